@@ -0,0 +1,34 @@
+#ifndef TRITON_ANALYSIS_INTEGER_RANGE_H
+#define TRITON_ANALYSIS_INTEGER_RANGE_H
+
+#include "mlir/Analysis/DataFlow/IntegerRangeAnalysis.h"
+#include "mlir/Analysis/DataFlowFramework.h"
+
+namespace mlir::triton {
+
+/// The integer range analysis of the arith and scf ops, extended with the
+/// ranges of the program ids, of make_range and of the integer constant
+/// tensors, which are propagated through the shape manipulation ops, and with
+/// the bounds of the function arguments given by their `tt.min_value` and
+/// `tt.max_value` attributes.  The ranges of tensors are those of their
+/// elements.  It needs the dead code analysis of the solvers of
+/// createDataFlowSolver().
+class TritonIntegerRangeAnalysis : public dataflow::IntegerRangeAnalysis {
+public:
+  using dataflow::IntegerRangeAnalysis::IntegerRangeAnalysis;
+
+  void setToEntryState(dataflow::IntegerValueRangeLattice *lattice) override;
+
+  void visitOperation(
+      Operation *op,
+      ArrayRef<const dataflow::IntegerValueRangeLattice *> operands,
+      ArrayRef<dataflow::IntegerValueRangeLattice *> results) override;
+};
+
+/// Returns the range of `value` inferred by `solver`, if known.
+std::optional<ConstantIntRanges> getIntegerRange(DataFlowSolver &solver,
+                                                 Value value);
+
+} // namespace mlir::triton
+
+#endif // TRITON_ANALYSIS_INTEGER_RANGE_H
@@ -4,6 +4,8 @@
 #include "Allocation.h"
 #include "llvm/ADT/SmallPtrSet.h"
 
+#include <map>
+#include <optional>
 #include <set>
 
 namespace mlir {
@@ -12,29 +14,50 @@ class OpBuilder;
 
 struct BlockInfo {
   using BufferIdSetT = Allocation::BufferIdSetT;
-  using IntervalSetT = std::set<Interval<size_t>>;
-
-  IntervalSetT syncReadIntervals;
-  IntervalSetT syncWriteIntervals;
+  /// Interval -> Operations accessing it since the last barrier
+  using IntervalMapT = std::map<Interval<size_t>, std::set<Operation *>>;
+
+  IntervalMapT syncReadIntervals;
+  IntervalMapT syncWriteIntervals;
+
+  /// A pair of unsynchronized shared memory accesses that overlap.
+  struct Conflict {
+    /// One of "RAW", "WAR" and "WAW".
+    StringRef kind;
+    /// The interval accessed by this BlockInfo.
+    Interval<size_t> interval;
+    /// The interval accessed by the other BlockInfo.
+    Interval<size_t> otherInterval;
+    /// One of the operations of this BlockInfo accessing `interval`.
+    Operation *op;
+  };
 
   BlockInfo() = default;
 
   /// Unions two BlockInfo objects.
   BlockInfo &join(const BlockInfo &other) {
-    syncReadIntervals.insert(other.syncReadIntervals.begin(),
-                             other.syncReadIntervals.end());
-    syncWriteIntervals.insert(other.syncWriteIntervals.begin(),
-                              other.syncWriteIntervals.end());
+    for (auto &[interval, ops] : other.syncReadIntervals)
+      syncReadIntervals[interval].insert(ops.begin(), ops.end());
+    for (auto &[interval, ops] : other.syncWriteIntervals)
+      syncWriteIntervals[interval].insert(ops.begin(), ops.end());
     return *this;
   }
 
+  /// Returns the first conflict between the accesses of this BlockInfo and the
+  /// accesses of `other`, if any.
+  std::optional<Conflict> getConflict(const BlockInfo &other) const {
+    if (auto conflict = getConflict(syncWriteIntervals,
+                                    other.syncReadIntervals, "RAW"))
+      return conflict;
+    if (auto conflict = getConflict(syncReadIntervals,
+                                    other.syncWriteIntervals, "WAR"))
+      return conflict;
+    return getConflict(syncWriteIntervals, other.syncWriteIntervals, "WAW");
+  }
+
   /// Returns true if intervals in two BlockInfo objects are intersected.
   bool isIntersected(const BlockInfo &other) const {
-    return /*RAW*/ isIntersected(syncWriteIntervals, other.syncReadIntervals) ||
-           /*WAR*/
-           isIntersected(syncReadIntervals, other.syncWriteIntervals) ||
-           /*WAW*/
-           isIntersected(syncWriteIntervals, other.syncWriteIntervals);
+    return getConflict(other).has_value();
   }
 
   /// Clears the intervals because a barrier is inserted.
@@ -43,6 +66,13 @@ struct BlockInfo {
     syncWriteIntervals.clear();
   }
 
+  /// Clears the accesses of the operations for which `isSynced` returns true,
+  /// because a barrier that only synchronizes them is inserted.
+  void sync(function_ref<bool(Operation *)> isSynced) {
+    sync(syncReadIntervals, isSynced);
+    sync(syncWriteIntervals, isSynced);
+  }
+
   /// Compares two BlockInfo objects.
   bool operator==(const BlockInfo &other) const {
     return syncReadIntervals == other.syncReadIntervals &&
@@ -52,13 +82,25 @@ struct BlockInfo {
   bool operator!=(const BlockInfo &other) const { return !(*this == other); }
 
 private:
-  bool isIntersected(const IntervalSetT &lhsIntervalSet,
-                     const IntervalSetT &rhsIntervalSet) const {
-    for (auto &lhs : lhsIntervalSet)
-      for (auto &rhs : rhsIntervalSet)
+  static void sync(IntervalMapT &intervals,
+                   function_ref<bool(Operation *)> isSynced) {
+    for (auto it = intervals.begin(); it != intervals.end();) {
+      auto &ops = it->second;
+      for (auto opIt = ops.begin(); opIt != ops.end();)
+        opIt = isSynced(*opIt) ? ops.erase(opIt) : std::next(opIt);
+      it = ops.empty() ? intervals.erase(it) : std::next(it);
+    }
+  }
+
+  std::optional<Conflict> getConflict(const IntervalMapT &lhsIntervalSet,
+                                      const IntervalMapT &rhsIntervalSet,
+                                      StringRef kind) const {
+    for (auto &[lhs, lhsOps] : lhsIntervalSet)
+      for (auto &[rhs, rhsOps] : rhsIntervalSet)
         if (lhs.intersects(rhs))
-          return true;
-    return false;
+          return Conflict{kind, lhs, rhs,
+                          lhsOps.empty() ? nullptr : *lhsOps.begin()};
+    return std::nullopt;
   }
 };
 
@@ -81,6 +123,21 @@ public:
   /// a shared memory read. If the temporary storage is written but not read,
   /// it is considered as the problem of the operation itself but not the membar
   /// analysis.
+  ///
+  /// Accesses to a memdesc_subview that selects one slice of a multi-buffer
+  /// at a constant index only cover the bytes of that slice, so accesses to
+  /// disjoint slices of the same buffer do not require a barrier.
+  ///
+  /// Operations nested in a `triton_gpu.warp_group` attribute are executed
+  /// only by that group of warps. When every pending access that conflicts
+  /// with such an operation was made by the same group, a named barrier
+  /// (`gpu.barrier` with `bar_id` and `num_threads`) synchronizing only those
+  /// warps is inserted instead of a CTA-wide one. Targets without named
+  /// barriers lower it as a CTA-wide barrier.
+  ///
+  /// If TRITON_MEMBAR_REPORT is set, a remark is emitted for each inserted
+  /// barrier naming the conflicting accesses, and the total number of inserted
+  /// barriers is reported on the function.
   MembarAnalysis() = default;
   explicit MembarAnalysis(Allocation *allocation) : allocation(allocation) {}
 
@@ -113,10 +170,42 @@ private:
   /// Collects the successors of the terminator
   void visitTerminator(Operation *operation, SmallVector<Block *> &successors);
 
-  void insertBarrier(Operation *operation, OpBuilder *builder);
+  /// A contiguous group of warps: (first warp, number of warps).
+  using WarpGroup = std::pair<int, int>;
+
+  /// Inserts a barrier synchronizing `group`, or the whole CTA if it is not
+  /// set or no named barrier is left for it. Returns true if the inserted
+  /// barrier is a named one.
+  bool insertBarrier(Operation *operation, OpBuilder *builder,
+                     std::optional<WarpGroup> group = std::nullopt);
+
+  /// Returns the group of warps executing `op`, or std::nullopt if `op` is
+  /// executed by all warps.
+  static std::optional<WarpGroup> getWarpGroup(Operation *op);
+
+  /// Returns the named barrier id reserved for `group` in this function, or
+  /// std::nullopt if all ids are taken.
+  std::optional<unsigned> getNamedBarrierId(WarpGroup group);
+
+  /// Inserts a barrier before `op`, synchronizing as few warps as the pending
+  /// accesses of `blockInfo` that conflict with `curBlockInfo` allow, and
+  /// syncs `blockInfo` accordingly.
+  void insertBarrierAndSync(Operation *op, BlockInfo *blockInfo,
+                            const BlockInfo &curBlockInfo, OpBuilder *builder);
+
+  /// Returns the shared memory interval accessed through `value` in
+  /// `bufferId`.
+  Interval<size_t> getAccessedInterval(Value value,
+                                       Allocation::BufferId bufferId) const;
+
+  /// Reports a barrier inserted before `op` because of `conflict`.
+  void reportBarrier(Operation *op, const BlockInfo::Conflict &conflict);
 
 private:
   Allocation *allocation = nullptr;
+  bool report = false;
+  unsigned numBarriers = 0;
+  std::map<WarpGroup, unsigned> namedBarrierIds;
 };
 
 /// Postorder traversal on the callgraph to insert membar instructions
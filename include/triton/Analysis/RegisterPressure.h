@@ -0,0 +1,66 @@
+#ifndef TRITON_ANALYSIS_REGISTER_PRESSURE_H
+#define TRITON_ANALYSIS_REGISTER_PRESSURE_H
+
+#include "mlir/Analysis/Liveness.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Interfaces/FunctionInterfaces.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+
+namespace mlir {
+
+/// Estimates the number of 32-bit registers each thread keeps live at every
+/// operation of a function, from the layouts of the live values.  This is an
+/// estimate of the pressure seen by the register allocator of the backend,
+/// meant to tell passes when they are about to cause spills; it does not model
+/// the temporaries of the lowering of each operation.
+class RegisterPressureAnalysis {
+public:
+  /// Maximum number of registers per thread supported by the hardware.
+  static constexpr unsigned kMaxRegistersPerThread = 255;
+  /// Number of 32-bit registers in the register file of a multiprocessor.
+  static constexpr unsigned kRegisterFileSize = 64 * 1024;
+
+  explicit RegisterPressureAnalysis(FunctionOpInterface funcOp);
+
+  /// Returns the number of registers live right after `op`, including its
+  /// results.
+  unsigned getLiveRegisters(Operation *op) const {
+    return liveRegisters.lookup(op);
+  }
+
+  /// Returns the maximum number of registers live at `op` or at any operation
+  /// nested in its regions.
+  unsigned getMaxLiveRegisters(Operation *op) const {
+    return maxLiveRegisters.lookup(op);
+  }
+
+  /// Returns the maximum number of registers live in the function.
+  unsigned getMaxLiveRegisters() const { return funcMaxLiveRegisters; }
+
+  /// Returns the number of registers each thread needs to hold a value of
+  /// `type`.
+  static unsigned getNumRegisters(Type type);
+
+  /// Returns the number of registers each thread can use without spilling,
+  /// given the number of threads of a CTA of `mod`.
+  static unsigned getRegisterLimit(ModuleOp mod);
+
+private:
+  unsigned getNumRegisters(Value value) const;
+
+  unsigned visitRegion(Region &region, const DenseSet<Value> &outerLive);
+
+  Liveness liveness;
+  DenseMap<Operation *, unsigned> liveRegisters;
+  DenseMap<Operation *, unsigned> maxLiveRegisters;
+  unsigned funcMaxLiveRegisters = 0;
+};
+
+/// Returns the maximum number of registers live per thread over the kernels
+/// of `mod`.
+unsigned estimateMaxLiveRegisters(ModuleOp mod);
+
+} // namespace mlir
+
+#endif // TRITON_ANALYSIS_REGISTER_PRESSURE_H
@@ -6,6 +6,7 @@
 #include "mlir/Support/LLVM.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Tools/LinearLayout.h"
 
 namespace mlir {
 
@@ -68,10 +69,29 @@ public:
 
   unsigned getScratchSizeInBytes();
 
+  // Returns the number of elements of the vectors in which the partial
+  // reductions of all the operands go through shared memory together, with
+  // a single access per element, or 1 if each operand has its own buffer.
+  unsigned getSmemVectorSize();
+
   bool isSupportedLayout();
 
   bool isReduceWithinCTA();
 
+  // Returns the number of CTAs of the cluster across which the axis is
+  // split, and whose reductions are combined through distributed shared
+  // memory.
+  unsigned getNumCTAsAlongAxis();
+
+  // Returns the number of elements of the result of the reduction of a CTA.
+  unsigned getResultElemsPerCTA();
+
+  // Returns the byte offsets in the scratch buffer of the buffers, one per
+  // operand, into which the CTAs across which the axis is split store their
+  // reductions, followed by the end of the last buffer.  Each buffer holds
+  // getNumCTAsAlongAxis() slots of getResultElemsPerCTA() elements.
+  SmallVector<unsigned> getCrossCTAOffsets();
+
   unsigned getAxis() { return axis; }
 
 private:
@@ -137,6 +157,8 @@ public:
   Location getLoc() { return scanOp.getLoc(); }
   unsigned getAxis() { return scanOp.getAxis(); }
   bool getReverse() { return scanOp.getReverse(); }
+  // Return true if the last operand holds head flags restarting the scan.
+  bool isSegmented() { return scanOp.getSegmented(); }
   triton::gpu::BlockedEncodingAttr getEncoding();
   llvm::ArrayRef<int64_t> getShape() { return srcShape; }
   unsigned getNumOperands() { return scanOp.getNumOperands(); }
@@ -151,6 +173,53 @@ private:
   SmallVector<Type> srcElementTypes;
 };
 
+class GatherLoweringHelper {
+public:
+  explicit GatherLoweringHelper(triton::GatherOp gatherOp)
+      : gatherOp(gatherOp) {}
+
+  // Return the size of the scratch space needed for the gather, which is zero
+  // when it is warp-local.
+  unsigned getScratchSizeInBytes();
+  // Return true if the elements of each column of the input along the gather
+  // axis, and the indices gathering from that column, are held by the same
+  // warp, so that the gather can be done with warp shuffles.
+  bool isWarpLocal();
+  // Return the layout mapping the coordinates of an input element, relative to
+  // the first element held by its warp, to a register and lane of the warp
+  // holding it. Only valid if the gather is warp-local.
+  LinearLayout getWarpLocalSourceLayout();
+
+private:
+  triton::GatherOp gatherOp;
+};
+
+class HistogramLoweringHelper {
+public:
+  explicit HistogramLoweringHelper(triton::HistogramOp histogramOp);
+
+  // Return true if the bins are counted in registers with warp ballots before
+  // being merged across warps in shared memory. Otherwise, the threads add
+  // their elements to privatized copies of the bins in shared memory with
+  // atomics, and the copies are merged when reading the result.
+  bool usesWarpBallots() const;
+  // Return the number of copies of the bins in shared memory, each shared by
+  // the warps of the same index modulo this number.
+  unsigned getNumPrivateCopies() const { return numPrivateCopies; }
+  // Return the number of bins counted by each pass over the input. The bins
+  // are counted in several passes when their copies do not fit in scratch.
+  unsigned getNumBinsPerPass() const { return numBinsPerPass; }
+  unsigned getNumPasses() const;
+  unsigned getScratchSizeInBytes() const;
+
+private:
+  triton::HistogramOp histogramOp;
+  unsigned numBins;
+  unsigned threadsPerWarp;
+  unsigned numPrivateCopies = 1;
+  unsigned numBinsPerPass;
+};
+
 // Decomposes a reshape into simpler pieces.
 //
 // As an example, suppose we have a reshape from [4,4,4] to [2,2,8,2].
@@ -190,10 +259,47 @@ bool isSingleValue(Value value);
 
 bool cvtNeedsSharedMemory(RankedTensorType srcTy, RankedTensorType dstTy);
 
+// If converting from `srcTy` to `dstTy` only moves data between the lanes of
+// each warp, in a way getWarpShuffleRegisters can do with shuffles, returns
+// the layout mapping the (register, lane) of each destination element to the
+// (register, lane) of a source element it can be shuffled from.
+std::optional<triton::LinearLayout>
+getWarpShuffleConversion(RankedTensorType srcTy, RankedTensorType dstTy);
+
+// The registers each lane sends and receives in the shuffles of a conversion
+// that mixes registers and lanes, such as a transpose. There is one shuffle
+// per destination register i, with (R, L) = conversion(i, 0), in which lane l
+// receives its register i ^ dst(l) from lane L ^ conversion(0, l), which sends
+// its register R ^ src(L ^ l), dst and src being linear in the lane id.
+struct WarpShuffleRegisters {
+  // The offsets xor'ed into the sent register by each bit of the lane id.
+  SmallVector<int32_t> src;
+  // The offsets xor'ed into the received register by each bit of the lane id.
+  SmallVector<int32_t> dst;
+};
+
+// Returns the registers of the shuffles of `conversion`, a layout as returned
+// by getWarpShuffleConversion, or nullopt if there are none in which each lane
+// sends a single register to all the lanes reading from it.
+std::optional<WarpShuffleRegisters>
+getWarpShuffleRegisters(const triton::LinearLayout &conversion);
+
 bool isMfmaToDotShortcut(RankedTensorType &srcTy, RankedTensorType &dstTy);
 
 bool isMmaToDotShortcut(RankedTensorType srcTy, RankedTensorType dstTy);
 
+// Returns the blocked layout in which each thread holds the rows (opIdx = 0)
+// or the columns (opIdx = 1) it reads of an FMA dot operand of `shape` and
+// `dotOperandLayout` along the whole K dimension, or null if the dot operand
+// isn't of an FMA dot that can read its operands from such a layout.
+triton::gpu::BlockedEncodingAttr getFMADotOperandRegisterLayout(
+    triton::gpu::DotOperandEncodingAttr dotOperandLayout,
+    ArrayRef<int64_t> shape);
+
+// dot_op<parent=#blocked> = getFMADotOperandRegisterLayout(...), the
+// conversion only reorders the registers of each thread.
+bool isBlockedToDotShortcut(RankedTensorType srcTy, RankedTensorType dstTy);
+
 // TODO(jlebar): Remove this function; it's subsumed by the linear-layout case
 // in cvtNeedsSharedMemory.
 bool isMmaToMmaShortcut(RankedTensorType srcTy, RankedTensorType dstTy);
@@ -365,6 +471,16 @@ std::unique_ptr<DataFlowSolver> createDataFlowSolver();
 
 triton::MakeTensorPtrOp getMakeTensorPtrOp(Value v);
 
+// Collects in `args` the numbers of the arguments of the function that the
+// pointers of `ptr` are computed from. Returns false if they may also be
+// computed from other pointers, e.g. loaded from memory.
+bool getPointerBaseArgs(Value ptr, DenseSet<unsigned> &args);
+
+// Returns whether all the elements of `value` are the same, so that each
+// register of it holds the same in all the threads of a warp, like scalars,
+// splats, and the elementwise ops and loads of such values.
+bool isWarpUniform(Value value);
+
 } // namespace mlir
 
 #endif // TRITON_ANALYSIS_UTILITY_H
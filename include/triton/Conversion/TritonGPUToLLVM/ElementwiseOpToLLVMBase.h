@@ -43,6 +43,20 @@ public:
   ContainerT::size_type size() const { return end() - begin(); }
 };
 
+// Returns true if the operands and the result of `op` are tensors of the same
+// 16-bit float type whose elements come in pairs of elements adjacent in each
+// thread, so that each pair can be processed by a packed f16x2/bf16x2
+// instruction.
+bool canPackElementPairs(Operation *op);
+
+// Packs the elements of the first 2 operand sets of `operands` in vectors of 2
+// elements, calls `createOp` on the vector type and the packed operands, and
+// returns the 2 elements of the vector it returns.
+SmallVector<Value>
+createPackedDestOps(ConversionPatternRewriter &rewriter, Location loc,
+                    Type elemTy, MultipleOperandsRange operands,
+                    function_ref<Value(Type, ValueRange)> createOp);
+
 // Base pattern for elementwise conversion using ConcreteT. Unpacks individual
 // elements from a `!llvm.struct` via `llvm.extactvalue`, calls
 // ConcreteT::createDestOps on each element, and packs them back into an
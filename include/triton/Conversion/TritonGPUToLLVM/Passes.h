@@ -19,6 +19,8 @@ namespace triton {
 
 namespace gpu {
 std::unique_ptr<OperationPass<ModuleOp>> createAllocateSharedMemoryPass();
+std::unique_ptr<OperationPass<ModuleOp>>
+createAllocateGlobalScratchMemoryPass();
 
 } // namespace gpu
 
@@ -37,6 +37,12 @@ public:
                        pred);
   }
 
+  // Synchronizes the threads of all the CTAs of the cluster, after which the
+  // stores of each to the shared memory of the others are visible.
+  //
+  // A target that does not support clusters will assert.
+  virtual void clusterBarrier(RewriterBase &rewriter, Location loc) const = 0;
+
   virtual Value shuffleXor(RewriterBase &rewriter, Location loc, Value val,
                            int i) const = 0;
   virtual Value shuffleUp(RewriterBase &rewriter, Location loc, Value val,
@@ -46,6 +52,28 @@ public:
   virtual Value shuffleIdx(RewriterBase &rewriter, Location loc, Value val,
                            Value i) const = 0;
 
+  // Variants of shuffleXor and shuffleUp for the butterfly reductions and the
+  // scans within warps, which let targets use cheaper cross-lane operations
+  // than general shuffles.
+  //
+  // shuffleXorForReduce returns `val` of the lane whose id is the id of the
+  // current lane xor-ed with any mask whose highest set bit is `i`, e.g. `i`,
+  // for a reduction over aligned groups of contiguous lanes.
+  virtual Value shuffleXorForReduce(RewriterBase &rewriter, Location loc,
+                                    Value val, int i) const = 0;
+  // shuffleUpForScan returns `val` of the lane `i` below the current lane to
+  // the lanes that are at least `i` above the start of their aligned group of
+  // `groupSize` lanes, and any value to the other lanes.
+  virtual Value shuffleUpForScan(RewriterBase &rewriter, Location loc,
+                                 Value val, int i,
+                                 unsigned groupSize) const = 0;
+
+  // Returns `val`, which is the same in all the threads of a warp, in a way
+  // that lets the target keep it and the values computed from it in scalar
+  // or uniform registers, instead of once per thread.
+  virtual Value makeWarpUniform(RewriterBase &rewriter, Location loc,
+                                Value val) const = 0;
+
   virtual Value programId(RewriterBase &rewriter, Location loc,
                           ModuleOp moduleOp, int axis) const = 0;
 
@@ -54,6 +82,24 @@ public:
                           unsigned numLaneToReduce,
                           unsigned interleave) const = 0;
 
+  // Returns true if the target can load (resp. store) four 8x8 matrices of
+  // 16-bit elements from (resp. to) shared memory with one instruction per
+  // warp, see loadMatrix and storeMatrix.
+  virtual bool canUseLdMatrix() const = 0;
+  virtual bool canUseStMatrix() const = 0;
+
+  // Loads four 8x8 matrices of 16-bit elements from shared memory.  Lane i
+  // passes in `ptr` the address of row i % 8 of matrix i / 8, and gets back
+  // one 32-bit word per matrix holding the elements 2 * (i % 4) and
+  // 2 * (i % 4) + 1 of row i / 4.  If `trans`, the words hold the elements
+  // i / 4 of rows 2 * (i % 4) and 2 * (i % 4) + 1 instead.
+  virtual SmallVector<Value> loadMatrix(RewriterBase &rewriter, Location loc,
+                                        Value ptr, bool trans) const = 0;
+  // Stores four 8x8 matrices of 16-bit elements to shared memory, with the
+  // same addressing and distribution of the elements as loadMatrix.
+  virtual void storeMatrix(RewriterBase &rewriter, Location loc, Value ptr,
+                           ArrayRef<Value> vals, bool trans) const = 0;
+
   virtual bool processReplicaUsingStMatrix(
       RewriterBase &rewriter, Location loc, Value smemBase,
       SmallVector<Value> &vals, RankedTensorType srcTy, Type elemTy,
@@ -62,6 +108,9 @@ public:
       int swizzleByteWidth = 0) const = 0;
 
   virtual std::string getMulhiFuncName(Type resultElementTy) const = 0;
+  // Returns a 64-bit timestamp of the device timer, in nanoseconds or cycles
+  // depending on the target.
+  virtual Value timestamp(RewriterBase &rewriter, Location loc) const = 0;
   // Emits LLVM code with |rewriter| to print a message following the given
   // format from the device. |formatStrStart| is the pointer to the start of
   // the format string global variable; |args| are the arguments to fill
@@ -231,6 +231,68 @@ Value createLLVMIntegerConstant(OpBuilder &builder, Location loc, short width,
 // Is v an integer or floating-point scalar constant equal to 0?
 bool isConstantZero(Value v);
 
+// Lets LLVM reassociate and contract the floating-point additions and
+// multiplications of the fast-math kernel `mod`. Divisions, square roots and
+// calls are left alone: the backends lower those of fast-math kernels to
+// approximations themselves, and keep the precise ones precise.
+void setFastMathFlags(ModuleOp mod);
+
+// The device log: with the device-log-capacity option, prints and asserts
+// don't call vprintf and __assertfail, but append records to a ring buffer,
+// the global kDeviceLogName, which the host decodes after the kernel completes
+// (see triton/runtime/device_log.py). Each thread reserves the records of a
+// print, or of a failing assert, with a single atomic. The buffer is a header
+// of kDeviceLogHeaderWords i32, the first of which counts the records ever
+// reserved, followed by the records of kDeviceLogRecordWords i32:
+//   site, thread id, pid x, pid y, pid z, element index, value (low, high)
+// where `site` indexes the JSON descriptions of the prints and asserts in the
+// kDeviceLogSitesAttrName module attribute, which ends up in the kernel
+// metadata. Once the buffer is full, records overwrite the oldest ones.
+constexpr llvm::StringLiteral kDeviceLogName = "triton_device_log";
+constexpr llvm::StringLiteral kDeviceLogSitesAttrName =
+    "triton_gpu.device_log_sites";
+constexpr unsigned kDeviceLogHeaderWords = 4;
+constexpr unsigned kDeviceLogRecordWords = 8;
+
+// Adds a device log of `capacity` records to `mod`, if it has prints or
+// asserts.
+void createDeviceLog(ModuleOp mod, unsigned capacity);
+
+// Returns the device log of `mod`, or null if prints and asserts aren't logged.
+LLVM::GlobalOp getDeviceLog(ModuleOp mod);
+
+// Adds the JSON description `site` to the sites of the device log of `mod`, and
+// returns its index.
+unsigned addDeviceLogSite(ModuleOp mod, StringRef site);
+
+// Reserves `numRecords` consecutive records of `log`, and returns the index of
+// the first one.
+Value reserveDeviceLogRecords(RewriterBase &rewriter, Location loc,
+                              LLVM::GlobalOp log, unsigned numRecords);
+
+// Writes the record `index` of `log` for the current thread, with the i32
+// `elementIndex` and the i64 `value`.
+void storeDeviceLogRecord(RewriterBase &rewriter, Location loc,
+                          const TargetInfoBase &targetInfo, LLVM::GlobalOp log,
+                          Value index, unsigned site, Value elementIndex,
+                          Value value);
+
+// The workspaces of the global_scratch_alloc ops of a kernel are packed by
+// AllocateGlobalScratchMemory in a buffer of kGlobalScratchSizeAttrName bytes,
+// at the kGlobalScratchOffsetAttrName of each op. When the size is not 0, the
+// launcher allocates and zeroes the buffer for each launch and passes it as
+// the last argument of the kernel.
+constexpr llvm::StringLiteral kGlobalScratchSizeAttrName =
+    "triton_gpu.global_scratch_memory_size";
+constexpr llvm::StringLiteral kGlobalScratchOffsetAttrName =
+    "triton_gpu.global_scratch_memory_offset";
+
+// Returns the size of the global scratch buffer of the kernels of `mod`.
+inline unsigned getGlobalScratchSize(ModuleOp mod) {
+  auto size = mod->getAttrOfType<IntegerAttr>(kGlobalScratchSizeAttrName);
+  return size ? size.getInt() : 0;
+}
+
 /// Helper function to get strides from a given shape and its order
 SmallVector<Value> getStridesFromShapeAndOrder(ArrayRef<int64_t> shape,
                                                ArrayRef<unsigned> order,
@@ -415,6 +477,7 @@ using ::mlir::triton::gpu::CTALayoutAttr;
 using ::mlir::triton::gpu::DotOperandEncodingAttr;
 using ::mlir::triton::gpu::NvidiaMmaEncodingAttr;
 using ::mlir::triton::gpu::SliceEncodingAttr;
+using ::mlir::triton::gpu::SparseDotMetaEncodingAttr;
 
 inline Value dot(RewriterBase &rewriter, Location loc, ArrayRef<Value> offsets,
                  ArrayRef<Value> strides) {
@@ -911,8 +974,12 @@ inline void emitWmmaOffsetForCTA(const AMDWmmaEncodingAttr &wmmaLayout,
   SmallVector<unsigned> elemOffset(rank, 0);
   if (rank == 3)
     elemOffset[0] = ctaBatchOffset;
+  // Version 1 interleaves the rows of the two halves of a wave, version 2 gives
+  // each half 8 contiguous rows.
+  const unsigned rowStride = wmmaLayout.getVersion() == 1 ? 2 : 1;
   for (unsigned elem = 0; elem < elemsPerThreadPerGroup; elem++) {
-    elemOffset[rank - 2] = ctaOffsetX * shapePerCta[rank - 2] + 2 * elem;
+    elemOffset[rank - 2] =
+        ctaOffsetX * shapePerCta[rank - 2] + rowStride * elem;
     elemOffset[rank - 1] = ctaOffsetY * shapePerCta[rank - 1];
     offsets.push_back(elemOffset);
   }
@@ -958,8 +1025,10 @@ emitBaseIndexForWmmaLayout(Location loc, RewriterBase &rewriter,
 
   SmallVector<Value> multiDimBase(rank);
 
-  multiDimBase[rank - 2] =
-      add(udiv(threadIdPerWarp, i32_val(mnkDim[2])), offWarp0);
+  Value halfWaveId = udiv(threadIdPerWarp, i32_val(mnkDim[2]));
+  if (wmmaLayout.getVersion() == 2)
+    halfWaveId = mul(halfWaveId, i32_val(8));
+  multiDimBase[rank - 2] = add(halfWaveId, offWarp0);
   multiDimBase[rank - 1] = add(laneId, offWarp1);
 
   // TODO: It is assumed when rank = 3, warpsPerCTA is set to
@@ -1258,6 +1327,24 @@ emitIndices(Location loc, RewriterBase &rewriter, const TargetInfoBase &target,
     const TargetInfoBase &target,
     std::function<void(VectorType, Value /*shmemAddr*/)> perVectorCallback);
 
+// Like emitTransferBetweenRegistersAndShared, but moves the registers of each
+// thread eight at a time with one ldmatrix/stmatrix-style x4 instruction, each
+// lane providing the address of one row of 8 16-bit elements.
+//
+// perMatrixCallback is called once per instruction with the address of the
+// current lane's row, the index of the first of the 8 registers it moves and
+// whether the matrices must be transposed.  Register 2*j and 2*j+1 are packed
+// in the j-th word of the instruction.
+//
+// Returns false, without emitting any IR, if the layouts don't tile into 8x8
+// matrices of 16-bit elements or the shared memory strides aren't constant.
+[[nodiscard]] bool emitTransferBetweenRegistersAndSharedUsingMatrices(
+    RankedTensorType registerTy, MemDescType sharedTy, Type elemLlvmTy,
+    Value shmemBase, ArrayRef<Value> shmemStrides, Location loc,
+    RewriterBase &rewriter,
+    std::function<void(Value /*shmemAddr*/, int /*firstReg*/, bool /*trans*/)>
+        perMatrixCallback);
+
 inline DenseMap<unsigned, Value> getSwizzledSharedPtrs(
     Location loc, const TargetInfoBase &target, unsigned inVec,
     RankedTensorType srcTy, triton::gpu::SharedEncodingAttr resSharedLayout,
@@ -10,6 +10,13 @@ std::unique_ptr<Pass> createCombineOpsPass();
 
 std::unique_ptr<Pass> createReorderBroadcastPass();
 std::unique_ptr<Pass> createRewriteTensorPointerPass();
+std::unique_ptr<Pass> createDecomposeScaledDotPass();
+std::unique_ptr<Pass> createFoldMasksPass();
+std::unique_ptr<Pass> createNarrowPointerOffsetsPass();
+std::unique_ptr<Pass> createLoopUnrollPass();
+std::unique_ptr<Pass> createRasterizeProgramIdsPass();
+std::unique_ptr<Pass> createRasterizeProgramIdsPass(const std::string &order,
+                                                    int groupSize);
 
 } // namespace triton
 
@@ -9,6 +9,94 @@
 // TritonGPU depends on Triton
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/IR/Attributes.h"
+#include "triton/Tools/LinearLayout.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
+
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace mlir::triton::gpu {
+
+// Memoizes linear layouts queried during compilation: the layouts of (shape,
+// encoding, element bit width) triples and the conversions between pairs of
+// tensor types.  Both are rebuilt from scratch on every query otherwise, which
+// adds up for kernels with many layout conversions.  Owned by the
+// TritonGPUDialect, so it lives as long as the MLIRContext; its keys are
+// uniqued attributes and types of that context.
+class LinearLayoutCache {
+public:
+  using LayoutKey =
+      std::tuple<SmallVector<int64_t>, Attribute, std::optional<int32_t>>;
+  using ConversionKey = std::pair<Type, Type>;
+
+  std::optional<LinearLayout>
+  getOrCreateLayout(const LayoutKey &key,
+                    function_ref<std::optional<LinearLayout>()> create);
+  std::optional<LinearLayout>
+  getOrCreateConversion(const ConversionKey &key,
+                        function_ref<std::optional<LinearLayout>()> create);
+
+private:
+  struct LayoutKeyHash {
+    size_t operator()(const LayoutKey &key) const {
+      const auto &[shape, layout, elemBitWidth] = key;
+      return llvm::hash_combine(
+          llvm::hash_combine_range(shape.begin(), shape.end()), layout,
+          elemBitWidth.value_or(-1));
+    }
+  };
+
+  std::shared_mutex mutex;
+  std::unordered_map<LayoutKey, std::optional<LinearLayout>, LayoutKeyHash>
+      layouts;
+  llvm::DenseMap<ConversionKey, std::optional<LinearLayout>> conversions;
+};
+
+// Memoizes the properties of encodings that the lowering patterns query for
+// nearly every op, e.g. the elements per thread of a (encoding, shape,
+// element type), which are otherwise derived again from the parameters of the
+// encoding on every call.  Owned by the TritonGPUDialect, like
+// LinearLayoutCache.
+class EncodingCache {
+public:
+  // The element type is null for the properties that don't depend on it.
+  using Key = std::tuple<Attribute, SmallVector<int64_t>, Type>;
+
+  unsigned getOrCreateTotalElemsPerThread(const Key &key,
+                                          function_ref<unsigned()> create);
+  SmallVector<unsigned>
+  getOrCreateElemsPerThread(const Key &key,
+                            function_ref<SmallVector<unsigned>()> create);
+  SmallVector<unsigned>
+  getOrCreateShapePerCTATile(const Key &key,
+                             function_ref<SmallVector<unsigned>()> create);
+  CTALayoutAttr getOrCreateCTALayout(Attribute layout,
+                                     function_ref<CTALayoutAttr()> create);
+
+private:
+  struct KeyHash {
+    size_t operator()(const Key &key) const {
+      const auto &[layout, shape, elemTy] = key;
+      return llvm::hash_combine(
+          layout, llvm::hash_combine_range(shape.begin(), shape.end()),
+          elemTy);
+    }
+  };
+  template <typename T> using Map = std::unordered_map<Key, T, KeyHash>;
+
+  template <typename MapT, typename KeyT, typename Create>
+  auto getOrCreate(MapT &map, const KeyT &key, Create create);
+
+  std::shared_mutex mutex;
+  Map<unsigned> totalElemsPerThread;
+  Map<SmallVector<unsigned>> elemsPerThread;
+  Map<SmallVector<unsigned>> shapePerCTATile;
+  llvm::DenseMap<Attribute, CTALayoutAttr> ctaLayouts;
+};
+
+} // namespace mlir::triton::gpu
+
 #include "triton/Dialect/TritonGPU/IR/Dialect.h.inc"
 #include "triton/Dialect/TritonGPU/IR/Types.h"
 
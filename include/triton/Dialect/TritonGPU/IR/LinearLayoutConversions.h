@@ -6,6 +6,7 @@
 
 #include <optional>
 
+#include "mlir/IR/BuiltinTypes.h"
 #include "triton/Tools/LinearLayout.h"
 
 namespace mlir::triton::gpu {
@@ -44,6 +45,17 @@ std::optional<LinearLayout>
 toLinearLayout(ArrayRef<int64_t> shape, Attribute layout,
                std::optional<int32_t> elemBitWidth = std::nullopt);
 
+// Returns the conversion from srcTy's layout to dstTy's, that is
+// srcLayout.invertAndCompose(dstLayout).  It maps each (register, lane, warp,
+// block) of srcTy to one of dstTy holding the same element.
+//
+// Results of both functions are memoized in the TritonGPUDialect, so callers
+// don't need to cache them.
+//
+// Returns std::nullopt if either layout can't be converted to an LL.
+std::optional<LinearLayout> getLayoutConversion(RankedTensorType srcTy,
+                                                RankedTensorType dstTy);
+
 } // namespace mlir::triton::gpu
 
 #endif // TRITON_DIALECT_TRITONGPU_IR_LINEARLAYOUTCONVERSIONS_H
@@ -0,0 +1,37 @@
+#ifndef TRITON_DIALECT_TRITONGPU_TRANSFORMS_LISTSCHEDULER_H_
+#define TRITON_DIALECT_TRITONGPU_TRANSFORMS_LISTSCHEDULER_H_
+
+#include "mlir/IR/BuiltinOps.h"
+
+namespace mlir::triton::gpu {
+
+// The machine model of the list scheduler: the latencies, in cycles, of the
+// ops whose results take long to be ready, and the registers of a thread.
+struct SchedulingModel {
+  int globalLoadLatency;
+  int sharedLoadLatency;
+  int mmaLatency;
+  int sfuLatency;
+  // The registers the values live at any point of a block should fit in.
+  int maxRegisters;
+
+  // Returns the model of the target of `module`, e.g. "cuda:90", given its
+  // number of warps.
+  static SchedulingModel get(ModuleOp module);
+
+  // Returns the cycles after which the results of `op` are ready.
+  int getLatency(Operation *op) const;
+};
+
+// Reorders the ops of the blocks of the functions and loops of `module` by
+// list scheduling: each op is issued once its operands are ready, the ready
+// op on the longest latency path first, so that long-latency ops start early
+// and their consumers come late. An op that would make the registers of the
+// live values exceed the model's is deferred for ops that free registers.
+// Ops with memory effects other than reads keep their order with respect to
+// all such ops.
+void scheduleBlocks(ModuleOp module, const SchedulingModel &model);
+
+} // namespace mlir::triton::gpu
+
+#endif // TRITON_DIALECT_TRITONGPU_TRANSFORMS_LISTSCHEDULER_H_
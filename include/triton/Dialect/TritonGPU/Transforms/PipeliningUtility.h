@@ -8,6 +8,9 @@ namespace mlir {
 namespace triton {
 
 static const char *kNumStagesAttrName = "tt.num_stages";
+/// The stage the user pinned an op of a pipelined loop to, which overrides the
+/// stage the pipeliner would assign it.
+static const char *kPipelineStageAttrName = "tt.pipeline_stage";
 
 /// Function to mask operations during scheduling.
 Operation *predicateOp(RewriterBase &rewriter, Operation *op, Value pred);
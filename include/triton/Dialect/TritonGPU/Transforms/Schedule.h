@@ -13,8 +13,11 @@ namespace triton {
 
 /// This fill out the pipelining options including schedule and annotations
 /// for wait ops. This also does pre-processing by converting some of the
-/// loads into async loads so that the IR is ready to be pipelined.
+/// loads into async loads so that the IR is ready to be pipelined. The loads
+/// feeding MMAv3 dots get enough buffers for the dots of
+/// `numDotIterationsInFlight` iterations to be in flight.
 bool preProcessLoopAndGetSchedule(scf::ForOp &forOp, int numStages,
+                                  int numDotIterationsInFlight,
                                   mlir::triton::PipeliningOption &options);
 
 /// Fills out pipelining options for an outer loop pipelining case. This
@@ -25,11 +28,22 @@ bool getOuterLoopSchedule(scf::ForOp &forOp, int numStages,
 /// Pipeline the TMA stores in the loop.
 bool pipelineTMAStores(scf::ForOp forOp);
 
+/// Pipeline the loads of a while loop over two stages, issuing those of the
+/// next iteration at the end of each iteration, masked by the condition of the
+/// next iteration.
+bool pipelineWhileLoop(scf::WhileOp whileOp);
+
+/// Accumulates the products of the fp8 MMAv3 dots of the loop that may
+/// accumulate those of several iterations, but not of all, in the precision of
+/// the tensor cores into a partial accumulator, added to their fp32
+/// accumulator every maxNumImpreciseAcc / K iterations.
+void promoteImpreciseAccumulators(scf::ForOp &forOp);
+
 /// This does post-processing on the pipelined loop to try to pipeline wgmma
-/// ops.
+/// ops, keeping those of `numIterationsInFlight` iterations in flight.
 // TODO: this should be included as part of the pipeline but currently the wgmma
 // wait modeling is problematic.
-void asyncLaunchDots(scf::ForOp forOp);
+void asyncLaunchDots(scf::ForOp forOp, int numIterationsInFlight = 2);
 
 /// Post process the pipelined loop by updating the wait ops with the right
 /// number of groups in flight.
@@ -102,6 +116,22 @@ public:
   void dump();
 };
 
+/// Add the dependencies of the ops already in `schedule` to the stage and
+/// cluster of these ops.
+void scheduleDependencies(scf::ForOp forOp, CoarseSchedule &schedule,
+                          int numStages);
+
+/// Add the dependencies with a distance of 1 of the ops already in
+/// `schedule` to the next stage, in the cluster before these ops.
+void scheduleDistanceOneDependencies(scf::ForOp forOp,
+                                     CoarseSchedule &schedule, int numStages);
+
+/// Add the ops of the loop not yet in `schedule` to the last stage, in
+/// `afterPrologue` or the cluster of their latest scheduled operand.
+void scheduleRemainingToLastStage(scf::ForOp forOp, CoarseSchedule &schedule,
+                                  CoarseSchedule::Cluster afterPrologue,
+                                  int numStages);
+
 } // namespace triton
 } // namespace mlir
 #endif // TRITON_TRITONGPU_TRANSFORM_PIPELINE_SCHEDULE_H_
@@ -117,6 +117,11 @@ std::optional<Attribute> inferDstEncoding(Operation *op, Attribute encoding);
 // Infers the encoding of the source of op given the result encoding.
 std::optional<Attribute> inferSrcEncoding(Operation *op, Attribute encoding);
 
+// Returns the per-thread cost of `convertOp`.  Conversions that only move
+// data within threads are free, those within warps take one shuffle per
+// element, and the others go through shared memory.
+int64_t getConvertCost(triton::gpu::ConvertLayoutOp convertOp);
+
 bool isExpensiveLoadOrStore(Operation *op);
 
 bool canFoldIntoConversion(Operation *op, Attribute targetEncoding);
@@ -38,6 +38,26 @@
 #define GET_ATTRDEF_CLASSES
 #include "triton/Dialect/TritonNvidiaGPU/IR/TritonNvidiaGPUAttrDefs.h.inc"
 
+namespace mlir {
+namespace triton {
+namespace nvidia_gpu {
+
+struct TensorMemory : public SideEffects::Resource::Base<TensorMemory> {
+  StringRef getName() final { return "<TensorMemory>"; }
+};
+
+// Returns the layout of the tensors loaded from and stored to tensor memory.
+// It follows the 32x32b access pattern of tcgen05.ld and tcgen05.st: thread t
+// of warp w holds row 32 * (w % 4) + t, and the groups of 4 warps split the
+// columns.
+triton::gpu::BlockedEncodingAttr
+getTmemCompatibleLayout(MLIRContext *ctx, ArrayRef<int64_t> shape,
+                        int numWarps, triton::gpu::CTALayoutAttr ctaLayout);
+
+} // namespace nvidia_gpu
+} // namespace triton
+} // namespace mlir
+
 #define GET_OP_CLASSES
 #include "triton/Dialect/TritonNvidiaGPU/IR/Ops.h.inc"
 
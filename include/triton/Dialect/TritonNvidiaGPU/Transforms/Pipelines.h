@@ -0,0 +1,48 @@
+#ifndef TRITON_DIALECT_TRITONNVIDIAGPU_TRANSFORMS_PIPELINES_H_
+#define TRITON_DIALECT_TRITONNVIDIAGPU_TRANSFORMS_PIPELINES_H_
+
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Pass/PassOptions.h"
+#include "triton/Dialect/TritonNvidiaGPU/Transforms/Passes.h"
+
+namespace mlir {
+namespace triton {
+namespace nvidia_gpu {
+
+// Options of the pipeline lowering TTIR to TTGIR on NVIDIA GPUs, with the
+// defaults of the CUDA backend.
+struct TTGIRPipelineOptions
+    : public PassPipelineOptions<TTGIRPipelineOptions> {
+  Option<int> capability{*this, "capability",
+                         llvm::cl::desc("compute capability of the target"),
+                         llvm::cl::init(80)};
+  Option<int> numWarps{*this, "num-warps",
+                       llvm::cl::desc("number of warps of the kernel"),
+                       llvm::cl::init(4)};
+  Option<int> numCTAs{*this, "num-ctas",
+                      llvm::cl::desc("number of CTAs of the kernel"),
+                      llvm::cl::init(1)};
+  Option<int> numStages{*this, "num-stages",
+                        llvm::cl::desc("number of pipeline stages"),
+                        llvm::cl::init(3)};
+  Option<int> numDotIterationsInFlight{
+      *this, "num-dot-iterations-in-flight",
+      llvm::cl::desc("number of loop iterations whose MMAv3 dots can be in "
+                     "flight"),
+      llvm::cl::init(2)};
+};
+
+// Adds the passes of `make_ttgir` of the CUDA backend to `pm`. The cluster
+// dimensions planned by the pipeline are written to `clusterInfo` when it is
+// not null.
+void buildTTGIRPipeline(OpPassManager &pm, const TTGIRPipelineOptions &options,
+                        ClusterInfo *clusterInfo = nullptr);
+
+// Registers the pipeline as `triton-cuda-ttgir-pipeline`.
+void registerTTGIRPipeline();
+
+} // namespace nvidia_gpu
+} // namespace triton
+} // namespace mlir
+
+#endif // TRITON_DIALECT_TRITONNVIDIAGPU_TRANSFORMS_PIPELINES_H_
@@ -13,6 +13,7 @@ namespace mlir::triton {
 inline const std::set<std::string> CACHE_INVALIDATING_ENV_VARS = {
     // clang-format off
     "AMDGCN_ENABLE_DUMP",
+    "AMDGCN_USE_BUFFER_OPS",
     "DISABLE_FAST_REDUCTION",
     "DISABLE_LLVM_OPT",
     "DISABLE_MMA_V3",
@@ -27,7 +28,11 @@ inline const std::set<std::string> CACHE_INVALIDATING_ENV_VARS = {
     "TRITON_DISABLE_LINE_INFO",
     "TRITON_DISABLE_RESHAPE_ENCODING_INFERENCE",
     "TRITON_ENABLE_LLVM_DEBUG",
+    "TRITON_LATE_SPECIALIZATION",
+    "TRITON_LIST_SCHEDULING",
     "TRITON_LLVM_DEBUG_ONLY",
+    "TRITON_SMEM_BEST_FIT_ALLOC",
+    "TRITON_VERSION_UNIFORM_MASKS",
     "USE_TTGIR_LOC",
     "NVPTX_ENABLE_DUMP",
     // clang-format on
@@ -36,7 +41,9 @@ inline const std::set<std::string> CACHE_INVALIDATING_ENV_VARS = {
 inline const std::set<std::string> CACHE_NEUTRAL_ENV_VARS = {
     // clang-format off
     "TRITON_REPRODUCER_PATH",
-    "TRITON_DISABLE_PYTHON_STACKTRACE"
+    "TRITON_DISABLE_PYTHON_STACKTRACE",
+    "TRITON_MEMBAR_REPORT",
+    "TRITON_VECTORIZATION_REPORT"
     // clang-format on
 };
 
@@ -12,6 +12,8 @@
 #include "triton/Analysis/Alias.h"
 #include "triton/Dialect/Triton/IR/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/LinearLayoutConversions.h"
+#include "triton/Tools/Sys/GetEnv.hpp"
 #include "llvm/ADT/SmallVector.h"
 
 using ::mlir::triton::gpu::AMDMfmaEncodingAttr;
@@ -37,6 +39,18 @@ namespace triton {
 // Bitwidth of pointers
 constexpr int kPtrBitWidth = 64;
 
+// Shared memory is organized in 32 banks of 4 bytes on all supported targets.
+constexpr unsigned kNumSmemBanks = 32;
+constexpr unsigned kSmemBankBytes = 4;
+// Largest row padding, in bytes, that we are willing to spend to avoid bank
+// conflicts in convert_layout scratch buffers.
+constexpr unsigned kMaxCvtPadBytes = 32;
+// Number of vectorized accesses per thread sampled by the bank conflict model.
+constexpr unsigned kMaxSampledSmemAccesses = 16;
+// Functions with at most this many buffers try every placement order when
+// TRITON_SMEM_BEST_FIT_ALLOC is set.
+constexpr unsigned kMaxExhaustiveAllocBuffers = 6;
+
 static std::pair<SmallVector<unsigned>, SmallVector<unsigned>>
 getCvtOrder(Attribute srcLayout, Attribute dstLayout) {
   auto srcMmaLayout = mlir::dyn_cast<NvidiaMmaEncodingAttr>(srcLayout);
@@ -89,6 +103,130 @@ SmallVector<unsigned> getRepShapeForCvtLayout(triton::gpu::ConvertLayoutOp op) {
   return repShape;
 }
 
+// Estimates the number of shared memory wavefronts warp 0 needs to store (or
+// load) its elements of `ty` to (or from) a convert_layout scratch buffer of
+// shape `paddedRepShape`, using `vec`-element accesses.  This mirrors the
+// addressing used by processReplica in the ConvertLayoutOp lowering: the
+// coordinates are wrapped to `repShape` and linearized along `order`.
+//
+// A wavefront serves 128 bytes, so 8- and 16-byte accesses are split in
+// phases of 16 and 8 threads.  Within a phase, the number of wavefronts is the
+// largest number of distinct 4-byte words that map to the same bank.
+//
+// Returns std::nullopt if the layout cannot be converted to a linear layout.
+static std::optional<unsigned>
+estimateCvtSmemWavefronts(RankedTensorType ty, ArrayRef<unsigned> repShape,
+                          ArrayRef<unsigned> paddedRepShape,
+                          ArrayRef<unsigned> order, unsigned vec,
+                          unsigned elemBytes) {
+  std::optional<LinearLayout> ll =
+      triton::gpu::toLinearLayout(ty.getShape(), ty.getEncoding());
+  if (!ll.has_value())
+    return std::nullopt;
+  MLIRContext *ctx = ty.getContext();
+  StringAttr kRegister = StringAttr::get(ctx, "register");
+  StringAttr kLane = StringAttr::get(ctx, "lane");
+  StringAttr kWarp = StringAttr::get(ctx, "warp");
+  StringAttr kBlock = StringAttr::get(ctx, "block");
+
+  SmallVector<StringAttr> outDims;
+  for (unsigned d = 0; d < repShape.size(); ++d)
+    outDims.push_back(StringAttr::get(ctx, "dim" + llvm::Twine(d)));
+  unsigned numRegs = ll->getInDimSize(kRegister);
+  unsigned numLanes = ll->getInDimSize(kLane);
+  unsigned accessBytes = std::max(vec * elemBytes, kSmemBankBytes);
+  unsigned lanesPerPhase = std::clamp<unsigned>(
+      kNumSmemBanks * kSmemBankBytes / accessBytes, 1, numLanes);
+
+  unsigned wavefronts = 0;
+  unsigned numAccesses =
+      std::min(ceil<unsigned>(numRegs, vec), kMaxSampledSmemAccesses);
+  SmallVector<SmallVector<unsigned>> bankWords(kNumSmemBanks);
+  for (unsigned access = 0; access < numAccesses; ++access) {
+    for (unsigned phase = 0; phase < numLanes; phase += lanesPerPhase) {
+      for (auto &words : bankWords)
+        words.clear();
+      for (unsigned lane = phase; lane < phase + lanesPerPhase; ++lane) {
+        auto coords = ll->apply({{kRegister, access * vec},
+                                 {kLane, lane},
+                                 {kWarp, 0},
+                                 {kBlock, 0}});
+        unsigned offset = 0;
+        unsigned stride = 1;
+        for (unsigned d : order) {
+          auto it = llvm::find_if(
+              coords, [&](auto &coord) { return coord.first == outDims[d]; });
+          offset += (it->second % repShape[d]) * stride;
+          stride *= paddedRepShape[d];
+        }
+        unsigned firstWord = offset * elemBytes / kSmemBankBytes;
+        unsigned lastWord =
+            (offset * elemBytes + vec * elemBytes - 1) / kSmemBankBytes;
+        for (unsigned word = firstWord; word <= lastWord; ++word) {
+          auto &words = bankWords[word % kNumSmemBanks];
+          if (!llvm::is_contained(words, word))
+            words.push_back(word);
+        }
+      }
+      size_t phaseWavefronts = 1;
+      for (auto &words : bankWords)
+        phaseWavefronts = std::max(phaseWavefronts, words.size());
+      wavefronts += phaseWavefronts;
+    }
+  }
+  return wavefronts;
+}
+
+// Picks the padding of dimension `paddedDim` of a convert_layout scratch
+// buffer.  By default, rows are padded by max(inVec, outVec) elements.  When
+// both layouts can be expressed as linear layouts, larger multiples of this
+// padding (up to kMaxCvtPadBytes) are also considered, and the one with the
+// fewest estimated bank conflicts for the store and the load is selected.
+static unsigned getCvtPadding(triton::gpu::ConvertLayoutOp op,
+                              ArrayRef<unsigned> repShape, unsigned paddedDim,
+                              unsigned inVec, unsigned outVec) {
+  unsigned defaultPad = std::max(inVec, outVec);
+  auto srcTy = op.getSrc().getType();
+  auto dstTy = op.getType();
+  Attribute srcLayout = srcTy.getEncoding();
+  Attribute dstLayout = dstTy.getEncoding();
+  // MMAv1 conversions use a dedicated addressing scheme in the codegen.
+  for (Attribute layout : {srcLayout, dstLayout}) {
+    auto mma = mlir::dyn_cast<NvidiaMmaEncodingAttr>(layout);
+    if (mma && mma.isVolta())
+      return defaultPad;
+  }
+
+  unsigned elemBytes =
+      isa<triton::PointerType>(srcTy.getElementType())
+          ? kPtrBitWidth / 8
+          : std::max<int>(8, srcTy.getElementTypeBitWidth()) / 8;
+  // The lowering linearizes scratch offsets along the order of the
+  // destination layout.
+  auto order = getOrder(dstLayout);
+
+  unsigned bestPad = defaultPad;
+  std::optional<unsigned> bestCost;
+  SmallVector<unsigned> paddedRepShape(repShape);
+  for (unsigned pad = defaultPad;
+       pad == defaultPad || pad * elemBytes <= kMaxCvtPadBytes;
+       pad += defaultPad) {
+    paddedRepShape[paddedDim] = repShape[paddedDim] + pad;
+    auto stCost = estimateCvtSmemWavefronts(srcTy, repShape, paddedRepShape,
+                                            order, inVec, elemBytes);
+    auto ldCost = estimateCvtSmemWavefronts(dstTy, repShape, paddedRepShape,
+                                            order, outVec, elemBytes);
+    if (!stCost.has_value() || !ldCost.has_value())
+      return defaultPad;
+    unsigned cost = *stCost + *ldCost;
+    if (!bestCost.has_value() || cost < *bestCost) {
+      bestCost = cost;
+      bestPad = pad;
+    }
+  }
+  return bestPad;
+}
+
 SmallVector<unsigned>
 getScratchConfigForCvtLayout(triton::gpu::ConvertLayoutOp op, unsigned &inVec,
                              unsigned &outVec) {
@@ -136,8 +274,7 @@ getScratchConfigForCvtLayout(triton::gpu::ConvertLayoutOp op, unsigned &inVec,
   if (auto dstBlockedLayout = mlir::dyn_cast<BlockedEncodingAttr>(dstLayout)) {
     paddedDim = dstBlockedLayout.getOrder()[0];
   }
-  unsigned pad = std::max(inVec, outVec);
-  repShape[paddedDim] += pad;
+  repShape[paddedDim] += getCvtPadding(op, repShape, paddedDim, inVec, outVec);
   return repShape;
 }
 
@@ -245,12 +382,14 @@ private:
       unsigned bytes = helper.getScratchSizeInBytes();
       maybeAddScratchBuffer<BufferT::BufferKind::Scratch>(op, bytes,
                                                           scratchAlignment);
+    } else if (auto gatherOp = dyn_cast<triton::GatherOp>(op)) {
+      GatherLoweringHelper helper(gatherOp);
+      unsigned bytes = helper.getScratchSizeInBytes();
+      maybeAddScratchBuffer<BufferT::BufferKind::Scratch>(op, bytes,
+                                                          scratchAlignment);
     } else if (auto histogram = dyn_cast<triton::HistogramOp>(op)) {
-      auto dstTy = histogram.getType();
-      int threadsPerWarp = triton::gpu::TritonGPUDialect::getThreadsPerWarp(
-          op->getParentOfType<ModuleOp>());
-      auto bytes = std::max<int>(dstTy.getNumElements(), threadsPerWarp) *
-                   std::max<int>(8, dstTy.getElementTypeBitWidth()) / 8;
+      HistogramLoweringHelper helper(histogram);
+      unsigned bytes = helper.getScratchSizeInBytes();
       maybeAddScratchBuffer<BufferT::BufferKind::Scratch>(op, bytes,
                                                           scratchAlignment);
     } else if (auto cvtLayout = dyn_cast<triton::gpu::ConvertLayoutOp>(op)) {
@@ -362,6 +501,10 @@ private:
 
   /// Computes the liveness range of the allocated value.
   /// Each buffer is allocated only once.
+  /// An explicit local_dealloc is a use of the allocated value, so the range
+  /// stops there. This is what lets the scratch buffers of an epilogue reuse
+  /// the multi-buffers of the pipelined loop preceding it, as the pipeliner
+  /// deallocates them right after the loop.
   void resolveExplicitBufferLiveness(
       function_ref<Interval<size_t>(Value value)> getLiveness) {
     for (auto valueBufferIter : allocation->valueBuffer) {
@@ -467,6 +610,11 @@ private:
       buffers.emplace_back(bufferIter.first);
     }
 
+    if (triton::tools::getBoolEnv("TRITON_SMEM_BEST_FIT_ALLOC")) {
+      computeOffsetsBestFit(buffers);
+      return;
+    }
+
     calculateStarts(buffers);
 
     // NOTE: The original paper doesn't consider interference between
@@ -484,6 +632,77 @@ private:
     } while (!interference.empty());
   }
 
+  /// Places `buffer` at the lowest-waste offset that does not overlap with any
+  /// already placed buffer whose liveness range intersects with it. Among all
+  /// the gaps large enough to hold the buffer, the smallest one is chosen; if
+  /// none fits, the buffer is placed above all the interfering buffers.
+  void placeBestFit(BufferT *buffer, ArrayRef<BufferT *> placed) {
+    auto range = bufferRange.lookup(buffer);
+    SmallVector<Interval<size_t>> occupied;
+    for (auto *other : placed) {
+      if (bufferRange.lookup(other).intersects(range))
+        occupied.push_back({other->offset, other->offset + other->size});
+    }
+    llvm::sort(occupied);
+
+    std::optional<size_t> bestOffset;
+    size_t bestGap = std::numeric_limits<size_t>::max();
+    size_t gapStart = 0;
+    for (auto interval : occupied) {
+      size_t start = llvm::alignTo(gapStart, buffer->alignment);
+      if (start + buffer->size <= interval.start() &&
+          interval.start() - gapStart < bestGap) {
+        bestGap = interval.start() - gapStart;
+        bestOffset = start;
+      }
+      gapStart = std::max(gapStart, interval.end());
+    }
+    buffer->setOffsetAligned(bestOffset.value_or(gapStart));
+  }
+
+  /// Assigns offsets to `buffers` in the given order and returns the resulting
+  /// peak shared memory usage.
+  size_t placeInOrder(ArrayRef<BufferT *> buffers) {
+    size_t size = 0;
+    for (auto [i, buffer] : llvm::enumerate(buffers)) {
+      placeBestFit(buffer, buffers.take_front(i));
+      size = std::max(size, buffer->offset + buffer->size);
+    }
+    return size;
+  }
+
+  /// Computes the shared memory offsets by packing the buffers in decreasing
+  /// size order with best-fit placement. When there are only a few buffers,
+  /// every placement order is tried and the one with the smallest peak usage
+  /// is kept.
+  void computeOffsetsBestFit(SmallVector<BufferT *> buffers) {
+    // Larger buffers first, then earlier liveness, then creation order, so the
+    // result is deterministic.
+    auto cmp = [&](BufferT *x, BufferT *y) {
+      auto xRange = bufferRange.lookup(x);
+      auto yRange = bufferRange.lookup(y);
+      return std::make_tuple(-static_cast<int64_t>(x->size), xRange.start(),
+                             x->id) <
+             std::make_tuple(-static_cast<int64_t>(y->size), yRange.start(),
+                             y->id);
+    };
+    llvm::sort(buffers, cmp);
+    size_t bestSize = placeInOrder(buffers);
+    if (buffers.size() > 1 && buffers.size() <= kMaxExhaustiveAllocBuffers) {
+      SmallVector<BufferT *> bestOrder = buffers;
+      SmallVector<BufferT *> order = buffers;
+      while (std::next_permutation(order.begin(), order.end(), cmp)) {
+        size_t size = placeInOrder(order);
+        if (size < bestSize) {
+          bestSize = size;
+          bestOrder = order;
+        }
+      }
+      placeInOrder(bestOrder);
+    }
+    allocation->sharedMemorySize = bestSize;
+  }
+
   /// Computes the initial shared memory offsets.
   void calculateStarts(const SmallVector<BufferT *> &buffers) {
     //  v = values in shared memory
@@ -51,6 +51,21 @@ int64_t multiplyDivisor(int64_t lhs, int64_t rhs) {
   return lhs * rhs;
 }
 
+// Returns the largest power of two dividing every element of a tensor
+// described by `info`.  Elements inside a contiguous run are only known to be
+// divisible by 1, so [2^n, 2^n+1, ...] has divisibility 1 rather than 2^n.
+int64_t getElementDivisibility(const AxisInfo &info) {
+  if (info.getConstantValue().has_value())
+    return highestPowOf2Divisor(info.getConstantValue().value());
+  if (info.getRank() == 0)
+    return 1;
+  int64_t divisibility = 0;
+  for (int d = 0; d < info.getRank(); ++d)
+    divisibility = gcd(divisibility,
+                       info.getContiguity(d) > 1 ? 1 : info.getDivisibility(d));
+  return divisibility;
+}
+
 class AxisInfoVisitor {
 public:
   AxisInfoVisitor() = default;
@@ -231,6 +246,21 @@ public:
   }
 };
 
+class GlobalScratchAllocOpAxisInfoVisitor final
+    : public AxisInfoVisitorImpl<triton::GlobalScratchAllocOp> {
+public:
+  using AxisInfoVisitorImpl<
+      triton::GlobalScratchAllocOp>::AxisInfoVisitorImpl;
+
+  AxisInfo
+  getAxisInfo(triton::GlobalScratchAllocOp op,
+              ArrayRef<const dataflow::Lattice<AxisInfo> *> operands) override {
+    return AxisInfo(/*contiguity=*/{1},
+                    /*divisibility=*/{std::max<int64_t>(op.getAlignment(), 1)},
+                    /*constancy=*/{1});
+  }
+};
+
 template <typename OpTy>
 class ConstantOpAxisInfoVisitor final : public AxisInfoVisitorImpl<OpTy> {
 public:
@@ -582,21 +612,7 @@ public:
     AxisInfo::DimVectorT contiguity = opInfo.getContiguity();
     AxisInfo::DimVectorT divisibility = opInfo.getDivisibility();
     AxisInfo::DimVectorT constancy = opInfo.getConstancy();
-    int64_t newDivisibility = 1;
-    if (opInfo.getConstantValue().has_value()) {
-      // The tensor is constant, same as ConstantOpAxisInfoVisitor
-      newDivisibility = highestPowOf2Divisor(opInfo.getConstantValue().value());
-    } else if (opInfo.getRank()) {
-      // Otherwise, calculate the GCD as the new divisibility
-      // Treat [2^n,2^n+1,...]'s divisibility as 1 instead of 2^n
-      newDivisibility =
-          opInfo.getContiguity(0) > 1 ? 1 : opInfo.getDivisibility(0);
-      for (int d = 1; d < opInfo.getRank(); ++d) {
-        newDivisibility =
-            gcd(newDivisibility,
-                opInfo.getContiguity(d) > 1 ? 1 : opInfo.getDivisibility(d));
-      }
-    }
+    int64_t newDivisibility = getElementDivisibility(opInfo);
     contiguity.insert(contiguity.begin() + op.getAxis(), 1);
     divisibility.insert(divisibility.begin() + op.getAxis(), newDivisibility);
     constancy.insert(constancy.begin() + op.getAxis(), 1);
@@ -634,6 +650,134 @@ public:
   }
 };
 
+class ReshapeOpAxisInfoVisitor final
+    : public AxisInfoVisitorImpl<triton::ReshapeOp> {
+public:
+  using AxisInfoVisitorImpl<triton::ReshapeOp>::AxisInfoVisitorImpl;
+
+  AxisInfo
+  getAxisInfo(triton::ReshapeOp op,
+              ArrayRef<const dataflow::Lattice<AxisInfo> *> operands) override {
+    AxisInfo opInfo = operands[0]->getValue();
+    ArrayRef<int64_t> srcShape = op.getSrc().getType().getShape();
+    ArrayRef<int64_t> dstShape = op.getType().getShape();
+    int dstRank = dstShape.size();
+    AxisInfo::DimVectorT contiguity(dstRank, 1);
+    AxisInfo::DimVectorT divisibility(dstRank, getElementDivisibility(opInfo));
+    AxisInfo::DimVectorT constancy(dstRank, 1);
+    // Elements may be permuted arbitrarily.
+    if (op.getAllowReorder())
+      return AxisInfo(contiguity, divisibility, constancy);
+
+    // Split both shapes into groups of consecutive dimensions with the same
+    // number of elements.  A group that maps one source dimension to several
+    // destination dimensions (or the other way round) is a plain row-major
+    // split (or merge) of that dimension.
+    int srcRank = srcShape.size();
+    for (int i = 0, o = 0; i < srcRank && o < dstRank;) {
+      int iEnd = i + 1, oEnd = o + 1;
+      int64_t srcElems = srcShape[i], dstElems = dstShape[o];
+      while (srcElems != dstElems) {
+        if (srcElems < dstElems)
+          srcElems *= srcShape[iEnd++];
+        else
+          dstElems *= dstShape[oEnd++];
+      }
+      if (iEnd - i == 1) {
+        // Split of source dimension `i`: the innermost destination dimension
+        // keeps its runs, outer ones see elements `stride` apart.
+        int64_t stride = 1;
+        for (int d = oEnd - 1; d >= o; --d) {
+          if (d == oEnd - 1) {
+            contiguity[d] = gcd(opInfo.getContiguity(i), dstShape[d]);
+            divisibility[d] = opInfo.getDivisibility(i);
+            constancy[d] = gcd(opInfo.getConstancy(i), dstShape[d]);
+          } else {
+            divisibility[d] =
+                opInfo.getContiguity(i) > 1 ? 1 : opInfo.getDivisibility(i);
+            if (opInfo.getConstancy(i) % stride == 0)
+              constancy[d] = gcd(opInfo.getConstancy(i) / stride, dstShape[d]);
+          }
+          stride *= dstShape[d];
+        }
+      } else if (oEnd - o == 1) {
+        // Merge of source dimensions [i, iEnd): runs of the innermost one
+        // extend into the outer ones only when they span it entirely.
+        int inner = iEnd - 1;
+        contiguity[o] = opInfo.getContiguity(inner);
+        divisibility[o] = opInfo.getDivisibility(inner);
+        int64_t innerElems = 1;
+        for (int d = inner; d >= i; --d) {
+          constancy[o] = innerElems * opInfo.getConstancy(d);
+          if (opInfo.getConstancy(d) != srcShape[d])
+            break;
+          innerElems *= srcShape[d];
+        }
+      }
+      i = iEnd;
+      o = oEnd;
+    }
+    return AxisInfo(contiguity, divisibility, constancy,
+                    opInfo.getConstantValue());
+  }
+};
+
+class JoinOpAxisInfoVisitor final
+    : public AxisInfoVisitorImpl<triton::JoinOp> {
+public:
+  using AxisInfoVisitorImpl<triton::JoinOp>::AxisInfoVisitorImpl;
+
+  AxisInfo
+  getAxisInfo(triton::JoinOp op,
+              ArrayRef<const dataflow::Lattice<AxisInfo> *> operands) override {
+    AxisInfo lhsInfo = operands[0]->getValue();
+    AxisInfo rhsInfo = operands[1]->getValue();
+    AxisInfo::DimVectorT contiguity;
+    AxisInfo::DimVectorT divisibility;
+    AxisInfo::DimVectorT constancy;
+    for (int d = 0; d < lhsInfo.getRank(); ++d) {
+      contiguity.push_back(
+          gcd(lhsInfo.getContiguity(d), rhsInfo.getContiguity(d)));
+      divisibility.push_back(
+          gcd(lhsInfo.getDivisibility(d), rhsInfo.getDivisibility(d)));
+      constancy.push_back(
+          gcd(lhsInfo.getConstancy(d), rhsInfo.getConstancy(d)));
+    }
+    // The new minor dimension interleaves lhs and rhs.
+    std::optional<int64_t> constantValue;
+    if (lhsInfo.getConstantValue().has_value() &&
+        lhsInfo.getConstantValue() == rhsInfo.getConstantValue())
+      constantValue = lhsInfo.getConstantValue();
+    contiguity.push_back(1);
+    divisibility.push_back(gcd(getElementDivisibility(lhsInfo),
+                               getElementDivisibility(rhsInfo)));
+    constancy.push_back(constantValue.has_value() ? 2 : 1);
+    return AxisInfo(contiguity, divisibility, constancy, constantValue);
+  }
+};
+
+class SplitOpAxisInfoVisitor final
+    : public AxisInfoVisitorImpl<triton::SplitOp> {
+public:
+  using AxisInfoVisitorImpl<triton::SplitOp>::AxisInfoVisitorImpl;
+
+  AxisInfo
+  getAxisInfo(triton::SplitOp op,
+              ArrayRef<const dataflow::Lattice<AxisInfo> *> operands) override {
+    // Both halves are slices along the minor dimension, so they inherit the
+    // properties of all the other dimensions.
+    AxisInfo opInfo = operands[0]->getValue();
+    AxisInfo::DimVectorT contiguity = opInfo.getContiguity();
+    AxisInfo::DimVectorT divisibility = opInfo.getDivisibility();
+    AxisInfo::DimVectorT constancy = opInfo.getConstancy();
+    contiguity.pop_back();
+    divisibility.pop_back();
+    constancy.pop_back();
+    return AxisInfo(contiguity, divisibility, constancy,
+                    opInfo.getConstantValue());
+  }
+};
+
 template <typename OpTy>
 class CmpOpAxisInfoVisitor final : public AxisInfoVisitorImpl<OpTy> {
 public:
@@ -1011,6 +1155,7 @@ AxisInfoAnalysis::AxisInfoAnalysis(DataFlowSolver &solver)
   // TODO: Remove rules for LLVM::ConstantOp, LLVM::AddOp
   // when scf.for supports integer induction variables
   visitors.append<MakeRangeOpAxisInfoVisitor>();
+  visitors.append<GlobalScratchAllocOpAxisInfoVisitor>();
   visitors.append<ConstantOpAxisInfoVisitor<arith::ConstantOp>,
                   ConstantOpAxisInfoVisitor<LLVM::ConstantOp>>();
   visitors.append<AddSubOpAxisInfoVisitor<triton::AddPtrOp>,
@@ -1025,6 +1170,8 @@ AxisInfoAnalysis::AxisInfoAnalysis(DataFlowSolver &solver)
   visitors.append<BroadcastOpAxisInfoVisitor>();
   visitors.append<SplatOpAxisInfoVisitor>();
   visitors.append<ExpandDimsOpAxisInfoVisitor>();
+  visitors.append<ReshapeOpAxisInfoVisitor, JoinOpAxisInfoVisitor,
+                  SplitOpAxisInfoVisitor>();
   visitors.append<CmpOpAxisInfoVisitor<arith::CmpIOp>>();
   visitors.append<LogicalOpAxisInfoVisitor<arith::AndIOp>,
                   LogicalOpAxisInfoVisitor<arith::OrIOp>,
@@ -1310,8 +1457,29 @@ void ModuleAxisInfoAnalysis::update(CallOpInterface callOp,
                                    gcd(prevValue, curValue));
       callee.setArgAttr(index, attrName, attr);
     };
+    // Tensors of rank > 1 get a value per dimension.
+    auto setDenseAttrFn = [&](StringRef attrName,
+                              const AxisInfo::DimVectorT &prevValues) {
+      auto attr = callee.getArgAttrOfType<DenseElementsAttr>(index, attrName);
+      SmallVector<int32_t> values;
+      for (auto [dim, prevValue] : llvm::enumerate(prevValues)) {
+        int32_t curValue = attr ? attr.getValues<int32_t>()[dim]
+                                : highestPowOf2Divisor<int32_t>(0);
+        values.push_back(gcd(prevValue, curValue));
+      }
+      auto attrTy = RankedTensorType::get(
+          {static_cast<int64_t>(values.size())},
+          IntegerType::get(callee.getContext(), 32));
+      callee.setArgAttr(index, attrName,
+                        DenseElementsAttr::get(attrTy, ArrayRef(values)));
+    };
     auto axisInfo = axisInfoMap->lookup(value);
-    assert(axisInfo.getRank() == 1 && "only scalar arguments are supported");
+    if (axisInfo.getRank() > 1) {
+      setDenseAttrFn("tt.contiguity", axisInfo.getContiguity());
+      setDenseAttrFn("tt.divisibility", axisInfo.getDivisibility());
+      setDenseAttrFn("tt.constancy", axisInfo.getConstancy());
+      continue;
+    }
     setAttrFn("tt.contiguity", axisInfo.getContiguity(0));
     setAttrFn("tt.divisibility", axisInfo.getDivisibility(0));
     setAttrFn("tt.constancy", axisInfo.getConstancy(0));
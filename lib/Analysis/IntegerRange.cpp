@@ -0,0 +1,102 @@
+#include "triton/Analysis/IntegerRange.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/TypeUtilities.h"
+#include "mlir/Interfaces/FunctionInterfaces.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+
+#include <limits>
+
+namespace mlir::triton {
+
+namespace {
+
+// Returns the bit width of the integer elements of `type`, or 0.
+unsigned getBitWidth(Type type) {
+  Type elemTy = getElementTypeOrSelf(type);
+  if (!elemTy.isIntOrIndex())
+    return 0;
+  return ConstantIntRanges::getStorageBitwidth(elemTy);
+}
+
+// Returns the range of the `width`-bit result of `op` if it is one of the ops
+// the analysis of MLIR doesn't know.
+std::optional<ConstantIntRanges> inferRange(Operation *op, unsigned width) {
+  auto signedRange = [&](int64_t min, int64_t max) {
+    return ConstantIntRanges::fromSigned(APInt(width, min, true),
+                                         APInt(width, max, true));
+  };
+  // The grid has less than 2^31 programs along each axis.
+  if (isa<GetProgramIdOp>(op))
+    return signedRange(0, std::numeric_limits<int32_t>::max() - 1);
+  if (isa<GetNumProgramsOp>(op))
+    return signedRange(1, std::numeric_limits<int32_t>::max());
+  if (auto makeRange = dyn_cast<MakeRangeOp>(op))
+    return signedRange(makeRange.getStartAttr().getInt(),
+                       makeRange.getEndAttr().getInt() - 1);
+  if (auto constant = dyn_cast<arith::ConstantOp>(op)) {
+    auto values = dyn_cast<DenseIntElementsAttr>(constant.getValue());
+    if (!values)
+      return std::nullopt;
+    std::optional<ConstantIntRanges> range;
+    for (APInt value : values.getValues<APInt>()) {
+      auto valueRange = ConstantIntRanges::constant(value);
+      range = range ? range->rangeUnion(valueRange) : valueRange;
+    }
+    return range;
+  }
+  return std::nullopt;
+}
+
+} // namespace
+
+void TritonIntegerRangeAnalysis::setToEntryState(
+    dataflow::IntegerValueRangeLattice *lattice) {
+  auto arg = dyn_cast<BlockArgument>(lattice->getPoint());
+  unsigned width = arg ? getBitWidth(arg.getType()) : 0;
+  auto func = width != 0 && arg.getOwner()->isEntryBlock()
+                  ? dyn_cast<FunctionOpInterface>(arg.getOwner()->getParentOp())
+                  : nullptr;
+  if (!func || width < 32)
+    return dataflow::IntegerRangeAnalysis::setToEntryState(lattice);
+  unsigned argNo = arg.getArgNumber();
+  auto min = func.getArgAttrOfType<IntegerAttr>(argNo, "tt.min_value");
+  auto max = func.getArgAttrOfType<IntegerAttr>(argNo, "tt.max_value");
+  if (!min && !max)
+    return dataflow::IntegerRangeAnalysis::setToEntryState(lattice);
+  APInt smin = min ? APInt(width, min.getInt(), true)
+                   : APInt::getSignedMinValue(width);
+  APInt smax = max ? APInt(width, max.getInt(), true)
+                   : APInt::getSignedMaxValue(width);
+  propagateIfChanged(lattice, lattice->join(IntegerValueRange(
+                                  ConstantIntRanges::fromSigned(smin, smax))));
+}
+
+void TritonIntegerRangeAnalysis::visitOperation(
+    Operation *op,
+    ArrayRef<const dataflow::IntegerValueRangeLattice *> operands,
+    ArrayRef<dataflow::IntegerValueRangeLattice *> results) {
+  unsigned width =
+      op->getNumResults() == 1 ? getBitWidth(op->getResult(0).getType()) : 0;
+  if (width != 0 &&
+      isa<SplatOp, BroadcastOp, ExpandDimsOp, ReshapeOp, TransOp>(op)) {
+    const IntegerValueRange &src = operands[0]->getValue();
+    if (!src.isUninitialized())
+      propagateIfChanged(results[0], results[0]->join(src));
+    return;
+  }
+  if (width != 0)
+    if (std::optional<ConstantIntRanges> range = inferRange(op, width))
+      return propagateIfChanged(
+          results[0], results[0]->join(IntegerValueRange(*range)));
+  dataflow::IntegerRangeAnalysis::visitOperation(op, operands, results);
+}
+
+std::optional<ConstantIntRanges> getIntegerRange(DataFlowSolver &solver,
+                                                 Value value) {
+  auto *lattice = solver.lookupState<dataflow::IntegerValueRangeLattice>(value);
+  if (!lattice || lattice->getValue().isUninitialized())
+    return std::nullopt;
+  return lattice->getValue().getValue();
+}
+
+} // namespace mlir::triton
@@ -1,10 +1,12 @@
 #include "triton/Analysis/Membar.h"
 #include "triton/Analysis/Alias.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Tools/Sys/GetEnv.hpp"
 
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/GPU/IR/GPUDialect.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/Matchers.h"
 #include "mlir/Interfaces/ControlFlowInterfaces.h"
 #include <deque>
 
@@ -14,7 +16,65 @@ void MembarAnalysis::run(FuncBlockInfoMapT &funcBlockInfoMap) {
   FunctionOpInterface funcOp =
       dyn_cast<FunctionOpInterface>(allocation->getOperation());
   OpBuilder builder(funcOp.getContext());
+  report = triton::tools::getBoolEnv("TRITON_MEMBAR_REPORT");
   resolve(funcOp, &funcBlockInfoMap, &builder);
+  if (report)
+    funcOp.emitRemark() << numBarriers << " shared memory barrier(s) inserted";
+}
+
+Interval<size_t>
+MembarAnalysis::getAccessedInterval(Value value,
+                                    Allocation::BufferId bufferId) const {
+  auto interval = allocation->getAllocatedInterval(bufferId);
+  // Only a slice of the outermost dimension of the allocation itself, taken at
+  // a constant index, is known to cover a contiguous range of bytes.
+  auto subview = value.getDefiningOp<triton::gpu::MemDescSubviewOp>();
+  if (!subview || allocation->getBufferId(subview.getSrc()) != bufferId)
+    return interval;
+  auto srcTy = subview.getSrc().getType();
+  auto dstTy = subview.getType();
+  auto sharedEnc =
+      dyn_cast<triton::gpu::SharedEncodingAttr>(srcTy.getEncoding());
+  if (!sharedEnc || srcTy.getRank() != dstTy.getRank() + 1 ||
+      srcTy.getShape().drop_front() != dstTy.getShape())
+    return interval;
+  // Multi-buffers created by the pipeliner carry the order of a single
+  // buffer; the lowering then makes the leading dimension the slowest one.
+  auto order = sharedEnc.getOrder();
+  if (order.size() == srcTy.getRank() ? order.back() != 0
+                                      : order.size() + 1 != srcTy.getRank())
+    return interval;
+  auto offsets = subview.getOffsets();
+  APInt index;
+  if (!matchPattern(offsets.front(), m_ConstantInt(&index)))
+    return interval;
+  for (Value offset : offsets.drop_front()) {
+    APInt zero;
+    if (!matchPattern(offset, m_ConstantInt(&zero)) || !zero.isZero())
+      return interval;
+  }
+  size_t sliceBytes = product<int64_t>(dstTy.getShape()) *
+                      dstTy.getElementTypeBitWidth() / 8;
+  size_t start = interval.start() + index.getZExtValue() * sliceBytes;
+  if (start + sliceBytes > interval.end())
+    return interval;
+  return Interval<size_t>(start, start + sliceBytes);
+}
+
+void MembarAnalysis::reportBarrier(Operation *op,
+                                   const BlockInfo::Conflict &conflict) {
+  ++numBarriers;
+  if (!report)
+    return;
+  auto diag = op->emitRemark()
+              << "shared memory barrier inserted: " << conflict.kind
+              << " hazard on [" << conflict.otherInterval.start() << ", "
+              << conflict.otherInterval.end() << ") with a pending access to ["
+              << conflict.interval.start() << ", " << conflict.interval.end()
+              << ")";
+  if (conflict.op)
+    diag.attachNote(conflict.op->getLoc())
+        << "conflicting access by " << conflict.op->getName();
 }
 
 void MembarAnalysis::resolve(FunctionOpInterface funcOp,
@@ -92,27 +152,108 @@ void MembarAnalysis::visitTerminator(Operation *op,
   llvm_unreachable("Unknown terminator encountered in membar analysis");
 }
 
-void MembarAnalysis::insertBarrier(Operation *op, OpBuilder *builder) {
+// bar.sync supports 16 barriers per CTA; id 0 is used by CTA-wide barriers.
+constexpr unsigned kNumNamedBarriers = 16;
+
+std::optional<MembarAnalysis::WarpGroup>
+MembarAnalysis::getWarpGroup(Operation *op) {
+  auto attrName = triton::gpu::TritonGPUDialect::getWarpGroupAttrName();
+  for (; op; op = op->getParentOp()) {
+    auto group = op->getAttrOfType<DenseI32ArrayAttr>(attrName);
+    if (group && group.size() == 2)
+      return WarpGroup(group[0], group[1]);
+  }
+  return std::nullopt;
+}
+
+std::optional<unsigned> MembarAnalysis::getNamedBarrierId(WarpGroup group) {
+  auto it = namedBarrierIds.find(group);
+  if (it != namedBarrierIds.end())
+    return it->second;
+  unsigned id = namedBarrierIds.size() + 1;
+  if (id >= kNumNamedBarriers)
+    return std::nullopt;
+  namedBarrierIds[group] = id;
+  return id;
+}
+
+bool MembarAnalysis::insertBarrier(Operation *op, OpBuilder *builder,
+                                   std::optional<WarpGroup> group) {
   OpBuilder::InsertionGuard g(*builder);
   auto barrierOp = builder->create<gpu::BarrierOp>(op->getLoc());
+  if (!group)
+    return false;
+  auto mod = op->getParentOfType<ModuleOp>();
+  int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
+  // A group spanning all warps is better served by a CTA-wide barrier.
+  if (group->first == 0 && group->second == numWarps)
+    return false;
+  auto barId = getNamedBarrierId(*group);
+  if (!barId)
+    return false;
+  int threadsPerWarp = triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+  barrierOp->setAttr("bar_id", builder->getI32IntegerAttr(*barId));
+  barrierOp->setAttr("num_threads", builder->getI32IntegerAttr(
+                                         group->second * threadsPerWarp));
+  barrierOp->setAttr(
+      triton::gpu::TritonGPUDialect::getWarpGroupAttrName(),
+      builder->getDenseI32ArrayAttr({group->first, group->second}));
+  return true;
+}
+
+void MembarAnalysis::insertBarrierAndSync(Operation *op, BlockInfo *blockInfo,
+                                          const BlockInfo &curBlockInfo,
+                                          OpBuilder *builder) {
+  auto group = getWarpGroup(op);
+  auto inGroup = [&](Operation *other) {
+    return group && getWarpGroup(other) == group;
+  };
+  // A named barrier is enough if no access of another group (or of all warps)
+  // is left to conflict with once the accesses of `group` are synced.
+  BlockInfo otherGroupsInfo = *blockInfo;
+  otherGroupsInfo.sync(inGroup);
+  if (group && !otherGroupsInfo.isIntersected(curBlockInfo) &&
+      insertBarrier(op, builder, group)) {
+    blockInfo->sync(inGroup);
+    return;
+  }
+  insertBarrier(op, builder);
+  blockInfo->sync();
 }
 
 void MembarAnalysis::update(Operation *op, BlockInfo *blockInfo,
                             FuncBlockInfoMapT *funcBlockInfoMap,
                             OpBuilder *builder) {
   if (isa<gpu::BarrierOp>(op)) {
-    // If the current op is a barrier, we sync previous reads and writes
-    blockInfo->sync();
+    // If the current op is a barrier, we sync previous reads and writes. A
+    // named barrier only syncs the accesses of its group of warps.
+    if (!op->hasAttr("bar_id")) {
+      blockInfo->sync();
+      return;
+    }
+    auto group = getWarpGroup(op);
+    blockInfo->sync([&](Operation *other) {
+      return group && getWarpGroup(other) == group;
+    });
     return;
   }
 
   if (isa<triton::gpu::AsyncWaitOp>(op) &&
       !isa<gpu::BarrierOp>(op->getNextNode())) {
     // If the current op is an async wait and the next op is not a barrier we
-    // insert a barrier op and sync
+    // insert a barrier op and sync. The wait only covers the copies of the
+    // warps executing it, so the barrier doesn't need to cover more of them.
     builder->setInsertionPointAfter(op);
-    insertBarrier(op, builder);
-    blockInfo->sync();
+    auto group = getWarpGroup(op);
+    if (insertBarrier(op, builder, group))
+      blockInfo->sync([&](Operation *other) {
+        return getWarpGroup(other) == group;
+      });
+    else
+      blockInfo->sync();
+    ++numBarriers;
+    if (report)
+      op->emitRemark() << "shared memory barrier inserted after async wait";
     return;
   }
 
@@ -134,12 +275,11 @@ void MembarAnalysis::update(Operation *op, BlockInfo *blockInfo,
         if (auto value = effectInstance.getValue()) {
           for (auto bufferId : allocation->getBufferIds(value)) {
             if (bufferId != Allocation::InvalidBufferId) {
+              auto interval = getAccessedInterval(value, bufferId);
               if (isa<MemoryEffects::Write>(effectInstance.getEffect()))
-                curBlockInfo.syncWriteIntervals.insert(
-                    allocation->getAllocatedInterval(bufferId));
+                curBlockInfo.syncWriteIntervals[interval].insert(op);
               else if (isa<MemoryEffects::Read>(effectInstance.getEffect()))
-                curBlockInfo.syncReadIntervals.insert(
-                    allocation->getAllocatedInterval(bufferId));
+                curBlockInfo.syncReadIntervals[interval].insert(op);
             }
           }
         }
@@ -148,17 +288,19 @@ void MembarAnalysis::update(Operation *op, BlockInfo *blockInfo,
     // Scratch buffer is considered as both shared memory write & read
     auto bufferId = allocation->getBufferId(op);
     if (bufferId != Allocation::InvalidBufferId) {
-      curBlockInfo.syncWriteIntervals.insert(
-          allocation->getAllocatedInterval(bufferId));
-      curBlockInfo.syncReadIntervals.insert(
-          allocation->getAllocatedInterval(bufferId));
+      curBlockInfo.syncWriteIntervals[allocation->getAllocatedInterval(
+                                          bufferId)]
+          .insert(op);
+      curBlockInfo.syncReadIntervals[allocation->getAllocatedInterval(
+                                         bufferId)]
+          .insert(op);
     }
   }
 
-  if (blockInfo->isIntersected(curBlockInfo)) {
+  if (auto conflict = blockInfo->getConflict(curBlockInfo)) {
     builder->setInsertionPoint(op);
-    insertBarrier(op, builder);
-    blockInfo->sync();
+    insertBarrierAndSync(op, blockInfo, curBlockInfo, builder);
+    reportBarrier(op, *conflict);
   }
   // Update the region info, even if barrier is inserted, we have to maintain
   // the current op's read/write buffers.
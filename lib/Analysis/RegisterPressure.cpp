@@ -0,0 +1,102 @@
+#include "triton/Analysis/RegisterPressure.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/TypeUtilities.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/IR/Utility.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+
+namespace mlir {
+
+namespace ttg = triton::gpu;
+
+unsigned RegisterPressureAnalysis::getNumRegisters(Type type) {
+  auto getNumBits = [](Type elemTy) -> unsigned {
+    if (isa<triton::PointerType>(elemTy))
+      return 64;
+    if (elemTy.isIntOrFloat())
+      return elemTy.getIntOrFloatBitWidth();
+    if (elemTy.isIndex())
+      return 64;
+    return 0;
+  };
+  auto tensorTy = dyn_cast<RankedTensorType>(type);
+  if (!tensorTy)
+    return ceil<unsigned>(getNumBits(type), 32);
+  // Tensors without a distributed layout are not held in registers.
+  if (!isa_and_nonnull<ttg::DistributedEncodingTrait>(tensorTy.getEncoding()))
+    return 0;
+  unsigned numElems = ttg::getTotalElemsPerThread(tensorTy);
+  // Pointers to the elements a thread holds contiguously are addressed with
+  // immediate offsets from the first one.
+  if (isa<triton::PointerType>(tensorTy.getElementType())) {
+    Attribute layout = tensorTy.getEncoding();
+    unsigned contig = ttg::getUniqueContigPerThread(
+        layout, tensorTy.getShape())[ttg::getOrder(layout)[0]];
+    numElems = ceil<unsigned>(numElems, contig);
+  }
+  return ceil<unsigned>(numElems * getNumBits(tensorTy.getElementType()), 32);
+}
+
+unsigned RegisterPressureAnalysis::getRegisterLimit(ModuleOp mod) {
+  unsigned numThreads = ttg::TritonGPUDialect::getNumWarps(mod) *
+                        ttg::TritonGPUDialect::getThreadsPerWarp(mod);
+  return std::min(kMaxRegistersPerThread, kRegisterFileSize / numThreads);
+}
+
+unsigned RegisterPressureAnalysis::getNumRegisters(Value value) const {
+  // A tensor splatted from a scalar takes the registers of the scalar.
+  Operation *def = value.getDefiningOp();
+  SplatElementsAttr splatAttr;
+  if (isa_and_nonnull<triton::SplatOp>(def) ||
+      matchPattern(value, m_Constant(&splatAttr)))
+    return getNumRegisters(getElementTypeOrSelf(value.getType()));
+  return getNumRegisters(value.getType());
+}
+
+RegisterPressureAnalysis::RegisterPressureAnalysis(FunctionOpInterface funcOp)
+    : liveness(funcOp) {
+  funcMaxLiveRegisters = visitRegion(funcOp.getFunctionBody(), {});
+}
+
+unsigned
+RegisterPressureAnalysis::visitRegion(Region &region,
+                                      const DenseSet<Value> &outerLive) {
+  unsigned maxRegs = 0;
+  for (Block &block : region) {
+    const LivenessBlockInfo *info = liveness.getLiveness(&block);
+    for (Operation &op : block) {
+      // Values live across `op`, which stay live in its regions.  The
+      // registers of the operands `op` consumes are reused for its results.
+      DenseSet<Value> live = outerLive;
+      for (Value v : info->currentlyLiveValues(&op))
+        if (v.getDefiningOp() != &op && !liveness.isDeadAfter(v, &op))
+          live.insert(v);
+
+      unsigned opMaxRegs = 0;
+      for (Region &nested : op.getRegions())
+        opMaxRegs = std::max(opMaxRegs, visitRegion(nested, live));
+
+      unsigned regs = 0;
+      for (Value v : live)
+        regs += getNumRegisters(v);
+      for (Value result : op.getResults())
+        regs += getNumRegisters(result);
+      liveRegisters[&op] = regs;
+      opMaxRegs = std::max(opMaxRegs, regs);
+      maxLiveRegisters[&op] = opMaxRegs;
+      maxRegs = std::max(maxRegs, opMaxRegs);
+    }
+  }
+  return maxRegs;
+}
+
+unsigned estimateMaxLiveRegisters(ModuleOp mod) {
+  unsigned maxRegs = 0;
+  mod.walk([&](FunctionOpInterface funcOp) {
+    RegisterPressureAnalysis analysis(funcOp);
+    maxRegs = std::max(maxRegs, analysis.getMaxLiveRegisters());
+  });
+  return maxRegs;
+}
+
+} // namespace mlir
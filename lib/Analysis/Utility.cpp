@@ -17,6 +17,7 @@
 #include "triton/Dialect/TritonNvidiaGPU/IR/Dialect.h"
 #include "triton/Tools/LinearLayout.h"
 #include "triton/Tools/Sys/GetEnv.hpp"
+#include "llvm/ADT/bit.h"
 
 namespace mlir {
 namespace {
@@ -185,9 +186,16 @@ SmallVector<unsigned> ReduceOpHelper::getScratchConfig() {
 }
 
 unsigned ReduceOpHelper::getScratchSizeInBytes() {
+  if (!isReduceWithinCTA())
+    return getCrossCTAOffsets().back();
+
   auto smemShape = getScratchConfig();
   auto elems = product<unsigned>(smemShape);
 
+  unsigned vec = getSmemVectorSize();
+  if (vec > 1)
+    return vec * srcElementTypes[0].getIntOrFloatBitWidth() / 8 * elems;
+
   unsigned bytesPerElem = 0;
   for (const auto &ty : srcElementTypes) {
     bytesPerElem += ceil<unsigned>(ty.getIntOrFloatBitWidth(), 8);
@@ -195,6 +203,56 @@ unsigned ReduceOpHelper::getScratchSizeInBytes() {
   return bytesPerElem * elems;
 }
 
+unsigned ReduceOpHelper::getNumCTAsAlongAxis() {
+  return getCTASplitNum(getSrcLayout())[axis];
+}
+
+unsigned ReduceOpHelper::getResultElemsPerCTA() {
+  auto shapePerCTA = getShapePerCTA(getSrcLayout(), getSrcShape());
+  shapePerCTA.erase(shapePerCTA.begin() + axis);
+  return product<int64_t>(shapePerCTA);
+}
+
+SmallVector<unsigned> ReduceOpHelper::getCrossCTAOffsets() {
+  auto smemShape = getScratchConfig();
+  unsigned elems = product<unsigned>(smemShape);
+  unsigned bytesPerElem = 0;
+  for (const auto &ty : srcElementTypes)
+    bytesPerElem += ceil<unsigned>(ty.getIntOrFloatBitWidth(), 8);
+  unsigned vec = getSmemVectorSize();
+  if (vec > 1)
+    bytesPerElem = vec * srcElementTypes[0].getIntOrFloatBitWidth() / 8;
+  // The buffers follow the buffer of the reduction within the CTA, as the
+  // other CTAs may write into them while it is in use.
+  SmallVector<unsigned> offsets;
+  unsigned offset = llvm::alignTo(bytesPerElem * elems, 16);
+  unsigned slots = getNumCTAsAlongAxis() * getResultElemsPerCTA();
+  for (const auto &ty : srcElementTypes) {
+    offsets.push_back(offset);
+    offset += llvm::alignTo(
+        slots * ceil<unsigned>(ty.getIntOrFloatBitWidth(), 8), 16);
+  }
+  offsets.push_back(offset);
+  return offsets;
+}
+
+unsigned ReduceOpHelper::getSmemVectorSize() {
+  unsigned numOperands = srcElementTypes.size();
+  if (numOperands == 1 || !srcElementTypes[0].isIntOrFloat())
+    return 1;
+  unsigned bitWidth = srcElementTypes[0].getIntOrFloatBitWidth();
+  for (Type ty : srcElementTypes) {
+    if (!ty.isIntOrFloat() || ty.getIntOrFloatBitWidth() != bitWidth)
+      return 1;
+  }
+  // Vector accesses of shared memory have a power of two number of elements
+  // and up to 128 bits.
+  unsigned vec = llvm::PowerOf2Ceil(numOperands);
+  if (bitWidth < 8 || vec * bitWidth > 128)
+    return 1;
+  return vec;
+}
+
 bool ReduceOpHelper::isReduceWithinCTA() {
   auto axis = getAxis();
   auto srcLayout = getSrcLayout();
@@ -204,12 +262,8 @@ bool ReduceOpHelper::isReduceWithinCTA() {
 }
 
 bool ReduceOpHelper::isSupportedLayout() {
-  // Layout optimization passes such as PlanCTAPass and
-  // RemoveLayoutConversionPass should avoid cross-CTA reduction
-  if (!isReduceWithinCTA()) {
-    return false;
-  }
-
+  // The reductions across the CTAs of a cluster go through distributed
+  // shared memory, once each CTA has reduced its part of the axis.
   auto srcLayout = getSrcLayout();
   if (isa<BlockedEncodingAttr>(srcLayout)) {
     return true;
@@ -321,6 +375,233 @@ unsigned ScanLoweringHelper::getScratchSizeInBytes() {
   return elementSizeInBytes * getScratchSizeInElems();
 }
 
+namespace {
+
+// The bases of a linear map over GF(2) in reduced row echelon form. Each row
+// pairs a vector of the image of the map, packed in an integer, with the
+// inputs whose images sum to it. No two rows share their leading bit.
+class ReducedBases {
+public:
+  explicit ReducedBases(ArrayRef<uint64_t> images) {
+    for (auto [i, image] : llvm::enumerate(images)) {
+      uint64_t comb = 1ull << i;
+      uint64_t vec = reduce(image, comb);
+      if (vec == 0)
+        continue;
+      uint64_t lead = leadingBit(vec);
+      for (auto &[rowVec, rowComb] : rows) {
+        if (rowVec & lead) {
+          rowVec ^= vec;
+          rowComb ^= comb;
+        }
+      }
+      rows.push_back({vec, comb});
+    }
+  }
+
+  bool contains(uint64_t vec) const {
+    uint64_t comb = 0;
+    return reduce(vec, comb) == 0;
+  }
+
+  // Returns the inputs whose images sum to `vec`, which must be in the image.
+  uint64_t solve(uint64_t vec) const {
+    uint64_t comb = 0;
+    reduce(vec, comb);
+    return comb;
+  }
+
+private:
+  static uint64_t leadingBit(uint64_t vec) {
+    return 1ull << (63 - llvm::countl_zero(vec));
+  }
+
+  uint64_t reduce(uint64_t vec, uint64_t &comb) const {
+    for (auto [rowVec, rowComb] : rows) {
+      if (vec & leadingBit(rowVec)) {
+        vec ^= rowVec;
+        comb ^= rowComb;
+      }
+    }
+    return vec;
+  }
+
+  SmallVector<std::pair<uint64_t, uint64_t>> rows;
+};
+
+// Packs the coordinates `coords` of a tensor of shape `shape` in a single
+// integer, with the bits of the first dimension in the lowest bits. Skips the
+// dimension `skipDim`, if any.
+uint64_t packCoords(ArrayRef<int64_t> shape,
+                    ArrayRef<std::pair<StringAttr, int32_t>> coords,
+                    int skipDim = -1) {
+  uint64_t packed = 0;
+  unsigned shift = 0;
+  for (auto [dim, coord] : llvm::enumerate(llvm::make_second_range(coords))) {
+    if (static_cast<int>(dim) != skipDim)
+      packed |= static_cast<uint64_t>(coord) << shift;
+    shift += llvm::Log2_64(shape[dim]);
+  }
+  return packed;
+}
+
+// Returns the images of the register and lane bases of `layout`, packed as by
+// packCoords, with the register bases first.
+SmallVector<uint64_t> getWarpLocalBases(const LinearLayout &layout,
+                                        ArrayRef<int64_t> shape,
+                                        int skipDim = -1) {
+  MLIRContext *ctx = layout.getInDimNames().begin()->getContext();
+  SmallVector<uint64_t> images;
+  for (StringRef inDim : {"register", "lane"}) {
+    StringAttr kInDim = StringAttr::get(ctx, inDim);
+    for (int i = 0; i < layout.getInDimSizeLog2(kInDim); ++i) {
+      SmallVector<std::pair<StringAttr, int32_t>> coords;
+      for (auto [outDim, basis] :
+           llvm::zip(layout.getOutDimNames(), layout.getBasis(kInDim, i)))
+        coords.push_back({outDim, basis});
+      images.push_back(packCoords(shape, coords, skipDim));
+    }
+  }
+  return images;
+}
+
+} // namespace
+
+namespace {
+// Bins counted by each lane with warp ballots, beyond which counting the bins
+// with shared memory atomics is cheaper.
+constexpr unsigned kMaxBallotBinsPerLane = 16;
+// Scratch used by the copies of the bins counted with atomics.
+constexpr unsigned kMaxHistogramScratchBytes = 32 * 1024;
+} // namespace
+
+HistogramLoweringHelper::HistogramLoweringHelper(
+    triton::HistogramOp histogramOp)
+    : histogramOp(histogramOp) {
+  auto mod = histogramOp->getParentOfType<ModuleOp>();
+  numBins = histogramOp.getType().getNumElements();
+  threadsPerWarp = triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+  numBinsPerPass = numBins;
+  if (usesWarpBallots())
+    return;
+  // Give each warp its own copy of the bins when they fit, to spread the
+  // atomics, or else as many copies as fit. Bins that do not fit even once
+  // are counted in several passes.
+  unsigned numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
+  unsigned maxBins = kMaxHistogramScratchBytes / 4;
+  while (numPrivateCopies * 2 <= numWarps &&
+         numPrivateCopies * 2 * numBins <= maxBins)
+    numPrivateCopies *= 2;
+  numBinsPerPass = std::min(numBins, maxBins);
+}
+
+bool HistogramLoweringHelper::usesWarpBallots() const {
+  return !histogramOp.getWeights() && llvm::isPowerOf2_32(numBins) &&
+         numBins <= kMaxBallotBinsPerLane * threadsPerWarp;
+}
+
+unsigned HistogramLoweringHelper::getNumPasses() const {
+  return ceil<unsigned>(numBins, numBinsPerPass);
+}
+
+unsigned HistogramLoweringHelper::getScratchSizeInBytes() const {
+  // The ballots pad the bins out to at least one per lane.
+  if (usesWarpBallots())
+    return std::max(numBins, threadsPerWarp) * 4;
+  return numPrivateCopies * numBinsPerPass * 4;
+}
+
+unsigned GatherLoweringHelper::getScratchSizeInBytes() {
+  // The warp-local lowering does not need shared memory.
+  if (isWarpLocal())
+    return 0;
+  // Otherwise, the whole input is stored to shared memory.
+  RankedTensorType srcType = gatherOp.getSrc().getType();
+  unsigned bitWidth = isa<triton::PointerType>(srcType.getElementType())
+                          ? 64
+                          : srcType.getElementTypeBitWidth();
+  return srcType.getNumElements() * ceil<unsigned>(bitWidth, 8);
+}
+
+bool GatherLoweringHelper::isWarpLocal() {
+  RankedTensorType srcType = gatherOp.getSrc().getType();
+  RankedTensorType idxType = gatherOp.getIndices().getType();
+  std::optional<LinearLayout> srcLayout =
+      toLinearLayout(srcType.getShape(), srcType.getEncoding());
+  std::optional<LinearLayout> idxLayout =
+      toLinearLayout(idxType.getShape(), idxType.getEncoding());
+  if (!srcLayout || !idxLayout)
+    return false;
+
+  MLIRContext *ctx = gatherOp.getContext();
+  StringAttr kBlock = StringAttr::get(ctx, "block");
+  StringAttr kWarp = StringAttr::get(ctx, "warp");
+  unsigned axis = gatherOp.getAxis();
+  StringAttr kGatherDim = StringAttr::get(ctx, "dim" + std::to_string(axis));
+  SmallVector<StringAttr> otherDims;
+  for (unsigned dim = 0; dim < srcType.getRank(); ++dim) {
+    if (dim != axis)
+      otherDims.push_back(StringAttr::get(ctx, "dim" + std::to_string(dim)));
+  }
+
+  // Moving across the warps or blocks must not move along the gather axis,
+  // and must move along the other dimensions the same way for the input and
+  // for the indices.
+  if (!srcLayout->sublayoutIsZero({kBlock, kWarp}, {kGatherDim}) ||
+      !idxLayout->sublayoutIsZero({kBlock, kWarp}, {kGatherDim}))
+    return false;
+  if (srcLayout->sublayout({kBlock, kWarp}, otherDims) !=
+      idxLayout->sublayout({kBlock, kWarp}, otherDims))
+    return false;
+
+  // Then, within a warp, the registers and lanes of the input must hold the
+  // whole gather axis at every coordinate of the other dimensions that the
+  // registers and lanes of the indices hold.
+  ArrayRef<int64_t> shape = srcType.getShape();
+  ReducedBases srcBases(getWarpLocalBases(*srcLayout, shape));
+  uint64_t axisShift = 0;
+  for (unsigned dim = 0; dim < axis; ++dim)
+    axisShift += llvm::Log2_64(shape[dim]);
+  for (unsigned i = 0; i < llvm::Log2_64(shape[axis]); ++i) {
+    if (!srcBases.contains(1ull << (axisShift + i)))
+      return false;
+  }
+  for (uint64_t image : getWarpLocalBases(*idxLayout, shape, axis)) {
+    if (!srcBases.contains(image))
+      return false;
+  }
+  return true;
+}
+
+LinearLayout GatherLoweringHelper::getWarpLocalSourceLayout() {
+  assert(isWarpLocal() && "the gather is not warp-local");
+  RankedTensorType srcType = gatherOp.getSrc().getType();
+  ArrayRef<int64_t> shape = srcType.getShape();
+  LinearLayout srcLayout = *toLinearLayout(shape, srcType.getEncoding());
+  MLIRContext *ctx = gatherOp.getContext();
+  StringAttr kRegister = StringAttr::get(ctx, "register");
+  StringAttr kLane = StringAttr::get(ctx, "lane");
+  int regBits = srcLayout.getInDimSizeLog2(kRegister);
+
+  ReducedBases srcBases(getWarpLocalBases(srcLayout, shape));
+  LinearLayout::BasesT bases;
+  unsigned shift = 0;
+  for (auto [dim, outDim] : llvm::enumerate(srcLayout.getOutDimNames())) {
+    std::vector<std::vector<int32_t>> dimBases;
+    for (unsigned i = 0; i < llvm::Log2_64(shape[dim]); ++i) {
+      uint64_t comb = srcBases.solve(1ull << (shift + i));
+      dimBases.push_back({static_cast<int32_t>(comb & ((1 << regBits) - 1)),
+                          static_cast<int32_t>(comb >> regBits)});
+    }
+    bases[outDim] = std::move(dimBases);
+    shift += llvm::Log2_64(shape[dim]);
+  }
+  return LinearLayout(std::move(bases),
+                      {{kRegister, srcLayout.getInDimSize(kRegister)},
+                       {kLane, srcLayout.getInDimSize(kLane)}},
+                      /*requireSurjective=*/false);
+}
+
 SmallVector<std::pair<SmallVector<int64_t>, SmallVector<int64_t>>>
 getReshapeDecomposition(ArrayRef<int64_t> srcShape,
                         ArrayRef<int64_t> dstShape) {
@@ -510,6 +791,29 @@ bool supportMMA(triton::DotOp op, int version) {
       return false;
     }
   }
+  if (version == 5) {
+    // The tcgen05 MMA of one CTA accumulating 128 rows in tensor memory, with
+    // 16-bit floating point operands and an f32 accumulator, or i8 operands
+    // and an i32 accumulator.
+    if (triton::tools::getBoolEnv("DISABLE_MMA_V5"))
+      return false;
+    auto retType = op.getType();
+    auto retShapePerCTA = getShapePerCTA(retType);
+    auto mod = op->getParentOfType<ModuleOp>();
+    int numWarps = TritonGPUDialect::getNumWarps(mod);
+    int numCTAs = TritonGPUDialect::getNumCTAs(mod);
+    Type retElemTy = retType.getElementType();
+    bool isF16Kind =
+        (aElemTy.isF16() || aElemTy.isBF16()) && retElemTy.isF32();
+    bool isI8Kind = aElemTy.isInteger(8) && retElemTy.isInteger(32);
+    // Each MMA instruction has a K of 32 bytes.
+    unsigned instrK = isI8Kind ? 32 : 16;
+    return retShapePerCTA.size() == 2 && numCTAs == 1 &&
+           numWarps % 4 == 0 && retShapePerCTA[0] == 128 &&
+           retShapePerCTA[1] % 16 == 0 && retShapePerCTA[1] <= 256 &&
+           op.getA().getType().getShape()[1] % instrK == 0 &&
+           (isF16Kind || isI8Kind) && aElemTy == bElemTy;
+  }
   if (aElemTy.isF32() && bElemTy.isF32()) {
     return op.getInputPrecision() == InputPrecision::TF32 && version >= 2;
   }
@@ -520,7 +824,7 @@ bool supportMMA(Value value, int version) {
   // Tell whether a DotOp support MMA by the operand type(either $a or $b).
   // We cannot get both the operand types(in TypeConverter), here we assume the
   // types of both the operands are identical here.
-  assert((version == 1 || version == 2 || version == 3) &&
+  assert((version == 1 || version == 2 || version == 3 || version == 5) &&
          "Unexpected MMA layout version found");
   auto elemTy = cast<TensorOrMemDesc>(value.getType()).getElementType();
   // FP8 is not natively supported on all mma versions but it can always be
@@ -579,24 +883,111 @@ bool matchMmaV3AndDotOperandLayout(RankedTensorType srcTy,
   return ans;
 }
 
+std::optional<LinearLayout>
+getWarpShuffleConversion(RankedTensorType srcTy, RankedTensorType dstTy) {
+  MLIRContext *ctx = srcTy.getContext();
+  // comp maps each destination location to a source location holding the
+  // same element.
+  std::optional<LinearLayout> comp = getLayoutConversion(dstTy, srcTy);
+  if (!comp.has_value())
+    return std::nullopt;
+  StringAttr kRegister = StringAttr::get(ctx, "register");
+  StringAttr kLane = StringAttr::get(ctx, "lane");
+  StringAttr kWarp = StringAttr::get(ctx, "warp");
+  StringAttr kBlock = StringAttr::get(ctx, "block");
+  std::optional<LinearLayout> withinWarp = comp->divideRight(
+      LinearLayout::identity1D(comp->getInDimSize(kWarp), kWarp, kWarp) *
+      LinearLayout::identity1D(comp->getInDimSize(kBlock), kBlock, kBlock));
+  if (!withinWarp.has_value() || !withinWarp->hasInDim(kLane) ||
+      !withinWarp->hasOutDim(kLane))
+    return std::nullopt;
+  if (!getWarpShuffleRegisters(*withinWarp).has_value())
+    return std::nullopt;
+  return withinWarp;
+}
+
+std::optional<WarpShuffleRegisters>
+getWarpShuffleRegisters(const LinearLayout &conversion) {
+  MLIRContext *ctx = (*conversion.getInDimNames().begin()).getContext();
+  StringAttr kRegister = StringAttr::get(ctx, "register");
+  StringAttr kLane = StringAttr::get(ctx, "lane");
+  // Without offsetting the received registers, destination register i of lane
+  // l reads source register R ^ Mr(l) of lane L ^ Ml(l), with Mr and Ml
+  // linear, so lane s sends register R ^ Mr(l) for the lanes l with Ml(l) =
+  // s ^ L. This is a function src of s ^ L if Mr(l) = src(Ml(l)), i.e. if Mr
+  // vanishes where Ml does. It is found by Gaussian elimination on the pairs
+  // (Ml(b), Mr(b)) of the lane bits b, each row keyed by the highest bit of
+  // its lane. A lane bit for which Ml vanishes but Mr doesn't, as in a
+  // transpose, offsets the received register by a register bit k instead, so
+  // that it reads from lane L(k) ^ Ml(b) and register R(k) ^ Mr(b).
+  SmallVector<std::pair<int32_t, int32_t>> rows;
+  auto reduce = [&](int32_t &lane, int32_t &reg) {
+    for (auto [rowLane, rowReg] : rows) {
+      if (lane & llvm::bit_floor(static_cast<uint32_t>(rowLane))) {
+        lane ^= rowLane;
+        reg ^= rowReg;
+      }
+    }
+  };
+  auto insert = [&](int32_t lane, int32_t reg) {
+    auto it = llvm::find_if(rows, [&](auto row) {
+      return static_cast<uint32_t>(row.first) < static_cast<uint32_t>(lane);
+    });
+    rows.insert(it, {lane, reg});
+  };
+  WarpShuffleRegisters regs;
+  unsigned usedRegBits = 0;
+  for (int i = 0; i < conversion.getInDimSizeLog2(kLane); ++i) {
+    int32_t lane = conversion.getBasis(kLane, i, kLane);
+    int32_t reg = conversion.getBasis(kLane, i, kRegister);
+    int32_t dstReg = 0;
+    reduce(lane, reg);
+    for (int k = 0; lane == 0 && reg != 0 &&
+                    k < conversion.getInDimSizeLog2(kRegister);
+         ++k) {
+      if (usedRegBits & (1u << k))
+        continue;
+      int32_t offsetLane = lane ^ conversion.getBasis(kRegister, k, kLane);
+      int32_t offsetReg = reg ^ conversion.getBasis(kRegister, k, kRegister);
+      reduce(offsetLane, offsetReg);
+      if (offsetLane == 0)
+        continue;
+      lane = offsetLane;
+      reg = offsetReg;
+      dstReg = 1 << k;
+      usedRegBits |= 1u << k;
+    }
+    if (lane == 0 && reg != 0)
+      return std::nullopt;
+    if (lane != 0)
+      insert(lane, reg);
+    regs.dst.push_back(dstReg);
+  }
+  // Extend src to all the lanes with zeros, as the lanes no one reads from
+  // may send any register.
+  for (int i = 0; i < conversion.getOutDimSizeLog2(kLane); ++i) {
+    int32_t lane = 1 << i, reg = 0;
+    reduce(lane, reg);
+    if (lane != 0)
+      insert(lane, 0);
+    regs.src.push_back(reg);
+  }
+  return regs;
+}
+
 bool cvtNeedsSharedMemory(RankedTensorType srcTy, RankedTensorType dstTy) {
   MLIRContext *ctx = srcTy.getContext();
-  std::optional<LinearLayout> srcLayout =
-      toLinearLayout(srcTy.getShape(), srcTy.getEncoding());
-  std::optional<LinearLayout> dstLayout =
-      toLinearLayout(dstTy.getShape(), dstTy.getEncoding());
-  if (srcLayout.has_value() && dstLayout.has_value()) {
-    // comp describes the layout function for converting from src to dst.
-    LinearLayout comp = srcLayout->invertAndCompose(*dstLayout);
+  // comp describes the layout function for converting from src to dst.
+  if (std::optional<LinearLayout> maybeComp =
+          getLayoutConversion(srcTy, dstTy)) {
+    const LinearLayout &comp = *maybeComp;
     StringAttr kLane = StringAttr::get(ctx, "lane");
     StringAttr kWarp = StringAttr::get(ctx, "warp");
     StringAttr kBlock = StringAttr::get(ctx, "block");
     // In principle, there's no need for shared memory if there's no
     // communication between warps.  However, right now we only have implemented
-    // the shortcut case where there's no communication between *threads*.
-    //
-    // TODO(jlebar): Remove the kLane layout once we add support for
-    // shuffle-based layout conversions in ConvertLayoutToLLVM.
+    // the shortcut case where there's no communication between *threads*, and
+    // the warp shuffles of getWarpShuffleConversion.
     if (comp.divideRight(LinearLayout::identity1D(comp.getInDimSize(kLane),
                                                   kLane, kLane) *
                          LinearLayout::identity1D(comp.getInDimSize(kWarp),
@@ -606,13 +997,16 @@ bool cvtNeedsSharedMemory(RankedTensorType srcTy, RankedTensorType dstTy) {
             .has_value()) {
       return false;
     }
+    if (getWarpShuffleConversion(srcTy, dstTy).has_value())
+      return false;
   }
 
   // TODO(jlebar): Remove these special cases once they're fully subsumed by the
   // linear-layout check above.
   return !isMmaToMmaShortcut(srcTy, dstTy) &&
          !isMmaToDotShortcut(srcTy, dstTy) &&
-         !isMfmaToDotShortcut(srcTy, dstTy);
+         !isMfmaToDotShortcut(srcTy, dstTy) &&
+         !isBlockedToDotShortcut(srcTy, dstTy);
 }
 
 bool isMmaToDotShortcut(RankedTensorType srcTy, RankedTensorType dstTy) {
@@ -629,6 +1023,35 @@ bool isMmaToDotShortcut(RankedTensorType srcTy, RankedTensorType dstTy) {
          !srcTy.getElementType().isF32();
 }
 
+BlockedEncodingAttr
+getFMADotOperandRegisterLayout(DotOperandEncodingAttr dotOperandLayout,
+                               ArrayRef<int64_t> shape) {
+  auto parent = dyn_cast<BlockedEncodingAttr>(dotOperandLayout.getParent());
+  if (!parent || shape.size() != 2 ||
+      product<unsigned>(parent.getCTALayout().getCTAsPerCGA()) != 1)
+    return {};
+  // M and N are the dimensions 0 and 1 of the operands of FMA dots, which
+  // only handle operands covering whole tiles of the parent along them.
+  unsigned kDim = dotOperandLayout.getOpIdx() == 0 ? 1 : 0;
+  unsigned nonKDim = 1 - kDim;
+  if (shape[nonKDim] % getShapePerCTATile(parent)[nonKDim] != 0)
+    return {};
+  SmallVector<unsigned> sizePerThread(parent.getSizePerThread());
+  sizePerThread[kDim] = shape[kDim];
+  return BlockedEncodingAttr::get(
+      parent.getContext(), sizePerThread, parent.getThreadsPerWarp(),
+      parent.getWarpsPerCTA(), parent.getOrder(), parent.getCTALayout());
+}
+
+bool isBlockedToDotShortcut(RankedTensorType srcTy, RankedTensorType dstTy) {
+  auto dotOperandLayout = dyn_cast<DotOperandEncodingAttr>(dstTy.getEncoding());
+  if (!dotOperandLayout)
+    return false;
+  BlockedEncodingAttr layout =
+      getFMADotOperandRegisterLayout(dotOperandLayout, dstTy.getShape());
+  return layout && srcTy.getEncoding() == layout;
+}
+
 namespace {
 
 /// A data structure similar to SetVector but maintains
@@ -919,4 +1342,94 @@ MakeTensorPtrOp getMakeTensorPtrOp(Value v) {
   llvm_unreachable("Unable to getMakeTensorPtr()");
 }
 
+static bool getPointerBaseArgsImpl(Value ptr, DenseSet<unsigned> &args,
+                                   DenseSet<Value> &visited) {
+  if (!visited.insert(ptr).second)
+    return true;
+  if (auto arg = dyn_cast<BlockArgument>(ptr)) {
+    Operation *parent = arg.getOwner()->getParentOp();
+    if (isa<FunctionOpInterface>(parent)) {
+      args.insert(arg.getArgNumber());
+      return arg.getOwner()->isEntryBlock();
+    }
+    auto forOp = dyn_cast<scf::ForOp>(parent);
+    if (!forOp || arg.getArgNumber() == 0)
+      return false;
+    return getPointerBaseArgsImpl(forOp.getTiedLoopInit(arg)->get(), args,
+                                  visited) &&
+           getPointerBaseArgsImpl(forOp.getTiedLoopYieldedValue(arg)->get(),
+                                  args, visited);
+  }
+  Operation *def = ptr.getDefiningOp();
+  unsigned resultNum = cast<OpResult>(ptr).getResultNumber();
+  if (auto forOp = dyn_cast<scf::ForOp>(def)) {
+    Operation *yieldOp = forOp.getBody()->getTerminator();
+    return getPointerBaseArgsImpl(forOp.getInitArgs()[resultNum], args,
+                                  visited) &&
+           getPointerBaseArgsImpl(yieldOp->getOperand(resultNum), args,
+                                  visited);
+  }
+  if (auto ifOp = dyn_cast<scf::IfOp>(def))
+    return getPointerBaseArgsImpl(ifOp.thenYield().getOperand(resultNum), args,
+                                  visited) &&
+           getPointerBaseArgsImpl(ifOp.elseYield().getOperand(resultNum), args,
+                                  visited);
+  // The arguments of the functions converted to LLVM are cast back to their
+  // Triton types for their users that are not converted yet.
+  if (auto castOp = dyn_cast<UnrealizedConversionCastOp>(def))
+    return castOp.getInputs().size() == 1 &&
+           getPointerBaseArgsImpl(castOp.getInputs()[0], args, visited);
+  // Pure ops, e.g. addptr, splat, broadcast or select, compute pointers based
+  // on their pointer operands. A pointer loaded from memory is not.
+  if (!isMemoryEffectFree(def))
+    return false;
+  bool hasPtrOperand = false;
+  for (Value operand : def->getOperands()) {
+    if (!isa<PointerType>(getElementTypeOrSelf(operand.getType())))
+      continue;
+    hasPtrOperand = true;
+    if (!getPointerBaseArgsImpl(operand, args, visited))
+      return false;
+  }
+  return hasPtrOperand;
+}
+
+bool getPointerBaseArgs(Value ptr, DenseSet<unsigned> &args) {
+  DenseSet<Value> visited;
+  return getPointerBaseArgsImpl(ptr, args, visited);
+}
+
+static bool isWarpUniformImpl(Value value, DenseSet<Value> &visited) {
+  // A scalar is the same in all the threads of a program.
+  if (!isa<RankedTensorType>(value.getType()) ||
+      !visited.insert(value).second)
+    return true;
+  Operation *def = value.getDefiningOp();
+  if (!def)
+    return false;
+  if (isa<triton::SplatOp>(def))
+    return true;
+  DenseElementsAttr attr;
+  if (matchPattern(value, m_Constant(&attr)))
+    return attr.isSplat();
+  // The loads of the same pointer under the same mask, and the ops that only
+  // move or combine the elements of their operands one by one. Inline
+  // assembly may read the id of the lane.
+  bool isElementwise = def->hasTrait<OpTrait::Elementwise>() &&
+                       isMemoryEffectFree(def) &&
+                       !isa<triton::ElementwiseInlineAsmOp>(def);
+  if (!isElementwise &&
+      !isa<triton::LoadOp, triton::BroadcastOp, triton::ExpandDimsOp,
+           triton::ReshapeOp, triton::gpu::ConvertLayoutOp>(def))
+    return false;
+  return llvm::all_of(def->getOperands(), [&](Value operand) {
+    return isWarpUniformImpl(operand, visited);
+  });
+}
+
+bool isWarpUniform(Value value) {
+  DenseSet<Value> visited;
+  return isWarpUniformImpl(value, visited);
+}
+
 } // namespace mlir
@@ -0,0 +1,71 @@
+#include "mlir/Pass/Pass.h"
+#include "triton/Conversion/TritonGPUToLLVM/Passes.h"
+#include "triton/Conversion/TritonGPUToLLVM/Utility.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+
+#include <limits>
+
+using namespace mlir;
+using namespace mlir::triton;
+
+namespace mlir {
+namespace triton {
+#define GEN_PASS_DEF_ALLOCATEGLOBALSCRATCHMEMORY
+#include "triton/Conversion/TritonGPUToLLVM/Passes.h.inc"
+} // namespace triton
+} // namespace mlir
+
+namespace {
+
+struct AllocateGlobalScratchMemory
+    : public mlir::triton::impl::AllocateGlobalScratchMemoryBase<
+          AllocateGlobalScratchMemory> {
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    MLIRContext *ctx = &getContext();
+    auto i32Ty = IntegerType::get(ctx, 32);
+    // The workspaces are live for the whole launch; they are laid out one
+    // after the other.
+    uint64_t size = 0;
+    WalkResult result = mod.walk([&](GlobalScratchAllocOp op) {
+      auto funcOp = op->getParentOfType<FunctionOpInterface>();
+      if (!LLVM::isKernel(funcOp)) {
+        op.emitError("global scratch memory can only be allocated in kernels, "
+                     "not in noinline functions");
+        return WalkResult::interrupt();
+      }
+      uint64_t offset = llvm::alignTo(size, std::max(op.getAlignment(), 1u));
+      op->setAttr(LLVM::kGlobalScratchOffsetAttrName,
+                  IntegerAttr::get(i32Ty, offset));
+      size = offset + op.getNbytes();
+      return WalkResult::advance();
+    });
+    if (result.wasInterrupted())
+      return signalPassFailure();
+    if (size > std::numeric_limits<int32_t>::max()) {
+      mod.emitError("the global scratch memory of the kernel exceeds 2GB");
+      return signalPassFailure();
+    }
+    mod->setAttr(LLVM::kGlobalScratchSizeAttrName,
+                 IntegerAttr::get(i32Ty, size));
+  }
+};
+
+} // namespace
+
+namespace mlir {
+
+namespace triton {
+
+namespace gpu {
+
+std::unique_ptr<OperationPass<ModuleOp>>
+createAllocateGlobalScratchMemoryPass() {
+  return std::make_unique<AllocateGlobalScratchMemory>();
+}
+
+} // namespace gpu
+
+} // namespace triton
+
+} // namespace mlir
@@ -2,6 +2,7 @@
 #include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
 #include "triton/Conversion/TritonGPUToLLVM/PatternTritonGPUOpToLLVM.h"
 #include "triton/Conversion/TritonGPUToLLVM/Utility.h"
+#include "llvm/Support/JSON.h"
 
 namespace {
 
@@ -21,6 +22,11 @@ struct AssertOpConversion : public ConvertOpToLLVMPattern<triton::AssertOp> {
     auto ctx = rewriter.getContext();
     auto typeConverter = getTypeConverter();
     auto elems = unpackLLElements(loc, adaptor.getCondition(), rewriter);
+    if (auto log = LLVM::getDeviceLog(op->getParentOfType<ModuleOp>())) {
+      logAssert(op, adaptor, elems, log, rewriter);
+      rewriter.eraseOp(op);
+      return success();
+    }
     auto elemTy = elems[0].getType();
     Value condition = int_val(elemTy.getIntOrFloatBitWidth(), 0);
     for (auto elem : elems) {
@@ -34,15 +40,68 @@ struct AssertOpConversion : public ConvertOpToLLVMPattern<triton::AssertOp> {
         return failure();
       }
     }
-    llAssert(op, condition, adaptor.getMessage(), adaptor.getFile(),
-             adaptor.getFunc(), adaptor.getLine(), rewriter);
+    llAssert(
+        op, condition,
+        [&]() {
+          targetInfo.assertFail(rewriter, loc, adaptor.getMessage(),
+                                adaptor.getFile(), adaptor.getFunc(),
+                                adaptor.getLine());
+        },
+        rewriter);
     rewriter.eraseOp(op);
     return success();
   }
+
+  // Appends a record to the device log `log` if any of the elements of the
+  // condition in this GPU thread is false, with the row-major index of the last
+  // of them and their number as value. The kernel goes on.
+  void logAssert(triton::AssertOp op, OpAdaptor adaptor, ArrayRef<Value> elems,
+                 LLVM::GlobalOp log,
+                 ConversionPatternRewriter &rewriter) const {
+    auto loc = op.getLoc();
+    auto mod = op->getParentOfType<ModuleOp>();
+    auto condTy = cast<RankedTensorType>(op.getCondition().getType());
+    llvm::json::Object site{{"kind", "assert"},
+                            {"message", adaptor.getMessage().str()},
+                            {"file", adaptor.getFile().str()},
+                            {"func", adaptor.getFunc().str()},
+                            {"line", adaptor.getLine()},
+                            {"shape", llvm::json::Array(condTy.getShape())}};
+    std::string json;
+    llvm::raw_string_ostream os(json);
+    os << llvm::json::Value(std::move(site));
+    unsigned siteIndex = LLVM::addDeviceLogSite(mod, json);
+
+    auto indices = emitIndices(loc, rewriter, targetInfo, condTy.getEncoding(),
+                               condTy, true);
+    Value numFailed = i32_val(0);
+    Value failedIndex = i32_val(0);
+    for (auto [elem, multiDim] : llvm::zip(elems, indices)) {
+      Value linear = i32_val(0);
+      for (auto [dim, size] : llvm::zip(multiDim, condTy.getShape()))
+        linear = add(mul(linear, i32_val(size)), dim);
+      Value failed = icmp_eq(elem, rewriter.create<LLVM::ConstantOp>(
+                                       loc, elem.getType(),
+                                       rewriter.getZeroAttr(elem.getType())));
+      numFailed = add(numFailed, zext(i32_ty, failed));
+      failedIndex = select(failed, linear, failedIndex);
+    }
+    llAssert(
+        op, icmp_ne(numFailed, i32_val(0)),
+        [&]() {
+          Value index = LLVM::reserveDeviceLogRecords(rewriter, loc, log, 1);
+          LLVM::storeDeviceLogRecord(rewriter, loc, targetInfo, log, index,
+                                     siteIndex, failedIndex,
+                                     zext(i64_ty, numFailed));
+        },
+        rewriter);
+  }
+
   // op: the op at which the assert is inserted. Unlike printf, we need to
-  // know about the op to split the block.
-  void llAssert(Operation *op, Value condition, StringRef message,
-                StringRef file, StringRef func, int line,
+  // know about the op to split the block. `reportFailure` emits the code run
+  // when `condition` is true.
+  void llAssert(Operation *op, Value condition,
+                function_ref<void()> reportFailure,
                 ConversionPatternRewriter &rewriter) const {
     ConversionPatternRewriter::InsertionGuard guard(rewriter);
     auto ctx = rewriter.getContext();
@@ -57,7 +116,7 @@ struct AssertOpConversion : public ConvertOpToLLVMPattern<triton::AssertOp> {
 
     Block *ifBlock = rewriter.splitBlock(prevBlock, op->getIterator());
     rewriter.setInsertionPointToStart(ifBlock);
-    targetInfo.assertFail(rewriter, loc, message, file, func, line);
+    reportFailure();
 
     // Split a block after the call.
     Block *thenBlock = rewriter.splitBlock(ifBlock, op->getIterator());
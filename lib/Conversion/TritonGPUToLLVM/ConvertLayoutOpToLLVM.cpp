@@ -9,6 +9,7 @@
 #include "triton/Dialect/TritonGPU/Transforms/Utility.h"
 
 #include "triton/Conversion/TritonGPUToLLVM/PatternTritonGPUOpToLLVM.h"
+#include "llvm/ADT/MapVector.h"
 
 namespace mlir::triton::gpu {
 namespace {
@@ -117,10 +118,60 @@ public:
     if (isSupported(srcLayout, dstLayout)) {
       return lowerDistributedToDistributed(op, adaptor, rewriter);
     }
+    if (isBlockedToDotShortcut(srcTy, dstTy)) {
+      return lowerBlockedToDotOperand(op, adaptor, rewriter);
+    }
     return failure();
   }
 
 private:
+  // blocked -> dot_operand of an FMA dot, when each thread already holds the
+  // rows or columns it reads along the whole K dimension: the registers are
+  // reordered as the FMA dot expects them, i.e. by K, then by repetition of
+  // the tile of the parent layout along M or N, and then by element of the
+  // thread in the tile.
+  LogicalResult
+  lowerBlockedToDotOperand(ConvertLayoutOp op, OpAdaptor adaptor,
+                           ConversionPatternRewriter &rewriter) const {
+    MLIRContext *ctx = op.getContext();
+    Location loc = op.getLoc();
+    RankedTensorType srcTy = op.getSrc().getType();
+    auto dotOperandLayout =
+        cast<DotOperandEncodingAttr>(op.getType().getEncoding());
+    auto parent = cast<BlockedEncodingAttr>(dotOperandLayout.getParent());
+    unsigned kDim = dotOperandLayout.getOpIdx() == 0 ? 1 : 0;
+    unsigned nonKDim = 1 - kDim;
+    int sizePerThread = parent.getSizePerThread()[nonKDim];
+    int shapePerCTATile = getShapePerCTATile(parent)[nonKDim];
+    int numReps = srcTy.getShape()[nonKDim] / shapePerCTATile;
+
+    StringAttr kRegister = str_attr("register");
+    StringAttr kLane = str_attr("lane");
+    StringAttr kWarp = str_attr("warp");
+    StringAttr kBlock = str_attr("block");
+    std::optional<LinearLayout> layout =
+        toLinearLayout(srcTy.getShape(), srcTy.getEncoding());
+    assert(layout.has_value());
+
+    // The elements of a register of all the threads only differ by the offset
+    // of the thread, which doesn't overlap the offsets of the registers.
+    auto inVals = unpackLLElements(loc, adaptor.getSrc(), rewriter);
+    SmallVector<Value> outVals(inVals.size());
+    for (int i = 0; i < inVals.size(); i++) {
+      auto coords = layout->apply(
+          {{kRegister, i}, {kLane, 0}, {kWarp, 0}, {kBlock, 0}});
+      int32_t k = coords[kDim].second;
+      int32_t idx = coords[nonKDim].second;
+      int rep = idx / shapePerCTATile;
+      int elem = idx % shapePerCTATile;
+      outVals[(k * numReps + rep) * sizePerThread + elem] = inVals[i];
+    }
+    Value result = packLLElements(loc, getTypeConverter(), outVals, rewriter,
+                                  op.getType());
+    rewriter.replaceOp(op, result);
+    return success();
+  }
+
   bool isSupported(Attribute srcLayout, Attribute dstLayout) const {
     return isaDistributedLayout(srcLayout) && isaDistributedLayout(dstLayout) &&
            !isLayoutMmaV1(srcLayout) && !isLayoutMmaV1(dstLayout);
@@ -309,20 +360,19 @@ struct ConvertLayoutOpUsingLinearLayoutsConversion
   // Set benefit to 2 so that this pattern applies before other convert-layout
   // conversions.  TODO(jlebar): Eventually we want this to be the only pattern.
   explicit ConvertLayoutOpUsingLinearLayoutsConversion(
-      LLVMTypeConverter &typeConverter, PatternBenefit benefit = 2)
-      : ConvertOpToLLVMPattern(typeConverter, benefit) {}
+      LLVMTypeConverter &typeConverter, const TargetInfoBase &targetInfo,
+      PatternBenefit benefit = 2)
+      : ConvertOpToLLVMPattern(typeConverter, benefit), targetInfo(targetInfo) {
+  }
 
   LogicalResult
   matchAndRewrite(ConvertLayoutOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
     MLIRContext *ctx = op.getContext();
 
-    const auto &shape = op.getType().getShape();
-    std::optional<LinearLayout> srcLayout =
-        gpu::toLinearLayout(shape, op.getSrc().getType().getEncoding());
-    std::optional<LinearLayout> dstLayout =
-        gpu::toLinearLayout(shape, op.getType().getEncoding());
-    if (!srcLayout.has_value() || !dstLayout.has_value()) {
+    std::optional<LinearLayout> maybeConversion =
+        gpu::getLayoutConversion(op.getSrc().getType(), op.getType());
+    if (!maybeConversion.has_value()) {
       return failure();
     }
 
@@ -341,7 +391,7 @@ struct ConvertLayoutOpUsingLinearLayoutsConversion
     // We can tell which case we're in by examining `conversion`.  If e.g. the
     // block -> block mapping is {1, 2, 4, ...} then there's no movement between
     // data in different CTAs and we know we're not in case 4.
-    LinearLayout conversion = srcLayout->invertAndCompose(*dstLayout);
+    const LinearLayout &conversion = *maybeConversion;
 
     int numLanes = conversion.getInDimSize(str_attr("lane"));
     int numWarps = conversion.getInDimSize(str_attr("warp"));
@@ -365,9 +415,8 @@ struct ConvertLayoutOpUsingLinearLayoutsConversion
       return transferWithinThread(*c, op, adaptor, rewriter);
     }
 
-    if (std::optional<LinearLayout> c = conversion.divideRight(
-            LinearLayout::identity1D(numWarps, kWarp, kWarp) *
-            LinearLayout::identity1D(numBlocks, kBlock, kBlock));
+    if (std::optional<LinearLayout> c =
+            getWarpShuffleConversion(op.getSrc().getType(), op.getType());
         c.has_value()) {
       return transferWithinLane(*c, op, adaptor, rewriter);
     }
@@ -407,11 +456,163 @@ struct ConvertLayoutOpUsingLinearLayoutsConversion
     return success();
   }
 
+  // Unlike in the other cases, `conversion` maps each destination (register,
+  // lane) to the source (register, lane) it is read from, see
+  // getWarpShuffleConversion.
   LogicalResult transferWithinLane(const LinearLayout &conversion,
                                    ConvertLayoutOp op, OpAdaptor adaptor,
                                    ConversionPatternRewriter &rewriter) const {
-    // TODO(jlebar): Implement me.
-    return failure();
+    MLIRContext *ctx = op.getContext();
+    auto loc = op.getLoc();
+    StringAttr kRegister = str_attr("register");
+    StringAttr kLane = str_attr("lane");
+
+    // Destination register i of lane l holds the source register
+    // conversion(i, 0) ^ conversion(0, l), a (register, lane) pair.
+    auto getSrc = [&](int dstReg, StringAttr dim) {
+      for (auto [outDim, idx] :
+           conversion.apply({{kRegister, dstReg}, {kLane, 0}}))
+        if (outDim == dim)
+          return idx;
+      llvm_unreachable("missing output dimension");
+    };
+    Value laneId = urem(getThreadId(rewriter, loc),
+                        i32_val(conversion.getInDimSize(kLane)));
+    Value srcLaneOffset =
+        applyLinearLayout(loc, rewriter,
+                          conversion.sublayout({kLane}, {kLane}),
+                          {{kLane, laneId}})[0]
+            .second;
+
+    // In the shuffle of destination register i, with (R, L) = conversion(i,
+    // 0), this lane sends its register R ^ src(L ^ laneId) and receives into
+    // its register i ^ dst(laneId), see getWarpShuffleRegisters.  The
+    // registers it may send or receive into are selected between at runtime,
+    // unless src and dst are zero, as for broadcasts and the layout changes
+    // that don't transpose registers and lanes.
+    WarpShuffleRegisters regs = *getWarpShuffleRegisters(conversion);
+    // Sets `offsets` to the offsets of `bitRegs` over all the lanes, and
+    // `isLaneOffset` to whether they are the offset of this lane.
+    auto getRegOffsets = [&](ArrayRef<int32_t> bitRegs,
+                             SmallVector<int32_t> &offsets,
+                             SmallVector<Value> &isLaneOffset) {
+      offsets = {0};
+      Value laneOffset = i32_val(0);
+      for (auto [bit, bitReg] : llvm::enumerate(bitRegs)) {
+        if (bitReg == 0)
+          continue;
+        if (!llvm::is_contained(offsets, bitReg)) {
+          for (int i = 0, e = offsets.size(); i < e; ++i)
+            offsets.push_back(offsets[i] ^ bitReg);
+        }
+        Value laneBit = and_(lshr(laneId, i32_val(bit)), i32_val(1));
+        laneOffset = xor_(laneOffset, mul(laneBit, i32_val(bitReg)));
+      }
+      for (int32_t offset : offsets)
+        isLaneOffset.push_back(icmp_eq(laneOffset, i32_val(offset)));
+    };
+    auto applySrc = [&](int32_t lane) {
+      int32_t reg = 0;
+      for (auto [bit, bitReg] : llvm::enumerate(regs.src))
+        if (lane & (1 << bit))
+          reg ^= bitReg;
+      return reg;
+    };
+    // Receiving into register i ^ dst(laneId) also reads it from lane
+    // conversion(dst(laneId), 0) ^ conversion(0, laneId) ^ L.
+    for (auto [bit, bitReg] : llvm::enumerate(regs.dst)) {
+      if (bitReg == 0)
+        continue;
+      Value laneBit = and_(lshr(laneId, i32_val(bit)), i32_val(1));
+      srcLaneOffset = xor_(srcLaneOffset,
+                           mul(laneBit, i32_val(getSrc(bitReg, kLane))));
+    }
+    SmallVector<int32_t> senderRegOffsets, receiverRegOffsets;
+    SmallVector<Value> isSenderRegOffset, isReceiverRegOffset;
+    getRegOffsets(regs.src, senderRegOffsets, isSenderRegOffset);
+    getRegOffsets(regs.dst, receiverRegOffsets, isReceiverRegOffset);
+
+    auto inVals = unpackLLElements(loc, adaptor.getSrc(), rewriter);
+    auto getSentValue = [&](int32_t srcReg, int32_t srcLane) {
+      int32_t baseReg = srcReg ^ applySrc(srcLane);
+      Value val = inVals[baseReg];
+      for (auto [offset, isOffset] :
+           llvm::zip(senderRegOffsets, isSenderRegOffset))
+        if (offset != 0)
+          val = select(isOffset, inVals[baseReg ^ offset], val);
+      return val;
+    };
+
+    // The distinct shuffles, each made of the source register and lane of
+    // lane 0.  Shuffles from the same lane of elements narrower than 32 bits
+    // are packed into the 32 bits of a single shuffle.
+    SmallVector<std::pair<int32_t, int32_t>> shuffles;
+    DenseMap<std::pair<int32_t, int32_t>, unsigned> shuffleIndex;
+    SmallVector<unsigned> dstShuffles;
+    for (int i = 0; i < conversion.getInDimSize(kRegister); i++) {
+      std::pair<int32_t, int32_t> src = {getSrc(i, kRegister),
+                                         getSrc(i, kLane)};
+      auto [it, inserted] = shuffleIndex.try_emplace(src, shuffles.size());
+      if (inserted)
+        shuffles.push_back(src);
+      dstShuffles.push_back(it->second);
+    }
+    Type elemTy = inVals[0].getType();
+    unsigned packing = 1;
+    if (elemTy.isIntOrFloat() && (elemTy.getIntOrFloatBitWidth() == 8 ||
+                                  elemTy.getIntOrFloatBitWidth() == 16))
+      packing = 32 / elemTy.getIntOrFloatBitWidth();
+
+    SmallVector<Value> shuffled(shuffles.size());
+    MapVector<int32_t, SmallVector<unsigned>> shufflesBySrcLane;
+    for (auto [idx, src] : llvm::enumerate(shuffles))
+      shufflesBySrcLane[src.second].push_back(idx);
+    for (auto &[srcLane, indices] : shufflesBySrcLane) {
+      Value srcLaneId = xor_(srcLaneOffset, i32_val(srcLane));
+      for (unsigned i = 0; i < indices.size(); i += packing) {
+        ArrayRef<unsigned> pack =
+            ArrayRef(indices).slice(i, std::min<unsigned>(
+                                           packing, indices.size() - i));
+        if (packing == 1) {
+          Value val = getSentValue(shuffles[pack[0]].first, srcLane);
+          auto ptrTy = dyn_cast<LLVM::LLVMPointerType>(val.getType());
+          if (!ptrTy) {
+            shuffled[pack[0]] =
+                targetInfo.shuffleIdx(rewriter, loc, val, srcLaneId);
+          } else {
+            Value result = targetInfo.shuffleIdx(
+                rewriter, loc, ptrtoint(i64_ty, val), srcLaneId);
+            shuffled[pack[0]] = inttoptr(ptrTy, result);
+          }
+          continue;
+        }
+        auto vecTy = vec_ty(elemTy, packing);
+        Value vec = undef(vecTy);
+        for (auto [j, idx] : llvm::enumerate(pack))
+          vec = insert_element(
+              vecTy, vec, getSentValue(shuffles[idx].first, srcLane),
+              i32_val(j));
+        Value word = targetInfo.shuffleIdx(rewriter, loc,
+                                           bitcast(vec, i32_ty), srcLaneId);
+        vec = bitcast(word, vecTy);
+        for (auto [j, idx] : llvm::enumerate(pack))
+          shuffled[idx] = extract_element(elemTy, vec, i32_val(j));
+      }
+    }
+
+    SmallVector<Value> outVals;
+    for (int i = 0; i < dstShuffles.size(); i++) {
+      Value val = shuffled[dstShuffles[i]];
+      for (auto [offset, isOffset] :
+           llvm::zip(receiverRegOffsets, isReceiverRegOffset))
+        if (offset != 0)
+          val = select(isOffset, shuffled[dstShuffles[i ^ offset]], val);
+      outVals.push_back(val);
+    }
+    Value result = packLLElements(loc, getTypeConverter(), outVals, rewriter,
+                                  op.getType());
+    rewriter.replaceOp(op, result);
+    return success();
   }
 
   LogicalResult transferWithinBlock(const LinearLayout &conversion,
@@ -428,6 +629,9 @@ struct ConvertLayoutOpUsingLinearLayoutsConversion
     // TODO(jlebar): Implement me.
     return failure();
   }
+
+private:
+  const TargetInfoBase &targetInfo;
 };
 
 } // namespace
@@ -440,7 +644,7 @@ void mlir::triton::populateConvertLayoutOpToLLVMPatterns(
   // Eventually the LL conversion will subsume all of the others and be the only
   // one left.
   patterns.add<gpu::ConvertLayoutOpUsingLinearLayoutsConversion>(
-      typeConverter, benefit.getBenefit() + 1);
+      typeConverter, targetInfo, benefit.getBenefit() + 1);
   patterns.add<gpu::ConvertLayoutOpConversion>(typeConverter, targetInfo,
                                                benefit);
   patterns.add<gpu::LocalLoadOpConversion>(typeConverter, targetInfo, benefit);
@@ -147,6 +147,43 @@ int getNumElementsPerThreads(Type type,
   return (32 / eltType.getIntOrFloatBitWidth()) * numElemsPerThread;
 }
 
+bool canPackElementPairs(Operation *op) {
+  if (op->getNumResults() != 1)
+    return false;
+  auto tensorTy = dyn_cast<RankedTensorType>(op->getResult(0).getType());
+  if (!tensorTy || !isa<FloatType>(tensorTy.getElementType()) ||
+      tensorTy.getElementType().getIntOrFloatBitWidth() != 16)
+    return false;
+  if (llvm::any_of(op->getOperandTypes(),
+                   [&](Type type) { return type != tensorTy; }))
+    return false;
+  // The elements of dot operands are reordered and packed in i32 values.
+  Attribute encoding = tensorTy.getEncoding();
+  if (!encoding || isa<DotOperandEncodingAttr>(encoding))
+    return false;
+  SmallVector<unsigned> contigPerThread = getContigPerThread(encoding);
+  SmallVector<unsigned> order = getOrder(encoding);
+  return contigPerThread[order[0]] % 2 == 0;
+}
+
+SmallVector<Value>
+createPackedDestOps(ConversionPatternRewriter &rewriter, Location loc,
+                    Type elemTy, MultipleOperandsRange operands,
+                    function_ref<Value(Type, ValueRange)> createOp) {
+  assert(operands.size() >= 2 && "expected a pair of operand sets");
+  auto vecTy = vec_ty(elemTy, 2);
+  SmallVector<Value> args;
+  for (unsigned j = 0; j < operands[0].size(); ++j) {
+    Value arg = undef(vecTy);
+    for (unsigned i = 0; i < 2; ++i)
+      arg = insert_element(vecTy, arg, operands[i][j], i32_val(i));
+    args.push_back(arg);
+  }
+  Value result = createOp(vecTy, args);
+  return {extract_element(elemTy, result, i32_val(0)),
+          extract_element(elemTy, result, i32_val(1))};
+}
+
 } // namespace mlir::triton::gpu
 
 namespace {
@@ -342,10 +379,24 @@ struct ElementwiseOpConversion
   using OpAdaptor = typename Base::OpAdaptor;
 
   // An interface to support variant DestOp builder.
-  SmallVector<DestOp> createDestOps(SourceOp op, OpAdaptor adaptor,
-                                    ConversionPatternRewriter &rewriter,
-                                    Type elemTy, MultipleOperandsRange operands,
-                                    Location loc) const {
+  SmallVector<Value> createDestOps(SourceOp op, OpAdaptor adaptor,
+                                   ConversionPatternRewriter &rewriter,
+                                   Type elemTy, MultipleOperandsRange operands,
+                                   Location loc) const {
+    // The backends lower these ops on vectors of 2 f16 to packed
+    // instructions, e.g. fma.rn.f16x2 or v_pk_fma_f16.
+    if constexpr (llvm::is_one_of<DestOp, LLVM::FMAOp, LLVM::MinNumOp,
+                                  LLVM::MaxNumOp, LLVM::MinimumOp,
+                                  LLVM::MaximumOp>::value) {
+      if (elemTy.isF16() && operands.size() >= 2 && canPackElementPairs(op))
+        return createPackedDestOps(
+            rewriter, loc, elemTy, operands, [&](Type vecTy, ValueRange args) {
+              return rewriter
+                  .create<DestOp>(loc, vecTy, args,
+                                  adaptor.getAttributes().getValue())
+                  .getResult();
+            });
+    }
     return {rewriter.create<DestOp>(loc, elemTy, operands[0],
                                     adaptor.getAttributes().getValue())};
   }
@@ -672,6 +723,13 @@ struct MinMaxFOpConversion
                                    Type elemTy, MultipleOperandsRange operands,
                                    Location loc) const {
     if (hwNanPropagationSupported) {
+      if (elemTy.isF16() && operands.size() >= 2 && canPackElementPairs(op))
+        return createPackedDestOps(
+            rewriter, loc, elemTy, operands, [&](Type vecTy, ValueRange args) {
+              return rewriter
+                  .create<DestOpNanProp>(loc, vecTy, args[0], args[1])
+                  .getResult();
+            });
       return {rewriter.create<DestOpNanProp>(loc, elemTy, operands[0][0],
                                              operands[0][1])};
     }
@@ -16,6 +16,14 @@ using namespace mlir::triton;
 /// FuncOp legalization pattern that converts MemRef arguments to pointers to
 /// MemRef descriptors (LLVM struct data types) containing all the MemRef type
 /// information.
+///
+/// Tensor arguments and results of device functions are converted, like any
+/// tensor, to the LLVM struct of the elements held by each thread in their
+/// layout, which is part of the function type, so that the caller and the
+/// callee agree on it. The backends pass the members of the structs in
+/// registers. The shared memory of the callee starts at the base passed by the
+/// caller in the extra argument added by `amendFuncOp`. Kernels with global
+/// scratch memory take the pointer to it in an extra last argument.
 struct FuncOpConversion : public ConvertOpToLLVMPattern<triton::FuncOp> {
   FuncOpConversion(LLVMTypeConverter &converter, int numWarps,
                    PatternBenefit benefit)
@@ -37,13 +45,11 @@ struct FuncOpConversion : public ConvertOpToLLVMPattern<triton::FuncOp> {
     }
   }
 
-  triton::FuncOp amendFuncOp(triton::FuncOp funcOp,
+  // Pushes back an argument of type `ptrTy` to the function arguments.
+  triton::FuncOp amendFuncOp(triton::FuncOp funcOp, Type ptrTy,
                              ConversionPatternRewriter &rewriter) const {
-    // Push back a variable that indicates the current stack pointer of shared
-    // memory to the function arguments.
     auto loc = funcOp.getLoc();
     auto ctx = funcOp->getContext();
-    auto ptrTy = LLVM::LLVMPointerType::get(rewriter.getContext(), 3);
     // 1. Modify the function type to add the new argument.
     auto funcTy = funcOp.getFunctionType();
     auto amendedInputTy = llvm::to_vector<4>(funcTy.getInputs());
@@ -72,8 +78,17 @@ struct FuncOpConversion : public ConvertOpToLLVMPattern<triton::FuncOp> {
                   ConversionPatternRewriter &rewriter) const override {
     // Prevent LLVM's inliner to inline this function
     auto amendedFuncOp = funcOp;
-    if (!LLVM::isKernel(funcOp))
-      amendedFuncOp = amendFuncOp(funcOp, rewriter);
+    if (!LLVM::isKernel(funcOp)) {
+      // The current stack pointer of shared memory.
+      amendedFuncOp = amendFuncOp(
+          funcOp, LLVM::LLVMPointerType::get(rewriter.getContext(), 3),
+          rewriter);
+    } else if (LLVM::getGlobalScratchSize(
+                   funcOp->getParentOfType<ModuleOp>()) > 0) {
+      amendedFuncOp = amendFuncOp(
+          funcOp, LLVM::LLVMPointerType::get(rewriter.getContext(), 1),
+          rewriter);
+    }
 
     LLVM::LLVMFuncOp newFuncOp = *mlir::convertFuncOpToLLVMFuncOp(
         amendedFuncOp, rewriter, *getTypeConverter());
@@ -88,6 +103,18 @@ struct FuncOpConversion : public ConvertOpToLLVMPattern<triton::FuncOp> {
       newFuncOp->setAttr("nvvm.kernel",
                          rewriter.getIntegerAttr(type::u1Ty(ctx), 1));
       newFuncOp.setLinkage(LLVM::Linkage::External);
+      // The pointers to const data are read-only, and the memory of restrict
+      // pointers is only accessed through them.
+      for (unsigned i = 0; i < funcOp.getNumArguments(); ++i) {
+        if (funcOp.getArgAttr(i, "tt.const"))
+          newFuncOp.setArgAttr(i, LLVM::LLVMDialect::getReadonlyAttrName(),
+                               rewriter.getUnitAttr());
+        if (funcOp.getArgAttr(i, "tt.noalias"))
+          newFuncOp.setArgAttr(i, LLVM::LLVMDialect::getNoAliasAttrName(),
+                               rewriter.getUnitAttr());
+      }
+      if (amendedFuncOp != funcOp)
+        rewriter.eraseOp(amendedFuncOp);
     } else {
       // The noinline attribute will be used by the LLVM codegen to prevent
       // inlining.
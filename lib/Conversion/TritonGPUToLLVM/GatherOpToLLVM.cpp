@@ -0,0 +1,181 @@
+#include "triton/Analysis/Utility.h"
+#include "triton/Conversion/TritonGPUToLLVM/PatternTritonGPUOpToLLVM.h"
+#include "triton/Conversion/TritonGPUToLLVM/TargetInfoBase.h"
+#include "triton/Conversion/TritonGPUToLLVM/Utility.h"
+#include "triton/Dialect/TritonGPU/IR/LinearLayoutConversions.h"
+
+using namespace mlir;
+using namespace mlir::triton;
+
+using ::mlir::LLVM::linearize;
+
+namespace {
+class GatherOpConversion : public ConvertOpToLLVMPattern<GatherOp> {
+public:
+  GatherOpConversion(LLVMTypeConverter &typeConverter,
+                     const TargetInfoBase &targetInfo, PatternBenefit benefit)
+      : ConvertOpToLLVMPattern(typeConverter, benefit), targetInfo(targetInfo) {
+  }
+
+  LogicalResult
+  matchAndRewrite(GatherOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    GatherLoweringHelper helper(op);
+    if (helper.isWarpLocal())
+      emitWarpLocalGather(op, adaptor, helper, rewriter);
+    else
+      emitGatherInShared(op, adaptor, rewriter);
+    return success();
+  }
+
+private:
+  // Returns the index along the gather axis of each element of the result, as
+  // an i32.
+  SmallVector<Value> getIndices(GatherOp op, OpAdaptor adaptor,
+                                ConversionPatternRewriter &rewriter) const {
+    Location loc = op.getLoc();
+    SmallVector<Value> indices =
+        unpackLLElements(loc, adaptor.getIndices(), rewriter);
+    unsigned bitWidth = op.getIndices().getType().getElementTypeBitWidth();
+    for (Value &index : indices) {
+      if (bitWidth > 32)
+        index = trunc(i32_ty, index);
+      else if (bitWidth < 32)
+        index = zext(i32_ty, index);
+    }
+    return indices;
+  }
+
+  // Stores the input to shared memory, then has each thread load the elements
+  // of the result from it.
+  void emitGatherInShared(GatherOp op, OpAdaptor adaptor,
+                          ConversionPatternRewriter &rewriter) const;
+
+  // Has each lane read the elements of the result from the lanes of its warp
+  // holding them with shuffles.
+  void emitWarpLocalGather(GatherOp op, OpAdaptor adaptor,
+                           GatherLoweringHelper &helper,
+                           ConversionPatternRewriter &rewriter) const;
+
+  const TargetInfoBase &targetInfo;
+};
+
+void GatherOpConversion::emitGatherInShared(
+    GatherOp op, OpAdaptor adaptor, ConversionPatternRewriter &rewriter) const {
+  Location loc = op.getLoc();
+  RankedTensorType srcType = op.getSrc().getType();
+  RankedTensorType dstType = op.getType();
+  Type elemType = getTypeConverter()->convertType(srcType.getElementType());
+  unsigned axis = op.getAxis();
+  SmallVector<unsigned> shape(srcType.getShape());
+
+  // Store the input in row-major order. Elements held by several threads are
+  // stored several times, with the same value.
+  Value smemBase = LLVM::getSharedMemoryBase(loc, rewriter, op.getOperation());
+  Type smemPtrType = smemBase.getType();
+  SmallVector<Value> srcValues =
+      unpackLLElements(loc, adaptor.getSrc(), rewriter);
+  SmallVector<SmallVector<Value>> srcIndices =
+      emitIndices(loc, rewriter, targetInfo, srcType.getEncoding(), srcType,
+                  /*withCTAOffset=*/false);
+  for (auto [value, coords] : llvm::zip(srcValues, srcIndices)) {
+    Value offset = linearize(rewriter, loc, coords, shape);
+    store(value, gep(smemPtrType, elemType, smemBase, offset));
+  }
+  barrier();
+
+  // Load each element of the result from the input coordinates of its index.
+  SmallVector<Value> indices = getIndices(op, adaptor, rewriter);
+  SmallVector<SmallVector<Value>> dstIndices =
+      emitIndices(loc, rewriter, targetInfo, dstType.getEncoding(), dstType,
+                  /*withCTAOffset=*/false);
+  SmallVector<Value> results;
+  for (auto [index, coords] : llvm::zip(indices, dstIndices)) {
+    coords[axis] = index;
+    Value offset = linearize(rewriter, loc, coords, shape);
+    results.push_back(
+        load(elemType, gep(smemPtrType, elemType, smemBase, offset)));
+  }
+
+  Value packed =
+      packLLElements(loc, getTypeConverter(), results, rewriter, dstType);
+  rewriter.replaceOp(op, packed);
+}
+
+void GatherOpConversion::emitWarpLocalGather(
+    GatherOp op, OpAdaptor adaptor, GatherLoweringHelper &helper,
+    ConversionPatternRewriter &rewriter) const {
+  Location loc = op.getLoc();
+  MLIRContext *ctx = op.getContext();
+  RankedTensorType srcType = op.getSrc().getType();
+  RankedTensorType dstType = op.getType();
+  unsigned axis = op.getAxis();
+  StringAttr kRegister = str_attr("register");
+  StringAttr kLane = str_attr("lane");
+
+  // The coordinates of the elements of the result relative to the first
+  // element held by their warp. As the warps hold the same coordinates of the
+  // input and the indices along the dimensions other than the gather axis,
+  // these are also the coordinates of the input to gather from, once the
+  // index is set along the gather axis.
+  LinearLayout dstLayout =
+      *triton::gpu::toLinearLayout(dstType.getShape(), dstType.getEncoding());
+  SmallVector<StringAttr> outDims =
+      llvm::to_vector(dstLayout.getOutDimNames());
+  LinearLayout dstLocalLayout =
+      dstLayout.sublayout({kRegister, kLane}, outDims);
+  LinearLayout srcLocalLayout = helper.getWarpLocalSourceLayout();
+
+  Value threadId = getThreadId(rewriter, loc);
+  Value laneId = urem(threadId, i32_val(dstLayout.getInDimSize(kLane)));
+  SmallVector<Value> srcValues =
+      unpackLLElements(loc, adaptor.getSrc(), rewriter);
+  // Shuffles move integers and floats, so shuffle pointers as integers.
+  Type elemType = getTypeConverter()->convertType(srcType.getElementType());
+  bool isPtr = isa<LLVM::LLVMPointerType>(elemType);
+  if (isPtr) {
+    for (Value &value : srcValues)
+      value = ptrtoint(i64_ty, value);
+  }
+  SmallVector<Value> indices = getIndices(op, adaptor, rewriter);
+  // Out of bounds indices are undefined behavior. Keep them within the axis
+  // so that they do not change the other coordinates.
+  Value axisMask = i32_val(srcType.getShape()[axis] - 1);
+
+  SmallVector<Value> results;
+  for (auto [reg, index] : llvm::enumerate(indices)) {
+    SmallVector<std::pair<StringAttr, Value>> coords = applyLinearLayout(
+        loc, rewriter, dstLocalLayout,
+        {{kRegister, i32_val(reg)}, {kLane, laneId}});
+    coords[axis].second = and_(index, axisMask);
+    SmallVector<std::pair<StringAttr, Value>> srcRegAndLane =
+        applyLinearLayout(loc, rewriter, srcLocalLayout, coords);
+    Value srcReg = srcRegAndLane[0].second;
+    Value srcLane = srcRegAndLane[1].second;
+
+    // Every register of the source lane may hold the element, so shuffle all
+    // of them and select the one holding it.
+    Value result;
+    for (auto [i, srcValue] : llvm::enumerate(srcValues)) {
+      Value value = targetInfo.shuffleIdx(rewriter, loc, srcValue, srcLane);
+      if (i == 0)
+        result = value;
+      else
+        result = select(icmp_eq(srcReg, i32_val(i)), value, result);
+    }
+    if (isPtr)
+      result = inttoptr(elemType, result);
+    results.push_back(result);
+  }
+
+  Value packed =
+      packLLElements(loc, getTypeConverter(), results, rewriter, dstType);
+  rewriter.replaceOp(op, packed);
+}
+} // namespace
+
+void mlir::triton::populateGatherOpToLLVMPatterns(
+    LLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
+    const TargetInfoBase &targetInfo, PatternBenefit benefit) {
+  patterns.add<GatherOpConversion>(typeConverter, targetInfo, benefit);
+}
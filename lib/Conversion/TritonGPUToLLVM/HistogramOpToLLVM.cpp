@@ -2,6 +2,7 @@
 #include "triton/Conversion/TritonGPUToLLVM/PatternTritonGPUOpToLLVM.h"
 #include "triton/Conversion/TritonGPUToLLVM/TargetInfoBase.h"
 #include "triton/Conversion/TritonGPUToLLVM/Utility.h"
+#include "triton/Dialect/TritonGPU/IR/LinearLayoutConversions.h"
 
 using namespace mlir;
 using namespace mlir::triton;
@@ -16,8 +17,9 @@ static int log2Int(int64_t num) { return (num > 1) ? 1 + log2Int(num / 2) : 0; }
 // only popcount those.
 static SmallVector<Value> computeWarpLevelHistogram(
     Location loc, RankedTensorType srcType, SmallVector<Value> &srcValues,
-    int numBins, int numThreadPerWarp, Value threadId,
-    ConversionPatternRewriter &rewriter, const TargetInfoBase &targetInfo) {
+    ArrayRef<Value> maskValues, int numBins, int numThreadPerWarp,
+    Value threadId, ConversionPatternRewriter &rewriter,
+    const TargetInfoBase &targetInfo) {
   assert(numBins % numThreadPerWarp == 0 &&
          "numBins must be divisible by numThreadPerWarp");
   Value zero = i32_val(0);
@@ -48,6 +50,12 @@ static SmallVector<Value> computeWarpLevelHistogram(
     if (numThreadWithUniqueData < numThreadPerWarp) {
       mask = int_val(numThreadPerWarp, (1ULL << numThreadWithUniqueData) - 1);
     }
+    // Masked out elements are in no bin.
+    if (!maskValues.empty()) {
+      mask = and_(mask, targetInfo.ballot(rewriter, loc,
+                                          int_ty(numThreadPerWarp),
+                                          maskValues[i]));
+    }
     for (int i = 0; i < numBitsLaneId; i++) {
       Value updateMask = select(icmp_ne(and_(threadId, i32_val(1 << i)), zero),
                                 int_val(numThreadPerWarp, 0), fullMask);
@@ -77,10 +85,155 @@ static SmallVector<Value> computeWarpLevelHistogram(
 
 static void atomicAdd(Value ptr, Value val, Location loc,
                       ConversionPatternRewriter &rewriter) {
-  rewriter.create<LLVM::AtomicRMWOp>(loc, LLVM::AtomicBinOp::add, ptr, val,
+  auto binOp = isa<FloatType>(val.getType()) ? LLVM::AtomicBinOp::fadd
+                                              : LLVM::AtomicBinOp::add;
+  rewriter.create<LLVM::AtomicRMWOp>(loc, binOp, ptr, val,
                                      LLVM::AtomicOrdering::monotonic);
 }
 
+// Emits the atomic add only for the threads where `pred` is true, or for all
+// threads if it is null.
+static void predicatedAtomicAdd(Value ptr, Value val, Value pred, Location loc,
+                                ConversionPatternRewriter &rewriter) {
+  if (!pred) {
+    atomicAdd(ptr, val, loc, rewriter);
+    return;
+  }
+  Block *currentBlock = rewriter.getInsertionBlock();
+  Block *afterAtomic =
+      rewriter.splitBlock(currentBlock, rewriter.getInsertionPoint());
+  Block *atomicBlock = rewriter.createBlock(afterAtomic);
+  rewriter.setInsertionPointToEnd(currentBlock);
+  rewriter.create<LLVM::CondBrOp>(loc, pred, atomicBlock, afterAtomic);
+  rewriter.setInsertionPointToStart(atomicBlock);
+  atomicAdd(ptr, val, loc, rewriter);
+  rewriter.create<LLVM::BrOp>(loc, afterAtomic);
+  rewriter.setInsertionPointToStart(afterAtomic);
+}
+
+// Returns the bits of `inDim` that only select between copies of the same
+// elements, as their bases are zero.
+static int32_t getBroadcastMask(const LinearLayout &layout, StringAttr inDim) {
+  int32_t mask = 0;
+  for (int i = 0; i < layout.getInDimSizeLog2(inDim); ++i) {
+    if (llvm::all_of(layout.getBasis(inDim, i), [](int32_t b) { return !b; }))
+      mask |= 1 << i;
+  }
+  return mask;
+}
+
+// Compute the histogram with shared memory atomics. Each group of warps adds
+// its elements to a private copy of the bins, and the threads read the result
+// by summing the copies. If the copies do not fit in the scratch buffer, the
+// bins are counted in several passes over the input, each over a range of
+// them. Unlike the warp ballots, this supports weights and any number of
+// bins, and ignores the elements outside of the bins.
+static SmallVector<Value> computeHistogramWithAtomics(
+    Location loc, ConversionPatternRewriter &rewriter,
+    const HistogramLoweringHelper &helper, RankedTensorType srcType,
+    Value baseSharedMemPtr, ArrayRef<Value> srcValues,
+    ArrayRef<Value> maskValues, ArrayRef<Value> weightValues, Type binType,
+    const SmallVector<Value> &indices, Value threadId, int numThreadPerWarp,
+    int numWarps) {
+  MLIRContext *ctx = rewriter.getContext();
+  StringAttr kRegister = str_attr("register");
+  StringAttr kLane = str_attr("lane");
+  StringAttr kWarp = str_attr("warp");
+  LinearLayout srcLayout =
+      *triton::gpu::toLinearLayout(srcType.getShape(), srcType.getEncoding());
+  int32_t regBroadcastMask = getBroadcastMask(srcLayout, kRegister);
+  int32_t laneBroadcastMask = getBroadcastMask(srcLayout, kLane);
+  int32_t warpBroadcastMask = getBroadcastMask(srcLayout, kWarp);
+  Value laneId = urem(threadId, i32_val(numThreadPerWarp));
+  Value warpId = udiv(threadId, i32_val(numThreadPerWarp));
+
+  // Only one copy of each element is counted.
+  Value isUnique;
+  auto addCondition = [&](Value cond) {
+    isUnique = isUnique ? and_(isUnique, cond) : cond;
+  };
+  if (laneBroadcastMask) {
+    addCondition(
+        icmp_eq(and_(laneId, i32_val(laneBroadcastMask)), i32_val(0)));
+  }
+  if (warpBroadcastMask) {
+    addCondition(
+        icmp_eq(and_(warpId, i32_val(warpBroadcastMask)), i32_val(0)));
+  }
+
+  unsigned numCopies = helper.getNumPrivateCopies();
+  unsigned numBinsPerPass = helper.getNumBinsPerPass();
+  unsigned numPasses = helper.getNumPasses();
+  unsigned numScratchBins = numCopies * numBinsPerPass;
+  Value copyBase =
+      mul(urem(warpId, i32_val(numCopies)), i32_val(numBinsPerPass));
+  unsigned srcBitWidth = srcType.getElementTypeBitWidth();
+  Value zero = isa<FloatType>(binType) ? f32_val(0) : i32_val(0);
+  Value one = isa<FloatType>(binType) ? f32_val(1) : i32_val(1);
+  auto binPtr = [&](Value offset) {
+    return gep(baseSharedMemPtr.getType(), binType, baseSharedMemPtr, offset);
+  };
+
+  SmallVector<Value> histogramValues(indices.size(), zero);
+  for (unsigned pass = 0; pass < numPasses; ++pass) {
+    unsigned firstBin = pass * numBinsPerPass;
+    // Initialize the shared memory with zeros.
+    int numThreads = numThreadPerWarp * numWarps;
+    for (int i = 0; i < ceil<int>(numScratchBins, numThreads); ++i) {
+      Value offset = add(threadId, i32_val(i * numThreads));
+      offset = urem(offset, i32_val(numScratchBins));
+      store(zero, binPtr(offset));
+    }
+    barrier();
+
+    // Add the elements of the range of bins of this pass to the copy of the
+    // bins of the warp.
+    for (auto [i, value] : llvm::enumerate(srcValues)) {
+      if (i & regBroadcastMask)
+        continue;
+      Value bin = sub(value, int_val(srcBitWidth, firstBin));
+      Value pred = icmp_ult(bin, int_val(srcBitWidth, numBinsPerPass));
+      if (isUnique)
+        pred = and_(pred, isUnique);
+      if (!maskValues.empty())
+        pred = and_(pred, maskValues[i]);
+      if (srcBitWidth > 32)
+        bin = trunc(i32_ty, bin);
+      else if (srcBitWidth < 32)
+        bin = zext(i32_ty, bin);
+      Value weight = weightValues.empty() ? one : weightValues[i];
+      predicatedAtomicAdd(binPtr(add(copyBase, bin)), weight, pred, loc,
+                          rewriter);
+    }
+    barrier();
+
+    // Merge the copies of the bins of the result held by each thread.
+    for (auto [i, index] : llvm::enumerate(indices)) {
+      Value bin = sub(index, i32_val(firstBin));
+      Value inPass;
+      if (numPasses > 1) {
+        inPass = icmp_ult(bin, i32_val(numBinsPerPass));
+        bin = urem(bin, i32_val(numBinsPerPass));
+      }
+      Value sum;
+      for (unsigned copy = 0; copy < numCopies; ++copy) {
+        Value val =
+            load(binType, binPtr(add(bin, i32_val(copy * numBinsPerPass))));
+        if (!sum)
+          sum = val;
+        else
+          sum = isa<FloatType>(binType) ? fadd(sum, val) : add(sum, val);
+      }
+      histogramValues[i] =
+          inPass ? select(inPass, sum, histogramValues[i]) : sum;
+    }
+    // The next pass reuses the shared memory.
+    if (pass + 1 < numPasses)
+      barrier();
+  }
+  return histogramValues;
+}
+
 static SmallVector<Value> computeCrossWarpHistogram(
     Location loc, ConversionPatternRewriter &rewriter, RankedTensorType srcType,
     Value baseSharedMemPtr, const SmallVector<Value> &warpLevelHistogram,
@@ -159,6 +312,12 @@ public:
     Value input = adaptor.getSrc();
     auto typeConverter = getTypeConverter();
     SmallVector<Value> srcValues = unpackLLElements(loc, input, rewriter);
+    SmallVector<Value> maskValues;
+    if (Value mask = adaptor.getMask())
+      maskValues = unpackLLElements(loc, mask, rewriter);
+    SmallVector<Value> weightValues;
+    if (Value weights = adaptor.getWeights())
+      weightValues = unpackLLElements(loc, weights, rewriter);
     int numBins = op.getType().getDimSize(0);
     auto mod = op->getParentOfType<ModuleOp>();
     int numThreadsPerWarp =
@@ -167,20 +326,8 @@ public:
            numThreadsPerWarp == 64 &&
                "Only supports 32 or 64 threads per warp");
     int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
-    // Pad out the bins so that we have at least one bin per thread within a
-    // warp.
-    numBins = std::max(numBins, numThreadsPerWarp);
     Value threadId = getThreadId(rewriter, loc);
     auto srcType = op.getSrc().getType();
-    // First compute a warp local histogram based on values owned by each warps.
-    SmallVector<Value> warpLevelHistogram = computeWarpLevelHistogram(
-        loc, srcType, srcValues, numBins, numThreadsPerWarp, threadId, rewriter,
-        targetInfo);
-
-    // Then use atomic to update the histogram in shared memory.
-    // TODO: we could skip this for cases with num_warps=1 as long as we can
-    // generate the right layout. Currently the warp level histogram generates
-    // data in the default blocked layout.
     Value baseSharedMemPtr =
         LLVM::getSharedMemoryBase(loc, rewriter, op.getOperation());
     auto dstType = op.getType();
@@ -190,9 +337,33 @@ public:
     SmallVector<Value> innerDimIndices;
     for (int i = 0; i < indices.size(); ++i)
       innerDimIndices.push_back(indices[i][0]);
-    SmallVector<Value> histogramValue = computeCrossWarpHistogram(
-        loc, rewriter, srcType, baseSharedMemPtr, warpLevelHistogram, numBins,
-        numThreadsPerWarp, innerDimIndices, threadId, numWarps);
+
+    HistogramLoweringHelper helper(op);
+    SmallVector<Value> histogramValue;
+    if (helper.usesWarpBallots()) {
+      // Pad out the bins so that we have at least one bin per thread within a
+      // warp.
+      numBins = std::max(numBins, numThreadsPerWarp);
+      // First compute a warp local histogram based on values owned by each
+      // warps.
+      SmallVector<Value> warpLevelHistogram = computeWarpLevelHistogram(
+          loc, srcType, srcValues, maskValues, numBins, numThreadsPerWarp,
+          threadId, rewriter, targetInfo);
+
+      // Then use atomic to update the histogram in shared memory.
+      // TODO: we could skip this for cases with num_warps=1 as long as we can
+      // generate the right layout. Currently the warp level histogram
+      // generates data in the default blocked layout.
+      histogramValue = computeCrossWarpHistogram(
+          loc, rewriter, srcType, baseSharedMemPtr, warpLevelHistogram,
+          numBins, numThreadsPerWarp, innerDimIndices, threadId, numWarps);
+    } else {
+      Type binType = typeConverter->convertType(dstType.getElementType());
+      histogramValue = computeHistogramWithAtomics(
+          loc, rewriter, helper, srcType, baseSharedMemPtr, srcValues,
+          maskValues, weightValues, binType, innerDimIndices, threadId,
+          numThreadsPerWarp, numWarps);
+    }
 
     Value results = packLLElements(loc, typeConverter, histogramValue, rewriter,
                                    op.getType());
@@ -132,6 +132,29 @@ private:
   const TargetInfoBase &targetInfo;
 };
 
+struct GlobalScratchAllocOpConversion
+    : public ConvertOpToLLVMPattern<triton::GlobalScratchAllocOp> {
+  using ConvertOpToLLVMPattern<
+      triton::GlobalScratchAllocOp>::ConvertOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::GlobalScratchAllocOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Location loc = op.getLoc();
+    auto offset =
+        op->getAttrOfType<IntegerAttr>(LLVM::kGlobalScratchOffsetAttrName);
+    if (!offset)
+      return op.emitError("global scratch memory was not allocated");
+    // The buffer is the last argument of the kernel.
+    auto funcOp = op->getParentOfType<LLVM::LLVMFuncOp>();
+    Value base = funcOp.getArgument(funcOp.getNumArguments() - 1);
+    Type ptrTy = getTypeConverter()->convertType(op.getType());
+    Value ptr = gep(ptrTy, i8_ty, base, i32_val(offset.getInt()));
+    rewriter.replaceOp(op, ptr);
+    return success();
+  }
+};
+
 } // namespace
 
 void mlir::triton::populateMemoryOpToLLVMPattern(
@@ -140,4 +163,5 @@ void mlir::triton::populateMemoryOpToLLVMPattern(
   patterns.add<LocalAllocOpConversion>(typeConverter, targetInfo, benefit);
   patterns.add<LocalDeallocOpConversion>(typeConverter, benefit);
   patterns.add<LocalStoreOpConversion>(typeConverter, targetInfo, benefit);
+  patterns.add<GlobalScratchAllocOpConversion>(typeConverter, benefit);
 }
@@ -5,6 +5,7 @@
 #include "triton/Conversion/TritonGPUToLLVM/TargetInfoBase.h"
 #include "triton/Conversion/TritonGPUToLLVM/Utility.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
+#include "llvm/Support/JSON.h"
 
 namespace {
 
@@ -13,7 +14,8 @@ namespace {
 //  - one or more "operands" (tensors).
 //
 // For each operand, we print all of the values contained in this GPU thread,
-// one per line, along with the index of the value in its tensor.
+// one per line, along with the index of the value in its tensor.  If the
+// module has a device log, the values are appended to it instead.
 struct PrintOpConversion : public ConvertOpToLLVMPattern<triton::PrintOp> {
   explicit PrintOpConversion(LLVMTypeConverter &typeConverter,
                              const TargetInfoBase &targetInfo,
@@ -25,6 +27,11 @@ struct PrintOpConversion : public ConvertOpToLLVMPattern<triton::PrintOp> {
   matchAndRewrite(triton::PrintOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
     auto loc = op->getLoc();
+    if (auto log = LLVM::getDeviceLog(op->getParentOfType<ModuleOp>())) {
+      logPrint(op, adaptor, log, rewriter);
+      rewriter.eraseOp(op);
+      return success();
+    }
 
     auto getPid = [&](int axis) {
       return targetInfo.programId(rewriter, loc,
@@ -83,6 +90,92 @@ struct PrintOpConversion : public ConvertOpToLLVMPattern<triton::PrintOp> {
     return success();
   }
 
+  // Appends a record to the device log `log` for each of the values of the
+  // operands in this GPU thread, or a single record if there are none. The
+  // value of a record is the bits of the element, zero-extended, and its index
+  // the row-major index of the element in its tensor.
+  void logPrint(triton::PrintOp op, OpAdaptor adaptor, LLVM::GlobalOp log,
+                ConversionPatternRewriter &rewriter) const {
+    auto loc = op->getLoc();
+    auto mod = op->getParentOfType<ModuleOp>();
+    auto getSite = [&](std::optional<unsigned> operand) {
+      llvm::json::Object site{{"kind", "print"},
+                              {"prefix", op.getPrefix().str()},
+                              {"hex", op.getHex()}};
+      if (auto fileLoc = loc->findInstanceOf<FileLineColLoc>())
+        site["loc"] = (fileLoc.getFilename().getValue() + ":" +
+                       Twine(fileLoc.getLine()))
+                          .str();
+      if (operand) {
+        Type type = op.getOperand(*operand).getType();
+        std::string elemTy;
+        llvm::raw_string_ostream os(elemTy);
+        getElementTypeOrSelf(type).print(os);
+        site["operand"] = *operand;
+        site["num_operands"] = op.getNumOperands();
+        site["type"] = elemTy;
+        llvm::json::Array shape;
+        if (auto rankedTy = dyn_cast<RankedTensorType>(type))
+          shape = llvm::json::Array(rankedTy.getShape());
+        site["shape"] = std::move(shape);
+      }
+      std::string json;
+      llvm::raw_string_ostream os(json);
+      os << llvm::json::Value(std::move(site));
+      return LLVM::addDeviceLogSite(mod, json);
+    };
+
+    if (op.getNumOperands() == 0) {
+      Value index = LLVM::reserveDeviceLogRecords(rewriter, loc, log, 1);
+      LLVM::storeDeviceLogRecord(rewriter, loc, targetInfo, log, index,
+                                 getSite(std::nullopt), i32_val(0),
+                                 i64_val(0));
+      return;
+    }
+
+    SmallVector<SmallVector<Value>> operandElems;
+    unsigned numRecords = 0;
+    for (Value operand : adaptor.getOperands()) {
+      operandElems.push_back(unpackLLElements(loc, operand, rewriter));
+      numRecords += operandElems.back().size();
+    }
+    Value index = LLVM::reserveDeviceLogRecords(rewriter, loc, log, numRecords);
+    for (auto [i, elems] : llvm::enumerate(operandElems)) {
+      unsigned site = getSite(i);
+      SmallVector<Value> elemIndices;
+      if (auto rankedTy =
+              dyn_cast<RankedTensorType>(op.getOperand(i).getType())) {
+        auto indices = emitIndices(loc, rewriter, targetInfo,
+                                   rankedTy.getEncoding(), rankedTy, true);
+        for (auto &multiDim : indices) {
+          Value linear = i32_val(0);
+          for (auto [dim, size] : llvm::zip(multiDim, rankedTy.getShape()))
+            linear = add(mul(linear, i32_val(size)), dim);
+          elemIndices.push_back(linear);
+        }
+      } else {
+        elemIndices.push_back(i32_val(0));
+      }
+      for (auto [elem, elemIndex] : llvm::zip(elems, elemIndices)) {
+        LLVM::storeDeviceLogRecord(rewriter, loc, targetInfo, log, index,
+                                   site, elemIndex,
+                                   getValueBits(elem, rewriter));
+        index = add(index, i32_val(1));
+      }
+    }
+  }
+
+  Value getValueBits(Value value, ConversionPatternRewriter &rewriter) const {
+    auto loc = value.getLoc();
+    Type type = value.getType();
+    if (isa<LLVM::LLVMPointerType>(type))
+      return ptrtoint(i64_ty, value);
+    unsigned bitWidth = type.getIntOrFloatBitWidth();
+    if (!type.isInteger())
+      value = bitcast(value, int_ty(bitWidth));
+    return bitWidth < 64 ? zext(i64_ty, value) : value;
+  }
+
   void printTensor(StringRef prefixStr, size_t operand, size_t numOperands,
                    ArrayRef<Value> elems, std::array<Value, 3> pid,
                    ArrayRef<SmallVector<Value>> indices,
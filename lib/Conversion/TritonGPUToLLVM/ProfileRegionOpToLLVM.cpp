@@ -0,0 +1,89 @@
+#include "mlir/Conversion/LLVMCommon/Pattern.h"
+#include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
+#include "triton/Conversion/TritonGPUToLLVM/PatternTritonGPUOpToLLVM.h"
+#include "triton/Conversion/TritonGPUToLLVM/TargetInfoBase.h"
+#include "triton/Conversion/TritonGPUToLLVM/Utility.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+
+namespace {
+
+using namespace mlir;
+
+// Every warp reads the timer, and its first lane appends the record:
+//
+//   base = buffer + (programIndex * numWarps + warpId) * (1 + 2 * capacity)
+//   count = base[0]
+//   record = base + 1 + 2 * (count % capacity)
+//   record[0] = timestamp
+//   record[1] = regionId * 2 + isEnd
+//   base[0] = count + 1
+struct ProfileRegionOpConversion
+    : public ConvertOpToLLVMPattern<triton::ProfileRegionOp> {
+  explicit ProfileRegionOpConversion(LLVMTypeConverter &typeConverter,
+                                     const TargetInfoBase &targetInfo,
+                                     PatternBenefit benefit)
+      : ConvertOpToLLVMPattern<triton::ProfileRegionOp>(typeConverter,
+                                                        benefit),
+        targetInfo(targetInfo) {}
+
+  LogicalResult
+  matchAndRewrite(triton::ProfileRegionOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op.getLoc();
+    auto moduleOp = op->getParentOfType<ModuleOp>();
+    int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(moduleOp);
+    int threadsPerWarp =
+        triton::gpu::TritonGPUDialect::getThreadsPerWarp(moduleOp);
+    uint64_t capacity = op.getCapacity();
+    uint64_t tag = 2 * static_cast<uint64_t>(op.getRegionId()) +
+                   static_cast<uint64_t>(op.getIsEnd());
+
+    // Read the timer first, so that the bookkeeping below is not measured
+    Value time = targetInfo.timestamp(rewriter, loc);
+    Value threadId = getThreadId(rewriter, loc);
+    Value warpId = udiv(threadId, i32_val(threadsPerWarp));
+    Value laneId = urem(threadId, i32_val(threadsPerWarp));
+
+    // #prevBlock
+    // if (laneId == 0) {
+    //   #ifBlock
+    //   append the record
+    // }
+    // #thenBlock
+    Block *prevBlock = op->getBlock();
+    Block *ifBlock = rewriter.splitBlock(prevBlock, op->getIterator());
+    rewriter.setInsertionPointToStart(ifBlock);
+    auto ptrTy = adaptor.getBuffer().getType();
+    Value warpIndex = zext(
+        i64_ty, add(mul(adaptor.getProgramIndex(), i32_val(numWarps)), warpId));
+    Value base = gep(ptrTy, i64_ty, adaptor.getBuffer(),
+                     mul(warpIndex, i64_val(1 + 2 * capacity)));
+    Value count = load(i64_ty, base);
+    Value slot = urem(count, i64_val(capacity));
+    Value record =
+        gep(ptrTy, i64_ty, base, add(i64_val(1), mul(slot, i64_val(2))));
+    store(time, record);
+    store(i64_val(tag), gep(ptrTy, i64_ty, record, i64_val(1)));
+    store(add(count, i64_val(1)), base);
+
+    Block *thenBlock = rewriter.splitBlock(ifBlock, op->getIterator());
+    rewriter.setInsertionPointToEnd(ifBlock);
+    rewriter.create<cf::BranchOp>(loc, thenBlock);
+    rewriter.setInsertionPointToEnd(prevBlock);
+    rewriter.create<cf::CondBranchOp>(loc, icmp_eq(laneId, i32_val(0)),
+                                      ifBlock, thenBlock);
+    rewriter.eraseOp(op);
+    return success();
+  }
+
+protected:
+  const TargetInfoBase &targetInfo;
+};
+
+} // namespace
+
+void mlir::triton::populateProfileRegionOpToLLVMPattern(
+    LLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
+    const TargetInfoBase &targetInfo, PatternBenefit benefit) {
+  patterns.add<ProfileRegionOpConversion>(typeConverter, targetInfo, benefit);
+}
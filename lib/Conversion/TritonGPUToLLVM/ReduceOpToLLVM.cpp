@@ -48,11 +48,16 @@ public:
       return success();
     }
 
-    // Compute a shared memory base per operand.
+    // Compute a shared memory base per operand, or a single one when the
+    // operands are packed together.
     auto smemShape = helper.getScratchConfig();
 
-    SmallVector<Value> smemBases =
-        getSmemBases(op, product<unsigned>(smemShape), rewriter);
+    SmallVector<Value> smemBases;
+    if (helper.getSmemVectorSize() > 1)
+      smemBases.push_back(
+          LLVM::getSharedMemoryBase(loc, rewriter, op.getOperation()));
+    else
+      smemBases = getSmemBases(op, product<unsigned>(smemShape), rewriter);
 
     storeWarpReduceToSharedMemory(helper, accs, indices, smemBases, rewriter);
 
@@ -135,6 +140,41 @@ private:
     barrier();
   }
 
+  // The type of the vectors in which the values of all the operands go
+  // through shared memory together.
+  Type getSmemVectorType(ReduceOpHelper &helper,
+                         ConversionPatternRewriter &rewriter) const {
+    triton::ReduceOp op = helper.getOperation();
+    unsigned bitWidth = getElementType(op, 0).getIntOrFloatBitWidth();
+    return vec_ty(int_ty(bitWidth), helper.getSmemVectorSize());
+  }
+
+  Value packOperands(ReduceOpHelper &helper, ValueRange vals,
+                     ConversionPatternRewriter &rewriter) const {
+    Location loc = helper.getOperation().getLoc();
+    auto vecTy = cast<VectorType>(getSmemVectorType(helper, rewriter));
+    Value packed = undef(vecTy);
+    for (auto [i, val] : llvm::enumerate(vals)) {
+      packed = insert_element(vecTy, packed,
+                              bitcast(val, vecTy.getElementType()),
+                              i32_val(i));
+    }
+    return packed;
+  }
+
+  SmallVector<Value> unpackOperands(ReduceOpHelper &helper, Value packed,
+                                    ConversionPatternRewriter &rewriter) const {
+    triton::ReduceOp op = helper.getOperation();
+    Location loc = op.getLoc();
+    auto vecTy = cast<VectorType>(packed.getType());
+    SmallVector<Value> vals;
+    for (unsigned i = 0; i < op.getNumOperands(); ++i) {
+      Value val = extract_element(vecTy.getElementType(), packed, i32_val(i));
+      vals.push_back(bitcast(val, getElementType(op, i)));
+    }
+    return vals;
+  }
+
   // Reduce along op axis for elements that are in the same thread. The
   // accumulated value is stored in accs.
   void reduceWithinThreads(
@@ -183,7 +223,12 @@ private:
     for (unsigned N = numLaneToReduce / 2; N > 0; N >>= 1) {
       SmallVector<Value> shfl(acc.size());
       for (unsigned i = 0; i < acc.size(); ++i) {
-        shfl[i] = targetInfo.shuffleXor(rewriter, loc, acc[i], N * interleave);
+        // Interleaved lanes belong to different reductions, which only a xor
+        // with the exact stride keeps apart.
+        shfl[i] = interleave == 1
+                      ? targetInfo.shuffleXorForReduce(rewriter, loc, acc[i], N)
+                      : targetInfo.shuffleXor(rewriter, loc, acc[i],
+                                              N * interleave);
       }
       accumulate(rewriter, op.getCombineOp(), acc, shfl, false);
     }
@@ -213,28 +258,150 @@ private:
     triton::ReduceOp op = helper.getOperation();
     Location loc = op.getLoc();
     unsigned axis = op.getAxis();
+    auto resultTy = dyn_cast<RankedTensorType>(op.getResult()[0].getType());
+    SmallVector<SmallVector<Value>> resultVals(op.getNumOperands());
+    if (resultTy) {
+      auto resultLayout = cast<SliceEncodingAttr>(resultTy.getEncoding());
+      unsigned resultElems = getTotalElemsPerThread(resultTy);
+      SmallVector<SmallVector<unsigned>> resultOffset =
+          emitOffsetForLayout(resultLayout, resultTy);
+      for (int j = 0; j < resultElems; j++) {
+        auto key = resultOffset[j];
+        key.insert(key.begin() + axis, 0);
+        for (unsigned i = 0; i < op.getNumOperands(); ++i)
+          resultVals[i].push_back(accs[key][i]);
+      }
+    } else {
+      for (unsigned i = 0; i < op.getNumOperands(); ++i)
+        resultVals[i].push_back(accs.begin()->second[i]);
+    }
+    if (!helper.isReduceWithinCTA())
+      reduceAcrossCTAs(helper, resultVals, resultTy, rewriter);
+
     SmallVector<Value> results(op.getNumOperands());
     for (unsigned i = 0; i < op.getNumOperands(); ++i) {
-      if (auto resultTy =
-              dyn_cast<RankedTensorType>(op.getResult()[i].getType())) {
-        auto resultLayout = cast<SliceEncodingAttr>(resultTy.getEncoding());
-        unsigned resultElems = getTotalElemsPerThread(resultTy);
-        SmallVector<SmallVector<unsigned>> resultOffset =
-            emitOffsetForLayout(resultLayout, resultTy);
-        SmallVector<Value> resultVals;
-        for (int j = 0; j < resultElems; j++) {
-          auto key = resultOffset[j];
-          key.insert(key.begin() + axis, 0);
-          resultVals.push_back(accs[key][i]);
-        }
-        results[i] = packLLElements(loc, getTypeConverter(), resultVals,
+      if (resultTy)
+        results[i] = packLLElements(loc, getTypeConverter(), resultVals[i],
                                     rewriter, resultTy);
-      } else
-        results[i] = accs.begin()->second[i];
+      else
+        results[i] = resultVals[i][0];
     }
     rewriter.replaceOp(op, results);
   }
 
+  // Returns whether the thread is the first of the threads whose values are
+  // the same reductions, i.e. whose position along the axis is 0.
+  Value isFirstAlongAxis(ReduceOpHelper &helper,
+                         ConversionPatternRewriter &rewriter) const {
+    triton::ReduceOp op = helper.getOperation();
+    Location loc = op.getLoc();
+    auto srcLayout = helper.getSrcLayout();
+    Value threadId = getThreadId(rewriter, loc);
+    Value warpSize = i32_val(triton::gpu::getWarpSize(srcLayout));
+    Value warpId = udiv(threadId, warpSize);
+    Value laneId = urem(threadId, warpSize);
+    auto threadsPerWarp = triton::gpu::getThreadsPerWarpWithUniqueData(
+        srcLayout, helper.getSrcShape());
+    SmallVector<Value> multiDimLaneId =
+        delinearize(rewriter, loc, laneId, threadsPerWarp, getOrder(srcLayout));
+    SmallVector<Value> multiDimWarpId =
+        getMultiDimWarpId(helper, warpId, loc, rewriter);
+    Value zero = i32_val(0);
+    return and_(icmp_eq(multiDimLaneId[op.getAxis()], zero),
+                icmp_eq(multiDimWarpId[op.getAxis()], zero));
+  }
+
+  // Combine the reductions `vals` of the CTAs of the cluster across which the
+  // axis is split, in the layout of `resultTy` or as scalars if it is null.
+  // Each CTA stores its reductions into the shared memory of every CTA of its
+  // group, in the slot of its position in the group, and then combines the
+  // slots in order, so that all the CTAs of the group get the same result.
+  void reduceAcrossCTAs(ReduceOpHelper &helper,
+                        SmallVector<SmallVector<Value>> &vals,
+                        RankedTensorType resultTy,
+                        ConversionPatternRewriter &rewriter) const {
+    triton::ReduceOp op = helper.getOperation();
+    Location loc = op.getLoc();
+    MLIRContext *ctx = rewriter.getContext();
+    unsigned axis = op.getAxis();
+    unsigned numCTAs = helper.getNumCTAsAlongAxis();
+    unsigned slotElems = helper.getResultElemsPerCTA();
+    auto srcLayout = helper.getSrcLayout();
+
+    // The CTAs of the group only differ in their position along the axis.
+    auto CTAsPerCGA = triton::gpu::getCTAsPerCGA(srcLayout);
+    auto CTAOrder = triton::gpu::getCTAOrder(srcLayout);
+    Value clusterCTAId = targetInfo.getClusterCTAId(rewriter, loc);
+    SmallVector<Value> multiDimCTAId =
+        delinearize(rewriter, loc, clusterCTAId, CTAsPerCGA, CTAOrder);
+    Value slot = urem(multiDimCTAId[axis], i32_val(numCTAs));
+    Value groupStart = sub(multiDimCTAId[axis], slot);
+
+    // The offsets of the values in the slots.
+    unsigned numElems = vals[0].size();
+    SmallVector<Value> offsets(numElems, i32_val(0));
+    if (resultTy) {
+      auto resultLayout = resultTy.getEncoding();
+      auto shapePerCTA = convertType<unsigned>(
+          triton::gpu::getShapePerCTA(resultTy));
+      auto resultCTATile =
+          getShapePerCTATile(resultLayout, resultTy.getShape());
+      auto resultIndices = emitIndices(loc, rewriter, targetInfo, resultLayout,
+                                       resultTy, /*withCTAOffset=*/false);
+      for (unsigned j = 0; j < numElems; ++j) {
+        SmallVector<Value> idx = resultIndices[j];
+        for (unsigned d = 0; d < idx.size(); ++d)
+          if (resultCTATile[d] > shapePerCTA[d])
+            idx[d] = urem(idx[d], i32_val(shapePerCTA[d]));
+        offsets[j] = linearize(rewriter, loc, idx, shapePerCTA,
+                               getOrder(resultLayout));
+      }
+    }
+
+    SmallVector<Value> bases;
+    Value smemBase =
+        LLVM::getSharedMemoryBase(loc, rewriter, op.getOperation());
+    SmallVector<unsigned> byteOffsets = helper.getCrossCTAOffsets();
+    for (unsigned i = 0; i < op.getNumOperands(); ++i)
+      bases.push_back(gep(ptr_ty(ctx, 3), i8_ty, smemBase,
+                          i32_val(byteOffsets[i])));
+
+    // The other CTAs may still use their shared memory for the ops before.
+    targetInfo.clusterBarrier(rewriter, loc);
+    Value pred = isFirstAlongAxis(helper, rewriter);
+    Value slotStart = mul(slot, i32_val(slotElems));
+    for (unsigned p = 0; p < numCTAs; ++p) {
+      SmallVector<Value> peerCTAId = multiDimCTAId;
+      peerCTAId[axis] = add(groupStart, i32_val(p));
+      Value peer = linearize(rewriter, loc, peerCTAId, CTAsPerCGA, CTAOrder);
+      for (unsigned j = 0; j < numElems; ++j) {
+        for (unsigned i = 0; i < op.getNumOperands(); ++i) {
+          Value writePtr = gep(ptr_ty(ctx, 3), getElementType(op, i), bases[i],
+                               add(slotStart, offsets[j]));
+          targetInfo.storeDShared(rewriter, loc, writePtr, peer, vals[i][j],
+                                  pred);
+        }
+      }
+    }
+    targetInfo.clusterBarrier(rewriter, loc);
+
+    for (unsigned j = 0; j < numElems; ++j) {
+      SmallVector<Value> acc;
+      for (unsigned p = 0; p < numCTAs; ++p) {
+        SmallVector<Value> cur(op.getNumOperands());
+        for (unsigned i = 0; i < op.getNumOperands(); ++i) {
+          auto elemTy = getElementType(op, i);
+          Value readPtr = gep(ptr_ty(ctx, 3), elemTy, bases[i],
+                              add(i32_val(p * slotElems), offsets[j]));
+          cur[i] = load(elemTy, readPtr);
+        }
+        accumulate(rewriter, op.getCombineOp(), acc, cur, p == 0);
+      }
+      for (unsigned i = 0; i < op.getNumOperands(); ++i)
+        vals[i][j] = acc[i];
+    }
+  }
+
   SmallVector<Value>
   getMultiDimWarpId(ReduceOpHelper &helper, Value &warpId, Location &loc,
                     ConversionPatternRewriter &rewriter) const {
@@ -302,6 +469,14 @@ private:
       writeIdx[axis] = warpIdAxis;
       Value writeOffset =
           linearize(rewriter, loc, writeIdx, smemShape, smemOrder);
+      if (helper.getSmemVectorSize() > 1) {
+        Type vecTy = getSmemVectorType(helper, rewriter);
+        Value writePtr = gep(ptr_ty(rewriter.getContext(), 3), vecTy,
+                             smemBases[0], writeOffset);
+        targetInfo.storeShared(rewriter, loc, writePtr,
+                               packOperands(helper, acc, rewriter), laneZero);
+        continue;
+      }
       for (unsigned i = 0; i < op.getNumOperands(); ++i) {
         auto elemTy = getElementType(op, i);
         Value writePtr = gep(ptr_ty(rewriter.getContext(), 3), elemTy,
@@ -335,32 +510,47 @@ private:
     unsigned elemsPerThread = std::max<unsigned>(elems / numThreads, 1);
     Value threadIsNeeded = icmp_slt(threadId, i32_val(elems));
     Value readOffset = threadId;
+    bool isPacked = helper.getSmemVectorSize() > 1;
     for (unsigned round = 0; round < elemsPerThread; ++round) {
       SmallVector<Value> acc(op.getNumOperands());
-      for (unsigned i = 0; i < op.getNumOperands(); ++i) {
-        auto elemTy = getElementType(op, i);
-        Value readPtr = gep(ptr_ty(rewriter.getContext(), 3), elemTy,
-                            smemBases[i], readOffset);
-        acc[i] = targetInfo.loadShared(rewriter, loc, readPtr, elemTy,
-                                       threadIsNeeded);
+      if (isPacked) {
+        Type vecTy = getSmemVectorType(helper, rewriter);
+        Value readPtr = gep(ptr_ty(rewriter.getContext(), 3), vecTy,
+                            smemBases[0], readOffset);
+        acc = unpackOperands(helper,
+                             targetInfo.loadShared(rewriter, loc, readPtr,
+                                                   vecTy, threadIsNeeded),
+                             rewriter);
+      } else {
+        for (unsigned i = 0; i < op.getNumOperands(); ++i) {
+          auto elemTy = getElementType(op, i);
+          Value readPtr = gep(ptr_ty(rewriter.getContext(), 3), elemTy,
+                              smemBases[i], readOffset);
+          acc[i] = targetInfo.loadShared(rewriter, loc, readPtr, elemTy,
+                                         threadIsNeeded);
+        }
       }
       warpReduce(rewriter, loc, acc, op, sizeInterWarps, 1 /* interleave */);
       // only the first thread in each sizeInterWarps is writing
       Value writeOffset = readOffset;
-      SmallVector<Value> writePtrs(op.getNumOperands());
-      for (unsigned i = 0; i < op.getNumOperands(); ++i) {
-        auto elemTy = getElementType(op, i);
-        writePtrs[i] = gep(ptr_ty(rewriter.getContext(), 3), elemTy,
-                           smemBases[i], writeOffset);
-      }
-
       Value laneIdModSizeInterWarps = urem(laneId, i32_val(sizeInterWarps));
       Value laneIdModSizeInterWarpsIsZero =
           icmp_eq(laneIdModSizeInterWarps, zero);
       Value pred = and_(threadIsNeeded, laneIdModSizeInterWarpsIsZero);
 
-      for (unsigned i = 0; i < op.getNumOperands(); ++i) {
-        targetInfo.storeShared(rewriter, loc, writePtrs[i], acc[i], pred);
+      if (isPacked) {
+        Type vecTy = getSmemVectorType(helper, rewriter);
+        Value writePtr = gep(ptr_ty(rewriter.getContext(), 3), vecTy,
+                             smemBases[0], writeOffset);
+        targetInfo.storeShared(rewriter, loc, writePtr,
+                               packOperands(helper, acc, rewriter), pred);
+      } else {
+        for (unsigned i = 0; i < op.getNumOperands(); ++i) {
+          auto elemTy = getElementType(op, i);
+          Value writePtr = gep(ptr_ty(rewriter.getContext(), 3), elemTy,
+                               smemBases[i], writeOffset);
+          targetInfo.storeShared(rewriter, loc, writePtr, acc[i], pred);
+        }
       }
 
       if (round != elemsPerThread - 1) {
@@ -369,60 +559,133 @@ private:
     }
   }
 
+  // Returns the convert_layout consuming `result`, if it is its only user and
+  // converts it to a layout in which the reduction can be read from shared
+  // memory directly.
+  triton::gpu::ConvertLayoutOp getConsumerConvert(Value result) const {
+    if (!result.hasOneUse())
+      return {};
+    auto cvtOp =
+        dyn_cast<triton::gpu::ConvertLayoutOp>(*result.getUsers().begin());
+    if (!cvtOp || !isa<BlockedEncodingAttr, SliceEncodingAttr>(
+                      cvtOp.getType().getEncoding()))
+      return {};
+    return cvtOp;
+  }
+
+  // Load the final reduction of every operand from shared memory, in the
+  // layout of `resultTy`.
+  SmallVector<SmallVector<Value>>
+  loadReduction(ReduceOpHelper &helper, SmallVector<unsigned> smemShape,
+                SmallVector<Value> &smemBases, RankedTensorType resultTy,
+                ConversionPatternRewriter &rewriter) const {
+    triton::ReduceOp op = helper.getOperation();
+    Location loc = op.getLoc();
+    auto smemOrder = helper.getOrderWithAxisAtBeginning();
+    bool isPacked = helper.getSmemVectorSize() > 1;
+    auto resultLayout = resultTy.getEncoding();
+    unsigned resultElems = getTotalElemsPerThread(resultTy);
+    auto resultIndices =
+        emitIndices(loc, rewriter, targetInfo, resultLayout, resultTy, true);
+    auto resultShape = resultTy.getShape();
+    auto resultCTATile = getShapePerCTATile(resultLayout, resultShape);
+    assert(resultIndices.size() == resultElems);
+
+    SmallVector<SmallVector<Value>> resultVals(
+        op.getNumOperands(), SmallVector<Value>(resultElems));
+    for (size_t j = 0; j < resultElems; ++j) {
+      SmallVector<Value> readIdx = resultIndices[j];
+      readIdx.insert(readIdx.begin() + op.getAxis(), i32_val(0));
+      for (size_t resultIdx = 0, resultDim = resultShape.size();
+           resultIdx < resultDim; ++resultIdx) {
+        auto smemIdx = resultIdx < op.getAxis() ? resultIdx : resultIdx + 1;
+        if (resultCTATile[resultIdx] > smemShape[smemIdx] ||
+            resultShape[resultIdx] > smemShape[smemIdx]) {
+          // When srcShape smaller then src sizePerThread, only srcShape
+          // elements is accumulated in smem. Modulo smemShape effectively
+          // replicates srcShape elements to src sizePerThread.
+          readIdx[smemIdx] =
+              urem(readIdx[smemIdx], i32_val(smemShape[smemIdx]));
+        }
+      }
+      Value readOffset =
+          linearize(rewriter, loc, readIdx, smemShape, smemOrder);
+      if (isPacked) {
+        Type vecTy = getSmemVectorType(helper, rewriter);
+        Value readPtr = gep(ptr_ty(rewriter.getContext(), 3), vecTy,
+                            smemBases[0], readOffset);
+        SmallVector<Value> vals =
+            unpackOperands(helper, load(vecTy, readPtr), rewriter);
+        for (unsigned i = 0; i < op.getNumOperands(); ++i)
+          resultVals[i][j] = vals[i];
+        continue;
+      }
+      for (unsigned i = 0; i < op.getNumOperands(); ++i) {
+        auto elemTy = getElementType(op, i);
+        Value readPtr = gep(ptr_ty(rewriter.getContext(), 3), elemTy,
+                            smemBases[i], readOffset);
+        resultVals[i][j] = load(elemTy, readPtr);
+      }
+    }
+    return resultVals;
+  }
+
   // Load the final reduction from shared memory and replace the reduce result
-  // with it.
+  // with it. A result only consumed by a convert_layout is read in the layout
+  // of the convert, which is replaced as well.
   void loadReductionAndPackResult(ReduceOpHelper &helper,
                                   SmallVector<unsigned> smemShape,
                                   SmallVector<Value> &smemBases,
                                   ConversionPatternRewriter &rewriter) const {
     triton::ReduceOp op = helper.getOperation();
     Location loc = op.getLoc();
-    auto srcLayout = helper.getSrcLayout();
-    auto axis = op.getAxis();
-    auto smemOrder = helper.getOrderWithAxisAtBeginning();
     SmallVector<Value> results(op.getNumOperands());
-    for (unsigned i = 0; i < op.getNumOperands(); ++i) {
-      auto elemTy = getElementType(op, i);
-      if (auto resultTy =
-              dyn_cast<RankedTensorType>(op.getResult()[i].getType())) {
-        // nd-tensor where n >= 1
-        auto resultLayout = cast<SliceEncodingAttr>(resultTy.getEncoding());
-        unsigned resultElems = getTotalElemsPerThread(resultTy);
-        auto resultIndices = emitIndices(loc, rewriter, targetInfo,
-                                         resultLayout, resultTy, true);
-        auto resultShape = resultTy.getShape();
-        auto resultCTATile = getShapePerCTATile(resultLayout, resultShape);
-        assert(resultIndices.size() == resultElems);
-
-        SmallVector<Value> resultVals(resultElems);
-        for (size_t j = 0; j < resultElems; ++j) {
-          SmallVector<Value> readIdx = resultIndices[j];
-          readIdx.insert(readIdx.begin() + op.getAxis(), i32_val(0));
-          for (size_t resultIdx = 0, resultDim = resultShape.size();
-               resultIdx < resultDim; ++resultIdx) {
-            auto smemIdx = resultIdx < op.getAxis() ? resultIdx : resultIdx + 1;
-            if (resultCTATile[resultIdx] > smemShape[smemIdx] ||
-                resultShape[resultIdx] > smemShape[smemIdx]) {
-              // When srcShape smaller then src sizePerThread, only srcShape
-              // elements is accumulated in smem. Modulo smemShape effectively
-              // replicates srcShape elements to src sizePerThread.
-              readIdx[smemIdx] =
-                  urem(readIdx[smemIdx], i32_val(smemShape[smemIdx]));
-            }
-          }
-          Value readOffset =
-              linearize(rewriter, loc, readIdx, smemShape, smemOrder);
-          Value readPtr = gep(ptr_ty(rewriter.getContext(), 3), elemTy,
-                              smemBases[i], readOffset);
-          resultVals[j] = load(elemTy, readPtr);
-        }
-
-        results[i] = packLLElements(loc, getTypeConverter(), resultVals,
-                                    rewriter, resultTy);
+    if (!isa<RankedTensorType>(op.getResult()[0].getType())) {
+      // 0d-tensor -> scalar
+      if (helper.getSmemVectorSize() > 1) {
+        Type vecTy = getSmemVectorType(helper, rewriter);
+        results = unpackOperands(helper, load(vecTy, smemBases[0]), rewriter);
       } else {
-        // 0d-tensor -> scalar
-        results[i] = load(elemTy, smemBases[i]);
+        for (unsigned i = 0; i < op.getNumOperands(); ++i)
+          results[i] = load(getElementType(op, i), smemBases[i]);
+      }
+      if (!helper.isReduceWithinCTA()) {
+        SmallVector<SmallVector<Value>> vals;
+        for (Value result : results)
+          vals.push_back({result});
+        reduceAcrossCTAs(helper, vals, RankedTensorType(), rewriter);
+        for (unsigned i = 0; i < op.getNumOperands(); ++i)
+          results[i] = vals[i][0];
+      }
+      rewriter.replaceOp(op, results);
+      return;
+    }
+
+    // nd-tensor where n >= 1
+    DenseMap<Attribute, SmallVector<SmallVector<Value>>> resultValsByLayout;
+    for (unsigned i = 0; i < op.getNumOperands(); ++i) {
+      auto resultTy = cast<RankedTensorType>(op.getResult()[i].getType());
+      // The reductions across CTAs are combined in the layout of the result.
+      auto cvtOp = helper.isReduceWithinCTA()
+                       ? getConsumerConvert(op.getResult()[i])
+                       : triton::gpu::ConvertLayoutOp();
+      RankedTensorType loadTy = cvtOp ? cvtOp.getType() : resultTy;
+      auto [it, inserted] =
+          resultValsByLayout.try_emplace(loadTy.getEncoding());
+      if (inserted) {
+        it->second =
+            loadReduction(helper, smemShape, smemBases, loadTy, rewriter);
+        if (!helper.isReduceWithinCTA())
+          reduceAcrossCTAs(helper, it->second, loadTy, rewriter);
+      }
+      Value packed = packLLElements(loc, getTypeConverter(), it->second[i],
+                                    rewriter, loadTy);
+      if (!cvtOp) {
+        results[i] = packed;
+        continue;
       }
+      rewriter.replaceOp(cvtOp, packed);
+      results[i] = undef(getTypeConverter()->convertType(resultTy));
     }
     rewriter.replaceOp(op, results);
   }
@@ -15,16 +15,12 @@ using ::mlir::LLVM::delinearize;
 using ::mlir::LLVM::linearize;
 using ::mlir::triton::gpu::getTotalElemsPerThread;
 
-// apply combine region to acc and cur and accumulate it into acc
+// apply combine region to acc and cur and return the combined values
 // TODO(Lezcano) This is now duplicated with ReduceOpConversion::reduce.
 // Deduplicate
-static SmallVector<Value> accumulate(ConversionPatternRewriter &rewriter,
-                                     Region &combineOp, ValueRange acc,
-                                     ValueRange cur) {
-  // Allows for passing an unitialized acc and use cur as the neutral element
-  if (acc.size() == 0) {
-    return cur;
-  }
+static SmallVector<Value> applyCombineOp(ConversionPatternRewriter &rewriter,
+                                         Region &combineOp, ValueRange acc,
+                                         ValueRange cur) {
   assert(cur.size() == acc.size());
   // Create a new copy of the reduce block, and inline it
   Block *currentBlock = rewriter.getBlock();
@@ -49,6 +45,29 @@ static SmallVector<Value> accumulate(ConversionPatternRewriter &rewriter,
   return results;
 }
 
+// accumulate cur into acc. For a segmented scan, the last values are the head
+// flags, and the accumulation restarts from cur when its flag is set.
+static SmallVector<Value> accumulate(ConversionPatternRewriter &rewriter,
+                                     ScanLoweringHelper &helper,
+                                     ValueRange acc, ValueRange cur) {
+  // Allows for passing an unitialized acc and use cur as the neutral element
+  if (acc.size() == 0) {
+    return cur;
+  }
+  if (!helper.isSegmented())
+    return applyCombineOp(rewriter, helper.getCombineOp(), acc, cur);
+  Location loc = helper.getLoc();
+  unsigned numValues = acc.size() - 1;
+  SmallVector<Value> results =
+      applyCombineOp(rewriter, helper.getCombineOp(),
+                     acc.take_front(numValues), cur.take_front(numValues));
+  Value curFlag = cur.back();
+  for (unsigned i = 0; i < numValues; ++i)
+    results[i] = select(curFlag, cur[i], results[i]);
+  results.push_back(or_(acc.back(), curFlag));
+  return results;
+}
+
 // Scan a contiguous elements within a thread and update `srcValues` in place.
 static void
 scanThreadContiguousElements(SmallVector<SmallVector<Value>> &srcValues,
@@ -66,8 +85,8 @@ scanThreadContiguousElements(SmallVector<SmallVector<Value>> &srcValues,
     unsigned accIndex = (srcIndex % stride) +
                         ((srcIndex / stride) / scanElementsPerThreads) * stride;
 
-    accs[accIndex] = accumulate(rewriter, helper.getCombineOp(), accs[accIndex],
-                                srcValues[srcIndex]);
+    accs[accIndex] =
+        accumulate(rewriter, helper, accs[accIndex], srcValues[srcIndex]);
     srcValues[srcIndex] = accs[accIndex];
   }
 }
@@ -83,6 +102,7 @@ static void warpScan(SmallVector<SmallVector<Value>> &srcValues,
   unsigned elementStride = helper.getAxisElementStride();
   unsigned threadStride = helper.getAxisThreadStride();
   unsigned scanDim = helper.getAxisNumThreadsPerWarpWithUniqueData();
+  unsigned threadsPerAxis = helper.getAxisNumThreadsPerWarp();
   for (unsigned srcIndex = 0; srcIndex < srcValues.size(); srcIndex++) {
     unsigned elementIdx = (srcIndex / elementStride) % scanElementsPerThreads;
     // Only consider the last element of each contiguous chunk of elements.
@@ -93,10 +113,11 @@ static void warpScan(SmallVector<SmallVector<Value>> &srcValues,
     for (unsigned i = 1; i <= scanDim / 2; i <<= 1) {
       SmallVector<Value> shfl(acc.size());
       for (unsigned j = 0; j < acc.size(); ++j) {
-        shfl[j] = targetInfo.shuffleUp(rewriter, loc, acc[j], i * threadStride);
+        shfl[j] = targetInfo.shuffleUpForScan(rewriter, loc, acc[j],
+                                              i * threadStride,
+                                              threadsPerAxis * threadStride);
       }
-      SmallVector<Value> tempAcc =
-          accumulate(rewriter, helper.getCombineOp(), shfl, acc);
+      SmallVector<Value> tempAcc = accumulate(rewriter, helper, shfl, acc);
       Value mask = icmp_slt(laneIdAxis, i32_val(i));
       for (unsigned j = 0; j < acc.size(); ++j) {
         acc[j] = select(mask, acc[j], tempAcc[j]);
@@ -139,7 +160,11 @@ static void storeWarpAccumulator(SmallVector<SmallVector<Value>> &srcValues,
     for (unsigned i = 0; i < lastElement.size(); ++i) {
       Value writePtr = gep(ptr_ty(rewriter.getContext(), 3), smemTypes[i],
                            smemBases[i], index);
-      targetInfo.storeShared(rewriter, loc, writePtr, lastElement[i], mask);
+      Value value = lastElement[i];
+      // i1 values, like the head flags, are stored as bytes.
+      if (value.getType().isInteger(1))
+        value = zext(i8_ty, value);
+      targetInfo.storeShared(rewriter, loc, writePtr, value, mask);
     }
     chunkId++;
   }
@@ -205,6 +230,8 @@ static void AddPartialReduce(SmallVector<SmallVector<Value>> &srcValues,
         Value ptr =
             gep(ptr_ty(rewriter.getContext(), 3), elemTy, smemBases[j], index);
         partialReduce[j] = load(elemTy, ptr);
+        if (srcValues[srcIndex][j].getType().isInteger(1))
+          partialReduce[j] = icmp_ne(partialReduce[j], int_val(8, 0));
       }
 
       if (accumulator.acc.size() == 0) {
@@ -212,16 +239,16 @@ static void AddPartialReduce(SmallVector<SmallVector<Value>> &srcValues,
         accumulator.maskedAcc = partialReduce;
         continue;
       }
-      accumulator.acc = accumulate(rewriter, helper.getCombineOp(),
-                                   accumulator.acc, partialReduce);
+      accumulator.acc =
+          accumulate(rewriter, helper, accumulator.acc, partialReduce);
       Value mask = icmp_slt(warpId, i32_val(i + 1));
       for (unsigned j = 0; j < helper.getNumOperands(); ++j) {
         accumulator.maskedAcc[j] =
             select(mask, accumulator.maskedAcc[j], accumulator.acc[j]);
       }
     }
-    auto temp = accumulate(rewriter, helper.getCombineOp(),
-                           accumulator.maskedAcc, srcValues[srcIndex]);
+    auto temp = accumulate(rewriter, helper, accumulator.maskedAcc,
+                           srcValues[srcIndex]);
     if (axisBlockId == 0) {
       // For the first warp and first chunk we don't have anything to
       // accumulate.
@@ -239,8 +266,7 @@ static void AddPartialReduce(SmallVector<SmallVector<Value>> &srcValues,
     }
     for (unsigned i = 1; i < scanElementsPerThreads; ++i) {
       auto laneValue = srcValues[srcIndex - i * elementStride];
-      laneValue =
-          accumulate(rewriter, helper.getCombineOp(), lastElement, laneValue);
+      laneValue = accumulate(rewriter, helper, lastElement, laneValue);
       if (axisBlockId == 0) {
         // For the first warp and first chunk we don't have anything to
         // accumulate.
@@ -300,8 +326,8 @@ static void AddPartialReduceOneWarp(SmallVector<SmallVector<Value>> &srcValues,
     if (axisBlockId == 0) // First chunk and first block
       accumulator = srcValues[srcIndex];
     else
-      srcValues[srcIndex] = accumulate(rewriter, helper.getCombineOp(),
-                                       accumulator, srcValues[srcIndex]);
+      srcValues[srcIndex] =
+          accumulate(rewriter, helper, accumulator, srcValues[srcIndex]);
     // Update the rest of the contiguous elements.
     auto lastElement = srcValues[srcIndex];
     if (scanDim > 1) {
@@ -319,8 +345,7 @@ static void AddPartialReduceOneWarp(SmallVector<SmallVector<Value>> &srcValues,
     }
     for (unsigned i = 1; i < scanElementsPerThreads; ++i) {
       auto laneValue = srcValues[srcIndex - i * elementStride];
-      laneValue =
-          accumulate(rewriter, helper.getCombineOp(), lastElement, laneValue);
+      laneValue = accumulate(rewriter, helper, lastElement, laneValue);
       if (axisBlockId == 0) {
         for (unsigned j = 0; j < helper.getNumOperands(); ++j) {
           // For the first warp and first chunk we don't have anything to
@@ -458,22 +483,26 @@ unpackInputs(Location loc, triton::ScanOp op, triton::ScanOpAdaptor adaptor,
   return srcValues;
 }
 
-// Flip the srcValues. Both reverses the chunks and reverses the lanes.
-// Lane reversal is done with a butterfly shuffle flip (divide and flip).
+// Flip the srcValues. Both reverses the chunks and reverses the lanes along
+// the axis. Lane reversal is a single butterfly shuffle xor-ing the lane bits
+// of the axis, and is skipped when the lanes along the axis hold the same
+// elements.
 SmallVector<SmallVector<Value>>
-flipSrcValues(Location loc, triton::ScanOp op,
+flipSrcValues(Location loc, ScanLoweringHelper &helper,
               ConversionPatternRewriter &rewriter,
               const TargetInfoBase &targetInfo,
-              SmallVector<SmallVector<Value>> srcValues, int iWarpSize) {
+              SmallVector<SmallVector<Value>> srcValues) {
+  bool flipLanes = helper.getAxisNumThreadsPerWarpWithUniqueData() > 1;
+  unsigned laneMask =
+      (helper.getAxisNumThreadsPerWarp() - 1) * helper.getAxisThreadStride();
   SmallVector<SmallVector<Value>> values(srcValues.size());
   for (int i = 0; i < srcValues.size(); ++i) {
     int revIndex = srcValues.size() - i - 1;
-    for (unsigned j = 0; j < op.getNumOperands(); ++j) {
-      for (unsigned k = iWarpSize / 2; k >= 1; k = k / 2) {
-        srcValues[revIndex][j] =
-            targetInfo.shuffleXor(rewriter, loc, srcValues[revIndex][j], k);
-      }
-      values[i].push_back(srcValues[revIndex][j]);
+    for (unsigned j = 0; j < helper.getNumOperands(); ++j) {
+      Value value = srcValues[revIndex][j];
+      if (flipLanes)
+        value = targetInfo.shuffleXor(rewriter, loc, value, laneMask);
+      values[i].push_back(value);
     }
   }
   return values;
@@ -511,8 +540,7 @@ ScanOpConversion::emitFastScan(triton::ScanOp op, triton::ScanOpAdaptor adaptor,
   // first/last etc). Reverse first seems more maintainable.)
   if (op.getReverse()) {
     warpIdAxis = sub(i32_val(axisNumWarps - 1), warpIdAxis);
-    srcValues =
-        flipSrcValues(loc, op, rewriter, targetInfo, srcValues, iWarpSize);
+    srcValues = flipSrcValues(loc, helper, rewriter, targetInfo, srcValues);
   }
 
   // Scan contiguous elements in a thread and update `srcValues`.
@@ -529,6 +557,8 @@ ScanOpConversion::emitFastScan(triton::ScanOp op, triton::ScanOpAdaptor adaptor,
     SmallVector<Type> smemTypes(op.getNumOperands());
     for (unsigned i = 0; i < op.getNumOperands(); ++i) {
       smemTypes[i] = getElementType(op, i);
+      if (smemTypes[i].isInteger(1))
+        smemTypes[i] = i8_ty;
     }
 
     // Store the partial reducing for each warp into shared memory.
@@ -567,8 +597,7 @@ ScanOpConversion::emitFastScan(triton::ScanOp op, triton::ScanOpAdaptor adaptor,
 
   SmallVector<Value> results(op.getNumOperands());
   if (op.getReverse()) {
-    srcValues =
-        flipSrcValues(loc, op, rewriter, targetInfo, srcValues, iWarpSize);
+    srcValues = flipSrcValues(loc, helper, rewriter, targetInfo, srcValues);
   }
 
   auto valuesTransposed = transpose(srcValues);
@@ -7,6 +7,8 @@
 #include "triton/Dialect/TritonGPU/IR/LinearLayoutConversions.h"
 #include "llvm/ADT/STLExtras.h"
 
+#include <map>
+
 namespace SharedToDotOperandMMAv1 {
 using CoordTy = SmallVector<Value>;
 using ValueTable = std::map<std::pair<int, int>, std::pair<Value, Value>>;
@@ -183,20 +185,33 @@ applyLinearLayout(Location loc, RewriterBase &rewriter,
       outIndices.push_back({outDimName, i32_val(constantComponent[i])});
   }
 
+  // Each bit of a basis moves a bit of the input to a bit of the output, so
+  // the bits of an input moved by the same distance are extracted by a single
+  // mask and shift, e.g. a single one for the lanes of a blocked layout.
   for (auto [inDimName, idx] : indices) {
     if (isa<LLVM::ConstantOp>(idx.getDefiningOp())) {
       continue;
     }
 
     int nBits = layout.getInDimSizeLog2(inDimName);
-    for (int i = 0; i < nBits; i++) {
-      Value bit = and_(idx, i32_val(1 << i));
-      Value bit_is_zero = icmp_eq(bit, zero);
-      for (auto &[outDimName, outIdx] : outIndices) {
-        int32_t basis = layout.getBasis(inDimName, i, outDimName);
-        if (basis == 0)
-          continue;
-        outIdx = xor_(outIdx, select(bit_is_zero, zero, i32_val(basis)));
+    for (auto &[outDimName, outIdx] : outIndices) {
+      // Maps the distance bits are moved by, from lower to higher bits, to
+      // the mask of the bits of the input moved by it.
+      std::map<int, uint32_t> masks;
+      for (int i = 0; i < nBits; i++) {
+        uint32_t basis = layout.getBasis(inDimName, i, outDimName);
+        for (int j = 0; j < 32; j++) {
+          if (basis & (1u << j))
+            masks[j - i] |= 1u << i;
+        }
+      }
+      for (auto [shift, mask] : masks) {
+        Value bits = and_(idx, i32_val(mask));
+        if (shift > 0)
+          bits = shl(bits, i32_val(shift));
+        else if (shift < 0)
+          bits = lshr(bits, i32_val(-shift));
+        outIdx = xor_(outIdx, bits);
       }
     }
   }
@@ -223,12 +238,6 @@ emitIndicesUsingLinearLayouts(Location loc, RewriterBase &rewriter,
   StringAttr kWarp = str_attr("warp");
   StringAttr kBlock = str_attr("block");
 
-  Value threadId = getThreadId(rewriter, loc);
-  Value threadsPerWarp = i32_val(ll->getInDimSize(kLane));
-  Value laneId = urem(threadId, threadsPerWarp);
-  Value warpId = udiv(threadId, threadsPerWarp);
-  Value blockId =
-      withCTAOffset ? target.getClusterCTAId(rewriter, loc) : i32_val(0);
   unsigned rank = shape.size();
   SmallVector<SmallVector<Value>> ret;
   // Linear layout function is split in two parts below:
@@ -240,11 +249,31 @@ emitIndicesUsingLinearLayouts(Location loc, RewriterBase &rewriter,
   //
   // This approach produces code with lower register pressure and
   // less computations, compared to fused L(r,t,w,b) method.
-  auto idxsBase = applyLinearLayout(loc, rewriter, *ll,
-                                    {{kRegister, i32_val(0)},
-                                     {kLane, laneId},
-                                     {kWarp, warpId},
-                                     {kBlock, blockId}});
+  //
+  // The base only depends on the thread, so it is computed at the entry of
+  // the function, where CSE merges the bases of all the values of the same
+  // layout, whichever blocks and loops they are in.
+  SmallVector<std::pair<StringAttr, Value>> idxsBase;
+  {
+    OpBuilder::InsertionGuard guard(rewriter);
+    if (auto funcOp = rewriter.getInsertionBlock()
+                          ->getParent()
+                          ->getParentOfType<LLVM::LLVMFuncOp>())
+      rewriter.setInsertionPointToStart(&funcOp.getBody().front());
+    Value threadId = getThreadId(rewriter, loc);
+    Value threadsPerWarp = i32_val(ll->getInDimSize(kLane));
+    Value laneId = urem(threadId, threadsPerWarp);
+    Value warpId = udiv(threadId, threadsPerWarp);
+    if (ll->getInDimSize(kWarp) > 1)
+      warpId = target.makeWarpUniform(rewriter, loc, warpId);
+    Value blockId =
+        withCTAOffset ? target.getClusterCTAId(rewriter, loc) : i32_val(0);
+    idxsBase = applyLinearLayout(loc, rewriter, *ll,
+                                 {{kRegister, i32_val(0)},
+                                  {kLane, laneId},
+                                  {kWarp, warpId},
+                                  {kBlock, blockId}});
+  }
   for (unsigned reg = 0; reg < ll->getInDimSize(str_attr("register")); reg++) {
     auto idxsReg =
         ll->apply({{kRegister, reg}, {kLane, 0}, {kWarp, 0}, {kBlock, 0}});
@@ -296,13 +325,14 @@ emitOffsetForLayoutUsingLinearLayouts(Attribute layout, RankedTensorType type) {
   return offsets;
 }
 
-bool emitTransferBetweenRegistersAndShared(
-    RankedTensorType registerTy, MemDescType sharedTy, Type elemLlvmTy,
-    std::optional<int32_t> maxVecElems, Value shmemBase,
-    ArrayRef<Value> shmemStrides, Location loc, RewriterBase &rewriter,
-    const TargetInfoBase &target,
-    std::function<void(VectorType, Value /*shmemAddr*/)> perVectorCallback) {
-  MLIRContext *ctx = rewriter.getContext();
+// Returns the layout mapping (register, lane, warp, block) of `registerTy` to
+// the (offsetX1, ..., offsetXN, block) of `sharedTy` holding the same element,
+// where the offsetX's are in minor-to-major order, or nullopt if we can't
+// transfer between the two.
+static std::optional<LinearLayout>
+getRegToSharedLayout(RankedTensorType registerTy, MemDescType sharedTy,
+                     Type elemLlvmTy) {
+  MLIRContext *ctx = registerTy.getContext();
 
   auto shape = registerTy.getShape();
   int rank = shape.size();
@@ -317,7 +347,7 @@ bool emitTransferBetweenRegistersAndShared(
   std::optional<LinearLayout> sharedLayout = triton::gpu::toLinearLayout(
       shape, sharedTy.getEncoding(), elemLlvmTy.getIntOrFloatBitWidth());
   if (!regLayout.has_value() || !sharedLayout.has_value()) {
-    return false;
+    return std::nullopt;
   }
   auto sharedOrder = triton::gpu::getOrder(sharedTy.getEncoding());
 
@@ -351,13 +381,36 @@ bool emitTransferBetweenRegistersAndShared(
     // offsetX1, ..., offsetXN must all be 0.
     if (!llvm::all_of(ArrayRef(idx).drop_back(1),
                       [&](auto offset) { return offset == 0; })) {
-      return false;
+      return std::nullopt;
     }
     int32_t outBlock = idx.back();
     if (outBlock != inBlock) {
-      return false;
+      return std::nullopt;
     }
   }
+  return regToSharedLayout;
+}
+
+bool emitTransferBetweenRegistersAndShared(
+    RankedTensorType registerTy, MemDescType sharedTy, Type elemLlvmTy,
+    std::optional<int32_t> maxVecElems, Value shmemBase,
+    ArrayRef<Value> shmemStrides, Location loc, RewriterBase &rewriter,
+    const TargetInfoBase &target,
+    std::function<void(VectorType, Value /*shmemAddr*/)> perVectorCallback) {
+  MLIRContext *ctx = rewriter.getContext();
+
+  StringAttr kBlock = str_attr("block");
+  StringAttr kRegister = str_attr("register");
+  StringAttr kLane = str_attr("lane");
+  StringAttr kWarp = str_attr("warp");
+
+  std::optional<LinearLayout> maybeRegToSharedLayout =
+      getRegToSharedLayout(registerTy, sharedTy, elemLlvmTy);
+  if (!maybeRegToSharedLayout.has_value()) {
+    return false;
+  }
+  const LinearLayout &regToSharedLayout = *maybeRegToSharedLayout;
+  auto sharedOrder = triton::gpu::getOrder(sharedTy.getEncoding());
 
   // Determine how many consecutive registers map to consecutive shmem elements
   // in out-dimension offsetN.  This is our load instruction's vector width.
@@ -408,10 +461,149 @@ bool emitTransferBetweenRegistersAndShared(
   return true;
 }
 
+bool emitTransferBetweenRegistersAndSharedUsingMatrices(
+    RankedTensorType registerTy, MemDescType sharedTy, Type elemLlvmTy,
+    Value shmemBase, ArrayRef<Value> shmemStrides, Location loc,
+    RewriterBase &rewriter,
+    std::function<void(Value /*shmemAddr*/, int /*firstReg*/, bool /*trans*/)>
+        perMatrixCallback) {
+  MLIRContext *ctx = rewriter.getContext();
+
+  StringAttr kBlock = str_attr("block");
+  StringAttr kRegister = str_attr("register");
+  StringAttr kLane = str_attr("lane");
+  StringAttr kWarp = str_attr("warp");
+
+  if (!elemLlvmTy.isIntOrFloat() || elemLlvmTy.getIntOrFloatBitWidth() != 16)
+    return false;
+  std::optional<LinearLayout> maybeRegToSharedLayout =
+      getRegToSharedLayout(registerTy, sharedTy, elemLlvmTy);
+  if (!maybeRegToSharedLayout.has_value())
+    return false;
+  const LinearLayout &regToSharedLayout = *maybeRegToSharedLayout;
+  if (regToSharedLayout.getInDimSize(kLane) != 32 ||
+      regToSharedLayout.getInDimSize(kRegister) < 8)
+    return false;
+  // Plain vector accesses of 16 bytes are as wide as the rows of a matrix.
+  if (regToSharedLayout.getNumConsecutiveInOut() >= 8)
+    return false;
+
+  // Each lane passes the address of a row of 8 contiguous elements, so the
+  // minor dimension must be contiguous and the others aligned to rows.
+  auto sharedOrder = triton::gpu::getOrder(sharedTy.getEncoding());
+  SmallVector<Value> strides = applyPermutation(shmemStrides, sharedOrder);
+  for (auto [i, stride] : llvm::enumerate(strides)) {
+    APInt strideVal;
+    if (!matchPattern(stride, m_ConstantInt(&strideVal)))
+      return false;
+    int64_t val = strideVal.getSExtValue();
+    if (i == 0 ? val != 1 : val % 8 != 0)
+      return false;
+  }
+
+  // A matrix instruction moves registers 0..7 of each lane, each pair of
+  // registers holding two elements of one of the four matrices.  Without
+  // .trans, register 0 and lane bits 0-1 select the element within a row, and
+  // lane bits 2-4 and registers bits 1-2 select the row the lane addresses.
+  // With .trans, lane bits 2-4 select the element within a row instead.
+  using Bit = std::pair<StringAttr, int>;
+  auto matchTiling = [&](ArrayRef<Bit> contigBits) {
+    for (auto [i, bit] : llvm::enumerate(contigBits)) {
+      ArrayRef<int32_t> basis = regToSharedLayout.getBasis(bit.first, bit.second);
+      for (auto [j, offset] : llvm::enumerate(basis))
+        if (offset != (j == 0 ? 1 << i : 0))
+          return false;
+    }
+    for (StringAttr inDim : {kRegister, kLane, kWarp}) {
+      for (int i = 0; i < regToSharedLayout.getInDimSizeLog2(inDim); i++) {
+        if (llvm::is_contained(contigBits, Bit{inDim, i}))
+          continue;
+        if (regToSharedLayout.getBasis(inDim, i)[0] % 8 != 0)
+          return false;
+      }
+    }
+    return true;
+  };
+  SmallVector<Bit> rowBits;
+  bool trans;
+  if (matchTiling({{kRegister, 0}, {kLane, 0}, {kLane, 1}})) {
+    trans = false;
+    rowBits = {{kLane, 2}, {kLane, 3}, {kLane, 4}, {kRegister, 1},
+               {kRegister, 2}};
+  } else if (matchTiling({{kLane, 2}, {kLane, 3}, {kLane, 4}})) {
+    trans = true;
+    rowBits = {{kRegister, 0}, {kLane, 0}, {kLane, 1}, {kRegister, 1},
+               {kRegister, 2}};
+  } else {
+    return false;
+  }
+
+  Value threadId = getThreadId(rewriter, loc);
+  Value laneId = urem(threadId, i32_val(32));
+  Value warpId = udiv(threadId, i32_val(32));
+
+  // Lane i addresses row i % 8 of matrix i / 8, i.e. bit k of the lane id
+  // gives rowBits[k] of the (register, lane) holding the start of the row.
+  auto getRowIndex = [&](StringAttr inDim) {
+    Value idx = i32_val(0);
+    for (auto [k, bit] : llvm::enumerate(rowBits)) {
+      if (bit.first != inDim)
+        continue;
+      Value laneBit = and_(lshr(laneId, i32_val(k)), i32_val(1));
+      idx = or_(idx, shl(laneBit, i32_val(bit.second)));
+    }
+    return idx;
+  };
+  auto rowOffset = llvm::to_vector(
+      llvm::drop_end(llvm::make_second_range(applyLinearLayout(
+          loc, rewriter, regToSharedLayout,
+          {{kRegister, getRowIndex(kRegister)},
+           {kLane, getRowIndex(kLane)},
+           {kWarp, warpId},
+           {kBlock, i32_val(0)}}))));
+
+  auto ptrTy = ptr_ty(ctx, /*addressSpace=*/3);
+  int numElems = regToSharedLayout.getInDimSize(kRegister);
+  for (int i = 0; i < numElems; i += 8) {
+    // The layout is linear, so the offsets of the registers moved by this
+    // instruction are the ones of the first instruction xor'ed with the
+    // offsets of register i.
+    auto regOffset = regToSharedLayout.apply(
+        {{kRegister, i}, {kLane, 0}, {kWarp, 0}, {kBlock, 0}});
+    SmallVector<Value> multiDimShmemOffset;
+    for (auto [offset, reg] : llvm::zip(rowOffset, regOffset))
+      multiDimShmemOffset.push_back(xor_(offset, i32_val(reg.second)));
+    Value shmemOffset = dot(rewriter, loc, multiDimShmemOffset, strides);
+    auto addr = gep(ptrTy, elemLlvmTy, shmemBase, shmemOffset);
+    addr.setInbounds(true);
+    perMatrixCallback(addr, i, trans);
+  }
+  return true;
+}
+
 std::optional<SmallVector<Value>> loadSharedToRegistersUsingLinearLayouts(
     RankedTensorType dstTy, MemDescType srcTy, Type elemLlvmTy,
     SharedMemoryObject smemObj, Location loc, RewriterBase &rewriter,
     const TargetInfoBase &target) {
+  if (target.canUseLdMatrix()) {
+    SmallVector<Value> ret(triton::gpu::getTotalElemsPerThread(dstTy));
+    bool success = emitTransferBetweenRegistersAndSharedUsingMatrices(
+        dstTy, srcTy, elemLlvmTy, smemObj.getBase(), smemObj.getStrides(), loc,
+        rewriter, [&](Value shmemAddr, int firstReg, bool trans) {
+          SmallVector<Value> words =
+              target.loadMatrix(rewriter, loc, shmemAddr, trans);
+          auto vecTy = vec_ty(elemLlvmTy, 2);
+          for (auto [j, word] : llvm::enumerate(words)) {
+            Value vec = bitcast(word, vecTy);
+            for (int b = 0; b < 2; b++)
+              ret[firstReg + 2 * j + b] =
+                  extract_element(elemLlvmTy, vec, i32_val(b));
+          }
+        });
+    if (success)
+      return ret;
+  }
+
   SmallVector<Value> ret;
   bool success = emitTransferBetweenRegistersAndShared(
       dstTy, srcTy, elemLlvmTy, /*maxVecElems=*/std::nullopt, smemObj.getBase(),
@@ -436,6 +628,24 @@ bool storeDistributedToSharedUsingLinearLayouts(
     MemDescType dstTy, RankedTensorType srcTy, Type elemLlvmTy,
     ArrayRef<Value> srcVals, Value smemBase, ArrayRef<Value> dstStrides,
     Location loc, RewriterBase &rewriter, const TargetInfoBase &target) {
+  if (target.canUseStMatrix() &&
+      emitTransferBetweenRegistersAndSharedUsingMatrices(
+          srcTy, dstTy, elemLlvmTy, smemBase, dstStrides, loc, rewriter,
+          [&](Value shmemAddr, int firstReg, bool trans) {
+            auto vecTy = vec_ty(elemLlvmTy, 2);
+            SmallVector<Value> words;
+            for (int j = 0; j < 4; j++) {
+              Value vec = undef(vecTy);
+              for (int b = 0; b < 2; b++)
+                vec = insert_element(vec, srcVals[firstReg + 2 * j + b],
+                                     i32_val(b));
+              words.push_back(bitcast(vec, i32_ty));
+            }
+            target.storeMatrix(rewriter, loc, shmemAddr, words, trans);
+          })) {
+    return true;
+  }
+
   bool success = emitTransferBetweenRegistersAndShared(
       srcTy, dstTy, elemLlvmTy, /*maxVecElems=*/std::nullopt, smemBase,
       dstStrides, loc, rewriter, target, [&](VectorType vecTy, Value vecAddr) {
@@ -532,6 +742,92 @@ bool isConstantZero(Value v) {
   return false;
 }
 
+void setFastMathFlags(ModuleOp mod) {
+  // No nnan and ninf: kernels commonly rely on infinities, e.g. to mask
+  // elements out of a softmax with -inf.
+  auto flags = LLVM::FastmathFlagsAttr::get(
+      mod.getContext(), LLVM::FastmathFlags::reassoc |
+                            LLVM::FastmathFlags::nsz |
+                            LLVM::FastmathFlags::contract);
+  mod.walk([&](Operation *op) {
+    if (isa<LLVM::FAddOp, LLVM::FSubOp, LLVM::FMulOp, LLVM::FNegOp,
+            LLVM::FMAOp>(op))
+      op->setAttr(cast<LLVM::FastmathFlagsInterface>(op).getFastmathAttrName(),
+                  flags);
+  });
+}
+
+void createDeviceLog(ModuleOp mod, unsigned capacity) {
+  if (!mod.walk([](Operation *op) {
+            return isa<triton::PrintOp, triton::AssertOp>(op)
+                       ? WalkResult::interrupt()
+                       : WalkResult::advance();
+          })
+           .wasInterrupted())
+    return;
+  OpBuilder builder(mod.getBodyRegion());
+  Location loc = mod.getLoc();
+  auto type = LLVM::LLVMArrayType::get(
+      builder.getI32Type(),
+      kDeviceLogHeaderWords + capacity * kDeviceLogRecordWords);
+  // External, so that the host finds it by name in the loaded module.
+  auto global = builder.create<LLVM::GlobalOp>(
+      loc, type, /*isConstant=*/false, LLVM::Linkage::External, kDeviceLogName,
+      /*value=*/Attribute(), /*alignment=*/16, /*addrSpace=*/1);
+  builder.createBlock(&global.getInitializerRegion());
+  Value zero = builder.create<LLVM::ZeroOp>(loc, type);
+  builder.create<LLVM::ReturnOp>(loc, zero);
+  mod->setAttr(kDeviceLogSitesAttrName, builder.getArrayAttr({}));
+}
+
+LLVM::GlobalOp getDeviceLog(ModuleOp mod) {
+  return mod.lookupSymbol<LLVM::GlobalOp>(kDeviceLogName);
+}
+
+unsigned addDeviceLogSite(ModuleOp mod, StringRef site) {
+  SmallVector<Attribute> sites(
+      mod->getAttrOfType<ArrayAttr>(kDeviceLogSitesAttrName).getValue());
+  sites.push_back(StringAttr::get(mod.getContext(), site));
+  mod->setAttr(kDeviceLogSitesAttrName,
+               ArrayAttr::get(mod.getContext(), sites));
+  return sites.size() - 1;
+}
+
+Value reserveDeviceLogRecords(RewriterBase &rewriter, Location loc,
+                              LLVM::GlobalOp log, unsigned numRecords) {
+  Value count = address_of(log);
+  return rewriter.create<LLVM::AtomicRMWOp>(
+      loc, LLVM::AtomicBinOp::add, count, i32_val(numRecords),
+      LLVM::AtomicOrdering::monotonic);
+}
+
+void storeDeviceLogRecord(RewriterBase &rewriter, Location loc,
+                          const TargetInfoBase &targetInfo, LLVM::GlobalOp log,
+                          Value index, unsigned site, Value elementIndex,
+                          Value value) {
+  auto mod = rewriter.getBlock()->getParent()->getParentOfType<ModuleOp>();
+  unsigned capacity =
+      (cast<LLVM::LLVMArrayType>(log.getType()).getNumElements() -
+       kDeviceLogHeaderWords) /
+      kDeviceLogRecordWords;
+  Value offset = add(i32_val(kDeviceLogHeaderWords),
+                     mul(urem(index, i32_val(capacity)),
+                         i32_val(kDeviceLogRecordWords)));
+  Value base = address_of(log);
+  Value record = gep(base.getType(), i32_ty, base, offset);
+  SmallVector<Value, kDeviceLogRecordWords> fields = {
+      i32_val(site),
+      getThreadId(rewriter, loc),
+      targetInfo.programId(rewriter, loc, mod, 0),
+      targetInfo.programId(rewriter, loc, mod, 1),
+      targetInfo.programId(rewriter, loc, mod, 2),
+      elementIndex,
+      trunc(i32_ty, value),
+      trunc(i32_ty, lshr(value, i64_val(32)))};
+  for (auto [i, field] : llvm::enumerate(fields))
+    store(field, gep(base.getType(), i32_ty, record, i32_val(i)));
+}
+
 SharedMemoryObject getSharedMemoryObjectFromStruct(Location loc,
                                                    Value llvmStruct,
                                                    Type elemTy,
@@ -806,6 +1102,26 @@ SmallVector<Value> getMultiDimOffset(Attribute layout, Location loc,
     }
     return multiDimOffset;
   }
+  if (auto metaLayout = dyn_cast<SparseDotMetaEncodingAttr>(layout)) {
+    // Rows g and g+8 of column t % 2 of the tile of the warp, see
+    // SparseDotMetaEncodingAttr.
+    auto shapePerCTA = getShapePerCTA(metaLayout, shape);
+    Value threadId = getThreadId(rewriter, loc);
+    Value laneId = urem(threadId, i32_val(32));
+    Value warpId = udiv(threadId, i32_val(32));
+    auto warpsPerCTA = metaLayout.getWarpsPerCTA();
+    SmallVector<Value> multiDimWarpId =
+        delinearize(rewriter, loc, warpId, warpsPerCTA,
+                    triton::gpu::getWarpOrder(metaLayout));
+    Value warpM =
+        urem(multiDimWarpId[0], i32_val(ceil<unsigned>(shapePerCTA[0], 16)));
+    Value row = add(add(udiv(laneId, i32_val(4)), mul(warpM, i32_val(16))),
+                    i32_val(8 * elemId + multiDimCTAInRepId[0] *
+                                             shapePerCTATile[0]));
+    Value col = add(urem(laneId, i32_val(2)),
+                    i32_val(multiDimCTAInRepId[1] * shapePerCTATile[1]));
+    return {row, col};
+  }
   if (isa<AMDMfmaEncodingAttr, AMDWmmaEncodingAttr>(layout)) {
     auto multiDimBase =
         emitBaseIndexForLayout(loc, rewriter, targetInfo, layout, type, false);
@@ -212,6 +212,32 @@ private:
   }
 };
 
+// Returns the blocked encoding of the result of a dot of the given shape.
+static Attribute getDotResultEncoding(MLIRContext *ctx,
+                                      const TritonGPUTypeConverter &converter,
+                                      ArrayRef<int64_t> shape) {
+  int numWarps = converter.getNumWarps();
+  int threadsPerWarp = converter.getThreadsPerWarp();
+  int numCTAs = converter.getNumCTAs();
+  auto rank = shape.size();
+  SmallVector<unsigned> retSizePerThread(rank, 1);
+  auto numElements = product<int64_t>(shape);
+  if (numElements / (numWarps * threadsPerWarp) >= 4) {
+    retSizePerThread[rank - 1] = 2;
+    retSizePerThread[rank - 2] = 2;
+  }
+  if (numElements / (numWarps * threadsPerWarp) >= 16) {
+    retSizePerThread[rank - 1] = 4;
+    retSizePerThread[rank - 2] = 4;
+  }
+  SmallVector<unsigned> retOrder(rank);
+  for (unsigned i = 0; i < rank; ++i)
+    retOrder[i] = rank - 1 - i;
+  return triton::gpu::BlockedEncodingAttr::get(
+      ctx, shape, retSizePerThread, retOrder, numWarps, threadsPerWarp,
+      numCTAs);
+}
+
 struct TritonDotPattern : public OpConversionPattern<triton::DotOp> {
   using OpConversionPattern::OpConversionPattern;
 
@@ -220,27 +246,8 @@ struct TritonDotPattern : public OpConversionPattern<triton::DotOp> {
                   ConversionPatternRewriter &rewriter) const override {
     RankedTensorType origType = op.getType();
     auto origShape = origType.getShape();
-    auto typeConverter = getTypeConverter<TritonGPUTypeConverter>();
-    int numWarps = typeConverter->getNumWarps();
-    int threadsPerWarp = typeConverter->getThreadsPerWarp();
-    int numCTAs = typeConverter->getNumCTAs();
-    auto rank = origShape.size();
-    SmallVector<unsigned> retSizePerThread(rank, 1);
-    auto numElements = product<int64_t>(origShape);
-    if (numElements / (numWarps * threadsPerWarp) >= 4) {
-      retSizePerThread[rank - 1] = 2;
-      retSizePerThread[rank - 2] = 2;
-    }
-    if (numElements / (numWarps * threadsPerWarp) >= 16) {
-      retSizePerThread[rank - 1] = 4;
-      retSizePerThread[rank - 2] = 4;
-    }
-    SmallVector<unsigned> retOrder(rank);
-    for (unsigned i = 0; i < rank; ++i)
-      retOrder[i] = rank - 1 - i;
-    Attribute dEncoding = triton::gpu::BlockedEncodingAttr::get(
-        getContext(), origShape, retSizePerThread, retOrder, numWarps,
-        threadsPerWarp, numCTAs);
+    Attribute dEncoding = getDotResultEncoding(
+        getContext(), *getTypeConverter<TritonGPUTypeConverter>(), origShape);
     RankedTensorType retType =
         RankedTensorType::get(origShape, origType.getElementType(), dEncoding);
     // a & b must be of smem layout
@@ -279,6 +286,42 @@ struct TritonDotPattern : public OpConversionPattern<triton::DotOp> {
   }
 };
 
+struct TritonSparseDotPattern
+    : public OpConversionPattern<triton::SparseDotOp> {
+  using OpConversionPattern::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::SparseDotOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    RankedTensorType origType = op.getType();
+    Attribute dEncoding =
+        getDotResultEncoding(getContext(),
+                             *getTypeConverter<TritonGPUTypeConverter>(),
+                             origType.getShape());
+    RankedTensorType retType = RankedTensorType::get(
+        origType.getShape(), origType.getElementType(), dEncoding);
+    // The metadata keeps its default layout until the dot gets an MMA layout.
+    auto convertOperand = [&](Value v, unsigned opIdx) -> Value {
+      auto type = cast<RankedTensorType>(v.getType());
+      Attribute encoding = triton::gpu::DotOperandEncodingAttr::get(
+          getContext(), opIdx, dEncoding, type.getElementType());
+      return rewriter.create<triton::gpu::ConvertLayoutOp>(
+          v.getLoc(),
+          RankedTensorType::get(type.getShape(), type.getElementType(),
+                                encoding),
+          v);
+    };
+    Value a = convertOperand(adaptor.getA(), 0);
+    Value b = convertOperand(adaptor.getB(), 1);
+    Value c = rewriter.create<triton::gpu::ConvertLayoutOp>(
+        op.getLoc(), retType, adaptor.getC());
+    addNamedAttrs(rewriter.replaceOpWithNewOp<triton::SparseDotOp>(
+                      op, retType, a, b, c, adaptor.getAMeta()),
+                  adaptor.getAttributes());
+    return success();
+  }
+};
+
 struct TritonCatPattern : public OpConversionPattern<triton::CatOp> {
   using OpConversionPattern::OpConversionPattern;
 
@@ -466,7 +509,8 @@ struct TritonScanPattern : public OpConversionPattern<triton::ScanOp> {
   matchAndRewrite(triton::ScanOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
     auto newScan = rewriter.create<triton::ScanOp>(
-        op.getLoc(), adaptor.getOperands(), adaptor.getAxis(), op.getReverse());
+        op.getLoc(), adaptor.getOperands(), adaptor.getAxis(), op.getReverse(),
+        op.getSegmented());
     addNamedAttrs(newScan, adaptor.getAttributes());
 
     auto &newCombineOp = newScan.getCombineOp();
@@ -543,14 +587,19 @@ void populateTritonPatterns(TritonGPUTypeConverter &typeConverter,
       GenericOpPattern<triton::ReduceReturnOp>, TritonScanPattern,
       GenericOpPattern<triton::ScanReturnOp>,
       GenericOpPattern<triton::MakeRangeOp>, TritonExpandDimsPattern,
-      TritonTransPattern, TritonDotPattern, GenericOpPattern<triton::LoadOp>,
-      GenericOpPattern<triton::StoreOp>, GenericOpPattern<triton::HistogramOp>,
+      TritonTransPattern, TritonDotPattern, TritonSparseDotPattern,
+      GenericOpPattern<triton::LoadOp>,
+      GenericOpPattern<triton::StoreOp>, GenericOpPattern<triton::PrefetchOp>,
+      GenericOpPattern<triton::HistogramOp>,
+      GenericOpPattern<triton::GatherOp>,
       GenericOpPattern<triton::ExternElementwiseOp>,
       GenericOpPattern<triton::PrintOp>, GenericOpPattern<triton::AssertOp>,
       GenericOpPattern<triton::AtomicCASOp>,
       GenericOpPattern<triton::AtomicRMWOp>, GenericOpPattern<ReturnOp>,
       GenericOpPattern<triton::ExperimentalDescriptorLoadOp>,
       GenericOpPattern<triton::ExperimentalDescriptorStoreOp>,
+      GenericOpPattern<triton::ExperimentalDescriptorReduceOp>,
+      GenericOpPattern<triton::ExperimentalDescriptorPrefetchOp>,
       GenericOpPattern<triton::CallOp>, TritonFuncOpPattern>(typeConverter,
                                                              context);
 }
@@ -288,6 +288,10 @@ LogicalResult DotOp::verify() {
       bTy.getElementType().getIntOrFloatBitWidth())
     return emitError(
         "element types of operands A and B must have same bit width");
+  int64_t k = aTy.getShape().back();
+  if (getKExtent() > k)
+    return emitError("kExtent must be within the K dimension of ")
+           << k << ", but got " << getKExtent();
   auto aEncoding = aTy.getEncoding();
   auto bEncoding = bTy.getEncoding();
   if (!aEncoding && !bEncoding)
@@ -301,6 +305,111 @@ LogicalResult DotOp::verify() {
                                                      bEncoding);
 }
 
+//-- SparseDotOp --
+LogicalResult SparseDotOp::verify() {
+  auto aTy = getA().getType();
+  auto bTy = getB().getType();
+  auto cTy = getC().getType();
+  auto metaTy = getAMeta().getType();
+  if (aTy.getRank() != 2 || bTy.getRank() != 2)
+    return emitOpError("operands must be 2D tensors");
+  Type aElemTy = aTy.getElementType();
+  if (!(aElemTy.isF16() || aElemTy.isBF16()) ||
+      aElemTy != bTy.getElementType() || !cTy.getElementType().isF32())
+    return emitOpError("operands must both be f16 or bf16, accumulating in "
+                       "f32");
+  int64_t M = aTy.getShape()[0];
+  int64_t K = bTy.getShape()[0];
+  int64_t N = bTy.getShape()[1];
+  if (K % 32 != 0)
+    return emitOpError("K must be a multiple of 32");
+  if (aTy.getShape()[1] * 2 != K)
+    return emitOpError("A must hold half of the K elements of B");
+  if (cTy.getShape() != ArrayRef<int64_t>({M, N}))
+    return emitOpError("accumulator must be of shape MxN");
+  if (!metaTy.getElementType().isInteger(16) ||
+      metaTy.getShape() != ArrayRef<int64_t>({M, K / 16}))
+    return emitOpError("metadata must be an MxK/16 tensor of i16");
+  return success();
+}
+
+//-- DotScaledOp --
+static LogicalResult verifyScaledOperand(Operation *op, StringRef name,
+                                         RankedTensorType type,
+                                         ScaleDotElemType elemType) {
+  Type elemTy = type.getElementType();
+  bool valid = false;
+  switch (elemType) {
+  case ScaleDotElemType::E4M3:
+  case ScaleDotElemType::E5M2:
+    valid = isa<FloatType>(elemTy) && elemTy.getIntOrFloatBitWidth() == 8;
+    break;
+  case ScaleDotElemType::E2M1:
+    valid = elemTy.isInteger(8);
+    break;
+  case ScaleDotElemType::BF16:
+    valid = elemTy.isBF16();
+    break;
+  }
+  if (!valid)
+    return op->emitOpError() << name << " has element type " << elemTy
+                             << ", which does not hold "
+                             << stringifyScaleDotElemType(elemType);
+  if (type.getRank() != 2)
+    return op->emitOpError() << name << " must be a 2D tensor";
+  return success();
+}
+
+static LogicalResult verifyScale(Operation *op, StringRef name, Value scale,
+                                 int64_t nonK, int64_t K,
+                                 ScaleDotElemType elemType) {
+  if (!scale)
+    return success();
+  if (elemType == ScaleDotElemType::BF16)
+    return op->emitOpError() << "bf16 operands cannot have a " << name;
+  auto scaleTy = cast<RankedTensorType>(scale.getType());
+  Type elemTy = scaleTy.getElementType();
+  int64_t blockSize;
+  if (elemTy.isInteger(8))
+    blockSize = 32;
+  else if (isa<FloatType>(elemTy) && elemTy.getIntOrFloatBitWidth() == 8)
+    blockSize = 16;
+  else
+    return op->emitOpError()
+           << name << " must be an i8 (e8m0) or fp8 (e4m3) tensor";
+  if (K % blockSize != 0 ||
+      scaleTy.getShape() != ArrayRef<int64_t>({nonK, K / blockSize}))
+    return op->emitOpError()
+           << name << " must have one element per block of " << blockSize
+           << " elements of K";
+  return success();
+}
+
+LogicalResult DotScaledOp::verify() {
+  auto lhsTy = getLhs().getType();
+  auto rhsTy = getRhs().getType();
+  if (failed(verifyScaledOperand(*this, "lhs", lhsTy, getLhsType())) ||
+      failed(verifyScaledOperand(*this, "rhs", rhsTy, getRhsType())))
+    return failure();
+  int64_t lhsK = lhsTy.getShape()[1] *
+                 (getLhsType() == ScaleDotElemType::E2M1 ? 2 : 1);
+  int64_t rhsK = rhsTy.getShape()[0] *
+                 (getRhsType() == ScaleDotElemType::E2M1 ? 2 : 1);
+  if (lhsK != rhsK)
+    return emitOpError("lhs and rhs must have the same number of elements of "
+                       "K, counting two e2m1 elements per byte");
+  int64_t M = lhsTy.getShape()[0];
+  int64_t N = rhsTy.getShape()[1];
+  if (getC().getType().getShape() != ArrayRef<int64_t>({M, N}))
+    return emitOpError("accumulator must be of shape MxN");
+  if (failed(verifyScale(*this, "lhs_scale", getLhsScale(), M, lhsK,
+                         getLhsType())) ||
+      failed(verifyScale(*this, "rhs_scale", getRhsScale(), N, rhsK,
+                         getRhsType())))
+    return failure();
+  return success();
+}
+
 //-- MakeRangeOp --
 OpFoldResult MakeRangeOp::fold(FoldAdaptor adaptor) {
   // make_range(start, start + 1) -> constant(start)
@@ -420,10 +529,9 @@ template <class Op> LogicalResult verifyReduceScan(Op &op) {
 }
 
 template <class ReturnOp, class Op>
-static LogicalResult verifyRegionsImpl(Op &op) {
+static LogicalResult verifyRegionsImpl(Op &op, unsigned numCombinedOperands) {
   auto argElementTypes = op.getElementTypes();
-  const auto &operands = op.getOperands();
-  const auto numArgs = 2 * operands.size();
+  const auto numArgs = 2 * numCombinedOperands;
   auto &block = *op.getBody();
   if (block.getNumArguments() != numArgs) {
     return op.emitOpError() << "nested block must take " << numArgs
@@ -434,7 +542,7 @@ static LogicalResult verifyRegionsImpl(Op &op) {
   const auto &blockArgTypes = block.getArgumentTypes();
   for (unsigned i = 0; i < numArgs; ++i) {
     const auto &blockArgTy = blockArgTypes[i];
-    const auto &argElemTy = argElementTypes[i % operands.size()];
+    const auto &argElemTy = argElementTypes[i % numCombinedOperands];
     if (blockArgTy != argElemTy) {
       return op.emitOpError()
              << "type mismatch on combine operation. Expected argument " << i
@@ -449,9 +557,9 @@ static LogicalResult verifyRegionsImpl(Op &op) {
            << "with a ReduceReturnOp but got " << block.getTerminator();
   }
   const auto &combineResults = terminator->getOperands();
-  if (combineResults.size() != operands.size()) {
+  if (combineResults.size() != numCombinedOperands) {
     return op.emitOpError()
-           << "expected combine operation to return " << operands.size()
+           << "expected combine operation to return " << numCombinedOperands
            << " values but got " << combineResults.size();
   }
   for (unsigned i = 0; i < combineResults.size(); ++i) {
@@ -489,7 +597,7 @@ getElementTypesImpl(const Operation::operand_range &operands) {
 LogicalResult ReduceOp::verify() { return verifyReduceScan(*this); }
 
 LogicalResult ReduceOp::verifyRegions() {
-  return verifyRegionsImpl<ReduceReturnOp>(*this);
+  return verifyRegionsImpl<ReduceReturnOp>(*this, getNumOperands());
 }
 
 llvm::SmallVector<RankedTensorType> ReduceOp::getInputTypes() {
@@ -504,9 +612,12 @@ unsigned ReduceOp::getNumOperands() { return this->getOperands().size(); }
 
 //-- ScanOp --
 void ScanOp::build(OpBuilder &builder, OperationState &state,
-                   ValueRange operands, int axis, bool reverse) {
+                   ValueRange operands, int axis, bool reverse,
+                   bool segmented) {
   SmallVector<Type> inferredReturnTypes;
   state.addAttribute("reverse", builder.getBoolAttr(reverse));
+  if (segmented)
+    state.addAttribute("segmented", builder.getUnitAttr());
   for (auto arg : operands)
     inferredReturnTypes.push_back(arg.getType());
   ReduceOp::build(builder, state, inferredReturnTypes, operands, axis);
@@ -522,10 +633,18 @@ ScanOp::inferReturnTypes(MLIRContext *context, std::optional<Location> location,
   return success();
 }
 
-LogicalResult ScanOp::verify() { return verifyReduceScan(*this); }
+LogicalResult ScanOp::verify() {
+  if (getSegmented()) {
+    if (getNumOperands() < 2)
+      return emitOpError() << "segmented scan must have at least 2 operands";
+    if (!getElementTypes().back().isInteger(1))
+      return emitOpError() << "head flags of a segmented scan must be i1";
+  }
+  return verifyReduceScan(*this);
+}
 
 LogicalResult ScanOp::verifyRegions() {
-  return verifyRegionsImpl<ScanReturnOp>(*this);
+  return verifyRegionsImpl<ScanReturnOp>(*this, getNumCombinedOperands());
 }
 
 llvm::SmallVector<RankedTensorType> ScanOp::getInputTypes() {
@@ -538,6 +657,10 @@ llvm::SmallVector<Type> ScanOp::getElementTypes() {
 
 unsigned ScanOp::getNumOperands() { return this->getOperands().size(); }
 
+unsigned ScanOp::getNumCombinedOperands() {
+  return getNumOperands() - (getSegmented() ? 1 : 0);
+}
+
 //-- SplatOp --
 OpFoldResult SplatOp::fold(FoldAdaptor adaptor) {
   auto value = adaptor.getSrc();
@@ -735,6 +858,98 @@ LogicalResult FpToFpOp::verify() {
   return success();
 }
 
+//-- HistogramOp --
+LogicalResult HistogramOp::verify() {
+  RankedTensorType srcTy = getSrc().getType();
+  RankedTensorType resTy = getResult().getType();
+  if (resTy.getRank() != 1)
+    return emitOpError("result must be a 1D tensor");
+  for (Value operand : {getMask(), getWeights()}) {
+    if (!operand)
+      continue;
+    auto operandTy = cast<RankedTensorType>(operand.getType());
+    if (operandTy.getShape() != srcTy.getShape() ||
+        operandTy.getEncoding() != srcTy.getEncoding()) {
+      return emitOpError(
+          "mask and weights must have the shape and encoding of the input");
+    }
+  }
+  if (Value weights = getWeights()) {
+    Type weightTy = cast<RankedTensorType>(weights.getType()).getElementType();
+    if (!weightTy.isInteger(32) && !weightTy.isF32())
+      return emitOpError("weights must be i32 or f32");
+    if (resTy.getElementType() != weightTy)
+      return emitOpError("result element type must match the weights");
+  } else if (!resTy.getElementType().isInteger(32)) {
+    return emitOpError("result element type must be i32 without weights");
+  }
+  return success();
+}
+
+//-- ExperimentalDescriptorReduceOp --
+LogicalResult ExperimentalDescriptorReduceOp::verify() {
+  // The reductions of the TMA, by the element types they support.
+  Type elemTy = getSrc().getType().getElementType();
+  bool isInt = elemTy.isInteger(32) || elemTy.isInteger(64);
+  bool isHalf = elemTy.isF16() || elemTy.isBF16();
+  bool supported = false;
+  switch (getKind()) {
+  case RMWOp::FADD:
+    supported = elemTy.isF32() || isHalf;
+    break;
+  case RMWOp::MAX:
+  case RMWOp::MIN:
+    supported = isInt || isHalf;
+    break;
+  case RMWOp::ADD:
+  case RMWOp::UMAX:
+  case RMWOp::UMIN:
+  case RMWOp::AND:
+  case RMWOp::OR:
+  case RMWOp::XOR:
+    supported = isInt;
+    break;
+  case RMWOp::XCHG:
+    break;
+  }
+  if (!supported)
+    return emitOpError("TMA reductions don't support ")
+           << stringifyRMWOp(getKind()) << " of " << elemTy;
+  return success();
+}
+
+//-- GatherOp --
+LogicalResult GatherOp::verify() {
+  RankedTensorType indicesTy = getIndices().getType();
+  RankedTensorType srcTy = getSrc().getType();
+  RankedTensorType resTy = getResult().getType();
+
+  if (indicesTy.getShape() != resTy.getShape()) {
+    return emitOpError("indices and output shapes must match");
+  }
+  if (indicesTy.getEncoding() != resTy.getEncoding()) {
+    return emitOpError("indices and output encodings must match");
+  }
+  if (srcTy.getElementType() != resTy.getElementType()) {
+    return emitOpError("input and output element types must match");
+  }
+  if (srcTy.getRank() != indicesTy.getRank()) {
+    return emitOpError("input and indices ranks must match");
+  }
+  if (getAxis() >= srcTy.getRank()) {
+    return emitOpError("gather dimension must be less than the input rank");
+  }
+  for (int dim = 0; dim < indicesTy.getRank(); ++dim) {
+    if (dim == static_cast<int>(getAxis()))
+      continue;
+    if (indicesTy.getShape()[dim] != srcTy.getShape()[dim]) {
+      return emitOpError("indices dimension ")
+             << dim << " must match the corresponding input dimension";
+    }
+  }
+  return success();
+}
+
 //-- BroadcastOp --
 LogicalResult BroadcastOp::canonicalize(BroadcastOp op,
                                         PatternRewriter &rewriter) {
@@ -762,7 +977,8 @@ OpFoldResult BroadcastOp::fold(FoldAdaptor adaptor) {
 void MakeTensorPtrOp::build(OpBuilder &builder, OperationState &state,
                             Value base, ValueRange shape, ValueRange strides,
                             ValueRange offsets, ArrayRef<int32_t> tensorShape,
-                            ArrayRef<int32_t> order) {
+                            ArrayRef<int32_t> order, Value pageTable,
+                            int32_t pageSize) {
   // Get pointer type from `base`
   auto pointerType = cast<PointerType>(base.getType());
   assert(pointerType != nullptr);
@@ -774,7 +990,21 @@ void MakeTensorPtrOp::build(OpBuilder &builder, OperationState &state,
   auto result = PointerType::get(tensorType, 1);
 
   return build(builder, state, result, base, shape, strides, offsets,
-               builder.getDenseI32ArrayAttr(order));
+               pageTable, builder.getDenseI32ArrayAttr(order),
+               pageTable ? builder.getI32IntegerAttr(pageSize) : IntegerAttr());
+}
+
+LogicalResult MakeTensorPtrOp::verify() {
+  if (!getPageTable() != !getPageSize())
+    return emitOpError("expects a page size with a page table");
+  if (!getPageTable())
+    return success();
+  auto pageTableType = dyn_cast<PointerType>(getPageTable().getType());
+  if (!pageTableType || !pageTableType.getPointeeType().isInteger(32))
+    return emitOpError("expects a page table of i32 page indices");
+  if (static_cast<int32_t>(*getPageSize()) <= 0)
+    return emitOpError("expects a positive page size");
+  return success();
 }
 
 // The following ops, including `call`, `func`, and `return` are copied and
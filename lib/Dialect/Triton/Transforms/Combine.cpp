@@ -141,21 +141,63 @@ public:
 
 // sum(x[:, :, None] * y[None, :, :], 1)
 // -> dot(x, y)
+// and the batched form
+// sum(x[:, :, :, None] * y[:, None, :, :], 2)
+// -> dot(x, y)
+// Products whose M or N is below the 16 of the smallest mma tiles, e.g.
+// matrix-vector products, are left as reductions, which lower to warp
+// shuffles. A K below 16 is padded with zeros.
 class CombineBroadcastMulReducePattern : public RewritePattern {
 private:
+  static constexpr int64_t kMinDotSize = 16;
+
   static bool isAddF32(const Operation *op) {
     if (auto addf = dyn_cast_or_null<arith::AddFOp>(op))
       return addf.getType().getIntOrFloatBitWidth() <= 32;
     return false;
   }
 
-  static SmallVector<int> getEqualIndices(ArrayRef<int64_t> x,
-                                          ArrayRef<int64_t> y) {
-    SmallVector<int> res;
-    for (int i = 0; i < x.size(); ++i)
-      if (x[i] == y[i])
-        res.push_back(i);
-    return res;
+  // Returns the tensor `v` was expanded at `axis` and broadcast from.
+  static Value getBroadcastSrc(Value v, int axis) {
+    auto broadcastOp = v.getDefiningOp<BroadcastOp>();
+    if (!broadcastOp)
+      return Value();
+    auto expandOp = broadcastOp.getSrc().getDefiningOp<ExpandDimsOp>();
+    if (!expandOp || expandOp.getAxis() != axis)
+      return Value();
+    return expandOp.getSrc();
+  }
+
+  // Doubles the K dimension `kDim` of `v`, interleaving its elements with
+  // zeros, until it is at least kMinDotSize. The operands are interleaved the
+  // same way, so the zeros only add zero products.
+  static Value padK(PatternRewriter &rewriter, Location loc, Value v,
+                    int kDim) {
+    auto type = cast<RankedTensorType>(v.getType());
+    int rank = type.getRank();
+    Value zero = rewriter.create<arith::ConstantOp>(
+        loc, rewriter.getZeroAttr(type.getElementType()));
+    for (int64_t k = type.getShape()[kDim]; k < kMinDotSize; k *= 2) {
+      auto curType = cast<RankedTensorType>(v.getType());
+      Value zeros = rewriter.create<SplatOp>(loc, curType, zero);
+      Value joined = rewriter.create<JoinOp>(loc, v, zeros);
+      // The pairs are the minor dimension of the join, which needs to follow K
+      // to reshape them into K.
+      if (kDim != rank - 1) {
+        SmallVector<int32_t> order;
+        for (int i = 0; i < rank; ++i) {
+          order.push_back(i);
+          if (i == kDim)
+            order.push_back(rank);
+        }
+        joined = rewriter.create<TransOp>(loc, joined, order);
+      }
+      SmallVector<int64_t> shape(curType.getShape());
+      shape[kDim] *= 2;
+      v = rewriter.create<ReshapeOp>(loc, curType.clone(shape), joined,
+                                     /*allow_reorder=*/false);
+    }
+    return v;
   }
 
 public:
@@ -165,7 +207,7 @@ public:
   LogicalResult matchAndRewrite(Operation *op,
                                 PatternRewriter &rewriter) const {
     auto reduceOp = llvm::dyn_cast<ReduceOp>(op);
-    if (!reduceOp)
+    if (!reduceOp || reduceOp.getNumOperands() != 1)
       return failure();
     // only support reduce with simple addition
     Region &combineOp = reduceOp.getCombineOp();
@@ -179,45 +221,44 @@ public:
         reduceOp.getOperand(0).getDefiningOp());
     if (!mulOp)
       return failure();
-    // mul operand has to be broadcast
-    auto broadcastLhsOp = llvm::dyn_cast_or_null<BroadcastOp>(
-        mulOp.getOperand(0).getDefiningOp());
-    if (!broadcastLhsOp)
+    // [..., M, K, N], reduced along K
+    auto mulType = cast<RankedTensorType>(mulOp.getType());
+    int rank = mulType.getRank();
+    if ((rank != 3 && rank != 4) || reduceOp.getAxis() != unsigned(rank - 2))
       return failure();
-    auto broadcastRhsOp = llvm::dyn_cast_or_null<BroadcastOp>(
-        mulOp.getOperand(1).getDefiningOp());
-    if (!broadcastRhsOp)
-      return failure();
-    // broadcast operand is expand dims
-    auto expandLhsOp = llvm::dyn_cast_or_null<ExpandDimsOp>(
-        broadcastLhsOp.getSrc().getDefiningOp());
-    if (!expandLhsOp)
-      return failure();
-    auto expandRhsOp = llvm::dyn_cast_or_null<ExpandDimsOp>(
-        broadcastRhsOp.getSrc().getDefiningOp());
-    if (!expandRhsOp)
+    // mul operands are broadcast from x[..., None] and y[..., None, :, :], in
+    // either order
+    Value lhs = getBroadcastSrc(mulOp.getLhs(), rank - 1);
+    Value rhs = getBroadcastSrc(mulOp.getRhs(), rank - 3);
+    if (!lhs || !rhs) {
+      lhs = getBroadcastSrc(mulOp.getRhs(), rank - 1);
+      rhs = getBroadcastSrc(mulOp.getLhs(), rank - 3);
+    }
+    if (!lhs || !rhs)
       return failure();
-    // get not-broadcast dimensions
-    int expandLhsAxis = expandLhsOp.getAxis();
-    int expandRhsAxis = expandRhsOp.getAxis();
-    if (expandLhsAxis != 2 || expandRhsAxis != 0)
+    ArrayRef<int64_t> shape = mulType.getShape();
+    auto lhsShape = cast<RankedTensorType>(lhs.getType()).getShape();
+    auto rhsShape = cast<RankedTensorType>(rhs.getType()).getShape();
+    // the broadcasts only add the M and N dimensions
+    if (lhsShape != shape.drop_back() ||
+        rhsShape.drop_front(rank - 3) != shape.drop_front(rank - 2) ||
+        rhsShape.drop_back(2) != shape.drop_back(3))
       return failure();
-    auto broadcastLhsShape =
-        cast<ShapedType>(broadcastLhsOp.getType()).getShape();
-    auto broadcastRhsShape =
-        cast<ShapedType>(broadcastLhsOp.getType()).getShape();
-    if (broadcastLhsShape[2] < 16 || broadcastRhsShape[0] < 16)
+    if (shape[rank - 3] < kMinDotSize || shape[rank - 1] < kMinDotSize)
       return failure();
-    Type newAccType = RankedTensorType::get(
-        {broadcastLhsShape[0], broadcastRhsShape[2]},
-        cast<ShapedType>(broadcastLhsOp.getSrc().getType()).getElementType());
+
+    Location loc = op->getLoc();
     rewriter.setInsertionPoint(op);
+    if (shape[rank - 2] < kMinDotSize) {
+      lhs = padK(rewriter, loc, lhs, rank - 2);
+      rhs = padK(rewriter, loc, rhs, rank - 3);
+    }
+    auto accType = cast<RankedTensorType>(op->getResult(0).getType());
     auto newAcc = rewriter.create<SplatOp>(
-        op->getLoc(), newAccType,
-        rewriter.create<arith::ConstantOp>(op->getLoc(),
-                                           rewriter.getF32FloatAttr(0)));
-    rewriter.replaceOpWithNewOp<DotOp>(op, expandLhsOp.getSrc(),
-                                       expandRhsOp.getSrc(), newAcc,
+        loc, accType,
+        rewriter.create<arith::ConstantOp>(
+            loc, rewriter.getZeroAttr(accType.getElementType())));
+    rewriter.replaceOpWithNewOp<DotOp>(op, lhs, rhs, newAcc,
                                        InputPrecision::TF32, 0);
     return success();
   }
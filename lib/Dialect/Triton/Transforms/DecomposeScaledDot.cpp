@@ -0,0 +1,190 @@
+#include <memory>
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/LLVM.h"
+#include "mlir/Support/LogicalResult.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/Transforms/Passes.h"
+
+#define GEN_PASS_DEF_TRITONDECOMPOSESCALEDDOT
+#include "triton/Dialect/Triton/Transforms/Passes.h.inc"
+
+namespace mlir::triton {
+namespace {
+
+Value createSplat(PatternRewriter &rewriter, Location loc,
+                  RankedTensorType type, int64_t value) {
+  return rewriter.create<arith::ConstantOp>(
+      loc, SplatElementsAttr::get(
+               type, rewriter.getIntegerAttr(type.getElementType(), value)));
+}
+
+// Converts a tensor of e2m1 values in the low nibbles of its i8 elements to
+// bf16, by building the bits of the bf16 values of its sign, 2-bit exponent
+// and 1-bit mantissa: the bf16 exponent is the e2m1 exponent rebiased from 1
+// to 127, and the subnormals of e2m1, 0 and 0.5, are special cased.
+Value convertE2M1ToBf16(PatternRewriter &rewriter, Location loc, Value src) {
+  auto srcTy = cast<RankedTensorType>(src.getType());
+  auto i16Ty = srcTy.clone(rewriter.getI16Type());
+  auto cst = [&](int64_t value) {
+    return createSplat(rewriter, loc, i16Ty, value);
+  };
+  Value v = rewriter.create<arith::ExtUIOp>(loc, i16Ty, src);
+  Value sign = rewriter.create<arith::ShLIOp>(
+      loc, rewriter.create<arith::AndIOp>(loc, v, cst(0x8)), cst(12));
+  Value exp = rewriter.create<arith::AndIOp>(
+      loc, rewriter.create<arith::ShRUIOp>(loc, v, cst(1)), cst(0x3));
+  Value mant = rewriter.create<arith::AndIOp>(loc, v, cst(0x1));
+  Value normal = rewriter.create<arith::OrIOp>(
+      loc,
+      rewriter.create<arith::ShLIOp>(
+          loc, rewriter.create<arith::AddIOp>(loc, exp, cst(126)), cst(7)),
+      rewriter.create<arith::ShLIOp>(loc, mant, cst(6)));
+  Value subnormal = rewriter.create<arith::MulIOp>(loc, mant, cst(126 << 7));
+  Value isSubnormal = rewriter.create<arith::CmpIOp>(
+      loc, arith::CmpIPredicate::eq, exp, cst(0));
+  Value bits = rewriter.create<arith::OrIOp>(
+      loc, rewriter.create<arith::SelectOp>(loc, isSubnormal, subnormal, normal),
+      sign);
+  return rewriter.create<BitcastOp>(loc, srcTy.clone(rewriter.getBF16Type()),
+                                    bits);
+}
+
+// Unpacks the two e2m1 elements of each byte of `src` along the K dimension
+// `kDim` of the operand.
+Value unpackE2M1(PatternRewriter &rewriter, Location loc, Value src,
+                 int kDim) {
+  auto srcTy = cast<RankedTensorType>(src.getType());
+  Value lo = rewriter.create<arith::AndIOp>(loc, src,
+                                            createSplat(rewriter, loc, srcTy,
+                                                        0xF));
+  Value hi = rewriter.create<arith::ShRUIOp>(loc, src,
+                                             createSplat(rewriter, loc, srcTy,
+                                                         4));
+  Value joined =
+      rewriter.create<JoinOp>(loc, convertE2M1ToBf16(rewriter, loc, lo),
+                              convertE2M1ToBf16(rewriter, loc, hi));
+  // The pairs of elements are the minor dimension of the join, which needs to
+  // follow K to reshape them into K.
+  if (kDim == 0)
+    joined = rewriter.create<TransOp>(loc, joined, ArrayRef<int32_t>{0, 2, 1});
+  SmallVector<int64_t> shape(srcTy.getShape());
+  shape[kDim] *= 2;
+  return rewriter.create<ReshapeOp>(
+      loc, RankedTensorType::get(shape, rewriter.getBF16Type()), joined,
+      /*allow_reorder=*/false);
+}
+
+// Converts the scales to bf16 and broadcasts them to the shape of the
+// operand, whose K dimension is `kDim`.
+Value broadcastScale(PatternRewriter &rewriter, Location loc, Value scale,
+                     int kDim) {
+  auto scaleTy = cast<RankedTensorType>(scale.getType());
+  auto bf16Ty = scaleTy.clone(rewriter.getBF16Type());
+  Value bf16Scale;
+  if (scaleTy.getElementType().isInteger(8)) {
+    // An e8m0 scale is the exponent of a bf16 value, with 0xFF as NaN.
+    auto i16Ty = scaleTy.clone(rewriter.getI16Type());
+    Value v = rewriter.create<arith::ExtUIOp>(loc, i16Ty, scale);
+    Value bits = rewriter.create<arith::ShLIOp>(
+        loc, v, createSplat(rewriter, loc, i16Ty, 7));
+    Value isNaN = rewriter.create<arith::CmpIOp>(
+        loc, arith::CmpIPredicate::eq, v,
+        createSplat(rewriter, loc, i16Ty, 0xFF));
+    bits = rewriter.create<arith::SelectOp>(
+        loc, isNaN, createSplat(rewriter, loc, i16Ty, 0x7FC0), bits);
+    bf16Scale = rewriter.create<BitcastOp>(loc, bf16Ty, bits);
+  } else {
+    bf16Scale = rewriter.create<FpToFpOp>(loc, bf16Ty, scale);
+  }
+  // [nonK, K / B] -> [nonK, K / B, B] -> [nonK, K]
+  ArrayRef<int64_t> shape = scaleTy.getShape();
+  int64_t blockSize = scaleTy.getElementType().isInteger(8) ? 32 : 16;
+  Value expanded = rewriter.create<ExpandDimsOp>(loc, bf16Scale, 2);
+  Value broadcasted = rewriter.create<BroadcastOp>(
+      loc,
+      RankedTensorType::get({shape[0], shape[1], blockSize},
+                            rewriter.getBF16Type()),
+      expanded);
+  Value result = rewriter.create<ReshapeOp>(
+      loc,
+      RankedTensorType::get({shape[0], shape[1] * blockSize},
+                            rewriter.getBF16Type()),
+      broadcasted, /*allow_reorder=*/false);
+  if (kDim == 0)
+    result = rewriter.create<TransOp>(loc, result, ArrayRef<int32_t>{1, 0});
+  return result;
+}
+
+// Returns the bf16 values of a scaled operand.
+Value upcastOperand(PatternRewriter &rewriter, Location loc, Value v,
+                    Value scale, ScaleDotElemType type, int kDim) {
+  auto vTy = cast<RankedTensorType>(v.getType());
+  switch (type) {
+  case ScaleDotElemType::E2M1:
+    v = unpackE2M1(rewriter, loc, v, kDim);
+    break;
+  case ScaleDotElemType::E4M3:
+  case ScaleDotElemType::E5M2:
+    v = rewriter.create<FpToFpOp>(loc, vTy.clone(rewriter.getBF16Type()), v);
+    break;
+  case ScaleDotElemType::BF16:
+    break;
+  }
+  if (!scale)
+    return v;
+  return rewriter.create<arith::MulFOp>(
+      loc, v, broadcastScale(rewriter, loc, scale, kDim));
+}
+
+// dot_scaled(lhs, lhs_scale, rhs, rhs_scale, c) =>
+//   dot(upcast(lhs) * broadcast(lhs_scale), upcast(rhs) *
+//   broadcast(rhs_scale), c)
+//
+// The operands are upcast to bf16, which represents all the values of the
+// microscaling element types and, having the 8-bit exponent of e8m0, the
+// products of the values by their scales. The dot then runs on the bf16 MMAs
+// of each target.
+struct DecomposeScaledDotPattern : public OpRewritePattern<DotScaledOp> {
+  using OpRewritePattern::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(DotScaledOp op,
+                                PatternRewriter &rewriter) const override {
+    Location loc = op.getLoc();
+    Value a = upcastOperand(rewriter, loc, op.getLhs(), op.getLhsScale(),
+                            op.getLhsType(), /*kDim=*/1);
+    Value b = upcastOperand(rewriter, loc, op.getRhs(), op.getRhsScale(),
+                            op.getRhsType(), /*kDim=*/0);
+    rewriter.replaceOpWithNewOp<DotOp>(op, op.getType(), a, b, op.getC(),
+                                       InputPrecision::IEEE,
+                                       /*maxNumImpreciseAcc=*/0);
+    return success();
+  }
+};
+
+class DecomposeScaledDotPass
+    : public ::impl::TritonDecomposeScaledDotBase<DecomposeScaledDotPass> {
+public:
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    RewritePatternSet patterns(context);
+    ModuleOp m = getOperation();
+
+    patterns.add<DecomposeScaledDotPattern>(context);
+
+    if (applyPatternsAndFoldGreedily(m, std::move(patterns)).failed())
+      signalPassFailure();
+  }
+};
+
+} // namespace
+
+std::unique_ptr<mlir::Pass> createDecomposeScaledDotPass() {
+  return std::make_unique<DecomposeScaledDotPass>();
+}
+
+} // namespace mlir::triton
@@ -0,0 +1,81 @@
+#include <memory>
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/LLVM.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "triton/Analysis/IntegerRange.h"
+#include "triton/Analysis/Utility.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/Transforms/Passes.h"
+
+#define GEN_PASS_DEF_TRITONFOLDMASKS
+#include "triton/Dialect/Triton/Transforms/Passes.h.inc"
+
+namespace mlir::triton {
+namespace {
+
+// Returns a constant with the value of `value` if it is a mask that the
+// analysis proves to be uniformly true or false.
+Value getConstantMask(OpBuilder &builder, Value value, DataFlowSolver &solver) {
+  Type elemTy = getElementTypeOrSelf(value.getType());
+  if (!elemTy.isInteger(1))
+    return Value();
+  std::optional<ConstantIntRanges> range = getIntegerRange(solver, value);
+  if (!range)
+    return Value();
+  std::optional<APInt> constant = range->getConstantValue();
+  if (!constant)
+    return Value();
+  TypedAttr attr = builder.getBoolAttr(constant->isOne());
+  if (auto tensorTy = dyn_cast<RankedTensorType>(value.getType()))
+    attr = SplatElementsAttr::get(tensorTy, attr);
+  return builder.create<arith::ConstantOp>(value.getLoc(), attr);
+}
+
+class FoldMasksPass : public ::impl::TritonFoldMasksBase<FoldMasksPass> {
+public:
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    ModuleOp m = getOperation();
+
+    // Replace the masks known to be uniform by constants, which the
+    // canonicalization of the loads and stores then drops along with the
+    // `other` values, or which select the `other` values.
+    OpBuilder builder(context);
+    WalkResult result = m.walk([&](FuncOp funcOp) {
+      std::unique_ptr<DataFlowSolver> solver = createDataFlowSolver();
+      solver->load<TritonIntegerRangeAnalysis>();
+      if (failed(solver->initializeAndRun(funcOp)))
+        return WalkResult::interrupt();
+      funcOp.walk([&](Operation *op) {
+        if (isa<arith::ConstantOp>(op))
+          return;
+        builder.setInsertionPoint(op);
+        for (Value result : op->getResults())
+          if (!result.use_empty())
+            if (Value mask = getConstantMask(builder, result, *solver))
+              result.replaceAllUsesWith(mask);
+      });
+      return WalkResult::advance();
+    });
+    if (result.wasInterrupted())
+      return signalPassFailure();
+
+    RewritePatternSet patterns(context);
+    LoadOp::getCanonicalizationPatterns(patterns, context);
+    StoreOp::getCanonicalizationPatterns(patterns, context);
+    if (applyPatternsAndFoldGreedily(m, std::move(patterns)).failed())
+      signalPassFailure();
+  }
+};
+
+} // namespace
+
+std::unique_ptr<mlir::Pass> createFoldMasksPass() {
+  return std::make_unique<FoldMasksPass>();
+}
+
+} // namespace mlir::triton
@@ -0,0 +1,144 @@
+#include <memory>
+
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/SCF/Utils/Utils.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/LLVM.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/Transforms/Passes.h"
+#include "llvm/Support/Debug.h"
+
+#define GEN_PASS_DEF_TRITONLOOPUNROLL
+#include "triton/Dialect/Triton/Transforms/Passes.h.inc"
+
+#define DEBUG_TYPE "triton-loop-unroll"
+#define DBGS() (llvm::dbgs() << "[" DEBUG_TYPE "]: ")
+#define LDBG(X) LLVM_DEBUG(DBGS() << X << "\n")
+
+namespace mlir::triton {
+namespace {
+
+constexpr char kUnrollFactorAttr[] = "tt.loop_unroll_factor";
+constexpr char kInterleaveFactorAttr[] = "tt.loop_interleave_factor";
+
+int getFactor(scf::ForOp forOp, StringRef name) {
+  if (auto attr = forOp->getAttrOfType<IntegerAttr>(name))
+    return std::max<int64_t>(attr.getInt(), 1);
+  return 1;
+}
+
+// Reorders the unrolled copies of the loop body, the ops of `copies` in
+// block order tagged with their copy index, so that the ops of each group of
+// `interleave` consecutive copies alternate. Each op stays after the ops it
+// uses, and the ops with memory effects keep their order.
+void interleaveCopies(ArrayRef<std::pair<Operation *, unsigned>> copies,
+                      int interleave) {
+  if (copies.empty())
+    return;
+  Block *block = copies.front().first->getBlock();
+  Operation *end = copies.back().first->getNextNode();
+  llvm::SmallPtrSet<Operation *, 32> unplaced;
+  SmallVector<Operation *> effectful;
+  for (auto [op, copy] : copies) {
+    unplaced.insert(op);
+    if (!isMemoryEffectFree(op))
+      effectful.push_back(op);
+  }
+  unsigned nextEffect = 0;
+  auto isReady = [&](Operation *op) {
+    if (!isMemoryEffectFree(op) && effectful[nextEffect] != op)
+      return false;
+    WalkResult result = op->walk([&](Operation *nested) {
+      for (Value operand : nested->getOperands()) {
+        Operation *def = operand.getDefiningOp();
+        if (def && def != op && unplaced.contains(def))
+          return WalkResult::interrupt();
+      }
+      return WalkResult::advance();
+    });
+    return !result.wasInterrupted();
+  };
+
+  // The ops of each copy, in order.
+  unsigned numCopies = copies.back().second + 1;
+  SmallVector<SmallVector<Operation *>> queues(numCopies);
+  for (auto [op, copy] : copies)
+    queues[copy].push_back(op);
+  SmallVector<Operation *> order;
+  for (unsigned first = 0; first < numCopies; first += interleave) {
+    unsigned last = std::min<unsigned>(first + interleave, numCopies);
+    SmallVector<unsigned> heads(numCopies, 0);
+    bool done = false;
+    while (!done) {
+      done = true;
+      for (unsigned copy = first; copy < last; ++copy) {
+        if (heads[copy] == queues[copy].size())
+          continue;
+        done = false;
+        Operation *op = queues[copy][heads[copy]];
+        // The lowest copy that isn't done can always make progress.
+        if (!isReady(op))
+          continue;
+        if (!isMemoryEffectFree(op))
+          ++nextEffect;
+        unplaced.erase(op);
+        order.push_back(op);
+        ++heads[copy];
+      }
+    }
+  }
+  for (Operation *op : order) {
+    if (end)
+      op->moveBefore(end);
+    else
+      op->moveBefore(block, block->end());
+  }
+}
+
+class LoopUnrollPass : public ::impl::TritonLoopUnrollBase<LoopUnrollPass> {
+public:
+  void runOnOperation() override {
+    // The factors are dropped first, so that the unrolled copies and the
+    // remainder loops of outer loops don't unroll the inner loops again. The
+    // loops are walked inner first, so an outer loop copies the inner loops
+    // already unrolled.
+    SmallVector<std::tuple<scf::ForOp, int, int>> loops;
+    getOperation().walk([&](scf::ForOp forOp) {
+      int unroll = getFactor(forOp, kUnrollFactorAttr);
+      int interleave = getFactor(forOp, kInterleaveFactorAttr);
+      forOp->removeAttr(kUnrollFactorAttr);
+      forOp->removeAttr(kInterleaveFactorAttr);
+      if (unroll > 1)
+        loops.push_back({forOp, unroll, std::min(interleave, unroll)});
+    });
+    for (auto [forOp, unroll, interleave] : loops) {
+      // The ops of the unrolled body, with the copy they belong to. The
+      // remainder loop is cloned before the body is unrolled, so it runs the
+      // last iterations one at a time.
+      SmallVector<std::pair<Operation *, unsigned>> copies;
+      auto annotate = [&](unsigned copy, Operation *op, OpBuilder) {
+        copies.push_back({op, copy});
+      };
+      if (failed(loopUnrollByFactor(forOp, unroll, annotate))) {
+        LDBG("cannot unroll " << forOp);
+        continue;
+      }
+      if (interleave == 1)
+        continue;
+      // The original ops are annotated after their copies.
+      llvm::stable_sort(copies, [](auto &a, auto &b) {
+        return a.first->isBeforeInBlock(b.first);
+      });
+      interleaveCopies(copies, interleave);
+    }
+  }
+};
+
+} // namespace
+
+std::unique_ptr<mlir::Pass> createLoopUnrollPass() {
+  return std::make_unique<LoopUnrollPass>();
+}
+
+} // namespace mlir::triton
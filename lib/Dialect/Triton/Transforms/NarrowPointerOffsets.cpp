@@ -0,0 +1,173 @@
+#include <limits>
+#include <memory>
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/LLVM.h"
+#include "triton/Analysis/IntegerRange.h"
+#include "triton/Analysis/Utility.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/Transforms/Passes.h"
+
+#define GEN_PASS_DEF_TRITONNARROWPOINTEROFFSETS
+#include "triton/Dialect/Triton/Transforms/Passes.h.inc"
+
+namespace mlir::triton {
+namespace {
+
+bool isSplat(Value value) {
+  DenseIntElementsAttr attr;
+  return value.getDefiningOp<SplatOp>() ||
+         (matchPattern(value, m_Constant(&attr)) && attr.isSplat());
+}
+
+// Returns the scalar splat by `value`, for which isSplat() holds.
+Value getSplatSource(OpBuilder &builder, Value value) {
+  if (auto splat = value.getDefiningOp<SplatOp>())
+    return splat.getSrc();
+  DenseIntElementsAttr attr;
+  matchPattern(value, m_Constant(&attr));
+  return builder.create<arith::ConstantOp>(value.getLoc(),
+                                           attr.getSplatValue<IntegerAttr>());
+}
+
+class OffsetNarrowing {
+public:
+  explicit OffsetNarrowing(DataFlowSolver &solver)
+      : solver(solver), builder(solver.getContext()) {}
+
+  // Moves the uniform terms of the 64-bit offsets of `op` to the scalar
+  // pointer they are added to:
+  //
+  // addptr(splat(base), splat(s) + t) => addptr(splat(addptr(base, s)), t)
+  //
+  // so that the uniform part of the addresses is computed once per program,
+  // and narrows the offsets to 32 bits if their range allows it.  Erases `op`
+  // if its offsets are uniform.
+  void rewrite(AddPtrOp op) {
+    if (!isa<RankedTensorType>(op.getOffset().getType()) ||
+        !getElementTypeOrSelf(op.getOffset().getType()).isInteger(64))
+      return;
+    Value ptr = op.getPtr();
+    Value offset = op.getOffset();
+    if (auto splat = ptr.getDefiningOp<SplatOp>()) {
+      builder.setInsertionPoint(op);
+      Value base = splat.getSrc();
+      while (auto add = offset.getDefiningOp<arith::AddIOp>()) {
+        Value uniform = add.getLhs(), rest = add.getRhs();
+        if (!isSplat(uniform))
+          std::swap(uniform, rest);
+        if (!isSplat(uniform))
+          break;
+        base = builder.create<AddPtrOp>(op.getLoc(), base.getType(), base,
+                                        getSplatSource(builder, uniform));
+        offset = rest;
+      }
+      if (isSplat(offset)) {
+        base = builder.create<AddPtrOp>(op.getLoc(), base.getType(), base,
+                                        getSplatSource(builder, offset));
+        op.replaceAllUsesWith(
+            builder.create<SplatOp>(op.getLoc(), ptr.getType(), base));
+        op.erase();
+        return;
+      }
+      if (offset != op.getOffset())
+        ptr = builder.create<SplatOp>(op.getLoc(), ptr.getType(), base);
+    }
+    if (fitsInInt32(offset))
+      offset = narrow(offset);
+    op.getPtrMutable().assign(ptr);
+    op.getOffsetMutable().assign(offset);
+  }
+
+private:
+  bool fitsInInt32(Value value) {
+    std::optional<ConstantIntRanges> range = getIntegerRange(solver, value);
+    return range &&
+           range->smin().getSExtValue() >=
+               std::numeric_limits<int32_t>::min() &&
+           range->smax().getSExtValue() <= std::numeric_limits<int32_t>::max();
+  }
+
+  // Returns the 32-bit version of the 64-bit `value`, which fits in 32 bits.
+  // The sums and products whose operands also fit in 32 bits are computed in
+  // 32 bits: they can't overflow.
+  Value narrow(Value value) {
+    if (Value narrowed = narrowedValues.lookup(value))
+      return narrowed;
+    Type i32Ty = builder.getI32Type();
+    if (auto tensorTy = dyn_cast<RankedTensorType>(value.getType()))
+      i32Ty = tensorTy.clone(i32Ty);
+
+    Value narrowed;
+    Operation *def = value.getDefiningOp();
+    Attribute attr;
+    if (auto ext = dyn_cast_or_null<arith::ExtSIOp>(def);
+        ext && ext.getIn().getType() == i32Ty) {
+      narrowed = ext.getIn();
+    } else if (def && matchPattern(def, m_Constant(&attr))) {
+      builder.setInsertionPointAfter(def);
+      auto toInt32 = [](const APInt &v) { return v.trunc(32); };
+      if (auto values = dyn_cast<DenseIntElementsAttr>(attr))
+        attr = values.mapValues(getElementTypeOrSelf(i32Ty), toInt32);
+      else
+        attr = builder.getIntegerAttr(
+            i32Ty, toInt32(cast<IntegerAttr>(attr).getValue()));
+      narrowed = builder.create<arith::ConstantOp>(def->getLoc(),
+                                                   cast<TypedAttr>(attr));
+    } else if (def &&
+               isa<arith::AddIOp, arith::SubIOp, arith::MulIOp, SplatOp,
+                   BroadcastOp, ExpandDimsOp>(def) &&
+               llvm::all_of(def->getOperands(), [&](Value operand) {
+                 return fitsInInt32(operand);
+               })) {
+      SmallVector<Value> operands;
+      for (Value operand : def->getOperands())
+        operands.push_back(narrow(operand));
+      builder.setInsertionPointAfter(def);
+      OperationState state(def->getLoc(), def->getName(), operands, {i32Ty},
+                           def->getAttrDictionary().getValue());
+      // The overflow flags of the 64-bit arithmetic don't hold in 32 bits.
+      state.attributes.erase("overflowFlags");
+      narrowed = builder.create(state)->getResult(0);
+    } else {
+      builder.setInsertionPointAfterValue(value);
+      narrowed = builder.create<arith::TruncIOp>(value.getLoc(), i32Ty, value);
+    }
+    narrowedValues[value] = narrowed;
+    return narrowed;
+  }
+
+  DataFlowSolver &solver;
+  OpBuilder builder;
+  DenseMap<Value, Value> narrowedValues;
+};
+
+class NarrowPointerOffsetsPass
+    : public ::impl::TritonNarrowPointerOffsetsBase<NarrowPointerOffsetsPass> {
+public:
+  void runOnOperation() override {
+    ModuleOp m = getOperation();
+    WalkResult result = m.walk([&](FuncOp funcOp) {
+      std::unique_ptr<DataFlowSolver> solver = createDataFlowSolver();
+      solver->load<TritonIntegerRangeAnalysis>();
+      if (failed(solver->initializeAndRun(funcOp)))
+        return WalkResult::interrupt();
+      OffsetNarrowing narrowing(*solver);
+      funcOp.walk([&](AddPtrOp op) { narrowing.rewrite(op); });
+      return WalkResult::advance();
+    });
+    if (result.wasInterrupted())
+      signalPassFailure();
+  }
+};
+
+} // namespace
+
+std::unique_ptr<mlir::Pass> createNarrowPointerOffsetsPass() {
+  return std::make_unique<NarrowPointerOffsetsPass>();
+}
+
+} // namespace mlir::triton
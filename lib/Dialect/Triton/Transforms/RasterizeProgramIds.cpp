@@ -0,0 +1,165 @@
+#include <memory>
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/LLVM.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/Transforms/Passes.h"
+#include "llvm/Support/MathExtras.h"
+
+#define GEN_PASS_DEF_TRITONRASTERIZEPROGRAMIDS
+#include "triton/Dialect/Triton/Transforms/Passes.h.inc"
+
+namespace mlir::triton {
+namespace {
+
+// Builds the i32 arithmetic of the remapping.
+struct IndexBuilder {
+  OpBuilder &b;
+  Location loc;
+
+  Value cst(int64_t value) {
+    return b.create<arith::ConstantIntOp>(loc, value, 32);
+  }
+  Value add(Value x, Value y) { return b.create<arith::AddIOp>(loc, x, y); }
+  Value sub(Value x, Value y) { return b.create<arith::SubIOp>(loc, x, y); }
+  Value mul(Value x, Value y) { return b.create<arith::MulIOp>(loc, x, y); }
+  Value div(Value x, Value y) { return b.create<arith::DivUIOp>(loc, x, y); }
+  Value rem(Value x, Value y) { return b.create<arith::RemUIOp>(loc, x, y); }
+  Value min(Value x, Value y) { return b.create<arith::MinUIOp>(loc, x, y); }
+  Value bit(Value x, int i) {
+    return b.create<arith::AndIOp>(
+        loc, b.create<arith::ShRUIOp>(loc, x, cst(i)), cst(1));
+  }
+  Value eq(Value x, Value y) {
+    return b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::eq, x, y);
+  }
+  Value select(Value cond, Value x, Value y) {
+    return b.create<arith::SelectOp>(loc, cond, x, y);
+  }
+};
+
+// The coordinates of the `index`-th cell of a `size` x `size` square along
+// the Z-order curve, for a `size` power of two.
+std::pair<Value, Value> mortonOrder(IndexBuilder &ib, Value index, int size) {
+  Value x = ib.cst(0), y = ib.cst(0);
+  for (int i = 0; (1 << i) < size; ++i) {
+    x = ib.add(x, ib.mul(ib.bit(index, 2 * i), ib.cst(1 << i)));
+    y = ib.add(y, ib.mul(ib.bit(index, 2 * i + 1), ib.cst(1 << i)));
+  }
+  return {x, y};
+}
+
+// The coordinates of the `index`-th cell of a `size` x `size` square along
+// the Hilbert curve, for a `size` power of two.
+std::pair<Value, Value> hilbertOrder(IndexBuilder &ib, Value index,
+                                     int size) {
+  Value x = ib.cst(0), y = ib.cst(0);
+  for (int s = 1, i = 0; s < size; s *= 2, i += 2) {
+    Value rx = ib.bit(index, i + 1);
+    Value ry = ib.b.create<arith::XOrIOp>(ib.loc, ib.bit(index, i), rx);
+    // The quadrants of the lower row are reflected, and transposed.
+    Value lower = ib.eq(ry, ib.cst(0));
+    Value reflect = ib.b.create<arith::AndIOp>(ib.loc, lower,
+                                               ib.eq(rx, ib.cst(1)));
+    x = ib.select(reflect, ib.sub(ib.cst(s - 1), x), x);
+    y = ib.select(reflect, ib.sub(ib.cst(s - 1), y), y);
+    Value tx = ib.select(lower, y, x);
+    Value ty = ib.select(lower, x, y);
+    x = ib.add(tx, ib.mul(rx, ib.cst(s)));
+    y = ib.add(ty, ib.mul(ry, ib.cst(s)));
+  }
+  return {x, y};
+}
+
+class RasterizeProgramIdsPass
+    : public ::impl::TritonRasterizeProgramIdsBase<RasterizeProgramIdsPass> {
+public:
+  RasterizeProgramIdsPass() = default;
+  RasterizeProgramIdsPass(const std::string &order, int groupSize) {
+    this->order = order;
+    this->groupSize = groupSize;
+  }
+
+  void runOnOperation() override {
+    if (order != "grouped" && order != "morton" && order != "hilbert") {
+      getOperation().emitError("unknown program rasterization: ") << order;
+      return signalPassFailure();
+    }
+    // The curves fill squares of a power of two size.
+    int size = std::max<int>(groupSize, 1);
+    if (order != "grouped")
+      size = 1 << llvm::Log2_32(size);
+    // Each function remaps the ids itself, so that the functions that aren't
+    // inlined see the same ids as their callers.
+    getOperation().walk([&](FuncOp func) { rasterize(func, size); });
+  }
+
+private:
+  void rasterize(FuncOp func, int size) {
+    SmallVector<GetProgramIdOp> pids;
+    func.walk([&](GetProgramIdOp op) {
+      if (op.getAxis() != ProgramIDDim::Z)
+        pids.push_back(op);
+    });
+    if (pids.empty())
+      return;
+
+    auto b = OpBuilder::atBlockBegin(&func.getBody().front());
+    IndexBuilder ib{b, func.getLoc()};
+    auto x = ProgramIDDimAttr::get(b.getContext(), ProgramIDDim::X);
+    auto y = ProgramIDDimAttr::get(b.getContext(), ProgramIDDim::Y);
+    Value pidX = b.create<GetProgramIdOp>(ib.loc, b.getI32Type(), x);
+    Value pidY = b.create<GetProgramIdOp>(ib.loc, b.getI32Type(), y);
+    Value numX = b.create<GetNumProgramsOp>(ib.loc, b.getI32Type(), x);
+    Value numY = b.create<GetNumProgramsOp>(ib.loc, b.getI32Type(), y);
+
+    // The programs are launched along x first. In the grouped order, the
+    // programs of each group of `size` consecutive x ids run along x first,
+    // then along y, so that the programs running at once cover a square-ish
+    // part of the grid rather than whole rows, like tl.swizzle2d.
+    Value linear = ib.add(pidX, ib.mul(pidY, numX));
+    Value groupLen = ib.mul(ib.cst(size), numY);
+    Value firstX = ib.mul(ib.div(linear, groupLen), ib.cst(size));
+    Value groupX = ib.min(ib.sub(numX, firstX), ib.cst(size));
+    Value local = ib.rem(linear, groupLen);
+    Value newX = ib.add(firstX, ib.rem(local, groupX));
+    Value newY = ib.div(local, groupX);
+
+    // The squares of `size` x `size` programs of the full groups are visited
+    // along the curve, and the programs at the edges of the grid in the
+    // grouped order.
+    if (order != "grouped" && size > 1) {
+      Value square = ib.div(local, ib.cst(size * size));
+      Value firstY = ib.mul(square, ib.cst(size));
+      Value full = b.create<arith::AndIOp>(
+          ib.loc, ib.eq(groupX, ib.cst(size)),
+          b.create<arith::CmpIOp>(ib.loc, arith::CmpIPredicate::ule,
+                                  ib.add(firstY, ib.cst(size)), numY));
+      Value cell = ib.rem(local, ib.cst(size * size));
+      auto [dx, dy] = order == "morton" ? mortonOrder(ib, cell, size)
+                                        : hilbertOrder(ib, cell, size);
+      newX = ib.select(full, ib.add(firstX, dx), newX);
+      newY = ib.select(full, ib.add(firstY, dy), newY);
+    }
+
+    for (GetProgramIdOp op : pids) {
+      op.replaceAllUsesWith(op.getAxis() == ProgramIDDim::X ? newX : newY);
+      op.erase();
+    }
+  }
+};
+
+} // namespace
+
+std::unique_ptr<mlir::Pass> createRasterizeProgramIdsPass() {
+  return std::make_unique<RasterizeProgramIdsPass>();
+}
+
+std::unique_ptr<mlir::Pass>
+createRasterizeProgramIdsPass(const std::string &order, int groupSize) {
+  return std::make_unique<RasterizeProgramIdsPass>(order, groupSize);
+}
+
+} // namespace mlir::triton
@@ -24,9 +24,17 @@ private:
   SmallVector<Value> strides;
   SmallVector<Value> offsets;
   ArrayRef<int64_t> tensorShape;
+  // The page table and page size of a tensor paged along its first dimension
+  Value pageTable;
+  int32_t pageSize = 0;
 
   // A cache to avoid generating the same offset with range
   DenseMap<unsigned, Value> cachedOffsetWithRange;
+  // A cache of the ranges of the dimensions, expanded to the rank of the
+  // block, by dimension and bit width
+  DenseMap<std::pair<unsigned, unsigned>, Value> cachedRange;
+  // A cache of the rows of the block in memory, through the page table
+  Value cachedPagedRows;
 
 public:
   RewritedInfo() = default;
@@ -36,9 +44,10 @@ public:
   RewritedInfo(Value base, const SmallVector<Value> &shape,
                const SmallVector<Value> &strides,
                const SmallVector<Value> &offsets,
-               const ArrayRef<int64_t> &tensorShape)
+               const ArrayRef<int64_t> &tensorShape, Value pageTable = {},
+               int32_t pageSize = 0)
       : base(base), shape(shape), strides(strides), offsets(offsets),
-        tensorShape(tensorShape) {
+        tensorShape(tensorShape), pageTable(pageTable), pageSize(pageSize) {
     assert(shape.size() == strides.size() && shape.size() == offsets.size() &&
            shape.size() == tensorShape.size());
   }
@@ -52,11 +61,41 @@ public:
   void setOffset(unsigned i, Value newOffset) {
     offsets[i] = newOffset;
     cachedOffsetWithRange.clear();
+    cachedRange.clear();
+    cachedPagedRows = {};
   }
 
   void setOffsets(const SmallVector<Value> &newOffsets) {
     offsets = newOffsets;
     cachedOffsetWithRange.clear();
+    cachedRange.clear();
+    cachedPagedRows = {};
+  }
+
+  // Returns the range [0, tensorShape[i]) of integers of `bitWidth` bits,
+  // expanded to the rank of the block along dimension i.
+  Value getExpandedRange(OpBuilder &builder, const Location &loc, unsigned i,
+                         unsigned bitWidth) {
+    auto key = std::make_pair(i, bitWidth);
+    if (cachedRange.count(key))
+      return cachedRange[key];
+
+    auto indexI32RowType =
+        RankedTensorType::get({tensorShape[i]}, builder.getI32Type());
+    Value range = builder.create<triton::MakeRangeOp>(loc, indexI32RowType, 0,
+                                                      tensorShape[i]);
+    if (bitWidth != 32)
+      range = builder.create<arith::ExtSIOp>(
+          loc,
+          RankedTensorType::get({tensorShape[i]},
+                                builder.getIntegerType(bitWidth)),
+          range);
+    for (int j = 0; j < tensorShape.size(); ++j) {
+      if (j == i)
+        continue;
+      range = builder.create<triton::ExpandDimsOp>(loc, range, j);
+    }
+    return cachedRange[key] = range;
   }
 
   Value getExpandedOffsetWithRange(OpBuilder &builder, const Location &loc,
@@ -88,6 +127,54 @@ public:
     return cachedOffsetWithRange[i] = expandedResult;
   }
 
+  // Returns the rows of the block in memory, by mapping its rows in the paged
+  // tensor through the page table. The page indices of the rows out of the
+  // tensor are not loaded, and these rows are masked by boundary checks.
+  Value getPagedRows(OpBuilder &builder, const Location &loc) {
+    if (cachedPagedRows)
+      return cachedPagedRows;
+
+    Value rows = getExpandedOffsetWithRange(builder, loc, 0);
+    auto rowsType = cast<RankedTensorType>(rows.getType());
+    auto splatI64 = [&](int64_t value) -> Value {
+      Value constant = builder.create<arith::ConstantIntOp>(
+          loc, value, builder.getI64Type());
+      return builder.create<triton::SplatOp>(loc, rowsType, constant);
+    };
+    Value inTensor = builder.create<arith::AndIOp>(
+        loc,
+        builder.create<arith::CmpIOp>(loc, arith::CmpIPredicate::sge, rows,
+                                      splatI64(0)),
+        builder.create<arith::CmpIOp>(
+            loc, arith::CmpIPredicate::slt, rows,
+            builder.create<triton::SplatOp>(loc, rowsType, shape[0])));
+
+    Value pageSizes = splatI64(pageSize);
+    Value pages = builder.create<arith::DivSIOp>(loc, rows, pageSizes);
+    Value rowsInPage = builder.create<arith::RemSIOp>(loc, rows, pageSizes);
+    auto pageTablePtrType =
+        RankedTensorType::get(rowsType.getShape(), pageTable.getType());
+    Value pageTablePtrs = builder.create<triton::AddPtrOp>(
+        loc, pageTablePtrType,
+        builder.create<triton::SplatOp>(loc, pageTablePtrType, pageTable),
+        pages);
+    Value zero = builder.create<triton::SplatOp>(
+        loc, RankedTensorType::get(rowsType.getShape(), builder.getI32Type()),
+        builder.create<arith::ConstantIntOp>(loc, 0, builder.getI32Type()));
+    Value pageIndices = builder.create<triton::LoadOp>(
+        loc, pageTablePtrs, inTensor, zero, triton::CacheModifier::NONE,
+        triton::EvictionPolicy::NORMAL, /*isVolatile=*/false);
+    Value pageStarts = builder.create<arith::MulIOp>(
+        loc, builder.create<arith::ExtSIOp>(loc, rowsType, pageIndices),
+        pageSizes);
+    return cachedPagedRows =
+               builder.create<arith::AddIOp>(loc, pageStarts, rowsInPage);
+  }
+
+  // Returns the pointers of the block as those of its first element, which
+  // the offsets move once per block, plus the offsets of the elements within
+  // the block, which only depend on the strides. These are the same for all
+  // the blocks a loop accesses, and are computed once for all of them.
   Value generatePtr(OpBuilder &builder, const Location &loc) {
     assert(tensorShape.size() == offsets.size() &&
            tensorShape.size() == strides.size());
@@ -97,9 +184,20 @@ public:
     auto ptrTensorType = RankedTensorType::get(tensorShape, ptrType);
 
     // Generate offsets per dimension
-    Value ptr = builder.create<triton::SplatOp>(loc, ptrTensorType, base);
+    Value blockBase = base;
+    Value elementOffsets;
     for (unsigned i = 0; i < tensorShape.size(); ++i) {
-      auto offsetWithRange = getExpandedOffsetWithRange(builder, loc, i);
+      Value offsetWithRange;
+      if (i == 0 && pageTable) {
+        // The rows of a paged block are not contiguous in memory.
+        offsetWithRange = getPagedRows(builder, loc);
+      } else {
+        Value blockOffset =
+            builder.create<arith::MulIOp>(loc, offsets[i], strides[i]);
+        blockBase = builder.create<triton::AddPtrOp>(loc, ptrType, blockBase,
+                                                     blockOffset);
+        offsetWithRange = getExpandedRange(builder, loc, i, /*bitWidth=*/64);
+      }
 
       // We must splat strides into the expanded shape not a row for retaining
       // the divisibility information given by strides
@@ -109,15 +207,24 @@ public:
           builder.create<arith::MulIOp>(loc, offsetWithRange, splatStride);
       Value broadcasted = builder.create<triton::BroadcastOp>(
           loc, indexTensorType, offsetWithStride);
-
-      // Add to the pointer
-      ptr = builder.create<triton::AddPtrOp>(loc, ptrTensorType, ptr,
-                                             broadcasted);
+      elementOffsets =
+          elementOffsets
+              ? builder.create<arith::AddIOp>(loc, elementOffsets, broadcasted)
+                    .getResult()
+              : broadcasted;
     }
 
-    return ptr;
+    // Add to the pointer
+    Value ptr = builder.create<triton::SplatOp>(loc, ptrTensorType, blockBase);
+    return builder.create<triton::AddPtrOp>(loc, ptrTensorType, ptr,
+                                            elementOffsets);
   }
 
+  // Returns the mask of the elements of the block within the bounds of the
+  // dimensions of `boundaryCheck`. As offset + range is within [0, shape)
+  // when range is within [-offset, shape - offset), the bounds are computed
+  // once per block, clamped to those of the range so that they fit in 32
+  // bits, and the range is compared to them.
   Value generateMask(OpBuilder &builder, const Location &loc,
                      const std::optional<ArrayRef<int32_t>> &boundaryCheck) {
     if (!boundaryCheck.has_value())
@@ -126,23 +233,32 @@ public:
     // Generate mask per dimension
     auto maskTensorType =
         RankedTensorType::get(tensorShape, builder.getI1Type());
+    Value zero =
+        builder.create<arith::ConstantIntOp>(loc, 0, builder.getI64Type());
     Value mask;
     for (auto i : boundaryCheck.value()) {
-      auto offsetWithRange = getExpandedOffsetWithRange(builder, loc, i);
+      Value range = getExpandedRange(builder, loc, i, /*bitWidth=*/32);
+      Value size = builder.create<arith::ConstantIntOp>(loc, tensorShape[i],
+                                                        builder.getI64Type());
+      auto getRangeBound = [&](Value bound) -> Value {
+        bound = builder.create<arith::MaxSIOp>(loc, bound, zero);
+        bound = builder.create<arith::MinSIOp>(loc, bound, size);
+        bound = builder.create<arith::TruncIOp>(loc, builder.getI32Type(),
+                                                bound);
+        return builder.create<triton::SplatOp>(loc, range.getType(), bound);
+      };
 
       // Compare with lower bound
-      Value lowerBound = builder.create<mlir::arith::ConstantIntOp>(
-          loc, 0, builder.getI64Type());
-      Value splatLowerBound = builder.create<triton::SplatOp>(
-          loc, offsetWithRange.getType(), lowerBound);
+      Value lowerBound =
+          getRangeBound(builder.create<arith::SubIOp>(loc, zero, offsets[i]));
       Value cmpLower = builder.create<arith::CmpIOp>(
-          loc, arith::CmpIPredicate::sge, offsetWithRange, splatLowerBound);
+          loc, arith::CmpIPredicate::sge, range, lowerBound);
 
       // Compare with upper bound
-      Value splatUpperBound = builder.create<triton::SplatOp>(
-          loc, offsetWithRange.getType(), shape[i]);
+      Value upperBound = getRangeBound(
+          builder.create<arith::SubIOp>(loc, shape[i], offsets[i]));
       Value cmpUpper = builder.create<arith::CmpIOp>(
-          loc, arith::CmpIPredicate::slt, offsetWithRange, splatUpperBound);
+          loc, arith::CmpIPredicate::slt, range, upperBound);
 
       // And and broadcast
       Value andResult = builder.create<arith::AndIOp>(loc, cmpLower, cmpUpper);
@@ -239,9 +355,9 @@ public:
     }
 
     // Save information
-    rewritedInfo[op.getResult()] =
-        RewritedInfo(op.getBase(), op.getShape(), op.getStrides(), i64Offsets,
-                     tensorType.getShape());
+    rewritedInfo[op.getResult()] = RewritedInfo(
+        op.getBase(), op.getShape(), op.getStrides(), i64Offsets,
+        tensorType.getShape(), op.getPageTable(), op.getPageSize().value_or(0));
 
     // Erase the original operation
     eraser.push(op);
@@ -40,28 +40,79 @@ static Type getI1SameShapeFromTensorOrTensorPtr(Type type) {
 
 namespace gpu {
 
+template <typename MapT, typename KeyT, typename Create>
+auto EncodingCache::getOrCreate(MapT &map, const KeyT &key, Create create) {
+  {
+    std::shared_lock lock(mutex);
+    auto it = map.find(key);
+    if (it != map.end())
+      return it->second;
+  }
+  // Computed outside of the lock, as the properties of an encoding may be
+  // derived from those of its parent; if another thread raced us, both
+  // results are the same.
+  auto result = create();
+  std::unique_lock lock(mutex);
+  return map.try_emplace(key, std::move(result)).first->second;
+}
+
+unsigned
+EncodingCache::getOrCreateTotalElemsPerThread(const Key &key,
+                                              function_ref<unsigned()> create) {
+  return getOrCreate(totalElemsPerThread, key, create);
+}
+
+SmallVector<unsigned> EncodingCache::getOrCreateElemsPerThread(
+    const Key &key, function_ref<SmallVector<unsigned>()> create) {
+  return getOrCreate(elemsPerThread, key, create);
+}
+
+SmallVector<unsigned> EncodingCache::getOrCreateShapePerCTATile(
+    const Key &key, function_ref<SmallVector<unsigned>()> create) {
+  return getOrCreate(shapePerCTATile, key, create);
+}
+
+CTALayoutAttr
+EncodingCache::getOrCreateCTALayout(Attribute layout,
+                                    function_ref<CTALayoutAttr()> create) {
+  return getOrCreate(ctaLayouts, layout, create);
+}
+
+static EncodingCache *getEncodingCache(MLIRContext *ctx) {
+  auto *dialect = ctx->getLoadedDialect<TritonGPUDialect>();
+  return dialect ? &dialect->encodingCache : nullptr;
+}
+
 // TODO: Inheritance of layout attributes
 // so that all distributed layouts implement
 // these utilities
 
 unsigned getTotalElemsPerThread(Attribute layout, ArrayRef<int64_t> shape,
                                 Type eltTy) {
-  if (auto tritonGPUAttr = mlir::dyn_cast<TritonGPU_AttrTrait>(layout)) {
-    return tritonGPUAttr.getTotalElemsPerThread(shape, eltTy);
-  } else {
+  auto tritonGPUAttr = mlir::dyn_cast<TritonGPU_AttrTrait>(layout);
+  if (!tritonGPUAttr)
     llvm::report_fatal_error("getTotalElemsPerThread not implemented");
-    return 0;
-  }
+  auto create = [&] {
+    return tritonGPUAttr.getTotalElemsPerThread(shape, eltTy);
+  };
+  EncodingCache *cache = getEncodingCache(layout.getContext());
+  if (!cache)
+    return create();
+  return cache->getOrCreateTotalElemsPerThread(
+      {layout, SmallVector<int64_t>(shape), eltTy}, create);
 }
 
 SmallVector<unsigned> getElemsPerThread(Attribute layout,
                                         ArrayRef<int64_t> shape, Type eltTy) {
-  if (auto tritonGPUAttr = mlir::dyn_cast<TritonGPU_AttrTrait>(layout)) {
-    return tritonGPUAttr.getElemsPerThread(shape, eltTy);
-  } else {
+  auto tritonGPUAttr = mlir::dyn_cast<TritonGPU_AttrTrait>(layout);
+  if (!tritonGPUAttr)
     llvm::report_fatal_error("getElemsPerThread not implemented");
-    return SmallVector<unsigned>();
-  }
+  auto create = [&] { return tritonGPUAttr.getElemsPerThread(shape, eltTy); };
+  EncodingCache *cache = getEncodingCache(layout.getContext());
+  if (!cache)
+    return create();
+  return cache->getOrCreateElemsPerThread(
+      {layout, SmallVector<int64_t>(shape), eltTy}, create);
 }
 
 SmallVector<unsigned> getElemsPerThread(Type type) {
@@ -199,13 +250,17 @@ SmallVector<unsigned> getUniqueContigPerThread(Attribute layout,
 
 SmallVector<unsigned> getShapePerCTATile(Attribute layout,
                                          ArrayRef<int64_t> tensorShape) {
-  if (auto distributedLayout =
-          mlir::dyn_cast<DistributedEncodingTrait>(layout)) {
-    return distributedLayout.getShapePerCTATile(tensorShape);
-  } else {
+  auto distributedLayout = mlir::dyn_cast<DistributedEncodingTrait>(layout);
+  if (!distributedLayout)
     llvm::report_fatal_error("getShapePerCTATile not implemented");
-    return SmallVector<unsigned>();
-  }
+  auto create = [&] {
+    return distributedLayout.getShapePerCTATile(tensorShape);
+  };
+  EncodingCache *cache = getEncodingCache(layout.getContext());
+  if (!cache)
+    return create();
+  return cache->getOrCreateShapePerCTATile(
+      {layout, SmallVector<int64_t>(tensorShape), Type()}, create);
 }
 
 bool isExpensiveView(Type srcType, Type dstType) {
@@ -269,6 +324,8 @@ SmallVector<unsigned> getOrder(Attribute layout) {
     std::iota(order.rbegin(), order.rend(), 0);
     return order;
   }
+  if (isa<SparseDotMetaEncodingAttr>(layout))
+    return {1, 0};
   if (auto sliceLayout = dyn_cast<SliceEncodingAttr>(layout)) {
     SmallVector<unsigned> parentOrder = getOrder(sliceLayout.getParent());
     unsigned dim = sliceLayout.getDim();
@@ -290,9 +347,16 @@ SmallVector<unsigned> getOrder(Attribute layout) {
 CTALayoutAttr getCTALayout(Attribute layout) {
   if (auto distributedLayout =
           mlir::dyn_cast<DistributedEncodingTrait>(layout)) {
-    return CTALayoutAttr::get(
-        layout.getContext(), getCTAsPerCGA(distributedLayout),
-        getCTASplitNum(distributedLayout), getCTAOrder(distributedLayout));
+    // Uniquing the CTA layout takes the lock of the context.
+    auto create = [&] {
+      return CTALayoutAttr::get(
+          layout.getContext(), getCTAsPerCGA(distributedLayout),
+          getCTASplitNum(distributedLayout), getCTAOrder(distributedLayout));
+    };
+    EncodingCache *cache = getEncodingCache(layout.getContext());
+    if (!cache)
+      return create();
+    return cache->getOrCreateCTALayout(layout, create);
   } else if (auto sharedLayout = mlir::dyn_cast<SharedEncodingAttr>(layout))
     return sharedLayout.getCTALayout();
   else
@@ -394,6 +458,8 @@ unsigned getNumWarpsPerCTA(Attribute layout) {
     warpsPerCTA = wmmaLayout.getWarpsPerCTA();
   else if (auto dotLayout = dyn_cast<DotOperandEncodingAttr>(layout))
     return getNumWarpsPerCTA(dotLayout.getParent());
+  else if (auto metaLayout = dyn_cast<SparseDotMetaEncodingAttr>(layout))
+    return getNumWarpsPerCTA(metaLayout.getParent());
   else if (auto sharedLayout = dyn_cast<SharedEncodingAttr>(layout))
     llvm::report_fatal_error("Cannot get numWarps from SharedEncodingAttr");
   else
@@ -406,7 +472,8 @@ unsigned getNumCTAs(Attribute layout) {
 }
 
 bool isaDistributedLayout(Attribute layout) {
-  return isa<BlockedEncodingAttr, MmaEncodingTrait, SliceEncodingAttr>(layout);
+  return isa<BlockedEncodingAttr, MmaEncodingTrait, SliceEncodingAttr,
+             SparseDotMetaEncodingAttr>(layout);
 }
 
 template <typename T> bool hasEncoding(Value value) {
@@ -1037,9 +1104,12 @@ LogicalResult DotOperandEncodingAttr::verify(
 
   if (auto parentAttr = mlir::dyn_cast<AMDWmmaEncodingAttr>(parent)) {
     // TODO: remove this condition if new values are supported
-    if (kWidth != 16)
+    if (parentAttr.getVersion() == 1 && kWidth != 16)
       return emitError() << "triton_gpu.dot_op kWidth parameter supports "
                             "only 16 for WMMA parent";
+    if (parentAttr.getVersion() == 2 && kWidth != 8)
+      return emitError() << "triton_gpu.dot_op kWidth parameter supports "
+                            "only 8 for WMMA version 2 parent";
     return success();
   }
 
@@ -1063,6 +1133,69 @@ LogicalResult DotOperandEncodingAttr::verify(
                      << parent;
 }
 
+//===----------------------------------------------------------------------===//
+// SparseDotMeta Encoding
+//===----------------------------------------------------------------------===//
+
+// Each warp holds the metadata of 16 rows and of one mma.sp, i.e. 2 columns,
+// and each thread the metadata of rows g and g+8 of a single column.
+SmallVector<unsigned>
+SparseDotMetaEncodingAttr::getElemsPerThread(ArrayRef<int64_t> shape,
+                                             Type eltTy) const {
+  auto shapePerCTA = getShapePerCTA(*this, shape);
+  auto shapePerCTATile = getShapePerCTATile(shape);
+  return {2 * ceil<unsigned>(shapePerCTA[0], shapePerCTATile[0]),
+          ceil<unsigned>(shapePerCTA[1], shapePerCTATile[1])};
+}
+unsigned
+SparseDotMetaEncodingAttr::getTotalElemsPerThread(ArrayRef<int64_t> shape,
+                                                  Type eltTy) const {
+  return product<unsigned>(getElemsPerThread(shape, eltTy));
+}
+SmallVector<unsigned> SparseDotMetaEncodingAttr::getCTAsPerCGA() const {
+  return ::getCTAsPerCGA(getParent());
+}
+SmallVector<unsigned> SparseDotMetaEncodingAttr::getCTAOrder() const {
+  return ::getCTAOrder(getParent());
+}
+SmallVector<unsigned> SparseDotMetaEncodingAttr::getCTASplitNum() const {
+  // Like the A operand, do not split CTAs along K.
+  SmallVector<unsigned> res = ::getCTASplitNum(getParent());
+  res[1] = 1;
+  return res;
+}
+SmallVector<unsigned> SparseDotMetaEncodingAttr::getWarpsPerCTA() const {
+  return ::getWarpsPerCTA(getParent());
+}
+SmallVector<unsigned> SparseDotMetaEncodingAttr::getWarpOrder() const {
+  return ::getWarpOrder(getParent());
+}
+SmallVector<unsigned> SparseDotMetaEncodingAttr::getThreadsPerWarp() const {
+  return {8, 4};
+}
+SmallVector<unsigned> SparseDotMetaEncodingAttr::getThreadOrder() const {
+  return {1, 0};
+}
+SmallVector<unsigned> SparseDotMetaEncodingAttr::getSizePerThread() const {
+  return {2, 1};
+}
+SmallVector<unsigned> SparseDotMetaEncodingAttr::getShapePerCTATile(
+    ArrayRef<int64_t> tensorShape) const {
+  return {16 * getWarpsPerCTA()[0], 2};
+}
+
+LogicalResult SparseDotMetaEncodingAttr::verify(
+    ::llvm::function_ref<::mlir::InFlightDiagnostic()> emitError,
+    Attribute parent) {
+  auto mmaParent = mlir::dyn_cast_or_null<NvidiaMmaEncodingAttr>(parent);
+  if (!mmaParent || !mmaParent.isAmpere() ||
+      mmaParent.getWarpsPerCTA().size() != 2)
+    return emitError() << "triton_gpu.sparse_dot_meta parent must be a 2D "
+                          "Ampere MMA layout, got: "
+                       << parent;
+  return success();
+}
+
 //===----------------------------------------------------------------------===//
 // Blocked Encoding
 //===----------------------------------------------------------------------===//
@@ -1355,12 +1488,18 @@ Attribute AMDWmmaEncodingAttr::parse(AsmParser &parser, Type type) {
   if (parser.parseGreater().failed())
     return {};
 
+  // The version is optional for the layouts written before gfx12 support.
+  unsigned version = 1;
   SmallVector<unsigned> warpsPerCTA;
   std::optional<SmallVector<unsigned>> CTAsPerCGA;
   std::optional<SmallVector<unsigned>> CTASplitNum;
   std::optional<SmallVector<unsigned>> CTAOrder;
 
   for (const NamedAttribute &attr : dict) {
+    if (attr.getName() == "version") {
+      if (parseUInt(parser, attr, version, "version").failed())
+        return {};
+    }
     if (attr.getName() == "warpsPerCTA") {
       if (parseIntArrayAttr(parser, attr, warpsPerCTA, "warpsPerCTA").failed())
         return {};
@@ -1387,18 +1526,29 @@ Attribute AMDWmmaEncodingAttr::parse(AsmParser &parser, Type type) {
   if (!CTALayout.has_value())
     return {};
 
-  return parser.getChecked<AMDWmmaEncodingAttr>(parser.getContext(),
-                                                warpsPerCTA, *CTALayout);
+  return parser.getChecked<AMDWmmaEncodingAttr>(
+      parser.getContext(), version, warpsPerCTA, *CTALayout);
 }
 
 void AMDWmmaEncodingAttr::print(AsmPrinter &printer) const {
   printer << "<{"
-          << "warpsPerCTA = [" << ArrayRef(getWarpsPerCTA()) << "]";
+          << "version = " << getVersion()
+          << ", warpsPerCTA = [" << ArrayRef(getWarpsPerCTA()) << "]";
   maybePrintCTALayout(getContext(), printer, getCTALayout(),
                       /*rank=*/getWarpsPerCTA().size());
   printer << "}>";
 }
 
+LogicalResult
+AMDWmmaEncodingAttr::verify(function_ref<mlir::InFlightDiagnostic()> emitError,
+                            unsigned version,
+                            llvm::ArrayRef<unsigned int> warpsPerCTA,
+                            mlir::triton::gpu::CTALayoutAttr) {
+  if (version != 1 && version != 2)
+    return emitError() << "WMMA version must be 1 or 2";
+  return success();
+}
+
 //===----------------------------------------------------------------------===//
 // Sliced Encoding
 //===----------------------------------------------------------------------===//
@@ -1713,11 +1863,12 @@ SmallVector<unsigned>
 AMDWmmaEncodingAttr::getSizePerThreadForOperands(unsigned opIdx) const {
   auto rank = getWarpsPerCTA().size();
   SmallVector<unsigned> sizePerThread(rank, 1);
+  auto kWidth = getKWidthForOperands();
   if (opIdx == 0) {
     sizePerThread[rank - 2] = 1;
-    sizePerThread[rank - 1] = 16;
+    sizePerThread[rank - 1] = kWidth;
   } else if (opIdx == 1) {
-    sizePerThread[rank - 2] = 16;
+    sizePerThread[rank - 2] = kWidth;
     sizePerThread[rank - 1] = 1;
   } else {
     llvm::report_fatal_error("DotOperandEncodingAttr opIdx must be 0 or 1");
@@ -1977,6 +2128,14 @@ unsigned NvidiaMmaEncodingAttr::getTotalElemsPerThreadForOperands(
   int warpsPerCTAN = getWarpsPerCTA()[1];
   // H100
   if (isHopper()) {
+    // The A operand in registers has the layout of the accumulator of a wgmma
+    // with N = K, i.e. each thread holds half of a row over the K dimension in
+    // each 16 row tile of its warp.
+    if (opIdx == 0) {
+      int repM = std::max<int>(
+          1, shapePerCTA[0] / (getInstrShape()[0] * warpsPerCTAM));
+      return repM * shapePerCTA[1] / 2;
+    }
     return getTotalElemsPerThread(shape, eltTy);
   }
   // A100
@@ -2687,6 +2846,9 @@ struct CanonicalizeConvertFromHistogram
   mlir::LogicalResult
   matchAndRewrite(triton::HistogramOp op,
                   PatternRewriter &rewriter) const override {
+    // The mask and the weights need the layout of the input.
+    if (op.getMask() || op.getWeights())
+      return failure();
     auto convert = op.getSrc().getDefiningOp<ConvertLayoutOp>();
     if (!convert)
       return failure();
@@ -2793,8 +2955,9 @@ struct CanonicalizeConvertFromConvert
     if (auto histogram = dyn_cast<HistogramOp>(arg)) {
       // For histogram ops the input and output layouts are independent, so we
       // can always fold convert into the histogram op.
-      rewriter.replaceOpWithNewOp<HistogramOp>(op, op->getResult(0).getType(),
-                                               histogram.getSrc());
+      rewriter.replaceOpWithNewOp<HistogramOp>(
+          op, op->getResult(0).getType(), histogram.getSrc(),
+          histogram.getMask(), histogram.getWeights());
       return success();
     }
 
@@ -372,6 +372,31 @@ LinearLayout ampereMmaToLinearLayout(ArrayRef<int64_t> shape,
   return combineCtaCgaWithShape(ctaLayout, mma.getCTALayout(), shape);
 }
 
+LinearLayout sparseDotMetaToLinearLayout(ArrayRef<int64_t> shape,
+                                         SparseDotMetaEncodingAttr meta) {
+  assert(shape.size() == 2);
+  auto mma = cast<NvidiaMmaEncodingAttr>(meta.getParent());
+  MLIRContext *ctx = meta.getContext();
+  SmallVector<StringAttr> dimNames = standardOutDimNames(ctx, 2);
+
+  // Within the 16x2 tile of a warp, thread 4g+t holds rows g and g+8 of
+  // column t % 2. The warps along N of the MMA, which come first in its warp
+  // order, hold the same metadata.
+  int32_t warpsM = mma.getWarpsPerCTA()[0];
+  int32_t warpsN = mma.getWarpsPerCTA()[1];
+  std::vector<std::vector<int32_t>> warpBases;
+  for (int32_t i = 1; i < warpsN; i *= 2)
+    warpBases.push_back({0, 0});
+  for (int32_t i = 1; i < warpsM; i *= 2)
+    warpBases.push_back({0, 16 * i});
+  LinearLayout ctaLayout(
+      {{S("register"), {{0, 8}}},
+       {S("lane"), {{1, 0}, {0, 0}, {0, 1}, {0, 2}, {0, 4}}},
+       {S("warp"), warpBases}},
+      {dimNames[1], dimNames[0]});
+  return combineCtaCgaWithShape(ctaLayout, getCTALayout(meta), shape);
+}
+
 LinearLayout hopperMmaToLinearLayout(ArrayRef<int64_t> shape,
                                      NvidiaMmaEncodingAttr mma) {
   int rank = shape.size();
@@ -523,16 +548,24 @@ LinearLayout wmmaToLinearLayout(ArrayRef<int64_t> shape,
   // For wmma with 16x16 output, each of the 32 threads holds 8 elements.
   //
   // For the register (i.e., element) dimension, these 8 elements are along
-  // the matrix C's M dimension, with 1 consecutive elements spanning 1 row
-  // and then the next 1 row being a gap.
+  // the matrix C's M dimension. For version 1, 1 consecutive elements span 1
+  // row and then the next 1 row is a gap; for version 2, the 8 elements span
+  // 8 consecutive rows.
   //
   // For the lane (i.e., thread) dimension, these threads are along the
   // matrix C's N dimension, with 16 consecutive threads covering a whole
-  // row and the next 16 threads start at the next row.
-  LinearLayout tileLayout(
-      {{kRegister, {/*gap*/ {0, 2}, {0, 4}, {0, 8}}},
-       {kLane, {{1, 0}, {2, 0}, {4, 0}, {8, 0}, /*gap*/ {0, 1}}}},
-      {outDimNames[order[0]], outDimNames[order[1]]});
+  // row. For version 1 the next 16 threads start at the next row; for
+  // version 2 they start 8 rows below.
+  LinearLayout tileLayout =
+      wmma.getVersion() == 1
+          ? LinearLayout(
+                {{kRegister, {/*gap*/ {0, 2}, {0, 4}, {0, 8}}},
+                 {kLane, {{1, 0}, {2, 0}, {4, 0}, {8, 0}, /*gap*/ {0, 1}}}},
+                {outDimNames[order[0]], outDimNames[order[1]]})
+          : LinearLayout(
+                {{kRegister, {{0, 1}, {0, 2}, {0, 4}}},
+                 {kLane, {{1, 0}, {2, 0}, {4, 0}, {8, 0}, /*gap*/ {0, 8}}}},
+                {outDimNames[order[0]], outDimNames[order[1]]});
 
   if (hasBatchDim) {
     assert(order[2] == 0);
@@ -737,11 +770,9 @@ LinearLayout sharedToLinearLayoutLeadingOffset(ArrayRef<int64_t> shape,
   return combineCtaCgaWithShape(tileLayout, shared.getCTALayout(), shape);
 }
 
-} // anonymous namespace
-
 std::optional<LinearLayout>
-toLinearLayout(ArrayRef<int64_t> shape, Attribute layout,
-               std::optional<int32_t> elemBitWidth /*= std::nullopt*/) {
+toLinearLayoutImpl(ArrayRef<int64_t> shape, Attribute layout,
+                   std::optional<int32_t> elemBitWidth) {
   if (auto blocked = dyn_cast<BlockedEncodingAttr>(layout)) {
     return blockedToLinearLayout(shape, blocked);
   }
@@ -762,6 +793,9 @@ toLinearLayout(ArrayRef<int64_t> shape, Attribute layout,
   if (auto slice = dyn_cast<SliceEncodingAttr>(layout)) {
     return sliceToLinearLayout(shape, slice);
   }
+  if (auto meta = dyn_cast<SparseDotMetaEncodingAttr>(layout)) {
+    return sparseDotMetaToLinearLayout(shape, meta);
+  }
   if (auto shared = dyn_cast<SharedEncodingAttr>(layout)) {
     if (shared.getHasLeadingOffset()) {
       assert(elemBitWidth.has_value());
@@ -775,4 +809,69 @@ toLinearLayout(ArrayRef<int64_t> shape, Attribute layout,
   return std::nullopt;
 }
 
+} // anonymous namespace
+
+std::optional<LinearLayout> LinearLayoutCache::getOrCreateLayout(
+    const LayoutKey &key,
+    function_ref<std::optional<LinearLayout>()> create) {
+  {
+    std::shared_lock lock(mutex);
+    auto it = layouts.find(key);
+    if (it != layouts.end())
+      return it->second;
+  }
+  // Build the layout outside of the lock; if another thread raced us, both
+  // results are the same.
+  std::optional<LinearLayout> result = create();
+  std::unique_lock lock(mutex);
+  return layouts.try_emplace(key, std::move(result)).first->second;
+}
+
+std::optional<LinearLayout> LinearLayoutCache::getOrCreateConversion(
+    const ConversionKey &key,
+    function_ref<std::optional<LinearLayout>()> create) {
+  {
+    std::shared_lock lock(mutex);
+    auto it = conversions.find(key);
+    if (it != conversions.end())
+      return it->second;
+  }
+  std::optional<LinearLayout> result = create();
+  std::unique_lock lock(mutex);
+  return conversions.try_emplace(key, std::move(result)).first->second;
+}
+
+std::optional<LinearLayout>
+toLinearLayout(ArrayRef<int64_t> shape, Attribute layout,
+               std::optional<int32_t> elemBitWidth /*= std::nullopt*/) {
+  // elemBitWidth only matters for MMAv3 shared layouts; don't let it split the
+  // cache entries of the other layouts.
+  auto shared = dyn_cast<SharedEncodingAttr>(layout);
+  if (!shared || !shared.getHasLeadingOffset())
+    elemBitWidth = std::nullopt;
+  auto *dialect = layout.getContext()->getLoadedDialect<TritonGPUDialect>();
+  if (!dialect)
+    return toLinearLayoutImpl(shape, layout, elemBitWidth);
+  return dialect->llCache.getOrCreateLayout(
+      {SmallVector<int64_t>(shape), layout, elemBitWidth},
+      [&] { return toLinearLayoutImpl(shape, layout, elemBitWidth); });
+}
+
+std::optional<LinearLayout> getLayoutConversion(RankedTensorType srcTy,
+                                                RankedTensorType dstTy) {
+  auto create = [&]() -> std::optional<LinearLayout> {
+    std::optional<LinearLayout> srcLayout =
+        toLinearLayout(srcTy.getShape(), srcTy.getEncoding());
+    std::optional<LinearLayout> dstLayout =
+        toLinearLayout(dstTy.getShape(), dstTy.getEncoding());
+    if (!srcLayout.has_value() || !dstLayout.has_value())
+      return std::nullopt;
+    return srcLayout->invertAndCompose(*dstLayout);
+  };
+  auto *dialect = srcTy.getContext()->getLoadedDialect<TritonGPUDialect>();
+  if (!dialect)
+    return create();
+  return dialect->llCache.getOrCreateConversion({srcTy, dstTy}, create);
+}
+
 } // namespace mlir::triton::gpu
@@ -7,7 +7,9 @@
 #include "triton/Analysis/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+#include "triton/Dialect/TritonGPU/Transforms/PipeliningUtility.h"
 #include "triton/Dialect/TritonGPU/Transforms/Utility.h"
+#include "triton/Dialect/TritonNvidiaGPU/IR/Dialect.h"
 #include "triton/Tools/Sys/GetEnv.hpp"
 #include "llvm/Support/Debug.h"
 
@@ -27,19 +29,23 @@ static int getMMAVersionSafe(int computeCapability, DotOp op) {
     versionsSupported = {2};
   } else if (computeCapability < 100) {
     versionsSupported = {3, 2};
+  } else if (computeCapability < 110) {
+    versionsSupported = {5, 2};
   } else {
     assert(false && "computeCapability not supported");
   }
   for (int baseVersion : versionsSupported) {
     if (supportMMA(op, baseVersion))
       return baseVersion;
-    if (baseVersion == 3)
-      op.emitRemark() << "Warning: can't use MMA V3 for the dot op";
+    if (baseVersion == 3 || baseVersion == 5)
+      op.emitRemark() << "Warning: can't use MMA V" << baseVersion
+                      << " for the dot op";
   }
   return 0;
 }
 
-SmallVector<unsigned> warpsPerTileV2(DotOp dotOp, const ArrayRef<int64_t> shape,
+SmallVector<unsigned> warpsPerTileV2(Operation *dotOp,
+                                     const ArrayRef<int64_t> shape,
                                      int numWarps) {
   auto rank = shape.size();
   // Early exit for batched matmul
@@ -156,6 +162,28 @@ static Value getSharedMemoryMMAOperand(Value v, mlir::PatternRewriter &rewriter,
   return rewriter.create<LocalAllocOp>(arg.getLoc(), newType, arg);
 }
 
+// Returns true if the A operand of a wgmma should be read from registers
+// rather than from shared memory. This is only worth it when A is computed in
+// the loop by elementwise ops, e.g. a dequantized or scaled operand: the loads
+// it comes from can then go to shared memory and be read into registers in the
+// layout of the wgmma, instead of storing the computed operand to shared
+// memory a second time. Registers A are only supported for 16-bit types and
+// when each warp group holds whole rows of A.
+static bool useRegisterMMAv3OperandA(Value a, NvidiaMmaEncodingAttr mmaEnc) {
+  auto aType = cast<RankedTensorType>(a.getType());
+  if (aType.getElementType().getIntOrFloatBitWidth() != 16 ||
+      mmaEnc.getWarpsPerCTA()[1] != 1)
+    return false;
+  if (auto cvtOp = a.getDefiningOp<ConvertLayoutOp>())
+    a = cvtOp.getSrc();
+  Operation *op = a.getDefiningOp();
+  if (!op || op->getNumResults() != 1 || isa<arith::ConstantOp>(op))
+    return false;
+  return isa<FpToFpOp, BitcastOp>(op) || isPureUnaryInlineAsm(op) ||
+         op->getDialect()->getTypeID() ==
+             mlir::TypeID::get<arith::ArithDialect>();
+}
+
 class BlockedToMMA : public mlir::OpRewritePattern<DotOp> {
   int computeCapability;
   mutable int mmaV1Counter{}; // used to generate ID for MMAv1 encoding
@@ -221,6 +249,65 @@ public:
     }
   }
 
+  // Rewrites the dot to a tcgen05 MMA accumulating in tensor memory. The MMA
+  // is waited on right after being issued and the accumulator goes back to
+  // registers, so that the rest of the pipeline sees a dot in registers.
+  static mlir::LogicalResult rewriteToMMAv5(DotOp dotOp,
+                                            mlir::PatternRewriter &rewriter,
+                                            int numWarps,
+                                            CTALayoutAttr CTALayout) {
+    namespace ttng = triton::nvidia_gpu;
+    MLIRContext *ctx = dotOp.getContext();
+    Location loc = dotOp.getLoc();
+    RankedTensorType oldRetType = dotOp.getType();
+    // Only the 16-bit operands are read transposed, the i8 ones are laid out
+    // K-major.
+    bool allowTranspose =
+        dotOp.getA().getType().getElementTypeBitWidth() == 16;
+    Value a = getSharedMemoryMMAOperand(dotOp.getA(), rewriter, 0,
+                                        allowTranspose);
+    Value b = getSharedMemoryMMAOperand(dotOp.getB(), rewriter, 1,
+                                        allowTranspose);
+
+    auto accLayout = ttng::getTmemCompatibleLayout(ctx, oldRetType.getShape(),
+                                                   numWarps, CTALayout);
+    auto accType = RankedTensorType::get(
+        oldRetType.getShape(), oldRetType.getElementType(), accLayout);
+    auto tmemType = MemDescType::get(
+        oldRetType.getShape(), oldRetType.getElementType(),
+        ttng::TensorMemoryEncodingAttr::get(ctx, oldRetType.getShape()[0],
+                                            oldRetType.getShape()[1]),
+        ttng::TensorMemorySpaceAttr::get(ctx), /*mutableMemory=*/true);
+    Value oldAcc = dotOp.getC();
+    bool zeroAcc = isZeroConst(oldAcc);
+    Value acc;
+    if (!zeroAcc)
+      acc = rewriter.create<ConvertLayoutOp>(loc, accType, oldAcc);
+    Value tmem = rewriter.create<ttng::TMEMAllocOp>(loc, tmemType, acc,
+                                                    /*base=*/Value());
+
+    auto barrierCTALayout = CTALayoutAttr::get(ctx, /*CTAsPerCGA=*/{1},
+                                               /*CTASplitNum=*/{1},
+                                               /*CTAOrder=*/{0});
+    auto barrierEncoding =
+        SharedEncodingAttr::get(ctx, 1, 1, 1, {0}, barrierCTALayout);
+    auto barrierType = MemDescType::get(
+        {1}, rewriter.getI64Type(), barrierEncoding,
+        SharedMemorySpaceAttr::get(ctx), /*mutableMemory=*/true);
+    Value barrier = rewriter.create<LocalAllocOp>(loc, barrierType, Value());
+    rewriter.create<ttng::InitBarrierOp>(loc, barrier, 1);
+
+    Value useD = rewriter.create<arith::ConstantIntOp>(loc, !zeroAcc, 1);
+    Value pred = rewriter.create<arith::ConstantIntOp>(loc, 1, 1);
+    rewriter.create<ttng::TCGen5MMAOp>(loc, a, b, tmem, useD, pred, barrier);
+    Value phase = rewriter.create<arith::ConstantIntOp>(loc, 0, 32);
+    rewriter.create<ttng::WaitBarrierOp>(loc, barrier, phase);
+    rewriter.create<ttng::InvalBarrierOp>(loc, barrier);
+    Value result = rewriter.create<ttng::TMEMLoadOp>(loc, accType, tmem);
+    rewriter.replaceOpWithNewOp<ConvertLayoutOp>(dotOp, oldRetType, result);
+    return success();
+  }
+
   mlir::LogicalResult
   matchAndRewrite(triton::DotOp dotOp,
                   mlir::PatternRewriter &rewriter) const override {
@@ -239,6 +326,8 @@ public:
     auto CTALayout = getCTALayout(oldRetType.getEncoding());
 
     int versionMajor = getMMAVersionSafe(computeCapability, dotOp);
+    if (versionMajor == 5)
+      return rewriteToMMAv5(dotOp, rewriter, numWarps, CTALayout);
     if (!(versionMajor >= 1 && versionMajor <= 3))
       return failure();
 
@@ -303,11 +392,19 @@ public:
       auto eltType = dotOp.getA().getType().getElementType();
       // In MMAV3 tranpose is only supported for f16 and bf16.
       bool allowTranspose = eltType.isF16() || eltType.isBF16();
-      a = getSharedMemoryMMAOperand(a, rewriter, 0, allowTranspose);
+      if (useRegisterMMAv3OperandA(a, mmaEnc)) {
+        auto newAEncoding = DotOperandEncodingAttr::get(
+            oldAType.getContext(), 0, mmaEnc, /*kWidth=*/0);
+        auto newAType = RankedTensorType::get(
+            oldAType.getShape(), oldAType.getElementType(), newAEncoding);
+        a = rewriter.create<ConvertLayoutOp>(a.getLoc(), newAType, a);
+      } else {
+        a = getSharedMemoryMMAOperand(a, rewriter, 0, allowTranspose);
+      }
       b = getSharedMemoryMMAOperand(b, rewriter, 1, allowTranspose);
       newDot = rewriter.create<triton::nvidia_gpu::WarpGroupDotOp>(
           dotOp.getLoc(), newRetType, a, b, newAcc, dotOp.getInputPrecision(),
-          dotOp.getMaxNumImpreciseAcc(), false);
+          dotOp.getMaxNumImpreciseAcc(), false, dotOp.getKExtent());
     } else {
       // convert operands
       int minBitwidth =
@@ -327,16 +424,71 @@ public:
       auto newBType = RankedTensorType::get(
           oldBType.getShape(), oldBType.getElementType(), newBEncoding);
       b = rewriter.create<ConvertLayoutOp>(b.getLoc(), newBType, b);
-      newDot = rewriter.create<DotOp>(dotOp.getLoc(), newRetType, a, b, newAcc,
-                                      dotOp.getInputPrecision(),
-                                      dotOp.getMaxNumImpreciseAcc());
+      newDot = rewriter.create<DotOp>(
+          dotOp.getLoc(), newRetType, a, b, newAcc, dotOp.getInputPrecision(),
+          dotOp.getMaxNumImpreciseAcc(), dotOp.getKExtent());
     }
+    // Keep the stage the dot is pinned to in pipelined loops.
+    if (Attribute stage = dotOp->getAttr(kPipelineStageAttrName))
+      newDot->setAttr(kPipelineStageAttrName, stage);
     // convert dot instruction
     rewriter.replaceOpWithNewOp<ConvertLayoutOp>(dotOp, oldRetType,
                                                  newDot->getResult(0));
     return success();
   }
 };
+
+// Sparse dots always use the mma.sp of MMAv2, wgmma.sp is not supported.
+class SparseBlockedToMMA : public mlir::OpRewritePattern<SparseDotOp> {
+  int computeCapability;
+
+public:
+  SparseBlockedToMMA(mlir::MLIRContext *context, int computeCapability)
+      : OpRewritePattern<SparseDotOp>(context),
+        computeCapability(computeCapability) {}
+
+  mlir::LogicalResult
+  matchAndRewrite(SparseDotOp dotOp,
+                  mlir::PatternRewriter &rewriter) const override {
+    RankedTensorType oldRetType = dotOp.getType();
+    if (!oldRetType.getEncoding() ||
+        mlir::isa<NvidiaMmaEncodingAttr>(oldRetType.getEncoding()))
+      return failure();
+    if (computeCapability < 80)
+      return failure();
+
+    auto mod = dotOp->getParentOfType<mlir::ModuleOp>();
+    int numWarps = TritonGPUDialect::getNumWarps(mod);
+    auto CTALayout = getCTALayout(oldRetType.getEncoding());
+    auto retShapePerCTA = getShapePerCTA(oldRetType);
+    auto mmaEnc = NvidiaMmaEncodingAttr::get(
+        oldRetType.getContext(), /*versionMajor=*/2, /*versionMinor=*/0,
+        warpsPerTileV2(dotOp, retShapePerCTA, numWarps), CTALayout,
+        /*instrShape=*/{16, 8});
+    auto newRetType = RankedTensorType::get(
+        oldRetType.getShape(), oldRetType.getElementType(), mmaEnc);
+    auto convert = [&](Value v, Attribute encoding) -> Value {
+      auto type = cast<RankedTensorType>(v.getType());
+      auto newType = RankedTensorType::get(type.getShape(),
+                                           type.getElementType(), encoding);
+      return rewriter.create<ConvertLayoutOp>(v.getLoc(), newType, v);
+    };
+    MLIRContext *ctx = dotOp.getContext();
+    Type eltType = dotOp.getA().getType().getElementType();
+    Value a = convert(dotOp.getA(),
+                      DotOperandEncodingAttr::get(ctx, 0, mmaEnc, eltType));
+    Value b = convert(dotOp.getB(),
+                      DotOperandEncodingAttr::get(ctx, 1, mmaEnc, eltType));
+    Value c = convert(dotOp.getC(), mmaEnc);
+    Value meta = convert(dotOp.getAMeta(),
+                         SparseDotMetaEncodingAttr::get(ctx, mmaEnc));
+    auto newDot = rewriter.create<SparseDotOp>(dotOp.getLoc(), newRetType, a,
+                                               b, c, meta);
+    rewriter.replaceOpWithNewOp<ConvertLayoutOp>(dotOp, oldRetType,
+                                                 newDot.getResult());
+    return success();
+  }
+};
 } // namespace
 
 static Value promoteOperand(OpBuilder &builder, Location loc, Value operand,
@@ -396,8 +548,17 @@ public:
 
     auto computeCapability = getNVIDIAComputeCapability(m);
 
+    if (computeCapability < 80) {
+      WalkResult result = m.walk([](SparseDotOp dotOp) {
+        dotOp.emitError("sparse dots require compute capability 80 or higher");
+        return WalkResult::interrupt();
+      });
+      if (result.wasInterrupted())
+        return signalPassFailure();
+    }
+
     mlir::RewritePatternSet patterns(context);
-    patterns.add<BlockedToMMA>(context, computeCapability);
+    patterns.add<BlockedToMMA, SparseBlockedToMMA>(context, computeCapability);
     if (applyPatternsAndFoldGreedily(m, std::move(patterns)).failed()) {
       signalPassFailure();
     }
@@ -85,6 +85,26 @@ struct CoalescePass : public impl::TritonGPUCoalesceBase<CoalescePass> {
     perThread = std::min<int>(perThread, std::max(numElems / numThreads, 1));
     LDBG("perThread: " << perThread);
 
+    // A load feeding the stores of the same elements in its slice gets the
+    // layout the stores can have, so that its result doesn't go through a
+    // layout conversion, which costs more than the narrower loads. This also
+    // keeps the rows narrower than a cache line of 2D tiles, e.g. [N, 8] f16,
+    // in the same lanes from their load to their store.
+    unsigned elemNumBits = getElementBitWidth(refTensorType);
+    if (isa<triton::LoadOp>(op)) {
+      for (Operation *opSameOrder : memAccessesSameOrder) {
+        auto storeTy = cast<RankedTensorType>(
+            getMemAccessPtr(opSameOrder).getType());
+        if (isa<triton::LoadOp>(opSameOrder) ||
+            getElementBitWidth(storeTy) != elemNumBits)
+          continue;
+        unsigned storePerThread =
+            getNumElementsPerThread(opSameOrder, order, axisInfoAnalysis);
+        LDBG("perThread for store: " << storePerThread);
+        perThread = std::min(perThread, storePerThread);
+      }
+    }
+
     if (!dyn_cast<triton::LoadOp>(op)) {
       // For ops that can result in a global memory write, we should enforce
       // that each thread handles at most 128 bits, which is the widest
@@ -92,7 +112,6 @@ struct CoalescePass : public impl::TritonGPUCoalesceBase<CoalescePass> {
       // in the memory write at the warp level, resulting in worse performance.
       // For loads, we can expect that the gaps won't matter due to the L1
       // cache.
-      unsigned elemNumBits = getElementBitWidth(refTensorType);
       perThread = std::min<int>(
           perThread, getNumElementsPerThread(op, order, axisInfoAnalysis));
     }
@@ -1,9 +1,12 @@
 #include "mlir/IR/Dominance.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/Matchers.h"
 #include "mlir/Transforms/Passes.h"
 #include "triton/Analysis/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
 #include "triton/Dialect/TritonGPU/Transforms/Utility.h"
+#include "triton/Tools/Sys/GetEnv.hpp"
 
 #include <memory>
 
@@ -31,13 +34,486 @@ static bool canMergeIntoIf(arith::SelectOp selectOp, scf::IfOp ifOp,
   return true;
 }
 
+namespace {
+
+// The elements of an integer tensor as the sum of the scalars `bases`, the
+// same for all the elements, and of an offset within [minOffset, maxOffset].
+struct TileBounds {
+  SmallVector<Value> bases;
+  int64_t minOffset = 0;
+  int64_t maxOffset = 0;
+};
+
+// The comparison `sum(lhs) + offset <predicate> sum(rhs)` of scalars, or the
+// scalar i1 `flag`, negated or not, when it is set.
+struct ScalarCondition {
+  Value flag;
+  bool negated = false;
+  SmallVector<Value> lhs, rhs;
+  int64_t offset = 0;
+  arith::CmpIPredicate predicate = arith::CmpIPredicate::slt;
+  Type type;
+};
+
+// The elements of a mask are all true when all the conditions of `allTrue`
+// hold, and all false when any of `allFalse` holds.
+struct UniformMask {
+  SmallVector<ScalarCondition> allTrue, allFalse;
+};
+
+void addScalar(Value scalar, TileBounds &bounds) {
+  APInt value;
+  if (matchPattern(scalar, m_ConstantInt(&value))) {
+    bounds.minOffset += value.getSExtValue();
+    bounds.maxOffset += value.getSExtValue();
+  } else if (auto addOp = scalar.getDefiningOp<arith::AddIOp>()) {
+    addScalar(addOp.getLhs(), bounds);
+    addScalar(addOp.getRhs(), bounds);
+  } else {
+    bounds.bases.push_back(scalar);
+  }
+}
+
+std::optional<TileBounds> getTileBounds(Value value) {
+  Operation *def = value.getDefiningOp();
+  if (!def)
+    return std::nullopt;
+  TileBounds bounds;
+  if (auto splatOp = dyn_cast<triton::SplatOp>(def)) {
+    addScalar(splatOp.getSrc(), bounds);
+    return bounds;
+  }
+  if (auto rangeOp = dyn_cast<triton::MakeRangeOp>(def)) {
+    bounds.minOffset = rangeOp.getStart();
+    bounds.maxOffset = rangeOp.getEnd() - 1;
+    return bounds;
+  }
+  DenseIntElementsAttr attr;
+  if (matchPattern(value, m_Constant(&attr))) {
+    bounds.minOffset = std::numeric_limits<int64_t>::max();
+    bounds.maxOffset = std::numeric_limits<int64_t>::min();
+    for (const APInt &element : attr.getValues<APInt>()) {
+      bounds.minOffset = std::min(bounds.minOffset, element.getSExtValue());
+      bounds.maxOffset = std::max(bounds.maxOffset, element.getSExtValue());
+    }
+    return bounds;
+  }
+  if (isa<triton::ExpandDimsOp, triton::BroadcastOp, ConvertLayoutOp,
+          arith::ExtSIOp>(def))
+    return getTileBounds(def->getOperand(0));
+  if (!isa<arith::AddIOp, arith::SubIOp, arith::MulIOp>(def))
+    return std::nullopt;
+  auto lhs = getTileBounds(def->getOperand(0));
+  auto rhs = getTileBounds(def->getOperand(1));
+  if (!lhs || !rhs)
+    return std::nullopt;
+  if (isa<arith::AddIOp>(def)) {
+    bounds.bases = lhs->bases;
+    bounds.bases.append(rhs->bases);
+    bounds.minOffset = lhs->minOffset + rhs->minOffset;
+    bounds.maxOffset = lhs->maxOffset + rhs->maxOffset;
+    return bounds;
+  }
+  if (isa<arith::SubIOp>(def)) {
+    if (!rhs->bases.empty())
+      return std::nullopt;
+    bounds.bases = lhs->bases;
+    bounds.minOffset = lhs->minOffset - rhs->maxOffset;
+    bounds.maxOffset = lhs->maxOffset - rhs->minOffset;
+    return bounds;
+  }
+  // The products of offsets, by a non-negative one.
+  if (!lhs->bases.empty() || !rhs->bases.empty())
+    return std::nullopt;
+  if (lhs->minOffset < 0)
+    std::swap(lhs, rhs);
+  if (lhs->minOffset < 0 || rhs->minOffset < 0)
+    return std::nullopt;
+  bounds.minOffset = lhs->minOffset * rhs->minOffset;
+  bounds.maxOffset = lhs->maxOffset * rhs->maxOffset;
+  return bounds;
+}
+
+std::optional<UniformMask> getUniformMask(Value mask) {
+  Operation *def = mask.getDefiningOp();
+  if (!def)
+    return std::nullopt;
+  if (auto splatOp = dyn_cast<triton::SplatOp>(def)) {
+    ScalarCondition condition;
+    condition.flag = splatOp.getSrc();
+    UniformMask uniform;
+    uniform.allTrue.push_back(condition);
+    condition.negated = true;
+    uniform.allFalse.push_back(condition);
+    return uniform;
+  }
+  if (isa<triton::ExpandDimsOp, triton::BroadcastOp, ConvertLayoutOp>(def))
+    return getUniformMask(def->getOperand(0));
+  if (auto andOp = dyn_cast<arith::AndIOp>(def)) {
+    auto lhs = getUniformMask(andOp.getLhs());
+    auto rhs = getUniformMask(andOp.getRhs());
+    if (!lhs || !rhs)
+      return std::nullopt;
+    lhs->allTrue.append(rhs->allTrue);
+    lhs->allFalse.append(rhs->allFalse);
+    return lhs;
+  }
+  auto cmpOp = dyn_cast<arith::CmpIOp>(def);
+  if (!cmpOp)
+    return std::nullopt;
+  Value lhsValue = cmpOp.getLhs(), rhsValue = cmpOp.getRhs();
+  arith::CmpIPredicate predicate = cmpOp.getPredicate();
+  switch (predicate) {
+  case arith::CmpIPredicate::sgt:
+  case arith::CmpIPredicate::sge:
+    std::swap(lhsValue, rhsValue);
+    predicate = predicate == arith::CmpIPredicate::sgt
+                    ? arith::CmpIPredicate::slt
+                    : arith::CmpIPredicate::sle;
+    break;
+  case arith::CmpIPredicate::slt:
+  case arith::CmpIPredicate::sle:
+    break;
+  default:
+    return std::nullopt;
+  }
+  auto lhs = getTileBounds(lhsValue);
+  auto rhs = getTileBounds(rhsValue);
+  if (!lhs || !rhs)
+    return std::nullopt;
+  bool strict = predicate == arith::CmpIPredicate::slt;
+  // All the elements of `lhs < rhs` are true when the largest of lhs is less
+  // than the smallest of rhs, and false when the smallest of lhs is at least
+  // the largest of rhs.
+  ScalarCondition allTrue, allFalse;
+  allTrue.lhs = allFalse.lhs = lhs->bases;
+  allTrue.rhs = allFalse.rhs = rhs->bases;
+  allTrue.type = allFalse.type = getElementTypeOrSelf(lhsValue.getType());
+  allTrue.offset = lhs->maxOffset - rhs->minOffset;
+  allTrue.predicate = predicate;
+  allFalse.offset = lhs->minOffset - rhs->maxOffset;
+  allFalse.predicate =
+      strict ? arith::CmpIPredicate::sge : arith::CmpIPredicate::sgt;
+  UniformMask uniform;
+  uniform.allTrue.push_back(allTrue);
+  uniform.allFalse.push_back(allFalse);
+  return uniform;
+}
+
+// Returns `sum(plus) - sum(minus) + offset` in `type`.
+Value buildSum(OpBuilder &b, Location loc, ArrayRef<Value> plus,
+               ArrayRef<Value> minus, int64_t offset, Type type) {
+  auto cast = [&](Value value) -> Value {
+    if (value.getType() == type)
+      return value;
+    if (type.isIndex() || value.getType().isIndex())
+      return b.create<arith::IndexCastOp>(loc, type, value);
+    return b.create<arith::ExtSIOp>(loc, type, value);
+  };
+  Value sum;
+  auto add = [&](Value value) {
+    sum = sum ? b.create<arith::AddIOp>(loc, sum, value).getResult() : value;
+  };
+  for (Value value : plus)
+    add(cast(value));
+  if (!sum || offset != 0)
+    add(b.create<arith::ConstantOp>(loc, b.getIntegerAttr(type, offset)));
+  for (Value value : minus)
+    sum = b.create<arith::SubIOp>(loc, sum, cast(value));
+  return sum;
+}
+
+Value buildCondition(OpBuilder &b, Location loc,
+                     const ScalarCondition &condition) {
+  if (condition.flag) {
+    if (!condition.negated)
+      return condition.flag;
+    Value trueVal = b.create<arith::ConstantIntOp>(loc, 1, 1);
+    return b.create<arith::XOrIOp>(loc, condition.flag, trueVal);
+  }
+  Value lhs =
+      buildSum(b, loc, condition.lhs, {}, condition.offset, condition.type);
+  Value rhs = buildSum(b, loc, condition.rhs, {}, 0, condition.type);
+  return b.create<arith::CmpIOp>(loc, condition.predicate, lhs, rhs);
+}
+
+// Returns whether all the elements of the mask are true, and whether they are
+// all false.
+std::pair<Value, Value> buildConditions(OpBuilder &b, Location loc,
+                                        const UniformMask &mask) {
+  Value allTrue, allFalse;
+  for (const ScalarCondition &condition : mask.allTrue) {
+    Value value = buildCondition(b, loc, condition);
+    allTrue = allTrue ? b.create<arith::AndIOp>(loc, allTrue, value).getResult()
+                      : value;
+  }
+  for (const ScalarCondition &condition : mask.allFalse) {
+    Value value = buildCondition(b, loc, condition);
+    allFalse = allFalse
+                   ? b.create<arith::OrIOp>(loc, allFalse, value).getResult()
+                   : value;
+  }
+  return {allTrue, allFalse};
+}
+
+Value getMask(Operation *op) {
+  if (auto loadOp = dyn_cast<triton::LoadOp>(op))
+    return loadOp.getMask();
+  if (auto storeOp = dyn_cast<triton::StoreOp>(op))
+    return storeOp.getMask();
+  if (auto selectOp = dyn_cast<arith::SelectOp>(op))
+    if (isa<RankedTensorType>(selectOp.getCondition().getType()))
+      return selectOp.getCondition();
+  return {};
+}
+
+// Returns the value a masked load yields when its mask is all false: its
+// `other` or zeros, which are as good as the undefined values without it.
+Value getMaskedOutValue(OpBuilder &b, triton::LoadOp loadOp) {
+  if (loadOp.getOther())
+    return loadOp.getOther();
+  auto type = cast<RankedTensorType>(loadOp.getType());
+  if (!type.getElementType().isIntOrFloat())
+    return {};
+  return b.create<arith::ConstantOp>(loadOp.getLoc(), b.getZeroAttr(type));
+}
+
+// Replaces the load, store or select `op` by its variant for a mask whose
+// elements are all true or all false.
+void foldUniformMask(Operation *op, bool allTrue) {
+  OpBuilder b(op);
+  if (auto loadOp = dyn_cast<triton::LoadOp>(op)) {
+    Value result;
+    if (allTrue)
+      result = b.create<triton::LoadOp>(
+          loadOp.getLoc(), loadOp.getPtr(), loadOp.getCache(),
+          loadOp.getEvict(), loadOp.getIsVolatile());
+    else
+      result = getMaskedOutValue(b, loadOp);
+    if (!result)
+      return;
+    loadOp.replaceAllUsesWith(result);
+    loadOp.erase();
+  } else if (auto storeOp = dyn_cast<triton::StoreOp>(op)) {
+    if (allTrue)
+      b.create<triton::StoreOp>(storeOp.getLoc(), storeOp.getPtr(),
+                                storeOp.getValue(), storeOp.getCache(),
+                                storeOp.getEvict());
+    storeOp.erase();
+  } else if (auto selectOp = dyn_cast<arith::SelectOp>(op)) {
+    selectOp.replaceAllUsesWith(allTrue ? selectOp.getTrueValue()
+                                        : selectOp.getFalseValue());
+    selectOp.erase();
+  }
+}
+
+// Versions a masked load or store into an unmasked variant, when all the
+// elements of its mask are true, a skipped one, when they are all false, and
+// the masked one otherwise.
+void versionMaskedOp(Operation *op, const UniformMask &mask) {
+  OpBuilder b(op);
+  Location loc = op->getLoc();
+  auto loadOp = dyn_cast<triton::LoadOp>(op);
+  if (loadOp && !loadOp.getOther() &&
+      !getElementTypeOrSelf(loadOp.getType()).isIntOrFloat())
+    return;
+  auto [allTrue, allFalse] = buildConditions(b, loc, mask);
+  auto fullIf =
+      b.create<scf::IfOp>(loc, op->getResultTypes(), allTrue, /*hasElse=*/true);
+  b.setInsertionPointToStart(fullIf.elseBlock());
+  auto emptyIf = b.create<scf::IfOp>(loc, op->getResultTypes(), allFalse,
+                                     /*hasElse=*/true);
+  if (loadOp) {
+    b.setInsertionPointToStart(fullIf.thenBlock());
+    auto fullLoad = b.create<triton::LoadOp>(loc, loadOp.getPtr(),
+                                             loadOp.getCache(),
+                                             loadOp.getEvict(),
+                                             loadOp.getIsVolatile());
+    b.create<scf::YieldOp>(loc, fullLoad.getResult());
+    b.setInsertionPointToStart(emptyIf.thenBlock());
+    b.create<scf::YieldOp>(loc, getMaskedOutValue(b, loadOp));
+    b.setInsertionPointToStart(emptyIf.elseBlock());
+    Operation *maskedLoad = b.clone(*loadOp);
+    b.create<scf::YieldOp>(loc, maskedLoad->getResults());
+    b.setInsertionPointAfter(emptyIf);
+    b.create<scf::YieldOp>(loc, emptyIf.getResults());
+    loadOp.replaceAllUsesWith(fullIf.getResult(0));
+    loadOp.erase();
+    return;
+  }
+  auto storeOp = cast<triton::StoreOp>(op);
+  b.setInsertionPoint(fullIf.thenBlock()->getTerminator());
+  b.create<triton::StoreOp>(loc, storeOp.getPtr(), storeOp.getValue(),
+                            storeOp.getCache(), storeOp.getEvict());
+  storeOp->moveBefore(emptyIf.elseBlock()->getTerminator());
+}
+
+// The iterations of a loop below, or from, the threshold `sum(plus) -
+// sum(minus) + offset`, for which a condition holds.
+struct SplitPoint {
+  SmallVector<Value> plus, minus;
+  int64_t offset = 0;
+  bool holdsBelow = false;
+};
+
+// Returns the threshold of the induction variable of `forOp` at which the
+// comparison `condition` changes, when the other scalars of the comparison
+// are invariant in the loop.
+std::optional<SplitPoint> getSplitPoint(const ScalarCondition &condition,
+                                        scf::ForOp forOp) {
+  if (condition.flag)
+    return std::nullopt;
+  // As `sum(lhs) + offset < sum(rhs)`.
+  SmallVector<Value> lhs = condition.lhs, rhs = condition.rhs;
+  int64_t offset = condition.offset;
+  switch (condition.predicate) {
+  case arith::CmpIPredicate::slt:
+    break;
+  case arith::CmpIPredicate::sle:
+    offset -= 1;
+    break;
+  case arith::CmpIPredicate::sgt:
+    std::swap(lhs, rhs);
+    offset = -offset;
+    break;
+  case arith::CmpIPredicate::sge:
+    std::swap(lhs, rhs);
+    offset = -offset - 1;
+    break;
+  default:
+    return std::nullopt;
+  }
+  Value iv = forOp.getInductionVar();
+  if (iv.getType() != condition.type ||
+      llvm::count(lhs, iv) + llvm::count(rhs, iv) != 1)
+    return std::nullopt;
+  for (Value value : llvm::concat<Value>(lhs, rhs))
+    if (value != iv && !forOp.isDefinedOutsideOfLoop(value))
+      return std::nullopt;
+
+  SplitPoint point;
+  if (llvm::is_contained(lhs, iv)) {
+    // iv < sum(rhs) - sum(lhs without iv) - offset
+    lhs.erase(llvm::find(lhs, iv));
+    point.plus = rhs;
+    point.minus = lhs;
+    point.offset = -offset;
+    point.holdsBelow = true;
+  } else {
+    // iv >= sum(lhs) - sum(rhs without iv) + offset + 1
+    rhs.erase(llvm::find(rhs, iv));
+    point.plus = lhs;
+    point.minus = rhs;
+    point.offset = offset + 1;
+  }
+  return point;
+}
+
+// Splits the iterations of `forOp` into a range where a mask used by its
+// loads, stores and selects is all true, a range where it is partial and a
+// range where it is all false, in the order of the iterations, and uses the
+// unmasked and skipped variants of the ops in the first and last ranges.
+void versionLoop(scf::ForOp forOp) {
+  APInt step;
+  if (!matchPattern(forOp.getStep(), m_ConstantInt(&step)) ||
+      !step.isStrictlyPositive())
+    return;
+  Value mask;
+  std::optional<SplitPoint> truePoint, falsePoint;
+  forOp.getBody()->walk([&](Operation *op) {
+    Value opMask = getMask(op);
+    if (mask || !opMask || op->getParentOfType<scf::ForOp>() != forOp)
+      return;
+    auto uniform = getUniformMask(opMask);
+    if (!uniform || uniform->allTrue.size() != 1 ||
+        uniform->allFalse.size() != 1)
+      return;
+    truePoint = getSplitPoint(uniform->allTrue[0], forOp);
+    falsePoint = getSplitPoint(uniform->allFalse[0], forOp);
+    if (truePoint && falsePoint &&
+        truePoint->holdsBelow != falsePoint->holdsBelow)
+      mask = opMask;
+  });
+  if (!mask)
+    return;
+
+  // The first iteration of the loop at or after each threshold.
+  OpBuilder b(forOp);
+  Location loc = forOp.getLoc();
+  Type type = forOp.getInductionVar().getType();
+  Value lb = forOp.getLowerBound(), ub = forOp.getUpperBound();
+  Value zero = b.create<arith::ConstantOp>(loc, b.getIntegerAttr(type, 0));
+  auto getIteration = [&](const SplitPoint &point, Value from) -> Value {
+    Value threshold =
+        buildSum(b, loc, point.plus, point.minus, point.offset, type);
+    Value distance = b.create<arith::SubIOp>(loc, threshold, lb);
+    distance = b.create<arith::MaxSIOp>(loc, distance, zero);
+    Value steps =
+        b.create<arith::CeilDivSIOp>(loc, distance, forOp.getStep());
+    Value iteration = b.create<arith::AddIOp>(
+        loc, lb, b.create<arith::MulIOp>(loc, steps, forOp.getStep()));
+    iteration = b.create<arith::MaxSIOp>(loc, iteration, from);
+    return b.create<arith::MinSIOp>(loc, iteration, ub);
+  };
+  bool fullFirst = truePoint->holdsBelow;
+  Value firstEnd = getIteration(fullFirst ? *truePoint : *falsePoint, lb);
+  Value partialEnd =
+      getIteration(fullFirst ? *falsePoint : *truePoint, firstEnd);
+
+  auto foldMaskUsers = [](Value loopMask, bool allTrue) {
+    for (Operation *user : llvm::make_early_inc_range(loopMask.getUsers()))
+      if (getMask(user) == loopMask)
+        foldUniformMask(user, allTrue);
+  };
+  IRMapping firstMapping;
+  auto firstLoop = cast<scf::ForOp>(b.clone(*forOp, firstMapping));
+  firstLoop.getUpperBoundMutable().assign(firstEnd);
+  foldMaskUsers(firstMapping.lookup(mask), /*allTrue=*/fullFirst);
+  auto partialLoop = cast<scf::ForOp>(b.clone(*forOp));
+  partialLoop.getLowerBoundMutable().assign(firstEnd);
+  partialLoop.getUpperBoundMutable().assign(partialEnd);
+  partialLoop.getInitsMutable().assign(firstLoop.getResults());
+  forOp.getLowerBoundMutable().assign(partialEnd);
+  forOp.getInitsMutable().assign(partialLoop.getResults());
+  foldMaskUsers(mask, /*allTrue=*/!fullFirst);
+}
+
+// Versions the loops with loads, stores and selects whose masks are uniform
+// in ranges of their iterations, innermost first, and the masked loads and
+// stores outside of loops.
+void versionUniformMasks(ModuleOp m) {
+  SmallVector<scf::ForOp> loops;
+  m.walk([&](scf::ForOp forOp) { loops.push_back(forOp); });
+  for (scf::ForOp forOp : loops)
+    versionLoop(forOp);
+
+  // The ops of loops stay unversioned, for the loops to be pipelined.
+  SmallVector<std::pair<Operation *, UniformMask>> ops;
+  m.walk([&](Operation *op) {
+    if (!isa<triton::LoadOp, triton::StoreOp>(op) || !getMask(op) ||
+        op->getParentOfType<LoopLikeOpInterface>())
+      return;
+    if (auto uniform = getUniformMask(getMask(op)))
+      ops.push_back({op, *uniform});
+  });
+  for (auto &[op, uniform] : ops)
+    versionMaskedOp(op, uniform);
+}
+
+} // namespace
+
 class CombineTensorSelectAndIfPass
     : public impl::TritonGPUCombineTensorSelectAndIfBase<
           CombineTensorSelectAndIfPass> {
 public:
+  using impl::TritonGPUCombineTensorSelectAndIfBase<
+      CombineTensorSelectAndIfPass>::TritonGPUCombineTensorSelectAndIfBase;
+
   void runOnOperation() override {
     MLIRContext *context = &getContext();
     ModuleOp m = getOperation();
+    if (versionMasks || tools::getBoolEnv("TRITON_VERSION_UNIFORM_MASKS"))
+      versionUniformMasks(m);
     DominanceInfo dom(m);
 
     // Go over the arith.select ops, look if there is an if
@@ -51,7 +51,8 @@ public:
     auto dot = [&](Value a, Value b, Value c) -> Value {
       return rewriter.create<DotOp>(dotOp->getLoc(), c.getType(), a, b, c,
                                     InputPrecision::TF32,
-                                    dotOp.getMaxNumImpreciseAcc());
+                                    dotOp.getMaxNumImpreciseAcc(),
+                                    dotOp.getKExtent());
     };
 
     auto aBig = f32ToTF32(dotOp.getA());
@@ -69,6 +70,74 @@ public:
   }
 };
 
+// Emulate the f32 dot with bf16 dots, for GPUs whose tensor cores are faster,
+// or only, at bf16. Each operand is split into a sum of bf16 terms, each term
+// rounding what is left of the f32 value after the terms before it:
+//  let aHi = bf16(a), aMid = bf16(a - aHi), aLo = bf16(a - aHi - aMid)
+// and the products of the terms whose magnitude is above the f32 rounding
+// error are summed, smallest first:
+// dot(a, b, inputPrecision="bf16x3") ->
+//  dot(aMid, bHi) + dot(aHi, bMid) + dot(aHi, bHi)
+// dot(a, b, inputPrecision="bf16x6") ->
+//  dot(aLo, bHi) + dot(aMid, bMid) + dot(aHi, bLo) +
+//  dot(aMid, bHi) + dot(aHi, bMid) + dot(aHi, bHi)
+// bf16x3 keeps about 16 bits of the mantissas of the products, bf16x6 about
+// as many as a f32 dot.
+class BF16xN : public OpRewritePattern<DotOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(DotOp dotOp,
+                                PatternRewriter &rewriter) const override {
+    auto isF32 = [](Value operand) {
+      return cast<RankedTensorType>(operand.getType()).getElementType().isF32();
+    };
+
+    InputPrecision precision = dotOp.getInputPrecision();
+    if (!((precision == InputPrecision::BF16x3 ||
+           precision == InputPrecision::BF16x6) &&
+          isF32(dotOp.getA()) && isF32(dotOp.getB()))) {
+      return failure();
+    }
+    unsigned numTerms = precision == InputPrecision::BF16x3 ? 2 : 3;
+
+    Location loc = dotOp.getLoc();
+    // Returns the bf16 terms of `value`, largest first.
+    auto split = [&](Value value) {
+      auto type = cast<RankedTensorType>(value.getType());
+      auto bf16Type = type.clone(rewriter.getBF16Type());
+      SmallVector<Value> terms;
+      Value rem = value;
+      for (unsigned i = 0; i < numTerms; ++i) {
+        Value term = rewriter.create<arith::TruncFOp>(loc, bf16Type, rem);
+        terms.push_back(term);
+        if (i + 1 < numTerms)
+          rem = rewriter.create<arith::SubFOp>(
+              loc, rem, rewriter.create<arith::ExtFOp>(loc, type, term));
+      }
+      return terms;
+    };
+    auto dot = [&](Value a, Value b, Value c) -> Value {
+      return rewriter.create<DotOp>(loc, c.getType(), a, b, c,
+                                    InputPrecision::IEEE,
+                                    dotOp.getMaxNumImpreciseAcc(),
+                                    dotOp.getKExtent());
+    };
+
+    SmallVector<Value> a = split(dotOp.getA());
+    SmallVector<Value> b = split(dotOp.getB());
+    // The pairs of terms (i, j) whose products are summed: those of
+    // i + j < numTerms, from the smallest to the largest.
+    Value acc = dotOp.getC();
+    for (int sum = numTerms - 1; sum >= 0; --sum)
+      for (int i = sum; i >= 0; --i)
+        acc = dot(a[i], b[sum - i], acc);
+
+    rewriter.replaceOp(dotOp, acc);
+    return success();
+  }
+};
+
 } // anonymous namespace
 
 struct F32DotTCPass : public impl::TritonGPUF32DotTCBase<F32DotTCPass> {
@@ -77,7 +146,7 @@ struct F32DotTCPass : public impl::TritonGPUF32DotTCBase<F32DotTCPass> {
     ModuleOp m = getOperation();
 
     RewritePatternSet decomposePatterns(context);
-    decomposePatterns.add<TF32x3>(context);
+    decomposePatterns.add<TF32x3, BF16xN>(context);
     if (applyPatternsAndFoldGreedily(m, std::move(decomposePatterns))
             .failed()) {
       signalPassFailure();
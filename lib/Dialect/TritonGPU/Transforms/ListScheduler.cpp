@@ -0,0 +1,269 @@
+#include "triton/Dialect/TritonGPU/Transforms/ListScheduler.h"
+
+#include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Interfaces/FunctionInterfaces.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "triton/Conversion/TritonToTritonGPU/TritonToTritonGPUPass.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonNvidiaGPU/IR/Dialect.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Support/Debug.h"
+
+#define DEBUG_TYPE "tritongpu-list-scheduler"
+#define DBGS() (llvm::dbgs() << "[" DEBUG_TYPE "]: ")
+#define LDBG(X) LLVM_DEBUG(DBGS() << X << "\n")
+
+namespace mlir::triton::gpu {
+
+SchedulingModel SchedulingModel::get(ModuleOp module) {
+  int numWarps = TritonGPUDialect::getNumWarps(module);
+  int threadsPerWarp = TritonGPUDialect::getThreadsPerWarp(module);
+  auto target = module->getAttrOfType<StringAttr>(AttrTargetName);
+  if (target && target.strref().starts_with("hip:")) {
+    // 512 VGPRs per lane of a SIMD, which runs the waves of a workgroup of
+    // up to 4 warps.
+    int maxRegisters = std::clamp(512 * 4 / std::max(numWarps, 1), 64, 512);
+    return {/*globalLoadLatency=*/500, /*sharedLoadLatency=*/64,
+            /*mmaLatency=*/32, /*sfuLatency=*/16, maxRegisters};
+  }
+  // 64K registers per SM for the threads of a CTA, by up to 255 per thread.
+  int maxRegisters =
+      std::min(255, 64 * 1024 / std::max(numWarps * threadsPerWarp, 1));
+  return {/*globalLoadLatency=*/400, /*sharedLoadLatency=*/30,
+          /*mmaLatency=*/32, /*sfuLatency=*/16, maxRegisters};
+}
+
+int SchedulingModel::getLatency(Operation *op) const {
+  if (isa<triton::LoadOp, triton::ExperimentalDescriptorLoadOp,
+          triton::AtomicRMWOp, triton::AtomicCASOp>(op))
+    return globalLoadLatency;
+  if (isa<LocalLoadOp, ConvertLayoutOp>(op))
+    return sharedLoadLatency;
+  if (isa<triton::DotOp, nvidia_gpu::WarpGroupDotOp>(op))
+    return mmaLatency;
+  if (isa<math::ExpOp, math::Exp2Op, math::LogOp, math::Log2Op, math::SinOp,
+          math::CosOp, math::SqrtOp, math::RsqrtOp, arith::DivFOp>(op))
+    return sfuLatency;
+  return 1;
+}
+
+namespace {
+
+enum class Effect { None, Read, Write };
+
+// Returns whether `op` reads memory and has no other effects, or has effects
+// the scheduler can't reorder.
+Effect getEffect(Operation *op) {
+  if (isMemoryEffectFree(op))
+    return Effect::None;
+  auto iface = dyn_cast<MemoryEffectOpInterface>(op);
+  if (!iface || op->getNumRegions() != 0)
+    return Effect::Write;
+  SmallVector<MemoryEffects::EffectInstance> effects;
+  iface.getEffects(effects);
+  bool onlyReads = llvm::all_of(effects, [](auto &effect) {
+    return isa<MemoryEffects::Read>(effect.getEffect());
+  });
+  return onlyReads ? Effect::Read : Effect::Write;
+}
+
+// The 32-bit registers of a thread holding `value`.
+int getRegisters(Value value) {
+  auto tensorTy = dyn_cast<RankedTensorType>(value.getType());
+  if (!tensorTy)
+    return isa<MemDescType>(value.getType()) ? 0 : 1;
+  if (!isa_and_nonnull<DistributedEncodingTrait>(tensorTy.getEncoding()))
+    return 0;
+  Type elemTy = tensorTy.getElementType();
+  int bits = isa<PointerType>(elemTy) ? 64 : elemTy.getIntOrFloatBitWidth();
+  return (getTotalElemsPerThread(tensorTy) * bits + 31) / 32;
+}
+
+void scheduleBlock(Block &block, const SchedulingModel &model) {
+  SmallVector<Operation *> ops;
+  for (Operation &op : block.without_terminator())
+    ops.push_back(&op);
+  if (ops.size() < 3)
+    return;
+  int numOps = ops.size();
+  DenseMap<Operation *, int> index;
+  for (auto [i, op] : llvm::enumerate(ops))
+    index[op] = i;
+
+  // The dependencies between the ops: on the ops defining their operands,
+  // including those of the ops of their regions, and between the ops with
+  // memory effects.
+  SmallVector<llvm::SmallSetVector<int, 4>> succs(numOps);
+  SmallVector<int> numPreds(numOps);
+  auto addDep = [&](int from, int to) {
+    if (succs[from].insert(to))
+      ++numPreds[to];
+  };
+  // The ops of the block using each value defined in the block, and the
+  // values whose registers are live throughout, as they are defined outside
+  // of the block or used by ops that aren't scheduled.
+  DenseMap<Value, llvm::SmallSetVector<int, 4>> users;
+  llvm::SetVector<Value> liveThrough;
+  for (BlockArgument arg : block.getArguments())
+    liveThrough.insert(arg);
+  std::optional<int> lastWrite;
+  SmallVector<int> readsSinceWrite;
+  for (int i = 0; i < numOps; ++i) {
+    Operation *op = ops[i];
+    op->walk([&](Operation *nested) {
+      for (Value operand : nested->getOperands()) {
+        Operation *def = operand.getDefiningOp();
+        if (def && def->getBlock() == &block) {
+          addDep(index[def], i);
+          users[operand].insert(i);
+        } else if (operand.getParentBlock() != &block &&
+                   !op->isAncestor(operand.getParentBlock()->getParentOp())) {
+          liveThrough.insert(operand);
+        }
+      }
+    });
+    switch (getEffect(op)) {
+    case Effect::None:
+      break;
+    case Effect::Read:
+      if (lastWrite)
+        addDep(*lastWrite, i);
+      readsSinceWrite.push_back(i);
+      break;
+    case Effect::Write:
+      if (lastWrite)
+        addDep(*lastWrite, i);
+      for (int read : readsSinceWrite)
+        addDep(read, i);
+      readsSinceWrite.clear();
+      lastWrite = i;
+      break;
+    }
+  }
+  for (Value operand : block.getTerminator()->getOperands())
+    if (operand.getParentBlock() == &block)
+      liveThrough.insert(operand);
+  for (Operation *op : ops)
+    for (Value result : op->getResults())
+      if (llvm::any_of(result.getUsers(), [&](Operation *user) {
+            return !block.findAncestorOpInBlock(*user) ||
+                   user == block.getTerminator();
+          }))
+        liveThrough.insert(result);
+
+  // The priority of an op is the latency of the longest path from it to the
+  // end of the block.
+  SmallVector<int> latency(numOps), height(numOps);
+  for (int i = numOps - 1; i >= 0; --i) {
+    latency[i] = model.getLatency(ops[i]);
+    height[i] = latency[i];
+    for (int succ : succs[i])
+      height[i] = std::max(height[i], latency[i] + height[succ]);
+  }
+
+  // The values defined in the block are counted once scheduled.
+  int pressure = 0;
+  for (Value value : liveThrough)
+    if (value.getParentBlock() != &block || isa<BlockArgument>(value))
+      pressure += getRegisters(value);
+  // The registers an op defines minus those of the values it last uses.
+  auto getPressureDelta = [&](int i) {
+    int delta = 0;
+    for (Value result : ops[i]->getResults())
+      if (!result.use_empty())
+        delta += getRegisters(result);
+    llvm::SmallDenseSet<Value> lastUses;
+    ops[i]->walk([&](Operation *nested) {
+      for (Value operand : nested->getOperands()) {
+        auto it = users.find(operand);
+        if (it != users.end() && it->second.size() == 1 &&
+            !liveThrough.contains(operand) && lastUses.insert(operand).second)
+          delta -= getRegisters(operand);
+      }
+    });
+    return delta;
+  };
+
+  SmallVector<int> readyCycle(numOps, 0);
+  SmallVector<int> ready;
+  for (int i = 0; i < numOps; ++i)
+    if (numPreds[i] == 0)
+      ready.push_back(i);
+  SmallVector<int> order;
+  int cycle = 0;
+  while (!ready.empty()) {
+    // The ops whose operands are ready, or the ones ready the soonest.
+    int soonest = llvm::min_element(ready, [&](int a, int b) {
+                    return readyCycle[a] < readyCycle[b];
+                  }) - ready.begin();
+    cycle = std::max(cycle, readyCycle[ready[soonest]]);
+    std::optional<int> best;
+    int bestDelta = 0;
+    bool bestFits = false;
+    for (int i : ready) {
+      if (readyCycle[i] > cycle)
+        continue;
+      int delta = getPressureDelta(i);
+      bool fits = delta <= 0 || pressure + delta <= model.maxRegisters;
+      bool better;
+      if (!best)
+        better = true;
+      else if (fits != bestFits)
+        better = fits;
+      else if (!fits && delta != bestDelta)
+        better = delta < bestDelta;
+      else if (height[i] != height[*best])
+        better = height[i] > height[*best];
+      else
+        better = i < *best;
+      if (better) {
+        best = i;
+        bestDelta = delta;
+        bestFits = fits;
+      }
+    }
+    int i = *best;
+    order.push_back(i);
+    pressure += bestDelta;
+    ready.erase(llvm::find(ready, i));
+    ops[i]->walk([&](Operation *nested) {
+      for (Value operand : nested->getOperands()) {
+        auto it = users.find(operand);
+        if (it != users.end())
+          it->second.remove(i);
+      }
+    });
+    for (int succ : succs[i]) {
+      readyCycle[succ] = std::max(readyCycle[succ], cycle + latency[i]);
+      if (--numPreds[succ] == 0)
+        ready.push_back(succ);
+    }
+    ++cycle;
+  }
+  assert(order.size() == ops.size() && "the dependencies have a cycle");
+
+  Operation *terminator = block.getTerminator();
+  for (int i : order)
+    ops[i]->moveBefore(terminator);
+  LDBG("scheduled " << numOps << " ops in " << cycle << " cycles");
+}
+
+} // namespace
+
+void scheduleBlocks(ModuleOp module, const SchedulingModel &model) {
+  SmallVector<Block *> blocks;
+  module.walk([&](Block *block) {
+    Operation *parent = block->getParentOp();
+    if (isa<FunctionOpInterface, scf::ForOp, scf::IfOp, scf::WhileOp>(
+            parent) &&
+        !block->empty() &&
+        block->back().hasTrait<OpTrait::IsTerminator>())
+      blocks.push_back(block);
+  });
+  for (Block *block : blocks)
+    scheduleBlock(*block, model);
+}
+
+} // namespace mlir::triton::gpu
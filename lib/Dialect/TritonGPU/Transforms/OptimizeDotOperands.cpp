@@ -3,6 +3,7 @@
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 #include "mlir/Transforms/Passes.h"
+#include "triton/Analysis/RegisterPressure.h"
 #include "triton/Analysis/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
@@ -138,6 +139,16 @@ public:
     if (isa<arith::TruncIOp, arith::TruncFOp, arith::SelectOp>(src))
       return failure();
 
+    // Registers A operands of wgmma are only loaded from shared memory for
+    // 16-bit types, so don't hoist the conversion over a type change.
+    auto mmaEnc = dyn_cast<NvidiaMmaEncodingAttr>(
+        cast<DotOperandEncodingAttr>(cvtTy.getEncoding()).getParent());
+    if (mmaEnc && mmaEnc.isHopper() &&
+        !all_of(src->getOperandTypes(), [](Type ty) {
+          return getElementTypeOrSelf(ty).getIntOrFloatBitWidth() == 16;
+        }))
+      return failure();
+
     // Check that the conversion is transitively dependent on a load, and all
     // operations between the load and the conversion are layout preserving.
     //
@@ -300,6 +311,57 @@ struct MMAV3UseRegOperand
   }
 };
 
+// Rewrite
+//   convert(load(ptr) #blocked) #dot_operand<parent=#blocked1> ->
+//   convert(load(convert(ptr) #blocked2) #blocked2) #dot_operand,
+// where #blocked2 is the layout in which each thread holds the rows or the
+// columns it reads of the operand of the FMA dot along the whole K dimension,
+// if they fit in a few registers.  The outer convert then only reorders the
+// registers of each thread, instead of going through shared memory.
+class LoadFMADotOperandInRegisters : public OpRewritePattern<ConvertLayoutOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+
+  // The registers per thread the tile of an operand may take.
+  static constexpr unsigned kMaxRegisters = 64;
+
+  LogicalResult matchAndRewrite(ConvertLayoutOp cvt,
+                                PatternRewriter &rewriter) const override {
+    RankedTensorType cvtTy = cvt.getType();
+    auto dotOperandLayout =
+        dyn_cast<DotOperandEncodingAttr>(cvtTy.getEncoding());
+    if (!dotOperandLayout)
+      return failure();
+    auto loadOp = cvt.getSrc().getDefiningOp<LoadOp>();
+    if (!loadOp || !loadOp->hasOneUse() ||
+        isTensorPointerType(loadOp.getPtr().getType()))
+      return failure();
+    BlockedEncodingAttr layout =
+        getFMADotOperandRegisterLayout(dotOperandLayout, cvtTy.getShape());
+    if (!layout || layout == cvt.getSrc().getType().getEncoding())
+      return failure();
+    auto newTy = RankedTensorType::get(cvtTy.getShape(),
+                                       cvtTy.getElementType(), layout);
+    if (RegisterPressureAnalysis::getNumRegisters(newTy) > kMaxRegisters)
+      return failure();
+
+    rewriter.setInsertionPoint(loadOp);
+    Operation *newLoad = rewriter.clone(*loadOp);
+    for (OpOperand &operand : newLoad->getOpOperands()) {
+      auto operandTy = cast<RankedTensorType>(operand.get().getType());
+      auto newOperandTy = RankedTensorType::get(
+          operandTy.getShape(), operandTy.getElementType(), layout);
+      operand.set(rewriter.create<ConvertLayoutOp>(
+          loadOp.getLoc(), newOperandTy, operand.get()));
+    }
+    newLoad->getResult(0).setType(newTy);
+    rewriter.replaceOpWithNewOp<ConvertLayoutOp>(cvt, cvtTy,
+                                                 newLoad->getResult(0));
+    rewriter.eraseOp(loadOp);
+    return success();
+  }
+};
+
 } // namespace
 
 #define GEN_PASS_DEF_TRITONGPUOPTIMIZEDOTOPERANDS
@@ -326,6 +388,7 @@ public:
       patterns.add<HoistLayoutConversion>(context);
     patterns.add<FuseTransHopper>(context);
     patterns.add<MMAV3UseRegOperand>(context);
+    patterns.add<LoadFMADotOperandInRegisters>(context);
     ConvertLayoutOp::getCanonicalizationPatterns(patterns, context);
     if (failed(applyPatternsAndFoldGreedily(m, std::move(patterns))))
       signalPassFailure();
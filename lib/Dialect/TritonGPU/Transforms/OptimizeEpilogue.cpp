@@ -0,0 +1,256 @@
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/LLVM.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "triton/Dialect/Triton/IR/Utility.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/LinearLayoutConversions.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+#include "triton/Dialect/TritonGPU/Transforms/Utility.h"
+
+#include <set>
+
+namespace mlir {
+namespace triton {
+namespace gpu {
+
+#define GEN_PASS_DEF_TRITONGPUOPTIMIZEEPILOGUE
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+namespace {
+
+constexpr unsigned kSectorBytes = 32;
+constexpr unsigned kMaxStoreBytes = 16;
+constexpr unsigned kSmemWavefrontBytes = 128;
+constexpr int kMaxCheapOperandDepth = 8;
+
+// Returns true if `value` is cheap to produce in any layout, so that a layout
+// conversion of it gets rematerialized by RemoveLayoutConversions instead of
+// going through shared memory.  This covers the operands of the epilogues we
+// care about: splatted scalars, constants, and bias/scale vectors broadcast
+// along rows or columns.
+static bool isCheapToConvert(Value value, int depth = kMaxCheapOperandDepth) {
+  Operation *def = value.getDefiningOp();
+  if (!def || depth == 0)
+    return false;
+  if (isa<SplatOp, arith::ConstantOp, MakeRangeOp, BroadcastOp, ExpandDimsOp>(
+          def))
+    return true;
+  if (!def->hasTrait<OpTrait::Elementwise>() || def->getNumResults() != 1)
+    return false;
+  return llvm::all_of(def->getOperands(), [&](Value operand) {
+    return !isa<RankedTensorType>(operand.getType()) ||
+           isCheapToConvert(operand, depth - 1);
+  });
+}
+
+// Returns the number of `kSectorBytes`-wide global memory sectors written by
+// one warp when storing a tensor of type `ty` held in `layout`, with `vec`
+// elements per store instruction.  The tensor is assumed to be contiguous in
+// memory along `order`.
+static std::optional<unsigned> countStoreSectors(RankedTensorType ty,
+                                                 Attribute layout,
+                                                 ArrayRef<unsigned> order,
+                                                 unsigned vec) {
+  std::optional<LinearLayout> ll = toLinearLayout(ty.getShape(), layout);
+  if (!ll.has_value())
+    return std::nullopt;
+  MLIRContext *ctx = ty.getContext();
+  StringAttr kRegister = StringAttr::get(ctx, "register");
+  StringAttr kLane = StringAttr::get(ctx, "lane");
+  StringAttr kWarp = StringAttr::get(ctx, "warp");
+  StringAttr kBlock = StringAttr::get(ctx, "block");
+  unsigned elemBytes = std::max<unsigned>(ty.getElementTypeBitWidth() / 8, 1);
+
+  unsigned sectors = 0;
+  for (int reg = 0; reg < ll->getInDimSize(kRegister); reg += vec) {
+    std::set<int64_t> instrSectors;
+    for (int lane = 0; lane < ll->getInDimSize(kLane); ++lane) {
+      auto coords = ll->apply(
+          {{kRegister, reg}, {kLane, lane}, {kWarp, 0}, {kBlock, 0}});
+      int64_t offset = 0;
+      int64_t stride = 1;
+      for (unsigned d : order) {
+        auto dimName = StringAttr::get(ctx, "dim" + llvm::Twine(d));
+        auto it = llvm::find_if(
+            coords, [&](auto &coord) { return coord.first == dimName; });
+        offset += it->second * stride;
+        stride *= ty.getDimSize(d);
+      }
+      int64_t firstByte = offset * elemBytes;
+      int64_t lastByte = firstByte + vec * elemBytes - 1;
+      for (int64_t s = firstByte / kSectorBytes; s <= lastByte / kSectorBytes;
+           ++s)
+        instrSectors.insert(s);
+    }
+    sectors += instrSectors.size();
+  }
+  return sectors;
+}
+
+// Returns the number of elements stored by each instruction of a thread when
+// a tensor of type `ty` is held in `layout`.
+static unsigned getStoreVec(RankedTensorType ty, Attribute layout,
+                            unsigned fastestDim) {
+  unsigned elemBits = std::max<unsigned>(ty.getElementTypeBitWidth(), 8);
+  unsigned contig =
+      getUniqueContigPerThread(layout, ty.getShape())[fastestDim];
+  return std::max<unsigned>(std::min(contig, kMaxStoreBytes * 8 / elemBits),
+                            1);
+}
+
+// Returns true if storing `valTy` straight from MMA layout `mmaEnc` is
+// expected to be cheaper than converting it to the coalesced `blockedEnc`
+// first.  Storing from an MMA layout touches more global memory sectors per
+// instruction, while the conversion costs a shared memory round trip of the
+// whole tile, so the former wins when the extra sectors are fewer than the
+// shared memory wavefronts of the conversion.
+static bool isMmaStoreProfitable(RankedTensorType valTy, Attribute mmaEnc,
+                                 BlockedEncodingAttr blockedEnc) {
+  auto order = blockedEnc.getOrder();
+  unsigned blockedVec = getStoreVec(valTy, blockedEnc, order[0]);
+  // Alignment of the pointers limits the MMA store just like the blocked one.
+  unsigned mmaVec = std::min(getStoreVec(valTy, mmaEnc, order[0]), blockedVec);
+  auto mmaSectors = countStoreSectors(valTy, mmaEnc, order, mmaVec);
+  auto blockedSectors = countStoreSectors(valTy, blockedEnc, order, blockedVec);
+  if (!mmaSectors.has_value() || !blockedSectors.has_value())
+    return false;
+  unsigned numWarps = product<unsigned>(getWarpsPerCTA(blockedEnc));
+  unsigned numCTAs = product<unsigned>(getCTAsPerCGA(blockedEnc));
+  unsigned elemBytes =
+      std::max<unsigned>(valTy.getElementTypeBitWidth() / 8, 1);
+  unsigned warpBytes =
+      valTy.getNumElements() * elemBytes / (numWarps * numCTAs);
+  unsigned roundTrip = 2 * ceil<unsigned>(warpBytes, kSmemWavefrontBytes);
+  return *mmaSectors <= *blockedSectors + roundTrip;
+}
+
+// convert(acc) : mma -> blocked
+// elementwise(val, cheap operands...) : blocked
+// ...
+// tt.store(ptr, val, mask) : blocked
+// ==>
+// elementwise(acc, convert(cheap operands)...) : mma
+// ...
+// tt.store(convert(ptr), val, convert(mask)) : mma
+//
+// or, if storing from the MMA layout is not profitable,
+//
+// elementwise(acc, convert(cheap operands)...) : mma
+// ...
+// tt.store(ptr, convert(val), mask) : blocked
+//
+// Either way the epilogue runs on the accumulator registers, and a remaining
+// conversion only moves the (usually narrower) final values.
+class OptimizeEpilogueStore : public OpRewritePattern<StoreOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(StoreOp storeOp,
+                                PatternRewriter &rewriter) const override {
+    auto valTy = dyn_cast<RankedTensorType>(storeOp.getValue().getType());
+    if (!valTy || !isa<RankedTensorType>(storeOp.getPtr().getType()))
+      return failure();
+    auto blockedEnc = dyn_cast<BlockedEncodingAttr>(valTy.getEncoding());
+    if (!blockedEnc)
+      return failure();
+
+    // Walk the chain of elementwise ops back to the conversion from MMA.
+    SmallVector<Operation *> chain;
+    Value val = storeOp.getValue();
+    ConvertLayoutOp cvtOp;
+    while (true) {
+      Operation *def = val.getDefiningOp();
+      if (!def || !def->hasOneUse())
+        return failure();
+      if ((cvtOp = dyn_cast<ConvertLayoutOp>(def)))
+        break;
+      if (!def->hasTrait<OpTrait::Elementwise>() || def->getNumResults() != 1)
+        return failure();
+      Value next;
+      for (Value operand : def->getOperands()) {
+        if (!isa<RankedTensorType>(operand.getType()) ||
+            isCheapToConvert(operand))
+          continue;
+        if (next)
+          return failure();
+        next = operand;
+      }
+      if (!next)
+        return failure();
+      chain.push_back(def);
+      val = next;
+    }
+    Attribute mmaEnc = cvtOp.getSrc().getType().getEncoding();
+    if (!isa<MmaEncodingTrait>(mmaEnc) ||
+        cvtOp.getType().getEncoding() != blockedEnc)
+      return failure();
+
+    bool storeFromMma = isMmaStoreProfitable(valTy, mmaEnc, blockedEnc);
+    if (chain.empty() && !storeFromMma)
+      return failure();
+
+    auto convertTo = [&](Value value, Attribute encoding) -> Value {
+      auto ty = cast<RankedTensorType>(value.getType());
+      auto newTy =
+          RankedTensorType::get(ty.getShape(), ty.getElementType(), encoding);
+      return rewriter.create<ConvertLayoutOp>(value.getLoc(), newTy, value);
+    };
+
+    Value newVal = cvtOp.getSrc();
+    for (Operation *op : llvm::reverse(chain)) {
+      rewriter.setInsertionPoint(op);
+      rewriter.modifyOpInPlace(op, [&]() {
+        for (OpOperand &operand : op->getOpOperands()) {
+          if (operand.get() == val)
+            operand.set(newVal);
+          else if (isa<RankedTensorType>(operand.get().getType()))
+            operand.set(convertTo(operand.get(), mmaEnc));
+        }
+        auto oldTy = cast<RankedTensorType>(op->getResult(0).getType());
+        op->getResult(0).setType(RankedTensorType::get(
+            oldTy.getShape(), oldTy.getElementType(), mmaEnc));
+      });
+      val = op->getResult(0);
+      newVal = val;
+    }
+
+    rewriter.setInsertionPoint(storeOp);
+    if (storeFromMma) {
+      Value newPtr = convertTo(storeOp.getPtr(), mmaEnc);
+      Value newMask =
+          storeOp.getMask() ? convertTo(storeOp.getMask(), mmaEnc) : Value();
+      rewriter.replaceOpWithNewOp<StoreOp>(storeOp, newPtr, newVal, newMask,
+                                           storeOp.getCache(),
+                                           storeOp.getEvict());
+    } else {
+      Value blockedVal = convertTo(newVal, blockedEnc);
+      rewriter.modifyOpInPlace(
+          storeOp, [&]() { storeOp.getValueMutable().assign(blockedVal); });
+    }
+    if (cvtOp->use_empty())
+      rewriter.eraseOp(cvtOp);
+    return success();
+  }
+};
+
+} // namespace
+
+class TritonGPUOptimizeEpiloguePass
+    : public impl::TritonGPUOptimizeEpilogueBase<
+          TritonGPUOptimizeEpiloguePass> {
+public:
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    ModuleOp m = getOperation();
+
+    RewritePatternSet patterns(context);
+    patterns.add<OptimizeEpilogueStore>(context);
+    if (applyPatternsAndFoldGreedily(m, std::move(patterns)).failed())
+      signalPassFailure();
+  }
+};
+
+} // namespace gpu
+} // namespace triton
+} // namespace mlir
@@ -6,9 +6,11 @@
 #include "mlir/Support/LLVM.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 #include "mlir/Transforms/Passes.h"
+#include "triton/Dialect/Triton/IR/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
 #include "triton/Dialect/TritonGPU/Transforms/Utility.h"
+#include "llvm/ADT/SetVector.h"
 
 namespace mlir {
 namespace triton {
@@ -18,9 +20,53 @@ namespace gpu {
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
 
 namespace {
-// Change the destination layout of reshape ops allowing reorder when used by a
-// reduction in order to minimize the amount of cross thread communication for
-// the reduction.
+// Add to `axes` the axes of the reductions and scans of `value` and of the
+// values computed elementwise from it, which get the layout of `value` once
+// the layout conversions are removed.
+void getReduceAndScanAxes(Value value, DenseSet<Value> &visited,
+                          SmallVector<int> &axes) {
+  if (!visited.insert(value).second)
+    return;
+  for (Operation *user : value.getUsers()) {
+    if (auto reduceOp = dyn_cast<triton::ReduceOp>(user)) {
+      axes.push_back(reduceOp.getAxis());
+    } else if (auto scanOp = dyn_cast<triton::ScanOp>(user)) {
+      axes.push_back(scanOp.getAxis());
+    } else if (user->hasTrait<OpTrait::Elementwise>() ||
+               user->hasTrait<OpTrait::SameOperandsAndResultEncoding>()) {
+      for (Value result : user->getResults())
+        getReduceAndScanAxes(result, visited, axes);
+    }
+  }
+}
+
+// Return an estimate of the cost of the communication between threads of a
+// reduction or scan along `axis` of a tensor of `type`: the rounds of warp
+// shuffles along the axis, and the shared memory round trip if the axis spans
+// several warps, for each element a thread holds after combining its own
+// elements along the axis.
+int64_t getCrossThreadCost(RankedTensorType type, int axis) {
+  // A shared memory round trip costs about as much as this many shuffles.
+  constexpr int64_t kSharedMemoryCost = 8;
+  Attribute encoding = type.getEncoding();
+  SmallVector<unsigned> elemsPerThread = triton::gpu::getElemsPerThread(type);
+  int64_t numElems = product<unsigned>(elemsPerThread) / elemsPerThread[axis];
+  unsigned numThreads = triton::gpu::getThreadsPerWarpWithUniqueData(
+      encoding, type.getShape())[axis];
+  unsigned numWarps = triton::gpu::getWarpsPerCTAWithUniqueData(
+      encoding, type.getShape())[axis];
+  int64_t cost = llvm::Log2_32_Ceil(numThreads);
+  if (numWarps > 1)
+    cost += kSharedMemoryCost + llvm::Log2_32_Ceil(numWarps);
+  return numElems * cost;
+}
+
+// Change the destination layout of reshape ops allowing reorder when used by
+// reductions or scans in order to minimize the amount of cross thread
+// communication for them. When the reductions and scans computed from the
+// reshape are along different axes, e.g. the row max, the row sum and the
+// column sum of backward softmax, pick the layout minimizing the total cost of
+// the chain rather than the cost of one of them.
 struct OptimizeReshapeLayoutPattern
     : public mlir::OpRewritePattern<triton::ReshapeOp> {
   OptimizeReshapeLayoutPattern(mlir::MLIRContext *context)
@@ -31,56 +77,55 @@ struct OptimizeReshapeLayoutPattern
                   mlir::PatternRewriter &rewriter) const override {
     if (!viewOp.getAllowReorder())
       return failure();
-    std::optional<int> reductionAxis;
-    for (Operation *user : viewOp.getResult().getUsers()) {
-      if (auto reduceOp = dyn_cast<triton::ReduceOp>(user)) {
-        if (reductionAxis) {
-          if (reductionAxis != reduceOp.getAxis())
-            return failure();
-        } else {
-          reductionAxis = reduceOp.getAxis();
-        }
-      }
-    }
-    if (!reductionAxis)
+    DenseSet<Value> visited;
+    SmallVector<int> axes;
+    getReduceAndScanAxes(viewOp.getResult(), visited, axes);
+    if (axes.empty())
       return failure();
     RankedTensorType tensorType = viewOp.getType();
-    if (auto blocked = mlir::dyn_cast<triton::gpu::BlockedEncodingAttr>(
-            tensorType.getEncoding())) {
-      // If the layout already has all the elements along the reduction
-      // dimension in the same thread we can skip.
-      if (blocked.getThreadsPerWarp()[*reductionAxis] == 1 &&
-          blocked.getWarpsPerCTA()[*reductionAxis] == 1 &&
-          blocked.getCTAsPerCGA()[*reductionAxis] == 1)
-        return failure();
-    }
+    auto getCost = [&](RankedTensorType type) {
+      int64_t cost = 0;
+      for (int axis : axes)
+        cost += getCrossThreadCost(type, axis);
+      return cost;
+    };
+    RankedTensorType bestType = tensorType;
+    int64_t bestCost = getCost(tensorType);
     ArrayRef<int64_t> shape = tensorType.getShape();
-    llvm::SmallVector<unsigned> order;
-    for (int i : triton::gpu::getOrder(tensorType.getEncoding())) {
-      if (i != *reductionAxis)
-        order.push_back(i);
-    }
-    // Make the reduction axis last so that elements won't be distributed
-    // amongst threads along this dimension.
-    order.push_back(*reductionAxis);
-    llvm::SmallVector<unsigned> sizePerThread(shape.size(), 1);
     auto mod = viewOp->getParentOfType<ModuleOp>();
     int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
     int threadsPerWarp = triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
     int numCTAs = triton::gpu::TritonGPUDialect::getNumCTAs(mod);
-    triton::gpu::BlockedEncodingAttr encoding =
-        triton::gpu::BlockedEncodingAttr::get(viewOp.getContext(), shape,
-                                              sizePerThread, order, numWarps,
-                                              threadsPerWarp, numCTAs);
-    if (encoding == tensorType.getEncoding())
-      return failure();
-    RankedTensorType newType =
-        RankedTensorType::get(shape, tensorType.getElementType(), encoding);
-    if (triton::gpu::isExpensiveView(viewOp.getSrc().getType(), newType))
+    llvm::SmallSetVector<int, 4> reductionAxes(axes.begin(), axes.end());
+    for (int reductionAxis : reductionAxes) {
+      llvm::SmallVector<unsigned> order;
+      for (int i : triton::gpu::getOrder(tensorType.getEncoding())) {
+        if (i != reductionAxis)
+          order.push_back(i);
+      }
+      // Make the reduction axis last so that elements won't be distributed
+      // amongst threads along this dimension.
+      order.push_back(reductionAxis);
+      llvm::SmallVector<unsigned> sizePerThread(shape.size(), 1);
+      triton::gpu::BlockedEncodingAttr encoding =
+          triton::gpu::BlockedEncodingAttr::get(viewOp.getContext(), shape,
+                                                sizePerThread, order, numWarps,
+                                                threadsPerWarp, numCTAs);
+      RankedTensorType newType =
+          RankedTensorType::get(shape, tensorType.getElementType(), encoding);
+      if (triton::gpu::isExpensiveView(viewOp.getSrc().getType(), newType))
+        continue;
+      int64_t cost = getCost(newType);
+      if (cost < bestCost) {
+        bestType = newType;
+        bestCost = cost;
+      }
+    }
+    if (bestType == tensorType)
       return failure();
     rewriter.setInsertionPointAfter(viewOp);
     rewriter.modifyOpInPlace(viewOp, [&]() {
-      viewOp.getResult().setType(newType);
+      viewOp.getResult().setType(bestType);
       viewOp.setEfficientLayout(true);
     });
     auto cvt = rewriter.create<mlir::triton::gpu::ConvertLayoutOp>(
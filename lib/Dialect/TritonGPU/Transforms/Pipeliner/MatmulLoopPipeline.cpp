@@ -188,7 +188,8 @@ static void createTMAAsyncCopy(
 
   Value pred = builder.create<arith::ConstantIntOp>(loc, 1, 1);
   Operation *copy = builder.create<ttng::AsyncTMACopyGlobalToLocalOp>(
-      loc, loadOp.getDescPtr(), loadOp.getIndices(), barrier, view, pred);
+      loc, loadOp.getDescPtr(), loadOp.getIndices(), loadOp.getIm2colOffsets(),
+      barrier, view, pred);
 
   bool isMMV3Load = loadToInfo[loadOp].loadIsMMAV3;
   auto [stage, cluster] = schedule[loadOp];
@@ -339,6 +340,85 @@ getSharedEncoding(Operation *loadOp, bool isMMAV3) {
                                       ctaLayout);
 }
 
+// Return true if the address or the mask of `loadOp` depend on data loaded in
+// a previous iteration of the loop, e.g. to chase pointers, in which case the
+// load can't be issued ahead of the iterations before it.
+static bool dependsOnLoadOfPreviousIteration(Operation *loadOp) {
+  Block *body = loadOp->getBlock();
+  DenseSet<Operation *> sameIteration;
+  tt::addDep(loadOp, sameIteration, /*includeArg=*/false);
+  for (Operation *op : sameIteration) {
+    for (Value operand : op->getOperands()) {
+      auto arg = dyn_cast<BlockArgument>(operand);
+      // Argument 0 is the induction variable.
+      if (!arg || arg.getOwner() != body || arg.getArgNumber() == 0)
+        continue;
+      Value yielded = body->getTerminator()->getOperand(arg.getArgNumber() - 1);
+      Operation *defOp = yielded.getDefiningOp();
+      if (!defOp || defOp->getBlock() != body)
+        continue;
+      DenseSet<Operation *> previousIteration;
+      tt::addDep(defOp, previousIteration, /*includeArg=*/true);
+      if (llvm::any_of(previousIteration, [](Operation *dep) {
+            return isa<tt::LoadOp, tt::ExperimentalDescriptorLoadOp>(dep);
+          }))
+        return true;
+    }
+  }
+  return false;
+}
+
+// Add to `roots` the function arguments the pointers `ptr` are computed from,
+// through the iteration arguments of loops. Return false if they are computed
+// from other pointers, e.g. loaded ones.
+static bool getPointerRoots(Value ptr, DenseSet<Value> &roots) {
+  SmallVector<Value> worklist = {ptr};
+  DenseSet<Value> seen;
+  while (!worklist.empty()) {
+    Value v = worklist.pop_back_val();
+    if (!isa<tt::PointerType>(getElementTypeOrSelf(v.getType())) ||
+        !seen.insert(v).second)
+      continue;
+    if (auto arg = dyn_cast<BlockArgument>(v)) {
+      Operation *parentOp = arg.getOwner()->getParentOp();
+      if (isa<tt::FuncOp>(parentOp)) {
+        roots.insert(v);
+        continue;
+      }
+      auto forOp = dyn_cast<scf::ForOp>(parentOp);
+      if (!forOp || arg.getArgNumber() == 0)
+        return false;
+      unsigned iterArg = arg.getArgNumber() - 1;
+      worklist.push_back(forOp.getInitArgs()[iterArg]);
+      worklist.push_back(forOp.getBody()->getTerminator()->getOperand(iterArg));
+      continue;
+    }
+    Operation *defOp = v.getDefiningOp();
+    if (isa<tt::LoadOp, tt::IntToPtrOp>(defOp) || defOp->getNumRegions() != 0)
+      return false;
+    llvm::append_range(worklist, defOp->getOperands());
+  }
+  return true;
+}
+
+// Add to `roots` the function arguments of the pointers the loop writes to.
+// Return false if some can't be found.
+static bool getWrittenPointerRoots(scf::ForOp forOp, DenseSet<Value> &roots) {
+  return !forOp.getBody()
+              ->walk([&](Operation *op) {
+                if (isa<tt::CallOp>(op))
+                  return WalkResult::interrupt();
+                // The pointers are the first operand of all these ops.
+                if (isa<tt::StoreOp, tt::AtomicRMWOp, tt::AtomicCASOp,
+                        tt::ExperimentalDescriptorStoreOp,
+                        tt::ExperimentalDescriptorReduceOp>(op) &&
+                    !getPointerRoots(op->getOperand(0), roots))
+                  return WalkResult::interrupt();
+                return WalkResult::advance();
+              })
+              .wasInterrupted();
+}
+
 // Create a map from load ops to their indirection level and the
 // final use of the load op (another load op, or a dot op).
 // Indirection level is "0" for the load op directly used by the dot op,
@@ -348,12 +428,32 @@ loadOpsToIndirectionLevelAndUse(scf::ForOp forOp) {
   llvm::SmallVector<std::tuple<Operation *, int, Operation *>>
       loadOpToIndLevelAndUse;
   DenseSet<Operation *> seen;
+  // Whether the loads not used by dots are being collected.
+  bool notUsedByDot = false;
+  // The roots of the pointers the loop writes to, if the loads of the loop are
+  // pipelined without the loop asking for it. Loads of memory written to by
+  // the loop aren't prefetched then, as it may be written to by the iterations
+  // before the load.
+  std::optional<DenseSet<Value>> writtenRoots;
+  auto canPrefetch = [&](Operation *loadOp) {
+    if (dependsOnLoadOfPreviousIteration(loadOp))
+      return false;
+    if (!writtenRoots)
+      return true;
+    DenseSet<Value> roots;
+    return getPointerRoots(loadOp->getOperand(0), roots) &&
+           llvm::none_of(roots, [&](Value root) {
+             return writtenRoots->contains(root);
+           });
+  };
 
   std::function<void(Operation * op, int, Operation *)> dfs =
       [&](Operation *op, int distance, Operation *use) {
         if (!seen.insert(op).second)
           return;
         if (isa<tt::LoadOp, tt::ExperimentalDescriptorLoadOp>(op)) {
+          if (notUsedByDot && !canPrefetch(op))
+            return;
           // TODO: What if there are multiple uses at different distances?
           loadOpToIndLevelAndUse.push_back(std::make_tuple(op, distance, use));
           use = op;
@@ -368,20 +468,42 @@ loadOpsToIndirectionLevelAndUse(scf::ForOp forOp) {
         }
       };
 
+  bool hasDot = false;
   for (Operation &op : forOp.getBody()->without_terminator()) {
     if (!op.hasTrait<OpTrait::DotLike>())
       continue;
+    hasDot = true;
     seen.clear();
     dfs(&op, 0, &op);
   }
 
-  // If the loop has numStages attribute, also consider pipelining other loads
-  // that are not directly used by dot ops.
-  if (forOp->hasAttr(tt::kNumStagesAttrName)) {
+  // If the loop has numStages attribute, or no dots, e.g. a streaming
+  // reduction, also consider pipelining other loads that are not directly used
+  // by dot ops.
+  notUsedByDot = true;
+  if (!hasDot && !forOp->hasAttr(tt::kNumStagesAttrName)) {
+    writtenRoots.emplace();
+    if (!getWrittenPointerRoots(forOp, *writtenRoots))
+      return loadOpToIndLevelAndUse;
+  }
+  if (forOp->hasAttr(tt::kNumStagesAttrName) || !hasDot) {
     for (Operation &op : forOp.getBody()->without_terminator()) {
       if (!isa<tt::LoadOp, tt::ExperimentalDescriptorLoadOp>(op))
         dfs(&op, 0, &op);
     }
+  } else {
+    // Loads pinned to a stage are pipelined even if they don't feed a dot.
+    for (Operation &op : forOp.getBody()->without_terminator()) {
+      if (isa<tt::LoadOp, tt::ExperimentalDescriptorLoadOp>(op))
+        continue;
+      if (llvm::any_of(op.getOperands(), [&](Value operand) {
+            Operation *defOp = operand.getDefiningOp();
+            return defOp && defOp->getBlock() == op.getBlock() &&
+                   isa<tt::LoadOp, tt::ExperimentalDescriptorLoadOp>(defOp) &&
+                   defOp->hasAttr(tt::kPipelineStageAttrName);
+          }))
+        dfs(&op, 0, &op);
+    }
   }
 
   return loadOpToIndLevelAndUse;
@@ -455,7 +577,16 @@ assignMemoryLayouts(llvm::SmallVector<std::tuple<Operation *, int, Operation *>>
       } else if (isa<tt::ExperimentalDescriptorLoadOp>(op)) {
         loadInfo.sharedEncoding =
             getSharedEncoding(op, /*loadIsMMAv3=*/true).value_or(nullptr);
-      } else if (auto dot = dyn_cast<tt::DotOp>(use)) {
+      } else if (isa<tt::DotOp, ttng::WarpGroupDotOp>(use)) {
+        // Operands of FMA dots loaded in their register tile layout are read
+        // by the dot from registers, don't stage them in shared memory.
+        if (llvm::all_of(op->getUsers(), [](Operation *user) {
+              auto cvt = dyn_cast<ttg::ConvertLayoutOp>(user);
+              return cvt && isBlockedToDotShortcut(cvt.getSrc().getType(),
+                                                   cvt.getType());
+            }))
+          continue;
+        // For wgmma this is the A operand read from registers.
         bool incompatible = false;
         loadInfo.sharedEncoding =
             getSharedEncIfAllUsersAreDotEnc(op->getResult(0), incompatible)
@@ -474,7 +605,8 @@ assignMemoryLayouts(llvm::SmallVector<std::tuple<Operation *, int, Operation *>>
         // fails.  :)
         if (!loadInfo.sharedEncoding) {
           if (auto dotEnc = dyn_cast<ttg::NvidiaMmaEncodingAttr>(
-                  dot.getResult().getType().getEncoding())) {
+                  cast<RankedTensorType>(use->getResult(0).getType())
+                      .getEncoding())) {
             auto loadTy = cast<RankedTensorType>(op->getResultTypes()[0]);
             auto mmaInstrShape = dotEnc.getInstrShape();
             if (loadTy.getRank() < mmaInstrShape.size())
@@ -528,6 +660,18 @@ assignMemoryLayouts(llvm::SmallVector<std::tuple<Operation *, int, Operation *>>
   return loadToInfo;
 }
 
+// The shared memory the buffers of the loads of a loop without dots may take.
+static constexpr int64_t kMaxStreamingBufferBytes = 48 * 1024;
+
+// Return the stage `op` is pinned to by the user, clamped to the stages of the
+// loop, if any.
+static std::optional<int> getPinnedStage(Operation *op, int numStages) {
+  auto attr = op->getAttrOfType<IntegerAttr>(tt::kPipelineStageAttrName);
+  if (!attr)
+    return std::nullopt;
+  return std::clamp<int>(attr.getInt(), 0, numStages - 1);
+}
+
 static llvm::MapVector<Operation *, LoadInfo>
 scheduleLoads(scf::ForOp forOp, tt::CoarseSchedule &schedule,
               DenseSet<Operation *> &rootUsers, int numStages) {
@@ -568,14 +712,17 @@ scheduleLoads(scf::ForOp forOp, tt::CoarseSchedule &schedule,
       ceil<unsigned>(numStages - 2, maxIndirectionLevel + 1);
 
   tt::CoarseSchedule::Cluster rootUsersCluster = schedule.clusters.newAtFront();
-  // Put the root uses of the loads in the last stage.
+  // Put the root uses of the loads in the last stage, or the stage they are
+  // pinned to.
   for (auto &[loadOp, dist, use] : loadOpToIndLevelAndUse) {
     if (loadToInfo.count(loadOp) == 0)
       continue;
     // Non-LoadOp(s) are the root uses of all LoadOp(s) and should be
     // always present in the opInfo
     if (!isa<tt::LoadOp>(use)) {
-      schedule.insert(use, numStages - 1, rootUsersCluster);
+      schedule.insert(use,
+                      getPinnedStage(use, numStages).value_or(numStages - 1),
+                      rootUsersCluster);
       rootUsers.insert(use);
     }
   }
@@ -584,14 +731,44 @@ scheduleLoads(scf::ForOp forOp, tt::CoarseSchedule &schedule,
   for (int i = 0; i < maxIndirectionLevel + 1; i++) {
     loadsClusters.push_back(schedule.clusters.newAtBack());
   }
-  // Assign stages to the loads.
+  // Assign stages to the loads, or the stages they are pinned to.
   for (auto [loadOp, indLevel, _] : loadOpToIndLevelAndUse) {
     if (loadToInfo.count(loadOp) == 0)
       continue;
     int stage = (maxIndirectionLevel - indLevel) * stagesBetweenLoads;
-    schedule.insert(loadOp, stage, loadsClusters[indLevel]);
+    schedule.insert(loadOp, getPinnedStage(loadOp, numStages).value_or(stage),
+                    loadsClusters[indLevel]);
   }
 
+  // A load must be issued at least a stage before its root use, and not later
+  // than the load using it, which pinned stages may not respect. The uses come
+  // before the loads, so the stages of the uses are final when their loads are
+  // moved.
+  for (auto [loadOp, _, use] : loadOpToIndLevelAndUse) {
+    if (loadToInfo.count(loadOp) == 0)
+      continue;
+    auto [stage, cluster] = schedule[loadOp];
+    bool usedByLoad = isa<tt::LoadOp>(use);
+    if (usedByLoad && loadToInfo.count(use) == 0) {
+      LDBG("Not pipelining load used by a load that is not pipelined: "
+           << *loadOp);
+      schedule.erase(loadOp);
+      loadToInfo.erase(loadOp);
+      continue;
+    }
+    int maxStage = schedule[use].first - (usedByLoad ? 0 : 1);
+    if (maxStage < 0) {
+      LDBG("Not pipelining load used in the first stage: " << *loadOp);
+      schedule.erase(loadOp);
+      loadToInfo.erase(loadOp);
+      continue;
+    }
+    if (stage > maxStage)
+      schedule.insert(loadOp, maxStage, cluster);
+  }
+  if (loadToInfo.empty())
+    return {};
+
   // Distance from the load to the use.
   for (auto [loadOp, _, use] : loadOpToIndLevelAndUse) {
     if (loadToInfo.count(loadOp) == 0)
@@ -599,9 +776,60 @@ scheduleLoads(scf::ForOp forOp, tt::CoarseSchedule &schedule,
     loadToInfo[loadOp].distToUse = schedule[use].first - schedule[loadOp].first;
   }
 
+  // Loops without dots are pipelined unless told otherwise, so bail out if
+  // their buffers would take more than the shared memory every target has.
+  bool hasDot =
+      llvm::any_of(forOp.getBody()->without_terminator(), [](Operation &op) {
+        return op.hasTrait<OpTrait::DotLike>();
+      });
+  if (!hasDot && !forOp->hasAttr(tt::kNumStagesAttrName)) {
+    int numBuffers = 0;
+    int64_t bufferBytes = 0;
+    for (auto &[loadOp, info] : loadToInfo) {
+      numBuffers = std::max(numBuffers, info.distToUse);
+      auto ty = cast<RankedTensorType>(loadOp->getResultTypes()[0]);
+      bufferBytes += ty.getNumElements() * ty.getElementTypeBitWidth() / 8;
+    }
+    if (numBuffers * bufferBytes > kMaxStreamingBufferBytes) {
+      LDBG("Not pipelining loop without dots, its buffers would take "
+           << numBuffers * bufferBytes << " bytes");
+      return {};
+    }
+  }
+
   return loadToInfo;
 }
 
+// Add the ops pinned to a stage not yet in the schedule to their stage, in a
+// new cluster at the back. An op is moved to a later stage than its pin if it
+// depends on an op scheduled later in the same iteration, or to an earlier one
+// if a scheduled op uses it earlier. Prefetches not pinned are pinned to the
+// first stage, so that they are issued with the loads furthest ahead.
+static void schedulePinnedOps(scf::ForOp forOp, tt::CoarseSchedule &schedule,
+                              int numStages) {
+  std::optional<tt::CoarseSchedule::Cluster> pinnedCluster;
+  for (Operation &op : forOp.getBody()->without_terminator()) {
+    std::optional<int> stage = getPinnedStage(&op, numStages);
+    if (!stage && isa<tt::PrefetchOp, tt::ExperimentalDescriptorPrefetchOp>(op))
+      stage = 0;
+    if (!stage || schedule.count(&op))
+      continue;
+    for (Operation *user : op.getUsers()) {
+      if (user->getBlock() == op.getBlock() && schedule.count(user))
+        *stage = std::min(*stage, schedule[user].first);
+    }
+    DenseSet<Operation *> deps;
+    tt::addDep(&op, deps, /*includeArg=*/false);
+    for (Operation *dep : deps) {
+      if (schedule.count(dep))
+        *stage = std::max(*stage, schedule[dep].first);
+    }
+    if (!pinnedCluster)
+      pinnedCluster = schedule.clusters.newAtBack();
+    schedule.insert(&op, *stage, *pinnedCluster);
+  }
+}
+
 // Schedule the prologue and epilogue `if` ops in the loop, pushing them as
 // close to the loop boundaries as possible. Return the cluster after the
 // prologue (or the beginning of the loop if there is no prologue).
@@ -662,114 +890,6 @@ schedulePrologueAndEpilogue(scf::ForOp forOp, tt::CoarseSchedule &schedule,
   return afterPrologue;
 }
 
-// Add dependencies of anchor ops to the coarse schedule. Schedule them to
-// the same stage and ordering cluster as the anchor op.
-static void scheduleDependencies(scf::ForOp forOp, tt::CoarseSchedule &schedule,
-                                 int numStages) {
-  SmallVector<std::tuple<Operation *, int, tt::CoarseSchedule::Cluster>>
-      opsInOrder = schedule.getOpsInOrder(forOp);
-  // Schedule dependencies stage by stage.
-  for (int stage = 0; stage < numStages; stage++) {
-    for (auto [op, stage_, cluster] : opsInOrder) {
-      if (stage_ != stage)
-        continue;
-      schedule.insertDepsOfOp(op, stage, cluster, false);
-    }
-  }
-}
-
-// Find dependencies with distance of 1. They will go to the next stage,
-// but in the cluster before the current op.
-static void scheduleDistanceOneDependencies(scf::ForOp forOp,
-                                            tt::CoarseSchedule &schedule,
-                                            int numStages) {
-  auto getNestedOperands = [](Operation *op) -> SmallVector<Value> {
-    SmallVector<Value> operands;
-    op->walk([&](Operation *nestedOp) {
-      for (Value operand : nestedOp->getOperands()) {
-        if (operand.getParentBlock()->getParentOp()->isAncestor(nestedOp))
-          operands.push_back(operand);
-      }
-    });
-    return operands;
-  };
-
-  // Mapping from the cluster to the cluster before it.
-  DenseMap<tt::CoarseSchedule::Cluster *, tt::CoarseSchedule::Cluster>
-      dist1Cluster;
-  for (auto &op : forOp.getBody()->without_terminator()) {
-    if (schedule.count(&op) == 0)
-      continue;
-    auto [stage, cluster] = schedule[&op];
-    // Can't schedule past the last stage.
-    if (stage == numStages - 1)
-      continue;
-    for (Value operand : getNestedOperands(&op)) {
-      if (auto arg = dyn_cast<BlockArgument>(operand)) {
-        if (arg.getArgNumber() > 0 && arg.getOwner() == op.getBlock()) {
-          auto yieldOp = op.getBlock()->getTerminator();
-          Value v = yieldOp->getOperand(arg.getArgNumber() - 1);
-          Operation *defOp = v.getDefiningOp();
-          if (defOp && schedule.count(defOp) == 0) {
-            if (isa<tt::LoadOp>(defOp)) {
-              // Exception: Schedule loads with a distance of 1 together
-              // with the current op.
-              schedule.insertIfAbsent(defOp, stage, cluster);
-              schedule.insertDepsOfOp(defOp, stage, cluster, true);
-            } else {
-              if (dist1Cluster.count(&cluster) == 0) {
-                dist1Cluster[&cluster] = schedule.clusters.newBefore(cluster);
-              }
-              schedule.insertIfAbsent(defOp, stage + 1, dist1Cluster[&cluster]);
-              schedule.insertDepsOfOp(defOp, stage + 1, dist1Cluster[&cluster],
-                                      true);
-            }
-          }
-        }
-      }
-    }
-  }
-}
-
-static void
-scheduleRemainingToLastStage(scf::ForOp forOp, tt::CoarseSchedule &schedule,
-                             tt::CoarseSchedule::Cluster afterPrologue,
-                             int numStages) {
-  // Assign the rest of the ops to the last stage.
-  // Take care of the ordering of the ops - uses cannot be scheduled to the
-  // cluster before the definition.
-  DenseMap<Operation *, tt::CoarseSchedule::Cluster> opToCluster;
-  for (auto &op : forOp.getBody()->without_terminator()) {
-    if (schedule.count(&op) == 0) {
-      opToCluster[&op] = afterPrologue;
-    }
-  }
-  SmallVector<Operation *> queue;
-  for (auto [op, stage, cluster] : schedule.getOpsInOrder(forOp)) {
-    // We really only care about the producers from the last stage.
-    // Others will be scheduled before these ops anyway.
-    if (stage == numStages - 1) {
-      queue.push_back(op);
-    }
-  }
-  while (!queue.empty()) {
-    Operation *op = queue.pop_back_val();
-    for (auto user : op->getUsers()) {
-      if (opToCluster.count(user)) {
-        tt::CoarseSchedule::Cluster userCluster = opToCluster[user];
-        tt::CoarseSchedule::Cluster opCluster = schedule[op].second;
-        if (*userCluster < *opCluster) {
-          opToCluster[user] = opCluster;
-          queue.push_back(user);
-        }
-      }
-    }
-  }
-  for (auto [op, cluster] : opToCluster) {
-    schedule.insert(op, numStages - 1, cluster);
-  }
-}
-
 // Create an allocation that can hold distance number of loadOp shapes.
 static Value createAlloc(scf::ForOp &forOp, Operation *loadOp,
                          ttg::SharedEncodingAttr sharedEnc, unsigned distance) {
@@ -891,7 +1011,7 @@ static void createTMABarrierAndWait(
     for (AsyncLoad *asyncLoad : group) {
       auto tensorTy =
           cast<RankedTensorType>(asyncLoad->loadOp->getResult(0).getType());
-      int loadSize = product(tensorTy.getShape());
+      int loadSize = product(ttg::getShapePerCTA(tensorTy));
       sizeInBytes +=
           loadSize * tensorTy.getElementType().getIntOrFloatBitWidth() / 8;
     }
@@ -934,7 +1054,8 @@ static void createTMABarrierAndWait(
 static SmallVector<Value>
 createAsyncOps(scf::ForOp &forOp, tt::CoarseSchedule &schedule,
                llvm::MapVector<Operation *, LoadInfo> &loadToInfo,
-               SmallVector<Value> &barriers, int numStages) {
+               SmallVector<Value> &barriers, int numStages,
+               int numDotIterationsInFlight) {
   // Calculate the number of buffers needed for each load.
   // TODO pawel: we could do more fine-grained allocation here and
   // allocate only the number of buffers that specific loads need.
@@ -947,9 +1068,10 @@ createAsyncOps(scf::ForOp &forOp, tt::CoarseSchedule &schedule,
   bool hasMMAV3 =
       llvm::any_of(loadToInfo, [](auto &kv) { return kv.second.loadIsMMAV3; });
   if (hasMMAV3) {
-    // For MMAv3, we need an extra buffer as this is assumed in the wgmma
-    // pipelining post-processing.
-    numBuffers++;
+    // For MMAv3, the dots of the previous iterations may still be reading
+    // their buffers, we need an extra buffer for each of them as this is
+    // assumed in the wgmma pipelining post-processing.
+    numBuffers += numDotIterationsInFlight - 1;
   };
 
   SmallVector<AsyncLoad> asyncLoads;
@@ -1063,7 +1185,8 @@ static void invalidateBarriers(OpBuilder &builder,
 }
 
 bool mlir::triton::preProcessLoopAndGetSchedule(
-    scf::ForOp &forOp, int numStages, mlir::triton::PipeliningOption &options) {
+    scf::ForOp &forOp, int numStages, int numDotIterationsInFlight,
+    mlir::triton::PipeliningOption &options) {
   // Schedule the loads and root ops (dot ops) in the loop. This will give us
   // a scaffold for the final schedule.
   DenseSet<Operation *> rootUsers;
@@ -1081,13 +1204,20 @@ bool mlir::triton::preProcessLoopAndGetSchedule(
   SmallVector<Value> barriers;
   // Convert the loads into async loads and create the allocs.
   SmallVector<Value> allocs =
-      createAsyncOps(forOp, coarseSchedule, loadToInfo, barriers, numStages);
+      createAsyncOps(forOp, coarseSchedule, loadToInfo, barriers, numStages,
+                     numDotIterationsInFlight);
 
   LLVM_DEBUG({
     LDBG("Coarse schedule with async loads:");
     coarseSchedule.dump();
   });
 
+  schedulePinnedOps(forOp, coarseSchedule, numStages);
+  LLVM_DEBUG({
+    LDBG("Coarse schedule with pinned ops:");
+    coarseSchedule.dump();
+  });
+
   tt::CoarseSchedule::Cluster afterPrologue =
       schedulePrologueAndEpilogue(forOp, coarseSchedule, rootUsers, numStages);
   LLVM_DEBUG({
@@ -1497,9 +1627,9 @@ static std::optional<int> dotCanBeProperlyAsync(ttng::WarpGroupDotOp dotOp,
 }
 
 // If necessary, insert a dot-wait inside the loop, waiting for the results of
-// the properly-async dots from iteration i-1 to complete.  (We pipeline to
-// depth 2, so there are at most 2 copies of each warp_group_dot in flight at a
-// time.)
+// the properly-async dots from iteration i-numIterationsInFlight+1 to complete.
+// (We pipeline to depth numIterationsInFlight, so there are at most
+// numIterationsInFlight copies of each warp_group_dot in flight at a time.)
 //
 // We can skip inserting the wait if we have a `warp_group_dot_wait
 // {pendings=0}` somewhere in the loop.  To see why, consider:
@@ -1517,7 +1647,8 @@ static std::optional<int> dotCanBeProperlyAsync(ttng::WarpGroupDotOp dotOp,
 // `wait 0` appears.
 static void insertAsyncWarpGroupDotWaitInLoop(
     scf::ForOp forOp,
-    const llvm::MapVector<Operation *, int /*iterArgIdx*/> &properlyAsyncDots) {
+    const llvm::MapVector<Operation *, int /*iterArgIdx*/> &properlyAsyncDots,
+    int numIterationsInFlight) {
   if (properlyAsyncDots.empty())
     return;
 
@@ -1553,8 +1684,9 @@ static void insertAsyncWarpGroupDotWaitInLoop(
   }
 
   // Add the wait right after the last properly-async dot.  This only needs to
-  // wait for all properly-async dots from the i-1'th iteration to complete, IOW
-  // we wait until there are most `asyncDots.size()` dots in flight.
+  // wait for all properly-async dots from the i-numIterationsInFlight+1'th
+  // iteration to complete, IOW we wait until there are most
+  // `asyncDots.size() * (numIterationsInFlight - 1)` dots in flight.
   //
   // (You might want to put the wait at the end of the loop instead of right
   // after the last dot, but there could be a load into shmem between the last
@@ -1565,7 +1697,8 @@ static void insertAsyncWarpGroupDotWaitInLoop(
   builder.setInsertionPointAfter(lastAsyncDot);
   auto wait = builder.create<ttng::WarpGroupDotWaitOp>(
       lastAsyncDot->getLoc(),
-      /*inputs=*/ArrayRef<Value>{}, properlyAsyncDots.size());
+      /*inputs=*/ArrayRef<Value>{},
+      properlyAsyncDots.size() * (numIterationsInFlight - 1));
 
   // Thread the results of the async dots through the wait.
   SmallVector<Value> addlWaitOperands;
@@ -1575,14 +1708,151 @@ static void insertAsyncWarpGroupDotWaitInLoop(
   threadValuesThroughWait(wait, addlWaitOperands);
 }
 
+// If `dotOp` is an fp8 MMAv3 dot whose fp32 accumulator is carried by
+// `forOp`, returns the number of iterations whose products it may accumulate
+// in the precision of the tensor cores, when that is more than one but fewer
+// than all of them.
+static std::optional<int64_t>
+getNumImpreciseIterations(ttng::WarpGroupDotOp dotOp, scf::ForOp forOp) {
+  auto aTy = cast<TensorOrMemDesc>(dotOp.getA().getType());
+  Type aElemTy = aTy.getElementType();
+  if (!(aElemTy.isFloat8E5M2() || aElemTy.isFloat8E4M3FNUZ()) ||
+      !dotOp.getType().getElementType().isF32())
+    return std::nullopt;
+  // The products of an iteration are accumulated in fp32 by the lowering of
+  // the dot when they don't fit.
+  int64_t k = aTy.getShape().back();
+  int64_t maxNumImpreciseAcc = dotOp.getMaxNumImpreciseAcc();
+  if (maxNumImpreciseAcc <= k)
+    return std::nullopt;
+  // 2^30, the default of the NVIDIA backend, doesn't limit the accumulation.
+  if (maxNumImpreciseAcc >= (1 << 30))
+    return std::nullopt;
+  // Nothing to promote when the loop has no more iterations than a group.
+  int64_t numIterations = maxNumImpreciseAcc / k;
+  auto lb = getConstantIntValue(forOp.getLowerBound());
+  auto ub = getConstantIntValue(forOp.getUpperBound());
+  auto step = getConstantIntValue(forOp.getStep());
+  if (lb && ub && step && *step > 0 &&
+      (*ub - *lb + *step - 1) / *step <= numIterations)
+    return std::nullopt;
+
+  auto iterArg = dyn_cast<BlockArgument>(dotOp.getC());
+  if (!iterArg || iterArg.getOwner() != forOp.getBody() ||
+      iterArg == forOp.getInductionVar() || !iterArg.hasOneUse() ||
+      !dotOp->hasOneUse())
+    return std::nullopt;
+  OpOperand &use = *dotOp->getUses().begin();
+  if (use.getOwner() != forOp.getBody()->getTerminator() ||
+      forOp.getRegionIterArg(use.getOperandNumber()) != iterArg)
+    return std::nullopt;
+  return numIterations;
+}
+
+// Accumulates the products of the fp8 MMAv3 dots of the loop into a partial
+// accumulator, added to the fp32 accumulator every maxNumImpreciseAcc / K
+// iterations:
+//
+//   scf.for ... iter_args(%acc = %init, %partial = %zero) {
+//     %dot = warp_group_dot %a, %b, %partial
+//     %acc', %partial' = scf.if (the last iteration of the group) {
+//       scf.yield (%acc + %dot), %zero
+//     } else {
+//       scf.yield %acc, %dot
+//     }
+//     scf.yield %acc', %partial'
+//   }
+//   %result = %acc + %partial
+//
+// As the partial accumulator is only used by the dot and under the `if`, the
+// dot stays properly async, and only the iterations that promote it wait for
+// the dot to complete.
+void triton::promoteImpreciseAccumulators(scf::ForOp &forOp) {
+  SmallVector<std::pair<ttng::WarpGroupDotOp, int64_t>> dots;
+  for (auto dotOp : forOp.getBody()->getOps<ttng::WarpGroupDotOp>())
+    if (auto numIterations = getNumImpreciseIterations(dotOp, forOp))
+      dots.push_back({dotOp, *numIterations});
+  if (dots.empty())
+    return;
+
+  IRRewriter builder(forOp.getContext());
+  builder.setInsertionPoint(forOp);
+  SmallVector<Value> zeros;
+  for (auto [dotOp, numIterations] : dots) {
+    auto accTy = dotOp.getType();
+    zeros.push_back(builder.create<arith::ConstantOp>(
+        dotOp.getLoc(), accTy, builder.getZeroAttr(accTy)));
+  }
+  unsigned numIterArgs = forOp.getNumRegionIterArgs();
+  scf::ForOp newForOp = replaceForOpWithNewSignature(builder, forOp, zeros);
+  forOp.erase();
+  forOp = newForOp;
+
+  // The index of the iteration within its group of iterations.
+  Location loc = forOp.getLoc();
+  builder.setInsertionPointToStart(forOp.getBody());
+  Value iv = forOp.getInductionVar();
+  Value index = builder.create<arith::DivSIOp>(
+      loc, builder.create<arith::SubIOp>(loc, iv, forOp.getLowerBound()),
+      forOp.getStep());
+
+  auto yieldOp = cast<scf::YieldOp>(forOp.getBody()->getTerminator());
+  SmallVector<Value> yieldOperands(yieldOp.getOperands());
+  SmallVector<std::pair<unsigned, unsigned>> resultIdxs;
+  for (auto [i, dot] : llvm::enumerate(dots)) {
+    ttng::WarpGroupDotOp dotOp = dot.first;
+    unsigned accIdx = cast<BlockArgument>(dotOp.getC()).getArgNumber() - 1;
+    unsigned partialIdx = numIterArgs + i;
+    Value acc = forOp.getRegionIterArg(accIdx);
+    dotOp.getCMutable().assign(forOp.getRegionIterArg(partialIdx));
+
+    Location dotLoc = dotOp.getLoc();
+    builder.setInsertionPointAfter(dotOp);
+    Type ivTy = iv.getType();
+    Value numIterations = builder.create<arith::ConstantOp>(
+        dotLoc, builder.getIntegerAttr(ivTy, dot.second));
+    Value lastInGroup = builder.create<arith::ConstantOp>(
+        dotLoc, builder.getIntegerAttr(ivTy, dot.second - 1));
+    Value promote = builder.create<arith::CmpIOp>(
+        dotLoc, arith::CmpIPredicate::eq,
+        builder.create<arith::RemSIOp>(dotLoc, index, numIterations),
+        lastInGroup);
+    auto ifOp = builder.create<scf::IfOp>(
+        dotLoc, TypeRange{dotOp.getType(), dotOp.getType()}, promote,
+        /*withElseRegion=*/true);
+    builder.setInsertionPointToStart(ifOp.thenBlock());
+    Value sum = builder.create<arith::AddFOp>(dotLoc, acc, dotOp.getResult());
+    builder.create<scf::YieldOp>(dotLoc, ValueRange{sum, zeros[i]});
+    builder.setInsertionPointToStart(ifOp.elseBlock());
+    builder.create<scf::YieldOp>(dotLoc, ValueRange{acc, dotOp.getResult()});
+
+    yieldOperands[accIdx] = ifOp.getResult(0);
+    yieldOperands.push_back(ifOp.getResult(1));
+    resultIdxs.push_back({accIdx, partialIdx});
+  }
+  builder.setInsertionPoint(yieldOp);
+  builder.create<scf::YieldOp>(yieldOp.getLoc(), yieldOperands);
+  yieldOp.erase();
+
+  // Add the products of the last group of iterations.
+  builder.setInsertionPointAfter(forOp);
+  for (auto [accIdx, partialIdx] : resultIdxs) {
+    Value result = forOp.getResult(accIdx);
+    Value sum = builder.create<arith::AddFOp>(loc, result,
+                                              forOp.getResult(partialIdx));
+    result.replaceAllUsesExcept(sum, sum.getDefiningOp());
+  }
+}
+
 // Convert MMAv3 ttng::WarpGroupDotOps {isAsync = False} (i.e. Hopper wgmma)
 // into ttng::WarpGroupDotOps {isAsync = True} and insert
 // ttng::WarpGroupDotWaitOps as necessary.
 //
-// We assume we have space for each dot to be pipelined to depth 2, i.e. each
-// dot op in the loop can have at most 2 warp_group_dot ops in flight at once.
-// (Each warp_group_dot op usually corresponds to a series of wgmma.async ops.)
-void triton::asyncLaunchDots(scf::ForOp forOp) {
+// We assume we have space for each dot to be pipelined to depth
+// numIterationsInFlight, i.e. each dot op in the loop can have at most
+// numIterationsInFlight warp_group_dot ops in flight at once.  (Each
+// warp_group_dot op usually corresponds to a series of wgmma.async ops.)
+void triton::asyncLaunchDots(scf::ForOp forOp, int numIterationsInFlight) {
   LDBG("Original loop:\n" << *forOp);
 
   // First, change every MMAv3 ttng.warp_group_dot {isAsync=false}
@@ -1618,11 +1888,12 @@ void triton::asyncLaunchDots(scf::ForOp forOp) {
     return;
   }
 
-  // Next, insert a wait inside the loop.  We pipeline to depth 2, so the third
-  // iteration's set of asynchronous dots (and their corresponding async copies
-  // from global to shmem) can't start until the first iteration's set has
-  // completed.
-  insertAsyncWarpGroupDotWaitInLoop(forOp, properlyAsyncDots);
+  // Next, insert a wait inside the loop.  We pipeline to depth
+  // numIterationsInFlight, so the set of asynchronous dots of iteration
+  // i+numIterationsInFlight (and their corresponding async copies from global
+  // to shmem) can't start until iteration i's set has completed.
+  insertAsyncWarpGroupDotWaitInLoop(forOp, properlyAsyncDots,
+                                    numIterationsInFlight);
 
   // Finally, insert a wait after the loop, waiting for dots from the final
   // iteration of the loop.
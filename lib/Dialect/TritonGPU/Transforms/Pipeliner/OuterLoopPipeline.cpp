@@ -7,47 +7,42 @@ using namespace mlir;
 namespace tt = mlir::triton;
 namespace ttg = mlir::triton::gpu;
 
-// create the schedule for a matmul loop. This is ad hoc based on how we know
-// matmul loops should be pipelined and is not a generic scheduler.
+// Create the schedule of an outer loop whose inner loops were pipelined: the
+// async copies of the prologues of the inner loops and their dependencies are
+// in stage 0, and the rest of the loop in stage 1. The copies of the next
+// iteration are issued after the inner loops of the current one, so that they
+// are in flight during its epilogue.
 static std::vector<std::pair<Operation *, unsigned>>
 createSchedule(scf::ForOp forOp, int numStages) {
   SmallVector<Operation *> insertOps;
+  Operation *lastLoop = nullptr;
   for (Operation &op : forOp.getBody()->without_terminator()) {
     if (isa<ttg::AsyncCopyGlobalToLocalOp, ttg::AsyncCommitGroupOp>(op))
       insertOps.emplace_back(&op);
+    if (isa<scf::ForOp>(op))
+      lastLoop = &op;
   }
   DenseSet<Operation *> insertAndDeps;
   for (Operation *op : insertOps) {
     tt::addDep(op, insertAndDeps, true);
   }
 
-  DenseSet<Operation *> epilogue;
-  bool foundLoop = false;
+  tt::CoarseSchedule schedule(numStages);
+  tt::CoarseSchedule::Cluster mainLoopCluster = schedule.clusters.newAtBack();
+  tt::CoarseSchedule::Cluster prefetchCluster = schedule.clusters.newAtBack();
+  tt::CoarseSchedule::Cluster epilogueCluster = schedule.clusters.newAtBack();
+  bool afterLastLoop = false;
   for (Operation &op : forOp.getBody()->without_terminator()) {
     if (insertAndDeps.count(&op))
-      continue;
-    if (isa<scf::ForOp>(op))
-      foundLoop = true;
-    if (isa<scf::ForOp, ttg::AsyncWaitOp>(op))
-      continue;
-    if (foundLoop)
-      epilogue.insert(&op);
+      schedule.insert(&op, 0, prefetchCluster);
+    else if (afterLastLoop && !isa<ttg::AsyncWaitOp>(op))
+      schedule.insert(&op, numStages - 1, epilogueCluster);
+    else
+      schedule.insert(&op, numStages - 1, mainLoopCluster);
+    if (&op == lastLoop)
+      afterLastLoop = true;
   }
-
-  std::vector<std::pair<Operation *, unsigned>> schedule;
-  // Schedule stage 1 first.
-  tt::addOps(forOp, 1, schedule, [&](Operation *op) {
-    return insertAndDeps.count(op) == 0 && epilogue.count(op) == 0;
-  });
-
-  // Then Schedule stage 0.
-  tt::addOps(forOp, 0, schedule,
-             [&](Operation *op) { return insertAndDeps.count(op); });
-
-  // Then schedule the epilogue in stage 1
-  tt::addOps(forOp, 1, schedule,
-             [&](Operation *op) { return epilogue.count(op); });
-  return schedule;
+  return schedule.createFinalSchedule(forOp);
 }
 
 // pre-process the loop by hosting allocations/deallocation out of the
@@ -88,7 +83,7 @@ static bool preCondition(scf::ForOp forOp) {
     if (isa<scf::ForOp>(op))
       numForOps++;
   }
-  if (insertOps.empty() || numForOps != 1)
+  if (insertOps.empty() || numForOps == 0)
     return false;
   DenseSet<Operation *> insertAndDeps;
   for (Operation *op : insertOps) {
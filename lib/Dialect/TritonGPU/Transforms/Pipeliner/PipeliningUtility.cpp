@@ -59,6 +59,16 @@ Operation *mlir::triton::predicateOp(RewriterBase &rewriter, Operation *op,
     loadOp.getMaskMutable().assign(mask);
     return op;
   }
+  if (auto prefetchOp = dyn_cast<tt::PrefetchOp>(op)) {
+    rewriter.setInsertionPoint(prefetchOp);
+    Value mask = getPredMask(rewriter, prefetchOp.getPtr().getType(),
+                             prefetchOp.getMask(), pred);
+    prefetchOp.getMaskMutable().assign(mask);
+    return op;
+  }
+  // TMA prefetches of boxes out of the bounds of the tensor are dropped.
+  if (isa<tt::ExperimentalDescriptorPrefetchOp>(op))
+    return op;
   if (auto copyOp = dyn_cast<ttng::AsyncTMACopyGlobalToLocalOp>(op)) {
     rewriter.setInsertionPoint(copyOp);
     Value mask = getPredMask(rewriter, copyOp.getPred().getType(),
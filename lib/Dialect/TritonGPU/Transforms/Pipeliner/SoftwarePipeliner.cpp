@@ -70,13 +70,17 @@ static void tryAndPipelineOuterLoop(scf::ForOp forOp) {
       mlir::triton::pipelineForLoop(rewriter, forOp, options);
 }
 
-static bool pipelineLoop(scf::ForOp forOp, int numStages) {
+static bool pipelineLoop(scf::ForOp forOp, int numStages,
+                         int numDotIterationsInFlight) {
   mlir::triton::PipeliningOption options;
   if (!preCondition(forOp))
     return false;
 
+  mlir::triton::promoteImpreciseAccumulators(forOp);
+
   bool foundSchedule = false;
-  foundSchedule = preProcessLoopAndGetSchedule(forOp, numStages, options);
+  foundSchedule = preProcessLoopAndGetSchedule(
+      forOp, numStages, numDotIterationsInFlight, options);
 
   // TODO: add more pipelines strategy.
   if (!foundSchedule)
@@ -89,7 +93,7 @@ static bool pipelineLoop(scf::ForOp forOp, int numStages) {
 
   if (failed(newForOp))
     return false;
-  mlir::triton::asyncLaunchDots(newForOp.value());
+  mlir::triton::asyncLaunchDots(newForOp.value(), numDotIterationsInFlight);
   return true;
 }
 
@@ -108,6 +112,16 @@ struct PipelinePass : public impl::TritonGPUPipelineBase<PipelinePass> {
   }
 
   void runOnOperation() override {
+    // While loops, e.g. with data-dependent exits, aren't expanded by the
+    // pipeline expander, their loads are prefetched an iteration ahead.
+    if (numStages > 1) {
+      SmallVector<scf::WhileOp> whileLoops;
+      getOperation()->walk(
+          [&](scf::WhileOp whileOp) { whileLoops.push_back(whileOp); });
+      for (scf::WhileOp whileOp : whileLoops)
+        mlir::triton::pipelineWhileLoop(whileOp);
+    }
+
     SmallVector<scf::ForOp> loops;
     getOperation()->walk([&](scf::ForOp forOp) {
       // Bail out for loops with num_stage <= 1.
@@ -122,7 +136,8 @@ struct PipelinePass : public impl::TritonGPUPipelineBase<PipelinePass> {
     for (scf::ForOp forOp : loops) {
       auto outerLoop = dyn_cast<scf::ForOp>(forOp->getParentOp());
       int loopNumStages = getNumStagesOrDefault(forOp);
-      bool pipelined = pipelineLoop(forOp, loopNumStages);
+      bool pipelined =
+          pipelineLoop(forOp, loopNumStages, numDotIterationsInFlight);
       if (pipelined && outerLoop && getNumStagesOrDefault(outerLoop) > 1)
         outerLoops.insert(outerLoop);
     }
@@ -7,14 +7,15 @@ namespace tt = mlir::triton;
 namespace ttg = mlir::triton::gpu;
 namespace ttng = mlir::triton::nvidia_gpu;
 
-static SmallVector<tt::ExperimentalDescriptorStoreOp>
-getTMAStores(scf::ForOp forOp) {
-  SmallVector<tt::ExperimentalDescriptorStoreOp> tmaStores;
+// Returns the descriptor stores and reductions of the loop.
+static SmallVector<Operation *> getTMAStores(scf::ForOp forOp) {
+  SmallVector<Operation *> tmaStores;
 
   // Do not use walk, as we don't want to walk into nested loops.
   std::function<void(Operation *)> collectTMAStores = [&](Operation *op) {
-    if (auto storeOp = dyn_cast<tt::ExperimentalDescriptorStoreOp>(op)) {
-      tmaStores.push_back(storeOp);
+    if (isa<tt::ExperimentalDescriptorStoreOp,
+            tt::ExperimentalDescriptorReduceOp>(op)) {
+      tmaStores.push_back(op);
     }
     for (Region &region : op->getRegions()) {
       for (Operation &op : region.getOps()) {
@@ -27,10 +28,16 @@ getTMAStores(scf::ForOp forOp) {
   return tmaStores;
 }
 
-static Value createAlloc(scf::ForOp &forOp,
-                         tt::ExperimentalDescriptorStoreOp storeOp) {
+// The value stored by a descriptor store or reduction.
+static Value getTMAStoreSrc(Operation *storeOp) {
+  if (auto reduceOp = dyn_cast<tt::ExperimentalDescriptorReduceOp>(storeOp))
+    return reduceOp.getSrc();
+  return cast<tt::ExperimentalDescriptorStoreOp>(storeOp).getSrc();
+}
+
+static Value createAlloc(scf::ForOp &forOp, Operation *storeOp) {
   OpBuilder builder(forOp);
-  auto ty = cast<RankedTensorType>(storeOp.getSrc().getType());
+  auto ty = cast<RankedTensorType>(getTMAStoreSrc(storeOp).getType());
   auto order = ttg::getOrder(ty.getEncoding());
   auto ctaLayout = ttg::getCTALayout(ty.getEncoding());
   Attribute encoding =
@@ -49,38 +56,44 @@ static Value createAlloc(scf::ForOp &forOp,
   return alloc;
 }
 
-static void createTMAAsyncCopy(scf::ForOp &forOp,
-                               tt::ExperimentalDescriptorStoreOp storeOp,
+static void createTMAAsyncCopy(scf::ForOp &forOp, Operation *storeOp,
                                Value alloc) {
   OpBuilder builder(storeOp);
-  auto loc = storeOp.getLoc();
-  auto ty = cast<RankedTensorType>(storeOp.getSrc().getType());
+  auto loc = storeOp->getLoc();
+  Value src = getTMAStoreSrc(storeOp);
+  auto ty = cast<RankedTensorType>(src.getType());
   auto order = ttg::getOrder(ty.getEncoding());
   auto ctaLayout = ttg::getCTALayout(ty.getEncoding());
 
   // Put wait before the local_store make the store truly async. We know
   // that we are the only user of the CopyLocalToGlobal.
   builder.create<ttng::TMAStoreWait>(loc, 0);
-  builder.create<ttg::LocalStoreOp>(loc, storeOp.getSrc(), alloc);
+  builder.create<ttg::LocalStoreOp>(loc, src, alloc);
   builder.create<ttng::FenceAsyncSharedOp>(loc, false);
-  builder.create<ttng::AsyncTMACopyLocalToGlobalOp>(
-      loc, storeOp.getDescPtr(), storeOp.getIndices(), alloc);
+  if (auto reduceOp = dyn_cast<tt::ExperimentalDescriptorReduceOp>(storeOp)) {
+    builder.create<ttng::AsyncTMAReduceOp>(loc, reduceOp.getKind(),
+                                           reduceOp.getDescPtr(),
+                                           reduceOp.getIndices(), alloc);
+  } else {
+    auto copyOp = cast<tt::ExperimentalDescriptorStoreOp>(storeOp);
+    builder.create<ttng::AsyncTMACopyLocalToGlobalOp>(
+        loc, copyOp.getDescPtr(), copyOp.getIndices(), alloc);
+  }
 
   storeOp->erase();
 }
 
 bool mlir::triton::pipelineTMAStores(scf::ForOp forOp) {
-  SmallVector<tt::ExperimentalDescriptorStoreOp> tmaStores =
-      getTMAStores(forOp);
+  SmallVector<Operation *> tmaStores = getTMAStores(forOp);
   if (tmaStores.empty())
     return false;
 
-  DenseMap<tt::ExperimentalDescriptorStoreOp, Value> storeToAlloc;
-  for (tt::ExperimentalDescriptorStoreOp op : tmaStores) {
+  DenseMap<Operation *, Value> storeToAlloc;
+  for (Operation *op : tmaStores) {
     storeToAlloc[op] = createAlloc(forOp, op);
   }
 
-  for (tt::ExperimentalDescriptorStoreOp op : tmaStores) {
+  for (Operation *op : tmaStores) {
     createTMAAsyncCopy(forOp, op, storeToAlloc[op]);
   }
 
@@ -0,0 +1,165 @@
+#include "mlir/IR/IRMapping.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/IR/Types.h"
+#include "triton/Dialect/TritonGPU/Transforms/Schedule.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Support/Debug.h"
+
+#define DEBUG_TYPE "triton-while-loop-pipeline"
+#define DBGS() (llvm::dbgs() << "[" DEBUG_TYPE "]: ")
+#define LDBG(X) LLVM_DEBUG(DBGS() << X << "\n")
+
+//===----------------------------------------------------------------------===//
+// This file pipelines `scf.while` loops, e.g. loops with data-dependent exits,
+// over two stages: the loads of the next iteration are issued at the end of
+// the current one, so that they are in flight while the loop condition is
+// evaluated and the current iteration completes. Whether there is a next
+// iteration is only known once its condition is evaluated, so the condition is
+// evaluated speculatively at the end of the iteration, and the loads are masked
+// by it.
+//===----------------------------------------------------------------------===//
+
+using namespace mlir;
+namespace tt = mlir::triton;
+
+// Return true if `op` or the ops nested in it may have effects other than
+// reading memory, or unknown effects.
+static bool mayHaveSideEffects(Operation *op) {
+  std::optional<SmallVector<MemoryEffects::EffectInstance>> effects =
+      getEffectsRecursively(op);
+  return !effects ||
+         llvm::any_of(*effects, [](const MemoryEffects::EffectInstance &e) {
+           return !isa<MemoryEffects::Read>(e.getEffect());
+         });
+}
+
+// Add to `slice` the ops of the body of the loop computing the operands of
+// `loadOp`. Return false if they can't be evaluated ahead of the load, e.g.
+// because they read memory.
+static bool getLoadSlice(tt::LoadOp loadOp, DenseSet<Operation *> &slice) {
+  Block *body = loadOp->getBlock();
+  DenseSet<Operation *> loadSlice;
+  SmallVector<Value> worklist(loadOp->getOperands());
+  while (!worklist.empty()) {
+    Operation *defOp = worklist.pop_back_val().getDefiningOp();
+    if (!defOp || defOp->getBlock() != body || !loadSlice.insert(defOp).second)
+      continue;
+    if (defOp->getNumRegions() != 0 || !isMemoryEffectFree(defOp))
+      return false;
+    llvm::append_range(worklist, defOp->getOperands());
+  }
+  slice.insert(loadSlice.begin(), loadSlice.end());
+  return true;
+}
+
+bool mlir::triton::pipelineWhileLoop(scf::WhileOp whileOp) {
+  Block *before = whileOp.getBeforeBody();
+  Block *after = whileOp.getAfterBody();
+  // The condition is evaluated again at the end of the after region, which
+  // must not change what it computes.
+  for (Operation &op : before->without_terminator()) {
+    if (op.getNumRegions() != 0 || mayHaveSideEffects(&op))
+      return false;
+  }
+
+  // Loads after ops that may write to memory would read what the previous
+  // iteration wrote before these ops run.
+  SmallVector<tt::LoadOp> loads;
+  DenseSet<Operation *> slice;
+  for (Operation &op : after->without_terminator()) {
+    auto loadOp = dyn_cast<tt::LoadOp>(op);
+    if (!loadOp) {
+      if (mayHaveSideEffects(&op))
+        break;
+      continue;
+    }
+    if (!isa<RankedTensorType>(loadOp.getType()) ||
+        tt::isTensorPointerType(loadOp.getPtr().getType()))
+      continue;
+    if (getLoadSlice(loadOp, slice))
+      loads.push_back(loadOp);
+  }
+  if (loads.empty())
+    return false;
+  LDBG("Prefetching " << loads.size() << " loads of " << whileOp);
+
+  Location loc = whileOp.getLoc();
+  OpBuilder builder(whileOp);
+  // Return the loads of the iteration of the loop whose before region gets
+  // `args`, masked off if the loop exits before the iteration.
+  auto prefetch = [&](ValueRange args) {
+    IRMapping mapping;
+    mapping.map(before->getArguments(), args);
+    for (Operation &op : before->without_terminator())
+      builder.clone(op, mapping);
+    scf::ConditionOp conditionOp = whileOp.getConditionOp();
+    Value condition = mapping.lookupOrDefault(conditionOp.getCondition());
+    for (auto [arg, value] :
+         llvm::zip(after->getArguments(), conditionOp.getArgs()))
+      mapping.map(arg, mapping.lookupOrDefault(value));
+    for (Operation &op : after->without_terminator()) {
+      if (slice.contains(&op))
+        builder.clone(op, mapping);
+    }
+    SmallVector<Value> values;
+    for (tt::LoadOp loadOp : loads) {
+      auto ptrType = cast<RankedTensorType>(loadOp.getPtr().getType());
+      auto maskType = RankedTensorType::get(
+          ptrType.getShape(), builder.getI1Type(), ptrType.getEncoding());
+      Value mask = builder.create<tt::SplatOp>(loc, maskType, condition);
+      if (Value loadMask = loadOp.getMask())
+        mask = builder.create<arith::AndIOp>(loc, mask,
+                                             mapping.lookupOrDefault(loadMask));
+      auto newLoad = cast<tt::LoadOp>(builder.clone(*loadOp, mapping));
+      newLoad.getMaskMutable().assign(mask);
+      values.push_back(newLoad);
+    }
+    return values;
+  };
+
+  // Prefetch the loads of the first iteration before the loop, and those of
+  // the next iteration at the end of each iteration.
+  SmallVector<Value> inits(whileOp.getInits());
+  llvm::append_range(inits, prefetch(whileOp.getInits()));
+  auto yieldOp = cast<scf::YieldOp>(after->getTerminator());
+  builder.setInsertionPoint(yieldOp);
+  SmallVector<Value> nextLoads = prefetch(yieldOp.getResults());
+  yieldOp.getResultsMutable().append(nextLoads);
+
+  // Pass the prefetched values from the before region to the after region.
+  SmallVector<Type> resultTypes(whileOp.getResultTypes());
+  for (tt::LoadOp loadOp : loads)
+    resultTypes.push_back(loadOp.getType());
+  builder.setInsertionPoint(whileOp);
+  auto newWhileOp = builder.create<scf::WhileOp>(loc, resultTypes, inits);
+  SmallVector<Type> beforeTypes;
+  for (Value init : inits)
+    beforeTypes.push_back(init.getType());
+  Block *newBefore = builder.createBlock(
+      &newWhileOp.getBefore(), {}, beforeTypes,
+      SmallVector<Location>(beforeTypes.size(), loc));
+  Block *newAfter = builder.createBlock(
+      &newWhileOp.getAfter(), {}, resultTypes,
+      SmallVector<Location>(resultTypes.size(), loc));
+  newBefore->getOperations().splice(newBefore->begin(),
+                                    before->getOperations());
+  newAfter->getOperations().splice(newAfter->begin(), after->getOperations());
+  for (auto [oldArg, newArg] :
+       llvm::zip(before->getArguments(), newBefore->getArguments()))
+    oldArg.replaceAllUsesWith(newArg);
+  for (auto [oldArg, newArg] :
+       llvm::zip(after->getArguments(), newAfter->getArguments()))
+    oldArg.replaceAllUsesWith(newArg);
+  newWhileOp.getConditionOp().getArgsMutable().append(
+      newBefore->getArguments().take_back(loads.size()));
+  for (auto [loadOp, prefetched] :
+       llvm::zip(loads, newAfter->getArguments().take_back(loads.size()))) {
+    loadOp.getResult().replaceAllUsesWith(prefetched);
+    loadOp.erase();
+  }
+  whileOp.replaceAllUsesWith(
+      newWhileOp.getResults().take_front(whileOp.getNumResults()));
+  whileOp.erase();
+  return true;
+}
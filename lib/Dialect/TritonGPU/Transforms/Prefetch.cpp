@@ -29,6 +29,7 @@
 #include "mlir/IR/IRMapping.h"
 #include "mlir/Support/LLVM.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "triton/Analysis/RegisterPressure.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
 
@@ -49,6 +50,10 @@ class Prefetcher {
   ///
   // TODO: add a hook to infer prefetchWidth
   unsigned prefetchWidth = 32;
+  /// kWidth of the dot operand encoding of the prefetched slices
+  unsigned prefetchKWidth = 4;
+  /// registers per thread left for the prefetched operands
+  unsigned registerBudget;
 
   /// dots to be prefetched
   SetVector<triton::DotOp> dots;
@@ -77,7 +82,8 @@ class Prefetcher {
 public:
   Prefetcher() = delete;
 
-  Prefetcher(scf::ForOp forOp) : forOp(forOp) {
+  Prefetcher(scf::ForOp forOp, unsigned registerBudget)
+      : forOp(forOp), registerBudget(registerBudget) {
     yieldOp = cast<scf::YieldOp>(forOp.getBody()->getTerminator());
   }
 
@@ -141,7 +147,7 @@ Value Prefetcher::generatePrefetch(Value v, unsigned opIdx, bool isPrologue,
       v, offsetsVal);
 
   auto dotOperandEnc = triton::gpu::DotOperandEncodingAttr::get(
-      builder.getContext(), opIdx, dotEncoding, prefetchWidth / 8);
+      builder.getContext(), opIdx, dotEncoding, prefetchKWidth);
   Value prefetchSlice = builder.create<triton::gpu::LocalLoadOp>(
       v.getLoc(), RankedTensorType::get(shape, elementType, dotOperandEnc),
       newSmem);
@@ -159,10 +165,11 @@ LogicalResult Prefetcher::initialize() {
   SmallVector<triton::DotOp> dotsInFor;
   for (Operation &op : *loop)
     if (auto dotOp = dyn_cast<triton::DotOp>(op)) {
-      // bail out if there exist non v2 dots.
-      auto dstEnc =
-          dyn_cast<NvidiaMmaEncodingAttr>(getEncoding(dotOp.getResult()));
-      if (!dstEnc || dstEnc.getVersionMajor() != 2)
+      // bail out if there exist dots other than mma v2 and mfma dots.
+      Attribute dstEnc = getEncoding(dotOp.getResult());
+      auto mmaEnc = dyn_cast<NvidiaMmaEncodingAttr>(dstEnc);
+      if (!isa<AMDMfmaEncodingAttr>(dstEnc) &&
+          (!mmaEnc || mmaEnc.getVersionMajor() != 2))
         return failure();
       dotsInFor.push_back(dotOp);
     }
@@ -235,9 +242,29 @@ LogicalResult Prefetcher::initialize() {
       prefetchWidth = 256 / elementWidth;
     else
       prefetchWidth = 8 * aKWidth;
+    prefetchKWidth = prefetchWidth / 8;
+    auto mfmaEnc = dyn_cast<AMDMfmaEncodingAttr>(dot.getType().getEncoding());
+    if (mfmaEnc) {
+      // The slices are loaded with the layout of the operands, and span whole
+      // mfma instructions along k, of at least 256 bits per row.
+      int64_t instrK = mfmaEnc.getMFMAInstrShapeForOperands(aKWidth, 0)[1];
+      prefetchWidth = llvm::alignTo(256 / elementWidth, instrK);
+      prefetchKWidth = aKWidth;
+    }
 
-    // Skip prefetching if kSize is less than prefetchWidth
-    if (kSize < prefetchWidth)
+    // Skip prefetching if kSize is less than prefetchWidth, or if the slices
+    // don't tile k
+    if (kSize < prefetchWidth || kSize % prefetchWidth != 0)
+      continue;
+    // Skip prefetching if keeping the prefetched operands live across the
+    // loop would make it spill.
+    auto aPrefetchType = RankedTensorType::get(
+        {aType.getShape()[0], prefetchWidth}, aType.getElementType(), aEnc);
+    auto bPrefetchType = RankedTensorType::get(
+        {prefetchWidth, bType.getShape()[1]}, bType.getElementType(), bEnc);
+    if (RegisterPressureAnalysis::getNumRegisters(aPrefetchType) +
+            RegisterPressureAnalysis::getNumRegisters(bPrefetchType) >
+        registerBudget)
       continue;
     auto aVals = getPrefetchSrc(dot.getA());
     auto bVals = getPrefetchSrc(dot.getB());
@@ -415,20 +442,28 @@ struct PrefetchPass : public impl::TritonGPUPrefetchBase<PrefetchPass> {
             .failed()) {
       signalPassFailure();
     }
-    getOperation()->walk([&](scf::ForOp forOp) {
-      Prefetcher prefetcher(forOp);
-
-      if (prefetcher.initialize().failed())
-        return;
-
-      prefetcher.emitPrologue();
-
-      scf::ForOp newForOp = prefetcher.createNewForOp();
-
-      // replace the original loop
-      for (unsigned i = 0; i < forOp->getNumResults(); ++i)
-        forOp->getResult(i).replaceAllUsesWith(newForOp->getResult(i));
-      forOp->erase();
+    getOperation()->walk([&](triton::FuncOp funcOp) {
+      unsigned registerLimit = RegisterPressureAnalysis::getRegisterLimit(
+          funcOp->getParentOfType<ModuleOp>());
+      RegisterPressureAnalysis registerPressure(funcOp);
+      funcOp->walk([&](scf::ForOp forOp) {
+        unsigned liveRegisters = registerPressure.getMaxLiveRegisters(forOp);
+        unsigned registerBudget =
+            registerLimit > liveRegisters ? registerLimit - liveRegisters : 0;
+        Prefetcher prefetcher(forOp, registerBudget);
+
+        if (prefetcher.initialize().failed())
+          return;
+
+        prefetcher.emitPrologue();
+
+        scf::ForOp newForOp = prefetcher.createNewForOp();
+
+        // replace the original loop
+        for (unsigned i = 0; i < forOp->getNumResults(); ++i)
+          forOp->getResult(i).replaceAllUsesWith(newForOp->getResult(i));
+        forOp->erase();
+      });
     });
   }
 };
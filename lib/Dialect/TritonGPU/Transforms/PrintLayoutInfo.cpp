@@ -0,0 +1,98 @@
+#include "mlir/Pass/Pass.h"
+#include "triton/Analysis/Allocation.h"
+#include "triton/Analysis/AxisInfo.h"
+#include "triton/Analysis/Utility.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/LinearLayoutConversions.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+#include "triton/Dialect/TritonGPU/Transforms/Utility.h"
+
+namespace mlir {
+namespace triton {
+namespace gpu {
+
+#define GEN_PASS_DEF_TRITONGPUPRINTLAYOUTINFO
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+namespace {
+
+void printBuffer(llvm::raw_ostream &os, Allocation *allocation,
+                 Allocation::BufferId bufferId, StringRef kind) {
+  if (bufferId == Allocation::InvalidBufferId)
+    return;
+  os << "\n  " << kind << " shared memory: offset = "
+     << allocation->getOffset(bufferId)
+     << ", size = " << allocation->getAllocatedSize(bufferId);
+}
+
+class TritonGPUPrintLayoutInfoPass
+    : public impl::TritonGPUPrintLayoutInfoBase<TritonGPUPrintLayoutInfoPass> {
+public:
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    ModuleAxisInfoAnalysis axisInfo(mod);
+    ModuleAllocation moduleAllocation(mod);
+    mod.walk([&](FuncOp funcOp) {
+      Allocation *allocation = moduleAllocation.getFuncData(funcOp);
+      funcOp.walk([&](Operation *op) {
+        std::string info;
+        llvm::raw_string_ostream os(info);
+        printResults(os, op, axisInfo);
+        if (allocation) {
+          printBuffer(os, allocation, allocation->getBufferId(op), "scratch");
+          for (Value result : op->getResults())
+            printBuffer(os, allocation, allocation->getBufferId(result),
+                        "result");
+        }
+        if (Value ptr = getMemAccessPtr(op)) {
+          if (auto ptrTy = dyn_cast<RankedTensorType>(ptr.getType())) {
+            // As in the lowering to LLVM on NVIDIA GPUs, where vectors have at
+            // most 128 bits.
+            unsigned vec =
+                std::min<unsigned>(128 / getPointeeBitWidth(ptrTy),
+                                   axisInfo.getPtrContiguity(ptr));
+            os << "\n  vector width: " << vec;
+          }
+        }
+        if (auto cvtOp = dyn_cast<ConvertLayoutOp>(op)) {
+          RankedTensorType srcTy = cvtOp.getSrc().getType();
+          RankedTensorType dstTy = cvtOp.getType();
+          StringRef kind = getWarpShuffleConversion(srcTy, dstTy)
+                               ? "warp shuffles"
+                           : cvtNeedsSharedMemory(srcTy, dstTy)
+                               ? "shared memory"
+                               : "registers";
+          os << "\n  conversion through " << kind
+             << ", per-thread cost = " << getConvertCost(cvtOp);
+        }
+        if (!info.empty())
+          op->emitRemark() << op->getName() << ":" << info;
+      });
+    });
+  }
+
+private:
+  void printResults(llvm::raw_ostream &os, Operation *op,
+                    ModuleAxisInfoAnalysis &axisInfo) {
+    for (OpResult result : op->getResults()) {
+      auto tensorTy = dyn_cast<RankedTensorType>(result.getType());
+      if (!tensorTy || !tensorTy.getEncoding() ||
+          isa<SharedEncodingAttr>(tensorTy.getEncoding()))
+        continue;
+      os << "\n  result #" << result.getResultNumber() << ":";
+      if (std::optional<LinearLayout> layout =
+              toLinearLayout(tensorTy.getShape(), tensorTy.getEncoding()))
+        os << "\n    layout:" << layout->toString();
+      if (AxisInfo *info = axisInfo.getAxisInfo(result)) {
+        os << "\n    axis info: ";
+        info->print(os);
+      }
+    }
+  }
+};
+
+} // namespace
+
+} // namespace gpu
+} // namespace triton
+} // namespace mlir
@@ -15,6 +15,7 @@
 #include "mlir/Transforms/RegionUtils.h"
 #include "triton/Analysis/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/LinearLayoutConversions.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
 #include "triton/Dialect/TritonGPU/Transforms/TritonGPUConversion.h"
 
@@ -25,6 +26,217 @@ namespace gpu {
 #define GEN_PASS_DEF_TRITONGPUREDUCEDATADUPLICATION
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
 
+namespace {
+
+// Shared memory is organized in 32 banks of 4 bytes.
+constexpr unsigned kNumSmemBanks = 32;
+constexpr unsigned kSmemBankBytes = 4;
+// Number of vectorized stores per thread sampled by the bank conflict model.
+constexpr unsigned kMaxSampledSmemAccesses = 16;
+// Number of rows and swizzled vectors of rows read by the dot operand that are
+// sampled by the bank conflict model.
+constexpr unsigned kMaxSampledRows = 32;
+constexpr unsigned kMaxSampledVecs = 8;
+
+// Returns the number of wavefronts serving the accesses of `accessBytes` bytes
+// at the byte `offsets`, one per lane.  A wavefront serves 128 bytes, so 8- and
+// 16-byte accesses are split in phases of 16 and 8 lanes.  Within a phase, the
+// number of wavefronts is the largest number of distinct 4-byte words that map
+// to the same bank.
+unsigned countSmemWavefronts(ArrayRef<unsigned> offsets, unsigned accessBytes) {
+  accessBytes = std::max(accessBytes, kSmemBankBytes);
+  unsigned lanesPerPhase =
+      std::max(kNumSmemBanks * kSmemBankBytes / accessBytes, 1u);
+  unsigned wavefronts = 0;
+  SmallVector<SmallVector<unsigned>> bankWords(kNumSmemBanks);
+  for (unsigned phase = 0; phase < offsets.size(); phase += lanesPerPhase) {
+    for (auto &words : bankWords)
+      words.clear();
+    for (unsigned offset : offsets.slice(
+             phase, std::min<size_t>(lanesPerPhase, offsets.size() - phase))) {
+      unsigned lastWord = (offset + accessBytes - 1) / kSmemBankBytes;
+      for (unsigned word = offset / kSmemBankBytes; word <= lastWord; ++word) {
+        auto &words = bankWords[word % kNumSmemBanks];
+        if (!llvm::is_contained(words, word))
+          words.push_back(word);
+      }
+    }
+    size_t phaseWavefronts = 1;
+    for (auto &words : bankWords)
+      phaseWavefronts = std::max(phaseWavefronts, words.size());
+    wavefronts += phaseWavefronts;
+  }
+  return wavefronts;
+}
+
+// Returns the offset, in elements, of (`row`, `col`) in a 2D buffer of
+// `numCols` columns laid out by `shared`, like
+// sharedToLinearLayoutNoLeadingOffset does.
+unsigned getSwizzledOffset(SharedEncodingAttr shared, unsigned row,
+                           unsigned col, unsigned numCols) {
+  unsigned phase = (row / shared.getPerPhase()) % shared.getMaxPhase();
+  return row * numCols + (col ^ ((phase * shared.getVec()) % numCols));
+}
+
+// Estimates the number of wavefronts warp 0 needs to store its elements of
+// `srcTy` to a 2D buffer laid out by `shared`, or returns std::nullopt if the
+// layout of `srcTy` can't be converted to a linear layout.
+std::optional<unsigned> estimateStoreWavefronts(RankedTensorType srcTy,
+                                                SharedEncodingAttr shared) {
+  std::optional<LinearLayout> ll =
+      toLinearLayout(srcTy.getShape(), srcTy.getEncoding());
+  if (!ll.has_value())
+    return std::nullopt;
+  MLIRContext *ctx = srcTy.getContext();
+  StringAttr kRegister = StringAttr::get(ctx, "register");
+  StringAttr kLane = StringAttr::get(ctx, "lane");
+  StringAttr kWarp = StringAttr::get(ctx, "warp");
+  StringAttr kBlock = StringAttr::get(ctx, "block");
+  StringAttr colDim = StringAttr::get(ctx, "dim" + Twine(shared.getOrder()[0]));
+  StringAttr rowDim = StringAttr::get(ctx, "dim" + Twine(shared.getOrder()[1]));
+  unsigned numCols = srcTy.getShape()[shared.getOrder()[0]];
+  unsigned elemBytes = srcTy.getElementTypeBitWidth() / 8;
+
+  auto getRowCol = [&](unsigned reg, unsigned lane) {
+    unsigned row = 0, col = 0;
+    for (auto [dim, coord] : ll->apply(
+             {{kRegister, reg}, {kLane, lane}, {kWarp, 0}, {kBlock, 0}})) {
+      if (dim == rowDim)
+        row = coord;
+      else if (dim == colDim)
+        col = coord;
+    }
+    return std::make_pair(row, col);
+  };
+
+  // The registers holding consecutive columns are stored together, up to the
+  // swizzled vectors and 16 bytes.
+  unsigned numRegs = ll->getInDimSize(kRegister);
+  unsigned maxVec = std::min(shared.getVec(), 16 / elemBytes);
+  auto first = getRowCol(0, 0);
+  unsigned vec = 1;
+  while (2 * vec <= std::min(numRegs, maxVec)) {
+    bool contiguous = true;
+    for (unsigned reg = vec; reg < 2 * vec; ++reg)
+      contiguous &= getRowCol(reg, 0) ==
+                    std::make_pair(first.first, first.second + reg);
+    if (!contiguous)
+      break;
+    vec *= 2;
+  }
+
+  unsigned wavefronts = 0;
+  unsigned numAccesses = std::min(numRegs / vec, kMaxSampledSmemAccesses);
+  for (unsigned access = 0; access < numAccesses; ++access) {
+    SmallVector<unsigned> offsets;
+    for (unsigned lane = 0; lane < ll->getInDimSize(kLane); ++lane) {
+      auto rowCol = getRowCol(access * vec, lane);
+      offsets.push_back(
+          getSwizzledOffset(shared, rowCol.first, rowCol.second, numCols) *
+          elemBytes);
+    }
+    wavefronts += countSmemWavefronts(offsets, vec * elemBytes);
+  }
+  return wavefronts;
+}
+
+// Estimates the number of wavefronts of the loads of the mma.sync operand from
+// a 2D buffer of `shape` laid out by `shared`.  Each load reads 8 consecutive
+// rows of the buffer at the same swizzled vector: with ldmatrix, each lane
+// gives the address of a whole row, and otherwise `lanesPerRow` lanes read
+// `laneElems` elements of each row.
+unsigned estimateLoadWavefronts(ArrayRef<int64_t> shape,
+                                SharedEncodingAttr shared, unsigned elemBytes,
+                                unsigned laneElems) {
+  unsigned numCols = shape[shared.getOrder()[0]];
+  unsigned numRows = shape[shared.getOrder()[1]];
+  unsigned vec = shared.getVec();
+  unsigned lanesPerRow = vec / laneElems;
+  unsigned wavefronts = 0;
+  for (unsigned row = 0; row < std::min(numRows, kMaxSampledRows); row += 8) {
+    for (unsigned col = 0; col < std::min(numCols, kMaxSampledVecs * vec);
+         col += vec) {
+      SmallVector<unsigned> offsets;
+      for (unsigned lane = 0; lane < 8 * lanesPerRow; ++lane) {
+        unsigned laneRow = (row + lane / lanesPerRow) % numRows;
+        unsigned laneCol = col + lane % lanesPerRow * laneElems;
+        offsets.push_back(
+            getSwizzledOffset(shared, laneRow, laneCol, numCols) * elemBytes);
+      }
+      wavefronts += countSmemWavefronts(offsets, laneElems * elemBytes);
+    }
+  }
+  return wavefronts;
+}
+
+// Returns the shared encoding through which `srcTy` is converted to the
+// mma.sync operand `dotOp`.  SharedEncodingAttr::get picks a swizzling without
+// conflicts for the loads of the operand, but the stores of the converted
+// layout, e.g. the blocked layout of dequantized weights, may conflict with it.
+// The swizzlings the loads support, which xor the phase of each row into its
+// vectors of `vec` elements and repeat every 8 rows, are thus compared by
+// their estimated conflicts for both the stores and the loads.
+SharedEncodingAttr getDotOperandSharedEncoding(RankedTensorType srcTy,
+                                              DotOperandEncodingAttr dotOp,
+                                              ArrayRef<unsigned> order) {
+  MLIRContext *ctx = srcTy.getContext();
+  CTALayoutAttr ctaLayout = getCTALayout(srcTy.getEncoding());
+  auto defaultShared =
+      SharedEncodingAttr::get(ctx, dotOp, srcTy.getShape(), order, ctaLayout,
+                              srcTy.getElementType());
+  auto mma = dyn_cast<NvidiaMmaEncodingAttr>(dotOp.getParent());
+  if (!mma || order.size() != 2 || getNumCTAs(srcTy.getEncoding()) != 1 ||
+      !srcTy.getElementType().isIntOrFloat() ||
+      srcTy.getElementTypeBitWidth() < 8)
+    return defaultShared;
+  bool isHopperRegA = mma.isHopper() && dotOp.getOpIdx() == 0;
+  if (!mma.isAmpere() && !isHopperRegA)
+    return defaultShared;
+
+  // Mirrors the choice of the loads in SharedToDotOperandMMAv2.
+  unsigned elemBytes = srcTy.getElementTypeBitWidth() / 8;
+  unsigned kWidth = isHopperRegA ? std::max(4 / elemBytes, 1u)
+                                 : dotOp.getKWidth();
+  unsigned kDim = dotOp.getOpIdx() == 0 ? 1 : 0;
+  bool needTrans = order[0] != kDim;
+  bool useLdmatrix = (elemBytes == 2 || !needTrans) && kWidth * elemBytes == 4;
+  // The transposed loads without ldmatrix read single elements of the columns.
+  if (needTrans && !useLdmatrix)
+    return defaultShared;
+  unsigned vec = defaultShared.getVec();
+  unsigned laneElems = useLdmatrix ? vec : kWidth;
+  unsigned numCols = srcTy.getShape()[order[0]];
+  if (vec % laneElems != 0 || numCols < vec)
+    return defaultShared;
+
+  auto estimate = [&](SharedEncodingAttr shared) -> std::optional<unsigned> {
+    std::optional<unsigned> stores = estimateStoreWavefronts(srcTy, shared);
+    if (!stores.has_value())
+      return std::nullopt;
+    return *stores + estimateLoadWavefronts(srcTy.getShape(), shared,
+                                            elemBytes, laneElems);
+  };
+  std::optional<unsigned> bestCost = estimate(defaultShared);
+  if (!bestCost.has_value())
+    return defaultShared;
+  SharedEncodingAttr best = defaultShared;
+  for (unsigned perPhase = 1; perPhase <= 8; perPhase *= 2) {
+    for (unsigned maxPhase = 1;
+         perPhase * maxPhase <= 8 && maxPhase * vec <= numCols; maxPhase *= 2) {
+      auto shared = SharedEncodingAttr::get(ctx, vec, perPhase, maxPhase,
+                                            order, ctaLayout);
+      unsigned cost = *estimate(shared);
+      if (cost < *bestCost) {
+        bestCost = cost;
+        best = shared;
+      }
+    }
+  }
+  return best;
+}
+
+} // namespace
+
 class TritonGPUReduceDataDuplicationPass
     : public impl::TritonGPUReduceDataDuplicationBase<
           TritonGPUReduceDataDuplicationPass> {
@@ -40,7 +252,7 @@ public:
         return;
       auto dstDotOp =
           dyn_cast<triton::gpu::DotOperandEncodingAttr>(dstType.getEncoding());
-      if (!dstDotOp)
+      if (!dstDotOp || isBlockedToDotShortcut(srcType, dstType))
         return;
       if (auto srcMmaEncoding =
               dyn_cast<triton::gpu::NvidiaMmaEncodingAttr>(srcEncoding)) {
@@ -74,9 +286,7 @@ public:
           triton::gpu::SharedMemorySpaceAttr::get(srcType.getContext());
       auto tmpType = triton::MemDescType::get(
           dstType.getShape(), dstType.getElementType(),
-          triton::gpu::SharedEncodingAttr::get(
-              mod.getContext(), dstDotOp, srcType.getShape(), sharedOrder,
-              triton::gpu::getCTALayout(srcEncoding), srcType.getElementType()),
+          getDotOperandSharedEncoding(srcType, dstDotOp, sharedOrder),
           sharedMemorySpace);
       auto tmp = builder.create<triton::gpu::LocalAllocOp>(
           cvtOp.getLoc(), tmpType, cvtOp.getSrc());
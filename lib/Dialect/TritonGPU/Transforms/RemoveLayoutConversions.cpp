@@ -8,12 +8,14 @@
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/IR/Verifier.h"
 #include "mlir/Interfaces/InferTypeOpInterface.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 #include "mlir/Transforms/Passes.h"
 #include "mlir/Transforms/RegionUtils.h"
+#include "triton/Analysis/RegisterPressure.h"
 #include "triton/Analysis/Utility.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
@@ -113,9 +115,18 @@ private:
   FuncOp funcOp;
 };
 
+// Per-thread cost, in instructions per element, of the work done when
+// rematerializing a value. These are in the units of getConvertCost.
+constexpr int64_t kRematLoadCost = 2;
+constexpr int64_t kRematOpCost = 1;
+// Upper bound on the per-thread cost of the ops duplicated by backward
+// rematerialization in one function, to bound code growth.
+constexpr int64_t kRematBudget = 4096;
+
 class LayoutRematerialization {
 public:
-  LayoutRematerialization(FuncOp F) : funcOp(F) {}
+  LayoutRematerialization(FuncOp F, int &numRewritesLeft)
+      : funcOp(F), numRewritesLeft(numRewritesLeft) {}
   // Map the original value to the remat'ed one.
   void addRematValue(Value old, Attribute encoding, Value newV);
   bool hasRematValue(Value value, Attribute encoding) {
@@ -139,6 +150,17 @@ public:
 
 private:
   void updateRematMapping(SmallVector<std::tuple<Value, Value>> &values);
+  // Returns whether one more slice may be rewritten, and counts it.
+  bool takeRewrite() {
+    if (numRewritesLeft == 0)
+      return false;
+    if (numRewritesLeft > 0)
+      --numRewritesLeft;
+    return true;
+  }
+  // Remaining per-thread cost of the ops that may be duplicated by backward
+  // rematerialization in this function.
+  int64_t rematBudget = kRematBudget;
   // Existing tuples of (value, layout) that needs to be updated when recreating
   // scf ops. This prevents keeping track of Values that have been delete when
   // rewriting slices.
@@ -148,6 +170,9 @@ private:
   // DenseMap<std::pair<Operation*, Attribute>, Operation*>
   SetVector<Operation *> opToDelete;
   FuncOp funcOp;
+  // Number of slices that may still be rewritten in the module, or -1 for no
+  // limit.
+  int &numRewritesLeft;
 };
 
 void LayoutRematerialization::addRematValue(Value old, Attribute encoding,
@@ -1009,6 +1034,47 @@ void LayoutRematerialization::rewriteSlice(SetVector<Value> &slice,
   rewriteSlice(slice, layout, convertOp, mapping);
 }
 
+// Returns the per-thread cost of the ops that rematerializing `slice` for
+// `convertOp` would duplicate.  An op stays alive in its old layout, and is
+// thus duplicated, if it has users outside of the slice other than
+// conversions (which get rematerialized as well), or if it feeds such an op.
+// All the other ops are moved to the new layout for free.
+int64_t getRematCost(const SetVector<Value> &slice, ConvertLayoutOp convertOp) {
+  DenseSet<Operation *> sliceOps;
+  for (Value v : slice)
+    if (Operation *op = v.getDefiningOp())
+      sliceOps.insert(op);
+  SmallVector<Operation *> queue;
+  for (Operation *op : sliceOps) {
+    if (llvm::any_of(op->getUsers(), [&](Operation *user) {
+          return user != convertOp && !sliceOps.contains(user) &&
+                 !isa<ConvertLayoutOp, scf::YieldOp, scf::ConditionOp>(user);
+        }))
+      queue.push_back(op);
+  }
+  DenseSet<Operation *> duplicatedOps(queue.begin(), queue.end());
+  while (!queue.empty()) {
+    Operation *op = queue.pop_back_val();
+    for (Value operand : op->getOperands()) {
+      Operation *def = operand.getDefiningOp();
+      if (def && sliceOps.contains(def) && duplicatedOps.insert(def).second)
+        queue.push_back(def);
+    }
+  }
+
+  int64_t cost = 0;
+  for (Operation *op : duplicatedOps) {
+    // Region ops are rewritten in place with extra results, not cloned.
+    if (op->getNumRegions() != 0)
+      continue;
+    int64_t opCost = isa<LoadOp>(op) ? kRematLoadCost : kRematOpCost;
+    for (Type resultTy : op->getResultTypes())
+      if (isa<RankedTensorType>(resultTy))
+        cost += opCost * getTotalElemsPerThread(resultTy);
+  }
+  return cost;
+}
+
 LogicalResult getRematerializableSlice(
     Value root, Attribute rootEncoding, SetVector<Value> &slice,
     DenseMap<Value, Attribute> &layout,
@@ -1080,12 +1146,28 @@ void LayoutRematerialization::backwardRematerialization(
     return;
   }
 
+  // 2. Check that recomputing the part of the slice that has other users is
+  // cheaper than the conversion and fits in the remaining budget.
+  int64_t convertCost = getConvertCost(convertOp);
+  int64_t rematCost = getRematCost(slice, convertOp);
+  LDBG("  remat cost = " << rematCost << " convert cost = " << convertCost
+                         << " budget = " << rematBudget);
+  if (rematCost > convertCost || rematCost > rematBudget) {
+    LDBG("  remat not profitable");
+    return;
+  }
+  if (!takeRewrite()) {
+    LDBG("  max rematerializations reached");
+    return;
+  }
+  rematBudget -= rematCost;
+
   LLVM_DEBUG({
     DBGS() << "  remat convert op " << convertOp << '\n';
     for (Value v : slice)
       DBGS() << "    " << v << '\n';
   });
-  // 2. Rewrite the slice.
+  // 3. Rewrite the slice.
   rewriteSlice(slice, layout, convertOp);
 }
 
@@ -1155,7 +1237,7 @@ void LayoutRematerialization::hoistConvertOnTopOfExtOrBroadcast(
   Attribute dstEncoding = layout[extOrBroadcatOp->getResult(0)];
   std::optional<Attribute> srcEncoding =
       inferSrcEncoding(extOrBroadcatOp, dstEncoding);
-  if (!srcEncoding)
+  if (!srcEncoding || !takeRewrite())
     return;
   // Move the convert before the ext op and rewrite the slice.
   OpBuilder builder(extOrBroadcatOp);
@@ -1180,22 +1262,128 @@ void LayoutRematerialization::hoistConvertOnTopOfExtOrBroadcast(
   rewriteSlice(slice, layout, convertOp, mapping);
 }
 
-void backwardRematerialization(ModuleOp module) {
-  module.walk([](FuncOp funcOp) {
-    LayoutRematerialization layoutRemat(funcOp);
+void backwardRematerialization(ModuleOp module, int &numRewritesLeft) {
+  module.walk([&](FuncOp funcOp) {
+    LayoutRematerialization layoutRemat(funcOp, numRewritesLeft);
     layoutRemat.backwardRematerialization();
     layoutRemat.cleanup();
   });
 }
 
-void hoistConvert(ModuleOp module) {
+void hoistConvert(ModuleOp module, int &numRewritesLeft) {
   SmallVector<ConvertLayoutOp> convertOps;
-  module.walk([](FuncOp funcOp) {
-    LayoutRematerialization layoutRemat(funcOp);
+  module.walk([&](FuncOp funcOp) {
+    LayoutRematerialization layoutRemat(funcOp, numRewritesLeft);
     layoutRemat.hoistConvertOnTopOfExtOrBroadcast();
     layoutRemat.cleanup();
   });
 }
+
+// Returns true if `forOp` runs at least once and doesn't write to memory, so
+// that the loads of its body that don't depend on the loop can be issued once
+// before it.
+bool canHoistLoads(scf::ForOp forOp) {
+  APInt lb, ub;
+  if (!matchPattern(forOp.getLowerBound(), m_ConstantInt(&lb)) ||
+      !matchPattern(forOp.getUpperBound(), m_ConstantInt(&ub)) ||
+      !lb.slt(ub))
+    return false;
+  std::optional<SmallVector<MemoryEffects::EffectInstance>> effects =
+      getEffectsRecursively(forOp);
+  return effects &&
+         llvm::none_of(*effects, [](const MemoryEffects::EffectInstance &e) {
+           return isa<MemoryEffects::Write>(e.getEffect());
+         });
+}
+
+// Hoist the converts of values that don't depend on the loop out of the loops,
+// along with the ops of the loop body computing their sources. The hoisted
+// values are live across the loop, so a convert is only hoisted if they fit in
+// the registers left by the loop.
+void hoistLoopInvariantConverts(ModuleOp module, int &numRewritesLeft) {
+  unsigned registerLimit = RegisterPressureAnalysis::getRegisterLimit(module);
+  module.walk([&](FuncOp funcOp) {
+    RegisterPressureAnalysis registerPressure(funcOp);
+    // Registers of the values hoisted out of or across each loop.
+    DenseMap<Operation *, unsigned> hoistedRegisters;
+    // Inner loops first, so that converts hoisted out of a loop may be hoisted
+    // out of the loops around it.
+    funcOp.walk([&](scf::ForOp forOp) {
+      Block *body = forOp.getBody();
+      std::optional<bool> mayHoistLoads;
+      DenseMap<Operation *, bool> hoistable;
+      std::function<bool(Operation *)> isHoistable = [&](Operation *op) {
+        auto it = hoistable.find(op);
+        if (it != hoistable.end())
+          return it->second;
+        bool result = op->getNumRegions() == 0;
+        if (result && !isPure(op)) {
+          if (isa<LoadOp>(op) && !mayHoistLoads)
+            mayHoistLoads = canHoistLoads(forOp);
+          result = isa<LoadOp>(op) && *mayHoistLoads;
+        }
+        for (Value operand : op->getOperands()) {
+          if (!result || forOp.isDefinedOutsideOfLoop(operand))
+            continue;
+          Operation *def = operand.getDefiningOp();
+          result = def && def->getBlock() == body && isHoistable(def);
+        }
+        return hoistable[op] = result;
+      };
+
+      SmallVector<ConvertLayoutOp> convertOps(body->getOps<ConvertLayoutOp>());
+      for (ConvertLayoutOp convertOp : convertOps) {
+        if (!isHoistable(convertOp))
+          continue;
+        // The ops of the body the convert depends on.
+        SetVector<Operation *> slice;
+        SmallVector<Operation *> worklist{convertOp};
+        while (!worklist.empty()) {
+          Operation *op = worklist.pop_back_val();
+          if (!slice.insert(op))
+            continue;
+          for (Value operand : op->getOperands()) {
+            if (!forOp.isDefinedOutsideOfLoop(operand))
+              worklist.push_back(operand.getDefiningOp());
+          }
+        }
+        // The converted value, and the values of the slice still used in the
+        // loop, become live across the loop.
+        unsigned numRegisters =
+            RegisterPressureAnalysis::getNumRegisters(convertOp.getType());
+        for (Operation *op : slice) {
+          if (op == convertOp.getOperation())
+            continue;
+          for (Value result : op->getResults()) {
+            if (llvm::any_of(result.getUsers(), [&](Operation *user) {
+                  return !slice.contains(user);
+                }))
+              numRegisters += RegisterPressureAnalysis::getNumRegisters(
+                  result.getType());
+          }
+        }
+        if (registerPressure.getMaxLiveRegisters(forOp) +
+                hoistedRegisters[forOp] + numRegisters >
+            registerLimit)
+          continue;
+        if (numRewritesLeft == 0)
+          return;
+        if (numRewritesLeft > 0)
+          --numRewritesLeft;
+        LDBG("Hoisting " << convertOp << " out of its loop");
+        SmallVector<Operation *> ops(slice.begin(), slice.end());
+        llvm::sort(ops, [](Operation *a, Operation *b) {
+          return a->isBeforeInBlock(b);
+        });
+        for (Operation *op : ops)
+          op->moveBefore(forOp);
+        for (Operation *loop = forOp; loop;
+             loop = loop->getParentOfType<scf::ForOp>())
+          hoistedRegisters[loop] += numRegisters;
+      }
+    });
+  });
+}
 } // namespace
 
 class TritonGPURemoveLayoutConversionsPass
@@ -1233,7 +1421,8 @@ public:
 
     // 2. For remaining convert ops, try to rematerialize the slice of producer
     // operation to avoid having to convert.
-    backwardRematerialization(m);
+    int numRewritesLeft = maxRematerializations;
+    backwardRematerialization(m, numRewritesLeft);
     LLVM_DEBUG({
       DBGS() << "Module after backward remat:\n";
       m.dump();
@@ -1241,13 +1430,20 @@ public:
 
     // 3. For remaining converts, try to hoist them above cast generating larger
     // size types in order to reduce the cost of the convert op.
-    hoistConvert(m);
+    hoistConvert(m, numRewritesLeft);
     LLVM_DEBUG({
       DBGS() << "Module after hoisting converts:\n";
       m.dump();
     });
 
-    // 4. Apply clean up patterns to remove remove dead convert and dead code
+    // 4. Hoist the converts of loop-invariant values out of the loops.
+    hoistLoopInvariantConverts(m, numRewritesLeft);
+    LLVM_DEBUG({
+      DBGS() << "Module after hoisting loop-invariant converts:\n";
+      m.dump();
+    });
+
+    // 5. Apply clean up patterns to remove remove dead convert and dead code
     // generated by the previous transformations.
     RewritePatternSet cleanUpPatterns2(context);
     populateForOpDeadArgumentElimination(cleanUpPatterns2);
@@ -7,6 +7,7 @@
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/IR/Verifier.h"
 #include "mlir/Interfaces/InferTypeOpInterface.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Support/LLVM.h"
@@ -16,9 +17,11 @@
 #include "mlir/Transforms/RegionUtils.h"
 #include "triton/Analysis/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/ListScheduler.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
 #include "triton/Dialect/TritonGPU/Transforms/TritonGPUConversion.h"
 #include "triton/Dialect/TritonGPU/Transforms/Utility.h"
+#include "triton/Tools/Sys/GetEnv.hpp"
 
 namespace mlir {
 namespace triton {
@@ -39,11 +42,35 @@ static bool willIncreaseRegisterPressure(Operation *op) {
   return false;
 }
 
+// Returns true if `load` can't read memory written by `store`, which holds if
+// the data of the arguments that the pointers of `load` are computed from is
+// constant, or if the pointers of the load and of the store are computed from
+// different arguments and either only from restrict (`tt.noalias`) ones.
+static bool isIndependentOf(triton::LoadOp load, triton::StoreOp store) {
+  DenseSet<unsigned> loadArgs, storeArgs;
+  if (!getPointerBaseArgs(load.getPtr(), loadArgs) ||
+      !getPointerBaseArgs(store.getPtr(), storeArgs))
+    return false;
+  auto funcOp = load->getParentOfType<FunctionOpInterface>();
+  auto allHaveAttr = [&](const DenseSet<unsigned> &args, StringRef name) {
+    return llvm::all_of(
+        args, [&](unsigned arg) { return bool(funcOp.getArgAttr(arg, name)); });
+  };
+  if (allHaveAttr(loadArgs, "tt.const"))
+    return true;
+  if (llvm::any_of(loadArgs,
+                   [&](unsigned arg) { return storeArgs.contains(arg); }))
+    return false;
+  return allHaveAttr(loadArgs, "tt.noalias") ||
+         allHaveAttr(storeArgs, "tt.noalias");
+}
+
 class TritonGPUReorderInstructionsPass
     : public impl::TritonGPUReorderInstructionsBase<
           TritonGPUReorderInstructionsPass> {
 public:
-  TritonGPUReorderInstructionsPass() = default;
+  using impl::TritonGPUReorderInstructionsBase<
+      TritonGPUReorderInstructionsPass>::TritonGPUReorderInstructionsBase;
 
   Operation *getFirstUse(Operation *op) {
     std::vector<Operation *> users;
@@ -60,6 +87,9 @@ public:
 
   void runOnOperation() override {
     ModuleOp m = getOperation();
+    // The fixed moves below refine the list schedule.
+    if (listScheduling || tools::getBoolEnv("TRITON_LIST_SCHEDULING"))
+      scheduleBlocks(m, SchedulingModel::get(m));
     mlir::DominanceInfo dom(m);
     // sink conversion after the last dealloc
     // before the first use ancestor in its block
@@ -131,6 +161,29 @@ public:
         return;
       moveAfter(op, AOp);
     });
+    // Hoist loads above the stores of their block that they don't depend on,
+    // so that their latency overlaps with the stores.
+    m.walk([&](triton::LoadOp op) {
+      if (op.getIsVolatile())
+        return;
+      Operation *target = nullptr;
+      for (Operation *prev = op->getPrevNode(); prev;
+           prev = prev->getPrevNode()) {
+        if (llvm::any_of(op->getOperands(), [&](Value operand) {
+              return operand.getDefiningOp() == prev;
+            }))
+          break;
+        if (auto store = dyn_cast<triton::StoreOp>(prev)) {
+          if (!isIndependentOf(op, store))
+            break;
+          target = prev;
+        } else if (!isMemoryEffectFree(prev)) {
+          break;
+        }
+      }
+      if (target)
+        op->moveBefore(target);
+    });
     return;
   }
 };
@@ -0,0 +1,163 @@
+#include "mlir/Analysis/Liveness.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/LLVM.h"
+#include "triton/Analysis/Allocation.h"
+#include "triton/Analysis/RegisterPressure.h"
+#include "triton/Dialect/Triton/IR/Utility.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+#include "llvm/ADT/SetVector.h"
+
+namespace mlir {
+namespace triton {
+namespace gpu {
+
+#define GEN_PASS_DEF_TRITONGPUSPILLTOSHAREDMEMORY
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+namespace {
+
+// As in the allocation of shared memory buffers.
+constexpr size_t kSpillAlignment = 8;
+
+// Returns the number of bytes of shared memory needed to spill `value`, or 0
+// if it is not worth or not possible to spill it.
+size_t getSpillSize(Value value) {
+  auto tensorTy = dyn_cast<RankedTensorType>(value.getType());
+  if (!tensorTy || tensorTy.getRank() > 2)
+    return 0;
+  // The layouts read back from shared memory by local_load without going
+  // through a dot operand conversion.
+  if (!isa<BlockedEncodingAttr, NvidiaMmaEncodingAttr>(tensorTy.getEncoding()))
+    return 0;
+  Type elemTy = tensorTy.getElementType();
+  if (!elemTy.isIntOrFloat() || elemTy.getIntOrFloatBitWidth() < 8)
+    return 0;
+  // Values that are cheaper to recompute than to reload, or that were just
+  // loaded from shared memory.
+  Operation *def = value.getDefiningOp();
+  if (!def || isa<SplatOp, MakeRangeOp, LocalLoadOp>(def) ||
+      matchPattern(value, m_Constant()))
+    return 0;
+  size_t bytes = product<int64_t>(tensorTy.getShape()) *
+                 elemTy.getIntOrFloatBitWidth() / 8;
+  return llvm::alignTo(bytes, kSpillAlignment);
+}
+
+// Returns the values held in registers across `op`, i.e. those live across it
+// or across one of the ops it is nested in, except the operands of `op`.
+SetVector<Value> getValuesLiveAcross(Operation *op, Liveness &liveness) {
+  SetVector<Value> values;
+  for (Operation *ancestor = op; ancestor && ancestor->getBlock();
+       ancestor = ancestor->getParentOp()) {
+    const LivenessBlockInfo *info = liveness.getLiveness(ancestor->getBlock());
+    if (!info)
+      break;
+    for (Value v : info->currentlyLiveValues(ancestor))
+      if (v.getDefiningOp() != ancestor && !liveness.isDeadAfter(v, ancestor) &&
+          !llvm::is_contained(op->getOperands(), v))
+        values.insert(v);
+  }
+  return values;
+}
+
+// Stores `value` to a new shared memory buffer right after its definition, and
+// reloads it right before each of its users.
+void spill(Value value) {
+  auto tensorTy = cast<RankedTensorType>(value.getType());
+  MLIRContext *ctx = value.getContext();
+  Attribute layout = tensorTy.getEncoding();
+  // The threads read back the elements they wrote; no swizzling is needed to
+  // avoid bank conflicts.
+  auto encoding = SharedEncodingAttr::get(ctx, 1, 1, 1, getOrder(layout),
+                                          getCTALayout(layout));
+  auto memDescTy = MemDescType::get(
+      tensorTy.getShape(), tensorTy.getElementType(), encoding,
+      SharedMemorySpaceAttr::get(ctx), /*mutableMemory=*/true);
+
+  Operation *def = value.getDefiningOp();
+  OpBuilder builder(def->getContext());
+  builder.setInsertionPointAfter(def);
+  Value buffer = builder.create<LocalAllocOp>(value.getLoc(), memDescTy,
+                                              /*src=*/Value());
+  auto storeOp = builder.create<LocalStoreOp>(value.getLoc(), value, buffer);
+
+  SetVector<Operation *> users;
+  for (Operation *user : value.getUsers())
+    if (user != storeOp)
+      users.insert(user);
+  for (Operation *user : users) {
+    builder.setInsertionPoint(user);
+    Value reloaded =
+        builder.create<LocalLoadOp>(value.getLoc(), tensorTy, buffer);
+    user->replaceUsesOfWith(value, reloaded);
+  }
+}
+
+// Spills the largest values live across the operations of `funcOp` where the
+// register pressure exceeds `registerLimit`, one at a time, until it doesn't
+// or the values don't fit in the `budget` left in shared memory.
+void spillToSharedMemory(FuncOp funcOp, unsigned registerLimit,
+                         size_t &budget) {
+  DenseSet<Value> spilled;
+  while (true) {
+    RegisterPressureAnalysis pressure(funcOp);
+    if (pressure.getMaxLiveRegisters() <= registerLimit)
+      return;
+    Liveness liveness(funcOp);
+    Value best;
+    unsigned bestRegisters = 0;
+    funcOp.walk([&](Operation *op) {
+      if (pressure.getLiveRegisters(op) <= registerLimit)
+        return;
+      for (Value v : getValuesLiveAcross(op, liveness)) {
+        size_t size = getSpillSize(v);
+        if (size == 0 || size > budget || spilled.contains(v))
+          continue;
+        unsigned registers =
+            RegisterPressureAnalysis::getNumRegisters(v.getType());
+        if (registers > bestRegisters) {
+          best = v;
+          bestRegisters = registers;
+        }
+      }
+    });
+    if (!best)
+      return;
+    budget -= getSpillSize(best);
+    spill(best);
+    spilled.insert(best);
+  }
+}
+
+} // anonymous namespace
+
+class TritonGPUSpillToSharedMemoryPass
+    : public impl::TritonGPUSpillToSharedMemoryBase<
+          TritonGPUSpillToSharedMemoryPass> {
+public:
+  using impl::TritonGPUSpillToSharedMemoryBase<
+      TritonGPUSpillToSharedMemoryPass>::TritonGPUSpillToSharedMemoryBase;
+
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    unsigned registerLimit = RegisterPressureAnalysis::getRegisterLimit(mod);
+    if (estimateMaxLiveRegisters(mod) <= registerLimit)
+      return;
+    // The buffers spilled to are all counted as live at once, on top of the
+    // shared memory the kernel already needs.
+    ModuleAllocation allocation(mod);
+    size_t used = allocation.getSharedMemorySize();
+    if (sharedMemorySize <= 0 || used >= (size_t)sharedMemorySize)
+      return;
+    size_t budget = sharedMemorySize - used;
+    mod.walk([&](FuncOp funcOp) {
+      spillToSharedMemory(funcOp, registerLimit, budget);
+    });
+  }
+};
+
+} // namespace gpu
+} // namespace triton
+} // namespace mlir
@@ -503,6 +503,21 @@ bool isSingleValue(Value value) {
   return true;
 }
 
+int64_t getConvertCost(triton::gpu::ConvertLayoutOp convertOp) {
+  // Per-thread cost, in instructions per element, of each kind of conversion.
+  constexpr int64_t kSharedMemoryConvertCost = 4;
+  constexpr int64_t kWarpShuffleConvertCost = 1;
+  RankedTensorType srcTy = convertOp.getSrc().getType();
+  RankedTensorType dstTy = convertOp.getType();
+  if (getWarpShuffleConversion(srcTy, dstTy).has_value())
+    return kWarpShuffleConvertCost * triton::gpu::getTotalElemsPerThread(dstTy);
+  if (!cvtNeedsSharedMemory(srcTy, dstTy))
+    return 0;
+  return kSharedMemoryConvertCost *
+         (triton::gpu::getTotalElemsPerThread(srcTy) +
+          triton::gpu::getTotalElemsPerThread(dstTy));
+}
+
 bool isExpensiveLoadOrStore(Operation *op) {
   // Case 1: Pointer of tensor is always expensive
   auto operandType = op->getOperand(0).getType();
@@ -46,6 +46,26 @@ using namespace mlir::triton::nvidia_gpu;
 
 //===----------------------------------------------------------------------===//
 
+namespace mlir {
+namespace triton {
+namespace nvidia_gpu {
+
+triton::gpu::BlockedEncodingAttr
+getTmemCompatibleLayout(MLIRContext *ctx, ArrayRef<int64_t> shape,
+                        int numWarps, triton::gpu::CTALayoutAttr ctaLayout) {
+  assert(shape.size() == 2 && shape[0] == 128 && numWarps % 4 == 0 &&
+         "unsupported shape for tensor memory");
+  unsigned colGroups = numWarps / 4;
+  unsigned colsPerThread = std::max<unsigned>(shape[1] / colGroups, 1);
+  return triton::gpu::BlockedEncodingAttr::get(
+      ctx, /*sizePerThread=*/{1, colsPerThread}, /*threadsPerWarp=*/{32, 1},
+      /*warpsPerCTA=*/{4, colGroups}, /*order=*/{0, 1}, ctaLayout);
+}
+
+} // namespace nvidia_gpu
+} // namespace triton
+} // namespace mlir
+
 void TritonNvidiaGPUDialect::initialize() {
   registerTypes();
 
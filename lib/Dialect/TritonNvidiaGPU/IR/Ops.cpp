@@ -24,6 +24,7 @@
 #include "mlir/IR/Builders.h"
 #include "mlir/Support/LLVM.h"
 #include "triton/Dialect/TritonNvidiaGPU/IR/Dialect.h"
+#include "llvm/Support/MathExtras.h"
 
 #define GET_OP_CLASSES
 #include "triton/Dialect/TritonNvidiaGPU/IR/Ops.cpp.inc"
@@ -149,12 +150,57 @@ void WaitBarrierOp::getEffects(
                        mlir::SideEffects::DefaultResource::get());
 }
 
+// -- ArriveBarrierOp --
+LogicalResult ArriveBarrierOp::verify() {
+  if (failed(verifyBarrierType(*this, getAlloc().getType())))
+    return failure();
+  if (getCount() < 1)
+    return emitOpError("arrive count must be positive");
+  return success();
+}
+
+void ArriveBarrierOp::getEffects(
+    SmallVectorImpl<SideEffects::EffectInstance<MemoryEffects::Effect>>
+        &effects) {
+  effects.emplace_back(MemoryEffects::Write::get(), getAlloc(),
+                       mlir::triton::gpu::SharedMemory::get());
+}
+
+// -- RegAllocOp / RegDeallocOp --
+static LogicalResult verifyRegCount(Operation *op, uint32_t regCount) {
+  // setmaxnreg only accepts multiples of 8 in [24, 256].
+  if (regCount < 24 || regCount > 256 || regCount % 8 != 0)
+    return op->emitOpError(
+        "register count must be a multiple of 8 in the range [24, 256]");
+  return success();
+}
+
+LogicalResult RegAllocOp::verify() {
+  return verifyRegCount(*this, getRegCount());
+}
+
+LogicalResult RegDeallocOp::verify() {
+  return verifyRegCount(*this, getRegCount());
+}
+
 // -- AsyncTMACopyGlobalToLocalOp --
 LogicalResult AsyncTMACopyGlobalToLocalOp::verify() {
   if (failed(verifyBarrierType(*this, getBarrier().getType())))
     return failure();
   if (getCoord().size() < 1 || getCoord().size() > 5)
     return emitOpError("TMA copies must have between 1 and 5 coordinates");
+  if (getIm2colOffsets().empty())
+    return success();
+  if (getCoord().size() < 3)
+    return emitOpError("im2col TMA copies must have at least 3 coordinates");
+  if (getIm2colOffsets().size() != getCoord().size() - 2)
+    return emitOpError("im2col TMA copies must have an offset per spatial "
+                       "dimension");
+  MemDescType resultTy = getResult().getType();
+  if (resultTy.getShape().size() != 2)
+    return emitOpError("im2col TMA copies must copy to a 2D buffer");
+  if (triton::gpu::getNumCTAs(resultTy.getEncoding()) != 1)
+    return emitOpError("im2col TMA copies don't support multicast");
   return success();
 }
 
@@ -179,6 +225,163 @@ void AsyncTMACopyLocalToGlobalOp::getEffects(
                        mlir::triton::gpu::SharedMemory::get());
 }
 
+// -- AsyncTMAReduceOp --
+void AsyncTMAReduceOp::getEffects(
+    SmallVectorImpl<SideEffects::EffectInstance<MemoryEffects::Effect>>
+        &effects) {
+  effects.emplace_back(MemoryEffects::Read::get(), getDescPtr(),
+                       mlir::triton::GlobalMemory::get());
+  effects.emplace_back(MemoryEffects::Write::get(), getDescPtr(),
+                       mlir::triton::GlobalMemory::get());
+  effects.emplace_back(MemoryEffects::Read::get(), getSrc(),
+                       mlir::triton::gpu::SharedMemory::get());
+}
+
+// -- Tensor memory ops --
+static bool isTensorMemory(MemDescType type) {
+  return isa_and_nonnull<TensorMemorySpaceAttr>(type.getMemorySpace());
+}
+
+static LogicalResult verifyTmemRegisterType(Operation *op,
+                                            RankedTensorType type) {
+  Type elemTy = type.getElementType();
+  if (!(elemTy.isF32() || elemTy.isInteger(32)) || type.getRank() != 2 ||
+      type.getShape()[0] != 128)
+    return op->emitOpError(
+        "only 128xN f32 or i32 tensors are supported in tensor memory");
+  auto mod = op->getParentOfType<ModuleOp>();
+  if (!mod)
+    return success();
+  int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
+  if (numWarps % 4 != 0)
+    return op->emitOpError("tensor memory accesses need a multiple of 4 warps");
+  auto layout =
+      getTmemCompatibleLayout(op->getContext(), type.getShape(), numWarps,
+                              triton::gpu::getCTALayout(type.getEncoding()));
+  if (type.getEncoding() != layout)
+    return op->emitOpError("tensor must have the layout ") << layout;
+  return success();
+}
+
+LogicalResult TMEMAllocOp::verify() {
+  if (!isTensorMemory(getType()))
+    return emitOpError("result must be in tensor memory");
+  if (getSrc() && failed(verifyTmemRegisterType(*this, getSrc().getType())))
+    return failure();
+  return success();
+}
+
+void TMEMAllocOp::getEffects(
+    SmallVectorImpl<SideEffects::EffectInstance<MemoryEffects::Effect>>
+        &effects) {
+  effects.emplace_back(MemoryEffects::Allocate::get(), getResult(),
+                       TensorMemory::get());
+  if (getSrc())
+    effects.emplace_back(MemoryEffects::Write::get(), getResult(),
+                         TensorMemory::get());
+}
+
+LogicalResult TMEMLoadOp::verify() {
+  if (!isTensorMemory(getSrc().getType()))
+    return emitOpError("source must be in tensor memory");
+  return verifyTmemRegisterType(*this, getType());
+}
+
+void TMEMLoadOp::getEffects(
+    SmallVectorImpl<SideEffects::EffectInstance<MemoryEffects::Effect>>
+        &effects) {
+  effects.emplace_back(MemoryEffects::Read::get(), getSrc(),
+                       TensorMemory::get());
+}
+
+LogicalResult TMEMStoreOp::verify() {
+  if (!isTensorMemory(getDst().getType()))
+    return emitOpError("destination must be in tensor memory");
+  return verifyTmemRegisterType(*this, getSrc().getType());
+}
+
+void TMEMStoreOp::getEffects(
+    SmallVectorImpl<SideEffects::EffectInstance<MemoryEffects::Effect>>
+        &effects) {
+  effects.emplace_back(MemoryEffects::Write::get(), getDst(),
+                       TensorMemory::get());
+}
+
+static LogicalResult verifyNumTmemCols(Operation *op, uint32_t numCols) {
+  if (numCols < 32 || numCols > 512 || !llvm::isPowerOf2_32(numCols))
+    return op->emitOpError(
+        "number of columns must be a power of 2 between 32 and 512");
+  return success();
+}
+
+LogicalResult TMEMAllocateColumnsOp::verify() {
+  auto slotType = getSlot().getType();
+  if (!slotType.getElementType().isInteger(32) ||
+      slotType.getShape() != ArrayRef<int64_t>({1}))
+    return emitOpError("slot must be a descriptor of 1xi32 type");
+  return verifyNumTmemCols(*this, getNumCols());
+}
+
+void TMEMAllocateColumnsOp::getEffects(
+    SmallVectorImpl<SideEffects::EffectInstance<MemoryEffects::Effect>>
+        &effects) {
+  effects.emplace_back(MemoryEffects::Write::get(), getSlot(),
+                       mlir::triton::gpu::SharedMemory::get());
+  effects.emplace_back(MemoryEffects::Allocate::get(), TensorMemory::get());
+}
+
+LogicalResult TMEMDeallocateColumnsOp::verify() {
+  return verifyNumTmemCols(*this, getNumCols());
+}
+
+void TMEMDeallocateColumnsOp::getEffects(
+    SmallVectorImpl<SideEffects::EffectInstance<MemoryEffects::Effect>>
+        &effects) {
+  effects.emplace_back(MemoryEffects::Free::get(), TensorMemory::get());
+}
+
+// -- TCGen5MMAOp --
+LogicalResult TCGen5MMAOp::verify() {
+  if (failed(verifyBarrierType(*this, getBarrier().getType())))
+    return failure();
+  if (!isTensorMemory(getD().getType()))
+    return emitOpError("accumulator must be in tensor memory");
+  auto aType = getA().getType();
+  auto bType = getB().getType();
+  if (!isa<triton::gpu::SharedEncodingAttr>(aType.getEncoding()) ||
+      !isa<triton::gpu::SharedEncodingAttr>(bType.getEncoding()))
+    return emitOpError("operands must be in shared memory");
+  Type elemTy = aType.getElementType();
+  if (elemTy != bType.getElementType() ||
+      !(elemTy.isF16() || elemTy.isBF16() || elemTy.isInteger(8)))
+    return emitOpError("operands must both be f16, bf16 or i8");
+  Type accElemTy = getD().getType().getElementType();
+  if (elemTy.isInteger(8) != accElemTy.isInteger(32))
+    return emitOpError("i8 operands accumulate in i32, and the others in f32");
+  auto dShape = getD().getType().getShape();
+  if (aType.getShape()[0] != dShape[0] || bType.getShape()[1] != dShape[1] ||
+      aType.getShape()[1] != bType.getShape()[0])
+    return emitOpError("incompatible operand shapes");
+  if (dShape[0] != 128 || dShape[1] % 16 != 0 || dShape[1] > 256)
+    return emitOpError("accumulator must be 128xN with N a multiple of 16 "
+                       "up to 256");
+  return success();
+}
+
+void TCGen5MMAOp::getEffects(
+    SmallVectorImpl<SideEffects::EffectInstance<MemoryEffects::Effect>>
+        &effects) {
+  effects.emplace_back(MemoryEffects::Read::get(), getA(),
+                       mlir::triton::gpu::SharedMemory::get());
+  effects.emplace_back(MemoryEffects::Read::get(), getB(),
+                       mlir::triton::gpu::SharedMemory::get());
+  effects.emplace_back(MemoryEffects::Read::get(), getD(), TensorMemory::get());
+  effects.emplace_back(MemoryEffects::Write::get(), getD(),
+                       TensorMemory::get());
+  effects.emplace_back(MemoryEffects::Write::get(), getBarrier(),
+                       mlir::triton::gpu::SharedMemory::get());
+}
+
 } // namespace nvidia_gpu
 } // namespace triton
 } // namespace mlir
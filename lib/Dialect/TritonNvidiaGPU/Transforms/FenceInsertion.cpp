@@ -25,6 +25,82 @@ using ::mlir::triton::gpu::SharedEncodingAttr;
 
 namespace {
 
+// Adds to `allocs` the allocations that the shared memory descriptor `v` may
+// be a view of. Returns false if some of them are unknown.
+bool getUnderlyingAllocs(Value v, SetVector<Value> &allocs,
+                         DenseSet<Value> &visited) {
+  if (!visited.insert(v).second)
+    return true;
+  if (auto arg = dyn_cast<BlockArgument>(v)) {
+    auto forOp = dyn_cast<scf::ForOp>(arg.getOwner()->getParentOp());
+    if (!forOp || arg.getArgNumber() == 0)
+      return false;
+    return getUnderlyingAllocs(forOp.getTiedLoopInit(arg)->get(), allocs,
+                               visited) &&
+           getUnderlyingAllocs(forOp.getTiedLoopYieldedValue(arg)->get(),
+                               allocs, visited);
+  }
+  Operation *def = v.getDefiningOp();
+  if (isa<ttg::LocalAllocOp>(def)) {
+    allocs.insert(v);
+    return true;
+  }
+  if (isa<ttg::MemDescSubviewOp, tt::TransOp>(def))
+    return getUnderlyingAllocs(def->getOperand(0), allocs, visited);
+  unsigned resultNum = cast<OpResult>(v).getResultNumber();
+  if (auto forOp = dyn_cast<scf::ForOp>(def)) {
+    Operation *yieldOp = forOp.getBody()->getTerminator();
+    return getUnderlyingAllocs(forOp.getInitArgs()[resultNum], allocs,
+                               visited) &&
+           getUnderlyingAllocs(yieldOp->getOperand(resultNum), allocs,
+                               visited);
+  }
+  if (auto ifOp = dyn_cast<scf::IfOp>(def))
+    return getUnderlyingAllocs(ifOp.thenYield().getOperand(resultNum), allocs,
+                               visited) &&
+           getUnderlyingAllocs(ifOp.elseYield().getOperand(resultNum), allocs,
+                               visited);
+  return false;
+}
+
+// Adds to `writers` the ops writing to the allocation `alloc` through the
+// generic proxy, by following all the views of the allocation. Writes through
+// the async proxy, i.e. TMA copies, do not need a fence before an async
+// proxy read.
+void getGenericProxyWriters(Value alloc, SetVector<Operation *> &writers) {
+  if (cast<ttg::LocalAllocOp>(alloc.getDefiningOp()).getSrc())
+    writers.insert(alloc.getDefiningOp());
+  SmallVector<Value> worklist{alloc};
+  DenseSet<Value> visited{alloc};
+  auto push = [&](Value v) {
+    if (visited.insert(v).second)
+      worklist.push_back(v);
+  };
+  while (!worklist.empty()) {
+    Value v = worklist.pop_back_val();
+    for (OpOperand &use : v.getUses()) {
+      Operation *user = use.getOwner();
+      unsigned operandNum = use.getOperandNumber();
+      if (isa<ttg::LocalStoreOp>(user)) {
+        writers.insert(user);
+      } else if (isa<ttg::MemDescSubviewOp, tt::TransOp>(user)) {
+        push(user->getResult(0));
+      } else if (auto forOp = dyn_cast<scf::ForOp>(user)) {
+        if (operandNum < forOp.getNumControlOperands())
+          continue;
+        push(forOp.getTiedLoopRegionIterArg(&use));
+        push(forOp.getTiedLoopResult(&use));
+      } else if (auto yieldOp = dyn_cast<scf::YieldOp>(user)) {
+        Operation *parent = yieldOp->getParentOp();
+        if (auto forOp = dyn_cast<scf::ForOp>(parent))
+          push(forOp.getRegionIterArgs()[operandNum]);
+        if (isa<scf::ForOp, scf::IfOp>(parent))
+          push(parent->getResult(operandNum));
+      }
+    }
+  }
+}
+
 struct FenceInsertionPass
     : public TritonGPUFenceInsertionBase<FenceInsertionPass> {
 
@@ -33,102 +109,73 @@ public:
   FenceInsertionPass(int computeCapability) {
     this->computeCapability = computeCapability;
   }
-  // TODO: support more general patterns to insert fences. eg. any op(generic)
-  // to shared in use-def chain which refers by async proxy. We have generic(
-  // convertlayout with sts/stmatix) + fence + async(wgmma) up to now
+  // A fence is needed between the writes of a buffer through the generic
+  // proxy, e.g. a local_alloc or local_store of registers, and the reads of
+  // the buffer by wgmma or tcgen05.mma through the async proxy. The fence is
+  // placed right before the MMA, then hoisted out of the loops that do not
+  // write the buffers read by the MMA, and dropped if a fence already follows
+  // the last write in the same block.
   void runOnOperation() override {
-    // Only insert fences for compute capability 9.0
+    // Only insert fences for compute capability 9.0 and above
     if (computeCapability < 90)
       return;
-    if (::triton::tools::getBoolEnv("DISABLE_MMA_V3"))
-      return;
+    bool disableMMAv3 = ::triton::tools::getBoolEnv("DISABLE_MMA_V3");
     ModuleOp mod = getOperation();
     mod.walk([&](Operation *op) {
-      if (!isa<ttng::WarpGroupDotOp>(op))
-        return WalkResult::advance();
-      OpBuilder builder(op);
-      auto a = op->getOperand(0);
-      auto b = op->getOperand(1);
-      auto mmaEncoding = dyn_cast<ttg::NvidiaMmaEncodingAttr>(
-          cast<RankedTensorType>(op->getResult(0).getType()).getEncoding());
-      if (!mmaEncoding || !mmaEncoding.isHopper())
+      if (isa<ttng::WarpGroupDotOp>(op)) {
+        if (disableMMAv3)
+          return WalkResult::advance();
+        auto mmaEncoding = dyn_cast<ttg::NvidiaMmaEncodingAttr>(
+            cast<RankedTensorType>(op->getResult(0).getType()).getEncoding());
+        if (!mmaEncoding || !mmaEncoding.isHopper())
+          return WalkResult::advance();
+      } else if (!isa<ttng::TCGen5MMAOp>(op)) {
+        // tcgen05.mma reads its operands from shared memory through the async
+        // proxy like wgmma.
         return WalkResult::advance();
-      bool aDependsOnShared = dependOnSharedEncOperand(a);
-      bool bDependsOnShared = dependOnSharedEncOperand(b);
-      if (!aDependsOnShared && !bDependsOnShared)
+      }
+      SetVector<Operation *> writers;
+      bool unknownWriters = false;
+      for (Value operand : {op->getOperand(0), op->getOperand(1)}) {
+        if (!isa<tt::MemDescType>(operand.getType()))
+          continue;
+        SetVector<Value> allocs;
+        DenseSet<Value> visited;
+        unknownWriters |= !getUnderlyingAllocs(operand, allocs, visited);
+        for (Value alloc : allocs)
+          getGenericProxyWriters(alloc, writers);
+      }
+      if (!unknownWriters && writers.empty())
         return WalkResult::advance();
-      Operation *fence = builder.create<ttng::FenceAsyncSharedOp>(
-          op->getLoc(), /*bCluster=*/false);
-      // If there is all the dependencies are outside of the loop try to hoist
-      // the fence.
-      while (auto loopOp = fence->getParentOfType<LoopLikeOpInterface>()) {
-        if (aDependsOnShared &&
-            loopOp->isAncestor(a.getParentBlock()->getParentOp()))
+      auto writesInside = [&](Operation *region) {
+        return unknownWriters ||
+               llvm::any_of(writers, [&](Operation *writer) {
+                 return region->isAncestor(writer);
+               });
+      };
+      Operation *insertPoint = op;
+      while (auto loopOp =
+                 insertPoint->getParentOfType<LoopLikeOpInterface>()) {
+        if (writesInside(loopOp))
           break;
-        if (bDependsOnShared &&
-            loopOp->isAncestor(b.getParentBlock()->getParentOp()))
+        insertPoint = loopOp;
+      }
+      // Skip the fence if one already separates the last write in the block
+      // from the insertion point, e.g. when several MMAs read the same
+      // buffers.
+      for (Operation *prev = insertPoint->getPrevNode(); prev;
+           prev = prev->getPrevNode()) {
+        if (isa<ttng::FenceAsyncSharedOp>(prev))
+          return WalkResult::advance();
+        if (writesInside(prev))
           break;
-        loopOp.moveOutOfLoop(fence);
       }
+      OpBuilder builder(insertPoint);
+      builder.create<ttng::FenceAsyncSharedOp>(op->getLoc(),
+                                               /*bCluster=*/false);
       return WalkResult::advance();
     });
   }
-
-private:
-  bool dependOnSharedEncOperand(Value operand) {
-    static DenseSet<std::pair<Operation *, unsigned>> trace;
-    auto op = operand.getDefiningOp();
-    // avoid redundant insertion
-    if (op && op->hasTrait<OpTrait::DotLike>())
-      return false;
-    // reach convertlayout
-    if (op && isa<ttg::LocalAllocOp>(op) &&
-        cast<ttg::LocalAllocOp>(op).getSrc())
-      return true;
-    // root and not BlockArgument
-    if (!op && !isa<BlockArgument>(operand))
-      return false;
-    // op and not BlockArgument
-    if (op && !isa<BlockArgument>(operand)) {
-      for (auto v : op->getOperands()) {
-        if (dependOnSharedEncOperand(v))
-          return true;
-      }
-    }
-    // reach BlockArgument
-    // TODO: support other scf ops, IfOp, WhileOp, etc.
-    if (BlockArgument arg = dyn_cast<BlockArgument>(operand)) {
-      unsigned argNum = arg.getArgNumber();
-      Operation *argOwner = arg.getOwner()->getParentOp();
-      // support ForOp only
-      if (auto forOp = dyn_cast<scf::ForOp>(argOwner)) {
-        // prologue
-        auto iterOperands = forOp.getInitArgs();
-        if (argNum == 0)
-          return false;
-        if (dependOnSharedEncOperand(iterOperands[argNum - 1]))
-          return true;
-        // yield
-        auto yieldOp = forOp.getBody()->getTerminator();
-        Value v = yieldOp->getOperand(argNum - 1);
-        auto entry = std::make_pair<Operation *, unsigned>(std::move(yieldOp),
-                                                           std::move(argNum));
-        // avoid cyclic
-        if (trace.contains(entry))
-          return false;
-        else
-          trace.insert(entry);
-
-        if (dependOnSharedEncOperand(v))
-          return true;
-      } else if (auto whileOp = dyn_cast<scf::WhileOp>(argOwner)) {
-        assert(false && "FenceInsertionPass does not supported WhileOp");
-      } else if (auto ifOp = dyn_cast<scf::IfOp>(argOwner)) {
-        assert(false && "FenceInsertionPass does not supported IfOp");
-      }
-    }
-    return false;
-  }
 };
 } // namespace
 
@@ -0,0 +1,80 @@
+#include "triton/Dialect/TritonNvidiaGPU/Transforms/Pipelines.h"
+#include "mlir/Pass/PassRegistry.h"
+#include "mlir/Transforms/Passes.h"
+#include "triton/Conversion/TritonToTritonGPU/TritonToTritonGPUPass.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+
+namespace mlir {
+namespace triton {
+namespace nvidia_gpu {
+
+using namespace mlir::triton::gpu;
+
+// Returns the maximum shared memory of a CTA on devices of compute capability
+// `capability`, in bytes.
+static int getMaxSharedMemorySize(int capability) {
+  if (capability >= 90)
+    return 227 * 1024;
+  if (capability == 80 || capability == 87)
+    return 163 * 1024;
+  if (capability >= 86)
+    return 99 * 1024;
+  if (capability >= 75)
+    return 64 * 1024;
+  return 48 * 1024;
+}
+
+void buildTTGIRPipeline(OpPassManager &pm, const TTGIRPipelineOptions &options,
+                        ClusterInfo *clusterInfo) {
+  int capability = options.capability;
+  // TTIR -> TTGIR
+  pm.addPass(createConvertTritonToTritonGPUPass(
+      "cuda:" + std::to_string(capability), options.numWarps,
+      /*threadsPerWarp=*/32, options.numCTAs));
+  // optimize TTGIR
+  pm.addPass(createTritonGPUCoalesce());
+  if (capability / 10 >= 8)
+    pm.addPass(createTritonGPUF32DotTC());
+  // TODO(Qingyi): Move PlanCTAPass to the front of CoalescePass
+  pm.addPass(createTritonNvidiaGPUPlanCTAPass(clusterInfo));
+  pm.addPass(createTritonGPURemoveLayoutConversions());
+  pm.addPass(createTritonGPUOptimizeThreadLocality());
+  pm.addPass(createTritonGPUAccelerateMatmul());
+  pm.addPass(createTritonGPURemoveLayoutConversions());
+  pm.addPass(createTritonGPUOptimizeEpilogue());
+  pm.addPass(createTritonGPUOptimizeDotOperands({capability >= 80}));
+  pm.addPass(createCSEPass());
+  if (capability / 10 >= 8) {
+    pm.addPass(createTritonGPUCombineTensorSelectAndIf());
+    pm.addPass(createTritonGPUPipeline(
+        {options.numStages, options.numDotIterationsInFlight}));
+  }
+  pm.addPass(createTritonGPUPrefetch());
+  pm.addPass(createTritonGPUOptimizeDotOperands({capability >= 80}));
+  pm.addPass(createTritonGPURemoveLayoutConversions());
+  pm.addPass(createTritonGPUReduceDataDuplication());
+  pm.addPass(createTritonGPUReorderInstructions());
+  pm.addPass(createCSEPass());
+  pm.addPass(createSymbolDCEPass());
+  // After CSE, which would merge the reloads of the spilled tensors.
+  pm.addPass(createTritonGPUSpillToSharedMemory(
+      {getMaxSharedMemorySize(capability)}));
+  if (capability / 10 >= 9) {
+    pm.addPass(createTritonNvidiaGPUFenceInsertionPass());
+    pm.addPass(createTritonNvidiaGPUTMALoweringPass());
+  }
+  pm.addPass(createCanonicalizerPass());
+}
+
+void registerTTGIRPipeline() {
+  PassPipelineRegistration<TTGIRPipelineOptions>(
+      "triton-cuda-ttgir-pipeline",
+      "The TTIR to TTGIR pipeline of the CUDA backend",
+      [](OpPassManager &pm, const TTGIRPipelineOptions &options) {
+        buildTTGIRPipeline(pm, options);
+      });
+}
+
+} // namespace nvidia_gpu
+} // namespace triton
+} // namespace mlir
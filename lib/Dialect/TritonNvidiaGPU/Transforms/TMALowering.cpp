@@ -1,3 +1,4 @@
+#include "mlir/Interfaces/FunctionInterfaces.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 #include "mlir/Transforms/Passes.h"
@@ -51,13 +52,15 @@ public:
     Value barrierAlloc =
         rewriter.create<LocalAllocOp>(loc, barrierMemDescType, Value());
     rewriter.create<InitBarrierOp>(loc, barrierAlloc, 1);
-    int sizeInBytes = product(tensorType.getShape()) *
+    // Each CTA receives its own block, even when multicast by others.
+    int sizeInBytes = product(getShapePerCTA(tensorType)) *
                       tensorType.getElementType().getIntOrFloatBitWidth() / 8;
     Value pred = rewriter.create<arith::ConstantIntOp>(loc, 1, 1);
     rewriter.create<triton::nvidia_gpu::BarrierExpectOp>(loc, barrierAlloc,
                                                          sizeInBytes, pred);
     rewriter.create<triton::nvidia_gpu::AsyncTMACopyGlobalToLocalOp>(
-        loc, op.getDescPtr(), op.getIndices(), barrierAlloc, alloc, pred);
+        loc, op.getDescPtr(), op.getIndices(), op.getIm2colOffsets(),
+        barrierAlloc, alloc, pred);
     Value phase = rewriter.create<arith::ConstantIntOp>(loc, 0, 32);
     rewriter.create<WaitBarrierOp>(loc, barrierAlloc, phase);
     rewriter.create<InvalBarrierOp>(loc, barrierAlloc);
@@ -66,12 +69,14 @@ public:
   }
 };
 
-class TMAStoreLowering
-    : public OpRewritePattern<ExperimentalDescriptorStoreOp> {
+// Lowers the descriptor stores and reductions to a bulk copy or reduction of
+// a staging buffer in shared memory.
+template <typename OpTy>
+class TMAStoreLowering : public OpRewritePattern<OpTy> {
 public:
-  using OpRewritePattern::OpRewritePattern;
+  using OpRewritePattern<OpTy>::OpRewritePattern;
 
-  LogicalResult matchAndRewrite(ExperimentalDescriptorStoreOp op,
+  LogicalResult matchAndRewrite(OpTy op,
                                 PatternRewriter &rewriter) const override {
     MLIRContext *ctx = op.getContext();
     Attribute sharedMemorySpace = triton::gpu::SharedMemorySpaceAttr::get(ctx);
@@ -91,12 +96,49 @@ public:
                          encoding, sharedMemorySpace, /*mutableMemory=*/true);
     Value alloc = rewriter.create<LocalAllocOp>(loc, memDescType, op.getSrc());
     rewriter.create<triton::nvidia_gpu::FenceAsyncSharedOp>(loc, false);
-    rewriter.create<triton::nvidia_gpu::AsyncTMACopyLocalToGlobalOp>(
-        loc, op.getDescPtr(), op.getIndices(), alloc);
-    rewriter.create<triton::nvidia_gpu::TMAStoreWait>(loc, 0);
+    createCopy(op, alloc, rewriter);
+    if (!deferStoreWait(op, alloc, rewriter))
+      rewriter.create<triton::nvidia_gpu::TMAStoreWait>(loc, 0);
     rewriter.eraseOp(op);
     return success();
   }
+
+private:
+  static void createCopy(ExperimentalDescriptorStoreOp op, Value alloc,
+                         PatternRewriter &rewriter) {
+    rewriter.create<triton::nvidia_gpu::AsyncTMACopyLocalToGlobalOp>(
+        op.getLoc(), op.getDescPtr(), op.getIndices(), alloc);
+  }
+
+  static void createCopy(ExperimentalDescriptorReduceOp op, Value alloc,
+                         PatternRewriter &rewriter) {
+    rewriter.create<triton::nvidia_gpu::AsyncTMAReduceOp>(
+        op.getLoc(), op.getKind(), op.getDescPtr(), op.getIndices(), alloc);
+  }
+
+  // A store at the top level of the kernel, typically the epilogue of a
+  // non-persistent GEMM, never has its staging buffer reused.  Instead of
+  // waiting right away, wait once before the kernel returns so that the bulk
+  // copy overlaps with whatever comes after it.  The buffer is deallocated
+  // after the wait to keep it live until then.
+  static bool deferStoreWait(OpTy op, Value alloc, PatternRewriter &rewriter) {
+    if (!isa<FunctionOpInterface>(op->getParentOp()))
+      return false;
+    Operation *terminator = op->getBlock()->getTerminator();
+    if (!isa<triton::ReturnOp>(terminator))
+      return false;
+    // Reuse the wait inserted for a previous store, if any.
+    Operation *prev = terminator->getPrevNode();
+    while (prev && isa<LocalDeallocOp>(prev))
+      prev = prev->getPrevNode();
+    auto wait = dyn_cast_or_null<triton::nvidia_gpu::TMAStoreWait>(prev);
+    OpBuilder::InsertionGuard guard(rewriter);
+    rewriter.setInsertionPoint(terminator);
+    if (!wait || wait.getPendings() != 0)
+      rewriter.create<triton::nvidia_gpu::TMAStoreWait>(op.getLoc(), 0);
+    rewriter.create<LocalDeallocOp>(op.getLoc(), alloc);
+    return true;
+  }
 };
 
 class TritonNvidiaGPUTMALoweringPass
@@ -108,7 +150,9 @@ public:
     ModuleOp m = getOperation();
 
     mlir::RewritePatternSet patterns(context);
-    patterns.add<TMALoadLowering, TMAStoreLowering>(context);
+    patterns.add<TMALoadLowering,
+                 TMAStoreLowering<ExperimentalDescriptorStoreOp>,
+                 TMAStoreLowering<ExperimentalDescriptorReduceOp>>(context);
     if (applyPatternsAndFoldGreedily(m, std::move(patterns)).failed())
       signalPassFailure();
   }
@@ -0,0 +1,152 @@
+#include "mlir/Analysis/Liveness.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/Support/LogicalResult.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonNvidiaGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonNvidiaGPU/Transforms/Passes.h"
+#include "llvm/Support/MathExtras.h"
+
+#include <limits>
+#include <memory>
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/TritonNvidiaGPU/Transforms/Passes.h.inc"
+
+namespace {
+
+using namespace mlir;
+using namespace triton;
+using namespace triton::gpu;
+using namespace triton::nvidia_gpu;
+
+// The tensor memory of an SM has 512 columns of 128 lanes.
+constexpr int kMaxTmemColumns = 512;
+// tcgen05.alloc allocates a power of 2 of at least 32 columns.
+constexpr int kMinTmemColumns = 32;
+
+struct TmemBuffer {
+  TMEMAllocOp alloc;
+  int numCols;
+  size_t start;
+  size_t end;
+  int offset = -1;
+};
+
+class TritonNvidiaGPUTensorMemoryAllocationPass
+    : public TritonNvidiaGPUTensorMemoryAllocationPassBase<
+          TritonNvidiaGPUTensorMemoryAllocationPass> {
+public:
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    int moduleCols = 0;
+    auto result = mod.walk([&](triton::FuncOp funcOp) {
+      FailureOr<int> numCols = allocateFunction(funcOp);
+      if (failed(numCols))
+        return WalkResult::interrupt();
+      moduleCols = std::max(moduleCols, *numCols);
+      return WalkResult::advance();
+    });
+    if (result.wasInterrupted())
+      return signalPassFailure();
+    if (moduleCols > 0)
+      mod->setAttr("triton_nvidia_gpu.tensor_memory_size",
+                   IntegerAttr::get(IntegerType::get(mod.getContext(), 32),
+                                    moduleCols));
+  }
+
+private:
+  // Returns the number of columns allocated by the function.
+  FailureOr<int> allocateFunction(triton::FuncOp funcOp) {
+    SmallVector<TmemBuffer> buffers;
+    funcOp.walk([&](TMEMAllocOp alloc) {
+      int numCols = alloc.getType().getShape()[1];
+      buffers.push_back({alloc, numCols, 0, 0});
+    });
+    if (buffers.empty())
+      return 0;
+
+    // Liveness ranges of the buffers, numbering the operations in post-order
+    // as the shared memory allocation does so that a loop outlives the
+    // buffers of its body.
+    DenseMap<Operation *, size_t> operationId;
+    funcOp.walk<WalkOrder::PostOrder>(
+        [&](Operation *op) { operationId[op] = operationId.size(); });
+    Liveness liveness(funcOp);
+    for (TmemBuffer &buffer : buffers) {
+      buffer.start = std::numeric_limits<size_t>::max();
+      buffer.end = std::numeric_limits<size_t>::min();
+      for (Operation *liveOp :
+           liveness.resolveLiveness(buffer.alloc.getResult())) {
+        buffer.start = std::min(buffer.start, operationId[liveOp]);
+        buffer.end = std::max(buffer.end, operationId[liveOp] + 1);
+      }
+    }
+
+    // First fit in the order of the starts of the ranges.
+    llvm::stable_sort(buffers, [](const TmemBuffer &a, const TmemBuffer &b) {
+      return a.start < b.start;
+    });
+    int numCols = 0;
+    for (size_t i = 0; i < buffers.size(); ++i) {
+      TmemBuffer &buffer = buffers[i];
+      SmallVector<std::pair<int, int>> used;
+      for (size_t j = 0; j < i; ++j)
+        if (buffers[j].start < buffer.end && buffer.start < buffers[j].end)
+          used.push_back({buffers[j].offset, buffers[j].numCols});
+      llvm::sort(used);
+      int offset = 0;
+      for (auto [usedOffset, usedCols] : used) {
+        if (offset + buffer.numCols <= usedOffset)
+          break;
+        offset = std::max(offset, usedOffset + usedCols);
+      }
+      buffer.offset = offset;
+      numCols = std::max(numCols, offset + buffer.numCols);
+    }
+    if (numCols > kMaxTmemColumns) {
+      funcOp.emitError("tensor memory allocations need ")
+          << numCols << " columns, more than the " << kMaxTmemColumns
+          << " available";
+      return failure();
+    }
+    numCols = std::max<int>(llvm::PowerOf2Ceil(numCols), kMinTmemColumns);
+
+    // Allocate the columns on entry, through a shared memory slot receiving
+    // their address, and release them before returning.
+    MLIRContext *ctx = funcOp.getContext();
+    OpBuilder builder(ctx);
+    builder.setInsertionPointToStart(&funcOp.getBody().front());
+    Location loc = funcOp.getLoc();
+    auto slotCTALayout = CTALayoutAttr::get(ctx, /*CTAsPerCGA=*/{1},
+                                            /*CTASplitNum=*/{1},
+                                            /*CTAOrder=*/{0});
+    auto slotEncoding =
+        SharedEncodingAttr::get(ctx, 1, 1, 1, {0}, slotCTALayout);
+    auto slotType = MemDescType::get({1}, builder.getI32Type(), slotEncoding,
+                                     SharedMemorySpaceAttr::get(ctx),
+                                     /*mutableMemory=*/true);
+    Value slot = builder.create<LocalAllocOp>(loc, slotType, Value());
+    Value base = builder.create<TMEMAllocateColumnsOp>(
+        loc, builder.getI32Type(), slot, numCols);
+    funcOp.walk([&](triton::ReturnOp returnOp) {
+      OpBuilder returnBuilder(returnOp);
+      returnBuilder.create<TMEMDeallocateColumnsOp>(returnOp.getLoc(), base,
+                                                    numCols);
+    });
+
+    for (TmemBuffer &buffer : buffers) {
+      buffer.alloc.getBaseMutable().assign(base);
+      buffer.alloc->setAttr(
+          "tensor_memory_col_offset",
+          IntegerAttr::get(IntegerType::get(ctx, 32), buffer.offset));
+    }
+    return numCols;
+  }
+};
+
+} // namespace
+
+std::unique_ptr<Pass> mlir::createTritonNvidiaGPUTensorMemoryAllocationPass() {
+  return std::make_unique<TritonNvidiaGPUTensorMemoryAllocationPass>();
+}
@@ -144,7 +144,29 @@ struct LLVMDIScopePass : public LLVMDIScopeBase<LLVMDIScopePass> {
     }
   }
 
+  // Give the operations without a source location, e.g. those created by the
+  // lowering of the kernel prologue, the location of the operation before
+  // them, or of their parent, so that every instruction of the kernel maps to
+  // a line of the source and profilers don't attribute it to no line.
+  void setUnknownLocs(LLVM::LLVMFuncOp funcOp) {
+    Location funcLoc = funcOp.getLoc();
+    funcOp.walk<WalkOrder::PreOrder>([&](Operation *op) {
+      if (op == funcOp || !isa<UnknownLoc>(op->getLoc()))
+        return;
+      Location loc = funcLoc;
+      if (Operation *prev = op->getPrevNode())
+        loc = prev->getLoc();
+      else if (Operation *parent = op->getParentOp(); parent != funcOp)
+        loc = parent->getLoc();
+      op->setLoc(loc);
+    });
+  }
+
   void runOnOperation() override {
+    getOperation()->walk([&](LLVM::LLVMFuncOp funcOp) {
+      if (!isa<UnknownLoc>(funcOp.getLoc()))
+        setUnknownLocs(funcOp);
+    });
     getOperation()->walk<WalkOrder::PreOrder>([&](Operation *op) -> void {
       if (isa<LLVM::LLVMFuncOp>(op))
         setSubprogramAttr(cast<LLVM::LLVMFuncOp>(op));
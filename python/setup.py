@@ -572,6 +572,7 @@ def get_entry_points():
         entry_points["console_scripts"] = [
             "proton-viewer = triton.profiler.viewer:main",
             "proton = triton.profiler.proton:main",
+            "proton-merge = triton.profiler.merge:main",
         ]
     return entry_points
 
@@ -70,106 +70,96 @@ public:
   AtomicOp(const uint64_t *ptr, size_t numel, int order)
       : ptr(ptr), numel(numel), order(order) {}
 
-  void apply() {
-    for (size_t i = 0; i < numel; ++i) {
-      applyAt(reinterpret_cast<void *>(ptr[i]), i);
-    }
-  }
+  // Applies the operation to all the elements, in a loop specialized for the
+  // operation and the element type.
+  virtual void apply() = 0;
 
   virtual ~AtomicOp() = default;
 
 protected:
-  virtual void applyAt(void *, size_t i) = 0;
-
   const uint64_t *ptr;
   size_t numel;
   int order;
 };
 
-template <typename DType> class AtomicRMWOpBase : public AtomicOp {
+// `Derived` provides the static `applyAtMasked` applying the operation to a
+// single element, which the loop of `apply` calls without a virtual call.
+template <typename DType, typename Derived>
+class AtomicRMWOpBase : public AtomicOp {
 public:
   AtomicRMWOpBase(const uint64_t *ptr, const void *val, void *ret,
                   const bool *mask, size_t numel, int order)
       : AtomicOp(ptr, numel, order), val(val), ret(ret), mask(mask) {}
 
-protected:
-  void applyAt(void *loc, size_t i) override final {
-    if (mask[i]) {
-      *(static_cast<DType *>(ret) + i) =
-          applyAtMasked(static_cast<DType *>(loc),
-                        *(static_cast<const DType *>(val) + i), order);
+  void apply() override final {
+    auto *vals = static_cast<const DType *>(val);
+    auto *rets = static_cast<DType *>(ret);
+    for (size_t i = 0; i < numel; ++i) {
+      if (mask[i])
+        rets[i] = Derived::applyAtMasked(reinterpret_cast<DType *>(ptr[i]),
+                                         vals[i], order);
     }
   }
 
-  virtual DType applyAtMasked(DType *loc, const DType value, int order) = 0;
-
+protected:
   const void *val;
   void *ret;
   const bool *mask;
 };
 
-template <typename DType, RMWOp Op, typename = void>
-class AtomicRMWOp : public AtomicRMWOpBase<DType> {
-public:
-  using AtomicRMWOpBase<DType>::AtomicRMWOpBase;
-};
+template <typename DType, RMWOp Op, typename = void> class AtomicRMWOp;
 
 template <typename DType, RMWOp Op>
 class AtomicRMWOp<DType, Op, std::enable_if_t<Op == RMWOp::ADD>>
-    : public AtomicRMWOpBase<DType> {
+    : public AtomicRMWOpBase<DType, AtomicRMWOp<DType, Op>> {
 public:
-  using AtomicRMWOpBase<DType>::AtomicRMWOpBase;
+  using AtomicRMWOpBase<DType, AtomicRMWOp<DType, Op>>::AtomicRMWOpBase;
 
-protected:
-  DType applyAtMasked(DType *loc, const DType value, int order) override {
+  static DType applyAtMasked(DType *loc, const DType value, int order) {
     return __atomic_fetch_add(loc, value, order);
   }
 };
 
 template <typename DType, RMWOp Op>
 class AtomicRMWOp<DType, Op, std::enable_if_t<Op == RMWOp::FADD>>
-    : public AtomicRMWOpBase<DType> {
+    : public AtomicRMWOpBase<DType, AtomicRMWOp<DType, Op>> {
 public:
-  using AtomicRMWOpBase<DType>::AtomicRMWOpBase;
+  using AtomicRMWOpBase<DType, AtomicRMWOp<DType, Op>>::AtomicRMWOpBase;
 
-protected:
-  DType applyAtMasked(DType *loc, const DType value, int order) override {
+  static DType applyAtMasked(DType *loc, const DType value, int order) {
     return atomic_fadd(loc, value, order);
   }
 };
 
 template <typename DType, RMWOp Op>
 class AtomicRMWOp<DType, Op, std::enable_if_t<Op == RMWOp::AND>>
-    : public AtomicRMWOpBase<DType> {
+    : public AtomicRMWOpBase<DType, AtomicRMWOp<DType, Op>> {
 public:
-  using AtomicRMWOpBase<DType>::AtomicRMWOpBase;
+  using AtomicRMWOpBase<DType, AtomicRMWOp<DType, Op>>::AtomicRMWOpBase;
 
-protected:
-  DType applyAtMasked(DType *loc, const DType value, int order) override {
+  static DType applyAtMasked(DType *loc, const DType value, int order) {
     return __atomic_fetch_and(loc, value, order);
   }
 };
 
 template <typename DType, RMWOp Op>
 class AtomicRMWOp<DType, Op, std::enable_if_t<Op == RMWOp::OR>>
-    : public AtomicRMWOpBase<DType> {
+    : public AtomicRMWOpBase<DType, AtomicRMWOp<DType, Op>> {
 public:
-  using AtomicRMWOpBase<DType>::AtomicRMWOpBase;
+  using AtomicRMWOpBase<DType, AtomicRMWOp<DType, Op>>::AtomicRMWOpBase;
 
-protected:
-  DType applyAtMasked(DType *loc, const DType value, int order) override {
+  static DType applyAtMasked(DType *loc, const DType value, int order) {
     return __atomic_fetch_or(loc, value, order);
   }
 };
 
 template <typename DType, RMWOp Op>
 class AtomicRMWOp<DType, Op, std::enable_if_t<Op == RMWOp::XOR>>
-    : public AtomicRMWOpBase<DType> {
+    : public AtomicRMWOpBase<DType, AtomicRMWOp<DType, Op>> {
 public:
-  using AtomicRMWOpBase<DType>::AtomicRMWOpBase;
+  using AtomicRMWOpBase<DType, AtomicRMWOp<DType, Op>>::AtomicRMWOpBase;
 
-protected:
-  DType applyAtMasked(DType *loc, const DType value, int order) override {
+  static DType applyAtMasked(DType *loc, const DType value, int order) {
     return __atomic_fetch_xor(loc, value, order);
   }
 };
@@ -177,12 +167,11 @@ protected:
 template <typename DType, RMWOp Op>
 class AtomicRMWOp<DType, Op,
                   std::enable_if_t<Op == RMWOp::MAX || Op == RMWOp::UMAX>>
-    : public AtomicRMWOpBase<DType> {
+    : public AtomicRMWOpBase<DType, AtomicRMWOp<DType, Op>> {
 public:
-  using AtomicRMWOpBase<DType>::AtomicRMWOpBase;
+  using AtomicRMWOpBase<DType, AtomicRMWOp<DType, Op>>::AtomicRMWOpBase;
 
-protected:
-  DType applyAtMasked(DType *loc, const DType value, int order) override {
+  static DType applyAtMasked(DType *loc, const DType value, int order) {
     return atomic_cmp</*is_min=*/false>(loc, value, order);
   }
 };
@@ -190,75 +179,141 @@ protected:
 template <typename DType, RMWOp Op>
 class AtomicRMWOp<DType, Op,
                   std::enable_if_t<Op == RMWOp::MIN || Op == RMWOp::UMIN>>
-    : public AtomicRMWOpBase<DType> {
+    : public AtomicRMWOpBase<DType, AtomicRMWOp<DType, Op>> {
 public:
-  using AtomicRMWOpBase<DType>::AtomicRMWOpBase;
+  using AtomicRMWOpBase<DType, AtomicRMWOp<DType, Op>>::AtomicRMWOpBase;
 
-protected:
-  DType applyAtMasked(DType *loc, const DType value, int order) override {
+  static DType applyAtMasked(DType *loc, const DType value, int order) {
     return atomic_cmp</*is_min=*/true>(loc, value, order);
   }
 };
 
 template <typename DType, RMWOp Op>
 class AtomicRMWOp<DType, Op, std::enable_if_t<Op == RMWOp::XCHG>>
-    : public AtomicRMWOpBase<DType> {
+    : public AtomicRMWOpBase<DType, AtomicRMWOp<DType, Op>> {
 public:
-  using AtomicRMWOpBase<DType>::AtomicRMWOpBase;
+  using AtomicRMWOpBase<DType, AtomicRMWOp<DType, Op>>::AtomicRMWOpBase;
 
-protected:
-  DType applyAtMasked(DType *loc, const DType value, int order) override {
+  static DType applyAtMasked(DType *loc, const DType value, int order) {
     return __atomic_exchange_n(loc, value, order);
   }
 };
 
-class AtomicCASOp : public AtomicOp {
+// Atomic operations perform bitwise comparison, so the CAS of elements of any
+// type is that of the unsigned integers of their size.
+template <typename T> class AtomicCASOp : public AtomicOp {
 public:
   AtomicCASOp(const uint64_t *ptr, void *expected, const void *desired,
-              size_t itemsize, size_t numel, int order)
-      : AtomicOp(ptr, numel, order), expected(expected), desired(desired),
-        itemsize(itemsize) {}
+              size_t numel, int order)
+      : AtomicOp(ptr, numel, order), expected(expected), desired(desired) {}
 
-protected:
-  void applyAt(void *loc, size_t i) override {
-    // Atomic operations perform bitwise comparison, so it's safe to
-    // use number of bytes (itemsize) to determine the type of pointers
-    if (itemsize == 1) {
-      uint8_t desired_val = *(static_cast<const uint8_t *>(desired) + i);
-      __atomic_compare_exchange_n(static_cast<uint8_t *>(loc),
-                                  static_cast<uint8_t *>(expected) + i,
-                                  desired_val, false, order, order);
-    } else if (itemsize == 2) {
-      uint16_t desired_val = *(static_cast<const uint16_t *>(desired) + i);
-      __atomic_compare_exchange_n(static_cast<uint16_t *>(loc),
-                                  static_cast<uint16_t *>(expected) + i,
-                                  desired_val, false, order, order);
-    } else if (itemsize == 4) {
-      uint32_t desired_val = *(static_cast<const uint32_t *>(desired) + i);
-      __atomic_compare_exchange_n(static_cast<uint32_t *>(loc),
-                                  static_cast<uint32_t *>(expected) + i,
-                                  desired_val, false, order, order);
-    } else if (itemsize == 8) {
-      uint64_t desired_val = *(static_cast<const uint64_t *>(desired) + i);
-      __atomic_compare_exchange_n(static_cast<uint64_t *>(loc),
-                                  static_cast<uint64_t *>(expected) + i,
-                                  desired_val, false, order, order);
-    } else {
-      // The ‘__atomic’ builtins can be used with any integral scalar or pointer
-      // type that is 1, 2, 4, or 8 bytes in length. 16-byte integral types are
-      // also allowed if ‘__int128’ (see 128-bit Integers) is supported by the
-      // architecture.
-      // https://gcc.gnu.org/onlinedocs/gcc/_005f_005fatomic-Builtins.html
-      throw std::invalid_argument("Invalid byte size");
+  void apply() override final {
+    auto *expecteds = static_cast<T *>(expected);
+    auto *desireds = static_cast<const T *>(desired);
+    for (size_t i = 0; i < numel; ++i) {
+      __atomic_compare_exchange_n(reinterpret_cast<T *>(ptr[i]), expecteds + i,
+                                  desireds[i], false, order, order);
     }
   }
 
 private:
   void *expected;
   const void *desired;
-  size_t itemsize;
 };
 
+template <typename T> struct TypeTag {
+  using type = T;
+};
+
+// Calls `fn` with the tag of the unsigned integer type of `itemsize` bytes,
+// through which elements of any type of that size are copied.
+template <typename Fn> void dispatchItemsize(size_t itemsize, Fn &&fn) {
+  switch (itemsize) {
+  case 1:
+    return fn(TypeTag<uint8_t>{});
+  case 2:
+    return fn(TypeTag<uint16_t>{});
+  case 4:
+    return fn(TypeTag<uint32_t>{});
+  case 8:
+    return fn(TypeTag<uint64_t>{});
+  default:
+    // The ‘__atomic’ builtins can be used with any integral scalar or pointer
+    // type that is 1, 2, 4, or 8 bytes in length. 16-byte integral types are
+    // also allowed if ‘__int128’ (see 128-bit Integers) is supported by the
+    // architecture.
+    // https://gcc.gnu.org/onlinedocs/gcc/_005f_005fatomic-Builtins.html
+    throw std::invalid_argument("Invalid byte size");
+  }
+}
+
+// The elements of a 1D array, which can be read without holding the GIL,
+// unlike the accessors of py::array.
+class StridedElements {
+public:
+  explicit StridedElements(const py::array &array)
+      : data(static_cast<const char *>(array.data())),
+        stride(array.strides(0)) {}
+
+  const void *operator[](ssize_t i) const { return data + i * stride; }
+
+  ssize_t getStride() const { return stride; }
+
+private:
+  const char *data;
+  ssize_t stride;
+};
+
+// Loads the elements at `ptrs`, or those of `others` where the mask is false,
+// into `ret`. Runs of masked elements at consecutive addresses are copied
+// with a single memcpy.
+template <typename T, typename Ptrs, typename Masks>
+void loadElements(const Ptrs &ptrs, const Masks &masks,
+                  const StridedElements &others, T *ret, ssize_t numel) {
+  for (ssize_t i = 0; i < numel;) {
+    if (!masks(i)) {
+      ret[i] = *static_cast<const T *>(others[i]);
+      ++i;
+      continue;
+    }
+    ssize_t end = i + 1;
+    while (end < numel && masks(end) &&
+           ptrs(end) == ptrs(end - 1) + sizeof(T))
+      ++end;
+    const T *src = reinterpret_cast<const T *>(ptrs(i));
+    if (end - i == 1)
+      ret[i] = *src;
+    else
+      memcpy(ret + i, src, (end - i) * sizeof(T));
+    i = end;
+  }
+}
+
+// Stores the elements of `values` to `ptrs` where the mask is true. Runs of
+// elements at consecutive addresses, also consecutive in `values`, are copied
+// with a single memcpy.
+template <typename T, typename Ptrs, typename Masks>
+void storeElements(const Ptrs &ptrs, const Masks &masks,
+                   const StridedElements &values, ssize_t numel) {
+  bool contiguousValues = values.getStride() == sizeof(T);
+  for (ssize_t i = 0; i < numel;) {
+    if (!masks(i)) {
+      ++i;
+      continue;
+    }
+    ssize_t end = i + 1;
+    while (contiguousValues && end < numel && masks(end) &&
+           ptrs(end) == ptrs(end - 1) + sizeof(T))
+      ++end;
+    T *dst = reinterpret_cast<T *>(ptrs(i));
+    if (end - i == 1)
+      *dst = *static_cast<const T *>(values[i]);
+    else
+      memcpy(dst, values[i], (end - i) * sizeof(T));
+    i = end;
+  }
+}
+
 // This is a workaround because explicit template parameter list for lambdas is
 // a C++20 extension:
 // auto try_make_op = [&]<typename T>() {
@@ -337,15 +392,16 @@ void init_triton_interpreter(py::module &&m) {
           py::array_t<uint64_t> reshaped_ptr = ptr.reshape({numel});
           py::array_t<bool> reshaped_mask = mask.reshape({numel});
           py::array reshaped_others = other.reshape({numel});
-          for (size_t i = 0; i < ptr.size(); ++i) {
-            if (reshaped_mask.at(i))
-              memcpy(ret.mutable_data(i),
-                     reinterpret_cast<void *>(reshaped_ptr.at(i)),
-                     ret_dtype.itemsize());
-            else
-              memcpy(ret.mutable_data(i), reshaped_others.data(i),
-                     ret_dtype.itemsize());
-          }
+          auto ptrs = reshaped_ptr.unchecked<1>();
+          auto masks = reshaped_mask.unchecked<1>();
+          StridedElements others(reshaped_others);
+          void *ret_data = ret.mutable_data();
+          dispatchItemsize(ret_dtype.itemsize(), [&](auto tag) {
+            using T = typename decltype(tag)::type;
+            py::gil_scoped_release release;
+            loadElements(ptrs, masks, others, static_cast<T *>(ret_data),
+                         numel);
+          });
           return ret.reshape(shape);
         });
 
@@ -355,12 +411,14 @@ void init_triton_interpreter(py::module &&m) {
           py::array_t<uint64_t> reshaped_ptr = ptr.reshape({numel});
           py::array_t<int8_t> reshaped_mask = mask.reshape({numel});
           py::array reshaped_value = value.reshape({numel});
-          for (size_t i = 0; i < ptr.size(); ++i) {
-            if (reshaped_mask.at(i)) {
-              memcpy(reinterpret_cast<void *>(reshaped_ptr.mutable_at(i)),
-                     reshaped_value.data(i), value.dtype().itemsize());
-            }
-          }
+          auto ptrs = reshaped_ptr.unchecked<1>();
+          auto masks = reshaped_mask.unchecked<1>();
+          StridedElements values(reshaped_value);
+          dispatchItemsize(value.dtype().itemsize(), [&](auto tag) {
+            using T = typename decltype(tag)::type;
+            py::gil_scoped_release release;
+            storeElements<T>(ptrs, masks, values, numel);
+          });
         });
 
   m.def("atomic_rmw",
@@ -406,7 +464,10 @@ void init_triton_interpreter(py::module &&m) {
 
 #undef MAKE_ATOMIC_RMW_OP
 
-          atomic_op->apply();
+          {
+            py::gil_scoped_release release;
+            atomic_op->apply();
+          }
           return ret.reshape(shape);
         });
 
@@ -426,10 +487,13 @@ void init_triton_interpreter(py::module &&m) {
           memcpy(static_cast<void *>(ret.mutable_data()),
                  static_cast<const void *>(reshaped_cmp.data()),
                  itemsize * numel);
-          AtomicCASOp(reshaped_ptr.data(), ret.mutable_data(),
-                      static_cast<const void *>(reshaped_val.data()), itemsize,
-                      numel, order)
-              .apply();
+          dispatchItemsize(itemsize, [&](auto tag) {
+            using T = typename decltype(tag)::type;
+            AtomicCASOp<T> cas_op(reshaped_ptr.data(), ret.mutable_data(),
+                                  reshaped_val.data(), numel, order);
+            py::gil_scoped_release release;
+            cas_op.apply();
+          });
           return ret.reshape(shape);
         });
 }
@@ -15,6 +15,7 @@
 #include "mlir/IR/Verifier.h"
 #include "mlir/Parser/Parser.h"
 #include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassInstrumentation.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Support/FileUtilities.h"
 #include "mlir/Support/LLVM.h"
@@ -24,12 +25,16 @@
 #include "mlir/Transforms/Passes.h"
 
 #include "triton/Analysis/Allocation.h"
+#include "triton/Analysis/RegisterPressure.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/Triton/IR/Types.h"
 #include "triton/Dialect/Triton/IR/Utility.h"
 #include "triton/Tools/Sys/GetEnv.hpp"
 #include "llvm/Support/SourceMgr.h"
 
+#include <chrono>
+#include <mutex>
+
 namespace {
 
 namespace py = pybind11;
@@ -54,8 +59,25 @@ public:
   }
 
   void setLastLoc(const std::string &fileName, int line, int column) {
-    auto context = builder->getContext();
-    setLastLoc(FileLineColLoc::get(context, fileName, line, column));
+    // The locations of a function are all in the same file, whose name is
+    // uniqued once rather than for each of them.
+    if (!fileNameAttr || fileNameAttr.getValue() != fileName)
+      fileNameAttr = builder->getStringAttr(fileName);
+    setLastLoc(FileLineColLoc::get(fileNameAttr, line, column));
+  }
+
+  // Saves the last location, to be restored by popLoc, e.g. around the ops
+  // built for a node of the AST.
+  void pushLoc() { savedLocs.push_back(getLastLoc()); }
+
+  void pushLoc(const std::string &fileName, int line, int column) {
+    setLastLoc(fileName, line, column);
+    pushLoc();
+  }
+
+  void popLoc() {
+    assert(!savedLocs.empty());
+    setLastLoc(savedLocs.pop_back_val());
   }
 
   Location getLastLoc() {
@@ -116,6 +138,8 @@ public:
 private:
   std::unique_ptr<OpBuilder> builder;
   std::unique_ptr<Location> lastLoc;
+  SmallVector<Location> savedLocs;
+  StringAttr fileNameAttr;
   bool lineInfoEnabled = !triton::tools::getBoolEnv("TRITON_DISABLE_LINE_INFO");
 };
 
@@ -134,6 +158,92 @@ void outputWarning(Location loc, const std::string &msg) {
                /*stack_level=*/2);
 }
 
+// The wall time of a pass over all the ops it ran on, and the number of ops
+// nested in them before and after it.
+struct PassStats {
+  std::string name;
+  double seconds = 0;
+  int64_t opsBefore = 0;
+  int64_t opsAfter = 0;
+};
+
+// Collects the PassStats of the passes of a pass manager, in the order in
+// which they first run. The passes of nested pass managers run in parallel
+// on the ops they are nested on, e.g. one thread per function.
+class PassStatsInstrumentation : public PassInstrumentation {
+public:
+  void runBeforePass(Pass *pass, Operation *op) override {
+    if (isAdaptor(pass))
+      return;
+    int64_t numOps = countOps(op);
+    std::lock_guard<std::mutex> lock(mutex);
+    running[{pass, op}] = {Clock::now(), numOps};
+  }
+
+  void runAfterPass(Pass *pass, Operation *op) override { finish(pass, op); }
+
+  void runAfterPassFailed(Pass *pass, Operation *op) override {
+    finish(pass, op);
+  }
+
+  std::vector<PassStats> takeStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    statsIndex.clear();
+    return std::move(stats);
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  // The adaptors running nested pass managers would count the time of the
+  // passes they run.
+  static bool isAdaptor(Pass *pass) {
+    return pass->getName().ends_with("OpToOpPassAdaptor");
+  }
+
+  static int64_t countOps(Operation *op) {
+    int64_t numOps = 0;
+    op->walk([&](Operation *) { ++numOps; });
+    return numOps;
+  }
+
+  void finish(Pass *pass, Operation *op) {
+    if (isAdaptor(pass))
+      return;
+    Clock::time_point end = Clock::now();
+    int64_t numOps = countOps(op);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = running.find({pass, op});
+    if (it == running.end())
+      return;
+    auto [start, opsBefore] = it->second;
+    running.erase(it);
+    auto [indexIt, inserted] = statsIndex.try_emplace(pass, stats.size());
+    if (inserted) {
+      StringRef name = pass->getArgument();
+      stats.push_back({(name.empty() ? pass->getName() : name).str()});
+    }
+    PassStats &passStats = stats[indexIt->second];
+    passStats.seconds += std::chrono::duration<double>(end - start).count();
+    passStats.opsBefore += opsBefore;
+    passStats.opsAfter += numOps;
+  }
+
+  std::mutex mutex;
+  llvm::DenseMap<std::pair<Pass *, Operation *>,
+                 std::pair<Clock::time_point, int64_t>>
+      running;
+  llvm::DenseMap<Pass *, size_t> statsIndex;
+  std::vector<PassStats> stats;
+};
+
+// The PassStats of the pass managers run by the current thread since the last
+// take_pass_stats.
+std::vector<PassStats> &getThreadPassStats() {
+  thread_local std::vector<PassStats> stats;
+  return stats;
+}
+
 } // anonymous namespace
 
 /*****************************************************************************/
@@ -175,6 +285,7 @@ void init_triton_ir(py::module &&m) {
       .value("NORMAL", EvictionPolicy::NORMAL)
       .value("EVICT_FIRST", EvictionPolicy::EVICT_FIRST)
       .value("EVICT_LAST", EvictionPolicy::EVICT_LAST)
+      .value("NO_ALLOCATE", EvictionPolicy::NO_ALLOCATE)
       .export_values();
 
   py::enum_<RMWOp>(m, "ATOMIC_OP", py::module_local())
@@ -201,15 +312,29 @@ void init_triton_ir(py::module &&m) {
       .value("TF32", InputPrecision::TF32)
       .value("TF32x3", InputPrecision::TF32x3)
       .value("IEEE", InputPrecision::IEEE)
+      .value("BF16x3", InputPrecision::BF16x3)
+      .value("BF16x6", InputPrecision::BF16x6)
+      .export_values();
+
+  py::enum_<ScaleDotElemType>(m, "SCALE_DOT_ELEM_TYPE", py::module_local())
+      .value("E4M3", ScaleDotElemType::E4M3)
+      .value("E5M2", ScaleDotElemType::E5M2)
+      .value("E2M1", ScaleDotElemType::E2M1)
+      .value("BF16", ScaleDotElemType::BF16)
       .export_values();
 
   py::class_<MLIRContext>(m, "context", py::module_local())
       .def(py::init<>())
       .def("printOpOnDiagnostic",
            [](MLIRContext &self, bool v) { self.printOpOnDiagnostic(v); })
-      .def("printStackTraceOnDiagnostic", [](MLIRContext &self, bool v) {
-        self.printStackTraceOnDiagnostic(v);
-      });
+      .def("printStackTraceOnDiagnostic",
+           [](MLIRContext &self, bool v) {
+             self.printStackTraceOnDiagnostic(v);
+           })
+      // Kernels compiled concurrently, one context per worker, should not
+      // also spawn a thread pool each.
+      .def("disable_multithreading",
+           [](MLIRContext &self) { self.disableMultithreading(); });
   py::class_<SourceMgrDiagnosticHandler>(m, "source_mgr_diag",
                                          py::module_local())
       .def(py::init<llvm::SourceMgr &, MLIRContext *>());
@@ -483,6 +608,20 @@ void init_triton_ir(py::module &&m) {
                return py::none();
              return py::int_(ret.getInt());
            })
+      .def("estimate_registers",
+           [](ModuleOp &self) -> int {
+             return estimateMaxLiveRegisters(self);
+           })
+      .def("get_str_array_attr",
+           [](ModuleOp &self, std::string name) -> py::object {
+             auto ret = self->getAttrOfType<ArrayAttr>(name);
+             if (!ret)
+               return py::none();
+             py::list strs;
+             for (StringRef str : ret.getAsValueRange<StringAttr>())
+               strs.append(py::str(str.str()));
+             return strs;
+           })
       .def("create_location_snapshot",
            [](ModuleOp &self, const std::string &fileName) -> void {
              generateLocationsFromIR(/*raw_ostream=*/llvm::nulls(),
@@ -538,6 +677,24 @@ void init_triton_ir(py::module &&m) {
             self.setArgAttr(arg_no, name, IntegerAttr::get(attrTy, val));
           },
           ret::reference)
+      // Replaces the uses of an integer argument with a constant and removes
+      // the argument from the function.
+      .def("fold_arg_to_constant",
+           [](FuncOp &self, unsigned arg_no, int64_t val) {
+             if (arg_no >= self.getNumArguments())
+               throw pybind11::index_error(
+                   "Function argument index out of range");
+             BlockArgument arg = self.getArgument(arg_no);
+             auto intTy = dyn_cast<IntegerType>(arg.getType());
+             if (!intTy)
+               throw std::runtime_error(
+                   "Only integer arguments can be folded to constants");
+             auto builder = OpBuilder::atBlockBegin(&self.getBody().front());
+             Value cst = builder.create<arith::ConstantIntOp>(
+                 arg.getLoc(), val, intTy.getWidth());
+             arg.replaceAllUsesWith(cst);
+             self.eraseArgument(arg_no);
+           })
       //  .def("has_attr", &::FuncOp::hasAttr)
       .def("finalize",
            [](FuncOp &self) -> void {
@@ -717,6 +874,10 @@ void init_triton_ir(py::module &&m) {
            [](TritonOpBuilder &self) -> Type {
              return self.getBuilder().getI1Type();
            }) // or ret::copy?
+      .def("get_int4_ty",
+           [](TritonOpBuilder &self) -> Type {
+             return self.getBuilder().getIntegerType(4);
+           })
       .def("get_int8_ty",
            [](TritonOpBuilder &self) -> Type {
              return self.getBuilder().getI8Type();
@@ -793,6 +954,11 @@ void init_triton_ir(py::module &&m) {
               int column) { self.setLastLoc(fileName, line, column); })
       .def("get_loc",
            [](TritonOpBuilder &self) -> Location { return self.getLastLoc(); })
+      .def("push_loc", [](TritonOpBuilder &self) { self.pushLoc(); })
+      .def("push_loc",
+           [](TritonOpBuilder &self, const std::string &fileName, int line,
+              int column) { self.pushLoc(fileName, line, column); })
+      .def("pop_loc", [](TritonOpBuilder &self) { self.popLoc(); })
 
       // Ops
       .def("get_or_insert_function",
@@ -1257,13 +1423,29 @@ void init_triton_ir(py::module &&m) {
              self.create<StoreOp>(ptrs, val, mask, cacheModifier,
                                   evictionPolicy);
            })
+      .def("create_prefetch",
+           [](TritonOpBuilder &self, Value &ptrs,
+              std::optional<Value> &mask) -> void {
+             self.create<PrefetchOp>(ptrs, mask.value_or(Value()));
+           })
       .def("create_descriptor_load",
            [](TritonOpBuilder &self, Value &desc_ptr,
               std::vector<Value> &indices, Type type,
               CacheModifier cacheModifier,
               EvictionPolicy evictionPolicy) -> Value {
              return self.create<ExperimentalDescriptorLoadOp>(
-                 type, desc_ptr, indices, cacheModifier, evictionPolicy);
+                 type, desc_ptr, indices, /*im2col_offsets=*/ValueRange(),
+                 cacheModifier, evictionPolicy);
+           })
+      .def("create_descriptor_load_im2col",
+           [](TritonOpBuilder &self, Value &desc_ptr,
+              std::vector<Value> &indices,
+              std::vector<Value> &im2colOffsets, Type type,
+              CacheModifier cacheModifier,
+              EvictionPolicy evictionPolicy) -> Value {
+             return self.create<ExperimentalDescriptorLoadOp>(
+                 type, desc_ptr, indices, im2colOffsets, cacheModifier,
+                 evictionPolicy);
            })
       .def("create_descriptor_store",
            [](TritonOpBuilder &self, Value &desc_ptr, Value value,
@@ -1271,6 +1453,18 @@ void init_triton_ir(py::module &&m) {
              self.create<ExperimentalDescriptorStoreOp>(desc_ptr, value,
                                                         indices);
            })
+      .def("create_descriptor_reduce",
+           [](TritonOpBuilder &self, RMWOp kind, Value &desc_ptr, Value value,
+              std::vector<Value> &indices) -> void {
+             self.create<ExperimentalDescriptorReduceOp>(kind, desc_ptr, value,
+                                                         indices);
+           })
+      .def("create_descriptor_prefetch",
+           [](TritonOpBuilder &self, Value &desc_ptr,
+              std::vector<Value> &indices, Type blockType) -> void {
+             self.create<ExperimentalDescriptorPrefetchOp>(desc_ptr, indices,
+                                                           blockType);
+           })
       .def("create_reshape",
            [](TritonOpBuilder &self, Value &arg, std::vector<int64_t> &shape,
               bool allowReorder) -> Value {
@@ -1402,12 +1596,33 @@ void init_triton_ir(py::module &&m) {
                  ProgramIDDimAttr::get(self.getBuilder().getContext(),
                                        ProgramIDDim(axis)));
            })
+      .def("create_global_scratch_alloc",
+           [](TritonOpBuilder &self, int nbytes, int alignment,
+              Type &ptrType) -> Value {
+             return self.create<GlobalScratchAllocOp>(ptrType, nbytes,
+                                                      alignment);
+           })
       .def("create_dot",
            [](TritonOpBuilder &self, mlir::Value &a, mlir::Value &b,
               mlir::Value &c, InputPrecision inputPrecision,
-              int maxNumImpreciseAcc) -> mlir::Value {
+              int maxNumImpreciseAcc, int kExtent) -> mlir::Value {
              return self.create<DotOp>(c.getType(), a, b, c, inputPrecision,
-                                       maxNumImpreciseAcc);
+                                       maxNumImpreciseAcc, kExtent);
+           })
+      .def("create_sparse_dot",
+           [](TritonOpBuilder &self, mlir::Value &a, mlir::Value &b,
+              mlir::Value &c, mlir::Value &aMeta) -> mlir::Value {
+             return self.create<SparseDotOp>(c.getType(), a, b, c, aMeta);
+           })
+      .def("create_dot_scaled",
+           [](TritonOpBuilder &self, mlir::Value &lhs,
+              std::optional<mlir::Value> &lhsScale,
+              ScaleDotElemType lhsFormat, mlir::Value &rhs,
+              std::optional<mlir::Value> &rhsScale,
+              ScaleDotElemType rhsFormat, mlir::Value &c) -> mlir::Value {
+             return self.create<DotScaledOp>(
+                 c.getType(), lhs, rhs, c, lhsScale.value_or(Value()),
+                 rhsScale.value_or(Value()), lhsFormat, rhsFormat);
            })
       .def("create_floor",
            [](TritonOpBuilder &self, Value &val) -> Value {
@@ -1474,8 +1689,8 @@ void init_triton_ir(py::module &&m) {
            })
       .def("create_scan",
            [](TritonOpBuilder &self, std::vector<Value> operands, int axis,
-              bool reverse) -> OpState {
-             return self.create<ScanOp>(operands, axis, reverse);
+              bool reverse, bool segmented) -> OpState {
+             return self.create<ScanOp>(operands, axis, reverse, segmented);
            })
       .def("create_scan_ret",
            [](TritonOpBuilder &self, py::args args) -> OpState {
@@ -1529,18 +1744,39 @@ void init_triton_ir(py::module &&m) {
              self.create<AssertOp>(condition, messageAttr, fileNameAttr,
                                    funcNameAttr, lineNoAttr);
            })
+      .def("create_profile_region",
+           [](TritonOpBuilder &self, Value &buffer, Value &programIndex,
+              int regionId, bool isEnd, int capacity) -> void {
+             self.create<ProfileRegionOp>(buffer, programIndex, regionId, isEnd,
+                                          capacity);
+           })
       // Undef
       .def("create_undef",
            [](TritonOpBuilder &self, Type &type) -> Value {
              return self.create<LLVM::UndefOp>(type);
            })
       .def("create_histogram",
-           [](TritonOpBuilder &self, Value operand, int numBins) -> Value {
+           [](TritonOpBuilder &self, Value operand, int numBins,
+              std::optional<Value> &mask,
+              std::optional<Value> &weights) -> Value {
+             Type binType = IntegerType::get(operand.getContext(), 32);
+             if (weights)
+               binType = cast<RankedTensorType>(weights->getType())
+                             .getElementType();
              return self.create<HistogramOp>(
-                 RankedTensorType::get(
-                     {static_cast<int64_t>(numBins)},
-                     IntegerType::get(operand.getContext(), 32)),
-                 operand);
+                 RankedTensorType::get({static_cast<int64_t>(numBins)},
+                                       binType),
+                 operand, mask.value_or(Value()), weights.value_or(Value()));
+           })
+      .def("create_gather",
+           [](TritonOpBuilder &self, Value src, Value indices,
+              int axis) -> Value {
+             auto srcTy = cast<RankedTensorType>(src.getType());
+             auto indicesTy = cast<RankedTensorType>(indices.getType());
+             return self.create<GatherOp>(
+                 RankedTensorType::get(indicesTy.getShape(),
+                                       srcTy.getElementType()),
+                 src, indices, axis);
            })
       // Force GPU barrier
       .def("create_barrier",
@@ -1554,6 +1790,16 @@ void init_triton_ir(py::module &&m) {
              return self.create<MakeTensorPtrOp>(base, shape, strides, offsets,
                                                  tensorShape, order);
            })
+      // Make a block pointer of a tensor paged along its first dimension
+      .def("create_make_paged_block_ptr",
+           [](TritonOpBuilder &self, Value &base, std::vector<Value> &shape,
+              std::vector<Value> &strides, std::vector<Value> &offsets,
+              std::vector<int32_t> &tensorShape, std::vector<int32_t> &order,
+              Value &pageTable, int32_t pageSize) -> Value {
+             return self.create<MakeTensorPtrOp>(base, shape, strides, offsets,
+                                                 tensorShape, order, pageTable,
+                                                 pageSize);
+           })
       // Advance a block pointer
       .def("create_advance",
            [](TritonOpBuilder &self, Value &ptr,
@@ -1653,10 +1899,40 @@ void init_triton_ir(py::module &&m) {
         if (haveTiming) {
           self.enableTiming();
         }
-
-        if (failed(self.run(mod.getOperation())))
+        auto statsInstrumentation =
+            std::make_unique<PassStatsInstrumentation>();
+        PassStatsInstrumentation *passStats = statsInstrumentation.get();
+        self.addInstrumentation(std::move(statsInstrumentation));
+
+        LogicalResult result = success();
+        {
+          // The passes don't call back into Python; let other threads compile
+          // in the meantime.
+          py::gil_scoped_release allow_threads;
+          result = self.run(mod.getOperation());
+        }
+        std::vector<PassStats> &threadStats = getThreadPassStats();
+        for (PassStats &stats : passStats->takeStats())
+          threadStats.push_back(std::move(stats));
+        if (failed(result))
           throw std::runtime_error("PassManager::run failed");
       });
+
+  // Returns the statistics of the passes run by the current thread since the
+  // last call, one dict per pass of each pass manager run.
+  m.def("take_pass_stats", []() {
+    py::list ret;
+    for (const PassStats &stats : getThreadPassStats()) {
+      py::dict dict;
+      dict["pass"] = stats.name;
+      dict["time"] = stats.seconds;
+      dict["ops_before"] = stats.opsBefore;
+      dict["ops_after"] = stats.opsAfter;
+      ret.append(dict);
+    }
+    getThreadPassStats().clear();
+    return ret;
+  });
 }
 
 void init_triton_env_vars(py::module &m) {
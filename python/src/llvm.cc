@@ -3,6 +3,7 @@
 #include "mlir/Target/LLVMIR/ModuleTranslation.h"
 #include "triton/Tools/Sys/GetEnv.hpp"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
@@ -17,6 +18,8 @@
 #include "llvm/Passes/PassPlugin.h"
 #include "llvm/Passes/StandardInstrumentations.h"
 #include "llvm/Support/CodeGen.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetSelect.h"
@@ -24,6 +27,7 @@
 #include "llvm/Transforms/IPO/AlwaysInliner.h"
 #include "llvm/Transforms/InstCombine/InstCombine.h"
 #include <csignal>
+#include <mutex>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <stdexcept>
@@ -146,6 +150,46 @@ std::string translateLLVMIRToASM(llvm::Module &module,
   return result;
 }
 
+// Returns the contents of the extern library at `path`, which are read once
+// per process, and again only if the file changes.  The modules are loaded
+// lazily from them, so that only the functions the kernels call are parsed.
+std::shared_ptr<llvm::MemoryBuffer> getExternLib(const std::string &path) {
+  struct ExternLib {
+    llvm::sys::TimePoint<> modificationTime;
+    uint64_t size;
+    std::shared_ptr<llvm::MemoryBuffer> buffer;
+  };
+  static std::mutex mutex;
+  static llvm::StringMap<ExternLib> libs;
+
+  llvm::sys::fs::file_status status;
+  if (llvm::sys::fs::status(path, status))
+    throw std::invalid_argument("Failed to read library at " + path);
+  std::lock_guard<std::mutex> lock(mutex);
+  ExternLib &lib = libs[path];
+  if (!lib.buffer ||
+      lib.modificationTime != status.getLastModificationTime() ||
+      lib.size != status.getSize()) {
+    auto buffer = llvm::MemoryBuffer::getFile(path);
+    if (!buffer)
+      throw std::invalid_argument("Failed to read library at " + path);
+    lib = {status.getLastModificationTime(), status.getSize(),
+           std::move(*buffer)};
+  }
+  return lib.buffer;
+}
+
+// The passes of the default pipelines that matter for the IR generated by
+// Triton, whose loops are already unrolled and whose operations are already
+// vectorized: the loop unrolling and vectorization passes only cost time.
+// The SLP vectorizer is kept for its scheduling of the memory operations.
+constexpr const char *kTritonPipeline =
+    "cgscc(inline),"
+    "function(sroa,early-cse<memssa>,instcombine,simplifycfg,"
+    "break-struct-phi-nodes,instcombine,gvn,loop-mssa(licm),slp-vectorizer,"
+    "dse,adce,instcombine,simplifycfg),"
+    "globaldce";
+
 using ret = py::return_value_policy;
 
 void init_triton_llvm(py::module &&m) {
@@ -251,7 +295,7 @@ void init_triton_llvm(py::module &&m) {
   m.def(
       "optimize_module",
       [](llvm::Module *mod, const llvm::OptimizationLevel &opt,
-         const std::string triple) {
+         const std::string triple, const std::string &pipeline) {
         if (mlir::triton::tools::getBoolEnv("DISABLE_LLVM_OPT"))
           return;
         // Check to see if we are passing a list of flags to disable
@@ -277,15 +321,25 @@ void init_triton_llvm(py::module &&m) {
 
         PassInstrumentationCallbacks *instrCbPtr = nullptr;
         PassInstrumentationCallbacks passInstrCb;
+        const bool enabledDump =
+            mlir::triton::tools::getBoolEnv("LLVM_IR_ENABLE_DUMP");
+        const bool enabledTiming =
+            mlir::triton::tools::getBoolEnv("LLVM_ENABLE_TIMING");
+        if (enabledTiming) {
+          llvm::TimePassesIsEnabled = true;
+          llvm::TimePassesPerRun = true;
+        }
         StandardInstrumentations standardInstr(mod->getContext(),
-                                               /*DebugLogging*/ true);
-        if (mlir::triton::tools::getBoolEnv("LLVM_IR_ENABLE_DUMP")) {
+                                               /*DebugLogging*/ enabledDump);
+        if (enabledDump) {
           auto optMap = llvm::cl::getRegisteredOptions();
           auto optIt = optMap.find("print-after-all");
           if (optIt != optMap.end()) {
             auto optPtr = static_cast<llvm::cl::opt<bool> *>(optIt->second);
             *optPtr = true;
           }
+        }
+        if (enabledDump || enabledTiming) {
           standardInstr.registerCallbacks(passInstrCb, &mam);
           instrCbPtr = &passInstrCb;
         }
@@ -331,18 +385,46 @@ void init_triton_llvm(py::module &&m) {
         pb.crossRegisterProxies(lam, fam, cgam, mam);
 
         ModulePassManager mpm;
-        pb.registerVectorizerStartEPCallback(
-            [&](llvm::FunctionPassManager &fpm, llvm::OptimizationLevel level) {
-              // Triton generates large structure of scalars which may pessimise
-              // optimizations, we run a pass to break up phi of struct to make
-              // sure all the struct are removed for the following passes.
+        pb.registerPipelineParsingCallback(
+            [](StringRef name, llvm::FunctionPassManager &fpm,
+               ArrayRef<PassBuilder::PipelineElement>) {
+              if (name != "break-struct-phi-nodes")
+                return false;
               fpm.addPass(BreakStructPhiNodesPass());
-              fpm.addPass(InstCombinePass());
+              return true;
             });
-        mpm.addPass(pb.buildPerModuleDefaultPipeline(opt));
-        mpm.run(*mod, mam);
+        if (pipeline.empty()) {
+          pb.registerVectorizerStartEPCallback(
+              [&](llvm::FunctionPassManager &fpm,
+                  llvm::OptimizationLevel level) {
+                // Triton generates large structure of scalars which may
+                // pessimise optimizations, we run a pass to break up phi of
+                // struct to make sure all the struct are removed for the
+                // following passes.
+                fpm.addPass(BreakStructPhiNodesPass());
+                fpm.addPass(InstCombinePass());
+              });
+          mpm.addPass(pb.buildPerModuleDefaultPipeline(opt));
+        } else {
+          StringRef text =
+              pipeline == "triton" ? kTritonPipeline : StringRef(pipeline);
+          if (llvm::Error err = pb.parsePassPipeline(mpm, text))
+            throw std::invalid_argument("Invalid LLVM pass pipeline: " +
+                                        llvm::toString(std::move(err)));
+        }
+        {
+          py::gil_scoped_release allow_threads;
+          mpm.run(*mod, mam);
+        }
+        if (enabledTiming) {
+          SmallString<0> timePassesStr;
+          raw_svector_ostream reportStream(timePassesStr);
+          reportAndResetTimings(&reportStream);
+          llvm::dbgs() << reportStream.str();
+        }
       },
-      py::arg("mod"), py::arg("opt"), py::arg("triple") = "");
+      py::arg("mod"), py::arg("opt"), py::arg("triple") = "",
+      py::arg("pipeline") = "");
 
   m.def(
       "translate_to_asm",
@@ -394,8 +476,12 @@ void init_triton_llvm(py::module &&m) {
     LLVMContext &ctx = dstMod->getContext();
     llvm::Linker linker(*dstMod);
     for (const std::string &path : paths) {
+      std::shared_ptr<llvm::MemoryBuffer> lib = getExternLib(path);
       llvm::SMDiagnostic err;
-      std::unique_ptr<llvm::Module> libMod = llvm::parseIRFile(path, err, ctx);
+      std::unique_ptr<llvm::Module> libMod = llvm::getLazyIRModule(
+          llvm::MemoryBuffer::getMemBuffer(lib->getMemBufferRef(),
+                                           /*RequiresNullTerminator=*/false),
+          err, ctx);
       if (!libMod) {
         std::string message = "Failed to parse library at " + path;
         throw std::invalid_argument(message);
@@ -39,6 +39,13 @@ void init_triton_passes_ttir(py::module &&m) {
   ADD_PASS_WRAPPER_0("add_reorder_broadcast", createReorderBroadcastPass);
   ADD_PASS_WRAPPER_0("add_rewrite_tensor_pointer",
                      createRewriteTensorPointerPass);
+  ADD_PASS_WRAPPER_0("add_decompose_scaled_dot", createDecomposeScaledDotPass);
+  ADD_PASS_WRAPPER_0("add_fold_masks", createFoldMasksPass);
+  ADD_PASS_WRAPPER_0("add_narrow_pointer_offsets",
+                     createNarrowPointerOffsetsPass);
+  ADD_PASS_WRAPPER_0("add_loop_unroll", createLoopUnrollPass);
+  ADD_PASS_WRAPPER_2("add_rasterize_program_ids",
+                     createRasterizeProgramIdsPass, const std::string &, int);
   ADD_PASS_WRAPPER_4("add_convert_to_ttgpuir",
                      createConvertTritonToTritonGPUPass, const std::string &,
                      int, int, int);
@@ -49,7 +56,8 @@ void init_triton_passes_ttgpuir(py::module &&m) {
   ADD_PASS_WRAPPER_0("add_coalesce", createTritonGPUCoalesce);
   ADD_PASS_WRAPPER_0("add_optimize_thread_locality",
                      createTritonGPUOptimizeThreadLocality);
-  ADD_PASS_OPTION_WRAPPER_1("add_pipeline", createTritonGPUPipeline, int);
+  ADD_PASS_OPTION_WRAPPER_2("add_pipeline", createTritonGPUPipeline, int,
+                            int);
   ADD_PASS_WRAPPER_0("add_prefetch", createTritonGPUPrefetch);
   ADD_PASS_WRAPPER_0("add_accelerate_matmul", createTritonGPUAccelerateMatmul);
   ADD_PASS_WRAPPER_0("add_reorder_instructions",
@@ -63,8 +71,14 @@ void init_triton_passes_ttgpuir(py::module &&m) {
                      createTritonGPUReduceDataDuplication);
   ADD_PASS_WRAPPER_0("add_allocate_shared_memory",
                      createAllocateSharedMemoryPass);
+  ADD_PASS_WRAPPER_0("add_allocate_global_scratch_memory",
+                     createAllocateGlobalScratchMemoryPass);
   ADD_PASS_WRAPPER_0("add_combine_tensor_select_and_if",
                      createTritonGPUCombineTensorSelectAndIf);
+  ADD_PASS_WRAPPER_0("add_optimize_epilogue", createTritonGPUOptimizeEpilogue);
+  ADD_PASS_WRAPPER_0("add_print_layout_info", createTritonGPUPrintLayoutInfo);
+  ADD_PASS_OPTION_WRAPPER_1("add_spill_to_shared_memory",
+                            createTritonGPUSpillToSharedMemory, int);
 }
 
 void init_triton_passes_convert(py::module &&m) {
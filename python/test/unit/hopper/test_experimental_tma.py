@@ -4,7 +4,8 @@ import tempfile
 
 import triton
 import triton.language as tl
-from triton.tools.experimental_descriptor import create_1d_tma_descriptor, create_2d_tma_descriptor
+from triton.tools.experimental_descriptor import (create_1d_tma_descriptor, create_2d_tma_descriptor,
+                                                  create_2d_tma_descriptor_device, create_im2col_tma_descriptor)
 
 
 def test_descriptor_load_ttgir():
@@ -71,6 +72,35 @@ def test_experimetal_descriptor_load():
     assert torch.equal(x, z_tri)
 
 
+def test_experimental_descriptor_load_im2col():
+    if not torch.cuda.is_available() or not torch.cuda.get_device_capability()[0] == 9:
+        pytest.skip("Test requires Hopper target.")
+        return
+    device = "cuda"
+    H, W, C, R, S = 8, 8, 64, 3, 3
+
+    @triton.jit
+    def kernel(Z, desc, S: tl.constexpr, BLOCK_P: tl.constexpr, BLOCK_C: tl.constexpr):
+        r = tl.program_id(0)
+        s = tl.program_id(1)
+        # The pixels of the first image, from the corner of the padding.
+        x = tl._experimental_descriptor_load_im2col(desc, [0, -1, -1, 0], [r, s], [BLOCK_P, BLOCK_C], tl.float16)
+        offs_p = tl.arange(0, BLOCK_P)
+        offs_c = tl.arange(0, BLOCK_C)
+        tl.store(Z + ((r * S + s) * BLOCK_P + offs_p[:, None]) * BLOCK_C + offs_c[None, :], x)
+
+    x = torch.randn((2, H, W, C), dtype=torch.float16, device=device)
+    # A 3x3 filter with a padding of 1 keeps the image size.
+    desc = create_im2col_tma_descriptor(x.data_ptr(), x.shape, (-1, -1), (1 - (R - 1), 1 - (S - 1)), C, H * W,
+                                        x.element_size())
+    z_tri = torch.empty((R, S, H * W, C), dtype=x.dtype, device=device)
+    kernel[(R, S)](z_tri, desc, S=S, BLOCK_P=H * W, BLOCK_C=C, num_warps=4)
+    x_pad = torch.nn.functional.pad(x, (0, 0, 1, 1, 1, 1))
+    for r in range(R):
+        for s in range(S):
+            assert torch.equal(z_tri[r, s], x_pad[0, r:r + H, s:s + W].reshape(H * W, C))
+
+
 @triton.jit
 def matmul_kernel_tma(a_desc_ptr, b_desc_ptr, c_desc_ptr,  #
                       M, N, K, BLOCK_SIZE_M: tl.constexpr, BLOCK_SIZE_N: tl.constexpr, BLOCK_SIZE_K: tl.constexpr):
@@ -113,3 +143,107 @@ def test_experimental_tma_matmul(num_stages, BLOCK_M, BLOCK_N, BLOCK_K):
     torch.testing.assert_close(ref_out, C, rtol=1e-3, atol=1e-3)
     if BLOCK_M >= 64 and BLOCK_N >= 64:
         assert "stmatrix.sync.aligned.m8n8.x4.shared.b16" in kernel.asm["ptx"]
+
+
+@triton.jit
+def split_k_matmul_kernel_tma(a_desc_ptr, b_desc_ptr, c_desc_ptr,  #
+                              M, N, K, BLOCK_SIZE_M: tl.constexpr, BLOCK_SIZE_N: tl.constexpr,
+                              BLOCK_SIZE_K: tl.constexpr, SPLIT_K: tl.constexpr):
+    pid = tl.program_id(axis=0)
+    pid_k = tl.program_id(axis=1)
+    num_pid_m = tl.cdiv(M, BLOCK_SIZE_M)
+    offs_am = (pid % num_pid_m) * BLOCK_SIZE_M
+    offs_bn = (pid // num_pid_m) * BLOCK_SIZE_N
+    accumulator = tl.zeros((BLOCK_SIZE_M, BLOCK_SIZE_N), dtype=tl.float32)
+    for k in range(pid_k, tl.cdiv(K, BLOCK_SIZE_K), SPLIT_K):
+        offs_k = k * BLOCK_SIZE_K
+        a = tl._experimental_descriptor_load(a_desc_ptr, [offs_am, offs_k], [BLOCK_SIZE_M, BLOCK_SIZE_K], tl.float16)
+        b = tl._experimental_descriptor_load(b_desc_ptr, [offs_k, offs_bn], [BLOCK_SIZE_K, BLOCK_SIZE_N], tl.float16)
+        accumulator = tl.dot(a, b, acc=accumulator)
+    # The partial results of the splits are summed by one bulk reduction each.
+    tl._experimental_descriptor_atomic_add(c_desc_ptr, accumulator, [offs_am, offs_bn])
+
+
+@pytest.mark.parametrize("SPLIT_K", [2, 4])
+def test_experimental_tma_split_k_matmul(SPLIT_K):
+    if not torch.cuda.is_available() or not torch.cuda.get_device_capability()[0] == 9:
+        pytest.skip("Test requires Hopper target.")
+        return
+    device = "cuda"
+    M, N, K = 512, 512, 2048
+    BLOCK_M, BLOCK_N, BLOCK_K = 128, 64, 64
+    torch.manual_seed(42)
+    A = torch.randn((M, K), dtype=torch.float16, device=device)
+    B = torch.randn((K, N), dtype=torch.float16, device=device)
+    C = torch.zeros((M, N), dtype=torch.float32, device=device)
+    desc_a = create_2d_tma_descriptor(A.data_ptr(), M, K, BLOCK_M, BLOCK_K, A.element_size())
+    desc_b = create_2d_tma_descriptor(B.data_ptr(), K, N, BLOCK_K, BLOCK_N, B.element_size())
+    # The reduction adds floats, so the descriptor must not be untyped.
+    desc_c = create_2d_tma_descriptor(C.data_ptr(), M, N, BLOCK_M, BLOCK_N, C.element_size(), dtype=C.dtype)
+    kernel = split_k_matmul_kernel_tma[(triton.cdiv(M, BLOCK_M) * triton.cdiv(N, BLOCK_N), SPLIT_K,
+                                        1)](desc_a, desc_b, desc_c, M, N, K, BLOCK_M, BLOCK_N, BLOCK_K, SPLIT_K,
+                                            num_warps=8)
+    ref_out = torch.matmul(A.to(torch.float32), B.to(torch.float32))
+    torch.testing.assert_close(ref_out, C, rtol=1e-3, atol=1e-3)
+    assert "cp.reduce.async.bulk.tensor.2d.global.shared::cta.add.tile.bulk_group" in kernel.asm["ptx"]
+
+
+def test_tma_descriptor_cache():
+    if not torch.cuda.is_available() or not torch.cuda.get_device_capability()[0] == 9:
+        pytest.skip("Test requires Hopper target.")
+        return
+    x = torch.randn((64, 64), dtype=torch.float16, device="cuda")
+    desc = create_2d_tma_descriptor(x.data_ptr(), 64, 64, 32, 32, x.element_size())
+    assert create_2d_tma_descriptor(x.data_ptr(), 64, 64, 32, 32, x.element_size()) is desc
+    assert create_2d_tma_descriptor(x.data_ptr(), 64, 64, 64, 32, x.element_size()) is not desc
+    assert create_2d_tma_descriptor(x.data_ptr(), 64, 64, 32, 32, x.element_size(), cache=False) is not desc
+
+
+@triton.jit
+def grouped_copy_kernel_tma(template_desc_ptr, desc_ptrs, in_ptrs, out_ptrs, Ms, N, BLOCK_M: tl.constexpr,
+                            BLOCK_N: tl.constexpr):
+    group = tl.program_id(axis=0)
+    desc_ptr = desc_ptrs + group * 128
+    in_ptr = tl.load(in_ptrs + group).to(tl.pointer_type(tl.float16))
+    out_ptr = tl.load(out_ptrs + group).to(tl.pointer_type(tl.float16))
+    M = tl.load(Ms + group)
+    create_2d_tma_descriptor_device(desc_ptr, template_desc_ptr, in_ptr, M, N, 2)
+    offs_m = tl.arange(0, BLOCK_M)
+    offs_n = tl.arange(0, BLOCK_N)
+    for m in range(0, tl.cdiv(M, BLOCK_M)):
+        x = tl._experimental_descriptor_load(desc_ptr, [m * BLOCK_M, 0], [BLOCK_M, BLOCK_N], tl.float16)
+        rows = m * BLOCK_M + offs_m[:, None]
+        tl.store(out_ptr + rows * N + offs_n[None, :], x, mask=rows < M)
+
+
+def test_device_tma_descriptor():
+    if not torch.cuda.is_available() or not torch.cuda.get_device_capability()[0] == 9:
+        pytest.skip("Test requires Hopper target.")
+        return
+    device = "cuda"
+    BLOCK_M, BLOCK_N = 64, 64
+    Ms = [64, 192, 100]
+    inputs = [torch.randn((M, BLOCK_N), dtype=torch.float16, device=device) for M in Ms]
+    outputs = [torch.empty_like(x) for x in inputs]
+    template = create_2d_tma_descriptor(inputs[0].data_ptr(), Ms[0], BLOCK_N, BLOCK_M, BLOCK_N, 2)
+    descs = torch.empty((len(Ms), 128), dtype=torch.int8, device=device)
+    in_ptrs = torch.tensor([x.data_ptr() for x in inputs], dtype=torch.int64, device=device)
+    out_ptrs = torch.tensor([x.data_ptr() for x in outputs], dtype=torch.int64, device=device)
+    Ms_tensor = torch.tensor(Ms, dtype=torch.int32, device=device)
+    grouped_copy_kernel_tma[(len(Ms), )](template, descs, in_ptrs, out_ptrs, Ms_tensor, BLOCK_N, BLOCK_M, BLOCK_N)
+    for x, z in zip(inputs, outputs):
+        assert torch.equal(x, z)
+
+
+@pytest.mark.parametrize("dtype", [torch.float16, torch.bfloat16])
+def test_grouped_matmul_tma(dtype):
+    if not torch.cuda.is_available() or not torch.cuda.get_device_capability()[0] == 9:
+        pytest.skip("Test requires Hopper target.")
+    from triton.tools.grouped_gemm import grouped_matmul
+    # Groups of different sizes, with an empty one and edge tiles.
+    shapes = [(256, 128, 64), (0, 128, 64), (100, 200, 72), (512, 64, 256)]
+    group_A = [torch.randn((M, K), dtype=dtype, device="cuda") for M, N, K in shapes]
+    group_B = [torch.randn((K, N), dtype=dtype, device="cuda") for M, N, K in shapes]
+    group_C = grouped_matmul(group_A, group_B)
+    for A, B, C in zip(group_A, group_B, group_C):
+        torch.testing.assert_close(C, torch.matmul(A, B), atol=1e-1, rtol=1e-2)
@@ -102,3 +102,33 @@ def test_block_ptr_matmul_no_scf(shape, num_warps, device):
         num_warps=num_warps)
     golden = torch.matmul(a, b)
     torch.testing.assert_close(c, golden, check_dtype=False)
+
+
+@triton.jit
+def paged_copy_kernel(cache_ptr, page_table_ptr, out_ptr, seq_len, stride, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr,
+                      PAGE_SIZE: tl.constexpr):
+    pid = tl.program_id(0)
+    cache_block_ptr = tl.make_block_ptr(base=cache_ptr, shape=(seq_len, BLOCK_N), strides=(stride, 1),
+                                        offsets=(0, 0), block_shape=(BLOCK_M, BLOCK_N), order=(1, 0),
+                                        page_table=page_table_ptr, page_size=PAGE_SIZE)
+    cache_block_ptr = tl.advance(cache_block_ptr, (pid * BLOCK_M, 0))
+    out_block_ptr = tl.make_block_ptr(base=out_ptr, shape=(seq_len, BLOCK_N), strides=(BLOCK_N, 1),
+                                      offsets=(pid * BLOCK_M, 0), block_shape=(BLOCK_M, BLOCK_N), order=(1, 0))
+    x = tl.load(cache_block_ptr, boundary_check=(0, ), padding_option="zero")
+    tl.store(out_block_ptr, x, boundary_check=(0, ))
+
+
+@pytest.mark.interpreter
+@pytest.mark.parametrize("seq_len, page_size, BLOCK_M", [(100, 16, 32), (64, 32, 16), (37, 8, 64)])
+def test_paged_block_ptr(seq_len, page_size, BLOCK_M, device):
+    BLOCK_N = 32
+    num_pages = triton.cdiv(seq_len, page_size)
+    # The pages of the sequence are scattered among more pages of the cache.
+    cache = torch.randn((3 * num_pages * page_size, BLOCK_N), device=device, dtype=torch.float16)
+    page_table = torch.randperm(3 * num_pages, device=device)[:num_pages].to(torch.int32)
+    out = torch.empty((seq_len, BLOCK_N), device=device, dtype=torch.float16)
+    grid = (triton.cdiv(seq_len, BLOCK_M), )
+    paged_copy_kernel[grid](cache, page_table, out, seq_len, cache.stride(0), BLOCK_M, BLOCK_N, page_size)
+    rows = torch.arange(seq_len, device=device)
+    expected = cache[page_table[rows // page_size].long() * page_size + rows % page_size]
+    assert torch.equal(out, expected)
@@ -180,11 +180,12 @@ class MfmaLayout:
 
 class WmmaLayout:
 
-    def __init__(self, warps_per_cta):
+    def __init__(self, warps_per_cta, version=1):
+        self.version = version
         self.warps_per_cta = warps_per_cta
 
     def __str__(self):
-        return f"#{GPU_DIALECT}.amd_wmma<{{warpsPerCTA = {self.warps_per_cta}}}>"
+        return f"#{GPU_DIALECT}.amd_wmma<{{version = {self.version}, warpsPerCTA = {self.warps_per_cta}}}>"
 
 
 class MmaLayout:
@@ -241,7 +242,10 @@ def is_layout_applicable(layout) -> bool:
         target_arch = triton.runtime.driver.active.get_current_target().arch
         if "gfx11" in target_arch:
             # RDNA 3
-            return isinstance(layout, WmmaLayout)
+            return isinstance(layout, WmmaLayout) and layout.version == 1
+        elif "gfx12" in target_arch:
+            # RDNA 4
+            return isinstance(layout, WmmaLayout) and layout.version == 2
         elif any(arch for arch in ["gfx8", "gfx9"] if arch in target_arch):
             # CDNA 1, 2, 3
             return isinstance(layout, MfmaLayout)
@@ -917,6 +921,36 @@ def test_where_broadcast(num_ctas, device):
     assert (z == to_numpy(z_tri)).all()
 
 
+@pytest.mark.interpreter
+def test_elementwise_chain(device):
+    # A long chain of elementwise ops over broadcast operands, which the interpreter evaluates in blocks of rows
+    M, N = 256, 128
+
+    @triton.jit
+    def kernel(x_ptr, row_ptr, col_ptr, out_ptr, M: tl.constexpr, N: tl.constexpr):
+        offs_m = tl.arange(0, M)[:, None]
+        offs_n = tl.arange(0, N)[None, :]
+        x = tl.load(x_ptr + offs_m * N + offs_n)
+        row = tl.load(row_ptr + offs_n)
+        col = tl.load(col_ptr + offs_m)
+        y = x * row + col
+        z = y * y
+        for _ in tl.static_range(20):
+            z = tl.where(z > 1.0, z * 0.5, z + y)
+        tl.store(out_ptr + offs_m * N + offs_n, tl.exp(-z) + y)
+
+    x = torch.rand((M, N), dtype=torch.float32, device=device)
+    row = torch.rand((N, ), dtype=torch.float32, device=device)
+    col = torch.rand((M, ), dtype=torch.float32, device=device)
+    out = torch.empty((M, N), dtype=torch.float32, device=device)
+    kernel[(1, )](x, row, col, out, M, N)
+    y = x * row[None, :] + col[:, None]
+    z = y * y
+    for _ in range(20):
+        z = torch.where(z > 1.0, z * 0.5, z + y)
+    torch.testing.assert_close(out, torch.exp(-z) + y)
+
+
 # ---------------
 # test unary ops
 # ---------------
@@ -1313,8 +1347,21 @@ def noinline_multi_values_fn(x, y, Z):
     tl.store(Z, z)
 
 
+@triton.jit(noinline=True)
+def noinline_call_tensors_fn(a, b):
+    return a + b, tl.sum(a, axis=1)
+
+
+@triton.jit(noinline=True)
+def noinline_tensors_fn(x, y, Z):
+    offs = tl.arange(0, 16)[:, None] * 16 + tl.arange(0, 16)[None, :]
+    z = tl.load(Z + offs)
+    z, s = noinline_call_tensors_fn(z + x, z + y)
+    tl.store(Z + offs, z + s[:, None])
+
+
 @pytest.mark.interpreter
-@pytest.mark.parametrize("mode", ["simple", "call_graph", "shared", "dynamic", "multi_values"])
+@pytest.mark.parametrize("mode", ["simple", "call_graph", "shared", "dynamic", "multi_values", "tensors"])
 def test_noinline(mode, device):
 
     @triton.jit
@@ -1327,7 +1374,7 @@ def test_noinline(mode, device):
     kernel = patch_kernel(kernel, {'GENERATE_TEST_HERE': func_name})
     x = torch.tensor([1.0], device=device, dtype=torch.float32)
     y = torch.tensor([2.0], device=device, dtype=torch.float32)
-    if mode == "shared":
+    if mode == "shared" or mode == "tensors":
         z = torch.ones((16, 16), device=device, dtype=torch.float32)
     else:
         z = torch.tensor([0.0], device=device, dtype=torch.float32)
@@ -1339,6 +1386,8 @@ def test_noinline(mode, device):
     elif mode == "shared":
         ref = torch.full((16, 16), 16, device=device, dtype=torch.float32)
         assert torch.equal(z, ref + x + y)
+    elif mode == "tensors":
+        assert torch.equal(z, torch.full((16, 16), 17, device=device, dtype=torch.float32) * (1 + x) + 1 + y)
 
 
 # ---------------
@@ -1417,11 +1466,12 @@ def test_atomic_rmw(op, dtype_x_str, mode, sem, device):
         assert z_ref.item() == to_numpy(z_tri).item()
     else:
         np.testing.assert_allclose(z_ref, to_numpy(z_tri), rtol=0.01)
-    sem_str = "acq_rel" if sem is None else sem
     if not is_cuda():
         return
 
-    assert f"atom.global.gpu.{sem_str}" in h.asm["ptx"]
+    # `old` is unused, so the atomic is a red which only keeps the release of its semantics.
+    sem_str = "release" if sem in [None, 'release', 'acq_rel'] else "relaxed"
+    assert f"red.global.gpu.{sem_str}" in h.asm["ptx"]
 
 
 @pytest.mark.interpreter
@@ -1473,6 +1523,30 @@ def test_tensor_atomic_rmw(shape, axis, num_ctas, dtype_x_str, device):
     np.testing.assert_allclose(z_ref, to_numpy(z_tri), rtol=1e-4)
 
 
+@pytest.mark.interpreter
+@pytest.mark.parametrize("num_bins", [1, 4, 32, 1024])
+@pytest.mark.parametrize("dtype_x_str", ['int32', 'float32'])
+def test_tensor_atomic_add_uniform_address(num_bins, dtype_x_str, device):
+    BLOCK = 1024
+
+    # Each group of BLOCK // num_bins elements adds to the same address.
+    @triton.jit
+    def kernel(Z, X, M, BLOCK: tl.constexpr, GROUP: tl.constexpr):
+        offs = tl.arange(0, BLOCK)
+        x = tl.load(X + offs)
+        mask = tl.load(M + offs) != 0
+        tl.atomic_add(Z + offs // GROUP, x, mask=mask, sem='relaxed')
+
+    rs = RandomState(17)
+    x = rs.randint(-8, 8, BLOCK).astype(dtype_x_str)
+    mask = rs.randint(0, 2, BLOCK).astype(np.int32)
+    group = BLOCK // num_bins
+    z_ref = np.sum((x * mask).reshape(num_bins, group), axis=1)
+    z_tri = to_triton(np.zeros(num_bins, dtype=dtype_x_str), device=device)
+    kernel[(1, )](z_tri, to_triton(x, device=device), to_triton(mask, device=device), BLOCK, group)
+    np.testing.assert_equal(z_ref, to_numpy(z_tri))
+
+
 @pytest.mark.interpreter
 @pytest.mark.parametrize("num_ctas", num_ctas_list)
 def test_tensor_atomic_rmw_block(num_ctas, device):
@@ -1678,6 +1752,35 @@ def test_cat(dtype_str, num_warps, device):
     assert z.unique().size(0) == z.size(0)
 
 
+@pytest.mark.interpreter
+@pytest.mark.parametrize("shape", [(128, ), (4, ), (16, 8), (2, 64)])
+@pytest.mark.parametrize("num_warps", [1, 4])
+def test_cat_ordered(shape, num_warps, device):
+
+    @triton.jit
+    def kernel(X, Y, Z, M: tl.constexpr, N: tl.constexpr):
+        offs = tl.arange(0, M)[:, None] * N + tl.arange(0, N)[None, :]
+        x = tl.load(X + offs)
+        y = tl.load(Y + offs)
+        z = tl.cat(x, y)
+        tl.store(Z + tl.arange(0, 2 * M)[:, None] * N + tl.arange(0, N)[None, :], z)
+
+    @triton.jit
+    def kernel_1d(X, Y, Z, M: tl.constexpr):
+        offs = tl.arange(0, M)
+        z = tl.cat(tl.load(X + offs), tl.load(Y + offs))
+        tl.store(Z + tl.arange(0, 2 * M), z)
+
+    x = torch.arange(0, math.prod(shape), device=device, dtype=torch.int32).reshape(shape)
+    y = -1 - x
+    z = torch.empty((2 * shape[0], ) + shape[1:], device=device, dtype=torch.int32)
+    if len(shape) == 1:
+        kernel_1d[(1, )](x, y, z, M=shape[0], num_warps=num_warps)
+    else:
+        kernel[(1, )](x, y, z, M=shape[0], N=shape[1], num_warps=num_warps)
+    torch.testing.assert_close(z, torch.cat([x, y], dim=0))
+
+
 @pytest.mark.interpreter
 @pytest.mark.parametrize("dtype_str", list(torch_dtypes))
 @pytest.mark.parametrize("num_ctas", num_ctas_list)
@@ -1837,6 +1940,36 @@ def test_join_with_mma(device):
     torch.testing.assert_close(z, z_ref)
 
 
+@pytest.mark.parametrize("signed", [False, True])
+def test_int4_dequant_dot(signed, device):
+    if not is_cuda():
+        pytest.skip("Only CUDA has a vectorized int4 conversion")
+
+    @triton.jit
+    def kernel(A, W, Z, M: tl.constexpr, N: tl.constexpr, K: tl.constexpr, SIGNED: tl.constexpr):
+        a = tl.load(A + K * tl.arange(0, M)[:, None] + tl.arange(0, K)[None, :])
+        # Each byte packs two consecutive rows of the weights, the first one in its low nibble.
+        w = tl.load(W + N * tl.arange(0, K // 2)[:, None] + tl.arange(0, N)[None, :])
+        if SIGNED:
+            w = tl.join(w.to(tl.int4), (w >> 4).to(tl.int4))
+        else:
+            w = tl.join(w.to(tl.uint4), (w >> 4).to(tl.uint4))
+        # Convert while the pairs of values are contiguous in registers.
+        w = w.to(tl.float16).permute(0, 2, 1).reshape(K, N)
+        z = tl.dot(a, w)
+        tl.store(Z + N * tl.arange(0, M)[:, None] + tl.arange(0, N)[None, :], z)
+
+    M, N, K = 32, 32, 64
+    lo, hi = (-8, 8) if signed else (0, 16)
+    w = torch.randint(lo, hi, (K, N), device=device, dtype=torch.int32)
+    packed = ((w[0::2] & 0xF) | ((w[1::2] & 0xF) << 4)).to(torch.uint8)
+    packed = packed.view(torch.int8) if signed else packed
+    a = torch.randn((M, K), device=device, dtype=torch.float16)
+    z = torch.empty((M, N), device=device, dtype=torch.float32)
+    kernel[(1, )](a, packed, z, M, N, K, SIGNED=signed)
+    torch.testing.assert_close(z, torch.matmul(a.float(), w.float()))
+
+
 @pytest.mark.interpreter
 @pytest.mark.parametrize("debug", [False, True])
 def test_interleave(device, debug):
@@ -2400,6 +2533,60 @@ def test_scan2d(op, dtype_str, shape, axis, reverse, num_warps, device):
         np.testing.assert_equal(z_ref, z_tri)
 
 
+@triton.jit
+def segmented_add(a, b):
+    return a + b
+
+
+@pytest.mark.interpreter
+@pytest.mark.parametrize("op", ['segmented_add', 'get_first_element'])
+@pytest.mark.parametrize("shape", [(8, 32), (32, 16), (2, 1024), (1024, 2)])
+@pytest.mark.parametrize("axis", [0, 1])
+@pytest.mark.parametrize("reverse", [False, True])
+@pytest.mark.parametrize("num_warps", [4])
+def test_segmented_scan(op, shape, axis, reverse, num_warps, device):
+
+    @triton.jit
+    def kernel(X, F, Z, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, AXIS: tl.constexpr, REVERSE: tl.constexpr):
+        offs = tl.arange(0, BLOCK_M)[:, None] * BLOCK_N + tl.arange(0, BLOCK_N)[None, :]
+        x = tl.load(X + offs)
+        f = tl.load(F + offs)
+        z = tl.associative_scan(x, AXIS, COMBINE_FN, reverse=REVERSE, flags=f)
+        tl.store(Z + offs, z)
+
+    kernel = patch_kernel(kernel, {'COMBINE_FN': op})
+
+    rs = RandomState(17)
+    x = rs.randint(-8, 8, shape).astype(np.int32)
+    flags = (rs.randint(0, 8, shape) == 0).astype(np.int8)
+
+    # The scan restarts at the flagged elements, in the direction of the scan.
+    x_ref = np.moveaxis(x, axis, -1)
+    f_ref = np.moveaxis(flags, axis, -1)
+    if reverse:
+        x_ref = np.flip(x_ref, -1)
+        f_ref = np.flip(f_ref, -1)
+    z_ref = np.empty_like(x_ref)
+    for row in np.ndindex(x_ref.shape[:-1]):
+        acc = x_ref[row][0]
+        for i in range(x_ref.shape[-1]):
+            if i == 0 or f_ref[row][i]:
+                acc = x_ref[row][i]
+            elif op == 'segmented_add':
+                acc = acc + x_ref[row][i]
+            z_ref[row][i] = acc
+    if reverse:
+        z_ref = np.flip(z_ref, -1)
+    z_ref = np.moveaxis(z_ref, -1, axis)
+
+    x_tri = to_triton(x, device=device)
+    f_tri = to_triton(flags, device=device)
+    z_tri = to_triton(np.empty_like(x), device=device)
+    kernel[(1, )](x_tri, f_tri, z_tri, BLOCK_M=shape[0], BLOCK_N=shape[1], AXIS=axis, REVERSE=reverse,
+                  num_warps=num_warps)
+    np.testing.assert_equal(z_ref, to_numpy(z_tri))
+
+
 scan_layouts = [
     BlockedLayout([1, 4], [4, THREADS_PER_WARP // 4], [4, 1], [0, 1], [1, 1], [1, 1], [0, 1]),
     BlockedLayout([1, 4], [8, THREADS_PER_WARP // 8], [4, 1], [0, 1], [1, 1], [1, 1], [0, 1]),
@@ -2442,6 +2629,62 @@ def test_histogram(M, N, device):
     assert (z_torch == z).all()
 
 
+@pytest.mark.interpreter
+@pytest.mark.parametrize("M, N", [[1024, 64], [2048, 4096], [512, 16384], [1024, 32768]])
+@pytest.mark.parametrize("weighted", [False, True])
+def test_histogram_mask_weights(M, N, weighted, device):
+
+    @triton.jit
+    def histogram_kernel(x_ptr, w_ptr, z_ptr, M: tl.constexpr, N: tl.constexpr, WEIGHTED: tl.constexpr):
+        offset1 = tl.arange(0, M)
+        offset2 = tl.arange(0, N)
+        x = tl.load(x_ptr + offset1)
+        mask = (offset1 % 3) != 0
+        if WEIGHTED:
+            w = tl.load(w_ptr + offset1)
+            z = tl.histogram(x, N, mask=mask, weights=w)
+        else:
+            z = tl.histogram(x, N, mask=mask)
+        tl.store(z_ptr + offset2, z)
+
+    torch.manual_seed(17)
+    x = torch.randint(0, N, (M, ), device=device, dtype=torch.int32)
+    w = torch.rand(M, device=device, dtype=torch.float32) if weighted else torch.ones(M, device=device)
+    mask = (torch.arange(M, device=device) % 3) != 0
+    z = torch.empty(N, dtype=torch.float32 if weighted else torch.int32, device=device)
+    z_ref = torch.zeros(N, dtype=torch.float32, device=device).index_add_(0, x[mask].long(), w[mask])
+    histogram_kernel[(1, )](x, w, z, M=M, N=N, WEIGHTED=weighted)
+    torch.testing.assert_close(z.float(), z_ref, rtol=1e-5, atol=1e-5)
+
+
+@pytest.mark.interpreter
+@pytest.mark.parametrize("src_shape, indices_shape, axis", [
+    ([4, 4], [8, 4], 0),
+    ([128, 64], [256, 64], 0),
+    ([128, 64], [128, 128], 1),
+    ([32, 16], [32, 8], 1),
+])
+def test_gather(src_shape, indices_shape, axis, device):
+
+    @triton.jit
+    def gather_kernel(src_ptr, idx_ptr, out_ptr, axis: tl.constexpr, src_dim0: tl.constexpr, src_dim1: tl.constexpr,
+                      idx_dim0: tl.constexpr, idx_dim1: tl.constexpr):
+        src_offs = tl.arange(0, src_dim0)[:, None] * src_dim1 + tl.arange(0, src_dim1)[None, :]
+        src = tl.load(src_ptr + src_offs)
+        idx_offs = tl.arange(0, idx_dim0)[:, None] * idx_dim1 + tl.arange(0, idx_dim1)[None, :]
+        idx = tl.load(idx_ptr + idx_offs)
+        out = tl.gather(src, idx, axis)
+        tl.store(out_ptr + idx_offs, out)
+
+    torch.manual_seed(0)
+    src = torch.randn(src_shape, device=device)
+    indices = torch.randint(0, src.shape[axis], indices_shape, device=device)
+    ref = torch.gather(src, axis, indices)
+    out = torch.empty(indices_shape, device=device)
+    gather_kernel[(1, )](src, indices, out, axis, src_shape[0], src_shape[1], indices_shape[0], indices_shape[1])
+    torch.testing.assert_close(out, ref, rtol=0, atol=0)
+
+
 @pytest.mark.interpreter
 @pytest.mark.parametrize("op", ['sum', 'max', 'min'])
 @pytest.mark.parametrize("BLOCK_N", [32, 64, 128])
@@ -2573,6 +2816,9 @@ layouts = [
     WmmaLayout(warps_per_cta=[2, 2]),
     WmmaLayout(warps_per_cta=[4, 1]),
     WmmaLayout(warps_per_cta=[1, 4]),
+    WmmaLayout(warps_per_cta=[2, 2], version=2),
+    WmmaLayout(warps_per_cta=[4, 1], version=2),
+    WmmaLayout(warps_per_cta=[1, 4], version=2),
 ]
 
 
@@ -3291,6 +3537,37 @@ def test_dot(M, N, K, num_warps, col_a, col_b, epilogue, input_precision, in_dty
             assert 'wgmma.mma_async.sync.aligned.m64n128k32.f32.e4m3.e4m3' in ptx
 
 
+@pytest.mark.interpreter
+@pytest.mark.parametrize("input_precision, rtol", [("bf16x3", 1e-4), ("bf16x6", 1e-5)])
+def test_dot_bf16_emulation(input_precision, rtol, device):
+    if is_cuda() and torch.cuda.get_device_capability()[0] < 8:
+        pytest.skip("bf16 dots require sm >= 80")
+
+    @triton.jit
+    def kernel(X, Y, Z, M: tl.constexpr, N: tl.constexpr, K: tl.constexpr, INPUT_PRECISION: tl.constexpr):
+        offs_m = tl.arange(0, M)
+        offs_n = tl.arange(0, N)
+        offs_k = tl.arange(0, K)
+        x = tl.load(X + offs_m[:, None] * K + offs_k[None, :])
+        y = tl.load(Y + offs_k[:, None] * N + offs_n[None, :])
+        z = tl.dot(x, y, input_precision=INPUT_PRECISION)
+        tl.store(Z + offs_m[:, None] * N + offs_n[None, :], z)
+
+    M, N, K = 64, 64, 64
+    rs = RandomState(17)
+    # Positive inputs, so that the sums don't cancel and the relative error is that of the products.
+    x = rs.uniform(0.5, 2.0, (M, K)).astype(np.float32)
+    y = rs.uniform(0.5, 2.0, (K, N)).astype(np.float32)
+    z = torch.empty((M, N), dtype=torch.float32, device=device)
+    h = kernel[(1, )](to_triton(x, device=device), to_triton(y, device=device), z, M, N, K, input_precision)
+    z_ref = np.matmul(x.astype(np.float64), y.astype(np.float64))
+    np.testing.assert_allclose(z_ref, to_numpy(z), rtol=rtol)
+    if is_interpreter():
+        return
+    num_dots = 3 if input_precision == "bf16x3" else 6
+    assert len(re.findall(r"(?:tt\.dot|warp_group_dot) ", h.asm["ttgir"])) == num_dots
+
+
 @pytest.mark.interpreter
 @pytest.mark.parametrize("B", [1, 2, 4, 8])
 @pytest.mark.parametrize("num_warps", [1, 2, 4, 8, 16])
@@ -3301,7 +3578,7 @@ def test_dot3d(B, num_warps, M, N, K, in_dtype_str, out_dtype_str, device):
     if is_hip():
         # hip does not support tf32 precision, so use ieee for all tests
         input_precision = "ieee"
-        if "gfx11" in triton.runtime.driver.active.get_current_target().arch:
+        if any(arch in triton.runtime.driver.active.get_current_target().arch for arch in ("gfx11", "gfx12")):
             if in_dtype_str == "float32":
                 pytest.skip(f"{in_dtype_str} is not supported in WMMA dot, FMA does not support dot3d")
             if out_dtype_str == "float16":
@@ -3580,6 +3857,23 @@ def test_const(device, choose_const, constexpr, mode):
         assert torch.all(input == output)
 
 
+def test_restrict(device):
+
+    @triton.jit
+    def kernel(x_ptr: tl.const, y_ptr: tl.restrict, out_ptr, BLOCK: tl.constexpr):
+        offsets = tl.arange(0, BLOCK)
+        tl.store(out_ptr + offsets, tl.load(x_ptr + offsets))
+        tl.store(out_ptr + BLOCK + offsets, tl.load(y_ptr + offsets))
+
+    x = torch.randn(128, device=device)
+    y = torch.randn(128, device=device)
+    out = torch.empty(256, device=device)
+    h = kernel[(1, )](x, y, out, BLOCK=128)
+    assert torch.equal(out, torch.cat([x, y]))
+    assert "tt.noalias" in h.asm["ttir"]
+    assert "readonly" in h.asm["llir"] and "noalias" in h.asm["llir"]
+
+
 @pytest.mark.interpreter
 @pytest.mark.parametrize("dtype_str", ['float32', 'float16'])
 def test_dot_without_load(dtype_str, device):
@@ -3601,6 +3895,43 @@ def test_dot_without_load(dtype_str, device):
     assert torch.all(out == out_ref)
 
 
+@pytest.mark.interpreter
+@pytest.mark.parametrize("M, N, K", [(16, 8, 32), (64, 64, 64), (128, 64, 128)])
+@pytest.mark.parametrize("dtype_str", ['float16', 'bfloat16'])
+def test_sparse_dot(M, N, K, dtype_str, device):
+    if is_interpreter() and dtype_str == 'bfloat16':
+        pytest.skip("bfloat16 is not supported in the interpreter")
+    if is_hip() or (is_cuda() and torch.cuda.get_device_capability()[0] < 8):
+        pytest.skip("sparse_dot requires an NVIDIA GPU of compute capability 80 or higher")
+
+    @triton.jit
+    def kernel(A, A_META, B, C, M: tl.constexpr, N: tl.constexpr, K: tl.constexpr):
+        offs_m = tl.arange(0, M)
+        offs_n = tl.arange(0, N)
+        a = tl.load(A + offs_m[:, None] * (K // 2) + tl.arange(0, K // 2)[None, :])
+        a_meta = tl.load(A_META + offs_m[:, None] * (K // 16) + tl.arange(0, K // 16)[None, :])
+        b = tl.load(B + tl.arange(0, K)[:, None] * N + offs_n[None, :])
+        c = tl.sparse_dot(a, a_meta, b)
+        tl.store(C + offs_m[:, None] * N + offs_n[None, :], c)
+
+    dtype = getattr(torch, dtype_str)
+    # Keep 2 increasing positions of each group of 4.
+    pairs = torch.tensor([[0, 1], [0, 2], [0, 3], [1, 2], [1, 3], [2, 3]])
+    pos = pairs[torch.randint(0, len(pairs), (M, K // 4))].reshape(M, K // 2)
+    a = torch.randn((M, K // 2), dtype=dtype)
+    dense_a = torch.zeros((M, K), dtype=dtype)
+    cols = 4 * (torch.arange(K // 2) // 2) + pos
+    dense_a.scatter_(1, cols, a)
+    shifts = 2 * torch.arange(8)
+    a_meta = (pos.reshape(M, K // 16, 8) << shifts).sum(-1).to(torch.int32)
+    a_meta = torch.where(a_meta >= 2**15, a_meta - 2**16, a_meta).to(torch.int16)
+    b = torch.randn((K, N), dtype=dtype)
+    c = torch.empty((M, N), dtype=torch.float32, device=device)
+    kernel[(1, )](a.to(device), a_meta.to(device), b.to(device), c, M, N, K)
+    ref = torch.matmul(dense_a.float(), b.float())
+    torch.testing.assert_close(c.cpu(), ref, atol=1e-2, rtol=1e-2)
+
+
 # ---------------
 # test arange
 # ---------------
@@ -3815,10 +4146,13 @@ def test_vectorization_hints(has_hints, device):
         return
 
     ptx = pgm.asm["ptx"]
+    loads = [entry for entry in pgm.metadata.vectorization if "tt.load" in entry]
     if has_hints:
         assert "ld.global.v4.b32" in ptx
+        assert any("tt.load: 4 x 32-bit" in entry for entry in loads)
     else:
         assert "ld.global.v4.b32" not in ptx
+        assert loads and not any("tt.load: 4 x 32-bit" in entry for entry in loads)
 
 
 # ---------------
@@ -3896,6 +4230,24 @@ def test_store_eviction_policy(eviction_policy, device):
         assert 'evict_first' in ptx
 
 
+@pytest.mark.interpreter
+def test_prefetch(device):
+    src = torch.randn(128, device=device)
+    dst = torch.empty(128, device=device)
+
+    @triton.jit
+    def _kernel(dst, src, N: tl.constexpr):
+        offsets = tl.arange(0, 128)
+        tl.prefetch(src + offsets, mask=offsets < N)
+        x = tl.load(src + offsets)
+        tl.store(dst + offsets, x)
+
+    pgm = _kernel[(1, )](dst, src, N=100)
+    torch.testing.assert_close(dst, src)
+    if is_cuda():
+        assert 'prefetch.global.L2' in pgm.asm['ptx']
+
+
 # ---------------
 # test default
 # ---------------
@@ -4811,6 +5163,28 @@ def test_smid(device):
     assert h.asm["ptx"].count("%smid") == 1
 
 
+def test_programmatic_dependent_launch(device):
+    if not is_cuda() or torch.cuda.get_device_capability()[0] < 9:
+        pytest.skip("programmatic dependent launch requires sm_90")
+
+    @triton.jit
+    def kernel(In, Out, BLOCK: tl.constexpr):
+        off = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        tl.extra.cuda.gdc_wait()
+        x = tl.load(In + off)
+        tl.extra.cuda.gdc_launch_dependents()
+        tl.store(Out + off, x + 1)
+
+    x = torch.zeros(4096, dtype=torch.int32, device=device)
+    y = torch.empty_like(x)
+    z = torch.empty_like(x)
+    h = kernel[(x.numel() // 128, )](x, y, BLOCK=128, launch_pdl=True)
+    kernel[(x.numel() // 128, )](y, z, BLOCK=128, launch_pdl=True)
+    assert torch.equal(z, torch.full_like(x, 2))
+    assert h.asm["ptx"].count("griddepcontrol.wait") == 1
+    assert h.asm["ptx"].count("griddepcontrol.launch_dependents") == 1
+
+
 # -----------------------
 # test layout conversions
 # -----------------------
@@ -5177,6 +5551,28 @@ def test_dot_max_num_imprecise_acc(M, N, K, BLOCK_M, BLOCK_N, BLOCK_K, in_type_s
         assert h.asm["ptx"].count("add.f32") == (BLOCK_M * BLOCK_N) // (32 * num_warps) * (BLOCK_K // low_precision_acc)
 
 
+@pytest.mark.interpreter
+@pytest.mark.parametrize("HEAD_DIM", [80, 96, 112])
+def test_dot_k_extent(HEAD_DIM, device):
+
+    @triton.jit
+    def kernel(Q, K, O, HEAD_DIM: tl.constexpr, BLOCK: tl.constexpr, BLOCK_D: tl.constexpr):
+        offs = tl.arange(0, BLOCK)
+        offs_d = tl.arange(0, BLOCK_D)
+        mask_d = offs_d < HEAD_DIM
+        q = tl.load(Q + offs[:, None] * HEAD_DIM + offs_d[None, :], mask=mask_d[None, :], other=0.0)
+        k = tl.load(K + offs[None, :] * HEAD_DIM + offs_d[:, None], mask=mask_d[:, None], other=0.0)
+        o = tl.dot(q, k, k_extent=HEAD_DIM)
+        tl.store(O + offs[:, None] * BLOCK + offs[None, :], o)
+
+    BLOCK = 64
+    q = torch.randn((BLOCK, HEAD_DIM), device=device, dtype=torch.float16)
+    k = torch.randn((BLOCK, HEAD_DIM), device=device, dtype=torch.float16)
+    o = torch.empty((BLOCK, BLOCK), device=device, dtype=torch.float32)
+    kernel[(1, )](q, k, o, HEAD_DIM, BLOCK, 128)
+    torch.testing.assert_close(o, torch.matmul(q.float(), k.float().T), rtol=1e-2, atol=1e-2)
+
+
 # -----------------------
 # test enable_fp_fusion
 # -----------------------
@@ -5209,6 +5605,119 @@ def test_enable_fp_fusion(enable_fp_fusion, default_override, device):
     assert found_fma == enable_fp_fusion
 
 
+# -----------------------
+# test fast_math
+# -----------------------
+
+
+@pytest.mark.parametrize("fast_math", [False, True])
+def test_fast_math(fast_math, device):
+
+    @triton.jit
+    def log_div(X, Y, Z):
+        offs = tl.arange(0, 128)
+        x = tl.load(X + offs)
+        y = tl.load(Y + offs)
+        tl.store(Z + offs, tl.log(x) / y + tl.math.div_rn(x, y))
+
+    x = torch.rand((128, ), device=device, dtype=torch.float32) + 0.5
+    y = torch.rand((128, ), device=device, dtype=torch.float32) + 0.5
+    z = torch.empty_like(x)
+    h = log_div[(1, )](x, y, z, fast_math=fast_math)
+    torch.testing.assert_close(z, torch.log(x) / y + x / y, rtol=1e-4, atol=1e-4)
+
+    if not is_cuda():
+        return
+    ptx = h.asm["ptx"]
+    assert ('div.approx.f32' in ptx) == fast_math
+    # div_rn keeps its precision.
+    assert 'div.rn.f32' in ptx
+
+
+# -----------------------
+# test llvm_pipeline
+# -----------------------
+
+
+@pytest.mark.parametrize("llvm_pipeline", ["", "triton", "function(instcombine)"])
+def test_llvm_pipeline(llvm_pipeline, device):
+
+    @triton.jit
+    def exp_sum(X, Z, N: tl.constexpr):
+        offs = tl.arange(0, 128)
+        acc = tl.zeros((128, ), dtype=tl.float32)
+        for i in range(N):
+            acc += tl.exp(tl.load(X + i * 128 + offs))
+        tl.store(Z + offs, acc)
+
+    x = torch.rand((4, 128), device=device, dtype=torch.float32)
+    z = torch.empty((128, ), device=device, dtype=torch.float32)
+    exp_sum[(1, )](x, z, N=4, llvm_pipeline=llvm_pipeline)
+    torch.testing.assert_close(z, torch.exp(x).sum(0))
+
+
+def test_llvm_pipeline_invalid(device):
+
+    @triton.jit
+    def copy(X, Z):
+        tl.store(Z, tl.load(X))
+
+    x = torch.rand((1, ), device=device, dtype=torch.float32)
+    with pytest.raises(Exception, match="Invalid LLVM pass pipeline"):
+        copy[(1, )](x, x, llvm_pipeline="function(not-a-pass)")
+
+
+@pytest.mark.parametrize("rasterization", ["grouped", "morton", "hilbert"])
+@pytest.mark.parametrize("grid", [(13, 21), (16, 16), (1, 7), (40, 1)])
+def test_rasterization(rasterization, grid, device):
+
+    @triton.jit
+    def count_ids(Count, num_y):
+        x = tl.program_id(0)
+        y = tl.program_id(1)
+        tl.atomic_add(Count + x * num_y + y, 1)
+
+    count = torch.zeros(grid, device=device, dtype=torch.int32)
+    count_ids[grid](count, grid[1], rasterization=rasterization, raster_group_size=4)
+    # The ids are a permutation of the grid.
+    assert torch.all(count == 1)
+
+
+# -----------------------
+# test device_log
+# -----------------------
+
+
+def test_device_log(device):
+    from triton.runtime import device_log
+
+    @triton.jit
+    def checked_copy(X, Y, N, BLOCK: tl.constexpr):
+        offs = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        tl.device_assert(offs < N, "out of bounds")
+        x = tl.load(X + offs)
+        tl.device_print("x: ", x)
+        tl.store(Y + offs, x)
+
+    x = torch.arange(128, device=device, dtype=torch.float32)
+    y = torch.empty_like(x)
+    # The second program fails its assert for the elements 32 to 63, and goes on.
+    h = checked_copy[(2, )](x, y, 96, BLOCK=64, debug=True, device_log=512, num_warps=1)
+    torch.testing.assert_close(y, x)
+    if is_cuda():
+        assert 'vprintf' not in h.asm["ptx"]
+
+    records = device_log.read(h)
+    printed = {(r.pid[0], r.index[0]): r.value for r in records if r.site["kind"] == "print"}
+    assert printed == {(pid, i): float(pid * 64 + i) for pid in range(2) for i in range(64)}
+    failed = [r for r in records if r.site["kind"] == "assert"]
+    assert failed and all(r.pid[0] == 1 and r.index[0] >= 32 for r in failed)
+    assert sum(r.value for r in failed) == 32
+    assert "Assertion `out of bounds` failed" in str(failed[0])
+    # Reading clears the log.
+    assert device_log.read(h) == []
+
+
 # -----------------------
 # test propagate_nan
 # -----------------------
@@ -5371,6 +5880,74 @@ def test_tl_range(device):
                 assert 'cp.async.wait_group 0x6' in ptx
 
 
+@pytest.mark.interpreter
+def test_pipeline_stage(device):
+
+    @triton.jit
+    def _kernel(x_ptr, y_ptr, out_ptr, N, BLOCK: tl.constexpr):
+        offs = tl.arange(0, BLOCK)
+        acc = tl.zeros((BLOCK, ), dtype=tl.float32)
+        for i in tl.range(0, N, BLOCK, num_stages=3):
+            x = tl.pipeline_stage(tl.load(x_ptr + i + offs), 0)
+            y = tl.pipeline_stage(tl.load(y_ptr + i + offs), 1)
+            acc += x * y
+        tl.store(out_ptr + offs, acc)
+
+    N, BLOCK = 4096, 128
+    x = torch.randn(N, device=device)
+    y = torch.randn(N, device=device)
+    out = torch.empty(BLOCK, device=device)
+    pgm = _kernel[(1, )](x, y, out, N, BLOCK)
+    torch.testing.assert_close(out, (x * y).reshape(-1, BLOCK).sum(0), rtol=1e-4, atol=1e-4)
+    if not is_interpreter():
+        assert "tt.pipeline_stage = 1 : i32" in pgm.asm["ttir"]
+
+
+@pytest.mark.interpreter
+@pytest.mark.parametrize("unroll, interleave", [(2, None), (4, 2), (4, 4)])
+def test_range_unroll(unroll, interleave, device):
+
+    @triton.jit
+    def _kernel(x_ptr, out_ptr, N, BLOCK: tl.constexpr, UNROLL: tl.constexpr, INTERLEAVE: tl.constexpr):
+        offs = tl.arange(0, BLOCK)
+        acc = tl.zeros((BLOCK, ), dtype=tl.float32)
+        for i in tl.range(0, N, BLOCK, unroll=UNROLL, interleave=INTERLEAVE):
+            acc += tl.load(x_ptr + i + offs)
+        tl.store(out_ptr + offs, acc)
+
+    # the trip count isn't a multiple of the unroll factor
+    N, BLOCK = 7 * 128, 128
+    x = torch.randn(N, device=device)
+    out = torch.empty(BLOCK, device=device)
+    pgm = _kernel[(1, )](x, out, N, BLOCK, unroll, interleave)
+    torch.testing.assert_close(out, x.reshape(-1, BLOCK).sum(0), rtol=1e-4, atol=1e-4)
+    if not is_interpreter():
+        # the unrolled loop and the remainder loop
+        assert pgm.asm["ttir"].count("scf.for") == 2
+        assert "tt.loop_unroll_factor" not in pgm.asm["ttir"]
+
+
+def test_range_interleave_must_divide_unroll():
+    with pytest.raises(ValueError, match="must divide"):
+        tl.range(0, 8, unroll=4, interleave=3)
+
+
+@pytest.mark.interpreter
+@pytest.mark.parametrize("num_programs", [1, 3, 8])
+def test_persistent_range(num_programs, device):
+
+    @triton.jit
+    def kernel(Out, num_tiles):
+        for tile_id in tl.persistent_range(num_tiles):
+            tl.atomic_add(Out + tile_id, 1)
+
+    num_tiles = 37
+    out = torch.zeros(num_tiles, dtype=torch.int32, device=device)
+    kernel[(num_programs, )](out, num_tiles)
+    # every tile is visited exactly once
+    assert (out == 1).all(), out
+
+
 @triton.jit(noinline=True)
 def maxnreg_noinline1(X):
     tl.store(X, 0)
@@ -5457,3 +6034,106 @@ def test_num_programs(device):
 
     kernel[grid](input)
     assert torch.all(input == torch.tensor(grid, device=device))
+
+
+@pytest.mark.interpreter
+def test_global_scratch(device):
+    # Each program adds its partial sum to a workspace, and the last one to finish writes the total.  The workspaces
+    # are zeroed before each launch.
+    @triton.jit
+    def kernel(x_ptr, out_ptr, BLOCK: tl.constexpr):
+        pid = tl.program_id(0)
+        partial = tl.sum(tl.load(x_ptr + pid * BLOCK + tl.arange(0, BLOCK)))
+        total = tl.global_scratch(1, tl.float32)
+        counter = tl.global_scratch(1, tl.int32)
+        tl.atomic_add(total, partial)
+        if tl.atomic_add(counter, 1) == tl.num_programs(0) - 1:
+            tl.store(out_ptr, tl.atomic_add(total, 0.0))
+
+    x = torch.arange(8 * 128, dtype=torch.float32, device=device)
+    out = torch.zeros((1, ), dtype=torch.float32, device=device)
+    for _ in range(2):
+        kernel[(8, )](x, out, BLOCK=128)
+        assert out.item() == x.sum().item()
+
+
+def test_grid_barrier(device):
+    if not is_cuda():
+        pytest.skip("cooperative launches are only supported on CUDA")
+
+    # Normalizes x by its sum in a single launch, with a barrier between the reduction and the normalization, which
+    # runs twice to check that the barrier can be reused.
+    @triton.jit
+    def normalize(x_ptr, out_ptr, total_ptr, BLOCK: tl.constexpr):
+        pid = tl.program_id(0)
+        offs = pid * BLOCK + tl.arange(0, BLOCK)
+        x = tl.load(x_ptr + offs)
+        for i in range(2):
+            tl.atomic_add(total_ptr + i, tl.sum(x, 0))
+            tl.grid_barrier()
+            x = x / tl.load(total_ptr + i, cache_modifier=".cg")
+        tl.store(out_ptr + offs, x)
+
+    num_programs = 16
+    x = torch.rand((num_programs * 128, ), device=device, dtype=torch.float32) + 0.5
+    out = torch.empty_like(x)
+    total = torch.zeros((2, ), device=device, dtype=torch.float32)
+    kernel = normalize[(num_programs, )](x, out, total, BLOCK=128, launch_cooperative=True)
+    assert kernel.max_cooperative_programs() >= num_programs
+    torch.testing.assert_close(out, x / x.sum(), rtol=1e-4, atol=1e-6)
+
+
+def test_symmetric_memory(device):
+    if not is_cuda():
+        pytest.skip("symmetric memory is only tested on CUDA")
+
+    # Two programs play two ranks whose symmetric buffers are on the same device: each puts its block into the buffer
+    # of the other, signals it, and waits for the block of the other.
+    @triton.jit
+    def exchange(x_ptr, out_ptr, buf_bases, sig_bases, BLOCK: tl.constexpr):
+        rank = tl.program_id(0)
+        peer = 1 - rank
+        offs = tl.arange(0, BLOCK)
+        buf_ptr = tl.load(buf_bases + rank).to(tl.pointer_type(tl.float32))
+        sig_ptr = tl.load(sig_bases + rank).to(tl.pointer_type(tl.int32))
+        x = tl.load(x_ptr + rank * BLOCK + offs)
+        tl.store(tl.remote_ptr(buf_ptr + offs, buf_bases, rank, peer), x)
+        tl.signal(tl.remote_ptr(sig_ptr, sig_bases, rank, peer), 1)
+        tl.signal_wait_until(sig_ptr, 1, cmp="eq")
+        y = tl.load(buf_ptr + offs, cache_modifier=".cg")
+        tl.store(out_ptr + rank * BLOCK + offs, y)
+
+    BLOCK = 128
+    x = torch.rand((2 * BLOCK, ), device=device, dtype=torch.float32)
+    out = torch.empty_like(x)
+    bufs = [torch.zeros((BLOCK, ), device=device, dtype=torch.float32) for _ in range(2)]
+    sigs = [torch.zeros((1, ), device=device, dtype=torch.int32) for _ in range(2)]
+    buf_bases = torch.tensor([b.data_ptr() for b in bufs], device=device, dtype=torch.int64)
+    sig_bases = torch.tensor([s.data_ptr() for s in sigs], device=device, dtype=torch.int64)
+    exchange[(2, )](x, out, buf_bases, sig_bases, BLOCK=BLOCK)
+    torch.testing.assert_close(out, x.view(2, BLOCK).flip(0).reshape(-1))
+    assert all(s.item() == 1 for s in sigs)
+
+
+@pytest.mark.interpreter
+def test_program_id_per_program(device):
+    # Each program instance sees its own program ids, also when the interpreter runs them in parallel
+    grid = (8, 4, 2)
+    ids = torch.zeros(grid + (3, ), dtype=torch.int32, device=device)
+    count = torch.zeros((1, ), dtype=torch.int32, device=device)
+
+    @triton.jit
+    def kernel(ids, count):
+        x = tl.program_id(0)
+        y = tl.program_id(1)
+        z = tl.program_id(2)
+        offset = ((x * tl.num_programs(1) + y) * tl.num_programs(2) + z) * 3
+        tl.store(ids + offset, x)
+        tl.store(ids + offset + 1, y)
+        tl.store(ids + offset + 2, z)
+        tl.atomic_add(count, 1)
+
+    kernel[grid](ids, count)
+    ref = torch.stack(torch.meshgrid(*[torch.arange(n, dtype=torch.int32) for n in grid], indexing="ij"), dim=-1)
+    assert torch.equal(ids.cpu(), ref)
+    assert count.item() == math.prod(grid)
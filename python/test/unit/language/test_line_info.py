@@ -170,6 +170,33 @@ def test_line_info(func: str):
         assert (check_file_lines(file_lines, "test_line_info.py", 66, should_contain=False))
 
 
+def strip_line_info(ptx):
+    import re
+    # The debug sections follow the code of the kernels.
+    ptx = ptx.split("\t.section\t.debug", 1)[0]
+    line_info = re.compile(r"\s*(\.loc|\.file|\$L__(tmp|func_begin|func_end)\d*:)")
+    return "\n".join(line for line in ptx.splitlines() if not line_info.match(line))
+
+
+@pytest.mark.parametrize("func", ["single", "call", "call_noinline"])
+def test_line_info_codegen(func: str, monkeypatch, tmp_path):
+    if not triton.runtime.driver.active.get_current_target().backend == "cuda":
+        pytest.skip("the PTX of the line info is only compared on CUDA")
+    kernel = {"single": kernel_single, "call": kernel_call, "call_noinline": kernel_call_noinline}[func]
+    monkeypatch.setenv("TRITON_CACHE_DIR", str(tmp_path))
+
+    def compile_ptx():
+        src = triton.compiler.ASTSource(fn=kernel, signature={0: "*fp32", 1: "*fp32"}, constants={2: 128})
+        return triton.compile(src).asm["ptx"]
+
+    ptx = compile_ptx()
+    monkeypatch.setenv("TRITON_DISABLE_LINE_INFO", "1")
+    ptx_without_line_info = compile_ptx()
+    # The line info annotates the code, but doesn't change it.
+    assert strip_line_info(ptx) != "\n".join(ptx.splitlines())
+    assert strip_line_info(ptx) == strip_line_info(ptx_without_line_info)
+
+
 def is_interpreter():
     import os
     return os.environ.get('TRITON_INTERPRET', '0') == '1'
@@ -253,3 +253,48 @@ def test_rand_limits(dtype, device):
 
     assert output[0] == output[1]
     assert 1.0 - torch.finfo(torch.float32).eps <= output[0].item() < 1.0
+
+
+# test packed random bits and dropout
+
+
+@pytest.mark.interpreter
+@pytest.mark.parametrize('dtype', ['int32', 'int64'])
+def test_randbits(dtype, device):
+    numpy_dtype = getattr(np, f"u{dtype}")
+    config = {'int32': PHILOX_32, 'int64': PHILOX_64}[dtype]
+
+    @triton.jit
+    def kernel(X, seed, N: tl.constexpr):
+        offset = tl.arange(0, N).to(X.dtype.element_ty)
+        bits = tl.randbits(seed, offset)
+        tl.store(X + offset[:, None] * 4 + tl.arange(0, 4)[None, :], bits.to(X.dtype.element_ty, bitcast=True))
+
+    seed = 42
+    x = torch.empty((64, 4), dtype=getattr(torch, dtype), device=device)
+    kernel[(1, )](x, seed, N=64)
+    out_tri = x.cpu().numpy().astype(numpy_dtype).tolist()
+    gen = CustomPhilox4x(seed, config=config)
+    out_ref = [[int(w) for w in gen.random_raw()] for _ in out_tri]
+    assert out_tri == out_ref
+
+
+@pytest.mark.interpreter
+@pytest.mark.parametrize('p', [0.0, 0.1, 0.5])
+def test_dropout(p, device):
+    BLOCK = 1024
+
+    @triton.jit
+    def kernel(X, Y, p, seed, BLOCK: tl.constexpr):
+        start = tl.program_id(0) * BLOCK
+        offset = start // 16 + tl.arange(0, BLOCK // 16)
+        x = tl.reshape(tl.load(X + start + tl.arange(0, BLOCK)), (BLOCK // 16, 16))
+        y = tl.dropout(x, p, seed, offset)
+        tl.store(Y + start + tl.arange(0, BLOCK), tl.reshape(y, (BLOCK, )))
+
+    x = torch.ones(256 * BLOCK, dtype=torch.float32, device=device)
+    y = torch.empty_like(x)
+    kernel[(256, )](x, y, p, 7, BLOCK=BLOCK)
+    kept = y != 0
+    assert abs(1 - kept.float().mean().item() - p) < 1e-2
+    torch.testing.assert_close(y[kept], torch.full_like(y[kept], 1 / (1 - p)), rtol=1e-2, atol=0)
@@ -48,6 +48,27 @@ def test_sort(M, N, descending, dtype_str, device):
     assert (y == z).all(), (y, z)
 
 
+@pytest.mark.interpreter
+@pytest.mark.parametrize("M, N, k", [[1, 512, 1], [8, 64, 4], [256, 16, 16], [512, 8, 8], [128, 16, 1]])
+@pytest.mark.parametrize("dtype_str", ['int32', 'float16', 'float32', 'bfloat16'])
+def test_topk(M, N, k, dtype_str, device):
+
+    @triton.jit
+    def topk_kernel(X, Z, N: tl.constexpr, M: tl.constexpr, k: tl.constexpr):
+        offx = tl.arange(0, M)
+        offy = tl.arange(0, N) * M
+        x = tl.load(X + offx[None, :] + offy[:, None])
+        z = tl.topk(x, k)
+        tl.store(Z + tl.arange(0, k)[None, :] + tl.arange(0, N)[:, None] * k, z)
+
+    x = numpy_random((N, M), dtype_str=dtype_str)
+    x = torch.from_numpy(x).to(device)
+    y = torch.topk(x, k, dim=1)[0]
+    z = torch.empty((N, k), dtype=x.dtype, device=device)
+    topk_kernel[(1, )](x, z, N, M, k, num_warps=8)
+    assert (y == z).all(), (y, z)
+
+
 # ---------------
 # test flip op
 # ---------------
@@ -91,3 +112,154 @@ def test_swizzle2d(size_i, size_j, size_g, device):
     expected_order = torch.tensor([[0, 3, 6, 9, 12, 15, 18], [1, 4, 7, 10, 13, 16, 19], [2, 5, 8, 11, 14, 17, 20],
                                    [21, 23, 25, 27, 29, 31, 33], [22, 24, 26, 28, 30, 32, 34]]).to(device)
     assert (output == expected_order).all(), (output, expected_order)
+
+
+@pytest.mark.interpreter
+@pytest.mark.parametrize("split_k", [1, 4])
+def test_split_k_reduce(split_k, device):
+
+    @triton.jit
+    def split_k_kernel(X, Out, workspace, locks, K, BLOCK: tl.constexpr, SPLIT_K: tl.constexpr):
+        tile_id = tl.program_id(0)
+        split_id = tl.program_id(1)
+        offs = tl.arange(0, BLOCK)
+        acc = tl.zeros((BLOCK, ), dtype=tl.float32)
+        for k in range(split_id, K, SPLIT_K):
+            acc += tl.load(X + (tile_id * K + k) * BLOCK + offs)
+        acc, is_last = tl.split_k_reduce(acc, workspace, locks, tile_id, split_id, SPLIT_K)
+        if is_last:
+            tl.store(Out + tile_id * BLOCK + offs, acc)
+
+    num_tiles, K, BLOCK = 3, 16, 32
+    x = torch.randn((num_tiles, K, BLOCK), dtype=torch.float32, device=device)
+    out = torch.empty((num_tiles, BLOCK), dtype=torch.float32, device=device)
+    workspace = torch.empty((num_tiles, split_k, BLOCK), dtype=torch.float32, device=device)
+    locks = torch.zeros((num_tiles, ), dtype=torch.int32, device=device)
+    split_k_kernel[(num_tiles, split_k)](x, out, workspace, locks, K, BLOCK=BLOCK, SPLIT_K=split_k)
+    torch.testing.assert_close(out, x.sum(dim=1), rtol=1e-5, atol=1e-5)
+    # counters are reset for the next launch
+    assert (locks == 0).all()
+    # the reduction order doesn't depend on which program finishes last
+    first = out.clone()
+    split_k_kernel[(num_tiles, split_k)](x, out, workspace, locks, K, BLOCK=BLOCK, SPLIT_K=split_k)
+    assert torch.equal(out, first)
+
+
+@pytest.mark.interpreter
+@pytest.mark.parametrize("use_order", [False, True])
+def test_dynamic_tile_id(use_order, device):
+
+    @triton.jit
+    def dynamic_tile_kernel(visits, counter, order, num_tiles):
+        tile_id = tl.dynamic_tile_id(counter, num_tiles, order)
+        while tile_id < num_tiles:
+            next_id = tl.dynamic_tile_id(counter, num_tiles, order)
+            tl.atomic_add(visits + tile_id, 1)
+            tile_id = next_id
+
+    num_tiles = 37
+    counter = torch.zeros((2, ), dtype=torch.int32, device=device)
+    order = None
+    if use_order:
+        costs = torch.randn((num_tiles, ), device=device)
+        order = torch.argsort(costs, descending=True).to(torch.int32)
+    for _ in range(2):
+        visits = torch.zeros((num_tiles, ), dtype=torch.int32, device=device)
+        dynamic_tile_kernel[(4, )](visits, counter, order, num_tiles)
+        # each tile is taken exactly once
+        assert (visits == 1).all()
+        # the counters are reset for the next launch
+        assert (counter == 0).all()
+
+
+@pytest.mark.interpreter
+@pytest.mark.parametrize("dtype_str", ["int32", "float32"])
+@pytest.mark.parametrize("N, BLOCK", [[1000, 128], [100000, 1024]])
+def test_device_cumsum(dtype_str, N, BLOCK, device):
+
+    @triton.jit
+    def device_cumsum_kernel(X, Out, status, N, BLOCK: tl.constexpr):
+        tile_id = tl.device_scan_tile_id(status)
+        offs = tile_id * BLOCK + tl.arange(0, BLOCK)
+        x = tl.load(X + offs, mask=offs < N, other=0)
+        tl.store(Out + offs, tl.device_cumsum(x, tile_id, status), mask=offs < N)
+
+    torch.manual_seed(0)
+    dtype = getattr(torch, dtype_str)
+    if dtype_str == "int32":
+        x = torch.randint(-10, 10, (N, ), dtype=dtype, device=device)
+    else:
+        x = torch.rand((N, ), dtype=dtype, device=device)
+    out = torch.empty_like(x)
+    num_tiles = triton.cdiv(N, BLOCK)
+    status = torch.zeros((num_tiles + 1, ), dtype=torch.int64, device=device)
+    device_cumsum_kernel[(num_tiles, )](x, out, status, N, BLOCK=BLOCK)
+    ref = torch.cumsum(x.double(), 0).to(dtype)
+    torch.testing.assert_close(out, ref, rtol=1e-4, atol=1e-2)
+
+
+@pytest.mark.interpreter
+@pytest.mark.parametrize("dtype_str", ["int8", "uint8", "int16"])
+def test_requantize(dtype_str, device):
+
+    @triton.jit
+    def requantize_kernel(A, B, Scale, Out, zero_point, M: tl.constexpr, N: tl.constexpr, K: tl.constexpr,
+                          DTYPE: tl.constexpr):
+        offs_m = tl.arange(0, M)
+        offs_n = tl.arange(0, N)
+        offs_k = tl.arange(0, K)
+        a = tl.load(A + offs_m[:, None] * K + offs_k[None, :])
+        b = tl.load(B + offs_k[:, None] * N + offs_n[None, :])
+        acc = tl.dot(a, b, out_dtype=tl.int32)
+        scale = tl.load(Scale + offs_n)
+        out = tl.requantize(acc, scale[None, :], zero_point, DTYPE)
+        tl.store(Out + offs_m[:, None] * N + offs_n[None, :], out)
+
+    M, N, K = 32, 32, 64
+    torch.manual_seed(0)
+    dtype = getattr(torch, dtype_str)
+    a = torch.randint(-128, 128, (M, K), dtype=torch.int8, device=device)
+    b = torch.randint(-128, 128, (K, N), dtype=torch.int8, device=device)
+    # scales spanning saturated and unsaturated outputs
+    scale = torch.logspace(-6, -1, N, dtype=torch.float32, device=device)
+    out = torch.empty((M, N), dtype=dtype, device=device)
+    requantize_kernel[(1, )](a, b, scale, out, 3, M, N, K, getattr(tl, dtype_str))
+    acc = a.cpu().int() @ b.cpu().int()
+    info = torch.iinfo(dtype)
+    ref = torch.round(acc.float() * scale.cpu() + 3).clamp(info.min, info.max).to(dtype)
+    assert torch.equal(out.cpu(), ref)
+
+
+@pytest.mark.parametrize("p_dtype", ["float32", "float16"])
+@pytest.mark.parametrize("exp2_impl", ["sfu", "fma", "mixed"])
+def test_online_softmax(p_dtype, exp2_impl, device):
+
+    @triton.jit
+    def attention_kernel(Q, K, V, Out, sm_scale, N, M: tl.constexpr, BLOCK_N: tl.constexpr, D: tl.constexpr,
+                         P_DTYPE: tl.constexpr, EXP2_IMPL: tl.constexpr):
+        offs_m = tl.arange(0, M)
+        offs_n = tl.arange(0, BLOCK_N)
+        offs_d = tl.arange(0, D)
+        q = tl.load(Q + offs_m[:, None] * D + offs_d[None, :])
+        m_i = tl.full([M], float("-inf"), tl.float32)
+        l_i = tl.zeros([M], tl.float32)
+        acc = tl.zeros([M, D], tl.float32)
+        qk_scale = sm_scale * 1.44269504
+        for start_n in range(0, N, BLOCK_N):
+            k = tl.load(K + offs_d[:, None] + (start_n + offs_n)[None, :] * D)
+            v = tl.load(V + (start_n + offs_n)[:, None] * D + offs_d[None, :])
+            qk = tl.dot(q, k)
+            p, alpha, m_i, l_i = tl.online_softmax(qk, m_i, l_i, qk_scale, P_DTYPE, EXP2_IMPL)
+            acc = tl.dot(p.to(v.dtype), v, acc * alpha[:, None])
+        tl.store(Out + offs_m[:, None] * D + offs_d[None, :], acc / l_i[:, None])
+
+    M, N, BLOCK_N, D = 32, 128, 32, 32
+    torch.manual_seed(0)
+    q = torch.randn((M, D), dtype=torch.float16, device=device)
+    k = torch.randn((N, D), dtype=torch.float16, device=device)
+    v = torch.randn((N, D), dtype=torch.float16, device=device)
+    out = torch.empty((M, D), dtype=torch.float32, device=device)
+    sm_scale = D**-0.5
+    attention_kernel[(1, )](q, k, v, out, sm_scale, N, M, BLOCK_N, D, getattr(tl, p_dtype), exp2_impl)
+    ref = torch.softmax((q.float() @ k.float().T) * sm_scale, dim=1) @ v.float()
+    torch.testing.assert_close(out, ref, rtol=1e-2, atol=1e-2)
@@ -25,6 +25,26 @@ def test_kwargs(use_cuda_graph: bool):
     _kernel[grid](dst=dst, src=src, N=N)
 
 
+def test_tune_per_bucket():
+    src = torch.arange(4096, device='cuda', dtype=torch.float32)
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': 32}), triton.Config(kwargs={'BLOCK_SIZE': 128})]
+
+    @triton.autotune(configs=configs, key=['N'], warmup=1, rep=1)
+    @triton.jit(buckets={'N': [1024]})
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+
+    for N in [100, 1000, 1024, 2000, 4096]:
+        dst = torch.zeros(N, device='cuda')
+        grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']), )
+        _kernel[grid](dst, src, N)
+        torch.testing.assert_close(dst, src[:N])
+    # The sizes of a bucket share their tuning.
+    assert len(_kernel.cache) == 2
+
+
 def test_restore():
     N = 1024
     src = torch.zeros(N, device='cuda')
@@ -130,3 +150,153 @@ def test_prune_configs(with_perf_model: bool):
         assert records['run_early_config_prune']
         assert records['capture_kwargs']
         assert records['capture_named_args']
+
+
+def test_estimate_spills():
+    if triton.runtime.driver.active.get_current_target().backend != "cuda":
+        pytest.skip("register estimates are only checked on CUDA")
+    N = 1 << 16
+    src = torch.randn(N, device='cuda')
+    dst = torch.empty(N, device='cuda')
+
+    # A single warp can't hold the whole tensor in registers.
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': N}, num_warps=1), triton.Config(kwargs={'BLOCK_SIZE': 1024})]
+
+    @triton.autotune(configs=configs, key=['N'], prune_configs_by={'estimate_spills': True}, warmup=1, rep=1)
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']), )
+    _kernel[grid](dst, src, N=N)
+    torch.testing.assert_close(src, dst)
+    assert _kernel.best_config == configs[1]
+    assert _kernel.configs_timings[configs[0]] == [float("inf")] * 3
+
+
+def test_cache_results(tmp_path, monkeypatch):
+    monkeypatch.setenv("TRITON_CACHE_DIR", str(tmp_path))
+    N = 1024
+    src = torch.empty(N, device='cuda')
+    dst = torch.empty(N, device='cuda')
+
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': 32}), triton.Config(kwargs={'BLOCK_SIZE': 128})]
+
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']), )
+    tuned = triton.autotune(configs=configs, key=['N'], warmup=1, rep=1, cache_results=True)(_kernel)
+    tuned[grid](dst, src, N)
+
+    # A new autotuner, as in another process, reuses the stored result without benchmarking.
+    retuned = triton.autotune(configs=configs, key=['N'], warmup=1, rep=1, cache_results=True)(_kernel)
+    bench_calls = []
+    monkeypatch.setattr(retuned, "_bench", lambda *args, **kwargs: bench_calls.append(1))
+    retuned[grid](dst, src, N)
+    assert not bench_calls
+    assert str(retuned.best_config) == str(tuned.best_config)
+
+
+def test_pgo_profile(tmp_path, monkeypatch):
+    monkeypatch.setenv("TRITON_PGO_PROFILE", str(tmp_path / "profile.json"))
+    src = torch.empty(4096, device='cuda')
+    dst = torch.empty(4096, device='cuda')
+
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': 32}), triton.Config(kwargs={'BLOCK_SIZE': 128})]
+
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+
+    grid = lambda META: (triton.cdiv(META['N'], META['BLOCK_SIZE']), )
+    tuned = triton.autotune(configs=configs, key=['N'], warmup=1, rep=1)(_kernel)
+    tuned[grid](dst, src, 1024)
+    assert (tmp_path / "profile.json").exists()
+
+    # A new autotuner, as in another run, takes the profiled config of the same key without benchmarking.
+    triton.runtime.pgo._profiles.clear()
+    retuned = triton.autotune(configs=configs, key=['N'], warmup=1, rep=1)(_kernel)
+    bench_calls = []
+    monkeypatch.setattr(retuned, "_bench", lambda *args, config, **kwargs: bench_calls.append(config) or [1.0] * 3)
+    retuned[grid](dst, src, 1024)
+    assert not bench_calls
+    assert str(retuned.best_config) == str(tuned.best_config)
+
+    # Another key only benchmarks the best config of the nearest profiled one.
+    monkeypatch.setenv("TRITON_PGO_TOP_K", "1")
+    retuned[grid](dst, src, 2048)
+    assert [str(config) for config in bench_calls] == [str(tuned.best_config)]
+
+
+def test_precompile_filters_failing_configs():
+    N = 1024
+    src = torch.empty(N, device='cuda')
+    dst = torch.empty(N, device='cuda')
+
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': 32}), triton.Config(kwargs={'BLOCK_SIZE': 256})]
+
+    @triton.autotune(configs=configs, key=['N'], warmup=1, rep=1)
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        tl.static_assert(BLOCK_SIZE <= 128)
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']), )
+    _kernel[grid](dst, src, N)
+    assert _kernel.best_config.kwargs == {'BLOCK_SIZE': 32}
+    assert _kernel.configs_timings[configs[1]] == [float("inf")] * 3
+
+
+@pytest.mark.parametrize('search', ['successive_halving', 'model_based'])
+def test_search_strategies(search):
+    N = 4096
+    src = torch.randn(N, device='cuda')
+    dst = torch.empty(N, device='cuda')
+
+    space = triton.ConfigSpace(kwargs={'BLOCK_SIZE': [32, 64, 128, 256, 512, 1024]}, num_warps=[1, 2, 4],
+                               constraint=lambda c: c.kwargs['BLOCK_SIZE'] >= 32 * c.num_warps)
+
+    @triton.autotune(configs=space, key=['N'], warmup=1, rep=1, search=search)
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']), )
+    _kernel[grid](dst, src, N)
+    assert len(_kernel.configs) == 15
+    assert _kernel.best_config in _kernel.configs_timings
+    triton.testing.assert_close(dst, src)
+
+
+# The workers of the multi-device mode import the kernel, so it is defined at the top level.
+@triton.autotune(configs=[triton.Config(kwargs={'BLOCK_SIZE': 2**i}) for i in range(5, 11)], key=['N'], warmup=1,
+                 rep=1, multi_device=True)
+@triton.jit
+def _multi_device_kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+    offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+    x = tl.load(src + offsets, mask=offsets < N)
+    tl.store(dst + offsets, x, mask=offsets < N)
+
+
+@pytest.mark.skipif(torch.cuda.device_count() < 2, reason="requires at least 2 GPUs")
+def test_multi_device():
+    N = 4096
+    src = torch.randn(N, device='cuda')
+    dst = torch.empty(N, device='cuda')
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']), )
+    _multi_device_kernel[grid](dst, src, N)
+    assert len(_multi_device_kernel.configs_timings) == len(_multi_device_kernel.configs)
+    assert all(timing[0] < float("inf") for timing in _multi_device_kernel.configs_timings.values())
+    triton.testing.assert_close(dst, src)
@@ -3,12 +3,14 @@ import itertools
 import os
 import shutil
 import tempfile
+import time
 
 import pytest
 import torch
 
 import triton
 import triton.language as tl
+from triton.runtime.cache import RemoteCacheBackend, RemoteCacheManager, evict_cache, parse_cache_size
 from triton.runtime.jit import JITFunction
 
 tmpdir = ".tmp"
@@ -97,6 +99,18 @@ def test_nested2_change():
     assert baseline != updated
 
 
+def test_parse_reuses_tree():
+    tree = function_1.parse()
+    assert function_1.parse() is tree
+    orig_src = function_1.src
+    try:
+        function_1.src = orig_src.replace('i + 1', 'i + 2')
+        assert function_1.parse() is not tree
+    finally:
+        function_1.src = orig_src
+    assert function_1.parse() is tree
+
+
 def test_combine_fn_change():
     # Test that tl.reduce and associative_scan calls include
     # the combine_fn in the hash
@@ -172,6 +186,18 @@ def test_reuse():
     assert counter == 1
 
 
+def test_pass_stats():
+    reset_tmp_dir()
+    x = torch.empty(1, dtype=torch.int32, device='cuda')
+    pass_stats = kernel[(1, )](x, 1, BLOCK=1024).metadata.pass_stats
+    assert {"ttir", "ttgir", "llir"} <= {stats["stage"] for stats in pass_stats}
+    for stats in pass_stats:
+        assert stats["pass"] and stats["time"] >= 0
+        assert stats["ops_before"] > 0 and stats["ops_after"] > 0
+    # The statistics of the compilation are kept in the cache
+    assert kernel[(1, )](x, 1, BLOCK=1024).metadata.pass_stats == pass_stats
+
+
 @pytest.mark.parametrize('mode', ['enable', 'disable'])
 def test_specialize(mode):
     counter = 0
@@ -190,6 +216,40 @@ def test_specialize(mode):
     assert counter == target
 
 
+def test_buckets():
+
+    @triton.jit(buckets={"n": [128, 1024]})
+    def kernel_buckets(X, n):
+        tl.store(X, n)
+
+    x = torch.empty(1, dtype=torch.int32, device='cuda')
+    device = torch.cuda.current_device()
+    for n in [1, 16, 100, 128, 129, 1000, 1024, 1025, 5000]:
+        kernel_buckets[(1, )](x, n)
+        assert x.item() == n
+    # One kernel per bucket, whatever the divisibility of the values.
+    assert len(kernel_buckets.cache[device]) == 3
+
+
+def test_alignments():
+
+    @triton.jit(alignments={"X": 128, "n": [32, 128]})
+    def kernel_alignments(X, n):
+        tl.store(X, n)
+
+    x = torch.empty(64, dtype=torch.int32, device='cuda')
+    device = torch.cuda.current_device()
+    assert x.data_ptr() % 128 == 0
+    for n in [16, 32, 64, 128, 256]:
+        h = kernel_alignments[(1, )](x, n)
+        assert x[0].item() == n
+    assert "tt.divisibility = 128" in h.asm["ttir"]
+    # The largest alignment that holds is specialized on: 16, 32 and 128 for n.
+    assert len(kernel_alignments.cache[device]) == 3
+    kernel_alignments[(1, )](x[4:], 256)
+    assert len(kernel_alignments.cache[device]) == 4
+
+
 def test_annotation():
 
     @triton.jit
@@ -547,3 +607,260 @@ def test_preload() -> None:
     # test that we can't preload a mismatched kernel
     with pytest.raises(RuntimeError, match="Specialization data is for"):
         kernel_sub.preload(specialization_data)
+
+
+def _wait_for_pending(fn, device):
+    for future in list(fn.pending[device].values()):
+        future.result()
+
+
+def test_async_compile_fallback() -> None:
+    reset_tmp_dir()
+    JITFunction.cache_hook = None
+    device = torch.cuda.current_device()
+    fallback_calls = []
+
+    def fallback(X, i, BLOCK, grid):
+        fallback_calls.append(i)
+        X.fill_(-1)
+
+    @triton.jit(async_compile=True, fallback=fallback)
+    def kernel_async(X, i, BLOCK: tl.constexpr):
+        tl.store(X, i)
+
+    x = torch.empty(1, dtype=torch.int32, device='cuda')
+    kernel_async[(1, )](x, 5, BLOCK=1)
+    assert fallback_calls == [5]
+    assert x.item() == -1
+
+    # Once compiled, the specialization replaces the fallback.
+    _wait_for_pending(kernel_async, device)
+    assert len(kernel_async.cache[device]) == 1
+    kernel_async[(1, )](x, 7, BLOCK=1)
+    assert fallback_calls == [5]
+    assert x.item() == 7
+
+
+def test_async_compile_generic() -> None:
+    reset_tmp_dir()
+    JITFunction.cache_hook = None
+    device = torch.cuda.current_device()
+
+    @triton.jit(async_compile=True)
+    def kernel_async(X, i, BLOCK: tl.constexpr):
+        tl.store(X, i)
+
+    x = torch.empty(1, dtype=torch.int32, device='cuda')
+    # Served by the generic variant, with the right result, until the
+    # specializations for 16 and 1 are ready.
+    kernel_async[(1, )](x, 16, BLOCK=1)
+    assert x.item() == 16
+    kernel_async[(1, )](x, 1, BLOCK=1)
+    assert x.item() == 1
+    _wait_for_pending(kernel_async, device)
+    # One generic variant and two specializations.
+    assert len(kernel_async.cache[device]) == 3
+    kernel_async[(1, )](x, 32, BLOCK=1)
+    assert x.item() == 32
+
+
+def test_late_specialization(monkeypatch) -> None:
+    reset_tmp_dir()
+    monkeypatch.setenv("TRITON_LATE_SPECIALIZATION", "1")
+    from triton.compiler.compiler import ASTSource
+    make_ir = ASTSource.make_ir
+    num_make_ir = 0
+
+    def counting_make_ir(self, *args, **kwargs):
+        nonlocal num_make_ir
+        num_make_ir += 1
+        return make_ir(self, *args, **kwargs)
+
+    monkeypatch.setattr(ASTSource, "make_ir", counting_make_ir)
+
+    @triton.jit
+    def kernel_late(X, i, j, BLOCK: tl.constexpr):
+        tl.store(X, i * 10 + j)
+
+    x = torch.empty(1, dtype=torch.int32, device='cuda')
+    for i, j in [(16, 3), (1, 3), (3, 1), (1, 1), (7, 5)]:
+        kernel_late[(1, )](x, i, j, BLOCK=1)
+        assert x.item() == i * 10 + j
+    # The specializations of the arguments share the TTIR of the generic variant.
+    assert num_make_ir == 1
+
+
+@pytest.mark.parametrize("cache_ir", ["gzip", "none"])
+def test_cache_ir(cache_ir, monkeypatch) -> None:
+    reset_tmp_dir()
+    monkeypatch.setenv("TRITON_CACHE_IR", cache_ir)
+
+    @triton.jit
+    def kernel_cache_ir(X, i):
+        tl.store(X, i)
+
+    x = torch.empty(1, dtype=torch.int32, device='cuda')
+    device = torch.cuda.current_device()
+    kernel_cache_ir[(1, )](x, 3)
+    files = [f for key in os.listdir(tmpdir) for f in os.listdir(os.path.join(tmpdir, key))]
+    assert not any(f.endswith(".ttgir") for f in files)
+    assert any(f.endswith(".ttgir.gz") for f in files) == (cache_ir == "gzip")
+
+    # The kernel is loaded from the cache.
+    kernel_cache_ir.cache[device].clear()
+    kernel_cache_ir[(1, )](x, 5)
+    assert x.item() == 5
+    kernel = next(iter(kernel_cache_ir.cache[device].values()))
+    assert "cubin" in kernel.asm or "hsaco" in kernel.asm
+    assert ("ttgir" in kernel.asm) == (cache_ir == "gzip")
+
+
+def test_evict_cache(tmp_path) -> None:
+    assert parse_cache_size("2K") == 2048
+    assert parse_cache_size("1.5M") == 3 << 19
+    now = time.time()
+    for i, age in enumerate([1000, 3000, 2000, 10]):
+        os.makedirs(tmp_path / f"key{i}")
+        path = tmp_path / f"key{i}" / "k.cubin"
+        path.write_bytes(b"\0" * 100)
+        os.utime(path, (now - age, now - age))
+    # The oldest kernels go first, and kernels used in the last minute stay.
+    evict_cache(str(tmp_path), 250)
+    assert sorted(os.listdir(tmp_path)) == ["key0", "key3"]
+    evict_cache(str(tmp_path), 0, keep="key0")
+    assert sorted(os.listdir(tmp_path)) == ["key0", "key3"]
+    evict_cache(str(tmp_path), 0)
+    assert sorted(os.listdir(tmp_path)) == ["key3"]
+
+
+class DictRemoteCacheBackend(RemoteCacheBackend):
+    store = {}
+    num_gets = 0
+
+    def __init__(self, key):
+        self._key = key
+
+    def get(self, filenames):
+        DictRemoteCacheBackend.num_gets += 1
+        return {f: self.store[(self._key, f)] for f in filenames if (self._key, f) in self.store}
+
+    def put(self, filename, data):
+        self.store[(self._key, filename)] = data
+
+
+def test_tiered_remote_cache(monkeypatch) -> None:
+    monkeypatch.setenv("TRITON_REMOTE_CACHE_BACKEND", f"{__name__}:DictRemoteCacheBackend")
+    monkeypatch.setenv("TRITON_REMOTE_CACHE_TIERED", "1")
+    monkeypatch.setattr(RemoteCacheManager, "_local_paths", {})
+    reset_tmp_dir()
+
+    writer = RemoteCacheManager("kernel_key")
+    group = {name: writer.put(data, name) for name, data in [("k.ttir", "ttir"), ("k.cubin", b"\x00\x01")]}
+    group["k.json"] = writer.put("{}", "k.json", binary=False)
+    writer.put_group("k.json", group)
+    RemoteCacheManager._write_behind.submit(lambda: None).result()
+
+    # Served from memory and disk, without remote round trips.
+    DictRemoteCacheBackend.num_gets = 0
+    assert RemoteCacheManager("kernel_key").get_group("k.json") == group
+    assert DictRemoteCacheBackend.num_gets == 0
+
+    # A cold node fetches the whole group in a single round trip.
+    reset_tmp_dir()
+    monkeypatch.setattr(RemoteCacheManager, "_local_paths", {})
+    reader = RemoteCacheManager("kernel_key")
+    result = reader.get_group("k.json")
+    assert DictRemoteCacheBackend.num_gets == 1
+    assert sorted(result.keys()) == sorted(group.keys())
+    with open(result["k.cubin"], "rb") as f:
+        assert f.read() == b"\x00\x01"
+
+
+@triton.jit
+def kernel_manifest(X, i, BLOCK: tl.constexpr):
+    tl.store(X, i + BLOCK)
+
+
+def test_manifest(tmp_path) -> None:
+    from triton.runtime import manifest
+    reset_tmp_dir()
+    JITFunction.cache_hook = None
+    device = torch.cuda.current_device()
+    kernel_manifest.cache[device].clear()
+
+    manifest.start_recording()
+    x = torch.empty(1, dtype=torch.int32, device='cuda')
+    kernel_manifest[(1, )](x, 1, BLOCK=8)
+    kernel_manifest[(1, )](x, 16, BLOCK=8)
+    path = str(tmp_path / "manifest.json")
+    manifest.save(path)
+    assert len(manifest.stop_recording()) == 2
+    hashes = {k.hash for k in kernel_manifest.cache[device].values()}
+
+    # Loading doesn't compile anything: the binaries come from the cache.
+    kernel_manifest.cache[device].clear()
+    counter = 0
+
+    def inc_counter(*args, **kwargs):
+        nonlocal counter
+        counter += 1
+
+    JITFunction.cache_hook = inc_counter
+    assert manifest.load(path) == 2
+    assert {k.hash for k in kernel_manifest.cache[device].values()} == hashes
+    kernel_manifest[(1, )](x, 16, BLOCK=8)
+    JITFunction.cache_hook = None
+    assert counter == 0
+    assert x.item() == 24
+
+
+def test_archive(tmp_path) -> None:
+    from triton.runtime import archive, manifest
+    reset_tmp_dir()
+    JITFunction.cache_hook = None
+    device = torch.cuda.current_device()
+    kernel_manifest.cache[device].clear()
+
+    manifest.start_recording()
+    x = torch.empty(1, dtype=torch.int32, device='cuda')
+    kernel_manifest[(1, )](x, 1, BLOCK=8)
+    kernel_manifest[(1, )](x, 16, BLOCK=8)
+    manifest_path = str(tmp_path / "manifest.json")
+    manifest.save(manifest_path)
+    manifest.stop_recording()
+    archive_path = str(tmp_path / "kernels.ttar")
+    assert archive.pack(manifest_path, archive_path) == 2
+
+    # The binaries come from the archive, without the kernel cache.
+    reset_tmp_dir()
+    kernel_manifest.cache[device].clear()
+    counter = 0
+
+    def inc_counter(*args, **kwargs):
+        nonlocal counter
+        counter += 1
+
+    JITFunction.cache_hook = inc_counter
+    assert manifest.load(manifest_path, archive=archive_path) == 2
+    kernel_manifest[(1, )](x, 16, BLOCK=8)
+    JITFunction.cache_hook = None
+    assert counter == 0
+    assert x.item() == 24
+    assert all(isinstance(k.kernel, memoryview) for k in kernel_manifest.cache[device].values())
+
+
+def test_shared_handles() -> None:
+    reset_tmp_dir()
+    device = torch.cuda.current_device()
+    kernel_manifest.cache[device].clear()
+    x = torch.empty(1, dtype=torch.int32, device='cuda')
+    kernel_manifest[(1, )](x, 1, BLOCK=8)
+    first = next(iter(kernel_manifest.cache[device].values()))
+
+    # The kernel loaded again from the cache reuses the handles of the first one.
+    kernel_manifest.cache[device].clear()
+    kernel_manifest[(1, )](x, 1, BLOCK=8)
+    second = next(iter(kernel_manifest.cache[device].values()))
+    assert second is not first
+    assert second.function == first.function
+    assert x.item() == 9
@@ -12,3 +12,26 @@ def test_is_lazy():
     assert triton.runtime.driver.active._obj is None
     utils = triton.runtime.driver.active.utils  # noqa: F841
     assert issubclass(triton.runtime.driver.active._obj.__class__, getattr(triton.backends.driver, "DriverBase"))
+
+
+def test_shared_carveout():
+    import pytest
+    import torch
+    import triton.language as tl
+    if not triton.runtime.driver.active.get_current_target().backend == "cuda":
+        pytest.skip("the shared memory carveout is specific to CUDA")
+
+    @triton.jit
+    def copy(src, dst, BLOCK: tl.constexpr):
+        offs = tl.arange(0, BLOCK)
+        tl.store(dst + offs, tl.load(src + offs))
+
+    src = torch.randn(128, device="cuda")
+    dst = torch.empty_like(src)
+    kernel = copy[(1, )](src, dst, BLOCK=128)
+    utils = triton.runtime.driver.active.utils
+    # without shared memory, the carveout is that of the memory reserved for the resident CTAs
+    assert utils.set_shared_carveout(kernel.function, kernel.metadata.shared) < 50
+    assert utils.set_shared_carveout(kernel.function, 1 << 20, 1) == 100
+    copy[(1, )](src, dst, BLOCK=128)
+    assert torch.equal(src, dst)
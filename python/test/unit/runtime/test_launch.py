@@ -7,6 +7,7 @@ import gc
 # import time
 import tracemalloc
 
+import pytest
 import torch
 
 import triton
@@ -43,6 +44,64 @@ def test_metadata() -> None:
     assert used_hook
 
 
+def test_resource_report(device) -> None:
+
+    @triton.jit
+    def kernel(x_ptr, BLOCK: tl.constexpr):
+        offs = tl.arange(0, BLOCK)
+        tl.store(x_ptr + offs, tl.load(x_ptr + offs) + 1)
+
+    x = torch.zeros(1024, device=device)
+    compiled = kernel[(1, )](x, BLOCK=1024, num_warps=4)
+    report = compiled.resource_report()
+    assert report["registers"] > 0
+    assert report["num_warps"] == 4
+    assert report["shared"] == compiled.metadata.shared
+    assert report["local_memory"] >= 0
+    if "occupancy" in report:
+        assert report["programs_per_sm"] > 0
+        assert 0 < report["occupancy"] <= 1
+        assert report["limiter"] in ("warps", "registers", "shared", "programs")
+    if triton.runtime.driver.active.get_current_target().backend == "cuda" and report["spill_stores"] is not None:
+        assert compiled.metadata.registers == report["registers"]
+        assert report["spill_stores"] == report["spill_loads"] == 0
+
+
+def test_native_hooks() -> None:
+    import ctypes
+
+    events = []
+    registered = []
+    hook_type = ctypes.CFUNCTYPE(None, ctypes.c_uint64)
+    enter = hook_type(lambda function: events.append(("enter", function)))
+    exit = hook_type(lambda function: events.append(("exit", function)))
+
+    def _launch_metadata(grid, kernel, args):
+        return {"value": args["x"]}
+
+    @triton.jit(launch_metadata=_launch_metadata)
+    def kernel(x):
+        pass
+
+    CompiledKernel = triton.compiler.CompiledKernel
+    CompiledKernel.launch_register_hook = registered.append
+    CompiledKernel.launch_metadata_hook = lambda launch_metadata: events.append(launch_metadata.get()["value"])
+    CompiledKernel.launch_enter_hook = ctypes.cast(enter, ctypes.c_void_p).value
+    CompiledKernel.launch_exit_hook = ctypes.cast(exit, ctypes.c_void_p).value
+    try:
+        kernel[(1, )](6)
+        kernel[(1, )](7)
+    finally:
+        CompiledKernel.launch_enter_hook = None
+        CompiledKernel.launch_exit_hook = None
+        CompiledKernel.launch_register_hook = None
+        CompiledKernel.launch_metadata_hook = None
+    # Kernels are registered once, before their first launch
+    assert len(registered) == 1
+    function = registered[0].function
+    assert events == [6, ("enter", function), ("exit", function), 7, ("enter", function), ("exit", function)]
+
+
 def test_memory_leak() -> None:
 
     @triton.jit
@@ -132,3 +191,100 @@ def test_memory_leak() -> None:
 
 #     # Run empty, which would run empty_kernel internally
 #     empty(*kernel_args)
+
+
+def test_kernel_graph(device) -> None:
+    if not hasattr(triton.runtime.driver.active, "create_kernel_graph"):
+        pytest.skip("kernel graphs are not supported by this backend")
+
+    @triton.jit
+    def add_kernel(x_ptr, y_ptr, val, N, BLOCK: tl.constexpr):
+        offs = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        mask = offs < N
+        tl.store(y_ptr + offs, tl.load(x_ptr + offs, mask=mask) + val, mask=mask)
+
+    N = 1024
+    x = torch.zeros(N, device=device)
+    y = torch.empty(N, device=device)
+    z = torch.empty(N, device=device)
+    kernel = add_kernel.warmup(x, y, 1.0, N, BLOCK=128, grid=(1, ))
+
+    graph = triton.runtime.driver.active.create_kernel_graph()
+    first = graph.add(kernel, (N // 128, ), x, y, 1.0, N)
+    second = graph.add(kernel, (N // 128, ), y, z, 1.0, N)
+    graph.launch()
+    torch.cuda.synchronize()
+    assert torch.equal(z, torch.full_like(x, 2.0))
+
+    graph.update(first, (N // 128, ), x, y, 3.0, N)
+    graph.update(second, (N // 256, ), y, z, 1.0, N // 2)
+    graph.launch()
+    torch.cuda.synchronize()
+    assert torch.equal(y, torch.full_like(x, 3.0))
+    assert torch.equal(z[:N // 2], torch.full_like(x[:N // 2], 4.0))
+    assert torch.equal(z[N // 2:], torch.full_like(x[N // 2:], 2.0))
+
+
+@pytest.mark.parametrize("graph", [False, True])
+def test_launch_batch(graph, device) -> None:
+    if graph and not hasattr(triton.runtime.driver.active, "create_kernel_graph"):
+        pytest.skip("kernel graphs are not supported by this backend")
+
+    @triton.jit
+    def add_kernel(x_ptr, y_ptr, val, N, BLOCK: tl.constexpr):
+        offs = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        mask = offs < N
+        tl.store(y_ptr + offs, tl.load(x_ptr + offs, mask=mask) + val, mask=mask)
+
+    N = 1024
+    xs = [torch.full((N, ), float(i), device=device) for i in range(4)]
+    ys = [torch.empty(N, device=device) for _ in range(4)]
+    grid = lambda meta: (triton.cdiv(meta["N"], meta["BLOCK"]), )
+    batch = triton.runtime.launch_batch([(add_kernel, grid, (x, y, 1.0, N), {"BLOCK": 128}) for x, y in zip(xs, ys)],
+                                        graph=graph)
+    torch.cuda.synchronize()
+    assert len(batch) == 4
+    for i, y in enumerate(ys):
+        assert torch.equal(y, torch.full_like(y, i + 1.0))
+
+    # Launching again uses the arguments bound when the launches were added.
+    for x in xs:
+        x.add_(1.0)
+    batch.launch()
+    torch.cuda.synchronize()
+    for i, y in enumerate(ys):
+        assert torch.equal(y, torch.full_like(y, i + 2.0))
+
+
+def test_horizontal_fuse(device) -> None:
+
+    @triton.jit
+    def add_kernel(x_ptr, y_ptr, val, N, BLOCK: tl.constexpr):
+        offs = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        mask = offs < N
+        tl.store(y_ptr + offs, tl.load(x_ptr + offs, mask=mask) + val, mask=mask)
+
+    @triton.jit
+    def ids_kernel(out_ptr):
+        x = tl.program_id(0)
+        y = tl.program_id(1)
+        z = tl.program_id(2)
+        tl.store(out_ptr + (z * tl.num_programs(1) + y) * tl.num_programs(0) + x, x + 10 * y + 100 * z)
+
+    N = 1000
+    x = torch.rand(N, device=device)
+    y = torch.empty(N, device=device)
+    z = torch.empty(N, device=device)
+    ids = torch.empty((2, 3, 4), dtype=torch.int32, device=device)
+    grid = lambda meta: (triton.cdiv(meta["N"], meta["BLOCK"]), )
+    fused = triton.horizontal_fuse([add_kernel, ids_kernel, add_kernel])
+    for _ in range(2):
+        fused((grid, (x, y, 1.0, N), {"BLOCK": 128}), ((4, 3, 2), (ids, )), (grid, (x, z, 2.0, N), {"BLOCK": 256}))
+    torch.cuda.synchronize()
+    torch.testing.assert_close(y, x + 1.0)
+    torch.testing.assert_close(z, x + 2.0)
+    expected = torch.arange(4, device=device) + 10 * torch.arange(3, device=device)[:, None] + 100 * torch.arange(
+        2, device=device)[:, None, None]
+    assert torch.equal(ids, expected.to(torch.int32))
+    # The launches share a kernel.
+    assert len(fused.fn.cache[torch.cuda.current_device()]) == 1
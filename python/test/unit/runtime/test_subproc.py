@@ -71,3 +71,23 @@ def test_compile_in_forked_subproc() -> None:
     proc.start()
     proc.join()
     assert proc.exitcode == 0
+
+
+def test_compile_many() -> None:
+    reset_tmp_dir()
+
+    @triton.jit
+    def kernel_scale(a, o, N: tl.constexpr, SCALE: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx, tl.load(a + idx) * SCALE)
+
+    srcs = [
+        ASTSource(fn=kernel_scale, constants={2: 32, 3: scale}, signature={0: "*fp32", 1: "*fp32"})
+        for scale in range(8)
+    ]
+    kernels = triton.compile_many(srcs, target=target)
+    assert len(kernels) == len(srcs)
+    # Each kernel is compiled from its own specialization.
+    assert len({k.hash for k in kernels}) == len(srcs)
+    for k in kernels:
+        assert k.asm["ttgir"]
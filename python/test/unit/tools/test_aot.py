@@ -1,4 +1,5 @@
 import glob
+import json
 import os
 import subprocess
 import sys
@@ -112,7 +113,27 @@ def gen_kernel_library(dir, libname):
     subprocess.run(command, check=True, cwd=dir)
 
 
-def gen_test_bin(dir, M, N, K, exe="test", algo_id=0):
+def gen_test_bin(dir, M, N, K, exe="test", algo_id=0, tuned=False, graph_kernel=None):
+    # launch the kernel `graph_kernel` of header `graph_kernel.h` through a CUDA graph if given
+    graph_src = "" if graph_kernel is None else f"""
+#include "{graph_kernel[1]}"
+static CUresult launch_graph(CUstream stream, CUdeviceptr C, CUdeviceptr A, CUdeviceptr B, int32_t M, int32_t N,
+                             int32_t K, int32_t stride_cm, int32_t stride_cn, int32_t stride_am, int32_t stride_ak,
+                             int32_t stride_bk, int32_t stride_bn) {{
+  CUDA_KERNEL_NODE_PARAMS node_params;
+  {graph_kernel[0]}_node_args node_args;
+  CUresult err = {graph_kernel[0]}_get_node_params(&node_params, &node_args, C, A, B, M, N, K, stride_cm, stride_cn,
+                                                  stride_am, stride_ak, stride_bk, stride_bn);
+  CUgraph graph;
+  CUgraphNode node;
+  CUgraphExec exec;
+  if (err == CUDA_SUCCESS) err = cuGraphCreate(&graph, 0);
+  if (err == CUDA_SUCCESS) err = cuGraphAddKernelNode(&node, graph, NULL, 0, &node_params);
+  if (err == CUDA_SUCCESS) err = cuGraphInstantiate(&exec, graph, 0);
+  if (err == CUDA_SUCCESS) err = cuGraphLaunch(exec, stream);
+  return err;
+}}
+"""
     test_src = f"""
 int main(int argc, char **argv) {{
   int M = {M}, N = {N}, K = {K};
@@ -146,7 +167,11 @@ int main(int argc, char **argv) {{
   cuStreamSynchronize(stream);
   CUresult ret;
   int algo_id = {algo_id};
-  if (algo_id == 0) {{
+  if ({int(graph_kernel is not None)}) {{
+    ret = {"launch_graph" if graph_kernel else "matmul_fp16_default"}(stream, C, A, B, M, N, K, N, 1, K, 1, N, 1);
+  }} else if ({int(tuned)}) {{
+    ret = matmul_fp16_tuned(stream, C, A, B, M, N, K, N, 1, K, 1, N, 1);
+  }} else if (algo_id == 0) {{
     ret = matmul_fp16_default(stream, C, A, B, M, N, K, N, 1, K, 1, N, 1);
   }} else {{
     ret = matmul_fp16(stream, C, A, B, M, N, K, N, 1, K, 1, N, 1, {algo_id});
@@ -170,7 +195,7 @@ int main(int argc, char **argv) {{
   cuCtxDestroy(ctx);
 }}
 """
-    src = test_utils_src + test_src
+    src = test_utils_src + graph_src + test_src
     with open(os.path.join(dir, "test.c"), "w") as file:
         file.write(src)
 
@@ -195,8 +220,9 @@ def write_triton_kernels(dir, src, util_src):
     return kernel_path
 
 
-def _compile_kernel(dir, signature, kernel_name, out_name, out_path, num_warps, grid, kernel_path):
+def _compile_kernel(dir, signature, kernel_name, out_name, out_path, num_warps, grid, kernel_path, targets=None):
     compiler_path = os.path.join(triton.tools.__path__[0], "compile.py")
+    target_args = ["--target", targets] if targets else []
 
     subprocess.run(
         [
@@ -214,6 +240,7 @@ def _compile_kernel(dir, signature, kernel_name, out_name, out_path, num_warps,
             str(num_warps),
             "-g",
             grid,
+            *target_args,
             kernel_path,
         ],
         check=True,
@@ -239,7 +266,7 @@ def compile_aot_kernel_no_specialization(dir, kernel_path, dtype, BM, BN, BK):
     )
 
 
-def compile_aot_kernels(dir, kernel_path, dtype, BM, BN, BK, ha_hb_hints):
+def compile_aot_kernels(dir, kernel_path, dtype, BM, BN, BK, ha_hb_hints, targets=None):
     # compile all desired configs
     for ha in ha_hb_hints:
         for hb in ha_hb_hints:
@@ -255,15 +282,22 @@ def compile_aot_kernels(dir, kernel_path, dtype, BM, BN, BK, ha_hb_hints):
                 num_warps=1,
                 grid=grid,
                 kernel_path=kernel_path,
+                targets=targets,
             )
 
 
-def link_aot_kernels(dir):
+def link_aot_kernels(dir, tuned_configs=None, cpp=False):
     linker_path = os.path.join(triton.tools.__path__[0], "link.py")
+    tuned_args = ["--cpp"] if cpp else []
+    if tuned_configs is not None:
+        configs_path = os.path.join(dir, "tuned_configs.json")
+        with open(configs_path, "w") as f:
+            json.dump(tuned_configs, f)
+        tuned_args += ["--tuned-configs", configs_path]
 
     # link all desired configs
     h_files = glob.glob(os.path.join(dir, "*.h"))
-    subprocess.run([sys.executable, linker_path] + h_files + ["-o", "kernel"], check=True, cwd=dir)
+    subprocess.run([sys.executable, linker_path] + h_files + ["-o", "kernel"] + tuned_args, check=True, cwd=dir)
 
 
 def generate_matmul_test_data(dir, M, N, K):
@@ -340,6 +374,80 @@ def test_compile_link_matmul():
         np.testing.assert_allclose(c_tri, c_ref * c_ref, atol=1e-4, rtol=0.0)
 
 
+def test_compile_link_matmul_multi_target():
+    np.random.seed(3)
+
+    # embed a cubin for another architecture next to the one of the device
+    capability = triton.runtime.driver.active.get_current_target().arch
+    other = 80 if capability != 80 else 90
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        dtype = "fp16"
+        BM, BN, BK = 16, 16, 16
+
+        kernel_path = write_triton_kernels(tmp_dir, kernel_src, kernel_utils_src)
+        compile_aot_kernels(tmp_dir, kernel_path, dtype, BM, BN, BK, ha_hb_hints=[":16"],
+                            targets=f"cuda:{other},cuda:{capability}")
+        for c_file in glob.glob(os.path.join(tmp_dir, "matmul_*.c")):
+            with open(c_file) as f:
+                c_src = f.read()
+            assert f"_cubin_sm{other}[" in c_src
+            assert f"_cubin_sm{capability}[" in c_src
+        link_aot_kernels(tmp_dir)
+
+        # compile test case
+        M, N, K = 16, 16, 16
+        gen_kernel_library(tmp_dir, "libkernel.so")
+        gen_test_bin(tmp_dir, M, N, K)
+
+        # initialize test data
+        a, b, a_path, b_path, c_path = generate_matmul_test_data(tmp_dir, M, N, K)
+
+        # run test case
+        env = os.environ.copy()
+        env["LD_LIBRARY_PATH"] = tmp_dir
+        subprocess.run(["./test", a_path, b_path, c_path], env=env, check=True, cwd=tmp_dir)
+
+        # read data and compare against reference
+        c = np.genfromtxt(c_path, delimiter=",", dtype=np.int32)
+        c_tri = c.reshape((M, N)).view(np.float32)
+        c_ref = np.matmul(a.astype(np.float32), b.astype(np.float32))
+        np.testing.assert_allclose(c_tri, c_ref * c_ref, atol=1e-4, rtol=0.0)
+
+
+def test_compile_link_matmul_graph():
+    np.random.seed(3)
+
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        dtype = "fp16"
+        BM, BN, BK = 16, 16, 16
+
+        kernel_path = write_triton_kernels(tmp_dir, kernel_src, kernel_utils_src)
+        compile_aot_kernel_no_specialization(tmp_dir, kernel_path, dtype, BM, BN, BK)
+        link_aot_kernels(tmp_dir)
+        # the header of the kernel is matmul_fp16.<hash>_<suffix>.h, for a kernel matmul_fp16_<hash>_<suffix>
+        (header, ) = [os.path.basename(h) for h in glob.glob(os.path.join(tmp_dir, "matmul_fp16.*.h"))]
+        kernel_name = header[:-len(".h")].replace(".", "_")
+
+        # compile test case
+        M, N, K = 16, 16, 16
+        gen_kernel_library(tmp_dir, "libkernel.so")
+        gen_test_bin(tmp_dir, M, N, K, graph_kernel=(kernel_name, header))
+
+        # initialize test data
+        a, b, a_path, b_path, c_path = generate_matmul_test_data(tmp_dir, M, N, K)
+
+        # run test case
+        env = os.environ.copy()
+        env["LD_LIBRARY_PATH"] = tmp_dir
+        subprocess.run(["./test", a_path, b_path, c_path], env=env, check=True, cwd=tmp_dir)
+
+        # read data and compare against reference
+        c = np.genfromtxt(c_path, delimiter=",", dtype=np.int32)
+        c_tri = c.reshape((M, N)).view(np.float32)
+        c_ref = np.matmul(a.astype(np.float32), b.astype(np.float32))
+        np.testing.assert_allclose(c_tri, c_ref * c_ref, atol=1e-4, rtol=0.0)
+
+
 def test_launcher_has_no_available_kernel():
     np.random.seed(3)
 
@@ -424,6 +532,72 @@ def test_compile_link_autotune_matmul():
             np.testing.assert_allclose(c_tri, c_ref * c_ref, atol=1e-4, rtol=1e-4)
 
 
+def test_compile_link_tuned_matmul():
+    np.random.seed(3)
+
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        dtype = "fp16"
+
+        kernel_path = write_triton_kernels(tmp_dir, kernel_src, kernel_utils_src)
+        for BM, BN, BK in [[16, 16, 16], [32, 32, 32]]:
+            compile_aot_kernels(tmp_dir, kernel_path, dtype, BM, BN, BK, ha_hb_hints=["", ":16"])
+
+        tuned_configs = {
+            "dims": ["M", "N", "K"],
+            "configs": {
+                "16,16,16": "16x16x16_warps1xstages3",
+                "64,64,64": "32x32x32_warps1xstages3",
+            },
+        }
+        link_aot_kernels(tmp_dir, tuned_configs)
+        with open(os.path.join(tmp_dir, "kernel.c")) as f:
+            assert "matmul_fp16_tuned_table[8]" in f.read()
+
+        gen_kernel_library(tmp_dir, "libkernel.so")
+
+        for M, N, K in [(16, 16, 16), (64, 64, 64)]:
+            a, b, a_path, b_path, c_path = generate_matmul_test_data(tmp_dir, M, N, K)
+            gen_test_bin(tmp_dir, M, N, K, tuned=True)
+
+            env = os.environ.copy()
+            env["LD_LIBRARY_PATH"] = tmp_dir
+            subprocess.run(["./test", a_path, b_path, c_path], env=env, check=True, cwd=tmp_dir)
+
+            c = np.genfromtxt(c_path, delimiter=",", dtype=np.int32)
+            c_tri = c.reshape((M, N)).view(np.float32)
+            c_ref = np.matmul(a.astype(np.float32), b.astype(np.float32))
+            np.testing.assert_allclose(c_tri, c_ref * c_ref, atol=1e-4, rtol=1e-4)
+
+
+def test_link_cpp_wrappers():
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        dtype = "fp16"
+        BM, BN, BK = 16, 16, 16
+
+        kernel_path = write_triton_kernels(tmp_dir, kernel_src, kernel_utils_src)
+        compile_aot_kernels(tmp_dir, kernel_path, dtype, BM, BN, BK, ha_hb_hints=["", ":16"])
+        link_aot_kernels(tmp_dir, cpp=True)
+
+        # the hints carried by the types pick the kernel at compile time, and wrong types don't compile
+        src = """
+#include "kernel.hpp"
+using namespace triton::aot;
+CUresult launch(CUstream stream, CUdeviceptr C, CUdeviceptr A, CUdeviceptr B, int32_t M, int32_t N, int32_t K) {
+  return kernel::matmul_fp16_16x16x16_warps1xstages3(
+      stream, Ptr<float, 16>{C}, Ptr<fp16, 16>{A}, Ptr<fp16, 16>{B}, M, N, K, Int<int32_t, 16>{N},
+      Const<int32_t, 1>{}, Int<int32_t, 16>{K}, Const<int32_t, 1>{}, Int<int32_t, 16>{N}, Const<int32_t, 1>{});
+}
+"""
+        for ty, ok in [("fp16", True), ("float", False)]:
+            with open(os.path.join(tmp_dir, "test.cpp"), "w") as f:
+                f.write(src.replace("Ptr<fp16, 16>{A}", f"Ptr<{ty}, 16>{{A}}"))
+            result = subprocess.run(["g++", "-std=c++17", "-fsyntax-only", "-I", include_dir[0], "test.cpp"],
+                                    cwd=tmp_dir, capture_output=True, text=True)
+            assert (result.returncode == 0) == ok, result.stderr
+        with open(os.path.join(tmp_dir, "kernel.hpp")) as f:
+            assert "if constexpr" in f.read()
+
+
 def test_ttgir_to_ptx():
     src = """
 module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32, "triton_gpu.num-ctas" = 1 : i32} {
@@ -0,0 +1,23 @@
+from triton.tools.bisect_perf import get_changes, split_pipeline, with_max_rematerializations
+
+
+def test_split_pipeline():
+    assert split_pipeline("builtin.module(a, b{x=1 y=2}, c(d,e))") == ["a", "b{x=1 y=2}", "c(d,e)"]
+    assert split_pipeline("a,b") == ["a", "b"]
+
+
+def test_get_changes():
+    good = ["a", "b", "c"]
+    bad = ["a", "x", "c", "y"]
+    changes, apply = get_changes(good, bad)
+    assert changes == [(["b"], ["x"]), ([], ["y"])]
+    assert apply(0) == good
+    assert apply(1) == ["a", "x", "c"]
+    assert apply(2) == bad
+
+
+def test_with_max_rematerializations():
+    passes = ["tritongpu-coalesce", "tritongpu-remove-layout-conversions"]
+    assert with_max_rematerializations(passes, 3) == [
+        "tritongpu-coalesce", "tritongpu-remove-layout-conversions{max-rematerializations=3}"
+    ]
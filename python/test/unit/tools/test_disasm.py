@@ -20,3 +20,51 @@ def test_disam_cubin():
     sass = get_sass(h.asm["cubin"])
     # check that the sass has a store instruction.
     assert "STG.E" in sass
+
+
+def test_analyze_sass():
+    from triton.tools.disasm import analyze_sass
+    sass = "\n".join([
+        "Function:kernel",
+        "--:-:-:Y:4\tS2R R0, SR_TID.X;",
+        "LBB0:",
+        "--:-:2:Y:2\tLDG.E.128 R4, desc[UR4][R2.64];",
+        "--:-:3:Y:2\tLDG.E R9, desc[UR4][R2.64+0x10];",
+        "--:-:-:Y:1\tLDS.64 R10, [R0];",
+        "04:-:-:Y:4\tFADD R4, R4, R10;",
+        "--:-:-:Y:4\tSTL [R1], R4;",
+        "--:-:-:Y:4\t@P0 BRA LBB0;",
+        "08:-:-:Y:4\tSTG.E desc[UR4][R2.64], R9;",
+        "--:-:-:Y:4\tEXIT;",
+    ])
+    analysis = analyze_sass(sass)["kernel"]
+    assert analysis["instructions"] == 9
+    assert analysis["mix"]["global_load"] == 2 and analysis["mix"]["shared_load"] == 1
+    assert analysis["vector_widths"]["LDG"] == {32: 1, 128: 1}
+    assert analysis["spills"] == 1
+    # The FADD waits for the 128-bit load of the same iteration, but the load of R9 is consumed after the loop.
+    loop, = analysis["loops"]
+    assert (loop["start"], loop["end"]) == (1, 6)
+    stall, = loop["stalls"]
+    assert stall["load"].startswith("LDG.E.128") and stall["use"].startswith("FADD") and stall["distance"] == 3
+
+
+def test_analyze_cubin():
+    if not triton.runtime.driver.active.get_current_target().backend == "cuda":
+        pytest.skip("Test requires CUDA.")
+    from triton.tools.disasm import analyze
+
+    @triton.jit
+    def kernel(X, Y, N, BLOCK: tl.constexpr):
+        acc = tl.zeros((BLOCK, ), dtype=tl.float32)
+        for i in range(0, N, BLOCK):
+            acc += tl.load(X + i + tl.arange(0, BLOCK))
+        tl.store(Y + tl.arange(0, BLOCK), acc)
+
+    x = torch.ones(1024, device='cuda')
+    y = torch.empty(128, device='cuda')
+    h = kernel[(1, )](x, y, 1024, BLOCK=128)
+    analysis = analyze(h.asm["cubin"])["kernel"]
+    assert analysis["mix"]["global_load"] > 0 and analysis["mix"]["global_store"] > 0
+    assert analysis["spills"] == 0
+    assert analysis["loops"]
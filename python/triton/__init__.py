@@ -8,7 +8,9 @@ __version__ = '3.0.0'
 from .runtime import (
     autotune,
     Config,
+    ConfigSpace,
     heuristics,
+    horizontal_fuse,
     JITFunction,
     KernelInterface,
     reinterpret,
@@ -18,7 +20,7 @@ from .runtime import (
     MockTensor,
 )
 from .runtime.jit import jit
-from .compiler import compile, CompilationError
+from .compiler import compile, compile_many, CompilationError
 from .errors import TritonError
 
 from . import language
@@ -30,8 +32,11 @@ __all__ = [
     "cdiv",
     "CompilationError",
     "compile",
+    "compile_many",
     "Config",
+    "ConfigSpace",
     "heuristics",
+    "horizontal_fuse",
     "impl",
     "InterpreterError",
     "jit",
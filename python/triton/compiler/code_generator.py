@@ -13,6 +13,7 @@ from ..language.core import _unwrap_if_constexpr
 from ..runtime.jit import _normalize_ty, get_jit_fn_file_line
 # ideally we wouldn't need any runtime component
 from ..runtime import JITFunction
+from ..runtime.fusion import fused_call
 from .errors import (CompilationError, CompileTimeAssertionFailure, UnsupportedLanguageConstruct)
 from types import ModuleType
 
@@ -55,21 +56,18 @@ def _is_constexpr(o: Any) -> bool:
     return isinstance(o, constexpr)
 
 
-def _is_triton_scalar(o: Any) -> bool:
-    return _is_triton_tensor(o) and (not o.type.is_block() or o.type.numel == 1)
-
-
 def _is_list_like(o: Any) -> bool:
     return isinstance(o, (list, tuple))
 
 
 def _check_fn_args(node, fn, args):
     if fn.noinline:
+        # Tensors are passed in the registers holding their elements in each thread, given by their layout.
         for idx, arg in enumerate(args):
-            if not _is_constexpr(arg) and not _is_triton_scalar(arg):
+            if not _is_constexpr(arg) and not _is_triton_tensor(arg):
                 raise UnsupportedLanguageConstruct(
                     fn.src, node,
-                    f'Function {fn.__name__} is marked noinline, but was called with non-scalar argument {fn.arg_names[idx]}:{arg}'
+                    f'Function {fn.__name__} is marked noinline, but was called with non-tensor argument {fn.arg_names[idx]}:{arg}'
                 )
 
 
@@ -189,9 +187,12 @@ class CodeGenerator(ast.NodeVisitor):
 
     def __init__(self, context, prototype, gscope, attributes, constants, function_name, jit_fn: JITFunction, options,
                  codegen_fns, debug=None, module=None, is_kernel=False, function_types: Optional[Dict] = None,
-                 noinline=False, file_name: Optional[str] = None, begin_line=0):
+                 noinline=False, file_name: Optional[str] = None, begin_line=0, program_id_remap=None):
         self.context = context
         self.builder = ir.builder(context)
+        # The (start, grid) of the programs the function runs as in a horizontal fusion, if any, for which
+        # `tl.program_id` and `tl.num_programs` are those of `grid`.
+        self.builder.program_id_remap = program_id_remap
         self.file_name = file_name
         # node.lineno starts from 1, so we need to subtract 1
         self.begin_line = begin_line - 1
@@ -883,6 +884,8 @@ class CodeGenerator(ast.NodeVisitor):
                     ast.NodeVisitor.generic_visit(self, stmt)
             return
         num_stages = None
+        unroll = None
+        interleave = None
         if IteratorClass is language.range:
             iterator = IteratorClass(*iter_args, **iter_kwargs)
             # visit iterator arguments
@@ -892,6 +895,14 @@ class CodeGenerator(ast.NodeVisitor):
             ub = iterator.end
             step = iterator.step
             num_stages = iterator.num_stages
+            unroll = iterator.unroll
+            interleave = iterator.interleave
+        elif IteratorClass is language.persistent_range:
+            iterator = IteratorClass(*iter_args, **iter_kwargs)
+            lb = language.semantic.program_id(0, self.builder)
+            ub = iterator.num_tiles
+            step = language.semantic.num_programs(0, self.builder)
+            num_stages = iterator.num_stages
         elif IteratorClass is range:
             # visit iterator arguments
             # note: only `range` iterator is supported now
@@ -900,7 +911,7 @@ class CodeGenerator(ast.NodeVisitor):
             ub = iter_args[1] if len(iter_args) > 1 else self.visit(node.iter.args[0])
             step = iter_args[2] if len(iter_args) > 2 else self.visit(ast.Num(1))
         else:
-            raise RuntimeError('Only `range` and `static_range` iterators are currently supported')
+            raise RuntimeError('Only `range`, `static_range` and `persistent_range` iterators are currently supported')
         # handle negative constant step (not supported by scf.for in MLIR)
         negative_step = False
         if _is_constexpr(step) and step.value < 0:
@@ -965,6 +976,10 @@ class CodeGenerator(ast.NodeVisitor):
             for_op = self.builder.create_for_op(lb, ub, step, [arg.handle for arg in init_args])
             if num_stages is not None:
                 for_op.set_attr("tt.num_stages", self.builder.get_int32_attr(num_stages))
+            if unroll is not None:
+                for_op.set_attr("tt.loop_unroll_factor", self.builder.get_int32_attr(unroll))
+            if interleave is not None:
+                for_op.set_attr("tt.loop_interleave_factor", self.builder.get_int32_attr(interleave))
 
             self.scf_stack.append(node)
             self.builder.set_insertion_point_to_start(for_op.get_body(0))
@@ -1023,7 +1038,7 @@ class CodeGenerator(ast.NodeVisitor):
         # Convert assert to triton's device_assert which happens on the device
         return language.core.device_assert(test, msg, _builder=self.builder)
 
-    def call_JitFunction(self, fn: JITFunction, args, kwargs):
+    def call_JitFunction(self, fn: JITFunction, args, kwargs, program_id_remap=None):
         args = inspect.getcallargs(fn.fn, *args, **kwargs)
         args = [args[name] for name in fn.arg_names]
         args = [arg if _is_triton_tensor(arg) else constexpr(arg) for arg in args]
@@ -1036,6 +1051,12 @@ class CodeGenerator(ast.NodeVisitor):
         arg_vals = [arg.handle for arg in args if arg is not None]
         arg_types = [arg.type for arg in args if arg is not None]
         fn_name = mangle_fn(fn.__name__, arg_types, constants)
+        # The callees of remapped functions are remapped the same way.
+        if program_id_remap is None:
+            program_id_remap = self.builder.program_id_remap
+        if program_id_remap is not None:
+            start, grid = program_id_remap
+            fn_name += f"_pid{start}_{'x'.join(map(str, grid))}"
         # generate function def if necessary
         if not self.module.has_function(fn_name):
             prototype = language.function_type([], arg_types)
@@ -1046,7 +1067,8 @@ class CodeGenerator(ast.NodeVisitor):
             generator = CodeGenerator(self.context, prototype, gscope, attributes, constants, module=self.module,
                                       jit_fn=fn, function_name=fn_name, function_types=self.function_ret_types,
                                       noinline=fn.noinline, file_name=file_name, begin_line=begin_line,
-                                      options=self.builder.options, codegen_fns=self.builder.codegen_fns, debug=debug)
+                                      options=self.builder.options, codegen_fns=self.builder.codegen_fns, debug=debug,
+                                      program_id_remap=program_id_remap)
             try:
                 generator.visit(fn.parse())
             except Exception as e:
@@ -1171,11 +1193,12 @@ class CodeGenerator(ast.NodeVisitor):
             warnings.simplefilter("ignore", DeprecationWarning)  # python 3.9
             warnings.simplefilter("ignore", PendingDeprecationWarning)  # python 3.8
             last_node = self.cur_node
-            last_loc = self.builder.get_loc()
             self.cur_node = node
+            # The location is saved and restored in the builder, as this runs for every node.
             if hasattr(node, 'lineno') and hasattr(node, 'col_offset'):
-                self.builder.set_loc(self.file_name, self.begin_line + node.lineno, node.col_offset)
-                last_loc = self.builder.get_loc()
+                self.builder.push_loc(self.file_name, self.begin_line + node.lineno, node.col_offset)
+            else:
+                self.builder.push_loc()
             try:
                 ret = super().visit(node)
             except CompilationError:
@@ -1184,11 +1207,11 @@ class CodeGenerator(ast.NodeVisitor):
                 # Wrap the error in a CompilationError which contains the source
                 # of the @jit function.
                 raise CompilationError(self.jit_fn.src, self.cur_node, repr(e)) from None
+            finally:
+                # Reset the location to the last one before the visit
+                self.builder.pop_loc()
 
-            # Reset the location to the last one before the visit
-            if last_loc:
-                self.cur_node = last_node
-                self.builder.set_loc(last_loc)
+            self.cur_node = last_node
             return ret
 
     def generic_visit(self, node):
@@ -1216,6 +1239,16 @@ class CodeGenerator(ast.NodeVisitor):
             raise CompileTimeAssertionFailure(self.jit_fn.src, node, _unwrap_if_constexpr(message))
         return None
 
+    def execute_fused_call(self, node: ast.Call) -> None:
+        if len(node.args) < 3 or node.keywords:
+            raise TypeError("`fused_call` requires a function, a start and a grid followed by positional arguments")
+        fn = _unwrap_if_constexpr(self.visit(node.args[0]))
+        start = _unwrap_if_constexpr(self.visit(node.args[1]))
+        grid = tuple(_unwrap_if_constexpr(size) for size in self.visit(node.args[2]))
+        args = [self.visit(arg) for arg in node.args[3:]]
+        _check_fn_args(node, fn, args)
+        return self.call_JitFunction(fn, args, {}, program_id_remap=(start, grid))
+
     def static_executor(python_fn):
 
         def ret(self, node: ast.Call):
@@ -1231,6 +1264,7 @@ class CodeGenerator(ast.NodeVisitor):
     statically_implemented_functions: Dict[object, Callable[[ast.Call], Any]] = {
         language.core.static_assert: execute_static_assert,
         language.core.static_print: static_executor(print),
+        fused_call: execute_fused_call,
         int: static_executor(int),
         len: static_executor(len),
     }
@@ -1259,7 +1293,19 @@ def ast_to_ttir(fn, specialization, context, options, codegen_fns):
     function_name = fn.repr(specialization)
     tys = list(specialization.signature.values())
     new_constants = {k: True if k in tys and tys[k] == "i1" else 1 for k in attrs.equal_to_1}
-    new_attrs = {k: [("tt.divisibility", 16)] for k in attrs.divisible_by_16}
+    new_attrs = {k: [("tt.divisibility", attrs.alignments.get(k, 16))] for k in attrs.divisible_by_16}
+    # The attributes are 32-bit, so wider bounds are dropped.
+    for k, bounds in attrs.value_ranges.items():
+        for name, bound in zip(("tt.min_value", "tt.max_value"), bounds):
+            if bound is not None and -2**31 <= bound < 2**31:
+                new_attrs.setdefault(k, []).append((name, bound))
+    for k, ty in specialization.signature.items():
+        if not isinstance(ty, str) or not ty.startswith("*"):
+            continue
+        if ty.startswith("*k"):
+            new_attrs.setdefault(cst_key(k), []).append(("tt.const", 1))
+        if fn.params[cst_key(k)].is_restrict:
+            new_attrs.setdefault(cst_key(k), []).append(("tt.noalias", 1))
 
     all_constants = constants.copy()
     all_constants.update(new_constants)
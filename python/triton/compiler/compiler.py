@@ -1,7 +1,7 @@
 from __future__ import annotations
 import hashlib
 import json
-from .._C.libtriton import get_cache_invalidating_env_vars, ir
+from .._C.libtriton import get_cache_invalidating_env_vars, ir, passes
 from ..backends import backends
 from ..backends.compiler import GPUTarget
 from .. import __version__
@@ -12,32 +12,58 @@ from ..runtime.driver import driver
 from dataclasses import dataclass
 from .code_generator import ast_to_ttir
 from pathlib import Path
+from concurrent.futures import ThreadPoolExecutor
 import re
+import atexit
 import functools
+import gzip
 import os
+import sys
+import threading
 
 
 @dataclass
 class AttrsDescriptor:
     divisible_by_16: set = None
     equal_to_1: set = None
+    # The (min, max) bounds of the values of integer arguments, by index, where None is unbounded
+    value_ranges: dict = None
+    # The alignments above 16 of the divisible-by-16 arguments, by index
+    alignments: dict = None
 
     def __post_init__(self):
         if self.divisible_by_16 is None:
             self.divisible_by_16 = set()
         if self.equal_to_1 is None:
             self.equal_to_1 = set()
+        if self.value_ranges is None:
+            self.value_ranges = dict()
+        if self.alignments is None:
+            self.alignments = dict()
 
     def to_dict(self):
-        return {'divisible_by_16': list(self.divisible_by_16), 'equal_to_1': list(self.equal_to_1)}
+        return {
+            'divisible_by_16': list(self.divisible_by_16),
+            'equal_to_1': list(self.equal_to_1),
+            'value_ranges': [[k, list(v)] for k, v in self.value_ranges.items()],
+            'alignments': [[k, v] for k, v in self.alignments.items()],
+        }
 
     @staticmethod
     def from_dict(data):
         return AttrsDescriptor(divisible_by_16=set(data.get('divisible_by_16', [])),
-                               equal_to_1=set(data.get('equal_to_1', [])))
+                               equal_to_1=set(data.get('equal_to_1', [])),
+                               value_ranges={k: tuple(v)
+                                             for k, v in data.get('value_ranges', [])},
+                               alignments={k: v
+                                           for k, v in data.get('alignments', [])})
 
     def hash(self):
-        key = str([sorted(x) for x in self.__dict__.values()])
+        key = str([sorted(self.divisible_by_16), sorted(self.equal_to_1)])
+        if self.value_ranges:
+            key += str(sorted(self.value_ranges.items()))
+        if self.alignments:
+            key += str(sorted(self.alignments.items()))
         return hashlib.sha256(key.encode("utf-8")).hexdigest()
 
 
@@ -237,8 +263,7 @@ def compile(src, target=None, options=None):
     options = backend.parse_options(dict(options or dict(), **extra_options))
     # create cache manager
     env_vars = get_cache_invalidating_env_vars()
-    key = f"{triton_key()}-{src.hash()}-{backend.hash()}-{options.hash()}-{str(sorted(env_vars.items()))}"
-    hash = hashlib.sha256(key.encode("utf-8")).hexdigest()
+    hash = _get_hash(src, backend, options, env_vars)
     fn_cache_manager = get_cache_manager(hash)
     # For dumping/overriding only hash the source as we want it to be independent of triton
     # core changes to make it easier to track kernels by hash.
@@ -274,19 +299,48 @@ def compile(src, target=None, options=None):
     if ir_source:
         first_stage += 1
     context = ir.context()
+    if getattr(_compile_worker, "active", False):
+        context.disable_multithreading()
     ir.load_dialects(context)
     backend.load_dialects(context)
     codegen_fns = backend.get_codegen_implementation()
+    generic_src = None if ir_source else _get_generic_source(src)
     try:
-        module = src.make_ir(options, codegen_fns, context)
+        if generic_src is not None:
+            module = _make_generic_ttir(generic_src, backend, options, env_vars, stages, metadata, context,
+                                        codegen_fns)
+        else:
+            module = src.make_ir(options, codegen_fns, context)
     except Exception as e:
         filter_traceback(e)
         raise
     use_ttgir_loc = os.environ.get("USE_TTGIR_LOC", "0") == "1"
+    cache_ir = os.environ.get("TRITON_CACHE_IR", "all")
+    if cache_ir not in ["all", "gzip", "none"]:
+        raise ValueError(f"TRITON_CACHE_IR must be all, gzip or none, got {cache_ir}")
+
+    def put_ir(module, ext):
+        # Stores the IR of a stage in the cache as configured by `TRITON_CACHE_IR`.  The binary, which launches
+        # need, and the TTGIR USE_TTGIR_LOC reparses are always stored as is.
+        ir_filename = f"{file_name}.{ext}"
+        if cache_ir == "all" or ext == backend.binary_ext or (use_ttgir_loc and ext == "ttgir"):
+            metadata_group[ir_filename] = fn_cache_manager.put(module, ir_filename)
+        elif cache_ir == "gzip":
+            metadata_group[f"{ir_filename}.gz"] = fn_cache_manager.put(gzip.compress(str(module).encode("utf-8")),
+                                                                       f"{ir_filename}.gz")
+
+    if generic_src is not None:
+        _specialize_ttir(module, src, generic_src)
+        put_ir(module, "ttir")
+        first_stage += 1
+    # drop the statistics of the passes run by this thread outside of compile
+    ir.take_pass_stats()
+    pass_stats = []
     for ext, compile_ir in list(stages.items())[first_stage:]:
         next_module = compile_ir(module, metadata)
+        pass_stats += [dict(stats, stage=ext) for stats in ir.take_pass_stats()]
         ir_filename = f"{file_name}.{ext}"
-        metadata_group[ir_filename] = fn_cache_manager.put(next_module, ir_filename)
+        put_ir(next_module, ext)
         if fn_dump_manager is not None:
             fn_dump_manager.put(next_module, ir_filename)
         if (fn_override_manager is not None and fn_override_manager.has_file(ir_filename)):
@@ -299,6 +353,9 @@ def compile(src, target=None, options=None):
             next_module.create_location_snapshot(ttgir_full_name)
             print(f"Create new locations for {ttgir_full_name}")
         module = next_module
+    metadata["pass_stats"] = pass_stats
+    if os.environ.get("TRITON_PRINT_PASS_STATS", "0") == "1":
+        _add_pass_stats(pass_stats)
     # write-back metadata
     metadata_group[metadata_filename] = fn_cache_manager.put(json.dumps(metadata, default=vars), metadata_filename,
                                                              binary=False)
@@ -307,6 +364,160 @@ def compile(src, target=None, options=None):
     return CompiledKernel(src, metadata_group, hash)
 
 
+def _get_hash(src, backend, options, env_vars):
+    key = f"{triton_key()}-{src.hash()}-{backend.hash()}-{options.hash()}-{str(sorted(env_vars.items()))}"
+    return hashlib.sha256(key.encode("utf-8")).hexdigest()
+
+
+def _get_generic_source(src):
+    """
+    With `TRITON_LATE_SPECIALIZATION=1`, returns the source of the variant of `src` without divisibility and
+    equal-to-1 specializations, whose TTIR is shared by all the specializations of `src` and specialized right before
+    `make_ttgir`.  Returns None when `src` is compiled from the AST as is.
+    """
+    if os.environ.get("TRITON_LATE_SPECIALIZATION", "0") != "1":
+        return None
+    attrs = src.attrs
+    if not attrs.divisible_by_16 and not attrs.equal_to_1:
+        return None
+    # The value ranges are used by the TTIR passes, so they are only applied from the AST.
+    if attrs.value_ranges:
+        return None
+    fn = src.fn
+    arg_index = lambda k: fn.arg_names.index(k) if isinstance(k, str) else k
+    # The equal-to-1 arguments are folded and removed from the kernel, which `ast_to_ttir` only does for those that
+    # are also constants, as `JITFunction` passes them.
+    if not attrs.equal_to_1 <= {arg_index(k) for k in src.constants}:
+        return None
+    constants = {k: v for k, v in src.constants.items() if arg_index(k) not in attrs.equal_to_1}
+    generic_src = ASTSource(fn, src.signature, constants, AttrsDescriptor())
+    if fn.repr(generic_src) != fn.repr(src):
+        return None
+    return generic_src
+
+
+def _make_generic_ttir(generic_src, backend, options, env_vars, stages, metadata, context, codegen_fns):
+    # The TTIR is read from and written to the cache directory of the generic variant of the kernel, where
+    # compiling that variant also puts it, so it is shared across processes.
+    fn_cache_manager = get_cache_manager(_get_hash(generic_src, backend, options, env_vars))
+    ir_filename = f"{generic_src.name[:150]}.ttir"
+    path = fn_cache_manager.get_file(ir_filename)
+    if path is not None:
+        return parse(path, "ttir", context)
+    module = stages["ttir"](generic_src.make_ir(options, codegen_fns, context), metadata)
+    fn_cache_manager.put(module, ir_filename)
+    return module
+
+
+def _specialize_ttir(module, src, generic_src):
+    # Applies the divisibility and equal-to-1 specializations of `src` to the arguments of the kernel of the TTIR of
+    # `generic_src`, the same way `ast_to_ttir` does.
+    fn = src.fn
+    arg_index = lambda k: fn.arg_names.index(k) if isinstance(k, str) else k
+    generic_constants = {arg_index(k) for k in generic_src.constants}
+    kernel_args = [i for i in map(arg_index, src.signature) if i not in generic_constants]
+    kernel = module.get_function(fn.repr(generic_src))
+    for i in src.attrs.divisible_by_16:
+        if i in kernel_args:
+            kernel.set_arg_attr(kernel_args.index(i), "tt.divisibility", src.attrs.alignments.get(i, 16))
+    equal_to_1 = sorted((kernel_args.index(i) for i in src.attrs.equal_to_1), reverse=True)
+    for arg_no in equal_to_1:
+        kernel.fold_arg_to_constant(arg_no, 1)
+    if equal_to_1:
+        pm = ir.pass_manager(module.context)
+        passes.common.add_sccp(pm)
+        passes.common.add_canonicalizer(pm)
+        passes.common.add_cse(pm)
+        pm.run(module)
+
+
+# The statistics of each (stage, pass) over the kernels compiled by the process, reported at exit
+_pass_stats_totals = {}
+_pass_stats_lock = threading.Lock()
+_num_kernels_with_pass_stats = 0
+
+
+def _add_pass_stats(pass_stats):
+    global _num_kernels_with_pass_stats
+    with _pass_stats_lock:
+        if _num_kernels_with_pass_stats == 0:
+            atexit.register(_print_pass_stats)
+        _num_kernels_with_pass_stats += 1
+        for stats in pass_stats:
+            total = _pass_stats_totals.setdefault((stats["stage"], stats["pass"]),
+                                                  {"runs": 0, "time": 0.0, "ops_before": 0, "ops_after": 0})
+            total["runs"] += 1
+            for key in ("time", "ops_before", "ops_after"):
+                total[key] += stats[key]
+
+
+def _print_pass_stats():
+    totals = sorted(_pass_stats_totals.items(), key=lambda item: item[1]["time"], reverse=True)
+    total_time = sum(total["time"] for _, total in totals) or 1.0
+    lines = [
+        f"Pass statistics of {_num_kernels_with_pass_stats} compiled kernels:",
+        f"{'time (s)':>10} {'%':>6} {'runs':>6} {'ops before':>12} {'ops after':>12}  pass",
+    ]
+    for (stage, name), total in totals:
+        lines.append(f"{total['time']:>10.4f} {100 * total['time'] / total_time:>6.2f} {total['runs']:>6} "
+                     f"{total['ops_before']:>12} {total['ops_after']:>12}  {stage}: {name}")
+    print("\n".join(lines), file=sys.stderr)
+
+
+_compile_worker = threading.local()
+_compile_pool = None
+_compile_pool_lock = threading.Lock()
+
+
+def _get_compile_pool():
+    global _compile_pool
+    with _compile_pool_lock:
+        if _compile_pool is None:
+            max_workers = int(os.environ.get("TRITON_COMPILE_THREADS", "0")) or os.cpu_count() or 1
+
+            def init_worker():
+                _compile_worker.active = True
+
+            _compile_pool = ThreadPoolExecutor(max_workers=max_workers, thread_name_prefix="triton-compile",
+                                               initializer=init_worker)
+        return _compile_pool
+
+
+def _reset_compile_pool():
+    # The worker threads don't survive a fork.
+    global _compile_pool, _compile_pool_lock
+    _compile_pool = None
+    _compile_pool_lock = threading.Lock()
+
+
+os.register_at_fork(after_in_child=_reset_compile_pool)
+
+
+def compile_many(srcs, target=None, options=None):
+    """
+    Compiles a batch of kernels concurrently and returns their `CompiledKernel`s, in the order of `srcs`.
+
+    Each kernel is compiled by `compile` in its own MLIR context on a thread pool shared by all calls and
+    sized by `TRITON_COMPILE_THREADS` (the number of CPUs by default).  The MLIR and LLVM pipelines run
+    without the GIL, and so do the assembler subprocesses, so the stages of different kernels overlap.
+    `options` is either one dict for all kernels or a list with one dict per kernel.  The first exception
+    raised by a compilation is re-raised once all of them completed.
+    """
+    srcs = list(srcs)
+    if target is None:
+        target = driver.active.get_current_target()
+    if options is None or isinstance(options, dict):
+        options = [options] * len(srcs)
+    assert len(options) == len(srcs), "expected one options dict per source"
+    pool = _get_compile_pool()
+    futures = [pool.submit(compile, src, target, opts) for src, opts in zip(srcs, options)]
+    errors = [f.exception() for f in futures]
+    for e in errors:
+        if e is not None:
+            raise e
+    return [f.result() for f in futures]
+
+
 def make_backend(target):
     actives = [x.compiler for x in backends.values() if x.compiler.supports_target(target)]
     if len(actives) != 1:
@@ -335,13 +546,46 @@ class CompiledKernel:
 
     # Hooks for external tools to monitor the execution of triton kernels
     # TODO: move out of this namespace since it's a runtime thing
+    # Either Python functions called with the `LazyDict` of the launch metadata, or native hooks: the addresses (ints)
+    # of C functions `void hook(uint64_t function)`, called with the handle of the kernel while holding the GIL.
     launch_enter_hook = None
     launch_exit_hook = None
+    # With native hooks, called with each kernel before its first launch (e.g., to record its name)
+    launch_register_hook = None
+    # With native hooks, called with the launch metadata of the kernels defining `launch_metadata` before each of
+    # their launches
+    launch_metadata_hook = None
+    # The handles of the loaded binaries by kernel hash and device, shared by the kernels of the same hash, e.g.
+    # the kernels of a JIT function compiled again or loaded from the cache on the same device
+    _loaded_handles = {}
 
     def __init__(self, src, metadata_group, hash):
-        from collections import namedtuple
         metadata_path = next((Path(p) for c, p in metadata_group.items() if c.endswith(".json")))
         metadata = json.loads(metadata_path.read_text())
+        # stores the text of each level of IR that was generated during compilation
+        asm_files = [Path(p) for c, p in metadata_group.items() if not c.endswith(".json")]
+        asm = {}
+        for file in asm_files:
+            if file.suffix == ".gz":
+                # IR compressed with TRITON_CACHE_IR=gzip
+                asm[Path(file.stem).suffix[1:]] = gzip.decompress(file.read_bytes())
+            else:
+                asm[file.suffix[1:]] = file.read_bytes()
+        self._init(src, metadata, asm, hash)
+
+    @classmethod
+    def from_metadata(cls, src, metadata, asm, hash):
+        """
+        Returns the kernel of the JSON `metadata` and the IRs `asm` of a compilation, as bytes by extension.  The
+        binary may be any read-only bytes-like object, e.g. a memoryview of a mapped kernel archive.
+        """
+        kernel = cls.__new__(cls)
+        kernel._init(src, metadata, asm, hash)
+        return kernel
+
+    def _init(self, src, metadata, asm, hash):
+        from collections import namedtuple
+        metadata = dict(metadata)
         metadata['cluster_dims'] = tuple(metadata['cluster_dims'])
         # JSON serialization dumps the target as a dict. Restore it to a GPUTarget.
         target = metadata['target']
@@ -353,33 +597,110 @@ class CompiledKernel:
         self.src = src
         self.hash = hash
         self.name = self.metadata.name
-        # stores the text of each level of IR that was generated during compilation
-        asm_files = [Path(p) for c, p in metadata_group.items() if not c.endswith(".json")]
         binary_ext = backend.binary_ext
-        self.asm = {
-            file.suffix[1:]: file.read_bytes() if file.suffix[1:] == binary_ext else file.read_text()
-            for file in asm_files
-        }
+        # the binary stays as is, and the IRs are kept as text
+        self.asm = {ext: data if ext == binary_ext else bytes(data).decode("utf-8") for ext, data in asm.items()}
         self.kernel = self.asm[binary_ext]
         # binaries are lazily initialized
         # because it involves doing runtime things
         # (e.g., checking amount of shared memory on current device)
         self.module = None
         self.function = None
+        # The handles of the binary on each device it was launched on
+        self._handles = {}
+        # The native launch hook this kernel was registered with
+        self.registered_launch_hook = None
 
     def _init_handles(self):
         if self.module is not None:
             return
-        device = driver.active.get_current_device()
         # create launcher
         self.run = driver.active.launcher_cls(self.src, self.metadata)
-        # not enough shared memory to run the kernel
-        max_shared = driver.active.utils.get_device_properties(device)["max_shared_mem"]
-        if self.metadata.shared > max_shared:
-            raise OutOfResources(self.metadata.shared, max_shared, "shared memory")
-        # TODO: n_regs, n_spills should be metadata generated when calling `ptxas`
-        self.module, self.function, self.n_regs, self.n_spills = driver.active.utils.load_binary(
-            self.name, self.kernel, self.metadata.shared, device)
+        self.module, self.function, self.n_regs, self.n_spills = self._get_handles(driver.active.get_current_device())
+
+    def _get_handles(self, device):
+        # Returns the (module, function, n_regs, n_spills) of the binary on `device`, which is loaded on the first
+        # launch on the device.
+        handles = self._handles.get(device)
+        if handles is not None:
+            return handles
+        key = (self.hash, device)
+        handles = CompiledKernel._loaded_handles.get(key)
+        if handles is None:
+            # not enough shared memory to run the kernel
+            max_shared = driver.active.utils.get_device_properties(device)["max_shared_mem"]
+            if self.metadata.shared > max_shared:
+                raise OutOfResources(self.metadata.shared, max_shared, "shared memory")
+            # TODO: n_regs, n_spills should be metadata generated when calling `ptxas`
+            handles = driver.active.utils.load_binary(self.name, self.kernel, self.metadata.shared, device)
+            CompiledKernel._loaded_handles[key] = handles
+        self._handles[device] = handles
+        return handles
+
+    def max_cooperative_programs(self, device=None):
+        """
+        Returns the number of programs of the kernel that can run at once on `device`, by default the current
+        device, i.e. the largest grid of its cooperative launches (see the `launch_cooperative` option).
+        """
+        if device is None:
+            device = driver.active.get_current_device()
+        function = self._get_handles(device)[1]
+        utils = driver.active.utils
+        num_threads = self.metadata.num_warps * self.metadata.num_ctas * 32
+        blocks_per_sm = utils.max_active_blocks(function, num_threads, self.metadata.shared)
+        return blocks_per_sm * utils.get_device_properties(device)["multiprocessor_count"]
+
+    def resource_report(self, device=None):
+        """
+        Returns the resource usage of the kernel and its theoretical occupancy on `device`, by default the current
+        device, as a dict of:
+
+        - `registers`: the registers per thread
+        - `spill_stores`, `spill_loads`: the bytes of the spills per thread reported by the assembler, if known
+        - `local_memory`: the bytes of local memory per thread
+        - `shared`: the bytes of shared memory per program
+        - `num_warps`: the warps per program
+
+        and, if the backend reports the limits of the multiprocessors:
+
+        - `programs_per_sm`: the programs that can run at once on a multiprocessor
+        - `occupancy`: the fraction of the threads of a multiprocessor they run
+        - `limiter`: the resource that limits `programs_per_sm`: "warps", "registers", "shared" or "programs"
+        """
+        if device is None:
+            device = driver.active.get_current_device()
+        function, n_regs, n_spills = self._get_handles(device)[1:]
+        metadata = self.metadata
+        report = {
+            "registers": n_regs,
+            "spill_stores": getattr(metadata, "spill_stores", None),
+            "spill_loads": getattr(metadata, "spill_loads", None),
+            "local_memory": n_spills * 4,
+            "shared": metadata.shared,
+            "num_warps": metadata.num_warps,
+        }
+        utils = driver.active.utils
+        props = utils.get_device_properties(device)
+        if "max_threads_per_sm" not in props:
+            return report
+        num_threads = metadata.num_warps * props["warpSize"]
+        limits = {"warps": props["max_threads_per_sm"] // num_threads}
+        if n_regs > 0:
+            # The registers are allocated to warps by units of 256.
+            regs_per_warp = (n_regs * props["warpSize"] + 255) // 256 * 256
+            limits["registers"] = props["max_regs_per_sm"] // regs_per_warp // metadata.num_warps
+        if metadata.shared > 0:
+            limits["shared"] = props["max_shared_mem_per_sm"] // (metadata.shared + props["reserved_shared_mem"])
+        limits["programs"] = props["max_blocks_per_sm"]
+        limiter = min(limits, key=limits.get)
+        programs_per_sm = limits[limiter]
+        if hasattr(utils, "max_active_blocks"):
+            # The driver also accounts for the shared memory carveout.
+            programs_per_sm = utils.max_active_blocks(function, num_threads, metadata.shared)
+        report["programs_per_sm"] = programs_per_sm
+        report["occupancy"] = programs_per_sm * num_threads / props["max_threads_per_sm"]
+        report["limiter"] = limiter
+        return report
 
     def __getattribute__(self, name):
         if name == 'run':
@@ -387,11 +708,17 @@ class CompiledKernel:
         return super().__getattribute__(name)
 
     def launch_metadata(self, grid, stream, *args):
-        if CompiledKernel.launch_enter_hook is None:
+        hook = CompiledKernel.launch_enter_hook
+        if hook is None:
             return None
+        native = isinstance(hook, int)
+        if native and self.registered_launch_hook != hook:
+            self._init_handles()
+            CompiledKernel.launch_register_hook(self)
+            self.registered_launch_hook = hook
         ret = LazyDict({"name": self.name, "function": self.function, "stream": stream})
         if not isinstance(self.src, ASTSource) or self.src.fn.launch_metadata is None:
-            return ret
+            return None if native else ret
         arg_dict = {}
         arg_idx = 0
         for i, arg_name in enumerate(self.src.fn.arg_names):
@@ -401,17 +728,22 @@ class CompiledKernel:
                 arg_dict[arg_name] = args[arg_idx]
                 arg_idx += 1
         ret.add(self.src.fn.launch_metadata, (grid, self.metadata, arg_dict))
+        if native:
+            CompiledKernel.launch_metadata_hook(ret)
+            return None
         return ret
 
     def __getitem__(self, grid):
         self._init_handles()
 
         def runner(*args, stream=None):
+            device = driver.active.get_current_device()
             if stream is None:
-                device = driver.active.get_current_device()
                 stream = driver.active.get_current_stream(device)
+            # the kernel may be launched on several devices
+            function = self._get_handles(device)[1]
             launch_metadata = self.launch_metadata(grid, stream, *args)
-            self.run(grid[0], grid[1], grid[2], stream, self.function, self.packed_metadata, launch_metadata,
+            self.run(grid[0], grid[1], grid[2], stream, function, self.packed_metadata, launch_metadata,
                      CompiledKernel.launch_enter_hook, CompiledKernel.launch_exit_hook, *args)
 
         return runner
@@ -9,16 +9,27 @@ from .standard import (
     cdiv,
     cumprod,
     cumsum,
+    device_cumsum,
+    device_scan_tile_id,
+    dynamic_tile_id,
     flip,
+    grid_barrier,
     interleave,
     max,
     min,
+    online_softmax,
     ravel,
+    remote_ptr,
+    requantize,
     sigmoid,
+    signal,
+    signal_wait_until,
     softmax,
     sort,
+    split_k_reduce,
     sum,
     swizzle2d,
+    topk,
     xor_sum,
     zeros,
     zeros_like,
@@ -26,7 +37,12 @@ from .standard import (
 from .core import (
     PropagateNan,
     TRITON_MAX_TENSOR_NUMEL,
+    _experimental_descriptor_atomic_add,
+    _experimental_descriptor_atomic_max,
+    _experimental_descriptor_atomic_min,
     _experimental_descriptor_load,
+    _experimental_descriptor_load_im2col,
+    _experimental_descriptor_prefetch,
     _experimental_descriptor_store,
     advance,
     arange,
@@ -53,6 +69,7 @@ from .core import (
     device_assert,
     device_print,
     dot,
+    dot_scaled,
     dtype,
     expand_dims,
     float16,
@@ -65,12 +82,15 @@ from .core import (
     float8e5b16,
     full,
     function_type,
+    gather,
+    global_scratch,
     histogram,
     inline_asm_elementwise,
     int1,
     int16,
     int32,
     int64,
+    int4,
     int8,
     join,
     load,
@@ -82,12 +102,18 @@ from .core import (
     multiple_of,
     num_programs,
     permute,
+    persistent_range,
+    pipeline_stage,
     pi32_t,
     pointer_type,
+    prefetch,
+    profile_region,
     program_id,
     range,
     reduce,
     reshape,
+    restrict,
+    sparse_dot,
     split,
     static_assert,
     static_print,
@@ -98,6 +124,7 @@ from .core import (
     uint16,
     uint32,
     uint64,
+    uint4,
     uint8,
     view,
     void,
@@ -106,11 +133,14 @@ from .core import (
 from .math import (umulhi, exp, exp2, fma, log, log2, cos, rsqrt, sin, sqrt, sqrt_rn, abs, fdiv, div_rn, erf, floor,
                    ceil)
 from .random import (
+    dropout,
+    dropout_mask,
     pair_uniform_to_normal,
     philox,
     philox_impl,
     rand,
     rand4x,
+    randbits,
     randint,
     randint4x,
     randn,
@@ -121,7 +151,12 @@ from .random import (
 __all__ = [
     "PropagateNan",
     "TRITON_MAX_TENSOR_NUMEL",
+    "_experimental_descriptor_atomic_add",
+    "_experimental_descriptor_atomic_max",
+    "_experimental_descriptor_atomic_min",
     "_experimental_descriptor_load",
+    "_experimental_descriptor_load_im2col",
+    "_experimental_descriptor_prefetch",
     "_experimental_descriptor_store",
     "abs",
     "advance",
@@ -155,10 +190,16 @@ __all__ = [
     "cumsum",
     "debug_barrier",
     "device_assert",
+    "device_cumsum",
     "device_print",
+    "device_scan_tile_id",
     "div_rn",
     "dot",
+    "dot_scaled",
+    "dropout",
+    "dropout_mask",
     "dtype",
+    "dynamic_tile_id",
     "erf",
     "exp",
     "exp2",
@@ -178,6 +219,9 @@ __all__ = [
     "fma",
     "full",
     "function_type",
+    "gather",
+    "global_scratch",
+    "grid_barrier",
     "histogram",
     "inline_asm_elementwise",
     "interleave",
@@ -185,6 +229,7 @@ __all__ = [
     "int16",
     "int32",
     "int64",
+    "int4",
     "int8",
     "ir",
     "join",
@@ -201,15 +246,21 @@ __all__ = [
     "minimum",
     "multiple_of",
     "num_programs",
+    "online_softmax",
     "pair_uniform_to_normal",
     "permute",
+    "persistent_range",
+    "pipeline_stage",
     "philox",
     "philox_impl",
     "pi32_t",
     "pointer_type",
+    "prefetch",
+    "profile_region",
     "program_id",
     "rand",
     "rand4x",
+    "randbits",
     "randint",
     "randint4x",
     "randn",
@@ -217,13 +268,20 @@ __all__ = [
     "range",
     "ravel",
     "reduce",
+    "remote_ptr",
+    "requantize",
     "reshape",
+    "restrict",
     "rsqrt",
     "sigmoid",
+    "signal",
+    "signal_wait_until",
     "sin",
     "softmax",
     "sort",
+    "sparse_dot",
     "split",
+    "split_k_reduce",
     "sqrt",
     "sqrt_rn",
     "static_assert",
@@ -233,11 +291,13 @@ __all__ = [
     "sum",
     "swizzle2d",
     "tensor",
+    "topk",
     "trans",
     "triton",
     "uint16",
     "uint32",
     "uint64",
+    "uint4",
     "uint8",
     "uint_to_uniform_float",
     "umulhi",
@@ -163,6 +163,20 @@ class const:
     is part of the pointer type and the usual Triton type consistency rules
     apply. For example you cannot have a function that returns constant pointer
     in one return statement and non-constant pointer in another.
+
+    The data pointed to by a kernel argument marked const must not be modified
+    while the kernel runs, through any pointer, which lets loads from it go
+    through the read-only data cache.
+    """
+    pass
+
+
+class restrict:
+    """
+    This class is used as a type annotation to mark pointer kernel arguments whose data is only accessed through them
+    while the kernel runs, as with the `restrict` qualifier of C: the data doesn't overlap the data of the other
+    pointer arguments.  It lets the compiler reorder the loads of the data of an argument around the stores to the
+    others.
     """
     pass
 
@@ -322,8 +336,8 @@ def check_bit_width(value, shift_value):
 
 
 class dtype:
-    SINT_TYPES = ['int8', 'int16', 'int32', 'int64']
-    UINT_TYPES = ['int1', 'uint8', 'uint16', 'uint32', 'uint64']
+    SINT_TYPES = ['int4', 'int8', 'int16', 'int32', 'int64']
+    UINT_TYPES = ['int1', 'uint4', 'uint8', 'uint16', 'uint32', 'uint64']
     FP_TYPES = ['fp8e4b15', 'fp8e4nv', 'fp8e4b8', 'fp8e5', 'fp8e5b16', 'fp16', 'bf16', 'fp32', 'fp64']
     STANDARD_FP_TYPES = ['fp16', 'bf16', 'fp32', 'fp64']
     OTHER_TYPES = ['void']
@@ -419,6 +433,9 @@ class dtype:
     def is_int1(self):
         return self.name == 'int1'
 
+    def is_int4(self):
+        return self.name == 'int4'
+
     def is_int8(self):
         return self.name == 'int8'
 
@@ -431,6 +448,9 @@ class dtype:
     def is_int64(self):
         return self.name == 'int64'
 
+    def is_uint4(self):
+        return self.name == 'uint4'
+
     def is_uint8(self):
         return self.name == 'uint8'
 
@@ -501,6 +521,8 @@ class dtype:
             return builder.get_void_ty()
         elif self.name == 'int1':
             return builder.get_int1_ty()
+        elif self.name in ('int4', 'uint4'):
+            return builder.get_int4_ty()
         elif self.name in ('int8', 'uint8'):
             return builder.get_int8_ty()
         elif self.name in ('int16', 'uint16'):
@@ -678,10 +700,13 @@ class function_type(dtype):
 # scalar types
 void = dtype('void')
 int1 = dtype('int1')
+# 4-bit integers only exist in registers: they are stored packed by pairs in 8-bit integers.
+int4 = dtype('int4')
 int8 = dtype('int8')
 int16 = dtype('int16')
 int32 = dtype('int32')
 int64 = dtype('int64')
+uint4 = dtype('uint4')
 uint8 = dtype('uint8')
 uint16 = dtype('uint16')
 uint32 = dtype('uint32')
@@ -1091,10 +1116,13 @@ class tensor:
     def reduce(self, axis, combine_fn, keep_dims=False) -> tensor:
         ...
 
-    def associative_scan(self, axis, combine_fn, reverse=False) -> tensor:
+    def associative_scan(self, axis, combine_fn, reverse=False, flags=None) -> tensor:
         ...
 
-    def histogram(self, num_bins) -> tensor:
+    def histogram(self, num_bins, mask=None, weights=None) -> tensor:
+        ...
+
+    def gather(self, indices, axis) -> tensor:
         ...
 
     def cdiv(self, div) -> tensor:
@@ -1136,6 +1164,9 @@ class tensor:
     def sort(self, dim: constexpr = None, descending: constexpr = CONSTEXPR_0) -> tensor:
         ...
 
+    def topk(self, k: constexpr, dim: constexpr = None) -> tensor:
+        ...
+
     def flip(self, dim=None) -> tensor:
         ...
 
@@ -1185,6 +1216,27 @@ def num_programs(axis, _builder=None):
     return semantic.num_programs(axis, _builder)
 
 
+@builtin
+def global_scratch(size, dtype, alignment=16, _builder=None):
+    """
+    Returns a pointer to a workspace of :code:`size` elements of type :code:`dtype` in global memory, which the
+    launcher allocates and zeroes for each launch, and which is shared by all the program instances of the launch.
+    It holds, e.g., the partial results and the counters of split-K or cross-program reductions without the caller
+    allocating and passing a buffer.
+
+    :param size: The number of elements of the workspace.
+    :type size: int
+    :param dtype: The data type of the elements.
+    :type dtype: tl.dtype
+    :param alignment: The alignment of the workspace, in bytes. Must be a power of 2.
+    :type alignment: int
+    """
+    size = _constexpr_to_value(size)
+    dtype = _constexpr_to_value(dtype)
+    alignment = _constexpr_to_value(alignment)
+    return semantic.global_scratch(size, dtype, alignment, _builder)
+
+
 # -----------------------
 # Block Initialization
 # -----------------------
@@ -1344,7 +1396,8 @@ def cat(input, other, can_reorder=False, _builder=None):
     :param reorder: Compiler hint. If true, the compiler is
         allowed to reorder elements while concatenating inputs.  Only use if the
         order does not matter (e.g., result is only used in reduction ops).
-        Current implementation of `cat` supports only can_reorder=True.
+        With can_reorder=False, the inputs must have the same shape and are
+        concatenated along their first dimension, in order.
     """
     return semantic.cat(input, other, can_reorder, _builder)
 
@@ -1523,7 +1576,7 @@ def cast(input, dtype: dtype, fp_downcast_rounding: Optional[str] = None, bitcas
 
 @builtin
 def dot(input, other, acc=None, input_precision=None, allow_tf32=None, max_num_imprecise_acc=None, out_dtype=float32,
-        _builder=None):
+        k_extent=None, _builder=None):
     """
     Returns the matrix product of two blocks.
 
@@ -1541,10 +1594,18 @@ def dot(input, other, acc=None, input_precision=None, allow_tf32=None, max_num_i
       the device does not have Tensor Cores or the inputs are not of dtype f32,
       this option is ignored. For devices that do have tensor cores, the
       default precision is tf32.
-    :type input_precision: string. Available options for nvidia: :code:`"tf32"`, :code:`"tf32x3"`, :code:`"ieee"`. Default: :code:`"tf32"`. Avaliable options for amd: :code:`"ieee"`.
+    :type input_precision: string. Available options for nvidia: :code:`"tf32"`, :code:`"tf32x3"`, :code:`"ieee"`, :code:`"bf16x3"`, :code:`"bf16x6"`. Default: :code:`"tf32"`. Avaliable options for amd: :code:`"ieee"`, :code:`"bf16x3"`, :code:`"bf16x6"`.
+      From the fastest to the most precise: :code:`"tf32"` runs one tf32 dot, with about 11 bits of precision;
+      :code:`"bf16x3"` splits the inputs in two bf16 terms and runs 3 bf16 dots, with about 16 bits of precision;
+      :code:`"tf32x3"` runs 3 tf32 dots, with about 21 bits of precision; :code:`"bf16x6"` splits the inputs in three
+      bf16 terms and runs 6 bf16 dots, about as precise as :code:`"ieee"`, which doesn't use the Tensor Cores.
     :param allow_tf32: *Deprecated.* If true, input_precision is set to "tf32".
       Only one of :code:`input_precision` and :code:`allow_tf32` can be
       specified (i.e. at least one must be :code:`None`).
+    :param k_extent: The number of leading elements along the inner dimension that can be nonzero, beyond which
+      :code:`input` or :code:`other` is zero, e.g. a head dimension of 96 in blocks padded to 128 with masked loads.
+      The tensor cores then skip the padding.
+    :type k_extent: int, optional
     """
     assert input_precision is None or allow_tf32 is None, "Only one of input_precision and allow_tf32 can be specified"
     if input_precision is None:
@@ -1555,7 +1616,53 @@ def dot(input, other, acc=None, input_precision=None, allow_tf32=None, max_num_i
     input_precision = _constexpr_to_value(input_precision)
     out_dtype = _constexpr_to_value(out_dtype)
     max_num_imprecise_acc = _constexpr_to_value(max_num_imprecise_acc)
-    return semantic.dot(input, other, acc, input_precision, max_num_imprecise_acc, out_dtype, _builder)
+    k_extent = _constexpr_to_value(k_extent)
+    return semantic.dot(input, other, acc, input_precision, max_num_imprecise_acc, out_dtype, k_extent, _builder)
+
+
+@builtin
+def dot_scaled(lhs, lhs_scale, lhs_format, rhs, rhs_scale, rhs_format, acc=None, out_dtype=float32, _builder=None):
+    """
+    Returns the matrix product of two blocks in block-scaled microscaling formats, where each block of K elements of
+    a row of `lhs`, or of a column of `rhs`, is multiplied by its scale.
+
+    :param lhs: The first tensor to be multiplied, of shape [M, K], or [M, K // 2] for `e2m1`.
+    :type lhs: 2D tensor of :code:`float8e4nv` (e4m3), :code:`float8e5` (e5m2), :code:`uint8` packing two e2m1
+      elements along K, the first one in the low nibble, or :code:`bfloat16`.
+    :param lhs_scale: The scales of `lhs`, of shape [M, K // B], or None. :code:`uint8` scales are e8m0 exponents of
+      blocks of B = 32 elements (MX formats), :code:`float8e4nv` scales are e4m3 scales of blocks of B = 16 elements
+      (NVFP4).
+    :param lhs_format: The format of `lhs`, one of :code:`"e4m3"`, :code:`"e5m2"`, :code:`"e2m1"`, :code:`"bf16"`.
+    :param rhs: The second tensor to be multiplied, of shape [K, N], or [K // 2, N] for `e2m1`.
+    :param rhs_scale: The scales of `rhs`, of shape [N, K // B], or None.
+    :param rhs_format: The format of `rhs`.
+    :param acc: The float32 accumulator tensor. If not None, the result is added to this tensor.
+    """
+    lhs_format = _constexpr_to_value(lhs_format)
+    rhs_format = _constexpr_to_value(rhs_format)
+    out_dtype = _constexpr_to_value(out_dtype)
+    return semantic.dot_scaled(lhs, lhs_scale, lhs_format, rhs, rhs_scale, rhs_format, acc, out_dtype, _builder)
+
+
+@builtin
+def sparse_dot(a, a_meta, b, acc=None, _builder=None):
+    """
+    Returns the matrix product of a 2:4 structured sparse block, of which at most 2 of every 4 consecutive elements of
+    a row are non-zero, and of a dense block. The sparse block is given compressed, holding the 2 kept elements of
+    each group of 4, along with the positions of these elements in their groups.
+
+    :param a: The compressed sparse tensor, of shape [M, K // 2].
+    :type a: 2D tensor of :code:`float16` or :code:`bfloat16`
+    :param a_meta: The positions of the elements of `a`, of shape [M, K // 16]. Bits [2i, 2i + 1] of `a_meta[m, j]`
+      hold the position, in its group of 4, of the element `a[m, 8j + i]`, whose group is the dense elements
+      `16j + 4 * (i // 2)` to `16j + 4 * (i // 2) + 3` of row `m`. The positions of the two elements of a group must
+      be increasing.
+    :type a_meta: 2D tensor of :code:`int16`
+    :param b: The dense tensor, of shape [K, N], with K a multiple of 32.
+    :type b: 2D tensor of the dtype of `a`
+    :param acc: The float32 accumulator tensor. If not None, the result is added to this tensor.
+    """
+    return semantic.sparse_dot(a, a_meta, b, acc, _builder)
 
 
 # -----------------------
@@ -1604,7 +1711,9 @@ def load(pointer, mask=None, other=None, boundary_check=(), padding_option="", c
         cache at all levels and "cg" stands for cache at global level (cache in L2 and below, not L1), see
         `cache operator <https://docs.nvidia.com/cuda/parallel-thread-execution/index.html#cache-operators>`_ for more details.
     :param eviction_policy: changes eviction policy in NVIDIA PTX
-    :type eviction_policy: str, optional
+    :type eviction_policy: str, optional, should be one of {"", "evict_first", "evict_last", "no_allocate"}, where
+        "evict_first" and "evict_last" also set the L2 eviction priority of the data on sm_80+ and "no_allocate" does
+        not allocate the data in L1
     :param volatile: changes volatile option in NVIDIA PTX
     :type volatile: bool, optional
     """
@@ -1635,6 +1744,23 @@ def _experimental_descriptor_load(desc_pointer, offsets, shape, dtype, _builder=
     return semantic.descriptor_load(desc_pointer, offsets, "", "", type, _builder)
 
 
+@builtin
+def _experimental_descriptor_load_im2col(desc_pointer, offsets, im2col_offsets, shape, dtype, _builder=None):
+    """
+    Experimental feature to access TMA descriptors loads in im2col mode, for implicit-GEMM convolutions. This is an
+    escape hatch to easily exercise TTGIR operations. This will be removed in the future and shouldn't be used in
+    production code.
+
+    This loads a block of `shape[0]` pixels and `shape[1]` channels based on an im2col descriptor, e.g. created by
+    `create_im2col_tma_descriptor`.  `offsets` are the coordinates of the first pixel and channel in the tensor, from
+    the outermost dimension, e.g. `[n, h, w, c]` for an NHWC tensor, and `im2col_offsets` the offsets of the filter tap
+    in the spatial dimensions, e.g. `[r, s]`.  The pixels follow the innermost spatial dimension, then the outer ones,
+    within the bounding box of the descriptor.
+    """
+    type = block_type(dtype, shape)
+    return semantic.descriptor_load_im2col(desc_pointer, offsets, im2col_offsets, "", "", type, _builder)
+
+
 @builtin
 def _experimental_descriptor_store(desc_pointer, value, offsets, _builder=None):
     """
@@ -1646,6 +1772,53 @@ def _experimental_descriptor_store(desc_pointer, value, offsets, _builder=None):
     return semantic.descriptor_store(desc_pointer, value, offsets, _builder)
 
 
+@builtin
+def _experimental_descriptor_atomic_add(desc_pointer, value, offsets, _builder=None):
+    """
+    Experimental feature to reduce into global memory with TMA descriptors. This is an escape hatch to easily
+    exercise TTGIR operations.
+    This will be removed in the future and shouldn't be used in production code.
+
+    This atomically adds a tensor of data to the block of the descriptor at the offsets, with a single bulk
+    reduction rather than an atomic per element, e.g. to accumulate the partial results of split-K. The addition is
+    performed in the data type of the descriptor, which must be the one of `value`, e.g. created with
+    :code:`dtype=torch.float32`: the untyped descriptors of floats would sum their bits as integers.
+    The sum of the results of several programs depends on the order in which they arrive.
+    """
+    return semantic.descriptor_atomic("add", desc_pointer, value, offsets, _builder)
+
+
+@builtin
+def _experimental_descriptor_atomic_max(desc_pointer, value, offsets, _builder=None):
+    """
+    Experimental feature to reduce into global memory with TMA descriptors, like
+    :code:`_experimental_descriptor_atomic_add` but by maximum. Floats are only supported in 16 bits.
+    """
+    return semantic.descriptor_atomic("max", desc_pointer, value, offsets, _builder)
+
+
+@builtin
+def _experimental_descriptor_atomic_min(desc_pointer, value, offsets, _builder=None):
+    """
+    Experimental feature to reduce into global memory with TMA descriptors, like
+    :code:`_experimental_descriptor_atomic_add` but by minimum. Floats are only supported in 16 bits.
+    """
+    return semantic.descriptor_atomic("min", desc_pointer, value, offsets, _builder)
+
+
+@builtin
+def _experimental_descriptor_prefetch(desc_pointer, offsets, shape, dtype, _builder=None):
+    """
+    Experimental feature to prefetch with TMA descriptors into the L2 cache. This is an escape hatch to easily exercise
+    TTGIR operations.
+    This will be removed in the future and shouldn't be used in production code.
+
+    This prefetches the block of `shape` and `dtype` a load of the descriptor at `offsets` returns.
+    """
+    type = block_type(_constexpr_to_value(dtype), shape)
+    return semantic.descriptor_prefetch(desc_pointer, offsets, type, _builder)
+
+
 @_tensor_member_fn
 @builtin
 def store(pointer, value, mask=None, boundary_check=(), cache_modifier="", eviction_policy="", _builder=None):
@@ -1685,7 +1858,7 @@ def store(pointer, value, mask=None, boundary_check=(), cache_modifier="", evict
         cache write-back all coherent levels, ".cg" stands for cache global, ".cs" stands for cache streaming, ".wt"
         stands for cache write-through, see `cache operator <https://docs.nvidia.com/cuda/parallel-thread-execution/index.html#cache-operators>`_ for more details.
     :param eviction_policy: changes eviction policy in NVIDIA PTX
-    :type eviction_policy: str, optional, should be one of {"", "evict_first", "evict_last"}
+    :type eviction_policy: str, optional, should be one of {"", "evict_first", "evict_last", "no_allocate"}
     """
     # `value` can be constexpr
     value = _to_tensor(value, _builder)
@@ -1698,7 +1871,32 @@ def store(pointer, value, mask=None, boundary_check=(), cache_modifier="", evict
 
 
 @builtin
-def make_block_ptr(base: tensor, shape, strides, offsets, block_shape, order, _builder=None):
+def prefetch(pointer, mask=None, _builder=None):
+    """
+    Prefetch the memory locations defined by `pointer` into the L2 cache, without loading them into registers or
+    shared memory, e.g. to fetch the next page of a paged KV cache from DRAM while computing on the current one.
+    Prefetching is a hint, it doesn't change the values later loads return.
+
+    In a loop pipelined over `num_stages` stages, the prefetches are issued `num_stages - 1` iterations ahead, along
+    with the loads of the first stage.
+
+    Prefetches lower to :code:`prefetch.global.L2` on NVIDIA GPUs. On AMD GPUs, they lower to LLVM prefetches, which
+    targets without a prefetch instruction ignore.
+
+    :param pointer: The memory locations to prefetch
+    :type pointer: `triton.PointerType`, or block of `dtype=triton.PointerType`
+    :param mask: If `mask[idx]` is false, do not prefetch `pointer[idx]`
+    :type mask: Block of triton.int1, optional
+    """
+    mask = _constexpr_to_value(mask)
+    if mask is not None:
+        mask = _to_tensor(mask, _builder)
+    return semantic.prefetch(pointer, mask, _builder)
+
+
+@builtin
+def make_block_ptr(base: tensor, shape, strides, offsets, block_shape, order, page_table=None, page_size=None,
+                   _builder=None):
     """
     Returns a pointer to a block in a parent tensor
 
@@ -1708,8 +1906,13 @@ def make_block_ptr(base: tensor, shape, strides, offsets, block_shape, order, _b
     :param offsets: The offsets to the block
     :param block_shape: The shape of the block
     :param order: The order of the original data format
+    :param page_table: A pointer to the `int32` page indices of a parent tensor paged along its first dimension, like
+        a paged KV cache: the row `r` of the parent tensor is the row `r % page_size` of the page `page_table[r //
+        page_size]` of the memory at `base`, whose rows are `strides[0]` apart.
+    :param page_size: The number of rows of each page, a constant
     """
-    return semantic.make_block_ptr(base, shape, strides, offsets, block_shape, order, _builder)
+    page_size = _constexpr_to_value(page_size)
+    return semantic.make_block_ptr(base, shape, strides, offsets, block_shape, order, _builder, page_table, page_size)
 
 
 @_tensor_member_fn
@@ -2097,7 +2300,7 @@ def _add_scan_docstr(name: str) -> Callable[[T], T]:
 
 @_tensor_member_fn
 @builtin
-def associative_scan(input, axis, combine_fn, reverse=False, _builder=None, _generator=None):
+def associative_scan(input, axis, combine_fn, reverse=False, flags=None, _builder=None, _generator=None):
     """Applies the combine_fn to each elements with a carry in :code:`input` tensors along the provided :code:`axis` and update the carry
 
     :param input: the input tensor, or tuple of tensors
@@ -2108,10 +2311,14 @@ def associative_scan(input, axis, combine_fn, reverse=False, _builder=None, _gen
     :type combine_fn: Callable
     :param reverse: whether to apply the associative scan in the reverse direction along axis
     :type reverse: bool
+    :param flags: head flags of a segmented scan, which restarts at the elements whose flag is set, in the direction
+        of the scan. The flags are carried by the scan natively, so :code:`combine_fn` does not see them.
+    :type flags: Tensor, optional
 
     """
     if isinstance(input, tensor):
-        return associative_scan((input, ), axis, combine_fn, reverse, _builder=_builder, _generator=_generator)[0]
+        return associative_scan((input, ), axis, combine_fn, reverse, flags, _builder=_builder,
+                                _generator=_generator)[0]
 
     def make_combine_region(scan_op):
         in_scalar_tys = [t.type.scalar for t in input]
@@ -2132,22 +2339,60 @@ def associative_scan(input, axis, combine_fn, reverse=False, _builder=None, _gen
     axis = _constexpr_to_value(axis)
     if axis is not None:
         axis = _wrap_axis(axis, len(input[0].shape))
-    return semantic.associative_scan(input, axis, make_combine_region, reverse, _builder)
+    if flags is not None:
+        flags = _to_tensor(flags, _builder)
+    return semantic.associative_scan(input, axis, make_combine_region, reverse, _builder, flags)
 
 
 @_tensor_member_fn
 @builtin
-def histogram(input, num_bins, _builder=None, _generator=None):
+def histogram(input, num_bins, mask=None, weights=None, _builder=None, _generator=None):
     """computes an histogram based on input tensor with num_bins bins, the bins have a width of 1 and start at 0.
 
+    Large numbers of bins are counted with shared memory atomics, in which case inputs outside of
+    :code:`[0, num_bins)` are not counted.
+
     :param input: the input tensor
     :type input: Tensor
     :param num_bins: number of histogram bins
     :type num_bins: int
+    :param mask: if given, only the elements where it is true are counted
+    :type mask: Block of triton.int1, optional
+    :param weights: if given, the weight each element adds to its bin instead of 1. The histogram has the
+        dtype of the weights.
+    :type weights: Block of triton.int32 or triton.float32, optional
 
     """
     num_bins = _constexpr_to_value(num_bins)
-    return semantic.histogram(input, num_bins, _builder)
+    if mask is not None:
+        mask = _to_tensor(mask, _builder)
+    if weights is not None:
+        weights = _to_tensor(weights, _builder)
+    return semantic.histogram(input, num_bins, mask, weights, _builder)
+
+
+@_tensor_member_fn
+@builtin
+def gather(src, index, axis, _builder=None):
+    """Gather from a tensor along a given dimension.
+
+    Each element of the result is :code:`src` at the coordinates of the element
+    in :code:`index`, but for :code:`axis`, where it is the value of the
+    element of :code:`index`. The gather stays in registers, using warp shuffles
+    when the layouts let each warp gather from its own elements, and shared
+    memory otherwise.
+
+    :param src: the source tensor
+    :type src: Tensor
+    :param index: the index tensor, with the shape of :code:`src` but along :code:`axis`, and values in
+        :code:`[0, src.shape[axis])`
+    :type index: Tensor
+    :param axis: the dimension to gather along
+    :type axis: int
+
+    """
+    axis = _constexpr_to_value(axis)
+    return semantic.gather(src, index, axis, _builder)
 
 
 # -----------------------
@@ -2214,6 +2459,29 @@ def max_constancy(input, values, _builder=None):
     return semantic.max_constancy(input, values)
 
 
+@builtin
+def pipeline_stage(input, stage, _builder=None):
+    """
+    Pins the op producing :code:`input` to the stage :code:`stage` of the software pipeline of the loop it is in,
+    overriding the stage the pipeliner would assign it, e.g. to load V one stage later than K in attention:
+
+    .. highlight:: python
+    .. code-block:: python
+
+        for start_n in tl.range(0, N, BLOCK_N, num_stages=3):
+            k = tl.pipeline_stage(tl.load(K_ptrs), 0)
+            v = tl.pipeline_stage(tl.load(V_ptrs), 1)
+
+    Stages are numbered from 0, the earliest, to `num_stages - 1`, where the dots are by default.  A load is moved to
+    an earlier stage than its pin if it is used in the same or an earlier stage, and the pin is ignored if the loop is
+    not pipelined.
+    """
+    stage = _constexpr_to_value(stage)
+    if not isinstance(stage, int):
+        raise TypeError(f"stage must have type `constexpr[int]`, got `{type(stage)}`")
+    return semantic.pipeline_stage(input, stage, _builder)
+
+
 # -----------------------
 # Debugging functions
 # -----------------------
@@ -2339,6 +2607,39 @@ def device_assert(cond, msg="", _builder=None):
     return semantic.device_assert(_to_tensor(cond, _builder), msg, file_name, func_name, lineno, _builder)
 
 
+@builtin
+def profile_region(buffer, region, end=False, capacity=1024, _builder=None):
+    '''
+    Records the device timer of each warp at the start or the end of a region, to draw warp-level timelines of the
+    kernel, e.g., of the stages of a software-pipelined loop.
+
+    Each warp appends a record to its own ring buffer in `buffer`, from its first thread: `buffer` holds, for each
+    program and each warp, the number of records written followed by `capacity` records of two int64s, the
+    timestamp and `region * 2 + end`.  Programs are indexed in row-major order of their ids along
+    axes (2, 1, 0).  When a ring buffer is full, the oldest records are overwritten.
+    :code:`triton.profiler.RegionBuffer` allocates such buffers and decodes them.
+
+    Timestamps are read from :code:`%globaltimer` (nanoseconds) on NVIDIA GPUs and :code:`s_memtime`
+    (shader clock cycles) on AMD GPUs.
+
+    .. highlight:: python
+    .. code-block:: python
+
+        tl.profile_region(regions, 0)
+        acc = tl.dot(a, b, acc)
+        tl.profile_region(regions, 0, end=True)
+
+    :param buffer: a pointer to the int64 ring buffers of all the programs.
+    :param region: the id of the region, an integer literal.
+    :param end: whether the region ends, rather than starts.
+    :param capacity: the number of records of each ring buffer.
+    '''
+    region = _constexpr_to_value(region)
+    end = _constexpr_to_value(end)
+    capacity = _constexpr_to_value(capacity)
+    return semantic.profile_region(buffer, region, end, capacity, _builder)
+
+
 @builtin
 def inline_asm_elementwise(asm: str, constraints: str, args: Sequence, dtype: Union[dtype, Sequence[dtype]],
                            is_pure: bool, pack: int, _builder=None):
@@ -2538,9 +2839,17 @@ class range:
         kernel argument.  The kernel argument only pipelines loads that feed
         into :code:`dot` operations, while this attribute tries to pipeline most
         (though not all) loads in this loop.
+    :param unroll: unroll the loop by this factor before it is pipelined, with
+        a remainder loop running the iterations left over. Unlike
+        :code:`tl.static_range`, the trip count doesn't need to be known at
+        compile time.
+    :param interleave: interleave the operations of each group of this many
+        consecutive unrolled iterations, so that the independent operations
+        of the iterations, e.g. their loads, overlap. Must divide
+        :code:`unroll`.
     """
 
-    def __init__(self, arg1, arg2=None, step=None, num_stages=None):
+    def __init__(self, arg1, arg2=None, step=None, num_stages=None, unroll=None, interleave=None):
         if step is None:
             self.step = constexpr(1)
         else:
@@ -2552,6 +2861,12 @@ class range:
             self.start = arg1
             self.end = arg2
         self.num_stages = num_stages
+        self.unroll = _constexpr_to_value(unroll)
+        self.interleave = _constexpr_to_value(interleave)
+        if self.interleave is not None:
+            unroll = self.unroll or 1
+            if self.interleave < 1 or unroll % self.interleave != 0:
+                raise ValueError(f"interleave ({self.interleave}) must divide unroll ({unroll})")
 
     def __iter__(self):
         raise RuntimeError("tl.range can only be used in @triton.jit'd functions")
@@ -2560,6 +2875,43 @@ class range:
         raise RuntimeError("tl.range can only be used in @triton.jit'd functions")
 
 
+class persistent_range:
+    """
+    Iterator over the tiles handled by the current program of a persistent
+    kernel, i.e. :code:`range(program_id(0), num_tiles, num_programs(0))`.
+
+    .. highlight:: python
+    .. code-block:: python
+
+        @triton.jit
+        def kernel(..., NUM_SMS: tl.constexpr):
+            num_pid_m = tl.cdiv(M, BLOCK_M)
+            num_pid_n = tl.cdiv(N, BLOCK_N)
+            for tile_id in tl.persistent_range(num_pid_m * num_pid_n):
+                pid_m, pid_n = tl.swizzle2d(tile_id // num_pid_n, tile_id % num_pid_n,
+                                            num_pid_m, num_pid_n, GROUP_SIZE_M)
+                ...
+
+        kernel[(min(NUM_SMS, num_tiles), )](..., NUM_SMS=NUM_SMS)
+
+    :note: The kernel should be launched with a 1D grid of at most one program
+        per SM. As the tile loop is an ordinary loop, the pipeliner can overlap
+        the end of a tile with the start of the next one.
+    :param num_tiles: the total number of tiles.
+    :param num_stages: forwarded to the loop like :code:`tl.range`'s.
+    """
+
+    def __init__(self, num_tiles, num_stages=None):
+        self.num_tiles = num_tiles
+        self.num_stages = num_stages
+
+    def __iter__(self):
+        raise RuntimeError("tl.persistent_range can only be used in @triton.jit'd functions")
+
+    def __next__(self):
+        raise RuntimeError("tl.persistent_range can only be used in @triton.jit'd functions")
+
+
 # -----------------------
 # Extern functions
 # -----------------------
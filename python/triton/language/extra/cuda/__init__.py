@@ -1,8 +1,9 @@
 from . import libdevice
 
-from .utils import (globaltimer, num_threads, num_warps, smid, convert_custom_float8_sm70, convert_custom_float8_sm80)
+from .utils import (globaltimer, num_threads, num_warps, smid, gdc_wait, gdc_launch_dependents,
+                    convert_custom_float8_sm70, convert_custom_float8_sm80)
 
 __all__ = [
-    "libdevice", "globaltimer", "num_threads", "num_warps", "smid", "convert_custom_float8_sm70",
-    "convert_custom_float8_sm80"
+    "libdevice", "globaltimer", "num_threads", "num_warps", "smid", "gdc_wait", "gdc_launch_dependents",
+    "convert_custom_float8_sm70", "convert_custom_float8_sm80"
 ]
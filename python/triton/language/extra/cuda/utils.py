@@ -13,6 +13,27 @@ def smid(_builder=None):
                                        _builder=_builder)
 
 
+# ----- Programmatic dependent launch ------
+# Kernels launched with `launch_pdl=True` may start while the previous kernel in
+# the stream is still running.  Such a kernel must call `gdc_wait` before
+# touching memory written by the previous kernel, and may call
+# `gdc_launch_dependents` once it no longer needs to delay the next one, to let
+# its prologue overlap with this kernel's epilogue.  Both are no-ops for kernels
+# launched normally.  Requires sm_90.
+@core.extern
+def gdc_wait(_builder=None):
+    """Waits until the kernels this one depends on have completed and flushed their memory."""
+    core.inline_asm_elementwise("griddepcontrol.wait; // dummy $0", "=r", [], dtype=core.int32, is_pure=False, pack=1,
+                                _builder=_builder)
+
+
+@core.extern
+def gdc_launch_dependents(_builder=None):
+    """Lets the next kernel in the stream start once every program of this kernel has called this or exited."""
+    core.inline_asm_elementwise("griddepcontrol.launch_dependents; // dummy $0", "=r", [], dtype=core.int32,
+                                is_pure=False, pack=1, _builder=_builder)
+
+
 @core.builtin
 def num_threads(_builder=None):
     return core.constexpr(_builder.options.num_warps * 32)
@@ -102,7 +102,9 @@ def exp(x, _builder=None):
 
 
 @core.builtin
-@_check_dtype(dtypes=["fp32", "fp64"])
+# fp16 and bf16 run on the SFUs in 16 bits on the targets that support it, two
+# values at a time.
+@_check_dtype(dtypes=["fp16", "bf16", "fp32", "fp64"])
 @_add_math_1arg_docstr("exponential (base 2)")
 @core._tensor_member_fn
 def exp2(x, _builder=None):
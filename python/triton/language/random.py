@@ -205,3 +205,81 @@ def randn4x(seed, offset, n_rounds: tl.constexpr = N_ROUNDS_DEFAULT):
     n1, n2 = pair_uniform_to_normal(u1, u2)
     n3, n4 = pair_uniform_to_normal(u3, u4)
     return n1, n2, n3, n4
+
+
+# -------------------
+# randbits / dropout
+# -------------------
+
+
+@jit
+def randbits(seed, offset, n_rounds: tl.constexpr = N_ROUNDS_DEFAULT):
+    """
+    Given a :code:`seed` scalar and an :code:`offset` block, returns the four
+    random words of the Philox output of each offset, packed in a block of
+    shape :code:`offset.shape + (4, )` of unsigned integers of the width of
+    :code:`offset`, so that each Philox output provides 128 (or 256) random
+    bits instead of the single word `randint` keeps.
+
+    :param seed: The seed for generating random numbers.
+    :param offset: The offsets to generate random numbers for.
+    """
+    c0, c1, c2, c3 = randint4x(seed, offset, n_rounds)
+    # [..., i, j] is word 2 * i + j
+    return tl.reshape(tl.join(tl.join(c0, c2), tl.join(c1, c3)), offset.shape + (4, ))
+
+
+@jit
+def dropout_mask(seed, offset, p, n_rounds: tl.constexpr = N_ROUNDS_DEFAULT):
+    """
+    Given a :code:`seed` scalar and an :code:`offset` block, returns the
+    masks of the elements kept by a dropout of probability :code:`p`, as a
+    block of shape :code:`offset.shape + (16, )` for 32-bit offsets, or
+    :code:`offset.shape + (32, )` for 64-bit ones.
+
+    Each element compares a byte of the :code:`randbits` of its offset with
+    :code:`p` rounded to a multiple of 1/256, so that a Philox output provides
+    the masks of 16 or 32 elements.
+
+    :param seed: The seed for generating random numbers.
+    :param offset: The offsets to generate random numbers for, each for a
+        group of consecutive elements.
+    :param p: The probability to drop an element.
+
+    .. highlight:: python
+    .. code-block:: python
+
+        # the elements [start, start + BLOCK) of x, with start and BLOCK multiples of 16
+        offset = start // 16 + tl.arange(0, BLOCK // 16)
+        keep = tl.dropout_mask(seed, offset, p)
+        x = tl.reshape(tl.load(x_ptr + start + tl.arange(0, BLOCK)), (BLOCK // 16, 16))
+        y = tl.reshape(tl.where(keep, x / (1 - p), 0.0), (BLOCK, ))
+    """
+    p = tl.to_tensor(p)
+    bits = randbits(seed, offset, n_rounds)
+    n_bytes: tl.constexpr = bits.dtype.primitive_bitwidth // 8
+    shifts = (tl.arange(0, n_bytes) * 8).to(bits.dtype)
+    values = (tl.expand_dims(bits, len(bits.shape)) >> shifts) & 0xff
+    values = tl.reshape(values, offset.shape + (4 * n_bytes, ))
+    threshold = (p * 256.0 + 0.5).to(bits.dtype)
+    return values >= threshold
+
+
+@jit
+def dropout(x, p, seed, offset, n_rounds: tl.constexpr = N_ROUNDS_DEFAULT):
+    """
+    Returns :code:`x` with its elements dropped with probability :code:`p`,
+    along the masks of :code:`dropout_mask`, and the kept ones scaled to keep
+    the expectation of :code:`x`. :code:`x` has the shape of the masks.
+
+    :param x: The block to apply dropout to.
+    :param p: The probability to drop an element.
+    :param seed: The seed for generating random numbers.
+    :param offset: The offsets to generate random numbers for.
+    """
+    p = tl.to_tensor(p)
+    keep = dropout_mask(seed, offset, p, n_rounds)
+    # the probability `dropout_mask` rounds `p` to
+    threshold = (p * 256.0 + 0.5).to(tl.int32)
+    scale = 256.0 / (256 - threshold)
+    return tl.where(keep, x * scale, 0.0)
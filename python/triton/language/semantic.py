@@ -26,15 +26,51 @@ class IncompatibleTypeErrorImpl(Exception):
 def program_id(axis: int, builder: ir.builder) -> tl.tensor:
     if axis not in (0, 1, 2):
         raise ValueError(f"program_id axis must be 0, 1, or 2 but got {axis}")
-    return tl.tensor(builder.create_get_program_id(axis), tl.int32)
+    remap = getattr(builder, "program_id_remap", None)
+    if remap is None:
+        return tl.tensor(builder.create_get_program_id(axis), tl.int32)
+    # The function runs as the programs [start, start + prod(grid)) of a 1D
+    # grid, which are those of `grid` in row-major order, with axis 0 fastest.
+    start, grid = remap
+    if grid[axis] == 1:
+        return tl.tensor(builder.get_int32(0), tl.int32)
+    pid = builder.create_get_program_id(0)
+    if start != 0:
+        pid = builder.create_sub(pid, builder.get_int32(start))
+    stride = 1
+    for size in grid[:axis]:
+        stride *= size
+    if stride != 1:
+        pid = builder.create_sdiv(pid, builder.get_int32(stride))
+    if axis != 2:
+        pid = builder.create_srem(pid, builder.get_int32(grid[axis]))
+    return tl.tensor(pid, tl.int32)
 
 
 def num_programs(axis: int, builder: ir.builder) -> tl.tensor:
     if axis not in (0, 1, 2):
         raise ValueError(f"num_programs axis must be 0, 1, or 2 but got {axis}")
+    remap = getattr(builder, "program_id_remap", None)
+    if remap is not None:
+        return tl.tensor(builder.get_int32(remap[1][axis]), tl.int32)
     return tl.tensor(builder.create_get_num_programs(axis), tl.int32)
 
 
+def global_scratch(size: int, dtype: tl.dtype, alignment: int, builder: ir.builder) -> tl.tensor:
+    if not isinstance(size, int) or size <= 0:
+        raise ValueError(f"global_scratch size must be a positive integer but got {size}")
+    if (not isinstance(dtype, tl.dtype) or dtype.is_ptr() or dtype.is_block() or dtype.is_void()
+            or dtype.primitive_bitwidth % 8):
+        raise ValueError(f"global_scratch elements must be of a scalar type of whole bytes but got {dtype}")
+    if not isinstance(alignment, int) or alignment <= 0 or alignment & (alignment - 1):
+        raise ValueError(f"global_scratch alignment must be a power of 2 but got {alignment}")
+    nbytes = size * dtype.primitive_bitwidth // 8
+    if nbytes >= 2**31:
+        raise ValueError(f"global_scratch workspace of {nbytes} bytes exceeds 2GB")
+    ptr_ty = tl.pointer_type(dtype)
+    return tl.tensor(builder.create_global_scratch_alloc(nbytes, alignment, ptr_ty.to_ir(builder)), ptr_ty)
+
+
 # ===----------------------------------------------------------------------===//
 #                               Implicit Casting Utilities
 # ===----------------------------------------------------------------------===//
@@ -571,10 +607,23 @@ def expand_dims(input: tl.tensor, axis: int, builder: ir.builder) -> tl.tensor:
 
 
 def cat(lhs: tl.tensor, rhs: tl.tensor, can_reorder: bool, builder: ir.builder) -> tl.tensor:
-    assert can_reorder, "current implementation of `cat` always may reorder elements"
-    assert len(lhs.shape) == 1
-    ret_type = tl.block_type(lhs.type.scalar, [lhs.shape[0] + rhs.shape[0]])
-    return tl.tensor(builder.create_cat(lhs.handle, rhs.handle), ret_type)
+    if can_reorder:
+        assert len(lhs.shape) == 1
+        ret_type = tl.block_type(lhs.type.scalar, [lhs.shape[0] + rhs.shape[0]])
+        return tl.tensor(builder.create_cat(lhs.handle, rhs.handle), ret_type)
+
+    if not lhs.type.is_block() or lhs.type != rhs.type:
+        raise ValueError(f"cat() expects two tensors of the same type, but got {lhs.type} and {rhs.type}")
+    # Join the inputs in a new minor dimension, move it in front of the first
+    # dimension and merge the two: the rows of lhs then come before those of
+    # rhs. The layout conversions this needs are lowered through linear
+    # layouts, in registers when the layouts allow it and through shared
+    # memory otherwise.
+    rank = len(lhs.shape)
+    ret = join(lhs, rhs, builder)
+    ret = permute(ret, [rank] + list(range(rank)), builder)
+    ret_shape = [2 * tl._constexpr_to_value(lhs.shape[0])] + [tl._constexpr_to_value(d) for d in lhs.shape[1:]]
+    return reshape(ret, ret_shape, can_reorder=False, builder=builder)
 
 
 def join(a: tl.tensor, b: tl.tensor, builder: ir.builder) -> tl.tensor:
@@ -884,6 +933,8 @@ def _str_to_eviction_policy(eviction_policy):
             eviction = ir.EVICTION_POLICY.EVICT_LAST
         elif eviction_policy == "evict_first":
             eviction = ir.EVICTION_POLICY.EVICT_FIRST
+        elif eviction_policy == "no_allocate":
+            eviction = ir.EVICTION_POLICY.NO_ALLOCATE
         else:
             raise ValueError(f"Eviction policy {eviction_policy} not supported")
     return eviction
@@ -997,6 +1048,9 @@ def _load_legacy(ptr, mask, other, boundary_check, padding, cache, eviction, is_
     ptr_ty = ptr.type.scalar
     elt_ty = ptr_ty.element_ty
 
+    if elt_ty.is_int4() or elt_ty.is_uint4():
+        raise ValueError(f"{elt_ty} values cannot be accessed in memory, load them packed in 8-bit integers instead")
+
     # Treat `pointer_type<tl.int1>` as `pointer_type<tl.int8>`
     if elt_ty == tl.int1:
         elt_ty = tl.int8
@@ -1049,6 +1103,21 @@ def descriptor_load(desc_ptr: tl.tensor, offsets, cache_modifier: str, eviction_
     return tl.tensor(x, type)
 
 
+def descriptor_load_im2col(desc_ptr: tl.tensor, offsets, im2col_offsets, cache_modifier: str, eviction_policy: str,
+                           type, builder: ir.builder) -> tl.tensor:
+    if len(offsets) < 3 or len(im2col_offsets) != len(offsets) - 2:
+        raise ValueError("im2col loads take the coordinates of 3 to 5 dimensions and an offset per spatial dimension, "
+                         f"but got {len(offsets)} coordinates and {len(im2col_offsets)} offsets")
+    if len(type.shape) != 2:
+        raise ValueError(f"im2col loads return a block of pixels and channels, but got shape {type.shape}")
+    offsets = _convert_to_ir_values(builder, offsets, require_i64=False)
+    im2col_offsets = [cast(to_tensor(offset, builder), tl.int16, builder).handle for offset in im2col_offsets]
+    x = builder.create_descriptor_load_im2col(desc_ptr.handle, offsets, im2col_offsets, type.to_ir(builder),
+                                              _str_to_load_cache_modifier(cache_modifier),
+                                              _str_to_eviction_policy(eviction_policy))
+    return tl.tensor(x, type)
+
+
 def descriptor_store(desc_ptr: tl.tensor, value: tl.tensor, offsets, builder: ir.builder) -> tl.tensor:
     offsets = _convert_to_ir_values(builder, offsets, require_i64=False)
     return tl.tensor(builder.create_descriptor_store(desc_ptr.handle, value.handle, offsets), tl.void)
@@ -1110,6 +1179,9 @@ def _store_legacy(ptr, val, mask, boundary_check, cache, eviction, builder):
     ptr_ty = ptr.type.scalar
     elt_ty = ptr_ty.element_ty
 
+    if elt_ty.is_int4() or elt_ty.is_uint4():
+        raise ValueError(f"{elt_ty} values cannot be accessed in memory, load them packed in 8-bit integers instead")
+
     # Treat `pointer_type<tl.int1>` as `pointer_type<tl.int8>`
     if elt_ty == tl.int1:
         elt_ty = tl.int8
@@ -1144,6 +1216,45 @@ def store(ptr: tl.tensor, val: tl.tensor, mask: Optional[tl.tensor], boundary_ch
         return _store_legacy(ptr, val, mask, boundary_check, cache, eviction, builder)
 
 
+def prefetch(ptr: tl.tensor, mask: Optional[tl.tensor], builder: ir.builder) -> tl.tensor:
+    if not ptr.type.scalar.is_ptr() or (ptr.type.is_ptr() and ptr.type.element_ty.is_block()):
+        raise ValueError(f"Unsupported ptr type {ptr.type.__repr__()} in `tl.prefetch`, which takes a pointer or a "
+                         "tensor of pointers")
+    if mask is not None:
+        if not ptr.type.is_block() and mask.type.is_block():
+            raise ValueError("Mask argument cannot be block type if pointer argument is not a block")
+        if not mask.type.scalar.is_bool():
+            raise ValueError("Mask must have boolean scalar type")
+        if ptr.type.is_block():
+            mask = broadcast_impl_shape(mask, ptr.type.get_block_shapes(), builder)
+    return tl.tensor(builder.create_prefetch(ptr.handle, mask.handle if mask is not None else None), tl.void)
+
+
+def descriptor_atomic(op: str, desc_ptr: tl.tensor, value: tl.tensor, offsets, builder: ir.builder) -> tl.tensor:
+    # The types the TMA reduces by `op`.
+    sca_ty = value.type.scalar
+    is_int = sca_ty.is_int() and sca_ty.primitive_bitwidth in (32, 64)
+    if op == 'add':
+        supported = is_int or sca_ty in (tl.float32, tl.float16, tl.bfloat16)
+    else:
+        supported = is_int or sca_ty in (tl.float16, tl.bfloat16)
+    if not supported:
+        raise ValueError(f"descriptor atomic_{op} does not support {sca_ty}")
+    if op == 'add':
+        rmw_op = ir.ATOMIC_OP.FADD if sca_ty.is_floating() else ir.ATOMIC_OP.ADD
+    elif sca_ty.is_int_unsigned():
+        rmw_op = ir.ATOMIC_OP.UMAX if op == 'max' else ir.ATOMIC_OP.UMIN
+    else:
+        rmw_op = ir.ATOMIC_OP.MAX if op == 'max' else ir.ATOMIC_OP.MIN
+    offsets = _convert_to_ir_values(builder, offsets, require_i64=False)
+    return tl.tensor(builder.create_descriptor_reduce(rmw_op, desc_ptr.handle, value.handle, offsets), tl.void)
+
+
+def descriptor_prefetch(desc_ptr: tl.tensor, offsets, type, builder: ir.builder) -> tl.tensor:
+    offsets = _convert_to_ir_values(builder, offsets, require_i64=False)
+    return tl.tensor(builder.create_descriptor_prefetch(desc_ptr.handle, offsets, type.to_ir(builder)), tl.void)
+
+
 #########
 # atomic
 #########
@@ -1314,13 +1425,13 @@ def _str_to_dot_input_precision(input_precision, builder):
     assert input_precision.lower() in builder.options.allowed_dot_input_precisions, \
         f"input_precision must be one of {builder.options.allowed_dot_input_precisions}. Got {input_precision}"
     input_precision = input_precision.upper()
-    if input_precision == "TF32X3":
-        input_precision = "TF32x3"
+    if input_precision in ("TF32X3", "BF16X3", "BF16X6"):
+        input_precision = input_precision.replace("X", "x")
     return getattr(ir.INPUT_PRECISION, input_precision)
 
 
 def dot(lhs: tl.tensor, rhs: tl.tensor, acc: tl.tensor, input_precision: Optional[str], max_num_imprecise_acc: int,
-        out_dtype: tl.dtype, builder: ir.builder) -> tl.tensor:
+        out_dtype: tl.dtype, k_extent: Optional[int], builder: ir.builder) -> tl.tensor:
 
     def assert_dtypes_valid(lhs_dtype, rhs_dtype, options):
         if not options.allow_fp8e4nv:
@@ -1406,8 +1517,89 @@ def dot(lhs: tl.tensor, rhs: tl.tensor, acc: tl.tensor, input_precision: Optiona
         else:
             max_num_imprecise_acc = 0
 
-    return tl.tensor(builder.create_dot(lhs.handle, rhs.handle, acc_handle, input_precision, max_num_imprecise_acc),
-                     ret_ty)
+    K = lhs.type.shape[-1]
+    if k_extent is None:
+        k_extent = 0
+    elif not isinstance(k_extent, int) or not 0 < k_extent <= K:
+        raise ValueError(f"k_extent must be an integer in (0, {K}], but got {k_extent}")
+
+    return tl.tensor(
+        builder.create_dot(lhs.handle, rhs.handle, acc_handle, input_precision, max_num_imprecise_acc, k_extent),
+        ret_ty)
+
+
+def _str_to_scale_dot_elem_type(format: str, builder: ir.builder):
+    formats = {"e4m3": ir.SCALE_DOT_ELEM_TYPE.E4M3, "e5m2": ir.SCALE_DOT_ELEM_TYPE.E5M2,
+               "e2m1": ir.SCALE_DOT_ELEM_TYPE.E2M1, "bf16": ir.SCALE_DOT_ELEM_TYPE.BF16}
+    if format not in formats:
+        raise ValueError(f"format must be one of {list(formats)}. Got {format}")
+    return formats[format]
+
+
+def dot_scaled(lhs: tl.tensor, lhs_scale: Optional[tl.tensor], lhs_format: str, rhs: tl.tensor,
+               rhs_scale: Optional[tl.tensor], rhs_format: str, acc: Optional[tl.tensor], out_dtype: tl.dtype,
+               builder: ir.builder) -> tl.tensor:
+
+    def check_operand(x, format, name):
+        assert x.type.is_block() and len(x.shape) == 2, f"{name} must be a 2D tensor"
+        if format == "e2m1":
+            assert x.dtype == tl.uint8 or x.dtype == tl.int8, f"e2m1 {name} must pack two elements per (u)int8, got {x.dtype}"
+        elif format == "e4m3":
+            assert x.dtype.is_fp8e4nv(), f"e4m3 {name} must be float8e4nv, got {x.dtype}"
+        elif format == "e5m2":
+            assert x.dtype.is_fp8e5(), f"e5m2 {name} must be float8e5, got {x.dtype}"
+        elif format == "bf16":
+            assert x.dtype.is_bf16(), f"bf16 {name} must be bfloat16, got {x.dtype}"
+
+    def check_scale(scale, name):
+        if scale is None:
+            return None
+        assert scale.type.is_block() and len(scale.shape) == 2, f"{name} must be a 2D tensor"
+        assert scale.dtype == tl.uint8 or scale.dtype.is_fp8e4nv(
+        ), f"{name} must be uint8 (e8m0) or float8e4nv (e4m3), got {scale.dtype}"
+        return scale.handle
+
+    check_operand(lhs, lhs_format, "lhs")
+    check_operand(rhs, rhs_format, "rhs")
+    assert out_dtype == tl.float32, "dot_scaled only accumulates in float32"
+    M = lhs.type.shape[0]
+    N = rhs.type.shape[1]
+    lhs_k = lhs.type.shape[1] * (2 if lhs_format == "e2m1" else 1)
+    rhs_k = rhs.type.shape[0] * (2 if rhs_format == "e2m1" else 1)
+    assert lhs_k == rhs_k, f"lhs ({lhs.shape}, {lhs_format}) and rhs ({rhs.shape}, {rhs_format}) have a different K"
+    ret_ty = tl.block_type(out_dtype, [M, N])
+    if acc is None:
+        acc_handle = builder.create_splat(builder.get_fp32(0), [M, N])
+    else:
+        acc_handle = acc.handle
+        assert acc.type == ret_ty
+    return tl.tensor(
+        builder.create_dot_scaled(lhs.handle, check_scale(lhs_scale, "lhs_scale"),
+                                  _str_to_scale_dot_elem_type(lhs_format, builder), rhs.handle,
+                                  check_scale(rhs_scale, "rhs_scale"), _str_to_scale_dot_elem_type(rhs_format, builder),
+                                  acc_handle), ret_ty)
+
+
+def sparse_dot(a: tl.tensor, a_meta: tl.tensor, b: tl.tensor, acc: Optional[tl.tensor],
+               builder: ir.builder) -> tl.tensor:
+    assert a.type.is_block() and b.type.is_block() and a_meta.type.is_block(), "sparse_dot operands must be tensors"
+    assert len(a.shape) == 2 and len(b.shape) == 2 and len(a_meta.shape) == 2, "sparse_dot operands must be 2D"
+    assert a.dtype in (tl.float16, tl.bfloat16) and a.dtype == b.dtype, \
+        f"sparse_dot operands must both be float16 or bfloat16, got {a.dtype} and {b.dtype}"
+    assert a_meta.dtype == tl.int16, f"sparse_dot metadata must be int16, got {a_meta.dtype}"
+    M = a.type.shape[0]
+    K = b.type.shape[0]
+    N = b.type.shape[1]
+    assert K % 32 == 0, f"sparse_dot requires K to be a multiple of 32, got {K}"
+    assert a.type.shape[1] * 2 == K, f"compressed a ({a.shape}) must hold half of the K = {K} elements of b"
+    assert a_meta.type.shape == [M, K // 16], f"a_meta must be of shape [{M}, {K // 16}], got {a_meta.shape}"
+    ret_ty = tl.block_type(tl.float32, [M, N])
+    if acc is None:
+        acc_handle = builder.create_splat(builder.get_fp32(0), [M, N])
+    else:
+        acc_handle = acc.handle
+        assert acc.type == ret_ty
+    return tl.tensor(builder.create_sparse_dot(a.handle, b.handle, acc_handle, a_meta.handle), ret_ty)
 
 
 # ===----------------------------------------------------------------------===//
@@ -1465,8 +1657,8 @@ def reduction(inputs: Sequence[tl.tensor], axis: int, region_builder_fn, builder
 # ===----------------------------------------------------------------------===
 
 
-def associative_scan(inputs: Sequence[tl.tensor], axis: int, region_builder_fn, reverse: bool,
-                     builder: ir.builder) -> Tuple[tl.tensor, ...]:
+def associative_scan(inputs: Sequence[tl.tensor], axis: int, region_builder_fn, reverse: bool, builder: ir.builder,
+                     flags: Optional[tl.tensor] = None) -> Tuple[tl.tensor, ...]:
     shape = inputs[0].type.shape
     rank = len(shape)
 
@@ -1478,7 +1670,13 @@ def associative_scan(inputs: Sequence[tl.tensor], axis: int, region_builder_fn,
     for t in inputs:
         assert t.type.shape == shape, "all scan inputs must have the same shape"
 
-    scan_op = builder.create_scan([t.handle for t in inputs], axis, reverse)
+    handles = [t.handle for t in inputs]
+    if flags is not None:
+        flags = broadcast_impl_shape(flags, shape, builder)
+        if not flags.type.scalar.is_bool():
+            flags = not_equal(flags, 0, builder)
+        handles.append(flags.handle)
+    scan_op = builder.create_scan(handles, axis, reverse, flags is not None)
     region_builder_fn(scan_op)
     scan_op.verify()
 
@@ -1490,10 +1688,44 @@ def associative_scan(inputs: Sequence[tl.tensor], axis: int, region_builder_fn,
 # ===----------------------------------------------------------------------===
 
 
-def histogram(input: tl.tensor, num_bins: int, builder: ir.builder) -> tl.tensor:
+def histogram(input: tl.tensor, num_bins: int, mask: Optional[tl.tensor], weights: Optional[tl.tensor],
+              builder: ir.builder) -> tl.tensor:
     assert len(input.shape) == 1, "histogram only supports 1D input"
     assert input.dtype.is_int(), "histogram only supports integer input"
-    return tl.tensor(builder.create_histogram(input.handle, num_bins), tl.block_type(tl.int32, (num_bins, )))
+    dtype = tl.int32
+    mask_handle = None
+    if mask is not None:
+        mask = broadcast_impl_shape(mask, input.shape, builder)
+        if not mask.type.scalar.is_bool():
+            raise ValueError("histogram mask must be a boolean tensor")
+        mask_handle = mask.handle
+    weights_handle = None
+    if weights is not None:
+        weights = broadcast_impl_shape(weights, input.shape, builder)
+        if weights.dtype not in (tl.int32, tl.float32):
+            raise ValueError(f"histogram weights must be int32 or float32, got {weights.dtype}")
+        dtype = weights.dtype
+        weights_handle = weights.handle
+    return tl.tensor(builder.create_histogram(input.handle, num_bins, mask_handle, weights_handle),
+                     tl.block_type(dtype, (num_bins, )))
+
+
+def gather(src: tl.tensor, index: tl.tensor, axis: int, builder: ir.builder) -> tl.tensor:
+    assert index.dtype.is_int(), "index must be an integer tensor"
+    if not src.type.is_block() or not index.type.is_block():
+        raise ValueError("gather operands must be tensors")
+
+    rank = len(src.type.shape)
+    if len(index.type.shape) != rank:
+        raise ValueError("source and index tensors must have the same rank")
+    axis = tl._wrap_axis(axis, rank)
+
+    for d in range(rank):
+        if d != axis and index.type.shape[d] != src.type.shape[d]:
+            raise ValueError(f"index dim {d} must match the corresponding source dim")
+
+    gather = builder.create_gather(src.handle, index.handle, axis)
+    return wrap_tensor(gather, src.type.scalar, index.type.shape)
 
 
 ##
@@ -1520,6 +1752,13 @@ def max_constancy(x: tl.tensor, values: List[int]) -> tl.tensor:
     return x
 
 
+def pipeline_stage(x: tl.tensor, stage: int, builder: ir.builder) -> tl.tensor:
+    if stage < 0:
+        raise ValueError(f"pipeline stage must be non-negative, got {stage}")
+    x.handle.set_attr("tt.pipeline_stage", builder.get_int32_attr(stage))
+    return x
+
+
 def debug_barrier(builder: ir.builder) -> tl.tensor:
     return tl.tensor(builder.create_barrier(), tl.void)
 
@@ -1546,6 +1785,19 @@ def device_assert(cond: tl.tensor, msg: str, file_name: str, func_name, lineno:
     return tl.tensor(builder.create_assert(cond.handle, msg, file_name, func_name, lineno), tl.void)
 
 
+def profile_region(buffer: tl.tensor, region: int, end: bool, capacity: int, builder: ir.builder) -> tl.tensor:
+    if not (buffer.type.is_ptr() and buffer.type.element_ty == tl.int64):
+        raise ValueError(f"profile_region requires a scalar pointer to int64, but got {buffer.type}")
+    if region < 0 or capacity <= 0:
+        raise ValueError("profile_region requires a non-negative region and a positive capacity")
+    # Linear index of the program, as in a row-major grid of (axis 2, axis 1, axis 0)
+    program_index = program_id(2, builder)
+    for axis in (1, 0):
+        program_index = add(mul(program_index, num_programs(axis, builder), builder), program_id(axis, builder),
+                            builder)
+    return tl.tensor(builder.create_profile_region(buffer.handle, program_index.handle, region, end, capacity), tl.void)
+
+
 def _convert_elem_to_ir_value(builder, elem, require_i64):
     if isinstance(elem, int):
         elem = tl.constexpr(elem)
@@ -1576,7 +1828,8 @@ def _convert_to_ir_values(builder, list_like, require_i64=True):
     return [_convert_elem_to_ir_value(builder, list_like, require_i64)]
 
 
-def make_block_ptr(base: tl.tensor, shape, strides, offsets, block_shape, order, builder: ir.builder) -> tl.tensor:
+def make_block_ptr(base: tl.tensor, shape, strides, offsets, block_shape, order, builder: ir.builder, page_table=None,
+                   page_size=None) -> tl.tensor:
     # Convert dynamic arguments to IR values
     # NOTES(Chenggang): current `shape/strides` are `int64_t`, while `offsets/block_shape` are `int32_t`
     shape = _convert_to_ir_values(builder, shape)
@@ -1611,7 +1864,17 @@ def make_block_ptr(base: tl.tensor, shape, strides, offsets, block_shape, order,
     # Build value, the type is:
     #   `pointer_type<blocked<shape, element_type>>` in Python
     #   `tt.ptr<tensor<shape, element_type>>` in MLIR
-    handle = builder.create_make_block_ptr(base.handle, shape, strides, offsets, block_shape, order)
+    if page_table is not None:
+        if not page_table.type.is_ptr() or page_table.type.element_ty != tl.int32:
+            raise ValueError("Expected `page_table` to be a pointer to `tl.int32` page indices")
+        if not isinstance(page_size, int) or page_size <= 0:
+            raise ValueError("Expected `page_size` to be a positive constant integer")
+        handle = builder.create_make_paged_block_ptr(base.handle, shape, strides, offsets, block_shape, order,
+                                                     page_table.handle, page_size)
+    else:
+        if page_size is not None:
+            raise ValueError("`page_size` requires a `page_table`")
+        handle = builder.create_make_block_ptr(base.handle, shape, strides, offsets, block_shape, order)
     return tl.tensor(handle, tl.pointer_type(tl.block_type(base.type.element_ty, block_shape)))
 
 
@@ -57,6 +57,77 @@ def softmax(x, ieee_rounding=False):
     return math.fdiv(num, den, ieee_rounding)
 
 
+@jit
+def _exp2_fma(x):
+    # 2**x = 2**j * 2**f, with j = floor(x) and f in [0, 1): 2**f is a degree 3
+    # minimax polynomial, evaluated with FMAs, and j is added to the exponent of
+    # its bits, so that the SFUs are left free.
+    x = core.maximum(x, -127.0)
+    j = math.floor(x)
+    f = x - j
+    p = ((0.0771190897 * f + 0.2275643945) * f + 0.6951461434) * f + 1.0
+    bits = p.to(core.int32, bitcast=True) + (j.to(core.int32) << 23)
+    return bits.to(core.float32, bitcast=True)
+
+
+@jit
+def _exp2_mixed(x):
+    # Every other column runs on the SFUs, and the others on the FMA units.
+    sfu, fma = core.reshape(x, [x.shape[0], x.shape[1] // 2, 2]).split()
+    return core.reshape(core.join(math.exp2(sfu), _exp2_fma(fma)), [x.shape[0], x.shape[1]])
+
+
+@jit
+def online_softmax(qk, m_i, l_i, qk_scale, p_dtype: core.constexpr = core.float32,
+                   exp2_impl: core.constexpr = "sfu"):
+    """
+    Updates the running row max :code:`m_i` and row sum :code:`l_i` of the
+    online softmax of flash attention with a block of scores :code:`qk`, and
+    returns :code:`(p, alpha, m_i, l_i)`: the exponentials of the block, to
+    multiply with the values, and the factor rescaling the accumulator.
+
+    The max is kept in the scaled domain, so that :code:`qk * qk_scale - m_i`,
+    the operand of the exponential, is a single FMA.
+
+    .. highlight:: python
+    .. code-block:: python
+
+        m_i = tl.full([BLOCK_M], float("-inf"), tl.float32)
+        l_i = tl.zeros([BLOCK_M], tl.float32)
+        qk_scale = sm_scale * 1.44269504  # log2(e)
+        for start_n in range(0, N, BLOCK_N):
+            qk = tl.dot(q, k)
+            p, alpha, m_i, l_i = tl.online_softmax(qk, m_i, l_i, qk_scale, tl.float16)
+            acc = tl.dot(p, v, acc * alpha[:, None])
+        out = acc / l_i[:, None]
+
+    :param qk: the 2D block of scores, reduced along its rows.
+    :param m_i: the running max of the rows, scaled by :code:`qk_scale`.
+    :param l_i: the running sum of the rows.
+    :param qk_scale: the positive scale of the scores, times log2(e) for a
+        softmax in base e.
+    :param p_dtype: the type of :code:`p`. With :code:`tl.float16` or
+        :code:`tl.bfloat16`, the exponentials are computed in 16 bits, two at
+        a time on the targets that support it.
+    :param exp2_impl: where the exponentials of :code:`p` run: "sfu" on the
+        special function units, "fma" with a polynomial on the FMA units, and
+        "mixed" half on each, for kernels bound by the throughput of the SFUs.
+    """
+    core.static_assert(exp2_impl == "sfu" or exp2_impl == "fma" or exp2_impl == "mixed",
+                       "exp2_impl must be 'sfu', 'fma' or 'mixed'")
+    m_ij = core.maximum(m_i, max(qk, 1) * qk_scale)
+    alpha = math.exp2(m_i - m_ij)
+    x = qk * qk_scale - m_ij[:, None]
+    if exp2_impl == "fma":
+        p = _exp2_fma(x).to(p_dtype)
+    elif exp2_impl == "mixed":
+        p = _exp2_mixed(x).to(p_dtype)
+    else:
+        p = math.exp2(x.to(p_dtype))
+    l_ij = l_i * alpha + sum(p.to(core.float32), 1)
+    return p, alpha, m_ij, l_ij
+
+
 @core._tensor_member_fn
 @jit
 def ravel(x):
@@ -69,6 +140,52 @@ def ravel(x):
     return core.reshape(x, [x.numel], can_reorder=True)
 
 
+def _int_range(dtype: core.constexpr):
+    dtype = core._unwrap_if_constexpr(dtype)
+    assert dtype.is_int() and dtype.int_bitwidth <= 16, "requantize supports 8 and 16-bit integer outputs"
+    if dtype.is_int_signed():
+        return float(-(1 << (dtype.int_bitwidth - 1))), float((1 << (dtype.int_bitwidth - 1)) - 1)
+    return 0.0, float((1 << dtype.int_bitwidth) - 1)
+
+
+def _int_min(dtype: core.constexpr):
+    return core.constexpr(_int_range(dtype)[0])
+
+
+def _int_max(dtype: core.constexpr):
+    return core.constexpr(_int_range(dtype)[1])
+
+
+@jit
+def requantize(input, scale, zero_point=0, dtype: core.constexpr = core.int8):
+    """
+    Requantizes the integer accumulator of a :code:`dot` of quantized
+    operands into :code:`dtype`: returns :code:`input * scale + zero_point`
+    rounded to the nearest integer, ties to even, and saturated to the range
+    of :code:`dtype`.
+
+    Applied to the result of the :code:`dot`, it runs in the layout of the
+    accumulator, so the accumulator is never written out in 32 bits.
+
+    .. highlight:: python
+    .. code-block:: python
+
+        acc = tl.dot(a, b, acc, out_dtype=tl.int32)
+        c = tl.requantize(acc, scale_a * scale_b / scale_c, zero_point_c)
+
+    :param input: the integer accumulator.
+    :param scale: the float32 scale, a scalar or a tensor broadcastable to :code:`input`, e.g. per output channel.
+    :param zero_point: the zero point of the output.
+    :param dtype: the 8 or 16-bit integer type of the output.
+    """
+    y = input.to(core.float32) * scale + zero_point
+    y = core.clamp(y, _int_min(dtype), _int_max(dtype))
+    # Adding and subtracting 1.5 * 2**23 rounds the values, which are below
+    # 2**22 once clamped, to the nearest integer, ties to even.
+    y = (y + 12582912.0) - 12582912.0
+    return y.to(dtype)
+
+
 @jit
 def swizzle2d(i, j, size_i, size_j, size_g):
     """
@@ -109,6 +226,297 @@ def swizzle2d(i, j, size_i, size_j, size_g):
     return new_i, new_j
 
 
+@jit
+def dynamic_tile_id(counter, num_tiles, order=None):
+    """
+    Returns the next tile of a persistent kernel whose tiles are handed out
+    dynamically, or :code:`num_tiles` once they are all taken.
+
+    Unlike :code:`tl.persistent_range`, which assigns the tiles to the programs
+    round-robin, each call takes the next tile from the shared counter, so that
+    the programs that got cheap tiles take more of them when the cost of the
+    tiles is irregular. The tiles are taken in the order of :code:`order`,
+    e.g. longest first, so that the expensive ones don't end up last. The last
+    program to run out of tiles resets the counter for the next launch.
+    Calling this function one tile ahead overlaps the latency of the atomic
+    with the work on the current tile.
+
+    .. highlight:: python
+    .. code-block:: python
+
+        @triton.jit
+        def kernel(..., counter, order, num_tiles):
+            tile_id = tl.dynamic_tile_id(counter, num_tiles, order)
+            while tile_id < num_tiles:
+                next_id = tl.dynamic_tile_id(counter, num_tiles, order)
+                ...
+                tile_id = next_id
+
+        counter = torch.zeros((2, ), dtype=torch.int32, device="cuda")
+        order = torch.argsort(costs, descending=True).to(torch.int32)
+        kernel[(NUM_SMS, )](..., counter, order, num_tiles)
+
+    :note: Each program should call this function until it returns
+        :code:`num_tiles`, exactly once past the last tile.
+    :param counter: a buffer of 2 zero-initialized int32 counters.
+    :param num_tiles: the total number of tiles.
+    :param order: an optional buffer of the :code:`num_tiles` tile ids in the
+        order in which they are taken.
+    """
+    ticket = core.atomic_add(counter, 1, sem="relaxed")
+    tile_id = ticket
+    if order is not None:
+        tile_id = core.load(order + core.minimum(ticket, num_tiles - 1))
+        tile_id = core.where(ticket < num_tiles, tile_id, num_tiles)
+    if ticket >= num_tiles:
+        num_programs = core.num_programs(0) * core.num_programs(1) * core.num_programs(2)
+        if core.atomic_add(counter + 1, 1, sem="acq_rel") == num_programs - 1:
+            core.atomic_xchg(counter, 0, sem="relaxed")
+            core.atomic_xchg(counter + 1, 0, sem="relaxed")
+    return tile_id
+
+
+@jit
+def split_k_reduce(acc, workspace, locks, tile_id, split_id, NUM_SPLITS: core.constexpr):
+    """
+    Deterministically reduces the partial results of a tile whose K loop is
+    split across :code:`NUM_SPLITS` programs.
+
+    Each program stores its partial result to :code:`workspace` and arrives on
+    the counter at :code:`locks + tile_id`. The last program to arrive sums the
+    partial results in split order, so the result does not depend on the order
+    in which the programs finish, and resets the counter for the next launch.
+    When the order does not matter, the partial results can instead be added
+    to the output with one bulk TMA reduction per tile on Hopper, with
+    :code:`tl._experimental_descriptor_atomic_add`.
+
+    .. highlight:: python
+    .. code-block:: python
+
+        acc, is_last = tl.split_k_reduce(acc, workspace, locks, tile_id, split_id, SPLIT_K)
+        if is_last:
+            tl.store(c_ptrs, acc.to(tl.float16), mask=c_mask)
+
+    :param acc: the partial result of this program.
+    :param workspace: a buffer of :code:`num_tiles * NUM_SPLITS * acc.numel` elements of :code:`acc`'s type.
+    :param locks: a buffer of :code:`num_tiles` zero-initialized int32 counters.
+    :param tile_id: the index of the output tile.
+    :param split_id: the index of this program's slice of the K loop, in :code:`[0, NUM_SPLITS)`.
+    :returns: the reduced tile, only valid in the last program, and whether this
+        program is the last one, which should store it.
+    """
+    offs = core.reshape(core.arange(0, acc.numel), acc.shape)
+    tile_ws = workspace + tile_id * NUM_SPLITS * acc.numel
+    core.store(tile_ws + split_id * acc.numel + offs, acc)
+    # make the stores of all the threads visible before arriving
+    core.debug_barrier()
+    count = core.atomic_add(locks + tile_id, 1, sem="acq_rel")
+    is_last = count == NUM_SPLITS - 1
+    total = zeros(acc.shape, acc.dtype)
+    if is_last:
+        for s in range(0, NUM_SPLITS):
+            total += core.load(tile_ws + s * acc.numel + offs, cache_modifier=".cg")
+        core.atomic_xchg(locks + tile_id, 0)
+    return total, is_last
+
+
+@jit
+def device_scan_tile_id(status):
+    """
+    Returns the index of the tile a program scans with :code:`device_cumsum`.
+
+    Tiles are numbered in the order in which the programs call this function,
+    rather than by program id, so the tiles a program looks back on are
+    always held by programs that are already running.
+
+    :param status: the status buffer passed to :code:`device_cumsum`.
+    """
+    return core.atomic_add(status, 1, sem="relaxed")
+
+
+@jit
+def _pack_scan_status(flag: core.constexpr, value):
+    bits = value.to(core.uint32, bitcast=True).to(core.int64)
+    return (flag << 32) | bits
+
+
+@jit
+def device_cumsum(input, tile_id, status):
+    """
+    Computes the cumulative sum of a 1D tensor across the tiles of all the
+    programs in a single pass, using decoupled look-back.
+
+    Each program publishes the sum of its tile to :code:`status`, then sums
+    the published values of the preceding tiles, from the closest one, until it
+    reaches a tile that published its inclusive prefix, and finally publishes
+    its own inclusive prefix. A status is a 64-bit word packing the 32-bit value
+    with a flag telling whether it is unset, the sum of the tile or its
+    inclusive prefix, so that it is read and written with a single atomic.
+
+    .. highlight:: python
+    .. code-block:: python
+
+        tile_id = tl.device_scan_tile_id(status)
+        offs = tile_id * BLOCK + tl.arange(0, BLOCK)
+        x = tl.load(X + offs, mask=offs < N, other=0)
+        tl.store(Out + offs, tl.device_cumsum(x, tile_id, status), mask=offs < N)
+
+    :param input: the tile of this program, of a 32-bit dtype.
+    :param tile_id: the index of the tile, from :code:`device_scan_tile_id`.
+    :param status: a buffer of :code:`num_tiles + 1` zero-initialized int64
+        elements, to zero again before each launch.
+    :returns: the inclusive cumulative sum of the elements of all the tiles up
+        to the elements of :code:`input`.
+    """
+    core.static_assert(len(input.shape) == 1, "device_cumsum only supports 1D tensors")
+    core.static_assert(input.dtype.primitive_bitwidth == 32, "device_cumsum only supports 32-bit dtypes")
+    tile_id = tile_id.to(core.int64)
+    tile_status = status + 1
+    aggregate = sum(input, 0)
+    # flags: 0 unset, 1 tile sum published, 2 inclusive prefix published
+    if tile_id == 0:
+        core.atomic_xchg(tile_status, _pack_scan_status(2, aggregate), sem="release")
+    else:
+        core.atomic_xchg(tile_status + tile_id, _pack_scan_status(1, aggregate), sem="release")
+    zero = tile_id * 0
+    exclusive = aggregate * 0
+    j = tile_id - 1
+    while j >= 0:
+        # an unset status is a value of 0, so it can be added before the flag
+        # is checked
+        s = core.atomic_cas(tile_status + j, zero, zero, sem="acquire")
+        flag = s >> 32
+        exclusive += (s & 0xFFFFFFFF).to(core.uint32).to(input.dtype, bitcast=True)
+        j = core.where(flag == 2, -1, j - (flag == 1).to(core.int64))
+    if tile_id > 0:
+        core.atomic_xchg(tile_status + tile_id, _pack_scan_status(2, exclusive + aggregate), sem="release")
+    return cumsum(input, 0) + exclusive
+
+
+@jit
+def grid_barrier():
+    """
+    Waits until all the programs of the grid reach the barrier, so that a
+    kernel can run several phases over the whole grid, e.g. a global
+    reduction followed by a normalization, in a single launch. The stores of
+    the programs before the barrier are visible to all the programs after it.
+
+    The programs must all run at once: the kernel must be launched with
+    :code:`launch_cooperative=True`, on a grid of at most
+    :code:`max_cooperative_programs()` of the compiled kernel, and all its
+    programs must call the barrier, or it deadlocks.
+
+    .. highlight:: python
+    .. code-block:: python
+
+        tl.atomic_add(total, tl.sum(x, 0))
+        tl.grid_barrier()
+        tl.store(Out + offs, x / tl.load(total, cache_modifier=".cg"), mask=mask)
+    """
+    # A counter of the arrivals of the launch, zeroed before it, which only
+    # grows: a program that arrives at the k-th barrier of this call site
+    # waits for the k * num_programs-th arrival.
+    counter = core.global_scratch(1, core.int32, 4)
+    num_programs = core.num_programs(0) * core.num_programs(1) * core.num_programs(2)
+    # make the stores of all the threads visible before arriving
+    core.debug_barrier()
+    arrived = core.atomic_add(counter, 1, sem="release")
+    target = (arrived // num_programs + 1) * num_programs
+    while core.atomic_add(counter, 0, sem="acquire") < target:
+        pass
+    core.debug_barrier()
+
+
+# -----------------------
+# Symmetric memory
+# -----------------------
+
+# A symmetric buffer is allocated with the same size on every rank of a group of GPUs that can access each other's
+# memory (e.g. over NVLink), and the kernels of each rank get the base addresses of the buffers of all the ranks, such
+# as the `buffer_ptrs_dev` of the torch symmetric memory.  The kernels then access the buffers of their peers directly,
+# which lets them overlap the communication with their computation.
+
+
+@jit
+def remote_ptr(ptr, peer_bases, rank, peer):
+    """
+    Returns the addresses in the symmetric buffer of :code:`peer` matching the addresses :code:`ptr` in the buffer of
+    :code:`rank`. Plain loads and stores through them get and put data from and to the peer.
+
+    :param ptr: The addresses in the local buffer
+    :type ptr: Block of dtype=triton.PointerDType
+    :param peer_bases: The base addresses of the buffers of all the ranks, as 64-bit integers
+    :param rank: The rank of the program
+    :param peer: The rank to access
+
+    .. highlight:: python
+    .. code-block:: python
+
+        # all-gather: put x into the slot of this rank on every peer
+        for peer in range(world_size):
+            tl.store(tl.remote_ptr(out_ptr + rank * N + offs, bases, rank, peer), x)
+    """
+    local = core.load(peer_bases + rank).to(core.int64, bitcast=True)
+    remote = core.load(peer_bases + peer).to(core.int64, bitcast=True)
+    return (ptr.to(core.int64) + (remote - local)).to(ptr.dtype)
+
+
+@jit
+def signal(signal_ptr, value, op: core.constexpr = "set"):
+    """
+    Sets or adds :code:`value` to the signal at :code:`signal_ptr`, usually the
+    :code:`remote_ptr` of a signal of a peer, once the stores of all the
+    threads of the program are visible to the whole system, so that a peer
+    waiting for the signal with :code:`signal_wait_until` sees them.
+
+    :param signal_ptr: The address of the signal, a 32 or 64-bit integer
+    :param value: The value to set or add
+    :param op: "set" or "add"
+    :type op: str, optional
+    """
+    # make the stores of all the threads visible before signaling
+    core.debug_barrier()
+    core.static_assert(op == "set" or op == "add", "signal op must be 'set' or 'add'")
+    if op == "set":
+        core.atomic_xchg(signal_ptr, value, sem="release", scope="sys")
+    else:
+        core.atomic_add(signal_ptr, value, sem="release", scope="sys")
+
+
+@jit
+def signal_wait_until(signal_ptr, value, cmp: core.constexpr = "ge"):
+    """
+    Waits until the signal at :code:`signal_ptr` compares to :code:`value`
+    with :code:`cmp`. The stores that preceded the :code:`signal` that
+    satisfied the wait are then visible to all the threads of the program.
+
+    The loads of data put by peers should bypass the L1 cache, e.g. with
+    :code:`cache_modifier=".cg"`.
+
+    :param signal_ptr: The address of the local signal
+    :param value: The value to compare the signal to
+    :param cmp: "eq" or "ge"
+    :type cmp: str, optional
+
+    .. highlight:: python
+    .. code-block:: python
+
+        tl.store(tl.remote_ptr(buf_ptr + offs, bases, rank, peer), x)
+        tl.signal(tl.remote_ptr(sig_ptr + rank, bases, rank, peer), 1)
+        ...
+        tl.signal_wait_until(sig_ptr + peer, 1)
+        y = tl.load(buf_ptr + offs, cache_modifier=".cg")
+    """
+    core.static_assert(cmp == "eq" or cmp == "ge", "signal_wait_until cmp must be 'eq' or 'ge'")
+    if cmp == "eq":
+        while core.atomic_add(signal_ptr, 0, sem="acquire", scope="sys") != value:
+            pass
+    else:
+        while core.atomic_add(signal_ptr, 0, sem="acquire", scope="sys") < value:
+            pass
+    core.debug_barrier()
+
+
 @jit
 def zeros(shape, dtype):
     """
@@ -319,51 +727,87 @@ def cumprod(input, axis=0, reverse=False):
 # sort
 
 
+# The sorts run a bitonic network on the tensor reshaped to a hypercube, [2] * log2(numel),
+# so that each compare-and-swap pairs the two halves of a single dimension. The partner of
+# each element is then a reduction over that size-2 dimension, which stays within a thread
+# when the two elements are in its registers, becomes a warp shuffle when they are in lanes
+# of a warp, and only goes through shared memory when they are in different warps.
+
+
 @jit
-def _compare_and_swap(x, flip, i: core.constexpr, n_dims: core.constexpr):
-    n_outer: core.constexpr = x.numel >> n_dims
-    shape: core.constexpr = [n_outer * 2**i, 2, 2**(n_dims - i - 1)]
-    y = core.reshape(x, shape)
-    # slice left/right with 'stride' 2**(n_dims - i - 1)
-    mask = core.arange(0, 2)[None, :, None]
-    left = core.broadcast_to(sum(y * (1 - mask), 1)[:, None, :], shape).to(y.dtype)
-    right = core.broadcast_to(sum(y * mask, 1)[:, None, :], shape).to(y.dtype)
-    left = core.reshape(left, x.shape)
-    right = core.reshape(right, x.shape)
-    # actual compare-and-swap
+def _indicator(n_dims: core.constexpr, idx: core.constexpr, pos: core.constexpr):
+    # 1 at the position `pos` of the `idx`th innermost dimension of the hypercube, 0 elsewhere.
+    core.static_assert(idx < n_dims)
+    core.static_assert((pos == 0) or (pos == 1))
+    y = core.arange(0, 2)
+    if pos == 0:
+        y = 1 - y
+    for n in core.static_range(0, n_dims):
+        if n != n_dims - 1 - idx:
+            y = core.expand_dims(y, n)
+    return y
+
+
+@jit
+def _compare_and_swap(x, flip, i: core.constexpr):
+    # compare-and-swap along the `i`th innermost dimension of the hypercube `x`
+    n_dims: core.constexpr = _log2(x.numel)
+    # the xor of the two elements along the dimension gives each element its partner
     idtype = core.get_int_dtype(bitwidth=x.dtype.primitive_bitwidth, signed=True)
-    ileft = left.to(idtype, bitcast=True)
-    iright = right.to(idtype, bitcast=True)
     ix = x.to(idtype, bitcast=True)
-    ret = ix ^ core.where((left > right) ^ flip, ileft ^ iright, zeros_like(ix))
-    return ret.to(x.dtype, bitcast=True)
+    iy = ix ^ xor_sum(ix, n_dims - 1 - i, True)
+    y = iy.to(x.dtype, bitcast=True)
+    # keep the smaller element on the left, or on the right where `flip` is set
+    is_right = _indicator(n_dims, i, 1)
+    return core.where((x > y) != (flip ^ is_right), y, x)
 
 
 @jit
-def _bitonic_merge(x, stage: core.constexpr, order: core.constexpr, n_dims: core.constexpr):
+def _bitonic_merge_hypercube(x, stage: core.constexpr, order: core.constexpr):
     '''
     order_type 0 == ascending
     order_type 1 == descending
     order_type 2 == alternating
     '''
-    n_outer: core.constexpr = x.numel >> n_dims
-    core.static_assert(stage <= n_dims)
     # flip denotes whether to re-arrange sub-sequences of elements in ascending or
     # descending order.
     # if flip = 00000000... then all elements will be re-arranged ascendingly at this stage
     # if flip = 00110011... then all the elements will be re-arranged alternatingly (with
     # a stride of 2) at this stage
     if order == 2:
-        shape: core.constexpr = [n_outer * 2**(n_dims - 1 - stage), 2, 2**stage]
-        flip = core.reshape(core.broadcast_to(core.arange(0, 2)[None, :, None], shape), x.shape)
+        flip = _indicator(_log2(x.numel), stage, 1)
     else:
         flip = order
     # perform `stage` rounds of `compare-and-swap`
     for i in core.static_range(stage):
-        x = _compare_and_swap(x, flip, i + (n_dims - stage), n_dims)
+        x = _compare_and_swap(x, flip, stage - 1 - i)
     return x
 
 
+@jit
+def _sort_impl(x, k: core.constexpr, dim: core.constexpr, descending: core.constexpr):
+    # handle default dimension or check that it is the most minor dim
+    _dim: core.constexpr = len(x.shape) - 1 if dim is None else dim
+    core.static_assert(_dim == len(x.shape) - 1, "only minor dimension is currently supported")
+    log_n: core.constexpr = _log2(x.shape[_dim])
+    log_k: core.constexpr = log_n if k is None else _log2(k)
+    core.static_assert(log_k <= log_n, "k must not be larger than the size of the dimension")
+    h = core.reshape(x, [2] * _log2(x.numel))
+    # sort runs of 2**log_k elements, in alternating orders unless they are the whole dimension
+    for i in core.static_range(1, log_k + 1):
+        h = _bitonic_merge_hypercube(h, i, 2 if i < log_n else descending)
+    # then halve the dimension until 2**log_k elements are left: the elementwise maximum (or
+    # minimum) of two runs sorted in opposite orders is a bitonic sequence holding their top
+    # 2**log_k elements, which one more merge sorts
+    for i in core.static_range(log_k + 1, log_n + 1):
+        if descending:
+            h = max(h, axis=_log2(h.numel) - 1 - log_k)
+        else:
+            h = min(h, axis=_log2(h.numel) - 1 - log_k)
+        h = _bitonic_merge_hypercube(h, log_k, 2 if i < log_n else descending)
+    return core.reshape(h, x.shape[:-1] + [2**log_k])
+
+
 @core._tensor_member_fn
 @jit
 def sort(x, dim: core.constexpr = None, descending: core.constexpr = core.CONSTEXPR_0):
@@ -377,14 +821,25 @@ def sort(x, dim: core.constexpr = None, descending: core.constexpr = core.CONSTE
     :param descending: If set to True, the tensor is sorted in descending order. If set to False, the tensor is sorted in ascending order.
     :type descending: bool, optional
     """
-    # handle default dimension or check that it is the most minor dim
-    _dim: core.constexpr = len(x.shape) - 1 if dim is None else dim
-    core.static_assert(_dim == len(x.shape) - 1, "only minor dimension is currently supported")
-    # iteratively run bitonic merge-sort steps
-    n_dims: core.constexpr = _log2(x.shape[_dim])
-    for i in core.static_range(1, n_dims + 1):
-        x = _bitonic_merge(x, i, 2 if i < n_dims else descending, n_dims)
-    return x
+    return _sort_impl(x, None, dim, descending)
+
+
+@core._tensor_member_fn
+@jit
+def topk(x, k: core.constexpr, dim: core.constexpr = None):
+    """
+    Returns the `k` largest elements of a tensor along a specified dimension, sorted in descending order.
+
+    It takes O(n log^2 k) compare-and-swaps along a dimension of size n, instead of the O(n log^2 n) of a full sort.
+
+    :param x: The input tensor.
+    :type x: Tensor
+    :param k: The number of elements to keep, a power of two.
+    :type k: int
+    :param dim: The dimension along which to select the elements. If None, the last dimension is used. Currently, only the last dimension is supported.
+    :type dim: int, optional
+    """
+    return _sort_impl(x, k, dim, True)
 
 
 # flip
@@ -1,6 +1,9 @@
-from .autotuner import (Autotuner, Config, Heuristics, autotune, heuristics)
+from .autotuner import (Autotuner, Config, ConfigSpace, Heuristics, ModelBasedSearch, SearchStrategy, SuccessiveHalving,
+                        autotune, heuristics)
+from .batch import LaunchBatch, launch_batch
 from .cache import RedisRemoteCacheBackend, RemoteCacheBackend
 from .driver import driver
+from .fusion import HorizontalFusion, horizontal_fuse
 from .jit import JITFunction, KernelInterface, MockTensor, TensorWrapper, reinterpret
 from .errors import OutOfResources, InterpreterError
 
@@ -8,16 +11,24 @@ __all__ = [
     "autotune",
     "Autotuner",
     "Config",
+    "ConfigSpace",
     "driver",
     "Heuristics",
     "heuristics",
+    "horizontal_fuse",
+    "HorizontalFusion",
     "InterpreterError",
     "JITFunction",
     "KernelInterface",
+    "launch_batch",
+    "LaunchBatch",
     "MockTensor",
+    "ModelBasedSearch",
     "OutOfResources",
     "RedisRemoteCacheBackend",
     "reinterpret",
     "RemoteCacheBackend",
+    "SearchStrategy",
+    "SuccessiveHalving",
     "TensorWrapper",
 ]
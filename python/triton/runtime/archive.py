@@ -0,0 +1,100 @@
+"""
+Kernel archives: the binaries and metadata of the kernels of a manifest, packed in a single file that is mapped in
+memory when loaded, so that the driver loads each binary from the mapping without reading it into Python bytes.
+
+    # With the kernel cache holding the binaries of the kernels of the manifest:
+    triton.runtime.archive.pack("kernels.json", "kernels.ttar")
+
+    # On the new host:
+    triton.runtime.manifest.load("kernels.json", archive="kernels.ttar")
+
+An archive starts with a magic number and the offset and size of its JSON index, which maps the hash of each kernel
+to its metadata and the offset and size of its binary.  Binaries are aligned to 16 bytes.
+"""
+import json
+import mmap
+import struct
+from typing import Dict, Optional, Tuple
+
+MAGIC = b"TTARCH1\0"
+# magic, index offset, index size
+_HEADER = struct.Struct("<8sQQ")
+_ALIGNMENT = 16
+
+
+def pack(manifest_path: str, archive_path: str) -> int:
+    """
+    Packs the binaries and metadata of the kernels of the manifest at `manifest_path`, read from the kernel cache,
+    into an archive at `archive_path`.  Returns the number of kernels packed; kernels missing from the cache are
+    skipped.
+    """
+    from .cache import get_cache_manager
+    from ..backends.compiler import GPUTarget
+    from ..compiler.compiler import make_backend
+    with open(manifest_path) as f:
+        entries = json.load(f)["kernels"]
+    index = {}
+    with open(archive_path, "wb") as f:
+        f.write(_HEADER.pack(MAGIC, 0, 0))
+        for entry in entries:
+            if entry["hash"] in index:
+                continue
+            # Same metadata file name as `compile`.
+            metadata_filename = f"{entry['name'][:150]}.json"
+            group = get_cache_manager(entry["hash"]).get_group(metadata_filename) or {}
+            if metadata_filename not in group:
+                continue
+            with open(group[metadata_filename]) as g:
+                metadata = json.load(g)
+            binary_filename = f"{entry['name'][:150]}.{make_backend(GPUTarget(**metadata['target'])).binary_ext}"
+            if binary_filename not in group:
+                continue
+            with open(group[binary_filename], "rb") as g:
+                binary = g.read()
+            f.write(b"\0" * (-f.tell() % _ALIGNMENT))
+            index[entry["hash"]] = {"metadata": metadata, "binary": [binary_filename, f.tell(), len(binary)]}
+            f.write(binary)
+        index_data = json.dumps(index).encode("utf-8")
+        index_offset = f.tell()
+        f.write(index_data)
+        f.seek(0)
+        f.write(_HEADER.pack(MAGIC, index_offset, len(index_data)))
+    return len(index)
+
+
+class Archive:
+    """
+    A kernel archive mapped in memory.  The mapping stays open as long as the archive or the kernels loaded from it
+    are alive.
+    """
+
+    def __init__(self, path: str):
+        with open(path, "rb") as f:
+            self._mmap = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        magic, index_offset, index_size = _HEADER.unpack_from(self._mmap, 0)
+        if magic != MAGIC:
+            raise ValueError(f"{path} is not a kernel archive")
+        self._index: Dict[str, dict] = json.loads(self._mmap[index_offset:index_offset + index_size])
+
+    def __contains__(self, hash: str) -> bool:
+        return hash in self._index
+
+    def get(self, hash: str) -> Optional[Tuple[dict, str, memoryview]]:
+        """
+        Returns the metadata of the kernel of hash `hash`, the extension of its binary and a read-only view of the
+        binary in the mapping, or None if the archive doesn't have the kernel.
+        """
+        if hash not in self._index:
+            return None
+        entry = self._index[hash]
+        filename, offset, size = entry["binary"]
+        return entry["metadata"], filename.rsplit(".", 1)[1], memoryview(self._mmap)[offset:offset + size]
+
+    def load_kernel(self, src, hash: str):
+        """Returns the `CompiledKernel` of `src` of hash `hash`, or None if the archive doesn't have it."""
+        from ..compiler.compiler import CompiledKernel
+        result = self.get(hash)
+        if result is None:
+            return None
+        metadata, binary_ext, binary = result
+        return CompiledKernel.from_metadata(src, metadata, {binary_ext: binary}, hash)
@@ -1,14 +1,21 @@
 from __future__ import annotations
 
 import builtins
+import hashlib
+import json
 import os
 import time
 import inspect
+import itertools
+import math
 from typing import Dict
 
 from ..testing import do_bench, do_bench_cudagraph
-from .jit import KernelInterface
+from . import manifest, pgo
+from .cache import get_cache_manager
+from .jit import JITFunction, KernelInterface, compute_bucket_key
 from .errors import OutOfResources
+from .multi_device import bench_on_devices, parse_clocks
 
 
 class Autotuner(KernelInterface):
@@ -27,17 +34,26 @@ class Autotuner(KernelInterface):
         warmup=25,
         rep=100,
         use_cuda_graph=False,
+        cache_results=False,
+        search=None,
+        multi_device=False,
+        gpu_clocks=None,
     ):
         """
         :param prune_configs_by: a dict of functions that are used to prune configs, fields:
             'perf_model': performance model used to predicate running time with different configs, returns running time
             'top_k': number of configs to bench
             'prune_num_stages_by'(optional): a function used to prune num_stages. It takes configs:List[Config] as its input, and returns pruned configs.
+            'estimate_spills'(optional): if True, configs whose register usage estimated from the TritonGPU IR exceeds
+            the hardware limit fail to compile before assembly, and are skipped.
         """
+        if isinstance(configs, ConfigSpace):
+            configs = configs.configs()
         if not configs:
             self.configs = [Config({}, num_warps=4, num_stages=2, num_ctas=1)]
         else:
             self.configs = configs
+        self.search = _make_search_strategy(search)
         self.key_idx = [arg_names.index(k) for k in key]
         self.cache = {}
         self.arg_names = arg_names
@@ -79,21 +95,31 @@ class Autotuner(KernelInterface):
         self.perf_model = None
         self.configs_top_k = 1.0
         self.early_config_prune = None
+        self.estimate_spills = False
         if prune_configs_by:
             self.perf_model = prune_configs_by.get("perf_model", self.perf_model)
             self.configs_top_k = prune_configs_by.get("top_k", self.configs_top_k)
             self.early_config_prune = prune_configs_by.get("early_config_prune", self.early_config_prune)
+            self.estimate_spills = prune_configs_by.get("estimate_spills", self.estimate_spills)
 
         self.fn = fn
         self.base_fn = fn
+        # The arguments of the key bucketed by the jit'd function are tuned per bucket.
+        self.key_buckets = {}
         while not inspect.isfunction(self.base_fn):
+            if isinstance(self.base_fn, JITFunction):
+                params = self.base_fn.params
+                self.key_buckets = {i: params[i].bucket for i in self.key_idx if params[i].bucket is not None}
             self.base_fn = self.base_fn.fn
         self.num_warmups = warmup
         self.num_reps = rep
         import torch
         self.use_cuda_graph = use_cuda_graph and torch.cuda.is_available()
+        self.cache_results = cache_results or os.getenv("TRITON_CACHE_AUTOTUNING", "0") == "1"
+        self.multi_device = multi_device or os.getenv("TRITON_AUTOTUNE_MULTI_DEVICE", "0") == "1"
+        self.gpu_clocks = gpu_clocks or parse_clocks(os.getenv("TRITON_AUTOTUNE_GPU_CLOCKS"))
 
-    def _bench(self, *args, config, **meta):
+    def _bench(self, *args, config, budget=1.0, **meta):
         from ..compiler.errors import CompileTimeAssertionFailure
 
         # check for conflicts, i.e. meta-parameters both provided
@@ -103,7 +129,7 @@ class Autotuner(KernelInterface):
             raise ValueError(f"Conflicting meta-parameters: {', '.join(conflicts)}."
                              " Make sure that you don't re-define auto-tuned symbols.")
         # augment meta-parameters with tunable ones
-        current = dict(meta, **config.all_kwargs())
+        current = dict(meta, **self._config_kwargs(config))
         full_nargs = {**self.nargs, **current}
 
         def kernel_call():
@@ -128,11 +154,45 @@ class Autotuner(KernelInterface):
             if self.use_cuda_graph:
                 import torch
                 with torch.cuda.stream(torch.cuda.Stream()):
-                    bench_res = do_bench_cudagraph(kernel_call, rep=self.num_reps, return_mode="median")
+                    bench_res = do_bench_cudagraph(kernel_call, rep=self.num_reps * budget, return_mode="median")
                 return bench_res
-            return do_bench(kernel_call, warmup=self.num_warmups, rep=self.num_reps, quantiles=(0.5, 0.2, 0.8))
+            return do_bench(kernel_call, warmup=self.num_warmups * budget, rep=self.num_reps * budget,
+                            quantiles=(0.5, 0.2, 0.8))
         except (OutOfResources, CompileTimeAssertionFailure):
-            return float("inf") if self.use_cuda_graph else [float("inf"), float("inf"), float("inf")]
+            return self._inf_timing()
+
+    def _inf_timing(self):
+        return float("inf") if self.use_cuda_graph else [float("inf"), float("inf"), float("inf")]
+
+    def _precompile(self, configs, args, kwargs):
+        """
+        Compiles `configs` concurrently, so that benchmarking them one by one afterwards doesn't wait on the
+        compiler, and returns those that compiled.  Configs that fail to compile for lack of resources (e.g. with
+        `estimate_spills`) or on a compile-time assertion are left out.
+        """
+        if len(configs) < 2 or os.getenv("TRITON_AUTOTUNE_PARALLEL_COMPILE", "1") != "1":
+            return configs
+        from ..compiler.compiler import _get_compile_pool
+        from ..compiler.errors import CompileTimeAssertionFailure
+        from .driver import driver
+
+        # The current device is per thread.
+        device = driver.active.get_current_device()
+
+        def compile_config(config):
+            driver.active.set_current_device(device)
+            self.fn.run(*args, **dict(kwargs, **self._config_kwargs(config), warmup=True))
+
+        pool = _get_compile_pool()
+        futures = [(config, pool.submit(compile_config, config)) for config in configs]
+        compiled = []
+        for config, future in futures:
+            try:
+                future.result()
+                compiled.append(config)
+            except (OutOfResources, CompileTimeAssertionFailure):
+                pass
+        return compiled
 
     def run(self, *args, **kwargs):
         self.nargs = dict(zip(self.arg_names, args))
@@ -143,22 +203,54 @@ class Autotuner(KernelInterface):
             for name in self.arg_names:
                 if name in all_args:
                     _args.append(all_args[name])
-            key = [_args[i] for i in self.key_idx]
+            key = [
+                compute_bucket_key(_args[i], self.key_buckets[i]) if i in self.key_buckets else _args[i]
+                for i in self.key_idx
+            ]
             for arg in _args:
                 if hasattr(arg, "dtype"):
                     key.append(str(arg.dtype))
             key = tuple(key)
             if key not in self.cache:
-                # prune configs
-                used_cached_result = False
-                pruned_configs = self.prune_configs(kwargs)
-                bench_start = time.time()
-                timings = {config: self._bench(*args, config=config, **kwargs) for config in pruned_configs}
-                bench_end = time.time()
-                self.bench_time = bench_end - bench_start
-                self.cache[key] = builtins.min(timings, key=timings.get)
-                self.pre_hook(args, reset_only=True)
-                self.configs_timings = timings
+                if manifest.is_recording():
+                    self._record_tuning(args, kwargs)
+                cached_config = self._load_best_config(key) if self.cache_results else None
+                if cached_config is None:
+                    cached_config = self._load_profiled_config(key)
+                if cached_config is not None:
+                    self.cache[key] = cached_config
+                else:
+                    # prune configs
+                    used_cached_result = False
+                    pruned_configs = self._order_by_profile(key, self.prune_configs(kwargs))
+                    bench_start = time.time()
+                    failed_configs = []
+
+                    def compile_configs(configs):
+                        compiled = self._precompile(configs, args, kwargs)
+                        failed_configs.extend(config for config in configs if config not in compiled)
+                        return compiled
+
+                    def bench(configs, budget=1.0):
+                        if isinstance(configs, Config):
+                            return self._bench(*args, config=configs, budget=budget, **kwargs)
+                        timings = None
+                        if self.multi_device and len(configs) > 1:
+                            timings = bench_on_devices(self, configs, args, kwargs, budget, self.gpu_clocks)
+                        if timings is None:
+                            timings = [self._bench(*args, config=config, budget=budget, **kwargs) for config in configs]
+                        return timings
+
+                    timings = self.search.search(pruned_configs, compile_configs, bench)
+                    timings.update({config: self._inf_timing() for config in failed_configs})
+                    bench_end = time.time()
+                    self.bench_time = bench_end - bench_start
+                    self.cache[key] = builtins.min(timings, key=timings.get)
+                    self.pre_hook(args, reset_only=True)
+                    self.configs_timings = timings
+                    if self.cache_results:
+                        self._store_best_config(key, self.cache[key])
+                    self._record_profile(key, timings)
             config = self.cache[key]
         else:
             config = self.configs[0]
@@ -171,11 +263,114 @@ class Autotuner(KernelInterface):
         ret = self.fn.run(
             *args,
             **kwargs,
-            **config.all_kwargs(),
+            **self._config_kwargs(config),
         )
         self.nargs = None
         return ret
 
+    def _results_cache(self, key):
+        """Returns the cache manager and file name under which the best config for `key` is kept."""
+        import torch
+        fn = self.fn
+        while not isinstance(fn, JITFunction):
+            fn = fn.fn
+        # The best config depends on the kernel, the configs it is tuned over, the tuning key and the hardware and
+        # software it runs on.
+        if torch.version.hip is not None:
+            device, version = torch.cuda.get_device_name(), f"hip-{torch.version.hip}"
+        else:
+            device, version = torch.cuda.get_device_name(), f"cuda-{torch.version.cuda}"
+        parts = [fn.cache_key, str(key), device, version] + [str(config) for config in self.configs]
+        cache_key = hashlib.sha256("-".join(parts).encode("utf-8")).hexdigest()
+        return get_cache_manager(cache_key), f"{self.base_fn.__name__}.autotune.json"
+
+    def _load_best_config(self, key):
+        cache, filename = self._results_cache(key)
+        path = cache.get_file(filename)
+        if path is None:
+            return None
+        with open(path) as f:
+            best = json.load(f)["best_config"]
+        # Return the config object itself, so that its pre_hook is kept.
+        for config in self.configs:
+            if json.loads(json.dumps(config.all_kwargs())) == best:
+                return config
+        return None
+
+    def _store_best_config(self, key, config):
+        cache, filename = self._results_cache(key)
+        try:
+            data = json.dumps({"key": str(key), "best_config": config.all_kwargs()})
+        except TypeError:
+            # Configs with values that cannot be serialized are not persisted.
+            return
+        cache.put(data, filename, binary=False)
+
+    def _profile(self):
+        """Returns the profile-guided tuning profile, the name of the kernel in it and the device, or None."""
+        profile = pgo.get_profile()
+        if profile is None:
+            return None
+        import torch
+        return profile, f"{self.base_fn.__module__}.{self.base_fn.__qualname__}", torch.cuda.get_device_name()
+
+    def _profiled_timings(self, key, exact):
+        """Returns the profiled times of the configs of this autotuner for `key`, or for the nearest key."""
+        profile = self._profile()
+        if profile is None:
+            return {}
+        profile, kernel, device = profile
+        timings = profile.timings(kernel, device, key, exact=exact)
+        configs = {}
+        for config in self.configs:
+            kwargs = pgo._normalize(config.all_kwargs())
+            if kwargs is not None and json.dumps(kwargs, sort_keys=True) in timings:
+                configs[config] = timings[json.dumps(kwargs, sort_keys=True)]
+        return configs
+
+    def _load_profiled_config(self, key):
+        timings = self._profiled_timings(key, exact=True)
+        return builtins.min(timings, key=timings.get) if timings else None
+
+    def _order_by_profile(self, key, configs):
+        """
+        Orders `configs` by their profiled time for the nearest key, the unprofiled ones last, and keeps the
+        :code:`TRITON_PGO_TOP_K` first if it is set.
+        """
+        timings = self._profiled_timings(key, exact=False)
+        if not timings:
+            return configs
+        configs = sorted(configs, key=lambda config: timings.get(config, float("inf")))
+        top_k = int(os.getenv("TRITON_PGO_TOP_K", "0"))
+        return configs[:top_k] if top_k > 0 else configs
+
+    def _record_profile(self, key, timings):
+        profile = self._profile()
+        if profile is not None:
+            profile, kernel, device = profile
+            profile.record(kernel, device, key,
+                           [(config.all_kwargs(), _median(timing)) for config, timing in timings.items()])
+
+    def _record_tuning(self, args, kwargs):
+        """Records the tuning of this kernel into the manifest, for `triton.tools.tune` to replay it."""
+        described_args = [manifest.describe_arg(arg) for arg in args]
+        tuning_kwargs = {k: v for k, v in kwargs.items() if k not in ("grid", "warmup")}
+        if any(arg is None
+               for arg in described_args) or not all(manifest.is_plain_value(v) for v in tuning_kwargs.values()):
+            return
+        grid = kwargs.get("grid")
+        grids = []
+        for config in self.configs:
+            config_grid = grid({**self.nargs, **kwargs, **config.all_kwargs()}) if callable(grid) else grid
+            grids.append(list(config_grid) if config_grid is not None else None)
+        manifest.record_tuning(self.base_fn, described_args, tuning_kwargs, grids)
+
+    def _config_kwargs(self, config):
+        kwargs = config.all_kwargs()
+        if self.estimate_spills:
+            kwargs["estimate_spills"] = True
+        return kwargs
+
     def prune_configs(self, kwargs):
         pruned_configs = self.configs
         if self.early_config_prune:
@@ -200,11 +395,16 @@ class Autotuner(KernelInterface):
         self.nargs = dict(zip(self.arg_names, args))
         ret = []
         for config in self.prune_configs(kwargs):
-            ret.append(self.fn.warmup(
-                *args,
-                **kwargs,
-                **config.all_kwargs(),
-            ))
+            try:
+                ret.append(self.fn.warmup(
+                    *args,
+                    **kwargs,
+                    **self._config_kwargs(config),
+                ))
+            except OutOfResources:
+                # Only configs sure to spill are expected to fail here.
+                if not self.estimate_spills:
+                    raise
         self.nargs = None
         return ret
 
@@ -262,8 +462,178 @@ class Config:
         return ", ".join(res)
 
 
+class ConfigSpace:
+    """
+    A space of configurations declared by the values each parameter can take, for the auto-tuner to search
+    instead of a list of :code:`triton.Config`:
+
+    .. code-block:: python
+
+        triton.ConfigSpace(
+            kwargs={'BLOCK_M': [64, 128, 256], 'BLOCK_N': [64, 128, 256], 'BLOCK_K': [32, 64], 'GROUP_M': [8]},
+            num_warps=[4, 8], num_stages=[2, 3, 4, 5],
+            constraint=lambda c: c.kwargs['BLOCK_M'] * c.kwargs['BLOCK_N'] <= 128 * 256)
+
+    :ivar constraint: an optional predicate on :code:`triton.Config`, to leave out invalid combinations.
+    """
+
+    def __init__(self, kwargs, num_warps=(4, ), num_stages=(2, ), num_ctas=(1, ), maxnreg=(None, ), constraint=None):
+        self.kwargs = kwargs
+        self.num_warps = num_warps
+        self.num_stages = num_stages
+        self.num_ctas = num_ctas
+        self.maxnreg = maxnreg
+        self.constraint = constraint
+
+    def configs(self):
+        names = list(self.kwargs.keys())
+        configs = []
+        for values in itertools.product(*(self.kwargs[name] for name in names)):
+            for num_warps, num_stages, num_ctas, maxnreg in itertools.product(self.num_warps, self.num_stages,
+                                                                              self.num_ctas, self.maxnreg):
+                config = Config(dict(zip(names, values)), num_warps=num_warps, num_stages=num_stages,
+                                num_ctas=num_ctas, maxnreg=maxnreg)
+                if self.constraint is None or self.constraint(config):
+                    configs.append(config)
+        return configs
+
+
+def _median(timing):
+    return timing[0] if isinstance(timing, list) else timing
+
+
+class SearchStrategy:
+    """
+    How the auto-tuner looks for the best of a list of configs.
+
+    :code:`search` is given the configs, a function compiling a list of configs concurrently and returning those
+    that compiled, and a function benchmarking one config, or a list of configs returning their timings, with a
+    fraction :code:`budget` of the warmup and repetition times of the auto-tuner.  Lists of configs are benchmarked
+    on several devices at once in multi-device mode.  It returns the timings of the configs it benchmarked, the best
+    of which is selected.
+    """
+
+    def search(self, configs, compile, bench):
+        raise NotImplementedError
+
+
+class ExhaustiveSearch(SearchStrategy):
+    """Benchmarks every config with the full budget."""
+
+    def search(self, configs, compile, bench):
+        compiled = compile(configs)
+        return dict(zip(compiled, bench(compiled)))
+
+
+class SuccessiveHalving(SearchStrategy):
+    """
+    Benchmarks every config with a small budget, then keeps the fastest :code:`1 / eta` of them and benchmarks
+    those again with :code:`eta` times the budget, until the survivors get the full budget.  The last round
+    returns the timings the best config is selected from.
+
+    :ivar min_budget: the fraction of the auto-tuner's warmup and repetition times of the first round.
+    """
+
+    def __init__(self, eta=3, min_budget=0.1):
+        assert eta > 1 and 0 < min_budget <= 1
+        self.eta = eta
+        self.min_budget = min_budget
+
+    def search(self, configs, compile, bench):
+        candidates = compile(configs)
+        budget = self.min_budget
+        while len(candidates) > 1 and budget < 1.0:
+            timings = dict(zip(candidates, bench(candidates, budget)))
+            num_survivors = max(len(candidates) // self.eta, 1)
+            candidates = sorted(candidates, key=lambda config: _median(timings[config]))[:num_survivors]
+            budget = min(budget * self.eta, 1.0)
+        # Only the timings of the last round are returned: those of the configs eliminated earlier were measured with
+        # smaller budgets and are less accurate.
+        return dict(zip(candidates, bench(candidates)))
+
+
+class ModelBasedSearch(SearchStrategy):
+    """
+    Benchmarks a random sample of the configs, then repeatedly benchmarks the configs a surrogate model predicts
+    to be fastest, for spaces of configs too large to benchmark all of them.
+
+    The model predicts the time of a config from the times of its nearest benchmarked neighbours, in the space
+    of the logarithms of the numeric parameters, and favors configs far from any benchmarked one to keep exploring.
+
+    :ivar num_initial: the number of configs benchmarked at random first.
+    :ivar num_iterations: the number of configs benchmarked after that, :code:`batch_size` at a time.
+    """
+
+    def __init__(self, num_initial=8, num_iterations=24, batch_size=4, num_neighbors=3, exploration=0.1, seed=0):
+        self.num_initial = num_initial
+        self.num_iterations = num_iterations
+        self.batch_size = batch_size
+        self.num_neighbors = num_neighbors
+        self.exploration = exploration
+        self.seed = seed
+
+    @staticmethod
+    def _features(config):
+        features = []
+        for name, value in sorted(config.all_kwargs().items()):
+            if isinstance(value, bool) or not isinstance(value, (int, float)):
+                features.append(float(value) if isinstance(value, bool) else 0.0)
+            else:
+                features.append(math.log2(value) if value > 0 else -1.0)
+        return features
+
+    def _predict(self, features, measured):
+        distances = sorted((math.dist(features, f), t) for f, t in measured)
+        neighbors = distances[:self.num_neighbors]
+        weights = [1 / (d + 1e-6) for d, _ in neighbors]
+        prediction = sum(w * t for w, (_, t) in zip(weights, neighbors)) / sum(weights)
+        # Lower is better: discount configs far from the measured ones by a fraction of the best time.
+        best = min(t for _, t in measured)
+        return prediction - self.exploration * best * neighbors[0][0]
+
+    def search(self, configs, compile, bench):
+        import random
+        rng = random.Random(self.seed)
+        remaining = list(configs)
+        rng.shuffle(remaining)
+        timings = {}
+        measured = []
+
+        def bench_batch(batch):
+            compiled = compile(batch)
+            for config, timing in zip(compiled, bench(compiled)):
+                timings[config] = timing
+                if math.isfinite(_median(timing)):
+                    measured.append((self._features(config), _median(timing)))
+
+        bench_batch(remaining[:self.num_initial])
+        remaining = remaining[self.num_initial:]
+        num_benchmarked = 0
+        while remaining and num_benchmarked < self.num_iterations:
+            if measured:
+                remaining.sort(key=lambda config: self._predict(self._features(config), measured))
+            batch_size = min(self.batch_size, self.num_iterations - num_benchmarked)
+            batch, remaining = remaining[:batch_size], remaining[batch_size:]
+            bench_batch(batch)
+            num_benchmarked += len(batch)
+        return timings
+
+
+def _make_search_strategy(search):
+    if search is None or search == "exhaustive":
+        return ExhaustiveSearch()
+    if search == "successive_halving":
+        return SuccessiveHalving()
+    if search == "model_based":
+        return ModelBasedSearch()
+    if isinstance(search, SearchStrategy):
+        return search
+    raise ValueError(f"unknown autotuning search strategy: {search}")
+
+
 def autotune(configs, key, prune_configs_by=None, reset_to_zero=None, restore_value=None, pre_hook=None, post_hook=None,
-             warmup=25, rep=100, use_cuda_graph=False):
+             warmup=25, rep=100, use_cuda_graph=False, cache_results=False, search=None, multi_device=False,
+             gpu_clocks=None):
     """
     Decorator for auto-tuning a :code:`triton.jit`'d function.
 
@@ -289,14 +659,34 @@ def autotune(configs, key, prune_configs_by=None, reset_to_zero=None, restore_va
     :code:`"1"`, Triton will print a message to stdout after autotuning each
     kernel, including the time spent autotuning and the best configuration.
 
-    :param configs: a list of :code:`triton.Config` objects
-    :type configs: list[triton.Config]
+    The configurations are compiled concurrently before being benchmarked one
+    after the other; set the environment variable
+    :code:`TRITON_AUTOTUNE_PARALLEL_COMPILE` to :code:`"0"` to compile each one
+    right before benchmarking it instead.
+
+    If :code:`cache_results` is true, or the environment variable
+    :code:`TRITON_CACHE_AUTOTUNING` is set to :code:`"1"`, the best
+    configuration for each key is stored in the Triton cache and reused by later
+    processes on the same kind of device instead of benchmarking again.  The
+    tunings a workload needs can be recorded in a manifest (see
+    :code:`triton.runtime.manifest`) and run ahead of time with
+    :code:`python -m triton.tools.tune`.
+
+    If the environment variable :code:`TRITON_PGO_PROFILE` names a profile
+    file, the timings of the benchmarked configurations are recorded into it,
+    and the best recorded configuration of a key is used without benchmarking;
+    keys not in the profile are tuned starting from the fastest configurations
+    of the nearest recorded key (see :code:`triton.runtime.pgo`).
+
+    :param configs: a list of :code:`triton.Config` objects, or a :code:`triton.ConfigSpace`
+    :type configs: list[triton.Config] | triton.ConfigSpace
     :param key: a list of argument names whose change in value will trigger the evaluation of all provided configs.
     :type key: list[str]
     :param prune_configs_by: a dict of functions that are used to prune configs, fields:
         'perf_model': performance model used to predicate running time with different configs, returns running time
         'top_k': number of configs to bench
         'early_config_prune'(optional): a function used to do early prune (eg, num_stages). It takes configs:List[Config] as its input, and returns pruned configs.
+        'estimate_spills'(optional): if True, skip the configs whose register usage estimated before assembly exceeds the hardware limit.
     :param reset_to_zero: a list of argument names whose value will be reset to zero before evaluating any configs.
     :type reset_to_zero: list[str]
     :param restore_value: a list of argument names whose value will be restored after evaluating any configs.
@@ -315,12 +705,31 @@ def autotune(configs, key, prune_configs_by=None, reset_to_zero=None, restore_va
     :type warmup: int
     :param rep: Repetition time (in ms) to pass to benchmarking, defaults to 100.
     :type rep: int
+    :param cache_results: whether to persist the best configurations in the Triton cache, defaults to False.
+    :type cache_results: bool
+    :param search: how to search the configs: "exhaustive" (the default) benchmarks all of them,
+        "successive_halving" benchmarks them with growing budgets while discarding the slowest, and "model_based"
+        benchmarks a subset guided by a surrogate model.  A :code:`SearchStrategy` instance can be given instead,
+        e.g. to pass parameters to these strategies.
+    :type search: str | SearchStrategy
+    :param multi_device: whether to benchmark the configs on all the visible devices of the same model as the
+        current one at once, with one worker process per device, defaults to False.  Setting the environment variable
+        :code:`TRITON_AUTOTUNE_MULTI_DEVICE` to :code:`"1"` enables it for all kernels.  The workers import the
+        kernel by name, so it must be defined at the top level of a module, and copy the tensor arguments to their
+        device; kernels defined elsewhere are tuned on the current device only.
+    :type multi_device: bool
+    :param gpu_clocks: the SM and memory clocks (in MHz) the GPUs are locked to by the workers of the multi-device
+        mode while benchmarking, with :code:`triton.testing.set_gpu_clock`, so that the timings measured on different
+        GPUs compare, defaults to the environment variable :code:`TRITON_AUTOTUNE_GPU_CLOCKS`
+        (e.g. :code:`"1350,1215"`), or unlocked clocks.  Locking the clocks requires administrator privileges.
+    :type gpu_clocks: tuple[int, int]
     """
 
     def decorator(fn):
         return Autotuner(fn, fn.arg_names, configs, key, reset_to_zero, restore_value, pre_hook=pre_hook,
                          post_hook=post_hook, prune_configs_by=prune_configs_by, warmup=warmup, rep=rep,
-                         use_cuda_graph=use_cuda_graph)
+                         use_cuda_graph=use_cuda_graph, cache_results=cache_results, search=search,
+                         multi_device=multi_device, gpu_clocks=gpu_clocks)
 
     return decorator
 
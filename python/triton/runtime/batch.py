@@ -0,0 +1,67 @@
+"""
+Batches of kernel launches: many small independent launches bound once and issued back to back, e.g. the launches
+of the experts of a MoE layer.
+
+    batch = triton.runtime.LaunchBatch([(kernel, grid, args) for ...], graph=True)
+    batch.launch()  # records the launches in a single CUDA graph and replays it
+    batch.launch()  # replays the graph
+
+The arguments are bound and the kernels are looked up, or compiled, when the launches are added, so that launching
+the batch only issues the launches.  The batch keeps launching with the arguments it was given, so tensors must be
+updated in place between launches.
+"""
+from .driver import driver
+
+
+class LaunchBatch:
+    """
+    Launches of JIT functions, given as (fn, grid, args) or (fn, grid, args, kwargs) tuples, issued in order on the
+    same stream.  With `graph=True`, the launches are recorded in a kernel graph on the first launch and replayed as
+    a whole; launch hooks are then not called.
+    """
+
+    def __init__(self, launches=(), graph=False):
+        self.launches = []
+        self.graph = graph
+        self._kernel_graph = None
+        for launch in launches:
+            fn, grid, args, *kwargs = launch
+            self.add(fn, grid, *args, **(kwargs[0] if kwargs else {}))
+
+    def add(self, fn, grid, *args, **kwargs):
+        """Adds a launch of the JIT function `fn` over `grid`, as `fn[grid](*args, **kwargs)` would launch it."""
+        assert self._kernel_graph is None, "cannot add launches to a batch recorded in a graph"
+        self.launches.append(fn.bind(*args, grid=grid, **kwargs))
+
+    def __len__(self):
+        return len(self.launches)
+
+    def launch(self, stream=None):
+        """Issues the launches of the batch on `stream`, the current stream by default."""
+        if stream is None:
+            stream = driver.active.get_current_stream(driver.active.get_current_device())
+        if self.graph:
+            if self._kernel_graph is None:
+                self._kernel_graph = driver.active.create_kernel_graph()
+                for kernel, grid, args in self.launches:
+                    self._kernel_graph.add(kernel, grid, *args)
+                self._kernel_graph.instantiate()
+            self._kernel_graph.launch(stream)
+            return
+        from ..compiler import CompiledKernel
+        enter_hook = CompiledKernel.launch_enter_hook
+        exit_hook = CompiledKernel.launch_exit_hook
+        for kernel, grid, args in self.launches:
+            launch_metadata = kernel.launch_metadata(grid, stream, *args)
+            kernel.run(grid[0], grid[1], grid[2], stream, kernel.function, kernel.packed_metadata, launch_metadata,
+                       enter_hook, exit_hook, *args)
+
+
+def launch_batch(launches, stream=None, graph=False):
+    """
+    Launches the (fn, grid, args[, kwargs]) tuples `launches` back to back, and returns their `LaunchBatch` to launch
+    them again.
+    """
+    batch = LaunchBatch(launches, graph=graph)
+    batch.launch(stream)
+    return batch
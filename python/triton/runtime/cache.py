@@ -1,8 +1,14 @@
+import base64
 import importlib
 import json
 import os
+import shutil
+import threading
+import time
 import uuid
+import warnings
 from abc import ABC, abstractmethod
+from concurrent.futures import ThreadPoolExecutor
 from pathlib import Path
 from typing import Dict, List, Optional
 import hashlib
@@ -24,6 +30,54 @@ def default_dump_dir():
     return os.path.join(get_home_dir(), ".triton", "dump")
 
 
+def parse_cache_size(size: str) -> int:
+    """
+    Returns the number of bytes of a size like `512M` or `20G`, with an optional K, M, G or T binary unit.
+    """
+    size = size.strip().upper()
+    units = {"K": 1 << 10, "M": 1 << 20, "G": 1 << 30, "T": 1 << 40}
+    if size and size[-1] in units:
+        return int(float(size[:-1]) * units[size[-1]])
+    return int(size)
+
+
+# Kernels used since then are never evicted, as other processes may be loading them.
+_EVICTION_GRACE_PERIOD = 60
+
+
+def evict_cache(cache_dir: str, max_size: int, keep: Optional[str] = None):
+    """
+    Removes the least recently used kernels of the cache at `cache_dir`, one directory per key, until it holds at
+    most `max_size` bytes.  A kernel is used when its group is written or read.  The key `keep` and the kernels used
+    in the last minute are kept.
+    """
+    entries = []
+    total_size = 0
+    for entry in os.scandir(cache_dir):
+        if not entry.is_dir(follow_symlinks=False):
+            continue
+        size = 0
+        last_used = 0.0
+        try:
+            for f in os.scandir(entry.path):
+                stat = f.stat(follow_symlinks=False)
+                size += stat.st_size
+                last_used = max(last_used, stat.st_mtime)
+        except OSError:
+            # Removed by another process.
+            continue
+        total_size += size
+        entries.append((last_used, size, entry.name))
+    now = time.time()
+    for last_used, size, name in sorted(entries):
+        if total_size <= max_size:
+            break
+        if name == keep or now - last_used < _EVICTION_GRACE_PERIOD:
+            continue
+        shutil.rmtree(os.path.join(cache_dir, name), ignore_errors=True)
+        total_size -= size
+
+
 class CacheManager(ABC):
 
     def __init__(self, key):
@@ -47,10 +101,19 @@ class CacheManager(ABC):
 
 
 class FileCacheManager(CacheManager):
+    """
+    Cache storing the files of each key in a directory.  With `TRITON_CACHE_MAX_SIZE`, e.g. `20G`, the least recently
+    used keys of the cache are evicted when a group is written and the cache is larger, at most once a minute per
+    process as it scans the whole cache.
+    """
+
+    # Time of the last eviction of this process.
+    _last_eviction = 0.0
 
     def __init__(self, key, override=False, dump=False):
         self.key = key
         self.lock_path = None
+        self.max_size = None
         if dump:
             self.cache_dir = default_dump_dir()
             self.cache_dir = os.path.join(self.cache_dir, self.key)
@@ -68,6 +131,8 @@ class FileCacheManager(CacheManager):
                 os.makedirs(self.cache_dir, exist_ok=True)
             else:
                 raise RuntimeError("Could not create or locate cache dir")
+            max_size = os.getenv("TRITON_CACHE_MAX_SIZE", "").strip()
+            self.max_size = parse_cache_size(max_size) if max_size else None
 
     def _make_path(self, filename) -> str:
         return os.path.join(self.cache_dir, filename)
@@ -94,6 +159,12 @@ class FileCacheManager(CacheManager):
         # Invalid group data.
         if child_paths is None:
             return None
+        if self.max_size is not None:
+            # Mark the kernel as used for the eviction.
+            try:
+                os.utime(grp_filepath)
+            except OSError:
+                pass
         result = {}
         for c, p in child_paths.items():
             if os.path.exists(p):
@@ -106,7 +177,12 @@ class FileCacheManager(CacheManager):
             raise RuntimeError("Could not create or locate cache dir")
         grp_contents = json.dumps({"child_paths": group})
         grp_filename = f"__grp__{filename}"
-        return self.put(grp_contents, grp_filename, binary=False)
+        path = self.put(grp_contents, grp_filename, binary=False)
+        now = time.time()
+        if self.max_size is not None and now - FileCacheManager._last_eviction >= _EVICTION_GRACE_PERIOD:
+            FileCacheManager._last_eviction = now
+            evict_cache(os.path.dirname(self.cache_dir), self.max_size, keep=self.key)
+        return path
 
     def put(self, data, filename, binary=True) -> str:
         if not self.cache_dir:
@@ -170,7 +246,84 @@ class RedisRemoteCacheBackend(RemoteCacheBackend):
         self._redis.set(self._get_key(filename), data)
 
 
+class ObjectStoreRemoteCacheBackend(RemoteCacheBackend):
+    """
+    Base class of the backends storing each file as an object of a bucket.  Object stores have no multi-get, so
+    `get` fetches the files concurrently.
+    """
+
+    def __init__(self, key):
+        self._key = key
+        self._key_fmt = os.environ.get("TRITON_OBJECT_STORE_KEY_FORMAT", "triton/{key}/{filename}")
+
+    def _get_key(self, filename: str) -> str:
+        return self._key_fmt.format(key=self._key, filename=filename)
+
+    @abstractmethod
+    def _fetch(self, object_key: str) -> Optional[bytes]:
+        pass
+
+    def get(self, filenames: List[str]) -> Dict[str, bytes]:
+        if len(filenames) <= 1:
+            results = [self._fetch(self._get_key(f)) for f in filenames]
+        else:
+            with ThreadPoolExecutor(max_workers=min(len(filenames), 16)) as pool:
+                results = list(pool.map(lambda f: self._fetch(self._get_key(f)), filenames))
+        return {filename: result for filename, result in zip(filenames, results) if result is not None}
+
+
+class S3RemoteCacheBackend(ObjectStoreRemoteCacheBackend):
+
+    def __init__(self, key):
+        import boto3
+        super().__init__(key)
+        self._bucket = os.environ["TRITON_S3_BUCKET"]
+        self._s3 = boto3.client("s3", endpoint_url=os.environ.get("TRITON_S3_ENDPOINT_URL", None))
+
+    def _fetch(self, object_key: str) -> Optional[bytes]:
+        try:
+            return self._s3.get_object(Bucket=self._bucket, Key=object_key)["Body"].read()
+        except self._s3.exceptions.NoSuchKey:
+            return None
+
+    def put(self, filename: str, data: bytes):
+        self._s3.put_object(Bucket=self._bucket, Key=self._get_key(filename), Body=data)
+
+
+class GCSRemoteCacheBackend(ObjectStoreRemoteCacheBackend):
+
+    def __init__(self, key):
+        from google.cloud import storage
+        super().__init__(key)
+        self._bucket = storage.Client().bucket(os.environ["TRITON_GCS_BUCKET"])
+
+    def _fetch(self, object_key: str) -> Optional[bytes]:
+        from google.api_core.exceptions import NotFound
+        try:
+            return self._bucket.blob(object_key).download_as_bytes()
+        except NotFound:
+            return None
+
+    def put(self, filename: str, data: bytes):
+        self._bucket.blob(self._get_key(filename)).upload_from_string(data)
+
+
 class RemoteCacheManager(CacheManager):
+    """
+    Cache backed by the remote cache pointed to by `TRITON_REMOTE_CACHE_BACKEND`, materialized in a local
+    `FileCacheManager`.
+
+    With `TRITON_REMOTE_CACHE_TIERED=1`, lookups are served from memory, then from the local disk, and only then
+    from the remote cache, and writes to the remote cache happen in the background.  Groups are then also
+    uploaded as a single bundle so that a kernel is fetched in one round trip.
+    """
+
+    # Paths of the files known to be materialized locally, by (key, filename).
+    _local_paths: Dict[tuple, str] = {}
+    # Remote writes of the tiered mode.  A single worker keeps them in order, so that the files of a group are in
+    # the remote cache before the group.
+    _write_behind = None
+    _write_behind_lock = threading.Lock()
 
     def __init__(self, key, override=False, dump=False):
         # Setup backend pointed too by `TRITON_REMOTE_CACHE_BACKEND`.
@@ -180,24 +333,70 @@ class RemoteCacheManager(CacheManager):
         remote_cache_cls = getattr(module, clz_nme)
         self._backend = remote_cache_cls(key)
 
+        self._key = key
         self._override = override
         self._dump = dump
+        self._tiered = os.environ.get("TRITON_REMOTE_CACHE_TIERED", "0") == "1"
 
         # Use a `FileCacheManager` to materialize remote cache paths locally.
         self._file_cache_manager = FileCacheManager(key, override=override, dump=dump)
 
     def _materialize(self, filename: str, data: bytes):
         # We use a backing `FileCacheManager` to provide the materialized data.
-        return self._file_cache_manager.put(data, filename, binary=True)
+        path = self._file_cache_manager.put(data, filename, binary=True)
+        RemoteCacheManager._local_paths[(self._key, filename)] = path
+        return path
+
+    def _get_local_file(self, filename: str) -> Optional[str]:
+        path = RemoteCacheManager._local_paths.get((self._key, filename), None)
+        if path is None:
+            path = self._file_cache_manager.get_file(filename)
+            if path is not None:
+                RemoteCacheManager._local_paths[(self._key, filename)] = path
+        return path
+
+    def _get_local_group(self, filename: str) -> Optional[Dict[str, str]]:
+        grp_filepath = self._get_local_file(f"__grp__{filename}")
+        if grp_filepath is None:
+            return None
+        with open(grp_filepath) as f:
+            child_paths = json.load(f).get("child_paths", None)
+        if child_paths is None:
+            return None
+        # Iterating works both for the file names of remote groups and the paths of local ones.
+        result = {c: self._get_local_file(c) for c in child_paths}
+        if any(p is None for p in result.values()):
+            return None
+        return result
+
+    def _remote_put(self, filename: str, data: bytes):
+        if not self._tiered:
+            self._backend.put(filename, data)
+            return
+        with RemoteCacheManager._write_behind_lock:
+            if RemoteCacheManager._write_behind is None:
+                RemoteCacheManager._write_behind = ThreadPoolExecutor(max_workers=1,
+                                                                      thread_name_prefix="triton-cache-write")
+            future = RemoteCacheManager._write_behind.submit(self._backend.put, filename, data)
+
+        def on_done(future):
+            if future.exception() is not None:
+                warnings.warn(f"Failed to write {filename} to the remote cache: {future.exception()}")
+
+        future.add_done_callback(on_done)
 
     def get_file(self, filename: str) -> Optional[str]:
         # We don't handle the dump/override cases.
         if self._dump or self._override:
             return self._file_cache_manager.get_file(filename)
 
-        # We always check the remote cache backend -- even if our internal file-
-        # based cache has the item -- to make sure LRU accounting works as
-        # expected.
+        # Unless tiered, we always check the remote cache backend -- even if
+        # our internal file-based cache has the item -- to make sure LRU
+        # accounting works as expected.
+        if self._tiered:
+            path = self._get_local_file(filename)
+            if path is not None:
+                return path
         results = self._backend.get([filename])
         if len(results) == 0:
             return None
@@ -211,7 +410,7 @@ class RemoteCacheManager(CacheManager):
 
         if not isinstance(data, bytes):
             data = str(data).encode("utf-8")
-        self._backend.put(filename, data)
+        self._remote_put(filename, data)
         return self._materialize(filename, data)
 
     def get_group(self, filename: str) -> Optional[Dict[str, str]]:
@@ -219,6 +418,19 @@ class RemoteCacheManager(CacheManager):
         if self._dump or self._override:
             return self._file_cache_manager.get_group(filename)
 
+        if self._tiered:
+            result = self._get_local_group(filename)
+            if result is not None:
+                return result
+            bundle_filename = f"__bundle__{filename}"
+            bundle = self._backend.get([bundle_filename]).get(bundle_filename, None)
+            if bundle is not None:
+                children = json.loads(bundle)
+                result = {c: self._materialize(c, base64.b64decode(data)) for c, data in children.items()}
+                self._materialize(f"__grp__{filename}", json.dumps({"child_paths": sorted(result.keys())}).encode())
+                return result
+            # Groups written without the tiered mode have no bundle.
+
         grp_filename = f"__grp__{filename}"
         grp_filepath = self.get_file(grp_filename)
         if grp_filepath is None:
@@ -242,6 +454,13 @@ class RemoteCacheManager(CacheManager):
         if self._dump or self._override:
             return self._file_cache_manager.put_group(filename, group)
 
+        if self._tiered:
+            children = {}
+            for child, path in group.items():
+                with open(path, "rb") as f:
+                    children[child] = base64.b64encode(f.read()).decode("ascii")
+            self._remote_put(f"__bundle__{filename}", json.dumps(children).encode("utf-8"))
+
         grp_contents = json.dumps({"child_paths": sorted(list(group.keys()))})
         grp_filename = f"__grp__{filename}"
         return self.put(grp_contents, grp_filename)
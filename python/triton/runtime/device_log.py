@@ -0,0 +1,103 @@
+"""
+Device logs: with the `device_log=N` compile option, `tl.device_print` and `tl.device_assert` don't call vprintf and
+__assertfail, but append compact records to a ring buffer of N records in the kernel, with a single atomic per print,
+or per failing assert, in each thread.  Asserts are then cheap enough to be left on, and failing asserts don't stop
+the kernel.  The host decodes the buffer once the kernel completes:
+
+    kernel = my_kernel[grid](x, BLOCK, debug=True, device_log=4096)
+    torch.cuda.synchronize()
+    for record in triton.runtime.device_log.read(kernel):
+        print(record)
+
+The buffer is a header of 4 int32, the first of which counts the records ever reserved, followed by the records of 8
+int32: the site, i.e. the index of the description of the print or assert in the kernel metadata, the thread, the
+program id, the row-major index of the element in its tensor, and the 64-bit value.  The value of a print is the
+bits of the element, and that of an assert is the number of failing elements of the thread, the index being that of
+the last of them.  Once the buffer is full, records overwrite the oldest ones.  The launches of the kernel on a device
+share its buffer until it is read.
+"""
+import json
+import struct
+from dataclasses import dataclass
+from typing import List, Optional, Tuple
+
+from .driver import driver
+
+# The names must match those of TritonGPUToLLVM/Utility.h.
+GLOBAL_NAME = "triton_device_log"
+# count, reserved
+_HEADER = struct.Struct("<I12x")
+# site, thread, pid x, pid y, pid z, index, value (low, high)
+_RECORD = struct.Struct("<6iII")
+_FLOAT_FORMATS = {"f16": ("<H", "<e"), "f32": ("<I", "<f"), "f64": ("<Q", "<d")}
+
+
+@dataclass
+class DeviceLogRecord:
+    # The description of the print or assert, e.g. {"kind": "assert", "message": ..., "file": ..., "line": ...}
+    site: dict
+    thread: int
+    pid: Tuple[int, int, int]
+    index: Tuple[int, ...]
+    value: object
+
+    def __str__(self):
+        pid = ", ".join(map(str, self.pid))
+        idx = ", ".join(map(str, self.index))
+        if self.site["kind"] == "assert":
+            return (f"{self.site['file']}:{self.site['line']}: {self.site['func']}: pid ({pid}) thread {self.thread}: "
+                    f"Assertion `{self.site['message']}` failed at idx ({idx}) for {self.value} elements")
+        if "operand" not in self.site:
+            return f"pid ({pid}){self.site['prefix']}"
+        operand = f"(operand {self.site['operand']}) " if self.site["num_operands"] > 1 else ""
+        return f"pid ({pid}) idx ({idx}){self.site['prefix']}{operand}{self.value}"
+
+
+def _decode_value(site: dict, bits: int):
+    ty = site["type"]
+    if site["hex"] or ty.startswith("!"):
+        return hex(bits)
+    if ty in _FLOAT_FORMATS:
+        bits_format, float_format = _FLOAT_FORMATS[ty]
+        return struct.unpack(float_format, struct.pack(bits_format, bits))[0]
+    if ty == "bf16":
+        return struct.unpack("<f", struct.pack("<I", bits << 16))[0]
+    if ty.startswith("i"):
+        width = int(ty[1:])
+        return bits - (1 << width) if width > 1 and bits >> (width - 1) else bits
+    # e.g. fp8 types
+    return hex(bits)
+
+
+def _unflatten(index: int, shape: List[int]) -> Tuple[int, ...]:
+    multi_dim = []
+    for dim in reversed(shape):
+        multi_dim.append(index % dim)
+        index //= dim
+    return tuple(reversed(multi_dim))
+
+
+def read(kernel, device: Optional[int] = None, clear: bool = True) -> List[DeviceLogRecord]:
+    """
+    Returns the records of the device log of the `CompiledKernel` `kernel` on `device`, by default the current device,
+    oldest first, and empties the log if `clear`.  The kernel must have completed.
+    """
+    sites = [json.loads(site) for site in getattr(kernel.metadata, "device_log_sites", ())]
+    if not sites:
+        return []
+    if device is None:
+        device = driver.active.get_current_device()
+    module = kernel._get_handles(device)[0]
+    if not module:
+        raise RuntimeError("the device log of kernels loaded as libraries can't be read")
+    data = driver.active.utils.read_global(module, GLOBAL_NAME, clear)
+    capacity = (len(data) - _HEADER.size) // _RECORD.size
+    count, = _HEADER.unpack_from(data, 0)
+    records = []
+    for i in range(max(count - capacity, 0), count):
+        site, thread, x, y, z, index, low, high = _RECORD.unpack_from(data, _HEADER.size + i % capacity * _RECORD.size)
+        site = sites[site]
+        bits = low | high << 32
+        value = bits if site["kind"] == "assert" or "operand" not in site else _decode_value(site, bits)
+        records.append(DeviceLogRecord(site, thread, (x, y, z), _unflatten(index, site.get("shape", [])), value))
+    return records
@@ -0,0 +1,103 @@
+"""
+Horizontal fusion: independent launches of JIT functions issued as the launch of a single kernel, e.g. the many
+small kernels of an optimizer step.
+
+    fused = triton.horizontal_fuse([scale_kernel, add_kernel])
+    fused((grid0, (x, n), {"BLOCK": 128}), (grid1, (a, b, m), {"BLOCK": 256}), num_warps=4)
+
+The program ids of the fused kernel are partitioned into the grids of the launches, in order, and the programs of
+each range run the function of their launch, for which `tl.program_id` and `tl.num_programs` are those of the grid of
+the launch.  The launches share the compilation options, e.g. `num_warps`, and the kernel gets the shared memory of
+the launch that needs the most, as a program only runs one of them.  The grids are compile-time constants of the
+fused kernel, so that launching over other grids compiles another kernel.
+"""
+import itertools
+import linecache
+
+from .jit import JITFunction
+
+
+def fused_call(fn, start, grid, *args):
+    """
+    Calls the JIT function `fn` with `args` as the programs [start, start + prod(grid)) of the 1D grid of the kernel,
+    which see the program ids of `grid`.  Only valid in the kernels of horizontal fusions.
+    """
+    raise RuntimeError("fused_call can only be called by the kernels of horizontal fusions")
+
+
+_num_fusions = itertools.count()
+
+
+class HorizontalFusion:
+    """
+    The JIT functions `fns` launched as a single kernel, to which a launch of each, as a (grid, args) or
+    (grid, args, kwargs) tuple, is given in the order of `fns`.
+    """
+
+    def __init__(self, fns):
+        if not fns:
+            raise ValueError("horizontal_fuse requires at least one function")
+        for fn in fns:
+            if not isinstance(fn, JITFunction):
+                raise TypeError(f"horizontal_fuse requires @triton.jit functions, but got {fn}")
+        self.fns = list(fns)
+        self.fn = self._make_kernel()
+
+    def _make_kernel(self):
+        from .. import language as tl
+        params = []
+        body = ["    pid = tl.program_id(0)"]
+        for i, fn in enumerate(self.fns):
+            names = [f"k{i}_{p.name}" for p in fn.params]
+            params += [f"{name}: tl.constexpr" if p.is_constexpr else name for name, p in zip(names, fn.params)]
+            params += [f"K{i}_START: tl.constexpr"] + [f"K{i}_GRID{axis}: tl.constexpr" for axis in range(3)]
+            call = f"fused_call(k{i}, K{i}_START, (K{i}_GRID0, K{i}_GRID1, K{i}_GRID2), {', '.join(names)})"
+            if i + 1 < len(self.fns):
+                body += [f"    if pid < K{i + 1}_START:", f"        {call}", "        return"]
+            else:
+                body += [f"    {call}"]
+        name = "fused_" + "_".join(fn.__name__ for fn in self.fns)
+        src = "\n".join([f"def {name}({', '.join(params)}):"] + body) + "\n"
+        # The source is registered in the line cache for `JITFunction`, which reads the source of its function.
+        file_name = f"<triton horizontal fusion {next(_num_fusions)}>"
+        linecache.cache[file_name] = (len(src), None, src.splitlines(True), file_name)
+        gscope = {"__name__": __name__, "tl": tl, "fused_call": fused_call}
+        gscope.update({f"k{i}": fn for i, fn in enumerate(self.fns)})
+        exec(compile(src, file_name, "exec"), gscope)
+        return JITFunction(gscope[name])
+
+    def _bind(self, launches):
+        if len(launches) != len(self.fns):
+            raise ValueError(f"expected {len(self.fns)} launches, but got {len(launches)}")
+        args = {}
+        start = 0
+        for i, (fn, launch) in enumerate(zip(self.fns, launches)):
+            grid, fn_args, *fn_kwargs = launch
+            bound_args = fn.signature.bind(*fn_args, **(fn_kwargs[0] if fn_kwargs else {}))
+            bound_args.apply_defaults()
+            if callable(grid):
+                grid = grid(bound_args.arguments)
+            grid = tuple(grid) + (1, ) * (3 - len(grid))
+            if any(size <= 0 for size in grid):
+                raise ValueError(f"the grid of the launch of {fn.__name__} is empty: {grid}")
+            args.update({f"k{i}_{name}": arg for name, arg in bound_args.arguments.items()})
+            args.update({f"K{i}_START": start, f"K{i}_GRID0": grid[0], f"K{i}_GRID1": grid[1], f"K{i}_GRID2": grid[2]})
+            start += grid[0] * grid[1] * grid[2]
+        return args, (start, )
+
+    def __call__(self, *launches, **kwargs):
+        """Launches the fused kernel with `launches`, with the compilation options `kwargs`."""
+        args, grid = self._bind(launches)
+        return self.fn.run(grid=grid, warmup=False, **args, **kwargs)
+
+    def warmup(self, *launches, **kwargs):
+        """Compiles the fused kernel for `launches`, with the compilation options `kwargs`, without launching it."""
+        args, grid = self._bind(launches)
+        return self.fn.run(grid=grid, warmup=True, **args, **kwargs)
+
+
+def horizontal_fuse(fns):
+    """
+    Returns the `HorizontalFusion` of the JIT functions `fns`, which launches a launch of each as a single kernel.
+    """
+    return HorizontalFusion(fns)
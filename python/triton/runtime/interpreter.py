@@ -1,6 +1,11 @@
 import ast
 import textwrap
 import inspect
+import itertools
+import os
+import sys
+import threading
+from concurrent.futures import ThreadPoolExecutor
 from typing import Tuple
 
 import math
@@ -15,11 +20,77 @@ from .._C.libtriton import interpreter as _interpreter
 from .._C.libtriton import ir as _ir
 
 
+class _ElementwiseExpr:
+    """
+    A pending elementwise op, whose operands are numpy arrays or other pending ops. A chain of pending ops is
+    evaluated when its result is first needed, in blocks of rows, so that the intermediate results of the chain only
+    take a block instead of a numpy temporary of the full shape each.
+    """
+
+    # The number of elements of the blocks of rows
+    BLOCK_SIZE = 1 << 14
+    # Chains deeper than this are evaluated, which bounds the recursion of the evaluation
+    MAX_DEPTH = 16
+
+    def __init__(self, op, operands):
+        self.op = op
+        self.operands = [x.evaluate() if isinstance(x, _ElementwiseExpr) and x.depth >= self.MAX_DEPTH else x
+                         for x in operands]
+        self.shape = np.broadcast_shapes(*[_shape(x) for x in self.operands])
+        self.depth = 1 + max([x.depth for x in self.operands if isinstance(x, _ElementwiseExpr)], default=0)
+        self.value = None
+
+    def evaluate(self):
+        if self.value is not None:
+            return self.value
+        shape = self.shape
+        row_size = math.prod(shape[1:])
+        rows_per_block = self.BLOCK_SIZE // max(row_size, 1)
+        if len(shape) == 0 or rows_per_block >= shape[0] or rows_per_block == 0:
+            value = self.op(*[_evaluate(x) for x in self.operands])
+        else:
+            value = None
+            for start in range(0, shape[0], rows_per_block):
+                rows = slice(start, min(start + rows_per_block, shape[0]))
+                block = self._evaluate_rows(rows, shape, {})
+                if value is None:
+                    value = np.empty(shape, dtype=block.dtype)
+                value[rows] = block
+        self.value = value
+        # The operands are no longer needed once the value is known
+        self.operands = None
+        return value
+
+    def _evaluate_rows(self, rows, shape, cache):
+        # Operands broadcast along the rows are evaluated whole, others are evaluated on the rows of the block
+        def operand_rows(x):
+            x_shape = _shape(x)
+            if len(x_shape) != len(shape) or x_shape[0] != shape[0]:
+                return _evaluate(x)
+            if isinstance(x, np.ndarray):
+                return x[rows]
+            if x.value is not None:
+                return x.value[rows]
+            if id(x) not in cache:
+                cache[id(x)] = x._evaluate_rows(rows, shape, cache)
+            return cache[id(x)]
+
+        return self.op(*[operand_rows(x) for x in self.operands])
+
+
+def _evaluate(x):
+    return x.evaluate() if isinstance(x, _ElementwiseExpr) else x
+
+
+def _shape(x):
+    return x.shape if isinstance(x, _ElementwiseExpr) else np.shape(x)
+
+
 class TensorHandle:
 
     def __init__(self, data, dtype):
         '''
-            data: numpy array
+            data: numpy array, or the pending elementwise op computing it
             dtype: triton type, either pointer_type or scalar_type.
             we don't store block_type here because the shape information is already availale in the data field
             attr: a dictionary of attributes
@@ -28,6 +99,21 @@ class TensorHandle:
         self.dtype = dtype
         self.attr = {}
 
+    @property
+    def data(self):
+        if isinstance(self._data, _ElementwiseExpr):
+            self._data = self._data.evaluate()
+        return self._data
+
+    @data.setter
+    def data(self, data):
+        self._data = data
+
+    @staticmethod
+    def elementwise(op, dtype, *args):
+        """Returns the handle of the pending elementwise op `op` over the handles `args`."""
+        return TensorHandle(_ElementwiseExpr(op, [arg._data for arg in args]), dtype)
+
     def __bool__(self):
         return bool(self.data.all())
 
@@ -46,13 +132,23 @@ class TensorHandle:
 
 class BlockPointerHandle:
 
-    def __init__(self, base, shape, strides, offsets, tensor_shape, order):
+    def __init__(self, base, shape, strides, offsets, tensor_shape, order, page_table=None, page_size=None):
         self.base = base
         self.shape = shape
         self.strides = strides
         self.offsets = offsets
         self.tensor_shape = tensor_shape
         self.order = order
+        self.page_table = page_table
+        self.page_size = page_size
+
+    def _paged_rows(self, rows):
+        # Maps the rows of the paged tensor to the rows in memory through the page table.
+        in_tensor = np.logical_and(rows >= 0, rows < self.shape[0].data)
+        table_ptrs = (self.page_table.data + 4 * (rows // self.page_size)).astype(np.uint64)
+        pages = _interpreter.load(np.ascontiguousarray(table_ptrs), np.ascontiguousarray(in_tensor),
+                                  np.zeros(rows.shape, dtype=np.int32), np.int32)
+        return pages.astype(np.int64) * self.page_size + rows % self.page_size
 
     def materialize_pointers(self, boundary_check):
         dtype_tt = self.base.get_element_ty()
@@ -64,7 +160,8 @@ class BlockPointerHandle:
             bcast_dims = [1] * len(tensor_shape)
             bcast_dims[dim] = tensor_shape[dim]
             off = (self.offsets[dim].data + np.arange(tensor_shape[dim])).reshape(bcast_dims)
-            ptrs = ptrs + (n_bytes * off * self.strides[dim].data).astype(np.uint64)
+            mem_off = self._paged_rows(off) if dim == 0 and self.page_table is not None else off
+            ptrs = ptrs + (n_bytes * mem_off * self.strides[dim].data).astype(np.uint64)
             if dim in boundary_check:
                 masks = np.logical_and(masks, off < self.shape[dim].data)
         ptrs = TensorHandle(ptrs, self.base.dtype.scalar)
@@ -79,7 +176,7 @@ class InterpreterOptions:
     allow_fp8e4nv: bool = True
     allow_fp8e4b15: bool = True
     default_dot_input_precision: str = "tf32"
-    allowed_dot_input_precisions: Tuple[str] = ("tf32", "tf32x3", "ieee")
+    allowed_dot_input_precisions: Tuple[str] = ("tf32", "tf32x3", "ieee", "bf16x3", "bf16x6")
     max_num_imprecise_acc_default: int = 0
 
 
@@ -240,6 +337,12 @@ class InterpreterBuilder:
         self.options = InterpreterOptions()
         self.codegen_fns = {}
         self.codegen_fns["convert_custom_types"] = ExtraFunctions._convert_custom_types
+        # Program instances may run in parallel threads, each with its own grid index
+        self._thread_local = threading.local()
+
+    @property
+    def grid_idx(self):
+        return getattr(self._thread_local, "grid_idx", None)
 
     def set_grid_idx(self, x, y, z):
         if not x < self.grid_dim[0]:
@@ -248,10 +351,14 @@ class InterpreterBuilder:
             raise ValueError("y >= grid_dim[1]")
         if not z < self.grid_dim[2]:
             raise ValueError("z >= grid_dim[2]")
-        self.grid_idx = (x, y, z)
+        self._thread_local.grid_idx = (x, y, z)
+        self._thread_local.num_global_scratch = 0
 
     def set_grid_dim(self, nx, ny, nz):
         self.grid_dim = (nx, ny, nz)
+        # The global scratch buffers of the launch, in the order the program instances allocate them
+        self._global_scratch = []
+        self._global_scratch_lock = threading.Lock()
 
     # constants
 
@@ -360,6 +467,17 @@ class InterpreterBuilder:
     def create_get_num_programs(self, axis):
         return TensorHandle(np.array([self.grid_dim[axis]], dtype=np.int32), tl.int32)
 
+    def create_global_scratch_alloc(self, nbytes, alignment, ptr_ty):
+        # The k-th allocation of each program instance gets the k-th buffer of the launch
+        idx = self._thread_local.num_global_scratch
+        self._thread_local.num_global_scratch += 1
+        with self._global_scratch_lock:
+            if idx == len(self._global_scratch):
+                self._global_scratch.append(np.zeros(nbytes + alignment, dtype=np.uint8))
+            buffer = self._global_scratch[idx]
+        addr = -(-buffer.ctypes.data // alignment) * alignment
+        return TensorHandle(np.array([addr], dtype=np.uint64), ptr_ty)
+
     # memory ops
     def create_load(self, ptr, _0, _1, is_volatile):
         mask = TensorHandle(np.ones_like(ptr.data, dtype=bool), tl.int1)
@@ -381,6 +499,10 @@ class InterpreterBuilder:
     def create_masked_store(self, ptrs, value, mask, cache_modifier, eviction_policy):
         return _interpreter.store(ptrs.data, value.data, mask.data)
 
+    def create_prefetch(self, ptrs, mask):
+        # Prefetches are hints without effect on the values of the memory.
+        return None
+
     # casting ops
     def cast_impl(self, src, dst_type):
         src_element_type = src.dtype.scalar
@@ -411,7 +533,7 @@ class InterpreterBuilder:
 
     # binary operators
     def binary_op(self, lhs, rhs, op):
-        return TensorHandle(op(lhs.data, rhs.data), lhs.dtype.scalar)
+        return TensorHandle.elementwise(op, lhs.dtype.scalar, lhs, rhs)
 
     create_fadd = lambda self, lhs, rhs: self.binary_op(lhs, rhs, np.add)
     create_fmul = lambda self, lhs, rhs: self.binary_op(lhs, rhs, np.multiply)
@@ -492,17 +614,17 @@ class InterpreterBuilder:
 
     # ternary functions
     def ternary_op(self, lhs, rhs, other, op):
-        return TensorHandle(op(lhs.data, rhs.data, other.data), other.dtype.scalar)
+        return TensorHandle.elementwise(op, other.dtype.scalar, lhs, rhs, other)
 
     create_clampf = lambda self, arg, lo, hi, propagate_nans: self.ternary_op(arg, lo, hi, np.clip)
     create_select = lambda self, cond, lhs, rhs: self.ternary_op(cond, lhs, rhs, np.where)
 
     def create_fma(self, x, y, z):
-        return TensorHandle(x.data * y.data + z.data, z.dtype.scalar)
+        return TensorHandle.elementwise(lambda x, y, z: x * y + z, z.dtype.scalar, x, y, z)
 
     # unary functions
     def unary_op(self, arg, op):
-        return TensorHandle(op(arg.data), arg.dtype.scalar)
+        return TensorHandle.elementwise(op, arg.dtype.scalar, arg)
 
     def create_fabs(self, arg):
         # Mask out the sign bit based on the primitive length
@@ -539,7 +661,7 @@ class InterpreterBuilder:
     def create_trans(self, arg, perm):
         return TensorHandle(np.transpose(arg.data, perm), arg.dtype.scalar)
 
-    def create_dot(self, a, b, d, input_precision, max_num_imprecise_acc):
+    def create_dot(self, a, b, d, input_precision, max_num_imprecise_acc, k_extent=0):
         a_data = a.data
         b_data = b.data
         if (a.dtype.primitive_bitwidth == 8 and a.dtype.is_floating()) or \
@@ -548,11 +670,31 @@ class InterpreterBuilder:
             b_data = _convert_float(b_data, b.dtype, tl.float16, None).view(np.float16)
         return TensorHandle(np.matmul(a_data, b_data, dtype=d.data.dtype) + d.data, d.dtype.scalar)
 
+    def create_sparse_dot(self, a, b, d, a_meta):
+        # Scatter the kept elements of each group of 4 to their positions in the dense rows
+        M, half_k = a.data.shape
+        i = np.arange(half_k)
+        meta = a_meta.data.view(np.uint16)[:, i // 8].astype(np.int64)
+        pos = (meta >> (2 * (i % 8))) & 3
+        dense = np.zeros((M, 2 * half_k), dtype=a.data.dtype)
+        dense[np.arange(M)[:, None], 4 * (i // 2) + pos] = a.data
+        return self.create_dot(TensorHandle(dense, a.dtype.scalar), b, d, None, 0)
+
     def create_make_range(self, start, stop):
         return TensorHandle(np.arange(start, stop, dtype=np.int32), tl.int32)
 
-    def create_histogram(self, data, bins):
-        return TensorHandle(np.histogram(data.data, bins=bins, range=(0, bins))[0], tl.int32)
+    def create_histogram(self, data, bins, mask, weights):
+        values = data.data
+        weights_data = None if weights is None else weights.data
+        if mask is not None:
+            values = values[mask.data]
+            weights_data = None if weights_data is None else weights_data[mask.data]
+        dtype = tl.int32 if weights is None else weights.dtype.scalar
+        hist = np.histogram(values, bins=bins, range=(0, bins), weights=weights_data)[0]
+        return TensorHandle(hist.astype(_get_np_dtype(dtype)), dtype)
+
+    def create_gather(self, src, indices, axis):
+        return TensorHandle(np.take_along_axis(src.data, indices.data, axis=axis), src.dtype.scalar)
 
     # pointer arithmetic
 
@@ -651,12 +793,17 @@ class InterpreterBuilder:
         new_offsets = [offset.clone() for offset in offsets]
         return BlockPointerHandle(base, shape, strides, new_offsets, tensor_shape, order)
 
+    def create_make_paged_block_ptr(self, base, shape, strides, offsets, tensor_shape, order, page_table, page_size):
+        new_offsets = [offset.clone() for offset in offsets]
+        return BlockPointerHandle(base, shape, strides, new_offsets, tensor_shape, order, page_table, page_size)
+
     def create_advance(self, ptr, offsets):
         if len(ptr.offsets) != len(offsets):
             raise ValueError("len(ptr.offsets) != len(offsets)")
         # Create new offsets to avoid modifying the original
         new_offsets = [offset.clone() for offset in ptr.offsets]
-        ret = BlockPointerHandle(ptr.base, ptr.shape, ptr.strides, new_offsets, ptr.tensor_shape, ptr.order)
+        ret = BlockPointerHandle(ptr.base, ptr.shape, ptr.strides, new_offsets, ptr.tensor_shape, ptr.order,
+                                 ptr.page_table, ptr.page_size)
         for i in range(len(offsets)):
             ret.offsets[i].data += offsets[i].data
         return ret
@@ -833,9 +980,10 @@ class ReduceOps(ReduceScanOpIneterface):
 
 class ScanOps(ReduceScanOpIneterface):
 
-    def __init__(self, axis, combine_fn, reverse):
+    def __init__(self, axis, combine_fn, reverse, flags=None):
         super().__init__(axis, combine_fn)
         self.reverse = reverse
+        self.flags = flags
 
     def cumsum(self, input):
         return [self.to_tensor(np.cumsum(input.handle.data, axis=self.axis), dtype=input.dtype)]
@@ -850,12 +998,17 @@ class ScanOps(ReduceScanOpIneterface):
         for arg in input:
             input_data.append(arg.handle.data)
             output_data.append(np.zeros(shape, dtype=arg.handle.data.dtype))
+        flags = None
+        if self.flags is not None:
+            flags = np.broadcast_to(self.flags.handle.data, shape).astype(bool)
+            if self.reverse:
+                flags = np.flip(flags, axis=self.axis)
         # Scan on axis
         for i in range(input_data[0].size):
             # Recover index from i using shape
             index = np.unravel_index(i, shape)
             data = tuple(self.to_tensor(d[index], input[ii].dtype) for ii, d in enumerate(input_data))
-            if index[self.axis] == 0:
+            if index[self.axis] == 0 or (flags is not None and flags[index]):
                 # First element
                 for j in range(len(output_data)):
                     output_data[j][index] = data[j].handle.data.item()
@@ -880,7 +1033,9 @@ class ScanOps(ReduceScanOpIneterface):
                 new_input.append(self.to_tensor(np.flip(arg.handle.data, axis=self.axis), arg.dtype))
         else:
             new_input = input
-        if self.combine_fn == tl.standard._sum_combine:
+        if self.flags is not None:
+            ret = self.generic_scan(new_input)
+        elif self.combine_fn == tl.standard._sum_combine:
             ret = self.cumsum(new_input[0])
         elif self.combine_fn == tl.standard._prod_combine:
             ret = self.cumprod(new_input[0])
@@ -900,8 +1055,8 @@ def _patch_reduce_scan():
     def _new_reduce(input, axis, combine_fn, keep_dims=False, **kwargs):
         return ReduceOps(axis, combine_fn, keep_dims).apply(input)
 
-    def _new_scan(input, axis, combine_fn, reverse=False, **kwargs):
-        return ScanOps(axis, combine_fn, reverse).apply(input)
+    def _new_scan(input, axis, combine_fn, reverse=False, flags=None, **kwargs):
+        return ScanOps(axis, combine_fn, reverse, flags).apply(input)
 
     tl.reduce = _new_reduce
     tl.associative_scan = _new_scan
@@ -960,6 +1115,9 @@ def _patch_lang_core(lang):
             start, end = arg1, arg2
         return range(start, end, step)
 
+    def _new_persistent_range(num_tiles, **kwargs):
+        return range(interpreter_builder.grid_idx[0], num_tiles, interpreter_builder.grid_dim[0])
+
     def _new_static_assert(cond, msg=""):
         assert cond, msg
 
@@ -977,12 +1135,15 @@ def _patch_lang_core(lang):
 
     lang.range = _new_range
     lang.static_range = _new_range
+    lang.persistent_range = _new_persistent_range
     lang.static_assert = _new_static_assert
     lang.static_print = print
     lang.dtype.to_ir = _new_to_ir
     lang.multiple_of = partial(_set_attr, name="tt.divisiblity")
     lang.max_contiguous = partial(_set_attr, name="tt.contiguity")
     lang.max_constancy = partial(_set_attr, name="tt.constancy")
+    # The interpreter doesn't pipeline loops.
+    lang.pipeline_stage = lambda input, stage, _builder=None: input
 
     _patch_reduce_scan()
 
@@ -1028,6 +1189,16 @@ interpreter_builder = InterpreterBuilder()
 RESERVED_KWS = ["num_warps", "num_stages", "num_ctas", "enable_fp_fusion", "grid", "maxnreg"]
 
 
+def _get_num_threads():
+    # Run the program instances one after another under a debugger, which only traces the main thread
+    if sys.gettrace() is not None:
+        return 1
+    num_threads = os.getenv("TRITON_INTERPRET_NUM_THREADS")
+    if num_threads is not None:
+        return max(int(num_threads), 1)
+    return os.cpu_count() or 1
+
+
 class GridExecutor:
 
     def __init__(self, fn, arg_names, grid):
@@ -1084,12 +1255,23 @@ class GridExecutor:
         assert len(grid) <= 3, "grid must have at most 3 dimensions"
         grid = grid + (1, ) * (3 - len(grid))
         interpreter_builder.set_grid_dim(*grid)
+
+        def run_program(idx):
+            interpreter_builder.set_grid_idx(*idx)
+            self.fn(**args)
+
+        program_ids = itertools.product(range(grid[0]), range(grid[1]), range(grid[2]))
+        num_threads = _get_num_threads()
         try:
-            for x in range(grid[0]):
-                for y in range(grid[1]):
-                    for z in range(grid[2]):
-                        interpreter_builder.set_grid_idx(x, y, z)
-                        self.fn(**args)
+            if num_threads == 1 or math.prod(grid) == 1:
+                for idx in program_ids:
+                    run_program(idx)
+            else:
+                # Program instances are independent, and the loads, stores and atomics of the interpreter release
+                # the GIL, so they overlap across threads.
+                with ThreadPoolExecutor(max_workers=num_threads) as executor:
+                    for _ in executor.map(run_program, program_ids):
+                        pass
         except Exception as e:
             raise InterpreterError(repr(e)) from e
         # copy arguments back to propagate side-effects
@@ -1,15 +1,18 @@
 from __future__ import annotations, division
 import ast
+import bisect
 import hashlib
 import inspect
 import itertools
 import os
 import re
 import textwrap
+import threading
 from collections import defaultdict
-from functools import cached_property
+from functools import cached_property, lru_cache
 from typing import Callable, Generic, Iterable, Optional, TypeVar, Union, overload, Dict, Any, Tuple
 from ..runtime.driver import driver
+from ..runtime import manifest
 from types import ModuleType
 
 TRITON_MODULE = __name__[:-len(".runtime.jit")]
@@ -230,10 +233,17 @@ def _normalize_ty(ty) -> str:
 class KernelParam:
     """Represents a parameter (name plus metadata) to a @jit'ed function."""
 
-    def __init__(self, num: int, param: inspect.Parameter, do_not_specialize: bool):
+    def __init__(self, num: int, param: inspect.Parameter, do_not_specialize: bool,
+                 bucket: Optional[Tuple[int]] = None, alignments: Tuple[int] = ()):
         self.num = num
         self._param = param
-        self.do_not_specialize = do_not_specialize
+        # The sorted upper bounds of the buckets of the values of the parameter, which is specialized on the bucket
+        # of its value instead of its divisibility and equality to 1.
+        self.bucket = bucket
+        self.do_not_specialize = do_not_specialize or bucket is not None
+        # The sorted alignments above 16 that the parameter is also specialized on, the largest that its value (or
+        # the address of its data) is a multiple of.
+        self.alignments = alignments
 
     @cached_property
     def name(self):
@@ -264,6 +274,10 @@ class KernelParam:
     def is_const(self):
         return "const" in self.annotation and not self.is_constexpr
 
+    @cached_property
+    def is_restrict(self):
+        return "restrict" in self.annotation
+
     @property
     def default(self):
         return self._param.default
@@ -286,6 +300,33 @@ def compute_spec_key(v):
     return "N"
 
 
+def get_alignment(v, alignments):
+    """Returns the largest of the sorted `alignments` that `v`, or the address of its data, is a multiple of."""
+    if hasattr(v, "data_ptr"):
+        v = v.data_ptr()
+    elif not isinstance(v, int) or isinstance(v, bool):
+        return None
+    return next((alignment for alignment in reversed(alignments) if v % alignment == 0), None)
+
+
+def compute_alignment_key(v, alignments):
+    alignment = get_alignment(v, alignments)
+    return compute_spec_key(v) if alignment is None else "A%d" % alignment
+
+
+def compute_bucket_key(v, bounds):
+    return "B%d" % bisect.bisect_left(bounds, v)
+
+
+def bucket_range(v, bounds):
+    """
+    Returns the (min, max) bounds of the values in the bucket of `v`, where None is unbounded: the bucket of the
+    first of the sorted upper `bounds` that `v` doesn't exceed, or the one past the last bound.
+    """
+    i = bisect.bisect_left(bounds, v)
+    return (bounds[i - 1] + 1 if i > 0 else None, bounds[i] if i < len(bounds) else None)
+
+
 dtype2str = {}
 
 
@@ -367,7 +408,11 @@ def create_function_from_signature(sig, kparams):
             constexpr_vals.append(name)
         else:
             non_constexpr_vals.append(name)
-            if not kp.do_not_specialize:
+            if kp.bucket is not None:
+                specialisations.append('compute_bucket_key(%s, %r)' % (name, kp.bucket))
+            elif kp.alignments and not kp.do_not_specialize:
+                specialisations.append('compute_alignment_key(%s, %r)' % (name, kp.alignments))
+            elif not kp.do_not_specialize:
                 specialisations.append('compute_spec_key(%s)' % name)
             if kp.annotation_type:
                 signature_types.append('"%s"' % kp.annotation_type)
@@ -395,6 +440,8 @@ def create_function_from_signature(sig, kparams):
 
     func_namespace['mangle_type'] = mangle_type
     func_namespace['compute_spec_key'] = compute_spec_key
+    func_namespace['compute_bucket_key'] = compute_bucket_key
+    func_namespace['compute_alignment_key'] = compute_alignment_key
 
     # Execute the function string in func_namespace to create the function
     exec(func_body, func_namespace)
@@ -432,6 +479,19 @@ for v in list(type_canonicalisation_dict.values()):
     type_canonicalisation_dict[v] = v
 
 
+# The trees are only ever read, by the dependencies finder and the code
+# generators, so a source is parsed once and its tree is shared by the cache
+# key and the code generation of every specialization, and of every call site
+# of the function in other kernels.
+@lru_cache(maxsize=1024)
+def _parse_src(src):
+    tree = ast.parse(src)
+    assert isinstance(tree, ast.Module)
+    assert len(tree.body) == 1
+    assert isinstance(tree.body[0], ast.FunctionDef)
+    return tree
+
+
 class JITFunction(KernelInterface[T]):
     # Hook for inspecting compiled functions and modules
     cache_hook = None
@@ -487,9 +547,19 @@ class JITFunction(KernelInterface[T]):
             for param, arg in zip(self.params, args)
             if isinstance(arg, int) and not isinstance(arg, bool) and arg == 1 and not param.do_not_specialize
         }
+        value_ranges = {
+            param.num: bucket_range(arg, param.bucket)
+            for param, arg in zip(self.params, args)
+            if param.bucket is not None and isinstance(arg, int)
+        }
+        alignments = {
+            param.num: get_alignment(arg, param.alignments)
+            for param, arg in zip(self.params, args)
+            if param.alignments and not param.do_not_specialize and get_alignment(arg, param.alignments) is not None
+        }
         # folded equal_to_1 and None
         # TODO: method to collect all folded args
-        return AttrsDescriptor(tuple(divisible_by_16), tuple(equal_to_1))
+        return AttrsDescriptor(tuple(divisible_by_16), tuple(equal_to_1), value_ranges, alignments)
         # return _triton.code_gen.instance_descriptor(divisible_by_16,
         # equal_to_1)
 
@@ -567,13 +637,51 @@ class JITFunction(KernelInterface[T]):
         assert callable(hook)
         self.pre_run_hooks.append(hook)
 
+    def _add_to_cache(self, device, key, kernel, signature, constants, attrs, options):
+        self.cache[device][key] = kernel
+        if manifest.is_recording():
+            manifest.record(self, kernel.hash,
+                            serialize_specialization_data(self.fn.__name__, signature, constants, attrs, options, key))
+
+    def _compile_async(self, device, key, src, target, options):
+        """
+        Returns the kernel for `key` if its background compilation completed, otherwise starts it if needed and
+        returns None.  The kernel is added to the cache once compiled, so later calls pick it up.
+        """
+        with self.pending_lock:
+            # The compilation may have completed since the caller looked at the cache.
+            kernel = self.cache[device].get(key, None)
+            if kernel is not None:
+                return kernel
+            future = self.pending[device].get(key, None)
+            if future is None:
+                future = self.compile_pool().submit(self.compile, src, target=target, options=options.__dict__)
+                self.pending[device][key] = future
+
+                def on_done(future):
+                    # Failed compilations stay pending, so that the next call raises the error.
+                    if future.exception() is None:
+                        with self.pending_lock:
+                            self._add_to_cache(device, key, future.result(), src.signature, src.constants, src.attrs,
+                                               options)
+                            self.pending[device].pop(key, None)
+
+                future.add_done_callback(on_done)
+        if not future.done():
+            return None
+        # Raises the compilation error, if any.
+        return future.result()
+
     def create_binder(self):
         """
         Precompute as much as possible.
         """
-        from ..compiler import CompiledKernel, compile, ASTSource, make_backend
+        from ..compiler import AttrsDescriptor, CompiledKernel, compile, ASTSource, make_backend
+        from ..compiler.compiler import _get_compile_pool
+        self.AttrsDescriptor = AttrsDescriptor
         self.CompiledKernel = CompiledKernel
         self.compile = compile
+        self.compile_pool = _get_compile_pool
         self.ASTSource = ASTSource
         self.make_backend = make_backend
         self.binder = create_function_from_signature(self.signature, self.params)
@@ -587,6 +695,7 @@ class JITFunction(KernelInterface[T]):
         # parse options
         device = driver.active.get_current_device()
         stream = driver.active.get_current_stream(device)
+        call_kwargs = dict(kwargs)
         kwargs["debug"] = self.debug
 
         # Execute pre run hooks with args and kwargs
@@ -640,12 +749,33 @@ class JITFunction(KernelInterface[T]):
                 return None
             # compile the kernel
             src = self.ASTSource(self, signature, constants, configs[0])
-            kernel = self.compile(
-                src,
-                target=target,
-                options=options.__dict__,
-            )
-            self.cache[device][key] = kernel
+            if self.async_compile and not warmup:
+                kernel = self._compile_async(device, key, src, target, options)
+                if kernel is None:
+                    # Serve the call with the fallback until the kernel is ready.
+                    if callable(self.fallback):
+                        return self.fallback(*args, grid=grid, **call_kwargs)
+                    generic_key = "generic" + ''.join(sigvals) + str((constexpr_vals, excess_kwargs))
+                    kernel = self.cache[device].get(generic_key, None)
+                    if kernel is None:
+                        # No divisibility or equal-to-1 specialization, so that the
+                        # variant serves all the calls with the same types.
+                        generic_constants = {
+                            p.name: v
+                            for (v, p) in zip(bound_vals, self.params)
+                            if p.is_constexpr or v is None
+                        }
+                        generic_src = self.ASTSource(self, signature, generic_constants, self.AttrsDescriptor())
+                        kernel = self.compile(generic_src, target=target, options=options.__dict__)
+                        self._add_to_cache(device, generic_key, kernel, signature, generic_constants,
+                                           generic_src.attrs, options)
+            else:
+                kernel = self.compile(
+                    src,
+                    target=target,
+                    options=options.__dict__,
+                )
+                self._add_to_cache(device, key, kernel, signature, constants, configs[0], options)
 
         # Check that used global values have not changed.
         not_present = object()
@@ -674,8 +804,10 @@ class JITFunction(KernelInterface[T]):
         return kernel
 
     def __init__(self, fn, version=None, do_not_specialize=None, debug=None, noinline=None, repr=None,
-                 launch_metadata=None):
+                 launch_metadata=None, async_compile=False, fallback=None, buckets=None, alignments=None):
         do_not_specialize = do_not_specialize if do_not_specialize else []
+        buckets = buckets if buckets else {}
+        alignments = alignments if alignments else {}
 
         self.fn = fn
         self.module = fn.__module__
@@ -691,7 +823,20 @@ class JITFunction(KernelInterface[T]):
         self.params = []
         for i, param in enumerate(self.signature.parameters.values()):
             dns = do_not_specialize and (i in do_not_specialize or param.name in do_not_specialize)
-            self.params.append(KernelParam(i, param, dns))
+            bucket = buckets.get(param.name, buckets.get(i))
+            if bucket is not None:
+                bucket = tuple(bucket)
+                if not bucket or any(a >= b for a, b in zip(bucket, bucket[1:])):
+                    raise ValueError(f"The buckets of {param.name} must be strictly increasing upper bounds")
+            alignment = alignments.get(param.name, alignments.get(i, ()))
+            alignment = tuple([alignment] if isinstance(alignment, int) else alignment)
+            if any(a <= 16 or a & (a - 1) for a in alignment) or any(a >= b for a, b in zip(alignment, alignment[1:])):
+                raise ValueError(f"The alignments of {param.name} must be increasing powers of 2 above 16")
+            self.params.append(KernelParam(i, param, dns, bucket, alignment))
+            if bucket is not None and self.params[-1].is_constexpr:
+                raise ValueError(f"Constexpr parameter {param.name} can't be bucketed")
+            if alignment and (bucket is not None or self.params[-1].is_constexpr):
+                raise ValueError(f"Constexpr or bucketed parameter {param.name} can't be specialized on alignments")
 
         # function source code (without decorators)
         self.src = textwrap.dedent(inspect.getsource(fn))
@@ -700,6 +845,15 @@ class JITFunction(KernelInterface[T]):
         self.cache = defaultdict(dict)
         self.hash = None
 
+        # When `async_compile` is set, unseen specializations are compiled in the
+        # background while calls are served by `fallback`, or by a generic variant
+        # of the kernel if `fallback` is None.  `pending` holds the futures of the
+        # compilations in flight, by device and key.
+        self.async_compile = async_compile or os.environ.get("TRITON_ASYNC_COMPILE", "0") == "1"
+        self.fallback = fallback
+        self.pending = defaultdict(dict)
+        self.pending_lock = threading.RLock()
+
         # Map of global variables used by the function and any functions it
         # transitively calls, plus their values.  The values are collected when
         # the function is first compiled.  Then every time we run the function,
@@ -744,8 +898,29 @@ class JITFunction(KernelInterface[T]):
     def warmup(self, *args, grid, **kwargs):
         return self.run(grid=grid, warmup=True, *map(MockTensor.wrap_dtype, args), **kwargs)
 
-    def preload(self, specialization_data):
-        from ..compiler import AttrsDescriptor, compile, ASTSource
+    def bind(self, *args, grid, **kwargs):
+        """
+        Returns the compiled kernel of a launch over `grid` with `args` and `kwargs`, compiling it if needed, the
+        grid as a 3-tuple and the arguments the compiled kernel takes, so that the launch can be issued again
+        without binding the arguments, e.g. by a `LaunchBatch`.
+        """
+        kernel = self.run(grid=grid, warmup=True, *args, **kwargs)
+        if kernel is None:
+            raise RuntimeError(f"{self.fn.__name__} was not compiled, as the cache hook skipped its compilation")
+        bound_args, _, _, non_constexpr_vals, _ = self.binder(*args, **dict(kwargs, debug=self.debug))
+        if callable(grid):
+            grid = grid(bound_args)
+        grid = tuple(grid) + (1, ) * (3 - len(grid))
+        return kernel, grid, non_constexpr_vals
+
+    def preload(self, specialization_data, hash=None, archive=None):
+        """
+        Adds the kernel described by `specialization_data` to the cache.  If `hash` is the hash of a kernel in the
+        kernel archive `archive` or in the kernel cache, e.g. one recorded in a manifest, its binaries are loaded as
+        is; the kernel is compiled otherwise.
+        """
+        from ..compiler import AttrsDescriptor, CompiledKernel, compile, ASTSource
+        from .cache import get_cache_manager
         import json
         import triton.language as tl
         device = driver.active.get_current_device()
@@ -764,19 +939,27 @@ class JITFunction(KernelInterface[T]):
             for key, value in deserialized_obj['options'].items()
         }
         key = deserialized_obj['key']
-        kernel = compile(src, None, options)
+        kernel = None
+        if hash is not None and archive is not None:
+            kernel = archive.load_kernel(src, hash)
+        if hash is not None and kernel is None:
+            # Same metadata file name as `compile`.
+            metadata_filename = f"{src.name[:150]}.json"
+            metadata_group = get_cache_manager(hash).get_group(metadata_filename) or {}
+            if metadata_filename in metadata_group:
+                kernel = CompiledKernel(src, metadata_group, hash)
+        if kernel is None:
+            kernel = compile(src, None, options)
         self.cache[device][key] = kernel
+        if manifest.is_recording():
+            manifest.record(self, kernel.hash, specialization_data)
         return kernel
 
     # we do not parse `src` in the constructor because
     # the user might want to monkey-patch self.src dynamically.
     # Our unit tests do this, for example.
     def parse(self):
-        tree = ast.parse(self.src)
-        assert isinstance(tree, ast.Module)
-        assert len(tree.body) == 1
-        assert isinstance(tree.body[0], ast.FunctionDef)
-        return tree
+        return _parse_src(self.src)
 
     def __call__(self, *args, **kwargs):
         raise RuntimeError("Cannot call @triton.jit'd outside of the scope of a kernel")
@@ -811,6 +994,10 @@ def jit(
     do_not_specialize: Optional[Iterable[int]] = None,
     debug: Optional[bool] = None,
     noinline: Optional[bool] = None,
+    async_compile: bool = False,
+    fallback: Optional[Callable] = None,
+    buckets: Optional[Dict[Union[int, str], Iterable[int]]] = None,
+    alignments: Optional[Dict[Union[int, str], Union[int, Iterable[int]]]] = None,
 ) -> Callable[[T], JITFunction[T]]:
     ...
 
@@ -824,6 +1011,10 @@ def jit(
     do_not_specialize: Optional[Iterable[int]] = None,
     debug: Optional[bool] = None,
     noinline: Optional[bool] = None,
+    async_compile: bool = False,
+    fallback: Optional[Callable] = None,
+    buckets: Optional[Dict[Union[int, str], Iterable[int]]] = None,
+    alignments: Optional[Dict[Union[int, str], Union[int, Iterable[int]]]] = None,
 ) -> Union[JITFunction[T], Callable[[T], JITFunction[T]]]:
     """
     Decorator for JIT-compiling a function using the Triton compiler.
@@ -841,6 +1032,25 @@ def jit(
 
     :param fn: the function to be jit-compiled
     :type fn: Callable
+    :param async_compile: compile unseen specializations on a background thread, serving the calls with
+        :code:`fallback` in the meantime.  Also enabled by :code:`TRITON_ASYNC_COMPILE=1`.
+    :type async_compile: bool
+    :param fallback: called with the arguments of the kernel launch, including :code:`grid`, while its
+        specialization compiles.  If None, a variant of the kernel without divisibility specialization
+        is compiled once per signature and launched instead.
+    :type fallback: Callable, optional
+    :param buckets: the sorted upper bounds of the buckets of integer arguments, by name or index, e.g.
+        :code:`{"N": [128, 1024, 8192]}`.  Such an argument is specialized on the bucket of its value instead of its
+        divisibility by 16 and equality to 1, and the compiler knows the bounds of the bucket, so that the values of
+        a bucket share a kernel, e.g. the variable sequence lengths of a serving workload.  The values above the last
+        bound form the last bucket.
+    :type buckets: Dict[str, List[int]], optional
+    :param alignments: the alignments above 16, powers of 2, that pointer and integer arguments are also specialized
+        on, by name or index, e.g. :code:`{"A": 128, "stride_am": [32, 128]}`.  Such an argument is specialized on
+        the largest of its alignments that its value, or the address of its data, is a multiple of, which the compiler
+        knows as its divisibility, e.g. to vectorize its accesses or to use TMA without alignment fallbacks.  An
+        argument has at most one more specialization per alignment.
+    :type alignments: Dict[str, Union[int, List[int]]], optional
     """
 
     def decorator(fn: T) -> JITFunction[T]:
@@ -858,6 +1068,10 @@ def jit(
                 noinline=noinline,
                 repr=repr,
                 launch_metadata=launch_metadata,
+                async_compile=async_compile,
+                fallback=fallback,
+                buckets=buckets,
+                alignments=alignments,
             )
 
     if fn is not None:
@@ -0,0 +1,135 @@
+"""
+Manifests of the kernels compiled by a process, to load them on another host without compiling.
+
+    triton.runtime.manifest.start_recording()
+    ...  # run the workload
+    triton.runtime.manifest.save("kernels.json")
+
+    # On the new host, with the kernel cache (e.g. a remote one) holding the binaries:
+    triton.runtime.manifest.load("kernels.json")
+
+Loading resolves each kernel's `JITFunction` by module and name, and adds the cached binaries to it by hash,
+without parsing the kernel's source or running the compiler.  Kernels whose binaries are missing from the cache
+are compiled instead.  The binaries can also be shipped packed in a kernel archive, see `triton.runtime.archive`,
+which is mapped in memory rather than read file by file.
+
+Manifests also record the arguments autotuned kernels were tuned for, as shapes and dtypes, so that
+`python -m triton.tools.tune` can run the tunings ahead of time.
+"""
+import importlib
+import json
+import threading
+from concurrent.futures import ThreadPoolExecutor
+from typing import List, Optional
+
+_lock = threading.Lock()
+_entries: Optional[List[dict]] = None
+_tunings: List[dict] = []
+
+
+def start_recording():
+    """Starts recording the kernels compiled or preloaded by this process."""
+    global _entries
+    with _lock:
+        if _entries is None:
+            _entries = []
+
+
+def stop_recording() -> List[dict]:
+    """Stops recording and returns the recorded entries."""
+    global _entries, _tunings
+    with _lock:
+        entries, _entries = _entries or [], None
+        _tunings = []
+    return entries
+
+
+def is_recording() -> bool:
+    return _entries is not None
+
+
+def record(fn, hash: str, specialization_data: str):
+    entry = {
+        "module": fn.__module__,
+        "name": fn.__name__,
+        "hash": hash,
+        "specialization_data": specialization_data,
+    }
+    with _lock:
+        if _entries is not None:
+            _entries.append(entry)
+
+
+def is_plain_value(value) -> bool:
+    return value is None or isinstance(value, (bool, int, float, str))
+
+
+def describe_arg(arg) -> Optional[dict]:
+    """Describes a kernel argument as a JSON object, or returns None if it cannot be recreated from a description."""
+    if hasattr(arg, "data_ptr") and hasattr(arg, "stride"):
+        return {"shape": list(arg.shape), "stride": list(arg.stride()), "dtype": str(arg.dtype).split(".")[-1]}
+    if is_plain_value(arg):
+        return {"value": arg}
+    return None
+
+
+def record_tuning(fn, args: List[dict], kwargs: dict, grids: List[Optional[list]]):
+    """Records that the autotuned kernel `fn` was tuned for `args`, launching config `i` over `grids[i]`."""
+    entry = {
+        "module": fn.__module__,
+        "name": fn.__name__,
+        "args": args,
+        "kwargs": kwargs,
+        "grids": grids,
+    }
+    with _lock:
+        if _entries is not None:
+            _tunings.append(entry)
+
+
+def save(path: str):
+    """Writes the entries recorded so far to `path`; recording continues."""
+    with _lock:
+        entries = list(_entries or [])
+        tunings = list(_tunings)
+    with open(path, "w") as f:
+        json.dump({"kernels": entries, "autotune": tunings}, f)
+
+
+def resolve(module_name: str, name: str, cls=None):
+    """
+    Returns the kernel named `name` in module `module_name`, unwrapping heuristics and autotuners down to an
+    instance of `cls` (a `JITFunction` by default).
+    """
+    from .jit import JITFunction
+    cls = JITFunction if cls is None else cls
+    fn = getattr(importlib.import_module(module_name), name)
+    while not isinstance(fn, cls):
+        fn = fn.fn
+    return fn
+
+
+def load(path: str, max_workers: Optional[int] = None, archive: Optional[str] = None) -> int:
+    """
+    Adds the kernels of the manifest at `path` to the caches of their `JITFunction`s, for the current device, from
+    the kernel archive at `archive` if given, and else from the kernel cache.  Returns the number of kernels loaded.
+    """
+    with open(path) as f:
+        entries = json.load(f)["kernels"]
+    if archive is not None:
+        from .archive import Archive
+        archive = Archive(archive)
+    # Import the modules up front: importing is not thread-safe in general.
+    fns = {(e["module"], e["name"]): resolve(e["module"], e["name"]) for e in entries}
+
+    from .driver import driver
+    device = driver.active.get_current_device()
+
+    def load_entry(entry):
+        # The current device is per thread.
+        driver.active.set_current_device(device)
+        fn = fns[(entry["module"], entry["name"])]
+        return fn.preload(entry["specialization_data"], hash=entry["hash"], archive=archive)
+
+    with ThreadPoolExecutor(max_workers=max_workers) as pool:
+        return len(list(pool.map(load_entry, entries)))
@@ -0,0 +1,150 @@
+"""
+Multi-device auto-tuning: the configs benchmarked by the auto-tuner split among all the visible GPUs of the same
+model as the current one, with one worker process per GPU,
+
+    TRITON_AUTOTUNE_MULTI_DEVICE=1 python -m triton.tools.tune kernels.json
+
+The workers import the module of the auto-tuned kernel, which must thus be defined at the top level of a module,
+copy the arguments to their GPU and benchmark their share of the configs.  If :code:`TRITON_AUTOTUNE_GPU_CLOCKS` is
+set to the SM and memory clocks in MHz, e.g. :code:`"1350,1215"`, the workers lock the clocks of their GPU with
+:code:`triton.testing.set_gpu_clock` while benchmarking, so that the timings measured on different GPUs compare.
+"""
+import contextlib
+import importlib
+import multiprocessing
+import os
+import warnings
+from concurrent.futures import ProcessPoolExecutor
+
+_pools = {}
+# The device of a worker process.
+_device = None
+
+
+def get_devices():
+    """Returns the visible devices of the same model as the current one."""
+    import torch
+    name = torch.cuda.get_device_name(torch.cuda.current_device())
+    return [device for device in range(torch.cuda.device_count()) if torch.cuda.get_device_name(device) == name]
+
+
+def parse_clocks(clocks):
+    """Returns the SM and memory clocks of :code:`"<sm>,<mem>"`, or None if `clocks` is empty."""
+    if not clocks:
+        return None
+    sm_clock, mem_clock = (int(clock) for clock in clocks.split(","))
+    return sm_clock, mem_clock
+
+
+def _resolve(module, qualname):
+    from .autotuner import Autotuner
+    obj = importlib.import_module(module)
+    for name in qualname.split("."):
+        obj = getattr(obj, name, None)
+    # The auto-tuner may be wrapped, e.g. by `triton.heuristics`.
+    while obj is not None and not isinstance(obj, Autotuner):
+        obj = getattr(obj, "fn", None)
+    return obj
+
+
+def _kernel_ref(tuner):
+    """Returns how the workers find `tuner`, or None if it isn't defined at the top level of a module."""
+    module, qualname = tuner.base_fn.__module__, tuner.base_fn.__qualname__
+    if "<locals>" in qualname:
+        return None
+    try:
+        return (module, qualname) if _resolve(module, qualname) is tuner else None
+    except ImportError:
+        return None
+
+
+def _smi_id(device):
+    """Returns how nvidia-smi names `device`, which CUDA_VISIBLE_DEVICES may renumber."""
+    visible = os.getenv("CUDA_VISIBLE_DEVICES")
+    return visible.split(",")[device].strip() if visible else str(device)
+
+
+def _init_worker(devices):
+    global _device
+    import torch
+    _device = devices.get()
+    torch.cuda.set_device(_device)
+
+
+def _bench_worker(kernel, args, kwargs, configs, budget, clocks):
+    import torch
+    from ..testing import set_gpu_clock
+    tuner = _resolve(*kernel)
+    device = torch.device("cuda", _device)
+
+    def to_device(arg):
+        return arg.to(device) if isinstance(arg, torch.Tensor) else arg
+
+    args = [to_device(arg) for arg in args]
+    kwargs = {name: to_device(arg) for name, arg in kwargs.items()}
+    tuner.nargs = dict(zip(tuner.arg_names, args))
+    with contextlib.ExitStack() as stack:
+        if clocks is not None:
+            stack.enter_context(set_gpu_clock(*clocks, device=_smi_id(_device)))
+        timings = []
+        for config, grid in configs:
+            config = tuner.configs[config] if isinstance(config, int) else config
+            timings.append(tuner._bench(*args, config=config, budget=budget, **dict(kwargs, grid=grid)))
+    tuner.nargs = None
+    return timings
+
+
+def _get_pool(devices):
+    if devices not in _pools:
+        # CUDA can't be used in forked processes once initialized.
+        context = multiprocessing.get_context("spawn")
+        queue = context.Queue()
+        for device in devices:
+            queue.put(device)
+        _pools[devices] = ProcessPoolExecutor(len(devices), mp_context=context, initializer=_init_worker,
+                                              initargs=(queue, ))
+    return _pools[devices]
+
+
+def bench_on_devices(tuner, configs, args, kwargs, budget, clocks):
+    """
+    Returns the timings of `configs` benchmarked by `tuner` on all the devices returned by `get_devices`, or None if
+    they can't be benchmarked there: if there is a single device or the workers can't import the kernel.
+    """
+    import torch
+    devices = tuple(get_devices())
+    if len(devices) < 2:
+        return None
+    kernel = _kernel_ref(tuner)
+    if kernel is None:
+        warnings.warn(f"{tuner.base_fn.__name__} is tuned on the current device only, as it isn't defined at the "
+                      "top level of a module")
+        return None
+
+    def to_cpu(arg):
+        return arg.cpu() if isinstance(arg, torch.Tensor) else arg
+
+    cpu_args = [to_cpu(arg) for arg in args]
+    cpu_kwargs = {name: to_cpu(arg) for name, arg in kwargs.items() if name != "grid"}
+    # The workers are given the configs of the auto-tuner by index, and the grid of each config, as grid functions
+    # are usually lambdas, which can't be sent to other processes.
+    indices = {id(config): i for i, config in enumerate(tuner.configs)}
+    grid = kwargs.get("grid")
+    work = []
+    for config in configs:
+        launch_grid = grid
+        if callable(grid):
+            launch_grid = tuple(grid({**tuner.nargs, **kwargs, **config.all_kwargs()}))
+        work.append((indices.get(id(config), config), launch_grid))
+    # The configs are dealt round robin, as they are often sorted by size.
+    pool = _get_pool(devices)
+    futures = []
+    for first in range(min(len(devices), len(configs))):
+        chunk = list(range(first, len(configs), len(devices)))
+        futures.append((chunk, pool.submit(_bench_worker, kernel, cpu_args, cpu_kwargs, [work[i] for i in chunk],
+                                           budget, clocks)))
+    timings = [None] * len(configs)
+    for chunk, future in futures:
+        for i, timing in zip(chunk, future.result()):
+            timings[i] = timing
+    return timings
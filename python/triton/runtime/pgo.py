@@ -0,0 +1,139 @@
+"""
+Profile-guided tuning: the timings of the configs benchmarked by the auto-tuner, recorded per kernel, device and
+tuning key into the profile file named by :code:`TRITON_PGO_PROFILE`,
+
+    TRITON_PGO_PROFILE=profile.json python train.py
+
+Later runs with the same profile take the best config of a recorded key without benchmarking, and tune the other
+keys starting from the configs that were the fastest for the nearest recorded key, e.g. the nearest shape.  With
+:code:`TRITON_PGO_TOP_K` set, they only benchmark that many of those configs.  The profile is a JSON file, which can
+be shipped with a model so that it is not tuned again on the devices it was recorded on.
+"""
+import json
+import math
+import os
+import tempfile
+import threading
+
+_profiles = {}
+_profiles_lock = threading.Lock()
+
+
+def get_profile():
+    """Returns the profile named by :code:`TRITON_PGO_PROFILE`, or None if it isn't set."""
+    path = os.getenv("TRITON_PGO_PROFILE")
+    if not path:
+        return None
+    path = os.path.abspath(path)
+    with _profiles_lock:
+        if path not in _profiles:
+            _profiles[path] = Profile(path)
+        return _profiles[path]
+
+
+def _normalize(value):
+    """Returns `value` as read back from JSON, or None if it can't be serialized."""
+    try:
+        return json.loads(json.dumps(value))
+    except (TypeError, ValueError):
+        return None
+
+
+def _key_distance(key, other):
+    """
+    Returns the distance between two tuning keys, in the space of the logarithms of their numeric elements, or None
+    if they differ in other elements, e.g. the data types.
+    """
+    if len(key) != len(other):
+        return None
+    distance = 0.0
+    for a, b in zip(key, other):
+        numeric = (isinstance(a, (int, float)) and not isinstance(a, bool) and isinstance(b, (int, float))
+                   and not isinstance(b, bool))
+        if not numeric:
+            if a != b:
+                return None
+            continue
+        distance += abs(math.log2(1 + abs(a)) - math.log2(1 + abs(b)))
+    return distance
+
+
+class Profile:
+    """
+    The measurements of a profile file: the median times in milliseconds of configs, as the JSON of their
+    :code:`all_kwargs()`, by kernel, device and tuning key.
+    """
+
+    def __init__(self, path):
+        self.path = path
+        self.lock = threading.Lock()
+        # {(kernel, device): [(key, {config: time})]}
+        self.measurements = {}
+        self._load()
+
+    def _load(self):
+        try:
+            with open(self.path) as f:
+                data = json.load(f)
+        except FileNotFoundError:
+            return
+        for entry in data.get("measurements", []):
+            self._merge(entry["kernel"], entry["device"], entry["key"], entry["timings"])
+
+    def _merge(self, kernel, device, key, timings):
+        keys = self.measurements.setdefault((kernel, device), [])
+        for recorded_key, recorded in keys:
+            if recorded_key == key:
+                recorded.update(timings)
+                return
+        keys.append((key, dict(timings)))
+
+    def record(self, kernel, device, key, timings):
+        """
+        Records the times `timings` of configs, by their :code:`all_kwargs()`, for the tuning key `key`, and writes
+        the profile.  Configs that can't be serialized and those that failed are left out.
+        """
+        key = _normalize(list(key))
+        if key is None:
+            return
+        serialized = {}
+        for kwargs, time in timings:
+            config = _normalize(kwargs)
+            if config is not None and math.isfinite(time):
+                serialized[json.dumps(config, sort_keys=True)] = time
+        if not serialized:
+            return
+        with self.lock:
+            self._merge(kernel, device, key, serialized)
+            self._save()
+
+    def _save(self):
+        entries = []
+        for (kernel, device), keys in self.measurements.items():
+            for key, timings in keys:
+                entries.append({"kernel": kernel, "device": device, "key": key, "timings": timings})
+        directory = os.path.dirname(self.path) or "."
+        os.makedirs(directory, exist_ok=True)
+        # Replace the file at once, so that concurrent runs never read a partial profile.
+        fd, tmp_path = tempfile.mkstemp(dir=directory, suffix=".tmp")
+        with os.fdopen(fd, "w") as f:
+            json.dump({"version": 1, "measurements": entries}, f, indent=1)
+        os.replace(tmp_path, self.path)
+
+    def timings(self, kernel, device, key, exact=True):
+        """
+        Returns the recorded times of the configs, by the JSON of their :code:`all_kwargs()`, for `key` or, unless
+        `exact`, for the nearest recorded key if `key` has none.  Returns an empty dict if there are none.
+        """
+        key = _normalize(list(key))
+        if key is None:
+            return {}
+        with self.lock:
+            nearest, nearest_distance = {}, None
+            for recorded_key, timings in self.measurements.get((kernel, device), []):
+                distance = _key_distance(key, recorded_key)
+                if distance is None or (exact and distance > 0):
+                    continue
+                if nearest_distance is None or distance < nearest_distance:
+                    nearest, nearest_distance = timings, distance
+            return dict(nearest)
@@ -5,11 +5,12 @@ import sys
 from contextlib import contextmanager
 from typing import Any, Dict, List
 from . import language as tl
+from .runtime.jit import jit
 
 
-def nvsmi(attrs):
+def nvsmi(attrs, device=0):
     attrs = ','.join(attrs)
-    cmd = ['nvidia-smi', '-i', '0', '--query-gpu=' + attrs, '--format=csv,noheader,nounits']
+    cmd = ['nvidia-smi', '-i', str(device), '--query-gpu=' + attrs, '--format=csv,noheader,nounits']
     out = subprocess.check_output(cmd)
     ret = out.decode(sys.stdout.encoding).split(',')
     ret = [int(x) for x in ret]
@@ -81,7 +82,40 @@ def do_bench_cudagraph(fn, rep=20, grad_to_none=None, return_mode="mean"):
     return getattr(torch, return_mode)(times).item()
 
 
-def do_bench(fn, warmup=25, rep=100, grad_to_none=None, quantiles=None, fast_flush=True, return_mode="mean"):
+def _device_times_cupti(fn, n_repeat, before_each):
+    """
+    Runs `fn` `n_repeat` times under Proton's CUPTI profiler and returns the device time of the kernels of each run,
+    in ms, excluding the launch overheads and gaps between kernels.
+    """
+    import json
+    import tempfile
+    import torch
+    import triton.profiler as proton
+
+    with tempfile.TemporaryDirectory() as tmpdir:
+        name = os.path.join(tmpdir, "do_bench")
+        session = proton.start(name, backend="cupti")
+        if session is None:
+            raise RuntimeError("timer='cupti' cannot be used while running under the proton command")
+        # Each run gets its own scope so that its kernels are accounted separately.
+        for i in range(n_repeat):
+            before_each()
+            with proton.scope(f"rep{i}"):
+                fn()
+        torch.cuda.synchronize()
+        proton.finalize(session)
+        with open(name + ".hatchet") as f:
+            tree = json.load(f)[0]
+
+    def device_ns(node):
+        return node["metrics"].get("Time (ns)", 0) + sum(device_ns(child) for child in node["children"])
+
+    times = {child["frame"]["name"]: device_ns(child) for child in tree["children"]}
+    return torch.tensor([times.get(f"rep{i}", 0) * 1e-6 for i in range(n_repeat)], dtype=torch.float)
+
+
+def do_bench(fn, warmup=25, rep=100, grad_to_none=None, quantiles=None, fast_flush=True, return_mode="mean",
+             timer="events", l2_cache="cold"):
     """
     Benchmark the runtime of the provided function. By default, return the median runtime of :code:`fn` along with
     the 20-th and 80-th performance percentile.
@@ -100,8 +134,17 @@ def do_bench(fn, warmup=25, rep=100, grad_to_none=None, quantiles=None, fast_flu
     :type fast_flush: bool, default is True
     :param return_mode: The statistical measure to return. Options are "min", "max", "mean", or "median". Default is "mean".
     :type return_mode: str
+    :param timer: How runs are timed: "events" records CUDA events around each run, which includes launch
+        overheads, and "cupti" sums the device durations of the kernels of each run from CUPTI activity records
+        (through Proton), which is less noisy for kernels of a few microseconds.  Default is "events".
+    :type timer: str
+    :param l2_cache: "cold" flushes the L2 cache before each run, so that inputs come from DRAM, and "warm" leaves
+        it as the previous run left it, so that inputs that fit are read from L2.  Default is "cold".
+    :type l2_cache: str
     """
     assert return_mode in ["min", "max", "mean", "median"]
+    assert timer in ["events", "cupti"]
+    assert l2_cache in ["cold", "warm"]
     import torch
 
     fn()
@@ -111,17 +154,31 @@ def do_bench(fn, warmup=25, rep=100, grad_to_none=None, quantiles=None, fast_flu
     # before each kernel call to make sure that the L2 cache
     # doesn't contain any input data before the run
     cache_size = 256 * 1024 * 1024
-    if fast_flush:
+    if l2_cache == "warm":
+        cache = None
+    elif fast_flush:
         cache = torch.empty(int(cache_size // 4), dtype=torch.int, device='cuda')
     else:
         cache = torch.empty(int(cache_size), dtype=torch.int8, device='cuda')
 
+    def before_each():
+        # we don't want `fn` to accumulate gradient values
+        # if it contains a backward pass. So we clear the
+        # provided gradients
+        if grad_to_none is not None:
+            for x in grad_to_none:
+                x.grad = None
+        # we clear the L2 cache before each run
+        if cache is not None:
+            cache.zero_()
+
     # Estimate the runtime of the function
     start_event = torch.cuda.Event(enable_timing=True)
     end_event = torch.cuda.Event(enable_timing=True)
     start_event.record()
     for _ in range(5):
-        cache.zero_()
+        if cache is not None:
+            cache.zero_()
         fn()
     end_event.record()
     torch.cuda.synchronize()
@@ -130,34 +187,173 @@ def do_bench(fn, warmup=25, rep=100, grad_to_none=None, quantiles=None, fast_flu
     # compute number of warmup and repeat
     n_warmup = max(1, int(warmup / estimate_ms))
     n_repeat = max(1, int(rep / estimate_ms))
-    start_event = [torch.cuda.Event(enable_timing=True) for i in range(n_repeat)]
-    end_event = [torch.cuda.Event(enable_timing=True) for i in range(n_repeat)]
     # Warm-up
     for _ in range(n_warmup):
         fn()
     # Benchmark
-    for i in range(n_repeat):
-        # we don't want `fn` to accumulate gradient values
-        # if it contains a backward pass. So we clear the
-        # provided gradients
+    if timer == "cupti":
+        times = _device_times_cupti(fn, n_repeat, before_each)
+    else:
+        start_event = [torch.cuda.Event(enable_timing=True) for i in range(n_repeat)]
+        end_event = [torch.cuda.Event(enable_timing=True) for i in range(n_repeat)]
+        for i in range(n_repeat):
+            before_each()
+            # record time of `fn`
+            start_event[i].record()
+            fn()
+            end_event[i].record()
+        # Record clocks
+        torch.cuda.synchronize()
+        times = torch.tensor([s.elapsed_time(e) for s, e in zip(start_event, end_event)], dtype=torch.float)
+    if quantiles is not None:
+        ret = torch.quantile(times, torch.tensor(quantiles, dtype=torch.float)).tolist()
+        if len(ret) == 1:
+            ret = ret[0]
+        return ret
+    return getattr(torch, return_mode)(times).item()
+
+
+@jit
+def _interference_kernel(src, dst, n, BLOCK: tl.constexpr):
+    # A persistent copy, like the kernels of NCCL collectives: its few programs stay resident on their SMs while
+    # they stream `src` to `dst`.
+    pid = tl.program_id(0)
+    num_programs = tl.num_programs(0)
+    for start in range(pid * BLOCK, n, num_programs * BLOCK):
+        offs = start + tl.arange(0, BLOCK)
+        mask = offs < n
+        tl.store(dst + offs, tl.load(src + offs, mask=mask), mask=mask)
+
+
+def do_bench_interference(fn, interference="memory", warmup=25, rep=100, grad_to_none=None, return_mode="mean",
+                          num_streams=2, sm_fraction=0.125):
+    """
+    Benchmark the runtime of the provided function while other work shares the GPU, as it does in production
+    next to communication kernels and other streams. Configs picked in isolation by :code:`do_bench` aren't always
+    the best under contention.
+
+    .. highlight:: python
+    .. code-block:: python
+
+        res = triton.testing.do_bench_interference(lambda: matmul(a, b), interference="nccl", sm_fraction=0.25)
+        print(res["ms"], res["slowdown"])
+
+    :param fn: Function to benchmark
+    :type fn: Callable
+    :param interference: The work co-running with :code:`fn` on other streams: "memory" copies a 256 MB buffer
+        over and over with all the SMs to hog the DRAM bandwidth, "nccl" runs a persistent copy kernel on
+        :code:`sm_fraction` of the SMs like the kernels of NCCL collectives, and "self" runs copies of :code:`fn`
+        itself on :code:`num_streams - 1` more streams. Default is "memory".
+    :type interference: str
+    :param warmup: Warmup time (in ms)
+    :type warmup: int
+    :param rep: Repetition time (in ms)
+    :type rep: int
+    :param grad_to_none: Reset the gradient of the provided tensor to None
+    :type grad_to_none: torch.tensor, optional
+    :param return_mode: The statistical measure of the runtimes. Options are "min", "max", "mean", or "median".
+        Default is "mean".
+    :type return_mode: str
+    :param num_streams: The number of streams running :code:`fn` at once with "self". Default is 2.
+    :type num_streams: int
+    :param sm_fraction: The fraction of the SMs taken by the kernel of "nccl". Default is 0.125.
+    :type sm_fraction: float
+    :return: A dict with the runtime of :code:`fn` in isolation ("isolated_ms") and under interference ("ms"),
+        their ratio ("slowdown"), which tells how sensitive :code:`fn` is to sharing the SMs and the DRAM
+        bandwidth, and the runs of :code:`fn` per second under interference ("throughput"), summed over all the
+        streams with "self". Both runtimes are measured with a warm L2 cache, as the interference evicts it anyway.
+    """
+    assert interference in ["memory", "nccl", "self"]
+    assert return_mode in ["min", "max", "mean", "median"]
+    assert interference != "self" or num_streams >= 2
+    import torch
+
+    from .runtime import driver
+
+    isolated_ms = do_bench(fn, warmup=warmup, rep=rep, grad_to_none=grad_to_none, return_mode=return_mode,
+                           l2_cache="warm")
+    n_warmup = max(1, int(warmup / isolated_ms))
+    n_repeat = max(1, int(rep / isolated_ms))
+
+    if interference == "self":
+        streams = [torch.cuda.Stream() for _ in range(num_streams - 1)]
+        interfere = fn
+    else:
+        streams = [torch.cuda.Stream()]
+        src = torch.empty(64 * 1024 * 1024, dtype=torch.int, device="cuda")
+        dst = torch.empty_like(src)
+        if interference == "memory":
+
+            def interfere():
+                dst.copy_(src)
+        else:
+            num_sms = driver.active.utils.get_device_properties(src.device.index)["multiprocessor_count"]
+            grid = (max(1, round(sm_fraction * num_sms)), )
+
+            def interfere():
+                _interference_kernel[grid](src, dst, src.numel(), BLOCK=4096)
+
+    # Estimate the runtime of the interference, which also compiles its kernel
+    start_event = torch.cuda.Event(enable_timing=True)
+    end_event = torch.cuda.Event(enable_timing=True)
+    with torch.cuda.stream(streams[0]):
+        interfere()
+        start_event.record()
+        for _ in range(3):
+            interfere()
+        end_event.record()
+    torch.cuda.synchronize()
+    interfere_ms = start_event.elapsed_time(end_event) / 3
+
+    # The interference is queued along with the runs of `fn`, as much ahead of them as they take in isolation,
+    # so that the side streams are busy for as long as they run without being flooded with launches.
+    queued_ms, queued_runs = 0.0, 0
+
+    def keep_busy(until_ms):
+        nonlocal queued_ms, queued_runs
+        while queued_ms < until_ms:
+            for stream in streams:
+                with torch.cuda.stream(stream):
+                    interfere()
+            queued_ms += interfere_ms
+            queued_runs += len(streams)
+
+    def before_each():
         if grad_to_none is not None:
             for x in grad_to_none:
                 x.grad = None
-        # we clear the L2 cache before each run
-        cache.zero_()
-        # record time of `fn`
+
+    # Warm-up
+    keep_busy(isolated_ms)
+    for i in range(n_warmup):
+        keep_busy((i + 2) * isolated_ms)
+        fn()
+    # Benchmark
+    start_event = [torch.cuda.Event(enable_timing=True) for i in range(n_repeat)]
+    end_event = [torch.cuda.Event(enable_timing=True) for i in range(n_repeat)]
+    wall_start, wall_end = torch.cuda.Event(enable_timing=True), torch.cuda.Event(enable_timing=True)
+    first_ms, first_runs = queued_ms, queued_runs
+    wall_start.record()
+    for i in range(n_repeat):
+        keep_busy(first_ms + (i + 2) * isolated_ms)
+        before_each()
         start_event[i].record()
         fn()
         end_event[i].record()
-    # Record clocks
+    # With "self", the runs of the side streams count towards the throughput, so the wall time lasts until the
+    # last of them.
+    if interference == "self":
+        for stream in streams:
+            torch.cuda.current_stream().wait_stream(stream)
+    wall_end.record()
     torch.cuda.synchronize()
     times = torch.tensor([s.elapsed_time(e) for s, e in zip(start_event, end_event)], dtype=torch.float)
-    if quantiles is not None:
-        ret = torch.quantile(times, torch.tensor(quantiles, dtype=torch.float)).tolist()
-        if len(ret) == 1:
-            ret = ret[0]
-        return ret
-    return getattr(torch, return_mode)(times).item()
+    ms = getattr(torch, return_mode)(times).item()
+    if interference == "self":
+        throughput = (n_repeat + queued_runs - first_runs) / wall_start.elapsed_time(wall_end) * 1e3
+    else:
+        throughput = 1e3 / ms
+    return {"isolated_ms": isolated_ms, "ms": ms, "slowdown": ms / isolated_ms, "throughput": throughput}
 
 
 def assert_close(x, y, atol=None, rtol=None, err_msg=''):
@@ -458,32 +654,38 @@ def cuda_memcheck(**target_kwargs):
 
 
 @contextmanager
-def set_gpu_clock(ref_sm_clock=1350, ref_mem_clock=1215):
+def set_gpu_clock(ref_sm_clock=1350, ref_mem_clock=1215, device=0):
+    """
+    Locks the SM and memory clocks of a GPU to the given values (in MHz) for the duration of the context.
+
+    :param device: the index or UUID of the GPU, as numbered by nvidia-smi.
+    """
+    device = str(device)
     try:
-        subprocess.check_output(["nvidia-smi", "-i", "0", "-pm", "1"])
+        subprocess.check_output(["nvidia-smi", "-i", device, "-pm", "1"])
         subprocess.check_output([
             "nvidia-smi",
             "-i",
-            "0",
+            device,
             f"--lock-gpu-clocks={ref_sm_clock},{ref_sm_clock}",
         ])
         subprocess.check_output([
             "nvidia-smi",
             "-i",
-            "0",
+            device,
             f"--lock-memory-clocks={ref_mem_clock},{ref_mem_clock}",
         ])
-        cur_sm_clock = nvsmi(["clocks.current.sm"])[0]
-        cur_mem_clock = nvsmi(["clocks.current.memory"])[0]
+        cur_sm_clock = nvsmi(["clocks.current.sm"], device)[0]
+        cur_mem_clock = nvsmi(["clocks.current.memory"], device)[0]
         assert abs(cur_sm_clock - ref_sm_clock) < 10, f"GPU SMs must run at {ref_sm_clock} MHz"
         assert abs(cur_mem_clock - ref_mem_clock) < 10, f"GPU SMs must run at {ref_mem_clock} MHz"
         tflops = 1e-6 * 2 * 108 * 4 * 256 * ref_sm_clock
         gbps = 640 * 2 * ref_mem_clock * 1e-3
         yield tflops, gbps
     finally:
-        subprocess.check_output(["nvidia-smi", "-i", "0", "-pm", "0"])
-        subprocess.check_output(["nvidia-smi", "-i", "0", "-rgc"])
-        subprocess.check_output(["nvidia-smi", "-i", "0", "-rmc"])
+        subprocess.check_output(["nvidia-smi", "-i", device, "-pm", "0"])
+        subprocess.check_output(["nvidia-smi", "-i", device, "-rgc"])
+        subprocess.check_output(["nvidia-smi", "-i", device, "-rmc"])
 
 
 def get_max_simd_tflops(dtype, clock_rate, device=None):
@@ -511,3 +713,128 @@ def get_max_simd_tflops(dtype, clock_rate, device=None):
             raise RuntimeError("dtype not supported")
     tflops = num_subcores * clock_rate * ops_per_sub_core * 1e-9
     return tflops
+
+
+class RooflineSuite:
+    """
+    A suite of benchmarks reporting how close each kernel gets to the roofline of the device, i.e. to the
+    throughput bound by its peak compute throughput and DRAM bandwidth given its arithmetic intensity.
+
+    .. highlight:: python
+    .. code-block:: python
+
+        suite = triton.testing.RooflineSuite("matmul")
+        for M, N, K in [(4096, 4096, 4096), (8192, 512, 8192)]:
+            a = torch.randn((M, K), device="cuda", dtype=torch.float16)
+            b = torch.randn((K, N), device="cuda", dtype=torch.float16)
+            suite.add(f"matmul-{M}x{N}x{K}", lambda: matmul(a, b), flops=2 * M * N * K,
+                      nbytes=2 * (M * K + K * N + M * N), dtype=torch.float16)
+        results = suite.run()
+        suite.save(results, "perf.json")
+        regressions = suite.compare(results, "baseline.json")
+
+    Results are stored in JSON files mapping a commit to the results measured on it, so that a file can track a
+    suite across revisions of Triton.
+    """
+
+    def __init__(self, name: str, warmup=25, rep=100):
+        self.name = name
+        self.warmup = warmup
+        self.rep = rep
+        self.cases = []
+
+    def add(self, name: str, fn, flops: int, nbytes: int, dtype=None, tensorcore=True):
+        """
+        Adds a benchmark of `fn`, which performs `flops` operations of type `dtype` while moving `nbytes` bytes
+        to or from DRAM.  The peak compute throughput is that of tensor cores if `tensorcore` is true, and of the
+        SIMD units otherwise.
+        """
+        self.cases.append((name, fn, flops, nbytes, dtype, tensorcore))
+
+    @staticmethod
+    def roofline_tflops(flops, nbytes, dtype, tensorcore=True, device=None):
+        """Returns the throughput in TFLOP/s attainable by a kernel of the given arithmetic intensity."""
+        import torch
+
+        from .runtime import driver
+        if not device:
+            device = torch.cuda.current_device()
+        if dtype is None or flops == 0:
+            return None
+        gbps = get_dram_gbps(device)
+        clock_rate = driver.active.utils.get_device_properties(device)["sm_clock_rate"]  # in kHz
+        if tensorcore:
+            peak_tflops = get_max_tensorcore_tflops(dtype, clock_rate, device)
+        else:
+            peak_tflops = get_max_simd_tflops(dtype, clock_rate, device)
+        if nbytes == 0:
+            return peak_tflops
+        return min(peak_tflops, flops / nbytes * gbps * 1e-3)
+
+    def run(self, print_data=False) -> Dict[str, Dict[str, Any]]:
+        """Benchmarks every case and returns the results by case name."""
+        results = {}
+        for name, fn, flops, nbytes, dtype, tensorcore in self.cases:
+            ms = do_bench(fn, warmup=self.warmup, rep=self.rep, return_mode="median")
+            tflops = flops / ms * 1e-9
+            gbps = nbytes / ms * 1e-6
+            # Kernels without floating point work are bound by DRAM bandwidth only.
+            roofline = self.roofline_tflops(flops, nbytes, dtype, tensorcore)
+            if roofline is not None:
+                fraction = tflops / roofline
+            else:
+                fraction = gbps / get_dram_gbps()
+            results[name] = {
+                "ms": ms,
+                "tflops": tflops,
+                "gbps": gbps,
+                "roofline_tflops": roofline,
+                "roofline_fraction": fraction,
+            }
+            if print_data:
+                print(f"{self.name}/{name}: {ms:.3f} ms, {tflops:.1f} TFLOP/s, {gbps:.0f} GB/s, "
+                      f"{100 * fraction:.1f}% of roofline")
+        return results
+
+    @staticmethod
+    def get_commit():
+        """Returns the git commit of the Triton sources, or the Triton version if they are not in a repository."""
+        from . import __version__
+        try:
+            return subprocess.check_output(["git", "rev-parse", "HEAD"], cwd=os.path.dirname(__file__),
+                                           stderr=subprocess.DEVNULL).decode().strip()
+        except (OSError, subprocess.CalledProcessError):
+            return __version__
+
+    def save(self, results, path: str, commit=None):
+        """Adds `results` to the JSON file at `path`, under `commit` (the current one by default)."""
+        import json
+        import torch
+        data = {}
+        if os.path.exists(path):
+            with open(path) as f:
+                data = json.load(f)
+        commit = commit or self.get_commit()
+        data.setdefault(commit, {})[self.name] = {"device": torch.cuda.get_device_name(), "results": results}
+        with open(path, "w") as f:
+            json.dump(data, f, indent=2)
+
+    def compare(self, results, baseline_path: str, commit=None, tolerance=0.05) -> Dict[str, Dict[str, float]]:
+        """
+        Returns the cases whose time regressed by more than `tolerance` from the results of `commit` in the
+        baseline file (or of the last commit recorded with this suite), with both times.
+        """
+        import json
+        with open(baseline_path) as f:
+            data = json.load(f)
+        if commit is None:
+            commits = [c for c in data if self.name in data[c]]
+            if not commits:
+                return {}
+            commit = commits[-1]
+        baseline = data[commit][self.name]["results"]
+        regressions = {}
+        for name, result in results.items():
+            if name in baseline and result["ms"] > baseline[name]["ms"] * (1 + tolerance):
+                regressions[name] = {"ms": result["ms"], "baseline_ms": baseline[name]["ms"]}
+        return regressions
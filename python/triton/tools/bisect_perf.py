@@ -0,0 +1,189 @@
+import difflib
+import os
+import re
+import shlex
+import subprocess
+import tempfile
+from argparse import ArgumentParser
+
+desc = """
+Triton performance bisector:
+
+This program finds the smallest difference between two pass pipelines that
+explains a performance regression of a kernel, e.g.
+
+`python -m triton.tools.bisect_perf kernel.ttgir \\
+    --good "tritongpu-coalesce,tritongpu-remove-layout-conversions" \\
+    --bad "tritongpu-coalesce,tritongpu-optimize-thread-locality,tritongpu-remove-layout-conversions" \\
+    --bench "python bench.py {ir}"`
+
+The input IR is run through triton-opt with pipelines going from the good
+pipeline to the bad one, one difference of their pass lists at a time, and
+the benchmark command is run on the resulting IR, which replaces `{ir}`.  The
+command prints the running time of the kernel, lower being better, on the last
+line of its output; it would typically compile the IR with
+`triton.compile(path)` and time the kernel.  The first pipeline whose time is
+above the time of the good pipeline by more than `--threshold` is found by
+bisection, and then, if the difference adds layout conversion removals, the
+first rematerialization of `tritongpu-remove-layout-conversions` that makes it
+slower, with its `max-rematerializations` option.  The difference of the IR
+before and after the culprit change is printed.
+
+NOTE: bisection assumes that the time only goes up as changes are applied.
+Noisy benchmarks should report the minimum or median of several runs.
+"""
+
+
+def split_pipeline(pipeline):
+    """
+    Returns the passes of a textual pass pipeline, e.g. `builtin.module(a,b{x=1})`, as a list of strings.
+    """
+    pipeline = pipeline.strip()
+    match = re.fullmatch(r"builtin\.module\((.*)\)", pipeline, re.DOTALL)
+    if match:
+        pipeline = match.group(1)
+    passes = []
+    depth = 0
+    start = 0
+    for i, c in enumerate(pipeline):
+        if c in "({":
+            depth += 1
+        elif c in ")}":
+            depth -= 1
+        elif c == "," and depth == 0:
+            passes.append(pipeline[start:i].strip())
+            start = i + 1
+    if pipeline[start:].strip():
+        passes.append(pipeline[start:].strip())
+    return passes
+
+
+def get_changes(good, bad):
+    """
+    Returns the differences between the pass lists `good` and `bad` as a list of (good_passes, bad_passes) pairs,
+    and a function building the pipeline with the first `k` of them applied to `good`.
+    """
+    opcodes = difflib.SequenceMatcher(None, good, bad, autojunk=False).get_opcodes()
+    changes = [(good[i1:i2], bad[j1:j2]) for tag, i1, i2, j1, j2 in opcodes if tag != "equal"]
+
+    def apply(k):
+        passes = []
+        num_applied = 0
+        for tag, i1, i2, j1, j2 in opcodes:
+            if tag == "equal":
+                passes += good[i1:i2]
+            else:
+                passes += bad[j1:j2] if num_applied < k else good[i1:i2]
+                num_applied += 1
+        return passes
+
+    return changes, apply
+
+
+def with_max_rematerializations(passes, count):
+    # Limits the rematerializations of the layout conversion removals of `passes`, which don't take other options.
+    name = "tritongpu-remove-layout-conversions"
+    return [f"{name}{{max-rematerializations={count}}}" if p == name else p for p in passes]
+
+
+class Bisector:
+
+    def __init__(self, ir, bench, triton_opt, workdir):
+        self.ir = ir
+        self.bench = bench
+        self.triton_opt = triton_opt
+        self.workdir = workdir
+        self.num_files = 0
+        self.runs = {}
+
+    def transform(self, passes):
+        # Returns the path of the IR produced by `passes`.
+        pipeline = f"builtin.module({','.join(passes)})"
+        path = os.path.join(self.workdir, f"{self.num_files}.mlir")
+        self.num_files += 1
+        subprocess.run([self.triton_opt, self.ir, f"--pass-pipeline={pipeline}", "-o", path], check=True)
+        return path
+
+    def time(self, passes):
+        key = tuple(passes)
+        if key not in self.runs:
+            path = self.transform(passes)
+            cmd = self.bench.replace("{ir}", shlex.quote(path))
+            out = subprocess.run(cmd, shell=True, check=True, capture_output=True, text=True).stdout
+            self.runs[key] = (float(out.strip().splitlines()[-1]), path)
+            print(f"{self.runs[key][0]:>12.6g}  {','.join(passes)}")
+        return self.runs[key][0]
+
+    def path(self, passes):
+        self.time(passes)
+        return self.runs[tuple(passes)][1]
+
+    def first_slow(self, make_passes, lo, hi, limit):
+        # Returns the smallest `k` in (lo, hi] such that `make_passes(k)` is slower than `limit`, assuming that
+        # `make_passes(hi)` is.
+        while hi - lo > 1:
+            mid = (lo + hi) // 2
+            if self.time(make_passes(mid)) > limit:
+                hi = mid
+            else:
+                lo = mid
+        return hi
+
+
+def print_ir_diff(before, after):
+    with open(before) as f:
+        before_lines = f.readlines()
+    with open(after) as f:
+        after_lines = f.readlines()
+    print("".join(difflib.unified_diff(before_lines, after_lines, "before", "after")))
+
+
+def bisect(args):
+    good = split_pipeline(args.good)
+    bad = split_pipeline(args.bad)
+    changes, apply = get_changes(good, bad)
+    if not changes:
+        print("The pipelines are the same")
+        return
+    with tempfile.TemporaryDirectory() as workdir:
+        bisector = Bisector(args.ir, args.bench, args.triton_opt, workdir)
+        good_time = bisector.time(good)
+        limit = good_time * (1 + args.threshold)
+        if bisector.time(bad) <= limit:
+            print("The bad pipeline is not slower than the good one")
+            return
+        k = bisector.first_slow(apply, 0, len(changes), limit)
+        before_passes, after_passes = changes[k - 1]
+        print(f"\nFirst slow change: [{','.join(before_passes)}] -> [{','.join(after_passes)}]")
+        before, after = apply(k - 1), apply(k)
+        if "tritongpu-remove-layout-conversions" in after_passes:
+            # Find an upper bound of the rematerializations, past which the IR doesn't change anymore.
+            with open(bisector.transform(after)) as f:
+                unlimited_ir = f.read()
+            count = 1
+            while count < (1 << 20):
+                with open(bisector.transform(with_max_rematerializations(after, count))) as f:
+                    if f.read() == unlimited_ir:
+                        break
+                count *= 2
+            make_passes = lambda n: with_max_rematerializations(after, n)
+            if bisector.time(make_passes(0)) > limit:
+                print("The change is slower without rematerializations")
+            else:
+                n = bisector.first_slow(make_passes, 0, count, limit)
+                print(f"First slow rematerialization: {n - 1}, with max-rematerializations={n}")
+                before, after = make_passes(n - 1), make_passes(n)
+        print_ir_diff(bisector.path(before), bisector.path(after))
+
+
+if __name__ == "__main__":
+    parser = ArgumentParser(description=desc)
+    parser.add_argument("ir", help="Path to the IR to transform, e.g. a TTGIR file")
+    parser.add_argument("--good", required=True, help="Pass pipeline of the fast kernel")
+    parser.add_argument("--bad", required=True, help="Pass pipeline of the slow kernel")
+    parser.add_argument("--bench", required=True,
+                        help="Command printing the time of the kernel of the IR at `{ir}` on its last line")
+    parser.add_argument("--threshold", type=float, default=0.05,
+                        help="Relative slowdown over the good pipeline counted as a regression")
+    parser.add_argument("--triton-opt", default="triton-opt", help="Path to triton-opt")
+    bisect(parser.parse_args())
@@ -2,8 +2,11 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <inttypes.h>
+#include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 #include <cuda.h>
+#include "{header_name}"
 
 
 // helpers to check for cuda errors
@@ -24,44 +27,209 @@ static inline void gpuAssert(CUresult code, const char *file, int line) {{
   }}
 }}
 
-// globals
-#define CUBIN_NAME {kernel_name}_cubin
-CUmodule {kernel_name}_mod = NULL;
-CUfunction {kernel_name}_func = NULL;
-unsigned char CUBIN_NAME[{bin_size}] = {{ {bin_data} }};
+// cubins of the kernel, with the compute capability they were built for and
+// their launch configuration
+{images}
 
+static const struct {{
+    int capability;
+    const unsigned char *data;
+    int shared;
+    unsigned cluster_dims[3];
+}} {kernel_name}_images[{num_images}] = {{ {image_table} }};
 
-void unload_{kernel_name}(void) {{
-    CUDA_CHECK(cuModuleUnload({kernel_name}_mod));
+// returns the index of the cubin to load on a device of compute capability
+// `capability`: the one built for it, or else the one of the closest lower
+// capability of the same major version before sm_90, whose cubins are
+// specific to their architecture; -1 if there is none
+static int select_image_{kernel_name}(int capability) {{
+    int best = -1;
+    for (int i = 0; i < {num_images}; ++i) {{
+      int c = {kernel_name}_images[i].capability;
+      if (c == capability)
+        return i;
+      if (c / 10 == capability / 10 && c < capability && c < 90 &&
+          (best < 0 || c > {kernel_name}_images[best].capability))
+        best = i;
+    }}
+    return best;
 }}
 
-// TODO: some code duplication with `runtime/backend/cuda.c`
-void load_{kernel_name}() {{
-    int dev = 0;
-    void *bin = (void *)&CUBIN_NAME;
-    int shared = {shared};
-    CUDA_CHECK(cuModuleLoadData(&{kernel_name}_mod, bin));
-    CUDA_CHECK(cuModuleGetFunction(&{kernel_name}_func, {kernel_name}_mod, "{triton_kernel_name}"));
+// the module of the kernel loaded in a context; the modules of all the
+// contexts the kernel was launched in are kept in a list guarded by a mutex
+typedef struct {kernel_name}_module {{
+    CUcontext ctx;
+    CUmodule mod;
+    CUfunction func;
+    int image;
+    struct {kernel_name}_module *next;
+}} {kernel_name}_module;
+
+static {kernel_name}_module *{kernel_name}_modules = NULL;
+static pthread_mutex_t {kernel_name}_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static CUresult load_module_{kernel_name}(CUcontext ctx, {kernel_name}_module **module) {{
+    CUdevice dev;
+    CUresult err = cuCtxGetDevice(&dev);
+    int major, minor, shared_optin;
+    if (err == CUDA_SUCCESS)
+      err = cuDeviceGetAttribute(&major, CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MAJOR, dev);
+    if (err == CUDA_SUCCESS)
+      err = cuDeviceGetAttribute(&minor, CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MINOR, dev);
+    if (err == CUDA_SUCCESS)
+      err = cuDeviceGetAttribute(&shared_optin, CU_DEVICE_ATTRIBUTE_MAX_SHARED_MEMORY_PER_BLOCK_OPTIN, dev);
+    if (err != CUDA_SUCCESS)
+      return err;
+    int image = select_image_{kernel_name}(major * 10 + minor);
+    if (image < 0)
+      return CUDA_ERROR_NO_BINARY_FOR_GPU;
+    {kernel_name}_module *m = ({kernel_name}_module *)calloc(1, sizeof({kernel_name}_module));
+    if (m == NULL)
+      return CUDA_ERROR_OUT_OF_MEMORY;
+    m->ctx = ctx;
+    m->image = image;
+    err = cuModuleLoadData(&m->mod, {kernel_name}_images[image].data);
+    if (err == CUDA_SUCCESS)
+      err = cuModuleGetFunction(&m->func, m->mod, "{triton_kernel_name}");
     // set dynamic shared memory if necessary
-    int shared_optin;
-    CUDA_CHECK(cuDeviceGetAttribute(&shared_optin, CU_DEVICE_ATTRIBUTE_MAX_SHARED_MEMORY_PER_BLOCK_OPTIN, dev));
-    if (shared > 49152 && shared_optin > 49152) {{
-      CUDA_CHECK(cuFuncSetCacheConfig({kernel_name}_func, CU_FUNC_CACHE_PREFER_SHARED));
-      CUDA_CHECK(cuFuncSetAttribute({kernel_name}_func, CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES, shared_optin))
+    int shared = {kernel_name}_images[image].shared;
+    if (err == CUDA_SUCCESS && shared > 49152 && shared_optin > 49152) {{
+      err = cuFuncSetCacheConfig(m->func, CU_FUNC_CACHE_PREFER_SHARED);
+      if (err == CUDA_SUCCESS)
+        err = cuFuncSetAttribute(m->func, CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES, shared_optin);
+    }}
+    if (err != CUDA_SUCCESS) {{
+      if (m->mod != NULL)
+        cuModuleUnload(m->mod);
+      free(m);
+      return err;
+    }}
+    m->next = {kernel_name}_modules;
+    {kernel_name}_modules = m;
+    *module = m;
+    return CUDA_SUCCESS;
+}}
+
+// returns the module of the kernel in the current context, loading it on the
+// first call in the context
+static CUresult get_module_{kernel_name}({kernel_name}_module **module) {{
+    CUcontext ctx;
+    CUresult err = cuCtxGetCurrent(&ctx);
+    if (err != CUDA_SUCCESS)
+      return err;
+    if (ctx == NULL)
+      return CUDA_ERROR_INVALID_CONTEXT;
+    pthread_mutex_lock(&{kernel_name}_mutex);
+    {kernel_name}_module *m = {kernel_name}_modules;
+    while (m != NULL && m->ctx != ctx)
+      m = m->next;
+    if (m == NULL)
+      err = load_module_{kernel_name}(ctx, &m);
+    pthread_mutex_unlock(&{kernel_name}_mutex);
+    *module = m;
+    return err;
+}}
+
+// unloads the module of the kernel in the current context
+void unload_{kernel_name}(void) {{
+    CUcontext ctx;
+    CUDA_CHECK(cuCtxGetCurrent(&ctx));
+    pthread_mutex_lock(&{kernel_name}_mutex);
+    {kernel_name}_module **m = &{kernel_name}_modules;
+    while (*m != NULL && (*m)->ctx != ctx)
+      m = &(*m)->next;
+    {kernel_name}_module *module = *m;
+    if (module != NULL)
+      *m = module->next;
+    pthread_mutex_unlock(&{kernel_name}_mutex);
+    if (module != NULL) {{
+      CUDA_CHECK(cuModuleUnload(module->mod));
+      free(module);
     }}
 }}
 
+// loads the module of the kernel in the current context, which is otherwise
+// done by the first launch in the context
+void load_{kernel_name}(void) {{
+    {kernel_name}_module *module;
+    CUDA_CHECK(get_module_{kernel_name}(&module));
+}}
+
 /*
 {kernel_docstring}
 */
-CUresult {kernel_name}(CUstream stream, {signature}) {{
-    if ({kernel_name}_func == NULL)
-       load_{kernel_name}();
+CUresult {kernel_name}_launch_ex(CUstream stream, const CUlaunchAttribute *attrs, unsigned num_attrs, {signature}) {{
+    {kernel_name}_module *module;
+    CUresult err = get_module_{kernel_name}(&module);
+    if (err != CUDA_SUCCESS)
+      return err;
     unsigned int gX = {gridX};
     unsigned int gY = {gridY};
     unsigned int gZ = {gridZ};
+    if (gX * gY * gZ == 0)
+      return CUDA_SUCCESS;
     void *args[{num_args}] = {{ {arg_pointers} }};
-    // TODO: shared memory
-    if(gX * gY * gZ > 0)
-      return cuLaunchKernel({kernel_name}_func, gX, gY, gZ, {num_warps} * 32, 1, 1, {shared}, stream, args, NULL);
+    const unsigned *cluster_dims = {kernel_name}_images[module->image].cluster_dims;
+    int shared = {kernel_name}_images[module->image].shared;
+    int num_ctas = cluster_dims[0] * cluster_dims[1] * cluster_dims[2];
+    if (num_ctas == 1 && num_attrs == 0)
+      return cuLaunchKernel(module->func, gX, gY, gZ, {num_warps} * 32, 1, 1, shared, stream, args, NULL);
+    CUlaunchAttribute launch_attrs[TT_MAX_LAUNCH_ATTRIBUTES + 2];
+    if (num_attrs > TT_MAX_LAUNCH_ATTRIBUTES)
+      return CUDA_ERROR_INVALID_VALUE;
+    memcpy(launch_attrs, attrs, num_attrs * sizeof(CUlaunchAttribute));
+    if (num_ctas != 1) {{
+      launch_attrs[num_attrs].id = CU_LAUNCH_ATTRIBUTE_CLUSTER_DIMENSION;
+      launch_attrs[num_attrs].value.clusterDim.x = cluster_dims[0];
+      launch_attrs[num_attrs].value.clusterDim.y = cluster_dims[1];
+      launch_attrs[num_attrs].value.clusterDim.z = cluster_dims[2];
+      ++num_attrs;
+      launch_attrs[num_attrs].id = CU_LAUNCH_ATTRIBUTE_CLUSTER_SCHEDULING_POLICY_PREFERENCE;
+      launch_attrs[num_attrs].value.clusterSchedulingPolicyPreference = CU_CLUSTER_SCHEDULING_POLICY_SPREAD;
+      ++num_attrs;
+    }}
+    CUlaunchConfig config;
+    memset(&config, 0, sizeof(config));
+    config.gridDimX = gX * cluster_dims[0];
+    config.gridDimY = gY * cluster_dims[1];
+    config.gridDimZ = gZ * cluster_dims[2];
+    config.blockDimX = {num_warps} * 32;
+    config.blockDimY = 1;
+    config.blockDimZ = 1;
+    config.sharedMemBytes = shared;
+    config.hStream = stream;
+    config.attrs = launch_attrs;
+    config.numAttrs = num_attrs;
+    return cuLaunchKernelEx(&config, module->func, args, NULL);
+}}
+
+CUresult {kernel_name}(CUstream stream, {signature}) {{
+    return {kernel_name}_launch_ex(stream, NULL, 0, {arg_names});
+}}
+
+CUresult {kernel_name}_get_node_params(CUDA_KERNEL_NODE_PARAMS *node_params, {kernel_name}_node_args *node_args, {signature}) {{
+    {kernel_name}_module *module;
+    CUresult err = get_module_{kernel_name}(&module);
+    if (err != CUDA_SUCCESS)
+      return err;
+    const unsigned *cluster_dims = {kernel_name}_images[module->image].cluster_dims;
+    if (cluster_dims[0] * cluster_dims[1] * cluster_dims[2] != 1)
+      return CUDA_ERROR_NOT_SUPPORTED;
+    unsigned int gX = {gridX};
+    unsigned int gY = {gridY};
+    unsigned int gZ = {gridZ};
+    if (gX * gY * gZ == 0)
+      return CUDA_ERROR_INVALID_VALUE;
+{node_arg_stores}
+    memset(node_params, 0, sizeof(*node_params));
+    node_params->func = module->func;
+    node_params->gridDimX = gX;
+    node_params->gridDimY = gY;
+    node_params->gridDimZ = gZ;
+    node_params->blockDimX = {num_warps} * 32;
+    node_params->blockDimY = 1;
+    node_params->blockDimZ = 1;
+    node_params->sharedMemBytes = {kernel_name}_images[module->image].shared;
+    node_params->kernelParams = node_args->params;
+    return CUDA_SUCCESS;
 }}
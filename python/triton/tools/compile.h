@@ -6,9 +6,28 @@
 #include <stdint.h>
 #include <stdio.h>
 
+// the maximum number of launch attributes passed to the `_launch_ex` entry
+// points, on top of the cluster dimensions of the kernel
+#define TT_MAX_LAUNCH_ATTRIBUTES 8
+
 #endif
 
+// modules are loaded lazily and thread-safely on the first launch in each
+// context; these load and unload the module of the current context
 void unload_{kernel_name}(void);
 void load_{kernel_name}(void);
 // tt-linker: {kernel_name}:{full_signature}:{algo_info}
+// tt-linker-types: {kernel_name}:{triton_signature}
 CUresult{_placeholder} {kernel_name}(CUstream stream, {signature});
+// launches the kernel with the launch attributes `attrs` through cuLaunchKernelEx
+CUresult {kernel_name}_launch_ex(CUstream stream, const CUlaunchAttribute *attrs, unsigned num_attrs, {signature});
+
+// the arguments of a graph node of the kernel, which must stay alive until the
+// node is created or updated with its parameters, when the driver copies them
+typedef struct {{
+{node_arg_fields}
+  void *params[{num_args}];
+}} {kernel_name}_node_args;
+// fills the parameters of a graph node launching the kernel in the current
+// context; kernels launched in clusters aren't supported
+CUresult {kernel_name}_get_node_params(CUDA_KERNEL_NODE_PARAMS *node_params, {kernel_name}_node_args *node_args, {signature});
@@ -7,6 +7,7 @@ from pathlib import Path
 from typing import List
 
 import triton
+from triton.backends.compiler import GPUTarget
 from triton.compiler.code_generator import kernel_suffix
 from triton.backends.nvidia.driver import ty_to_cpp
 
@@ -32,6 +33,14 @@ CUresult kernel_{specialization_suffix}(CUstream stream, unsigned gX, unsigned g
 
 Different such specialized entry points can be combined using the `linker.py` script.
 
+The kernel is compiled for the GPU of the current device, or for each of the
+compute capabilities given with `--target`, e.g. `--target cuda:80,cuda:89,cuda:90`.
+The object then embeds one cubin per target, and loads the cubin for the
+compute capability of the device on the first launch: the one built for it, or
+else the one of the closest lower capability of the same major version, as
+cubins run on the later minor versions of their architecture (except the
+architecture-specific cubins of sm_90 and later).
+
 NOTE: when resolving the scope of /path/to/kernel.py, the file will be executed from within its parent directory with the python interpreter
 used to run this `compile.py` script
 """
@@ -47,10 +56,14 @@ if __name__ == "__main__":
     parser.add_argument("--num-warps", "-w", type=int, default=1, help="Number of warps to launch the kernel")
     parser.add_argument("--num-stages", "-ns", type=int, default=3,
                         help="Number of stages (meta-parameter of the kernel)")
+    parser.add_argument("--num-ctas", "-nc", type=int, default=1,
+                        help="Number of CTAs of the clusters the kernel is launched in")
     parser.add_argument("--out-name", "-on", type=str, default=None, help="Out name for the compiled kernel")
     parser.add_argument("--out-path", "-o", type=Path, default=None, help="Out filename")
     parser.add_argument("--signature", "-s", type=str, help="Signature of the kernel", required=True)
     parser.add_argument("--grid", "-g", type=str, help="Launch grid of the kernel", required=True)
+    parser.add_argument("--target", "-t", type=str, default=None,
+                        help="Comma-separated targets to compile the kernel for, e.g. cuda:80,cuda:90")
     args = parser.parse_args()
 
     out_name = args.out_name if args.out_name else args.kernel_name
@@ -75,6 +88,8 @@ if __name__ == "__main__":
         return m.hexdigest()[:8]
 
     meta_sig = f"warps{args.num_warps}xstages{args.num_stages}"
+    if args.num_ctas != 1:
+        meta_sig += f"xctas{args.num_ctas}"
     sig_hash = hash_signature(signature + [meta_sig])
 
     def constexpr(s):
@@ -97,7 +112,7 @@ if __name__ == "__main__":
     signature = {i: s.split(":")[0] for i, s in enumerate(signature) if i not in constants}
     const_sig = 'x'.join([str(v) for v in constants.values()])
     doc_string = [f"{kernel.arg_names[i]}={constants[i]}" for i in constants.keys()]
-    doc_string += [f"num_warps={args.num_warps}", f"num_stages={args.num_stages}"]
+    doc_string += [f"num_warps={args.num_warps}", f"num_stages={args.num_stages}", f"num_ctas={args.num_ctas}"]
 
     # compile ast into cubin
     for h in hints.values():
@@ -108,8 +123,17 @@ if __name__ == "__main__":
     for i in equal_to_1:
         constants.update({i: 1})
     src = triton.compiler.ASTSource(fn=kernel, constants=constants, signature=signature, attrs=attrs)
-    opts = {"num_warps": args.num_warps, "num_stages": args.num_stages}
-    ccinfo = triton.compile(src, options=opts)
+    opts = {"num_warps": args.num_warps, "num_stages": args.num_stages, "num_ctas": args.num_ctas}
+    if args.target is None:
+        targets = [triton.runtime.driver.active.get_current_target()]
+    else:
+        targets = []
+        for t in args.target.split(","):
+            backend, _, arch = t.strip().partition(":")
+            assert backend == "cuda" and arch.isdigit(), f"Only cuda:<capability> targets are supported, got {t}"
+            targets.append(GPUTarget("cuda", int(arch), 32))
+    assert len({t.arch for t in targets}) == len(targets), "Targets must be different"
+    ccinfos = [triton.compile(src, target=target, options=opts) for target in targets]
     arg_names = []
     arg_types = []
     for i in signature.keys():
@@ -120,18 +144,31 @@ if __name__ == "__main__":
     # dump C stub code
     suffix = kernel_suffix(signature.values(), attrs)
     func_name = '_'.join([out_name, sig_hash, suffix])
-    hex_ = str(binascii.hexlify(ccinfo.asm["cubin"]))[2:-1]
+    images = []
+    image_table = []
+    for target, ccinfo in zip(targets, ccinfos):
+        hex_ = str(binascii.hexlify(ccinfo.asm["cubin"]))[2:-1]
+        bin_data = ", ".join([f"0x{x}{y}" for x, y in zip(hex_[::2], hex_[1::2])])
+        images.append(f"unsigned char {func_name}_cubin_sm{target.arch}[{len(hex_) // 2}] = {{ {bin_data} }};")
+        cluster_dims = ", ".join(map(str, ccinfo.metadata.cluster_dims))
+        image_table.append(
+            f"{{ {target.arch}, {func_name}_cubin_sm{target.arch}, {ccinfo.metadata.shared}, {{ {cluster_dims} }} }}")
     params = {
         "kernel_name": func_name,
         "triton_kernel_name": args.kernel_name,
-        "bin_size": len(hex_),
-        "bin_data": ", ".join([f"0x{x}{y}" for x, y in zip(hex_[::2], hex_[1::2])]),
+        "images": "\n".join(images),
+        "image_table": ", ".join(image_table),
+        "num_images": len(images),
         "signature": ", ".join([f"{ty_to_cpp(ty)} {name}" for name, ty in zip(arg_names, arg_types)]),
+        "triton_signature": ",".join([signature[i] for i in signature.keys()]),
         "full_signature": ", ".join([f"{ty_to_cpp(signature[i])} {kernel.arg_names[i]}" for i in signature.keys()]),
         "arg_pointers": ", ".join([f"&{arg}" for arg in arg_names]),
+        "arg_names": ", ".join(arg_names),
+        "node_arg_fields": "\n".join([f"  {ty_to_cpp(ty)} {name};" for name, ty in zip(arg_names, arg_types)]),
+        "node_arg_stores": "\n".join([f"    node_args->{name} = {name};" for name in arg_names] +
+                                     [f"    node_args->params[{i}] = &node_args->{name};" for i, name in enumerate(arg_names)]),
         "num_args": len(arg_names),
         "kernel_docstring": doc_string,
-        "shared": ccinfo.metadata.shared,
         "num_warps": args.num_warps,
         "algo_info": '_'.join([const_sig, meta_sig]),
         "gridX": grid[0],
@@ -139,6 +176,7 @@ if __name__ == "__main__":
         "gridZ": grid[2],
         "_placeholder": "",
     }
+    params["header_name"] = out_path.with_suffix(f".{sig_hash}_{suffix}.h").name
     for ext in ['h', 'c']:
         template_path = Path(__file__).parent / f"compile.{ext}"
         with out_path.with_suffix(f".{sig_hash}_{suffix}.{ext}").open("w") as fp:
@@ -30,6 +30,7 @@ FLINE_RE = re.compile(r'\s*/\*\w{4}\*/\s*([^;]*;)\s*/\* 0x(\w{16}) \*/\s*')
 SLINE_RE = re.compile(r'\s*/\* 0x(\w{16}) \*/\s*')
 FNAME_RE = re.compile(r'\s*Function : (\w+)\s*')
 BRA_RE = re.compile(r'(.*BRA(?:\.U)? )(0x\w+);')
+LABEL_RE = re.compile(r'\s*(\.L_x_\d+):\s*$')
 
 
 def parseCtrl(sline):
@@ -89,6 +90,7 @@ def extract(file_path, fun):
         sass_str = subprocess.check_output([cuobjdump, "-fun", fun, "-sass", file_path])
     sass_lines = sass_str.splitlines()
     line_idx = 0
+    ret = ''
     while line_idx < len(sass_lines):
         line = sass_lines[line_idx].decode()
         # format:
@@ -103,10 +105,9 @@ def extract(file_path, fun):
             if line_idx < len(sass_lines):
                 line = sass_lines[line_idx].decode()
             else:
-                return
+                return ret
 
         fname = FNAME_RE.match(line).group(1)
-        ret = ''
         ret += f'Function:{fname}\n'
         line_idx += 2  # bypass .headerflags
         line = sass_lines[line_idx].decode()
@@ -115,7 +116,14 @@ def extract(file_path, fun):
         # store sass asm in buffer and them print them (for labels)
         # (ctrl, asm)
         asm_buffer = []
-        while FLINE_RE.match(line) is not None:
+        # Newer versions of cuobjdump print the branch targets as labels, e.g. `.L_x_0:`, which are kept.
+        named_labels = {}  # instruction index -> label names
+        while FLINE_RE.match(line) is not None or LABEL_RE.match(line) is not None:
+            if LABEL_RE.match(line) is not None:
+                named_labels.setdefault(len(asm_buffer), []).append(LABEL_RE.match(line).group(1))
+                line_idx += 1
+                line = sass_lines[line_idx].decode()
+                continue
             # First line (Offset ASM Encoding)
             fline = sass_lines[line_idx].decode()
             line_idx += 1
@@ -133,6 +141,8 @@ def extract(file_path, fun):
             if offset in labels:
                 label_name = f'LBB{labels[offset]}'
                 ret += f'{label_name}:\n'
+            for label_name in named_labels.get(idx, []):
+                ret += f'{label_name}:\n'
             ret += ctrl + '\t'
             # if this is BRA, remap offset to label
             if BRA_RE.match(asm):
@@ -141,4 +151,155 @@ def extract(file_path, fun):
                 asm = BRA_RE.sub(rf'\1{target_name};', asm)
             ret += asm + '\n'
         ret += '\n'
-        return ret
+    return ret
+
+
+# Analysis of the SASS printed by `extract`, whose lines are the function headers (Function:<name>), the labels
+# (<label>:) and the instructions (<ctrl>\t<asm>).
+INSTR_RE = re.compile(r'([-\w]+:[-\w]+:[-\w]+:[-\w]+:\w+)\t(?:@!?U?P[T\d]+\s+)?([\w.]+)\s*([^;]*);')
+TARGET_RE = re.compile(r'(LBB\d+|\.L_x_\d+)')
+
+# The categories of the instruction mix, by opcode.
+INSTR_CATEGORIES = {
+    "tensor_core": ("HMMA", "IMMA", "DMMA", "HGMMA", "IGMMA", "QGMMA", "BMMA"),
+    "global_load": ("LDG", ),
+    "global_store": ("STG", ),
+    "async_copy": ("LDGSTS", "LDGDEPBAR", "UTMALDG", "UTMASTG", "UBLKCP"),
+    "shared_load": ("LDS", "LDSM"),
+    "shared_store": ("STS", ),
+    "local_memory": ("LDL", "STL"),
+    "atomic": ("ATOM", "ATOMG", "ATOMS", "RED"),
+    "barrier": ("BAR", "MEMBAR", "DEPBAR", "SYNCS", "WARPSYNC", "ERRBAR"),
+    "branch": ("BRA", "BRX", "JMP", "CALL", "RET", "EXIT"),
+}
+OPCODE_CATEGORIES = {opcode: category for category, opcodes in INSTR_CATEGORIES.items() for opcode in opcodes}
+# The opcodes whose vector widths are counted.
+VECTOR_OPCODES = ("LDG", "STG", "LDS", "STS", "LDL", "STL")
+
+
+def parse_instruction(line):
+    """
+    Returns the (opcode, modifiers, operands, wait mask, write barrier) of the instruction printed by `extract` on
+    `line`, or None if it isn't an instruction.  The wait mask is the set of the scoreboards the instruction waits for,
+    and the write barrier the scoreboard that tracks its result, or None.
+    """
+    m = INSTR_RE.match(line)
+    if m is None:
+        return None
+    ctrl, op, operands = m.groups()
+    opcode, *modifiers = op.split('.')
+    wait, _, write, _, _ = ctrl.split(':')
+    wait_mask = 0 if wait == '--' else int(wait)
+    return (opcode, modifiers, operands.strip(), {b for b in range(6) if wait_mask >> b & 1},
+            None if write == '-' else int(write))
+
+
+def vector_width(modifiers):
+    """Returns the width in bits of the accesses of a load or store with `modifiers`."""
+    for modifier in modifiers:
+        if modifier in ("64", "128"):
+            return int(modifier)
+        if modifier in ("U8", "S8"):
+            return 8
+        if modifier in ("U16", "S16"):
+            return 16
+    return 32
+
+
+def _analyze_function(lines):
+    labels = {}
+    instrs = []
+    for line in lines:
+        instr = parse_instruction(line)
+        if instr is not None:
+            instrs.append((line.split('\t', 1)[1], *instr))
+        elif line.endswith(':'):
+            labels[line[:-1]] = len(instrs)
+    mix = {category: 0 for category in INSTR_CATEGORIES}
+    mix["other"] = 0
+    vector_widths = {opcode: {} for opcode in VECTOR_OPCODES}
+    for _, opcode, modifiers, _, _, _ in instrs:
+        mix[OPCODE_CATEGORIES.get(opcode, "other")] += 1
+        if opcode in vector_widths:
+            width = vector_width(modifiers)
+            vector_widths[opcode][width] = vector_widths[opcode].get(width, 0) + 1
+    # The loops are the backward branches, but for the branch to itself that ends the code of the kernels.  In the body of a pipelined loop, the global loads are consumed by the
+    # following iterations, so that an instruction that waits for a global load of the same iteration stalls for its
+    # whole latency.
+    loops = []
+    for end, (asm, opcode, _, operands, _, _) in enumerate(instrs):
+        target = TARGET_RE.search(operands) if opcode == "BRA" else None
+        if target is None or labels.get(target.group(1), end) >= end:
+            continue
+        start = labels[target.group(1)]
+        pending = {}  # scoreboard -> index of the global load it tracks
+        stalls = []
+        for idx in range(start, end + 1):
+            instr_asm, instr_opcode, _, _, wait, write = instrs[idx]
+            for barrier in sorted(wait & pending.keys()):
+                load = pending.pop(barrier)
+                stalls.append({"load": instrs[load][0], "use": instr_asm, "distance": idx - load})
+            if write is not None:
+                if instr_opcode == "LDG":
+                    pending[write] = idx
+                else:
+                    pending.pop(write, None)
+        loops.append({"start": start, "end": end, "instructions": end - start + 1, "stalls": stalls})
+    return {
+        "instructions": len(instrs),
+        "mix": mix,
+        "vector_widths": {opcode: widths for opcode, widths in vector_widths.items() if widths},
+        "spills": mix["local_memory"],
+        "loops": loops,
+    }
+
+
+def analyze_sass(sass):
+    """
+    Returns the analysis of the functions of `sass`, as printed by `extract`, by name.  The analysis of a function
+    has its number of instructions; its instruction mix, the number of instructions of each category of
+    `INSTR_CATEGORIES`; the vector widths, in bits, of its loads and stores; its number of local memory accesses,
+    i.e., of the spills; and its loops, with the instructions of their body that wait for a global load issued in
+    the same iteration of the loop, which isn't pipelined.
+    """
+    functions = {}
+    name = None
+    for line in sass.splitlines():
+        if line.startswith('Function:'):
+            name = line[len('Function:'):]
+            functions[name] = []
+        elif name is not None and line:
+            functions[name].append(line)
+    return {name: _analyze_function(lines) for name, lines in functions.items()}
+
+
+def analyze(cubin_asm, fun=None):
+    """Returns the `analyze_sass` analysis of the functions of `cubin_asm`, or of the function `fun`."""
+    return analyze_sass(get_sass(cubin_asm, fun))
+
+
+def format_analysis(analysis):
+    """Returns the report of the analysis of `analyze_sass`, as text."""
+    ret = ''
+    for name, function in analysis.items():
+        ret += f'{name}: {function["instructions"]} instructions, {function["spills"]} spills\n'
+        mix = ", ".join(f"{category}={count}" for category, count in function["mix"].items() if count)
+        ret += f'  mix: {mix}\n'
+        for opcode, widths in function["vector_widths"].items():
+            widths = ", ".join(f"{width}b={count}" for width, count in sorted(widths.items()))
+            ret += f'  {opcode}: {widths}\n'
+        for loop in function["loops"]:
+            ret += f'  loop [{loop["start"]}, {loop["end"]}]: {len(loop["stalls"])} stalls on global loads\n'
+            for stall in loop["stalls"]:
+                ret += f'    {stall["use"]} waits for {stall["load"]} ({stall["distance"]} instructions)\n'
+    return ret
+
+
+if __name__ == "__main__":
+    import argparse
+    parser = argparse.ArgumentParser(description="Reports the instruction mix and the stalls of the kernels of a cubin")
+    parser.add_argument("cubin", help="the cubin file")
+    parser.add_argument("-f", "--function", default=None, help="the function to analyze")
+    args = parser.parse_args()
+    with open(args.cubin, "rb") as f:
+        print(format_analysis(analyze(f.read(), args.function)), end='')
@@ -3,6 +3,13 @@ import torch
 import triton
 import triton.language as tl
 
+TMA_SIZE = 128
+
+# Descriptors already encoded on the device, keyed by the arguments of their creation and the device.  A descriptor
+# only depends on them, not on the content of the tensor, so the same tensor can be reused across launches without
+# encoding and copying its descriptor again.
+_descriptor_cache = {}
+
 
 @triton.jit
 def flush_TMA_cache(desc_ptr):
@@ -10,26 +17,121 @@ def flush_TMA_cache(desc_ptr):
                               [desc_ptr], dtype=tl.int32, is_pure=False, pack=1)
 
 
-def create_1d_tma_descriptor(ptr, dim, block_dim, element_size):
-    TMA_SIZE = 128
-    desc = torch.empty(TMA_SIZE, dtype=torch.int8)
-    triton.runtime.driver.active.utils.fill_1d_tma_descriptor(ptr, dim, block_dim, element_size, desc.data_ptr())
-    gpu_desc = desc.cuda()
-    # TMA cache is not being flushed in between dispacthes, therefore we should
-    # manually flush the cache every time we create a new TMA descriptor to make
-    # sure the following dispatch don't use stale cache when accessing TMA.
-    flush_TMA_cache[(1, )](gpu_desc, num_warps=1)
-    return gpu_desc
+def clear_tma_descriptor_cache():
+    _descriptor_cache.clear()
 
 
-def create_2d_tma_descriptor(ptr, dim1, dim0, block_dim1, block_dim0, element_size):
-    TMA_SIZE = 128
+# The CUtensorMapDataType of the element types.  Descriptors are untyped, i.e. of unsigned integers of the element
+# size, unless created with a dtype, which the reductions into them need.
+_TMA_DATA_TYPES = {
+    torch.uint8: 0,
+    torch.int32: 3,
+    torch.int64: 5,
+    torch.float16: 6,
+    torch.float32: 7,
+    torch.float64: 8,
+    torch.bfloat16: 9,
+}
+
+
+def _create_tma_descriptor(fill_descriptor, *args, cache=True, dtype=None):
+    key = (torch.cuda.current_device(), fill_descriptor.__name__) + args + (dtype, )
+    if cache and key in _descriptor_cache:
+        return _descriptor_cache[key]
     desc = torch.empty(TMA_SIZE, dtype=torch.int8)
-    triton.runtime.driver.active.utils.fill_2d_tma_descriptor(ptr, dim1, dim0, block_dim1, block_dim0, element_size,
-                                                              desc.data_ptr())
+    data_type = () if dtype is None else (_TMA_DATA_TYPES[dtype], )
+    fill_descriptor(*args, desc.data_ptr(), *data_type)
     gpu_desc = desc.cuda()
     # TMA cache is not being flushed in between dispacthes, therefore we should
     # manually flush the cache every time we create a new TMA descriptor to make
     # sure the following dispatch don't use stale cache when accessing TMA.
     flush_TMA_cache[(1, )](gpu_desc, num_warps=1)
+    if cache:
+        _descriptor_cache[key] = gpu_desc
     return gpu_desc
+
+
+def create_1d_tma_descriptor(ptr, dim, block_dim, element_size, cache=True, dtype=None):
+    utils = triton.runtime.driver.active.utils
+    return _create_tma_descriptor(utils.fill_1d_tma_descriptor, ptr, dim, block_dim, element_size, cache=cache,
+                                  dtype=dtype)
+
+
+def create_2d_tma_descriptor(ptr, dim1, dim0, block_dim1, block_dim0, element_size, cache=True, dtype=None):
+    utils = triton.runtime.driver.active.utils
+    return _create_tma_descriptor(utils.fill_2d_tma_descriptor, ptr, dim1, dim0, block_dim1, block_dim0, element_size,
+                                  cache=cache, dtype=dtype)
+
+
+def create_im2col_tma_descriptor(ptr, dims, lower_corner, upper_corner, channels_per_pixel, pixels_per_column,
+                                 element_size, cache=True):
+    """
+    Creates an im2col descriptor of the contiguous tensor of shape `dims`, from the outermost dimension and with the
+    channels innermost, e.g. NHWC, for `tl._experimental_descriptor_load_im2col`.  The loads get `pixels_per_column`
+    pixels of `channels_per_pixel` channels, within the bounding box of the spatial dimensions whose corners are
+    offset by `lower_corner` and `upper_corner` from those of the tensor, e.g. `(-pad_h, -pad_w)` and
+    `(pad_h - dilation_h * (R - 1), pad_w - dilation_w * (S - 1))` for a convolution by an R x S filter.
+    """
+    utils = triton.runtime.driver.active.utils
+    return _create_tma_descriptor(utils.fill_im2col_tma_descriptor, ptr, tuple(dims), tuple(lower_corner),
+                                  tuple(upper_corner), channels_per_pixel, pixels_per_column, element_size,
+                                  cache=cache)
+
+
+# Device-side modification of the descriptors, with `tensormap.replace`.  The descriptor must be in global memory and
+# aligned to 128 bytes, and the modifications become visible to the TMA copies of the following launches after
+# `tensormap_fence_release`, and to those of the same kernel after `flush_TMA_cache` on the descriptor.
+
+
+@triton.jit
+def tensormap_replace_global_address(desc_ptr, ptr):
+    tl.inline_asm_elementwise("tensormap.replace.tile.global_address.global.b1024.b64 [$1], $2; // $0 dummy reg",
+                              "=r, l, l", [desc_ptr, ptr], dtype=tl.int32, is_pure=False, pack=1)
+
+
+@triton.jit
+def tensormap_replace_global_dim(desc_ptr, ord: tl.constexpr, dim):
+    # `ord` is the index of the dimension, from the innermost one.
+    if ord == 0:
+        tl.inline_asm_elementwise("tensormap.replace.tile.global_dim.global.b1024.b32 [$1], 0, $2; // $0 dummy reg",
+                                  "=r, l, r", [desc_ptr, dim.to(tl.int32)], dtype=tl.int32, is_pure=False, pack=1)
+    else:
+        tl.static_assert(ord == 1, "only 1D and 2D descriptors are supported")
+        tl.inline_asm_elementwise("tensormap.replace.tile.global_dim.global.b1024.b32 [$1], 1, $2; // $0 dummy reg",
+                                  "=r, l, r", [desc_ptr, dim.to(tl.int32)], dtype=tl.int32, is_pure=False, pack=1)
+
+
+@triton.jit
+def tensormap_replace_global_stride(desc_ptr, ord: tl.constexpr, stride_in_bytes):
+    # `ord` is the index of the stride, the stride of the innermost dimension being implicit.
+    tl.static_assert(ord == 0, "only 1D and 2D descriptors are supported")
+    tl.inline_asm_elementwise("tensormap.replace.tile.global_stride.global.b1024.b64 [$1], 0, $2; // $0 dummy reg",
+                              "=r, l, l", [desc_ptr, stride_in_bytes.to(tl.int64)], dtype=tl.int32, is_pure=False,
+                              pack=1)
+
+
+@triton.jit
+def tensormap_fence_release(desc_ptr):
+    tl.inline_asm_elementwise("fence.proxy.tensormap::generic.release.gpu; // $0 dummy reg, $1", "=r, l", [desc_ptr],
+                              dtype=tl.int32, is_pure=False, pack=1)
+
+
+@triton.jit
+def create_2d_tma_descriptor_device(desc_ptr, template_desc_ptr, ptr, dim1, dim0, ELEMENT_SIZE: tl.constexpr):
+    """
+    Creates in `desc_ptr` the descriptor of the contiguous `dim1 x dim0` tensor at `ptr` from `template_desc_ptr`, a
+    descriptor of a tensor of the same element type and block shape, e.g. created by `create_2d_tma_descriptor` with
+    any pointer and shape.  This lets kernels working on many tensors, like grouped GEMMs, build their descriptors
+    without a host round trip per tensor.
+    """
+    offs = tl.arange(0, 16)
+    template = tl.load(template_desc_ptr.to(tl.pointer_type(tl.int64)) + offs)
+    tl.store(desc_ptr.to(tl.pointer_type(tl.int64)) + offs, template)
+    tl.debug_barrier()
+    tensormap_replace_global_address(desc_ptr, ptr)
+    tensormap_replace_global_dim(desc_ptr, 0, dim0)
+    tensormap_replace_global_dim(desc_ptr, 1, dim1)
+    tensormap_replace_global_stride(desc_ptr, 0, dim0.to(tl.int64) * ELEMENT_SIZE)
+    tensormap_fence_release(desc_ptr)
+    tl.debug_barrier()
+    flush_TMA_cache(desc_ptr)
@@ -0,0 +1,133 @@
+"""
+Grouped GEMMs with TMA: `C[g] = A[g] @ B[g]` for groups of problems of different sizes, e.g. the expert GEMMs of a
+MoE layer, computed by a single persistent kernel.
+
+    group_C = grouped_gemm.grouped_matmul(group_A, group_B)
+
+    # To launch the GEMMs of the same tensors again without building their problem table:
+    problems = grouped_gemm.GroupedGemmProblems(group_A, group_B, group_C)
+    problems.launch()
+
+The problems are described on the device by a table with a row per group, and each group gets TMA descriptors of
+its A, B and C, created on the device from templates.  The tiles of all the groups are numbered one after the other
+and the programs of the persistent kernel take them in turn, so that the load is balanced across the SMs whatever the
+sizes of the groups.  Matrices are contiguous and row-major, of fp16 or bf16, with K and N multiples of 8 so that the
+rows of A, B and C are aligned to the 16 bytes needed by TMA.
+"""
+import torch
+
+import triton
+import triton.language as tl
+from .experimental_descriptor import TMA_SIZE, create_2d_tma_descriptor, create_2d_tma_descriptor_device
+
+# The int64 fields of a row of the problem table.
+_A_PTR = tl.constexpr(0)
+_B_PTR = tl.constexpr(1)
+_C_PTR = tl.constexpr(2)
+_M = tl.constexpr(3)
+_N = tl.constexpr(4)
+_K = tl.constexpr(5)
+# The index past the last tile of the group in the tiles of all the groups.
+_TILE_END = tl.constexpr(6)
+_PROBLEM_FIELDS = tl.constexpr(8)
+_DESC_SIZE = tl.constexpr(TMA_SIZE)
+
+
+@triton.jit
+def _grouped_matmul_init_descriptors(problems, descs, a_template, b_template, c_template, ELEMENT_SIZE: tl.constexpr):
+    group = tl.program_id(0)
+    problem = problems + group * _PROBLEM_FIELDS
+    M = tl.load(problem + _M)
+    N = tl.load(problem + _N)
+    K = tl.load(problem + _K)
+    desc = descs + group * 3 * _DESC_SIZE
+    create_2d_tma_descriptor_device(desc, a_template, tl.load(problem + _A_PTR), M, K, ELEMENT_SIZE)
+    create_2d_tma_descriptor_device(desc + _DESC_SIZE, b_template, tl.load(problem + _B_PTR), K, N, ELEMENT_SIZE)
+    create_2d_tma_descriptor_device(desc + 2 * _DESC_SIZE, c_template, tl.load(problem + _C_PTR), M, N, ELEMENT_SIZE)
+
+
+@triton.jit
+def grouped_matmul_tma_kernel(problems, descs, num_tiles,  #
+                              BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr,  #
+                              NUM_SMS: tl.constexpr, IS_BF16: tl.constexpr):
+    """
+    Computes the tiles `program_id(0) + i * NUM_SMS` of the `num_tiles` tiles of the grouped GEMM of the problem
+    table `problems`, whose A, B and C descriptors of each group are at `descs`.
+    """
+    dtype = tl.bfloat16 if IS_BF16 else tl.float16
+    group = 0
+    group_start = 0
+    group_end = tl.load(problems + _TILE_END).to(tl.int32)
+    for tile in range(tl.program_id(0), num_tiles, NUM_SMS):
+        # The tiles of a program only go forward, so skip the groups before the tile.
+        while tile >= group_end:
+            group += 1
+            group_start = group_end
+            group_end = tl.load(problems + group * _PROBLEM_FIELDS + _TILE_END).to(tl.int32)
+        problem = problems + group * _PROBLEM_FIELDS
+        N = tl.load(problem + _N)
+        K = tl.load(problem + _K)
+        num_n_tiles = tl.cdiv(N, BLOCK_N)
+        offs_m = ((tile - group_start) // num_n_tiles * BLOCK_M).to(tl.int32)
+        offs_n = ((tile - group_start) % num_n_tiles * BLOCK_N).to(tl.int32)
+        desc = descs + group * 3 * _DESC_SIZE
+        accumulator = tl.zeros((BLOCK_M, BLOCK_N), dtype=tl.float32)
+        for k in range(0, tl.cdiv(K, BLOCK_K)):
+            offs_k = (k * BLOCK_K).to(tl.int32)
+            a = tl._experimental_descriptor_load(desc, [offs_m, offs_k], [BLOCK_M, BLOCK_K], dtype)
+            b = tl._experimental_descriptor_load(desc + _DESC_SIZE, [offs_k, offs_n], [BLOCK_K, BLOCK_N], dtype)
+            accumulator = tl.dot(a, b, accumulator)
+        # Out of bounds elements of the edge tiles are not stored by TMA.
+        tl._experimental_descriptor_store(desc + 2 * _DESC_SIZE, accumulator.to(dtype), [offs_m, offs_n])
+
+
+class GroupedGemmProblems:
+    """
+    The problem table and the TMA descriptors of the grouped GEMM `group_C[g] = group_A[g] @ group_B[g]` on the
+    device, built once so that the GEMMs can be launched again, e.g. after updating the tensors in place.
+    """
+
+    def __init__(self, group_A, group_B, group_C, BLOCK_M=128, BLOCK_N=128, BLOCK_K=64):
+        assert len(group_A) == len(group_B) == len(group_C) > 0
+        dtype = group_A[0].dtype
+        assert dtype in (torch.float16, torch.bfloat16), "grouped GEMMs support fp16 and bf16"
+        device = group_A[0].device
+        rows = []
+        num_tiles = 0
+        for A, B, C in zip(group_A, group_B, group_C):
+            (M, K), (K_B, N) = A.shape, B.shape
+            assert K == K_B and C.shape == (M, N), "incompatible shapes"
+            assert all(x.dtype == dtype and x.is_contiguous() for x in (A, B, C)), "matrices must be contiguous"
+            assert K % 8 == 0 and N % 8 == 0, "TMA needs rows aligned to 16 bytes"
+            num_tiles += triton.cdiv(M, BLOCK_M) * triton.cdiv(N, BLOCK_N)
+            rows.append([A.data_ptr(), B.data_ptr(), C.data_ptr(), M, N, K, num_tiles, 0])
+        self.problems = torch.tensor(rows, dtype=torch.int64, device=device)
+        self.descs = torch.empty((len(rows), 3, TMA_SIZE), dtype=torch.int8, device=device)
+        self.num_tiles = num_tiles
+        self.block = (BLOCK_M, BLOCK_N, BLOCK_K)
+        self.is_bf16 = dtype == torch.bfloat16
+        # The descriptors of the groups only differ from the templates by their address and shape, so the templates
+        # are of the shape of a block, as groups may be empty.
+        A, B, C = group_A[0], group_B[0], group_C[0]
+        element_size = A.element_size()
+        a_template = create_2d_tma_descriptor(A.data_ptr(), BLOCK_M, BLOCK_K, BLOCK_M, BLOCK_K, element_size)
+        b_template = create_2d_tma_descriptor(B.data_ptr(), BLOCK_K, BLOCK_N, BLOCK_K, BLOCK_N, element_size)
+        c_template = create_2d_tma_descriptor(C.data_ptr(), BLOCK_M, BLOCK_N, BLOCK_M, BLOCK_N, element_size)
+        _grouped_matmul_init_descriptors[(len(rows), )](self.problems, self.descs, a_template, b_template, c_template,
+                                                        element_size, num_warps=1)
+
+    def launch(self, num_stages=3, num_warps=8):
+        if self.num_tiles == 0:
+            return
+        # A program per SM whatever the number of tiles, so that the kernel is compiled once for all problem sizes.
+        num_sms = torch.cuda.get_device_properties(self.problems.device).multi_processor_count
+        BLOCK_M, BLOCK_N, BLOCK_K = self.block
+        grouped_matmul_tma_kernel[(num_sms, )](self.problems, self.descs, self.num_tiles, BLOCK_M, BLOCK_N, BLOCK_K,
+                                               num_sms, self.is_bf16, num_stages=num_stages, num_warps=num_warps)
+
+
+def grouped_matmul(group_A, group_B, BLOCK_M=128, BLOCK_N=128, BLOCK_K=64, num_stages=3, num_warps=8):
+    """Returns the products `group_A[g] @ group_B[g]`, computed by a single persistent kernel."""
+    group_C = [torch.empty((A.shape[0], B.shape[1]), dtype=A.dtype, device=A.device) for A, B in zip(group_A, group_B)]
+    GroupedGemmProblems(group_A, group_B, group_C, BLOCK_M, BLOCK_N, BLOCK_K).launch(num_stages, num_warps)
+    return group_C
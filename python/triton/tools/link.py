@@ -1,3 +1,4 @@
+import json
 from collections import defaultdict
 from pathlib import Path
 from typing import Sequence, Union
@@ -24,6 +25,8 @@ class KernelLinkerMeta:
     suffix: str
     num_specs: int
     """ number of specialized arguments """
+    arg_triton_types: Union[Sequence[str], None] = None
+    """ Triton types of the arguments, e.g. *fp16 """
 
 
 class HeaderParser:
@@ -33,6 +36,8 @@ class HeaderParser:
 
         # [kernel_name, c signature]
         self.linker_directives = re.compile("//[\\s]*tt-linker:[\\s]*([\\w]+):(.+):(.+)")
+        # [kernel_name, triton signature]
+        self.type_directives = re.compile("//[\\s]*tt-linker-types:[\\s]*([\\w]+):(.*)")
         # [name, hash, suffix]
         self.kernel_name = re.compile("^([\\w]+)_([\\w]+)_([\\w]+)$")
         # [(type, name)]
@@ -43,6 +48,11 @@ class HeaderParser:
         self.kernels = defaultdict(list)
 
     def extract_linker_meta(self, header: str):
+        triton_types = {}
+        for ln in header.splitlines():
+            m = self.type_directives.match(ln)
+            if _exists(m):
+                triton_types[m.group(1)] = [ty.strip() for ty in m.group(2).split(",")]
         for ln in header.splitlines():
             if ln.startswith("//"):
                 m = self.linker_directives.match(ln)
@@ -62,6 +72,7 @@ class HeaderParser:
                             triton_suffix=suffix,
                             suffix=suffix,
                             num_specs=num_specs,
+                            arg_triton_types=triton_types.get(ker_name),
                         ),
                     )
 
@@ -158,41 +169,49 @@ def make_default_algo_kernel(meta: KernelLinkerMeta) -> str:
 
 
 # generate dispatcher function for kernels with different integer value hints
+#
+# The hints of the arguments are checked once, into a mask of the hints that
+# hold, and a table indexed by the mask gives the most specialized kernel whose
+# hints all hold, so the dispatch doesn't depend on the number of kernels.
 def make_kernel_hints_dispatcher(name: str, metas: Sequence[KernelLinkerMeta]) -> str:
+    metas = sorted(metas, key=lambda m: -m.num_specs)
     src = f"// launcher for: {name}\n"
-    for meta in sorted(metas, key=lambda m: -m.num_specs):
+    for meta in metas:
         src += f"CUresult {meta.orig_kernel_name}_{meta.sig_hash}_{meta.suffix}(CUstream stream, {gen_signature(meta)});\n"
     src += "\n"
 
+    # the distinct (argument, hint) pairs of the kernels, one bit of the mask each
+    hints = sorted({(i, hint) for meta in metas for i, hint in enumerate(meta.sizes) if hint is not None})
+    if len(hints) > 16:
+        raise LinkerError(f"Too many distinct hints for kernel {name}: {len(hints)}")
+    required = [sum(1 << b for b, (i, hint) in enumerate(hints) if meta.sizes[i] == hint) for meta in metas]
+    table = [next((k for k, r in enumerate(required) if r & mask == r), -1) for mask in range(1 << len(hints))]
+
+    arg_names = metas[-1].arg_names
+    src += f"static const int16_t {name}_hints_table[{len(table)}] = {{ {', '.join(map(str, table))} }};\n\n"
     src += (f"CUresult {name}(CUstream stream, {gen_signature_with_full_args(metas[-1])}){{")
     src += "\n"
-    for meta in sorted(metas, key=lambda m: -m.num_specs):
-        cond_fn = (  #
-            lambda val, hint: f"({val} % {hint} == 0)"  #
-            if hint == 16  #
-            else f"({val} == {hint})"  #
-            if hint == 1  #
-            else None)
-        conds = " && ".join([  #
-            cond_fn(val, hint)  #
-            for val, hint in zip(meta.arg_names, meta.sizes)  #
-            if hint is not None
-        ])
-        src += (f"  if ({conds})\n" if any(meta.sizes) else "if (1)\n"
-                )  # Edge case where no specializations hence no dispatching required
-        arg_names = [arg for arg, hint in zip(meta.arg_names, meta.sizes) if hint != 1]
-        src += f"    return {meta.orig_kernel_name}_{meta.sig_hash}_{meta.suffix}(stream, {', '.join(arg_names)});\n"
+    src += "  unsigned mask = 0;\n"
+    for b, (i, hint) in enumerate(hints):
+        cond = f"{arg_names[i]} % {hint} == 0" if hint == 16 else f"{arg_names[i]} == {hint}"
+        src += f"  mask |= ({cond}) << {b};\n"
+    src += f"  switch ({name}_hints_table[mask]) {{\n"
+    for k, meta in enumerate(metas):
+        args = [arg for arg, hint in zip(meta.arg_names, meta.sizes) if hint != 1]
+        src += f"  case {k}:\n"
+        src += f"    return {meta.orig_kernel_name}_{meta.sig_hash}_{meta.suffix}(stream, {', '.join(args)});\n"
+    src += "  }\n"
     src += "\n"
     src += "  return CUDA_ERROR_INVALID_VALUE;\n"
     src += "}\n"
 
     for mode in ["load", "unload"]:
         src += f"\n// {mode} for: {name}\n"
-        for meta in sorted(metas, key=lambda m: -m.num_specs):
+        for meta in metas:
             src += f"void {mode}_{meta.orig_kernel_name}_{meta.sig_hash}_{meta.suffix}();\n"
         src += f"void {mode}_{name}() {{"
         src += "\n"
-        for meta in sorted(metas, key=lambda m: -m.num_specs):
+        for meta in metas:
             src += (f"  {mode}_{meta.orig_kernel_name}_{meta.sig_hash}_{meta.suffix}();\n")
         src += "}\n"
     return src
@@ -229,6 +248,61 @@ def make_kernel_load_def(names: str, meta: KernelLinkerMeta) -> str:
     return src
 
 
+def make_tuned_decl(meta: KernelLinkerMeta) -> str:
+    return f"CUresult {meta.orig_kernel_name}_tuned(CUstream stream, {gen_signature_with_full_args(meta)});\n"
+
+
+# generate dispatcher function picking the kernel tuned for the shape bucket of the arguments
+#
+# `configs` maps the names of some integer arguments, e.g. ["M", "N", "K"], to "dims", and the power-of-two upper
+# bounds of the buckets of these arguments, e.g. "64,64,32", to the meta-parameter and constant values of the tuned
+# kernel of each bucket, e.g. "16x16x16_warps1xstages3", under "configs". A value falls in the bucket of the smallest
+# bound above or equal to it, or of the largest bound, and buckets without a config use the config of the closest one.
+def make_tuned_dispatcher(names: Sequence[str], meta: KernelLinkerMeta, configs: dict) -> str:
+    dims = configs["dims"]
+    for dim in dims:
+        if dim not in meta.arg_names:
+            raise LinkerError(f"{dim} is not an argument of kernel {meta.orig_kernel_name}")
+    buckets = {}
+    for bounds, algo_info in configs["configs"].items():
+        bounds = tuple(int(b) for b in bounds.split(","))
+        if len(bounds) != len(dims) or any(b <= 0 or b & (b - 1) for b in bounds):
+            raise LinkerError(f"{bounds} are not powers of two bounds for {dims}")
+        algo_name = f"{meta.orig_kernel_name}_{algo_info}"
+        if algo_name not in names:
+            raise LinkerError(f"No kernel {algo_name} to tune {meta.orig_kernel_name} with")
+        buckets[tuple(b.bit_length() - 1 for b in bounds)] = names.index(algo_name)
+    log2_bounds = [sorted({bucket[d] for bucket in buckets}) for d in range(len(dims))]
+
+    # the bucket index of each ceil(log2(value)) of each dimension
+    src = ""
+    for dim, bounds in zip(dims, log2_bounds):
+        index = [next((k for k, b in enumerate(bounds) if b >= log2), len(bounds) - 1) for log2 in range(33)]
+        src += f"static const uint8_t {meta.orig_kernel_name}_{dim}_buckets[33] = {{ {', '.join(map(str, index))} }};\n"
+
+    # the tuned kernel of each bucket, row-major
+    def closest(cell):
+        key = lambda b: sum(abs(log2_bounds[d].index(b[d]) - cell[d]) for d in range(len(dims)))
+        return buckets[min(buckets, key=key)]
+
+    cells = [[]]
+    for bounds in log2_bounds:
+        cells = [cell + [k] for cell in cells for k in range(len(bounds))]
+    table = [closest(cell) for cell in cells]
+    src += f"static const int16_t {meta.orig_kernel_name}_tuned_table[{len(table)}] = {{ {', '.join(map(str, table))} }};\n\n"
+
+    src += f"static inline int {meta.orig_kernel_name}_ceil_log2(int32_t v) {{\n"
+    src += "  return v <= 1 ? 0 : 32 - __builtin_clz((uint32_t)v - 1);\n"
+    src += "}\n\n"
+    src += f"CUresult {meta.orig_kernel_name}_tuned(CUstream stream, {gen_signature_with_full_args(meta)}){{\n"
+    src += "  int cell = 0;\n"
+    for dim, bounds in zip(dims, log2_bounds):
+        src += f"  cell = cell * {len(bounds)} + {meta.orig_kernel_name}_{dim}_buckets[{meta.orig_kernel_name}_ceil_log2({dim})];\n"
+    src += f"  return {meta.orig_kernel_name}_kernels[{meta.orig_kernel_name}_tuned_table[cell]](stream, {', '.join(meta.arg_names)});\n"
+    src += "}\n"
+    return src
+
+
 def make_get_num_algos_decl(meta: KernelLinkerMeta) -> str:
     src = f"int {meta.orig_kernel_name}_get_num_algos(void);"
     return src
@@ -241,6 +315,143 @@ def make_get_num_algos_def(meta: KernelLinkerMeta) -> str:
     return src
 
 
+# element types of the pointers of the C++ wrappers, by Triton type
+_cpp_elem_types = {
+    "i1": "int8_t",
+    "i8": "int8_t",
+    "i16": "int16_t",
+    "i32": "int32_t",
+    "i64": "int64_t",
+    "u1": "uint8_t",
+    "u8": "uint8_t",
+    "u16": "uint16_t",
+    "u32": "uint32_t",
+    "u64": "uint64_t",
+    "fp32": "float",
+    "fp64": "double",
+}
+
+# types of the C++ wrappers: pointers and integers carrying their hints in their type
+_cpp_types = """
+#ifndef TT_KERNEL_CPP_TYPES
+#define TT_KERNEL_CPP_TYPES
+
+namespace triton::aot {
+
+// element types without a C++ equivalent
+struct fp16 { uint16_t bits; };
+struct bf16 { uint16_t bits; };
+struct fp8e4nv { uint8_t bits; };
+struct fp8e4b15 { uint8_t bits; };
+struct fp8e5 { uint8_t bits; };
+struct fp8e4b8 { uint8_t bits; };
+struct fp8e5b16 { uint8_t bits; };
+
+// a device pointer to elements of type T, whose address is a multiple of Divisibility
+template <typename T, unsigned Divisibility = 1> struct Ptr { CUdeviceptr ptr; };
+// an integer which is a multiple of Divisibility
+template <typename T, unsigned Divisibility = 1> struct Int { T value; };
+// an integer known at compile time
+template <typename T, T Value> struct Const {};
+
+template <typename Arg> struct ArgTraits {
+  static_assert(std::is_arithmetic_v<Arg>, "pointers must be passed as triton::aot::Ptr");
+  using type = Arg;
+  static constexpr unsigned divisibility = 1;
+  static constexpr bool is_one = false;
+  static constexpr Arg value(Arg arg) { return arg; }
+};
+template <typename T, unsigned Divisibility> struct ArgTraits<Ptr<T, Divisibility>> {
+  using type = Ptr<T>;
+  static constexpr unsigned divisibility = Divisibility;
+  static constexpr bool is_one = false;
+  static constexpr CUdeviceptr value(Ptr<T, Divisibility> arg) { return arg.ptr; }
+};
+template <typename T, unsigned Divisibility> struct ArgTraits<Int<T, Divisibility>> {
+  using type = T;
+  static constexpr unsigned divisibility = Divisibility;
+  static constexpr bool is_one = false;
+  static constexpr T value(Int<T, Divisibility> arg) { return arg.value; }
+};
+template <typename T, T Value> struct ArgTraits<Const<T, Value>> {
+  using type = T;
+  static constexpr unsigned divisibility = Value % 16 == 0 ? 16 : 1;
+  static constexpr bool is_one = Value == 1;
+  static constexpr T value(Const<T, Value>) { return Value; }
+};
+
+template <typename Arg> constexpr bool divisible_by_16 = ArgTraits<Arg>::divisibility % 16 == 0;
+template <typename Arg> constexpr bool equal_to_1 = ArgTraits<Arg>::is_one;
+template <typename Arg, typename T> constexpr bool has_type = std::is_same_v<typename ArgTraits<Arg>::type, T>;
+template <typename Arg> constexpr auto value(Arg arg) { return ArgTraits<Arg>::value(arg); }
+
+} // namespace triton::aot
+
+#endif
+"""
+
+
+def _cpp_type(ty: str, c_type: str) -> str:
+    if not ty.startswith("*"):
+        return c_type
+    elem = ty[1:]
+    if elem in _cpp_elem_types:
+        return f"Ptr<{_cpp_elem_types[elem]}>"
+    if elem in ["fp16", "bf16", "fp8e4nv", "fp8e4b15", "fp8e5", "fp8e4b8", "fp8e5b16"]:
+        return f"Ptr<{elem}>"
+    raise LinkerError(f"No C++ element type for pointers of type {ty}")
+
+
+# generate C++ wrapper for kernels with different integer value hints, picking the kernel from the hints
+# carried by the types of the arguments at compile time
+def make_cpp_hints_dispatcher(name: str, metas: Sequence[KernelLinkerMeta]) -> str:
+    metas = sorted(metas, key=lambda m: -m.num_specs)
+    meta = metas[-1]
+    if meta.arg_triton_types is None:
+        raise LinkerError(f"No argument types for kernel {name}, compile it again to generate C++ wrappers")
+    arg_names = meta.arg_names
+    src = f"// launcher for: {name}, which picks the most specialized kernel whose hints are known to hold from\n"
+    src += "// the types of the arguments, or else the kernel whose hints hold at runtime\n"
+    src += f"template <{', '.join(f'typename {arg}_t' for arg in arg_names)}>\n"
+    src += f"inline CUresult {name}(CUstream stream, {', '.join(f'{arg}_t {arg}' for arg in arg_names)}) {{\n"
+    src += "  using namespace triton::aot;\n"
+    for arg, ty, c_type in zip(arg_names, meta.arg_triton_types, meta.arg_ctypes):
+        cpp_type = _cpp_type(ty, c_type)
+        src += f"  static_assert(has_type<{arg}_t, {cpp_type}>, \"{arg} must be of type {cpp_type}\");\n"
+    for k, meta in enumerate(metas):
+        conds = [
+            f"divisible_by_16<{arg}_t>" if hint == 16 else f"equal_to_1<{arg}_t>"
+            for arg, hint in zip(arg_names, meta.sizes)
+            if hint is not None
+        ]
+        keyword = "if" if k == 0 else "else if"
+        src += f"  {keyword} constexpr ({' && '.join(conds) if conds else 'true'})\n"
+        args = [f"value({arg})" for arg, hint in zip(arg_names, meta.sizes) if hint != 1]
+        src += f"    return ::{meta.orig_kernel_name}_{meta.sig_hash}_{meta.suffix}(stream, {', '.join(args)});\n"
+    src += "  else\n"
+    src += f"    return ::{name}(stream, {', '.join(f'value({arg})' for arg in arg_names)});\n"
+    src += "}\n"
+    return src
+
+
+def make_cpp_header(c_header: str, namespace: str, kernels: dict) -> str:
+    src = "#pragma once\n\n"
+    src += "#include <cstdint>\n"
+    src += "#include <type_traits>\n\n"
+    src += "#include <cuda.h>\n\n"
+    src += "extern \"C\" {\n"
+    src += f"#include \"{c_header}\"\n"
+    for metas in kernels.values():
+        for meta in metas:
+            src += f"CUresult {meta.orig_kernel_name}_{meta.sig_hash}_{meta.suffix}(CUstream stream, {gen_signature(meta)});\n"
+    src += "}\n"
+    src += _cpp_types
+    src += f"\nnamespace {namespace} {{\n\n"
+    src += "\n".join(make_cpp_hints_dispatcher(name, metas) for name, metas in kernels.items())
+    src += f"\n}} // namespace {namespace}\n"
+    return src
+
+
 desc = """
 Triton ahead-of-time linker:
 
@@ -250,6 +461,23 @@ kernel given the specializations that were compiled.
 
 Example usage:
 python link.py /path/to/headers/*.h -o kernel_name
+
+With `--tuned-configs configs.json`, e.g.
+
+{"dims": ["M", "N", "K"], "configs": {"64,64,64": "16x16x16_warps1xstages3", "1024,1024,1024": "64x64x32_warps4xstages3"}}
+
+it also generates a `kernel_name_tuned` entry-point launching the kernel tuned
+for the power-of-two bucket of the given arguments, out of the kernels with
+the given meta-parameter and constant values, i.e. the configs picked by the
+autotuner for each bucket.
+
+With `--cpp`, it also generates a C++ header `kernel_name.hpp` of typed
+wrappers of the entry-points of each meta-parameter and constant values, in
+namespace `kernel_name`.  Their pointer arguments are `triton::aot::Ptr<T, D>`
+of the element type T of the kernel, and their integer arguments may be
+`triton::aot::Int<T, D>` or `triton::aot::Const<T, V>`, where D is a
+divisibility and V a value known at compile time.  The wrappers call the
+kernel specialized for these at compile time, without runtime dispatch.
 """
 
 if __name__ == "__main__":
@@ -268,7 +496,11 @@ if __name__ == "__main__":
         default="",
         help="String to prefix kernel dispatcher names",
     )
+    parser.add_argument("--cpp", action="store_true", help="Generate a C++ header of typed wrappers")
+    parser.add_argument("--tuned-configs", type=Path, default=None,
+                        help="JSON file of the tuned kernel of each shape bucket")
     args = parser.parse_args()
+    tuned_configs = json.loads(args.tuned_configs.read_text()) if args.tuned_configs else None
 
     # metadata
     parser = HeaderParser()
@@ -292,6 +524,9 @@ if __name__ == "__main__":
         out += get_num_algos_decl
         out += "\n"
         out += global_decl
+        if tuned_configs is not None:
+            out += "\n"
+            out += make_tuned_decl(meta)
         fp.write(out)
 
     # generate source
@@ -319,4 +554,11 @@ if __name__ == "__main__":
         out += load_unload_def
         out += "\n"
         out += default_algo_kernel
+        if tuned_configs is not None:
+            out += "\n"
+            out += make_tuned_dispatcher(names, meta, tuned_configs)
         fp.write(out)
+
+    if args.cpp:
+        with args.out.with_suffix(".hpp").open("w") as fp:
+            fp.write(make_cpp_header(args.out.with_suffix(".h").name, args.out.stem, parser.kernels))
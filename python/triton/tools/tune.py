@@ -0,0 +1,69 @@
+import json
+from argparse import ArgumentParser
+
+desc = """
+Triton ahead-of-time autotuner:
+
+This program runs the autotuning recorded in a manifest written by
+`triton.runtime.manifest.save`, and stores the best configurations in the
+Triton cache, e.g.
+
+`python -m triton.tools.tune kernels.json`
+
+Later processes using the same cache (for instance a remote one shared by the
+replicas of a service) on the same kind of device then pick the best
+configurations without benchmarking.
+
+Tensor arguments are recreated from their shapes, strides and dtypes, and
+filled with random values for floating point tensors and zeros otherwise.
+Kernels whose running time depends on the contents of their inputs may thus
+select different configurations than with real data.
+
+NOTE: the modules defining the kernels are imported by name, so they must be
+importable from the current directory or the python path.
+"""
+
+
+def make_arg(desc, device):
+    import torch
+    if "value" in desc:
+        return desc["value"]
+    dtype = getattr(torch, desc["dtype"])
+    arg = torch.empty_strided(desc["shape"], desc["stride"], dtype=dtype, device=device)
+    if dtype.is_floating_point:
+        arg.normal_()
+    else:
+        arg.zero_()
+    return arg
+
+
+def tune(entry, device):
+    from triton.runtime import manifest
+    from triton.runtime.autotuner import Autotuner
+
+    tuner = manifest.resolve(entry["module"], entry["name"], cls=Autotuner)
+    tuner.cache_results = True
+    args = [make_arg(desc, device) for desc in entry["args"]]
+    grids = entry["grids"]
+
+    def grid(meta):
+        for config, config_grid in zip(tuner.configs, grids):
+            if all(meta.get(k) == v for k, v in config.all_kwargs().items()):
+                return tuple(config_grid)
+        raise ValueError(f"no recorded grid for {meta}")
+
+    tuner.run(*args, grid=grid, warmup=False, **entry["kwargs"])
+    return tuner.best_config
+
+
+if __name__ == "__main__":
+    parser = ArgumentParser(description=desc)
+    parser.add_argument("manifest", help="Path to the manifest recording the tunings to run")
+    parser.add_argument("--device", type=str, default="cuda", help="Device to tune on")
+    args = parser.parse_args()
+
+    with open(args.manifest) as f:
+        entries = json.load(f).get("autotune", [])
+    for entry in entries:
+        best_config = tune(entry, args.device)
+        print(f"{entry['module']}.{entry['name']}: {best_config}")
@@ -827,6 +827,31 @@ tt.func @call_graph(%arg0: i32) {
 
 // -----
 
+module {
+
+// Tensor arguments get the gcd of the call sites in each dimension.
+// CHECK-LABEL: @add_2d
+tt.func @add_2d(%arg0: tensor<16x16xi32>) {
+  // CHECK: constant_value = 16
+  %cst = arith.constant dense<16> : tensor<16x16xi32>
+  // CHECK-NEXT: contiguity = [1, 16], divisibility = [{{[0-9]+}}, 16], constancy = [16, 1], constant_value = <none>
+  %0 = arith.addi %arg0, %cst : tensor<16x16xi32>
+  tt.return
+}
+
+// CHECK-LABEL: @call_2d
+tt.func @call_2d() {
+  %0 = tt.make_range {end = 16 : i32, start = 0 : i32} : tensor<16xi32>
+  %1 = tt.expand_dims %0 {axis = 0 : i32} : tensor<16xi32> -> tensor<1x16xi32>
+  %2 = tt.broadcast %1 : tensor<1x16xi32> -> tensor<16x16xi32>
+  tt.call @add_2d(%2) : (tensor<16x16xi32>) -> ()
+  tt.return
+}
+
+}
+
+// -----
+
 // CHECK-LABEL: @tensor_ptr
 tt.func @tensor_ptr(%arg0: !tt.ptr<tensor<64x16xi32>, 1>) {
   // CHECK: contiguity = [1, 1], divisibility = [1, 1], constancy = [1, 1], constant_value = <none>
@@ -863,3 +888,59 @@ tt.func public @chained_for(%8: tensor<128x64x!tt.ptr<bf16>> {tt.divisibility =
   }
   tt.return
 }
+
+// -----
+
+// CHECK-LABEL: @reshape_join_split
+tt.func @reshape_join_split() {
+  // CHECK: contiguity = [128], divisibility = [1073741824], constancy = [1], constant_value = <none>
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  // CHECK-NEXT: contiguity = [1, 32], divisibility = [1, 1073741824], constancy = [1, 1], constant_value = <none>
+  %1 = tt.reshape %0 {allow_reorder = false} : tensor<128xi32> -> tensor<4x32xi32>
+  // CHECK-NEXT: contiguity = [32], divisibility = [1073741824], constancy = [1], constant_value = <none>
+  %2 = tt.reshape %1 {allow_reorder = false} : tensor<4x32xi32> -> tensor<128xi32>
+  // CHECK-NEXT: contiguity = [1, 1], divisibility = [1, 1], constancy = [1, 1], constant_value = <none>
+  %3 = tt.reshape %0 {allow_reorder = true} : tensor<128xi32> -> tensor<4x32xi32>
+  // CHECK-NEXT: contiguity = [1], divisibility = [16], constancy = [128], constant_value = 16
+  %cst = arith.constant dense<16> : tensor<128xi32>
+  // CHECK-NEXT: contiguity = [1, 1], divisibility = [16, 16], constancy = [8, 16], constant_value = 16
+  %4 = tt.reshape %cst {allow_reorder = false} : tensor<128xi32> -> tensor<8x16xi32>
+  // CHECK-NEXT: contiguity = [128, 1], divisibility = [1073741824, 1], constancy = [1, 1], constant_value = <none>
+  %5 = tt.join %0, %0 : tensor<128xi32> -> tensor<128x2xi32>
+  // CHECK-NEXT: contiguity = [1, 1], divisibility = [16, 16], constancy = [128, 2], constant_value = 16
+  %6 = tt.join %cst, %cst : tensor<128xi32> -> tensor<128x2xi32>
+  // CHECK-NEXT: contiguity = [128], divisibility = [1073741824], constancy = [1], constant_value = <none>
+  // CHECK-NEXT: contiguity = [128], divisibility = [1073741824], constancy = [1], constant_value = <none>
+  %7, %8 = tt.split %5 : tensor<128x2xi32> -> tensor<128xi32>
+  tt.return
+}
+
+// -----
+
+// CHECK-LABEL: @while_carried_ptr
+tt.func @while_carried_ptr(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %n: i32) {
+  // CHECK: contiguity = [128], divisibility = [1073741824], constancy = [1], constant_value = <none>
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  // CHECK-NEXT: contiguity = [1], divisibility = [16], constancy = [128], constant_value = <none>
+  %1 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<128x!tt.ptr<f32>>
+  // CHECK-NEXT: contiguity = [128], divisibility = [16], constancy = [1], constant_value = <none>
+  %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  // CHECK-NEXT: contiguity = [1], divisibility = [128], constancy = [128], constant_value = 128
+  %cst = arith.constant dense<128> : tensor<128xi32>
+  %c0_i32 = arith.constant 0 : i32
+  %c1_i32 = arith.constant 1 : i32
+  %3:2 = scf.while (%p = %2, %i = %c0_i32) : (tensor<128x!tt.ptr<f32>>, i32) -> (tensor<128x!tt.ptr<f32>>, i32) {
+    %cond = arith.cmpi slt, %i, %n : i32
+    scf.condition(%cond) %p, %i : tensor<128x!tt.ptr<f32>>, i32
+  } do {
+  ^bb0(%p: tensor<128x!tt.ptr<f32>>, %i: i32):
+    // CHECK: tt.addptr
+    // CHECK-SAME: contiguity = [128], divisibility = [16], constancy = [1], constant_value = <none>
+    %next = tt.addptr %p, %cst : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    %i1 = arith.addi %i, %c1_i32 : i32
+    scf.yield %next, %i1 : tensor<128x!tt.ptr<f32>>, i32
+  }
+  // CHECK: scf.while
+  // CHECK: contiguity = [128], divisibility = [16], constancy = [1], constant_value = <none>
+  tt.return
+}
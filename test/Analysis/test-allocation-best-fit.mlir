@@ -0,0 +1,24 @@
+// RUN: env TRITON_SMEM_BEST_FIT_ALLOC=1 triton-opt %s -split-input-file --mlir-disable-threading -test-print-allocation 2>&1 | FileCheck %s
+
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#A_SHARED = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.num-ctas" = 1 : i32} {
+
+// %c does not interfere with %b, so it reuses the space right above %a.
+// CHECK-LABEL: best_fit
+tt.func @best_fit() {
+  // CHECK: offset = 0, size = 1024
+  %a = triton_gpu.local_alloc : () -> !tt.memdesc<32x16xf16, #A_SHARED, #triton_gpu.shared_memory>
+  // CHECK-NEXT: offset = 1024, size = 512
+  %b = triton_gpu.local_alloc : () -> !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory>
+  %0 = triton_gpu.local_load %b : !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory> -> tensor<16x16xf16, #AL>
+  // CHECK-NEXT: offset = 1024, size = 256
+  %c = triton_gpu.local_alloc : () -> !tt.memdesc<8x16xf16, #A_SHARED, #triton_gpu.shared_memory>
+  %1 = triton_gpu.local_load %c : !tt.memdesc<8x16xf16, #A_SHARED, #triton_gpu.shared_memory> -> tensor<8x16xf16, #AL>
+  %2 = triton_gpu.local_load %a : !tt.memdesc<32x16xf16, #A_SHARED, #triton_gpu.shared_memory> -> tensor<32x16xf16, #AL>
+  tt.return
+  // CHECK-NEXT: size = 1536
+}
+
+}
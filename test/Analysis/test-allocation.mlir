@@ -293,6 +293,38 @@ tt.func @scratch() {
   // CHECK-NEXT: size = 128
 }
 
+// Padding the rows of the scratch buffer by the default 4 elements makes the
+// mma accumulator stores 2-way bank conflicted, so 8 elements are used.
+// CHECK-LABEL: scratch_cvt_padding
+tt.func @scratch_cvt_padding() {
+  %cst0 = arith.constant dense<0.000000e+00> : tensor<64x64xf32, #C>
+  // CHECK: scratch offset = 0, size = 10240
+  %0 = triton_gpu.convert_layout %cst0 : tensor<64x64xf32, #C> -> tensor<64x64xf32, #AL>
+  tt.return
+  // CHECK-NEXT: size = 10240
+}
+
+// The multi-buffer of a pipelined loop is deallocated right after the loop, so
+// the epilogue scratch buffer of each persistent tile reuses its space.
+// CHECK-LABEL: persistent_epilogue_reuses_multibuffer
+tt.func @persistent_epilogue_reuses_multibuffer(%lb : index, %ub : index, %step : index) {
+  %cst0 = arith.constant dense<0.000000e+00> : tensor<16x32xf16, #AL>
+  scf.for %tile = %lb to %ub step %step {
+    // CHECK: offset = 0, size = 8192
+    %ring = triton_gpu.local_alloc : () -> !tt.memdesc<2x64x32xf16, #A_SHARED, #triton_gpu.shared_memory, mutable>
+    scf.for %iv = %lb to %ub step %step {
+      %c0 = arith.constant 0 : i32
+      %view = triton_gpu.memdesc_subview %ring[%c0, %c0, %c0] : !tt.memdesc<2x64x32xf16, #A_SHARED, #triton_gpu.shared_memory, mutable> -> !tt.memdesc<64x32xf16, #A_SHARED, #triton_gpu.shared_memory, mutable>
+      %x = triton_gpu.local_load %view : !tt.memdesc<64x32xf16, #A_SHARED, #triton_gpu.shared_memory, mutable> -> tensor<64x32xf16, #AL>
+    }
+    triton_gpu.local_dealloc %ring : !tt.memdesc<2x64x32xf16, #A_SHARED, #triton_gpu.shared_memory, mutable>
+    // CHECK-NEXT: scratch offset = 0, size = 1152
+    %0 = triton_gpu.convert_layout %cst0 : tensor<16x32xf16, #AL> -> tensor<16x32xf16, #BL>
+  }
+  tt.return
+  // CHECK-NEXT: size = 8192
+}
+
 // CHECK-LABEL: trans
 tt.func @trans(%A : !tt.ptr<f16>) {
   // CHECK: offset = 0, size = 1024
@@ -0,0 +1,20 @@
+// RUN: env TRITON_MEMBAR_REPORT=1 triton-opt %s --mlir-disable-threading --convert-scf-to-cf --allocate-shared-memory -test-print-membar 2>&1 | FileCheck %s
+
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#A_SHARED = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.num-ctas" = 1 : i32} {
+
+// CHECK: remark: shared memory barrier inserted: RAW hazard on [0, 512) with a pending access to [0, 512)
+// CHECK: note: conflicting access by triton_gpu.local_store
+// CHECK: remark: 1 shared memory barrier(s) inserted
+tt.func @store_then_load() {
+  %cst = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #AL>
+  %buf = triton_gpu.local_alloc : () -> !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable>
+  triton_gpu.local_store %cst, %buf : tensor<16x16xf16, #AL> -> !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable>
+  %0 = triton_gpu.local_load %buf : !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable> -> tensor<16x16xf16, #AL>
+  triton_gpu.local_dealloc %buf : !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable>
+  tt.return
+}
+
+}
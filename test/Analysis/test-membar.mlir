@@ -657,3 +657,72 @@ tt.func @call_graph_2(%A : !tt.ptr<f16>, %cond : i1) {
 }
 
 }
+
+// -----
+
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#A_SHARED = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.num-ctas" = 1 : i32} {
+
+// Slices of a multi-buffer taken at distinct constant indices don't overlap,
+// so only the access to the slice that was just written needs a barrier.
+// CHECK-LABEL: multibuffer_disjoint_slices
+tt.func @multibuffer_disjoint_slices() {
+  %c0 = arith.constant 0 : i32
+  %c1 = arith.constant 1 : i32
+  %cst = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #AL>
+  %ring = triton_gpu.local_alloc : () -> !tt.memdesc<2x16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable>
+  %s0 = triton_gpu.memdesc_subview %ring[%c0, %c0, %c0] : !tt.memdesc<2x16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable> -> !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable>
+  %s1 = triton_gpu.memdesc_subview %ring[%c1, %c0, %c0] : !tt.memdesc<2x16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable> -> !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable>
+  // CHECK: triton_gpu.local_store
+  // CHECK-NEXT: triton_gpu.local_load
+  triton_gpu.local_store %cst, %s0 : tensor<16x16xf16, #AL> -> !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable>
+  %0 = triton_gpu.local_load %s1 : !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable> -> tensor<16x16xf16, #AL>
+  // CHECK: gpu.barrier
+  // CHECK-NEXT: triton_gpu.local_load
+  %1 = triton_gpu.local_load %s0 : !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable> -> tensor<16x16xf16, #AL>
+  triton_gpu.local_dealloc %ring : !tt.memdesc<2x16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable>
+  tt.return
+}
+
+}
+
+// -----
+
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#A_SHARED = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+
+module attributes {"triton_gpu.num-warps" = 8 : i32, "triton_gpu.num-ctas" = 1 : i32} {
+
+// A buffer only shared by the warps of one group is synchronized with a named
+// barrier covering that group.
+// CHECK-LABEL: warp_group_named_barrier
+tt.func @warp_group_named_barrier() {
+  %cst = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #AL>
+  %buf = triton_gpu.local_alloc : () -> !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable>
+  // CHECK: triton_gpu.local_store
+  // CHECK-NEXT: gpu.barrier {bar_id = 1 : i32, num_threads = 128 : i32, triton_gpu.warp_group = array<i32: 4, 4>}
+  // CHECK-NEXT: triton_gpu.local_load
+  triton_gpu.local_store %cst, %buf {triton_gpu.warp_group = array<i32: 4, 4>} : tensor<16x16xf16, #AL> -> !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable>
+  %0 = triton_gpu.local_load %buf {triton_gpu.warp_group = array<i32: 4, 4>} : !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable> -> tensor<16x16xf16, #AL>
+  triton_gpu.local_dealloc %buf : !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable>
+  tt.return
+}
+
+// A buffer written by one group and read by another one needs a CTA-wide
+// barrier.
+// CHECK-LABEL: warp_group_cross_group
+tt.func @warp_group_cross_group() {
+  %cst = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #AL>
+  %buf = triton_gpu.local_alloc : () -> !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable>
+  // CHECK: triton_gpu.local_store
+  // CHECK-NEXT: gpu.barrier{{$}}
+  // CHECK-NEXT: triton_gpu.local_load
+  triton_gpu.local_store %cst, %buf {triton_gpu.warp_group = array<i32: 0, 4>} : tensor<16x16xf16, #AL> -> !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable>
+  %0 = triton_gpu.local_load %buf {triton_gpu.warp_group = array<i32: 4, 4>} : !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable> -> tensor<16x16xf16, #AL>
+  triton_gpu.local_dealloc %buf : !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable>
+  tt.return
+}
+
+}
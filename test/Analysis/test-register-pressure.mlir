@@ -0,0 +1,48 @@
+// RUN: triton-opt %s --mlir-disable-threading -test-print-register-pressure 2>&1 | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+
+// Each thread holds 8 floats in 8 registers, and addresses them from 2
+// pointers, one per group of 4 contiguous elements.
+// CHECK-LABEL: elementwise
+// CHECK-NEXT: limit = 255
+// CHECK-NEXT: tt.load: live = 12
+// CHECK-NEXT: arith.addf: live = 20
+// CHECK-NEXT: arith.mulf: live = 12
+// CHECK-NEXT: tt.store: live = 0
+// CHECK-NEXT: tt.return: live = 0
+// CHECK-NEXT: max = 20
+tt.func @elementwise(%ptr: tensor<1024x!tt.ptr<f32>, #blocked>) {
+  %0 = tt.load %ptr : tensor<1024x!tt.ptr<f32>, #blocked>
+  %1 = arith.addf %0, %0 : tensor<1024xf32, #blocked>
+  %2 = arith.mulf %0, %1 : tensor<1024xf32, #blocked>
+  tt.store %ptr, %2 : tensor<1024x!tt.ptr<f32>, #blocked>
+  tt.return
+}
+
+// The splatted constant only takes one register.  Values live across the loop
+// are live in its body, the loop-carried values are only counted once.
+// CHECK-LABEL: loop
+// CHECK-NEXT: limit = 255
+// CHECK-NEXT: arith.constant: live = 8
+// CHECK-NEXT: scf.for: live = 12, max = 20
+// CHECK-NEXT: tt.load: live = 20
+// CHECK-NEXT: arith.addf: live = 12
+// CHECK-NEXT: scf.yield: live = 4
+// CHECK-NEXT: tt.store: live = 0
+// CHECK-NEXT: tt.return: live = 0
+// CHECK-NEXT: max = 20
+tt.func @loop(%lb: i32, %ub: i32, %step: i32, %ptr: tensor<1024x!tt.ptr<f32>, #blocked>) {
+  %cst = arith.constant dense<0.000000e+00> : tensor<1024xf32, #blocked>
+  %0 = scf.for %iv = %lb to %ub step %step iter_args(%acc = %cst) -> (tensor<1024xf32, #blocked>) : i32 {
+    %1 = tt.load %ptr : tensor<1024x!tt.ptr<f32>, #blocked>
+    %2 = arith.addf %acc, %1 : tensor<1024xf32, #blocked>
+    scf.yield %2 : tensor<1024xf32, #blocked>
+  }
+  tt.store %ptr, %0 : tensor<1024x!tt.ptr<f32>, #blocked>
+  tt.return
+}
+
+}
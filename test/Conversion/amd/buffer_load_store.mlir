@@ -0,0 +1,44 @@
+// RUN: env AMDGCN_USE_BUFFER_OPS=1 triton-opt %s -split-input-file --convert-triton-amdgpu-to-llvm=arch=gfx942 | FileCheck %s
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [64], warpsPerCTA = [1], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32, "triton_gpu.threads-per-warp" = 64 : i32} {
+  // CHECK-LABEL: buffer_load_store_masked
+  tt.func @buffer_load_store_masked(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg2: i32 {tt.divisibility = 16 : i32}) {
+    %c256_i32 = arith.constant 256 : i32
+    %0 = tt.get_program_id x : i32
+    %1 = arith.muli %0, %c256_i32 : i32
+    %2 = tt.make_range {end = 256 : i32, start = 0 : i32} : tensor<256xi32, #blocked0>
+    %3 = tt.splat %1 : i32 -> tensor<256xi32, #blocked0>
+    %4 = arith.addi %3, %2 : tensor<256xi32, #blocked0>
+    %5 = tt.splat %arg2 : i32 -> tensor<256xi32, #blocked0>
+    %6 = arith.cmpi slt, %4, %5 : tensor<256xi32, #blocked0>
+    %7 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<256x!tt.ptr<f32>, #blocked0>
+    %8 = tt.addptr %7, %4 : tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xi32, #blocked0>
+    // Masked-off lanes read out of the bounds of the buffer instead of branching
+    // CHECK: rocdl.make.buffer.rsrc
+    // CHECK: llvm.select {{.*}} : i1, i32
+    // CHECK: rocdl.raw.ptr.buffer.load {{.*}} : vector<4xi32>
+    // CHECK-NOT: llvm.load
+    %9 = tt.load %8, %6 : tensor<256x!tt.ptr<f32>, #blocked0>
+    %10 = tt.splat %arg1 : !tt.ptr<f32> -> tensor<256x!tt.ptr<f32>, #blocked0>
+    %11 = tt.addptr %10, %4 : tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xi32, #blocked0>
+    // CHECK: rocdl.make.buffer.rsrc
+    // CHECK-COUNT-4: rocdl.raw.ptr.buffer.store {{.*}} : i32
+    // CHECK-NOT: llvm.store
+    tt.store %11, %9, %6 : tensor<256x!tt.ptr<f32>, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [64], warpsPerCTA = [1], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32, "triton_gpu.threads-per-warp" = 64 : i32} {
+  // Tensors of pointers which are not a uniform pointer plus offsets keep global loads
+  // CHECK-LABEL: global_load_non_uniform
+  tt.func @global_load_non_uniform(%arg0: tensor<256x!tt.ptr<f32>, #blocked0>) {
+    // CHECK-NOT: rocdl.raw.ptr.buffer.load
+    %0 = tt.load %arg0 : tensor<256x!tt.ptr<f32>, #blocked0>
+    tt.return
+  }
+}
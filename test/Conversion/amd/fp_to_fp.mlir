@@ -4,8 +4,50 @@
 #blocked = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
 module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
   tt.func @f16_to_f32(%arg0: tensor<8x8xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>>) {
-    // CHECK-COUNT-8: llvm.inline_asm asm_dialect {{.*}}v_cvt_f32_f16 {{.*}}: (f16) -> f32
+    // CHECK-COUNT-8: llvm.fpext %{{.*}} : f16 to f32
     %0 = tt.fp_to_fp %arg0 : tensor<8x8xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>> -> tensor<8x8xf32, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>>
     tt.return
   }
 }
+
+// -----
+
+//  CHECK-LABEL: f32_to_f8
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func @f32_to_f8(%arg0: tensor<8x8xf32, #blocked>) {
+    // CHECK-COUNT-4: llvm.call_intrinsic "llvm.amdgcn.cvt.pk.fp8.f32"
+    // CHECK-NOT: llvm.inline_asm
+    %0 = tt.fp_to_fp %arg0, rounding = rtne : tensor<8x8xf32, #blocked> -> tensor<8x8xf8E4M3FNUZ, #blocked>
+    // CHECK-COUNT-4: llvm.call_intrinsic "llvm.amdgcn.cvt.pk.bf8.f32"
+    %1 = tt.fp_to_fp %arg0, rounding = rtne : tensor<8x8xf32, #blocked> -> tensor<8x8xf8E5M2FNUZ, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
+//  CHECK-LABEL: f8_to_f32
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func @f8_to_f32(%arg0: tensor<8x8xf8E4M3FNUZ, #blocked>) {
+    // The fp8 values are converted to fp32 directly, not through fp16
+    // CHECK-COUNT-4: llvm.call_intrinsic "llvm.amdgcn.cvt.pk.f32.fp8"
+    // CHECK-NOT: llvm.fptrunc
+    // CHECK-NOT: llvm.fpext
+    %0 = tt.fp_to_fp %arg0 : tensor<8x8xf8E4M3FNUZ, #blocked> -> tensor<8x8xf32, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
+//  CHECK-LABEL: f8e4m3fn_to_f16
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func @f8e4m3fn_to_f16(%arg0: tensor<8x8xf8E4M3FN, #blocked>) {
+    // CHECK-COUNT-8: llvm.fmul %{{.*}}, %{{.*}} : f16
+    %0 = tt.fp_to_fp %arg0 : tensor<8x8xf8E4M3FN, #blocked> -> tensor<8x8xf16, #blocked>
+    tt.return
+  }
+}
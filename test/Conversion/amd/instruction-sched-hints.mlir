@@ -0,0 +1,68 @@
+// RUN: triton-opt %s -split-input-file --insert-instruction-sched-hints=variant=interleave | FileCheck %s --check-prefix=INTERLEAVE
+// RUN: triton-opt %s -split-input-file --insert-instruction-sched-hints=variant=iglp0 | FileCheck %s --check-prefix=IGLP0
+
+// INTERLEAVE-LABEL: @mfma_loop_body
+// IGLP0-LABEL: @mfma_loop_body
+module {
+  llvm.func @mfma_loop_body(%a : !llvm.ptr<1>, %lds : !llvm.ptr<3>, %x : vector<4xf16>, %acc : vector<4xf32>) {
+    %c0 = llvm.mlir.constant(0 : i32) : i32
+    llvm.br ^bb1(%acc : vector<4xf32>)
+  ^bb1(%c : vector<4xf32>):
+    %g0 = llvm.load %a : !llvm.ptr<1> -> vector<4xf16>
+    %g1 = llvm.load %a : !llvm.ptr<1> -> vector<4xf16>
+    %g2 = llvm.load %a : !llvm.ptr<1> -> vector<4xf16>
+    %l0 = llvm.load %lds : !llvm.ptr<3> -> vector<4xf16>
+    %l1 = llvm.load %lds : !llvm.ptr<3> -> vector<4xf16>
+    %m0 = rocdl.mfma.f32.4x4x4f16 %l0, %x, %c, %c0, %c0, %c0 : (vector<4xf16>, vector<4xf16>, vector<4xf32>, i32, i32, i32) -> vector<4xf32>
+    %m1 = rocdl.mfma.f32.4x4x4f16 %l1, %x, %m0, %c0, %c0, %c0 : (vector<4xf16>, vector<4xf16>, vector<4xf32>, i32, i32, i32) -> vector<4xf32>
+    llvm.store %g0, %lds : vector<4xf16>, !llvm.ptr<3>
+    llvm.store %g1, %lds : vector<4xf16>, !llvm.ptr<3>
+    llvm.store %g2, %lds : vector<4xf16>, !llvm.ptr<3>
+    // Each MFMA is followed by half of the LDS reads, global loads and LDS writes, the first MFMA taking the rounding.
+    // INTERLEAVE: llvm.store
+    // INTERLEAVE: %[[MFMA:.*]] = llvm.mlir.constant(8 : i32)
+    // INTERLEAVE: %[[ONE:.*]] = llvm.mlir.constant(1 : i32)
+    // INTERLEAVE: llvm.call_intrinsic "llvm.amdgcn.sched.group.barrier"(%[[MFMA]], %[[ONE]], %{{.*}})
+    // INTERLEAVE: llvm.mlir.constant(256 : i32)
+    // INTERLEAVE: llvm.mlir.constant(1 : i32)
+    // INTERLEAVE: llvm.call_intrinsic "llvm.amdgcn.sched.group.barrier"
+    // INTERLEAVE: llvm.mlir.constant(32 : i32)
+    // INTERLEAVE: llvm.mlir.constant(2 : i32)
+    // INTERLEAVE: llvm.call_intrinsic "llvm.amdgcn.sched.group.barrier"
+    // INTERLEAVE: llvm.mlir.constant(512 : i32)
+    // INTERLEAVE: llvm.mlir.constant(2 : i32)
+    // INTERLEAVE: llvm.call_intrinsic "llvm.amdgcn.sched.group.barrier"
+    // INTERLEAVE: llvm.mlir.constant(8 : i32)
+    // INTERLEAVE: llvm.call_intrinsic "llvm.amdgcn.sched.group.barrier"
+    // INTERLEAVE: llvm.mlir.constant(256 : i32)
+    // INTERLEAVE: llvm.call_intrinsic "llvm.amdgcn.sched.group.barrier"
+    // INTERLEAVE: llvm.mlir.constant(32 : i32)
+    // INTERLEAVE: llvm.mlir.constant(1 : i32)
+    // INTERLEAVE: llvm.call_intrinsic "llvm.amdgcn.sched.group.barrier"
+    // INTERLEAVE: llvm.mlir.constant(512 : i32)
+    // INTERLEAVE: llvm.mlir.constant(1 : i32)
+    // INTERLEAVE: llvm.call_intrinsic "llvm.amdgcn.sched.group.barrier"
+    // INTERLEAVE-NOT: llvm.amdgcn.sched.group.barrier
+    // INTERLEAVE: llvm.br ^bb1
+    // IGLP0: llvm.store
+    // IGLP0: %[[ZERO:.*]] = llvm.mlir.constant(0 : i32)
+    // IGLP0: llvm.call_intrinsic "llvm.amdgcn.iglp.opt"(%[[ZERO]])
+    // IGLP0-NEXT: llvm.br ^bb1
+    llvm.br ^bb1(%m1 : vector<4xf32>)
+  }
+}
+
+// -----
+
+// Blocks without MFMAs are left alone.
+// INTERLEAVE-LABEL: @no_mfma
+// INTERLEAVE-NOT: llvm.call_intrinsic
+// IGLP0-LABEL: @no_mfma
+// IGLP0-NOT: llvm.call_intrinsic
+module {
+  llvm.func @no_mfma(%a : !llvm.ptr<1>, %lds : !llvm.ptr<3>) {
+    %g0 = llvm.load %a : !llvm.ptr<1> -> vector<4xf16>
+    llvm.store %g0, %lds : vector<4xf16>, !llvm.ptr<3>
+    llvm.return
+  }
+}
@@ -27,3 +27,46 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 :
     tt.return
   }
 }
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [64], warpsPerCTA = [4], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 64 : i32} {
+  // The offset loaded by all the lanes and the warp id are read from the
+  // first lane, so that the addresses computed from them live in SGPRs.
+  // CHECK-LABEL: global_load_uniform_offset
+  tt.func @global_load_uniform_offset(%arg0: !tt.ptr<i32>, %arg1: !tt.ptr<f32> {tt.divisibility = 16 : i32}) -> tensor<1024xf32, #blocked0> {
+    // CHECK: llvm.call_intrinsic "llvm.amdgcn.readfirstlane"
+    // CHECK: llvm.load {{.*}} : !llvm.ptr -> vector<1xi32>
+    // CHECK: llvm.call_intrinsic "llvm.amdgcn.readfirstlane"
+    // CHECK-COUNT-4: llvm.load {{.*}} : !llvm.ptr -> vector<1xf32>
+    %0 = tt.get_program_id x : i32
+    %1 = tt.addptr %arg0, %0 : !tt.ptr<i32>, i32
+    %2 = tt.load %1 : !tt.ptr<i32>
+    %3 = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32, #blocked0>
+    %4 = tt.splat %2 : i32 -> tensor<1024xi32, #blocked0>
+    %5 = arith.addi %4, %3 : tensor<1024xi32, #blocked0>
+    %6 = tt.splat %arg1 : !tt.ptr<f32> -> tensor<1024x!tt.ptr<f32>, #blocked0>
+    %7 = tt.addptr %6, %5 : tensor<1024x!tt.ptr<f32>, #blocked0>, tensor<1024xi32, #blocked0>
+    %8 = tt.load %7 : tensor<1024x!tt.ptr<f32>, #blocked0>
+    tt.return %8 : tensor<1024xf32, #blocked0>
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [8], threadsPerWarp = [64], warpsPerCTA = [1], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32, "triton_gpu.threads-per-warp" = 64 : i32} {
+  // The 8 elements of a thread are prefetched as two 128-bit vectors, the
+  // masked off ones included.
+  // CHECK-LABEL: masked_prefetch
+  tt.func @masked_prefetch(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %mask: tensor<512xi1, #blocked0>) {
+    %0 = tt.make_range {end = 512 : i32, start = 0 : i32} : tensor<512xi32, #blocked0>
+    %1 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<512x!tt.ptr<f32>, #blocked0>
+    %2 = tt.addptr %1, %0 : tensor<512x!tt.ptr<f32>, #blocked0>, tensor<512xi32, #blocked0>
+    // CHECK-COUNT-2: llvm.intr.prefetch
+    // CHECK-NOT: llvm.intr.prefetch
+    tt.prefetch %2, %mask : tensor<512x!tt.ptr<f32>, #blocked0>
+    tt.return
+  }
+}
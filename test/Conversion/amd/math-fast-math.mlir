@@ -0,0 +1,23 @@
+// RUN: triton-opt %s -split-input-file --convert-triton-amdgpu-to-llvm="arch=gfx942 fast-math=true" | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [64], warpsPerCTA = [1], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32, triton_gpu.target = "hip:gfx942", "triton_gpu.threads-per-warp" = 64 : i32} {
+  // CHECK-LABEL: fast_math
+  tt.func public @fast_math(%x: tensor<64xf32, #blocked>, %y: tensor<64xf32, #blocked>) {
+    // CHECK: llvm.fmul
+    // CHECK: llvm.call @llvm.amdgcn.exp2.f32
+    %0 = math.exp %x : tensor<64xf32, #blocked>
+    // CHECK: llvm.call @llvm.amdgcn.log.f32
+    %1 = math.log2 %x : tensor<64xf32, #blocked>
+    // CHECK: llvm.call @llvm.amdgcn.rsq.f32
+    %2 = math.rsqrt %x : tensor<64xf32, #blocked>
+    // CHECK: llvm.call @llvm.amdgcn.rcp.f32
+    // CHECK: llvm.fmul
+    %3 = arith.divf %x, %y : tensor<64xf32, #blocked>
+    // CHECK: llvm.fadd {{.*}} {fastmathFlags = #llvm.fastmath<reassoc, nsz, contract>} : f32
+    %4 = arith.addf %x, %y : tensor<64xf32, #blocked>
+    // CHECK: llvm.fdiv {{.*}} : f32
+    %5 = tt.precise_divf %x, %y : tensor<64xf32, #blocked>
+    tt.return
+  }
+}
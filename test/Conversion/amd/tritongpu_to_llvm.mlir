@@ -35,3 +35,38 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 :
     tt.return
   }
 }
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [64], warpsPerCTA = [1], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32, "triton_gpu.threads-per-warp" = 64 : i32} {
+  // CHECK-LABEL: reduce_dpp
+  tt.func @reduce_dpp(%arg0: tensor<64xf32, #blocked>) {
+    // CHECK: rocdl.ds_bpermute
+    // CHECK: rocdl.ds_swizzle
+    // CHECK-COUNT-4: llvm.call_intrinsic "llvm.amdgcn.update.dpp"
+    // CHECK-NOT: rocdl.ds_swizzle
+    %0 = "tt.reduce"(%arg0) <{axis = 0 : i32}> ({
+    ^bb0(%arg1: f32, %arg2: f32):
+      %1 = arith.addf %arg1, %arg2 : f32
+      tt.reduce.return %1 : f32
+    }) : (tensor<64xf32, #blocked>) -> f32
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [4, 16], warpsPerCTA = [1, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32, "triton_gpu.threads-per-warp" = 64 : i32} {
+  // CHECK-LABEL: scan_dpp
+  tt.func @scan_dpp(%arg0: tensor<4x16xf32, #blocked>) {
+    // CHECK-COUNT-4: llvm.call_intrinsic "llvm.amdgcn.update.dpp"
+    %0 = "tt.scan"(%arg0) <{axis = 1 : i32, reverse = false}> ({
+    ^bb0(%arg1: f32, %arg2: f32):
+      %1 = arith.addf %arg1, %arg2 : f32
+      tt.scan.return %1 : f32
+    }) : (tensor<4x16xf32, #blocked>) -> tensor<4x16xf32, #blocked>
+    tt.return
+  }
+}
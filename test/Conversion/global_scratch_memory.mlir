@@ -0,0 +1,31 @@
+// RUN: triton-opt %s -split-input-file --allocate-global-scratch-memory | FileCheck %s --check-prefix=ALLOC
+// RUN: triton-opt %s -split-input-file --allocate-global-scratch-memory --convert-triton-gpu-to-llvm="compute-capability=90" | FileCheck %s
+
+// ALLOC: module attributes {{.*}}triton_gpu.global_scratch_memory_size = 132 : i32
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CHECK: llvm.func @global_scratch(%{{.*}}: !llvm.ptr<1>{{.*}}, %[[SCRATCH:[^:]*]]: !llvm.ptr<1>)
+  tt.func public @global_scratch(%arg0: !tt.ptr<i32>) {
+    // ALLOC: tt.global_scratch_alloc {alignment = 16 : i32, nbytes = 100 : i32, triton_gpu.global_scratch_memory_offset = 0 : i32}
+    // CHECK: %[[OFF0:.*]] = llvm.mlir.constant(0 : i32) : i32
+    // CHECK: llvm.getelementptr %[[SCRATCH]][%[[OFF0]]] : (!llvm.ptr<1>, i32) -> !llvm.ptr<1>, i8
+    %0 = tt.global_scratch_alloc {alignment = 16 : i32, nbytes = 100 : i32} : !tt.ptr<i32>
+    // ALLOC: tt.global_scratch_alloc {alignment = 128 : i32, nbytes = 4 : i32, triton_gpu.global_scratch_memory_offset = 128 : i32}
+    // CHECK: %[[OFF1:.*]] = llvm.mlir.constant(128 : i32) : i32
+    // CHECK: llvm.getelementptr %[[SCRATCH]][%[[OFF1]]] : (!llvm.ptr<1>, i32) -> !llvm.ptr<1>, i8
+    %1 = tt.global_scratch_alloc {alignment = 128 : i32, nbytes = 4 : i32} : !tt.ptr<i32>
+    %2 = tt.load %0 : !tt.ptr<i32>
+    tt.store %1, %2 : !tt.ptr<i32>
+    tt.return
+  }
+}
+
+// -----
+
+// ALLOC: module attributes {{.*}}triton_gpu.global_scratch_memory_size = 0 : i32
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // Kernels without global scratch memory keep their signature.
+  // CHECK: llvm.func @no_global_scratch(%{{[^,]*}}: !llvm.ptr<1>{{[^,]*}})
+  tt.func public @no_global_scratch(%arg0: !tt.ptr<i32>) {
+    tt.return
+  }
+}
@@ -86,9 +86,11 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 :
   // CHECK-LABEL: store_with_cache_attr
   tt.func @store_with_cache_attr(%a_ptr_init : tensor<256x!tt.ptr<f32>, #blocked0>, %cst : tensor<256xi1, #blocked0>, %cst_0 : tensor<256xf32, #blocked0>) {
     //      CHECK: llvm.inline_asm
-    // CHECK-SAME: st.global.L1::evict_last.b32
+    // CHECK-SAME: createpolicy.fractional.L2::evict_last.b64
     //      CHECK: llvm.inline_asm
-    // CHECK-SAME: st.global.L1::evict_last.b32
+    // CHECK-SAME: st.global.L1::evict_last.L2::cache_hint.b32
+    //      CHECK: llvm.inline_asm
+    // CHECK-SAME: st.global.L1::evict_last.L2::cache_hint.b32
     tt.store %a_ptr_init, %cst_0, %cst evictionPolicy = evict_last cacheModifier = ca : tensor<256x!tt.ptr<f32>, #blocked0>
     tt.return
   }
@@ -96,6 +98,64 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 :
 
 // -----
 
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [2], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 2 : i32} {
+  // The mask isn't known to be uniform over the 4 contiguous elements of a
+  // thread, so each is prefetched under its own predicate.
+  // CHECK-LABEL: masked_prefetch
+  tt.func @masked_prefetch(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %n: i32) {
+    %0 = tt.make_range {end = 256 : i32, start = 0 : i32} : tensor<256xi32, #blocked0>
+    %1 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<256x!tt.ptr<f32>, #blocked0>
+    %2 = tt.addptr %1, %0 : tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xi32, #blocked0>
+    %3 = tt.splat %n : i32 -> tensor<256xi32, #blocked0>
+    %4 = arith.cmpi slt, %0, %3 : tensor<256xi32, #blocked0>
+    // CHECK-COUNT-4: @$1 prefetch.global.L2 [ $0 + 0 ];
+    //     CHECK-NOT: prefetch.global.L2
+    tt.prefetch %2, %4 : tensor<256x!tt.ptr<f32>, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [2], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 2 : i32} {
+  // CHECK-LABEL: load_const_arg_evict_first
+  tt.func @load_const_arg_evict_first(%arg0: !tt.ptr<f32> {tt.const = 1 : i32, tt.divisibility = 16 : i32}, %arg1: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+    %0 = tt.make_range {end = 256 : i32, start = 0 : i32} : tensor<256xi32, #blocked0>
+    %1 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<256x!tt.ptr<f32>, #blocked0>
+    %2 = tt.addptr %1, %0 : tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xi32, #blocked0>
+    %3 = tt.splat %arg1 : !tt.ptr<f32> -> tensor<256x!tt.ptr<f32>, #blocked0>
+    %4 = tt.addptr %3, %0 : tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xi32, #blocked0>
+    // Streaming loads of data that is not written by the kernel take the
+    // read-only path with an L2 policy and a 256-byte L2 prefetch.
+    //      CHECK: createpolicy.fractional.L2::evict_first.b64
+    //      CHECK: ld.global.nc.L1::evict_first.L2::cache_hint.L2::256B.v4.b32
+    %5 = tt.load %2 evictionPolicy = evict_first : tensor<256x!tt.ptr<f32>, #blocked0>
+    //      CHECK: ld.global.L1::no_allocate.v4.b32
+    %6 = tt.load %4 evictionPolicy = no_allocate : tensor<256x!tt.ptr<f32>, #blocked0>
+    //  CHECK-NOT: ld.global.nc
+    //      CHECK: ld.volatile.global.v4.b32
+    %7 = tt.load %2 {isVolatile = true} : tensor<256x!tt.ptr<f32>, #blocked0>
+    %8 = arith.addf %5, %6 : tensor<256xf32, #blocked0>
+    %9 = arith.addf %8, %7 : tensor<256xf32, #blocked0>
+    tt.store %4, %9 : tensor<256x!tt.ptr<f32>, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 2 : i32} {
+  // The const and restrict kernel arguments are readonly and noalias.
+  // CHECK: llvm.func @const_and_restrict_args(%{{.*}}: !llvm.ptr<1> {llvm.readonly{{.*}}}, %{{.*}}: !llvm.ptr<1> {llvm.noalias{{.*}}}, %{{.*}}: !llvm.ptr<1> {tt.divisibility
+  tt.func @const_and_restrict_args(%arg0: !tt.ptr<f32> {tt.const = 1 : i32}, %arg1: !tt.ptr<f32> {tt.noalias = 1 : i32}, %arg2: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+    tt.return
+  }
+}
+
+// -----
+
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [2], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
 module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 2 : i32} {
   // CHECK-LABEL: global_load_store_no_vec
@@ -776,25 +836,11 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 :
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
 #blocked1 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [1, 1], order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
 module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
-  // CHECK: llvm.mlir.global external @global_smem
   // CHECK-LABEL: convert_layout_blocked_blocked_multi_rep
   tt.func @convert_layout_blocked_blocked_multi_rep(%arg0: tensor<16x16xf32, #blocked0>) {
-    // CHECK: llvm.mlir.addressof @global_smem
-    // CHECK: llvm.store
-    // CHECK-SAME: !llvm.ptr<3>
-    // CHECK: nvvm.barrier0
-    // CHECK: llvm.load
-    // CHECK-SAME: !llvm.ptr<3>
-    // CHECK: llvm.load
-    // CHECK-SAME: !llvm.ptr<3>
-    // CHECK: nvvm.barrier0
-    // CHECK: llvm.store
-    // CHECK-SAME: !llvm.ptr<3>
-    // CHECK: nvvm.barrier0
-    // CHECK: llvm.load
-    // CHECK-SAME: !llvm.ptr<3>
-    // CHECK: llvm.load
-    // CHECK-SAME: !llvm.ptr<3>
+    // CHECK-NOT: !llvm.ptr<3>
+    // CHECK-COUNT-8: nvvm.shfl.sync idx
+    // CHECK-NOT: nvvm.barrier0
     %0 = triton_gpu.convert_layout %arg0 : tensor<16x16xf32, #blocked0> -> tensor<16x16xf32, #blocked1>
     tt.return
   }
@@ -830,6 +876,23 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 :
   }
 }
 
+// -----
+
+#mma0 = #triton_gpu.nvidia_mma<{versionMajor = 2, warpsPerCTA = [1, 1], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [0, 1], instrShape = [16, 8]}>
+#dot_operand_a = #triton_gpu.dot_op<{opIdx=0, parent=#mma0, kWidth=2}>
+#dot_operand_b = #triton_gpu.dot_op<{opIdx=1, parent=#mma0, kWidth=2}>
+#meta = #triton_gpu.sparse_dot_meta<{parent=#mma0}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: convert_sparse_dot
+  tt.func @convert_sparse_dot(%A: tensor<16x32xf16, #dot_operand_a>, %B: tensor<64x8xf16, #dot_operand_b>, %meta: tensor<16x4xi16, #meta>) {
+    %cst0 = arith.constant dense<0.000000e+00> : tensor<16x8xf32, #mma0>
+    // CHECK-COUNT-2: mma.sp.sync.aligned.m16n8k32.row.col.f32.f16.f16.f32
+    // CHECK-NOT: mma.sp
+    %D = tt.sparse_dot %A, %B, %cst0, %meta : tensor<16x32xf16, #dot_operand_a> meta tensor<16x4xi16, #meta> * tensor<64x8xf16, #dot_operand_b> -> tensor<16x8xf32, #mma0>
+    tt.return
+  }
+}
+
 // TODO: problems in MLIR's parser on slice layout
 // #blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
 // module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
@@ -922,7 +985,9 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 8 :
 module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
   // CHECK-LABEL: convert_blocked1d_to_slice0
   tt.func @convert_blocked1d_to_slice0(%src:tensor<32xi32, #blocked0>) {
-    // CHECK: llvm.load {{.*}} : !llvm.ptr<3> -> vector<4xi32>
+    // CHECK-NOT: !llvm.ptr<3>
+    // CHECK-COUNT-4: nvvm.shfl.sync idx
+    // CHECK-NOT: nvvm.barrier0
     %cvt = triton_gpu.convert_layout %src : tensor<32xi32, #blocked0> -> tensor<32xi32, #triton_gpu.slice<{dim = 0, parent = #blocked1}>>
     tt.return
   }
@@ -935,7 +1000,9 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 :
 module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
   // CHECK-LABEL: convert_blocked1d_to_slice1
   tt.func @convert_blocked1d_to_slice1(%src:tensor<32xi32, #blocked0>) {
-    // CHECK-COUNT-8: llvm.load {{.*}} : !llvm.ptr<3>
+    // CHECK-NOT: !llvm.ptr<3>
+    // CHECK-COUNT-8: nvvm.shfl.sync idx
+    // CHECK-NOT: nvvm.barrier0
     %cvt = triton_gpu.convert_layout %src : tensor<32xi32, #blocked0> -> tensor<32xi32, #triton_gpu.slice<{dim = 1, parent = #blocked1}>>
     tt.return
   }
@@ -948,9 +1015,10 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 :
 module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
   // CHECK-LABEL: convert_blocked_to_blocked_ptr
   tt.func @convert_blocked_to_blocked_ptr(%src:tensor<32x!tt.ptr<f32>, #blocked0>) {
+    // CHECK-NOT: nvvm.barrier0
     // CHECK: llvm.ptrtoint
-    // CHECK: llvm.store
-    // CHECK: nvvm.barrier0
+    // CHECK: nvvm.shfl.sync idx
+    // CHECK: nvvm.shfl.sync idx
     // CHECK: llvm.inttoptr
     // CHECK-COUNT-4: llvm.insertvalue
     %cvt = triton_gpu.convert_layout %src : tensor<32x!tt.ptr<f32>, #blocked0> -> tensor<32x!tt.ptr<f32>, #blocked1>
@@ -960,6 +1028,44 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 :
 
 // -----
 
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [4, 8], warpsPerCTA = [1, 1], order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [4, 8], warpsPerCTA = [1, 1], order = [0, 1], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: convert_layout_within_warp
+  tt.func @convert_layout_within_warp(%arg0: tensor<4x8xf32, #blocked0>) {
+    // CHECK-NOT: !llvm.ptr<3>
+    // CHECK: nvvm.shfl.sync idx
+    // CHECK-NOT: nvvm.shfl.sync
+    // CHECK-NOT: nvvm.barrier0
+    // CHECK: llvm.return
+    %0 = triton_gpu.convert_layout %arg0 : tensor<4x8xf32, #blocked0> -> tensor<4x8xf32, #blocked1>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [1, 1], order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [4, 1], threadsPerWarp = [1, 32], warpsPerCTA = [1, 1], order = [0, 1], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: convert_layout_transpose_within_warp
+  tt.func @convert_layout_transpose_within_warp(%arg0: tensor<4x32xf32, #blocked0>) {
+    // The registers of a thread become lanes: each lane selects the register
+    // it sends and the one it receives into.
+    // CHECK-NOT: !llvm.ptr<3>
+    // CHECK: llvm.select
+    // CHECK-COUNT-4: nvvm.shfl.sync idx
+    // CHECK-NOT: nvvm.shfl.sync
+    // CHECK-NOT: nvvm.barrier0
+    // CHECK: llvm.select
+    // CHECK: llvm.return
+    %0 = triton_gpu.convert_layout %arg0 : tensor<4x32xf32, #blocked0> -> tensor<4x32xf32, #blocked1>
+    tt.return
+  }
+}
+
+// -----
+
 #blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [2, 16], warpsPerCTA = [1, 4], order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
 #shared = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
 #mma = #triton_gpu.nvidia_mma<{versionMajor = 2, warpsPerCTA = [2, 2], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [0, 1], instrShape = [16, 8]}>
@@ -1076,9 +1182,9 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 :
   // CHECK-LABEL: atomic_add_f32
   tt.func @atomic_add_f32(%arg0 : tensor<256x!tt.ptr<f32>, #blocked0>, %arg1 : tensor<256xi1, #blocked0>, %arg2 : tensor<256xf32, #blocked0>) {
     // CHECK: llvm.inline_asm
-    // CHECK-SAME: @$3 atom.global.gpu.relaxed.add.f32
+    // CHECK-SAME: @$2 red.global.gpu.relaxed.add.f32
     // CHECK: llvm.inline_asm
-    // CHECK-SAME: @$3 atom.global.gpu.relaxed.add.f32
+    // CHECK-SAME: @$2 red.global.gpu.relaxed.add.f32
     %0 = tt.atomic_rmw fadd, relaxed, gpu, %arg0, %arg2, %arg1 : (tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xf32, #blocked0>, tensor<256xi1, #blocked0>) -> tensor<256xf32, #blocked0>
     tt.return
   }
@@ -1086,12 +1192,31 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 :
 
 // -----
 
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // All the elements go to the same address, so they are summed up in
+  // registers and across the warp before a single atomic per warp.
+  // CHECK-LABEL: atomic_add_f32_uniform
+  tt.func @atomic_add_f32_uniform(%arg0 : !tt.ptr<f32>, %arg1 : tensor<256xi1, #blocked0>, %arg2 : tensor<256xf32, #blocked0>) {
+    // CHECK: llvm.fadd
+    // CHECK-COUNT-10: nvvm.shfl.sync bfly
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: @$2 red.global.gpu.relaxed.add.f32
+    // CHECK-NOT: red.global
+    %0 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<256x!tt.ptr<f32>, #blocked0>
+    %1 = tt.atomic_rmw fadd, relaxed, gpu, %0, %arg2, %arg1 : (tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xf32, #blocked0>, tensor<256xi1, #blocked0>) -> tensor<256xf32, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
 module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
   // CHECK-LABEL: atomic_add_f32_scalar
   tt.func @atomic_add_f32_scalar(%arg0 : !tt.ptr<f32>, %arg1 : i1, %arg2 : f32) {
     // CHECK: llvm.icmp "eq"
     // CHECK: llvm.inline_asm
-    // CHECK-SAME: @$3 atom.global.gpu.relaxed.add.f32
+    // CHECK-SAME: @$2 red.global.gpu.relaxed.add.f32
     %0 = tt.atomic_rmw fadd, relaxed, gpu, %arg0, %arg2, %arg1 : (!tt.ptr<f32>, f32, i1) -> f32
     tt.return
   }
@@ -1104,9 +1229,9 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 :
   // CHECK-LABEL: atomic_add_f32
   tt.func @atomic_add_f32_sys_scope(%arg0 : tensor<256x!tt.ptr<f32>, #blocked0>, %arg1 : tensor<256xi1, #blocked0>, %arg2 : tensor<256xf32, #blocked0>) {
     // CHECK: llvm.inline_asm
-    // CHECK-SAME: @$3 atom.global.sys.relaxed.add.f32
+    // CHECK-SAME: @$2 red.global.sys.relaxed.add.f32
     // CHECK: llvm.inline_asm
-    // CHECK-SAME: @$3 atom.global.sys.relaxed.add.f32
+    // CHECK-SAME: @$2 red.global.sys.relaxed.add.f32
     %0 = tt.atomic_rmw fadd, relaxed, sys, %arg0, %arg2, %arg1 : (tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xf32, #blocked0>, tensor<256xi1, #blocked0>) -> tensor<256xf32, #blocked0>
     tt.return
   }
@@ -1114,6 +1239,54 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 :
 
 // -----
 
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // The two atomics of each thread are issued relaxed between a single
+  // release fence and a single acquire fence.
+  // CHECK-LABEL: atomic_add_f32_acq_rel
+  tt.func @atomic_add_f32_acq_rel(%arg0 : tensor<256x!tt.ptr<f32>, #blocked0>, %arg1 : tensor<256xi1, #blocked0>, %arg2 : tensor<256xf32, #blocked0>) -> tensor<256xf32, #blocked0> {
+    // CHECK: fence.acq_rel.gpu;
+    // CHECK-NOT: fence
+    // CHECK-COUNT-2: @$3 atom.global.gpu.relaxed.add.f32
+    // CHECK-NOT: atom.global
+    // CHECK: fence.acq_rel.gpu;
+    %0 = tt.atomic_rmw fadd, acq_rel, gpu, %arg0, %arg2, %arg1 : (tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xf32, #blocked0>, tensor<256xi1, #blocked0>) -> tensor<256xf32, #blocked0>
+    tt.return %0 : tensor<256xf32, #blocked0>
+  }
+}
+
+// -----
+
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // An unused result is not acquired, so an acq_rel atomic is a release red.
+  // CHECK-LABEL: atomic_add_i32_scalar_acq_rel
+  tt.func @atomic_add_i32_scalar_acq_rel(%arg0 : !tt.ptr<i32>, %arg1 : i1, %arg2 : i32) {
+    // CHECK-NOT: fence
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: @$2 red.global.gpu.release.add.u32
+    // CHECK-NOT: st.shared
+    %0 = tt.atomic_rmw add, acq_rel, gpu, %arg0, %arg2, %arg1 : (!tt.ptr<i32>, i32, i1) -> i32
+    tt.return
+  }
+}
+
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // The result of a scalar 64-bit CAS is broadcast through shared memory as a
+  // 64-bit value.
+  // CHECK-LABEL: atomic_cas_i64_scalar
+  tt.func @atomic_cas_i64_scalar(%arg0 : !tt.ptr<i64>, %arg1 : i64, %arg2 : i64) -> i64 {
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: atom.global.acquire.gpu.cas.b64
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: st.shared.b64
+    // CHECK: llvm.load %{{.*}} : !llvm.ptr<3> -> i64
+    %0 = tt.atomic_cas acquire, gpu, %arg0, %arg1, %arg2 : (!tt.ptr<i64>, i64, i64) -> i64
+    tt.return %0 : i64
+  }
+}
+
+// -----
+
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
 module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
   // CHECK-LABEL: store_f32
@@ -1267,6 +1440,28 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 8 :
   }
 }
 
+// -----
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [2], threadsPerWarp = [32], warpsPerCTA = [4], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // The thread part of the indices is computed in the entry block, and the
+  // lanes are moved to the bits of the index by a mask and a shift.
+  // CHECK-LABEL: test_index_base_in_entry_block
+  tt.func @test_index_base_in_entry_block(%arg0: i1) {
+    // CHECK: nvvm.read.ptx.sreg.tid.x
+    // CHECK: llvm.and %{{.*}}, %{{.*}} : i32
+    // CHECK: llvm.shl
+    // CHECK: llvm.cond_br
+    // CHECK-NOT: nvvm.read.ptx.sreg.tid.x
+    // CHECK: llvm.return
+    cf.cond_br %arg0, ^bb1, ^bb2
+    ^bb1:  // pred: ^bb0
+      %0 = tt.make_range {end = 256 : i32, start = 0 : i32} : tensor<256xi32, #blocked0>
+      cf.br ^bb2
+    ^bb2:  // 2 preds: ^bb0, ^bb1
+      tt.return
+  }
+}
+
 // -----
 
 #mma = #triton_gpu.nvidia_mma<{versionMajor=2, warpsPerCTA=[2, 2], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [0, 1], instrShape = [16, 8]}>
@@ -1361,6 +1556,64 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 :
   }
 }
 
+// -----
+#blocked = #triton_gpu.blocked<{sizePerThread = [8], threadsPerWarp = [32], warpsPerCTA = [1], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: test_i4_to_fp16_vectorized_conversion
+  tt.func @test_i4_to_fp16_vectorized_conversion(%in: tensor<256xi4, #blocked>) {
+    // 8 elements per thread => we should process 2 vectors of 4
+    // CHECK-NOT: llvm.sitofp
+    // CHECK: llvm.inline_asm {{.*}}lop3.b32 a0, $2, 0x000f000f, 0x64086408, 0x6a{{.*}}sub.f16x2
+    // CHECK: llvm.inline_asm
+    // CHECK-NOT: llvm.inline_asm
+    %out = arith.sitofp %in : tensor<256xi4, #blocked> to tensor<256xf16, #blocked>
+    // CHECK-NOT: llvm.uitofp
+    // CHECK: llvm.inline_asm {{.*}}lop3.b32 a0, $2, 0x000f000f, 0x43004300, 0xea{{.*}}fma.rn.bf16x2
+    // CHECK: llvm.inline_asm
+    // CHECK-NOT: llvm.uitofp
+    %out1 = arith.uitofp %in : tensor<256xi4, #blocked> to tensor<256xbf16, #blocked>
+    tt.return
+  }
+}
+
+// -----
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [1], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [1], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: test_packed_elementwise
+  tt.func @test_packed_elementwise(%a: tensor<128xf16, #blocked>, %b: tensor<128xbf16, #blocked>, %c: tensor<32xf16, #blocked1>) {
+    // 4 adjacent elements per thread => 2 pairs
+    // CHECK-COUNT-2: llvm.fadd {{.*}} : vector<2xf16>
+    // CHECK-NOT: llvm.fadd
+    %0 = arith.addf %a, %a : tensor<128xf16, #blocked>
+    // CHECK-COUNT-2: llvm.intr.maximum({{.*}}) : (vector<2xf16>, vector<2xf16>) -> vector<2xf16>
+    %1 = arith.maximumf %0, %a : tensor<128xf16, #blocked>
+    // CHECK-COUNT-2: llvm.inline_asm {{.*}}fma.rn.bf16x2 $0, $1, $2, c
+    %2 = arith.mulf %b, %b : tensor<128xbf16, #blocked>
+    // Elements of different threads can't be packed.
+    // CHECK-NOT: vector<2xf16>
+    // CHECK: llvm.fadd {{.*}} : f16
+    %3 = arith.addf %c, %c : tensor<32xf16, #blocked1>
+    tt.return
+  }
+}
+
+// -----
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [1], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [1], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: test_packed_exp2
+  tt.func @test_packed_exp2(%a: tensor<128xf16, #blocked>, %c: tensor<32xf16, #blocked1>) {
+    // 4 adjacent elements per thread => 2 pairs
+    // CHECK-COUNT-2: llvm.inline_asm {{.*}}ex2.approx.f16x2 $0, $1
+    // CHECK-NOT: ex2.approx.f16x2
+    %0 = math.exp2 %a : tensor<128xf16, #blocked>
+    // CHECK: llvm.inline_asm {{.*}}ex2.approx.f16 $0, $1
+    %1 = math.exp2 %c : tensor<32xf16, #blocked1>
+    tt.return
+  }
+}
+
 // -----
 
 // CHECK-LABEL: sum_reduction
@@ -1496,6 +1749,37 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 :
 
 // -----
 
+// The partial reductions of both operands go through shared memory together,
+// and the result is read in the layout of the convert_layout consuming it.
+//  CHECK-LABEL: reduce_two_operands_packed
+//  CHECK: st.shared.v2.b32
+//  CHECK-NOT: st.shared.b32
+//  CHECK: nvvm.barrier0
+//  CHECK: ld.shared.v2.b32
+//  CHECK: st.shared.v2.b32
+//  CHECK: nvvm.barrier0
+//  CHECK: llvm.load %{{.*}} : !llvm.ptr<3> -> vector<2xi32>
+//  CHECK-NOT: nvvm.barrier0
+//  CHECK: tt.return
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [1, 4], order = [1, 0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:80", "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func public @reduce_two_operands_packed(%arg0: tensor<32x256xf32, #blocked>, %arg1: tensor<32x256xi32, #blocked>, %arg2: !tt.ptr<f32>) {
+    %0:2 = "tt.reduce"(%arg0, %arg1) <{axis = 1 : i32}> ({
+    ^bb0(%arg3: f32, %arg4: i32, %arg5: f32, %arg6: i32):
+      %1 = arith.maxnumf %arg3, %arg5 : f32
+      %2 = arith.addi %arg4, %arg6 : i32
+      tt.reduce.return %1, %2 : f32, i32
+    }) : (tensor<32x256xf32, #blocked>, tensor<32x256xi32, #blocked>) -> (tensor<32xf32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>, tensor<32xi32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>)
+    %3 = triton_gpu.convert_layout %0#0 : tensor<32xf32, #triton_gpu.slice<{dim = 1, parent = #blocked}>> -> tensor<32xf32, #blocked1>
+    %4 = tt.splat %arg2 : !tt.ptr<f32> -> tensor<32x!tt.ptr<f32>, #blocked1>
+    tt.store %4, %3 : tensor<32x!tt.ptr<f32>, #blocked1>
+    tt.return
+  }
+}
+
+// -----
+
 //  CHECK-LABEL: volta_dot
 #mma = #triton_gpu.nvidia_mma<{versionMajor = 1, versionMinor = 2, warpsPerCTA = [1, 1], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0], instrShape = [16, 16]}>
 module attributes {"triton_gpu.target" = "cuda:70", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
@@ -1643,3 +1927,125 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 :
     tt.return
   }
 }
+
+// -----
+
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: profile_region
+  // CHECK: mov.u64 $0, %globaltimer;
+  // CHECK: llvm.udiv
+  // CHECK: llvm.urem
+  // CHECK: llvm.cond_br
+  // CHECK: llvm.load %{{.*}} : !llvm.ptr<1> -> i64
+  // CHECK: llvm.mlir.constant(1024 : i64)
+  // CHECK: llvm.store
+  // CHECK: llvm.mlir.constant(7 : i64)
+  // CHECK: llvm.store
+  // CHECK: llvm.store
+  tt.func @profile_region(%arg0 : !tt.ptr<i64>, %arg1 : i32) {
+    tt.profile_region %arg0, %arg1 {regionId = 3 : i32, isEnd = true, capacity = 1024 : i32} : !tt.ptr<i64>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 2], threadsPerWarp = [32, 1], warpsPerCTA = [1, 2], order = [0, 1]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 2 : i32} {
+  // The warps split the other dimension, so each warp gathers from its own
+  // elements with shuffles.
+  // CHECK-LABEL: gather_warp_local
+  tt.func @gather_warp_local(%src: tensor<32x4xf32, #blocked>, %idx: tensor<16x4xi32, #blocked>) -> tensor<16x4xf32, #blocked> {
+    // CHECK-NOT: llvm.store
+    // CHECK-COUNT-4: nvvm.shfl.sync idx
+    // CHECK-NOT: nvvm.barrier0
+    %0 = tt.gather %src[%idx] {axis = 0 : i32} : (tensor<32x4xf32, #blocked>, tensor<16x4xi32, #blocked>) -> tensor<16x4xf32, #blocked>
+    tt.return %0 : tensor<16x4xf32, #blocked>
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [2], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 2 : i32} {
+  // The warps split the gather axis, so the gather goes through shared memory.
+  // CHECK-LABEL: gather_in_shared
+  tt.func @gather_in_shared(%src: tensor<64xf16, #blocked>, %idx: tensor<64xi64, #blocked>) -> tensor<64xf16, #blocked> {
+    // Only the warp ids of the indices of the source and the result are
+    // shuffled, from the first lane to make them uniform.
+    // CHECK-COUNT-2: nvvm.shfl.sync idx
+    // CHECK-NOT: nvvm.shfl.sync
+    // CHECK: llvm.store %{{.*}} : f16, !llvm.ptr<3>
+    // CHECK: nvvm.barrier0
+    // CHECK: llvm.trunc %{{.*}} : i64 to i32
+    // CHECK: llvm.load %{{.*}} : !llvm.ptr<3> -> f16
+    %0 = tt.gather %src[%idx] {axis = 0 : i32} : (tensor<64xf16, #blocked>, tensor<64xi64, #blocked>) -> tensor<64xf16, #blocked>
+    tt.return %0 : tensor<64xf16, #blocked>
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // Weighted histograms are counted with shared memory atomics, only for the
+  // elements of the mask.
+  // CHECK-LABEL: histogram_weighted
+  tt.func @histogram_weighted(%src: tensor<256xi32, #blocked>, %mask: tensor<256xi1, #blocked>, %w: tensor<256xf32, #blocked>) -> tensor<4096xf32, #blocked> {
+    // CHECK-NOT: nvvm.vote.ballot.sync
+    // CHECK: llvm.store %{{.*}} : f32, !llvm.ptr<3>
+    // CHECK: nvvm.barrier0
+    // CHECK: llvm.cond_br
+    // CHECK: llvm.atomicrmw fadd {{.*}} monotonic : !llvm.ptr<3>, f32
+    // CHECK: nvvm.barrier0
+    // CHECK: llvm.load %{{.*}} : !llvm.ptr<3> -> f32
+    // CHECK: llvm.fadd
+    %0 = tt.histogram %src, mask %mask : tensor<256xi1, #blocked>, weights %w : tensor<256xf32, #blocked> : tensor<256xi32, #blocked> -> tensor<4096xf32, #blocked>
+    tt.return %0 : tensor<4096xf32, #blocked>
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [1], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
+  // A reverse scan flips the lanes with a single butterfly shuffle on the way
+  // in and out.
+  // CHECK-LABEL: reverse_scan
+  tt.func @reverse_scan(%arg0: tensor<32xf32, #blocked>) -> tensor<32xf32, #blocked> {
+    // CHECK: nvvm.shfl.sync bfly
+    // CHECK-NOT: nvvm.shfl.sync bfly
+    // CHECK: nvvm.shfl.sync up
+    // CHECK: nvvm.shfl.sync bfly
+    // CHECK-NOT: nvvm.shfl.sync bfly
+    %0 = "tt.scan"(%arg0) <{axis = 0 : i32, reverse = true}> ({
+    ^bb0(%arg1: f32, %arg2: f32):
+      %1 = arith.addf %arg1, %arg2 : f32
+      tt.scan.return %1 : f32
+    }) : (tensor<32xf32, #blocked>) -> tensor<32xf32, #blocked>
+    tt.return %0 : tensor<32xf32, #blocked>
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [2], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // A segmented scan carries the head flags next to the values, and restarts
+  // from the value of the elements whose flag is set.
+  // CHECK-LABEL: segmented_scan
+  tt.func @segmented_scan(%arg0: tensor<256xf32, #blocked>, %arg1: tensor<256xi1, #blocked>) -> tensor<256xf32, #blocked> {
+    // CHECK: llvm.fadd
+    // CHECK-NEXT: llvm.select
+    // CHECK-NEXT: llvm.or %{{.*}} : i1
+    // CHECK: llvm.zext %{{.*}} : i1 to i8
+    // CHECK: nvvm.barrier0
+    // CHECK: llvm.load %{{.*}} : !llvm.ptr<3> -> i8
+    %0:2 = "tt.scan"(%arg0, %arg1) <{axis = 0 : i32, reverse = false, segmented}> ({
+    ^bb0(%arg2: f32, %arg3: f32):
+      %1 = arith.addf %arg2, %arg3 : f32
+      tt.scan.return %1 : f32
+    }) : (tensor<256xf32, #blocked>, tensor<256xi1, #blocked>) -> (tensor<256xf32, #blocked>, tensor<256xi1, #blocked>)
+    tt.return %0#0 : tensor<256xf32, #blocked>
+  }
+}
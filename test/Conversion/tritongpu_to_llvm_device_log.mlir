@@ -0,0 +1,21 @@
+// RUN: triton-opt %s -split-input-file --convert-triton-gpu-to-llvm="compute-capability=90 device-log-capacity=16" 2>&1 | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [2], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+// CHECK: module attributes {{.*}}triton_gpu.device_log_sites = ["{{.*}}kind\22:\22print{{.*}}", "{{.*}}kind\22:\22assert{{.*}}"]
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CHECK: llvm.mlir.global external @triton_device_log() {{.*}}addr_space = 1 : i32{{.*}} : !llvm.array<132 x i32>
+  // CHECK-LABEL: device_log
+  tt.func @device_log(%x: tensor<256xf16, #blocked>, %cond: tensor<256xi1, #blocked>) {
+    // The two records of the thread are reserved at once.
+    // CHECK: llvm.atomicrmw add {{.*}}, %{{.*}} monotonic : !llvm.ptr<1>, i32
+    // CHECK-NOT: vprintf
+    // CHECK-COUNT-16: llvm.store {{.*}} : i32, !llvm.ptr<1>
+    tt.print "x: " {hex = false} : %x : tensor<256xf16, #blocked>
+    // CHECK: llvm.cond_br
+    // CHECK: llvm.atomicrmw add
+    // CHECK-COUNT-8: llvm.store {{.*}} : i32, !llvm.ptr<1>
+    // CHECK-NOT: __assertfail
+    tt.assert %cond, "cond", "file.py", "device_log", 1 : tensor<256xi1, #blocked>
+    tt.return
+  }
+}
@@ -0,0 +1,25 @@
+// RUN: triton-opt %s -split-input-file --convert-triton-gpu-to-llvm="compute-capability=90 fast-math=true" 2>&1 | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: fast_math
+  tt.func @fast_math(%x: tensor<128xf32, #blocked>, %y: tensor<128xf32, #blocked>, %z: tensor<128xf64, #blocked>) {
+    // CHECK: lg2.approx.f32
+    // CHECK: llvm.fmul
+    %0 = math.log %x : tensor<128xf32, #blocked>
+    // CHECK: sin.approx.f32
+    %1 = math.sin %x : tensor<128xf32, #blocked>
+    // CHECK: rsqrt.approx.f32
+    %2 = math.rsqrt %x : tensor<128xf32, #blocked>
+    // CHECK: div.approx.f32
+    %3 = arith.divf %x, %y : tensor<128xf32, #blocked>
+    // CHECK: llvm.fadd {{.*}} {fastmathFlags = #llvm.fastmath<reassoc, nsz, contract>} : f32
+    %4 = arith.addf %x, %y : tensor<128xf32, #blocked>
+    // Precise ops and other types keep their precise lowering.
+    // CHECK: llvm.call @__nv_fdiv_rn
+    %5 = tt.precise_divf %x, %y : tensor<128xf32, #blocked>
+    // CHECK: div.rn.f64
+    %6 = arith.divf %z, %z : tensor<128xf64, #blocked>
+    tt.return
+  }
+}
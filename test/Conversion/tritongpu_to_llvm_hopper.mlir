@@ -231,6 +231,34 @@ module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 :
 
 // -----
 
+#shared = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [0, 1], hasLeadingOffset = true}>
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [4, 1], instrShape = [16, 128, 16]}>
+// CHECK-LABEL: distribute_to_shared_st_matrix_trans
+module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func @distribute_to_shared_st_matrix_trans(%a: tensor<128x128xf16, #mma>) {
+    // CHECK-COUNT-16: nvgpu.stmatrix {{.*}} {trans}
+    //          CHECK: llvm.return
+    %b = triton_gpu.local_alloc %a {allocation.offset = 0 : i32} : (tensor<128x128xf16, #mma>) -> !tt.memdesc<128x128xf16, #shared, mutable>
+    tt.return
+  }
+}
+
+// -----
+
+#shared = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [1, 0], hasLeadingOffset = true}>
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [4, 1], instrShape = [16, 128, 16]}>
+// CHECK-LABEL: shared_to_distribute_ld_matrix
+module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func @shared_to_distribute_ld_matrix(%a: !tt.memdesc<128x128xf16, #shared, mutable>) {
+    // CHECK-COUNT-16: ldmatrix.sync.aligned.m8n8.x4.shared.b16
+    //     CHECK-NOT: ldmatrix
+    %b = triton_gpu.local_load %a : !tt.memdesc<128x128xf16, #shared, mutable> -> tensor<128x128xf16, #mma>
+    tt.return
+  }
+}
+
+// -----
+
 #blocked = #triton_gpu.blocked<{sizePerThread = [8], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
 module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
   tt.func @fp8_const(%arg0: tensor<1024xi1, #blocked>, %arg1: tensor<1024xf8E4M3FNUZ, #blocked>) attributes {noinline = false} {
@@ -241,3 +269,69 @@ module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 :
     tt.return
   }
 }
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  // CHECK-LABEL: atomic_add_f32_vec4
+  tt.func @atomic_add_f32_vec4(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: tensor<2048xf32, #blocked>) {
+    %0 = tt.make_range {end = 2048 : i32, start = 0 : i32} : tensor<2048xi32, #blocked>
+    %1 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<2048x!tt.ptr<f32>, #blocked>
+    %2 = tt.addptr %1, %0 : tensor<2048x!tt.ptr<f32>, #blocked>, tensor<2048xi32, #blocked>
+    // CHECK-COUNT-4: red.global.gpu.relaxed.add.v4.f32
+    // CHECK-NOT: red.global
+    %3 = tt.atomic_rmw fadd, relaxed, gpu, %2, %arg1 : (tensor<2048x!tt.ptr<f32>, #blocked>, tensor<2048xf32, #blocked>) -> tensor<2048xf32, #blocked>
+    // The unused results aren't acquired, and the release of the adds of
+    // each thread is a single fence before them.
+    // CHECK: fence.acq_rel.gpu;
+    // CHECK-COUNT-4: red.global.gpu.relaxed.add.v4.f32
+    // CHECK-NOT: fence
+    %4 = tt.atomic_rmw fadd, acq_rel, gpu, %2, %arg1 : (tensor<2048x!tt.ptr<f32>, #blocked>, tensor<2048xf32, #blocked>) -> tensor<2048xf32, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0], CTAsPerCGA = [1, 2], CTASplitNum = [1, 2], CTAOrder = [1, 0]}>
+module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 2 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  // CHECK-LABEL: reduce_across_ctas
+  tt.func @reduce_across_ctas(%arg0: tensor<4x256xf32, #blocked>) {
+    // The partial reductions are stored into the shared memory of both CTAs
+    // of the cluster, and combined after a cluster barrier.
+    // CHECK: nvgpu.cluster_arrive
+    // CHECK: nvgpu.cluster_wait
+    // CHECK-COUNT-2: mapa.shared::cluster.u32
+    // CHECK: nvgpu.cluster_arrive
+    // CHECK: nvgpu.cluster_wait
+    // CHECK-COUNT-2: llvm.load
+    // CHECK: llvm.fadd
+    %0 = "tt.reduce"(%arg0) <{axis = 1 : i32}> ({
+    ^bb0(%arg1: f32, %arg2: f32):
+      %1 = arith.addf %arg1, %arg2 : f32
+      tt.reduce.return %1 : f32
+    }) : (tensor<4x256xf32, #blocked>) -> tensor<4xf32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>
+    tt.return
+  }
+}
+
+// -----
+
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [8, 1], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0], instrShape = [16, 256, 32]}>
+#shared = #triton_gpu.shared<{vec = 16, perPhase = 4, maxPhase = 2, order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [0, 1], hasLeadingOffset = true}>
+#shared1 = #triton_gpu.shared<{vec = 16, perPhase = 4, maxPhase = 2, order = [0, 1], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [0, 1], hasLeadingOffset = true}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 8 : i32} {
+  // The operands are zero past the first 96 elements along K, so the last of
+  // the four K steps is skipped.
+  // CHECK-LABEL: @dot_k_extent
+  tt.func @dot_k_extent(%a: !tt.memdesc<128x128xf8E5M2, #shared>, %b: !tt.memdesc<128x256xf8E5M2, #shared1>, %c: tensor<128x256xf32, #mma>) {
+    // CHECK-COUNT-3: nvgpu.wgmma %
+    // CHECK-NOT: nvgpu.wgmma %
+    // CHECK: nvgpu.wgmma_commit_group
+    %m = triton_nvidia_gpu.warp_group_dot %a, %b, %c
+      {maxNumImpreciseAcc = 129 : i32, inputPrecision = 0 : i32, kExtent = 96 : i32} :
+      !tt.memdesc<128x128xf8E5M2, #shared> * !tt.memdesc<128x256xf8E5M2, #shared1> -> tensor<128x256xf32, #mma>
+    tt.return
+  }
+}
@@ -0,0 +1,83 @@
+// RUN: triton-opt %s -split-input-file --allocate-shared-memory --convert-triton-gpu-to-llvm | FileCheck %s
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [2], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+// CHECK: module attributes {{.*}}triton_gpu.vectorization = [
+// CHECK-SAME: "{{.*}}:{{[0-9]+}}:{{[0-9]+}}: tt.load: 4 x 32-bit, limited by 128-bit access width"
+// CHECK-SAME: "{{.*}}:{{[0-9]+}}:{{[0-9]+}}: tt.store: 4 x 32-bit, limited by 128-bit access width"
+// CHECK-SAME: ]
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 2 : i32} {
+  tt.func @vec4(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+    %0 = tt.make_range {end = 256 : i32, start = 0 : i32} : tensor<256xi32, #blocked0>
+    %1 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<256x!tt.ptr<f32>, #blocked0>
+    %2 = tt.addptr %1, %0 : tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xi32, #blocked0>
+    %3 = tt.load %2 : tensor<256x!tt.ptr<f32>, #blocked0>
+    %4 = tt.splat %arg1 : !tt.ptr<f32> -> tensor<256x!tt.ptr<f32>, #blocked0>
+    %5 = tt.addptr %4, %0 : tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xi32, #blocked0>
+    tt.store %5, %3 : tensor<256x!tt.ptr<f32>, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [2], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+// CHECK: module attributes {{.*}}triton_gpu.vectorization = [
+// CHECK-SAME: "{{.*}}tt.load: 1 x 32-bit, limited by sizePerThread"
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 2 : i32} {
+  tt.func @size_per_thread(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+    %0 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32, #blocked0>
+    %1 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<64x!tt.ptr<f32>, #blocked0>
+    %2 = tt.addptr %1, %0 : tensor<64x!tt.ptr<f32>, #blocked0>, tensor<64xi32, #blocked0>
+    %3 = tt.load %2 : tensor<64x!tt.ptr<f32>, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [2], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+// CHECK: module attributes {{.*}}triton_gpu.vectorization = [
+// CHECK-SAME: "{{.*}}tt.load: 1 x 32-bit, limited by pointer divisibility"
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 2 : i32} {
+  tt.func @pointer_divisibility(%arg0: !tt.ptr<f32> {tt.divisibility = 4 : i32}) {
+    %0 = tt.make_range {end = 256 : i32, start = 0 : i32} : tensor<256xi32, #blocked0>
+    %1 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<256x!tt.ptr<f32>, #blocked0>
+    %2 = tt.addptr %1, %0 : tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xi32, #blocked0>
+    %3 = tt.load %2 : tensor<256x!tt.ptr<f32>, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [2], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+// CHECK: module attributes {{.*}}triton_gpu.vectorization = [
+// CHECK-SAME: "{{.*}}tt.load: 4 x 32-bit, limited by 128-bit access width; 1 x 32-bit where partially masked, limited by mask constancy"
+// CHECK-SAME: "{{.*}}tt.store: 4 x 32-bit, limited by 128-bit access width; 1 x 32-bit where partially masked, limited by mask constancy"
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 2 : i32} {
+  // A ragged mask keeps full-width accesses for vectors that are entirely
+  // enabled and uses scalar ones for the others.
+  // CHECK-LABEL: mask_constancy
+  //       CHECK: llvm.and
+  //       CHECK: llvm.and
+  //       CHECK: llvm.and
+  //       CHECK: llvm.inline_asm
+  //  CHECK-SAME: ld.global.v4.b32
+  // CHECK-COUNT-4: ld.global.b32
+  // CHECK-COUNT-4: llvm.select
+  //       CHECK: llvm.inline_asm
+  //  CHECK-SAME: st.global.v4.b32
+  // CHECK-COUNT-4: st.global.b32
+  tt.func @mask_constancy(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %n: i32) {
+    %0 = tt.make_range {end = 256 : i32, start = 0 : i32} : tensor<256xi32, #blocked0>
+    %1 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<256x!tt.ptr<f32>, #blocked0>
+    %2 = tt.addptr %1, %0 : tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xi32, #blocked0>
+    %3 = tt.splat %n : i32 -> tensor<256xi32, #blocked0>
+    %4 = arith.cmpi slt, %0, %3 : tensor<256xi32, #blocked0>
+    %5 = tt.load %2, %4 : tensor<256x!tt.ptr<f32>, #blocked0>
+    %6 = tt.splat %arg1 : !tt.ptr<f32> -> tensor<256x!tt.ptr<f32>, #blocked0>
+    %7 = tt.addptr %6, %0 : tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xi32, #blocked0>
+    tt.store %7, %5, %4 : tensor<256x!tt.ptr<f32>, #blocked0>
+    tt.return
+  }
+}
@@ -43,6 +43,40 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 :
 
 // -----
 
+#shared0 = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+#shared1 = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: tma_copy_global_to_local_im2col
+  // CHECK: elect.sync
+  // CHECK: "@$0 cp.async.bulk.tensor.4d.shared::cluster.global.im2col.mbarrier::complete_tx::bytes [$1], [$2, {$3, $4, $5, $6}], [$7], {$8, $9};", "b,r,l,r,r,r,r,r,h,h" {{.*}} : (i1, !llvm.ptr<3>, !llvm.ptr<1>, i32, i32, i32, i32, !llvm.ptr<3>, i16, i16) -> !llvm.void
+  // CHECK-NOT: cp.async.bulk.tensor.4d.shared
+  // CHECK: return
+  tt.func @tma_copy_global_to_local_im2col(%tma: !tt.ptr<i64>, %alloc: !tt.memdesc<64x64xf16, #shared1>, %x: i32, %off: i16, %barrier: !tt.memdesc<1xi64, #shared0>, %pred: i1) {
+    triton_nvidia_gpu.async_tma_copy_global_to_local %tma[%x, %x, %x, %x] im2col[%off, %off] %alloc, %barrier, %pred : !tt.ptr<i64>, !tt.memdesc<1xi64, #shared0> -> !tt.memdesc<64x64xf16, #shared1>
+    tt.return
+  }
+}
+
+// -----
+
+#shared0 = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+#shared1 = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0], CTAsPerCGA = [2, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 2 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: tma_copy_global_to_local_multicast
+  // CHECK: fence.mbarrier_init.release.cluster;
+  // CHECK: nvgpu.cluster_arrive {relaxed = false}
+  // CHECK: nvgpu.cluster_wait
+  // CHECK: "@$0 cp.async.bulk.tensor.2d.shared::cluster.global.mbarrier::complete_tx::bytes.multicast::cluster [$1], [$2, {$3, $4}], [$5], $6;", "b,r,l,r,r,r,h" {{.*}} : (i1, !llvm.ptr<3>, !llvm.ptr<1>, i32, i32, !llvm.ptr<3>, i16) -> !llvm.void
+  // CHECK-NOT: cp.async.bulk.tensor.2d.shared
+  // CHECK: return
+  tt.func @tma_copy_global_to_local_multicast(%tma: !tt.ptr<i64>, %alloc: !tt.memdesc<128x128xf16, #shared1>, %x: i32, %barrier: !tt.memdesc<1xi64, #shared0>, %pred: i1) {
+    triton_nvidia_gpu.async_tma_copy_global_to_local %tma[%x, %x] %alloc, %barrier, %pred : !tt.ptr<i64>, !tt.memdesc<1xi64, #shared0> -> !tt.memdesc<128x128xf16, #shared1>
+    tt.return
+  }
+}
+
+// -----
+
 #shared1 = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
 module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
   // CHECK-LABEL: tma_copy_local_to_global
@@ -58,6 +92,36 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 :
 
 // -----
 
+#shared1 = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: tma_reduce
+  // CHECK: elect.sync
+  // CHECK: "@$0 cp.reduce.async.bulk.tensor.2d.global.shared::cta.add.tile.bulk_group [$1, {$2, $3}], [$4];", "b,l,r,r,r" {{.*}} : (i1, !llvm.ptr<1>, i32, i32, !llvm.ptr<3>) -> !llvm.void
+  // CHECK-NOT: cp.reduce.async.bulk.tensor
+  // CHECK: cp.async.bulk.commit_group
+  tt.func @tma_reduce(%tma: !tt.ptr<i64>, %alloc: !tt.memdesc<128x128xf32, #shared1>, %x: i32) {
+    triton_nvidia_gpu.async_tma_reduce fadd, %tma[%x, %x] %alloc : <i64>, <128x128xf32, #shared1>
+    tt.return
+  }
+}
+
+// -----
+
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // The 256-byte rows are prefetched as two 128-byte boxes.
+  // CHECK-LABEL: tma_prefetch
+  // CHECK: elect.sync
+  // CHECK: "@$0 cp.async.bulk.prefetch.tensor.2d.L2.global.tile [$1, {$2, $3}];", "b,l,r,r" {{.*}} : (i1, !llvm.ptr<1>, i32, i32) -> !llvm.void
+  // CHECK: "@$0 cp.async.bulk.prefetch.tensor.2d.L2.global.tile [$1, {$2, $3}];", "b,l,r,r" {{.*}} : (i1, !llvm.ptr<1>, i32, i32) -> !llvm.void
+  // CHECK-NOT: cp.async.bulk.prefetch.tensor
+  tt.func @tma_prefetch(%tma: !tt.ptr<i64>, %x: i32) {
+    tt.experimental_descriptor_prefetch %tma[%x, %x] : !tt.ptr<i64>, tensor<64x128xf16>
+    tt.return
+  }
+}
+
+// -----
+
 #shared1 = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
 module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
   // CHECK-LABEL: async_tma_store_wait
@@ -79,3 +143,32 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 :
     tt.return
   }
 }
+
+// -----
+
+#shared0 = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 8 : i32} {
+  // CHECK-LABEL: arrive_barrier
+  // CHECK: %[[FIRST:.*]] = llvm.mlir.constant(128 : i32) : i32
+  // CHECK: llvm.icmp "eq" %{{.*}}, %[[FIRST]]
+  // CHECK: "@$0 mbarrier.arrive.shared::cta.b64 _, [$1];", "b,r"
+  // CHECK: "@$0 mbarrier.arrive.shared::cta.b64 _, [$1], 2;", "b,r"
+  tt.func @arrive_barrier(%barrier: !tt.memdesc<1xi64, #shared0, mutable>) {
+    triton_nvidia_gpu.arrive_barrier %barrier {triton_gpu.warp_group = array<i32: 4, 4>} : <1xi64, #shared0, mutable>
+    triton_nvidia_gpu.arrive_barrier %barrier {count = 2 : i32} : <1xi64, #shared0, mutable>
+    tt.return
+  }
+}
+
+// -----
+
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 8 : i32} {
+  // CHECK-LABEL: set_max_nreg
+  // CHECK: "setmaxnreg.dec.sync.aligned.u32 40;", ""  : () -> !llvm.void
+  // CHECK: "setmaxnreg.inc.sync.aligned.u32 232;", ""  : () -> !llvm.void
+  tt.func @set_max_nreg() {
+    triton_nvidia_gpu.reg_dealloc 40
+    triton_nvidia_gpu.reg_alloc 232
+    tt.return
+  }
+}
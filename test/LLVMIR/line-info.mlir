@@ -0,0 +1,20 @@
+// RUN: triton-opt %s -enable-line-info -mlir-print-debuginfo | FileCheck %s
+
+// CHECK-LABEL: llvm.func @unknown_locs
+llvm.func @unknown_locs(%arg0: i32) -> i32 {
+  // CHECK: llvm.mlir.constant(1 : i32) : i32 loc([[LOC:#loc[0-9]*]])
+  // CHECK-NEXT: llvm.add %{{.*}}, %{{.*}} : i32 loc([[LOC]])
+  %0 = llvm.mlir.constant(1 : i32) : i32 loc(#loc1)
+  %1 = llvm.add %arg0, %0 : i32 loc(unknown)
+  // CHECK: llvm.br ^bb1 loc([[BR_LOC:#loc[0-9]*]])
+  llvm.br ^bb1 loc(#loc2)
+^bb1:
+  // CHECK: llvm.mul %{{.*}}, %{{.*}} : i32 loc([[FUNC_LOC:#loc[0-9]*]])
+  %2 = llvm.mul %1, %1 : i32 loc(unknown)
+  llvm.return %2 : i32 loc(#loc3)
+} loc(#loc)
+
+#loc = loc("kernel.py":1:0)
+#loc1 = loc("kernel.py":2:4)
+#loc2 = loc("kernel.py":3:4)
+#loc3 = loc("kernel.py":4:4)
@@ -355,3 +355,65 @@ tt.func @test_nested_transpose(%arg0: tensor<2x4x8xf32>) -> (tensor<8x2x4xf32>)
     // CHECK: tt.return %[[res]]
     tt.return %b : tensor<8x2x4xf32>
 }
+
+// CHECK-LABEL: @test_combine_batched_broadcast_mul_reduce
+tt.func @test_combine_batched_broadcast_mul_reduce(%x: tensor<2x32x64xf32>, %y: tensor<2x64x16xf32>) -> tensor<2x32x16xf32> {
+    // CHECK: %[[res:.*]] = tt.dot %arg0, %arg1, %{{.*}} : tensor<2x32x64xf32> * tensor<2x64x16xf32> -> tensor<2x32x16xf32>
+    // CHECK: tt.return %[[res]]
+    %0 = tt.expand_dims %x {axis = 3 : i32} : tensor<2x32x64xf32> -> tensor<2x32x64x1xf32>
+    %1 = tt.broadcast %0 : tensor<2x32x64x1xf32> -> tensor<2x32x64x16xf32>
+    %2 = tt.expand_dims %y {axis = 1 : i32} : tensor<2x64x16xf32> -> tensor<2x1x64x16xf32>
+    %3 = tt.broadcast %2 : tensor<2x1x64x16xf32> -> tensor<2x32x64x16xf32>
+    %4 = arith.mulf %1, %3 : tensor<2x32x64x16xf32>
+    %5 = "tt.reduce" (%4) ({
+    ^bb0(%arg0: f32, %arg1: f32):
+      %add = arith.addf %arg0, %arg1 : f32
+      tt.reduce.return %add : f32
+    }) {axis = 2 : i32} : (tensor<2x32x64x16xf32>) -> tensor<2x32x16xf32>
+    tt.return %5 : tensor<2x32x16xf32>
+}
+
+// CHECK-LABEL: @test_combine_broadcast_mul_reduce_small_k
+tt.func @test_combine_broadcast_mul_reduce_small_k(%x: tensor<32x4xf16>, %y: tensor<4x32xf16>) -> tensor<32x32xf16> {
+    // The K of both operands is interleaved with zeros up to 16.
+    // CHECK: tt.join %arg0
+    // CHECK: tt.reshape {{.*}} -> tensor<32x8xf16>
+    // CHECK: tt.join
+    // CHECK: %[[x:.*]] = tt.reshape {{.*}} -> tensor<32x16xf16>
+    // CHECK: tt.join %arg1
+    // CHECK: tt.trans {{.*}} {order = array<i32: 0, 2, 1>}
+    // CHECK: tt.reshape {{.*}} -> tensor<8x32xf16>
+    // CHECK: tt.join
+    // CHECK: tt.trans
+    // CHECK: %[[y:.*]] = tt.reshape {{.*}} -> tensor<16x32xf16>
+    // CHECK: tt.dot %[[x]], %[[y]], %{{.*}} : tensor<32x16xf16> * tensor<16x32xf16> -> tensor<32x32xf16>
+    %0 = tt.expand_dims %x {axis = 2 : i32} : tensor<32x4xf16> -> tensor<32x4x1xf16>
+    %1 = tt.broadcast %0 : tensor<32x4x1xf16> -> tensor<32x4x32xf16>
+    %2 = tt.expand_dims %y {axis = 0 : i32} : tensor<4x32xf16> -> tensor<1x4x32xf16>
+    %3 = tt.broadcast %2 : tensor<1x4x32xf16> -> tensor<32x4x32xf16>
+    %4 = arith.mulf %3, %1 : tensor<32x4x32xf16>
+    %5 = "tt.reduce" (%4) ({
+    ^bb0(%arg0: f16, %arg1: f16):
+      %add = arith.addf %arg0, %arg1 : f16
+      tt.reduce.return %add : f16
+    }) {axis = 1 : i32} : (tensor<32x4x32xf16>) -> tensor<32x32xf16>
+    tt.return %5 : tensor<32x32xf16>
+}
+
+// CHECK-LABEL: @test_no_combine_skinny_mul_reduce
+tt.func @test_no_combine_skinny_mul_reduce(%x: tensor<32x64xf32>, %y: tensor<64x8xf32>) -> tensor<32x8xf32> {
+    // An N below the mma tiles is left as a reduction.
+    // CHECK-NOT: tt.dot
+    // CHECK: tt.reduce
+    %0 = tt.expand_dims %x {axis = 2 : i32} : tensor<32x64xf32> -> tensor<32x64x1xf32>
+    %1 = tt.broadcast %0 : tensor<32x64x1xf32> -> tensor<32x64x8xf32>
+    %2 = tt.expand_dims %y {axis = 0 : i32} : tensor<64x8xf32> -> tensor<1x64x8xf32>
+    %3 = tt.broadcast %2 : tensor<1x64x8xf32> -> tensor<32x64x8xf32>
+    %4 = arith.mulf %1, %3 : tensor<32x64x8xf32>
+    %5 = "tt.reduce" (%4) ({
+    ^bb0(%arg0: f32, %arg1: f32):
+      %add = arith.addf %arg0, %arg1 : f32
+      tt.reduce.return %add : f32
+    }) {axis = 1 : i32} : (tensor<32x64x8xf32>) -> tensor<32x8xf32>
+    tt.return %5 : tensor<32x8xf32>
+}
@@ -0,0 +1,43 @@
+// RUN: triton-opt %s -split-input-file --triton-decompose-scaled-dot | FileCheck %s
+
+// CHECK-LABEL: @mxfp8_e8m0_scales
+//   CHECK-DAG: %[[A:.*]] = tt.fp_to_fp %arg0 : tensor<128x64xf8E4M3FNUZ> -> tensor<128x64xbf16>
+//   CHECK-DAG: %[[B:.*]] = tt.fp_to_fp %arg1 : tensor<64x128xf8E5M2> -> tensor<64x128xbf16>
+//   CHECK-DAG: %[[SA:.*]] = tt.reshape %{{.*}} {allow_reorder = false} : tensor<128x2x32xbf16> -> tensor<128x64xbf16>
+//   CHECK-DAG: %[[AS:.*]] = arith.mulf %[[A]], %[[SA]] : tensor<128x64xbf16>
+//   CHECK-DAG: %[[SB:.*]] = tt.trans %{{.*}} {order = array<i32: 1, 0>} : tensor<128x64xbf16> -> tensor<64x128xbf16>
+//   CHECK-DAG: %[[BS:.*]] = arith.mulf %[[B]], %[[SB]] : tensor<64x128xbf16>
+//       CHECK: tt.dot %[[AS]], %[[BS]], %arg4 : tensor<128x64xbf16> * tensor<64x128xbf16> -> tensor<128x128xf32>
+//   CHECK-NOT: tt.dot_scaled
+tt.func @mxfp8_e8m0_scales(%arg0: tensor<128x64xf8E4M3FNUZ>, %arg1: tensor<64x128xf8E5M2>, %arg2: tensor<128x2xi8>, %arg3: tensor<128x2xi8>, %arg4: tensor<128x128xf32>) -> tensor<128x128xf32> {
+  %0 = tt.dot_scaled %arg0 scale %arg2, %arg1 scale %arg3, %arg4 lhs = e4m3 rhs = e5m2 : tensor<128x64xf8E4M3FNUZ>, tensor<128x2xi8> * tensor<64x128xf8E5M2>, tensor<128x2xi8> -> tensor<128x128xf32>
+  tt.return %0 : tensor<128x128xf32>
+}
+
+// -----
+
+// CHECK-LABEL: @mxfp4_lhs_bf16_rhs
+//       CHECK: %[[LO:.*]] = arith.andi %arg0
+//       CHECK: %[[HI:.*]] = arith.shrui %arg0
+//       CHECK: %[[J:.*]] = tt.join %{{.*}}, %{{.*}} : tensor<128x32xbf16> -> tensor<128x32x2xbf16>
+//       CHECK: %[[A:.*]] = tt.reshape %[[J]] {allow_reorder = false} : tensor<128x32x2xbf16> -> tensor<128x64xbf16>
+//       CHECK: %[[AS:.*]] = arith.mulf %[[A]], %{{.*}} : tensor<128x64xbf16>
+//       CHECK: tt.dot %[[AS]], %arg1, %arg3 : tensor<128x64xbf16> * tensor<64x128xbf16> -> tensor<128x128xf32>
+tt.func @mxfp4_lhs_bf16_rhs(%arg0: tensor<128x32xi8>, %arg1: tensor<64x128xbf16>, %arg2: tensor<128x2xi8>, %arg3: tensor<128x128xf32>) -> tensor<128x128xf32> {
+  %0 = tt.dot_scaled %arg0 scale %arg2, %arg1, %arg3 lhs = e2m1 rhs = bf16 : tensor<128x32xi8>, tensor<128x2xi8> * tensor<64x128xbf16> -> tensor<128x128xf32>
+  tt.return %0 : tensor<128x128xf32>
+}
+
+// -----
+
+// CHECK-LABEL: @nvfp4_rhs
+//       CHECK: tt.join %{{.*}}, %{{.*}} : tensor<32x128xbf16> -> tensor<32x128x2xbf16>
+//       CHECK: tt.trans %{{.*}} {order = array<i32: 0, 2, 1>} : tensor<32x128x2xbf16> -> tensor<32x2x128xbf16>
+//       CHECK: tt.reshape %{{.*}} {allow_reorder = false} : tensor<32x2x128xbf16> -> tensor<64x128xbf16>
+//       CHECK: tt.fp_to_fp %arg2 : tensor<128x4xf8E4M3FNUZ> -> tensor<128x4xbf16>
+//       CHECK: tt.broadcast %{{.*}} : tensor<128x4x1xbf16> -> tensor<128x4x16xbf16>
+//       CHECK: tt.dot
+tt.func @nvfp4_rhs(%arg0: tensor<128x64xbf16>, %arg1: tensor<32x128xi8>, %arg2: tensor<128x4xf8E4M3FNUZ>, %arg3: tensor<128x128xf32>) -> tensor<128x128xf32> {
+  %0 = tt.dot_scaled %arg0, %arg1 scale %arg2, %arg3 lhs = bf16 rhs = e2m1 : tensor<128x64xbf16> * tensor<32x128xi8>, tensor<128x4xf8E4M3FNUZ> -> tensor<128x128xf32>
+  tt.return %0 : tensor<128x128xf32>
+}
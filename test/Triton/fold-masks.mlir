@@ -0,0 +1,98 @@
+// RUN: triton-opt %s -split-input-file -triton-fold-masks | FileCheck %s
+
+// CHECK-LABEL: @fold_true_masks
+tt.func @fold_true_masks(%ptr: tensor<64x!tt.ptr<f32>>) -> tensor<64xf32> {
+  %cst = arith.constant dense<0.000000e+00> : tensor<64xf32>
+  %c64 = arith.constant dense<64> : tensor<64xi32>
+  %c0 = arith.constant dense<0> : tensor<64xi32>
+  %pid = tt.get_program_id x : i32
+  %pids = tt.splat %pid : i32 -> tensor<64xi32>
+  %range = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32>
+  // The offsets are within the block, and the program ids are not negative.
+  %lt = arith.cmpi slt, %range, %c64 : tensor<64xi32>
+  %ge = arith.cmpi sge, %pids, %c0 : tensor<64xi32>
+  %mask = arith.andi %lt, %ge : tensor<64xi1>
+  // CHECK-NOT: arith.cmpi
+  // CHECK: %[[X:.*]] = tt.load %{{.*}} : tensor<64x!tt.ptr<f32>>
+  %x = tt.load %ptr, %mask, %cst : tensor<64x!tt.ptr<f32>>
+  // CHECK: tt.store %{{.*}}, %[[X]] : tensor<64x!tt.ptr<f32>>
+  tt.store %ptr, %x, %mask : tensor<64x!tt.ptr<f32>>
+  tt.return %x : tensor<64xf32>
+}
+
+// -----
+
+// CHECK-LABEL: @fold_loop_masks
+tt.func @fold_loop_masks(%ptr: tensor<16x!tt.ptr<f32>>) {
+  %c0 = arith.constant 0 : i32
+  %c1 = arith.constant 1 : i32
+  %c4 = arith.constant 4 : i32
+  %c16 = arith.constant 16 : i32
+  %c64 = arith.constant dense<64> : tensor<16xi32>
+  %range = tt.make_range {end = 16 : i32, start = 0 : i32} : tensor<16xi32>
+  // The last block of the loop ends at 64.
+  // CHECK: scf.for
+  scf.for %i = %c0 to %c4 step %c1 : i32 {
+    %start = arith.muli %i, %c16 : i32
+    %starts = tt.splat %start : i32 -> tensor<16xi32>
+    %offs = arith.addi %starts, %range : tensor<16xi32>
+    %mask = arith.cmpi slt, %offs, %c64 : tensor<16xi32>
+    %ptrs = tt.addptr %ptr, %offs : tensor<16x!tt.ptr<f32>>, tensor<16xi32>
+    // CHECK: %[[X:.*]] = tt.load %{{.*}} : tensor<16x!tt.ptr<f32>>
+    %x = tt.load %ptrs, %mask : tensor<16x!tt.ptr<f32>>
+    // CHECK: tt.store %{{.*}}, %[[X]] : tensor<16x!tt.ptr<f32>>
+    tt.store %ptrs, %x, %mask : tensor<16x!tt.ptr<f32>>
+  }
+  tt.return
+}
+
+// -----
+
+// CHECK-LABEL: @fold_false_masks
+tt.func @fold_false_masks(%ptr: tensor<16x!tt.ptr<f32>>) -> tensor<16xf32> {
+  // CHECK: %[[CST:.*]] = arith.constant dense<1.000000e+00>
+  %cst = arith.constant dense<1.000000e+00> : tensor<16xf32>
+  %c16 = arith.constant dense<16> : tensor<16xi32>
+  %range = tt.make_range {end = 16 : i32, start = 0 : i32} : tensor<16xi32>
+  %mask = arith.cmpi sge, %range, %c16 : tensor<16xi32>
+  // CHECK-NOT: tt.load
+  %x = tt.load %ptr, %mask, %cst : tensor<16x!tt.ptr<f32>>
+  // CHECK-NOT: tt.store
+  tt.store %ptr, %x, %mask : tensor<16x!tt.ptr<f32>>
+  // CHECK: tt.return %[[CST]]
+  tt.return %x : tensor<16xf32>
+}
+
+// -----
+
+// CHECK-LABEL: @keep_masks
+tt.func @keep_masks(%ptr: tensor<64x!tt.ptr<f32>>, %n: i32) -> tensor<64xf32> {
+  %c64 = arith.constant 64 : i32
+  // The offsets of the program may be past the end, even if %n is a multiple
+  // of the block size.
+  %pid = tt.get_program_id x : i32
+  %start = arith.muli %pid, %c64 : i32
+  %starts = tt.splat %start : i32 -> tensor<64xi32>
+  %range = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32>
+  %offs = arith.addi %starts, %range : tensor<64xi32>
+  %ns = tt.splat %n : i32 -> tensor<64xi32>
+  // CHECK: %[[MASK:.*]] = arith.cmpi slt
+  %mask = arith.cmpi slt, %offs, %ns : tensor<64xi32>
+  // CHECK: tt.load %{{.*}}, %[[MASK]] :
+  %x = tt.load %ptr, %mask : tensor<64x!tt.ptr<f32>>
+  tt.return %x : tensor<64xf32>
+}
+
+// -----
+
+// CHECK-LABEL: @fold_bounded_arg_masks
+tt.func @fold_bounded_arg_masks(%ptr: tensor<64x!tt.ptr<f32>>, %n: i32 {tt.min_value = 1025 : i32, tt.max_value = 8192 : i32}) -> tensor<64xf32> {
+  // %n is larger than the offsets of the first block.
+  %range = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32>
+  %ns = tt.splat %n : i32 -> tensor<64xi32>
+  %mask = arith.cmpi slt, %range, %ns : tensor<64xi32>
+  // CHECK-NOT: arith.cmpi
+  // CHECK: tt.load %{{.*}} : tensor<64x!tt.ptr<f32>>
+  %x = tt.load %ptr, %mask : tensor<64x!tt.ptr<f32>>
+  tt.return %x : tensor<64xf32>
+}
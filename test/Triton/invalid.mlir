@@ -114,6 +114,18 @@ tt.func public @fn(%v1: tensor<4x128xf32>, %v2: tensor<4x128xi64>) {
 
 // -----
 
+tt.func public @fn(%v: tensor<4x128xf32>, %flags: tensor<4x128xi32>) {
+    // expected-error @+1 {{head flags of a segmented scan must be i1}}
+    %a, %b = "tt.scan" (%v, %flags) ({
+    ^bb0(%arg0: f32, %arg1: f32):
+      %add = arith.addf %arg0, %arg1 : f32
+      tt.scan.return %add : f32
+    }) {axis = 0 : i32, reverse = false, segmented}  : (tensor<4x128xf32>, tensor<4x128xi32>) -> (tensor<4x128xf32>, tensor<4x128xi32>)
+    tt.return
+}
+
+// -----
+
 tt.func public @fn(%v1: tensor<4x128xf32>, %v2: tensor<4x128xi64>) {
     // expected-error @+1 {{operand types and result types}}
     %a, %b = "tt.reduce" (%v1, %v2) ({
@@ -336,3 +348,83 @@ tt.func public @fn(%arg0: tensor<16x32x64xf32, #shared>) {
     tt.return
 }
 }  // end module
+
+// -----
+
+tt.func public @fn(%arg0: tensor<128x16xf32>, %arg1: tensor<64x8xi32>) {
+    // expected-error @+1 {{indices dimension 1 must match the corresponding input dimension}}
+    %a = tt.gather %arg0[%arg1] {axis = 0 : i32} : (tensor<128x16xf32>, tensor<64x8xi32>) -> tensor<64x8xf32>
+    tt.return
+}
+
+// -----
+
+tt.func public @fn(%arg0: tensor<128x16xf32>, %arg1: tensor<64x16xi32>) {
+    // expected-error @+1 {{indices and output shapes must match}}
+    %a = tt.gather %arg0[%arg1] {axis = 0 : i32} : (tensor<128x16xf32>, tensor<64x16xi32>) -> tensor<128x16xf32>
+    tt.return
+}
+
+// -----
+
+tt.func public @fn(%arg0: tensor<512xi32>, %arg1: tensor<512xf32>) {
+    // expected-error @+1 {{result element type must match the weights}}
+    %a = tt.histogram %arg0, weights %arg1 : tensor<512xf32> : tensor<512xi32> -> tensor<16xi32>
+    tt.return
+}
+
+// -----
+
+tt.func public @fn(%arg0: tensor<512xi32>, %arg1: tensor<256xi1>) {
+    // expected-error @+1 {{mask and weights must have the shape and encoding of the input}}
+    %a = tt.histogram %arg0, mask %arg1 : tensor<256xi1> : tensor<512xi32> -> tensor<16xi32>
+    tt.return
+}
+
+// -----
+
+tt.func public @fn(%a: tensor<64x32xf16>, %b: tensor<64x16xf16>, %c: tensor<64x16xf32>, %meta: tensor<64x2xi16>) {
+    // expected-error @+1 {{metadata must be an MxK/16 tensor of i16}}
+    %d = tt.sparse_dot %a, %b, %c, %meta : tensor<64x32xf16> meta tensor<64x2xi16> * tensor<64x16xf16> -> tensor<64x16xf32>
+    tt.return
+}
+
+// -----
+
+tt.func public @fn(%a: tensor<64x64xf16>, %b: tensor<64x16xf16>, %c: tensor<64x16xf32>, %meta: tensor<64x4xi16>) {
+    // expected-error @+1 {{A must hold half of the K elements of B}}
+    %d = tt.sparse_dot %a, %b, %c, %meta : tensor<64x64xf16> meta tensor<64x4xi16> * tensor<64x16xf16> -> tensor<64x16xf32>
+    tt.return
+}
+
+// -----
+
+tt.func public @fn(%base: !tt.ptr<f16>, %pages: !tt.ptr<i64>, %n: i64, %off: i32) {
+    // expected-error @+1 {{page table of i32 page indices}}
+    %0 = tt.make_tensor_ptr %base, [%n, %n], [%n, %n], [%off, %off] pages %pages : !tt.ptr<i64> {order = array<i32: 1, 0>, pageSize = 16 : i32} : !tt.ptr<tensor<64x64xf16>>
+    tt.return
+}
+
+// -----
+
+tt.func public @fn(%base: !tt.ptr<f16>, %pages: !tt.ptr<i32>, %n: i64, %off: i32) {
+    // expected-error @+1 {{expects a page size with a page table}}
+    %0 = tt.make_tensor_ptr %base, [%n, %n], [%n, %n], [%off, %off] pages %pages : !tt.ptr<i32> {order = array<i32: 1, 0>} : !tt.ptr<tensor<64x64xf16>>
+    tt.return
+}
+
+// -----
+
+tt.func public @fn(%a: tensor<32x64xf16>, %b: tensor<64x32xf16>, %c: tensor<32x32xf32>) {
+    // expected-error @+1 {{kExtent must be within the K dimension of 64, but got 96}}
+    %d = tt.dot %a, %b, %c {kExtent = 96 : i32} : tensor<32x64xf16> * tensor<64x32xf16> -> tensor<32x32xf32>
+    tt.return
+}
+
+// -----
+
+tt.func public @fn(%desc: !tt.ptr<i8>, %x: i32, %v: tensor<64x64xf32>) {
+    // expected-error @+1 {{TMA reductions don't support max of f32}}
+    tt.experimental_descriptor_reduce max, %desc[%x, %x], %v : !tt.ptr<i8>, tensor<64x64xf32>
+    tt.return
+}
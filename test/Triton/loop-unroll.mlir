@@ -0,0 +1,79 @@
+// RUN: triton-opt %s -split-input-file -triton-loop-unroll | FileCheck %s
+
+// The iterations left over by the unrolled loop run in a remainder loop.
+// CHECK-LABEL: @unroll_remainder
+// CHECK: %[[MAIN:.*]] = scf.for
+// CHECK-COUNT-2: tt.load
+// CHECK-NOT: tt.load
+// CHECK: scf.yield
+// CHECK: scf.for {{.*}} iter_args(%{{.*}} = %[[MAIN]])
+// CHECK: tt.load
+// CHECK-NOT: tt.load
+// CHECK: scf.yield
+// CHECK-NOT: tt.loop_unroll_factor
+tt.func @unroll_remainder(%base: !tt.ptr<f32>, %n: i32) -> f32 {
+  %c0_i32 = arith.constant 0 : i32
+  %c1_i32 = arith.constant 1 : i32
+  %zero = arith.constant 0.000000e+00 : f32
+  %res = scf.for %i = %c0_i32 to %n step %c1_i32 iter_args(%acc = %zero) -> (f32) : i32 {
+    %ptr = tt.addptr %base, %i : !tt.ptr<f32>, i32
+    %x = tt.load %ptr : !tt.ptr<f32>
+    %next = arith.addf %acc, %x : f32
+    scf.yield %next : f32
+  } {tt.loop_unroll_factor = 2 : i32}
+  tt.return %res : f32
+}
+
+// -----
+
+// The loads of the interleaved copies are issued before their uses.
+// CHECK-LABEL: @interleave
+// CHECK: scf.for
+// CHECK: tt.addptr
+// CHECK-NEXT: tt.addptr
+// CHECK-NEXT: tt.load
+// CHECK-NEXT: tt.load
+// CHECK-NEXT: arith.addf
+// CHECK-NEXT: arith.addf
+// CHECK-NEXT: scf.yield
+// CHECK-NOT: tt.loop_interleave_factor
+tt.func @interleave(%base: !tt.ptr<f32>) -> f32 {
+  %c0_i32 = arith.constant 0 : i32
+  %c1_i32 = arith.constant 1 : i32
+  %c8_i32 = arith.constant 8 : i32
+  %zero = arith.constant 0.000000e+00 : f32
+  %res = scf.for %i = %c0_i32 to %c8_i32 step %c1_i32 iter_args(%acc = %zero) -> (f32) : i32 {
+    %ptr = tt.addptr %base, %i : !tt.ptr<f32>, i32
+    %x = tt.load %ptr : !tt.ptr<f32>
+    %next = arith.addf %acc, %x : f32
+    scf.yield %next : f32
+  } {tt.loop_interleave_factor = 2 : i32, tt.loop_unroll_factor = 2 : i32}
+  tt.return %res : f32
+}
+
+// -----
+
+// The loads and stores of the interleaved copies keep their order.
+// CHECK-LABEL: @interleave_stores
+// CHECK: scf.for
+// CHECK: tt.addptr
+// CHECK-NEXT: tt.addptr
+// CHECK-NEXT: tt.load
+// CHECK-NEXT: arith.addf
+// CHECK-NEXT: tt.store
+// CHECK-NEXT: tt.load
+// CHECK-NEXT: arith.addf
+// CHECK-NEXT: tt.store
+tt.func @interleave_stores(%base: !tt.ptr<f32>) {
+  %c0_i32 = arith.constant 0 : i32
+  %c1_i32 = arith.constant 1 : i32
+  %c8_i32 = arith.constant 8 : i32
+  %one = arith.constant 1.000000e+00 : f32
+  scf.for %i = %c0_i32 to %c8_i32 step %c1_i32 : i32 {
+    %ptr = tt.addptr %base, %i : !tt.ptr<f32>, i32
+    %x = tt.load %ptr : !tt.ptr<f32>
+    %y = arith.addf %x, %one : f32
+    tt.store %ptr, %y : !tt.ptr<f32>
+  } {tt.loop_interleave_factor = 2 : i32, tt.loop_unroll_factor = 2 : i32}
+  tt.return
+}
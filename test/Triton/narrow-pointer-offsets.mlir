@@ -0,0 +1,73 @@
+// RUN: triton-opt %s -split-input-file -triton-narrow-pointer-offsets | FileCheck %s
+
+// CHECK-LABEL: @narrow_extended_offsets
+tt.func @narrow_extended_offsets(%arg0: !tt.ptr<f32>) -> tensor<128xf32> {
+  %c128 = arith.constant 128 : i32
+  %pid = tt.get_program_id x : i32
+  %start = arith.muli %pid, %c128 : i32
+  %starts = tt.splat %start : i32 -> tensor<128xi32>
+  %range = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  // CHECK: %[[OFFS:.*]] = arith.addi
+  %offs = arith.addi %starts, %range : tensor<128xi32>
+  %offs64 = arith.extsi %offs : tensor<128xi32> to tensor<128xi64>
+  %ptrs = tt.splat %arg0 : !tt.ptr<f32> -> tensor<128x!tt.ptr<f32>>
+  // CHECK: tt.addptr %{{.*}}, %[[OFFS]] : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  %0 = tt.addptr %ptrs, %offs64 : tensor<128x!tt.ptr<f32>>, tensor<128xi64>
+  %1 = tt.load %0 : tensor<128x!tt.ptr<f32>>
+  tt.return %1 : tensor<128xf32>
+}
+
+// -----
+
+// CHECK-LABEL: @move_uniform_offsets
+tt.func @move_uniform_offsets(%arg0: !tt.ptr<f32>, %stride: i64) -> tensor<128xf32> {
+  %pid = tt.get_program_id x : i32
+  %pid64 = arith.extsi %pid : i32 to i64
+  // CHECK: %[[ROW:.*]] = arith.muli
+  %row = arith.muli %pid64, %stride : i64
+  %rows = tt.splat %row : i64 -> tensor<128xi64>
+  // CHECK: %[[RANGE:.*]] = tt.make_range
+  %range = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  %range64 = arith.extsi %range : tensor<128xi32> to tensor<128xi64>
+  %offs = arith.addi %rows, %range64 : tensor<128xi64>
+  %ptrs = tt.splat %arg0 : !tt.ptr<f32> -> tensor<128x!tt.ptr<f32>>
+  // CHECK: %[[BASE:.*]] = tt.addptr %arg0, %[[ROW]] : !tt.ptr<f32>, i64
+  // CHECK: %[[BASES:.*]] = tt.splat %[[BASE]] : !tt.ptr<f32> -> tensor<128x!tt.ptr<f32>>
+  // CHECK: tt.addptr %[[BASES]], %[[RANGE]] : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  %0 = tt.addptr %ptrs, %offs : tensor<128x!tt.ptr<f32>>, tensor<128xi64>
+  %1 = tt.load %0 : tensor<128x!tt.ptr<f32>>
+  tt.return %1 : tensor<128xf32>
+}
+
+// -----
+
+// CHECK-LABEL: @narrow_arithmetic
+tt.func @narrow_arithmetic(%arg0: !tt.ptr<f32>) -> tensor<128xf32> {
+  %c4 = arith.constant dense<4> : tensor<128xi64>
+  // CHECK-DAG: %[[RANGE:.*]] = tt.make_range
+  // CHECK-DAG: %[[C4:.*]] = arith.constant dense<4> : tensor<128xi32>
+  %range = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  %range64 = arith.extsi %range : tensor<128xi32> to tensor<128xi64>
+  // CHECK: %[[OFFS:.*]] = arith.muli %[[RANGE]], %[[C4]] : tensor<128xi32>
+  %offs = arith.muli %range64, %c4 : tensor<128xi64>
+  %ptrs = tt.splat %arg0 : !tt.ptr<f32> -> tensor<128x!tt.ptr<f32>>
+  // CHECK: tt.addptr %{{.*}}, %[[OFFS]] : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  %0 = tt.addptr %ptrs, %offs : tensor<128x!tt.ptr<f32>>, tensor<128xi64>
+  %1 = tt.load %0 : tensor<128x!tt.ptr<f32>>
+  tt.return %1 : tensor<128xf32>
+}
+
+// -----
+
+// CHECK-LABEL: @keep_wide_offsets
+tt.func @keep_wide_offsets(%arg0: !tt.ptr<f32>, %idx: tensor<128xi32>) -> tensor<128xf32> {
+  %c8 = arith.constant dense<8> : tensor<128xi64>
+  // The offsets of the gather don't fit in 32 bits.
+  %idx64 = arith.extsi %idx : tensor<128xi32> to tensor<128xi64>
+  %offs = arith.muli %idx64, %c8 : tensor<128xi64>
+  %ptrs = tt.splat %arg0 : !tt.ptr<f32> -> tensor<128x!tt.ptr<f32>>
+  // CHECK: tt.addptr %{{.*}}, %{{.*}} : tensor<128x!tt.ptr<f32>>, tensor<128xi64>
+  %0 = tt.addptr %ptrs, %offs : tensor<128x!tt.ptr<f32>>, tensor<128xi64>
+  %1 = tt.load %0 : tensor<128x!tt.ptr<f32>>
+  tt.return %1 : tensor<128xf32>
+}
@@ -76,6 +76,12 @@ tt.func @load_store_ops_scalar(%ptr: !tt.ptr<f32> {tt.divisibility = 16 : i32},
   tt.store %ptr, %b, %mask : !tt.ptr<f32>
   // CHECK: tt.store %{{.*}}, %[[L2]], %{{.*}} : !tt.ptr<f32>
   tt.store %ptr, %c, %mask : !tt.ptr<f32>
+
+  // prefetch scalar
+  // CHECK: tt.prefetch %{{.*}} : !tt.ptr<f32>
+  tt.prefetch %ptr : !tt.ptr<f32>
+  // CHECK: tt.prefetch %{{.*}}, %{{.*}} : !tt.ptr<f32>
+  tt.prefetch %ptr, %mask : !tt.ptr<f32>
   tt.return
 }
 
@@ -207,6 +213,20 @@ tt.func @scan_op(%ptr: tensor<1x2x4x!tt.ptr<f32>>, %v : tensor<1x2x4xf32>) {
   tt.return
 }
 
+// CHECK-LABEL: segmented_scan_op
+tt.func @segmented_scan_op(%v : tensor<2x4xf32>, %flags : tensor<2x4xi1>) {
+  // CHECK: tt.scan
+  // CHECK-SAME: segmented
+  // CHECK: tt.scan.return
+  // CHECK-NEXT: (tensor<2x4xf32>, tensor<2x4xi1>) -> (tensor<2x4xf32>, tensor<2x4xi1>)
+  %a, %b = "tt.scan"(%v, %flags) <{axis = 1 : i32, reverse = false, segmented}>({
+  ^bb0(%arg0: f32, %arg1: f32):
+    %add = arith.addf %arg0, %arg1 : f32
+    tt.scan.return %add : f32
+  }) : (tensor<2x4xf32>, tensor<2x4xi1>) -> (tensor<2x4xf32>, tensor<2x4xi1>)
+  tt.return
+}
+
 // CHECK-LABEL: inline_asm
 // CHECK: tt.elementwise_inline_asm "shl.b32 $0, $0, 3;"
 tt.func @inline_asm(%0: tensor<512xi8>) {
@@ -237,6 +257,22 @@ tt.func @histogram(%0: tensor<512xi32>) {
   tt.return
 }
 
+// CHECK-LABEL: histogram_mask_weights
+tt.func @histogram_mask_weights(%0: tensor<512xi32>, %1: tensor<512xi1>, %2: tensor<512xf32>) {
+  // CHECK: tt.histogram %{{.+}}, mask %{{.+}} : tensor<512xi1> : tensor<512xi32> -> tensor<16xi32>
+  %3 = tt.histogram %0, mask %1 : tensor<512xi1> : tensor<512xi32> -> tensor<16xi32>
+  // CHECK: tt.histogram %{{.+}}, mask %{{.+}} : tensor<512xi1>, weights %{{.+}} : tensor<512xf32> : tensor<512xi32> -> tensor<4096xf32>
+  %4 = tt.histogram %0, mask %1 : tensor<512xi1>, weights %2 : tensor<512xf32> : tensor<512xi32> -> tensor<4096xf32>
+  tt.return
+}
+
+// CHECK-LABEL: gather
+tt.func @gather(%0: tensor<128x16xf32>, %1: tensor<64x16xi32>) -> tensor<64x16xf32> {
+  // CHECK: tt.gather %{{.+}}[%{{.+}}] {axis = 0 : i32} : (tensor<128x16xf32>, tensor<64x16xi32>) -> tensor<64x16xf32>
+  %2 = tt.gather %0[%1] {axis = 0 : i32} : (tensor<128x16xf32>, tensor<64x16xi32>) -> tensor<64x16xf32>
+  tt.return %2 : tensor<64x16xf32>
+}
+
 // CHECK-LABEL: experimental_descriptor_load
 tt.func @experimental_descriptor_load(%0: !tt.ptr<i8>) {
   // CHECK: tt.experimental_descriptor_load %{{.+}}[%{{.+}}] : !tt.ptr<i8> -> tensor<128xf32>
@@ -244,3 +280,10 @@ tt.func @experimental_descriptor_load(%0: !tt.ptr<i8>) {
   %1 = tt.experimental_descriptor_load %0[%c0_i32] : !tt.ptr<i8> -> tensor<128xf32>
   tt.return
 }
+
+// CHECK-LABEL: sparse_dot
+tt.func @sparse_dot(%a: tensor<64x32xf16>, %b: tensor<64x16xf16>, %c: tensor<64x16xf32>, %meta: tensor<64x4xi16>) -> tensor<64x16xf32> {
+  // CHECK: tt.sparse_dot %{{.+}}, %{{.+}}, %{{.+}}, %{{.+}} : tensor<64x32xf16> meta tensor<64x4xi16> * tensor<64x16xf16> -> tensor<64x16xf32>
+  %d = tt.sparse_dot %a, %b, %c, %meta : tensor<64x32xf16> meta tensor<64x4xi16> * tensor<64x16xf16> -> tensor<64x16xf32>
+  tt.return %d : tensor<64x16xf32>
+}
@@ -0,0 +1,39 @@
+// RUN: triton-opt %s -triton-rasterize-program-ids | FileCheck %s
+// RUN: triton-opt %s --triton-rasterize-program-ids='order=hilbert group-size=4' | FileCheck %s --check-prefix=HILBERT
+
+// The program ids are remapped in groups of 8 x ids walked along y.
+// CHECK-LABEL: @store_ids
+// CHECK-DAG: %[[X:.*]] = tt.get_program_id x
+// CHECK-DAG: %[[Y:.*]] = tt.get_program_id y
+// CHECK-DAG: %[[NUM_X:.*]] = tt.get_num_programs x
+// CHECK-DAG: %[[NUM_Y:.*]] = tt.get_num_programs y
+// CHECK: %[[ROWS:.*]] = arith.muli %[[Y]], %[[NUM_X]]
+// CHECK: %[[LINEAR:.*]] = arith.addi %[[X]], %[[ROWS]]
+// CHECK: %[[GROUP_LEN:.*]] = arith.muli %{{.*}}, %[[NUM_Y]]
+// CHECK: arith.divui %[[LINEAR]], %[[GROUP_LEN]]
+// CHECK: %[[GROUP_X:.*]] = arith.minui
+// CHECK: %[[LOCAL:.*]] = arith.remui %[[LINEAR]], %[[GROUP_LEN]]
+// CHECK: %[[OFFSET_X:.*]] = arith.remui %[[LOCAL]], %[[GROUP_X]]
+// CHECK: %[[NEW_X:.*]] = arith.addi %{{.*}}, %[[OFFSET_X]]
+// CHECK: %[[NEW_Y:.*]] = arith.divui %[[LOCAL]], %[[GROUP_X]]
+// CHECK-NOT: tt.get_program_id
+// CHECK: tt.addptr %{{.*}}, %[[NEW_X]]
+// CHECK: tt.store %{{.*}}, %[[NEW_Y]]
+
+// With the Hilbert curve, the ids of the full squares are selected over
+// those of the grouped order.
+// HILBERT-LABEL: @store_ids
+// HILBERT: %[[FULL:.*]] = arith.andi
+// HILBERT: arith.xori
+// HILBERT: %[[NEW_X:.*]] = arith.select %[[FULL]],
+// HILBERT: %[[NEW_Y:.*]] = arith.select %[[FULL]],
+// HILBERT-NOT: tt.get_program_id
+// HILBERT: tt.addptr %{{.*}}, %[[NEW_X]]
+// HILBERT: tt.store %{{.*}}, %[[NEW_Y]]
+tt.func @store_ids(%base: !tt.ptr<i32>) {
+  %x = tt.get_program_id x : i32
+  %y = tt.get_program_id y : i32
+  %ptr = tt.addptr %base, %x : !tt.ptr<i32>, i32
+  tt.store %ptr, %y : !tt.ptr<i32>
+  tt.return
+}
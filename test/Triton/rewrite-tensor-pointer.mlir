@@ -98,3 +98,51 @@ tt.func public @asm_in_loop(%arg0: !tt.ptr<bf16> {tt.divisibility = 16 : i32}) a
   }
   tt.return
 }
+
+// -----
+
+// CHECK-LABEL: @paged_load
+tt.func public @paged_load(%base: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %pages: !tt.ptr<i32>, %len: i64, %start: i32) -> tensor<32x64xf16> {
+  %c0_i32 = arith.constant 0 : i32
+  %c1_i64 = arith.constant 1 : i64
+  %c64_i64 = arith.constant 64 : i64
+  // CHECK-NOT: tt.make_tensor_ptr
+  // CHECK: %[[PAGE:.*]] = arith.divsi %[[ROWS:.*]], %[[SIZE:.*]] : tensor<32x1xi64>
+  // CHECK: %[[IN_PAGE:.*]] = arith.remsi %[[ROWS]], %[[SIZE]] : tensor<32x1xi64>
+  // CHECK: %[[TABLE:.*]] = tt.addptr %{{.*}}, %[[PAGE]] : tensor<32x1x!tt.ptr<i32>>, tensor<32x1xi64>
+  // CHECK: %[[INDEX:.*]] = tt.load %[[TABLE]], %{{.*}}, %{{.*}} : tensor<32x1x!tt.ptr<i32>>
+  // CHECK: %[[INDEX64:.*]] = arith.extsi %[[INDEX]] : tensor<32x1xi32> to tensor<32x1xi64>
+  // CHECK: %[[START:.*]] = arith.muli %[[INDEX64]], %[[SIZE]] : tensor<32x1xi64>
+  // CHECK: %[[ROW:.*]] = arith.addi %[[START]], %[[IN_PAGE]] : tensor<32x1xi64>
+  // CHECK: arith.muli %[[ROW]], %{{.*}} : tensor<32x1xi64>
+  %0 = tt.make_tensor_ptr %base, [%len, %c64_i64], [%c64_i64, %c1_i64], [%start, %c0_i32] pages %pages : !tt.ptr<i32> {order = array<i32: 1, 0>, pageSize = 16 : i32} : !tt.ptr<tensor<32x64xf16>>
+  // CHECK: tt.load %{{.*}}, %{{.*}}, %{{.*}} : tensor<32x64x!tt.ptr<f16>>
+  %1 = tt.load %0 {boundaryCheck = array<i32: 0>, padding = 1 : i32} : !tt.ptr<tensor<32x64xf16>>
+  tt.return %1 : tensor<32x64xf16>
+}
+
+// -----
+
+// The offsets move the pointer to the first element of the block once, and
+// are checked against the bounds once, for all the elements of the block.
+// CHECK-LABEL: @block_base
+tt.func public @block_base(%base: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %rows: i64, %start: i32) -> tensor<32x64xf16> {
+  %c0_i32 = arith.constant 0 : i32
+  %c1_i64 = arith.constant 1 : i64
+  %c64_i64 = arith.constant 64 : i64
+  // CHECK-NOT: tt.make_tensor_ptr
+  // CHECK: %[[OFFSET:.*]] = arith.extsi %{{.*}} : i32 to i64
+  // CHECK: %[[ROW_OFFSET:.*]] = arith.muli %[[OFFSET]], %{{.*}} : i64
+  // CHECK: %[[ROW_BASE:.*]] = tt.addptr %{{.*}}, %[[ROW_OFFSET]] : !tt.ptr<f16>, i64
+  // CHECK: tt.make_range {end = 32 : i32, start = 0 : i32} : tensor<32xi32>
+  // CHECK: %[[BLOCK_BASE:.*]] = tt.addptr %[[ROW_BASE]], %{{.*}} : !tt.ptr<f16>, i64
+  // CHECK: %[[SPLAT:.*]] = tt.splat %[[BLOCK_BASE]] : !tt.ptr<f16> -> tensor<32x64x!tt.ptr<f16>>
+  // CHECK: %[[PTRS:.*]] = tt.addptr %[[SPLAT]], %{{.*}} : tensor<32x64x!tt.ptr<f16>>, tensor<32x64xi64>
+  // CHECK: %[[LOWER:.*]] = arith.subi %{{.*}}, %[[OFFSET]] : i64
+  // CHECK: %[[UPPER:.*]] = arith.subi %{{.*}}, %[[OFFSET]] : i64
+  // CHECK: %[[IN_BOUNDS:.*]] = arith.cmpi slt, %{{.*}}, %{{.*}} : tensor<32x1xi32>
+  // CHECK: tt.load %[[PTRS]], %{{.*}}, %{{.*}} : tensor<32x64x!tt.ptr<f16>>
+  %0 = tt.make_tensor_ptr %base, [%rows, %c64_i64], [%c64_i64, %c1_i64], [%start, %c0_i32] {order = array<i32: 1, 0>} : <tensor<32x64xf16>>
+  %1 = tt.load %0 {boundaryCheck = array<i32: 0>, padding = 1 : i32} : !tt.ptr<tensor<32x64xf16>>
+  tt.return %1 : tensor<32x64xf16>
+}
@@ -142,3 +142,82 @@ module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 :
     tt.return
   }
 }
+
+// -----
+
+// CHECK: #[[$MMA:.+]] = #triton_gpu.nvidia_mma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [4, 1], instrShape = [16, 64, 16]}>
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  // CHECK-LABEL: mmav3_register_operand_a
+  tt.func @mmav3_register_operand_a(%a_ptr: tensor<128x64x!tt.ptr<f16>, #blocked>, %scale: tensor<128x64xf16, #blocked>, %b: tensor<64x64xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>>) -> tensor<128x64xf32, #blocked> {
+    %cst = arith.constant dense<0.000000e+00> : tensor<128x64xf32, #blocked>
+    %a_raw = tt.load %a_ptr : tensor<128x64x!tt.ptr<f16>, #blocked>
+    %a_scaled = arith.mulf %a_raw, %scale : tensor<128x64xf16, #blocked>
+    %a = triton_gpu.convert_layout %a_scaled : tensor<128x64xf16, #blocked> -> tensor<128x64xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>>
+    // CHECK: %[[A:.+]] = triton_gpu.convert_layout %{{.*}} : tensor<128x64xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>> -> tensor<128x64xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #[[$MMA]]}>>
+    // CHECK: %[[B:.+]] = triton_gpu.local_alloc
+    // CHECK: triton_nvidia_gpu.warp_group_dot %[[A]], %[[B]]
+    %d = tt.dot %a, %b, %cst : tensor<128x64xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>> * tensor<64x64xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>> -> tensor<128x64xf32, #blocked>
+    tt.return %d : tensor<128x64xf32, #blocked>
+  }
+}
+
+// -----
+
+// CHECK: #[[$TMEM_LAYOUT:.+]] = #triton_gpu.blocked<{sizePerThread = [1, 64], threadsPerWarp = [32, 1], warpsPerCTA = [4, 1], order = [0, 1]}>
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.target" = "cuda:100", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  // CHECK-LABEL: mmav5
+  tt.func @mmav5(%a: tensor<128x64xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>>, %b: tensor<64x64xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>>) -> tensor<128x64xf32, #blocked> {
+    %cst = arith.constant dense<0.000000e+00> : tensor<128x64xf32, #blocked>
+    // CHECK-DAG: %[[A:.+]] = triton_gpu.local_alloc %{{.*}} : (tensor<128x64xf16, #{{.*}}>) -> !tt.memdesc<128x64xf16, #{{.*}}, #triton_gpu.shared_memory>
+    // CHECK-DAG: %[[B:.+]] = triton_gpu.local_alloc %{{.*}} : (tensor<64x64xf16, #{{.*}}>) -> !tt.memdesc<64x64xf16, #{{.*}}, #triton_gpu.shared_memory>
+    // CHECK: %[[ACC:.+]] = triton_nvidia_gpu.tmem_alloc {{.*}}: () -> !tt.memdesc<128x64xf32, #triton_nvidia_gpu.tensor_memory_encoding<blockM = 128, blockN = 64>, #triton_nvidia_gpu.tensor_memory, mutable>
+    // CHECK: %[[BAR:.+]] = triton_gpu.local_alloc {{.*}}: () -> !tt.memdesc<1xi64
+    // CHECK: triton_nvidia_gpu.init_barrier %[[BAR]], 1
+    // CHECK: %[[FALSE:.+]] = arith.constant false
+    // CHECK: %[[TRUE:.+]] = arith.constant true
+    // CHECK: triton_nvidia_gpu.tc_gen5_mma %[[A]], %[[B]], %[[ACC]], %[[FALSE]], %[[TRUE]], %[[BAR]]
+    // CHECK: triton_nvidia_gpu.wait_barrier %[[BAR]]
+    // CHECK: triton_nvidia_gpu.inval_barrier %[[BAR]]
+    // CHECK: %[[D:.+]] = triton_nvidia_gpu.tmem_load %[[ACC]] : {{.*}} -> tensor<128x64xf32, #[[$TMEM_LAYOUT]]>
+    // CHECK: triton_gpu.convert_layout %[[D]] : tensor<128x64xf32, #[[$TMEM_LAYOUT]]> -> tensor<128x64xf32, #blocked>
+    %d = tt.dot %a, %b, %cst : tensor<128x64xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>> * tensor<64x64xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>> -> tensor<128x64xf32, #blocked>
+    tt.return %d : tensor<128x64xf32, #blocked>
+  }
+}
+
+// -----
+
+// CHECK: #[[$TMEM_LAYOUT:.+]] = #triton_gpu.blocked<{sizePerThread = [1, 64], threadsPerWarp = [32, 1], warpsPerCTA = [4, 1], order = [0, 1]}>
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.target" = "cuda:100", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  // CHECK-LABEL: mmav5_i8
+  tt.func @mmav5_i8(%a: tensor<128x64xi8, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>>, %b: tensor<64x64xi8, #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>>) -> tensor<128x64xi32, #blocked> {
+    %cst = arith.constant dense<0> : tensor<128x64xi32, #blocked>
+    // CHECK-DAG: %[[A:.+]] = triton_gpu.local_alloc %{{.*}} : (tensor<128x64xi8, #{{.*}}>) -> !tt.memdesc<128x64xi8, #{{.*}}, #triton_gpu.shared_memory>
+    // CHECK-DAG: %[[B:.+]] = triton_gpu.local_alloc %{{.*}} : (tensor<64x64xi8, #{{.*}}>) -> !tt.memdesc<64x64xi8, #{{.*}}, #triton_gpu.shared_memory>
+    // CHECK: %[[ACC:.+]] = triton_nvidia_gpu.tmem_alloc {{.*}}: () -> !tt.memdesc<128x64xi32, #triton_nvidia_gpu.tensor_memory_encoding<blockM = 128, blockN = 64>, #triton_nvidia_gpu.tensor_memory, mutable>
+    // CHECK: triton_nvidia_gpu.tc_gen5_mma %[[A]], %[[B]], %[[ACC]]
+    // CHECK: %[[D:.+]] = triton_nvidia_gpu.tmem_load %[[ACC]] : {{.*}} -> tensor<128x64xi32, #[[$TMEM_LAYOUT]]>
+    %d = tt.dot %a, %b, %cst : tensor<128x64xi8, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>> * tensor<64x64xi8, #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>> -> tensor<128x64xi32, #blocked>
+    tt.return %d : tensor<128x64xi32, #blocked>
+  }
+}
+
+// -----
+
+// CHECK: #[[MMA:.+]] = #triton_gpu.nvidia_mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [{{.*}}], instrShape = [16, 8]}>
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.target" = "cuda:80", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  // CHECK-LABEL: sparse_dot
+  tt.func @sparse_dot(%a: tensor<64x32xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>>, %b: tensor<64x64xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>>, %meta: tensor<64x4xi16, #blocked>) -> tensor<64x64xf32, #blocked> {
+    %cst = arith.constant dense<0.000000e+00> : tensor<64x64xf32, #blocked>
+    // CHECK-DAG: %[[A:.+]] = triton_gpu.convert_layout %{{.*}} -> tensor<64x32xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #[[MMA]], kWidth = 2}>>
+    // CHECK-DAG: %[[B:.+]] = triton_gpu.convert_layout %{{.*}} -> tensor<64x64xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #[[MMA]], kWidth = 2}>>
+    // CHECK-DAG: %[[META:.+]] = triton_gpu.convert_layout %{{.*}} -> tensor<64x4xi16, #triton_gpu.sparse_dot_meta<{parent = #[[MMA]]}>>
+    // CHECK: tt.sparse_dot %[[A]], %[[B]], %{{.*}}, %[[META]] {{.*}} -> tensor<64x64xf32, #[[MMA]]>
+    %d = tt.sparse_dot %a, %b, %cst, %meta : tensor<64x32xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>> meta tensor<64x4xi16, #blocked> * tensor<64x64xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>> -> tensor<64x64xf32, #blocked>
+    tt.return %d : tensor<64x64xf32, #blocked>
+  }
+}
@@ -0,0 +1,62 @@
+// RUN: triton-opt %s -split-input-file --tritonamdgpu-accelerate-matmul='arch-generation-name=gfx942 matrix-instruction-size=0 kPack=0' | FileCheck %s
+
+// Large tiles use the 32x32 instructions, which issue the fewest MFMAs, and
+// pack two of them per ds_read_b128.
+// CHECK: #[[MFMA:.+]] = #triton_gpu.amd_mfma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [2, 2], instrShape = [32, 32], isTransposed = false}>
+// CHECK-LABEL: mfma_dot_large
+// CHECK: tensor<128x64xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #[[MFMA]], kWidth = 8}>>
+// CHECK: tensor<64x128xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #[[MFMA]], kWidth = 8}>>
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [8, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 64 : i32} {
+  tt.func public @mfma_dot_large(
+   %0: tensor<128x64xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>>,
+   %1: tensor<64x128xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>>,
+   %2: tensor<128x128x!tt.ptr<f32>, #blocked>) {
+    %3 = arith.constant dense<0.000000e+00> : tensor<128x128xf32, #blocked>
+    %4 = tt.dot %0, %1, %3 : tensor<128x64xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>> * tensor<64x128xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>> -> tensor<128x128xf32, #blocked>
+    tt.store %2, %4 : tensor<128x128x!tt.ptr<f32>, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
+// A 32x32 tile has a single 32x32 instruction which the 4 warps would all
+// compute, so the 16x16 instructions are cheaper.
+// CHECK: #[[MFMA:.+]] = #triton_gpu.amd_mfma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [2, 2], instrShape = [16, 16], isTransposed = false}>
+// CHECK-LABEL: mfma_dot_small
+// CHECK: tensor<32x64xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #[[MFMA]], kWidth = 8}>>
+// CHECK: tensor<64x32xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #[[MFMA]], kWidth = 8}>>
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [8, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 64 : i32} {
+  tt.func public @mfma_dot_small(
+   %0: tensor<32x64xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>>,
+   %1: tensor<64x32xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>>,
+   %2: tensor<32x32x!tt.ptr<f32>, #blocked>) {
+    %3 = arith.constant dense<0.000000e+00> : tensor<32x32xf32, #blocked>
+    %4 = tt.dot %0, %1, %3 : tensor<32x64xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>> * tensor<64x32xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>> -> tensor<32x32xf32, #blocked>
+    tt.store %2, %4 : tensor<32x32x!tt.ptr<f32>, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
+// The matrix cores only multiply FNUZ fp8, so dots of OCP fp8 run as fp16
+// MFMAs.
+// CHECK-LABEL: mfma_dot_ocp_fp8
+// CHECK: tt.fp_to_fp %{{.*}} : tensor<128x64xf8E5M2, {{.*}}> -> tensor<128x64xf16
+// CHECK: tt.fp_to_fp %{{.*}} : tensor<64x128xf8E4M3FN, {{.*}}> -> tensor<64x128xf16
+// CHECK: tt.dot {{.*}} -> tensor<128x128xf32, #triton_gpu.amd_mfma
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [8, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 64 : i32} {
+  tt.func public @mfma_dot_ocp_fp8(
+   %0: tensor<128x64xf8E5M2, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>>,
+   %1: tensor<64x128xf8E4M3FN, #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>>,
+   %2: tensor<128x128x!tt.ptr<f32>, #blocked>) {
+    %3 = arith.constant dense<0.000000e+00> : tensor<128x128xf32, #blocked>
+    %4 = tt.dot %0, %1, %3 : tensor<128x64xf8E5M2, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>> * tensor<64x128xf8E4M3FN, #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>> -> tensor<128x128xf32, #blocked>
+    tt.store %2, %4 : tensor<128x128x!tt.ptr<f32>, #blocked>
+    tt.return
+  }
+}
@@ -0,0 +1,36 @@
+// RUN: triton-opt %s -split-input-file --tritonamdgpu-stream-pipeline=num_stages=3 | FileCheck %s
+
+// Both loads fill ring buffers of two tiles, the prologue loads the tiles of
+// the first two iterations and the loop loads the tile two iterations ahead.
+// CHECK-LABEL: @multi_buffer_matmul
+// CHECK-COUNT-2: triton_gpu.local_alloc {{.*}}!tt.memdesc<2x32x32xf16
+// CHECK-COUNT-4: tt.load
+// CHECK-COUNT-2: triton_gpu.local_store
+// CHECK: scf.for
+// CHECK-COUNT-2: tt.load
+// CHECK-COUNT-2: triton_gpu.local_store
+// CHECK-COUNT-2: triton_gpu.local_load
+// CHECK: tt.dot
+// CHECK: scf.yield
+// CHECK-COUNT-2: triton_gpu.local_dealloc
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [16, 4], warpsPerCTA = [1, 1], order = [1, 0]}>
+#mma = #triton_gpu.amd_mfma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [1, 1], instrShape = [32, 32], isTransposed = false}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32, triton_gpu.target = "hip:gfx942", "triton_gpu.threads-per-warp" = 64 : i32} {
+  tt.func public @multi_buffer_matmul(%Aptr: tensor<32x32x!tt.ptr<f16>, #blocked>, %Bptr : tensor<32x32x!tt.ptr<f16>, #blocked>, %ub : i32) -> tensor<32x32xf32, #mma> {
+    %cst_0 = arith.constant dense<32> : tensor<32x32xi32, #blocked>
+    %cst_1 = arith.constant dense<0.000000e+00> : tensor<32x32xf32, #mma>
+    %c0_i32 = arith.constant 0 : i32
+    %c1_i32 = arith.constant 1 : i32
+    %0:3 = scf.for %iv = %c0_i32 to %ub step %c1_i32 iter_args(%acc = %cst_1, %a_ptr = %Aptr, %b_ptr = %Bptr) -> (tensor<32x32xf32, #mma>, tensor<32x32x!tt.ptr<f16>, #blocked>, tensor<32x32x!tt.ptr<f16>, #blocked>) : i32 {
+      %a = tt.load %a_ptr : tensor<32x32x!tt.ptr<f16>, #blocked>
+      %b = tt.load %b_ptr : tensor<32x32x!tt.ptr<f16>, #blocked>
+      %a_op = triton_gpu.convert_layout %a : tensor<32x32xf16, #blocked> -> tensor<32x32xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 4}>>
+      %b_op = triton_gpu.convert_layout %b : tensor<32x32xf16, #blocked> -> tensor<32x32xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 4}>>
+      %d = tt.dot %a_op, %b_op, %acc : tensor<32x32xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 4}>> * tensor<32x32xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 4}>> -> tensor<32x32xf32, #mma>
+      %a_next = tt.addptr %a_ptr, %cst_0 : tensor<32x32x!tt.ptr<f16>, #blocked>, tensor<32x32xi32, #blocked>
+      %b_next = tt.addptr %b_ptr, %cst_0 : tensor<32x32x!tt.ptr<f16>, #blocked>, tensor<32x32xi32, #blocked>
+      scf.yield %d, %a_next, %b_next : tensor<32x32xf32, #mma>, tensor<32x32x!tt.ptr<f16>, #blocked>, tensor<32x32x!tt.ptr<f16>, #blocked>
+    }
+    tt.return %0#0 : tensor<32x32xf32, #mma>
+  }
+}
@@ -0,0 +1,80 @@
+// RUN: triton-opt %s -split-input-file --tritonamdgpu-stream-pipeline="num_stages=4 ping_pong=true" | FileCheck %s
+
+// The upper half of the waves waits on one more barrier before the loop, and
+// the dot and the local_loads of its operands run between barriers at a
+// higher priority.
+// CHECK-LABEL: @ping_pong_matmul
+// CHECK-COUNT-6: tt.load
+// CHECK: gpu.thread_id
+// CHECK: llvm.call_intrinsic "llvm.amdgcn.readfirstlane"
+// CHECK: %[[UPPER:.*]] = arith.cmpi uge
+// CHECK: %[[LOWER:.*]] = arith.cmpi ult
+// CHECK: gpu.barrier
+// CHECK-NEXT: scf.if %[[UPPER]] {
+// CHECK-NEXT: gpu.barrier
+// CHECK: scf.for
+// CHECK-COUNT-2: triton_gpu.local_store
+// CHECK: gpu.barrier
+// CHECK: llvm.call_intrinsic "llvm.amdgcn.s.setprio"
+// CHECK-COUNT-2: triton_gpu.local_load
+// CHECK-NEXT: tt.dot
+// CHECK-NEXT: llvm.mlir.constant(0 : i16)
+// CHECK-NEXT: llvm.call_intrinsic "llvm.amdgcn.s.setprio"
+// CHECK-NEXT: gpu.barrier
+// CHECK: scf.yield
+// CHECK: scf.if %[[LOWER]] {
+// CHECK-NEXT: gpu.barrier
+// CHECK: gpu.barrier
+// CHECK-COUNT-2: triton_gpu.local_dealloc
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [8, 8], warpsPerCTA = [8, 1], order = [1, 0]}>
+#mma = #triton_gpu.amd_mfma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [8, 1], instrShape = [32, 32], isTransposed = false}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 8 : i32, triton_gpu.target = "hip:gfx942", "triton_gpu.threads-per-warp" = 64 : i32} {
+  tt.func public @ping_pong_matmul(%Aptr: tensor<256x64x!tt.ptr<f16>, #blocked>, %Bptr : tensor<64x64x!tt.ptr<f16>, #blocked>, %ub : i32) -> tensor<256x64xf32, #mma> {
+    %cst_0 = arith.constant dense<64> : tensor<256x64xi32, #blocked>
+    %cst_1 = arith.constant dense<64> : tensor<64x64xi32, #blocked>
+    %cst_2 = arith.constant dense<0.000000e+00> : tensor<256x64xf32, #mma>
+    %c0_i32 = arith.constant 0 : i32
+    %c1_i32 = arith.constant 1 : i32
+    %0:3 = scf.for %iv = %c0_i32 to %ub step %c1_i32 iter_args(%acc = %cst_2, %a_ptr = %Aptr, %b_ptr = %Bptr) -> (tensor<256x64xf32, #mma>, tensor<256x64x!tt.ptr<f16>, #blocked>, tensor<64x64x!tt.ptr<f16>, #blocked>) : i32 {
+      %a = tt.load %a_ptr : tensor<256x64x!tt.ptr<f16>, #blocked>
+      %b = tt.load %b_ptr : tensor<64x64x!tt.ptr<f16>, #blocked>
+      %a_op = triton_gpu.convert_layout %a : tensor<256x64xf16, #blocked> -> tensor<256x64xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 4}>>
+      %b_op = triton_gpu.convert_layout %b : tensor<64x64xf16, #blocked> -> tensor<64x64xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 4}>>
+      %d = tt.dot %a_op, %b_op, %acc : tensor<256x64xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 4}>> * tensor<64x64xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 4}>> -> tensor<256x64xf32, #mma>
+      %a_next = tt.addptr %a_ptr, %cst_0 : tensor<256x64x!tt.ptr<f16>, #blocked>, tensor<256x64xi32, #blocked>
+      %b_next = tt.addptr %b_ptr, %cst_1 : tensor<64x64x!tt.ptr<f16>, #blocked>, tensor<64x64xi32, #blocked>
+      scf.yield %d, %a_next, %b_next : tensor<256x64xf32, #mma>, tensor<256x64x!tt.ptr<f16>, #blocked>, tensor<64x64x!tt.ptr<f16>, #blocked>
+    }
+    tt.return %0#0 : tensor<256x64xf32, #mma>
+  }
+}
+
+// -----
+
+// With a single wave per SIMD, the waves are not shifted.
+// CHECK-LABEL: @ping_pong_four_warps
+// CHECK-NOT: gpu.barrier
+// CHECK-NOT: llvm.amdgcn.s.setprio
+// CHECK: tt.return
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [8, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#mma = #triton_gpu.amd_mfma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [4, 1], instrShape = [32, 32], isTransposed = false}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "hip:gfx942", "triton_gpu.threads-per-warp" = 64 : i32} {
+  tt.func public @ping_pong_four_warps(%Aptr: tensor<128x64x!tt.ptr<f16>, #blocked>, %Bptr : tensor<64x64x!tt.ptr<f16>, #blocked>, %ub : i32) -> tensor<128x64xf32, #mma> {
+    %cst_0 = arith.constant dense<64> : tensor<128x64xi32, #blocked>
+    %cst_1 = arith.constant dense<64> : tensor<64x64xi32, #blocked>
+    %cst_2 = arith.constant dense<0.000000e+00> : tensor<128x64xf32, #mma>
+    %c0_i32 = arith.constant 0 : i32
+    %c1_i32 = arith.constant 1 : i32
+    %0:3 = scf.for %iv = %c0_i32 to %ub step %c1_i32 iter_args(%acc = %cst_2, %a_ptr = %Aptr, %b_ptr = %Bptr) -> (tensor<128x64xf32, #mma>, tensor<128x64x!tt.ptr<f16>, #blocked>, tensor<64x64x!tt.ptr<f16>, #blocked>) : i32 {
+      %a = tt.load %a_ptr : tensor<128x64x!tt.ptr<f16>, #blocked>
+      %b = tt.load %b_ptr : tensor<64x64x!tt.ptr<f16>, #blocked>
+      %a_op = triton_gpu.convert_layout %a : tensor<128x64xf16, #blocked> -> tensor<128x64xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 4}>>
+      %b_op = triton_gpu.convert_layout %b : tensor<64x64xf16, #blocked> -> tensor<64x64xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 4}>>
+      %d = tt.dot %a_op, %b_op, %acc : tensor<128x64xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 4}>> * tensor<64x64xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 4}>> -> tensor<128x64xf32, #mma>
+      %a_next = tt.addptr %a_ptr, %cst_0 : tensor<128x64x!tt.ptr<f16>, #blocked>, tensor<128x64xi32, #blocked>
+      %b_next = tt.addptr %b_ptr, %cst_1 : tensor<64x64x!tt.ptr<f16>, #blocked>, tensor<64x64xi32, #blocked>
+      scf.yield %d, %a_next, %b_next : tensor<128x64xf32, #mma>, tensor<128x64x!tt.ptr<f16>, #blocked>, tensor<64x64x!tt.ptr<f16>, #blocked>
+    }
+    tt.return %0#0 : tensor<128x64xf32, #mma>
+  }
+}
@@ -121,6 +121,40 @@ tt.func public @load_tensors_two_types(%arg0: !tt.ptr<f32> {tt.divisibility = 16
 
 // -----
 
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#slice1 = #triton_gpu.slice<{dim = 1, parent = #blocked}>
+#slice0 = #triton_gpu.slice<{dim = 0, parent = #blocked}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+
+// The load of the rows of 8 f16 gets the layout of the store, whose pointers
+// are only aligned to 4 bytes, so that the conversions between them fold.
+// CHECK: [[LAYOUT:#.*]] = #triton_gpu.blocked<{sizePerThread = [1, 2], threadsPerWarp = [8, 4], warpsPerCTA = [4, 1], order = [1, 0]}>
+// CHECK-LABEL: @load_store_narrow_rows
+// CHECK: tt.load {{.*}} : tensor<64x8x!tt.ptr<f16>, [[LAYOUT]]>
+// CHECK: tt.store {{.*}} : tensor<64x8x!tt.ptr<f16>, [[LAYOUT]]>
+tt.func public @load_store_narrow_rows(%arg0: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<f16> {tt.divisibility = 4 : i32}) {
+    %c8 = arith.constant dense<8> : tensor<64x1xi32, #blocked>
+    %0 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32, #slice1>
+    %1 = tt.expand_dims %0 {axis = 1 : i32} : tensor<64xi32, #slice1> -> tensor<64x1xi32, #blocked>
+    %2 = arith.muli %1, %c8 : tensor<64x1xi32, #blocked>
+    %3 = tt.make_range {end = 8 : i32, start = 0 : i32} : tensor<8xi32, #slice0>
+    %4 = tt.expand_dims %3 {axis = 0 : i32} : tensor<8xi32, #slice0> -> tensor<1x8xi32, #blocked>
+    %5 = tt.broadcast %2 : tensor<64x1xi32, #blocked> -> tensor<64x8xi32, #blocked>
+    %6 = tt.broadcast %4 : tensor<1x8xi32, #blocked> -> tensor<64x8xi32, #blocked>
+    %7 = arith.addi %5, %6 : tensor<64x8xi32, #blocked>
+    %8 = tt.splat %arg0 : !tt.ptr<f16> -> tensor<64x8x!tt.ptr<f16>, #blocked>
+    %9 = tt.addptr %8, %7 : tensor<64x8x!tt.ptr<f16>, #blocked>, tensor<64x8xi32, #blocked>
+    %10 = tt.load %9 : tensor<64x8x!tt.ptr<f16>, #blocked>
+    %11 = tt.splat %arg1 : !tt.ptr<f16> -> tensor<64x8x!tt.ptr<f16>, #blocked>
+    %12 = tt.addptr %11, %7 : tensor<64x8x!tt.ptr<f16>, #blocked>, tensor<64x8xi32, #blocked>
+    tt.store %12, %10 : tensor<64x8x!tt.ptr<f16>, #blocked>
+    tt.return
+}
+
+}
+
+// -----
+
 // COM: Reproducer for issue #3866
 // CHECK-LABEL: @test_3866
 // CHECK: tt.load {{.*}} : !tt.ptr<tensor<64x16xf16>
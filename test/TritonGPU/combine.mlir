@@ -1,4 +1,5 @@
 // RUN: triton-opt %s -split-input-file -tritongpu-remove-layout-conversions 2>&1 | FileCheck %s
+// RUN: triton-opt %s -split-input-file -tritongpu-remove-layout-conversions=max-rematerializations=0 2>&1 | FileCheck %s --check-prefix=NOREMAT
 
 #layout0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
 #layout1 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
@@ -52,6 +53,10 @@ tt.func @remat(%arg0: i32) -> tensor<1024xi32, #layout1> {
   // CHECK: %[[C:.+]] = arith.muli %[[A]], %[[B]] : tensor<1024xi32, [[$target_layout]]>
   // CHECK: %[[D:.+]] = arith.addi %[[C]], %[[C]] : tensor<1024xi32, [[$target_layout]]>
   // CHECK: tt.return %[[D]] : tensor<1024xi32, [[$target_layout]]>
+  // NOREMAT-LABEL: @remat(
+  // NOREMAT: arith.muli
+  // NOREMAT: triton_gpu.convert_layout
+  // NOREMAT: tt.return
 }
 
 // Always rematerialize single value loads
@@ -2515,3 +2520,102 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 :
     tt.return
   }
 }
+
+// -----
+
+#layout0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+#layout1 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.num-ctas" = 1 : i32} {
+// Duplicating a short chain that is still used in its old layout is cheaper
+// than the conversion.
+// CHECK-LABEL: remat_cheap_duplication
+// CHECK-NOT: triton_gpu.convert_layout
+// CHECK: tt.return
+tt.func @remat_cheap_duplication(%ptr: tensor<1024x!tt.ptr<i32>, #layout0>) -> tensor<1024xi32, #layout1> {
+  %0 = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32, #layout0>
+  %1 = arith.muli %0, %0 : tensor<1024xi32, #layout0>
+  %2 = arith.addi %1, %0 : tensor<1024xi32, #layout0>
+  tt.store %ptr, %2 : tensor<1024x!tt.ptr<i32>, #layout0>
+  %3 = triton_gpu.convert_layout %2 : tensor<1024xi32, #layout0> -> tensor<1024xi32, #layout1>
+  tt.return %3 : tensor<1024xi32, #layout1>
+}
+
+// Duplicating a long chain costs more than the conversion.
+// CHECK-LABEL: no_remat_expensive_duplication
+// CHECK: tt.store
+// CHECK: triton_gpu.convert_layout
+// CHECK: tt.return
+tt.func @no_remat_expensive_duplication(%ptr: tensor<1024x!tt.ptr<i32>, #layout0>) -> tensor<1024xi32, #layout1> {
+  %0 = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32, #layout0>
+  %1 = arith.muli %0, %0 : tensor<1024xi32, #layout0>
+  %2 = arith.addi %1, %0 : tensor<1024xi32, #layout0>
+  %3 = arith.muli %2, %1 : tensor<1024xi32, #layout0>
+  %4 = arith.addi %3, %2 : tensor<1024xi32, #layout0>
+  %5 = arith.muli %4, %3 : tensor<1024xi32, #layout0>
+  %6 = arith.addi %5, %4 : tensor<1024xi32, #layout0>
+  %7 = arith.muli %6, %5 : tensor<1024xi32, #layout0>
+  %8 = arith.addi %7, %6 : tensor<1024xi32, #layout0>
+  %9 = arith.muli %8, %7 : tensor<1024xi32, #layout0>
+  tt.store %ptr, %9 : tensor<1024x!tt.ptr<i32>, #layout0>
+  %10 = triton_gpu.convert_layout %9 : tensor<1024xi32, #layout0> -> tensor<1024xi32, #layout1>
+  tt.return %10 : tensor<1024xi32, #layout1>
+}
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [4, 1], instrShape = [16, 8]}>
+#dot0 = #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 2}>
+#dot1 = #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 2}>
+module attributes {"triton_gpu.target" = "cuda:80", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+// The load of the loop-invariant operand and its conversion to the dot operand
+// layout are hoisted out of the loop, which doesn't write to memory.
+// CHECK-LABEL: hoist_loop_invariant_convert
+  tt.func public @hoist_loop_invariant_convert(%x_ptr: tensor<64x32x!tt.ptr<f16>, #blocked>, %w_ptr_init: tensor<32x64x!tt.ptr<f16>, #blocked>, %w_off: tensor<32x64xi32, #blocked>) -> tensor<64x64xf32, #mma> {
+    %c0_i32 = arith.constant 0 : i32
+    %c8_i32 = arith.constant 8 : i32
+    %c1_i32 = arith.constant 1 : i32
+    %cst = arith.constant dense<0.000000e+00> : tensor<64x64xf32, #mma>
+    // CHECK: %[[X:.*]] = tt.load %arg0
+    // CHECK: %[[X_OP:.*]] = triton_gpu.convert_layout %[[X]]
+    // CHECK: scf.for
+    // CHECK-NOT: tt.load %arg0
+    // CHECK: tt.dot %[[X_OP]]
+    %0:2 = scf.for %i = %c0_i32 to %c8_i32 step %c1_i32 iter_args(%acc = %cst, %w_ptr = %w_ptr_init) -> (tensor<64x64xf32, #mma>, tensor<32x64x!tt.ptr<f16>, #blocked>) : i32 {
+      %x = tt.load %x_ptr : tensor<64x32x!tt.ptr<f16>, #blocked>
+      %x_op = triton_gpu.convert_layout %x : tensor<64x32xf16, #blocked> -> tensor<64x32xf16, #dot0>
+      %w = tt.load %w_ptr : tensor<32x64x!tt.ptr<f16>, #blocked>
+      %w_op = triton_gpu.convert_layout %w : tensor<32x64xf16, #blocked> -> tensor<32x64xf16, #dot1>
+      %d = tt.dot %x_op, %w_op, %acc : tensor<64x32xf16, #dot0> * tensor<32x64xf16, #dot1> -> tensor<64x64xf32, #mma>
+      %w_next = tt.addptr %w_ptr, %w_off : tensor<32x64x!tt.ptr<f16>, #blocked>, tensor<32x64xi32, #blocked>
+      scf.yield %d, %w_next : tensor<64x64xf32, #mma>, tensor<32x64x!tt.ptr<f16>, #blocked>
+    }
+    tt.return %0#0 : tensor<64x64xf32, #mma>
+  }
+
+// The loop stores to memory, so the load stays in the loop. The convert of the
+// function argument is hoisted.
+// CHECK-LABEL: keep_load_in_writing_loop
+  tt.func public @keep_load_in_writing_loop(%x_ptr: tensor<64x32x!tt.ptr<f16>, #blocked>, %w: tensor<32x64xf16, #blocked>, %out_ptr: tensor<64x64x!tt.ptr<f32>, #mma>) {
+    %c0_i32 = arith.constant 0 : i32
+    %c8_i32 = arith.constant 8 : i32
+    %c1_i32 = arith.constant 1 : i32
+    %cst = arith.constant dense<0.000000e+00> : tensor<64x64xf32, #mma>
+    // CHECK: %[[W_OP:.*]] = triton_gpu.convert_layout %arg1
+    // CHECK: scf.for
+    // CHECK: %[[X:.*]] = tt.load %arg0
+    // CHECK: %[[X_OP:.*]] = triton_gpu.convert_layout %[[X]]
+    // CHECK: tt.dot %[[X_OP]], %[[W_OP]]
+    // CHECK: tt.store
+    scf.for %i = %c0_i32 to %c8_i32 step %c1_i32 : i32 {
+      %x = tt.load %x_ptr : tensor<64x32x!tt.ptr<f16>, #blocked>
+      %x_op = triton_gpu.convert_layout %x : tensor<64x32xf16, #blocked> -> tensor<64x32xf16, #dot0>
+      %w_op = triton_gpu.convert_layout %w : tensor<32x64xf16, #blocked> -> tensor<32x64xf16, #dot1>
+      %d = tt.dot %x_op, %w_op, %cst : tensor<64x32xf16, #dot0> * tensor<32x64xf16, #dot1> -> tensor<64x64xf32, #mma>
+      tt.store %out_ptr, %d : tensor<64x64x!tt.ptr<f32>, #mma>
+    }
+    tt.return
+  }
+}
@@ -211,3 +211,26 @@ module attributes {"triton_gpu.target" = "cuda:80", "triton_gpu.num-ctas" = 1 :
     tt.return %td : tensor<128x128xf32, #mma>
   }
 }
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [4, 1], order = [1, 0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [2, 2], threadsPerWarp = [8, 4], warpsPerCTA = [2, 2], order = [1, 0]}>
+module attributes {"triton_gpu.target" = "cuda:89", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+// CHECK-DAG: #[[A_TILE:.*]] = #triton_gpu.blocked<{sizePerThread = [2, 16], threadsPerWarp = [8, 4], warpsPerCTA = [2, 2], order = [1, 0]}>
+// CHECK-LABEL: tt.func @fma_operand_in_registers
+//       CHECK:   %[[PA:.*]] = triton_gpu.convert_layout %{{.*}} : tensor<32x16x!tt.ptr<f32>, #blocked> -> tensor<32x16x!tt.ptr<f32>, #[[A_TILE]]>
+//       CHECK:   %[[A:.*]] = tt.load %[[PA]] : tensor<32x16x!tt.ptr<f32>, #[[A_TILE]]>
+//       CHECK:   triton_gpu.convert_layout %[[A]] : tensor<32x16xf32, #[[A_TILE]]> -> tensor<32x16xf32, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked1}>>
+// The tile of B would take 128 registers.
+//       CHECK:   %[[B:.*]] = tt.load %{{.*}} : tensor<16x64x!tt.ptr<f32>, #blocked>
+//       CHECK:   triton_gpu.convert_layout %[[B]] : tensor<16x64xf32, #blocked> -> tensor<16x64xf32, #triton_gpu.dot_op<{opIdx = 1, parent = #blocked1}>>
+tt.func @fma_operand_in_registers(%pa: tensor<32x16x!tt.ptr<f32>, #blocked>, %pb: tensor<16x64x!tt.ptr<f32>, #blocked>, %acc: tensor<32x64xf32, #blocked1>) -> tensor<32x64xf32, #blocked1> {
+  %a = tt.load %pa : tensor<32x16x!tt.ptr<f32>, #blocked>
+  %b = tt.load %pb : tensor<16x64x!tt.ptr<f32>, #blocked>
+  %a_op = triton_gpu.convert_layout %a : tensor<32x16xf32, #blocked> -> tensor<32x16xf32, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked1}>>
+  %b_op = triton_gpu.convert_layout %b : tensor<16x64xf32, #blocked> -> tensor<16x64xf32, #triton_gpu.dot_op<{opIdx = 1, parent = #blocked1}>>
+  %r = tt.dot %a_op, %b_op, %acc : tensor<32x16xf32, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked1}>> * tensor<16x64xf32, #triton_gpu.dot_op<{opIdx = 1, parent = #blocked1}>> -> tensor<32x64xf32, #blocked1>
+  tt.return %r : tensor<32x64xf32, #blocked1>
+}
+}
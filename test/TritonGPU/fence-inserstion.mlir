@@ -45,3 +45,102 @@ module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 :
     tt.return
   }
 }
+
+// -----
+
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [8, 1], instrShape = [16, 64, 16]}>
+#shared = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [1, 0], hasLeadingOffset = true}>
+#shared1 = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [0, 1], hasLeadingOffset = true}>
+#shared2 = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [0]}>
+module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 8 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  // Buffers only written by TMA are read by wgmma without a fence.
+  // CHECK-LABEL: tma_multibuffer_no_fence
+  // CHECK-NOT: triton_nvidia_gpu.fence_async_shared
+  // CHECK: tt.return
+  tt.func public @tma_multibuffer_no_fence(%desc: !tt.ptr<i8>, %barrier: !tt.memdesc<1xi64, #shared2, #triton_gpu.shared_memory, mutable>) {
+    %cst = arith.constant dense<0.000000e+00> : tensor<128x64xf32, #mma>
+    %true = arith.constant true
+    %c0_i32 = arith.constant 0 : i32
+    %c1_i32 = arith.constant 1 : i32
+    %c2_i32 = arith.constant 2 : i32
+    %c64_i32 = arith.constant 64 : i32
+    %a = triton_gpu.local_alloc : () -> !tt.memdesc<2x128x128xf16, #shared, #triton_gpu.shared_memory, mutable>
+    %b = triton_gpu.local_alloc : () -> !tt.memdesc<2x128x64xf16, #shared1, #triton_gpu.shared_memory, mutable>
+    %r:2 = scf.for %iv = %c0_i32 to %c64_i32 step %c1_i32 iter_args(%acc = %cst, %idx = %c0_i32) -> (tensor<128x64xf32, #mma>, i32) : i32 {
+      %a0 = triton_gpu.memdesc_subview %a[%idx, %c0_i32, %c0_i32] : !tt.memdesc<2x128x128xf16, #shared, #triton_gpu.shared_memory, mutable> -> !tt.memdesc<128x128xf16, #shared, #triton_gpu.shared_memory, mutable>
+      %b0 = triton_gpu.memdesc_subview %b[%idx, %c0_i32, %c0_i32] : !tt.memdesc<2x128x64xf16, #shared1, #triton_gpu.shared_memory, mutable> -> !tt.memdesc<128x64xf16, #shared1, #triton_gpu.shared_memory, mutable>
+      triton_nvidia_gpu.async_tma_copy_global_to_local %desc[%iv, %c0_i32] %a0, %barrier, %true : !tt.ptr<i8>, !tt.memdesc<1xi64, #shared2, #triton_gpu.shared_memory, mutable> -> !tt.memdesc<128x128xf16, #shared, #triton_gpu.shared_memory, mutable>
+      triton_nvidia_gpu.async_tma_copy_global_to_local %desc[%c0_i32, %iv] %b0, %barrier, %true : !tt.ptr<i8>, !tt.memdesc<1xi64, #shared2, #triton_gpu.shared_memory, mutable> -> !tt.memdesc<128x64xf16, #shared1, #triton_gpu.shared_memory, mutable>
+      %d = triton_nvidia_gpu.warp_group_dot %a0, %b0, %acc : !tt.memdesc<128x128xf16, #shared, #triton_gpu.shared_memory, mutable> * !tt.memdesc<128x64xf16, #shared1, #triton_gpu.shared_memory, mutable> -> tensor<128x64xf32, #mma>
+      %next = arith.addi %idx, %c1_i32 : i32
+      %wrap = arith.remsi %next, %c2_i32 : i32
+      scf.yield %d, %wrap : tensor<128x64xf32, #mma>, i32
+    }
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [2, 16], warpsPerCTA = [8, 1], order = [1, 0]}>
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [8, 1], instrShape = [16, 64, 16]}>
+#shared = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [1, 0], hasLeadingOffset = true}>
+#shared1 = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [0, 1], hasLeadingOffset = true}>
+module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 8 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  // A buffer rewritten in the loop with a local_store needs a fence in the
+  // loop, which covers the loop-carried buffer written before the loop and is
+  // shared by the two wgmmas.
+  // CHECK-LABEL: share_fence_in_loop
+  // CHECK-NOT: triton_nvidia_gpu.fence_async_shared
+  // CHECK: triton_gpu.local_store
+  // CHECK-NEXT: triton_nvidia_gpu.fence_async_shared
+  // CHECK-NEXT: triton_nvidia_gpu.warp_group_dot
+  // CHECK-NEXT: triton_nvidia_gpu.warp_group_dot
+  // CHECK-NOT: triton_nvidia_gpu.fence_async_shared
+  // CHECK: tt.return
+  tt.func public @share_fence_in_loop(%arg0: tensor<128x128xf16, #blocked>, %arg1: tensor<128x64xf16, #blocked>) {
+    %cst = arith.constant dense<0.000000e+00> : tensor<128x64xf32, #mma>
+    %c0_i32 = arith.constant 0 : i32
+    %c1_i32 = arith.constant 1 : i32
+    %c64_i32 = arith.constant 64 : i32
+    %a = triton_gpu.local_alloc %arg0 : (tensor<128x128xf16, #blocked>) -> !tt.memdesc<128x128xf16, #shared, #triton_gpu.shared_memory>
+    %b = triton_gpu.local_alloc : () -> !tt.memdesc<128x64xf16, #shared1, #triton_gpu.shared_memory, mutable>
+    %r:2 = scf.for %iv = %c0_i32 to %c64_i32 step %c1_i32 iter_args(%acc = %cst, %a_iter = %a) -> (tensor<128x64xf32, #mma>, !tt.memdesc<128x128xf16, #shared, #triton_gpu.shared_memory>) : i32 {
+      triton_gpu.local_store %arg1, %b : tensor<128x64xf16, #blocked> -> !tt.memdesc<128x64xf16, #shared1, #triton_gpu.shared_memory, mutable>
+      %d0 = triton_nvidia_gpu.warp_group_dot %a_iter, %b, %acc : !tt.memdesc<128x128xf16, #shared, #triton_gpu.shared_memory> * !tt.memdesc<128x64xf16, #shared1, #triton_gpu.shared_memory, mutable> -> tensor<128x64xf32, #mma>
+      %d1 = triton_nvidia_gpu.warp_group_dot %a_iter, %b, %d0 : !tt.memdesc<128x128xf16, #shared, #triton_gpu.shared_memory> * !tt.memdesc<128x64xf16, #shared1, #triton_gpu.shared_memory, mutable> -> tensor<128x64xf32, #mma>
+      scf.yield %d1, %a_iter : tensor<128x64xf32, #mma>, !tt.memdesc<128x128xf16, #shared, #triton_gpu.shared_memory>
+    }
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [2, 16], warpsPerCTA = [8, 1], order = [1, 0]}>
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [8, 1], instrShape = [16, 64, 16]}>
+#shared = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [1, 0], hasLeadingOffset = true}>
+#shared1 = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [0, 1], hasLeadingOffset = true}>
+module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 8 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  // The views of buffers written before the loop, even loop-carried ones, get
+  // a single fence before the loop.
+  // CHECK-LABEL: hoist_fence_loop_carried
+  // CHECK: triton_gpu.local_alloc %arg1
+  // CHECK-NEXT: triton_nvidia_gpu.fence_async_shared
+  // CHECK-NEXT: scf.for
+  // CHECK-NOT: triton_nvidia_gpu.fence_async_shared
+  // CHECK: tt.return
+  tt.func public @hoist_fence_loop_carried(%arg0: tensor<128x128xf16, #blocked>, %arg1: tensor<128x64xf16, #blocked>) {
+    %cst = arith.constant dense<0.000000e+00> : tensor<128x64xf32, #mma>
+    %c0_i32 = arith.constant 0 : i32
+    %c1_i32 = arith.constant 1 : i32
+    %c64_i32 = arith.constant 64 : i32
+    %a = triton_gpu.local_alloc %arg0 : (tensor<128x128xf16, #blocked>) -> !tt.memdesc<128x128xf16, #shared, #triton_gpu.shared_memory>
+    %b = triton_gpu.local_alloc %arg1 : (tensor<128x64xf16, #blocked>) -> !tt.memdesc<128x64xf16, #shared1, #triton_gpu.shared_memory>
+    %r:2 = scf.for %iv = %c0_i32 to %c64_i32 step %c1_i32 iter_args(%acc = %cst, %a_iter = %a) -> (tensor<128x64xf32, #mma>, !tt.memdesc<128x128xf16, #shared, #triton_gpu.shared_memory>) : i32 {
+      %d = triton_nvidia_gpu.warp_group_dot %a_iter, %b, %acc : !tt.memdesc<128x128xf16, #shared, #triton_gpu.shared_memory> * !tt.memdesc<128x64xf16, #shared1, #triton_gpu.shared_memory> -> tensor<128x64xf32, #mma>
+      scf.yield %d, %a_iter : tensor<128x64xf32, #mma>, !tt.memdesc<128x128xf16, #shared, #triton_gpu.shared_memory>
+    }
+    tt.return
+  }
+}
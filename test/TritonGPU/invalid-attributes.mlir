@@ -48,6 +48,17 @@
 
 // -----
 
+// expected-error@+2 {{triton_gpu.dot_op kWidth parameter supports only 8 for WMMA version 2 parent}}
+#wmma = #triton_gpu.amd_wmma<{version = 2, warpsPerCTA = [1, 4]}>
+#dot_op = #triton_gpu.dot_op<{opIdx = 1, parent = #wmma, kWidth = 16}>
+
+// -----
+
+// expected-error@+1 {{WMMA version must be 1 or 2}}
+#wmma = #triton_gpu.amd_wmma<{version = 3, warpsPerCTA = [1, 4]}>
+
+// -----
+
 // expected-error@+1 {{major version must be in the [0, 3] range}}
 #mfma = #triton_gpu.amd_mfma<{versionMajor = 10, versionMinor = 0, warpsPerCTA = [1, 1, 1], instrShape = [32, 32], isTransposed = false}>
 
@@ -0,0 +1,36 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-reorder-instructions=list-scheduling=true | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32, "triton_gpu.target" = "cuda:80"} {
+  // The second load is issued before the consumer of the first one.
+  // CHECK-LABEL: @loads_before_consumers
+  // CHECK: %[[A:.*]] = tt.load
+  // CHECK-NEXT: %[[B:.*]] = tt.load
+  // CHECK-NEXT: arith.addf %[[A]], %[[A]]
+  // CHECK-NEXT: arith.mulf %[[B]], %[[B]]
+  tt.func @loads_before_consumers(%pa: tensor<512x!tt.ptr<f32>, #blocked>, %pb: tensor<512x!tt.ptr<f32>, #blocked>) -> (tensor<512xf32, #blocked>, tensor<512xf32, #blocked>) {
+    %a = tt.load %pa : tensor<512x!tt.ptr<f32>, #blocked>
+    %x = arith.addf %a, %a : tensor<512xf32, #blocked>
+    %b = tt.load %pb : tensor<512x!tt.ptr<f32>, #blocked>
+    %y = arith.mulf %b, %b : tensor<512xf32, #blocked>
+    tt.return %x, %y : tensor<512xf32, #blocked>, tensor<512xf32, #blocked>
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32, "triton_gpu.target" = "cuda:80"} {
+  // A load stays after the store it may read, and both are issued before the
+  // exp, which has a shorter latency.
+  // CHECK-LABEL: @load_after_store
+  // CHECK: tt.store
+  // CHECK-NEXT: tt.load
+  // CHECK-NEXT: math.exp
+  tt.func @load_after_store(%p: tensor<512x!tt.ptr<f32>, #blocked>, %v: tensor<512xf32, #blocked>) -> (tensor<512xf32, #blocked>, tensor<512xf32, #blocked>) {
+    %e = math.exp %v : tensor<512xf32, #blocked>
+    tt.store %p, %v : tensor<512x!tt.ptr<f32>, #blocked>
+    %l = tt.load %p : tensor<512x!tt.ptr<f32>, #blocked>
+    tt.return %l, %e : tensor<512xf32, #blocked>, tensor<512xf32, #blocked>
+  }
+}
@@ -710,3 +710,49 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 :
     tt.return
   }
 }
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [8, 1], threadsPerWarp = [8, 4], warpsPerCTA = [1, 4], order = [0, 1]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [4, 1], instrShape = [16, 16, 32]}>
+#shared = #triton_gpu.shared<{vec = 16, perPhase = 1, maxPhase = 4, order = [1, 0], hasLeadingOffset = true}>
+#shared1 = #triton_gpu.shared<{vec = 16, perPhase = 1, maxPhase = 4, order = [0, 1], hasLeadingOffset = true}>
+module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  // The fp8 dot accumulates the products of 2 iterations in a partial
+  // accumulator, added to the fp32 one under an if, so the dot stays async.
+  // CHECK-LABEL: fp8_dot_promote_acc
+  // CHECK-DAG: %[[ZERO:.+]] = arith.constant dense<0.000000e+00> : tensor<128x16xf32, #{{.*}}>
+  // CHECK: scf.for
+  // CHECK:   triton_nvidia_gpu.warp_group_dot
+  // CHECK-NEXT: triton_nvidia_gpu.warp_group_dot_wait {{.*}} {pendings = 1 : i32}
+  // CHECK:   scf.if
+  // CHECK:     triton_nvidia_gpu.warp_group_dot_wait {{.*}} {pendings = 0 : i32}
+  // CHECK:     %[[SUM:.+]] = arith.addf
+  // CHECK:     scf.yield %[[SUM]], %[[ZERO]]
+  // CHECK:   scf.yield
+  // CHECK: triton_nvidia_gpu.warp_group_dot_wait {{.*}} {pendings = 0 : i32}
+  // CHECK: %[[RESULT:.+]] = arith.addf
+  // CHECK: tt.return %[[RESULT]]
+  tt.func @fp8_dot_promote_acc(%arg0: !tt.ptr<f8E5M2> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<f8E5M2> {tt.divisibility = 16 : i32}) -> tensor<128x16xf32, #mma> {
+    %cst = arith.constant dense<64> : tensor<64x16xi32, #blocked>
+    %cst2 = arith.constant dense<64> : tensor<128x64xi32, #blocked1>
+    %c0_i32 = arith.constant 0 : i32
+    %c1_i32 = arith.constant 1 : i32
+    %c8_i32 = arith.constant 8 : i32
+    %cst_acc = arith.constant dense<0.000000e+00> : tensor<128x16xf32, #mma>
+    %a_ptr = tt.splat %arg0 : !tt.ptr<f8E5M2> -> tensor<128x64x!tt.ptr<f8E5M2>, #blocked1>
+    %b_ptr = tt.splat %arg1 : !tt.ptr<f8E5M2> -> tensor<64x16x!tt.ptr<f8E5M2>, #blocked>
+    %17:3 = scf.for %arg3 = %c0_i32 to %c8_i32 step %c1_i32 iter_args(%arg4 = %cst_acc, %arg5 = %b_ptr, %arg6 = %a_ptr) -> (tensor<128x16xf32, #mma>, tensor<64x16x!tt.ptr<f8E5M2>, #blocked>, tensor<128x64x!tt.ptr<f8E5M2>, #blocked1>)  : i32 {
+      %9 = tt.load %arg6 : tensor<128x64x!tt.ptr<f8E5M2>, #blocked1>
+      %18 = tt.load %arg5 : tensor<64x16x!tt.ptr<f8E5M2>, #blocked>
+      %19 = triton_gpu.local_alloc %9 : (tensor<128x64xf8E5M2, #blocked1>) -> !tt.memdesc<128x64xf8E5M2, #shared, #triton_gpu.shared_memory>
+      %20 = triton_gpu.local_alloc %18 : (tensor<64x16xf8E5M2, #blocked>) -> !tt.memdesc<64x16xf8E5M2, #shared1, #triton_gpu.shared_memory>
+      %acc = triton_nvidia_gpu.warp_group_dot %19, %20, %arg4 {maxNumImpreciseAcc = 128 : i32} : !tt.memdesc<128x64xf8E5M2, #shared, #triton_gpu.shared_memory> * !tt.memdesc<64x16xf8E5M2, #shared1, #triton_gpu.shared_memory> -> tensor<128x16xf32, #mma>
+      %22 = tt.addptr %arg5, %cst : tensor<64x16x!tt.ptr<f8E5M2>, #blocked>, tensor<64x16xi32, #blocked>
+      %23 = tt.addptr %arg6, %cst2 : tensor<128x64x!tt.ptr<f8E5M2>, #blocked1>, tensor<128x64xi32, #blocked1>
+      scf.yield %acc, %22, %23 : tensor<128x16xf32, #mma>, tensor<64x16x!tt.ptr<f8E5M2>, #blocked>, tensor<128x64x!tt.ptr<f8E5M2>, #blocked1>
+    }
+    tt.return %17#0 : tensor<128x16xf32, #mma>
+  }
+}
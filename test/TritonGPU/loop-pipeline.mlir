@@ -1595,3 +1595,213 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 :
     tt.return %0#0 : tensor<128x256xf32, #mma>
   }
 }
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [1, 32], warpsPerCTA = [2, 2], order = [1, 0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [1, 32], warpsPerCTA = [1, 4], order = [1, 0]}>
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [4, 1], instrShape = [16, 256, 16]}>
+#shared = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [1, 0], hasLeadingOffset = true}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:90", "triton_gpu.threads-per-warp" = 32 : i32} {
+// The B load is pinned to the stage after the A load, so the prologue loads A
+// for two iterations but B for one.
+//   CHECK-LABEL: @matmul_tma_pinned_stage
+// CHECK-COUNT-3:   triton_nvidia_gpu.async_tma_copy_global_to_local
+//     CHECK-NOT:   triton_nvidia_gpu.async_tma_copy_global_to_local
+//         CHECK:   scf.for
+// CHECK-COUNT-2:     triton_nvidia_gpu.async_tma_copy_global_to_local
+//         CHECK:     scf.yield
+  tt.func public @matmul_tma_pinned_stage(%arg0: !tt.ptr<i8> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<i8> {tt.divisibility = 16 : i32}) -> tensor<128x256xf32, #mma> {
+    %c256_i32 = arith.constant 256 : i32
+    %c0_i32 = arith.constant 0 : i32
+    %c64_i32 = arith.constant 64 : i32
+    %c1_i32 = arith.constant 1 : i32
+    %cst = arith.constant dense<0.000000e+00> : tensor<128x256xf32, #mma>
+    %0:2 = scf.for %arg3 = %c0_i32 to %c256_i32 step %c1_i32 iter_args(%arg4 = %cst, %arg5 = %c0_i32) -> (tensor<128x256xf32, #mma>, i32)  : i32 {
+      %1 = tt.experimental_descriptor_load %arg0[%c0_i32, %arg5] : !tt.ptr<i8> -> tensor<128x64xf16, #blocked>
+      %2 = triton_gpu.local_alloc %1 : (tensor<128x64xf16, #blocked>) -> !tt.memdesc<128x64xf16, #shared, #triton_gpu.shared_memory>
+      %3 = tt.experimental_descriptor_load %arg1[%arg5, %c0_i32] {tt.pipeline_stage = 1 : i32} : !tt.ptr<i8> -> tensor<64x256xf16, #blocked1>
+      %4 = triton_gpu.local_alloc %3 : (tensor<64x256xf16, #blocked1>) -> !tt.memdesc<64x256xf16, #shared, #triton_gpu.shared_memory>
+      %5 = triton_nvidia_gpu.warp_group_dot %2, %4, %arg4 { inputPrecision = 0 : i32 } : !tt.memdesc<128x64xf16, #shared, #triton_gpu.shared_memory> * !tt.memdesc<64x256xf16, #shared, #triton_gpu.shared_memory> -> tensor<128x256xf32, #mma>
+      %6 = arith.addi %arg5, %c64_i32 : i32
+      scf.yield %5, %6 : tensor<128x256xf32, #mma>, i32
+    }
+    tt.return %0#0 : tensor<128x256xf32, #mma>
+  }
+}
+
+// -----
+
+// Loops without dots are pipelined without a tt.num_stages attribute, unless
+// their loads depend on the loads of the previous iterations or read memory
+// the loop writes to.
+
+// CHECK-LABEL: @streaming_sum
+// CHECK:   triton_gpu.local_alloc
+// CHECK:   triton_gpu.async_copy_global_to_local
+// CHECK:   scf.for
+// CHECK:     triton_gpu.local_load
+
+// CHECK-LABEL: @pointer_chasing
+// CHECK-NOT: triton_gpu.async_copy_global_to_local
+// CHECK: tt.return
+
+// CHECK-LABEL: @in_place_update
+// CHECK-NOT: triton_gpu.async_copy_global_to_local
+// CHECK: tt.return
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func public @streaming_sum(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg2: i32 {tt.divisibility = 16 : i32}) {
+    %c1024_i32 = arith.constant 1024 : i32
+    %c0_i32 = arith.constant 0 : i32
+    %cst = arith.constant dense<0.000000e+00> : tensor<1024xf32, #blocked>
+    %0 = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32, #blocked>
+    %1 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<1024x!tt.ptr<f32>, #blocked>
+    %2 = scf.for %arg3 = %c0_i32 to %arg2 step %c1024_i32 iter_args(%arg4 = %cst) -> (tensor<1024xf32, #blocked>)  : i32 {
+      %3 = tt.splat %arg3 : i32 -> tensor<1024xi32, #blocked>
+      %4 = arith.addi %3, %0 : tensor<1024xi32, #blocked>
+      %5 = tt.addptr %1, %4 : tensor<1024x!tt.ptr<f32>, #blocked>, tensor<1024xi32, #blocked>
+      %6 = tt.load %5 : tensor<1024x!tt.ptr<f32>, #blocked>
+      %7 = arith.addf %arg4, %6 : tensor<1024xf32, #blocked>
+      scf.yield %7 : tensor<1024xf32, #blocked>
+    }
+    %8 = tt.splat %arg1 : !tt.ptr<f32> -> tensor<1024x!tt.ptr<f32>, #blocked>
+    %9 = tt.addptr %8, %0 : tensor<1024x!tt.ptr<f32>, #blocked>, tensor<1024xi32, #blocked>
+    tt.store %9, %2 : tensor<1024x!tt.ptr<f32>, #blocked>
+    tt.return
+  }
+
+  tt.func public @pointer_chasing(%arg0: !tt.ptr<i32> {tt.divisibility = 16 : i32}, %arg1: i32) -> tensor<1024xi32, #blocked> {
+    %c1_i32 = arith.constant 1 : i32
+    %c0_i32 = arith.constant 0 : i32
+    %0 = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32, #blocked>
+    %1 = tt.splat %arg0 : !tt.ptr<i32> -> tensor<1024x!tt.ptr<i32>, #blocked>
+    %2 = scf.for %arg2 = %c0_i32 to %arg1 step %c1_i32 iter_args(%arg3 = %0) -> (tensor<1024xi32, #blocked>)  : i32 {
+      %3 = tt.addptr %1, %arg3 : tensor<1024x!tt.ptr<i32>, #blocked>, tensor<1024xi32, #blocked>
+      %4 = tt.load %3 : tensor<1024x!tt.ptr<i32>, #blocked>
+      scf.yield %4 : tensor<1024xi32, #blocked>
+    }
+    tt.return %2 : tensor<1024xi32, #blocked>
+  }
+
+  tt.func public @in_place_update(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: i32) {
+    %c1024_i32 = arith.constant 1024 : i32
+    %c0_i32 = arith.constant 0 : i32
+    %0 = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32, #blocked>
+    %1 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<1024x!tt.ptr<f32>, #blocked>
+    scf.for %arg2 = %c0_i32 to %arg1 step %c1024_i32  : i32 {
+      %2 = tt.splat %arg2 : i32 -> tensor<1024xi32, #blocked>
+      %3 = arith.addi %2, %0 : tensor<1024xi32, #blocked>
+      %4 = tt.addptr %1, %3 : tensor<1024x!tt.ptr<f32>, #blocked>, tensor<1024xi32, #blocked>
+      %5 = tt.load %4 : tensor<1024x!tt.ptr<f32>, #blocked>
+      %6 = arith.addf %5, %5 : tensor<1024xf32, #blocked>
+      %7 = tt.addptr %4, %0 : tensor<1024x!tt.ptr<f32>, #blocked>, tensor<1024xi32, #blocked>
+      tt.store %7, %6 : tensor<1024x!tt.ptr<f32>, #blocked>
+    }
+    tt.return
+  }
+}
+
+// -----
+
+// The loads of while loops are prefetched an iteration ahead, masked by the
+// condition of the next iteration, evaluated at the end of the current one.
+
+// CHECK-LABEL: @early_exit_sum
+// CHECK:   %[[FLAG0:.*]] = tt.load %{{.*}} : !tt.ptr<i32>
+// CHECK:   %[[COND0:.*]] = arith.cmpi
+// CHECK:   %[[MASK0:.*]] = tt.splat %[[COND0]]
+// CHECK:   %[[X0:.*]] = tt.load %{{.*}}, %[[MASK0]]
+// CHECK:   scf.while ({{.*}}, %[[ARG:.*]] = %[[X0]])
+// CHECK:     scf.condition({{.*}}) {{.*}}, %[[ARG]]
+// CHECK:   do
+// CHECK:     arith.addf
+// CHECK:     tt.load %{{.*}} : !tt.ptr<i32>
+// CHECK:     %[[COND:.*]] = arith.cmpi
+// CHECK:     %[[MASK:.*]] = tt.splat %[[COND]]
+// CHECK:     %[[X:.*]] = tt.load %{{.*}}, %[[MASK]]
+// CHECK:     scf.yield {{.*}}, %[[X]]
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func public @early_exit_sum(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<i32>) -> tensor<1024xf32, #blocked> {
+    %c0_i32 = arith.constant 0 : i32
+    %c1_i32 = arith.constant 1 : i32
+    %c1024_i32 = arith.constant 1024 : i32
+    %cst = arith.constant dense<0.000000e+00> : tensor<1024xf32, #blocked>
+    %0 = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32, #blocked>
+    %1 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<1024x!tt.ptr<f32>, #blocked>
+    %2:2 = scf.while (%arg2 = %c0_i32, %arg3 = %cst) : (i32, tensor<1024xf32, #blocked>) -> (i32, tensor<1024xf32, #blocked>) {
+      %3 = tt.addptr %arg1, %arg2 : !tt.ptr<i32>, i32
+      %4 = tt.load %3 : !tt.ptr<i32>
+      %5 = arith.cmpi eq, %4, %c0_i32 : i32
+      scf.condition(%5) %arg2, %arg3 : i32, tensor<1024xf32, #blocked>
+    } do {
+    ^bb0(%arg2: i32, %arg3: tensor<1024xf32, #blocked>):
+      %6 = arith.muli %arg2, %c1024_i32 : i32
+      %7 = tt.splat %6 : i32 -> tensor<1024xi32, #blocked>
+      %8 = arith.addi %7, %0 : tensor<1024xi32, #blocked>
+      %9 = tt.addptr %1, %8 : tensor<1024x!tt.ptr<f32>, #blocked>, tensor<1024xi32, #blocked>
+      %10 = tt.load %9 : tensor<1024x!tt.ptr<f32>, #blocked>
+      %11 = arith.addf %arg3, %10 : tensor<1024xf32, #blocked>
+      %12 = arith.addi %arg2, %c1_i32 : i32
+      scf.yield %12, %11 : i32, tensor<1024xf32, #blocked>
+    }
+    tt.return %2#1 : tensor<1024xf32, #blocked>
+  }
+}
+
+// -----
+
+// The outer loop of pipelined inner loops issues the copies of the prologues
+// of its next iteration after its inner loops, before its epilogue.
+
+// CHECK-LABEL: @outer_loop_two_inner_loops
+// CHECK: scf.for
+// CHECK:   scf.for
+// CHECK:   triton_gpu.async_wait {num = 0 : i32}
+// CHECK:   scf.for
+// CHECK:   triton_gpu.async_wait {num = 0 : i32}
+// CHECK-COUNT-4:   triton_gpu.async_copy_global_to_local
+// CHECK:   tt.store
+// CHECK:   scf.yield
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.target" = "cuda:80", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func public @outer_loop_two_inner_loops(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg2: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+    %c0_i32 = arith.constant 0 : i32
+    %c1_i32 = arith.constant 1 : i32
+    %c8_i32 = arith.constant 8 : i32
+    %c1024_i32 = arith.constant 1024 : i32
+    %c8192_i32 = arith.constant 8192 : i32
+    %cst = arith.constant dense<0.000000e+00> : tensor<1024xf32, #blocked>
+    %0 = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32, #blocked>
+    %1 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<1024x!tt.ptr<f32>, #blocked>
+    %2 = tt.splat %arg1 : !tt.ptr<f32> -> tensor<1024x!tt.ptr<f32>, #blocked>
+    %3 = tt.splat %arg2 : !tt.ptr<f32> -> tensor<1024x!tt.ptr<f32>, #blocked>
+    scf.for %arg3 = %c0_i32 to %c8_i32 step %c1_i32  : i32 {
+      %4 = arith.muli %arg3, %c8192_i32 : i32
+      %5 = tt.splat %4 : i32 -> tensor<1024xi32, #blocked>
+      %6 = arith.addi %5, %0 : tensor<1024xi32, #blocked>
+      %7 = scf.for %arg4 = %c0_i32 to %c8192_i32 step %c1024_i32 iter_args(%arg5 = %cst) -> (tensor<1024xf32, #blocked>)  : i32 {
+        %8 = tt.splat %arg4 : i32 -> tensor<1024xi32, #blocked>
+        %9 = arith.addi %6, %8 : tensor<1024xi32, #blocked>
+        %10 = tt.addptr %1, %9 : tensor<1024x!tt.ptr<f32>, #blocked>, tensor<1024xi32, #blocked>
+        %11 = tt.load %10 : tensor<1024x!tt.ptr<f32>, #blocked>
+        %12 = arith.addf %arg5, %11 : tensor<1024xf32, #blocked>
+        scf.yield %12 : tensor<1024xf32, #blocked>
+      }
+      %13 = scf.for %arg4 = %c0_i32 to %c8192_i32 step %c1024_i32 iter_args(%arg5 = %7) -> (tensor<1024xf32, #blocked>)  : i32 {
+        %14 = tt.splat %arg4 : i32 -> tensor<1024xi32, #blocked>
+        %15 = arith.addi %6, %14 : tensor<1024xi32, #blocked>
+        %16 = tt.addptr %2, %15 : tensor<1024x!tt.ptr<f32>, #blocked>, tensor<1024xi32, #blocked>
+        %17 = tt.load %16 : tensor<1024x!tt.ptr<f32>, #blocked>
+        %18 = arith.addf %arg5, %17 : tensor<1024xf32, #blocked>
+        scf.yield %18 : tensor<1024xf32, #blocked>
+      }
+      %19 = tt.splat %arg3 : i32 -> tensor<1024xi32, #blocked>
+      %20 = arith.muli %19, %0 : tensor<1024xi32, #blocked>
+      %21 = tt.addptr %3, %20 : tensor<1024x!tt.ptr<f32>, #blocked>, tensor<1024xi32, #blocked>
+      tt.store %21, %13 : tensor<1024x!tt.ptr<f32>, #blocked>
+    }
+    tt.return
+  }
+}
@@ -0,0 +1,61 @@
+// RUN: triton-opt %s -split-input-file --tritongpu-optimize-epilogue | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+#slice0 = #triton_gpu.slice<{dim = 0, parent = #blocked}>
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [4, 1], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0], instrShape = [16, 8]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  // fp32 rows written from the MMA layout use whole sectors, so the bias add
+  // and the activation run on the accumulator and the tile is stored directly.
+  // CHECK-LABEL: bias_relu_fp32
+  // CHECK-NOT: triton_gpu.convert_layout %{{.*}} : tensor<128x128xf32, #mma> -> tensor<128x128xf32, #blocked>
+  // CHECK: arith.addf %{{.*}}, %{{.*}} : tensor<128x128xf32, #mma>
+  // CHECK: arith.maximumf %{{.*}}, %{{.*}} : tensor<128x128xf32, #mma>
+  // CHECK: tt.store %{{.*}}, %{{.*}} : tensor<128x128x!tt.ptr<f32>, #mma>
+  tt.func @bias_relu_fp32(%acc: tensor<128x128xf32, #mma>, %bias_ptr: !tt.ptr<f32>, %out: !tt.ptr<f32>) {
+    %zero = arith.constant dense<0.000000e+00> : tensor<128x128xf32, #blocked>
+    %offs = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32, #slice0>
+    %bias_base = tt.splat %bias_ptr : !tt.ptr<f32> -> tensor<128x!tt.ptr<f32>, #slice0>
+    %bias_ptrs = tt.addptr %bias_base, %offs : tensor<128x!tt.ptr<f32>, #slice0>, tensor<128xi32, #slice0>
+    %bias = tt.load %bias_ptrs : tensor<128x!tt.ptr<f32>, #slice0>
+    %bias_row = tt.expand_dims %bias {axis = 0 : i32} : tensor<128xf32, #slice0> -> tensor<1x128xf32, #blocked>
+    %bias_tile = tt.broadcast %bias_row : tensor<1x128xf32, #blocked> -> tensor<128x128xf32, #blocked>
+    %0 = triton_gpu.convert_layout %acc : tensor<128x128xf32, #mma> -> tensor<128x128xf32, #blocked>
+    %1 = arith.addf %0, %bias_tile : tensor<128x128xf32, #blocked>
+    %2 = arith.maximumf %1, %zero : tensor<128x128xf32, #blocked>
+    %ptrs = tt.splat %out : !tt.ptr<f32> -> tensor<128x128x!tt.ptr<f32>, #blocked>
+    tt.store %ptrs, %2 : tensor<128x128x!tt.ptr<f32>, #blocked>
+    tt.return
+  }
+
+  // fp16 rows written from the MMA layout only use half of each sector, so the
+  // scaled and truncated values are converted right before the store.
+  // CHECK-LABEL: scale_fp16
+  // CHECK: arith.mulf %{{.*}}, %{{.*}} : tensor<128x128xf32, #mma>
+  // CHECK: %[[H:.*]] = arith.truncf %{{.*}} : tensor<128x128xf32, #mma> to tensor<128x128xf16, #mma>
+  // CHECK: %[[B:.*]] = triton_gpu.convert_layout %[[H]] : tensor<128x128xf16, #mma> -> tensor<128x128xf16, #blocked>
+  // CHECK: tt.store %{{.*}}, %[[B]] : tensor<128x128x!tt.ptr<f16>, #blocked>
+  tt.func @scale_fp16(%acc: tensor<128x128xf32, #mma>, %scale: f32, %out: !tt.ptr<f16>) {
+    %scale_tile = tt.splat %scale : f32 -> tensor<128x128xf32, #blocked>
+    %0 = triton_gpu.convert_layout %acc : tensor<128x128xf32, #mma> -> tensor<128x128xf32, #blocked>
+    %1 = arith.mulf %0, %scale_tile : tensor<128x128xf32, #blocked>
+    %2 = arith.truncf %1 : tensor<128x128xf32, #blocked> to tensor<128x128xf16, #blocked>
+    %ptrs = tt.splat %out : !tt.ptr<f16> -> tensor<128x128x!tt.ptr<f16>, #blocked>
+    tt.store %ptrs, %2 : tensor<128x128x!tt.ptr<f16>, #blocked>
+    tt.return
+  }
+
+  // A full tile loaded from memory would need its own conversion through
+  // shared memory, so the epilogue is left alone.
+  // CHECK-LABEL: residual_add
+  // CHECK: %[[C:.*]] = triton_gpu.convert_layout %{{.*}} : tensor<128x128xf32, #mma> -> tensor<128x128xf32, #blocked>
+  // CHECK: arith.addf %[[C]], %{{.*}} : tensor<128x128xf32, #blocked>
+  // CHECK: tt.store %{{.*}}, %{{.*}} : tensor<128x128x!tt.ptr<f32>, #blocked>
+  tt.func @residual_add(%acc: tensor<128x128xf32, #mma>, %res_ptrs: tensor<128x128x!tt.ptr<f32>, #blocked>, %out: !tt.ptr<f32>) {
+    %res = tt.load %res_ptrs : tensor<128x128x!tt.ptr<f32>, #blocked>
+    %0 = triton_gpu.convert_layout %acc : tensor<128x128xf32, #mma> -> tensor<128x128xf32, #blocked>
+    %1 = arith.addf %0, %res : tensor<128x128xf32, #blocked>
+    %ptrs = tt.splat %out : !tt.ptr<f32> -> tensor<128x128x!tt.ptr<f32>, #blocked>
+    tt.store %ptrs, %1 : tensor<128x128x!tt.ptr<f32>, #blocked>
+    tt.return
+  }
+}
@@ -596,6 +596,66 @@ module attributes {"triton_gpu.target" = "cuda:80", "triton_gpu.num-ctas" = 1 :
   }
 }
 
+// -----
+
+// CHECK-DAG: #[[$BLOCK1:.+]] = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [2, 16], warpsPerCTA = [2, 1], order = [1, 0]}>
+// CHECK-DAG: #[[$BLOCK2:.+]] = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [32, 1], warpsPerCTA = [2, 1], order = [0, 1]}>
+// CHECK-LABEL: optimize_view_layout_scan
+// CHECK: %[[R:.+]] = tt.reshape {{.*}} {allow_reorder = true, efficient_layout} : tensor<8x128xf32, #{{.+}}> -> tensor<64x16xf32, #[[$BLOCK2]]>
+// CHECK: %[[C:.+]] = triton_gpu.convert_layout %[[R]] : tensor<64x16xf32, #[[$BLOCK2]]> -> tensor<64x16xf32, #[[$BLOCK1]]>
+// CHECK:  "tt.scan"(%[[C]])
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 16], threadsPerWarp = [4, 8], warpsPerCTA = [2, 1], order = [1, 0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [2, 16], warpsPerCTA = [2, 1], order = [1, 0]}>
+module attributes {"triton_gpu.target" = "cuda:80", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 2 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func public @optimize_view_layout_scan(%arg0: tensor<8x128xf32, #blocked>) -> tensor<64x16xf32, #blocked1> {
+    %0 = tt.reshape %arg0 {allow_reorder = true} : tensor<8x128xf32, #blocked> -> tensor<64x16xf32, #blocked1>
+    %1 = "tt.scan"(%0) <{axis = 1 : i32, reverse = false}> ({
+    ^bb0(%arg1: f32, %arg2: f32):
+      %2 = arith.addf %arg1, %arg2 : f32
+      tt.scan.return %2 : f32
+    }) : (tensor<64x16xf32, #blocked1>) -> tensor<64x16xf32, #blocked1>
+    tt.return %1 : tensor<64x16xf32, #blocked1>
+  }
+}
+
+// -----
+
+// The layout of the reshape minimizes the communication of the row max, the
+// row sum and the column sum together: keeping the rows in a thread would make
+// the column sum go through shared memory.
+// CHECK-DAG: #[[$BLOCK1:.+]] = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [4, 8], warpsPerCTA = [1, 2], order = [1, 0]}>
+// CHECK-DAG: #[[$BLOCK2:.+]] = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [2, 16], warpsPerCTA = [2, 1], order = [1, 0]}>
+// CHECK-LABEL: optimize_view_layout_reduce_chain
+// CHECK: %[[R:.+]] = tt.reshape {{.*}} {allow_reorder = true, efficient_layout} : tensor<8x128xf32, #{{.+}}> -> tensor<64x16xf32, #[[$BLOCK2]]>
+// CHECK: triton_gpu.convert_layout %[[R]] : tensor<64x16xf32, #[[$BLOCK2]]> -> tensor<64x16xf32, #[[$BLOCK1]]>
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 16], threadsPerWarp = [4, 8], warpsPerCTA = [2, 1], order = [1, 0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [4, 8], warpsPerCTA = [1, 2], order = [1, 0]}>
+module attributes {"triton_gpu.target" = "cuda:80", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 2 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func public @optimize_view_layout_reduce_chain(%arg0: tensor<8x128xf32, #blocked>) -> (tensor<64xf32, #triton_gpu.slice<{dim = 1, parent = #blocked1}>>, tensor<16xf32, #triton_gpu.slice<{dim = 0, parent = #blocked1}>>) {
+    %0 = tt.reshape %arg0 {allow_reorder = true} : tensor<8x128xf32, #blocked> -> tensor<64x16xf32, #blocked1>
+    %1 = "tt.reduce"(%0) <{axis = 1 : i32}> ({
+    ^bb0(%arg1: f32, %arg2: f32):
+      %2 = arith.maximumf %arg1, %arg2 : f32
+      tt.reduce.return %2 : f32
+    }) : (tensor<64x16xf32, #blocked1>) -> tensor<64xf32, #triton_gpu.slice<{dim = 1, parent = #blocked1}>>
+    %3 = tt.expand_dims %1 {axis = 1 : i32} : tensor<64xf32, #triton_gpu.slice<{dim = 1, parent = #blocked1}>> -> tensor<64x1xf32, #blocked1>
+    %4 = tt.broadcast %3 : tensor<64x1xf32, #blocked1> -> tensor<64x16xf32, #blocked1>
+    %5 = arith.subf %0, %4 : tensor<64x16xf32, #blocked1>
+    %6 = math.exp %5 : tensor<64x16xf32, #blocked1>
+    %7 = "tt.reduce"(%6) <{axis = 1 : i32}> ({
+    ^bb0(%arg1: f32, %arg2: f32):
+      %8 = arith.addf %arg1, %arg2 : f32
+      tt.reduce.return %8 : f32
+    }) : (tensor<64x16xf32, #blocked1>) -> tensor<64xf32, #triton_gpu.slice<{dim = 1, parent = #blocked1}>>
+    %9 = "tt.reduce"(%6) <{axis = 0 : i32}> ({
+    ^bb0(%arg1: f32, %arg2: f32):
+      %10 = arith.addf %arg1, %arg2 : f32
+      tt.reduce.return %10 : f32
+    }) : (tensor<64x16xf32, #blocked1>) -> tensor<16xf32, #triton_gpu.slice<{dim = 0, parent = #blocked1}>>
+    tt.return %7, %9 : tensor<64xf32, #triton_gpu.slice<{dim = 1, parent = #blocked1}>>, tensor<16xf32, #triton_gpu.slice<{dim = 0, parent = #blocked1}>>
+  }
+}
+
 // -----
 #blocked = #triton_gpu.blocked<{sizePerThread = [8, 1], threadsPerWarp = [32, 1], warpsPerCTA = [1, 1], order = [1, 0]}>
 #blocked1 = #triton_gpu.blocked<{sizePerThread = [8], threadsPerWarp = [32], warpsPerCTA = [1], order = [0]}>
@@ -0,0 +1,31 @@
+// RUN: triton-opt %s -tritongpu-print-layout-info 2>&1 | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:80", "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func public @copy(%src: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %dst: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+    // CHECK: remark: tt.make_range:
+    // CHECK-NEXT: result #0:
+    // CHECK-NEXT: layout:
+    // CHECK-NEXT: - register=1 -> (1)
+    // CHECK: where out dims are: [dim0 (size 512)]
+    // CHECK-NEXT: axis info: contiguity = [512], divisibility = [1073741824], constancy = [1]
+    %offsets = tt.make_range {end = 512 : i32, start = 0 : i32} : tensor<512xi32, #blocked>
+    %src_splat = tt.splat %src : !tt.ptr<f32> -> tensor<512x!tt.ptr<f32>, #blocked>
+    %src_ptrs = tt.addptr %src_splat, %offsets : tensor<512x!tt.ptr<f32>, #blocked>, tensor<512xi32, #blocked>
+    // CHECK: remark: tt.load:
+    // CHECK: vector width: 4
+    %values = tt.load %src_ptrs : tensor<512x!tt.ptr<f32>, #blocked>
+    // CHECK: remark: triton_gpu.convert_layout:
+    // CHECK: scratch shared memory: offset = 0, size =
+    // CHECK: conversion through shared memory, per-thread cost = 32
+    %cvt = triton_gpu.convert_layout %values : tensor<512xf32, #blocked> -> tensor<512xf32, #blocked1>
+    %dst_splat = tt.splat %dst : !tt.ptr<f32> -> tensor<512x!tt.ptr<f32>, #blocked1>
+    %offsets1 = tt.make_range {end = 512 : i32, start = 0 : i32} : tensor<512xi32, #blocked1>
+    %dst_ptrs = tt.addptr %dst_splat, %offsets1 : tensor<512x!tt.ptr<f32>, #blocked1>, tensor<512xi32, #blocked1>
+    // CHECK: remark: tt.store:
+    // CHECK: vector width: 1
+    tt.store %dst_ptrs, %cvt : tensor<512x!tt.ptr<f32>, #blocked1>
+    tt.return
+  }
+}
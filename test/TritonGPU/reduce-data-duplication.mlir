@@ -12,3 +12,34 @@ module attributes {"triton_gpu.target" = "cuda:80", "triton_gpu.num-ctas" = 1 :
     tt.return
   }
 }
+
+// -----
+
+// The operand of the FMA dot is already held by the threads that read it.
+//       CHECK-LABEL:   fma_operand_in_registers
+//   CHECK-NOT:   triton_gpu.local_alloc
+//       CHECK:   triton_gpu.convert_layout
+#blocked = #triton_gpu.blocked<{sizePerThread = [2, 16], threadsPerWarp = [8, 4], warpsPerCTA = [2, 2], order = [1, 0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [2, 2], threadsPerWarp = [8, 4], warpsPerCTA = [2, 2], order = [1, 0]}>
+module attributes {"triton_gpu.target" = "cuda:89", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func @fma_operand_in_registers(%arg0: tensor<32x16xf32, #blocked>) {
+    %0 = triton_gpu.convert_layout %arg0 : tensor<32x16xf32, #blocked> -> tensor<32x16xf32, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked1}>>
+    tt.return
+  }
+}
+
+// -----
+
+// The default swizzling of the operand, 2 rows per phase, makes the loads of
+// 4 consecutive elements per lane conflict, and a phase per row is picked.
+//       CHECK:   #[[SHARED:.*]] = #triton_gpu.shared<{vec = 16, perPhase = 1, maxPhase = 4, order = [0, 1], hasLeadingOffset = false}
+//       CHECK-LABEL:   dequant_operand_swizzle
+//       CHECK:   triton_gpu.local_alloc %{{.*}} : (tensor<64x64xf16, #{{.*}}>) -> !tt.memdesc<64x64xf16, #[[SHARED]], #triton_gpu.shared_memory>
+#blocked = #triton_gpu.blocked<{sizePerThread = [8, 1], threadsPerWarp = [8, 4], warpsPerCTA = [1, 4], order = [0, 1]}>
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [4, 1], instrShape = [16, 8]}>
+module attributes {"triton_gpu.target" = "cuda:80", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func @dequant_operand_swizzle(%arg0: tensor<64x64xf16, #blocked>) {
+    %0 = triton_gpu.convert_layout %arg0 : tensor<64x64xf16, #blocked> -> tensor<64x64xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 4}>>
+    tt.return
+  }
+}
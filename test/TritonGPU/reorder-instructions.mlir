@@ -100,3 +100,32 @@ module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-war
     tt.return
   }
 }
+
+// -----
+
+// check that loads are hoisted above the stores to other arguments when one of
+// them is restrict, but not above the stores that may alias.
+// CHECK-LABEL: hoist_load_above_store
+//       CHECK: %[[A:[0-9]+]] = tt.load
+//  CHECK-NEXT: tt.store %[[CPTRS:[0-9]+]], %arg3 :
+//  CHECK-NEXT: %[[B:[0-9]+]] = tt.load
+//  CHECK-NEXT: tt.store %[[CPTRS]], %[[A]] :
+//  CHECK-NEXT: tt.store %[[CPTRS]], %[[B]] :
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func public @hoist_load_above_store(%arg0: !tt.ptr<f32> {tt.noalias = 1 : i32}, %arg1: !tt.ptr<f32>, %arg2: !tt.ptr<f32>, %arg3: tensor<512xf32, #blocked>) {
+    %range = tt.make_range {end = 512 : i32, start = 0 : i32} : tensor<512xi32, #blocked>
+    %a = tt.splat %arg0 : !tt.ptr<f32> -> tensor<512x!tt.ptr<f32>, #blocked>
+    %aptrs = tt.addptr %a, %range : tensor<512x!tt.ptr<f32>, #blocked>, tensor<512xi32, #blocked>
+    %b = tt.splat %arg1 : !tt.ptr<f32> -> tensor<512x!tt.ptr<f32>, #blocked>
+    %bptrs = tt.addptr %b, %range : tensor<512x!tt.ptr<f32>, #blocked>, tensor<512xi32, #blocked>
+    %c = tt.splat %arg2 : !tt.ptr<f32> -> tensor<512x!tt.ptr<f32>, #blocked>
+    %cptrs = tt.addptr %c, %range : tensor<512x!tt.ptr<f32>, #blocked>, tensor<512xi32, #blocked>
+    tt.store %cptrs, %arg3 : tensor<512x!tt.ptr<f32>, #blocked>
+    %0 = tt.load %aptrs : tensor<512x!tt.ptr<f32>, #blocked>
+    %1 = tt.load %bptrs : tensor<512x!tt.ptr<f32>, #blocked>
+    tt.store %cptrs, %0 : tensor<512x!tt.ptr<f32>, #blocked>
+    tt.store %cptrs, %1 : tensor<512x!tt.ptr<f32>, #blocked>
+    tt.return
+  }
+}
@@ -0,0 +1,46 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-spill-to-shared-memory="shared-memory-size=65536" | FileCheck %s
+// RUN: triton-opt %s -split-input-file -tritongpu-spill-to-shared-memory="shared-memory-size=32768" | FileCheck %s --check-prefix=NOSPILL
+
+// The 128 registers of %0 are live across the 256 registers of %1 and %2; %0
+// is stored to shared memory and reloaded at its use.
+// CHECK: #[[SHARED:.*]] = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0], hasLeadingOffset = false}>
+// CHECK-LABEL: @spill_long_lived
+// CHECK: %[[X:.*]] = arith.extf %arg0
+// CHECK-NEXT: %[[BUF:.*]] = triton_gpu.local_alloc  : () -> !tt.memdesc<128x128xf32, #[[SHARED]], #triton_gpu.shared_memory, mutable>
+// CHECK-NEXT: triton_gpu.local_store %[[X]], %[[BUF]]
+// CHECK: %[[Y:.*]] = arith.truncf
+// CHECK-NEXT: %[[RELOAD:.*]] = triton_gpu.local_load %[[BUF]]
+// CHECK-NEXT: %[[Z:.*]] = arith.truncf %[[RELOAD]]
+// CHECK-NEXT: arith.addf %[[Z]], %[[Y]]
+// NOSPILL-LABEL: @spill_long_lived
+// NOSPILL-NOT: triton_gpu.local_store
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.target" = "cuda:80", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func @spill_long_lived(%arg0: tensor<128x128xf16, #blocked>, %arg1: tensor<128x128xf16, #blocked>) -> tensor<128x128xf16, #blocked> {
+    %0 = arith.extf %arg0 : tensor<128x128xf16, #blocked> to tensor<128x128xf32, #blocked>
+    %1 = arith.extf %arg1 : tensor<128x128xf16, #blocked> to tensor<128x128xf32, #blocked>
+    %2 = arith.mulf %1, %1 : tensor<128x128xf32, #blocked>
+    %3 = arith.truncf %2 : tensor<128x128xf32, #blocked> to tensor<128x128xf16, #blocked>
+    %4 = arith.truncf %0 : tensor<128x128xf32, #blocked> to tensor<128x128xf16, #blocked>
+    %5 = arith.addf %4, %3 : tensor<128x128xf16, #blocked>
+    tt.return %5 : tensor<128x128xf16, #blocked>
+  }
+}
+
+// -----
+
+// The pressure is within the limit.
+// CHECK-LABEL: @no_pressure
+// CHECK-NOT: triton_gpu.local_store
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.target" = "cuda:80", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func @no_pressure(%arg0: tensor<64x128xf16, #blocked>, %arg1: tensor<64x128xf16, #blocked>) -> tensor<64x128xf16, #blocked> {
+    %0 = arith.extf %arg0 : tensor<64x128xf16, #blocked> to tensor<64x128xf32, #blocked>
+    %1 = arith.extf %arg1 : tensor<64x128xf16, #blocked> to tensor<64x128xf32, #blocked>
+    %2 = arith.mulf %1, %1 : tensor<64x128xf32, #blocked>
+    %3 = arith.truncf %2 : tensor<64x128xf32, #blocked> to tensor<64x128xf16, #blocked>
+    %4 = arith.truncf %0 : tensor<64x128xf32, #blocked> to tensor<64x128xf16, #blocked>
+    %5 = arith.addf %4, %3 : tensor<64x128xf16, #blocked>
+    tt.return %5 : tensor<64x128xf16, #blocked>
+  }
+}
@@ -0,0 +1,84 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-combine-tensor-select-and-if=version-uniform-masks=true | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:90", "triton_gpu.threads-per-warp" = 32 : i32} {
+// The causal mask of the tiles of a row block is all true below the diagonal,
+// partial on it and all false above it.
+// CHECK-LABEL: @causal_mask
+// CHECK-DAG: %[[ZERO:.*]] = arith.constant dense<0.000000e+00>
+// CHECK-DAG: %[[NEG_INF:.*]] = arith.constant dense<0xFF800000>
+// CHECK: %[[FULL:.*]] = scf.for
+// CHECK-NOT: arith.select
+// CHECK: arith.addf %{{.*}}, %[[ZERO]] :
+// CHECK: scf.yield
+// CHECK: %[[PARTIAL:.*]] = scf.for {{.*}} iter_args(%{{.*}} = %[[FULL]])
+// CHECK: arith.select
+// CHECK: scf.yield
+// CHECK: scf.for {{.*}} iter_args(%{{.*}} = %[[PARTIAL]])
+// CHECK-NOT: arith.select
+// CHECK: arith.addf %{{.*}}, %[[NEG_INF]] :
+// CHECK: scf.yield
+  tt.func @causal_mask(%start_m: i32, %ub: i32, %qk: tensor<64x64xf32, #blocked>) -> tensor<64x64xf32, #blocked> {
+    %c0_i32 = arith.constant 0 : i32
+    %c64_i32 = arith.constant 64 : i32
+    %zero = arith.constant dense<0.000000e+00> : tensor<64x64xf32, #blocked>
+    %neg_inf = arith.constant dense<0xFF800000> : tensor<64x64xf32, #blocked>
+    %rows = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>
+    %cols = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32, #triton_gpu.slice<{dim = 0, parent = #blocked}>>
+    %m_splat = tt.splat %start_m : i32 -> tensor<64xi32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>
+    %offs_m = arith.addi %m_splat, %rows : tensor<64xi32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>
+    %offs_m_2d = tt.expand_dims %offs_m {axis = 1 : i32} : tensor<64xi32, #triton_gpu.slice<{dim = 1, parent = #blocked}>> -> tensor<64x1xi32, #blocked>
+    %offs_m_b = tt.broadcast %offs_m_2d : tensor<64x1xi32, #blocked> -> tensor<64x64xi32, #blocked>
+    %cols_2d = tt.expand_dims %cols {axis = 0 : i32} : tensor<64xi32, #triton_gpu.slice<{dim = 0, parent = #blocked}>> -> tensor<1x64xi32, #blocked>
+    %cols_b = tt.broadcast %cols_2d : tensor<1x64xi32, #blocked> -> tensor<64x64xi32, #blocked>
+    %res = scf.for %start_n = %c0_i32 to %ub step %c64_i32 iter_args(%acc = %qk) -> (tensor<64x64xf32, #blocked>) : i32 {
+      %n_splat = tt.splat %start_n : i32 -> tensor<64x64xi32, #blocked>
+      %offs_n = arith.addi %n_splat, %cols_b : tensor<64x64xi32, #blocked>
+      %mask = arith.cmpi sge, %offs_m_b, %offs_n : tensor<64x64xi32, #blocked>
+      %bias = arith.select %mask, %zero, %neg_inf : tensor<64x64xi1, #blocked>, tensor<64x64xf32, #blocked>
+      %next = arith.addf %acc, %bias : tensor<64x64xf32, #blocked>
+      scf.yield %next : tensor<64x64xf32, #blocked>
+    }
+    tt.return %res : tensor<64x64xf32, #blocked>
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:90", "triton_gpu.threads-per-warp" = 32 : i32} {
+// The bounds check of a tile is all true, unless the tile is at the end.
+// CHECK-LABEL: @bounds_check
+// CHECK: %[[ALL_TRUE:.*]] = arith.cmpi slt
+// CHECK: %[[ALL_FALSE:.*]] = arith.cmpi sge
+// CHECK: %[[LOAD:.*]] = scf.if %[[ALL_TRUE]]
+// CHECK-NEXT: %[[FULL:.*]] = tt.load %{{.*}} : tensor<512x!tt.ptr<f32>, #blocked>
+// CHECK-NEXT: scf.yield %[[FULL]]
+// CHECK: scf.if %[[ALL_FALSE]]
+// CHECK-NEXT: scf.yield %{{.*}}
+// CHECK: tt.load %{{.*}}, %{{.*}}, %{{.*}} :
+// CHECK: scf.if %{{.*}} {
+// CHECK-NEXT: tt.store %{{.*}}, %[[LOAD]] :
+// CHECK: } else {
+// CHECK: scf.if %{{.*}} {
+// CHECK-NEXT: } else {
+// CHECK-NEXT: tt.store %{{.*}}, %[[LOAD]], %{{.*}} :
+  tt.func @bounds_check(%src: !tt.ptr<f32>, %dst: !tt.ptr<f32>, %n: i32) {
+    %c512_i32 = arith.constant 512 : i32
+    %other = arith.constant dense<1.000000e+00> : tensor<512xf32, #blocked>
+    %pid = tt.get_program_id x : i32
+    %start = arith.muli %pid, %c512_i32 : i32
+    %range = tt.make_range {end = 512 : i32, start = 0 : i32} : tensor<512xi32, #blocked>
+    %start_splat = tt.splat %start : i32 -> tensor<512xi32, #blocked>
+    %offsets = arith.addi %start_splat, %range : tensor<512xi32, #blocked>
+    %n_splat = tt.splat %n : i32 -> tensor<512xi32, #blocked>
+    %mask = arith.cmpi slt, %offsets, %n_splat : tensor<512xi32, #blocked>
+    %src_splat = tt.splat %src : !tt.ptr<f32> -> tensor<512x!tt.ptr<f32>, #blocked>
+    %src_ptrs = tt.addptr %src_splat, %offsets : tensor<512x!tt.ptr<f32>, #blocked>, tensor<512xi32, #blocked>
+    %dst_splat = tt.splat %dst : !tt.ptr<f32> -> tensor<512x!tt.ptr<f32>, #blocked>
+    %dst_ptrs = tt.addptr %dst_splat, %offsets : tensor<512x!tt.ptr<f32>, #blocked>, tensor<512xi32, #blocked>
+    %val = tt.load %src_ptrs, %mask, %other : tensor<512x!tt.ptr<f32>, #blocked>
+    tt.store %dst_ptrs, %val, %mask : tensor<512x!tt.ptr<f32>, #blocked>
+    tt.return
+  }
+}
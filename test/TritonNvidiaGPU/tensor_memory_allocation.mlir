@@ -0,0 +1,41 @@
+// RUN: triton-opt %s -split-input-file --triton-nvidia-tensor-memory-allocation | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 128], threadsPerWarp = [32, 1], warpsPerCTA = [4, 1], order = [0, 1]}>
+#tmem = #triton_nvidia_gpu.tensor_memory_encoding<blockM = 128, blockN = 128>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:100", "triton_gpu.threads-per-warp" = 32 : i32} {
+// CHECK: module attributes {{.*}}triton_nvidia_gpu.tensor_memory_size = 256 : i32
+// CHECK-LABEL: overlapping_buffers
+//       CHECK: %[[SLOT:.*]] = triton_gpu.local_alloc  : () -> !tt.memdesc<1xi32
+//       CHECK: %[[BASE:.*]] = triton_nvidia_gpu.tmem_allocate_columns %[[SLOT]], 256
+//       CHECK: triton_nvidia_gpu.tmem_alloc %{{.*}} base %[[BASE]] {tensor_memory_col_offset = 0 : i32}
+//       CHECK: triton_nvidia_gpu.tmem_alloc %{{.*}} base %[[BASE]] {tensor_memory_col_offset = 128 : i32}
+//       CHECK: triton_nvidia_gpu.tmem_deallocate_columns %[[BASE]], 256
+//  CHECK-NEXT: tt.return
+  tt.func public @overlapping_buffers(%arg0: tensor<128x128xf32, #blocked>) -> tensor<128x128xf32, #blocked> {
+    %0 = triton_nvidia_gpu.tmem_alloc %arg0 : (tensor<128x128xf32, #blocked>) -> !tt.memdesc<128x128xf32, #tmem, #triton_nvidia_gpu.tensor_memory, mutable>
+    %1 = triton_nvidia_gpu.tmem_alloc %arg0 : (tensor<128x128xf32, #blocked>) -> !tt.memdesc<128x128xf32, #tmem, #triton_nvidia_gpu.tensor_memory, mutable>
+    %2 = triton_nvidia_gpu.tmem_load %0 : !tt.memdesc<128x128xf32, #tmem, #triton_nvidia_gpu.tensor_memory, mutable> -> tensor<128x128xf32, #blocked>
+    %3 = triton_nvidia_gpu.tmem_load %1 : !tt.memdesc<128x128xf32, #tmem, #triton_nvidia_gpu.tensor_memory, mutable> -> tensor<128x128xf32, #blocked>
+    %4 = arith.addf %2, %3 : tensor<128x128xf32, #blocked>
+    tt.return %4 : tensor<128x128xf32, #blocked>
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 64], threadsPerWarp = [32, 1], warpsPerCTA = [4, 1], order = [0, 1]}>
+#tmem = #triton_nvidia_gpu.tensor_memory_encoding<blockM = 128, blockN = 64>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:100", "triton_gpu.threads-per-warp" = 32 : i32} {
+// CHECK: module attributes {{.*}}triton_nvidia_gpu.tensor_memory_size = 64 : i32
+// CHECK-LABEL: disjoint_buffers
+//       CHECK: triton_nvidia_gpu.tmem_allocate_columns %{{.*}}, 64
+//       CHECK: triton_nvidia_gpu.tmem_alloc %{{.*}} base %{{.*}} {tensor_memory_col_offset = 0 : i32}
+//       CHECK: triton_nvidia_gpu.tmem_alloc %{{.*}} base %{{.*}} {tensor_memory_col_offset = 0 : i32}
+  tt.func public @disjoint_buffers(%arg0: tensor<128x64xf32, #blocked>) -> tensor<128x64xf32, #blocked> {
+    %0 = triton_nvidia_gpu.tmem_alloc %arg0 : (tensor<128x64xf32, #blocked>) -> !tt.memdesc<128x64xf32, #tmem, #triton_nvidia_gpu.tensor_memory, mutable>
+    %1 = triton_nvidia_gpu.tmem_load %0 : !tt.memdesc<128x64xf32, #tmem, #triton_nvidia_gpu.tensor_memory, mutable> -> tensor<128x64xf32, #blocked>
+    %2 = triton_nvidia_gpu.tmem_alloc %1 : (tensor<128x64xf32, #blocked>) -> !tt.memdesc<128x64xf32, #tmem, #triton_nvidia_gpu.tensor_memory, mutable>
+    %3 = triton_nvidia_gpu.tmem_load %2 : !tt.memdesc<128x64xf32, #tmem, #triton_nvidia_gpu.tensor_memory, mutable> -> tensor<128x64xf32, #blocked>
+    tt.return %3 : tensor<128x64xf32, #blocked>
+  }
+}
@@ -18,14 +18,96 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 :
 
 // -----
 
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [1, 32], warpsPerCTA = [1, 4], order = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:90", "triton_gpu.threads-per-warp" = 32 : i32} {
+// CHECK-LABEL: tma_load_im2col
+// CHECK: triton_nvidia_gpu.async_tma_copy_global_to_local %arg0[%arg1, %arg1, %arg1, %arg1] im2col[%arg2, %arg2]
+  tt.func public @tma_load_im2col(%arg0: !tt.ptr<i8>, %arg1: i32, %arg2: i16) -> tensor<64x64xf16, #blocked> {
+    %l = tt.experimental_descriptor_load %arg0[%arg1, %arg1, %arg1, %arg1] im2col[%arg2, %arg2] : !tt.ptr<i8> -> tensor<64x64xf16, #blocked>
+    tt.return %l : tensor<64x64xf16, #blocked>
+  }
+}
+
+// -----
+
 #blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [1, 32], warpsPerCTA = [1, 4], order = [1, 0]}>
 module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:90", "triton_gpu.threads-per-warp" = 32 : i32} {
 // CHECK-LABEL: tma_store
 //       CHECK: triton_gpu.local_alloc
 //       CHECK: triton_nvidia_gpu.fence_async_shared {bCluster = false}
 //       CHECK: triton_nvidia_gpu.async_tma_copy_local_to_global
+//       CHECK: triton_nvidia_gpu.async_tma_store_wait {pendings = 0 : i32}
+//  CHECK-NEXT: triton_gpu.local_dealloc
+//  CHECK-NEXT: tt.return
   tt.func public @tma_store(%arg0: !tt.ptr<i8> {tt.divisibility = 16 : i32}, %arg1: i32 {tt.divisibility = 16 : i32}, %arg2: tensor<128x256xf32, #blocked>) {
     tt.experimental_descriptor_store %arg0[%arg1, %arg1], %arg2 : !tt.ptr<i8>, tensor<128x256xf32, #blocked>
     tt.return
   }
 }
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [1, 32], warpsPerCTA = [1, 4], order = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:90", "triton_gpu.threads-per-warp" = 32 : i32} {
+// Reductions are staged in shared memory and waited on like stores.
+// CHECK-LABEL: tma_reduce
+//       CHECK: %[[A:.*]] = triton_gpu.local_alloc
+//       CHECK: triton_nvidia_gpu.fence_async_shared {bCluster = false}
+//       CHECK: triton_nvidia_gpu.async_tma_reduce fadd, %arg0[%arg1, %arg1] %[[A]]
+//       CHECK: triton_nvidia_gpu.async_tma_store_wait {pendings = 0 : i32}
+//  CHECK-NEXT: triton_gpu.local_dealloc %[[A]]
+//  CHECK-NEXT: tt.return
+  tt.func public @tma_reduce(%arg0: !tt.ptr<i8> {tt.divisibility = 16 : i32}, %arg1: i32 {tt.divisibility = 16 : i32}, %arg2: tensor<128x256xf32, #blocked>) {
+    tt.experimental_descriptor_reduce fadd, %arg0[%arg1, %arg1], %arg2 : !tt.ptr<i8>, tensor<128x256xf32, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [1, 32], warpsPerCTA = [1, 4], order = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:90", "triton_gpu.threads-per-warp" = 32 : i32} {
+// The wait of top-level stores is deferred to the end of the kernel and shared
+// between them.
+// CHECK-LABEL: tma_store_deferred_wait
+//       CHECK: %[[A:.*]] = triton_gpu.local_alloc
+//       CHECK: triton_nvidia_gpu.async_tma_copy_local_to_global
+//   CHECK-NOT: triton_nvidia_gpu.async_tma_store_wait
+//       CHECK: %[[B:.*]] = triton_gpu.local_alloc
+//       CHECK: triton_nvidia_gpu.async_tma_copy_local_to_global
+//       CHECK: tt.call @foo
+//       CHECK: triton_nvidia_gpu.async_tma_store_wait {pendings = 0 : i32}
+//   CHECK-NOT: triton_nvidia_gpu.async_tma_store_wait
+//   CHECK-DAG: triton_gpu.local_dealloc %[[A]]
+//   CHECK-DAG: triton_gpu.local_dealloc %[[B]]
+//       CHECK: tt.return
+  tt.func private @foo()
+  tt.func public @tma_store_deferred_wait(%arg0: !tt.ptr<i8> {tt.divisibility = 16 : i32}, %arg1: i32 {tt.divisibility = 16 : i32}, %arg2: tensor<128x64xf16, #blocked>) {
+    tt.experimental_descriptor_store %arg0[%arg1, %arg1], %arg2 : !tt.ptr<i8>, tensor<128x64xf16, #blocked>
+    tt.experimental_descriptor_store %arg0[%arg1, %arg1], %arg2 : !tt.ptr<i8>, tensor<128x64xf16, #blocked>
+    tt.call @foo() : () -> ()
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [1, 32], warpsPerCTA = [1, 4], order = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:90", "triton_gpu.threads-per-warp" = 32 : i32} {
+// Stores in a loop reuse the staging buffer, so they keep waiting right away.
+// CHECK-LABEL: tma_store_in_loop
+//       CHECK: scf.for
+//       CHECK: triton_nvidia_gpu.async_tma_copy_local_to_global
+//  CHECK-NEXT: triton_nvidia_gpu.async_tma_store_wait {pendings = 0 : i32}
+//       CHECK: scf.yield
+//   CHECK-NOT: triton_gpu.local_dealloc
+//       CHECK: tt.return
+  tt.func public @tma_store_in_loop(%arg0: !tt.ptr<i8> {tt.divisibility = 16 : i32}, %arg1: i32 {tt.divisibility = 16 : i32}, %arg2: tensor<128x64xf16, #blocked>) {
+    %c0 = arith.constant 0 : i32
+    %c1 = arith.constant 1 : i32
+    scf.for %i = %c0 to %arg1 step %c1 : i32 {
+      tt.experimental_descriptor_store %arg0[%i, %arg1], %arg2 : !tt.ptr<i8>, tensor<128x64xf16, #blocked>
+    }
+    tt.return
+  }
+}
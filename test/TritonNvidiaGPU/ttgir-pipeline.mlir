@@ -0,0 +1,16 @@
+// RUN: triton-opt %s --triton-cuda-ttgir-pipeline="capability=90 num-warps=8" | FileCheck %s
+
+// CHECK: module attributes {{.*}}"triton_gpu.num-warps" = 8 : i32{{.*}}triton_gpu.target = "cuda:90"
+// CHECK-LABEL: @copy
+// CHECK: tt.load %{{.*}} : tensor<1024x!tt.ptr<f32>, #{{.*}}>
+// CHECK: tt.store
+tt.func public @copy(%src: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %dst: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+  %offsets = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32>
+  %src_splat = tt.splat %src : !tt.ptr<f32> -> tensor<1024x!tt.ptr<f32>>
+  %src_ptrs = tt.addptr %src_splat, %offsets : tensor<1024x!tt.ptr<f32>>, tensor<1024xi32>
+  %values = tt.load %src_ptrs : tensor<1024x!tt.ptr<f32>>
+  %dst_splat = tt.splat %dst : !tt.ptr<f32> -> tensor<1024x!tt.ptr<f32>>
+  %dst_ptrs = tt.addptr %dst_splat, %offsets : tensor<1024x!tt.ptr<f32>>, tensor<1024xi32>
+  tt.store %dst_ptrs, %values : tensor<1024x!tt.ptr<f32>>
+  tt.return
+}
@@ -0,0 +1,53 @@
+#include "mlir/Pass/Pass.h"
+#include "triton/Analysis/RegisterPressure.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+
+using namespace mlir;
+
+namespace {
+
+struct TestRegisterPressurePass
+    : public PassWrapper<TestRegisterPressurePass, OperationPass<ModuleOp>> {
+
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(TestRegisterPressurePass);
+
+  StringRef getArgument() const final {
+    return "test-print-register-pressure";
+  }
+  StringRef getDescription() const final {
+    return "print the result of the register pressure analysis";
+  }
+
+  void runOnOperation() override {
+    auto &os = llvm::errs();
+    ModuleOp moduleOp = getOperation();
+    moduleOp.walk([&](triton::FuncOp funcOp) {
+      auto opName = SymbolTable::getSymbolName(funcOp).getValue().str();
+      os << opName << "\n";
+      os << "limit = "
+         << RegisterPressureAnalysis::getRegisterLimit(
+                funcOp->getParentOfType<ModuleOp>())
+         << "\n";
+      RegisterPressureAnalysis analysis(funcOp);
+      funcOp.walk<WalkOrder::PreOrder>([&](Operation *op) {
+        if (op == funcOp.getOperation())
+          return;
+        os << op->getName() << ": live = " << analysis.getLiveRegisters(op);
+        if (op->getNumRegions() != 0)
+          os << ", max = " << analysis.getMaxLiveRegisters(op);
+        os << "\n";
+      });
+      os << "max = " << analysis.getMaxLiveRegisters() << "\n";
+    });
+  }
+};
+
+} // namespace
+
+namespace mlir {
+namespace test {
+void registerTestRegisterPressurePass() {
+  PassRegistration<TestRegisterPressurePass>();
+}
+} // namespace test
+} // namespace mlir
@@ -11,6 +11,41 @@ import functools
 from pathlib import Path
 
 
+def get_resource_usage(amdgcn: str, arch: str, num_warps: int, shared: int) -> dict:
+    """
+    Reads the register, spill and LDS usage of the kernel from the code object metadata at the end of the assembly,
+    and estimates the waves each SIMD runs concurrently.
+    """
+
+    def get_count(name):
+        match = re.search(rf"^\s*\.{name}:\s+(\d+)", amdgcn, re.MULTILINE)
+        return int(match.group(1)) if match else 0
+
+    vgprs = get_count("vgpr_count")
+    agprs = get_count("agpr_count")
+    sgprs = get_count("sgpr_count")
+    lds = max(get_count("group_segment_fixed_size"), shared)
+    usage = {
+        "n_regs": vgprs,
+        "n_sgprs": sgprs,
+        "n_spills": get_count("vgpr_spill_count") + get_count("sgpr_spill_count"),
+        "scratch": get_count("private_segment_fixed_size"),
+    }
+    if not arch.startswith("gfx9"):
+        return usage
+    # gfx908 has separate files of 256 VGPRs and AGPRs, later CDNAs a unified file of 512 with AGPRs counted in
+    # `vgpr_count`.  Registers are allocated by granules of 8.
+    if arch == "gfx908":
+        max_waves, waves = 10, 256 // ((max(vgprs, agprs, 1) + 7) & ~7)
+    else:
+        max_waves, waves = 8, 512 // ((max(vgprs, 1) + 7) & ~7)
+    if lds > 0:
+        # The 64 KB of LDS of a CU are shared by its workgroups, whose warps are spread over its 4 SIMDs
+        waves = min(waves, 65536 // lds * ((num_warps + 3) // 4))
+    usage["occupancy"] = min(waves, max_waves)
+    return usage
+
+
 @dataclass(frozen=True)
 class HIPOptions:
     num_warps: int = 4
@@ -24,19 +59,44 @@ class HIPOptions:
     allow_fp8e4nv: bool = False
     allow_fp8e4b15: bool = False
     default_dot_input_precision: str = "ieee"
-    allowed_dot_input_precisions: Tuple[str] = ("ieee", )
+    allowed_dot_input_precisions: Tuple[str] = ("ieee", "bf16x3", "bf16x6")
     enable_fp_fusion: bool = True
+    # MN size of the MFMA instructions and number of instructions fed by each LDS read of their operands, chosen with
+    # a cost model of the dot when 0
     matrix_instr_nonkdim: int = 0
-    kpack: int = 1
+    kpack: int = 0
+    # Interleaving of MFMA and memory instructions asked to the LLVM scheduler: "none", "iglp0" and "iglp1" (the
+    # llvm.amdgcn.iglp.opt strategies) or "interleave" (an even share of the memory instructions after each MFMA)
+    instruction_sched_variant: str = 'none'
+    # With num_stages >= 4, runs the two halves of the waves one phase apart in the pipelined loops so that the dots
+    # of one half overlap the rest of the loop body of the other half (e.g., the softmax of attention)
+    ping_pong: bool = False
     allow_flush_denorm: bool = False
+    # Lowers the f32 exp, log, sin, cos, sqrt, rsqrt and divisions to the approximate hardware instructions (e.g.,
+    # v_exp_f32) and lets LLVM reassociate floating-point ops.  Infinities and NaNs are preserved.  The functions of
+    # tl.extra.hip.libdevice keep their precision, e.g. to opt a single op out.
+    fast_math: bool = False
+    # device_log > 0 lowers device_print and device_assert to appending records to a ring buffer of this many
+    # records in the kernel, and failing asserts don't stop the kernel.  See triton.runtime.device_log.
+    device_log: int = 0
     max_num_imprecise_acc_default: int = 0
+    # llvm_pipeline selects the LLVM optimizations: "" for the O3 pipeline, "triton" for the passes of O3 that matter
+    # for the IR generated by Triton, without the loop unrolling and vectorization passes, which cuts the time of the
+    # LLVM stage, or a textual pipeline of the new pass manager, e.g. "function(instcombine,gvn)".
+    llvm_pipeline: str = ""
+    # Register estimates are only checked by the CUDA backend.
+    estimate_spills: bool = False
+    # The order of the programs over the grid for L2 reuse, as for the CUDA backend: "", "grouped", "morton" or
+    # "hilbert".
+    rasterization: str = ""
+    raster_group_size: int = 8
     backend_name: str = 'hip'
 
     def __post_init__(self):
         default_libdir = Path(__file__).parent / 'lib'
         extern_libs = {} if self.extern_libs is None else dict(self.extern_libs)
         # Ignore user-defined warp size for gfx9
-        warp_size = 32 if 'gfx10' in self.arch or 'gfx11' in self.arch else 64
+        warp_size = 32 if 'gfx10' in self.arch or 'gfx11' in self.arch or 'gfx12' in self.arch else 64
         object.__setattr__(self, 'warp_size', warp_size)
         libs = ["ocml", "ockl"]
         for lib in libs:
@@ -44,6 +104,9 @@ class HIPOptions:
         object.__setattr__(self, 'extern_libs', tuple(extern_libs.items()))
         assert self.num_warps > 0 and (self.num_warps & (self.num_warps - 1)) == 0, \
                "num_warps must be a power of 2"
+        assert self.kpack in (0, 1, 2), "kpack must be 0, 1 or 2"
+        assert self.instruction_sched_variant in ('none', 'iglp0', 'iglp1', 'interleave'), \
+               f"unknown instruction_sched_variant {self.instruction_sched_variant}"
 
     def hash(self):
         key = '_'.join([f'{name}-{val}' for name, val in self.__dict__.items()])
@@ -76,6 +139,7 @@ class HIPBackend(BaseBackend):
             metadata.cluster_dims[0],
             metadata.cluster_dims[1],
             metadata.cluster_dims[2],
+            metadata.global_scratch_size,
         )
 
     def get_codegen_implementation(self):
@@ -111,7 +175,13 @@ class HIPBackend(BaseBackend):
         pm.enable_debug()
         passes.common.add_inliner(pm)
         passes.ttir.add_rewrite_tensor_pointer(pm)
+        if options.rasterization:
+            passes.ttir.add_rasterize_program_ids(pm, options.rasterization, options.raster_group_size)
         passes.ttir.add_combine(pm)
+        passes.ttir.add_loop_unroll(pm)
+        passes.ttir.add_fold_masks(pm)
+        passes.ttir.add_narrow_pointer_offsets(pm)
+        passes.ttir.add_decompose_scaled_dot(pm)
         passes.common.add_canonicalizer(pm)
         passes.ttir.add_reorder_broadcast(pm)
         passes.common.add_cse(pm)
@@ -130,15 +200,22 @@ class HIPBackend(BaseBackend):
         pm = ir.pass_manager(mod.context)
         pm.enable_debug()
         passes.ttgpuir.add_coalesce(pm)
+        passes.ttgpuir.add_f32_dot_tc(pm)
         passes.ttgpuir.add_remove_layout_conversions(pm)
         passes.ttgpuir.add_optimize_thread_locality(pm)
         amd.passes.ttgpuir.add_accelerate_matmul(pm, options.arch, options.matrix_instr_nonkdim, options.kpack)
         passes.ttgpuir.add_remove_layout_conversions(pm)
         amd.passes.ttgpuir.add_optimize_epilogue(pm)
         passes.ttgpuir.add_optimize_dot_operands(pm, True)
-        if options.num_stages == 0 and amd.has_matrix_core_feature(options.arch):
-            amd.passes.ttgpuir.add_stream_pipeline(pm)
+        # num_stages == 0 prefetches a tile in registers, num_stages > 1 pipelines the loads through ring buffers in
+        # shared memory
+        if options.num_stages != 1 and amd.has_matrix_core_feature(options.arch):
+            amd.passes.ttgpuir.add_stream_pipeline(pm, options.num_stages, options.ping_pong)
             passes.common.add_canonicalizer(pm)
+            # Double-buffers the slices of the dot operands read from the ring buffers in registers. Ping-pong
+            # schedules the dots of the two halves of the waves, so they are not split.
+            if options.num_stages > 1 and not options.ping_pong:
+                passes.ttgpuir.add_prefetch(pm)
         passes.ttgpuir.add_optimize_dot_operands(pm, True)
         passes.ttgpuir.add_remove_layout_conversions(pm)
         passes.ttgpuir.add_reduce_data_duplication(pm)
@@ -147,6 +224,7 @@ class HIPBackend(BaseBackend):
         passes.common.add_cse(pm)
         passes.common.add_symbol_dce(pm)
         pm.run(mod)
+        metadata["estimated_registers"] = mod.estimate_registers()
         return mod
 
     @staticmethod
@@ -160,6 +238,7 @@ class HIPBackend(BaseBackend):
         passes.convert.add_index_to_llvmir(pm)
 
         passes.ttgpuir.add_allocate_shared_memory(pm)
+        passes.ttgpuir.add_allocate_global_scratch_memory(pm)
         ## __HIP_FTZ is used to control the denorm flushing behavior of exp2 op as follows:
         ## 1. If __HIP_FTZ = 1, exp2 flushes denorms in input and output regardless
         ##    of the value of kernel arg `allow_flush_denorm`.
@@ -168,7 +247,7 @@ class HIPBackend(BaseBackend):
         ## 3. __HIP_FTZ is default to 1 and not exposed as a kernel argument.
         ##    For now it is used as a controller for developers only.
         __HIP_FTZ = True
-        amd.passes.ttgpuir.add_to_llvmir(pm, options.arch, __HIP_FTZ)
+        amd.passes.ttgpuir.add_to_llvmir(pm, options.arch, __HIP_FTZ, options.fast_math, options.device_log)
         passes.common.add_canonicalizer(pm)
         passes.common.add_cse(pm)
 
@@ -185,6 +264,7 @@ class HIPBackend(BaseBackend):
         # involves using MUBUF instructions that have built-in out-of-bounds checks, which would eliminate the need
         # for conditional branching around memory accesses.
         amd.passes.ttgpuir.add_builtin_func_to_llvmir(pm)
+        amd.passes.ttgpuir.add_instruction_sched_hints(pm, options.instruction_sched_variant)
         pm.run(mod)
 
         # LLVM-IR (MLIR) -> LLVM-IR (LLVM)
@@ -214,10 +294,12 @@ class HIPBackend(BaseBackend):
             paths = [path for (name, path) in options.extern_libs if amd.need_extern_lib(llvm_mod, name)]
             llvm.link_extern_libs(llvm_mod, paths)
 
-        llvm.optimize_module(llvm_mod, llvm.OPTIMIZE_O3, amd.TARGET_TRIPLE)
+        llvm.optimize_module(llvm_mod, llvm.OPTIMIZE_O3, amd.TARGET_TRIPLE, options.llvm_pipeline)
 
         # Get some metadata
         metadata["shared"] = src.get_int_attr("triton_gpu.shared")
+        metadata["global_scratch_size"] = src.get_int_attr("triton_gpu.global_scratch_memory_size")
+        metadata["device_log_sites"] = src.get_str_array_attr("triton_gpu.device_log_sites") or []
 
         amd.cleanup_bitcode_metadata(llvm_mod)
         return str(llvm_mod)
@@ -232,6 +314,7 @@ class HIPBackend(BaseBackend):
         metadata["name"] = names[0]
         # llvm -> hsaco
         amdgcn = llvm.translate_to_asm(src, amd.TARGET_TRIPLE, options.arch, '', [], options.enable_fp_fusion, False)
+        metadata.update(get_resource_usage(amdgcn, options.arch, options.num_warps, metadata["shared"]))
         if os.environ.get("AMDGCN_ENABLE_DUMP", "0") == "1":
             print("// -----// AMDGCN Dump //----- //")
             print(amdgcn)
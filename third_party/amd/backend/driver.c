@@ -42,7 +42,21 @@ static const char *hipLibSearchPaths[] = {"/*py_libhip_search_path*/"};
   FOR_EACH_ERR_FN(hipModuleGetFunction, hipFunction_t *function,               \
                   hipModule_t module, const char *kname)                       \
   FOR_EACH_ERR_FN(hipFuncGetAttribute, int *, hipFunction_attribute attr,      \
-                  hipFunction_t function)
+                  hipFunction_t function)                                      \
+  FOR_EACH_ERR_FN(hipGraphCreate, hipGraph_t *pGraph, unsigned int flags)      \
+  FOR_EACH_ERR_FN(hipGraphInstantiate, hipGraphExec_t *pGraphExec,             \
+                  hipGraph_t graph, hipGraphNode_t *pErrorNode,                \
+                  char *pLogBuffer, size_t bufferSize)                         \
+  FOR_EACH_ERR_FN(hipGraphLaunch, hipGraphExec_t graphExec,                    \
+                  hipStream_t stream)                                          \
+  FOR_EACH_ERR_FN(hipGraphDestroy, hipGraph_t graph)                           \
+  FOR_EACH_ERR_FN(hipGraphExecDestroy, hipGraphExec_t graphExec)            \
+  FOR_EACH_ERR_FN(hipModuleGetGlobal, hipDeviceptr_t *dptr, size_t *bytes,     \
+                  hipModule_t hmod, const char *name)                          \
+  FOR_EACH_ERR_FN(hipMemcpyDtoH, void *dst, hipDeviceptr_t src,                \
+                  size_t sizeBytes)                                            \
+  FOR_EACH_ERR_FN(hipMemsetD8, hipDeviceptr_t dest, unsigned char value,       \
+                  size_t count)
 
 // The HIP symbol table for holding resolved dynamic library symbols.
 struct HIPSymbolTable {
@@ -140,16 +154,8 @@ static PyObject *getDeviceProperties(PyObject *self, PyObject *args) {
       props.warpSize);
 }
 
-static PyObject *loadBinary(PyObject *self, PyObject *args) {
-  const char *name;
-  const char *data;
-  Py_ssize_t data_size;
-  int shared;
-  int device;
-  if (!PyArg_ParseTuple(args, "ss#ii", &name, &data, &data_size, &shared,
-                        &device)) {
-    return NULL;
-  }
+static PyObject *loadBinaryData(const char *name, const char *data,
+                                int shared, int device) {
 
   // set HIP options
   hipJitOption opt[] = {hipJitOptionErrorLogBufferSizeBytes,
@@ -183,11 +189,116 @@ static PyObject *loadBinary(PyObject *self, PyObject *args) {
                        n_spills);
 }
 
+// The binary is any bytes-like object, e.g. a view of a mapped kernel archive.
+static PyObject *loadBinary(PyObject *self, PyObject *args) {
+  const char *name;
+  Py_buffer data;
+  int shared;
+  int device;
+  if (!PyArg_ParseTuple(args, "sy*ii", &name, &data, &shared, &device)) {
+    return NULL;
+  }
+  PyObject *result = loadBinaryData(name, (const char *)data.buf, shared,
+                                    device);
+  PyBuffer_Release(&data);
+  return result;
+}
+
+static PyObject *graphCreate(PyObject *self, PyObject *args) {
+  hipGraph_t graph;
+  HIP_CHECK(hipSymbolTable.hipGraphCreate(&graph, 0));
+  return PyLong_FromUnsignedLongLong((uint64_t)graph);
+}
+
+static PyObject *graphInstantiate(PyObject *self, PyObject *args) {
+  unsigned long long graph;
+  if (!PyArg_ParseTuple(args, "K", &graph))
+    return NULL;
+  hipGraphExec_t graphExec;
+  hipError_t err;
+  Py_BEGIN_ALLOW_THREADS;
+  err = hipSymbolTable.hipGraphInstantiate(&graphExec, (hipGraph_t)graph, NULL,
+                                           NULL, 0);
+  Py_END_ALLOW_THREADS;
+  HIP_CHECK(err);
+  return PyLong_FromUnsignedLongLong((uint64_t)graphExec);
+}
+
+static PyObject *graphLaunch(PyObject *self, PyObject *args) {
+  unsigned long long graphExec;
+  unsigned long long stream;
+  if (!PyArg_ParseTuple(args, "KK", &graphExec, &stream))
+    return NULL;
+  hipError_t err;
+  Py_BEGIN_ALLOW_THREADS;
+  err = hipSymbolTable.hipGraphLaunch((hipGraphExec_t)graphExec,
+                                      (hipStream_t)stream);
+  Py_END_ALLOW_THREADS;
+  HIP_CHECK(err);
+  Py_RETURN_NONE;
+}
+
+static PyObject *graphDestroy(PyObject *self, PyObject *args) {
+  unsigned long long graph;
+  if (!PyArg_ParseTuple(args, "K", &graph))
+    return NULL;
+  HIP_CHECK(hipSymbolTable.hipGraphDestroy((hipGraph_t)graph));
+  Py_RETURN_NONE;
+}
+
+static PyObject *graphExecDestroy(PyObject *self, PyObject *args) {
+  unsigned long long graphExec;
+  if (!PyArg_ParseTuple(args, "K", &graphExec))
+    return NULL;
+  HIP_CHECK(hipSymbolTable.hipGraphExecDestroy((hipGraphExec_t)graphExec));
+  Py_RETURN_NONE;
+}
+
+// Returns the contents of the global `name` of the module, e.g. the device log
+// of a kernel, and zeroes it if `clear`.
+static PyObject *readGlobal(PyObject *self, PyObject *args) {
+  unsigned long long module;
+  const char *name;
+  int clear;
+  if (!PyArg_ParseTuple(args, "Ksp", &module, &name, &clear))
+    return NULL;
+  hipDeviceptr_t ptr;
+  size_t size;
+  HIP_CHECK(hipSymbolTable.hipModuleGetGlobal(&ptr, &size, (hipModule_t)module,
+                                              name));
+  PyObject *data = PyBytes_FromStringAndSize(NULL, size);
+  if (!data)
+    return NULL;
+  char *buf = PyBytes_AS_STRING(data);
+  hipError_t err;
+  Py_BEGIN_ALLOW_THREADS;
+  err = hipSymbolTable.hipMemcpyDtoH(buf, ptr, size);
+  if (err == HIP_SUCCESS && clear)
+    err = hipSymbolTable.hipMemsetD8(ptr, 0, size);
+  Py_END_ALLOW_THREADS;
+  gpuAssert(err, __FILE__, __LINE__);
+  if (PyErr_Occurred()) {
+    Py_DECREF(data);
+    return NULL;
+  }
+  return data;
+}
+
 static PyMethodDef ModuleMethods[] = {
     {"load_binary", loadBinary, METH_VARARGS,
      "Load provided hsaco into HIP driver"},
     {"get_device_properties", getDeviceProperties, METH_VARARGS,
      "Get the properties for a given device"},
+    {"graph_create", graphCreate, METH_VARARGS, "Create an empty HIP graph"},
+    {"graph_instantiate", graphInstantiate, METH_VARARGS,
+     "Instantiate a HIP graph into an executable graph"},
+    {"graph_launch", graphLaunch, METH_VARARGS,
+     "Launch an executable HIP graph on a stream"},
+    {"graph_destroy", graphDestroy, METH_VARARGS, "Destroy a HIP graph"},
+    {"graph_exec_destroy", graphExecDestroy, METH_VARARGS,
+     "Destroy an executable HIP graph"},
+    {"read_global", readGlobal, METH_VARARGS,
+     "Read, and optionally zero, a global variable of a loaded module"},
     {NULL, NULL, 0, NULL} // sentinel
 };
 
@@ -101,6 +101,12 @@ class HIPUtils(object):
         mod = compile_module_from_src(src, "hip_utils")
         self.load_binary = mod.load_binary
         self.get_device_properties = mod.get_device_properties
+        self.graph_create = mod.graph_create
+        self.graph_instantiate = mod.graph_instantiate
+        self.graph_launch = mod.graph_launch
+        self.graph_destroy = mod.graph_destroy
+        self.graph_exec_destroy = mod.graph_exec_destroy
+        self.read_global = mod.read_global
 
 
 # -------------------- Launcher ----------------------------
@@ -127,55 +133,111 @@ def ty_to_cpp(ty):
 
 
 def make_launcher(constants, signature, ids, warp_size):
-    start_desc = len(signature)
-    #signature = generate_cu_signature(constants, signature, ids)
     arg_decls = ', '.join(f"{ty_to_cpp(ty)} arg{i}" for i, ty in signature.items())
 
     def _extracted_type(ty):
         if ty[0] == '*':
             return "PyObject*"
-        return {
-            'i1': 'int32_t',
-            'i8': 'int8_t',
-            'i16': 'int16_t',
-            'i32': 'int32_t',
-            'i64': 'int64_t',
-            'u1': 'uint32_t',
-            'u8': 'uint8_t',
-            'u16': 'uint16_t',
-            'u32': 'uint32_t',
-            'u64': 'uint64_t',
-            'fp16': 'float',
-            'bf16': 'float',
-            'fp32': 'float',
-            'f32': 'float',
-            'fp64': 'double',
-        }[ty]
+        return ty_to_cpp(ty)
 
-    def format_of(ty):
+    # Converts the Python object `obj` to the C type of argument `ty`.  This
+    # replaces PyArg_ParseTuple, whose format string is parsed on every launch.
+    def convert(ty, obj):
         return {
-            "PyObject*": "O",
-            "float": "f",
-            "double": "d",
-            "long": "l",
-            "int8_t": "b",
-            "int16_t": "h",
-            "int32_t": "i",
-            "int64_t": "l",
-            "uint8_t": "B",
-            "uint16_t": "H",
-            "uint32_t": "I",
-            "uint64_t": "K",
+            "PyObject*": f"{obj}",
+            "float": f"(float)PyFloat_AsDouble({obj})",
+            "double": f"PyFloat_AsDouble({obj})",
+            "int8_t": f"(int8_t)PyLong_AsLong({obj})",
+            "int16_t": f"(int16_t)PyLong_AsLong({obj})",
+            "int32_t": f"(int32_t)PyLong_AsLong({obj})",
+            "int64_t": f"(int64_t)PyLong_AsLongLong({obj})",
+            "uint8_t": f"(uint8_t)PyLong_AsUnsignedLong({obj})",
+            "uint16_t": f"(uint16_t)PyLong_AsUnsignedLong({obj})",
+            "uint32_t": f"(uint32_t)PyLong_AsUnsignedLong({obj})",
+            "uint64_t": f"(uint64_t)PyLong_AsUnsignedLongLong({obj})",
         }[ty]
 
-    args_format = ''.join([format_of(_extracted_type(ty)) for ty in signature.values()])
-    format = "iiiKKOOOO" + args_format
-    args_list = ', ' + ', '.join(f"&_arg{i}" for i, ty in signature.items()) if len(signature) > 0 else ''
+    params = [i for i in signature.keys() if i not in constants]
+
+    # Reads the kernel metadata tuple from args[first] and the kernel arguments
+    # that follow it, resolving pointer arguments to device pointers.
+    def parse_kernel_args(first):
+        conversions = ' '.join(f"{_extracted_type(ty)} _arg{i} = {convert(_extracted_type(ty), f'args[{first + 1 + j}]')};"
+                               for j, (i, ty) in enumerate(signature.items()))
+        pointers = ' '.join(
+            f"static DevicePtrCache ptr_cache{i}; DevicePtrInfo ptr_info{i} = getPointer(_arg{i}, {i}, &ptr_cache{i}); if (!ptr_info{i}.valid) return NULL;"
+            for i, ty in signature.items()
+            if ty[0] == "*")
+        return f"""
+  PyObject *kernel_metadata = args[{first}];
+  {conversions}
+  if (PyErr_Occurred()) {{
+    return NULL;
+  }}
+  if (!PyTuple_Check(kernel_metadata) || PyTuple_GET_SIZE(kernel_metadata) != 7) {{
+    PyErr_SetString(PyExc_TypeError, "kernel_metadata must be a tuple");
+    return NULL;
+  }}
+  int num_warps = getInt(kernel_metadata, 0);
+  int num_ctas = getInt(kernel_metadata, 1);
+  int shared_memory = getInt(kernel_metadata, 2);
+  int clusterDimX = getInt(kernel_metadata, 3);
+  int clusterDimY = getInt(kernel_metadata, 4);
+  int clusterDimZ = getInt(kernel_metadata, 5);
+  int global_scratch_size = getInt(kernel_metadata, 6);
+  if (PyErr_Occurred()) {{
+    return NULL;
+  }}
+  // raise exception asap
+  {pointers}
+"""
+
+    kernel_args = ', '.join(f"ptr_info{i}.dev_ptr" if ty[0] == "*" else f"_arg{i}" for i, ty in signature.items())
+    kernel_params = ', '.join(f"&ptr_info{i}.dev_ptr" if signature[i][0] == "*" else f"&_arg{i}" for i in params)
+
+    # Kernel node arguments: (graph or graph exec, dependency or node, gridX,
+    # gridY, gridZ, function, kernel_metadata, kernel args...).
+    num_node_args = 7
+    kernel_node_params = f"""
+  if (nargs != {num_node_args + len(signature)}) {{
+    PyErr_Format(PyExc_TypeError, "expected {num_node_args + len(signature)} arguments, got %zd", nargs);
+    return NULL;
+  }}
+  int gridX = (int)PyLong_AsLong(args[2]);
+  int gridY = (int)PyLong_AsLong(args[3]);
+  int gridZ = (int)PyLong_AsLong(args[4]);
+  uint64_t _function = PyLong_AsUnsignedLongLong(args[5]);
+  {parse_kernel_args(6)}
+  if (gridX * gridY * gridZ == 0) {{
+    PyErr_SetString(PyExc_ValueError, "Kernel graph nodes need a non-empty grid");
+    return NULL;
+  }}
+  if (global_scratch_size > 0) {{
+    PyErr_SetString(PyExc_NotImplementedError, "Kernel graph nodes don't support global scratch memory");
+    return NULL;
+  }}
+  // The runtime copies the parameter values when the node is created or
+  // updated.  It takes `func` as a hipFunction_t when it is not the address of
+  // a registered host stub, as for the kernels of code objects.
+  void *params[] = {{ {kernel_params} }};
+  hipKernelNodeParams node_params;
+  memset(&node_params, 0, sizeof(node_params));
+  node_params.func = (void *)_function;
+  node_params.gridDim.x = gridX;
+  node_params.gridDim.y = gridY;
+  node_params.gridDim.z = gridZ;
+  node_params.blockDim.x = {warp_size} * num_warps;
+  node_params.blockDim.y = 1;
+  node_params.blockDim.z = 1;
+  node_params.sharedMemBytes = shared_memory;
+  node_params.kernelParams = params;
+"""
+
+    num_launch_args = 9
 
     libhip_path = _get_path_to_hip_runtime_dylib()
 
     # generate glue code
-    params = [i for i in signature.keys() if i not in constants]
     src = f"""
 #define __HIP_PLATFORM_AMD__
 #include <hip/hip_runtime.h>
@@ -199,7 +261,23 @@ static const char *hipLibSearchPaths[] = {{"{libhip_path}"}};
                   unsigned int sharedMemBytes, hipStream_t stream,            \\
                   void **kernelParams, void **extra)                          \\
   FOR_EACH_ERR_FN(hipPointerGetAttribute, void *data,                         \\
-                  hipPointer_attribute attribute, hipDeviceptr_t ptr)
+                  hipPointer_attribute attribute, hipDeviceptr_t ptr)         \\
+  FOR_EACH_ERR_FN(hipGraphAddKernelNode, hipGraphNode_t *pGraphNode,          \\
+                  hipGraph_t graph, const hipGraphNode_t *pDependencies,      \\
+                  size_t numDependencies,                                     \\
+                  const hipKernelNodeParams *pNodeParams)                     \\
+  FOR_EACH_ERR_FN(hipGraphExecKernelNodeSetParams, hipGraphExec_t hGraphExec, \\
+                  hipGraphNode_t node, const hipKernelNodeParams *pNodeParams)\\
+  FOR_EACH_ERR_FN(hipGetDevice, int *deviceId)                                \\
+  FOR_EACH_ERR_FN(hipDeviceGetDefaultMemPool, hipMemPool_t *memPool,          \\
+                  int device)                                                 \\
+  FOR_EACH_ERR_FN(hipMemPoolSetAttribute, hipMemPool_t memPool,               \\
+                  hipMemPoolAttr attr, void *value)                           \\
+  FOR_EACH_ERR_FN(hipMallocAsync, void **devPtr, size_t size,                 \\
+                  hipStream_t stream)                                         \\
+  FOR_EACH_ERR_FN(hipMemsetD8Async, hipDeviceptr_t dest, unsigned char value, \\
+                  size_t count, hipStream_t stream)                           \\
+  FOR_EACH_ERR_FN(hipFreeAsync, void *devPtr, hipStream_t stream)
 
 // The HIP symbol table for holding resolved dynamic library symbols.
 struct HIPSymbolTable {{
@@ -269,11 +347,43 @@ static inline void gpuAssert(hipError_t code, const char *file, int line)
 
 #define HIP_CHECK(ans) {{ gpuAssert((ans), __FILE__, __LINE__); }}
 
-static void _launch(int gridX, int gridY, int gridZ, int num_warps, int num_ctas, int clusterDimX, int clusterDimY, int clusterDimZ, int shared_memory, hipStream_t stream, hipFunction_t function{', ' + arg_decls if len(arg_decls) > 0 else ''}) {{
+// Allocates the global scratch memory of a launch in stream order from the
+// default memory pool of the device, and zeroes it.  The release threshold of
+// the pool is raised so that it keeps the memory freed after the launches
+// instead of returning it to the system at each synchronization: the next
+// launches then allocate without calling into the OS.
+static bool allocGlobalScratch(hipDeviceptr_t *ptr, size_t size, hipStream_t stream) {{
+  static bool pool_configured[64];
+  int device;
+  hipError_t err = hipSymbolTable.hipGetDevice(&device);
+  if (err == hipSuccess && device < 64 && !pool_configured[device]) {{
+    hipMemPool_t pool;
+    uint64_t threshold = ~(uint64_t)0;
+    err = hipSymbolTable.hipDeviceGetDefaultMemPool(&pool, device);
+    if (err == hipSuccess)
+      err = hipSymbolTable.hipMemPoolSetAttribute(pool, hipMemPoolAttrReleaseThreshold, &threshold);
+    pool_configured[device] = err == hipSuccess;
+  }}
+  if (err == hipSuccess)
+    err = hipSymbolTable.hipMallocAsync((void **)ptr, size, stream);
+  if (err == hipSuccess)
+    err = hipSymbolTable.hipMemsetD8Async(*ptr, 0, size, stream);
+  HIP_CHECK(err);
+  return err == hipSuccess;
+}}
+
+static void _launch(int gridX, int gridY, int gridZ, int num_warps, int num_ctas, int clusterDimX, int clusterDimY, int clusterDimZ, int shared_memory, int global_scratch_size, hipStream_t stream, hipFunction_t function{', ' + arg_decls if len(arg_decls) > 0 else ''}) {{
   // printf("_launch hip kernel\\n");
-  void *params[] = {{ {', '.join(f"&arg{i}" for i in params)} }};
+  // The global scratch memory is the last parameter of the kernels that use it;
+  // the runtime ignores it for the others.
+  hipDeviceptr_t global_scratch = 0;
+  void *params[] = {{ {''.join(f"&arg{i}, " for i in params)}&global_scratch }};
   if (gridX*gridY*gridZ > 0) {{
+      if (global_scratch_size > 0 && !allocGlobalScratch(&global_scratch, global_scratch_size, stream))
+        return;
       HIP_CHECK(hipSymbolTable.hipModuleLaunchKernel(function, gridX, gridY, gridZ, {warp_size}*num_warps, 1, 1, shared_memory, stream, params, 0));
+      if (global_scratch)
+        HIP_CHECK(hipSymbolTable.hipFreeAsync(global_scratch, stream));
     }}
   }}
 
@@ -282,7 +392,17 @@ typedef struct _DevicePtrInfo {{
     bool valid;
 }} DevicePtrInfo;
 
-static inline DevicePtrInfo getPointer(PyObject *obj, int idx) {{
+// The pointer last passed for an argument and the device pointer it was
+// checked to map to.  Kernels are usually launched on the same buffers over and
+// over, so this saves the hipPointerGetAttribute query of most launches.
+typedef struct _DevicePtrCache {{
+    hipDeviceptr_t ptr;
+    hipDeviceptr_t dev_ptr;
+}} DevicePtrCache;
+
+static PyObject *data_ptr_str = NULL;
+
+static inline DevicePtrInfo getPointer(PyObject *obj, int idx, DevicePtrCache *cache) {{
   DevicePtrInfo ptr_info;
   ptr_info.dev_ptr = 0;
   ptr_info.valid = true;
@@ -294,58 +414,65 @@ static inline DevicePtrInfo getPointer(PyObject *obj, int idx) {{
     // valid nullptr
     return ptr_info;
   }}
-  PyObject *ptr = PyObject_GetAttrString(obj, "data_ptr");
-  if(ptr){{
-    PyObject *empty_tuple = PyTuple_New(0);
-    PyObject *ret = PyObject_Call(ptr, empty_tuple, NULL);
-    Py_DECREF(empty_tuple);
-    Py_DECREF(ptr);
-    if (!PyLong_Check(ret)) {{
-      PyErr_SetString(PyExc_TypeError, "data_ptr method of Pointer object must return 64-bit int");
-      ptr_info.valid = false;
-      return ptr_info;
-    }}
-    ptr_info.dev_ptr = (hipDeviceptr_t)PyLong_AsUnsignedLongLong(ret);
-    if(!ptr_info.dev_ptr)
-      return ptr_info;
-    uint64_t dev_ptr;
-    hipError_t status = hipSymbolTable.hipPointerGetAttribute(&dev_ptr, HIP_POINTER_ATTRIBUTE_DEVICE_POINTER, ptr_info.dev_ptr);
-    if (status == hipErrorInvalidValue) {{
-        PyErr_Format(PyExc_ValueError,
-                     "Pointer argument (at %d) cannot be accessed from Triton (cpu tensor?)", idx);
-        ptr_info.valid = false;
-    }}
-    ptr_info.dev_ptr = (hipDeviceptr_t)dev_ptr;
+  PyObject *ret = PyObject_CallMethodObjArgs(obj, data_ptr_str, NULL);
+  if (!ret) {{
+    PyErr_Clear();
+    PyErr_SetString(PyExc_TypeError, "Pointer argument must be either uint64 or have data_ptr method");
+    ptr_info.valid = false;
+    return ptr_info;
+  }}
+  if (!PyLong_Check(ret)) {{
     Py_DECREF(ret);
+    PyErr_SetString(PyExc_TypeError, "data_ptr method of Pointer object must return 64-bit int");
+    ptr_info.valid = false;
+    return ptr_info;
+  }}
+  ptr_info.dev_ptr = (hipDeviceptr_t)PyLong_AsUnsignedLongLong(ret);
+  Py_DECREF(ret);
+  if (!ptr_info.dev_ptr)
+    return ptr_info;
+  if (ptr_info.dev_ptr == cache->ptr) {{
+    ptr_info.dev_ptr = cache->dev_ptr;
     return ptr_info;
   }}
-  PyErr_SetString(PyExc_TypeError, "Pointer argument must be either uint64 or have data_ptr method");
+  uint64_t dev_ptr;
+  hipError_t status = hipSymbolTable.hipPointerGetAttribute(&dev_ptr, HIP_POINTER_ATTRIBUTE_DEVICE_POINTER, ptr_info.dev_ptr);
+  if (status == hipErrorInvalidValue) {{
+      PyErr_Format(PyExc_ValueError,
+                   "Pointer argument (at %d) cannot be accessed from Triton (cpu tensor?)", idx);
+      ptr_info.valid = false;
+      return ptr_info;
+  }}
+  cache->ptr = ptr_info.dev_ptr;
+  cache->dev_ptr = (hipDeviceptr_t)dev_ptr;
+  ptr_info.dev_ptr = (hipDeviceptr_t)dev_ptr;
   return ptr_info;
 }}
 
-static PyObject* launch(PyObject* self, PyObject* args) {{
-   // printf("launch\\n");
-  int gridX, gridY, gridZ;
-  uint64_t _stream;
-  uint64_t _function;
-  PyObject *launch_enter_hook = NULL;
-  PyObject *launch_exit_hook = NULL;
-  PyObject *kernel_metadata = NULL;
-  PyObject *launch_metadata = NULL;
-  {' '.join([f"{_extracted_type(ty)} _arg{i}; " for i, ty in signature.items()])}
-  if(!PyArg_ParseTuple(args, \"{format}\", &gridX, &gridY, &gridZ, &_stream, &_function,
-                                           &kernel_metadata, &launch_metadata,
-                                           &launch_enter_hook, &launch_exit_hook {args_list})) {{
-    return NULL;
-  }}
+static inline int getInt(PyObject *tuple, Py_ssize_t idx) {{
+  return (int)PyLong_AsLong(PyTuple_GET_ITEM(tuple, idx));
+}}
 
-  // extract kernel metadata
-  int num_warps, num_ctas, shared_memory, clusterDimX, clusterDimY, clusterDimZ;
-  if (!PyArg_ParseTuple(kernel_metadata, \"iiiiii\", &num_warps, &num_ctas, &shared_memory, &clusterDimX, &clusterDimY, &clusterDimZ)) {{
+static PyObject* launch(PyObject* self, PyObject* const* args, Py_ssize_t nargs) {{
+  if (nargs != {num_launch_args + len(signature)}) {{
+    PyErr_Format(PyExc_TypeError, "launch expected {num_launch_args + len(signature)} arguments, got %zd", nargs);
     return NULL;
   }}
+  int gridX = (int)PyLong_AsLong(args[0]);
+  int gridY = (int)PyLong_AsLong(args[1]);
+  int gridZ = (int)PyLong_AsLong(args[2]);
+  uint64_t _stream = PyLong_AsUnsignedLongLong(args[3]);
+  uint64_t _function = PyLong_AsUnsignedLongLong(args[4]);
+  PyObject *launch_metadata = args[6];
+  PyObject *launch_enter_hook = args[7];
+  PyObject *launch_exit_hook = args[8];
+  {parse_kernel_args(5)}
+
   // extract launch metadata
-  if (launch_enter_hook != Py_None){{
+  if (PyLong_Check(launch_enter_hook)) {{
+    // native hook, see `CompiledKernel.launch_enter_hook`
+    ((void (*)(uint64_t))PyLong_AsVoidPtr(launch_enter_hook))(_function);
+  }} else if (launch_enter_hook != Py_None){{
     PyObject* args = Py_BuildValue("(O)", launch_metadata);
     PyObject* ret = PyObject_CallObject(launch_enter_hook, args);
     Py_DECREF(args);
@@ -353,12 +480,11 @@ static PyObject* launch(PyObject* self, PyObject* args) {{
       return NULL;
   }}
 
+  _launch(gridX, gridY, gridZ, num_warps, num_ctas, clusterDimX, clusterDimY, clusterDimZ, shared_memory, global_scratch_size, (hipStream_t)_stream, (hipFunction_t)_function{', ' + kernel_args if len(signature) > 0 else ''});
 
-  // raise exception asap
-  {"; ".join([f"DevicePtrInfo ptr_info{i} = getPointer(_arg{i}, {i}); if (!ptr_info{i}.valid) return NULL;" if ty[0] == "*" else "" for i, ty in signature.items()])};
-  _launch(gridX, gridY, gridZ, num_warps, num_ctas, clusterDimX, clusterDimY, clusterDimZ, shared_memory, (hipStream_t)_stream, (hipFunction_t)_function{', ' + ', '.join(f"ptr_info{i}.dev_ptr" if ty[0]=="*" else f"_arg{i}"for i, ty in signature.items()) if len(signature) > 0 else ''});
-
-  if(launch_exit_hook != Py_None){{
+  if (PyLong_Check(launch_exit_hook)) {{
+    ((void (*)(uint64_t))PyLong_AsVoidPtr(launch_exit_hook))(_function);
+  }} else if(launch_exit_hook != Py_None){{
     PyObject* args = Py_BuildValue("(O)", launch_metadata);
     PyObject* ret = PyObject_CallObject(launch_exit_hook, args);
     Py_DECREF(args);
@@ -374,8 +500,43 @@ static PyObject* launch(PyObject* self, PyObject* args) {{
   return Py_None;
 }}
 
+// Adds a node launching the kernel to a graph, after `dependency` unless it is
+// 0, and returns the node.
+static PyObject* add_kernel_node(PyObject* self, PyObject* const* args, Py_ssize_t nargs) {{
+  {kernel_node_params}
+  hipGraph_t graph = (hipGraph_t)PyLong_AsUnsignedLongLong(args[0]);
+  hipGraphNode_t dependency = (hipGraphNode_t)PyLong_AsUnsignedLongLong(args[1]);
+  if (PyErr_Occurred()) {{
+    return NULL;
+  }}
+  hipGraphNode_t node;
+  HIP_CHECK(hipSymbolTable.hipGraphAddKernelNode(&node, graph, dependency ? &dependency : NULL, dependency ? 1 : 0, &node_params));
+  if (PyErr_Occurred()) {{
+    return NULL;
+  }}
+  return PyLong_FromUnsignedLongLong((uint64_t)node);
+}}
+
+// Sets the arguments and grid of a kernel node of an instantiated graph, for
+// its next launches.
+static PyObject* update_kernel_node(PyObject* self, PyObject* const* args, Py_ssize_t nargs) {{
+  {kernel_node_params}
+  hipGraphExec_t graph_exec = (hipGraphExec_t)PyLong_AsUnsignedLongLong(args[0]);
+  hipGraphNode_t node = (hipGraphNode_t)PyLong_AsUnsignedLongLong(args[1]);
+  if (PyErr_Occurred()) {{
+    return NULL;
+  }}
+  HIP_CHECK(hipSymbolTable.hipGraphExecKernelNodeSetParams(graph_exec, node, &node_params));
+  if (PyErr_Occurred()) {{
+    return NULL;
+  }}
+  Py_RETURN_NONE;
+}}
+
 static PyMethodDef ModuleMethods[] = {{
-  {{"launch", launch, METH_VARARGS, "Entry point for all kernels with this signature"}},
+  {{"launch", (PyCFunction)(void(*)(void))launch, METH_FASTCALL, "Entry point for all kernels with this signature"}},
+  {{"add_kernel_node", (PyCFunction)(void(*)(void))add_kernel_node, METH_FASTCALL, "Adds a kernel node to a HIP graph"}},
+  {{"update_kernel_node", (PyCFunction)(void(*)(void))update_kernel_node, METH_FASTCALL, "Updates a kernel node of an instantiated HIP graph"}},
   {{NULL, NULL, 0, NULL}} // sentinel
 }};
 
@@ -391,6 +552,10 @@ PyMODINIT_FUNC PyInit___triton_launcher(void) {{
   if (!initSymbolTable()) {{
     return NULL;
   }}
+  data_ptr_str = PyUnicode_InternFromString("data_ptr");
+  if (data_ptr_str == NULL) {{
+    return NULL;
+  }}
   PyObject *m = PyModule_Create(&ModuleDef);
   if(m == NULL) {{
     return NULL;
@@ -413,11 +578,71 @@ class HIPLauncher(object):
         src = make_launcher(constants, signature, ids, metadata.warp_size)
         mod = compile_module_from_src(src, "__triton_launcher")
         self.launch = mod.launch
+        self.add_kernel_node = mod.add_kernel_node
+        self.update_kernel_node = mod.update_kernel_node
 
     def __call__(self, *args, **kwargs):
         self.launch(*args, **kwargs)
 
 
+class HIPKernelGraph(object):
+    """
+    A HIP graph of kernel launches, whose arguments can be updated in place between replays:
+
+        graph = driver.active.create_kernel_graph()
+        node = graph.add(kernel, grid, *args)  # `kernel` is a `CompiledKernel`
+        graph.instantiate()
+        graph.launch()
+        graph.update(node, grid, *new_args)
+        graph.launch()
+
+    Kernels run in the order they are added.  The arguments must match the specialization `kernel` was compiled for,
+    as they are not checked again.  Launch hooks are not called for graph launches.
+    """
+
+    def __init__(self, driver):
+        self.driver = driver
+        self.utils = driver.utils
+        self.graph = self.utils.graph_create()
+        self.graph_exec = None
+        self.nodes = []
+
+    def _node_args(self, kernel, grid, args):
+        kernel._init_handles()
+        grid = tuple(grid) + (1, ) * (3 - len(grid))
+        return (grid[0], grid[1], grid[2], kernel.function, kernel.packed_metadata, *args)
+
+    def add(self, kernel, grid, *args):
+        """Adds a launch of `kernel` over `grid` to the graph and returns its index."""
+        assert self.graph_exec is None, "cannot add kernels to an instantiated graph"
+        dependency = self.nodes[-1][1] if self.nodes else 0
+        node = kernel.run.add_kernel_node(self.graph, dependency, *self._node_args(kernel, grid, args))
+        self.nodes.append((kernel, node))
+        return len(self.nodes) - 1
+
+    def instantiate(self):
+        self.graph_exec = self.utils.graph_instantiate(self.graph)
+
+    def update(self, index, grid, *args):
+        """Replaces the grid and arguments of the launch at `index` for the next replays."""
+        assert self.graph_exec is not None, "graph must be instantiated before updating it"
+        kernel, node = self.nodes[index]
+        kernel.run.update_kernel_node(self.graph_exec, node, *self._node_args(kernel, grid, args))
+
+    def launch(self, stream=None):
+        if self.graph_exec is None:
+            self.instantiate()
+        if stream is None:
+            stream = self.driver.get_current_stream(self.driver.get_current_device())
+        self.utils.graph_launch(self.graph_exec, stream)
+
+    def __del__(self):
+        if getattr(self, "graph_exec", None) is not None:
+            self.utils.graph_exec_destroy(self.graph_exec)
+        if getattr(self, "graph", None) is not None:
+            self.utils.graph_destroy(self.graph)
+
+
 class HIPDriver(GPUDriver):
 
     def __init__(self):
@@ -436,3 +661,6 @@ class HIPDriver(GPUDriver):
         arch = device_properties['arch']
         warp_size = device_properties['warpSize']
         return GPUTarget("hip", arch.split(':')[0], warp_size)
+
+    def create_kernel_graph(self):
+        return HIPKernelGraph(self)
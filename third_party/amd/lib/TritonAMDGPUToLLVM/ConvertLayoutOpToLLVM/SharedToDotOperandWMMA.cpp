@@ -106,6 +106,56 @@ llvm::SmallVector<llvm::SmallVector<Value>> computeTensorElemMappingInBlock(
   return mapping;
 }
 
+/**
+ * @brief Same as computeTensorElemMappingInBlock, for WMMA version 2, where
+ * the two halves of a wave hold different halves of the K elements of a tile
+ * instead of the same elements.
+ *
+ * @param laneId lane id in warp [0..31]; lanes l and l + 16 hold the same
+ * non-K index and consecutive groups of numOfElems K elements
+ */
+llvm::SmallVector<llvm::SmallVector<Value>> computeTensorElemMappingInBlockV2(
+    ConversionPatternRewriter &rewriter, Location loc,
+    const ArrayRef<int64_t> &elemsPerInstr, Value warpId, Value laneId,
+    int numOfElems, ArrayRef<int64_t> reps, ArrayRef<Value> smemOffsets,
+    int loadVecSize, unsigned iNonKDim, [[maybe_unused]] unsigned iKDim) {
+  assert(reps.size() == 3);
+  assert(elemsPerInstr.size() == 2);
+  auto numK = reps[2];
+  const int loadsPerThread = numOfElems / loadVecSize;
+  llvm::SmallVector<llvm::SmallVector<Value>> mapping(numK * loadsPerThread);
+
+  Value _0 = i32_val(0);
+  Value nonKDim = i32_val(iNonKDim);
+  Value warpVOffset = mul(warpId, i32_val(elemsPerInstr[0]));
+
+  auto rank = smemOffsets.size();
+
+  for (int tile = 0; tile < numK; ++tile) {
+    Value tileVOffset = _0;
+    Value tileHOffset = i32_val(tile * elemsPerInstr[1]);
+
+    Value laneVOffset = urem(laneId, nonKDim);
+    Value laneHOffset = mul(udiv(laneId, nonKDim), i32_val(numOfElems));
+
+    for (int loadId = 0; loadId < loadsPerThread; ++loadId) {
+      Value elemVOffset = _0;
+      Value elemHOffset = i32_val(loadId * loadVecSize);
+
+      Value sliceVOffset =
+          add(add(add(tileVOffset, laneVOffset), elemVOffset), warpVOffset);
+      Value sliceHOffset = add(add(tileHOffset, laneHOffset), elemHOffset);
+
+      Value row = add(sliceVOffset, smemOffsets[rank - 2]);
+      Value col = add(sliceHOffset, smemOffsets[rank - 1]);
+
+      mapping[loadsPerThread * tile + loadId] = {row, col};
+    }
+  }
+
+  return mapping;
+}
+
 Value convertLayout(int opIdx, ConversionPatternRewriter &rewriter,
                     Location loc, Value tensor, DotOperandEncodingAttr encoding,
                     const SharedMemoryObject &smemObj,
@@ -139,14 +189,19 @@ Value convertLayout(int opIdx, ConversionPatternRewriter &rewriter,
   auto repB = numReps[0];
 
   unsigned iWaveSize = triton::gpu::getWarpSize(wmmaLayout);
-  unsigned iNumLanes = iWaveSize / 2;
   assert(iWaveSize == 32);
   Value waveSize = i32_val(iWaveSize);
-  Value numLanes = i32_val(iNumLanes);
   Value linearWaveId = udiv(thread, waveSize);
-  Value lane = urem(thread, numLanes); // share elem between two threads
 
-  unsigned numElemsPerThreadPerRep = wmmaInstrK;
+  // Version 1 duplicates the elements of a lane in the other half of the wave,
+  // version 2 splits K between the two halves.
+  bool isVersion1 = wmmaLayout.getVersion() == 1;
+  unsigned iNumLanes = isVersion1 ? iWaveSize / 2 : iWaveSize;
+  Value lane = urem(thread, i32_val(iNumLanes));
+  auto mappingFn = isVersion1 ? computeTensorElemMappingInBlock
+                              : computeTensorElemMappingInBlockV2;
+
+  unsigned numElemsPerThreadPerRep = isVersion1 ? wmmaInstrK : kWidth;
 
   Value warp = udiv(thread, waveSize);
   unsigned int maxNumWarps = shape[nonKDimIdx] / wmmaInstrNonK;
@@ -164,13 +219,13 @@ Value convertLayout(int opIdx, ConversionPatternRewriter &rewriter,
       shape[nonKDimIdx], nonKDimIdx, triton::gpu::getOrder(wmmaLayout));
   if (opIdx == 0) {
     offsets = AMD::computeOffsetsAType(
-        rewriter, loc, computeTensorElemMappingInBlock, elemsPerInstr,
+        rewriter, loc, mappingFn, elemsPerInstr,
         spatialWarpId, lane, warpsPerBlockNonK, numElemsPerThreadPerRep,
         numReps, smemObj, sharedLayout, wmmaInstrNonK, wmmaInstrK);
   } else {
     assert(opIdx == 1);
     offsets = AMD::computeOffsetsBType(
-        rewriter, loc, computeTensorElemMappingInBlock, elemsPerInstr,
+        rewriter, loc, mappingFn, elemsPerInstr,
         spatialWarpId, lane, warpsPerBlockNonK, numElemsPerThreadPerRep,
         numReps, smemObj, sharedLayout, wmmaInstrNonK, wmmaInstrK);
   }
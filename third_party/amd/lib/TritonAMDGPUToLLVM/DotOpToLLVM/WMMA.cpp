@@ -201,8 +201,12 @@ LogicalResult convertDot(DotOp op, DotOpAdaptor adaptor,
 
   unsigned warpSize = triton::gpu::getWarpSize(wmmaLayout);
   constexpr unsigned vgprElemBitWidth = 32;
+  // WMMA v1 stores 16-bit results in one half of each 32-bit VGPR, while v2
+  // packs them.
   unsigned paddedOutputElemSize =
-      vgprElemBitWidth / dstElemTy.getIntOrFloatBitWidth();
+      wmmaLayout.getVersion() == 1
+          ? vgprElemBitWidth / dstElemTy.getIntOrFloatBitWidth()
+          : 1;
   // compute number of output elements that each thread holds for one WMMA
   // instruction.
   auto elemsPerVec = mnkDim[0] * mnkDim[1] * paddedOutputElemSize / warpSize;
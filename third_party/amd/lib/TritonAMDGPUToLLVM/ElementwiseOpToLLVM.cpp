@@ -85,40 +85,37 @@ Fp16_to_Fp8E5M2_RTZ(Location loc, ConversionPatternRewriter &rewriter,
 
 static Value cvtFp16ToFp32(Location loc, ConversionPatternRewriter &rewriter,
                            const Value &v) {
-  GCNBuilder builder;
-  auto &cvt = *builder.create("v_cvt_f32_f16");
-  auto res = builder.newOperand("=v");
-  auto operand = builder.newOperand(v, "v");
-  cvt(res, operand);
-  return builder.launch(rewriter, loc, f32_ty, false);
+  return fpext(f32_ty, v);
 }
 
 static Value cvtFp32ToFp16(Location loc, ConversionPatternRewriter &rewriter,
                            const Value &v, const RoundingMode rounding) {
+  if (rounding == RoundingMode::RTNE)
+    return rewriter.create<LLVM::FPTruncOp>(loc, f16_ty, v);
+
   GCNBuilder builder;
 
   auto &cvt = *builder.create("v_cvt_f16_f32");
   auto res = builder.newOperand("=v");
   auto operand = builder.newOperand(v, "v");
-  if (rounding == RoundingMode::RTZ) {
-    auto &setRTZ = *builder.create("s_setreg_imm32_b32 0x1801, 0xc");
-    setRTZ();
-  }
+  auto &setRTZ = *builder.create("s_setreg_imm32_b32 0x1801, 0xc");
+  setRTZ();
   cvt(res, operand);
-  if (rounding == RoundingMode::RTZ) {
-    auto &resetRTZ = *builder.create("s_setreg_imm32_b32 0x1801, 0x0");
-    resetRTZ();
-  }
+  auto &resetRTZ = *builder.create("s_setreg_imm32_b32 0x1801, 0x0");
+  resetRTZ();
   return builder.launch(rewriter, loc, f16_ty, false);
 }
 
 // convert fp8 to fp32
+// The conversions call the intrinsics of the packed v_cvt_pk_* instructions
+// rather than inline assembly, so that LLVM schedules them and folds the
+// packing of their operands.
 static SmallVector<Value> cvtFp8ToFp32(Location loc,
                                        ConversionPatternRewriter &rewriter,
                                        Value v0, Value v1,
                                        const std::string &fp8_format) {
   assert(fp8_format == "fp8" || fp8_format == "bf8");
-  std::string ins_str = "v_cvt_pk_f32_" + fp8_format;
+  std::string intrinsic = "llvm.amdgcn.cvt.pk.f32." + fp8_format;
 
   auto fp8x4VecTy = vec_ty(i8_ty, 4);
   Value fp8x4Vec = undef(fp8x4VecTy);
@@ -126,14 +123,14 @@ static SmallVector<Value> cvtFp8ToFp32(Location loc,
   fp8x4Vec = insert_element(fp8x4VecTy, fp8x4Vec, v1, i32_val(1));
   auto i32v = bitcast(fp8x4Vec, i32_ty);
 
-  GCNBuilder builder1;
-  auto &cvt = *builder1.create(ins_str);
-  auto res = builder1.newOperand("=v");
-  auto operand = builder1.newOperand(i32v, "v");
-  cvt(res, operand);
-  auto i64v = builder1.launch(rewriter, loc, i64_ty, false);
   auto fp32x2VecTy = vec_ty(f32_ty, 2);
-  auto fp32x2Vec = bitcast(i64v, fp32x2VecTy);
+  // The last operand selects the low word of the source
+  auto fp32x2Vec =
+      rewriter
+          .create<LLVM::CallIntrinsicOp>(loc, fp32x2VecTy,
+                                         rewriter.getStringAttr(intrinsic),
+                                         ValueRange{i32v, false_val()})
+          ->getResult(0);
 
   SmallVector<Value> ret(2);
   ret[0] = extract_element(f32_ty, fp32x2Vec, i32_val(0));
@@ -148,15 +145,16 @@ static SmallVector<Value> cvtFp32ToFp8(Location loc,
                                        Value v0, Value v1,
                                        const std::string &fp8_format) {
   assert(fp8_format == "fp8" || fp8_format == "bf8");
-  std::string ins_str = "v_cvt_pk_" + fp8_format + "_f32";
+  std::string intrinsic = "llvm.amdgcn.cvt.pk." + fp8_format + ".f32";
 
-  GCNBuilder builder;
-  auto &cvt = *builder.create(ins_str);
-  auto res = builder.newOperand("=v");
-  auto operand0 = builder.newOperand(v0, "v");
-  auto operand1 = builder.newOperand(v1, "v");
-  cvt(res, operand0, operand1);
-  auto fp8x4Vec = builder.launch(rewriter, loc, i32_ty, false);
+  // The last two operands are the word the result is merged into and whether
+  // it is written to its high word
+  auto fp8x4Vec =
+      rewriter
+          .create<LLVM::CallIntrinsicOp>(
+              loc, i32_ty, rewriter.getStringAttr(intrinsic),
+              ValueRange{v0, v1, undef(i32_ty), false_val()})
+          ->getResult(0);
 
   auto fp8x4VecTy = vec_ty(i8_ty, 4);
   auto a1 = bitcast(fp8x4Vec, fp8x4VecTy);
@@ -171,7 +169,6 @@ static SmallVector<Value>
 convert_val_Fp16_to_Fp8(Location loc, ConversionPatternRewriter &rewriter,
                         Value v0, Value v1, const std::string &fp8_format) {
   assert(fp8_format == "fp8" || fp8_format == "bf8");
-  std::string ins_str = "v_cvt_pk_" + fp8_format + "_f32";
 
   auto f32_0 = cvtFp16ToFp32(loc, rewriter, v0);
   auto f32_1 = cvtFp16ToFp32(loc, rewriter, v1);
@@ -298,6 +295,38 @@ static SmallVector<Value> Fp8E5M2_to_Fp16(Location loc,
           extract_element(f16_ty, fp16x2Vec1, i32_val(1))};
 }
 
+// Fp8E4M3FN -> Fp16
+// The exponent and mantissa of an fp8e4m3fn shifted into an fp16 read as the
+// fp8 value divided by 2^8, subnormals included, so that a multiplication
+// converts them exactly. The only NaN of fp8e4m3fn, s.1111.111, would read as
+// a finite value and is selected apart.
+static Value Fp8E4M3FN_to_Fp16_oneValue(Location loc,
+                                        ConversionPatternRewriter &rewriter,
+                                        Value v) {
+  auto fp8x2VecTy = vec_ty(i8_ty, 2);
+  Value a = undef(fp8x2VecTy);
+  a = insert_element(fp8x2VecTy, a, int_val(8, 0), i32_val(0));
+  a = insert_element(fp8x2VecTy, a, v, i32_val(1));
+  a = bitcast(a, i16_ty);
+
+  auto nosign = and_(i16_ty, a, int_val(16, 0x7F00));
+  auto sign = and_(i16_ty, a, int_val(16, 0x8000));
+  auto shifted = bitcast(lshr(i16_ty, nosign, int_val(16, 1)), f16_ty);
+  auto scaled = bitcast(fmul(f16_ty, shifted, f16_val(0x1p+8)), i16_ty);
+  auto isNan = icmp_eq(nosign, int_val(16, 0x7F00));
+  auto o = select(isNan, int_val(16, 0x7E00), scaled);
+  return bitcast(or_(i16_ty, o, sign), f16_ty);
+}
+
+static SmallVector<Value>
+Fp8E4M3FN_to_Fp16(Location loc, ConversionPatternRewriter &rewriter,
+                  const SmallVector<Value> &v) {
+  SmallVector<Value> result(v.size());
+  for (size_t i = 0; i < v.size(); ++i)
+    result[i] = Fp8E4M3FN_to_Fp16_oneValue(loc, rewriter, v[i]);
+  return result;
+}
+
 static Value convertBf16ToFp32(Location loc,
                                ConversionPatternRewriter &rewriter,
                                const Value &v) {
@@ -870,6 +899,7 @@ struct FpToFpOpConversion
             {{F8E5M2FNUZTyID, F16TyID, undefRounding},
              Fp8E5M2FNUZ_to_Fp16(isaFamily)},
             {{F8E5M2TyID, F16TyID, undefRounding}, Fp8E5M2_to_Fp16},
+            {{F8E4M3FNTyID, F16TyID, undefRounding}, Fp8E4M3FN_to_Fp16},
             // F16 -> F8
             {{F16TyID, F8E5M2FNUZTyID, RoundingMode::RTNE},
              Fp16_to_Fp8E5M2FNUZ(isaFamily)},
@@ -948,7 +978,11 @@ struct FpToFpOpConversion
         srcElementType.isF32() && !(isaFamily == AMD::ISAFamily::CDNA3 &&
                                     (dstElementType.isFloat8E4M3FNUZ() ||
                                      dstElementType.isFloat8E5M2FNUZ()));
-    bool isDstFP32 = dstElementType.isF32();
+    // CDNA3 converts fp8 to fp32 directly, without rounding through fp16
+    bool isDstFP32 = dstElementType.isF32() &&
+                     !(isaFamily == AMD::ISAFamily::CDNA3 &&
+                       (srcElementType.isFloat8E4M3FNUZ() ||
+                        srcElementType.isFloat8E5M2FNUZ()));
     Type srcType = useFP16IntermediateSrc ? f16_ty : srcElementType;
     Type dstType = isDstFP32 ? f16_ty : dstElementType;
     SmallVector<Value> inVals;
@@ -1033,6 +1067,13 @@ struct FMulOpConversion
                                    Location loc) const {
     auto lhsElemTy = getElementType(op.getLhs());
     auto rhsElemTy = getElementType(op.getRhs());
+    // Lowered to v_pk_mul_f16.
+    if (elemTy.isF16() && operands.size() >= 2 && canPackElementPairs(op))
+      return createPackedDestOps(
+          rewriter, loc, elemTy, operands, [&](Type vecTy, ValueRange args) {
+            return rewriter.create<LLVM::FMulOp>(loc, vecTy, args[0], args[1])
+                .getResult();
+          });
     if (lhsElemTy.isBF16() && rhsElemTy.isBF16()) {
       return {EmitDualBF16ElementwiseOp<LLVM::FMulOp>(loc, rewriter, operands)};
     } else {
@@ -1055,6 +1096,13 @@ struct FAddOpConversion
                                    Location loc) const {
     auto lhsElemTy = getElementType(op.getLhs());
     auto rhsElemTy = getElementType(op.getRhs());
+    // Lowered to v_pk_add_f16.
+    if (elemTy.isF16() && operands.size() >= 2 && canPackElementPairs(op))
+      return createPackedDestOps(
+          rewriter, loc, elemTy, operands, [&](Type vecTy, ValueRange args) {
+            return rewriter.create<LLVM::FAddOp>(loc, vecTy, args[0], args[1])
+                .getResult();
+          });
     if (lhsElemTy.isBF16() && rhsElemTy.isBF16()) {
       return {EmitDualBF16ElementwiseOp<LLVM::FAddOp>(loc, rewriter, operands)};
     } else {
@@ -1077,6 +1125,13 @@ struct FSubOpConversion
                                    Location loc) const {
     auto lhsElemTy = getElementType(op.getLhs());
     auto rhsElemTy = getElementType(op.getRhs());
+    // Lowered to v_pk_add_f16 with a negated operand.
+    if (elemTy.isF16() && operands.size() >= 2 && canPackElementPairs(op))
+      return createPackedDestOps(
+          rewriter, loc, elemTy, operands, [&](Type vecTy, ValueRange args) {
+            return rewriter.create<LLVM::FSubOp>(loc, vecTy, args[0], args[1])
+                .getResult();
+          });
     if (lhsElemTy.isBF16() && rhsElemTy.isBF16()) {
       return {EmitDualBF16ElementwiseOp<LLVM::FSubOp>(loc, rewriter, operands)};
     } else {
@@ -1270,9 +1325,92 @@ private:
   bool ftz;
 };
 
+// Lowers f32 `SourceOp` to the AMDGPU intrinsic `intrinsic` of the approximate
+// hardware instruction, e.g. `llvm.amdgcn.log.f32` for v_log_f32, whose
+// operand is that of `SourceOp` multiplied by `inScale` and whose result is
+// multiplied by `outScale`. Divisions multiply their numerator by the
+// approximate reciprocal of their denominator.
+template <typename SourceOp>
+struct FastMathOpConversion
+    : ElementwiseOpConversionBase<SourceOp, FastMathOpConversion<SourceOp>> {
+  using Base =
+      ElementwiseOpConversionBase<SourceOp, FastMathOpConversion<SourceOp>>;
+  using Adaptor = typename Base::OpAdaptor;
+
+  FastMathOpConversion(LLVMTypeConverter &typeConverter,
+                       ModuleAxisInfoAnalysis &axisAnalysisPass,
+                       StringRef intrinsic, double inScale, double outScale,
+                       PatternBenefit benefit)
+      : Base(typeConverter, axisAnalysisPass, benefit), intrinsic(intrinsic),
+        inScale(inScale), outScale(outScale) {}
+
+  SmallVector<Value> createDestOps(SourceOp op, Adaptor adaptor,
+                                   ConversionPatternRewriter &rewriter,
+                                   Type elemTy, MultipleOperandsRange operands,
+                                   Location loc) const {
+    // Other types keep their precise lowering.
+    if (!elemTy.isF32())
+      return {};
+    Value operand = operands[0].back();
+    if (inScale != 1.0)
+      operand = fmul(f32_ty, operand, f32_val(inScale));
+    Type funcType = getFunctionType(elemTy, operand);
+    LLVM::LLVMFuncOp funcOp =
+        appendOrGetExternFuncOp(rewriter, op, intrinsic, funcType);
+    Value ret = rewriter.create<LLVM::CallOp>(loc, funcOp, operand).getResult();
+    if (outScale != 1.0)
+      ret = fmul(f32_ty, ret, f32_val(outScale));
+    if constexpr (std::is_same_v<SourceOp, arith::DivFOp>)
+      ret = fmul(f32_ty, operands[0][0], ret);
+    return {ret};
+  }
+
+private:
+  StringRef intrinsic;
+  double inScale;
+  double outScale;
+};
+
 } // namespace
 
 namespace mlir::triton::AMD {
+void populateFastMathOpToLLVMPatterns(LLVMTypeConverter &typeConverter,
+                                      RewritePatternSet &patterns,
+                                      ModuleAxisInfoAnalysis &axisInfoAnalysis,
+                                      PatternBenefit benefit) {
+  const double log2e = 1.4426950408889634;
+  const double ln2 = 0.6931471805599453;
+  // v_sin_f32 and v_cos_f32 take their operand in revolutions.
+  const double invTwoPi = 0.15915494309189535;
+  patterns.add<FastMathOpConversion<math::ExpOp>>(
+      typeConverter, axisInfoAnalysis, "llvm.amdgcn.exp2.f32", log2e, 1.0,
+      benefit);
+  patterns.add<FastMathOpConversion<math::Exp2Op>>(
+      typeConverter, axisInfoAnalysis, "llvm.amdgcn.exp2.f32", 1.0, 1.0,
+      benefit);
+  patterns.add<FastMathOpConversion<math::LogOp>>(
+      typeConverter, axisInfoAnalysis, "llvm.amdgcn.log.f32", 1.0, ln2,
+      benefit);
+  patterns.add<FastMathOpConversion<math::Log2Op>>(
+      typeConverter, axisInfoAnalysis, "llvm.amdgcn.log.f32", 1.0, 1.0,
+      benefit);
+  patterns.add<FastMathOpConversion<math::SinOp>>(
+      typeConverter, axisInfoAnalysis, "llvm.amdgcn.sin.f32", invTwoPi, 1.0,
+      benefit);
+  patterns.add<FastMathOpConversion<math::CosOp>>(
+      typeConverter, axisInfoAnalysis, "llvm.amdgcn.cos.f32", invTwoPi, 1.0,
+      benefit);
+  patterns.add<FastMathOpConversion<math::SqrtOp>>(
+      typeConverter, axisInfoAnalysis, "llvm.amdgcn.sqrt.f32", 1.0, 1.0,
+      benefit);
+  patterns.add<FastMathOpConversion<math::RsqrtOp>>(
+      typeConverter, axisInfoAnalysis, "llvm.amdgcn.rsq.f32", 1.0, 1.0,
+      benefit);
+  patterns.add<FastMathOpConversion<arith::DivFOp>>(
+      typeConverter, axisInfoAnalysis, "llvm.amdgcn.rcp.f32", 1.0, 1.0,
+      benefit);
+}
+
 void populateElementwiseOpToLLVMPatterns(
     LLVMTypeConverter &typeConverter, RewritePatternSet &patterns, bool ftz,
     ModuleAxisInfoAnalysis &axisInfoAnalysis, ModuleAllocation &allocation,
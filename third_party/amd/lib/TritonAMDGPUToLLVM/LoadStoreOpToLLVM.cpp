@@ -1,15 +1,21 @@
 #include "PatternTritonGPUOpToLLVM.h"
 #include "TargetInfo.h"
 #include "Utility.h"
+#include "triton/Analysis/Utility.h"
 #include "triton/Dialect/TritonGPU/Transforms/Utility.h"
+#include "triton/Tools/Sys/GetEnv.hpp"
 
 using namespace mlir;
 using namespace mlir::triton::gpu;
 
 using ::mlir::LLVM::delinearize;
 using ::mlir::LLVM::getSharedMemoryBase;
+using ::mlir::LLVM::AMD::createBufferResource;
+using ::mlir::LLVM::AMD::llBufferLoad;
+using ::mlir::LLVM::AMD::llBufferStore;
 using ::mlir::LLVM::AMD::llLoad;
 using ::mlir::LLVM::AMD::llStore;
+using ::mlir::LLVM::AMD::supportsBufferOps;
 using ::mlir::triton::gpu::getTotalElemsPerThread;
 
 namespace {
@@ -113,6 +119,45 @@ struct LoadStoreConversionBase {
     return axisAnalysisPass.getMaskAlignment(mask);
   }
 
+  // Returns the buffer resource descriptor of the base pointer of `ptr` and
+  // the byte offsets of its elements from it, when `ptr` is a uniform global
+  // pointer plus 32-bit offsets, so that its elements can be accessed with
+  // buffer instructions; returns a null descriptor otherwise.
+  // Buffer instructions take 32-bit offsets instead of 64-bit addresses, and
+  // replace the masks by the range check of the hardware.  Offsets are
+  // unsigned though, so they are only used with AMDGCN_USE_BUFFER_OPS=1,
+  // which asserts that the offsets are non-negative and fit in 2 GiB.
+  std::pair<Value, SmallVector<Value>>
+  getBufferResourceAndOffsets(Location loc, Value ptr,
+                              ConversionPatternRewriter &rewriter) const {
+    if (!triton::tools::getBoolEnv("AMDGCN_USE_BUFFER_OPS") ||
+        !supportsBufferOps(targetInfo.getISAFamily()))
+      return {};
+    auto tensorTy = dyn_cast<RankedTensorType>(ptr.getType());
+    if (!tensorTy || triton::getPointeeBitWidth(tensorTy) < 8)
+      return {};
+    auto ptrTy = cast<triton::PointerType>(tensorTy.getElementType());
+    if (ptrTy.getAddressSpace() != 1)
+      return {};
+    auto addPtrOp = ptr.getDefiningOp<triton::AddPtrOp>();
+    if (!addPtrOp)
+      return {};
+    auto splatOp = addPtrOp.getPtr().getDefiningOp<triton::SplatOp>();
+    if (!splatOp || !getElementTypeOrSelf(addPtrOp.getOffset()).isInteger(32))
+      return {};
+    Value basePtr = rewriter.getRemappedValue(splatOp.getSrc());
+    Value llOffset = rewriter.getRemappedValue(addPtrOp.getOffset());
+    if (!basePtr || !llOffset || !isa<LLVM::LLVMStructType>(llOffset.getType()))
+      return {};
+    Value rsrc = createBufferResource(rewriter, loc, basePtr,
+                                      targetInfo.getISAFamily());
+    Value elemBytes = i32_val(triton::getPointeeBitWidth(tensorTy) / 8);
+    SmallVector<Value> offsets;
+    for (Value offset : unpackLLElements(loc, llOffset, rewriter))
+      offsets.push_back(mul(offset, elemBytes));
+    return {rsrc, offsets};
+  }
+
 protected:
   const AMD::TargetInfo &targetInfo;
   ModuleAxisInfoAnalysis &axisAnalysisPass;
@@ -159,6 +204,7 @@ struct LoadOpConversion : public ConvertOpToLLVMPattern<triton::LoadOp>,
     // Get the LLVM values for pointers
     auto ptrElems = unpackLLElements(loc, llPtr, rewriter);
     assert(ptrElems.size() == numElems);
+    auto [rsrc, offsetElems] = getBufferResourceAndOffsets(loc, ptr, rewriter);
 
     // Get the LLVM values for mask
     SmallVector<Value> maskElems;
@@ -188,6 +234,11 @@ struct LoadOpConversion : public ConvertOpToLLVMPattern<triton::LoadOp>,
     const int valueElemNBits =
         std::max(8u, valueElemTy.getIntOrFloatBitWidth());
     const int numVecs = numElems / vec;
+    // The loaded values that are the same in all the lanes, e.g. the offsets
+    // and indices of jagged and block-sparse kernels, are read from the first
+    // lane, so that they and the addresses computed from them live in SGPRs.
+    const bool isUniform = numElems * valueElemNBits <= 128 &&
+                           isWarpUniform(op.getResult());
 
     SmallVector<Value> loadedVals;
     for (size_t vecStart = 0; vecStart < numElems; vecStart += vec) {
@@ -224,11 +275,18 @@ struct LoadOpConversion : public ConvertOpToLLVMPattern<triton::LoadOp>,
         falseVal = v;
       }
 
-      auto loadVal = llLoad(rewriter, loc, ptr, vecTy, pred, falseVal);
+      Value loadVal;
+      if (rsrc)
+        loadVal = llBufferLoad(rewriter, loc, rsrc, offsetElems[vecStart],
+                               vecTy, pred, other ? falseVal : Value());
+      else
+        loadVal = llLoad(rewriter, loc, ptr, vecTy, pred, falseVal);
       for (size_t ii = 0; ii < vec; ++ii) {
         Value vecIdx = createIndexAttrConstant(
             rewriter, loc, this->getTypeConverter()->getIndexType(), ii % vec);
         Value loaded = extract_element(valueElemTy, loadVal, vecIdx);
+        if (isUniform)
+          loaded = targetInfo.makeWarpUniform(rewriter, loc, loaded);
         loadedVals.push_back(loaded);
       }
     } // end vec
@@ -275,6 +333,7 @@ struct StoreOpConversion : public ConvertOpToLLVMPattern<triton::StoreOp>,
     auto ptrElems = unpackLLElements(loc, llPtr, rewriter);
     auto valueElems = unpackLLElements(loc, llValue, rewriter);
     assert(ptrElems.size() == valueElems.size());
+    auto [rsrc, offsetElems] = getBufferResourceAndOffsets(loc, ptr, rewriter);
 
     // Determine the vectorization size
     SmallVector<Value> maskElems;
@@ -327,8 +386,12 @@ struct StoreOpConversion : public ConvertOpToLLVMPattern<triton::StoreOp>,
         }
         llWord = bitcast(llWord, valArgTy);
         Value maskVal = llMask ? and_(mask, maskElems[vecStart]) : mask;
-        auto address = ptrElems[vecStart + wordIdx * wordNElems];
-        llStore(rewriter, loc, address, llWord, maskVal);
+        const size_t wordStart = vecStart + wordIdx * wordNElems;
+        if (rsrc)
+          llBufferStore(rewriter, loc, rsrc, offsetElems[wordStart], llWord,
+                        maskVal);
+        else
+          llStore(rewriter, loc, ptrElems[wordStart], llWord, maskVal);
       }
     }
     rewriter.eraseOp(op);
@@ -336,6 +399,36 @@ struct StoreOpConversion : public ConvertOpToLLVMPattern<triton::StoreOp>,
   }
 };
 
+struct PrefetchOpConversion : public ConvertOpToLLVMPattern<triton::PrefetchOp>,
+                              public LoadStoreConversionBase {
+  PrefetchOpConversion(LLVMTypeConverter &converter,
+                       const AMD::TargetInfo &targetInfo,
+                       ModuleAxisInfoAnalysis &axisAnalysisPass,
+                       PatternBenefit benefit)
+      : ConvertOpToLLVMPattern<triton::PrefetchOp>(converter, benefit),
+        LoadStoreConversionBase(targetInfo, axisAnalysisPass) {}
+
+  LogicalResult
+  matchAndRewrite(triton::PrefetchOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op->getLoc();
+    Value ptr = op.getPtr();
+    // LLVM prefetches don't fault, so the masked off elements are prefetched
+    // too rather than branched around. Only the targets with prefetch
+    // instructions, i.e. gfx12, emit them; the others drop them.
+    unsigned vec = getVectorSize(ptr);
+    unsigned elemsPerThread = getTotalElemsPerThread(ptr.getType());
+    auto ptrElems = unpackLLElements(loc, adaptor.getPtr(), rewriter);
+    for (size_t vecStart = 0; vecStart < elemsPerThread; vecStart += vec)
+      rewriter.create<LLVM::Prefetch>(
+          loc, ptrElems[vecStart], /*rw=*/rewriter.getI32IntegerAttr(0),
+          /*hint=*/rewriter.getI32IntegerAttr(3),
+          /*cache=*/rewriter.getI32IntegerAttr(1));
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
 static LLVM::AtomicOrdering getMemoryOrdering(MemSemantic memOrdering) {
   switch (memOrdering) {
   case MemSemantic::RELAXED:
@@ -659,7 +752,7 @@ void populateLoadStoreOpToLLVMPatterns(LLVMTypeConverter &typeConverter,
                                        ModuleAxisInfoAnalysis &axisInfoAnalysis,
                                        PatternBenefit benefit) {
   patterns.add<AtomicCASOpConversion, AtomicRMWOpConversion, LoadOpConversion,
-               StoreOpConversion>(typeConverter, targetInfo, axisInfoAnalysis,
-                                  benefit);
+               PrefetchOpConversion, StoreOpConversion>(
+      typeConverter, targetInfo, axisInfoAnalysis, benefit);
 }
 } // namespace mlir::triton::AMD
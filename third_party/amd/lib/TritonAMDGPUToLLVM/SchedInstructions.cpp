@@ -0,0 +1,145 @@
+#include "TritonAMDGPUToLLVM/Passes.h"
+
+#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "mlir/Dialect/LLVMIR/ROCDLDialect.h"
+#include "mlir/Pass/Pass.h"
+#include "llvm/Support/MathExtras.h"
+
+namespace mlir {
+namespace triton {
+#define GEN_PASS_DEF_INSERTINSTRUCTIONSCHEDHINTS
+#include "TritonAMDGPUToLLVM/Passes.h.inc"
+} // namespace triton
+} // namespace mlir
+
+using namespace mlir;
+
+namespace {
+
+// Instruction classes of the masks of llvm.amdgcn.sched.group.barrier.
+enum class SchedGroup : int32_t {
+  MFMA = 0x008,
+  VMEMRead = 0x020,
+  DSRead = 0x100,
+  DSWrite = 0x200,
+};
+
+// The number of instructions of each class in a block.
+struct InstructionMix {
+  int numMfma = 0;
+  int numVmemRead = 0;
+  int numDsRead = 0;
+  int numDsWrite = 0;
+};
+
+unsigned getAddressSpace(Value ptr) {
+  return cast<LLVM::LLVMPointerType>(ptr.getType()).getAddressSpace();
+}
+
+InstructionMix countInstructions(Block &block) {
+  InstructionMix mix;
+  for (Operation &op : block) {
+    StringRef name = op.getName().getStringRef();
+    if (name.starts_with("rocdl.mfma") || name.starts_with("rocdl.wmma")) {
+      ++mix.numMfma;
+    } else if (auto loadOp = dyn_cast<LLVM::LoadOp>(op)) {
+      unsigned addressSpace = getAddressSpace(loadOp.getAddr());
+      if (addressSpace == 3)
+        ++mix.numDsRead;
+      else if (addressSpace == 1)
+        ++mix.numVmemRead;
+    } else if (auto storeOp = dyn_cast<LLVM::StoreOp>(op)) {
+      if (getAddressSpace(storeOp.getAddr()) == 3)
+        ++mix.numDsWrite;
+    } else if (isa<ROCDL::RawPtrBufferLoadOp>(op)) {
+      ++mix.numVmemRead;
+    }
+  }
+  return mix;
+}
+
+void createIntrinsicCall(OpBuilder &builder, Location loc, StringRef name,
+                         ArrayRef<int32_t> args) {
+  SmallVector<Value> operands;
+  for (int32_t arg : args)
+    operands.push_back(builder.create<LLVM::ConstantOp>(
+        loc, builder.getI32Type(), builder.getI32IntegerAttr(arg)));
+  builder.create<LLVM::CallIntrinsicOp>(loc, builder.getStringAttr(name),
+                                        operands);
+}
+
+// Asks the scheduler to place `size` instructions of `group` next, within
+// the scheduling region of the insertion point.
+void createSchedGroupBarrier(OpBuilder &builder, Location loc,
+                             SchedGroup group, int32_t size) {
+  createIntrinsicCall(builder, loc, "llvm.amdgcn.sched.group.barrier",
+                      {static_cast<int32_t>(group), size, /*syncId=*/0});
+}
+
+// Interleaves the memory instructions of the block with its MFMAs: each MFMA
+// is followed by an even share of the global loads, LDS reads and LDS writes
+// not yet placed, so that they issue while the matrix cores are busy.
+void interleave(OpBuilder &builder, Location loc, InstructionMix mix) {
+  std::pair<SchedGroup, int> groups[] = {
+      {SchedGroup::DSRead, mix.numDsRead},
+      {SchedGroup::VMEMRead, mix.numVmemRead},
+      {SchedGroup::DSWrite, mix.numDsWrite}};
+  for (int i = 0; i < mix.numMfma; ++i) {
+    createSchedGroupBarrier(builder, loc, SchedGroup::MFMA, 1);
+    for (auto &[group, left] : groups) {
+      int size = llvm::divideCeil(left, mix.numMfma - i);
+      if (size == 0)
+        continue;
+      createSchedGroupBarrier(builder, loc, group, size);
+      left -= size;
+    }
+  }
+}
+
+struct InsertInstructionSchedHints
+    : public triton::impl::InsertInstructionSchedHintsBase<
+          InsertInstructionSchedHints> {
+  explicit InsertInstructionSchedHints(StringRef variant) {
+    this->variant = variant.str();
+  }
+
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    if (variant == "none")
+      return;
+    if (variant != "iglp0" && variant != "iglp1" && variant != "interleave") {
+      mod.emitError("unknown instruction scheduling variant: ") << variant;
+      return signalPassFailure();
+    }
+
+    // The scheduler works on basic blocks, so the hints go in each block with
+    // MFMAs, which are the bodies of the loops over K once lowered.
+    mod.walk([&](LLVM::LLVMFuncOp funcOp) {
+      for (Block &block : funcOp.getBody()) {
+        InstructionMix mix = countInstructions(block);
+        if (mix.numMfma == 0)
+          continue;
+        OpBuilder builder(block.getTerminator());
+        Location loc = block.getTerminator()->getLoc();
+        if (variant == "interleave")
+          interleave(builder, loc, mix);
+        else
+          createIntrinsicCall(builder, loc, "llvm.amdgcn.iglp.opt",
+                              {variant == "iglp0" ? 0 : 1});
+      }
+    });
+  }
+};
+
+} // anonymous namespace
+
+namespace mlir {
+namespace triton {
+
+std::unique_ptr<OperationPass<ModuleOp>>
+createInsertInstructionSchedHintsPass(StringRef variant) {
+  return std::make_unique<InsertInstructionSchedHints>(variant);
+}
+
+} // namespace triton
+} // namespace mlir
@@ -99,6 +99,10 @@ Value TargetInfo::loadDShared(RewriterBase &rewriter, Location loc, Value ptr,
   return mlir::LLVM::AMD::llLoad(rewriter, loc, ptr, elemTy, pred, falseVal);
 }
 
+void TargetInfo::clusterBarrier(RewriterBase &rewriter, Location loc) const {
+  llvm::report_fatal_error("AMDGPU does not support CTA clusters");
+}
+
 Value TargetInfo::shuffleXor(RewriterBase &rewriter, Location loc, Value val,
                              int i) const {
   return LLVM::AMD::shuffleXor(loc, rewriter, val, i);
@@ -119,6 +123,43 @@ Value TargetInfo::shuffleIdx(RewriterBase &rewriter, Location loc, Value val,
   return LLVM::AMD::shuffleIdx(loc, rewriter, val, i);
 }
 
+Value TargetInfo::shuffleXorForReduce(RewriterBase &rewriter, Location loc,
+                                      Value val, int i) const {
+  return LLVM::AMD::shuffleXorForReduce(loc, rewriter, val, i);
+}
+
+Value TargetInfo::shuffleUpForScan(RewriterBase &rewriter, Location loc,
+                                   Value val, int i, unsigned groupSize) const {
+  return LLVM::AMD::shuffleUpForScan(loc, rewriter, val, i, groupSize);
+}
+
+Value TargetInfo::makeWarpUniform(RewriterBase &rewriter, Location loc,
+                                  Value val) const {
+  // The value of the first active lane is in an SGPR, and so are the values
+  // the compiler computes from it with scalar instructions.
+  Type type = val.getType();
+  if (!type.isIntOrFloat() || (type.getIntOrFloatBitWidth() != 32 &&
+                               type.getIntOrFloatBitWidth() != 64))
+    return val;
+  auto readFirstLane = [&](Value word) {
+    return rewriter
+        .create<LLVM::CallIntrinsicOp>(
+            loc, i32_ty, rewriter.getStringAttr("llvm.amdgcn.readfirstlane"),
+            word)
+        ->getResult(0);
+  };
+  if (type.getIntOrFloatBitWidth() == 32)
+    return bitcast(readFirstLane(bitcast(val, i32_ty)), type);
+  Type vecTy = vec_ty(i32_ty, 2);
+  Value words = bitcast(val, vecTy);
+  Value uniform = undef(vecTy);
+  for (int i = 0; i < 2; ++i) {
+    Value word = readFirstLane(extract_element(i32_ty, words, i32_val(i)));
+    uniform = insert_element(vecTy, uniform, word, i32_val(i));
+  }
+  return bitcast(uniform, type);
+}
+
 Value TargetInfo::programId(RewriterBase &rewriter, Location loc,
                             ModuleOp moduleOp, int axis) const {
   return LLVM::AMD::llGetPid(loc, rewriter, moduleOp, axis);
@@ -131,6 +172,20 @@ bool TargetInfo::warpReduce(RewriterBase &rewriter, Location loc,
   return false;
 }
 
+bool TargetInfo::canUseLdMatrix() const { return false; }
+
+bool TargetInfo::canUseStMatrix() const { return false; }
+
+SmallVector<Value> TargetInfo::loadMatrix(RewriterBase &rewriter, Location loc,
+                                          Value ptr, bool trans) const {
+  llvm_unreachable("ldmatrix is not supported on AMD");
+}
+
+void TargetInfo::storeMatrix(RewriterBase &rewriter, Location loc, Value ptr,
+                             ArrayRef<Value> vals, bool trans) const {
+  llvm_unreachable("stmatrix is not supported on AMD");
+}
+
 bool TargetInfo::processReplicaUsingStMatrix(
     RewriterBase &rewriter, Location loc, Value smemBase,
     SmallVector<Value> &vals, RankedTensorType srcTy, Type elemTy,
@@ -212,6 +267,14 @@ std::string TargetInfo::getMulhiFuncName(Type resultElementTy) const {
   return funcName;
 }
 
+Value TargetInfo::timestamp(RewriterBase &rewriter, Location loc) const {
+  // s_memtime counts the cycles of the shader clock
+  auto stringAttr = rewriter.getStringAttr("llvm.amdgcn.s.memtime");
+  return rewriter
+      .create<LLVM::CallIntrinsicOp>(loc, i64_ty, stringAttr, ValueRange{})
+      ->getResult(0);
+}
+
 void TargetInfo::printf(RewriterBase &rewriter, Value formatStrStart,
                         int formatStrByteCount, ValueRange args) const {
   return printfImpl(formatStrStart, formatStrByteCount, args, rewriter,
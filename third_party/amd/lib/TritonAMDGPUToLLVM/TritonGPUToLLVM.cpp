@@ -18,6 +18,7 @@
 #include "triton/Analysis/Membar.h"
 #include "triton/Conversion/TritonGPUToLLVM/PatternTritonGPUOpToLLVM.h"
 #include "triton/Conversion/TritonGPUToLLVM/TypeConverter.h"
+#include "triton/Conversion/TritonGPUToLLVM/Utility.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonNvidiaGPU/IR/Dialect.h"
@@ -63,9 +64,12 @@ public:
 struct ConvertTritonAMDGPUToLLVM
     : public triton::impl::ConvertTritonAMDGPUToLLVMBase<
           ConvertTritonAMDGPUToLLVM> {
-  explicit ConvertTritonAMDGPUToLLVM(StringRef targetArch, bool ftz) {
+  explicit ConvertTritonAMDGPUToLLVM(StringRef targetArch, bool ftz,
+                                     bool fastMath, int32_t deviceLogCapacity) {
     this->arch = targetArch.str();
     this->ftz = ftz;
+    this->fastMath = fastMath;
+    this->deviceLogCapacity = deviceLogCapacity;
   }
 
   void getDependentDialects(DialectRegistry &registry) const override {
@@ -105,6 +109,9 @@ struct ConvertTritonAMDGPUToLLVM
     ModuleMembarAnalysis membarPass(&allocation);
     membarPass.run();
 
+    if (deviceLogCapacity > 0)
+      LLVM::createDeviceLog(mod, deviceLogCapacity);
+
     // Lower functions
     {
       mlir::LowerToLLVMOptions option(context);
@@ -178,6 +185,11 @@ struct ConvertTritonAMDGPUToLLVM
     AMD::populateElementwiseOpToLLVMPatterns(typeConverter, patterns, ftz,
                                              axisInfoAnalysis, allocation,
                                              targetInfo, AMDBenefit);
+    // The approximations take precedence over the precise lowerings of the
+    // same ops.
+    if (fastMath)
+      AMD::populateFastMathOpToLLVMPatterns(typeConverter, patterns,
+                                            axisInfoAnalysis, AMDBenefit + 1);
     AMD::populateLoadStoreOpToLLVMPatterns(typeConverter, targetInfo, patterns,
                                            numWarps, axisInfoAnalysis,
                                            AMDBenefit);
@@ -185,6 +197,8 @@ struct ConvertTritonAMDGPUToLLVM
                       commonBenefit);
     populatePatterns7(mlir::triton::populateScanOpToLLVMPatterns,
                       commonBenefit);
+    populatePatterns7(mlir::triton::populateGatherOpToLLVMPatterns,
+                      commonBenefit);
     populatePatterns5(mlir::triton::populateViewOpToLLVMPatterns,
                       commonBenefit);
     populatePatterns7(mlir::triton::populateHistogramOpToLLVMPatterns,
@@ -214,9 +228,13 @@ struct ConvertTritonAMDGPUToLLVM
                                                           patterns);
     mlir::triton::populatePrintOpToLLVMPattern(typeConverter, patterns,
                                                targetInfo, commonBenefit);
+    mlir::triton::populateProfileRegionOpToLLVMPattern(
+        typeConverter, patterns, targetInfo, commonBenefit);
     if (failed(applyPartialConversion(mod, convTarget, std::move(patterns)))) {
       return signalPassFailure();
     }
+    if (fastMath)
+      LLVM::setFastMathFlags(mod);
   }
 
 private:
@@ -246,8 +264,10 @@ namespace mlir {
 namespace triton {
 
 std::unique_ptr<OperationPass<ModuleOp>>
-createConvertTritonAMDGPUToLLVMPass(StringRef targetArch, bool ftz) {
-  return std::make_unique<ConvertTritonAMDGPUToLLVM>(targetArch, ftz);
+createConvertTritonAMDGPUToLLVMPass(StringRef targetArch, bool ftz,
+                                    bool fastMath, int32_t deviceLogCapacity) {
+  return std::make_unique<ConvertTritonAMDGPUToLLVM>(targetArch, ftz, fastMath,
+                                                     deviceLogCapacity);
 }
 
 } // namespace triton
@@ -4,7 +4,10 @@
 #include "mlir/Dialect/LLVMIR/ROCDLDialect.h"
 #include "triton/Conversion/TritonGPUToLLVM/TypeConverter.h"
 
+#include <limits>
+
 using mlir::triton::gpu::appendOrGetExternFuncOp;
+using mlir::triton::AMD::ISAFamily;
 using mlir::triton::gpu::getFunctionType;
 
 namespace {
@@ -13,8 +16,26 @@ enum class ShflKind : uint32_t {
   up = 1,
   down = 2,
   idx = 3,
+  // Moves data between the lanes of each row of 16 lanes with a DPP mov, whose
+  // control is given as the stride.
+  dpp = 4,
 };
 
+// Controls of DPP movs, see the `dpp_ctrl` operand of llvm.amdgcn.update.dpp.
+// The lanes of each row read from the lanes of the same row:
+// quad_perm(a, b, c, d): lane 4 * q + j reads lane 4 * q + (a, b, c, d)[j],
+constexpr int dppQuadPerm(int a, int b, int c, int d) {
+  return a | (b << 2) | (c << 4) | (d << 6);
+}
+// row_shr(n): lane j reads lane j - n, or keeps its value if j < n,
+constexpr int dppRowShr(int n) { return 0x110 + n; }
+// row_ror(n): lane j reads lane (j - n) % 16,
+constexpr int dppRowRor(int n) { return 0x120 + n; }
+// row_mirror: lane j reads lane 15 - j, row_half_mirror: lane j reads lane
+// 7 - j % 8 of its half-row.
+constexpr int dppRowMirror = 0x140;
+constexpr int dppRowHalfMirror = 0x141;
+
 std::string getTypeString(Type ty) {
   std::string str;
   llvm::raw_string_ostream rso(str);
@@ -35,6 +56,27 @@ std::string mangleFunc(std::string name, Type type) {
   }
   return mangled;
 }
+
+// Buffer accesses at this offset are past the end of any buffer created by
+// createBufferResource, so that loads return zeros and stores are dropped.
+const int32_t kBufferOutOfBounds = std::numeric_limits<int32_t>::min();
+
+// Returns the type buffer instructions access `type` with: integers below 32
+// bits and vectors of i32 otherwise, which all the targets support.
+Type getBufferOpType(Type type) {
+  auto ctx = type.getContext();
+  unsigned bits = 0;
+  if (auto vecTy = dyn_cast<VectorType>(type))
+    bits = vecTy.getNumElements() * vecTy.getElementTypeBitWidth();
+  else
+    bits = type.getIntOrFloatBitWidth();
+  if (bits < 32)
+    return IntegerType::get(ctx, bits);
+  assert(bits % 32 == 0 && "Unexpected width of a buffer access");
+  if (bits == 32)
+    return IntegerType::get(ctx, 32);
+  return vec_ty(IntegerType::get(ctx, 32), bits / 32);
+}
 } // namespace
 
 namespace mlir::LLVM::AMD {
@@ -90,6 +132,15 @@ static Value shuffleCommon(Location loc, RewriterBase &rewriter, Value val,
 
   switch (mode) {
   case ShflKind::bfly:
+    // DPP movs are cheaper than the LDS hardware of ds_swizzle and
+    // ds_bpermute, and implement the strides that stay within rows of 16.
+    if (strideInt == 1 || strideInt == 2 || strideInt == 8) {
+      int dppCtrl = strideInt == 1   ? dppQuadPerm(1, 0, 3, 2)
+                    : strideInt == 2 ? dppQuadPerm(2, 3, 0, 1)
+                                     : dppRowRor(8);
+      return shuffleCommon(loc, rewriter, val, i, dppCtrl, ShflKind::dpp,
+                           clamp);
+    }
     if (strideInt > 16) {
       Value threadId =
           rewriter
@@ -118,6 +169,18 @@ static Value shuffleCommon(Location loc, RewriterBase &rewriter, Value val,
   }
   case ShflKind::idx:
     return bpermute(i);
+  case ShflKind::dpp: {
+    // The lanes reading outside of their row keep their value.
+    Value dppCtrl = i32_val(strideInt);
+    Value rowMask = i32_val(0xf);
+    Value bankMask = i32_val(0xf);
+    Value boundCtrl = int_val(1, false);
+    return rewriter
+        .create<LLVM::CallIntrinsicOp>(
+            loc, valType, rewriter.getStringAttr("llvm.amdgcn.update.dpp"),
+            ValueRange{val, val, dppCtrl, rowMask, bankMask, boundCtrl})
+        ->getResult(0);
+  }
   default:
     assert(false && "Unsupported ShflKind");
     break;
@@ -143,6 +206,26 @@ Value shuffleIdx(Location loc, RewriterBase &rewriter, Value val, Value i) {
   return shuffleCommon(loc, rewriter, val, i, 0, ShflKind::idx, i32_val(0x1f));
 }
 
+Value shuffleXorForReduce(Location loc, RewriterBase &rewriter, Value val,
+                          int i) {
+  // Mirroring the lanes of a half-row xors their ids with 7, which ds_swizzle
+  // would otherwise do for the stride 4 that no DPP mov implements exactly.
+  if (i == 4)
+    return shuffleCommon(loc, rewriter, val, i32_val(0), dppRowHalfMirror,
+                         ShflKind::dpp, i32_val(0));
+  return shuffleXor(loc, rewriter, val, i);
+}
+
+Value shuffleUpForScan(Location loc, RewriterBase &rewriter, Value val, int i,
+                       unsigned groupSize) {
+  // Within groups that fit in a row, the lanes reading outside of the row are
+  // the ones whose value is not used.
+  if (groupSize <= 16 && i < 16)
+    return shuffleCommon(loc, rewriter, val, i32_val(0), dppRowShr(i),
+                         ShflKind::dpp, i32_val(0));
+  return shuffleUp(loc, rewriter, val, i);
+}
+
 Value llGetPid(Location loc, RewriterBase &rewriter, ModuleOp moduleOp,
                int axis) {
   assert(axis >= 0);
@@ -180,4 +263,55 @@ void llStore(RewriterBase &rewriter, Location loc, Value ptr, Value val,
   rewriter.create<LLVM::CallOp>(loc, funcOp, ValueRange({ptr, val, pred}));
 }
 
+bool supportsBufferOps(ISAFamily isaFamily) {
+  switch (isaFamily) {
+  case ISAFamily::CDNA1:
+  case ISAFamily::CDNA2:
+  case ISAFamily::CDNA3:
+  case ISAFamily::RDNA2:
+  case ISAFamily::RDNA3:
+    return true;
+  default:
+    return false;
+  }
+}
+
+Value createBufferResource(RewriterBase &rewriter, Location loc, Value basePtr,
+                           ISAFamily isaFamily) {
+  assert(supportsBufferOps(isaFamily));
+  // Word 3 of the descriptor: bits 12-18 hold a data format, ignored by raw
+  // buffer accesses but required to be nonzero (32-bit float).  On RDNA, bit
+  // 24 is reserved to 1 and bits 28-29 select the range check against the
+  // offset, which is the only one CDNA has.
+  uint32_t flags = (7 << 12) | (4 << 15);
+  if (isaFamily == ISAFamily::RDNA2 || isaFamily == ISAFamily::RDNA3)
+    flags |= (1 << 24) | (3 << 28);
+  Value stride = int_val(16, 0);
+  Value numRecords = i32_val(std::numeric_limits<int32_t>::max());
+  Type rsrcTy = LLVM::LLVMPointerType::get(rewriter.getContext(), 8);
+  return rewriter.create<ROCDL::MakeBufferRsrcOp>(
+      loc, rsrcTy, basePtr, stride, numRecords, i32_val(flags));
+}
+
+Value llBufferLoad(RewriterBase &rewriter, Location loc, Value rsrc,
+                   Value offset, Type elemTy, Value pred, Value falseVal) {
+  Value maskedOffset = select(pred, offset, i32_val(kBufferOutOfBounds));
+  Value loadVal = rewriter.create<ROCDL::RawPtrBufferLoadOp>(
+      loc, getBufferOpType(elemTy), rsrc, maskedOffset, i32_val(0),
+      i32_val(0));
+  loadVal = bitcast(loadVal, elemTy);
+  if (!falseVal)
+    return loadVal;
+  return select(pred, loadVal, falseVal);
+}
+
+void llBufferStore(RewriterBase &rewriter, Location loc, Value rsrc,
+                   Value offset, Value val, Value pred) {
+  Value maskedOffset = select(pred, offset, i32_val(kBufferOutOfBounds));
+  Value storeVal = bitcast(val, getBufferOpType(val.getType()));
+  rewriter.create<ROCDL::RawPtrBufferStoreOp>(loc, storeVal, rsrc,
+                                              maskedOffset, i32_val(0),
+                                              i32_val(0));
+}
+
 } // namespace mlir::LLVM::AMD
@@ -2,6 +2,7 @@
 #define TRITON_CONVERSION_TRITONAMDGPU_TO_LLVM_UTILITY_H
 
 #include "TritonAMDGPUToLLVM/GCNAsmFormat.h"
+#include "TritonAMDGPUToLLVM/TargetUtils.h"
 
 #include "mlir/Conversion/LLVMCommon/Pattern.h"
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
@@ -17,6 +18,11 @@ Value shuffleXor(Location loc, RewriterBase &rewriter, Value val, int i);
 Value shuffleUp(Location loc, RewriterBase &rewriter, Value val, int i);
 Value shuffleIdx(Location loc, RewriterBase &rewriter, Value val, int i);
 Value shuffleIdx(Location loc, RewriterBase &rewriter, Value val, Value i);
+// See TargetInfoBase::shuffleXorForReduce and shuffleUpForScan.
+Value shuffleXorForReduce(Location loc, RewriterBase &rewriter, Value val,
+                          int i);
+Value shuffleUpForScan(Location loc, RewriterBase &rewriter, Value val, int i,
+                       unsigned groupSize);
 
 Value llGetPid(Location loc, RewriterBase &rewriter, ModuleOp moduleOp,
                int axis);
@@ -29,6 +35,24 @@ Value llLoad(RewriterBase &rewriter, Location loc, Value ptr, Type elemTy,
 // Stores to shared or global memory with predication.
 void llStore(RewriterBase &rewriter, Location loc, Value ptr, Value val,
              Value pred);
+
+// Returns true if buffer resource descriptors of the given ISA family can be
+// created by createBufferResource.
+bool supportsBufferOps(mlir::triton::AMD::ISAFamily isaFamily);
+
+// Creates the resource descriptor of a raw buffer of 2 GiB starting at the
+// global memory `basePtr`, whose accesses are range checked by the hardware.
+Value createBufferResource(RewriterBase &rewriter, Location loc, Value basePtr,
+                           mlir::triton::AMD::ISAFamily isaFamily);
+
+// Loads from the buffer `rsrc` at the byte offset `offset` with predication.
+// Masked-off lanes load zeros; they are replaced by `falseVal` if it is set.
+Value llBufferLoad(RewriterBase &rewriter, Location loc, Value rsrc,
+                   Value offset, Type elemTy, Value pred, Value falseVal);
+
+// Stores to the buffer `rsrc` at the byte offset `offset` with predication.
+void llBufferStore(RewriterBase &rewriter, Location loc, Value rsrc,
+                   Value offset, Value val, Value pred);
 } // namespace mlir::LLVM::AMD
 
 #endif
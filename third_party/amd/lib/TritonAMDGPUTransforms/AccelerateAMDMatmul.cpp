@@ -27,13 +27,16 @@ enum class MatrixCoreVersion {
   CDNA_MFMA1,
   CDNA_MFMA2,
   CDNA_MFMA3,
-  RDNA_WMMA,
+  RDNA_WMMA1,
+  RDNA_WMMA2,
   UNKNOWN
 };
 
 MatrixCoreVersion getMatrixCoreVersion(StringRef archGen) {
   if (archGen.contains("gfx11"))
-    return MatrixCoreVersion::RDNA_WMMA;
+    return MatrixCoreVersion::RDNA_WMMA1;
+  if (archGen.contains("gfx12"))
+    return MatrixCoreVersion::RDNA_WMMA2;
   if (archGen.contains("gfx908"))
     return MatrixCoreVersion::CDNA_MFMA1;
   if (archGen.contains("gfx90a"))
@@ -54,6 +57,14 @@ int getMfmaVersion(MatrixCoreVersion matrixCoreVer) {
   return 0;
 }
 
+int getWmmaVersion(MatrixCoreVersion matrixCoreVer) {
+  if (MatrixCoreVersion::RDNA_WMMA1 == matrixCoreVer)
+    return 1;
+  if (MatrixCoreVersion::RDNA_WMMA2 == matrixCoreVer)
+    return 2;
+  return 0;
+}
+
 SmallVector<unsigned, 2> warpsPerTile(tt::DotOp dotOp,
                                       const ArrayRef<int64_t> shape,
                                       int numWarps,
@@ -307,14 +318,95 @@ public:
     return false;
   }
 
+  static bool isOcpFp8(Type type) {
+    return type.isFloat8E4M3FN() || type.isFloat8E5M2();
+  }
+
+  /// @brief Rewrite a dot of OCP fp8 operands into an fp16 dot
+  ///
+  /// The matrix cores only multiply the FNUZ variants of fp8, while fp16
+  /// represents every OCP fp8 value exactly, so the fp16 MFMAs compute these
+  /// dots without the FMA fallback. The new dot is matched again.
+  LogicalResult upcastOcpFp8Operands(tt::DotOp dotOp,
+                                     mlir::PatternRewriter &rewriter) const {
+    auto aType = cast<RankedTensorType>(dotOp.getA().getType());
+    auto bType = cast<RankedTensorType>(dotOp.getB().getType());
+    if (!isOcpFp8(aType.getElementType()) &&
+        !isOcpFp8(bType.getElementType()))
+      return failure();
+    auto upcast = [&](Value v) -> Value {
+      auto type = cast<RankedTensorType>(v.getType());
+      if (!isOcpFp8(type.getElementType()))
+        return v;
+      return rewriter.create<tt::FpToFpOp>(
+          v.getLoc(), type.clone(rewriter.getF16Type()), v);
+    };
+    Value a = upcast(dotOp.getA());
+    Value b = upcast(dotOp.getB());
+    rewriter.replaceOpWithNewOp<tt::DotOp>(
+        dotOp, dotOp.getType(), a, b, dotOp.getC(), dotOp.getInputPrecision(),
+        dotOp.getMaxNumImpreciseAcc());
+    return success();
+  }
+
+  /// @brief Compute the number of elements each thread loads from shared
+  /// memory per dot operand, see the description of kWidth in
+  /// matchAndRewrite
+  static unsigned getKWidth(unsigned mDim, unsigned nDim, unsigned kDim,
+                            unsigned kBase, unsigned kPack) {
+    // in mfma 4x4 case argument matrix groups in 16 groups
+    if (mDim == 4 && nDim == 4)
+      return kDim / 16 * kPack;
+    if ((mDim == 4 && nDim == 64) || (mDim == 64 && nDim == 4))
+      return kDim * kPack;
+    return kBase * kPack;
+  }
+
+  /// @brief Estimate the cost of a dot lowered to the given MFMA instruction
+  /// @return cycles of one warp; only meaningful relative to other choices
+  ///
+  /// For a given element type the matrix cores execute the same number of
+  /// multiply-accumulates per cycle whatever the instruction shape, so the
+  /// choices differ by the work that warps duplicate when their tiles
+  /// overhang the tensor, by the number of MFMA and ds_read instructions
+  /// issued, and by the bytes read from shared memory.
+  static double estimateMfmaCost(tt::DotOp dot, int numWarps, unsigned mDim,
+                                 unsigned nDim, unsigned kDim,
+                                 unsigned kWidth) {
+    constexpr double macsPerCycle = 128;
+    constexpr double issueCycles = 4;
+    constexpr double ldsBytesPerCycle = 128;
+    constexpr int64_t warpSize = 64;
+
+    auto aType = cast<RankedTensorType>(dot.getA().getType());
+    auto shape = dot.getType().getShape();
+    auto rank = shape.size();
+    int64_t K = aType.getShape()[rank - 1];
+    auto warps = warpsPerTileMFMA(dot, shape, numWarps, {mDim, nDim});
+    int64_t batchReps = rank == 3 ? llvm::divideCeil(shape[0], warps[0]) : 1;
+    int64_t repsM = llvm::divideCeil(shape[rank - 2], warps[rank - 2] * mDim);
+    int64_t repsN = llvm::divideCeil(shape[rank - 1], warps[rank - 1] * nDim);
+
+    int64_t numMfma = batchReps * repsM * repsN * (K / kDim);
+    double macs = double(numMfma) * mDim * nDim * kDim;
+    int64_t numElems = batchReps * (repsM * mDim + repsN * nDim) * K;
+    int64_t numDsReads = numElems / (warpSize * kWidth);
+    double ldsBytes =
+        double(numElems) * aType.getElementType().getIntOrFloatBitWidth() / 8;
+    return macs / macsPerCycle + (numMfma + numDsReads) * issueCycles +
+           ldsBytes / ldsBytesPerCycle;
+  }
+
   /// @brief Choose MFMA instruction parameters
   /// @param dot target dot operation
-  /// @return pair {mDim, nDim, kDim, kBase} sizes of one MFMA instruction
-  /// arguments
-  std::tuple<unsigned, unsigned, unsigned, unsigned>
-  chooseMfmaDimensions(tt::DotOp dot) const {
-    // number of matrix elements along k dim per one MFMA intruction
-    unsigned kDim = 0;
+  /// @return {mDim, nDim, kDim, kBase, kPack} sizes of one MFMA instruction
+  /// arguments and the number of instructions fed by one ds_read
+  ///
+  /// The instruction shape and kPack the pass was not given are chosen as
+  /// the cheapest according to estimateMfmaCost among the instructions
+  /// fitting the dot.
+  std::tuple<unsigned, unsigned, unsigned, unsigned, unsigned>
+  chooseMfmaInstruction(tt::DotOp dot, int numWarps) const {
     auto opType = cast<RankedTensorType>(dot.getA().getType());
     auto dataTypeA = opType.getElementType();
     auto dataTypeB =
@@ -325,52 +417,65 @@ public:
     auto rank = resShape.size();
     auto M = resShape[rank - 2];
     auto N = resShape[rank - 1];
+    auto K = opType.getShape()[rank - 1];
 
-    unsigned mDim = 0;
-    unsigned nDim = 0;
+    SmallVector<std::pair<unsigned, unsigned>> dims;
     if (enforcedNonKDim != 0) {
-      mDim = enforcedNonKDim;
-      nDim = enforcedNonKDim;
+      dims.push_back({enforcedNonKDim, enforcedNonKDim});
+    } else if (std::min(M, N) >= 16) {
+      dims.append({{32, 32}, {16, 16}});
     } else {
-      int minSize = std::min(M, N);
-      if (minSize >= 32) {
-        mDim = 32;
-        nDim = 32;
-      }
-      if (minSize >= 16 && minSize < 32) {
-        mDim = 16;
-        nDim = 16;
-      }
-      if (minSize < 16) {
-        if (M < 16 && N >= 64) {
-          mDim = 4;
-          nDim = 64;
-        } else if (M >= 64 && N < 16) {
-          mDim = 64;
-          nDim = 4;
-        } else {
-          assert(opType.getShape()[rank - 1] >= 64 &&
-                 "k should be at least 64 to use this layout");
-          mDim = 4;
-          nDim = 4;
+      // Dots thinner than 16 along M or N can only use the 4x4 instructions,
+      // either with the 16 blocks along the other dimension or along K.
+      dims.append({{4, 64}, {64, 4}, {4, 4}});
+    }
+    SmallVector<unsigned, 2> kPacks;
+    // In FA, the second dot can only use kWidth = kBase since it's limited by
+    // the result of the first dot, which is of mfmaLayout.
+    if (isSecondDot(dot))
+      kPacks.push_back(1);
+    else if (kPack != 0)
+      kPacks.push_back(kPack);
+    else
+      kPacks.append({1, 2});
+
+    bool foundInsn = false;
+    std::optional<std::tuple<unsigned, unsigned, unsigned, unsigned, unsigned>>
+        best;
+    double bestCost = 0;
+    for (auto [mDim, nDim] : dims) {
+      auto maybeMfmaInsn =
+          MfmaInsn::selectMfma(mDim, nDim, dataTypeA, dataTypeB, mfmaVersion);
+      if (failed(maybeMfmaInsn))
+        continue;
+      foundInsn = true;
+      unsigned kDim = maybeMfmaInsn->getKDim();
+      unsigned kBase = maybeMfmaInsn->getKBase();
+      if (M % mDim != 0 || N % nDim != 0 || K % kDim != 0)
+        continue;
+      if (mDim == 4 && nDim == 4 && K < 64)
+        continue;
+      for (unsigned pack : kPacks) {
+        unsigned kWidth = getKWidth(mDim, nDim, kDim, kBase, pack);
+        // Packing is limited to ds_read_b128, the widest shared memory load,
+        // and to the K the dot has, unless kPack is enforced.
+        if (pack > 1 && kPack == 0 &&
+            (kWidth * dataTypeA.getIntOrFloatBitWidth() > 128 ||
+             K % (kDim * pack) != 0))
+          continue;
+        double cost =
+            estimateMfmaCost(dot, numWarps, mDim, nDim, kDim, kWidth);
+        if (!best || cost < bestCost) {
+          best = {mDim, nDim, kDim, kBase, pack};
+          bestCost = cost;
         }
       }
     }
-    assert(mDim != 0 && nDim != 0);
-
-    auto maybeMfmaInsn =
-        MfmaInsn::selectMfma(mDim, nDim, dataTypeA, dataTypeB, mfmaVersion);
-    if (failed(maybeMfmaInsn))
+    if (!foundInsn)
       llvm::report_fatal_error("No match found in MFMA database\n");
-
-    kDim = maybeMfmaInsn->getKDim();
-    unsigned kBase = maybeMfmaInsn->getKBase();
-
-    assert(kDim != 0);
-
-    assert(M % mDim == 0 && N % nDim == 0);
-    assert(opType.getShape()[rank - 1] % kDim == 0);
-    return {mDim, nDim, kDim, kBase};
+    if (!best)
+      llvm::report_fatal_error("No MFMA instruction fits the dot shape\n");
+    return *best;
   }
 
   mlir::LogicalResult
@@ -383,6 +488,9 @@ public:
         !isa<ttg::BlockedEncodingAttr>(oldRetType.getEncoding()))
       return failure();
 
+    if (succeeded(upcastOcpFp8Operands(dotOp, rewriter)))
+      return success();
+
     if (!supportMFMA(dotOp))
       return failure();
 
@@ -402,7 +510,8 @@ public:
 
     ttg::AMDMfmaEncodingAttr mfmaEnc;
 
-    auto [mDim, nDim, kDim, kBase] = chooseMfmaDimensions(dotOp);
+    auto [mDim, nDim, kDim, kBase, insnKPack] =
+        chooseMfmaInstruction(dotOp, numWarps);
 
     auto warpsPerTile =
         warpsPerTileMFMA(dotOp, retShape, numWarps, {mDim, nDim});
@@ -449,19 +558,15 @@ public:
     //        can only consume kBase elements from each thread.
     //    Note that we cannot have larger kPack since kPack = 2 means
     //    ds_read_b128, which is the largest vector size for shared memory load.
-    auto kWidth = kBase;
-    // in mfma 4x4 case argument matrix groups in 16 groups
-    if (mDim == 4 && nDim == 4)
-      kWidth = kDim / 16;
-    if ((mDim == 4 && nDim == 64) || (mDim == 64 && nDim == 4))
-      kWidth = kDim;
-
+    //    The pass chooses kPack = 2 when it is not given and the operands
+    //    allow it, as it halves the number of ds_read instructions.
+    //
     // We want to extend kWidth by kPack (kPack=1 means no extension)
     // to increase ds_read vector size
     // However, in FA, the second dot can only use kWidth = kBase since it's
-    // limited by the result of the first dot, which is of mfmaLayout.
-    if (!isSecondDot(dotOp))
-      kWidth *= kPack;
+    // limited by the result of the first dot, which is of mfmaLayout, so
+    // chooseMfmaInstruction only returns kPack = 1 for it.
+    auto kWidth = getKWidth(mDim, nDim, kDim, kBase, insnKPack);
 
     auto newAType = RankedTensorType::get(
         oldAType.getShape(), oldAType.getElementType(),
@@ -594,9 +699,12 @@ static void decomposeMixedModeDotOp(ModuleOp mod) {
 }
 
 class BlockedToWMMA : public mlir::RewritePattern {
+  int wmmaVersion;
+
 public:
-  BlockedToWMMA(mlir::MLIRContext *context)
-      : mlir::RewritePattern(tt::DotOp::getOperationName(), 2, context) {}
+  BlockedToWMMA(mlir::MLIRContext *context, int wmmaVersion)
+      : mlir::RewritePattern(tt::DotOp::getOperationName(), 2, context),
+        wmmaVersion(wmmaVersion) {}
 
   mlir::LogicalResult
   matchAndRewrite(mlir::Operation *op,
@@ -640,7 +748,8 @@ public:
     auto warpsPerTile = warpsPerTileWMMA(dotOp, retShape, numWarps);
 
     auto CTALayout = ttg::getCTALayout(oldRetEncoding);
-    wmmaEnc = AMDWmmaEncodingAttr::get(ctx, warpsPerTile, CTALayout);
+    wmmaEnc =
+        AMDWmmaEncodingAttr::get(ctx, wmmaVersion, warpsPerTile, CTALayout);
 
     auto newRetType = RankedTensorType::get(retShape, operandTypes[3], wmmaEnc);
 
@@ -649,12 +758,13 @@ public:
     auto newAcc =
         convertAndCastTensor(rewriter, oldAcc, wmmaEnc, operandTypes[2]);
 
+    auto kWidth = wmmaEnc.getKWidthForOperands();
     auto newAType = RankedTensorType::get(
         aShape, operandTypes[0],
-        ttg::DotOperandEncodingAttr::get(ctx, 0, wmmaEnc, mnkDim[2]));
+        ttg::DotOperandEncodingAttr::get(ctx, 0, wmmaEnc, kWidth));
     auto newBType = RankedTensorType::get(
         bShape, operandTypes[1],
-        ttg::DotOperandEncodingAttr::get(ctx, 1, wmmaEnc, mnkDim[2]));
+        ttg::DotOperandEncodingAttr::get(ctx, 1, wmmaEnc, kWidth));
 
     Value castedA = convertAndCastTensor(rewriter, a, newAType.getEncoding(),
                                          operandTypes[0]);
@@ -697,8 +807,9 @@ public:
         MatrixCoreVersion::CDNA_MFMA3 == matrixCoreVer) {
       patterns.add<::BlockedToMFMA>(context, getMfmaVersion(matrixCoreVer),
                                     matrixInstructionSize, kPack);
-    } else if (matrixCoreVer == MatrixCoreVersion::RDNA_WMMA) {
-      patterns.add<::BlockedToWMMA>(context);
+    } else if (MatrixCoreVersion::RDNA_WMMA1 == matrixCoreVer ||
+               MatrixCoreVersion::RDNA_WMMA2 == matrixCoreVer) {
+      patterns.add<::BlockedToWMMA>(context, getWmmaVersion(matrixCoreVer));
     }
     if (applyPatternsAndFoldGreedily(m, std::move(patterns)).failed()) {
       signalPassFailure();
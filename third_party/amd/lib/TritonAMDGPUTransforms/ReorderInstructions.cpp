@@ -15,9 +15,11 @@
 #include "mlir/Transforms/RegionUtils.h"
 #include "triton/Analysis/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/ListScheduler.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
 #include "triton/Dialect/TritonGPU/Transforms/TritonGPUConversion.h"
 #include "triton/Dialect/TritonGPU/Transforms/Utility.h"
+#include "triton/Tools/Sys/GetEnv.hpp"
 #define GEN_PASS_CLASSES
 #include "TritonAMDGPUTransforms/Passes.h"
 
@@ -42,6 +44,9 @@ public:
 
   void runOnOperation() override {
     ModuleOp m = getOperation();
+    // The fixed moves below refine the list schedule.
+    if (triton::tools::getBoolEnv("TRITON_LIST_SCHEDULING"))
+      triton::gpu::scheduleBlocks(m, triton::gpu::SchedulingModel::get(m));
     mlir::DominanceInfo dom(m);
     // Sink conversions into loops when they will increase
     // register pressure
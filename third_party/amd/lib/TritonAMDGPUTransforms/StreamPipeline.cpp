@@ -1,4 +1,5 @@
 #include "TritonAMDGPUTransforms/Passes.h"
+#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/IR/IRMapping.h"
 #include "mlir/IR/TypeUtilities.h"
@@ -7,6 +8,9 @@
 #include "triton/Analysis/AxisInfo.h"
 #include "triton/Analysis/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/PipelineExpander.h"
+#include "triton/Dialect/TritonGPU/Transforms/PipeliningUtility.h"
+#include "triton/Dialect/TritonGPU/Transforms/Schedule.h"
 #include "triton/Dialect/TritonGPU/Transforms/Utility.h"
 #include "llvm/ADT/MapVector.h"
 
@@ -30,6 +34,15 @@
 //   - Store next tile into shared mem
 // - Epilogue: Peeled non-load loop body for last iteration
 //
+// With num_stages = N > 1, the loads are instead scheduled for the pipeline
+// expander shared with the NVIDIA pipeliner, through ring buffers of N - 1
+// tiles in shared memory:
+//   stage 0:     global load of the tile of iteration i into registers
+//   stage 1:     local_store of the tile into slot i % (N - 1)
+//   stage N - 1: local_load of slot i % (N - 1), and the rest of the body
+// so that N - 1 tiles are in flight in shared memory while a single one is
+// held in registers.
+//
 //===----------------------------------------------------------------------===//
 
 using llvm::MapVector;
@@ -818,11 +831,329 @@ scf::ForOp LoopPipeliner::createNewForOp() {
   return pplForOp;
 }
 
+// Return true if the loop can be handed to the pipeline expander.
+static bool canMultiBuffer(scf::ForOp forOp) {
+  // The expander only supports loop-carried values with a distance of 1.
+  if (llvm::any_of(forOp.getBody()->getTerminator()->getOperands(),
+                   [](Value operand) { return !operand.getDefiningOp(); }))
+    return false;
+  // Don't pipeline outer loops.
+  return !forOp
+              ->walk([&](Operation *op) {
+                if (op != forOp.getOperation() &&
+                    isa<scf::ForOp, scf::WhileOp>(op))
+                  return WalkResult::interrupt();
+                return WalkResult::advance();
+              })
+              .wasInterrupted();
+}
+
+// Return the loads of the loop body whose only use converts them to a dot
+// operand, along with the conversion, skipping those depending on other
+// loads of the loop.
+static SmallVector<std::pair<triton::LoadOp, ttg::ConvertLayoutOp>>
+getMultiBufferedLoads(scf::ForOp forOp) {
+  SmallVector<std::pair<triton::LoadOp, ttg::ConvertLayoutOp>> loads;
+  for (Operation &op : forOp.getBody()->without_terminator()) {
+    auto loadOp = dyn_cast<triton::LoadOp>(&op);
+    if (!loadOp || !isa<RankedTensorType>(loadOp.getType()) ||
+        !loadOp->hasOneUse())
+      continue;
+    auto cvt = dyn_cast<ttg::ConvertLayoutOp>(*loadOp->getUsers().begin());
+    if (!cvt ||
+        !isa<ttg::DotOperandEncodingAttr>(cvt.getType().getEncoding()))
+      continue;
+    DenseSet<Operation *> deps;
+    triton::addDep(loadOp, deps);
+    if (llvm::any_of(deps, [&](Operation *dep) {
+          return dep != loadOp && isa<triton::LoadOp>(dep);
+        }))
+      continue;
+    loads.push_back({loadOp, cvt});
+  }
+  return loads;
+}
+
+// Create a buffer of `numBuffers` tiles of the result of `loadOp`, in the
+// shared layout of the dot operand `cvt` converts it to.
+static Value createRingBuffer(OpBuilder &builder, triton::LoadOp loadOp,
+                              ttg::ConvertLayoutOp cvt, int numBuffers) {
+  auto ty = cast<RankedTensorType>(loadOp.getType());
+  auto dotOpEnc =
+      cast<ttg::DotOperandEncodingAttr>(cvt.getType().getEncoding());
+  auto sharedEnc = ttg::SharedEncodingAttr::get(
+      ty.getContext(), dotOpEnc, ty.getShape(), ttg::getOrder(ty.getEncoding()),
+      ttg::getCTALayout(ty.getEncoding()), ty.getElementType());
+  SmallVector<int64_t> bufferShape(ty.getShape().begin(), ty.getShape().end());
+  bufferShape.insert(bufferShape.begin(), numBuffers);
+  auto bufferTy = triton::MemDescType::get(
+      bufferShape, ty.getElementType(), sharedEnc,
+      ttg::SharedMemorySpaceAttr::get(ty.getContext()),
+      /*mutableMemory=*/true);
+  return builder.create<ttg::LocalAllocOp>(loadOp.getLoc(), bufferTy,
+                                           Value());
+}
+
+// Pipeline the loads of `forOp` feeding dot operands through ring buffers of
+// `numStages - 1` tiles. Return the pipelined loop.
+static FailureOr<scf::ForOp> multiBufferLoop(scf::ForOp forOp, int numStages) {
+  if (!canMultiBuffer(forOp))
+    return failure();
+  auto loads = getMultiBufferedLoads(forOp);
+  if (loads.empty())
+    return failure();
+
+  int numBuffers = numStages - 1;
+  Location loc = forOp.getLoc();
+  IRRewriter builder(forOp.getContext());
+  builder.setInsertionPoint(forOp);
+  SmallVector<Value> allocs;
+  for (auto [loadOp, cvt] : loads)
+    allocs.push_back(createRingBuffer(builder, loadOp, cvt, numBuffers));
+
+  // Add the slots written and read by the iteration to the loop-carried
+  // values. They are advanced at the top of the body, so that the stages of
+  // their users each advance their own copy.
+  Value minusOne = builder.create<arith::ConstantIntOp>(loc, -1, 32);
+  Value zero = builder.create<arith::ConstantIntOp>(loc, 0, 32);
+  Value one = builder.create<arith::ConstantIntOp>(loc, 1, 32);
+  Value numBuffersVal =
+      builder.create<arith::ConstantIntOp>(loc, numBuffers, 32);
+  unsigned newOperandIndex = forOp.getBody()->getNumArguments();
+  scf::ForOp newForOp =
+      replaceForOpWithNewSignature(builder, forOp, {minusOne, minusOne});
+  forOp.erase();
+  forOp = newForOp;
+
+  builder.setInsertionPointToStart(forOp.getBody());
+  auto nextSlot = [&](Value slot) -> Value {
+    Value next = builder.create<arith::AddIOp>(loc, slot, one);
+    Value inRange = builder.create<arith::CmpIOp>(
+        loc, arith::CmpIPredicate::slt, next, numBuffersVal);
+    return builder.create<arith::SelectOp>(loc, inRange, next, zero);
+  };
+  Value insertIdx = nextSlot(forOp.getBody()->getArgument(newOperandIndex));
+  Value extractIdx =
+      nextSlot(forOp.getBody()->getArgument(newOperandIndex + 1));
+  auto yieldOp = cast<scf::YieldOp>(forOp.getBody()->getTerminator());
+  yieldOp->insertOperands(yieldOp->getNumOperands(), {insertIdx, extractIdx});
+
+  triton::CoarseSchedule schedule(numStages);
+  auto loadCluster = schedule.clusters.newAtBack();
+  auto storeCluster = schedule.clusters.newAtBack();
+  auto computeCluster = schedule.clusters.newAtBack();
+  for (auto [load, alloc] : llvm::zip(loads, allocs)) {
+    auto [loadOp, cvt] = load;
+    auto allocTy = cast<triton::MemDescType>(alloc.getType());
+    auto slotTy = triton::MemDescType::get(
+        allocTy.getShape().drop_front(), allocTy.getElementType(),
+        allocTy.getEncoding(),
+        ttg::SharedMemorySpaceAttr::get(builder.getContext()),
+        /*mutableMemory=*/true);
+    SmallVector<Value> offsets(allocTy.getRank(), zero);
+
+    builder.setInsertionPointAfter(loadOp);
+    offsets[0] = insertIdx;
+    auto storeSlot = builder.create<ttg::MemDescSubviewOp>(
+        loadOp.getLoc(), slotTy, alloc, offsets);
+    auto store = builder.create<ttg::LocalStoreOp>(loadOp.getLoc(), loadOp,
+                                                   storeSlot);
+
+    builder.setInsertionPoint(cvt);
+    offsets[0] = extractIdx;
+    auto loadSlot = builder.create<ttg::MemDescSubviewOp>(cvt.getLoc(), slotTy,
+                                                          alloc, offsets);
+    auto localLoad = builder.create<ttg::LocalLoadOp>(
+        cvt.getLoc(), cvt.getType(), loadSlot);
+    cvt.replaceAllUsesWith(localLoad.getResult());
+    cvt.erase();
+
+    schedule.insert(loadOp, 0, loadCluster);
+    schedule.insert(storeSlot, 1, storeCluster);
+    schedule.insert(store, 1, storeCluster);
+    schedule.insert(loadSlot, numStages - 1, computeCluster);
+    schedule.insert(localLoad, numStages - 1, computeCluster);
+  }
+  // Prefetches are issued with the global loads, the furthest ahead.
+  for (auto prefetch : forOp.getBody()->getOps<triton::PrefetchOp>())
+    schedule.insert(prefetch, 0, loadCluster);
+  triton::scheduleDependencies(forOp, schedule, numStages);
+  triton::scheduleDistanceOneDependencies(forOp, schedule, numStages);
+  triton::scheduleRemainingToLastStage(forOp, schedule, computeCluster,
+                                       numStages);
+
+  std::vector<std::pair<Operation *, unsigned>> finalSchedule =
+      schedule.createFinalSchedule(forOp);
+  triton::PipeliningOption options;
+  options.getScheduleFn =
+      [finalSchedule](scf::ForOp forOp,
+                      std::vector<std::pair<Operation *, unsigned>> &s) {
+        s = finalSchedule;
+      };
+  options.peelEpilogue = false;
+  options.predicateFn = triton::predicateOp;
+  options.supportDynamicLoops = true;
+
+  builder.setInsertionPointAfter(forOp);
+  for (Value alloc : allocs)
+    builder.create<ttg::LocalDeallocOp>(loc, alloc);
+
+  builder.setInsertionPoint(forOp);
+  return triton::pipelineForLoop(builder, forOp, options);
+}
+
+// Return true if the only shared memory accesses of the body of the
+// multi-buffered `forOp` are the local_stores of the ring buffers, before its
+// first dot, and the local_loads of dot operands, and if it has no other
+// barrier. The barriers of pingPongLoop are then the only synchronization the
+// loop needs.
+static bool canPingPong(scf::ForOp forOp) {
+  bool hasDot = false;
+  for (Operation &op : forOp.getBody()->without_terminator()) {
+    if (isa<triton::DotOp>(op)) {
+      hasDot = true;
+    } else if (isa<ttg::LocalStoreOp>(op)) {
+      if (hasDot)
+        return false;
+    } else if (auto localLoad = dyn_cast<ttg::LocalLoadOp>(op)) {
+      if (!localLoad->hasOneUse() ||
+          !isa<triton::DotOp>(*localLoad->getUsers().begin()))
+        return false;
+    } else if (auto cvt = dyn_cast<ttg::ConvertLayoutOp>(op)) {
+      if (cvtNeedsSharedMemory(cast<RankedTensorType>(cvt.getSrc().getType()),
+                               cvt.getType()))
+        return false;
+    } else if (auto reduce = dyn_cast<triton::ReduceOp>(op)) {
+      if (!ReduceOpHelper(reduce).isWarpSynchronous())
+        return false;
+    } else if (op.getNumRegions() > 0 ||
+               isa<ttg::LocalAllocOp, ttg::LocalDeallocOp, triton::ScanOp,
+                   triton::AtomicRMWOp, triton::AtomicCASOp,
+                   triton::HistogramOp, triton::CallOp, gpu::BarrierOp>(op)) {
+      return false;
+    }
+  }
+  return hasDot;
+}
+
+static void createSetPrio(OpBuilder &builder, Location loc, int16_t prio) {
+  Value prioVal = builder.create<LLVM::ConstantOp>(
+      loc, builder.getI16Type(), builder.getI16IntegerAttr(prio));
+  builder.create<LLVM::CallIntrinsicOp>(
+      loc, builder.getStringAttr("llvm.amdgcn.s.setprio"), prioVal);
+}
+
+// Create a barrier executed by the waves for which `cond` holds.
+static void createBarrierIf(OpBuilder &builder, Location loc, Value cond) {
+  auto ifOp = builder.create<scf::IfOp>(loc, cond, /*withElseRegion=*/false);
+  OpBuilder thenBuilder = ifOp.getThenBodyBuilder();
+  thenBuilder.create<gpu::BarrierOp>(loc);
+}
+
+// Cut the body of `forOp` with barriers around each dot and the local_loads
+// of its operands, and make the waves of the upper half of the workgroup wait
+// on one more barrier before the loop than those of the lower half, which
+// catch up after the loop. Each barrier of the loop then releases the waves
+// of one half into a dot and those of the other half into the code between
+// two dots, so that with two waves per SIMD, the matrix cores run the dots of
+// one wave while the other one computes the rest of the body, e.g. the
+// softmax of attention. The waves running their dots get a higher priority so
+// that they issue their MFMAs first.
+//
+// Each half is one barrier ahead of the other, so the accesses of different
+// waves to the same slot of the ring buffers have to be separated by at least
+// two barriers: the local_stores of stage 1 and the local_loads of stage
+// numStages - 1 of the same slot are numStages - 2 iterations apart, and with
+// numStages >= 4 the local_loads of an iteration are separated by two
+// barriers from the local_stores to the same slot before and after them.
+static void pingPongLoop(scf::ForOp forOp, int numWarps, int threadsPerWarp) {
+  SmallVector<triton::DotOp> dots;
+  for (Operation &op : forOp.getBody()->without_terminator())
+    if (auto dot = dyn_cast<triton::DotOp>(op))
+      dots.push_back(dot);
+  for (triton::DotOp dot : dots) {
+    // Bring the local_loads of the operands, and the subviews they read, next
+    // to the dot so that they run between the same barriers.
+    Operation *first = dot;
+    for (Value operand : dot->getOperands()) {
+      auto localLoad = operand.getDefiningOp<ttg::LocalLoadOp>();
+      if (!localLoad || localLoad->getBlock() != dot->getBlock())
+        continue;
+      localLoad->moveBefore(dot);
+      if (first == dot)
+        first = localLoad;
+      auto subview =
+          localLoad.getSrc().getDefiningOp<ttg::MemDescSubviewOp>();
+      if (subview && subview->getBlock() == dot->getBlock() &&
+          subview->hasOneUse()) {
+        subview->moveBefore(localLoad);
+        if (first == localLoad)
+          first = subview;
+      }
+    }
+
+    Location loc = dot.getLoc();
+    OpBuilder builder(first);
+    builder.create<gpu::BarrierOp>(loc);
+    createSetPrio(builder, loc, 1);
+    builder.setInsertionPointAfter(dot);
+    createSetPrio(builder, loc, 0);
+    builder.create<gpu::BarrierOp>(loc);
+  }
+
+  Location loc = forOp.getLoc();
+  OpBuilder builder(forOp);
+  Type i32Ty = builder.getI32Type();
+  Value tid = builder.create<arith::IndexCastOp>(
+      loc, i32Ty, builder.create<gpu::ThreadIdOp>(loc, gpu::Dimension::x));
+  Value warpId = builder.create<arith::DivUIOp>(
+      loc, tid, builder.create<arith::ConstantIntOp>(loc, threadsPerWarp, 32));
+  // Read the warp id from the first lane so that the branches around the
+  // barriers are uniform.
+  warpId = builder
+               .create<LLVM::CallIntrinsicOp>(
+                   loc, i32Ty,
+                   builder.getStringAttr("llvm.amdgcn.readfirstlane"), warpId)
+               ->getResult(0);
+  Value halfNumWarps =
+      builder.create<arith::ConstantIntOp>(loc, numWarps / 2, 32);
+  Value isUpperHalf = builder.create<arith::CmpIOp>(
+      loc, arith::CmpIPredicate::uge, warpId, halfNumWarps);
+  Value isLowerHalf = builder.create<arith::CmpIOp>(
+      loc, arith::CmpIPredicate::ult, warpId, halfNumWarps);
+  // Wait for the prologue of all the waves before shifting the halves.
+  builder.create<gpu::BarrierOp>(loc);
+  createBarrierIf(builder, loc, isUpperHalf);
+  builder.setInsertionPointAfter(forOp);
+  createBarrierIf(builder, loc, isLowerHalf);
+  builder.create<gpu::BarrierOp>(loc);
+}
+
 // Stream Pipeline
 struct PipelinePass : public TritonAMDGPUStreamPipelineBase<PipelinePass> {
   PipelinePass() = default;
+  PipelinePass(int numStages, bool pingPong) {
+    this->numStages = numStages;
+    this->pingPong = pingPong;
+  }
 
   void runOnOperation() override {
+    if (numStages > 1) {
+      ModuleOp mod = getOperation();
+      int numWarps = ttg::TritonGPUDialect::getNumWarps(mod);
+      int threadsPerWarp = ttg::TritonGPUDialect::getThreadsPerWarp(mod);
+      // Ping-pong needs two waves per SIMD, one of each half.
+      bool canShiftWaves = pingPong && numStages >= 4 && numWarps >= 8;
+      SmallVector<scf::ForOp> loops;
+      mod->walk([&](scf::ForOp forOp) { loops.push_back(forOp); });
+      for (scf::ForOp forOp : loops) {
+        FailureOr<scf::ForOp> newForOp = multiBufferLoop(forOp, numStages);
+        if (succeeded(newForOp) && canShiftWaves && canPingPong(*newForOp))
+          pingPongLoop(*newForOp, numWarps, threadsPerWarp);
+      }
+      return;
+    }
+
     // Pre-processing
     // we make sure element-wise ops are done *after* the conversion
     // to dot operands
@@ -856,6 +1187,7 @@ struct PipelinePass : public TritonAMDGPUStreamPipelineBase<PipelinePass> {
 };
 } // anonymous namespace
 
-std::unique_ptr<Pass> mlir::createTritonAMDGPUStreamPipelinePass() {
-  return std::make_unique<PipelinePass>();
+std::unique_ptr<Pass>
+mlir::createTritonAMDGPUStreamPipelinePass(int numStages, bool pingPong) {
+  return std::make_unique<PipelinePass>(numStages, pingPong);
 }
@@ -443,10 +443,13 @@ void inplace_rref_small(uint64_t *matrix, uint64_t rows, uint64_t cols) {
         uint64_t m = matrix[r];
         uint64_t ml = m & (-m);
 
+        // OpenAI change: The pivot row is eliminated from the rows that have
+        // its leading bit without branches, so that the loop vectorises, and
+        // restored after.
         for (uint64_t s = 0; s < rows; s++) {
-            if (s == r) { continue; }
-            if (matrix[s] & ml) { matrix[s] ^= m; }
+            matrix[s] ^= m & (0 - (uint64_t) ((matrix[s] & ml) != 0));
         }
+        matrix[r] = m;
 
         next_b = (b << 1) + 1;
         if (b == final_b) { break; }
@@ -464,11 +467,17 @@ void inplace_rref_strided(uint64_t *matrix, uint64_t rows, uint64_t cols, uint64
         return;
     }
 
-    if ((rows <= 64) && (cols <= 64)) {
-        uint64_t matrix2[64];
+    if (cols <= 64) {
+        // OpenAI change: Matrices of a single strip are reduced by the small
+        // algorithm whatever their number of rows, rather than by Kronrod's
+        // with its lookup tables of a few hundred kilobytes, which dominated
+        // the reduction of the tall matrices of LinearLayout::invertAndCompose.
+        uint64_t buffer[256];
+        uint64_t* matrix2 = (rows <= 256) ? buffer : ((uint64_t*) malloc(rows * 8));
         for (uint64_t i = 0; i < rows; i++) { matrix2[i] = matrix[i * stride]; }
         inplace_rref_small(matrix2, rows, cols);
         for (uint64_t i = 0; i < rows; i++) { matrix[i * stride] = matrix2[i]; }
+        if (matrix2 != buffer) { free(matrix2); }
     } else {
         // Select value of k to minimise the objective function:
         // ceil(64/k) * (rows + 2^(k/2))
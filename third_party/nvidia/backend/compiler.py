@@ -11,6 +11,8 @@ import signal
 import os
 import subprocess
 from pathlib import Path
+import ctypes
+import ctypes.util
 
 
 @functools.lru_cache()
@@ -37,6 +39,109 @@ def get_ptxas_version():
 
 
 @functools.lru_cache()
+def _nvjitlink():
+    """
+    Load the nvJitLink library, which runs ptxas in process, or return None
+    if it cannot be found.
+    """
+    paths = [
+        os.environ.get("TRITON_LIBNVJITLINK_PATH", ""),
+        os.path.join(os.path.dirname(__file__), "lib", "libnvJitLink.so"),
+        ctypes.util.find_library("nvJitLink") or "",
+    ]
+    for path in paths:
+        if not path:
+            continue
+        try:
+            return ctypes.CDLL(path)
+        except OSError:
+            continue
+    return None
+
+
+@functools.lru_cache()
+def _nvjitlink_version():
+    major, minor = ctypes.c_uint(), ctypes.c_uint()
+    _nvjitlink().nvJitLinkVersion(ctypes.byref(major), ctypes.byref(minor))
+    return f'{major.value}.{minor.value}'
+
+
+def _nvjitlink_function(name):
+    # nvJitLink.h maps its API to symbols versioned by the release of the
+    # library, e.g. __nvJitLinkCreate_12_4, besides the unversioned ones.
+    lib = _nvjitlink()
+    try:
+        return getattr(lib, name)
+    except AttributeError:
+        major, minor = _nvjitlink_version().split('.')
+        return getattr(lib, f'__{name}_{major}_{minor}')
+
+
+_NVJITLINK_INPUT_PTX = 2
+
+
+def _compile_ptx_in_process(src, arch, ptxas_options):
+    """
+    Compile `src` to a cubin for `arch` with nvJitLink, without the temporary
+    files and the process of ptxas. TRITON_PTXAS_THREADS sets the number of
+    threads compiling the functions of the module in parallel.
+    """
+    options = [f'-arch={arch}']
+    for o in ptxas_options:
+        options.append(o if o == '-lineinfo' else f'-Xptxas={o}')
+    threads = os.environ.get("TRITON_PTXAS_THREADS", "1")
+    if threads != "1":
+        options.append(f'-split-compile={threads}')
+    c_options = (ctypes.c_char_p * len(options))(*[o.encode() for o in options])
+    handle = ctypes.c_void_p()
+
+    def check(result, what):
+        if result == 0:
+            return
+        size = ctypes.c_size_t()
+        log = b''
+        if handle and _nvjitlink_function("nvJitLinkGetErrorLogSize")(handle, ctypes.byref(size)) == 0:
+            buf = ctypes.create_string_buffer(size.value)
+            _nvjitlink_function("nvJitLinkGetErrorLog")(handle, buf)
+            log = buf.value
+        raise RuntimeError(f'`{what}` failed with error code {result}: \n{log.decode(errors="replace")}')
+
+    check(_nvjitlink_function("nvJitLinkCreate")(ctypes.byref(handle), len(options), c_options), "nvJitLinkCreate")
+    try:
+        data = src.encode()
+        check(
+            _nvjitlink_function("nvJitLinkAddData")(handle, _NVJITLINK_INPUT_PTX, data, len(data), b"triton.ptx"),
+            "nvJitLinkAddData")
+        check(_nvjitlink_function("nvJitLinkComplete")(handle), "nvJitLinkComplete")
+        size = ctypes.c_size_t()
+        check(_nvjitlink_function("nvJitLinkGetLinkedCubinSize")(handle, ctypes.byref(size)),
+              "nvJitLinkGetLinkedCubinSize")
+        cubin = ctypes.create_string_buffer(size.value)
+        check(_nvjitlink_function("nvJitLinkGetLinkedCubin")(handle, cubin), "nvJitLinkGetLinkedCubin")
+        return cubin.raw
+    finally:
+        _nvjitlink_function("nvJitLinkDestroy")(ctypes.byref(handle))
+
+
+@functools.lru_cache()
+def _parse_ptxas_info(log, name):
+    """
+    Returns the registers, spill stores and loads and stack frame size in bytes of the entry function `name`
+    reported by `ptxas -v` in `log`, by metadata key.
+    """
+    entry = log.find(f"Compiling entry function '{name}'")
+    if entry < 0:
+        return {}
+    info = {}
+    properties = re.search(r"(\d+) bytes stack frame, (\d+) bytes spill stores, (\d+) bytes spill loads", log[entry:])
+    if properties is not None:
+        info["stack_frame"], info["spill_stores"], info["spill_loads"] = map(int, properties.groups())
+    registers = re.search(r"Used (\d+) registers", log[entry:])
+    if registers is not None:
+        info["registers"] = int(registers.group(1))
+    return info
+
+
 def ptx_get_version(cuda_version) -> int:
     '''
     Get the highest PTX version supported by the current CUDA driver.
@@ -63,18 +168,54 @@ class CUDAOptions:
     num_warps: int = 4
     num_ctas: int = 1
     num_stages: int = 3
+    # num_dot_iterations_in_flight is the number of iterations of a pipelined
+    # loop whose wgmma dots can be in flight, each taking one more buffer of
+    # the loads feeding them.  Deeper pipelines help long K-loops and dots with
+    # operands in registers, e.g. fp8 GEMMs.
+    num_dot_iterations_in_flight: int = 2
     # maxnreg corresponds to the ptx parameter .maxnreg, which controls the
     # maximum number of 32-bit registers used by one thread.
     maxnreg: Optional[int] = None
+    # estimate_spills makes compilation fail with OutOfResources before
+    # generating PTX when the registers estimated live per thread in TTGIR
+    # exceed what the hardware provides, i.e. when the kernel is sure to spill.
+    estimate_spills: bool = False
     cluster_dims: tuple = (1, 1, 1)
+    # launch_pdl launches the kernel with programmatic dependent launch, so that
+    # it can start while the previous kernel in the stream is finishing.  The
+    # kernel must call tl.extra.cuda.gdc_wait() before reading the results of
+    # the previous kernel.  Requires sm_90.
+    launch_pdl: bool = False
+    # launch_cooperative launches all the programs of the kernel at once, so that they can wait for each other in
+    # tl.grid_barrier().  The grid must not exceed CompiledKernel.max_cooperative_programs().
+    launch_cooperative: bool = False
+    # rasterization remaps the x and y program ids so that the programs running at once share their operands in the
+    # L2 cache, e.g. for GEMMs: "grouped" walks groups of raster_group_size consecutive x ids along y, like
+    # tl.swizzle2d, and "morton" and "hilbert" visit the squares of raster_group_size x raster_group_size programs of
+    # the groups along these curves.  "" keeps the launch order.
+    rasterization: str = ""
+    raster_group_size: int = 8
     ptx_version: int = None
     enable_fp_fusion: bool = True
+    # fast_math lowers the f32 exp2, log, log2, sin, cos, sqrt, rsqrt and divisions to the approximate PTX
+    # instructions (e.g., lg2.approx.f32, div.approx.f32) and lets LLVM reassociate and contract floating-point
+    # ops.  Infinities and NaNs are preserved.  tl.math.div_rn, tl.math.sqrt_rn and the functions of
+    # tl.extra.cuda.libdevice keep their precision, e.g. to opt a single op out.
+    fast_math: bool = False
+    # device_log > 0 lowers device_print and device_assert to appending records to a ring buffer of this many
+    # records in the kernel, instead of calling vprintf and __assertfail, and failing asserts don't stop the kernel.
+    # The host decodes the buffer after the kernel completes, see triton.runtime.device_log.
+    device_log: int = 0
     allow_fp8e4nv: bool = False
     allow_fp8e4b15: bool = False
     default_dot_input_precision: str = "tf32"
-    allowed_dot_input_precisions: Tuple[str] = ("tf32", "tf32x3", "ieee")
+    allowed_dot_input_precisions: Tuple[str] = ("tf32", "tf32x3", "ieee", "bf16x3", "bf16x6")
     max_num_imprecise_acc_default: bool = None
     extern_libs: dict = None
+    # llvm_pipeline selects the LLVM optimizations: "" for the O3 pipeline, "triton" for the passes of O3 that matter
+    # for the IR generated by Triton, without the loop unrolling and vectorization passes, which cuts the time of the
+    # LLVM stage, or a textual pipeline of the new pass manager, e.g. "function(instcombine,gvn)".
+    llvm_pipeline: str = ""
     debug: bool = False
     backend_name: str = 'cuda'
 
@@ -86,6 +227,7 @@ class CUDAOptions:
         object.__setattr__(self, 'extern_libs', tuple(extern_libs.items()))
         assert self.num_warps > 0 and (self.num_warps & (self.num_warps - 1)) == 0, \
                "num_warps must be a power of 2"
+        assert self.num_dot_iterations_in_flight >= 1, "num_dot_iterations_in_flight must be at least 1"
 
     def hash(self):
         hash_dict = dict(self.__dict__)
@@ -113,6 +255,8 @@ class CUDABackend(BaseBackend):
         if not "enable_fp_fusion" in args:
             args["enable_fp_fusion"] = os.getenv("TRITON_DEFAULT_FP_FUSION", "1") == "1"
         args["max_num_imprecise_acc_default"] = 2**30 if self.capability == 90 else 0
+        # Programmatic dependent launch needs sm_90; elsewhere kernels simply run one after the other.
+        args["launch_pdl"] = args.get("launch_pdl", False) and self.capability >= 90
         return CUDAOptions(**args)
 
     def pack_metadata(self, metadata):
@@ -123,6 +267,9 @@ class CUDABackend(BaseBackend):
             metadata.cluster_dims[0],
             metadata.cluster_dims[1],
             metadata.cluster_dims[2],
+            metadata.launch_pdl,
+            metadata.global_scratch_size,
+            metadata.launch_cooperative,
         )
 
     def get_codegen_implementation(self):
@@ -142,7 +289,13 @@ class CUDABackend(BaseBackend):
         pm.enable_debug()
         passes.common.add_inliner(pm)
         passes.ttir.add_rewrite_tensor_pointer(pm)
+        if opt.rasterization:
+            passes.ttir.add_rasterize_program_ids(pm, opt.rasterization, opt.raster_group_size)
         passes.ttir.add_combine(pm)
+        passes.ttir.add_loop_unroll(pm)
+        passes.ttir.add_fold_masks(pm)
+        passes.ttir.add_narrow_pointer_offsets(pm)
+        passes.ttir.add_decompose_scaled_dot(pm)
         passes.common.add_canonicalizer(pm)
         passes.ttir.add_reorder_broadcast(pm)
         passes.common.add_cse(pm)
@@ -166,35 +319,19 @@ class CUDABackend(BaseBackend):
         # TTIR -> TTGIR
         pm = ir.pass_manager(mod.context)
         pm.enable_debug()
-        passes.ttir.add_convert_to_ttgpuir(pm, f"cuda:{capability}", opt.num_warps, 32, opt.num_ctas)
-        # optimize TTGIR
-        passes.ttgpuir.add_coalesce(pm)
-        if capability // 10 >= 8:
-            passes.ttgpuir.add_f32_dot_tc(pm)
-        # TODO(Qingyi): Move PlanCTAPass to the front of CoalescePass
-        nvidia.passes.ttnvgpuir.add_plan_cta(pm, cluster_info)
-        passes.ttgpuir.add_remove_layout_conversions(pm)
-        passes.ttgpuir.add_optimize_thread_locality(pm)
-        passes.ttgpuir.add_accelerate_matmul(pm)
-        passes.ttgpuir.add_remove_layout_conversions(pm)
-        passes.ttgpuir.add_optimize_dot_operands(pm, capability >= 80)
-        passes.common.add_cse(pm)
-        if capability // 10 >= 8:
-            passes.ttgpuir.add_combine_tensor_select_and_if(pm)
-            passes.ttgpuir.add_pipeline(pm, opt.num_stages)
-        passes.ttgpuir.add_prefetch(pm)
-        passes.ttgpuir.add_optimize_dot_operands(pm, capability >= 80)
-        passes.ttgpuir.add_remove_layout_conversions(pm)
-        passes.ttgpuir.add_reduce_data_duplication(pm)
-        passes.ttgpuir.add_reorder_instructions(pm)
-        passes.common.add_cse(pm)
-        passes.common.add_symbol_dce(pm)
-        if capability // 10 >= 9:
-            nvidia.passes.ttnvgpuir.add_fence_insertion(pm)
-            nvidia.passes.ttnvgpuir.add_tma_lowering(pm)
-        passes.common.add_canonicalizer(pm)
+        # The passes are listed in lib/Dialect/TritonNvidiaGPU/Transforms/Pipelines.cpp, which also registers them
+        # in triton-opt as triton-cuda-ttgir-pipeline.
+        nvidia.passes.ttgpuir.add_ttgir_pipeline(pm, capability, opt.num_warps, opt.num_ctas, opt.num_stages,
+                                                 opt.num_dot_iterations_in_flight, cluster_info)
         pm.run(mod)
         metadata["cluster_dims"] = (cluster_info.clusterDimX, cluster_info.clusterDimY, cluster_info.clusterDimZ)
+        metadata["estimated_registers"] = mod.estimate_registers()
+        if opt.estimate_spills:
+            # 64K registers per multiprocessor, at most 255 per thread.
+            limit = min(opt.maxnreg or 255, 64 * 1024 // (opt.num_warps * 32))
+            if metadata["estimated_registers"] > limit:
+                from triton.runtime.errors import OutOfResources
+                raise OutOfResources(metadata["estimated_registers"], limit, "registers (estimated)")
         return mod
 
     @staticmethod
@@ -204,6 +341,11 @@ class CUDABackend(BaseBackend):
         if num_warp_groups is not None:
             metadata["num_warps"] *= num_warp_groups
         mod = src
+        # Set up Diagnostic
+        if os.environ.get("MLIR_ENABLE_REMARK", "0") == "1":
+            srcMgr = llvm.source_mgr()
+            diag = ir.source_mgr_diag(srcMgr, mod.context)
+            mod.context.printOpOnDiagnostic(True)
         # TritonGPU -> LLVM-IR (MLIR)
         pm = ir.pass_manager(mod.context)
         pm.enable_debug()
@@ -211,8 +353,11 @@ class CUDABackend(BaseBackend):
         passes.ttgpuir.add_combine_tensor_select_and_if(pm)
         passes.convert.add_scf_to_cf(pm)
         passes.convert.add_index_to_llvmir(pm)
+        if capability // 10 >= 10:
+            nvidia.passes.ttnvgpuir.add_tensor_memory_allocation(pm)
         passes.ttgpuir.add_allocate_shared_memory(pm)
-        nvidia.passes.ttgpuir.add_to_llvmir(pm, capability)
+        passes.ttgpuir.add_allocate_global_scratch_memory(pm)
+        nvidia.passes.ttgpuir.add_to_llvmir(pm, capability, options.fast_math, options.device_log)
         nvidia.passes.ttnvgpuir.add_nvgpu_to_llvm(pm)
         passes.convert.add_arith_to_llvmir(pm)
         passes.common.add_canonicalizer(pm)
@@ -237,10 +382,13 @@ class CUDABackend(BaseBackend):
             paths = [path for (name, path) in options.extern_libs]
             llvm.link_extern_libs(llvm_mod, paths)
 
-        llvm.optimize_module(llvm_mod, llvm.OPTIMIZE_O3)
+        llvm.optimize_module(llvm_mod, llvm.OPTIMIZE_O3, pipeline=options.llvm_pipeline)
 
         # Get some metadata
         metadata["shared"] = src.get_int_attr("triton_gpu.shared")
+        metadata["global_scratch_size"] = src.get_int_attr("triton_gpu.global_scratch_memory_size")
+        metadata["vectorization"] = src.get_str_array_attr("triton_gpu.vectorization") or []
+        metadata["device_log_sites"] = src.get_str_array_attr("triton_gpu.device_log_sites") or []
         ret = str(llvm_mod)
         del llvm_mod
         del context
@@ -261,7 +409,9 @@ class CUDABackend(BaseBackend):
         llvm_ptx_version = min(83, ptx_version)
 
         triple = 'nvptx64-nvidia-cuda'
-        proc = 'sm_90a' if capability == 90 else f'sm_{capability}'
+        # The architecture specific features of sm_100a, like tcgen05, are emitted as inline assembly, so LLVM can
+        # target sm_90a, the newest one it knows, and the version of the target is patched below.
+        proc = 'sm_90a' if capability >= 90 else f'sm_{capability}'
         features = f'+ptx{llvm_ptx_version}'
         ret = llvm.translate_to_asm(src, triple, proc, features, ['nvptx-short-ptr'], opt.enable_fp_fusion, False)
         # Find kernel names (there should only be one)
@@ -271,6 +421,8 @@ class CUDABackend(BaseBackend):
         # post-process
         ptx_version = f'{ptx_version//10}.{ptx_version%10}'
         ret = re.sub(r'\.version \d+\.\d+', f'.version {ptx_version}', ret, flags=re.MULTILINE)
+        if capability > 90:
+            ret = re.sub(r'\.target sm_90a', f'.target sm_{capability}a', ret, flags=re.MULTILINE)
         # Remove the debug flag that prevents ptxas from optimizing the code
         ret = re.sub(r",\s*debug|debug,\s*", "", ret)
         if os.environ.get("NVPTX_ENABLE_DUMP", "0") == "1":
@@ -280,6 +432,17 @@ class CUDABackend(BaseBackend):
 
     @staticmethod
     def make_cubin(src, metadata, opt, capability):
+        suffix = 'a' if capability >= 90 else ''
+        ptxas_options = []
+        if not os.environ.get('TRITON_DISABLE_LINE_INFO'):
+            ptxas_options.append('-lineinfo')
+        if not opt.enable_fp_fusion:
+            ptxas_options.append('--fmad=false')
+        if os.environ.get("DISABLE_PTXAS_OPT", "0") == "1":
+            ptxas_options.append('--opt-level=0')
+        if os.environ.get("TRITON_PTXAS_IN_PROCESS", "0") == "1" and _nvjitlink() is not None:
+            return _compile_ptx_in_process(src, f'sm_{capability}{suffix}', ptxas_options)
+
         ptxas, _ = _path_to_binary("ptxas")
         with tempfile.NamedTemporaryFile(delete=False, mode='w', suffix='.ptx') as fsrc, \
             tempfile.NamedTemporaryFile(delete=False, mode='r', suffix='.log') as flog:
@@ -287,16 +450,14 @@ class CUDABackend(BaseBackend):
             fsrc.flush()
             fbin = fsrc.name + '.o'
 
-            line_info = '' if os.environ.get('TRITON_DISABLE_LINE_INFO') else ' -lineinfo'
-            fmad = '' if opt.enable_fp_fusion else ' --fmad=false'
-            suffix = 'a ' if capability == 90 else ' '
-            if os.environ.get("DISABLE_PTXAS_OPT", "0") == "1":
-                cmd = f'{ptxas}{line_info}{fmad} -v --opt-level 0 --gpu-name=sm_{capability}{suffix}{fsrc.name} -o {fbin} 2> {flog.name}'
-            else:
-                cmd = f'{ptxas}{line_info}{fmad} -v --gpu-name=sm_{capability}{suffix}{fsrc.name} -o {fbin} 2> {flog.name}'
+            options = ''.join(f' {o}' for o in ptxas_options)
+            cmd = f'{ptxas}{options} -v --gpu-name=sm_{capability}{suffix} {fsrc.name} -o {fbin} 2> {flog.name}'
 
             try:
                 subprocess.run(cmd, shell=True, check=True)
+                # The static resource usage of the kernel, which `CompiledKernel.resource_report` reports.
+                with open(flog.name) as log_file:
+                    metadata.update(_parse_ptxas_info(log_file.read(), metadata["name"]))
             except subprocess.CalledProcessError as e:
                 with open(flog.name) as log_file:
                     log = log_file.read()
@@ -329,4 +490,6 @@ class CUDABackend(BaseBackend):
     @functools.lru_cache()
     def hash(self):
         version = get_ptxas_version()
+        if os.environ.get("TRITON_PTXAS_IN_PROCESS", "0") == "1" and _nvjitlink() is not None:
+            version = f'nvJitLink-{_nvjitlink_version()}'
         return f'{version}-{self.capability}'
@@ -55,6 +55,11 @@ static PyObject *getDeviceProperties(PyObject *self, PyObject *args) {
   int sm_clock_rate;
   int mem_clock_rate;
   int mem_bus_width;
+  int max_threads_per_sm;
+  int max_blocks_per_sm;
+  int max_regs_per_sm;
+  int max_shared_mem_per_sm;
+  int reserved_shared_mem;
   CUDA_CHECK_AND_RETURN_NULL(cuDeviceGetAttribute(
       &max_shared_mem, CU_DEVICE_ATTRIBUTE_MAX_SHARED_MEMORY_PER_BLOCK_OPTIN,
       device));
@@ -70,27 +75,137 @@ static PyObject *getDeviceProperties(PyObject *self, PyObject *args) {
       &mem_clock_rate, CU_DEVICE_ATTRIBUTE_MEMORY_CLOCK_RATE, device));
   CUDA_CHECK_AND_RETURN_NULL(cuDeviceGetAttribute(
       &mem_bus_width, CU_DEVICE_ATTRIBUTE_GLOBAL_MEMORY_BUS_WIDTH, device));
+  // The limits of the occupancy of a multiprocessor
+  CUDA_CHECK_AND_RETURN_NULL(cuDeviceGetAttribute(
+      &max_threads_per_sm, CU_DEVICE_ATTRIBUTE_MAX_THREADS_PER_MULTIPROCESSOR,
+      device));
+  CUDA_CHECK_AND_RETURN_NULL(cuDeviceGetAttribute(
+      &max_blocks_per_sm, CU_DEVICE_ATTRIBUTE_MAX_BLOCKS_PER_MULTIPROCESSOR,
+      device));
+  CUDA_CHECK_AND_RETURN_NULL(cuDeviceGetAttribute(
+      &max_regs_per_sm, CU_DEVICE_ATTRIBUTE_MAX_REGISTERS_PER_MULTIPROCESSOR,
+      device));
+  CUDA_CHECK_AND_RETURN_NULL(cuDeviceGetAttribute(
+      &max_shared_mem_per_sm,
+      CU_DEVICE_ATTRIBUTE_MAX_SHARED_MEMORY_PER_MULTIPROCESSOR, device));
+  CUDA_CHECK_AND_RETURN_NULL(cuDeviceGetAttribute(
+      &reserved_shared_mem,
+      CU_DEVICE_ATTRIBUTE_RESERVED_SHARED_MEMORY_PER_BLOCK, device));
+
+  return Py_BuildValue(
+      "{s:i, s:i, s:i, s:i, s:i, s:i, s:i, s:i, s:i, s:i, s:i, s:i}",
+      "max_shared_mem", max_shared_mem, "max_num_regs", max_num_regs,
+      "multiprocessor_count", multiprocessor_count, "warpSize", warp_size,
+      "sm_clock_rate", sm_clock_rate, "mem_clock_rate", mem_clock_rate,
+      "mem_bus_width", mem_bus_width, "max_threads_per_sm", max_threads_per_sm,
+      "max_blocks_per_sm", max_blocks_per_sm, "max_regs_per_sm",
+      max_regs_per_sm, "max_shared_mem_per_sm", max_shared_mem_per_sm,
+      "reserved_shared_mem", reserved_shared_mem);
+}
 
-  return Py_BuildValue("{s:i, s:i, s:i, s:i, s:i, s:i, s:i}", "max_shared_mem",
-                       max_shared_mem, "max_num_regs", max_num_regs,
-                       "multiprocessor_count", multiprocessor_count, "warpSize",
-                       warp_size, "sm_clock_rate", sm_clock_rate,
-                       "mem_clock_rate", mem_clock_rate, "mem_bus_width",
-                       mem_bus_width);
+// The context-independent loading of CUDA 12, resolved at runtime so that
+// older drivers keep loading modules.
+typedef CUresult (*cuLibraryLoadData_t)(
+    CUlibrary *library, const void *code, CUjit_option *jitOptions,
+    void **jitOptionsValues, unsigned int numJitOptions,
+    CUlibraryOption *libraryOptions, void **libraryOptionValues,
+    unsigned int numLibraryOptions);
+typedef CUresult (*cuLibraryGetKernel_t)(CUkernel *pKernel, CUlibrary library,
+                                         const char *name);
+typedef CUresult (*cuKernelGetFunction_t)(CUfunction *pFunc, CUkernel kernel);
+
+static cuLibraryLoadData_t cuLibraryLoadDataHandle = NULL;
+static cuLibraryGetKernel_t cuLibraryGetKernelHandle = NULL;
+static cuKernelGetFunction_t cuKernelGetFunctionHandle = NULL;
+
+static bool initLibraryApi() {
+  static bool initialized = false;
+  if (!initialized) {
+    initialized = true;
+    void *libHandle = dlopen("libcuda.so.1", RTLD_LAZY);
+    if (libHandle) {
+      cuLibraryLoadDataHandle =
+          (cuLibraryLoadData_t)dlsym(libHandle, "cuLibraryLoadData");
+      cuLibraryGetKernelHandle =
+          (cuLibraryGetKernel_t)dlsym(libHandle, "cuLibraryGetKernel");
+      cuKernelGetFunctionHandle =
+          (cuKernelGetFunction_t)dlsym(libHandle, "cuKernelGetFunction");
+    }
+  }
+  return cuLibraryLoadDataHandle && cuLibraryGetKernelHandle &&
+         cuKernelGetFunctionHandle;
 }
 
-static PyObject *loadBinary(PyObject *self, PyObject *args) {
-  const char *name;
-  const char *data;
-  Py_ssize_t data_size;
-  int shared;
-  int device;
-  if (!PyArg_ParseTuple(args, "ss#ii", &name, &data, &data_size, &shared,
-                        &device)) {
-    return NULL;
+static PyObject *hasLibraryApi(PyObject *self, PyObject *args) {
+  return PyBool_FromLong(initLibraryApi());
+}
+
+// Loads the binary as a module of the current context, or, when `kernel` is
+// a kernel of a library loaded by `load_library`, resolves its function in the
+// current context.
+// Sets the preferred split of the unified L1 and shared memory of the
+// multiprocessors of `device` for `fun` to just enough shared memory for
+// `occupancy` resident CTAs with `shared` bytes of dynamic shared memory each,
+// leaving the rest to L1.  When `occupancy` is 0, it is the number of CTAs the
+// threads and registers of the kernel allow.  The carveout, in percent of the
+// maximum shared memory, is returned in `carveout`; the driver rounds it up to
+// a supported split.
+static CUresult setSharedCarveout(CUfunction fun, int shared, int occupancy,
+                                  CUdevice device, int *carveout) {
+  int num_threads, num_regs, shared_static;
+  int max_threads, max_regs, max_blocks, max_shared, reserved_shared;
+  CUresult err;
+  if ((err = cuFuncGetAttribute(&num_threads,
+                                CU_FUNC_ATTRIBUTE_MAX_THREADS_PER_BLOCK,
+                                fun)) != CUDA_SUCCESS ||
+      (err = cuFuncGetAttribute(&num_regs, CU_FUNC_ATTRIBUTE_NUM_REGS, fun)) !=
+          CUDA_SUCCESS ||
+      (err = cuFuncGetAttribute(&shared_static,
+                                CU_FUNC_ATTRIBUTE_SHARED_SIZE_BYTES, fun)) !=
+          CUDA_SUCCESS ||
+      (err = cuDeviceGetAttribute(
+           &max_threads, CU_DEVICE_ATTRIBUTE_MAX_THREADS_PER_MULTIPROCESSOR,
+           device)) != CUDA_SUCCESS ||
+      (err = cuDeviceGetAttribute(
+           &max_regs, CU_DEVICE_ATTRIBUTE_MAX_REGISTERS_PER_MULTIPROCESSOR,
+           device)) != CUDA_SUCCESS ||
+      (err = cuDeviceGetAttribute(
+           &max_blocks, CU_DEVICE_ATTRIBUTE_MAX_BLOCKS_PER_MULTIPROCESSOR,
+           device)) != CUDA_SUCCESS ||
+      (err = cuDeviceGetAttribute(
+           &max_shared,
+           CU_DEVICE_ATTRIBUTE_MAX_SHARED_MEMORY_PER_MULTIPROCESSOR, device)) !=
+          CUDA_SUCCESS ||
+      (err = cuDeviceGetAttribute(
+           &reserved_shared,
+           CU_DEVICE_ATTRIBUTE_RESERVED_SHARED_MEMORY_PER_BLOCK, device)) !=
+          CUDA_SUCCESS)
+    return err;
+  if (occupancy <= 0) {
+    // The number of threads of Triton kernels is their maxntid.  Registers are
+    // allocated to threads by 8.
+    occupancy = max_blocks;
+    if (num_threads > 0 && max_threads / num_threads < occupancy)
+      occupancy = max_threads / num_threads;
+    int regs_per_block = (num_regs + 7) / 8 * 8 * num_threads;
+    if (regs_per_block > 0 && max_regs / regs_per_block < occupancy)
+      occupancy = max_regs / regs_per_block;
+    if (occupancy < 1)
+      occupancy = 1;
   }
+  long long needed =
+      (long long)occupancy * (shared + shared_static + reserved_shared);
+  *carveout = needed >= max_shared
+                  ? 100
+                  : (int)((needed * 100 + max_shared - 1) / max_shared);
+  return cuFuncSetAttribute(
+      fun, CU_FUNC_ATTRIBUTE_PREFERRED_SHARED_MEMORY_CARVEOUT, *carveout);
+}
+
+static PyObject *loadBinaryData(const char *name, const char *data,
+                                int shared, int device, CUkernel kernel) {
   CUfunction fun;
-  CUmodule mod;
+  CUmodule mod = 0;
   int32_t n_regs = 0;
   int32_t n_spills = 0;
   // create driver handles
@@ -104,9 +219,14 @@ static PyObject *loadBinary(PyObject *self, PyObject *args) {
     CUDA_CHECK_AND_RETURN_NULL_ALLOW_THREADS(cuCtxSetCurrent(pctx));
   }
 
-  CUDA_CHECK_AND_RETURN_NULL_ALLOW_THREADS(cuModuleLoadData(&mod, data));
-  CUDA_CHECK_AND_RETURN_NULL_ALLOW_THREADS(
-      cuModuleGetFunction(&fun, mod, name));
+  if (kernel) {
+    CUDA_CHECK_AND_RETURN_NULL_ALLOW_THREADS(
+        cuKernelGetFunctionHandle(&fun, kernel));
+  } else {
+    CUDA_CHECK_AND_RETURN_NULL_ALLOW_THREADS(cuModuleLoadData(&mod, data));
+    CUDA_CHECK_AND_RETURN_NULL_ALLOW_THREADS(
+        cuModuleGetFunction(&fun, mod, name));
+  }
   // get allocated registers and spilled registers from the function
   CUDA_CHECK_AND_RETURN_NULL_ALLOW_THREADS(
       cuFuncGetAttribute(&n_regs, CU_FUNC_ATTRIBUTE_NUM_REGS, fun));
@@ -119,18 +239,17 @@ static PyObject *loadBinary(PyObject *self, PyObject *args) {
       &shared_optin, CU_DEVICE_ATTRIBUTE_MAX_SHARED_MEMORY_PER_BLOCK_OPTIN,
       device));
   if (shared > 49152 && shared_optin > 49152) {
-    CUDA_CHECK_AND_RETURN_NULL_ALLOW_THREADS(
-        cuFuncSetCacheConfig(fun, CU_FUNC_CACHE_PREFER_SHARED));
-    int shared_total, shared_static;
-    CUDA_CHECK_AND_RETURN_NULL_ALLOW_THREADS(cuDeviceGetAttribute(
-        &shared_total, CU_DEVICE_ATTRIBUTE_MAX_SHARED_MEMORY_PER_MULTIPROCESSOR,
-        device));
+    int shared_static;
     CUDA_CHECK_AND_RETURN_NULL_ALLOW_THREADS(cuFuncGetAttribute(
         &shared_static, CU_FUNC_ATTRIBUTE_SHARED_SIZE_BYTES, fun));
     CUDA_CHECK_AND_RETURN_NULL_ALLOW_THREADS(
         cuFuncSetAttribute(fun, CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES,
                            shared_optin - shared_static));
   }
+  // leave the shared memory the kernel doesn't need to L1
+  int carveout;
+  CUDA_CHECK_AND_RETURN_NULL_ALLOW_THREADS(
+      setSharedCarveout(fun, shared, /*occupancy=*/0, device, &carveout));
   Py_END_ALLOW_THREADS;
 
   if (PyErr_Occurred()) {
@@ -140,6 +259,56 @@ static PyObject *loadBinary(PyObject *self, PyObject *args) {
                        n_spills);
 }
 
+// The binary is any bytes-like object, e.g. a view of a mapped kernel archive.
+static PyObject *loadBinary(PyObject *self, PyObject *args) {
+  const char *name;
+  Py_buffer data;
+  int shared;
+  int device;
+  CUkernel kernel = 0;
+  if (!PyArg_ParseTuple(args, "sy*ii|K", &name, &data, &shared, &device,
+                        &kernel)) {
+    return NULL;
+  }
+  if (kernel && !initLibraryApi()) {
+    PyBuffer_Release(&data);
+    PyErr_SetString(PyExc_RuntimeError,
+                    "The CUDA driver doesn't support libraries");
+    return NULL;
+  }
+  PyObject *result = loadBinaryData(name, (const char *)data.buf, shared,
+                                    device, kernel);
+  PyBuffer_Release(&data);
+  return result;
+}
+
+// Loads the binary once for all the contexts, and returns the handles of the
+// library and of its kernel `name`.
+static PyObject *loadLibrary(PyObject *self, PyObject *args) {
+  const char *name;
+  Py_buffer data;
+  if (!PyArg_ParseTuple(args, "sy*", &name, &data)) {
+    return NULL;
+  }
+  if (!initLibraryApi()) {
+    PyBuffer_Release(&data);
+    PyErr_SetString(PyExc_RuntimeError,
+                    "The CUDA driver doesn't support libraries");
+    return NULL;
+  }
+  CUlibrary library;
+  CUkernel kernel;
+  Py_BEGIN_ALLOW_THREADS;
+  CUresult err = cuLibraryLoadDataHandle(&library, data.buf, NULL, NULL, 0,
+                                         NULL, NULL, 0);
+  if (err == CUDA_SUCCESS)
+    err = cuLibraryGetKernelHandle(&kernel, library, name);
+  Py_END_ALLOW_THREADS;
+  PyBuffer_Release(&data);
+  CUDA_CHECK_AND_RETURN_NULL(err);
+  return Py_BuildValue("(KK)", (uint64_t)library, (uint64_t)kernel);
+}
+
 typedef CUresult (*cuOccupancyMaxActiveClusters_t)(
     int *numClusters, CUfunction func, const CUlaunchConfig *config);
 
@@ -264,8 +433,9 @@ static PyObject *fill1DTMADescriptor(PyObject *self, PyObject *args) {
   uint32_t tensorDim;
   int elementSize;
   unsigned long long desc_address;
-  if (!PyArg_ParseTuple(args, "KKiiK", &global_address, &dim, &tensorDim,
-                        &elementSize, &desc_address)) {
+  int dataType = -1;
+  if (!PyArg_ParseTuple(args, "KKiiK|i", &global_address, &dim, &tensorDim,
+                        &elementSize, &desc_address, &dataType)) {
     return NULL;
   }
   uint64_t dims[1] = {dim};
@@ -286,6 +456,9 @@ static PyObject *fill1DTMADescriptor(PyObject *self, PyObject *args) {
   default:
     PyErr_SetString(PyExc_ValueError, "elementSize must be 1, 2, or 4");
   }
+  // The data type matters to the reductions, which are typed by it.
+  if (dataType >= 0)
+    type = (CUtensorMapDataType)dataType;
   assert((elementSize * tensorDim) >= 32 && "block size too small.");
   int rank = 1;
   CUresult result = cuTensorMapEncodeTiled(
@@ -305,9 +478,10 @@ static PyObject *fill2DTMADescriptor(PyObject *self, PyObject *args) {
   uint32_t tensorDims[2];
   int elementSize;
   unsigned long long desc_address;
-  if (!PyArg_ParseTuple(args, "KKKiiiK", &global_address, &dims[1], &dims[0],
+  int dataType = -1;
+  if (!PyArg_ParseTuple(args, "KKKiiiK|i", &global_address, &dims[1], &dims[0],
                         &tensorDims[1], &tensorDims[0], &elementSize,
-                        &desc_address)) {
+                        &desc_address, &dataType)) {
     return NULL;
   }
   uint64_t globalStrides[2] = {dims[0] * elementSize,
@@ -327,6 +501,8 @@ static PyObject *fill2DTMADescriptor(PyObject *self, PyObject *args) {
   default:
     PyErr_SetString(PyExc_ValueError, "elementSize must be 1, 2, or 4");
   }
+  if (dataType >= 0)
+    type = (CUtensorMapDataType)dataType;
   int rank = 2;
   // Swizzling should be picked in codegen but since we need to set it on the
   // descriptor we rely on a convention between this function and codegen.
@@ -357,9 +533,215 @@ static PyObject *fill2DTMADescriptor(PyObject *self, PyObject *args) {
   return Py_None;
 }
 
+// Fills an im2col TMA descriptor of the contiguous tensor of shape `dims`,
+// given from the outermost dimension and whose innermost one is the channels,
+// e.g. NHWC.  The corners of the bounding box of the pixels are given per
+// spatial dimension, from the outermost one, and may be negative to pad the
+// tensor.
+static PyObject *fillIm2colTMADescriptor(PyObject *self, PyObject *args) {
+  unsigned long long global_address;
+  PyObject *dimsObj, *lowerCornerObj, *upperCornerObj;
+  uint32_t channelsPerPixel, pixelsPerColumn;
+  int elementSize;
+  unsigned long long desc_address;
+  if (!PyArg_ParseTuple(args, "KOOOIIiK", &global_address, &dimsObj,
+                        &lowerCornerObj, &upperCornerObj, &channelsPerPixel,
+                        &pixelsPerColumn, &elementSize, &desc_address)) {
+    return NULL;
+  }
+  Py_ssize_t rank = PySequence_Size(dimsObj);
+  if (rank < 3 || rank > 5) {
+    PyErr_SetString(PyExc_ValueError,
+                    "im2col descriptors must have 3 to 5 dimensions");
+    return NULL;
+  }
+  if (PySequence_Size(lowerCornerObj) != rank - 2 ||
+      PySequence_Size(upperCornerObj) != rank - 2) {
+    PyErr_SetString(PyExc_ValueError,
+                    "the corners of the bounding box must have a coordinate "
+                    "per spatial dimension");
+    return NULL;
+  }
+  // The driver takes the dimensions from the innermost one.
+  uint64_t dims[5];
+  int lowerCorner[3], upperCorner[3];
+  for (Py_ssize_t i = 0; i < rank; ++i) {
+    PyObject *dim = PySequence_GetItem(dimsObj, rank - 1 - i);
+    dims[i] = dim ? PyLong_AsUnsignedLongLong(dim) : 0;
+    Py_XDECREF(dim);
+  }
+  for (Py_ssize_t i = 0; i < rank - 2; ++i) {
+    PyObject *lower = PySequence_GetItem(lowerCornerObj, rank - 3 - i);
+    PyObject *upper = PySequence_GetItem(upperCornerObj, rank - 3 - i);
+    lowerCorner[i] = lower ? PyLong_AsLong(lower) : 0;
+    upperCorner[i] = upper ? PyLong_AsLong(upper) : 0;
+    Py_XDECREF(lower);
+    Py_XDECREF(upper);
+  }
+  if (PyErr_Occurred())
+    return NULL;
+  uint64_t globalStrides[4];
+  uint64_t stride = elementSize;
+  for (Py_ssize_t i = 0; i < rank - 1; ++i) {
+    stride *= dims[i];
+    globalStrides[i] = stride;
+  }
+  uint32_t elementStrides[5] = {1, 1, 1, 1, 1};
+  CUtensorMapDataType type;
+  switch (elementSize) {
+  case 1:
+    type = CU_TENSOR_MAP_DATA_TYPE_UINT8;
+    break;
+  case 2:
+    type = CU_TENSOR_MAP_DATA_TYPE_UINT16;
+    break;
+  case 4:
+    type = CU_TENSOR_MAP_DATA_TYPE_UINT32;
+    break;
+  default:
+    PyErr_SetString(PyExc_ValueError, "elementSize must be 1, 2, or 4");
+    return NULL;
+  }
+  // The same convention as for 2D descriptors, with the channels as the
+  // contiguous dimension of the block.
+  CUtensorMapSwizzle swizzle;
+  uint32_t contigDimSizeInByte = elementSize * channelsPerPixel;
+  if (contigDimSizeInByte >= 128) {
+    swizzle = CU_TENSOR_MAP_SWIZZLE_128B;
+  } else if (contigDimSizeInByte >= 64) {
+    swizzle = CU_TENSOR_MAP_SWIZZLE_64B;
+  } else if (contigDimSizeInByte >= 32) {
+    swizzle = CU_TENSOR_MAP_SWIZZLE_32B;
+  } else {
+    PyErr_SetString(PyExc_ValueError, "block size too small");
+    return NULL;
+  }
+  if (contigDimSizeInByte > 128) {
+    channelsPerPixel = 128 / elementSize;
+  }
+  CUDA_CHECK_AND_RETURN_NULL(cuTensorMapEncodeIm2col(
+      (CUtensorMap *)desc_address, type, rank, (void *)global_address, dims,
+      globalStrides, lowerCorner, upperCorner, channelsPerPixel,
+      pixelsPerColumn, elementStrides, CU_TENSOR_MAP_INTERLEAVE_NONE, swizzle,
+      CU_TENSOR_MAP_L2_PROMOTION_L2_128B, CU_TENSOR_MAP_FLOAT_OOB_FILL_NONE));
+  Py_RETURN_NONE;
+}
+
+static PyObject *graphCreate(PyObject *self, PyObject *args) {
+  CUgraph graph;
+  CUDA_CHECK_AND_RETURN_NULL(cuGraphCreate(&graph, 0));
+  return PyLong_FromUnsignedLongLong((uint64_t)graph);
+}
+
+static PyObject *graphInstantiate(PyObject *self, PyObject *args) {
+  unsigned long long graph;
+  if (!PyArg_ParseTuple(args, "K", &graph))
+    return NULL;
+  CUgraphExec graphExec;
+  Py_BEGIN_ALLOW_THREADS;
+  CUDA_CHECK_AND_RETURN_NULL_ALLOW_THREADS(
+      cuGraphInstantiate(&graphExec, (CUgraph)graph, 0));
+  Py_END_ALLOW_THREADS;
+  return PyLong_FromUnsignedLongLong((uint64_t)graphExec);
+}
+
+static PyObject *graphLaunch(PyObject *self, PyObject *args) {
+  unsigned long long graphExec;
+  unsigned long long stream;
+  if (!PyArg_ParseTuple(args, "KK", &graphExec, &stream))
+    return NULL;
+  Py_BEGIN_ALLOW_THREADS;
+  CUDA_CHECK_AND_RETURN_NULL_ALLOW_THREADS(
+      cuGraphLaunch((CUgraphExec)graphExec, (CUstream)stream));
+  Py_END_ALLOW_THREADS;
+  Py_RETURN_NONE;
+}
+
+static PyObject *graphDestroy(PyObject *self, PyObject *args) {
+  unsigned long long graph;
+  if (!PyArg_ParseTuple(args, "K", &graph))
+    return NULL;
+  CUDA_CHECK_AND_RETURN_NULL(cuGraphDestroy((CUgraph)graph));
+  Py_RETURN_NONE;
+}
+
+static PyObject *graphExecDestroy(PyObject *self, PyObject *args) {
+  unsigned long long graphExec;
+  if (!PyArg_ParseTuple(args, "K", &graphExec))
+    return NULL;
+  CUDA_CHECK_AND_RETURN_NULL(cuGraphExecDestroy((CUgraphExec)graphExec));
+  Py_RETURN_NONE;
+}
+
+// Returns the contents of the global `name` of the module, e.g. the device log
+// of a kernel, and zeroes it if `clear`.
+static PyObject *readGlobal(PyObject *self, PyObject *args) {
+  unsigned long long module;
+  const char *name;
+  int clear;
+  if (!PyArg_ParseTuple(args, "Ksp", &module, &name, &clear))
+    return NULL;
+  CUdeviceptr ptr;
+  size_t size;
+  CUDA_CHECK_AND_RETURN_NULL(
+      cuModuleGetGlobal(&ptr, &size, (CUmodule)module, name));
+  PyObject *data = PyBytes_FromStringAndSize(NULL, size);
+  if (!data)
+    return NULL;
+  char *buf = PyBytes_AS_STRING(data);
+  CUresult err;
+  Py_BEGIN_ALLOW_THREADS;
+  err = cuMemcpyDtoH(buf, ptr, size);
+  if (err == CUDA_SUCCESS && clear)
+    err = cuMemsetD8(ptr, 0, size);
+  Py_END_ALLOW_THREADS;
+  if (!gpuAssert(err, __FILE__, __LINE__)) {
+    Py_DECREF(data);
+    return NULL;
+  }
+  return data;
+}
+
+static PyObject *setSharedCarveoutPy(PyObject *self, PyObject *args) {
+  uint64_t fun;
+  int shared;
+  int occupancy = 0;
+  if (!PyArg_ParseTuple(args, "Ki|i", &fun, &shared, &occupancy))
+    return NULL;
+  int carveout;
+  Py_BEGIN_ALLOW_THREADS;
+  CUdevice device;
+  CUDA_CHECK_AND_RETURN_NULL_ALLOW_THREADS(cuCtxGetDevice(&device));
+  CUDA_CHECK_AND_RETURN_NULL_ALLOW_THREADS(setSharedCarveout(
+      (CUfunction)fun, shared, occupancy, device, &carveout));
+  Py_END_ALLOW_THREADS;
+  return PyLong_FromLong(carveout);
+}
+
+// Returns the number of blocks of `threads` threads and `shared` bytes of
+// dynamic shared memory of the function that can run at once on each
+// multiprocessor.
+static PyObject *maxActiveBlocks(PyObject *self, PyObject *args) {
+  uint64_t fun;
+  int threads, shared;
+  if (!PyArg_ParseTuple(args, "Kii", &fun, &threads, &shared))
+    return NULL;
+  int blocks;
+  Py_BEGIN_ALLOW_THREADS;
+  CUDA_CHECK_AND_RETURN_NULL_ALLOW_THREADS(
+      cuOccupancyMaxActiveBlocksPerMultiprocessor(&blocks, (CUfunction)fun,
+                                                  threads, shared));
+  Py_END_ALLOW_THREADS;
+  return PyLong_FromLong(blocks);
+}
+
 static PyMethodDef ModuleMethods[] = {
     {"load_binary", loadBinary, METH_VARARGS,
      "Load provided cubin into CUDA driver"},
+    {"load_library", loadLibrary, METH_VARARGS,
+     "Load provided cubin as a context-independent library"},
+    {"has_library_api", hasLibraryApi, METH_NOARGS,
+     "Whether the CUDA driver supports context-independent libraries"},
     {"get_device_properties", getDeviceProperties, METH_VARARGS,
      "Get the properties for a given device"},
     {"cuOccupancyMaxActiveClusters", occupancyMaxActiveClusters, METH_VARARGS,
@@ -372,6 +754,25 @@ static PyMethodDef ModuleMethods[] = {
      "that calls printf()."},
     {"fill_1d_tma_descriptor", fill1DTMADescriptor, METH_VARARGS, "doc"},
     {"fill_2d_tma_descriptor", fill2DTMADescriptor, METH_VARARGS, "doc"},
+    {"fill_im2col_tma_descriptor", fillIm2colTMADescriptor, METH_VARARGS,
+     "Fill an im2col TMA descriptor of a contiguous tensor, e.g. NHWC"},
+    {"graph_create", graphCreate, METH_VARARGS, "Create an empty CUDA graph"},
+    {"graph_instantiate", graphInstantiate, METH_VARARGS,
+     "Instantiate a CUDA graph into an executable graph"},
+    {"graph_launch", graphLaunch, METH_VARARGS,
+     "Launch an executable CUDA graph on a stream"},
+    {"graph_destroy", graphDestroy, METH_VARARGS, "Destroy a CUDA graph"},
+    {"graph_exec_destroy", graphExecDestroy, METH_VARARGS,
+     "Destroy an executable CUDA graph"},
+    {"read_global", readGlobal, METH_VARARGS,
+     "Read, and optionally zero, a global variable of a loaded module"},
+    {"set_shared_carveout", setSharedCarveoutPy, METH_VARARGS,
+     "Prefer, for a loaded function using the given dynamic shared memory, "
+     "just enough shared memory for the given number of resident CTAs per "
+     "multiprocessor, by default as many as its threads and registers allow, "
+     "and L1 for the rest; returns the carveout in percent"},
+    {"max_active_blocks", maxActiveBlocks, METH_VARARGS,
+     "Return the number of blocks of a function that fit on a multiprocessor"},
 
     {NULL, NULL, 0, NULL} // sentinel
 };
@@ -3,6 +3,7 @@ import os
 import hashlib
 import subprocess
 import tempfile
+import threading
 from pathlib import Path
 from triton.runtime.build import _build
 from triton.runtime.cache import get_cache_manager
@@ -78,12 +79,41 @@ class CudaUtils(object):
 
     def __init__(self):
         mod = compile_module_from_src(Path(os.path.join(dirname, "driver.c")).read_text(), "cuda_utils")
-        self.load_binary = mod.load_binary
+        self._load_binary = mod.load_binary
+        self._load_library = mod.load_library
+        self.has_library_api = mod.has_library_api()
+        # The (library, kernel) handles of the binaries loaded as libraries, by kernel name and binary digest
+        self._libraries = {}
+        self._libraries_lock = threading.Lock()
         self.get_device_properties = mod.get_device_properties
         self.cuOccupancyMaxActiveClusters = mod.cuOccupancyMaxActiveClusters
         self.set_printf_fifo_size = mod.set_printf_fifo_size
         self.fill_1d_tma_descriptor = mod.fill_1d_tma_descriptor
         self.fill_2d_tma_descriptor = mod.fill_2d_tma_descriptor
+        self.fill_im2col_tma_descriptor = mod.fill_im2col_tma_descriptor
+        self.graph_create = mod.graph_create
+        self.graph_instantiate = mod.graph_instantiate
+        self.graph_launch = mod.graph_launch
+        self.graph_destroy = mod.graph_destroy
+        self.graph_exec_destroy = mod.graph_exec_destroy
+        self.read_global = mod.read_global
+        self.set_shared_carveout = mod.set_shared_carveout
+        self.max_active_blocks = mod.max_active_blocks
+
+    def load_binary(self, name, kernel, shared, device):
+        """
+        Returns the (module, function, n_regs, n_spills) of the kernel `name` of the binary `kernel` in the current
+        context.  With the context-independent loading of CUDA 12, the binary is loaded once as a library for all
+        the devices, and only its function is resolved in each context; the module handle is then 0.
+        """
+        if not self.has_library_api or os.getenv("TRITON_CUDA_MODULE_LOAD", "0") == "1":
+            return self._load_binary(name, kernel, shared, device)
+        key = (name, hashlib.sha256(kernel).digest())
+        with self._libraries_lock:
+            library = self._libraries.get(key)
+            if library is None:
+                library = self._libraries[key] = self._load_library(name, kernel)
+        return self._load_binary(name, kernel, shared, device, library[1])
 
 
 # ------------------------
@@ -123,28 +153,110 @@ def make_launcher(constants, signature, ids):
             return "PyObject*"
         return ty_to_cpp(ty)
 
-    def format_of(ty):
+    # Converts the Python object `obj` to the C type of argument `ty`.  This
+    # replaces PyArg_ParseTuple, whose format string is parsed on every launch.
+    def convert(ty, obj):
         return {
-            "PyObject*": "O",
-            "float": "f",
-            "double": "d",
-            "long": "l",
-            "int8_t": "b",
-            "int16_t": "h",
-            "int32_t": "i",
-            "int64_t": "l",
-            "uint8_t": "B",
-            "uint16_t": "H",
-            "uint32_t": "I",
-            "uint64_t": "K",
+            "PyObject*": f"{obj}",
+            "float": f"(float)PyFloat_AsDouble({obj})",
+            "double": f"PyFloat_AsDouble({obj})",
+            "int8_t": f"(int8_t)PyLong_AsLong({obj})",
+            "int16_t": f"(int16_t)PyLong_AsLong({obj})",
+            "int32_t": f"(int32_t)PyLong_AsLong({obj})",
+            "int64_t": f"(int64_t)PyLong_AsLongLong({obj})",
+            "uint8_t": f"(uint8_t)PyLong_AsUnsignedLong({obj})",
+            "uint16_t": f"(uint16_t)PyLong_AsUnsignedLong({obj})",
+            "uint32_t": f"(uint32_t)PyLong_AsUnsignedLong({obj})",
+            "uint64_t": f"(uint64_t)PyLong_AsUnsignedLongLong({obj})",
         }[ty]
 
-    args_format = ''.join([format_of(_extracted_type(ty)) for ty in signature.values()])
-    format = "iiiKKOOOO" + args_format
-    args_list = ', ' + ', '.join(f"&_arg{i}" for i, ty in signature.items()) if len(signature) > 0 else ''
+    params = [i for i in signature.keys() if i not in constants]
+
+    # Reads the kernel metadata tuple from args[first] and the kernel arguments
+    # that follow it, resolving pointer arguments to device pointers.
+    def parse_kernel_args(first):
+        conversions = ' '.join(f"{_extracted_type(ty)} _arg{i} = {convert(_extracted_type(ty), f'args[{first + 1 + j}]')};"
+                               for j, (i, ty) in enumerate(signature.items()))
+        pointers = ' '.join(
+            f"static DevicePtrCache ptr_cache{i}; DevicePtrInfo ptr_info{i} = getPointer(_arg{i}, {i}, &ptr_cache{i}); if (!ptr_info{i}.valid) return NULL;"
+            for i, ty in signature.items()
+            if ty[0] == "*")
+        return f"""
+  PyObject *kernel_metadata = args[{first}];
+  {conversions}
+  if (PyErr_Occurred()) {{
+    return NULL;
+  }}
+  if (!PyTuple_Check(kernel_metadata) || PyTuple_GET_SIZE(kernel_metadata) != 9) {{
+    PyErr_SetString(PyExc_TypeError, "kernel_metadata must be a tuple");
+    return NULL;
+  }}
+  int num_warps = getInt(kernel_metadata, 0);
+  int num_ctas = getInt(kernel_metadata, 1);
+  int shared_memory = getInt(kernel_metadata, 2);
+  int clusterDimX = getInt(kernel_metadata, 3);
+  int clusterDimY = getInt(kernel_metadata, 4);
+  int clusterDimZ = getInt(kernel_metadata, 5);
+  int launch_pdl = getInt(kernel_metadata, 6);
+  int global_scratch_size = getInt(kernel_metadata, 7);
+  int launch_cooperative = getInt(kernel_metadata, 8);
+  if (PyErr_Occurred()) {{
+    return NULL;
+  }}
+  // raise exception asap
+  {pointers}
+"""
+
+    kernel_args = ', '.join(f"ptr_info{i}.dev_ptr" if ty[0] == "*" else f"_arg{i}" for i, ty in signature.items())
+    kernel_params = ', '.join(f"&ptr_info{i}.dev_ptr" if signature[i][0] == "*" else f"&_arg{i}" for i in params)
+
+    # Kernel node arguments: (graph or graph exec, dependency or node, gridX,
+    # gridY, gridZ, function, kernel_metadata, kernel args...).
+    num_node_args = 7
+    kernel_node_params = f"""
+  if (nargs != {num_node_args + len(signature)}) {{
+    PyErr_Format(PyExc_TypeError, "expected {num_node_args + len(signature)} arguments, got %zd", nargs);
+    return NULL;
+  }}
+  int gridX = (int)PyLong_AsLong(args[2]);
+  int gridY = (int)PyLong_AsLong(args[3]);
+  int gridZ = (int)PyLong_AsLong(args[4]);
+  uint64_t _function = PyLong_AsUnsignedLongLong(args[5]);
+  {parse_kernel_args(6)}
+  if (num_ctas != 1) {{
+    PyErr_SetString(PyExc_NotImplementedError, "Kernel graph nodes don't support clusters");
+    return NULL;
+  }}
+  if (gridX * gridY * gridZ == 0) {{
+    PyErr_SetString(PyExc_ValueError, "Kernel graph nodes need a non-empty grid");
+    return NULL;
+  }}
+  if (global_scratch_size > 0) {{
+    PyErr_SetString(PyExc_NotImplementedError, "Kernel graph nodes don't support global scratch memory");
+    return NULL;
+  }}
+  if (launch_cooperative) {{
+    PyErr_SetString(PyExc_NotImplementedError, "Kernel graph nodes don't support cooperative launches");
+    return NULL;
+  }}
+  // The driver copies the parameter values when the node is created or updated.
+  void *params[] = {{ {kernel_params} }};
+  CUDA_KERNEL_NODE_PARAMS node_params;
+  memset(&node_params, 0, sizeof(node_params));
+  node_params.func = (CUfunction)_function;
+  node_params.gridDimX = gridX;
+  node_params.gridDimY = gridY;
+  node_params.gridDimZ = gridZ;
+  node_params.blockDimX = 32 * num_warps;
+  node_params.blockDimY = 1;
+  node_params.blockDimZ = 1;
+  node_params.sharedMemBytes = shared_memory;
+  node_params.kernelParams = params;
+"""
+
+    num_launch_args = 9
 
     # generate glue code
-    params = [i for i in signature.keys() if i not in constants]
     src = f"""
 #include \"cuda.h\"
 #include <stdbool.h>
@@ -191,19 +303,68 @@ static cuLaunchKernelEx_t getLaunchKernelExHandle() {{
   return cuLaunchKernelExHandle;
 }}
 
-static void _launch(int gridX, int gridY, int gridZ, int num_warps, int num_ctas, int clusterDimX, int clusterDimY, int clusterDimZ, int shared_memory, CUstream stream, CUfunction function{', ' + arg_decls if len(arg_decls) > 0 else ''}) {{
-  void *params[] = {{ {', '.join(f"&arg{i}" for i in params)} }};
+// Allocates the global scratch memory of a launch in stream order from the
+// default memory pool of the device, and zeroes it.  The release threshold of
+// the pool is raised so that it keeps the memory freed after the launches
+// instead of returning it to the system at each synchronization: the next
+// launches then allocate without calling into the OS.
+static bool allocGlobalScratch(CUdeviceptr *ptr, size_t size, CUstream stream) {{
+  static bool pool_configured[64];
+  CUdevice device;
+  CUresult err = cuCtxGetDevice(&device);
+  if (err == CUDA_SUCCESS && device < 64 && !pool_configured[device]) {{
+    CUmemoryPool pool;
+    cuuint64_t threshold = ~(cuuint64_t)0;
+    err = cuDeviceGetDefaultMemPool(&pool, device);
+    if (err == CUDA_SUCCESS)
+      err = cuMemPoolSetAttribute(pool, CU_MEMPOOL_ATTR_RELEASE_THRESHOLD, &threshold);
+    pool_configured[device] = err == CUDA_SUCCESS;
+  }}
+  if (err == CUDA_SUCCESS)
+    err = cuMemAllocAsync(ptr, size, stream);
+  if (err == CUDA_SUCCESS)
+    err = cuMemsetD8Async(*ptr, 0, size, stream);
+  CUDA_CHECK(err);
+  return err == CUDA_SUCCESS;
+}}
+
+static void _launch(int gridX, int gridY, int gridZ, int num_warps, int num_ctas, int launch_pdl, int launch_cooperative, int clusterDimX, int clusterDimY, int clusterDimZ, int shared_memory, int global_scratch_size, CUstream stream, CUfunction function{', ' + arg_decls if len(arg_decls) > 0 else ''}) {{
+  // The global scratch memory is the last parameter of the kernels that use it;
+  // the driver ignores it for the others.
+  CUdeviceptr global_scratch = 0;
+  void *params[] = {{ {''.join(f"&arg{i}, " for i in params)}&global_scratch }};
   if (gridX*gridY*gridZ > 0) {{
-    if (num_ctas == 1) {{
+    if (global_scratch_size > 0 && !allocGlobalScratch(&global_scratch, global_scratch_size, stream))
+      return;
+    if (num_ctas == 1 && !launch_pdl && !launch_cooperative) {{
       CUDA_CHECK(cuLaunchKernel(function, gridX, gridY, gridZ, 32*num_warps, 1, 1, shared_memory, stream, params, 0));
     }} else {{
-      CUlaunchAttribute launchAttr[2];
-      launchAttr[0].id = CU_LAUNCH_ATTRIBUTE_CLUSTER_DIMENSION;
-      launchAttr[0].value.clusterDim.x = clusterDimX;
-      launchAttr[0].value.clusterDim.y = clusterDimY;
-      launchAttr[0].value.clusterDim.z = clusterDimZ;
-      launchAttr[1].id = CU_LAUNCH_ATTRIBUTE_CLUSTER_SCHEDULING_POLICY_PREFERENCE;
-      launchAttr[1].value.clusterSchedulingPolicyPreference = CU_CLUSTER_SCHEDULING_POLICY_SPREAD;
+      CUlaunchAttribute launchAttr[4];
+      unsigned numAttrs = 0;
+      if (num_ctas != 1) {{
+        launchAttr[numAttrs].id = CU_LAUNCH_ATTRIBUTE_CLUSTER_DIMENSION;
+        launchAttr[numAttrs].value.clusterDim.x = clusterDimX;
+        launchAttr[numAttrs].value.clusterDim.y = clusterDimY;
+        launchAttr[numAttrs].value.clusterDim.z = clusterDimZ;
+        ++numAttrs;
+        launchAttr[numAttrs].id = CU_LAUNCH_ATTRIBUTE_CLUSTER_SCHEDULING_POLICY_PREFERENCE;
+        launchAttr[numAttrs].value.clusterSchedulingPolicyPreference = CU_CLUSTER_SCHEDULING_POLICY_SPREAD;
+        ++numAttrs;
+      }}
+      if (launch_pdl) {{
+        // Let the kernel start before the previous one in the stream completes;
+        // it waits for it with griddepcontrol.wait.
+        launchAttr[numAttrs].id = CU_LAUNCH_ATTRIBUTE_PROGRAMMATIC_STREAM_SERIALIZATION;
+        launchAttr[numAttrs].value.programmaticStreamSerializationAllowed = 1;
+        ++numAttrs;
+      }}
+      if (launch_cooperative) {{
+        // All the CTAs run at once, so that they can wait for each other in
+        // tl.grid_barrier; the driver fails launches whose grid is too large.
+        launchAttr[numAttrs].id = CU_LAUNCH_ATTRIBUTE_COOPERATIVE;
+        launchAttr[numAttrs].value.cooperative = 1;
+        ++numAttrs;
+      }}
       CUlaunchConfig config;
       config.gridDimX = gridX * clusterDimX;
       config.gridDimY = gridY * clusterDimY;
@@ -214,13 +375,15 @@ static void _launch(int gridX, int gridY, int gridZ, int num_warps, int num_ctas
       config.sharedMemBytes = shared_memory;
       config.hStream = stream;
       config.attrs = launchAttr;
-      config.numAttrs = 2;
+      config.numAttrs = numAttrs;
       static cuLaunchKernelEx_t cuLaunchKernelExHandle = NULL;
       if (cuLaunchKernelExHandle == NULL) {{
         cuLaunchKernelExHandle = getLaunchKernelExHandle();
       }}
       CUDA_CHECK(cuLaunchKernelExHandle(&config, function, params, 0));
     }}
+    if (global_scratch)
+      CUDA_CHECK(cuMemFreeAsync(global_scratch, stream));
   }}
 }}
 
@@ -229,7 +392,17 @@ typedef struct _DevicePtrInfo {{
     bool valid;
 }} DevicePtrInfo;
 
-static inline DevicePtrInfo getPointer(PyObject *obj, int idx) {{
+// The pointer last passed for an argument and the device pointer it was
+// checked to map to.  Kernels are usually launched on the same buffers over and
+// over, so this saves the cuPointerGetAttribute query of most launches.
+typedef struct _DevicePtrCache {{
+    CUdeviceptr ptr;
+    CUdeviceptr dev_ptr;
+}} DevicePtrCache;
+
+static PyObject *data_ptr_str = NULL;
+
+static inline DevicePtrInfo getPointer(PyObject *obj, int idx, DevicePtrCache *cache) {{
   DevicePtrInfo ptr_info;
   ptr_info.dev_ptr = 0;
   ptr_info.valid = true;
@@ -241,59 +414,65 @@ static inline DevicePtrInfo getPointer(PyObject *obj, int idx) {{
     // valid nullptr
     return ptr_info;
   }}
-  PyObject *ptr = PyObject_GetAttrString(obj, "data_ptr");
-  if(ptr){{
-    PyObject *empty_tuple = PyTuple_New(0);
-    PyObject *ret = PyObject_Call(ptr, empty_tuple, NULL);
-    Py_DECREF(empty_tuple);
-    Py_DECREF(ptr);
-    if (!PyLong_Check(ret)) {{
-      PyErr_SetString(PyExc_TypeError, "data_ptr method of Pointer object must return 64-bit int");
+  PyObject *ret = PyObject_CallMethodObjArgs(obj, data_ptr_str, NULL);
+  if (!ret) {{
+    PyErr_Clear();
+    PyErr_SetString(PyExc_TypeError, "Pointer argument must be either uint64 or have data_ptr method");
+    ptr_info.valid = false;
+    return ptr_info;
+  }}
+  if (!PyLong_Check(ret)) {{
+    Py_DECREF(ret);
+    PyErr_SetString(PyExc_TypeError, "data_ptr method of Pointer object must return 64-bit int");
+    ptr_info.valid = false;
+    return ptr_info;
+  }}
+  ptr_info.dev_ptr = PyLong_AsUnsignedLongLong(ret);
+  Py_DECREF(ret);
+  if (!ptr_info.dev_ptr)
+    return ptr_info;
+  if (ptr_info.dev_ptr == cache->ptr) {{
+    ptr_info.dev_ptr = cache->dev_ptr;
+    return ptr_info;
+  }}
+  uint64_t dev_ptr;
+  int status = cuPointerGetAttribute(&dev_ptr, CU_POINTER_ATTRIBUTE_DEVICE_POINTER, ptr_info.dev_ptr);
+  if (status == CUDA_ERROR_INVALID_VALUE) {{
+      PyErr_Format(PyExc_ValueError,
+                   "Pointer argument (at %d) cannot be accessed from Triton (cpu tensor?)", idx);
       ptr_info.valid = false;
       return ptr_info;
-    }}
-    ptr_info.dev_ptr = PyLong_AsUnsignedLongLong(ret);
-    if(!ptr_info.dev_ptr)
-      return ptr_info;
-    uint64_t dev_ptr;
-    int status = cuPointerGetAttribute(&dev_ptr, CU_POINTER_ATTRIBUTE_DEVICE_POINTER, ptr_info.dev_ptr);
-    if (status == CUDA_ERROR_INVALID_VALUE) {{
-        PyErr_Format(PyExc_ValueError,
-                     "Pointer argument (at %d) cannot be accessed from Triton (cpu tensor?)", idx);
-        ptr_info.valid = false;
-    }}
-    ptr_info.dev_ptr = dev_ptr;
-    Py_DECREF(ret);  // Thanks ChatGPT!
-    return ptr_info;
   }}
-  PyErr_SetString(PyExc_TypeError, "Pointer argument must be either uint64 or have data_ptr method");
-  ptr_info.valid = false;
+  cache->ptr = ptr_info.dev_ptr;
+  cache->dev_ptr = dev_ptr;
+  ptr_info.dev_ptr = dev_ptr;
   return ptr_info;
 }}
 
-static PyObject* launch(PyObject* self, PyObject* args) {{
-  int gridX, gridY, gridZ;
-  uint64_t _stream;
-  uint64_t _function;
-  PyObject *launch_enter_hook = NULL;
-  PyObject *launch_exit_hook = NULL;
-  PyObject *kernel_metadata = NULL;
-  PyObject *launch_metadata = NULL;
-  {' '.join([f"{_extracted_type(ty)} _arg{i}; " for i, ty in signature.items()])}
-  if(!PyArg_ParseTuple(args, \"{format}\", &gridX, &gridY, &gridZ, &_stream, &_function,
-                                           &kernel_metadata, &launch_metadata,
-                                           &launch_enter_hook, &launch_exit_hook {args_list})) {{
-    return NULL;
-  }}
+static inline int getInt(PyObject *tuple, Py_ssize_t idx) {{
+  return (int)PyLong_AsLong(PyTuple_GET_ITEM(tuple, idx));
+}}
 
-  int num_warps, num_ctas, shared_memory, clusterDimX, clusterDimY, clusterDimZ;
-  if (!PyArg_ParseTuple(kernel_metadata, \"iiiiii\", &num_warps, &num_ctas, &shared_memory, &clusterDimX, &clusterDimY, &clusterDimZ)) {{
-    PyErr_SetString(PyExc_TypeError, "kernel_metadata must be a tuple");
+static PyObject* launch(PyObject* self, PyObject* const* args, Py_ssize_t nargs) {{
+  if (nargs != {num_launch_args + len(signature)}) {{
+    PyErr_Format(PyExc_TypeError, "launch expected {num_launch_args + len(signature)} arguments, got %zd", nargs);
     return NULL;
   }}
+  int gridX = (int)PyLong_AsLong(args[0]);
+  int gridY = (int)PyLong_AsLong(args[1]);
+  int gridZ = (int)PyLong_AsLong(args[2]);
+  uint64_t _stream = PyLong_AsUnsignedLongLong(args[3]);
+  uint64_t _function = PyLong_AsUnsignedLongLong(args[4]);
+  PyObject *launch_metadata = args[6];
+  PyObject *launch_enter_hook = args[7];
+  PyObject *launch_exit_hook = args[8];
+  {parse_kernel_args(5)}
 
   // extract launch metadata
-  if (launch_enter_hook != Py_None){{
+  if (PyLong_Check(launch_enter_hook)) {{
+    // native hook, see `CompiledKernel.launch_enter_hook`
+    ((void (*)(uint64_t))PyLong_AsVoidPtr(launch_enter_hook))(_function);
+  }} else if (launch_enter_hook != Py_None){{
     PyObject* args = Py_BuildValue("(O)", launch_metadata);
     PyObject* ret = PyObject_CallObject(launch_enter_hook, args);
     Py_DECREF(args);
@@ -301,16 +480,16 @@ static PyObject* launch(PyObject* self, PyObject* args) {{
       return NULL;
   }}
 
-  // raise exception asap
-  {"; ".join([f"DevicePtrInfo ptr_info{i} = getPointer(_arg{i}, {i}); if (!ptr_info{i}.valid) return NULL;" if ty[0] == "*" else "" for i, ty in signature.items()])};
   Py_BEGIN_ALLOW_THREADS;
-  _launch(gridX, gridY, gridZ, num_warps, num_ctas, clusterDimX, clusterDimY, clusterDimZ, shared_memory, (CUstream)_stream, (CUfunction)_function{', ' + ', '.join(f"ptr_info{i}.dev_ptr" if ty[0]=="*" else f"_arg{i}"for i, ty in signature.items()) if len(signature) > 0 else ''});
+  _launch(gridX, gridY, gridZ, num_warps, num_ctas, launch_pdl, launch_cooperative, clusterDimX, clusterDimY, clusterDimZ, shared_memory, global_scratch_size, (CUstream)_stream, (CUfunction)_function{', ' + kernel_args if len(signature) > 0 else ''});
   Py_END_ALLOW_THREADS;
   if (PyErr_Occurred()) {{
     return NULL;
   }}
 
-  if(launch_exit_hook != Py_None){{
+  if (PyLong_Check(launch_exit_hook)) {{
+    ((void (*)(uint64_t))PyLong_AsVoidPtr(launch_exit_hook))(_function);
+  }} else if(launch_exit_hook != Py_None){{
     PyObject* args = Py_BuildValue("(O)", launch_metadata);
     PyObject* ret = PyObject_CallObject(launch_exit_hook, args);
     Py_DECREF(args);
@@ -324,8 +503,43 @@ static PyObject* launch(PyObject* self, PyObject* args) {{
   return Py_None;
 }}
 
+// Adds a node launching the kernel to a graph, after `dependency` unless it is
+// 0, and returns the node.
+static PyObject* add_kernel_node(PyObject* self, PyObject* const* args, Py_ssize_t nargs) {{
+  {kernel_node_params}
+  CUgraph graph = (CUgraph)PyLong_AsUnsignedLongLong(args[0]);
+  CUgraphNode dependency = (CUgraphNode)PyLong_AsUnsignedLongLong(args[1]);
+  if (PyErr_Occurred()) {{
+    return NULL;
+  }}
+  CUgraphNode node;
+  CUDA_CHECK(cuGraphAddKernelNode(&node, graph, dependency ? &dependency : NULL, dependency ? 1 : 0, &node_params));
+  if (PyErr_Occurred()) {{
+    return NULL;
+  }}
+  return PyLong_FromUnsignedLongLong((uint64_t)node);
+}}
+
+// Sets the arguments and grid of a kernel node of an instantiated graph, for
+// its next launches.
+static PyObject* update_kernel_node(PyObject* self, PyObject* const* args, Py_ssize_t nargs) {{
+  {kernel_node_params}
+  CUgraphExec graph_exec = (CUgraphExec)PyLong_AsUnsignedLongLong(args[0]);
+  CUgraphNode node = (CUgraphNode)PyLong_AsUnsignedLongLong(args[1]);
+  if (PyErr_Occurred()) {{
+    return NULL;
+  }}
+  CUDA_CHECK(cuGraphExecKernelNodeSetParams(graph_exec, node, &node_params));
+  if (PyErr_Occurred()) {{
+    return NULL;
+  }}
+  Py_RETURN_NONE;
+}}
+
 static PyMethodDef ModuleMethods[] = {{
-  {{"launch", launch, METH_VARARGS, "Entry point for all kernels with this signature"}},
+  {{"launch", (PyCFunction)(void(*)(void))launch, METH_FASTCALL, "Entry point for all kernels with this signature"}},
+  {{"add_kernel_node", (PyCFunction)(void(*)(void))add_kernel_node, METH_FASTCALL, "Adds a kernel node to a CUDA graph"}},
+  {{"update_kernel_node", (PyCFunction)(void(*)(void))update_kernel_node, METH_FASTCALL, "Updates a kernel node of an instantiated CUDA graph"}},
   {{NULL, NULL, 0, NULL}} // sentinel
 }};
 
@@ -338,6 +552,10 @@ static struct PyModuleDef ModuleDef = {{
 }};
 
 PyMODINIT_FUNC PyInit___triton_launcher(void) {{
+  data_ptr_str = PyUnicode_InternFromString("data_ptr");
+  if (data_ptr_str == NULL) {{
+    return NULL;
+  }}
   PyObject *m = PyModule_Create(&ModuleDef);
   if(m == NULL) {{
     return NULL;
@@ -360,11 +578,71 @@ class CudaLauncher(object):
         src = make_launcher(constants, signature, ids)
         mod = compile_module_from_src(src, "__triton_launcher")
         self.launch = mod.launch
+        self.add_kernel_node = mod.add_kernel_node
+        self.update_kernel_node = mod.update_kernel_node
 
     def __call__(self, *args, **kwargs):
         self.launch(*args, **kwargs)
 
 
+class CudaKernelGraph(object):
+    """
+    A CUDA graph of kernel launches, whose arguments can be updated in place between replays:
+
+        graph = driver.active.create_kernel_graph()
+        node = graph.add(kernel, grid, *args)  # `kernel` is a `CompiledKernel`
+        graph.instantiate()
+        graph.launch()
+        graph.update(node, grid, *new_args)
+        graph.launch()
+
+    Kernels run in the order they are added.  The arguments must match the specialization `kernel` was compiled for,
+    as they are not checked again.  Launch hooks are not called for graph launches.
+    """
+
+    def __init__(self, driver):
+        self.driver = driver
+        self.utils = driver.utils
+        self.graph = self.utils.graph_create()
+        self.graph_exec = None
+        self.nodes = []
+
+    def _node_args(self, kernel, grid, args):
+        kernel._init_handles()
+        grid = tuple(grid) + (1, ) * (3 - len(grid))
+        return (grid[0], grid[1], grid[2], kernel.function, kernel.packed_metadata, *args)
+
+    def add(self, kernel, grid, *args):
+        """Adds a launch of `kernel` over `grid` to the graph and returns its index."""
+        assert self.graph_exec is None, "cannot add kernels to an instantiated graph"
+        dependency = self.nodes[-1][1] if self.nodes else 0
+        node = kernel.run.add_kernel_node(self.graph, dependency, *self._node_args(kernel, grid, args))
+        self.nodes.append((kernel, node))
+        return len(self.nodes) - 1
+
+    def instantiate(self):
+        self.graph_exec = self.utils.graph_instantiate(self.graph)
+
+    def update(self, index, grid, *args):
+        """Replaces the grid and arguments of the launch at `index` for the next replays."""
+        assert self.graph_exec is not None, "graph must be instantiated before updating it"
+        kernel, node = self.nodes[index]
+        kernel.run.update_kernel_node(self.graph_exec, node, *self._node_args(kernel, grid, args))
+
+    def launch(self, stream=None):
+        if self.graph_exec is None:
+            self.instantiate()
+        if stream is None:
+            stream = self.driver.get_current_stream(self.driver.get_current_device())
+        self.utils.graph_launch(self.graph_exec, stream)
+
+    def __del__(self):
+        if getattr(self, "graph_exec", None) is not None:
+            self.utils.graph_exec_destroy(self.graph_exec)
+        if getattr(self, "graph", None) is not None:
+            self.utils.graph_destroy(self.graph)
+
+
 class CudaDriver(GPUDriver):
 
     def __init__(self):
@@ -383,3 +661,6 @@ class CudaDriver(GPUDriver):
     def is_active():
         import torch
         return torch.cuda.is_available() and (torch.version.hip is None)
+
+    def create_kernel_graph(self):
+        return CudaKernelGraph(self)
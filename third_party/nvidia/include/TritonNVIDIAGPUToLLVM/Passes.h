@@ -25,7 +25,9 @@ createDecomposeUnsupportedConversionsPass();
 
 std::unique_ptr<OperationPass<ModuleOp>> createConvertTritonGPUToLLVMPass();
 std::unique_ptr<OperationPass<ModuleOp>>
-createConvertTritonGPUToLLVMPass(int32_t computeCapability);
+createConvertTritonGPUToLLVMPass(int32_t computeCapability,
+                                 bool fastMath = false,
+                                 int32_t deviceLogCapacity = 0);
 
 #define GEN_PASS_REGISTRATION
 #include "nvidia/include/TritonNVIDIAGPUToLLVM/Passes.h.inc"
@@ -276,17 +276,20 @@ public:
 
   std::string getPtxAsm(ttn::StoreMatrixOp op) const {
     auto datas = op.getDatas();
+    std::string trans = op.getTrans() ? ".trans" : "";
     std::string ptxAsm;
     switch (datas.size()) {
     case 1:
-      ptxAsm = "stmatrix.sync.aligned.m8n8.x1.shared.b16 [$0], {$1};";
+      ptxAsm = "stmatrix.sync.aligned.m8n8.x1" + trans +
+               ".shared.b16 [$0], {$1};";
       break;
     case 2:
-      ptxAsm = "stmatrix.sync.aligned.m8n8.x2.shared.b16 [$0], {$1, $2};";
+      ptxAsm = "stmatrix.sync.aligned.m8n8.x2" + trans +
+               ".shared.b16 [$0], {$1, $2};";
       break;
     case 4:
-      ptxAsm =
-          "stmatrix.sync.aligned.m8n8.x4.shared.b16 [$0], {$1, $2, $3, $4};";
+      ptxAsm = "stmatrix.sync.aligned.m8n8.x4" + trans +
+               ".shared.b16 [$0], {$1, $2, $3, $4};";
       break;
     default:
       assert(false && "Invalid size");
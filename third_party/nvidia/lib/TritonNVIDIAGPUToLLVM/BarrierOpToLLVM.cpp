@@ -188,6 +188,72 @@ struct WaitBarrierOpConversion
     return success();
   }
 };
+
+struct ArriveBarrierOpConversion
+    : public ConvertOpToLLVMPattern<triton::nvidia_gpu::ArriveBarrierOp> {
+  using ConvertOpToLLVMPattern::ConvertOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::nvidia_gpu::ArriveBarrierOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Location loc = op->getLoc();
+    auto smemObj = LLVM::getSharedMemoryObjectFromStruct(
+        loc, adaptor.getAlloc(),
+        typeConverter->convertType(op.getAlloc().getType().getElementType()),
+        rewriter);
+
+    // Arrive from the first thread of the warps executing the op.
+    int firstThread = 0;
+    auto groupAttrName = triton::gpu::TritonGPUDialect::getWarpGroupAttrName();
+    for (Operation *parent = op; parent; parent = parent->getParentOp()) {
+      auto group = parent->getAttrOfType<DenseI32ArrayAttr>(groupAttrName);
+      if (!group)
+        continue;
+      auto mod = op->getParentOfType<ModuleOp>();
+      firstThread =
+          group[0] * triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+      break;
+    }
+    auto id = getThreadId(rewriter, loc);
+    Value pred = icmp_eq(id, i32_val(firstThread));
+    ::mlir::triton::PTXBuilder ptxBuilder;
+    std::string ptx = "@$0 mbarrier.arrive.shared::cta.b64 _, [$1]";
+    if (op.getCount() > 1)
+      ptx += ", " + std::to_string(op.getCount());
+    ptx += ";";
+    auto &arriveOp = *ptxBuilder.create<>(ptx);
+    arriveOp({ptxBuilder.newOperand(pred, "b"),
+              ptxBuilder.newOperand(smemObj.getBase(), "r")},
+             /*onlyAttachMLIRArgs=*/true);
+    auto voidTy = void_ty(op->getContext());
+    ptxBuilder.launch(rewriter, loc, voidTy);
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
+template <typename OpTy>
+struct SetMaxNRegOpConversion : public ConvertOpToLLVMPattern<OpTy> {
+  using ConvertOpToLLVMPattern<OpTy>::ConvertOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(OpTy op, typename OpTy::Adaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    constexpr bool increase =
+        std::is_same_v<OpTy, triton::nvidia_gpu::RegAllocOp>;
+    const std::string ptx = std::string("setmaxnreg.") +
+                            (increase ? "inc" : "dec") +
+                            ".sync.aligned.u32 " +
+                            std::to_string(op.getRegCount()) + ";";
+    ::mlir::triton::PTXBuilder ptxBuilder;
+    auto &setMaxNRegOp = *ptxBuilder.create<>(ptx);
+    setMaxNRegOp({}, /*onlyAttachMLIRArgs=*/true);
+    auto voidTy = void_ty(op->getContext());
+    ptxBuilder.launch(rewriter, op->getLoc(), voidTy);
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
 } // namespace
 
 void mlir::triton::NVIDIA::populateBarrierOpToLLVMPatterns(
@@ -198,5 +264,9 @@ void mlir::triton::NVIDIA::populateBarrierOpToLLVMPatterns(
   patterns.add<InitBarrierOpConversion, InvalBarrierOpConversion>(typeConverter,
                                                                   benefit);
   patterns.add<WaitBarrierOpConversion>(typeConverter, benefit);
+  patterns.add<ArriveBarrierOpConversion>(typeConverter, benefit);
+  patterns.add<SetMaxNRegOpConversion<triton::nvidia_gpu::RegAllocOp>,
+               SetMaxNRegOpConversion<triton::nvidia_gpu::RegDeallocOp>>(
+      typeConverter, benefit);
   patterns.add<BarrierExpectConversion>(typeConverter, benefit);
 }
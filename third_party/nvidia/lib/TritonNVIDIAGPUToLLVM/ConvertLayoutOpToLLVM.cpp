@@ -52,8 +52,11 @@ using namespace mlir::triton::gpu;
 struct LocalLoadOpConversion
     : public ConvertOpToLLVMPattern<triton::gpu::LocalLoadOp> {
 public:
-  using ConvertOpToLLVMPattern<
-      triton::gpu::LocalLoadOp>::ConvertOpToLLVMPattern;
+  LocalLoadOpConversion(const LLVMTypeConverter &typeConverter,
+                        const NVIDIA::TargetInfo &targetInfo,
+                        PatternBenefit benefit = 1)
+      : ConvertOpToLLVMPattern(typeConverter, benefit), targetInfo(targetInfo) {
+  }
 
   LogicalResult
   matchAndRewrite(triton::gpu::LocalLoadOp op, OpAdaptor adaptor,
@@ -93,6 +96,10 @@ private:
       res = SharedToDotOperandMMAv2::convertLayout(
           dotOperandLayout.getOpIdx(), rewriter, loc, src, dotOperandLayout,
           smemObj, typeConverter, getThreadId(rewriter, loc));
+    } else if (!isOuter && mmaLayout.isHopper() &&
+               dotOperandLayout.getOpIdx() == 0) { // tensor core v3, A in regs
+      res = lowerSharedToMMAv3RegisterOperand(op, adaptor, typeConverter,
+                                              rewriter, mmaLayout, smemObj);
     } else if (!isOuter && mmaLayout.isVolta() && isMMA) { // tensor core v1
       bool isMMAv1Row = mmaLayout.getMMAv1IsRow(dotOperandLayout.getOpIdx());
       auto srcSharedLayout =
@@ -114,6 +121,37 @@ private:
     return res;
   };
 
+  // shared -> register A operand of a wgmma. The operand has the layout of the
+  // accumulator of a wgmma with N = K, so we load it as such.
+  Value lowerSharedToMMAv3RegisterOperand(
+      triton::gpu::LocalLoadOp op, triton::gpu::LocalLoadOpAdaptor adaptor,
+      const LLVMTypeConverter *typeConverter,
+      ConversionPatternRewriter &rewriter,
+      const NvidiaMmaEncodingAttr &mmaLayout,
+      const SharedMemoryObject &smemObj) const {
+    auto loc = op.getLoc();
+    MemDescType srcTy = op.getSrc().getType();
+    RankedTensorType dstTy = op.getType();
+    assert(dstTy.getElementType().getIntOrFloatBitWidth() == 16 &&
+           mmaLayout.getWarpsPerCTA()[1] == 1 &&
+           "Unsupported Shared -> DotOperand[MMAv3] conversion");
+    auto instrShape = mmaLayout.getInstrShape();
+    unsigned K = getShapePerCTA(dstTy)[1];
+    SmallVector<unsigned> accInstrShape = {instrShape[0],
+                                           std::min<unsigned>(K, 256),
+                                           instrShape[2]};
+    auto accLayout = NvidiaMmaEncodingAttr::get(
+        op.getContext(), mmaLayout.getVersionMajor(),
+        mmaLayout.getVersionMinor(), mmaLayout.getWarpsPerCTA(),
+        mmaLayout.getCTALayout(), accInstrShape);
+    auto accTy = RankedTensorType::get(dstTy.getShape(),
+                                       dstTy.getElementType(), accLayout);
+    Type llvmElemTy = typeConverter->convertType(dstTy.getElementType());
+    SmallVector<Value> vals = loadSharedToDistributed(
+        accTy, srcTy, llvmElemTy, smemObj, loc, rewriter, targetInfo);
+    return packLLElements(loc, typeConverter, vals, rewriter, dstTy);
+  }
+
   // shared -> mma_operand
   LogicalResult
   lowerSharedToDotOperand(triton::gpu::LocalLoadOp op,
@@ -138,6 +176,8 @@ private:
     rewriter.replaceOp(op, res);
     return success();
   }
+
+  const NVIDIA::TargetInfo &targetInfo;
 };
 
 struct ConvertLayoutOpConversion
@@ -690,85 +730,8 @@ private:
   const NVIDIA::TargetInfo &targetInfo;
 };
 
-struct LocalAllocOpConversion
-    : public ConvertOpToLLVMPattern<triton::gpu::LocalAllocOp> {
-  LocalAllocOpConversion(const LLVMTypeConverter &converter,
-                         const NVIDIA::TargetInfo &targetInfo,
-                         PatternBenefit benefit = 1)
-      : ConvertOpToLLVMPattern<triton::gpu::LocalAllocOp>(converter, benefit),
-        targetInfo(targetInfo) {}
-
-  LogicalResult
-  matchAndRewrite(triton::gpu::LocalAllocOp op, OpAdaptor adaptor,
-                  ConversionPatternRewriter &rewriter) const override {
-    if (!op.getSrc())
-      return failure();
-    auto mmaEncoding = dyn_cast<triton::gpu::NvidiaMmaEncodingAttr>(
-        op.getSrc().getType().getEncoding());
-    if (!mmaEncoding)
-      return failure();
-    auto sharedLayout =
-        cast<triton::gpu::SharedEncodingAttr>(op.getType().getEncoding());
-    if (!sharedLayout.getHasLeadingOffset())
-      return failure();
-    int swizzleByteSize = 0;
-    if (sharedLayout.getPerPhase() == 4 && sharedLayout.getMaxPhase() == 2)
-      swizzleByteSize = 32;
-    else if (sharedLayout.getPerPhase() == 2 && sharedLayout.getMaxPhase() == 4)
-      swizzleByteSize = 64;
-    else if (sharedLayout.getPerPhase() == 1 && sharedLayout.getMaxPhase() == 8)
-      swizzleByteSize = 128;
-    else
-      return failure();
-
-    Location loc = op->getLoc();
-    RankedTensorType srcTy = op.getSrc().getType();
-    Value smemBase = LLVM::getSharedMemoryBase(loc, rewriter, op);
-    auto srcs = unpackLLElements(loc, adaptor.getSrc(), rewriter);
-    SmallVector<unsigned> shape;
-    for (int64_t dim : srcTy.getShape())
-      shape.push_back(dim);
-    bool loweredToStMatrix = targetInfo.processReplicaUsingStMatrix(
-        rewriter, loc, smemBase, srcs, srcTy,
-        getTypeConverter()->convertType(srcTy.getElementType()), shape, shape,
-        sharedLayout.getOrder(), 1, swizzleByteSize);
-    if (!loweredToStMatrix)
-      return failure();
-
-    auto resultTy = cast<MemDescType>(op.getType());
-    // Workaround for 3D tensors
-    // TODO: we need to modify the pipeline pass to give a proper shared
-    // encoding to 3D tensors
-    auto order = sharedLayout.getOrder();
-    SmallVector<unsigned> newOrder;
-    if (resultTy.getShape().size() != order.size()) {
-      for (auto i = 0; i < order.size(); ++i)
-        newOrder.push_back(order[i] + 1);
-      newOrder.push_back(0);
-    } else {
-      newOrder = SmallVector<unsigned>(order.begin(), order.end());
-    }
-    auto llvmElemTy = typeConverter->convertType(resultTy.getElementType());
-    auto shapePerCTA = getShapePerCTA(sharedLayout, resultTy.getShape());
-    auto smemObj = SharedMemoryObject(smemBase, llvmElemTy, shapePerCTA,
-                                      newOrder, loc, rewriter);
-    auto retVal = getStructFromSharedMemoryObject(loc, smemObj, rewriter);
-    rewriter.replaceOp(op, retVal);
-    return success();
-  }
-
-private:
-  const NVIDIA::TargetInfo &targetInfo;
-};
-
 } // namespace
 
-void mlir::triton::NVIDIA::populateConvertLayoutOpToLLVMOptimizedPatterns(
-    LLVMTypeConverter &typeConverter, const TargetInfo &targetInfo,
-    RewritePatternSet &patterns, PatternBenefit benefit) {
-  patterns.add<LocalAllocOpConversion>(typeConverter, targetInfo, benefit);
-}
-
 void mlir::triton::NVIDIA::populateConvertLayoutOpToLLVMPatterns(
     LLVMTypeConverter &typeConverter, const TargetInfo &targetInfo,
     RewritePatternSet &patterns, PatternBenefit benefit) {
@@ -779,7 +742,7 @@ void mlir::triton::NVIDIA::populateConvertLayoutOpToLLVMPatterns(
   // testcases.  Is this dead code?  Does the benefit need to be increased?
   patterns.add<ConvertLayoutOpConversion>(typeConverter, targetInfo, benefit);
   // Same default benefit
-  patterns.add<LocalLoadOpConversion>(typeConverter, benefit);
+  patterns.add<LocalLoadOpConversion>(typeConverter, targetInfo, benefit);
   mlir::triton::populateConvertLayoutOpToLLVMPatterns(typeConverter, targetInfo,
                                                       patterns, benefit);
 }
@@ -23,10 +23,20 @@ LogicalResult convertMMA16816(triton::DotOp op, triton::DotOp::Adaptor adaptor,
                               const LLVMTypeConverter *typeConverter,
                               ConversionPatternRewriter &rewriter);
 
+LogicalResult convertSparseMMA(triton::SparseDotOp op,
+                               triton::SparseDotOp::Adaptor adaptor,
+                               const LLVMTypeConverter *typeConverter,
+                               ConversionPatternRewriter &rewriter);
+
 LogicalResult convertWGMMA(triton::nvidia_gpu::WarpGroupDotOp op,
                            triton::nvidia_gpu::WarpGroupDotOp::Adaptor adaptor,
                            const LLVMTypeConverter *typeConverter,
                            ConversionPatternRewriter &rewriter, Value thread);
+
+LogicalResult convertTCGen5MMA(triton::nvidia_gpu::TCGen5MMAOp op,
+                               triton::nvidia_gpu::TCGen5MMAOp::Adaptor adaptor,
+                               const LLVMTypeConverter *typeConverter,
+                               ConversionPatternRewriter &rewriter);
 namespace {
 struct DotOpConversion : public ConvertOpToLLVMPattern<triton::DotOp> {
   using ConvertOpToLLVMPattern<triton::DotOp>::ConvertOpToLLVMPattern;
@@ -68,6 +78,22 @@ struct DotOpConversion : public ConvertOpToLLVMPattern<triton::DotOp> {
   }
 };
 
+struct SparseDotOpConversion
+    : public ConvertOpToLLVMPattern<triton::SparseDotOp> {
+  using ConvertOpToLLVMPattern<triton::SparseDotOp>::ConvertOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::SparseDotOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto mmaLayout =
+        dyn_cast<NvidiaMmaEncodingAttr>(op.getD().getType().getEncoding());
+    if (!mmaLayout || !mmaLayout.isAmpere())
+      llvm::report_fatal_error(
+          "Unsupported SparseDotOp found when converting TritonGPU to LLVM.");
+    return convertSparseMMA(op, adaptor, getTypeConverter(), rewriter);
+  }
+};
+
 struct WarpGroupDotOpConversion
     : public ConvertOpToLLVMPattern<triton::nvidia_gpu::WarpGroupDotOp> {
   using ConvertOpToLLVMPattern<
@@ -105,6 +131,18 @@ struct WarpGroupDotOpConversion
   }
 };
 
+struct TCGen5MMAOpConversion
+    : public ConvertOpToLLVMPattern<triton::nvidia_gpu::TCGen5MMAOp> {
+  using ConvertOpToLLVMPattern<
+      triton::nvidia_gpu::TCGen5MMAOp>::ConvertOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::nvidia_gpu::TCGen5MMAOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    return convertTCGen5MMA(op, adaptor, getTypeConverter(), rewriter);
+  }
+};
+
 struct WarpGroupDotWaitOpConversion
     : public ConvertOpToLLVMPattern<triton::nvidia_gpu::WarpGroupDotWaitOp> {
   using ConvertOpToLLVMPattern<
@@ -172,6 +210,8 @@ void mlir::triton::NVIDIA::populateDotOpToLLVMPatterns(
     LLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
     PatternBenefit benefit) {
   patterns.add<DotOpConversion>(typeConverter, benefit);
+  patterns.add<SparseDotOpConversion>(typeConverter, benefit);
   patterns.add<WarpGroupDotOpConversion>(typeConverter, benefit);
   patterns.add<WarpGroupDotWaitOpConversion>(typeConverter, benefit);
+  patterns.add<TCGen5MMAOpConversion>(typeConverter, benefit);
 }
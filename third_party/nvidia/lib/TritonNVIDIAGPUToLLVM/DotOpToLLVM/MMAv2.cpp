@@ -378,8 +378,12 @@ LogicalResult convertDot(const LLVMTypeConverter *typeConverter,
     }
   };
 
+  // The K steps past the extent of the operands multiply zeros.
+  int numStepsK = repK;
+  if (op.getKExtent() > 0)
+    numStepsK = ceil<int>(op.getKExtent(), aShapePerCTA.back() / repK);
   for (int b = 0; b < repBatch; ++b)
-    for (int k = 0; k < repK; ++k)
+    for (int k = 0; k < numStepsK; ++k)
       for (int m = 0; m < repM; ++m)
         for (int n = 0; n < repN; ++n)
           callMma(b, 2 * m, n, 2 * k);
@@ -432,3 +436,85 @@ LogicalResult convertMMA16816(triton::DotOp op, triton::DotOp::Adaptor adaptor,
                               ConversionPatternRewriter &rewriter) {
   return convertMMA(op, adaptor, typeConverter, rewriter, false /*isTuring*/);
 }
+
+// Convert to mma.sp.m16n8k32, which multiplies the 16x16 compressed tile of
+// A, holding 2 of every 4 elements of its 16x32 dense tile, by a 32x8 tile of
+// B. The A and B operands are in the layouts of mma.m16n8k16, and each
+// thread packs the 2-bit positions of the rows g and g + 8 of its quad,
+// held by its sparse_dot_meta layout, into the metadata register. With the
+// sparsity selector 0, only the threads 0 and 1 of each quad provide it.
+LogicalResult convertSparseMMA(triton::SparseDotOp op,
+                               triton::SparseDotOp::Adaptor adaptor,
+                               const LLVMTypeConverter *typeConverter,
+                               ConversionPatternRewriter &rewriter) {
+  Location loc = op.getLoc();
+  MLIRContext *ctx = op.getContext();
+  auto aTensorTy = op.getA().getType();
+  auto bTensorTy = op.getB().getType();
+  auto dTensorTy = op.getD().getType();
+  auto mmaLayout = cast<NvidiaMmaEncodingAttr>(dTensorTy.getEncoding());
+  int bitwidth = aTensorTy.getElementType().getIntOrFloatBitWidth();
+  auto repA = mmaLayout.getMMAv2Rep(triton::gpu::getShapePerCTA(aTensorTy),
+                                    bitwidth, /*opIdx=*/0);
+  auto repB = mmaLayout.getMMAv2Rep(triton::gpu::getShapePerCTA(bTensorTy),
+                                    bitwidth, /*opIdx=*/1);
+  // Each step of K reads one 16-wide K tile of the compressed A and two of B.
+  int repM = repA[1], repN = repB[2], repK = repA[2];
+  assert(repB[1] == 2 * repK && "B must hold twice the K tiles of A");
+
+  auto ha = getValuesFromDotOperandLayoutStruct(
+      typeConverter, loc, rewriter, adaptor.getA(), 1, repM, repK, aTensorTy);
+  auto hb = getValuesFromDotOperandLayoutStruct(
+      typeConverter, loc, rewriter, adaptor.getB(), 1, std::max(repN / 2, 1),
+      repB[1], bTensorTy);
+  Value loadedC =
+      loadC(op.getC(), adaptor.getC(), typeConverter, loc, rewriter);
+  auto fc = unpackLLElements(loc, loadedC, rewriter);
+  auto meta = unpackLLElements(loc, adaptor.getAMeta(), rewriter);
+
+  std::string eltTy = aTensorTy.getElementType().isBF16() ? "bf16" : "f16";
+  std::string ptx = "mma.sp.sync.aligned.m16n8k32.row.col.f32." + eltTy +
+                    "." + eltTy + ".f32";
+  unsigned colsPerThread = repN * 2;
+  for (int k = 0; k < repK; ++k)
+    for (int m = 0; m < repM; ++m) {
+      unsigned metaIdx = 2 * (k + repK * m);
+      Value metaReg =
+          or_(zext(i32_ty, meta[metaIdx]),
+              shl(zext(i32_ty, meta[metaIdx + 1]), i32_val(16)));
+      for (int n = 0; n < repN; ++n) {
+        PTXBuilder builder;
+        auto &mma = *builder.create(ptx);
+        auto retArgs = builder.newListOperand(4, "=f");
+        auto cArgs = builder.newListOperand();
+        unsigned cOffset = 2 * m * colsPerThread + 4 * n;
+        for (int i = 0; i < 4; ++i)
+          cArgs->listAppend(
+              builder.newOperand(fc[cOffset + i], std::to_string(i)));
+        auto aArgs = builder.newListOperand({
+            {ha[{0, 2 * m, 2 * k}], "r"},
+            {ha[{0, 2 * m + 1, 2 * k}], "r"},
+            {ha[{0, 2 * m, 2 * k + 1}], "r"},
+            {ha[{0, 2 * m + 1, 2 * k + 1}], "r"},
+        });
+        auto bArgs = builder.newListOperand({
+            {hb[{0, n, 4 * k}], "r"},
+            {hb[{0, n, 4 * k + 1}], "r"},
+            {hb[{0, n, 4 * k + 2}], "r"},
+            {hb[{0, n, 4 * k + 3}], "r"},
+        });
+        mma(retArgs, aArgs, bArgs, cArgs, builder.newOperand(metaReg, "r"),
+            builder.newConstantOperand(0));
+        Value mmaOut = builder.launch(
+            rewriter, loc,
+            getMmaRetType(TensorCoreType::FP32_FP16_FP16_FP32, ctx));
+        for (int i = 0; i < 4; ++i)
+          fc[cOffset + i] = extract_val(f32_ty, mmaOut, i);
+      }
+    }
+
+  Value res = packLLElements(loc, typeConverter, fc, rewriter,
+                             typeConverter->convertType(dTensorTy));
+  rewriter.replaceOp(op, res);
+  return success();
+}
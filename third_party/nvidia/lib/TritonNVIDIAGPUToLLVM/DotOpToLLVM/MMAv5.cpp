@@ -0,0 +1,156 @@
+#include "MMAHelpers.h"
+#include "TritonNVIDIAGPUToLLVM/PTXAsmFormat.h"
+#include "Utility.h"
+#include "mlir/Support/LLVM.h"
+
+using namespace mlir;
+using namespace mlir::triton;
+using namespace mlir::triton::NVIDIA;
+
+using ::mlir::LLVM::getSharedMemoryObjectFromStruct;
+using ::mlir::triton::gpu::getShapePerCTA;
+using ::mlir::triton::gpu::SharedEncodingAttr;
+
+namespace ttng = mlir::triton::nvidia_gpu;
+
+namespace {
+
+// The K of a single tcgen05.mma, which reads 32 bytes of K of each operand.
+unsigned getMmaV5InstrK(Type elemTy) {
+  return 256 / elemTy.getIntOrFloatBitWidth();
+}
+
+// The instruction descriptor of tcgen05.mma.kind::f16 with an f32
+// accumulator, or of tcgen05.mma.kind::i8 with signed operands and an s32
+// accumulator, as described in the spec:
+// https://docs.nvidia.com/cuda/parallel-thread-execution/index.html#tcgen05-instruction-descriptor
+uint32_t createInstrDescriptor(Type aElemTy, Type bElemTy, bool transA,
+                               bool transB, unsigned M, unsigned N) {
+  union MmaV5InstrDescriptor {
+    uint32_t descriptor;
+    struct {
+      uint32_t : 4;
+      uint32_t dFormat : 2;
+      uint32_t : 1;
+      uint32_t aFormat : 3;
+      uint32_t bFormat : 3;
+      uint32_t negateA : 1;
+      uint32_t negateB : 1;
+      uint32_t aMajor : 1;
+      uint32_t bMajor : 1;
+      uint32_t N : 6;
+      uint32_t : 1;
+      uint32_t M : 5;
+      uint32_t : 3;
+    };
+  };
+  static_assert(sizeof(MmaV5InstrDescriptor) == 4,
+                "Instruction descriptor size should be 32 bits.");
+  MmaV5InstrDescriptor desc;
+  desc.descriptor = 0;
+  if (aElemTy.isInteger(8)) {
+    desc.dFormat = 2; // s32
+    desc.aFormat = 1; // s8
+    desc.bFormat = 1;
+  } else {
+    desc.dFormat = 1; // f32
+    desc.aFormat = aElemTy.isBF16() ? 1 : 0;
+    desc.bFormat = bElemTy.isBF16() ? 1 : 0;
+  }
+  desc.aMajor = transA;
+  desc.bMajor = transB;
+  desc.N = N >> 3;
+  desc.M = M >> 4;
+  return desc.descriptor;
+}
+
+void createPTXInst(ConversionPatternRewriter &rewriter, Location loc,
+                   const std::string &ptx,
+                   ArrayRef<std::pair<Value, std::string>> args) {
+  PTXBuilder ptxBuilder;
+  SmallVector<PTXBuilder::Operand *> operands;
+  for (auto [arg, constraint] : args)
+    operands.push_back(ptxBuilder.newOperand(arg, constraint));
+  auto &inst = *ptxBuilder.create<>(ptx);
+  inst(operands, /*onlyAttachMLIRArgs=*/true);
+  ptxBuilder.launch(rewriter, loc, void_ty(rewriter.getContext()));
+}
+
+} // namespace
+
+LogicalResult convertTCGen5MMA(ttng::TCGen5MMAOp op,
+                               ttng::TCGen5MMAOp::Adaptor adaptor,
+                               const LLVMTypeConverter *typeConverter,
+                               ConversionPatternRewriter &rewriter) {
+  Location loc = op.getLoc();
+  auto aTy = op.getA().getType();
+  auto bTy = op.getB().getType();
+  auto aShapePerCTA = getShapePerCTA(aTy);
+  auto bShapePerCTA = getShapePerCTA(bTy);
+  unsigned M = aShapePerCTA[0];
+  unsigned N = bShapePerCTA[1];
+  unsigned K = aShapePerCTA[1];
+  bool transA = cast<SharedEncodingAttr>(aTy.getEncoding()).getOrder()[0] == 0;
+  bool transB = cast<SharedEncodingAttr>(bTy.getEncoding()).getOrder()[0] == 1;
+
+  // The whole tile is a single MMA of a single thread, so the descriptors are
+  // those of the first warp of wgmma.
+  Value baseA = getSharedMemoryObjectFromStruct(
+                    loc, adaptor.getA(),
+                    typeConverter->convertType(aTy.getElementType()), rewriter)
+                    .getBase();
+  Value baseB = getSharedMemoryObjectFromStruct(
+                    loc, adaptor.getB(),
+                    typeConverter->convertType(bTy.getElementType()), rewriter)
+                    .getBase();
+  unsigned instrK = getMmaV5InstrK(aTy.getElementType());
+  DotOpMmaV3SmemLoader aLoader(op.getA(), baseA, aShapePerCTA, i32_val(0),
+                               /*dimWpt=*/1, transA, {M, instrK}, rewriter,
+                               loc);
+  DotOpMmaV3SmemLoader bLoader(op.getB(), baseB, bShapePerCTA, i32_val(0),
+                               /*dimWpt=*/1, transB, {N, instrK}, rewriter,
+                               loc);
+  // The descriptors of tcgen05 set the version bit 46 on top of the format of
+  // wgmma.
+  Value version = int_val(64, 1ull << 46);
+  uint32_t instrDesc = createInstrDescriptor(
+      aTy.getElementType(), bTy.getElementType(), transA, transB, M, N);
+
+  // Wait for the threads that wrote the accumulator to tensor memory before
+  // issuing the MMA from a single thread.
+  createPTXInst(rewriter, loc, "tcgen05.fence::before_thread_sync;", {});
+  barrier();
+  createPTXInst(rewriter, loc, "tcgen05.fence::after_thread_sync;", {});
+
+  Value pred = and_(icmp_eq(getThreadId(rewriter, loc), i32_val(0)),
+                    adaptor.getPred());
+  std::string kind = aTy.getElementType().isInteger(8) ? "i8" : "f16";
+  for (unsigned k = 0; k < K / instrK; ++k) {
+    Value aDesc = or_(aLoader.smemLoad(0, k, rewriter, loc), version);
+    Value bDesc = or_(bLoader.smemLoad(0, k, rewriter, loc), version);
+    Value useD = k == 0 ? adaptor.getUseD() : int_val(1, 1);
+    createPTXInst(
+        rewriter, loc,
+        "@$0 tcgen05.mma.cta_group::1.kind::" + kind + " [$1], $2, $3, $4, $5;",
+        {{pred, "b"},
+         {adaptor.getD(), "r"},
+         {aDesc, "l"},
+         {bDesc, "l"},
+         {i32_val(instrDesc), "r"},
+         {useD, "b"}});
+  }
+  // Arrive on the barrier once the MMAs issued so far are done.
+  Value barrierBase = getSharedMemoryObjectFromStruct(
+                          loc, adaptor.getBarrier(),
+                          typeConverter->convertType(
+                              op.getBarrier().getType().getElementType()),
+                          rewriter)
+                          .getBase();
+  createPTXInst(
+      rewriter, loc,
+      "@$0 tcgen05.commit.cta_group::1.mbarrier::arrive::one.shared::cluster."
+      "b64 [$1];",
+      {{pred, "b"}, {barrierBase, "r"}});
+  rewriter.eraseOp(op);
+  return success();
+}
@@ -21,6 +21,7 @@
  * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include "MMAHelpers.h"
 #include "Utility.h"
 #include "mlir/Support/LLVM.h"
 
@@ -32,6 +33,7 @@ using ::mlir::triton::gpu::getShapePerCTA;
 using ::mlir::triton::gpu::getShapePerCTATile;
 using ::mlir::triton::gpu::NvidiaMmaEncodingAttr;
 using ::mlir::triton::gpu::SharedEncodingAttr;
+using namespace mlir::triton::NVIDIA;
 
 triton::nvgpu::WGMMAEltType getMmaRetType(Value d) {
   auto dTy = cast<RankedTensorType>(d.getType()).getElementType();
@@ -65,134 +67,6 @@ triton::nvgpu::WGMMAEltType getMmaOperandType(Value a, bool allowTF32) {
   }
 }
 
-int64_t getSwizzlingFromLayout(const SharedEncodingAttr &layout,
-                               uint32_t widthInByte) {
-  int perPhase = layout.getPerPhase();
-  int maxPhase = layout.getMaxPhase();
-  uint32_t swizzlingByteWidth = 0;
-  if (perPhase == 4 && maxPhase == 2) {
-    swizzlingByteWidth = 32;
-  } else if (perPhase == 2 && maxPhase == 4) {
-    swizzlingByteWidth = 64;
-  } else if (perPhase == 1 && maxPhase == 8) {
-    swizzlingByteWidth = 128;
-  } else {
-    llvm::report_fatal_error("Unsupported shared layout.");
-  }
-
-  // TODO[biaow]: remove it once we support swizzling size larger than matrix
-  // width, which requires padding the matrix width to the swizzling size when
-  // allocating shared memory.
-  assert(swizzlingByteWidth <= widthInByte &&
-         "swizzling size larger than matrix width is not supported.");
-  return swizzlingByteWidth;
-}
-
-static Value createDescriptor(ConversionPatternRewriter &rewriter, Location loc,
-                              int64_t swizzling, uint32_t stride) {
-  // Create descriptor based on the format described in the spec:
-  // https://docs.nvidia.com/cuda/parallel-thread-execution/index.html#asynchronous-warpgroup-level-matrix-shared-memory-layout-matrix-descriptor
-  union WGMMADescriptor {
-    uint64_t descriptor;
-    struct {
-      uint64_t baseAddress : 14;
-      uint64_t : 2;
-      uint64_t leadDimensionBaseOffset : 14;
-      uint64_t : 2;
-      uint64_t strideDimensionBaseOffset : 14;
-      uint64_t : 3;
-      uint64_t matrixBaseOffset : 3;
-      uint64_t : 10;
-      uint64_t swizzlingMode : 2;
-    };
-  };
-  static_assert(sizeof(WGMMADescriptor) == 8,
-                "Descriptor size should be 64 bits.");
-  WGMMADescriptor desc;
-  desc.descriptor = 0;
-  switch (swizzling) {
-  case 0:
-    desc.swizzlingMode = 0;
-    break;
-  case 32:
-    desc.swizzlingMode = 3;
-    break;
-  case 64:
-    desc.swizzlingMode = 2;
-    break;
-  case 128:
-    desc.swizzlingMode = 1;
-    break;
-  default:
-    llvm::report_fatal_error("Unsupported swizzling size.");
-  }
-  desc.strideDimensionBaseOffset = swizzling >> 1;
-  desc.leadDimensionBaseOffset = (swizzling * stride) >> 4;
-  return int_val(64, desc.descriptor);
-}
-
-class DotOpMmaV3SmemLoader {
-public:
-  DotOpMmaV3SmemLoader() {}
-  DotOpMmaV3SmemLoader(Value tensor, Value base, SmallVector<int64_t> shape,
-                       Value warpId, unsigned int dimWpt, bool trans,
-                       SmallVector<unsigned int> instrShape,
-                       ConversionPatternRewriter &rewriter, Location loc)
-      : base(base), shape(shape), warpId(warpId), dimWpt(dimWpt), trans(trans),
-        instrShape(instrShape) {
-    auto ty = cast<MemDescType>(tensor.getType());
-    auto sharedLayout = cast<SharedEncodingAttr>(ty.getEncoding());
-    ord = sharedLayout.getOrder();
-    const int perPhase = sharedLayout.getPerPhase();
-    const int maxPhase = sharedLayout.getMaxPhase();
-    elemBytes = ty.getElementTypeBitWidth() / 8;
-    elemsPerSwizzlingRow = 128 / perPhase / elemBytes;
-    elemsPerSwizzlingRowVal = i32_val(elemsPerSwizzlingRow);
-
-    uint32_t widthInByte = shape[ord[0]] * elemBytes;
-    int64_t swizzling = getSwizzlingFromLayout(sharedLayout, widthInByte);
-
-    descriptor = createDescriptor(rewriter, loc, swizzling, shape[ord[1]]);
-  }
-
-  Value smemLoad(int a, int b, ConversionPatternRewriter &rewriter,
-                 Location loc) {
-    Value k = i32_val(b * instrShape[1]);
-    Value m = add(i32_val(a * dimWpt * instrShape[0]),
-                  mul(warpId, i32_val(instrShape[0])));
-    if (trans) {
-      std::swap(k, m);
-    }
-    Value leading_offset = mul(udiv(k, elemsPerSwizzlingRowVal),
-                               i32_val(shape[ord[1]] * elemsPerSwizzlingRow));
-    Value stride_offset = mul(m, elemsPerSwizzlingRowVal);
-    Value offset = add(add(leading_offset, stride_offset),
-                       urem(k, elemsPerSwizzlingRowVal));
-    Value off1 = mul(i32_val(elemBytes), offset);
-    Value off_ = zext(i64_ty, udiv(off1, i32_val(16)));
-
-    Value loadDesc = add(descriptor, off_);
-    // Add the base at the end to make it easier to do loop invariant code
-    // motion.
-    loadDesc = add(loadDesc, lshr(shl(ptrtoint(i64_ty, base), int_val(64, 46)),
-                                  int_val(64, 50)));
-    return loadDesc;
-  }
-
-private:
-  Value base;
-  SmallVector<int64_t> shape;
-  Value warpId;
-  int dimWpt;
-  bool trans;
-  Value elemsPerSwizzlingRowVal;
-  SmallVector<unsigned int> instrShape;
-  ArrayRef<unsigned> ord;
-  int elemsPerSwizzlingRow;
-  int elemBytes;
-  Value descriptor;
-};
-
 DotOpMmaV3SmemLoader loadA(const LLVMTypeConverter *typeConverter,
                            ConversionPatternRewriter &rewriter, Location loc,
                            const NvidiaMmaEncodingAttr &mmaEncoding,
@@ -358,8 +232,8 @@ LogicalResult convertDot(const LLVMTypeConverter *typeConverter,
                          ConversionPatternRewriter &rewriter, Location loc,
                          Operation *op, Value a, Value b, Value c, Value d,
                          Value loadedA, Value loadedB, Value loadedC,
-                         bool allowTF32, uint32_t maxNumImpreciseAcc, bool sync,
-                         Value thread) {
+                         bool allowTF32, uint32_t maxNumImpreciseAcc,
+                         int kExtent, bool sync, Value thread) {
   auto aTensorTy = cast<TensorOrMemDesc>(a.getType());
   auto bTensorTy = cast<TensorOrMemDesc>(b.getType());
   auto dTensorTy = cast<RankedTensorType>(d.getType());
@@ -396,6 +270,8 @@ LogicalResult convertDot(const LLVMTypeConverter *typeConverter,
   int numRepM = ceil<unsigned>(dShapePerCTA[0], shapePerCTATile[0]);
   int numRepN = ceil<unsigned>(dShapePerCTA[1], shapePerCTATile[1]);
   int numRepK = ceil<unsigned>(aTensorTy.getShape()[1], instrShape[2]);
+  // The K steps past the extent of the operands multiply zeros.
+  int numStepsK = kExtent > 0 ? ceil<int>(kExtent, K) : numRepK;
   DotOpMmaV3SmemLoader aLoader;
   SmallVector<Value> structA;
   if (aSharedLayout) {
@@ -440,7 +316,7 @@ LogicalResult convertDot(const LLVMTypeConverter *typeConverter,
         d = packLLElements(loc, typeConverter, mmaOut, rewriter, accTy);
       uint32_t numLowPrecisionAcc = 0;
       Value partialAcc;
-      for (int k = 0; k < numRepK; ++k) {
+      for (int k = 0; k < numStepsK; ++k) {
         Value a;
         if (aSharedLayout) {
           a = aLoader.smemLoad(m, k, rewriter, loc);
@@ -460,7 +336,7 @@ LogicalResult convertDot(const LLVMTypeConverter *typeConverter,
         // accumulation than allowed do a separate allocation.
         bool requireAddAccumulator =
             needsPartialAccumulator &&
-            (numLowPrecisionAcc >= maxNumImpreciseAcc || k == numRepK - 1);
+            (numLowPrecisionAcc >= maxNumImpreciseAcc || k == numStepsK - 1);
         Value mmaAcc = needsPartialAccumulator ? partialAcc : d;
         mmaAcc = rewriter.create<triton::nvgpu::WGMMAOp>(
             loc, accTy, a, b, mmaAcc, M, N, K, eltTypeC, eltTypeA, eltTypeB,
@@ -514,5 +390,6 @@ LogicalResult convertWGMMA(triton::nvidia_gpu::WarpGroupDotOp op,
                     op.getA(), op.getB(), op.getC(), op.getD(),              //
                     adaptor.getA(), adaptor.getB(), adaptor.getC(),
                     op.getInputPrecision() == InputPrecision::TF32,
-                    op.getMaxNumImpreciseAcc(), !op.getIsAsync(), thread);
+                    op.getMaxNumImpreciseAcc(), op.getKExtent(),
+                    !op.getIsAsync(), thread);
 }
@@ -235,6 +235,44 @@ static const std::string S8_to_Bf16 =
     "prmt.b32 $1, f2, f3, 0x7632;                \n" //
     "}";
 
+/* ----- Packed 4-bit integer to FP16/BF16 ------ */
+// Converts four 4-bit integers, held in the low nibbles of the bytes of $2, to
+// four fp16 or bf16 values packed in $0 and $1. Instead of converting each
+// value, the nibbles are inserted with lop3 into the mantissa of a magic
+// number, 1024 for fp16 and 128 for bf16, whose ulp is 1, and the magic number
+// is subtracted for two values at a time. Signed values are biased by 8 by
+// flipping their sign bit in the same lop3, and the bias is subtracted back.
+static std::string getI4ToFp16x4Ptx(bool isSigned, bool isBf16) {
+  std::string magic = isBf16 ? (isSigned ? "0x43084308" : "0x43004300")
+                             : (isSigned ? "0x64086408" : "0x64006400");
+  // (a & b) ^ c when signed, (a & b) | c otherwise.
+  std::string lut = isSigned ? "0x6a" : "0xea";
+  // There is no sub.bf16x2 before sm_90, so bf16 uses an fma by 1.
+  std::string sub =
+      isBf16 ? "mov.b32 one, 0x3f803f80;\n"
+               "mov.b32 bias, " +
+                   std::string(isSigned ? "0xc308c308" : "0xc300c300") +
+                   ";\n"
+                   "fma.rn.bf16x2 a0, a0, one, bias;\n"
+                   "fma.rn.bf16x2 a1, a1, one, bias;\n"
+             : "mov.b32 bias, " + magic +
+                   ";\n"
+                   "sub.f16x2 a0, a0, bias;\n"
+                   "sub.f16x2 a1, a1, bias;\n";
+  return "{\n"
+         ".reg .b32 a<2>, s, one, bias;\n"
+         // a0 = {v0, v2}, a1 = {v1, v3}
+         "lop3.b32 a0, $2, 0x000f000f, " +
+         magic + ", " + lut +
+         ";\n"
+         "shr.b32 s, $2, 8;\n"
+         "lop3.b32 a1, s, 0x000f000f, " +
+         magic + ", " + lut + ";\n" + sub +
+         "prmt.b32 $0, a0, a1, 0x5410;\n"
+         "prmt.b32 $1, a0, a1, 0x7632;\n"
+         "}";
+}
+
 typedef std::function<SmallVector<Value>(Location, ConversionPatternRewriter &,
                                          const SmallVector<Value> &)>
     ConverterT;
@@ -552,6 +590,25 @@ struct FDivOpConversion
   }
 };
 
+// Returns the results of `ptxAsm`, which computes `$0` from `$1` and `$2` with
+// `fma.rn.bf16x2`, on the pairs of bf16 elements of the first 2 operand sets
+// of `operands`, packed in 32-bit registers.
+static SmallVector<Value>
+createBF16x2FmaOps(Location loc, ConversionPatternRewriter &rewriter,
+                   MultipleOperandsRange operands, const char *ptxAsm) {
+  return createPackedDestOps(
+      rewriter, loc, bf16_ty, operands, [&](Type vecTy, ValueRange args) {
+        PTXBuilder builder;
+        auto &fma = *builder.create<PTXInstr>(ptxAsm);
+        auto res = builder.newOperand("=r");
+        auto lhs = builder.newOperand(bitcast(args[0], i32_ty), "r");
+        auto rhs = builder.newOperand(bitcast(args[1], i32_ty), "r");
+        fma({res, lhs, rhs}, /*onlyAttachMLIRArgs=*/true);
+        return bitcast(builder.launch(rewriter, loc, i32_ty, false), vecTy)
+            .getResult();
+      });
+}
+
 struct FMulOpConversion
     : ElementwiseOpConversionBase<arith::MulFOp, FMulOpConversion> {
   using Base = ElementwiseOpConversionBase<arith::MulFOp, FMulOpConversion>;
@@ -564,6 +621,19 @@ struct FMulOpConversion
                                    Location loc) const {
     auto lhsElemTy = getElementType(op.getLhs());
     auto rhsElemTy = getElementType(op.getRhs());
+    bool packed = operands.size() >= 2 && canPackElementPairs(op);
+    if (lhsElemTy.isBF16() && rhsElemTy.isBF16() && packed) {
+      auto ptxAsm = "{ .reg .b32 c;             \n"
+                    "   mov.b32 c, 0x80008000U; \n" // -0.0
+                    "   fma.rn.bf16x2 $0, $1, $2, c; } \n";
+      return createBF16x2FmaOps(loc, rewriter, operands, ptxAsm);
+    }
+    if (elemTy.isF16() && packed)
+      return createPackedDestOps(
+          rewriter, loc, elemTy, operands, [&](Type vecTy, ValueRange args) {
+            return rewriter.create<LLVM::FMulOp>(loc, vecTy, args[0], args[1])
+                .getResult();
+          });
     if (lhsElemTy.isBF16() && rhsElemTy.isBF16()) {
       PTXBuilder builder;
       auto ptxAsm = " { .reg .b16 c;        \n"
@@ -594,6 +664,19 @@ struct FAddOpConversion
                                    Location loc) const {
     auto lhsElemTy = getElementType(op.getLhs());
     auto rhsElemTy = getElementType(op.getRhs());
+    bool packed = operands.size() >= 2 && canPackElementPairs(op);
+    if (lhsElemTy.isBF16() && rhsElemTy.isBF16() && packed) {
+      auto ptxAsm = "{ .reg .b32 c;             \n"
+                    "   mov.b32 c, 0x3f803f80U; \n" // 1.0
+                    "   fma.rn.bf16x2 $0, $1, c, $2; } \n";
+      return createBF16x2FmaOps(loc, rewriter, operands, ptxAsm);
+    }
+    if (elemTy.isF16() && packed)
+      return createPackedDestOps(
+          rewriter, loc, elemTy, operands, [&](Type vecTy, ValueRange args) {
+            return rewriter.create<LLVM::FAddOp>(loc, vecTy, args[0], args[1])
+                .getResult();
+          });
     if (lhsElemTy.isBF16() && rhsElemTy.isBF16()) {
       PTXBuilder builder;
       auto ptxAsm = "{ .reg .b16 c;         \n"
@@ -624,6 +707,19 @@ struct FSubOpConversion
                                    Location loc) const {
     auto lhsElemTy = getElementType(op.getLhs());
     auto rhsElemTy = getElementType(op.getRhs());
+    bool packed = operands.size() >= 2 && canPackElementPairs(op);
+    if (lhsElemTy.isBF16() && rhsElemTy.isBF16() && packed) {
+      auto ptxAsm = "{ .reg .b32 c;             \n"
+                    "   mov.b32 c, 0xbf80bf80U; \n" // -1.0
+                    "   fma.rn.bf16x2 $0, $2, c, $1; } \n";
+      return createBF16x2FmaOps(loc, rewriter, operands, ptxAsm);
+    }
+    if (elemTy.isF16() && packed)
+      return createPackedDestOps(
+          rewriter, loc, elemTy, operands, [&](Type vecTy, ValueRange args) {
+            return rewriter.create<LLVM::FSubOp>(loc, vecTy, args[0], args[1])
+                .getResult();
+          });
     if (lhsElemTy.isBF16() && rhsElemTy.isBF16()) {
       PTXBuilder builder;
       auto ptxAsm = " { .reg .b16 c;         \n"
@@ -642,6 +738,29 @@ struct FSubOpConversion
   }
 };
 
+// Converts 4 4-bit integers to fp16 or bf16 with the magic number conversion
+// of getI4ToFp16x4Ptx, or returns an empty vector if the conversion does not
+// apply.
+static SmallVector<Value> convertI4ToFp16x4(Location loc,
+                                            ConversionPatternRewriter &rewriter,
+                                            Type inElemTy, Type outElemTy,
+                                            MultipleOperandsRange operands,
+                                            bool isSigned) {
+  if (!inElemTy.isInteger(4) || !(outElemTy.isF16() || outElemTy.isBF16()) ||
+      operands.size() < 4)
+    return {};
+  // Widen the nibbles to bytes: the conversion ignores their upper bits.
+  SmallVector<Value> inVals;
+  for (int i = 0; i < 4; ++i)
+    inVals.push_back(zext(i8_ty, operands[i][0]));
+  auto cvtFunc = makeConverterFromPtx(
+      getI4ToFp16x4Ptx(isSigned, outElemTy.isBF16()), i8_ty,
+      outElemTy.isBF16() ? bf16_ty : f16_ty);
+  auto outVals = cvtFunc(loc, rewriter, inVals);
+  assert(outVals.size() == 4);
+  return outVals;
+}
+
 // Uses inline ptx to convert s8/u8 to bf16, since the
 struct SIToFPOpConversion
     : ElementwiseOpConversionBase<arith::SIToFPOp, SIToFPOpConversion> {
@@ -655,6 +774,10 @@ struct SIToFPOpConversion
                                    Location loc) const {
     Type inElemTy = getElementType(op.getIn());
     Type outElemTy = getElementType(op.getOut());
+    auto i4Vals = convertI4ToFp16x4(loc, rewriter, inElemTy, outElemTy,
+                                    operands, /*isSigned=*/true);
+    if (!i4Vals.empty())
+      return i4Vals;
     if (outElemTy.isBF16() && inElemTy.isInteger(8) && operands.size() >= 4) {
       auto cvtFunc = makeConverterFromPtx(
           S8_to_Bf16, getTypeConverter()->convertType(inElemTy),
@@ -674,6 +797,24 @@ struct SIToFPOpConversion
   }
 };
 
+// Only handles the vectorized conversion of 4-bit integers, the other cases
+// are left to the common lowering of UIToFPOp.
+struct UIToFPOpConversion
+    : ElementwiseOpConversionBase<arith::UIToFPOp, UIToFPOpConversion> {
+  using Base = ElementwiseOpConversionBase<arith::UIToFPOp, UIToFPOpConversion>;
+  using Base::Base;
+  using Adaptor = typename Base::OpAdaptor;
+
+  SmallVector<Value> createDestOps(arith::UIToFPOp op, OpAdaptor adaptor,
+                                   ConversionPatternRewriter &rewriter,
+                                   Type elemTy, MultipleOperandsRange operands,
+                                   Location loc) const {
+    return convertI4ToFp16x4(loc, rewriter, getElementType(op.getIn()),
+                             getElementType(op.getOut()), operands,
+                             /*isSigned=*/false);
+  }
+};
+
 struct FPToSIOpConversion
     : ElementwiseOpConversionBase<arith::FPToSIOp, FPToSIOpConversion> {
   using Base = ElementwiseOpConversionBase<arith::FPToSIOp, FPToSIOpConversion>;
@@ -766,6 +907,94 @@ struct ExpOpConversionApprox
   }
 };
 
+// Lowers f32 `SourceOp` to the approximate PTX instruction `ptxInstr`, e.g.
+// `lg2.approx.f32`, whose result is multiplied by `scale`.
+template <typename SourceOp>
+struct FastMathOpConversion
+    : ElementwiseOpConversionBase<SourceOp, FastMathOpConversion<SourceOp>> {
+  using Base =
+      ElementwiseOpConversionBase<SourceOp, FastMathOpConversion<SourceOp>>;
+  using Adaptor = typename Base::OpAdaptor;
+
+  FastMathOpConversion(LLVMTypeConverter &typeConverter,
+                       ModuleAxisInfoAnalysis &axisAnalysisPass,
+                       StringRef ptxInstr, double scale,
+                       PatternBenefit benefit)
+      : Base(typeConverter, axisAnalysisPass, benefit), ptxInstr(ptxInstr),
+        scale(scale) {}
+
+  SmallVector<Value> createDestOps(SourceOp op, Adaptor adaptor,
+                                   ConversionPatternRewriter &rewriter,
+                                   Type elemTy, MultipleOperandsRange operands,
+                                   Location loc) const {
+    // Other types keep their precise lowering.
+    if (!elemTy.isF32())
+      return {};
+    PTXBuilder ptxBuilder;
+    auto &instr = *ptxBuilder.create<PTXInstr>(ptxInstr.str());
+    SmallVector<PTXBuilder::Operand *> ptxOperands = {
+        ptxBuilder.newOperand("=f")};
+    for (Value operand : operands[0])
+      ptxOperands.push_back(ptxBuilder.newOperand(operand, "f"));
+    instr(ptxOperands);
+    Value ret = ptxBuilder.launch(rewriter, loc, f32_ty, false);
+    if (scale != 1.0)
+      ret = fmul(f32_ty, ret, f32_val(scale));
+    return {ret};
+  }
+
+private:
+  StringRef ptxInstr;
+  double scale;
+};
+
+// Lowers f16 and bf16 exp2 to `ex2.approx`, which runs on 16-bit values on
+// sm_75+ for f16 and sm_90+ for bf16, rather than extending them to f32. Pairs
+// of elements held by the same thread are packed into a single instruction, so
+// that the SFUs evaluate two exponentials per issue.
+struct Exp2OpConversion
+    : ElementwiseOpConversionBase<math::Exp2Op, Exp2OpConversion> {
+  using Base = ElementwiseOpConversionBase<math::Exp2Op, Exp2OpConversion>;
+  using Adaptor = typename Base::OpAdaptor;
+
+  Exp2OpConversion(LLVMTypeConverter &typeConverter,
+                   ModuleAxisInfoAnalysis &axisAnalysisPass,
+                   int computeCapability, PatternBenefit benefit)
+      : Base(typeConverter, axisAnalysisPass, benefit),
+        computeCapability(computeCapability) {}
+
+  SmallVector<Value> createDestOps(math::Exp2Op op, OpAdaptor adaptor,
+                                   ConversionPatternRewriter &rewriter,
+                                   Type elemTy, MultipleOperandsRange operands,
+                                   Location loc) const {
+    bool isF16 = elemTy.isF16() && computeCapability >= 75;
+    bool isBF16 = elemTy.isBF16() && computeCapability >= 90;
+    if (!isF16 && !isBF16)
+      return {};
+    std::string instr = isF16 ? "ex2.approx.f16" : "ex2.approx.ftz.bf16";
+    if (operands.size() >= 2 && canPackElementPairs(op))
+      return createPackedDestOps(
+          rewriter, loc, elemTy, operands, [&](Type vecTy, ValueRange args) {
+            PTXBuilder builder;
+            auto &ex2 = *builder.create<PTXInstr>(instr + "x2");
+            auto res = builder.newOperand("=r");
+            auto arg = builder.newOperand(bitcast(args[0], i32_ty), "r");
+            ex2(res, arg);
+            return bitcast(builder.launch(rewriter, loc, i32_ty, false), vecTy)
+                .getResult();
+          });
+    PTXBuilder builder;
+    auto &ex2 = *builder.create<PTXInstr>(instr);
+    auto res = builder.newOperand("=h");
+    auto arg = builder.newOperand(operands[0][0], "h");
+    ex2(res, arg);
+    return {builder.launch(rewriter, loc, elemTy, false)};
+  }
+
+private:
+  int computeCapability;
+};
+
 struct ClampFOpConversion
     : ElementwiseOpConversionBase<ClampFOp, ClampFOpConversion> {
   using Base = ElementwiseOpConversionBase<ClampFOp, ClampFOpConversion>;
@@ -931,6 +1160,9 @@ void mlir::triton::NVIDIA::populateElementwiseOpToLLVMPatterns(
   patterns.add<TruncFOpConversion>(typeConverter, axisInfoAnalysis, benefit);
   patterns.add<FPToSIOpConversion>(typeConverter, axisInfoAnalysis, benefit);
   patterns.add<SIToFPOpConversion>(typeConverter, axisInfoAnalysis, benefit);
+  // Takes precedence over the common UIToFPOp lowering for 4-bit integers.
+  patterns.add<UIToFPOpConversion>(typeConverter, axisInfoAnalysis,
+                                   benefit.getBenefit() + 1);
 
   patterns.add<FpToFpOpConversion>(typeConverter, axisInfoAnalysis,
                                    computeCapability, benefit);
@@ -940,6 +1172,9 @@ void mlir::triton::NVIDIA::populateElementwiseOpToLLVMPatterns(
   // ElementwiseOpConversion<math::ExpOp, math::ExpOp> defined below will call
   // __nv_expf for higher-precision calculation
   patterns.add<ExpOpConversionApprox>(typeConverter, axisInfoAnalysis, benefit);
+  // Takes precedence over the common Exp2Op lowering for f16 and bf16.
+  patterns.add<Exp2OpConversion>(typeConverter, axisInfoAnalysis,
+                                 computeCapability, benefit.getBenefit() + 1);
   bool hwNanPropagationSupported = computeCapability >= 80;
   mlir::triton::populateMinMaxFOpToLLVMPattern(
       typeConverter, patterns, axisInfoAnalysis, hwNanPropagationSupported,
@@ -948,6 +1183,31 @@ void mlir::triton::NVIDIA::populateElementwiseOpToLLVMPatterns(
       typeConverter, patterns, axisInfoAnalysis, targetInfo, benefit);
 }
 
+void mlir::triton::NVIDIA::populateFastMathOpToLLVMPatterns(
+    LLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
+    ModuleAxisInfoAnalysis &axisInfoAnalysis, PatternBenefit benefit) {
+  using namespace mlir::triton::gpu;
+
+  const double ln2 = 0.6931471805599453;
+  // f32 exp is always lowered to ex2.approx.f32.
+  patterns.add<FastMathOpConversion<math::Exp2Op>>(
+      typeConverter, axisInfoAnalysis, "ex2.approx.f32", 1.0, benefit);
+  patterns.add<FastMathOpConversion<math::Log2Op>>(
+      typeConverter, axisInfoAnalysis, "lg2.approx.f32", 1.0, benefit);
+  patterns.add<FastMathOpConversion<math::LogOp>>(
+      typeConverter, axisInfoAnalysis, "lg2.approx.f32", ln2, benefit);
+  patterns.add<FastMathOpConversion<math::SinOp>>(
+      typeConverter, axisInfoAnalysis, "sin.approx.f32", 1.0, benefit);
+  patterns.add<FastMathOpConversion<math::CosOp>>(
+      typeConverter, axisInfoAnalysis, "cos.approx.f32", 1.0, benefit);
+  patterns.add<FastMathOpConversion<math::SqrtOp>>(
+      typeConverter, axisInfoAnalysis, "sqrt.approx.f32", 1.0, benefit);
+  patterns.add<FastMathOpConversion<math::RsqrtOp>>(
+      typeConverter, axisInfoAnalysis, "rsqrt.approx.f32", 1.0, benefit);
+  patterns.add<FastMathOpConversion<arith::DivFOp>>(
+      typeConverter, axisInfoAnalysis, "div.approx.f32", 1.0, benefit);
+}
+
 void mlir::triton::NVIDIA::populateClampFOpToLLVMPattern(
     LLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
     ModuleAxisInfoAnalysis &axisInfoAnalysis, int computeCapability,
@@ -1,6 +1,7 @@
 #include "TargetInfo.h"
 #include "mlir/IR/Matchers.h"
 #include "mlir/IR/TypeUtilities.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 
 #include "PatternTritonGPUOpToLLVM.h"
 #include "TritonNVIDIAGPUToLLVM/PTXAsmFormat.h"
@@ -8,7 +9,9 @@
 #include "Utility.h"
 #include "triton/Conversion/TritonGPUToLLVM/Utility.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/LinearLayoutConversions.h"
 #include "triton/Dialect/TritonGPU/Transforms/Utility.h"
+#include "triton/Tools/Sys/GetEnv.hpp"
 
 using namespace mlir;
 using namespace mlir::triton;
@@ -98,6 +101,41 @@ Value redundantDataMask(Type valueTy, ConversionPatternRewriter &rewriter,
   return mask;
 }
 
+// Returns true if `ptr` is only based on kernel arguments marked `tt.const`,
+// whose data is not modified while the kernel runs, so that loads of it can go
+// through the non-coherent read-only data path.
+bool isBasedOnConstArgs(Value ptr) {
+  DenseSet<unsigned> args;
+  if (!getPointerBaseArgs(ptr, args))
+    return false;
+  auto funcOp = ptr.getParentRegion()->getParentOfType<FunctionOpInterface>();
+  return llvm::all_of(args, [&](unsigned arg) {
+    return bool(funcOp.getArgAttr(arg, "tt.const"));
+  });
+}
+
+// Returns an L2 cache policy for the L2 eviction priority of `evict` created
+// with createpolicy, or a null value if `evict` has none.
+Value createL2CachePolicy(triton::EvictionPolicy evict, int computeCapability,
+                          ConversionPatternRewriter &rewriter, Location loc) {
+  // createpolicy and L2::cache_hint require sm_80.
+  if (computeCapability < 80)
+    return Value();
+  std::string priority;
+  if (evict == triton::EvictionPolicy::EVICT_FIRST)
+    priority = "L2::evict_first";
+  else if (evict == triton::EvictionPolicy::EVICT_LAST)
+    priority = "L2::evict_last";
+  else
+    return Value();
+  PTXBuilder ptxBuilder;
+  auto &createPolicy =
+      ptxBuilder.create<>("createpolicy")->o("fractional").o(priority).b(64);
+  createPolicy(ptxBuilder.newOperand("=l"),
+               ptxBuilder.newConstantOperand("1.0"));
+  return ptxBuilder.launch(rewriter, loc, i64_ty, /*hasSideEffect=*/false);
+}
+
 // Contains some helper functions for both Load and Store conversions.
 struct LoadStoreConversionBase {
   explicit LoadStoreConversionBase(const NVIDIA::TargetInfo &targetInfo,
@@ -127,7 +165,68 @@ struct LoadStoreConversionBase {
     return axisAnalysisPass.getMaskAlignment(mask);
   }
 
+  // Records the vector width `vec` chosen for the memory access `op` together
+  // with the fact that limited it.  If the mask is only known to be uniform
+  // over `maskVec` < `vec` elements, vectors that are partially masked off
+  // are accessed `maskVec` elements at a time.  The entries are collected in
+  // the "triton_gpu.vectorization" module attribute, which ends up in the
+  // kernel metadata, and are emitted as remarks if
+  // TRITON_VECTORIZATION_REPORT is set.
+  void reportVectorSize(Operation *op, Value ptr, unsigned vec,
+                        unsigned maskVec) const {
+    auto tensorTy = dyn_cast<RankedTensorType>(ptr.getType());
+    if (!tensorTy)
+      return;
+    auto layout = tensorTy.getEncoding();
+    auto order = triton::gpu::getOrder(layout);
+    unsigned pointeeBitWidth = triton::getPointeeBitWidth(tensorTy);
+    SmallVector<std::pair<StringRef, int64_t>> limits;
+    limits.push_back({"128-bit access width", 128 / pointeeBitWidth});
+    limits.push_back(
+        {"sizePerThread", triton::gpu::getUniqueContigPerThread(
+                              layout, tensorTy.getShape())[order[0]]});
+    if (auto *axisInfo = axisAnalysisPass.getAxisInfo(ptr)) {
+      int64_t elemBytes = std::max<int64_t>(pointeeBitWidth / 8, 1);
+      limits.push_back(
+          {"pointer contiguity", axisInfo->getContiguity(order[0])});
+      limits.push_back(
+          {"pointer divisibility",
+           std::max<int64_t>(axisInfo->getDivisibility(order[0]) / elemBytes,
+                             1)});
+    }
+    auto limit = llvm::find_if(
+        limits, [&](auto &bound) { return bound.second == vec; });
+
+    std::string message;
+    llvm::raw_string_ostream messageOs(message);
+    messageOs << vec << " x " << pointeeBitWidth << "-bit";
+    if (limit != limits.end())
+      messageOs << ", limited by " << limit->first;
+    if (maskVec < vec)
+      messageOs << "; " << maskVec << " x " << pointeeBitWidth
+                << "-bit where partially masked, limited by mask constancy";
+    if (triton::tools::getBoolEnv("TRITON_VECTORIZATION_REPORT"))
+      op->emitRemark() << "vectorized to " << message;
+
+    std::string entry;
+    llvm::raw_string_ostream os(entry);
+    if (auto fileLoc = op->getLoc()->findInstanceOf<FileLineColLoc>())
+      os << fileLoc.getFilename().getValue() << ":" << fileLoc.getLine()
+         << ":" << fileLoc.getColumn() << ": ";
+    os << op->getName() << ": " << message;
+    auto mod = op->getParentOfType<ModuleOp>();
+    SmallVector<Attribute> entries;
+    if (auto report = mod->getAttrOfType<ArrayAttr>(kVectorizationAttrName))
+      entries.append(report.begin(), report.end());
+    entries.push_back(StringAttr::get(op->getContext(), os.str()));
+    mod->setAttr(kVectorizationAttrName,
+                 ArrayAttr::get(op->getContext(), entries));
+  }
+
 protected:
+  static constexpr llvm::StringLiteral kVectorizationAttrName =
+      "triton_gpu.vectorization";
+
   const NVIDIA::TargetInfo &targetInfo;
   ModuleAxisInfoAnalysis &axisAnalysisPass;
 };
@@ -166,12 +265,15 @@ struct LoadOpConversion : public ConvertOpToLLVMPattern<triton::LoadOp>,
         typeConverter->convertType(getElementTypeOrSelf(op.getType()));
     unsigned vec = getVectorSize(ptr);
     unsigned numElems = getTotalElemsPerThread(ptr.getType());
+    // Number of consecutive elements that are known to share a mask bit.
+    unsigned maskVec = vec;
     if (llMask) {
       LLVM_DEBUG(DBGS() << "vec = " << vec
                         << " mask_alignment = " << getMaskAlignment(mask));
-      vec = std::min<size_t>(vec, getMaskAlignment(mask));
-      LLVM_DEBUG(llvm::dbgs() << " vec = " << vec << '\n');
+      maskVec = std::min<size_t>(vec, getMaskAlignment(mask));
+      LLVM_DEBUG(llvm::dbgs() << " vec = " << maskVec << '\n');
     }
+    reportVectorSize(op, ptr, vec, maskVec);
 
     // Get the LLVM values for pointers
     auto ptrElems = unpackLLElements(loc, llPtr, rewriter);
@@ -204,31 +306,46 @@ struct LoadOpConversion : public ConvertOpToLLVMPattern<triton::LoadOp>,
     // vectorized iteration through all the pointer/mask/other elements
     const int valueElemNBits =
         std::max(8u, valueElemTy.getIntOrFloatBitWidth());
-    const int numVecs = numElems / vec;
+
+    int computeCapability = targetInfo.getComputeCapability();
+    // evict_first (streaming) and evict_last (persisting) also set the L2
+    // eviction priority of the accessed lines through a cache policy.
+    Value l2Policy =
+        createL2CachePolicy(op.getEvict(), computeCapability, rewriter, loc);
+    bool readOnly = !op.getIsVolatile() && isBasedOnConstArgs(ptr);
+    // Streaming loads covering a contiguous 256-byte range have L2 fetch the
+    // whole range at once.
+    bool prefetch256B = false;
+    if (auto tensorTy = dyn_cast<RankedTensorType>(ptr.getType());
+        tensorTy && computeCapability >= 80 &&
+        op.getEvict() == triton::EvictionPolicy::EVICT_FIRST) {
+      auto order = triton::gpu::getOrder(tensorTy.getEncoding());
+      if (auto *axisInfo = axisAnalysisPass.getAxisInfo(ptr))
+        prefetch256B = axisInfo->getContiguity(order[0]) *
+                           (valueElemNBits / 8) >=
+                       256;
+    }
 
     LDBG("LoadOp numElems = " << numElems << " vec = " << vec
                               << " valueElemNBits = " << valueElemNBits << " "
                               << op.getType());
-    SmallVector<Value> loadedVals;
-    for (size_t vecStart = 0; vecStart < numElems; vecStart += vec) {
+    // Loads the `vecSize` elements starting at `vecStart` with one predicated
+    // access.  Elements that are predicated off are set to `other`.
+    auto loadVector = [&](size_t vecStart, unsigned vecSize, Value pred,
+                          SmallVectorImpl<Value> &loadedVals) {
       // TODO: optimization when ptr is GEP with constant offset
       size_t in_off = 0;
 
       const size_t maxWordWidth = std::max<size_t>(32, valueElemNBits);
-      const size_t totalWidth = valueElemNBits * vec;
+      const size_t totalWidth = valueElemNBits * vecSize;
       const size_t width = std::min(totalWidth, maxWordWidth);
       const size_t nWords = std::max<size_t>(1, totalWidth / width);
       const size_t wordNElems = width / valueElemNBits;
       const size_t movWidth = width < 16 ? 16 : width;
-      assert(wordNElems * nWords * numVecs == numElems);
-
-      // TODO(Superjomn) Add cache policy fields to StoreOp.
-      // TODO(Superjomn) Deal with cache policy here.
-      const bool hasL2EvictPolicy = false;
+      assert(wordNElems * nWords == vecSize);
 
       PTXBuilder ptxBuilder;
 
-      Value pred = mask ? maskElems[vecStart] : int_val(1, 1);
 
       const std::string readConstraint =
           (width == 64) ? "l" : ((width == 32) ? "r" : "c");
@@ -252,19 +369,21 @@ struct LoadOpConversion : public ConvertOpToLLVMPattern<triton::LoadOp>,
                      .global()
                      .o("ca", op.getCache() == triton::CacheModifier::CA)
                      .o("cg", op.getCache() == triton::CacheModifier::CG)
+                     .o("nc", readOnly)
                      .o("L1::evict_first",
                         op.getEvict() == triton::EvictionPolicy::EVICT_FIRST)
                      .o("L1::evict_last",
                         op.getEvict() == triton::EvictionPolicy::EVICT_LAST)
-                     .o("L1::cache_hint", hasL2EvictPolicy)
+                     .o("L1::no_allocate",
+                        op.getEvict() == triton::EvictionPolicy::NO_ALLOCATE)
+                     .o("L2::cache_hint", static_cast<bool>(l2Policy))
+                     .o("L2::256B", prefetch256B)
                      .v(nWords)
                      .b(width);
 
       PTXBuilder::Operand *evictOpr{};
-
-      // Here lack a mlir::Value to bind to this operation, so disabled.
-      // if (has_l2_evict_policy)
-      //   evictOpr = ptxBuilder.newOperand(l2Evict, "l");
+      if (l2Policy)
+        evictOpr = ptxBuilder.newOperand(l2Policy, "l");
 
       if (!evictOpr)
         ld(dstsOpr, addrOpr).predicate(pred, "b");
@@ -308,10 +427,6 @@ struct LoadOpConversion : public ConvertOpToLLVMPattern<triton::LoadOp>,
                        ? LLVM::LLVMStructType::getLiteral(getContext(), retTys)
                        : retTys[0];
 
-      // TODO: if (has_l2_evict_policy)
-      // auto asmDialectAttr =
-      // LLVM::AsmDialectAttr::get(rewriter.getContext(),
-      //                                                 LLVM::AsmDialect::AD_ATT);
       Value ret = ptxBuilder.launch(rewriter, loc, retTy);
 
       // Extract and store return values
@@ -328,13 +443,39 @@ struct LoadOpConversion : public ConvertOpToLLVMPattern<triton::LoadOp>,
         rets.push_back(curr);
       }
       int tmp = width / valueElemNBits;
-      for (size_t ii = 0; ii < vec; ++ii) {
+      for (size_t ii = 0; ii < vecSize; ++ii) {
         Value vecIdx = createIndexAttrConstant(
             rewriter, loc, typeConverter->getIndexType(), ii % tmp);
         Value loaded = extract_element(valueElemTy, rets[ii / tmp], vecIdx);
         loadedVals.push_back(loaded);
       }
-    } // end vec
+    };
+
+    SmallVector<Value> loadedVals;
+    for (size_t vecStart = 0; vecStart < numElems; vecStart += vec) {
+      if (!mask) {
+        loadVector(vecStart, vec, int_val(1, 1), loadedVals);
+        continue;
+      }
+      if (maskVec == vec) {
+        loadVector(vecStart, vec, maskElems[vecStart], loadedVals);
+        continue;
+      }
+      // The mask may change within the vector, which only happens at the
+      // edges of a ragged tensor.  Load the whole vector at once if all of
+      // its elements are enabled, and fall back to narrower loads otherwise.
+      Value allEnabled = maskElems[vecStart];
+      for (size_t ii = 1; ii < vec; ++ii)
+        allEnabled = and_(allEnabled, maskElems[vecStart + ii]);
+      Value notAllEnabled = xor_(allEnabled, int_val(1, 1));
+      SmallVector<Value> fullVals, partialVals;
+      loadVector(vecStart, vec, allEnabled, fullVals);
+      for (size_t ii = 0; ii < vec; ii += maskVec)
+        loadVector(vecStart + ii, maskVec,
+                   and_(maskElems[vecStart + ii], notAllEnabled), partialVals);
+      for (size_t ii = 0; ii < vec; ++ii)
+        loadedVals.push_back(select(allEnabled, fullVals[ii], partialVals[ii]));
+    }
 
     Type llvmResultStructTy = typeConverter->convertType(op.getType());
     Value resultStruct = packLLElements(loc, typeConverter, loadedVals,
@@ -379,34 +520,36 @@ struct StoreOpConversion : public ConvertOpToLLVMPattern<triton::StoreOp>,
 
     // Determine the vectorization size
     SmallVector<Value> maskElems;
+    unsigned maskVec = vec;
     if (llMask) {
       Value mask = op.getMask();
       maskElems = unpackLLElements(loc, llMask, rewriter);
       assert(valueElems.size() == maskElems.size());
 
       unsigned maskAlign = getMaskAlignment(mask);
-      vec = std::min(vec, maskAlign);
+      maskVec = std::min(vec, maskAlign);
     }
+    reportVectorSize(op, ptr, vec, maskVec);
 
     Value mask = redundantDataMask(valueTy, rewriter, loc, targetInfo);
     const size_t dtsize =
         std::max<int>(1, valueElemTy.getIntOrFloatBitWidth() / 8);
     const size_t valueElemNBits = dtsize * 8;
+    Value l2Policy = createL2CachePolicy(
+        op.getEvict(), targetInfo.getComputeCapability(), rewriter, loc);
 
-    const int numVecs = elemsPerThread / vec;
-    for (size_t vecStart = 0; vecStart < elemsPerThread; vecStart += vec) {
+    // Stores the `vecSize` elements starting at `vecStart` with one access
+    // predicated on `pred`.
+    auto storeVector = [&](size_t vecStart, unsigned vecSize, Value pred) {
       // TODO: optimization when ptr is AddPtr with constant offset
       size_t in_off = 0;
 
       const size_t maxWordWidth = std::max<size_t>(32, valueElemNBits);
-      const size_t totalWidth = valueElemNBits * vec;
+      const size_t totalWidth = valueElemNBits * vecSize;
       const size_t width = std::min(totalWidth, maxWordWidth);
       const size_t nWords = std::max<size_t>(1, totalWidth / width);
       const size_t wordNElems = width / valueElemNBits;
-      assert(wordNElems * nWords * numVecs == elemsPerThread);
-
-      // TODO(Superjomn) Add cache policy fields to StoreOp.
-      // TODO(Superjomn) Deal with cache policy here.
+      assert(wordNElems * nWords == vecSize);
 
       Type valArgTy = IntegerType::get(ctx, width);
       auto wordTy = vec_ty(valueElemTy, wordNElems);
@@ -436,8 +579,6 @@ struct StoreOpConversion : public ConvertOpToLLVMPattern<triton::StoreOp>,
       PTXBuilder ptxBuilder;
       auto *asmArgList = ptxBuilder.newListOperand(asmArgs);
 
-      Value maskVal = llMask ? and_(mask, maskElems[vecStart]) : mask;
-
       auto *asmAddr =
           ptxBuilder.newAddrOperand(ptrElems[vecStart], "l", in_off);
 
@@ -452,9 +593,17 @@ struct StoreOpConversion : public ConvertOpToLLVMPattern<triton::StoreOp>,
                  op.getEvict() == triton::EvictionPolicy::EVICT_FIRST)
               .o("L1::evict_last",
                  op.getEvict() == triton::EvictionPolicy::EVICT_LAST)
+              .o("L1::no_allocate",
+                 op.getEvict() == triton::EvictionPolicy::NO_ALLOCATE)
+              .o("L2::cache_hint", static_cast<bool>(l2Policy))
               .v(nWords)
               .b(width);
-      ptxStoreInstr(asmAddr, asmArgList).predicate(maskVal, "b");
+      if (l2Policy)
+        ptxStoreInstr(asmAddr, asmArgList,
+                      ptxBuilder.newOperand(l2Policy, "l"))
+            .predicate(pred, "b");
+      else
+        ptxStoreInstr(asmAddr, asmArgList).predicate(pred, "b");
 
       Type boolTy = getTypeConverter()->convertType(rewriter.getIntegerType(1));
       llvm::SmallVector<Type> argTys({boolTy, ptr.getType()});
@@ -463,6 +612,70 @@ struct StoreOpConversion : public ConvertOpToLLVMPattern<triton::StoreOp>,
       auto asmReturnTy = void_ty(ctx);
 
       ptxBuilder.launch(rewriter, loc, asmReturnTy);
+    };
+
+    for (size_t vecStart = 0; vecStart < elemsPerThread; vecStart += vec) {
+      if (!llMask) {
+        storeVector(vecStart, vec, mask);
+        continue;
+      }
+      if (maskVec == vec) {
+        storeVector(vecStart, vec, and_(mask, maskElems[vecStart]));
+        continue;
+      }
+      // See LoadOpConversion: store the whole vector at once if all of its
+      // elements are enabled, and fall back to narrower stores otherwise.
+      Value allEnabled = maskElems[vecStart];
+      for (size_t ii = 1; ii < vec; ++ii)
+        allEnabled = and_(allEnabled, maskElems[vecStart + ii]);
+      Value notAllEnabled = xor_(allEnabled, int_val(1, 1));
+      storeVector(vecStart, vec, and_(mask, allEnabled));
+      for (size_t ii = 0; ii < vec; ii += maskVec)
+        storeVector(
+            vecStart + ii, maskVec,
+            and_(mask, and_(maskElems[vecStart + ii], notAllEnabled)));
+    }
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
+struct PrefetchOpConversion : public ConvertOpToLLVMPattern<triton::PrefetchOp>,
+                              public LoadStoreConversionBase {
+  PrefetchOpConversion(LLVMTypeConverter &converter,
+                       const NVIDIA::TargetInfo &targetInfo,
+                       ModuleAxisInfoAnalysis &axisAnalysisPass,
+                       PatternBenefit benefit)
+      : ConvertOpToLLVMPattern<triton::PrefetchOp>(converter, benefit),
+        LoadStoreConversionBase(targetInfo, axisAnalysisPass) {}
+
+  LogicalResult
+  matchAndRewrite(triton::PrefetchOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op->getLoc();
+    Value ptr = op.getPtr();
+    Value llMask = adaptor.getMask();
+
+    // The elements of a vector are contiguous, so prefetching the first one
+    // brings the others into L2 with it. The vectors are those of a load,
+    // narrowed to where the mask is uniform.
+    unsigned vec = getVectorSize(ptr);
+    unsigned elemsPerThread = getTotalElemsPerThread(ptr.getType());
+    auto ptrElems = unpackLLElements(loc, adaptor.getPtr(), rewriter);
+    SmallVector<Value> maskElems;
+    if (llMask) {
+      maskElems = unpackLLElements(loc, llMask, rewriter);
+      vec = std::min(vec, getMaskAlignment(op.getMask()));
+    }
+
+    Value mask = redundantDataMask(ptr.getType(), rewriter, loc, targetInfo);
+    for (size_t vecStart = 0; vecStart < elemsPerThread; vecStart += vec) {
+      Value pred = llMask ? and_(mask, maskElems[vecStart]) : mask;
+      PTXBuilder ptxBuilder;
+      auto *asmAddr = ptxBuilder.newAddrOperand(ptrElems[vecStart], "l");
+      auto &prefetch = ptxBuilder.create<>("prefetch")->global().o("L2");
+      prefetch(asmAddr).predicate(pred, "b");
+      ptxBuilder.launch(rewriter, loc, void_ty(rewriter.getContext()));
     }
     rewriter.eraseOp(op);
     return success();
@@ -479,6 +692,50 @@ void createBarrier(ConversionPatternRewriter &rewriter, Location loc,
   }
 }
 
+bool isRelease(MemSemantic sem) {
+  return sem == MemSemantic::RELEASE || sem == MemSemantic::ACQUIRE_RELEASE;
+}
+
+bool isAcquire(MemSemantic sem) {
+  return sem == MemSemantic::ACQUIRE || sem == MemSemantic::ACQUIRE_RELEASE;
+}
+
+// Emits the fence that releases the accesses before it to the relaxed atomics
+// after it, or acquires the accesses after it from the relaxed atomics before
+// it, at `scope`.
+void createAtomicFence(ConversionPatternRewriter &rewriter, Location loc,
+                       MemSyncScope scope) {
+  PTXBuilder ptxBuilder;
+  std::string fence =
+      "fence.acq_rel." + stringifyMemSyncScope(scope).str() + ";";
+  ptxBuilder.create<>(fence)->operator()({}, /*onlyAttachMLIRArgs=*/true);
+  ptxBuilder.launch(rewriter, loc, void_ty(rewriter.getContext()));
+}
+
+// The atomics a thread issues for the elements of a tensor are unordered with
+// each other, so when there are several, their release and acquire are a
+// single fence before and after them, and they are issued relaxed. Emits the
+// fence before them if `sem` releases, and returns the semantics to issue them
+// with.
+MemSemantic fenceAtomicsBefore(ConversionPatternRewriter &rewriter,
+                               Location loc, MemSemantic sem,
+                               MemSyncScope scope, unsigned numAtomics) {
+  if (numAtomics <= 1 || sem == MemSemantic::RELAXED)
+    return sem;
+  if (isRelease(sem))
+    createAtomicFence(rewriter, loc, scope);
+  return MemSemantic::RELAXED;
+}
+
+// Emits the fence after the atomics issued with `atomSem` as returned by
+// fenceAtomicsBefore, if `sem` acquires.
+void fenceAtomicsAfter(ConversionPatternRewriter &rewriter, Location loc,
+                       MemSemantic sem, MemSemantic atomSem,
+                       MemSyncScope scope) {
+  if (atomSem != sem && isAcquire(sem))
+    createAtomicFence(rewriter, loc, scope);
+}
+
 struct AtomicCASOpConversion
     : public ConvertOpToLLVMPattern<triton::AtomicCASOp>,
       public LoadStoreConversionBase {
@@ -526,6 +783,9 @@ struct AtomicCASOpConversion
     auto vecTy = vec_ty(valueElemTy, vec);
     SmallVector<Value> resultVals(elemsPerThread);
 
+    MemSemantic atomSem =
+        fenceAtomicsBefore(rewriter, loc, op.getSem(), op.getScope(),
+                           ceil<unsigned>(elemsPerThread, vec));
     for (size_t i = 0; i < elemsPerThread; i += vec) {
       Value casVal = undef(vecTy);
       for (int ii = 0; ii < vec; ++ii) {
@@ -549,7 +809,7 @@ struct AtomicCASOpConversion
       auto sTy = "b" + std::to_string(valueElemNBits);
       std::string semStr;
       llvm::raw_string_ostream os(semStr);
-      os << op.getSem();
+      os << atomSem;
       auto scope = stringifyMemSyncScope(op.getScope()).str();
       atom.global().o(semStr).o(scope).o("cas").o(sTy);
       atom(dstOpr, ptrOpr, cmpOpr, valOpr).predicate(mask);
@@ -570,7 +830,7 @@ struct AtomicCASOpConversion
         // Only threads with mask = True store the result
         PTXBuilder ptxBuilderStore;
         auto *dstOprStore = ptxBuilderStore.newAddrOperand(atomPtr, "r");
-        auto *valOprStore = ptxBuilderStore.newOperand(old, "r");
+        auto *valOprStore = ptxBuilderStore.newOperand(old, tyId);
         auto &st = *ptxBuilderStore.create<PTXInstr>("st");
         st.shared().o(sTy);
         st(dstOprStore, valOprStore).predicate(mask);
@@ -584,6 +844,7 @@ struct AtomicCASOpConversion
     }
 
     if (tensorTy) {
+      fenceAtomicsAfter(rewriter, loc, op.getSem(), atomSem, op.getScope());
       Type structTy = getTypeConverter()->convertType(tensorTy);
       Value resultStruct = packLLElements(loc, getTypeConverter(), resultVals,
                                           rewriter, structTy);
@@ -603,6 +864,133 @@ struct AtomicRMWOpConversion
       : ConvertOpToLLVMPattern<triton::AtomicRMWOp>(converter, benefit),
         LoadStoreConversionBase(targetInfo, axisAnalysisPass) {}
 
+  // Returns the masks of the register and lane bits of the layout of `ptr`
+  // that only move between elements with the same address, according to the
+  // constancy of `ptr`.
+  std::pair<unsigned, unsigned> getUniformAddressBits(Value ptr) const {
+    auto tensorTy = cast<RankedTensorType>(ptr.getType());
+    AxisInfo *axisInfo = axisAnalysisPass.getAxisInfo(ptr);
+    std::optional<LinearLayout> layout = triton::gpu::toLinearLayout(
+        tensorTy.getShape(), tensorTy.getEncoding());
+    if (!axisInfo || !layout)
+      return {0, 0};
+    // Constant blocks are aligned, so moving by less than the constancy along
+    // every dimension stays within a block.
+    auto getBits = [&](StringAttr inDim) {
+      unsigned bits = 0;
+      for (int i = 0; i < layout->getInDimSizeLog2(inDim); ++i) {
+        ArrayRef<int32_t> basis = layout->getBasis(inDim, i);
+        bool isUniform = true;
+        for (auto [dim, offset] : llvm::enumerate(basis))
+          isUniform &= offset < axisInfo->getConstancy(dim);
+        if (isUniform)
+          bits |= 1u << i;
+      }
+      return bits;
+    };
+    MLIRContext *ctx = ptr.getContext();
+    return {getBits(str_attr("register")), getBits(str_attr("lane"))};
+  }
+
+  // Sums up the values of the elements going to the same address, first
+  // within each thread, then across the lanes of the warp with butterfly
+  // shuffles, so that the thread with the lowest lane and register of each
+  // group issues a single atomic for all of them. Returns for each register
+  // whether it still issues an atomic.
+  SmallVector<bool>
+  aggregateUniformAddresses(triton::AtomicRMWOp op, Type valueElemTy,
+                            SmallVector<Value> &valElements,
+                            SmallVector<Value> &rmwMasks,
+                            ConversionPatternRewriter &rewriter) const {
+    Location loc = op.getLoc();
+    unsigned numElems = valElements.size();
+    SmallVector<bool> isLeader(numElems, true);
+    auto [regBits, laneBits] = getUniformAddressBits(op.getPtr());
+    if (!regBits && !laneBits)
+      return isLeader;
+
+    bool isFloat = op.getAtomicRmwOp() == RMWOp::FADD;
+    auto combine = [&](Value a, Value b) -> Value {
+      return isFloat ? fadd(a, b) : add(a, b);
+    };
+    Value zero = null(valueElemTy);
+    for (unsigned i = 0; i < numElems; ++i)
+      valElements[i] = select(rmwMasks[i], valElements[i], zero);
+    // The leader of the registers of a group is the one with its uniform bits
+    // cleared, which comes before the others.
+    for (unsigned i = 0; i < numElems; ++i) {
+      unsigned leader = i & ~regBits;
+      if (leader == i)
+        continue;
+      valElements[leader] = combine(valElements[leader], valElements[i]);
+      rmwMasks[leader] = or_(rmwMasks[leader], rmwMasks[i]);
+      isLeader[i] = false;
+    }
+    if (!laneBits)
+      return isLeader;
+
+    Value laneId = urem(tid_val(), i32_val(32));
+    Value isLeaderLane =
+        icmp_eq(and_(laneId, i32_val(laneBits)), i32_val(0));
+    for (unsigned i = 0; i < numElems; ++i) {
+      if (!isLeader[i])
+        continue;
+      for (unsigned bit = 1; bit <= laneBits; bit <<= 1) {
+        if (!(laneBits & bit))
+          continue;
+        valElements[i] = combine(
+            valElements[i],
+            targetInfo.shuffleXor(rewriter, loc, valElements[i], bit));
+        rmwMasks[i] = or_(rmwMasks[i], targetInfo.shuffleXor(
+                                           rewriter, loc, rmwMasks[i], bit));
+      }
+      rmwMasks[i] = and_(rmwMasks[i], isLeaderLane);
+    }
+    return isLeader;
+  }
+
+  // Emits the sm_90 vector add of `vals` to `ptr` with `sem`, with red when
+  // `useRed`, or with atom otherwise.
+  SmallVector<Value> emitVectorFAdd(triton::AtomicRMWOp op, Value ptr,
+                                    ArrayRef<Value> vals, Value pred,
+                                    MemSemantic sem, bool useRed,
+                                    ConversionPatternRewriter &rewriter) const {
+    Location loc = op.getLoc();
+    MLIRContext *ctx = rewriter.getContext();
+    unsigned vec = vals.size();
+    PTXBuilder ptxBuilder;
+    SmallVector<std::pair<Value, std::string>> valItems;
+    for (Value val : vals)
+      valItems.push_back({val, "f"});
+    auto *dstOpr = useRed ? nullptr : ptxBuilder.newListOperand(vec, "=f");
+    auto *ptrOpr = ptxBuilder.newAddrOperand(ptr, "l");
+    auto *valOpr = ptxBuilder.newListOperand(valItems);
+
+    std::string semStr;
+    llvm::raw_string_ostream os(semStr);
+    os << sem;
+    auto &atom = ptxBuilder.create<>(useRed ? "red" : "atom")
+                     ->global()
+                     .o(stringifyMemSyncScope(op.getScope()).str())
+                     .o(semStr)
+                     .o("add")
+                     .v(vec)
+                     .o("f32");
+    SmallVector<Value> results;
+    if (useRed) {
+      atom(ptrOpr, valOpr).predicate(pred);
+      ptxBuilder.launch(rewriter, loc, void_ty(ctx));
+      results.assign(vec, undef(f32_ty));
+      return results;
+    }
+    atom(dstOpr, ptrOpr, valOpr).predicate(pred);
+    Value ret = ptxBuilder.launch(rewriter, loc,
+                                  struct_ty(SmallVector<Type>(vec, f32_ty)));
+    for (unsigned i = 0; i < vec; ++i)
+      results.push_back(extract_val(f32_ty, ret, i));
+    return results;
+  }
+
   LogicalResult
   matchAndRewrite(triton::AtomicRMWOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
@@ -639,17 +1027,76 @@ struct AtomicRMWOpConversion
     auto vec = getVectorSize(ptr);
     int numElems = 1;
     // tensor
+    bool isVectorFAdd = false;
     if (tensorTy) {
       auto valTy = cast<RankedTensorType>(val.getType());
-      vec = std::min<unsigned>(vec, valTy.getElementType().isF16() ? 2 : 1);
+      Type elemTy = valTy.getElementType();
+      // sm_90 adds up to four f32 at a time, which needs the whole vector to
+      // be masked alike.
+      isVectorFAdd = atomicRmwAttr == RMWOp::FADD && elemTy.isF32() &&
+                     targetInfo.getComputeCapability() >= 90;
+      if (isVectorFAdd) {
+        vec = std::min<unsigned>(vec, 4);
+        if (llMask)
+          vec = std::min<unsigned>(vec, getMaskAlignment(op.getMask()));
+        isVectorFAdd = vec > 1;
+      } else {
+        vec = std::min<unsigned>(vec, elemTy.isF16() ? 2 : 1);
+      }
       // mask
       numElems = tensorTy.getNumElements();
     }
     Value mask = redundantDataMask(valueTy, rewriter, loc, targetInfo);
+    SmallVector<Value> rmwMasks(elemsPerThread, mask);
+    if (llMask) {
+      for (size_t i = 0; i < elemsPerThread; ++i)
+        rmwMasks[i] = and_(mask, maskElements[i]);
+    }
+
+    // Elements going to the same address, which the constancy of the
+    // pointers tells, are summed up before a single atomic when nothing is
+    // read back, as each element would otherwise read a different value.
+    SmallVector<bool> isLeader(elemsPerThread, true);
+    if (tensorTy && vec == 1 && op->use_empty() &&
+        (atomicRmwAttr == RMWOp::ADD || atomicRmwAttr == RMWOp::FADD)) {
+      isLeader = aggregateUniformAddresses(op, valueElemTy, valElements,
+                                           rmwMasks, rewriter);
+    }
+
+    // An atomic whose result is unused hands nothing it reads to the program,
+    // which can't tell whether it synchronized with a release, so only its own
+    // release is kept, and it is a red unless it is an exchange, which PTX has
+    // no red for.
+    MemSemantic sem = op.getSem();
+    bool useRed = false;
+    if (op->use_empty()) {
+      sem = isRelease(sem) ? MemSemantic::RELEASE : MemSemantic::RELAXED;
+      useRed = atomicRmwAttr != RMWOp::XCHG;
+    }
+    unsigned numAtomics = 0;
+    for (size_t i = 0; i < elemsPerThread; i += vec)
+      numAtomics += isLeader[i];
+    MemSemantic atomSem =
+        fenceAtomicsBefore(rewriter, loc, sem, op.getScope(), numAtomics);
 
     auto vecTy = vec_ty(valueElemTy, vec);
     SmallVector<Value> resultVals(elemsPerThread);
     for (size_t i = 0; i < elemsPerThread; i += vec) {
+      if (!isLeader[i]) {
+        resultVals[i] = undef(valueElemTy);
+        continue;
+      }
+      Value rmwPtr = ptrElements[i];
+      Value rmwMask = rmwMasks[i];
+      if (isVectorFAdd) {
+        SmallVector<Value> rets =
+            emitVectorFAdd(op, rmwPtr, ArrayRef(valElements).slice(i, vec),
+                           rmwMask, atomSem, useRed, rewriter);
+        for (int ii = 0; ii < vec; ++ii)
+          resultVals[i + ii] = rets[ii];
+        continue;
+      }
+
       Value rmwVal = undef(vecTy);
       for (int ii = 0; ii < vec; ++ii) {
         Value iiVal = createIndexAttrConstant(
@@ -657,19 +1104,21 @@ struct AtomicRMWOpConversion
         rmwVal = insert_element(vecTy, rmwVal, valElements[i + ii], iiVal);
       }
 
-      Value rmwPtr = ptrElements[i];
-      Value rmwMask = llMask ? and_(mask, maskElements[i]) : mask;
       std::string sTy;
       PTXBuilder ptxBuilderAtomicRMW;
       std::string tyId = valueElemNBits * vec == 64
                              ? "l"
                              : (valueElemNBits * vec == 32 ? "r" : "h");
-      auto *dstOpr = ptxBuilderAtomicRMW.newOperand("=" + tyId, /*init=*/true);
+      auto *dstOpr =
+          useRed ? nullptr
+                 : ptxBuilderAtomicRMW.newOperand("=" + tyId, /*init=*/true);
       auto *ptrOpr = ptxBuilderAtomicRMW.newAddrOperand(rmwPtr, "l");
       auto *valOpr = ptxBuilderAtomicRMW.newOperand(rmwVal, tyId);
 
       auto scope = stringifyMemSyncScope(op.getScope()).str();
-      auto &atom = ptxBuilderAtomicRMW.create<>("atom")->global().o(scope);
+      auto &atom = ptxBuilderAtomicRMW.create<>(useRed ? "red" : "atom")
+                       ->global()
+                       .o(scope);
       auto rmwOp = stringifyRMWOp(atomicRmwAttr).str();
       auto sBits = std::to_string(valueElemNBits);
       switch (atomicRmwAttr) {
@@ -713,9 +1162,18 @@ struct AtomicRMWOpConversion
       }
       std::string semStr;
       llvm::raw_string_ostream os(semStr);
-      os << op.getSem();
+      os << atomSem;
       atom.o(semStr).o(rmwOp).o(sTy);
-      if (tensorTy) {
+      if (useRed) {
+        atom(ptrOpr, valOpr).predicate(rmwMask);
+        ptxBuilderAtomicRMW.launch(rewriter, loc, void_ty(ctx));
+        if (!tensorTy) {
+          rewriter.replaceOp(op, {undef(valueElemTy)});
+          return success();
+        }
+        for (int ii = 0; ii < vec; ++ii)
+          resultVals[i + ii] = undef(valueElemTy);
+      } else if (tensorTy) {
         atom(dstOpr, ptrOpr, valOpr).predicate(rmwMask);
         auto retType = vec == 1 ? valueElemTy : vecTy;
         auto ret = ptxBuilderAtomicRMW.launch(rewriter, loc, retType);
@@ -724,10 +1182,9 @@ struct AtomicRMWOpConversion
               vec == 1 ? ret : extract_element(valueElemTy, ret, i32_val(ii));
         }
       } else {
-        auto ASMReturnTy = void_ty(ctx);
         atom(dstOpr, ptrOpr, valOpr).predicate(rmwMask);
         auto old = ptxBuilderAtomicRMW.launch(rewriter, loc, valueElemTy);
-        if (op->user_begin() == op->user_end()) {
+        if (op->use_empty()) {
           rewriter.replaceOp(op, {old});
           return success();
         }
@@ -749,6 +1206,7 @@ struct AtomicRMWOpConversion
       }
     }
     if (tensorTy) {
+      fenceAtomicsAfter(rewriter, loc, sem, atomSem, op.getScope());
       Type structTy = getTypeConverter()->convertType(tensorTy);
       Value resultStruct = packLLElements(loc, getTypeConverter(), resultVals,
                                           rewriter, structTy);
@@ -911,6 +1369,72 @@ struct AsyncTMACopyGlobalToLocalOpConversion
           triton::nvidia_gpu::AsyncTMACopyGlobalToLocalOp> {
   using ConvertOpToLLVMPattern::ConvertOpToLLVMPattern;
 
+  struct MulticastInfo {
+    // The number of CTAs sharing the block of this CTA.
+    int numCTAs = 1;
+    // The rank of this CTA among them, and the mask of their cluster CTA ids.
+    Value rank;
+    Value ctaMask;
+    // The offset of the block of this CTA in each dimension, or null.
+    SmallVector<Value> ctaOffsets;
+  };
+
+  // The CTAs holding the same block are those whose ids along the dimensions
+  // split between CTAs are equal modulo CTASplitNum. Those with ids multiple
+  // of CTASplitNum form the group of CTA 0, and the group of any other CTA is
+  // that group translated by its ids modulo CTASplitNum.
+  static MulticastInfo getMulticastInfo(ConversionPatternRewriter &rewriter,
+                                        Location loc, MemDescType ty,
+                                        ArrayRef<int64_t> shapePerCTA) {
+    MulticastInfo info;
+    unsigned rank = ty.getRank();
+    info.ctaOffsets.resize(rank);
+    Attribute layout = ty.getEncoding();
+    if (triton::gpu::getNumCTAs(layout) == 1)
+      return info;
+    auto CTAsPerCGA = triton::gpu::getCTAsPerCGA(layout);
+    auto CTASplitNum = triton::gpu::getCTASplitNum(layout);
+    auto CTAOrder = triton::gpu::getCTAOrder(layout);
+    Value clusterCTAId = rewriter.create<triton::nvgpu::ClusterCTAIdOp>(
+        loc, rewriter.getI32Type());
+    SmallVector<Value> multiDimCTAId =
+        delinearize(rewriter, loc, clusterCTAId, CTAsPerCGA, CTAOrder);
+
+    SmallVector<unsigned> strides(rank);
+    unsigned stride = 1;
+    for (unsigned dim : CTAOrder) {
+      strides[dim] = stride;
+      stride *= CTAsPerCGA[dim];
+    }
+    // Mask of the group of CTA 0.
+    uint32_t baseMask = 1;
+    Value groupOffset = i32_val(0);
+    Value groupRank = i32_val(0);
+    for (unsigned dim : CTAOrder) {
+      unsigned splitNum = std::min<unsigned>(CTASplitNum[dim], CTAsPerCGA[dim]);
+      unsigned numReps = CTAsPerCGA[dim] / splitNum;
+      uint32_t dimMask = 0;
+      for (unsigned r = 0; r < numReps; ++r)
+        dimMask |= baseMask << (r * splitNum * strides[dim]);
+      baseMask = dimMask;
+      Value splitId = multiDimCTAId[dim];
+      if (numReps > 1) {
+        groupRank =
+            add(mul(groupRank, i32_val(numReps)),
+                udiv(multiDimCTAId[dim], i32_val(splitNum)));
+        splitId = urem(multiDimCTAId[dim], i32_val(splitNum));
+      }
+      if (splitNum > 1) {
+        groupOffset = add(groupOffset, mul(splitId, i32_val(strides[dim])));
+        info.ctaOffsets[dim] = mul(splitId, i32_val(shapePerCTA[dim]));
+      }
+      info.numCTAs *= numReps;
+    }
+    info.rank = groupRank;
+    info.ctaMask = trunc(i16_ty, shl(i32_val(baseMask), groupOffset));
+    return info;
+  }
+
   LogicalResult
   matchAndRewrite(triton::nvidia_gpu::AsyncTMACopyGlobalToLocalOp op,
                   OpAdaptor adaptor,
@@ -941,25 +1465,48 @@ struct AsyncTMACopyGlobalToLocalOpConversion
     // figure out that the op is uniform.
     pred = and_(pred, LLVM::NVIDIA::createElectPredicate(loc, rewriter));
 
+    auto resultTy = op.getResult().getType();
     int elementSizeInBytes =
-        op.getResult().getType().getElementType().getIntOrFloatBitWidth() / 8;
-    int totalNumElements = product(op.getResult().getType().getShape());
-    int64_t size = totalNumElements * elementSizeInBytes;
+        resultTy.getElementType().getIntOrFloatBitWidth() / 8;
+    SmallVector<int64_t> shapePerCTA = triton::gpu::getShapePerCTA(resultTy);
+    int totalNumElements = product(shapePerCTA);
 
-    int innerBlockSize = op.getResult().getType().getShape().back();
+    int innerBlockSize = shapePerCTA.back();
     int contigDimSizeInByte = innerBlockSize * elementSizeInBytes;
     int numCopies = 1;
     int rank = op.getCoord().size();
     if (rank > 1)
       numCopies = ceil<int>(contigDimSizeInByte, 128);
+    // Im2col copies split the block along the channels like tiled ones.
+    bool isIm2col = !op.getIm2colOffsets().empty();
+
+    // The CTAs of a cluster holding the same block of the tensor, i.e. along
+    // the dimensions where CTASplitNum < CTAsPerCGA, each copy their share of
+    // the block and multicast it to the others, and the coordinates of the
+    // CTAs holding different blocks are offset to their block.
+    MulticastInfo multicast =
+        getMulticastInfo(rewriter, loc, resultTy, shapePerCTA);
+    int numCopiesPerCTA = ceil<int>(numCopies, multicast.numCTAs);
+    if (multicast.numCTAs > 1) {
+      // The copies of the other CTAs write to the buffer and arrive on the
+      // barrier of this CTA. Wait for all the CTAs of the cluster to get here,
+      // so that they are done with the previous content of the buffer, and
+      // for their barrier initializations to be visible.
+      ::mlir::triton::PTXBuilder ptxBuilderFence;
+      ptxBuilderFence.create<>("fence.mbarrier_init.release.cluster;")
+          ->operator()({}, /*onlyAttachMLIRArgs=*/true);
+      ptxBuilderFence.launch(rewriter, loc, voidTy);
+      createBarrier(rewriter, loc,
+                    triton::gpu::TritonGPUDialect::getNumCTAs(mod));
+    }
 
     // The bounding box inner dimension must be less than or equal to the
     // swizzle size.
     // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__TENSOR__MEMORY.html#group__CUDA__TENSOR__MEMORY_1ga7c7d2aaac9e49294304e755e6f341d7
     // We clamp the block size and the codegen will emit multiple copy
     // operations.
-    for (int copyIdx = 0; copyIdx < numCopies; copyIdx += numWarps) {
-      int numWarpsToCopy = std::min(numCopies - copyIdx, numWarps);
+    for (int copyIdx = 0; copyIdx < numCopiesPerCTA; copyIdx += numWarps) {
+      int numWarpsToCopy = std::min(numCopiesPerCTA - copyIdx, numWarps);
       if (numWarpsToCopy == 1)
         warpID = i32_val(0);
       Value boxPred =
@@ -967,6 +1514,12 @@ struct AsyncTMACopyGlobalToLocalOpConversion
       ::mlir::triton::PTXBuilder ptxBuilderTMA;
       Type elemPtrTy = ptr_ty(rewriter.getContext(), 3);
       Value copyIdxVal = add(warpID, i32_val(copyIdx));
+      if (multicast.numCTAs > 1) {
+        copyIdxVal = add(mul(copyIdxVal, i32_val(multicast.numCTAs)),
+                         multicast.rank);
+        if (numCopies % multicast.numCTAs != 0)
+          boxPred = and_(boxPred, icmp_ult(copyIdxVal, i32_val(numCopies)));
+      }
       Value shMemOffset =
           mul(copyIdxVal, i32_val(totalNumElements / numCopies));
       Value shMemPtr =
@@ -975,9 +1528,14 @@ struct AsyncTMACopyGlobalToLocalOpConversion
           ptxBuilderTMA.newOperand(boxPred, "b"),
           ptxBuilderTMA.newOperand(shMemPtr, "r"),
           ptxBuilderTMA.newOperand(adaptor.getDescPtr(), "l")};
-      std::string tmaInst =
-          "@$0 cp.async.bulk.tensor." + std::to_string(rank) +
-          "d.shared::cluster.global.mbarrier::complete_tx::bytes [$1], [$2, {";
+      std::string tmaInst = "@$0 cp.async.bulk.tensor." +
+                            std::to_string(rank) + "d.shared::cluster.global";
+      if (isIm2col)
+        tmaInst += ".im2col";
+      tmaInst += ".mbarrier::complete_tx::bytes";
+      if (multicast.numCTAs > 1)
+        tmaInst += ".multicast::cluster";
+      tmaInst += " [$1], [$2, {";
       int operandIdx = 3;
       for (int i = 0; i < rank; i++) {
         Value coord = adaptor.getCoord()[rank - i - 1];
@@ -985,6 +1543,11 @@ struct AsyncTMACopyGlobalToLocalOpConversion
           Value offset = mul(copyIdxVal, i32_val(128 / elementSizeInBytes));
           coord = add(coord, offset);
         }
+        // The coordinates of im2col copies are those of the tensor, not of
+        // the block, which is not split between CTAs.
+        if (!isIm2col)
+          if (Value ctaOffset = multicast.ctaOffsets[rank - i - 1])
+            coord = add(coord, ctaOffset);
         operands.push_back(ptxBuilderTMA.newOperand(coord, "r"));
         tmaInst += "$" + std::to_string(operandIdx++);
         if (i != rank - 1)
@@ -992,7 +1555,26 @@ struct AsyncTMACopyGlobalToLocalOpConversion
       }
       operands.push_back(
           ptxBuilderTMA.newOperand(barrierMemObj.getBase(), "r"));
-      tmaInst += "}], [$" + std::to_string(operandIdx++) + "];";
+      tmaInst += "}], [$" + std::to_string(operandIdx++) + "]";
+      if (isIm2col) {
+        // The offsets of the filter tap, from the innermost spatial
+        // dimension.
+        auto im2colOffsets = adaptor.getIm2colOffsets();
+        tmaInst += ", {";
+        for (int i = 0, e = im2colOffsets.size(); i < e; i++) {
+          operands.push_back(
+              ptxBuilderTMA.newOperand(im2colOffsets[e - i - 1], "h"));
+          tmaInst += "$" + std::to_string(operandIdx++);
+          if (i != e - 1)
+            tmaInst += ", ";
+        }
+        tmaInst += "}";
+      }
+      if (multicast.numCTAs > 1) {
+        operands.push_back(ptxBuilderTMA.newOperand(multicast.ctaMask, "h"));
+        tmaInst += ", $" + std::to_string(operandIdx++);
+      }
+      tmaInst += ";";
       auto &tma = *ptxBuilderTMA.create<>(tmaInst);
       tma(operands, /*onlyAttachMLIRArgs=*/true);
       ptxBuilderTMA.launch(rewriter, loc, voidTy);
@@ -1002,18 +1584,64 @@ struct AsyncTMACopyGlobalToLocalOpConversion
   }
 };
 
+// Returns the TMA instruction copying a block of `rank` dimensions from shared
+// to global memory.
+static std::string
+getTMACopyLocalToGlobalInst(triton::nvidia_gpu::AsyncTMACopyLocalToGlobalOp op,
+                            int rank) {
+  return "cp.async.bulk.tensor." + std::to_string(rank) +
+         "d.global.shared::cta.bulk_group";
+}
+
+// Returns the TMA instruction reducing a block of `rank` dimensions from
+// shared into global memory. The operation is signed, unsigned or floating
+// point depending on the data type of the descriptor.
+static std::string
+getTMACopyLocalToGlobalInst(triton::nvidia_gpu::AsyncTMAReduceOp op,
+                            int rank) {
+  StringRef redOp;
+  switch (op.getKind()) {
+  case RMWOp::ADD:
+  case RMWOp::FADD:
+    redOp = "add";
+    break;
+  case RMWOp::MAX:
+  case RMWOp::UMAX:
+    redOp = "max";
+    break;
+  case RMWOp::MIN:
+  case RMWOp::UMIN:
+    redOp = "min";
+    break;
+  case RMWOp::AND:
+    redOp = "and";
+    break;
+  case RMWOp::OR:
+    redOp = "or";
+    break;
+  case RMWOp::XOR:
+    redOp = "xor";
+    break;
+  case RMWOp::XCHG:
+    llvm_unreachable("TMA reductions don't exchange");
+  }
+  return "cp.reduce.async.bulk.tensor." + std::to_string(rank) +
+         "d.global.shared::cta." + redOp.str() + ".tile.bulk_group";
+}
+
+// Lowers the copies and reductions of shared memory into global memory, which
+// are issued and complete alike.
+template <typename OpTy>
 struct AsyncTMACopyLocalToGlobalOpConversion
-    : public ConvertOpToLLVMPattern<
-          triton::nvidia_gpu::AsyncTMACopyLocalToGlobalOp> {
-  using ConvertOpToLLVMPattern::ConvertOpToLLVMPattern;
+    : public ConvertOpToLLVMPattern<OpTy> {
+  using ConvertOpToLLVMPattern<OpTy>::ConvertOpToLLVMPattern;
 
   LogicalResult
-  matchAndRewrite(triton::nvidia_gpu::AsyncTMACopyLocalToGlobalOp op,
-                  OpAdaptor adaptor,
+  matchAndRewrite(OpTy op, typename OpTy::Adaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
     auto loc = op.getLoc();
-    Type llvmElemTy =
-        typeConverter->convertType(op.getSrc().getType().getElementType());
+    Type llvmElemTy = this->getTypeConverter()->convertType(
+        op.getSrc().getType().getElementType());
     auto dstMemObj = LLVM::getSharedMemoryObjectFromStruct(
         loc, adaptor.getSrc(), llvmElemTy, rewriter);
     auto voidTy = void_ty(op->getContext());
@@ -1059,8 +1687,8 @@ struct AsyncTMACopyLocalToGlobalOpConversion
       SmallVector<PTXBuilder::Operand *> operands = {
           ptxBuilderTMA.newOperand(boxPred, "b"),
           ptxBuilderTMA.newOperand(adaptor.getDescPtr(), "l")};
-      std::string tmaInst = "@$0 cp.async.bulk.tensor." + std::to_string(rank) +
-                            "d.global.shared::cta.bulk_group [$1, {";
+      std::string tmaInst =
+          "@$0 " + getTMACopyLocalToGlobalInst(op, rank) + " [$1, {";
       int operandIdx = 2;
       for (int i = 0; i < rank; i++) {
         Value coord = adaptor.getCoord()[rank - i - 1];
@@ -1092,6 +1720,61 @@ struct AsyncTMACopyLocalToGlobalOpConversion
   }
 };
 
+struct ExperimentalDescriptorPrefetchOpConversion
+    : public ConvertOpToLLVMPattern<
+          triton::ExperimentalDescriptorPrefetchOp> {
+  using ConvertOpToLLVMPattern::ConvertOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::ExperimentalDescriptorPrefetchOp op,
+                  OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op.getLoc();
+    auto voidTy = void_ty(op->getContext());
+    auto blockTy = cast<RankedTensorType>(op.getBlockType());
+    int elementSizeInBytes = blockTy.getElementTypeBitWidth() / 8;
+    int contigDimSizeInByte = blockTy.getShape().back() * elementSizeInBytes;
+    int rank = op.getIndices().size();
+    // The block is split into the boxes of the descriptor like the block of
+    // a TMA copy.
+    int numCopies = 1;
+    if (rank > 1)
+      numCopies = ceil<int>(contigDimSizeInByte, 128);
+
+    // The prefetches don't write to shared memory nor arrive on a barrier, so
+    // a single thread issues them all.
+    auto mod = op->getParentOfType<ModuleOp>();
+    int warpSize = triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+    Value pred =
+        and_(LLVM::NVIDIA::createElectPredicate(loc, rewriter),
+             icmp_ult(getThreadId(rewriter, loc), i32_val(warpSize)));
+    for (int copyIdx = 0; copyIdx < numCopies; ++copyIdx) {
+      ::mlir::triton::PTXBuilder ptxBuilderTMA;
+      SmallVector<PTXBuilder::Operand *> operands = {
+          ptxBuilderTMA.newOperand(pred, "b"),
+          ptxBuilderTMA.newOperand(adaptor.getDescPtr(), "l")};
+      std::string tmaInst = "@$0 cp.async.bulk.prefetch.tensor." +
+                            std::to_string(rank) + "d.L2.global.tile [$1, {";
+      int operandIdx = 2;
+      for (int i = 0; i < rank; i++) {
+        Value coord = adaptor.getIndices()[rank - i - 1];
+        if (i == 0 && copyIdx > 0)
+          coord = add(coord, i32_val(copyIdx * 128 / elementSizeInBytes));
+        operands.push_back(ptxBuilderTMA.newOperand(coord, "r"));
+        tmaInst += "$" + std::to_string(operandIdx++);
+        if (i != rank - 1)
+          tmaInst += ", ";
+      }
+      tmaInst += "}];";
+      auto &tma = *ptxBuilderTMA.create<>(tmaInst);
+      tma(operands, /*onlyAttachMLIRArgs=*/true);
+      ptxBuilderTMA.launch(rewriter, loc, voidTy);
+    }
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
 struct AsyncWaitOpConversion
     : public ConvertOpToLLVMPattern<triton::gpu::AsyncWaitOp> {
   using ConvertOpToLLVMPattern<
@@ -1169,11 +1852,16 @@ void mlir::triton::NVIDIA::populateLoadStoreOpToLLVMPatterns(
     RewritePatternSet &patterns, ModuleAxisInfoAnalysis &axisInfoAnalysis,
     PatternBenefit benefit) {
   patterns.add<AsyncCopyGlobalToLocalOpConversion, AtomicCASOpConversion,
-               AtomicRMWOpConversion, LoadOpConversion, StoreOpConversion>(
-      typeConverter, targetInfo, axisInfoAnalysis, benefit);
+               AtomicRMWOpConversion, LoadOpConversion, PrefetchOpConversion,
+               StoreOpConversion>(typeConverter, targetInfo, axisInfoAnalysis,
+                                  benefit);
   patterns.add<AsyncCommitGroupOpConversion>(typeConverter, benefit);
   patterns.add<AsyncWaitOpConversion>(typeConverter, benefit);
   patterns.add<AsyncTMACopyGlobalToLocalOpConversion,
-               AsyncTMACopyLocalToGlobalOpConversion, TMAStoreWaitConversion>(
-      typeConverter, benefit);
+               AsyncTMACopyLocalToGlobalOpConversion<
+                   triton::nvidia_gpu::AsyncTMACopyLocalToGlobalOp>,
+               AsyncTMACopyLocalToGlobalOpConversion<
+                   triton::nvidia_gpu::AsyncTMAReduceOp>,
+               ExperimentalDescriptorPrefetchOpConversion,
+               TMAStoreWaitConversion>(typeConverter, benefit);
 }
@@ -49,7 +49,8 @@ void stMatrixm8n8x4(Value offset, ArrayRef<Value> vals, int indexOffset,
     inputs.push_back(bitcast(input, i32_ty));
   }
   Value addr = gep(smemBase.getType(), elemTy, smemBase, offset);
-  rewriter.create<triton::nvgpu::StoreMatrixOp>(loc, addr, inputs);
+  rewriter.create<triton::nvgpu::StoreMatrixOp>(loc, addr, inputs,
+                                                /*trans=*/UnitAttr());
 }
 void storeDistributedToSharedWithStMatrix(
     RankedTensorType tensorTy, Type elemTy, SmallVector<Value> &inVals,
@@ -426,6 +427,12 @@ Value TargetInfo::loadDShared(RewriterBase &rewriter, Location loc, Value ptr,
   }
 }
 
+void TargetInfo::clusterBarrier(RewriterBase &rewriter, Location loc) const {
+  // The arrive has release semantics, and the wait acquire semantics.
+  rewriter.create<triton::nvgpu::ClusterArriveOp>(loc, /*relaxed=*/false);
+  rewriter.create<triton::nvgpu::ClusterWaitOp>(loc);
+}
+
 Value TargetInfo::shuffleXor(RewriterBase &rewriter, Location loc, Value val,
                              int i) const {
   return LLVM::NVIDIA::shuffleXor(loc, rewriter, val, i);
@@ -436,6 +443,16 @@ Value TargetInfo::shuffleUp(RewriterBase &rewriter, Location loc, Value val,
   return LLVM::NVIDIA::shuffleUp(loc, rewriter, val, i);
 }
 
+Value TargetInfo::makeWarpUniform(RewriterBase &rewriter, Location loc,
+                                  Value val) const {
+  // ptxas keeps the values it proves uniform, like that of a shuffle from a
+  // fixed lane, and those computed from them in the uniform registers of
+  // sm_75+.
+  if (computeCapability < 75)
+    return val;
+  return LLVM::NVIDIA::shuffleIdx(loc, rewriter, val, 0);
+}
+
 Value TargetInfo::shuffleIdx(RewriterBase &rewriter, Location loc, Value val,
                              int i) const {
   return LLVM::NVIDIA::shuffleIdx(loc, rewriter, val, i);
@@ -446,6 +463,16 @@ Value TargetInfo::shuffleIdx(RewriterBase &rewriter, Location loc, Value val,
   return LLVM::NVIDIA::shuffleIdx(loc, rewriter, val, i);
 }
 
+Value TargetInfo::shuffleXorForReduce(RewriterBase &rewriter, Location loc,
+                                      Value val, int i) const {
+  return LLVM::NVIDIA::shuffleXor(loc, rewriter, val, i);
+}
+
+Value TargetInfo::shuffleUpForScan(RewriterBase &rewriter, Location loc,
+                                   Value val, int i, unsigned groupSize) const {
+  return LLVM::NVIDIA::shuffleUp(loc, rewriter, val, i);
+}
+
 Value TargetInfo::programId(RewriterBase &rewriter, Location loc,
                             ModuleOp moduleOp, int axis) const {
   return LLVM::NVIDIA::llGetPid(loc, rewriter, moduleOp, axis);
@@ -490,6 +517,35 @@ bool TargetInfo::warpReduce(RewriterBase &rewriter, Location loc,
   }
   return false;
 }
+
+bool TargetInfo::canUseLdMatrix() const { return computeCapability >= 75; }
+
+bool TargetInfo::canUseStMatrix() const { return computeCapability >= 90; }
+
+SmallVector<Value> TargetInfo::loadMatrix(RewriterBase &rewriter, Location loc,
+                                          Value ptr, bool trans) const {
+  MLIRContext *ctx = rewriter.getContext();
+  PTXBuilder builder;
+  auto resArgs = builder.newListOperand(4, "=r");
+  auto addrArg = builder.newAddrOperand(ptr, "r");
+  auto &ldmatrix = builder.create("ldmatrix.sync.aligned.m8n8.x4")
+                       ->o("trans", trans)
+                       .o("shared.b16");
+  ldmatrix(resArgs, addrArg);
+  Type resTy = struct_ty(SmallVector<Type>(4, i32_ty));
+  Value res = builder.launch(rewriter, loc, resTy);
+  SmallVector<Value> words;
+  for (int i = 0; i < 4; i++)
+    words.push_back(extract_val(i32_ty, res, i));
+  return words;
+}
+
+void TargetInfo::storeMatrix(RewriterBase &rewriter, Location loc, Value ptr,
+                             ArrayRef<Value> vals, bool trans) const {
+  rewriter.create<triton::nvgpu::StoreMatrixOp>(
+      loc, ptr, vals, trans ? rewriter.getUnitAttr() : UnitAttr());
+}
+
 bool TargetInfo::processReplicaUsingStMatrix(
     RewriterBase &rewriter, Location loc, Value smemBase,
     SmallVector<Value> &vals, RankedTensorType srcTy, Type elemTy,
@@ -512,6 +568,14 @@ std::string TargetInfo::getMulhiFuncName(Type resultElementTy) const {
   return funcName;
 }
 
+Value TargetInfo::timestamp(RewriterBase &rewriter, Location loc) const {
+  // %globaltimer counts nanoseconds
+  PTXBuilder builder;
+  auto &mov = builder.create("mov")->o("u64");
+  mov(builder.newOperand("=l"), builder.newConstantOperand("%globaltimer"));
+  return builder.launch(rewriter, loc, i64_ty, /*hasSideEffects=*/true);
+}
+
 void TargetInfo::printf(RewriterBase &rewriter, Value formatStrStart,
                         int /*formatStrByteCount*/, ValueRange args) const {
   auto *ctx = rewriter.getContext();
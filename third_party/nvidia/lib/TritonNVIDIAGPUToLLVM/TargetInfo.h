@@ -9,6 +9,8 @@ class TargetInfo : public mlir::triton::TargetInfoBase {
 public:
   TargetInfo(int computeCapability) : computeCapability(computeCapability) {}
 
+  int getComputeCapability() const { return computeCapability; }
+
   bool supportMaximumMinimum() const override;
 
   Value getClusterCTAId(RewriterBase &rewriter, Location loc) const override;
@@ -23,6 +25,8 @@ public:
                     std::optional<Value> ctaId, Type elemTy,
                     Value pred) const override;
 
+  void clusterBarrier(RewriterBase &rewriter, Location loc) const override;
+
   Value shuffleXor(RewriterBase &rewriter, Location loc, Value val,
                    int i) const override;
   Value shuffleUp(RewriterBase &rewriter, Location loc, Value val,
@@ -31,6 +35,13 @@ public:
                    int i) const override;
   Value shuffleIdx(RewriterBase &rewriter, Location loc, Value val,
                    Value i) const override;
+  Value shuffleXorForReduce(RewriterBase &rewriter, Location loc, Value val,
+                            int i) const override;
+  Value shuffleUpForScan(RewriterBase &rewriter, Location loc, Value val, int i,
+                         unsigned groupSize) const override;
+
+  Value makeWarpUniform(RewriterBase &rewriter, Location loc,
+                        Value val) const override;
 
   Value programId(RewriterBase &rewriter, Location loc, ModuleOp moduleOp,
                   int axis) const override;
@@ -39,6 +50,14 @@ public:
                   triton::ReduceOp op, unsigned numLaneToReduce,
                   unsigned interleave) const override;
 
+  bool canUseLdMatrix() const override;
+  bool canUseStMatrix() const override;
+
+  SmallVector<Value> loadMatrix(RewriterBase &rewriter, Location loc, Value ptr,
+                                bool trans) const override;
+  void storeMatrix(RewriterBase &rewriter, Location loc, Value ptr,
+                   ArrayRef<Value> vals, bool trans) const override;
+
   bool processReplicaUsingStMatrix(RewriterBase &rewriter, Location loc,
                                    Value smemBase, SmallVector<Value> &vals,
                                    RankedTensorType srcTy, Type elemTy,
@@ -50,6 +69,8 @@ public:
 
   std::string getMulhiFuncName(Type resultElementTy) const override;
 
+  Value timestamp(RewriterBase &rewriter, Location loc) const override;
+
   void printf(RewriterBase &rewriter, Value formatStrStart,
               int formatStrByteCount, ValueRange args) const override;
   void assertFail(RewriterBase &rewriter, Location loc, StringRef message,
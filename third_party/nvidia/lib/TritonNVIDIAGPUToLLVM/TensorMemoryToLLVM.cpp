@@ -0,0 +1,251 @@
+#include "PatternTritonGPUOpToLLVM.h"
+#include "TritonNVIDIAGPUToLLVM/PTXAsmFormat.h"
+#include "mlir/Conversion/LLVMCommon/Pattern.h"
+#include "triton/Conversion/TritonGPUToLLVM/Utility.h"
+#include "triton/Dialect/TritonNvidiaGPU/IR/Dialect.h"
+#include "llvm/Support/MathExtras.h"
+
+#include "Utility.h"
+
+using namespace mlir;
+using namespace mlir::triton;
+
+namespace ttng = mlir::triton::nvidia_gpu;
+
+namespace {
+
+// The most 32-bit registers moved by a single tcgen05.ld or tcgen05.st.
+constexpr int kMaxTmemRegsPerAccess = 32;
+
+void createTcgen05Inst(ConversionPatternRewriter &rewriter, Location loc,
+                       const std::string &ptx, ArrayRef<Value> args,
+                       ArrayRef<std::string> constraints) {
+  PTXBuilder ptxBuilder;
+  SmallVector<PTXBuilder::Operand *> operands;
+  for (auto [arg, constraint] : llvm::zip(args, constraints))
+    operands.push_back(ptxBuilder.newOperand(arg, constraint));
+  auto &inst = *ptxBuilder.create<>(ptx);
+  inst(operands, /*onlyAttachMLIRArgs=*/true);
+  ptxBuilder.launch(rewriter, loc, void_ty(rewriter.getContext()));
+}
+
+Value getWarpId(ConversionPatternRewriter &rewriter, Location loc) {
+  Value warpId = udiv(getThreadId(rewriter, loc), i32_val(32));
+  // Make the warp id uniform so that the predicates of the .sync.aligned
+  // instructions below are known to be warp-uniform.
+  return LLVM::NVIDIA::shuffleIdx(loc, rewriter, warpId, 0);
+}
+
+// Address of the tensor memory accessed by the current warp, following the
+// layout of getTmemCompatibleLayout: warp `w` accesses the lanes
+// [32 * (w % 4), 32 * (w % 4) + 32) and the `colsPerThread` columns of the
+// column group `w / 4`.
+Value getWarpTmemAddress(ConversionPatternRewriter &rewriter, Location loc,
+                         Value base, int colsPerThread) {
+  Value warpId = getWarpId(rewriter, loc);
+  Value lane = mul(urem(warpId, i32_val(4)), i32_val(32));
+  Value col = mul(udiv(warpId, i32_val(4)), i32_val(colsPerThread));
+  return add(base, add(shl(lane, i32_val(16)), col));
+}
+
+// The `[taddr]` operand of tcgen05.ld and tcgen05.st, which take no offset.
+PTXBuilder::Operand *newTmemAddrOperand(PTXBuilder &ptxBuilder, Value addr) {
+  auto *opr = ptxBuilder.newOperand(addr, "r");
+  opr->repr = [](int idx) { return "[$" + std::to_string(idx) + "]"; };
+  return opr;
+}
+
+// Splits the columns of a thread in the power-of-2 numbers of registers
+// accepted by tcgen05.ld and tcgen05.st.
+SmallVector<std::pair<int, int>> getTmemAccessChunks(int numRegs) {
+  SmallVector<std::pair<int, int>> chunks;
+  for (int start = 0; start < numRegs;) {
+    int size = std::min<int>(llvm::bit_floor<unsigned>(numRegs - start),
+                             kMaxTmemRegsPerAccess);
+    chunks.push_back({start, size});
+    start += size;
+  }
+  return chunks;
+}
+
+void storeToTmem(ConversionPatternRewriter &rewriter, Location loc,
+                 Value address, ArrayRef<Value> values) {
+  for (auto [start, size] : getTmemAccessChunks(values.size())) {
+    PTXBuilder ptxBuilder;
+    auto &st = *ptxBuilder.create<>("tcgen05.st.sync.aligned.32x32b.x" +
+                                    std::to_string(size) + ".b32");
+    auto *addr = newTmemAddrOperand(ptxBuilder, add(address, i32_val(start)));
+    auto *srcs = ptxBuilder.newListOperand();
+    for (Value value : values.slice(start, size))
+      srcs->listAppend(ptxBuilder.newOperand(bitcast(value, i32_ty), "r"));
+    st(addr, srcs);
+    ptxBuilder.launch(rewriter, loc, void_ty(rewriter.getContext()));
+  }
+  // Make the stores visible to the thread issuing the following MMA, which
+  // synchronizes with the other threads before issuing it.
+  createTcgen05Inst(rewriter, loc, "tcgen05.wait::st.sync.aligned;", {}, {});
+  createTcgen05Inst(rewriter, loc, "tcgen05.fence::before_thread_sync;", {},
+                    {});
+}
+
+SmallVector<Value> loadFromTmem(ConversionPatternRewriter &rewriter,
+                                Location loc, Value address, int numRegs,
+                                Type elemTy) {
+  MLIRContext *ctx = rewriter.getContext();
+  // Order the loads after the synchronization with the MMA, i.e. the wait on
+  // its barrier.
+  createTcgen05Inst(rewriter, loc, "tcgen05.fence::after_thread_sync;", {},
+                    {});
+  SmallVector<Value> values;
+  for (auto [start, size] : getTmemAccessChunks(numRegs)) {
+    PTXBuilder ptxBuilder;
+    auto &ld = *ptxBuilder.create<>("tcgen05.ld.sync.aligned.32x32b.x" +
+                                    std::to_string(size) + ".b32");
+    auto *dsts = ptxBuilder.newListOperand(size, "=r");
+    auto *addr = newTmemAddrOperand(ptxBuilder, add(address, i32_val(start)));
+    ld(dsts, addr);
+    Type resTy = struct_ty(SmallVector<Type>(size, i32_ty));
+    Value res = ptxBuilder.launch(rewriter, loc, resTy);
+    for (int i = 0; i < size; ++i)
+      values.push_back(bitcast(extract_val(i32_ty, res, i), elemTy));
+  }
+  createTcgen05Inst(rewriter, loc, "tcgen05.wait::ld.sync.aligned;", {}, {});
+  return values;
+}
+
+int getColsPerThread(MemDescType type, int numWarps) {
+  return type.getShape()[1] / (numWarps / 4);
+}
+
+struct TMEMAllocateColumnsOpConversion
+    : public ConvertOpToLLVMPattern<ttng::TMEMAllocateColumnsOp> {
+  using ConvertOpToLLVMPattern::ConvertOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(ttng::TMEMAllocateColumnsOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Location loc = op->getLoc();
+    auto smemObj = LLVM::getSharedMemoryObjectFromStruct(
+        loc, adaptor.getSlot(), i32_ty, rewriter);
+    Value pred = icmp_eq(getWarpId(rewriter, loc), i32_val(0));
+    const std::string numCols = std::to_string(op.getNumCols());
+    createTcgen05Inst(
+        rewriter, loc,
+        "@$0 tcgen05.alloc.cta_group::1.sync.aligned.shared::cta.b32 [$1], " +
+            numCols + ";",
+        {pred, smemObj.getBase()}, {"b", "r"});
+    createTcgen05Inst(
+        rewriter, loc,
+        "@$0 tcgen05.relinquish_alloc_permit.cta_group::1.sync.aligned;",
+        {pred}, {"b"});
+    barrier();
+    Value base = load(i32_ty, smemObj.getBase());
+    rewriter.replaceOp(op, base);
+    return success();
+  }
+};
+
+struct TMEMDeallocateColumnsOpConversion
+    : public ConvertOpToLLVMPattern<ttng::TMEMDeallocateColumnsOp> {
+  using ConvertOpToLLVMPattern::ConvertOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(ttng::TMEMDeallocateColumnsOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Location loc = op->getLoc();
+    // Wait for all the warps to be done with the columns.
+    createTcgen05Inst(rewriter, loc, "tcgen05.fence::before_thread_sync;", {},
+                      {});
+    barrier();
+    createTcgen05Inst(rewriter, loc, "tcgen05.fence::after_thread_sync;", {},
+                      {});
+    Value pred = icmp_eq(getWarpId(rewriter, loc), i32_val(0));
+    createTcgen05Inst(rewriter, loc,
+                      "@$0 tcgen05.dealloc.cta_group::1.sync.aligned.b32 $1, " +
+                          std::to_string(op.getNumCols()) + ";",
+                      {pred, adaptor.getBase()}, {"b", "r"});
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
+struct TMEMAllocOpConversion
+    : public ConvertOpToLLVMPattern<ttng::TMEMAllocOp> {
+  using ConvertOpToLLVMPattern::ConvertOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(ttng::TMEMAllocOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Location loc = op->getLoc();
+    auto colOffset =
+        op->getAttrOfType<IntegerAttr>("tensor_memory_col_offset");
+    if (!adaptor.getBase() || !colOffset)
+      return op.emitOpError(
+          "tensor memory must be allocated before lowering to LLVM");
+    Value address = add(adaptor.getBase(), i32_val(colOffset.getInt()));
+    if (op.getSrc()) {
+      int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(
+          op->getParentOfType<ModuleOp>());
+      Value warpAddress = getWarpTmemAddress(
+          rewriter, loc, address, getColsPerThread(op.getType(), numWarps));
+      storeToTmem(rewriter, loc, warpAddress,
+                  unpackLLElements(loc, adaptor.getSrc(), rewriter));
+    }
+    rewriter.replaceOp(op, address);
+    return success();
+  }
+};
+
+struct TMEMLoadOpConversion : public ConvertOpToLLVMPattern<ttng::TMEMLoadOp> {
+  using ConvertOpToLLVMPattern::ConvertOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(ttng::TMEMLoadOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Location loc = op->getLoc();
+    int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(
+        op->getParentOfType<ModuleOp>());
+    int colsPerThread = getColsPerThread(op.getSrc().getType(), numWarps);
+    Value warpAddress =
+        getWarpTmemAddress(rewriter, loc, adaptor.getSrc(), colsPerThread);
+    SmallVector<Value> values =
+        loadFromTmem(rewriter, loc, warpAddress, colsPerThread,
+                     op.getType().getElementType());
+    Value result = packLLElements(loc, getTypeConverter(), values, rewriter,
+                                  op.getType());
+    rewriter.replaceOp(op, result);
+    return success();
+  }
+};
+
+struct TMEMStoreOpConversion
+    : public ConvertOpToLLVMPattern<ttng::TMEMStoreOp> {
+  using ConvertOpToLLVMPattern::ConvertOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(ttng::TMEMStoreOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Location loc = op->getLoc();
+    int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(
+        op->getParentOfType<ModuleOp>());
+    Value warpAddress =
+        getWarpTmemAddress(rewriter, loc, adaptor.getDst(),
+                           getColsPerThread(op.getDst().getType(), numWarps));
+    storeToTmem(rewriter, loc, warpAddress,
+                unpackLLElements(loc, adaptor.getSrc(), rewriter));
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
+} // namespace
+
+void mlir::triton::NVIDIA::populateTensorMemoryOpToLLVMPatterns(
+    LLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
+    PatternBenefit benefit) {
+  patterns.add<TMEMAllocateColumnsOpConversion>(typeConverter, benefit);
+  patterns.add<TMEMDeallocateColumnsOpConversion>(typeConverter, benefit);
+  patterns.add<TMEMAllocOpConversion>(typeConverter, benefit);
+  patterns.add<TMEMLoadOpConversion>(typeConverter, benefit);
+  patterns.add<TMEMStoreOpConversion>(typeConverter, benefit);
+}
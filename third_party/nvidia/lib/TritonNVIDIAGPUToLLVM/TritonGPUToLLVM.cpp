@@ -80,8 +80,10 @@ struct ConvertTritonGPUToLLVM
                     NVVM::NVVMDialect>();
   }
 
-  ConvertTritonGPUToLLVM(int32_t computeCapability)
-      : ConvertTritonGPUToLLVMBase({computeCapability}) {}
+  ConvertTritonGPUToLLVM(int32_t computeCapability, bool fastMath,
+                         int32_t deviceLogCapacity)
+      : ConvertTritonGPUToLLVMBase(
+            {computeCapability, fastMath, deviceLogCapacity}) {}
 
   void runOnOperation() override {
     MLIRContext *context = &getContext();
@@ -90,6 +92,15 @@ struct ConvertTritonGPUToLLVM
     mlir::LowerToLLVMOptions option(context);
     option.overrideIndexBitwidth(32);
     TritonGPUToLLVMTypeConverter typeConverter(context, option);
+    // Tensor memory buffers are represented by their 32-bit tensor memory
+    // address.
+    typeConverter.addConversion(
+        [&](triton::MemDescType type) -> std::optional<Type> {
+          if (!isa_and_nonnull<ttng::TensorMemorySpaceAttr>(
+                  type.getMemorySpace()))
+            return std::nullopt;
+          return IntegerType::get(type.getContext(), 32);
+        });
     TritonLLVMConversionTarget convTarget(*context);
     int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
     int numCTAs = triton::gpu::TritonGPUDialect::getNumCTAs(mod);
@@ -100,6 +111,9 @@ struct ConvertTritonGPUToLLVM
     ModuleMembarAnalysis membarPass(&allocation);
     membarPass.run();
 
+    if (deviceLogCapacity > 0)
+      LLVM::createDeviceLog(mod, deviceLogCapacity);
+
     // Lower functions
     {
       mlir::LowerToLLVMOptions option(context);
@@ -125,9 +139,6 @@ struct ConvertTritonGPUToLLVM
     RewritePatternSet patterns(context);
     TargetInfo targetInfo(computeCapability);
     int benefit = patternBenefitPrioritizeOverLLVMConversions;
-    mlir::triton::NVIDIA::populateConvertLayoutOpToLLVMOptimizedPatterns(
-        typeConverter, targetInfo, patterns,
-        patternBenefitConvertLayoutOptimizedPattern);
     mlir::triton::NVIDIA::populateConvertLayoutOpToLLVMPatterns(
         typeConverter, targetInfo, patterns, benefit);
     populateDotOpToLLVMPatterns(typeConverter, patterns, benefit);
@@ -137,19 +148,29 @@ struct ConvertTritonGPUToLLVM
     populateClampFOpToLLVMPattern(typeConverter, patterns, axisInfoAnalysis,
                                   computeCapability,
                                   patternBenefitClampOptimizedPattern);
+    // The approximations take precedence over the precise lowerings of the
+    // same ops.
+    if (fastMath)
+      populateFastMathOpToLLVMPatterns(typeConverter, patterns,
+                                       axisInfoAnalysis, benefit + 1);
     populateLoadStoreOpToLLVMPatterns(typeConverter, targetInfo, patterns,
                                       axisInfoAnalysis, benefit);
     mlir::triton::populateReduceOpToLLVMPatterns(typeConverter, patterns,
                                                  targetInfo, benefit);
     mlir::triton::populateScanOpToLLVMPatterns(typeConverter, patterns,
                                                targetInfo, benefit);
+    mlir::triton::populateGatherOpToLLVMPatterns(typeConverter, patterns,
+                                                 targetInfo, benefit);
     populateBarrierOpToLLVMPatterns(typeConverter, patterns, benefit);
     populateTensorPtrOpsToLLVMPatterns(typeConverter, patterns, benefit);
+    populateTensorMemoryOpToLLVMPatterns(typeConverter, patterns, benefit);
     populateClusterOpsToLLVMPatterns(typeConverter, patterns, benefit);
     mlir::triton::populateHistogramOpToLLVMPatterns(typeConverter, patterns,
                                                     targetInfo, benefit);
     mlir::triton::populatePrintOpToLLVMPattern(typeConverter, patterns,
                                                targetInfo, benefit);
+    mlir::triton::populateProfileRegionOpToLLVMPattern(typeConverter, patterns,
+                                                       targetInfo, benefit);
     mlir::triton::populateControlFlowOpToLLVMPattern(typeConverter, patterns,
                                                      benefit);
     mlir::triton::NVIDIA::populateSPMDOpToLLVMPattern(typeConverter, patterns,
@@ -174,6 +195,8 @@ struct ConvertTritonGPUToLLVM
                                                    patterns, benefit);
     if (failed(applyPartialConversion(mod, convTarget, std::move(patterns))))
       return signalPassFailure();
+    if (fastMath)
+      LLVM::setFastMathFlags(mod);
 
     // Fold CTAId when there is only 1 CTA.
     if (numCTAs == 1) {
@@ -222,8 +245,10 @@ std::unique_ptr<OperationPass<ModuleOp>> createConvertTritonGPUToLLVMPass() {
   return std::make_unique<ConvertTritonGPUToLLVM>();
 }
 std::unique_ptr<OperationPass<ModuleOp>>
-createConvertTritonGPUToLLVMPass(int32_t computeCapability) {
-  return std::make_unique<ConvertTritonGPUToLLVM>(computeCapability);
+createConvertTritonGPUToLLVMPass(int32_t computeCapability, bool fastMath,
+                                 int32_t deviceLogCapacity) {
+  return std::make_unique<ConvertTritonGPUToLLVM>(computeCapability, fastMath,
+                                                  deviceLogCapacity);
 }
 
 } // namespace triton
@@ -7,6 +7,7 @@
 #include "passes.h"
 #include "triton/Dialect/TritonNvidiaGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonNvidiaGPU/Transforms/Passes.h"
+#include "triton/Dialect/TritonNvidiaGPU/Transforms/Pipelines.h"
 #include "llvm/IR/Constants.h"
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
@@ -18,12 +19,29 @@ void init_triton_nvidia_passes_ttgpuir(py::module &&m) {
   using namespace mlir::triton;
   // TODO: it is weird to pass mlir::triton::NVVM here since the conversion is
   // nvidia-specificontext
-  m.def("add_to_llvmir", [](mlir::PassManager &pm, int32_t capability) {
-    pm.addPass(mlir::triton::createConvertTritonGPUToLLVMPass(capability));
-  });
+  m.def("add_to_llvmir",
+        [](mlir::PassManager &pm, int32_t capability, bool fastMath,
+           int32_t deviceLogCapacity) {
+          pm.addPass(mlir::triton::createConvertTritonGPUToLLVMPass(
+              capability, fastMath, deviceLogCapacity));
+        });
   m.def("add_decompose_unsupported_conversions", [](mlir::PassManager &pm) {
     pm.addPass(NVIDIA::createDecomposeUnsupportedConversionsPass());
   });
+  // The passes of make_ttgir, also registered in triton-opt as
+  // triton-cuda-ttgir-pipeline.
+  m.def("add_ttgir_pipeline",
+        [](mlir::PassManager &pm, int capability, int numWarps, int numCTAs,
+           int numStages, int numDotIterationsInFlight,
+           nvidia_gpu::ClusterInfo *clusterInfo) {
+          nvidia_gpu::TTGIRPipelineOptions options;
+          options.capability = capability;
+          options.numWarps = numWarps;
+          options.numCTAs = numCTAs;
+          options.numStages = numStages;
+          options.numDotIterationsInFlight = numDotIterationsInFlight;
+          nvidia_gpu::buildTTGIRPipeline(pm, options, clusterInfo);
+        });
 }
 
 void init_triton_nvidia_passes_ttnvgpuir(py::module &&m) {
@@ -33,6 +51,8 @@ void init_triton_nvidia_passes_ttnvgpuir(py::module &&m) {
                      mlir::createTritonNvidiaGPUFenceInsertionPass);
   ADD_PASS_WRAPPER_0("add_tma_lowering",
                      mlir::createTritonNvidiaGPUTMALoweringPass);
+  ADD_PASS_WRAPPER_0("add_tensor_memory_allocation",
+                     mlir::createTritonNvidiaGPUTensorMemoryAllocationPass);
   ADD_PASS_WRAPPER_0("add_nvgpu_to_llvm",
                      mlir::triton::createConvertNVGPUToLLVMPass);
 }
@@ -16,12 +16,20 @@ void initProton(pybind11::module &&m) {
 
   m.def("start",
         [](const std::string &path, const std::string &contextSourceName,
-           const std::string &dataName, const std::string &profilerName) {
+           const std::string &dataName, const std::string &profilerName,
+           uint64_t samplingInterval, bool hardwareCounters, bool pcSampling,
+           bool memoryTracking, size_t contextDepth, size_t bufferSize) {
           auto sessionId = SessionManager::instance().addSession(
-              path, profilerName, contextSourceName, dataName);
+              path, profilerName, contextSourceName, dataName,
+              samplingInterval, hardwareCounters, pcSampling, memoryTracking,
+              contextDepth, bufferSize);
           SessionManager::instance().activateSession(sessionId);
           return sessionId;
-        });
+        },
+        "path"_a, "contextSourceName"_a, "dataName"_a, "profilerName"_a,
+        "samplingInterval"_a = 1, "hardwareCounters"_a = false,
+        "pcSampling"_a = false, "memoryTracking"_a = false,
+        "contextDepth"_a = 0, "bufferSize"_a = 0);
 
   m.def("activate", [](size_t sessionId) {
     SessionManager::instance().activateSession(sessionId);
@@ -41,6 +49,17 @@ void initProton(pybind11::module &&m) {
     SessionManager::instance().finalizeAllSessions(outputFormatEnum);
   });
 
+  m.def("start_periodic_flush", [](size_t sessionId, double interval) {
+    SessionManager::instance().startPeriodicFlush(
+        sessionId, std::chrono::milliseconds(
+                       static_cast<int64_t>(interval * 1000)));
+  });
+
+  m.def("set_tag", [](size_t sessionId, const std::string &key,
+                      const std::string &value) {
+    SessionManager::instance().setTag(sessionId, key, value);
+  });
+
   m.def("record_scope", []() { return Scope::getNewScopeId(); });
 
   m.def("enter_scope", [](size_t scopeId, const std::string &name) {
@@ -73,6 +92,22 @@ void initProton(pybind11::module &&m) {
                                                 /*aggregable=*/false);
         });
 
+  m.def("register_kernel", [](uint64_t function, const std::string &name) {
+    LaunchHook::instance().registerKernel(function, name);
+  });
+
+  m.def("set_launch_metadata",
+        [](const std::string &name,
+           const std::map<std::string, MetricValueType> &metrics) {
+          LaunchHook::instance().setLaunchMetadata(name, metrics);
+        });
+
+  // The addresses of the native launch hooks, for the launchers to call them
+  m.def("get_launch_hooks", []() {
+    return std::make_pair(reinterpret_cast<uintptr_t>(&LaunchHook::enterHook),
+                          reinterpret_cast<uintptr_t>(&LaunchHook::exitHook));
+  });
+
   pybind11::bind_map<std::map<std::string, MetricValueType>>(m, "MetricMap");
 }
 
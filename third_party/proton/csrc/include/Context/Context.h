@@ -12,10 +12,17 @@ namespace proton {
 
 /// A context is a named object.
 struct Context {
+  inline static const size_t NoNameId = std::numeric_limits<size_t>::max();
+
   std::string name{};
+  /// The id of the name if the context source interns them, so that the
+  /// contexts of a frequent name are looked up without hashing it.
+  size_t nameId{NoNameId};
 
   Context() = default;
   Context(const std::string &name) : name(name) {}
+  Context(size_t nameId, const std::string &name)
+      : name(name), nameId(nameId) {}
   virtual ~Context() = default;
 
   bool operator==(const Context &other) const { return name == other.name; }
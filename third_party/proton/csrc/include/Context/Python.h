@@ -2,13 +2,43 @@
 #define PROTON_CONTEXT_PYTHON_H_
 
 #include "Context.h"
+#include <unordered_map>
+#include <utility>
 
 namespace proton {
 
 /// Unwind the Python stack and early return a list of contexts.
+///
+/// The context of a frame is built once per code object and line, and its
+/// name is interned, so that unwinding a deep stack on each launch only looks
+/// up the frames it hasn't seen.  The cache is guarded by the GIL.
 class PythonContextSource : public ContextSource {
 public:
+  /// Keeps the `maxDepth` innermost frames of the stack, or all of them if
+  /// `maxDepth` is 0.
+  explicit PythonContextSource(size_t maxDepth = 0) : maxDepth(maxDepth) {}
+
   std::vector<Context> getContexts() override;
+
+private:
+  // A frame is identified by its code object and line
+  using FrameKey = std::pair<const void *, int>;
+
+  struct FrameKeyHash {
+    size_t operator()(const FrameKey &key) const {
+      return std::hash<const void *>()(key.first) ^
+             (std::hash<int>()(key.second) << 1);
+    }
+  };
+
+  const Context &addFrameContext(const FrameKey &key, const std::string &name);
+
+  const size_t maxDepth;
+  // frame -> index of its context in frameContexts
+  std::unordered_map<FrameKey, size_t, FrameKeyHash> frameIndices;
+  std::vector<Context> frameContexts;
+  // name -> name id
+  std::unordered_map<std::string, size_t> nameIds;
 };
 
 } // namespace proton
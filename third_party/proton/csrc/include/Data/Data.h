@@ -5,12 +5,14 @@
 #include "Metric.h"
 #include <map>
 #include <memory>
+#include <mutex>
+#include <ostream>
 #include <shared_mutex>
 #include <string>
 
 namespace proton {
 
-enum class OutputFormat { Hatchet, Count };
+enum class OutputFormat { Hatchet, ChromeTrace, Binary, Count };
 
 class Data : public ThreadLocalOpInterface {
 public:
@@ -34,9 +36,17 @@ public:
                           bool aggregable) = 0;
 
   /// Dump the data to the given output format.
+  /// Binary dumps are incremental: the file is created by the first one, and
+  /// each dump appends what changed since the previous one.
   /// [MT] Thread-safe.
   void dump(OutputFormat outputFormat);
 
+  /// Tag the data (e.g., with the rank of the process), so that the profiles
+  /// of several processes can be told apart and merged.  Tags are written with
+  /// the hatchet and chrome_trace outputs.
+  /// [MT] Thread-safe.
+  void setTag(const std::string &key, const std::string &value);
+
 protected:
   /// The actual implementation of the dump operation.
   /// [MT] Thread-safe.
@@ -45,6 +55,12 @@ protected:
   mutable std::shared_mutex mutex;
   const std::string path{};
   ContextSource *contextSource{};
+  std::map<std::string, std::string> tags;
+
+private:
+  // Serializes the incremental dumps to `binaryOutput`
+  std::mutex binaryMutex;
+  std::unique_ptr<std::ostream> binaryOutput;
 };
 
 OutputFormat parseOutputFormat(const std::string &outputFormat);
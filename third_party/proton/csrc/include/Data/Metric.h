@@ -2,12 +2,13 @@
 #define PROTON_DATA_METRIC_H_
 
 #include "Utility/Traits.h"
+#include <algorithm>
 #include <variant>
 #include <vector>
 
 namespace proton {
 
-enum class MetricKind { Flexible, Kernel, Count };
+enum class MetricKind { Flexible, Kernel, Counter, Memory, Count };
 
 using MetricValueType = std::variant<uint64_t, int64_t, double, std::string>;
 
@@ -16,7 +17,7 @@ using MetricValueType = std::variant<uint64_t, int64_t, double, std::string>;
 /// Each `Metric` has a name and a set of values.
 /// Each value could be of type `uint64_t`, `int64_t`, or `double`,
 /// Each value also has its own name and is either aggregable or not.
-/// Currently the only aggregation operation is `addition`.
+/// Aggregable values are added, unless they are maxima (e.g., peaks).
 class Metric {
 public:
   Metric(MetricKind kind, size_t size) : kind(kind), values(size) {}
@@ -29,6 +30,9 @@ public:
 
   virtual bool isAggregable(int valueId) const = 0;
 
+  /// Whether an aggregable value aggregates by maximum instead of addition.
+  virtual bool isMaximum(int valueId) const { return false; }
+
   std::vector<MetricValueType> getValues() const { return values; }
 
   MetricValueType getValue(int valueId) { return values[valueId]; }
@@ -44,7 +48,9 @@ public:
             using CurrentType = std::decay_t<decltype(currentValue)>;
             using ValueType = std::decay_t<decltype(otherValue)>;
             if constexpr (std::is_same_v<ValueType, CurrentType>) {
-              if (isAggregable(valueId)) {
+              if (isAggregable(valueId) && isMaximum(valueId)) {
+                currentValue = std::max(currentValue, otherValue);
+              } else if (isAggregable(valueId)) {
                 currentValue += otherValue;
               } else {
                 currentValue = otherValue;
@@ -115,13 +121,14 @@ public:
     Duration,
     DeviceId,
     DeviceType,
+    StreamId,
     Count,
   };
 
   KernelMetric() : Metric(MetricKind::Kernel, kernelMetricKind::Count) {}
 
   KernelMetric(uint64_t startTime, uint64_t endTime, uint64_t invocations,
-               uint64_t deviceId, uint64_t deviceType)
+               uint64_t deviceId, uint64_t deviceType, uint64_t streamId = 0)
       : KernelMetric() {
     this->values[StartTime] = startTime;
     this->values[EndTime] = endTime;
@@ -129,6 +136,13 @@ public:
     this->values[Duration] = endTime - startTime;
     this->values[DeviceId] = deviceId;
     this->values[DeviceType] = deviceType;
+    this->values[StreamId] = streamId;
+  }
+
+  /// Extrapolate the metric of a sampled kernel to `factor` invocations.
+  void scale(uint64_t factor) {
+    std::get<uint64_t>(this->values[Invocations]) *= factor;
+    std::get<uint64_t>(this->values[Duration]) *= factor;
   }
 
   virtual const std::string getName() const { return "KernelMetric"; }
@@ -141,10 +155,100 @@ public:
 
 private:
   const static inline bool AGGREGABLE[kernelMetricKind::Count] = {
-      false, false, true, true, false, false};
+      false, false, true, true, false, false, false};
   const static inline std::string VALUE_NAMES[kernelMetricKind::Count] = {
-      "StartTime (ns)", "EndTime (ns)", "Count",
-      "Time (ns)",      "DeviceId",     "DeviceType",
+      "StartTime (ns)", "EndTime (ns)", "Count",    "Time (ns)",
+      "DeviceId",       "DeviceType",   "StreamId",
+  };
+};
+
+/// Hardware counters of a kernel, collected by the profiler on demand.
+/// All values are sums, so that they aggregate across invocations; ratios
+/// (e.g., the L2 hit rate) are derived from them when the data is analyzed.
+class CounterMetric : public Metric {
+public:
+  enum counterMetricKind : int {
+    DramBytes,
+    L2HitSectors,
+    L2MissSectors,
+    ActiveCycles,
+    // Achieved occupancy multiplied by the active cycles
+    OccupancyCycles,
+    TensorPipeActiveCycles,
+    SharedBankConflicts,
+    Count,
+  };
+
+  CounterMetric() : Metric(MetricKind::Counter, counterMetricKind::Count) {
+    for (int i = 0; i < counterMetricKind::Count; ++i)
+      this->values[i] = 0.0;
+  }
+
+  void setValue(int valueId, double value) { this->values[valueId] = value; }
+
+  virtual const std::string getName() const { return "CounterMetric"; }
+
+  virtual const std::string getValueName(int valueId) const {
+    return VALUE_NAMES[valueId];
+  }
+
+  virtual bool isAggregable(int valueId) const { return true; }
+
+private:
+  const static inline std::string VALUE_NAMES[counterMetricKind::Count] = {
+      "dram_bytes",
+      "l2_hit_sectors",
+      "l2_miss_sectors",
+      "sm_active_cycles",
+      "sm_occupancy_cycles",
+      "tensor_pipe_active_cycles",
+      "smem_bank_conflicts",
+  };
+};
+
+/// Device memory allocated and freed by a scope.  The peak is the largest
+/// amount of device memory allocated while profiling, right after any of the
+/// allocations of the scope, so that it aggregates by maximum.
+class MemoryMetric : public Metric {
+public:
+  enum memoryMetricKind : int {
+    AllocatedBytes,
+    FreedBytes,
+    Allocations,
+    PeakBytes,
+    Count,
+  };
+
+  MemoryMetric() : Metric(MetricKind::Memory, memoryMetricKind::Count) {
+    for (int i = 0; i < memoryMetricKind::Count; ++i)
+      this->values[i] = uint64_t{0};
+  }
+
+  MemoryMetric(uint64_t allocatedBytes, uint64_t freedBytes,
+               uint64_t allocations, uint64_t peakBytes)
+      : MemoryMetric() {
+    this->values[AllocatedBytes] = allocatedBytes;
+    this->values[FreedBytes] = freedBytes;
+    this->values[Allocations] = allocations;
+    this->values[PeakBytes] = peakBytes;
+  }
+
+  virtual const std::string getName() const { return "MemoryMetric"; }
+
+  virtual const std::string getValueName(int valueId) const {
+    return VALUE_NAMES[valueId];
+  }
+
+  virtual bool isAggregable(int valueId) const { return true; }
+
+  virtual bool isMaximum(int valueId) const { return valueId == PeakBytes; }
+
+private:
+  const static inline std::string VALUE_NAMES[memoryMetricKind::Count] = {
+      "alloc_bytes",
+      "free_bytes",
+      "allocs",
+      "peak_bytes",
   };
 };
 
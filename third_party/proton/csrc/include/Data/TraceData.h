@@ -3,12 +3,29 @@
 
 #include "Data.h"
 
+#include <atomic>
+#include <memory>
+#include <vector>
+
 namespace proton {
 
-class TraceData : public Data {
+/// Records a timeline of events instead of aggregating metrics: the scopes and
+/// ops entered and exited by each host thread, and every kernel executed on the
+/// devices, with their streams.  Dumped as a Chrome trace, which Perfetto and
+/// chrome://tracing can open.
+///
+/// Each recording thread (application threads and the threads of the profiler
+/// delivering activity records) appends its events to its own ring buffer
+/// without locking; the buffers are merged when the data is dumped.  When a
+/// buffer is full the oldest events of the thread are overwritten.
+class TraceData : public Data, public ScopeInterface {
 public:
-  using Data::Data;
-  virtual ~TraceData() = default;
+  /// Maximum number of events kept per thread.
+  inline static const size_t DefaultBufferCapacity = 1 << 18;
+
+  TraceData(const std::string &path, ContextSource *contextSource = nullptr,
+            size_t bufferCapacity = DefaultBufferCapacity);
+  virtual ~TraceData();
 
   size_t addScope(size_t scopeId, const std::string &name) override;
 
@@ -18,13 +35,33 @@ public:
                   const std::map<std::string, MetricValueType> &metrics,
                   bool aggregable) override;
 
+  // ScopeInterface
+  void enterScope(const Scope &scope) override;
+
+  void exitScope(const Scope &scope) override;
+
 protected:
+  // OpInterface
   void startOp(const Scope &scope) override final;
 
   void stopOp(const Scope &scope) override final;
 
 private:
+  struct Event;
+  class EventBuffer;
+
+  void record(Event &&event);
+  EventBuffer &getThreadBuffer();
+  void dumpChromeTrace(std::ostream &os) const;
   void doDump(std::ostream &os, OutputFormat outputFormat) const override;
+
+  const size_t id;
+  const size_t bufferCapacity;
+  // Buffers of all the threads that recorded events.  Only modified when a
+  // thread records its first event.
+  std::vector<std::shared_ptr<EventBuffer>> buffers;
+
+  inline static std::atomic<size_t> nextId{0};
 };
 
 } // namespace proton
@@ -3,11 +3,37 @@
 
 #include "Context/Context.h"
 #include "Data.h"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <unordered_map>
+#include <vector>
 
 namespace proton {
 
+/// Aggregates metrics by calling context.
+///
+/// Each thread that enters ops or records contexts builds its own tree, so
+/// that application threads launching kernels concurrently do not contend on a
+/// single lock.  The trees are merged when the data is dumped.  Metrics
+/// delivered by the profiler's threads are added to the tree of the thread
+/// that launched the kernel, found through the scope id.
+///
+/// The binary output format is a log of records, each starting with a one
+/// byte tag, with integers encoded as LEB128 varints and strings as their
+/// length followed by their bytes:
+///   "PROTONB1"                            file header
+///   Node:    id, parent id, name          a new node; the root has id 0
+///   Name:    id, name                     a new metric name
+///   Metrics: node id, count, count x (name id, type, value)
+///   Device:  type, id, clock rate, memory clock rate, bus width, number of
+///            SMs, arch
+///   End                                   the end of a dump
+/// The values of a Metrics record are the current totals of a node, and are
+/// only written when they changed since the previous dump.  Records after the
+/// last End are incomplete and ignored by readers.
 class TreeData : public Data {
 public:
   TreeData(const std::string &path, ContextSource *contextSource);
@@ -30,14 +56,46 @@ protected:
   void stopOp(const Scope &scope) override;
 
 private:
-  void init();
+  class Tree;
+  struct ThreadTree;
+
+  // Where the context of a scope lives
+  struct ScopeContext {
+    ThreadTree *threadTree;
+    size_t contextId;
+  };
+
+  // A shard of the scope id -> context map
+  struct ScopeMap {
+    std::mutex mutex;
+    std::unordered_map<size_t, ScopeContext> scopeIdToContext;
+  };
+
+  inline static const size_t NumScopeMaps = 64;
+
+  ThreadTree &getThreadTree();
+  ScopeMap &getScopeMap(size_t scopeId) {
+    return scopeMaps[scopeId % NumScopeMaps];
+  }
+  bool findScope(size_t scopeId, ScopeContext &scopeContext);
+  void setScope(size_t scopeId, const ScopeContext &scopeContext);
+  std::vector<Context> getContexts() const;
+
+  void mergeThreadTrees(Tree &tree) const;
   void dumpHatchet(std::ostream &os) const;
+  void dumpBinary(std::ostream &os) const;
   void doDump(std::ostream &os, OutputFormat outputFormat) const override;
 
-  class Tree;
-  std::unique_ptr<Tree> tree;
-  // ScopeId -> ContextId
-  std::unordered_map<size_t, size_t> scopeIdToContextId;
+  const size_t id;
+  // Trees of all the threads that recorded contexts.  Only modified when a
+  // thread records its first context.
+  std::vector<std::shared_ptr<ThreadTree>> threadTrees;
+  std::array<ScopeMap, NumScopeMaps> scopeMaps;
+  // What the previous binary dumps wrote
+  struct BinaryState;
+  mutable std::unique_ptr<BinaryState> binaryState;
+
+  inline static std::atomic<size_t> nextId{0};
 };
 
 } // namespace proton
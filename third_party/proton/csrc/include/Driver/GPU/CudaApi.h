@@ -14,6 +14,8 @@ template <bool CheckSuccess> CUresult ctxSynchronize();
 
 template <bool CheckSuccess> CUresult ctxGetCurrent(CUcontext *pctx);
 
+template <bool CheckSuccess> CUresult ctxGetDevice(CUdevice *device);
+
 template <bool CheckSuccess>
 CUresult deviceGetAttribute(int *pi, CUdevice_attribute attrib, CUdevice dev);
 
@@ -70,6 +70,30 @@ protected:
       profiler.correlation.popExternId();
       profiler.setOpInProgress(false);
     }
+
+    /// Called on entering a launch API, returns whether the launch is
+    /// sampled.  Launch APIs called by another one (e.g., a driver launch
+    /// called by a runtime launch) follow the outermost one's decision.
+    bool enterLaunch() {
+      if (launchDepth++ == 0)
+        sampled = numLaunches++ % profiler.getSamplingInterval() == 0;
+      return sampled;
+    }
+
+    /// Called on exiting a launch API, returns whether the launch is sampled.
+    bool exitLaunch() {
+      if (launchDepth > 0)
+        --launchDepth;
+      return sampled;
+    }
+
+    /// Number of launch APIs being called, 1 in the outermost one.
+    size_t getLaunchDepth() const { return launchDepth; }
+
+  private:
+    size_t launchDepth{0};
+    uint64_t numLaunches{0};
+    bool sampled{true};
   };
 
   struct Correlation {
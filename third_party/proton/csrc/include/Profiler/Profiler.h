@@ -11,6 +11,7 @@
 #include <mutex>
 #include <set>
 #include <shared_mutex>
+#include <stdexcept>
 #include <string>
 
 namespace proton {
@@ -73,6 +74,63 @@ public:
     return dataSet;
   }
 
+  /// Profile one in every `interval` kernel launches of each thread.
+  /// The metrics of the sampled launches are extrapolated to all launches.
+  Profiler *setSamplingInterval(uint64_t interval) {
+    if (interval == 0)
+      throw std::invalid_argument("The sampling interval must be positive");
+    samplingInterval.store(interval, std::memory_order_relaxed);
+    return this;
+  }
+
+  uint64_t getSamplingInterval() const {
+    return samplingInterval.load(std::memory_order_relaxed);
+  }
+
+  /// Collect the hardware counters of kernels, from the next start on.
+  Profiler *setHardwareCounters(bool enable) {
+    hardwareCounters.store(enable, std::memory_order_relaxed);
+    return this;
+  }
+
+  bool hasHardwareCounters() const {
+    return hardwareCounters.load(std::memory_order_relaxed);
+  }
+
+  /// Sample the program counters of kernels, from the next start on.
+  Profiler *setPCSampling(bool enable) {
+    pcSampling.store(enable, std::memory_order_relaxed);
+    return this;
+  }
+
+  bool hasPCSampling() const {
+    return pcSampling.load(std::memory_order_relaxed);
+  }
+
+  /// Track the device memory allocated and freed, from the next start on.
+  Profiler *setMemoryTracking(bool enable) {
+    memoryTracking.store(enable, std::memory_order_relaxed);
+    return this;
+  }
+
+  bool hasMemoryTracking() const {
+    return memoryTracking.load(std::memory_order_relaxed);
+  }
+
+  /// Use activity buffers of `bytes` bytes, or of the default size if 0, from
+  /// the next start on.
+  Profiler *setBufferSize(size_t bytes) {
+    bufferSize.store(bytes == 0 ? DefaultBufferSize : bytes,
+                     std::memory_order_relaxed);
+    return this;
+  }
+
+  size_t getBufferSize() const {
+    return bufferSize.load(std::memory_order_relaxed);
+  }
+
+  inline static const size_t DefaultBufferSize = 64 * 1024 * 1024;
+
 protected:
   virtual void doStart() = 0;
   virtual void doFlush() = 0;
@@ -81,6 +139,11 @@ protected:
   mutable std::shared_mutex mutex;
   std::set<Data *> dataSet;
   bool isInitialized{false};
+  std::atomic<uint64_t> samplingInterval{1};
+  std::atomic<bool> hardwareCounters{false};
+  std::atomic<bool> pcSampling{false};
+  std::atomic<bool> memoryTracking{false};
+  std::atomic<size_t> bufferSize{DefaultBufferSize};
 };
 
 } // namespace proton
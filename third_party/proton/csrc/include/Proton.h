@@ -4,6 +4,7 @@
 #include "Context/Context.h"
 #include "Data/Data.h"
 #include "Data/Metric.h"
+#include "Session/LaunchHook.h"
 #include "Session/Session.h"
 
 #endif // PROTON_H_
@@ -0,0 +1,51 @@
+#ifndef PROTON_SESSION_LAUNCH_HOOK_H_
+#define PROTON_SESSION_LAUNCH_HOOK_H_
+
+#include "Context/Context.h"
+#include "Data/Metric.h"
+#include "Utility/Singleton.h"
+
+#include <cstdint>
+#include <map>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+namespace proton {
+
+/// Native launch hooks of Triton kernels, called by the launchers with the
+/// handle of each launched kernel instead of a Python function with its
+/// launch metadata.  The name of the kernel is looked up in a table filled
+/// once per kernel, unless the kernel computes its name and metrics from its
+/// launch metadata, which are set right before the launch.
+class LaunchHook : public Singleton<LaunchHook> {
+public:
+  LaunchHook() = default;
+  ~LaunchHook() = default;
+
+  /// Record the name of the kernel with the handle `function`.
+  /// [MT] Thread-safe.
+  void registerKernel(uint64_t function, const std::string &name);
+
+  /// Set the name and the metrics of the next kernel launched by this thread,
+  /// computed from its launch metadata.
+  void setLaunchMetadata(const std::string &name,
+                         const std::map<std::string, MetricValueType> &metrics);
+
+  void enter(uint64_t function);
+
+  void exit(uint64_t function);
+
+  /// The functions called by the launchers, as `void (*)(uint64_t function)`.
+  static void enterHook(uint64_t function);
+
+  static void exitHook(uint64_t function);
+
+private:
+  std::shared_mutex mutex;
+  std::unordered_map<uint64_t, std::string> kernelNames;
+};
+
+} // namespace proton
+
+#endif // PROTON_SESSION_LAUNCH_HOOK_H_
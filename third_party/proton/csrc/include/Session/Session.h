@@ -4,11 +4,15 @@
 #include "Context/Context.h"
 #include "Data/Metric.h"
 #include "Utility/Singleton.h"
+#include <chrono>
+#include <condition_variable>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <shared_mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace proton {
@@ -22,7 +26,7 @@ enum class OutputFormat;
 /// different duration, or the same duration but with different configurations.
 class Session {
 public:
-  ~Session() = default;
+  ~Session();
 
   void activate();
 
@@ -30,12 +34,23 @@ public:
 
   void finalize(OutputFormat outputFormat);
 
+  /// Flush the profiler and append the data to its binary output every
+  /// `interval`, from a background thread, until the session is finalized.
+  void startPeriodicFlush(std::chrono::milliseconds interval);
+
+  void stopPeriodicFlush();
+
 private:
   Session(size_t id, const std::string &path, Profiler *profiler,
           std::unique_ptr<ContextSource> contextSource,
-          std::unique_ptr<Data> data)
+          std::unique_ptr<Data> data, uint64_t samplingInterval,
+          bool hardwareCounters, bool pcSampling, bool memoryTracking,
+          size_t bufferSize)
       : id(id), path(path), profiler(profiler),
-        contextSource(std::move(contextSource)), data(std::move(data)) {}
+        contextSource(std::move(contextSource)), data(std::move(data)),
+        samplingInterval(samplingInterval), hardwareCounters(hardwareCounters),
+        pcSampling(pcSampling), memoryTracking(memoryTracking),
+        bufferSize(bufferSize) {}
 
   template <typename T> std::vector<T *> getInterfaces() {
     std::vector<T *> interfaces;
@@ -56,6 +71,26 @@ private:
   Profiler *profiler{};
   std::unique_ptr<ContextSource> contextSource{};
   std::unique_ptr<Data> data{};
+  // Profile one in every `samplingInterval` kernel launches.  The profiler is
+  // shared by sessions, so the last activated session's interval applies.
+  uint64_t samplingInterval{1};
+  // Collect the hardware counters of kernels.  Takes effect when the profiler
+  // starts.
+  bool hardwareCounters{false};
+  // Sample the program counters of kernels.  Takes effect when the profiler
+  // starts.
+  bool pcSampling{false};
+  // Track the device memory allocated and freed.  Takes effect when the
+  // profiler starts.
+  bool memoryTracking{false};
+  // The size of the activity buffers of the profiler, or 0 for the default.
+  // Takes effect when the profiler starts.
+  size_t bufferSize{0};
+
+  std::thread flushThread;
+  std::mutex flushMutex;
+  std::condition_variable flushCondition;
+  bool flushStopped{false};
 
   friend class SessionManager;
 };
@@ -69,12 +104,21 @@ public:
 
   size_t addSession(const std::string &path, const std::string &profilerName,
                     const std::string &contextSourceName,
-                    const std::string &dataName);
+                    const std::string &dataName,
+                    uint64_t samplingInterval = 1,
+                    bool hardwareCounters = false, bool pcSampling = false,
+                    bool memoryTracking = false, size_t contextDepth = 0,
+                    size_t bufferSize = 0);
 
   void finalizeSession(size_t sessionId, OutputFormat outputFormat);
 
   void finalizeAllSessions(OutputFormat outputFormat);
 
+  void startPeriodicFlush(size_t sessionId, std::chrono::milliseconds interval);
+
+  void setTag(size_t sessionId, const std::string &key,
+              const std::string &value);
+
   void activateSession(size_t sesssionId);
 
   void deactivateSession(size_t sessionId);
@@ -95,7 +139,11 @@ private:
   std::unique_ptr<Session> makeSession(size_t id, const std::string &path,
                                        const std::string &profilerName,
                                        const std::string &contextSourceName,
-                                       const std::string &dataName);
+                                       const std::string &dataName,
+                                       uint64_t samplingInterval,
+                                       bool hardwareCounters, bool pcSampling,
+                                       bool memoryTracking,
+                                       size_t contextDepth, size_t bufferSize);
 
   void activateSessionImpl(size_t sesssionId);
 
@@ -3,6 +3,7 @@
 
 #include <map>
 #include <shared_mutex>
+#include <utility>
 
 namespace proton {
 
@@ -46,6 +47,18 @@ public:
     return map.erase(key) > 0;
   }
 
+  /// Moves the value of `key` to `value` and erases it, under a single lock.
+  /// Returns false if there is no such key.
+  bool pop(const Key &key, Value &value) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    auto it = map.find(key);
+    if (it == map.end())
+      return false;
+    value = std::move(it->second);
+    map.erase(it);
+    return true;
+  }
+
   void clear() {
     std::unique_lock<std::shared_mutex> lock(mutex);
     map.clear();
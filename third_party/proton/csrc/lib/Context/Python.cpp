@@ -71,6 +71,15 @@ std::string unpackPyobject(PyObject *pyObject) {
 
 } // namespace
 
+const Context &
+PythonContextSource::addFrameContext(const FrameKey &key,
+                                     const std::string &name) {
+  auto nameId = nameIds.emplace(name, nameIds.size()).first->second;
+  frameIndices[key] = frameContexts.size();
+  frameContexts.emplace_back(nameId, name);
+  return frameContexts.back();
+}
+
 std::vector<Context> PythonContextSource::getContexts() {
   pybind11::gil_scoped_acquire gil;
 
@@ -78,18 +87,27 @@ std::vector<Context> PythonContextSource::getContexts() {
   Py_XINCREF(frame);
 
   std::vector<Context> contexts;
-  while (frame != nullptr) {
+  while (frame != nullptr && (maxDepth == 0 || contexts.size() < maxDepth)) {
     PyCodeObject *f_code = getFrameCodeObject(frame);
-    size_t lineno = PyFrame_GetLineNumber(frame);
-    size_t firstLineNo = f_code->co_firstlineno;
-    std::string file = unpackPyobject(f_code->co_filename);
-    std::string function = unpackPyobject(f_code->co_name);
-    auto pythonFrame = file + ":" + function + "@" + std::to_string(lineno);
-    contexts.push_back(Context(pythonFrame));
+    int lineno = PyFrame_GetLineNumber(frame);
+    FrameKey key{f_code, lineno};
+    auto it = frameIndices.find(key);
+    if (it != frameIndices.end()) {
+      contexts.push_back(frameContexts[it->second]);
+      Py_DECREF(f_code);
+    } else {
+      std::string file = unpackPyobject(f_code->co_filename);
+      std::string function = unpackPyobject(f_code->co_name);
+      auto pythonFrame = file + ":" + function + "@" + std::to_string(lineno);
+      // The cache keeps the reference to the code object, so that its address
+      // isn't reused by another one.
+      contexts.push_back(addFrameContext(key, pythonFrame));
+    }
     auto newFrame = getFrameBack(frame);
     Py_DECREF(frame);
     frame = newFrame;
   }
+  Py_XDECREF(frame);
   std::reverse(contexts.begin(), contexts.end());
   return contexts;
 }
@@ -12,6 +12,20 @@ namespace proton {
 void Data::dump(OutputFormat outputFormat) {
   std::shared_lock<std::shared_mutex> lock(mutex);
 
+  if (outputFormat == OutputFormat::Binary) {
+    std::lock_guard<std::mutex> binaryLock(binaryMutex);
+    if (!binaryOutput) {
+      if (path.empty() || path == "-")
+        throw std::runtime_error("The binary output format requires a path");
+      binaryOutput.reset(new std::ofstream(
+          path + "." + outputFormatToString(outputFormat),
+          std::ios::binary | std::ios::trunc));
+    }
+    doDump(*binaryOutput, outputFormat);
+    binaryOutput->flush();
+    return;
+  }
+
   std::unique_ptr<std::ostream> out;
   if (path.empty() || path == "-") {
     out.reset(new std::ostream(std::cout.rdbuf())); // Redirecting to cout
@@ -23,10 +37,21 @@ void Data::dump(OutputFormat outputFormat) {
   doDump(*out, outputFormat);
 }
 
+void Data::setTag(const std::string &key, const std::string &value) {
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  tags[key] = value;
+}
+
 OutputFormat parseOutputFormat(const std::string &outputFormat) {
   if (toLower(outputFormat) == "hatchet") {
     return OutputFormat::Hatchet;
   }
+  if (toLower(outputFormat) == "chrome_trace") {
+    return OutputFormat::ChromeTrace;
+  }
+  if (toLower(outputFormat) == "binary") {
+    return OutputFormat::Binary;
+  }
   throw std::runtime_error("Unknown output format: " + outputFormat);
 }
 
@@ -34,6 +59,12 @@ const std::string outputFormatToString(OutputFormat outputFormat) {
   if (outputFormat == OutputFormat::Hatchet) {
     return "hatchet";
   }
+  if (outputFormat == OutputFormat::ChromeTrace) {
+    return "chrome_trace";
+  }
+  if (outputFormat == OutputFormat::Binary) {
+    return "binary";
+  }
   throw std::runtime_error("Unknown output format: " +
                            std::to_string(static_cast<int>(outputFormat)));
 }
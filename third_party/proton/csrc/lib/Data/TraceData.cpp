@@ -1,30 +1,338 @@
 #include "Data/TraceData.h"
-#include "Utility/Errors.h"
+#include "Data/Metric.h"
+#include "Driver/Device.h"
+#include "nlohmann/json.hpp"
 
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <set>
 #include <stdexcept>
+#include <unistd.h>
+#include <unordered_map>
+
+using json = nlohmann::json;
 
 namespace proton {
 
-void TraceData::startOp(const Scope &scope) { throw NotImplemented(); }
+namespace {
+
+// Host timestamps are taken from the same clock as the device timestamps of
+// the activity records (nanoseconds since the epoch), so that both line up.
+uint64_t getHostTime() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+double toMicroseconds(uint64_t ns) { return static_cast<double>(ns) / 1000.0; }
+
+} // namespace
+
+struct TraceData::Event {
+  enum class Kind {
+    // A scope or op entered or exited by the recording thread.
+    ScopeEnter,
+    ScopeExit,
+    OpEnter,
+    OpExit,
+    // A launch through the runtime API, made by the recording thread.
+    Launch,
+    // Names the kernels attributed to `scopeId`, a child of `parentId`.
+    ScopeName,
+    // A kernel executed on a device.
+    Kernel,
+    // User metrics of a scope.
+    Metrics,
+  };
+
+  Kind kind{};
+  size_t scopeId{};
+  size_t parentId{};
+  std::string name{};
+  uint64_t startTime{};
+  uint64_t endTime{};
+  uint64_t deviceId{};
+  uint64_t deviceType{};
+  uint64_t streamId{};
+  std::map<std::string, MetricValueType> metrics{};
+};
+
+/// A single-producer ring buffer of events: only the owning thread pushes,
+/// and events are only read once recording has stopped.
+class TraceData::EventBuffer {
+public:
+  EventBuffer(size_t capacity, size_t threadIndex)
+      : events(capacity), threadIndex(threadIndex) {}
+
+  void push(Event &&event) {
+    auto index = head.load(std::memory_order_relaxed);
+    events[index % events.size()] = std::move(event);
+    head.store(index + 1, std::memory_order_release);
+  }
+
+  /// Calls `fn` on the events kept, oldest first.
+  template <typename FnT> void forEach(FnT &&fn) const {
+    auto end = head.load(std::memory_order_acquire);
+    auto begin = end > events.size() ? end - events.size() : 0;
+    for (auto index = begin; index < end; ++index)
+      fn(events[index % events.size()]);
+  }
+
+  size_t getThreadIndex() const { return threadIndex; }
+
+private:
+  std::vector<Event> events;
+  std::atomic<size_t> head{0};
+  const size_t threadIndex;
+};
+
+TraceData::TraceData(const std::string &path, ContextSource *contextSource,
+                     size_t bufferCapacity)
+    : Data(path, contextSource), id(nextId++), bufferCapacity(bufferCapacity) {
+}
+
+TraceData::~TraceData() {}
 
-void TraceData::stopOp(const Scope &scope) { throw NotImplemented(); }
+TraceData::EventBuffer &TraceData::getThreadBuffer() {
+  // TraceData id -> buffer of this thread.  Keyed by id rather than address so
+  // that a new TraceData never picks up the buffer of a destroyed one.
+  static thread_local std::unordered_map<size_t, std::weak_ptr<EventBuffer>>
+      threadBuffers;
+  auto it = threadBuffers.find(id);
+  if (it != threadBuffers.end()) {
+    if (auto buffer = it->second.lock())
+      return *buffer;
+  }
+  for (auto iter = threadBuffers.begin(); iter != threadBuffers.end();) {
+    if (iter->second.expired())
+      iter = threadBuffers.erase(iter);
+    else
+      ++iter;
+  }
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  auto buffer = std::make_shared<EventBuffer>(bufferCapacity, buffers.size());
+  buffers.push_back(buffer);
+  threadBuffers[id] = buffer;
+  return *buffer;
+}
+
+void TraceData::record(Event &&event) {
+  getThreadBuffer().push(std::move(event));
+}
+
+void TraceData::enterScope(const Scope &scope) {
+  Event event;
+  event.kind = Event::Kind::ScopeEnter;
+  event.scopeId = scope.scopeId;
+  event.name = scope.name;
+  event.startTime = getHostTime();
+  record(std::move(event));
+}
+
+void TraceData::exitScope(const Scope &scope) {
+  Event event;
+  event.kind = Event::Kind::ScopeExit;
+  event.scopeId = scope.scopeId;
+  event.name = scope.name;
+  event.startTime = getHostTime();
+  record(std::move(event));
+}
 
-size_t TraceData::addScope(size_t scopeId, const std::string &name) {
-  throw NotImplemented();
+void TraceData::startOp(const Scope &scope) {
+  Event event;
+  event.kind = Event::Kind::OpEnter;
+  event.scopeId = scope.scopeId;
+  event.name = scope.name;
+  event.startTime = getHostTime();
+  record(std::move(event));
+}
+
+void TraceData::stopOp(const Scope &scope) {
+  Event event;
+  event.kind = Event::Kind::OpExit;
+  event.scopeId = scope.scopeId;
+  event.name = scope.name;
+  event.startTime = getHostTime();
+  record(std::move(event));
+}
+
+size_t TraceData::addScope(size_t parentScopeId, const std::string &name) {
+  Event event;
+  if (name.empty()) {
+    // Called by the launching thread for kernels of the runtime API
+    event.kind = Event::Kind::Launch;
+    event.scopeId = parentScopeId;
+    event.startTime = getHostTime();
+    record(std::move(event));
+    return parentScopeId;
+  }
+  auto scopeId = Scope::getNewScopeId();
+  event.kind = Event::Kind::ScopeName;
+  event.scopeId = scopeId;
+  event.parentId = parentScopeId;
+  event.name = name;
+  record(std::move(event));
+  return scopeId;
 }
 
 void TraceData::addMetric(size_t scopeId, std::shared_ptr<Metric> metric) {
-  throw NotImplemented();
+  if (!metric || metric->getKind() != MetricKind::Kernel)
+    return;
+  auto kernelMetric = std::dynamic_pointer_cast<KernelMetric>(metric);
+  Event event;
+  event.kind = Event::Kind::Kernel;
+  event.scopeId = scopeId;
+  event.startTime =
+      std::get<uint64_t>(kernelMetric->getValue(KernelMetric::StartTime));
+  event.endTime =
+      std::get<uint64_t>(kernelMetric->getValue(KernelMetric::EndTime));
+  event.deviceId =
+      std::get<uint64_t>(kernelMetric->getValue(KernelMetric::DeviceId));
+  event.deviceType =
+      std::get<uint64_t>(kernelMetric->getValue(KernelMetric::DeviceType));
+  event.streamId =
+      std::get<uint64_t>(kernelMetric->getValue(KernelMetric::StreamId));
+  record(std::move(event));
 }
 
 void TraceData::addMetrics(
     size_t scopeId, const std::map<std::string, MetricValueType> &metrics,
     bool aggregable) {
-  throw NotImplemented();
+  Event event;
+  event.kind = Event::Kind::Metrics;
+  event.scopeId = scopeId;
+  event.metrics = metrics;
+  record(std::move(event));
+}
+
+void TraceData::dumpChromeTrace(std::ostream &os) const {
+  // Names and metrics of the scopes, from the events of all threads
+  std::unordered_map<size_t, std::string> scopeNames;
+  std::unordered_map<size_t, json> scopeArgs;
+  for (auto &buffer : buffers) {
+    buffer->forEach([&](const Event &event) {
+      if (event.kind == Event::Kind::OpEnter ||
+          event.kind == Event::Kind::ScopeName)
+        scopeNames[event.scopeId] = event.name;
+      if (event.kind == Event::Kind::Metrics) {
+        auto &args = scopeArgs[event.scopeId];
+        for (auto &[name, value] : event.metrics)
+          std::visit([&](auto &&v) { args[name] = v; }, value);
+      }
+    });
+  }
+  auto getArgs = [&](size_t scopeId) {
+    auto it = scopeArgs.find(scopeId);
+    return it == scopeArgs.end() ? json::object() : it->second;
+  };
+
+  const auto hostPid = static_cast<uint64_t>(getpid());
+  // Each device gets its own process, and each of its streams a thread.
+  auto getDevicePid = [](uint64_t deviceType, uint64_t deviceId) {
+    return (uint64_t{1} << 32) + (deviceType << 16) + deviceId;
+  };
+
+  json traceEvents = json::array();
+  std::map<uint64_t, std::set<uint64_t>> deviceStreams;
+  std::map<uint64_t, std::pair<uint64_t, uint64_t>> devices;
+  for (auto &buffer : buffers) {
+    auto tid = buffer->getThreadIndex();
+    bool hasHostEvents = false;
+    buffer->forEach([&](const Event &event) {
+      switch (event.kind) {
+      case Event::Kind::ScopeEnter:
+      case Event::Kind::OpEnter:
+        traceEvents.push_back({{"name", event.name},
+                               {"cat", event.kind == Event::Kind::OpEnter
+                                           ? "op"
+                                           : "scope"},
+                               {"ph", "B"},
+                               {"ts", toMicroseconds(event.startTime)},
+                               {"pid", hostPid},
+                               {"tid", tid},
+                               {"args", getArgs(event.scopeId)}});
+        hasHostEvents = true;
+        break;
+      case Event::Kind::ScopeExit:
+      case Event::Kind::OpExit:
+        traceEvents.push_back({{"ph", "E"},
+                               {"ts", toMicroseconds(event.startTime)},
+                               {"pid", hostPid},
+                               {"tid", tid}});
+        hasHostEvents = true;
+        break;
+      case Event::Kind::Launch:
+        traceEvents.push_back({{"name", "launch"},
+                               {"cat", "launch"},
+                               {"ph", "i"},
+                               {"s", "t"},
+                               {"ts", toMicroseconds(event.startTime)},
+                               {"pid", hostPid},
+                               {"tid", tid}});
+        hasHostEvents = true;
+        break;
+      case Event::Kind::Kernel: {
+        auto nameIt = scopeNames.find(event.scopeId);
+        auto pid = getDevicePid(event.deviceType, event.deviceId);
+        devices[pid] = {event.deviceType, event.deviceId};
+        deviceStreams[pid].insert(event.streamId);
+        traceEvents.push_back(
+            {{"name", nameIt == scopeNames.end() ? "kernel" : nameIt->second},
+             {"cat", "kernel"},
+             {"ph", "X"},
+             {"ts", toMicroseconds(event.startTime)},
+             {"dur", toMicroseconds(event.endTime - event.startTime)},
+             {"pid", pid},
+             {"tid", event.streamId},
+             {"args", getArgs(event.scopeId)}});
+        break;
+      }
+      default:
+        break;
+      }
+    });
+    if (hasHostEvents)
+      traceEvents.push_back(
+          {{"name", "thread_name"},
+           {"ph", "M"},
+           {"pid", hostPid},
+           {"tid", tid},
+           {"args", {{"name", "thread " + std::to_string(tid)}}}});
+  }
+  traceEvents.push_back({{"name", "process_name"},
+                         {"ph", "M"},
+                         {"pid", hostPid},
+                         {"args", {{"name", "host"}}}});
+  for (auto [pid, device] : devices) {
+    auto [deviceType, deviceId] = device;
+    auto deviceName =
+        getDeviceTypeString(static_cast<DeviceType>(deviceType)) + " " +
+        std::to_string(deviceId);
+    traceEvents.push_back({{"name", "process_name"},
+                           {"ph", "M"},
+                           {"pid", pid},
+                           {"args", {{"name", deviceName}}}});
+    for (auto streamId : deviceStreams[pid])
+      traceEvents.push_back(
+          {{"name", "thread_name"},
+           {"ph", "M"},
+           {"pid", pid},
+           {"tid", streamId},
+           {"args", {{"name", "stream " + std::to_string(streamId)}}}});
+  }
+  json output = {{"traceEvents", traceEvents}, {"displayTimeUnit", "ns"}};
+  if (!tags.empty())
+    output["otherData"] = tags;
+  os << output.dump() << std::endl;
 }
 
 void TraceData::doDump(std::ostream &os, OutputFormat outputFormat) const {
-  throw NotImplemented();
+  if (outputFormat == OutputFormat::ChromeTrace) {
+    dumpChromeTrace(os);
+  } else {
+    throw std::runtime_error("TraceData only supports the chrome_trace format");
+  }
 }
 
 } // namespace proton
@@ -4,6 +4,7 @@
 #include "Driver/Device.h"
 #include "nlohmann/json.hpp"
 
+#include <cstring>
 #include <limits>
 #include <map>
 #include <mutex>
@@ -14,6 +15,61 @@ using json = nlohmann::json;
 
 namespace proton {
 
+namespace {
+
+enum class BinaryRecord : char {
+  Node = 1,
+  Name = 2,
+  Metrics = 3,
+  Device = 4,
+  End = 5,
+};
+
+enum class BinaryValue : char { Uint64, Int64, Double, String };
+
+constexpr char BinaryMagic[] = "PROTONB1";
+
+void writeVarint(std::ostream &os, uint64_t value) {
+  while (value >= 0x80) {
+    os.put(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  os.put(static_cast<char>(value));
+}
+
+void writeString(std::ostream &os, const std::string &value) {
+  writeVarint(os, value.size());
+  os.write(value.data(), value.size());
+}
+
+void writeValue(std::ostream &os, const MetricValueType &value) {
+  std::visit(
+      [&](auto &&v) {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<T, uint64_t>) {
+          os.put(static_cast<char>(BinaryValue::Uint64));
+          writeVarint(os, v);
+        } else if constexpr (std::is_same_v<T, int64_t>) {
+          // Zigzag encoding, so that small negative values stay short
+          os.put(static_cast<char>(BinaryValue::Int64));
+          writeVarint(os, (static_cast<uint64_t>(v) << 1) ^
+                              static_cast<uint64_t>(v >> 63));
+        } else if constexpr (std::is_same_v<T, double>) {
+          // Little endian, as on all the supported hosts
+          os.put(static_cast<char>(BinaryValue::Double));
+          char bytes[sizeof(double)];
+          std::memcpy(bytes, &v, sizeof(double));
+          os.write(bytes, sizeof(double));
+        } else {
+          os.put(static_cast<char>(BinaryValue::String));
+          writeString(os, v);
+        }
+      },
+      value);
+}
+
+} // namespace
+
 class TreeData::Tree {
 public:
   struct TreeNode : public Context {
@@ -27,47 +83,90 @@ public:
         : id(id), parentId(parentId), Context(name) {}
     virtual ~TreeNode() = default;
 
-    void addChild(const Context &context, size_t id) { children[context] = id; }
+    void addChild(const Context &context, size_t id) {
+      children[context.name] = id;
+    }
 
     bool hasChild(const Context &context) const {
-      return children.find(context) != children.end();
+      return children.find(context.name) != children.end();
     }
 
     size_t getChild(const Context &context) const {
-      return children.at(context);
+      return children.at(context.name);
     }
 
     size_t parentId = DummyId;
     size_t id = DummyId;
-    std::map<Context, size_t> children = {};
+    // context name -> child id
+    std::unordered_map<std::string, size_t> children = {};
+    // context name id -> child id, for the contexts with interned names
+    std::unordered_map<size_t, size_t> nameIdChildren = {};
     std::map<MetricKind, std::shared_ptr<Metric>> metrics = {};
     std::map<std::string, FlexibleMetric> flexibleMetrics = {};
     friend class Tree;
   };
 
-  Tree() {
-    treeNodeMap.try_emplace(TreeNode::RootId, TreeNode::RootId, "ROOT");
-  }
+  Tree() { treeNodes.emplace_back(TreeNode::RootId, "ROOT"); }
 
   size_t addNode(const Context &context, size_t parentId) {
-    if (treeNodeMap[parentId].hasChild(context)) {
-      return treeNodeMap[parentId].getChild(context);
+    bool interned = context.nameId != Context::NoNameId;
+    if (interned) {
+      auto &nameIdChildren = treeNodes[parentId].nameIdChildren;
+      auto childIt = nameIdChildren.find(context.nameId);
+      if (childIt != nameIdChildren.end())
+        return childIt->second;
     }
-    auto id = nextContextId++;
-    treeNodeMap.try_emplace(id, id, parentId, context.name);
-    treeNodeMap[parentId].addChild(context, id);
+    size_t id;
+    auto childIt = treeNodes[parentId].children.find(context.name);
+    if (childIt != treeNodes[parentId].children.end()) {
+      id = childIt->second;
+    } else {
+      id = treeNodes.size();
+      treeNodes.emplace_back(id, parentId, context.name);
+      treeNodes[parentId].addChild(context, id);
+    }
+    if (interned)
+      treeNodes[parentId].nameIdChildren[context.nameId] = id;
     return id;
   }
 
   size_t addNode(const std::vector<Context> &indices) {
     auto parentId = TreeNode::RootId;
-    for (auto index : indices) {
+    for (auto &index : indices) {
       parentId = addNode(index, parentId);
     }
     return parentId;
   }
 
-  TreeNode &getNode(size_t id) { return treeNodeMap.at(id); }
+  TreeNode &getNode(size_t id) { return treeNodes[id]; }
+
+  /// Adds the nodes and metrics of `other` to this tree.
+  void merge(Tree &other) {
+    // other's node id -> node id
+    std::vector<size_t> nodeIds(other.treeNodes.size(), TreeNode::RootId);
+    other.walk<WalkPolicy::PreOrder>([&](TreeNode &otherNode) {
+      auto nodeId = TreeNode::RootId;
+      if (otherNode.id != TreeNode::RootId) {
+        nodeId = addNode(otherNode, nodeIds[otherNode.parentId]);
+        nodeIds[otherNode.id] = nodeId;
+      }
+      auto &node = getNode(nodeId);
+      for (auto &[metricKind, metric] : otherNode.metrics) {
+        auto metricIt = node.metrics.find(metricKind);
+        if (metricIt == node.metrics.end())
+          node.metrics.emplace(metricKind, cloneMetric(*metric));
+        else
+          metricIt->second->updateMetric(*metric);
+      }
+      for (auto &[metricName, flexibleMetric] : otherNode.flexibleMetrics) {
+        auto metricIt = node.flexibleMetrics.find(metricName);
+        if (metricIt == node.flexibleMetrics.end())
+          node.flexibleMetrics.emplace(metricName, flexibleMetric);
+        else
+          metricIt->second.updateMetric(flexibleMetric);
+      }
+    });
+  }
 
   enum class WalkPolicy { PreOrder, PostOrder };
 
@@ -94,53 +193,123 @@ public:
   }
 
 private:
-  size_t nextContextId = TreeNode::RootId + 1;
-  // tree node id->tree node
-  std::map<size_t, TreeNode> treeNodeMap;
+  static std::shared_ptr<Metric> cloneMetric(const Metric &metric) {
+    if (metric.getKind() == MetricKind::Kernel)
+      return std::make_shared<KernelMetric>(
+          static_cast<const KernelMetric &>(metric));
+    if (metric.getKind() == MetricKind::Counter)
+      return std::make_shared<CounterMetric>(
+          static_cast<const CounterMetric &>(metric));
+    if (metric.getKind() == MetricKind::Memory)
+      return std::make_shared<MemoryMetric>(
+          static_cast<const MemoryMetric &>(metric));
+    throw std::runtime_error("MetricKind not supported");
+  }
+
+  // tree node id -> tree node, ids are allocated contiguously
+  std::vector<TreeNode> treeNodes;
+};
+
+/// The tree of a thread.  Its mutex is only contended when the profiler's
+/// threads add the metrics of the kernels launched by the thread.
+struct TreeData::ThreadTree {
+  std::mutex mutex;
+  Tree tree;
 };
 
-void TreeData::init() { tree = std::make_unique<Tree>(); }
+TreeData::ThreadTree &TreeData::getThreadTree() {
+  // TreeData id -> tree of this thread.  Keyed by id rather than address so
+  // that a new TreeData never picks up the tree of a destroyed one.
+  static thread_local std::unordered_map<size_t, std::weak_ptr<ThreadTree>>
+      threadLocalTrees;
+  auto it = threadLocalTrees.find(id);
+  if (it != threadLocalTrees.end()) {
+    if (auto threadTree = it->second.lock())
+      return *threadTree;
+  }
+  for (auto iter = threadLocalTrees.begin(); iter != threadLocalTrees.end();) {
+    if (iter->second.expired())
+      iter = threadLocalTrees.erase(iter);
+    else
+      ++iter;
+  }
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  auto threadTree = std::make_shared<ThreadTree>();
+  threadTrees.push_back(threadTree);
+  threadLocalTrees[id] = threadTree;
+  return *threadTree;
+}
+
+bool TreeData::findScope(size_t scopeId, ScopeContext &scopeContext) {
+  auto &scopeMap = getScopeMap(scopeId);
+  std::lock_guard<std::mutex> lock(scopeMap.mutex);
+  auto it = scopeMap.scopeIdToContext.find(scopeId);
+  if (it == scopeMap.scopeIdToContext.end())
+    return false;
+  scopeContext = it->second;
+  return true;
+}
+
+void TreeData::setScope(size_t scopeId, const ScopeContext &scopeContext) {
+  auto &scopeMap = getScopeMap(scopeId);
+  std::lock_guard<std::mutex> lock(scopeMap.mutex);
+  scopeMap.scopeIdToContext[scopeId] = scopeContext;
+}
+
+std::vector<Context> TreeData::getContexts() const {
+  if (contextSource == nullptr)
+    return {};
+  return contextSource->getContexts();
+}
 
 void TreeData::startOp(const Scope &scope) {
   // enterOp and addMetric maybe called from different threads
-  std::unique_lock<std::shared_mutex> lock(mutex);
-  std::vector<Context> contexts;
-  if (contextSource != nullptr)
-    contexts = contextSource->getContexts();
+  auto contexts = getContexts();
   contexts.push_back(Context(scope.name));
-  auto contextId = tree->addNode(contexts);
-  scopeIdToContextId[scope.scopeId] = contextId;
+  auto &threadTree = getThreadTree();
+  size_t contextId;
+  {
+    std::lock_guard<std::mutex> lock(threadTree.mutex);
+    contextId = threadTree.tree.addNode(contexts);
+  }
+  setScope(scope.scopeId, {&threadTree, contextId});
 }
 
 void TreeData::stopOp(const Scope &scope) {}
 
 size_t TreeData::addScope(size_t parentScopeId, const std::string &name) {
-  std::unique_lock<std::shared_mutex> lock(mutex);
-  auto scopeIdIt = scopeIdToContextId.find(parentScopeId);
-  auto scopeId = parentScopeId;
-  if (scopeIdIt == scopeIdToContextId.end()) {
-    std::vector<Context> contexts;
-    if (contextSource != nullptr)
-      contexts = contextSource->getContexts();
+  ScopeContext parent;
+  if (!findScope(parentScopeId, parent)) {
     // Record the parent context
-    scopeIdToContextId[parentScopeId] = tree->addNode(contexts);
-  } else {
-    // Add a new context under it and update the context
-    scopeId = Scope::getNewScopeId();
-    scopeIdToContextId[scopeId] =
-        tree->addNode(Context(name), scopeIdIt->second);
+    auto contexts = getContexts();
+    auto &threadTree = getThreadTree();
+    size_t contextId;
+    {
+      std::lock_guard<std::mutex> lock(threadTree.mutex);
+      contextId = threadTree.tree.addNode(contexts);
+    }
+    setScope(parentScopeId, {&threadTree, contextId});
+    return parentScopeId;
+  }
+  // Add a new context under it and update the context
+  auto scopeId = Scope::getNewScopeId();
+  size_t contextId;
+  {
+    std::lock_guard<std::mutex> lock(parent.threadTree->mutex);
+    contextId =
+        parent.threadTree->tree.addNode(Context(name), parent.contextId);
   }
+  setScope(scopeId, {parent.threadTree, contextId});
   return scopeId;
 }
 
 void TreeData::addMetric(size_t scopeId, std::shared_ptr<Metric> metric) {
-  std::unique_lock<std::shared_mutex> lock(mutex);
-  auto scopeIdIt = scopeIdToContextId.find(scopeId);
+  ScopeContext scopeContext;
   // The profile data is deactived, ignore the metric
-  if (scopeIdIt == scopeIdToContextId.end())
+  if (!findScope(scopeId, scopeContext))
     return;
-  auto contextId = scopeIdIt->second;
-  auto &node = tree->getNode(contextId);
+  std::lock_guard<std::mutex> lock(scopeContext.threadTree->mutex);
+  auto &node = scopeContext.threadTree->tree.getNode(scopeContext.contextId);
   if (node.metrics.find(metric->getKind()) == node.metrics.end())
     node.metrics.emplace(metric->getKind(), metric);
   else
@@ -150,19 +319,18 @@ void TreeData::addMetric(size_t scopeId, std::shared_ptr<Metric> metric) {
 void TreeData::addMetrics(size_t scopeId,
                           const std::map<std::string, MetricValueType> &metrics,
                           bool aggregable) {
-  std::unique_lock<std::shared_mutex> lock(mutex);
-  auto scopeIdIt = scopeIdToContextId.find(scopeId);
-  auto contextId = Tree::TreeNode::DummyId;
-  if (scopeIdIt == scopeIdToContextId.end()) {
+  ScopeContext scopeContext;
+  if (!findScope(scopeId, scopeContext)) {
     if (contextSource == nullptr)
       throw std::runtime_error("ContextSource is not set");
     // Attribute the metric to the last context
     std::vector<Context> contexts = contextSource->getContexts();
-    contextId = tree->addNode(contexts);
-  } else {
-    contextId = scopeIdIt->second;
+    auto &threadTree = getThreadTree();
+    std::lock_guard<std::mutex> lock(threadTree.mutex);
+    scopeContext = {&threadTree, threadTree.tree.addNode(contexts)};
   }
-  auto &node = tree->getNode(contextId);
+  std::lock_guard<std::mutex> lock(scopeContext.threadTree->mutex);
+  auto &node = scopeContext.threadTree->tree.getNode(scopeContext.contextId);
   for (auto [metricName, metricValue] : metrics) {
     if (node.flexibleMetrics.find(metricName) == node.flexibleMetrics.end())
       node.flexibleMetrics.emplace(
@@ -173,6 +341,24 @@ void TreeData::addMetrics(size_t scopeId,
   }
 }
 
+struct TreeData::BinaryState {
+  // (parent id, name) -> id of the nodes written
+  std::map<std::pair<size_t, std::string>, size_t> nodeIds;
+  // metric name -> id
+  std::unordered_map<std::string, size_t> nameIds;
+  // node id -> name id -> value written
+  std::unordered_map<size_t, std::map<size_t, MetricValueType>> values;
+  // (device type, device id) of the devices written
+  std::set<std::pair<uint64_t, uint64_t>> devices;
+};
+
+void TreeData::mergeThreadTrees(Tree &tree) const {
+  for (auto &threadTree : threadTrees) {
+    std::lock_guard<std::mutex> lock(threadTree->mutex);
+    tree.merge(threadTree->tree);
+  }
+}
+
 void TreeData::dumpHatchet(std::ostream &os) const {
   std::map<size_t, json *> jsonNodes;
   json output = json::array();
@@ -180,7 +366,9 @@ void TreeData::dumpHatchet(std::ostream &os) const {
   jsonNodes[Tree::TreeNode::RootId] = &(output.back());
   std::set<std::string> valueNames;
   std::map<uint64_t, std::set<uint64_t>> deviceIds;
-  this->tree->template walk<Tree::WalkPolicy::PreOrder>(
+  Tree tree;
+  mergeThreadTrees(tree);
+  tree.template walk<Tree::WalkPolicy::PreOrder>(
       [&](Tree::TreeNode &treeNode) {
         const auto contextName = treeNode.name;
         auto contextId = treeNode.id;
@@ -217,6 +405,18 @@ void TreeData::dumpHatchet(std::ostream &os) const {
             valueNames.insert(
                 kernelMetric->getValueName(KernelMetric::Invocations));
             deviceIds.insert({deviceType, {deviceId}});
+          } else if (metricKind == MetricKind::Counter ||
+                     metricKind == MetricKind::Memory) {
+            auto values = metric->getValues();
+            for (int i = 0; i < values.size(); ++i) {
+              auto valueName = metric->getValueName(i);
+              std::visit(
+                  [&](auto &&value) {
+                    (*jsonNode)["metrics"][valueName] = value;
+                  },
+                  values[i]);
+              valueNames.insert(valueName);
+            }
           } else {
             throw std::runtime_error("MetricKind not supported");
           }
@@ -265,22 +465,131 @@ void TreeData::dumpHatchet(std::ostream &os) const {
           {"num_sms", device.numSms}};
     }
   }
+  // The tags of the process follow the devices, when there are any
+  if (!tags.empty())
+    output.push_back(tags);
   os << std::endl << output.dump(4) << std::endl;
 }
 
+void TreeData::dumpBinary(std::ostream &os) const {
+  if (!binaryState) {
+    os.write(BinaryMagic, sizeof(BinaryMagic) - 1);
+    binaryState = std::make_unique<BinaryState>();
+  }
+  auto &state = *binaryState;
+  auto getNameId = [&](const std::string &name) {
+    auto it = state.nameIds.find(name);
+    if (it != state.nameIds.end())
+      return it->second;
+    auto nameId = state.nameIds.size();
+    state.nameIds[name] = nameId;
+    os.put(static_cast<char>(BinaryRecord::Name));
+    writeVarint(os, nameId);
+    writeString(os, name);
+    return nameId;
+  };
+  auto writeDevice = [&](uint64_t deviceType, uint64_t deviceId) {
+    if (!state.devices.insert({deviceType, deviceId}).second)
+      return;
+    Device device = getDevice(static_cast<DeviceType>(deviceType), deviceId);
+    os.put(static_cast<char>(BinaryRecord::Device));
+    writeString(os, getDeviceTypeString(static_cast<DeviceType>(deviceType)));
+    for (auto value : {deviceId, device.clockRate, device.memoryClockRate,
+                       device.busWidth, device.numSms})
+      writeVarint(os, value);
+    writeString(os, device.arch);
+  };
+
+  Tree tree;
+  mergeThreadTrees(tree);
+  // id in the merged tree -> id in the output
+  std::unordered_map<size_t, size_t> nodeIds;
+  tree.template walk<Tree::WalkPolicy::PreOrder>(
+      [&](Tree::TreeNode &treeNode) {
+        size_t nodeId = Tree::TreeNode::RootId;
+        if (treeNode.id != Tree::TreeNode::RootId) {
+          auto key = std::make_pair(nodeIds[treeNode.parentId], treeNode.name);
+          auto it = state.nodeIds.find(key);
+          if (it == state.nodeIds.end()) {
+            nodeId = state.nodeIds.size() + 1;
+            state.nodeIds[key] = nodeId;
+            os.put(static_cast<char>(BinaryRecord::Node));
+            writeVarint(os, nodeId);
+            writeVarint(os, key.first);
+            writeString(os, treeNode.name);
+          } else {
+            nodeId = it->second;
+          }
+        }
+        nodeIds[treeNode.id] = nodeId;
+
+        // The same values as in the hatchet output
+        std::vector<std::pair<std::string, MetricValueType>> values;
+        for (auto [metricKind, metric] : treeNode.metrics) {
+          if (metricKind == MetricKind::Kernel) {
+            auto deviceId = std::get<uint64_t>(
+                metric->getValue(KernelMetric::DeviceId));
+            auto deviceType = std::get<uint64_t>(
+                metric->getValue(KernelMetric::DeviceType));
+            for (auto valueId :
+                 {KernelMetric::Duration, KernelMetric::Invocations})
+              values.emplace_back(metric->getValueName(valueId),
+                                  metric->getValue(valueId));
+            values.emplace_back(metric->getValueName(KernelMetric::DeviceId),
+                                std::to_string(deviceId));
+            values.emplace_back(
+                metric->getValueName(KernelMetric::DeviceType),
+                getDeviceTypeString(static_cast<DeviceType>(deviceType)));
+            writeDevice(deviceType, deviceId);
+          } else if (metricKind == MetricKind::Counter ||
+                     metricKind == MetricKind::Memory) {
+            auto metricValues = metric->getValues();
+            for (int i = 0; i < metricValues.size(); ++i)
+              values.emplace_back(metric->getValueName(i), metricValues[i]);
+          } else {
+            throw std::runtime_error("MetricKind not supported");
+          }
+        }
+        for (auto [_, flexibleMetric] : treeNode.flexibleMetrics)
+          values.emplace_back(flexibleMetric.getValueName(0),
+                              flexibleMetric.getValues()[0]);
+
+        // Only the values that changed since the previous dump
+        auto &writtenValues = state.values[nodeId];
+        std::vector<std::pair<size_t, MetricValueType>> changedValues;
+        for (auto &[name, value] : values) {
+          auto nameId = getNameId(name);
+          auto it = writtenValues.find(nameId);
+          if (it != writtenValues.end() && it->second == value)
+            continue;
+          writtenValues[nameId] = value;
+          changedValues.emplace_back(nameId, value);
+        }
+        if (changedValues.empty())
+          return;
+        os.put(static_cast<char>(BinaryRecord::Metrics));
+        writeVarint(os, nodeId);
+        writeVarint(os, changedValues.size());
+        for (auto &[nameId, value] : changedValues) {
+          writeVarint(os, nameId);
+          writeValue(os, value);
+        }
+      });
+  os.put(static_cast<char>(BinaryRecord::End));
+}
+
 void TreeData::doDump(std::ostream &os, OutputFormat outputFormat) const {
-  std::shared_lock<std::shared_mutex> lock(mutex);
   if (outputFormat == OutputFormat::Hatchet) {
     dumpHatchet(os);
+  } else if (outputFormat == OutputFormat::Binary) {
+    dumpBinary(os);
   } else {
     std::logic_error("OutputFormat not supported");
   }
 }
 
 TreeData::TreeData(const std::string &path, ContextSource *contextSource)
-    : Data(path, contextSource) {
-  init();
-}
+    : Data(path, contextSource), id(nextId++) {}
 
 TreeData::~TreeData() {}
 
@@ -4,12 +4,23 @@
 #include "Driver/Device.h"
 #include "Driver/GPU/CudaApi.h"
 #include "Driver/GPU/CuptiApi.h"
+#include "Driver/GPU/NvperfApi.h"
 #include "Utility/Map.h"
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdlib>
+#include <deque>
+#include <functional>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <sstream>
 #include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace proton {
 
@@ -23,7 +34,8 @@ thread_local std::deque<size_t>
 
 namespace {
 
-std::shared_ptr<Metric> convertActivityToMetric(CUpti_Activity *activity) {
+std::shared_ptr<Metric> convertActivityToMetric(CUpti_Activity *activity,
+                                                uint64_t samplingInterval) {
   std::shared_ptr<Metric> metric;
   switch (activity->kind) {
   case CUPTI_ACTIVITY_KIND_KERNEL:
@@ -34,7 +46,9 @@ std::shared_ptr<Metric> convertActivityToMetric(CUpti_Activity *activity) {
           static_cast<uint64_t>(kernel->start),
           static_cast<uint64_t>(kernel->end), 1,
           static_cast<uint64_t>(kernel->deviceId),
-          static_cast<uint64_t>(DeviceType::CUDA));
+          static_cast<uint64_t>(DeviceType::CUDA),
+          static_cast<uint64_t>(kernel->streamId));
+      std::static_pointer_cast<KernelMetric>(metric)->scale(samplingInterval);
     } // else: not a valid kernel activity
     break;
   }
@@ -47,7 +61,8 @@ std::shared_ptr<Metric> convertActivityToMetric(CUpti_Activity *activity) {
 uint32_t
 processActivityKernel(CuptiProfiler::CorrIdToExternIdMap &corrIdToExternId,
                       CuptiProfiler::ApiExternIdSet &apiExternIds,
-                      std::set<Data *> &dataSet, CUpti_Activity *activity) {
+                      std::set<Data *> &dataSet, CUpti_Activity *activity,
+                      uint64_t samplingInterval) {
   // Support CUDA >= 11.0
   auto *kernel = reinterpret_cast<CUpti_ActivityKernel5 *>(activity);
   auto correlationId = kernel->correlationId;
@@ -62,7 +77,8 @@ processActivityKernel(CuptiProfiler::CorrIdToExternIdMap &corrIdToExternId,
         // It's triggered by a CUDA op but not triton op
         scopeId = data->addScope(parentId, kernel->name);
       }
-      data->addMetric(scopeId, convertActivityToMetric(activity));
+      data->addMetric(scopeId,
+                      convertActivityToMetric(activity, samplingInterval));
     }
   } else {
     // Graph kernels
@@ -75,7 +91,8 @@ processActivityKernel(CuptiProfiler::CorrIdToExternIdMap &corrIdToExternId,
     // 3. corrId -> numKernels
     for (auto *data : dataSet) {
       auto externId = data->addScope(parentId, kernel->name);
-      data->addMetric(externId, convertActivityToMetric(activity));
+      data->addMetric(externId,
+                      convertActivityToMetric(activity, samplingInterval));
     }
   }
   apiExternIds.erase(parentId);
@@ -90,13 +107,14 @@ processActivityKernel(CuptiProfiler::CorrIdToExternIdMap &corrIdToExternId,
 
 uint32_t processActivity(CuptiProfiler::CorrIdToExternIdMap &corrIdToExternId,
                          CuptiProfiler::ApiExternIdSet &apiExternIds,
-                         std::set<Data *> &dataSet, CUpti_Activity *activity) {
+                         std::set<Data *> &dataSet, CUpti_Activity *activity,
+                         uint64_t samplingInterval) {
   auto correlationId = 0;
   switch (activity->kind) {
   case CUPTI_ACTIVITY_KIND_KERNEL:
   case CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL: {
     correlationId = processActivityKernel(corrIdToExternId, apiExternIds,
-                                          dataSet, activity);
+                                          dataSet, activity, samplingInterval);
     break;
   }
   default:
@@ -105,6 +123,13 @@ uint32_t processActivity(CuptiProfiler::CorrIdToExternIdMap &corrIdToExternId,
   return correlationId;
 }
 
+bool isGraphLaunch(CUpti_CallbackId cbId) {
+  return cbId == CUPTI_DRIVER_TRACE_CBID_cuGraphLaunch ||
+         cbId == CUPTI_DRIVER_TRACE_CBID_cuGraphLaunch_ptsz ||
+         cbId == CUPTI_RUNTIME_TRACE_CBID_cudaGraphLaunch_v10000 ||
+         cbId == CUPTI_RUNTIME_TRACE_CBID_cudaGraphLaunch_ptsz_v10000;
+}
+
 void setRuntimeCallbacks(CUpti_SubscriberHandle subscriber, bool enable) {
 #define CALLBACK_ENABLE(id)                                                    \
   cupti::enableCallback<true>(static_cast<uint32_t>(enable), subscriber,       \
@@ -162,6 +187,1020 @@ void setGraphCallbacks(CUpti_SubscriberHandle subscriber, bool enable) {
 #undef CALLBACK_ENABLE
 }
 
+void setMemoryCallbacks(CUpti_SubscriberHandle subscriber, bool enable) {
+#define CALLBACK_ENABLE(id)                                                    \
+  cupti::enableCallback<true>(static_cast<uint32_t>(enable), subscriber,       \
+                              CUPTI_CB_DOMAIN_DRIVER_API, id)
+
+  CALLBACK_ENABLE(CUPTI_DRIVER_TRACE_CBID_cuMemAlloc_v2);
+  CALLBACK_ENABLE(CUPTI_DRIVER_TRACE_CBID_cuMemAllocManaged);
+  CALLBACK_ENABLE(CUPTI_DRIVER_TRACE_CBID_cuMemAllocAsync);
+  CALLBACK_ENABLE(CUPTI_DRIVER_TRACE_CBID_cuMemAllocAsync_ptsz);
+  CALLBACK_ENABLE(CUPTI_DRIVER_TRACE_CBID_cuMemAllocFromPoolAsync);
+  CALLBACK_ENABLE(CUPTI_DRIVER_TRACE_CBID_cuMemAllocFromPoolAsync_ptsz);
+  CALLBACK_ENABLE(CUPTI_DRIVER_TRACE_CBID_cuMemFree_v2);
+  CALLBACK_ENABLE(CUPTI_DRIVER_TRACE_CBID_cuMemFreeAsync);
+  CALLBACK_ENABLE(CUPTI_DRIVER_TRACE_CBID_cuMemFreeAsync_ptsz);
+#undef CALLBACK_ENABLE
+}
+
+bool isMemoryApi(CUpti_CallbackDomain domain, CUpti_CallbackId cbId) {
+  if (domain != CUPTI_CB_DOMAIN_DRIVER_API)
+    return false;
+  switch (cbId) {
+  case CUPTI_DRIVER_TRACE_CBID_cuMemAlloc_v2:
+  case CUPTI_DRIVER_TRACE_CBID_cuMemAllocManaged:
+  case CUPTI_DRIVER_TRACE_CBID_cuMemAllocAsync:
+  case CUPTI_DRIVER_TRACE_CBID_cuMemAllocAsync_ptsz:
+  case CUPTI_DRIVER_TRACE_CBID_cuMemAllocFromPoolAsync:
+  case CUPTI_DRIVER_TRACE_CBID_cuMemAllocFromPoolAsync_ptsz:
+  case CUPTI_DRIVER_TRACE_CBID_cuMemFree_v2:
+  case CUPTI_DRIVER_TRACE_CBID_cuMemFreeAsync:
+  case CUPTI_DRIVER_TRACE_CBID_cuMemFreeAsync_ptsz:
+    return true;
+  default:
+    return false;
+  }
+}
+
+void setModuleCallbacks(CUpti_SubscriberHandle subscriber, bool enable) {
+  cupti::enableCallback<true>(static_cast<uint32_t>(enable), subscriber,
+                              CUPTI_CB_DOMAIN_RESOURCE,
+                              CUPTI_CBID_RESOURCE_MODULE_LOADED);
+}
+
+// Metrics collected by the range profiler, in the order of CounterMetric's
+// values.
+const char *const CounterMetricNames[CounterMetric::Count] = {
+    "dram__bytes.sum",
+    "lts__t_sectors_lookup_hit.sum",
+    "lts__t_sectors_lookup_miss.sum",
+    "sm__cycles_active.sum",
+    "sm__warps_active.avg.pct_of_peak_sustained_active",
+    "sm__pipe_tensor_cycles_active.sum",
+    "l1tex__data_bank_conflicts_pipe_lsu_mem_shared.sum",
+};
+
+/// Collects the hardware counters of kernels with CUPTI's range profiler.
+///
+/// Each kernel launched on the profiled context is replayed once per pass
+/// needed by the counters, in a range of its own, so kernels are serialized
+/// and their measured times are inflated while counters are collected.  Ranges
+/// are recorded in launch order, so the n-th range is attributed to the n-th
+/// launch.  Only the context current at the first launch is profiled.
+class CounterProfiler {
+public:
+  CounterProfiler() = default;
+  ~CounterProfiler() = default;
+
+  /// Called on the launching thread before a kernel is launched.
+  /// `scopeId` is the scope the kernel is attributed to; `isAPI` tells whether
+  /// the kernel is launched by a runtime API, so that a scope named after the
+  /// kernel is added under it.
+  void enterLaunch(size_t scopeId, bool isAPI, bool isGraph) {
+    std::lock_guard<std::mutex> lock(mutex);
+    CUcontext currentContext = nullptr;
+    cuda::ctxGetCurrent<false>(&currentContext);
+    if (currentContext == nullptr)
+      return;
+    if (context == nullptr) {
+      context = currentContext;
+      init();
+      beginSession();
+    }
+    if (currentContext != context || !sessionActive)
+      return;
+    if (isGraph) {
+      // Kernels of graphs cannot be attributed to launches
+      setProfiling(false);
+      return;
+    }
+    launches.push_back({scopeId, isAPI});
+  }
+
+  /// Called on the launching thread after a kernel is launched.
+  void exitLaunch(bool isGraph, const std::set<Data *> &dataSet) {
+    std::lock_guard<std::mutex> lock(mutex);
+    CUcontext currentContext = nullptr;
+    cuda::ctxGetCurrent<false>(&currentContext);
+    if (currentContext != context || !sessionActive)
+      return;
+    if (isGraph) {
+      setProfiling(true);
+    } else if (launches.size() >= MaxRanges) {
+      endSession();
+      decode(dataSet);
+      beginSession();
+    }
+  }
+
+  /// Adds the counters of the kernels launched so far to `dataSet`.
+  void flush(const std::set<Data *> &dataSet, bool stop) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!sessionActive)
+      return;
+    endSession();
+    decode(dataSet);
+    if (stop) {
+      NVPW_MetricsEvaluator_Destroy_Params destroyParams = {
+          NVPW_MetricsEvaluator_Destroy_Params_STRUCT_SIZE};
+      destroyParams.pMetricsEvaluator = evaluator;
+      nvperf::metricsEvaluatorDestroy<true>(&destroyParams);
+      CUpti_Profiler_DeInitialize_Params deinitializeParams = {
+          CUpti_Profiler_DeInitialize_Params_STRUCT_SIZE};
+      cupti::profilerDeInitialize<true>(&deinitializeParams);
+      context = nullptr;
+    } else {
+      beginSession();
+    }
+  }
+
+private:
+  struct Launch {
+    size_t scopeId;
+    bool isAPI;
+  };
+
+  // Maximum number of kernels profiled before their counters are decoded
+  static constexpr size_t MaxRanges = 64;
+  static constexpr size_t MaxRangeNameLength = 512;
+
+  void init() {
+    CUdevice device = 0;
+    cuda::ctxGetDevice<true>(&device);
+    CUpti_Profiler_Initialize_Params initializeParams = {
+        CUpti_Profiler_Initialize_Params_STRUCT_SIZE};
+    cupti::profilerInitialize<true>(&initializeParams);
+    NVPW_InitializeHost_Params initializeHostParams = {
+        NVPW_InitializeHost_Params_STRUCT_SIZE};
+    nvperf::initializeHost<true>(&initializeHostParams);
+
+    CUpti_Device_GetChipName_Params chipNameParams = {
+        CUpti_Device_GetChipName_Params_STRUCT_SIZE};
+    chipNameParams.deviceIndex = static_cast<size_t>(device);
+    cupti::deviceGetChipName<true>(&chipNameParams);
+    chipName = chipNameParams.pChipName;
+
+    CUpti_Profiler_GetCounterAvailability_Params availabilityParams = {
+        CUpti_Profiler_GetCounterAvailability_Params_STRUCT_SIZE};
+    availabilityParams.ctx = context;
+    cupti::profilerGetCounterAvailability<true>(&availabilityParams);
+    counterAvailabilityImage.resize(
+        availabilityParams.counterAvailabilityImageSize);
+    availabilityParams.pCounterAvailabilityImage =
+        counterAvailabilityImage.data();
+    cupti::profilerGetCounterAvailability<true>(&availabilityParams);
+
+    initEvaluator();
+    auto rawMetricRequests = getRawMetricRequests();
+    initConfigImage(rawMetricRequests);
+    initCounterDataPrefix(rawMetricRequests);
+  }
+
+  void initEvaluator() {
+    NVPW_CUDA_MetricsEvaluator_CalculateScratchBufferSize_Params scratchParams =
+        {NVPW_CUDA_MetricsEvaluator_CalculateScratchBufferSize_Params_STRUCT_SIZE};
+    scratchParams.pChipName = chipName.c_str();
+    scratchParams.pCounterAvailabilityImage = counterAvailabilityImage.data();
+    nvperf::metricsEvaluatorCalculateScratchBufferSize<true>(&scratchParams);
+    evaluatorScratchBuffer.resize(scratchParams.scratchBufferSize);
+
+    NVPW_CUDA_MetricsEvaluator_Initialize_Params evaluatorParams = {
+        NVPW_CUDA_MetricsEvaluator_Initialize_Params_STRUCT_SIZE};
+    evaluatorParams.pScratchBuffer = evaluatorScratchBuffer.data();
+    evaluatorParams.scratchBufferSize = evaluatorScratchBuffer.size();
+    evaluatorParams.pChipName = chipName.c_str();
+    evaluatorParams.pCounterAvailabilityImage = counterAvailabilityImage.data();
+    nvperf::metricsEvaluatorInitialize<true>(&evaluatorParams);
+    evaluator = evaluatorParams.pMetricsEvaluator;
+
+    for (int i = 0; i < CounterMetric::Count; ++i) {
+      NVPW_MetricEvalRequest request;
+      NVPW_MetricsEvaluator_ConvertMetricNameToMetricEvalRequest_Params
+          convertParams = {
+              NVPW_MetricsEvaluator_ConvertMetricNameToMetricEvalRequest_Params_STRUCT_SIZE};
+      convertParams.pMetricsEvaluator = evaluator;
+      convertParams.pMetricName = CounterMetricNames[i];
+      convertParams.pMetricEvalRequest = &request;
+      convertParams.metricEvalRequestStructSize =
+          NVPW_MetricEvalRequest_STRUCT_SIZE;
+      if (nvperf::metricsEvaluatorConvertMetricNameToMetricEvalRequest<false>(
+              &convertParams) != NVPA_STATUS_SUCCESS) {
+        std::cerr << "[PROTON] Hardware counter " << CounterMetricNames[i]
+                  << " is not available on " << chipName << std::endl;
+        continue;
+      }
+      counterIds.push_back(i);
+      evalRequests.push_back(request);
+    }
+  }
+
+  std::vector<NVPA_RawMetricRequest> getRawMetricRequests() {
+    NVPW_MetricsEvaluator_GetMetricRawDependencies_Params dependencyParams = {
+        NVPW_MetricsEvaluator_GetMetricRawDependencies_Params_STRUCT_SIZE};
+    dependencyParams.pMetricsEvaluator = evaluator;
+    dependencyParams.pMetricEvalRequests = evalRequests.data();
+    dependencyParams.numMetricEvalRequests = evalRequests.size();
+    dependencyParams.metricEvalRequestStructSize =
+        NVPW_MetricEvalRequest_STRUCT_SIZE;
+    dependencyParams.metricEvalRequestStrideSize =
+        sizeof(NVPW_MetricEvalRequest);
+    nvperf::metricsEvaluatorGetMetricRawDependencies<true>(&dependencyParams);
+    // The names are owned by the evaluator
+    std::vector<const char *> rawDependencies(
+        dependencyParams.numRawDependencies);
+    dependencyParams.ppRawDependencies = rawDependencies.data();
+    nvperf::metricsEvaluatorGetMetricRawDependencies<true>(&dependencyParams);
+
+    std::vector<NVPA_RawMetricRequest> rawMetricRequests;
+    for (auto *rawDependency : rawDependencies) {
+      NVPA_RawMetricRequest rawMetricRequest = {
+          NVPA_RAW_METRIC_REQUEST_STRUCT_SIZE};
+      rawMetricRequest.pMetricName = rawDependency;
+      rawMetricRequest.isolated = true;
+      rawMetricRequest.keepInstances = true;
+      rawMetricRequests.push_back(rawMetricRequest);
+    }
+    return rawMetricRequests;
+  }
+
+  void
+  initConfigImage(const std::vector<NVPA_RawMetricRequest> &rawMetricRequests) {
+    NVPW_CUDA_RawMetricsConfig_Create_V2_Params createParams = {
+        NVPW_CUDA_RawMetricsConfig_Create_V2_Params_STRUCT_SIZE};
+    createParams.activityKind = NVPA_ACTIVITY_KIND_PROFILER;
+    createParams.pChipName = chipName.c_str();
+    createParams.pCounterAvailabilityImage = counterAvailabilityImage.data();
+    nvperf::rawMetricsConfigCreate<true>(&createParams);
+    auto *rawMetricsConfig = createParams.pRawMetricsConfig;
+
+    NVPW_RawMetricsConfig_BeginPassGroup_Params beginParams = {
+        NVPW_RawMetricsConfig_BeginPassGroup_Params_STRUCT_SIZE};
+    beginParams.pRawMetricsConfig = rawMetricsConfig;
+    nvperf::rawMetricsConfigBeginPassGroup<true>(&beginParams);
+    NVPW_RawMetricsConfig_AddMetrics_Params addParams = {
+        NVPW_RawMetricsConfig_AddMetrics_Params_STRUCT_SIZE};
+    addParams.pRawMetricsConfig = rawMetricsConfig;
+    addParams.pRawMetricRequests = rawMetricRequests.data();
+    addParams.numMetricRequests = rawMetricRequests.size();
+    nvperf::rawMetricsConfigAddMetrics<true>(&addParams);
+    NVPW_RawMetricsConfig_EndPassGroup_Params endParams = {
+        NVPW_RawMetricsConfig_EndPassGroup_Params_STRUCT_SIZE};
+    endParams.pRawMetricsConfig = rawMetricsConfig;
+    nvperf::rawMetricsConfigEndPassGroup<true>(&endParams);
+
+    NVPW_RawMetricsConfig_GenerateConfigImage_Params generateParams = {
+        NVPW_RawMetricsConfig_GenerateConfigImage_Params_STRUCT_SIZE};
+    generateParams.pRawMetricsConfig = rawMetricsConfig;
+    nvperf::rawMetricsConfigGenerateConfigImage<true>(&generateParams);
+    NVPW_RawMetricsConfig_GetConfigImage_Params imageParams = {
+        NVPW_RawMetricsConfig_GetConfigImage_Params_STRUCT_SIZE};
+    imageParams.pRawMetricsConfig = rawMetricsConfig;
+    nvperf::rawMetricsConfigGetConfigImage<true>(&imageParams);
+    configImage.resize(imageParams.bytesCopied);
+    imageParams.bytesAllocated = configImage.size();
+    imageParams.pBuffer = configImage.data();
+    nvperf::rawMetricsConfigGetConfigImage<true>(&imageParams);
+
+    NVPW_RawMetricsConfig_Destroy_Params destroyParams = {
+        NVPW_RawMetricsConfig_Destroy_Params_STRUCT_SIZE};
+    destroyParams.pRawMetricsConfig = rawMetricsConfig;
+    nvperf::rawMetricsConfigDestroy<true>(&destroyParams);
+  }
+
+  void initCounterDataPrefix(
+      const std::vector<NVPA_RawMetricRequest> &rawMetricRequests) {
+    NVPW_CUDA_CounterDataBuilder_Create_Params createParams = {
+        NVPW_CUDA_CounterDataBuilder_Create_Params_STRUCT_SIZE};
+    createParams.pChipName = chipName.c_str();
+    createParams.pCounterAvailabilityImage = counterAvailabilityImage.data();
+    nvperf::counterDataBuilderCreate<true>(&createParams);
+    auto *counterDataBuilder = createParams.pCounterDataBuilder;
+
+    NVPW_CounterDataBuilder_AddMetrics_Params addParams = {
+        NVPW_CounterDataBuilder_AddMetrics_Params_STRUCT_SIZE};
+    addParams.pCounterDataBuilder = counterDataBuilder;
+    addParams.pRawMetricRequests = rawMetricRequests.data();
+    addParams.numMetricRequests = rawMetricRequests.size();
+    nvperf::counterDataBuilderAddMetrics<true>(&addParams);
+
+    NVPW_CounterDataBuilder_GetCounterDataPrefix_Params prefixParams = {
+        NVPW_CounterDataBuilder_GetCounterDataPrefix_Params_STRUCT_SIZE};
+    prefixParams.pCounterDataBuilder = counterDataBuilder;
+    nvperf::counterDataBuilderGetCounterDataPrefix<true>(&prefixParams);
+    counterDataPrefix.resize(prefixParams.bytesCopied);
+    prefixParams.bytesAllocated = counterDataPrefix.size();
+    prefixParams.pBuffer = counterDataPrefix.data();
+    nvperf::counterDataBuilderGetCounterDataPrefix<true>(&prefixParams);
+
+    NVPW_CounterDataBuilder_Destroy_Params destroyParams = {
+        NVPW_CounterDataBuilder_Destroy_Params_STRUCT_SIZE};
+    destroyParams.pCounterDataBuilder = counterDataBuilder;
+    nvperf::counterDataBuilderDestroy<true>(&destroyParams);
+  }
+
+  void initCounterDataImage() {
+    CUpti_Profiler_CounterDataImageOptions options = {
+        CUpti_Profiler_CounterDataImageOptions_STRUCT_SIZE};
+    options.pCounterDataPrefix = counterDataPrefix.data();
+    options.counterDataPrefixSize = counterDataPrefix.size();
+    options.maxNumRanges = MaxRanges;
+    options.maxNumRangeTreeNodes = MaxRanges;
+    options.maxRangeNameLength = MaxRangeNameLength;
+
+    CUpti_Profiler_CounterDataImage_CalculateSize_Params sizeParams = {
+        CUpti_Profiler_CounterDataImage_CalculateSize_Params_STRUCT_SIZE};
+    sizeParams.pOptions = &options;
+    sizeParams.sizeofCounterDataImageOptions =
+        CUpti_Profiler_CounterDataImageOptions_STRUCT_SIZE;
+    cupti::profilerCounterDataImageCalculateSize<true>(&sizeParams);
+    counterDataImage.resize(sizeParams.counterDataImageSize);
+
+    CUpti_Profiler_CounterDataImage_Initialize_Params imageParams = {
+        CUpti_Profiler_CounterDataImage_Initialize_Params_STRUCT_SIZE};
+    imageParams.pOptions = &options;
+    imageParams.sizeofCounterDataImageOptions =
+        CUpti_Profiler_CounterDataImageOptions_STRUCT_SIZE;
+    imageParams.counterDataImageSize = counterDataImage.size();
+    imageParams.pCounterDataImage = counterDataImage.data();
+    cupti::profilerCounterDataImageInitialize<true>(&imageParams);
+
+    CUpti_Profiler_CounterDataImage_CalculateScratchBufferSize_Params
+        scratchSizeParams = {
+            CUpti_Profiler_CounterDataImage_CalculateScratchBufferSize_Params_STRUCT_SIZE};
+    scratchSizeParams.counterDataImageSize = counterDataImage.size();
+    scratchSizeParams.pCounterDataImage = counterDataImage.data();
+    cupti::profilerCounterDataImageCalculateScratchBufferSize<true>(
+        &scratchSizeParams);
+    counterDataScratchBuffer.resize(
+        scratchSizeParams.counterDataScratchBufferSize);
+
+    CUpti_Profiler_CounterDataImage_InitializeScratchBuffer_Params
+        scratchParams = {
+            CUpti_Profiler_CounterDataImage_InitializeScratchBuffer_Params_STRUCT_SIZE};
+    scratchParams.counterDataImageSize = counterDataImage.size();
+    scratchParams.pCounterDataImage = counterDataImage.data();
+    scratchParams.counterDataScratchBufferSize =
+        counterDataScratchBuffer.size();
+    scratchParams.pCounterDataScratchBuffer = counterDataScratchBuffer.data();
+    cupti::profilerCounterDataImageInitializeScratchBuffer<true>(
+        &scratchParams);
+  }
+
+  void beginSession() {
+    initCounterDataImage();
+    CUpti_Profiler_BeginSession_Params beginParams = {
+        CUpti_Profiler_BeginSession_Params_STRUCT_SIZE};
+    beginParams.ctx = context;
+    beginParams.counterDataImageSize = counterDataImage.size();
+    beginParams.pCounterDataImage = counterDataImage.data();
+    beginParams.counterDataScratchBufferSize = counterDataScratchBuffer.size();
+    beginParams.pCounterDataScratchBuffer = counterDataScratchBuffer.data();
+    beginParams.range = CUPTI_AutoRange;
+    beginParams.replayMode = CUPTI_KernelReplay;
+    beginParams.maxRangesPerPass = MaxRanges;
+    beginParams.maxLaunchesPerPass = MaxRanges;
+    cupti::profilerBeginSession<true>(&beginParams);
+
+    CUpti_Profiler_SetConfig_Params configParams = {
+        CUpti_Profiler_SetConfig_Params_STRUCT_SIZE};
+    configParams.ctx = context;
+    configParams.pConfig = configImage.data();
+    configParams.configSize = configImage.size();
+    configParams.passIndex = 0;
+    configParams.minNestingLevel = 1;
+    configParams.numNestingLevels = 1;
+    configParams.targetNestingLevel = 1;
+    cupti::profilerSetConfig<true>(&configParams);
+    sessionActive = true;
+    setProfiling(true);
+  }
+
+  void endSession() {
+    setProfiling(false);
+    CUpti_Profiler_FlushCounterData_Params flushParams = {
+        CUpti_Profiler_FlushCounterData_Params_STRUCT_SIZE};
+    flushParams.ctx = context;
+    cupti::profilerFlushCounterData<true>(&flushParams);
+    CUpti_Profiler_UnsetConfig_Params unsetParams = {
+        CUpti_Profiler_UnsetConfig_Params_STRUCT_SIZE};
+    unsetParams.ctx = context;
+    cupti::profilerUnsetConfig<true>(&unsetParams);
+    CUpti_Profiler_EndSession_Params endParams = {
+        CUpti_Profiler_EndSession_Params_STRUCT_SIZE};
+    endParams.ctx = context;
+    cupti::profilerEndSession<true>(&endParams);
+    sessionActive = false;
+  }
+
+  void setProfiling(bool enable) {
+    if (enable == profiling)
+      return;
+    if (enable) {
+      CUpti_Profiler_EnableProfiling_Params enableParams = {
+          CUpti_Profiler_EnableProfiling_Params_STRUCT_SIZE};
+      enableParams.ctx = context;
+      cupti::profilerEnableProfiling<true>(&enableParams);
+    } else {
+      CUpti_Profiler_DisableProfiling_Params disableParams = {
+          CUpti_Profiler_DisableProfiling_Params_STRUCT_SIZE};
+      disableParams.ctx = context;
+      cupti::profilerDisableProfiling<true>(&disableParams);
+    }
+    profiling = enable;
+  }
+
+  std::string getRangeName(size_t rangeIndex) {
+    NVPW_Profiler_CounterData_GetRangeDescriptions_Params descriptionParams = {
+        NVPW_Profiler_CounterData_GetRangeDescriptions_Params_STRUCT_SIZE};
+    descriptionParams.pCounterDataImage = counterDataImage.data();
+    descriptionParams.rangeIndex = rangeIndex;
+    nvperf::counterDataGetRangeDescriptions<true>(&descriptionParams);
+    std::vector<const char *> descriptions(descriptionParams.numDescriptions);
+    descriptionParams.ppDescriptions = descriptions.data();
+    nvperf::counterDataGetRangeDescriptions<true>(&descriptionParams);
+    return descriptions.empty() ? std::string() : descriptions.back();
+  }
+
+  void decode(const std::set<Data *> &dataSet) {
+    NVPW_MetricsEvaluator_SetDeviceAttributes_Params attributeParams = {
+        NVPW_MetricsEvaluator_SetDeviceAttributes_Params_STRUCT_SIZE};
+    attributeParams.pMetricsEvaluator = evaluator;
+    attributeParams.pCounterDataImage = counterDataImage.data();
+    attributeParams.counterDataImageSize = counterDataImage.size();
+    nvperf::metricsEvaluatorSetDeviceAttributes<true>(&attributeParams);
+
+    NVPW_CounterData_GetNumRanges_Params rangeParams = {
+        NVPW_CounterData_GetNumRanges_Params_STRUCT_SIZE};
+    rangeParams.pCounterDataImage = counterDataImage.data();
+    nvperf::counterDataGetNumRanges<true>(&rangeParams);
+    auto numRanges = std::min<size_t>(rangeParams.numRanges, launches.size());
+    if (rangeParams.numRanges != launches.size())
+      std::cerr << "[PROTON] Profiled " << rangeParams.numRanges
+                << " kernels for " << launches.size()
+                << " launches, hardware counters may be misattributed"
+                << std::endl;
+
+    std::vector<double> values(evalRequests.size());
+    for (size_t rangeIndex = 0; rangeIndex < numRanges; ++rangeIndex) {
+      NVPW_MetricsEvaluator_EvaluateToGpuValues_Params evaluateParams = {
+          NVPW_MetricsEvaluator_EvaluateToGpuValues_Params_STRUCT_SIZE};
+      evaluateParams.pMetricsEvaluator = evaluator;
+      evaluateParams.pMetricEvalRequests = evalRequests.data();
+      evaluateParams.numMetricEvalRequests = evalRequests.size();
+      evaluateParams.metricEvalRequestStructSize =
+          NVPW_MetricEvalRequest_STRUCT_SIZE;
+      evaluateParams.metricEvalRequestStrideSize =
+          sizeof(NVPW_MetricEvalRequest);
+      evaluateParams.pCounterDataImage = counterDataImage.data();
+      evaluateParams.counterDataImageSize = counterDataImage.size();
+      evaluateParams.rangeIndex = rangeIndex;
+      evaluateParams.isolated = true;
+      evaluateParams.pMetricValues = values.data();
+      nvperf::metricsEvaluatorEvaluateToGpuValues<true>(&evaluateParams);
+
+      std::vector<double> counters(CounterMetric::Count, 0.0);
+      for (size_t i = 0; i < counterIds.size(); ++i)
+        counters[counterIds[i]] = values[i];
+      // Occupancy is averaged over the active cycles when aggregated
+      counters[CounterMetric::OccupancyCycles] *=
+          counters[CounterMetric::ActiveCycles] / 100.0;
+
+      auto &launch = launches[rangeIndex];
+      auto rangeName = launch.isAPI ? getRangeName(rangeIndex) : "";
+      for (auto *data : dataSet) {
+        auto scopeId = launch.scopeId;
+        if (launch.isAPI)
+          scopeId = data->addScope(launch.scopeId, rangeName);
+        auto metric = std::make_shared<CounterMetric>();
+        for (int i = 0; i < CounterMetric::Count; ++i)
+          metric->setValue(i, counters[i]);
+        data->addMetric(scopeId, metric);
+      }
+    }
+    launches.clear();
+  }
+
+  std::mutex mutex;
+  CUcontext context{};
+  bool sessionActive{false};
+  bool profiling{false};
+  std::string chipName;
+  std::vector<uint8_t> counterAvailabilityImage;
+  std::vector<uint8_t> evaluatorScratchBuffer;
+  NVPW_MetricsEvaluator *evaluator{};
+  // Ids of the CounterMetric values evaluated by `evalRequests`
+  std::vector<int> counterIds;
+  std::vector<NVPW_MetricEvalRequest> evalRequests;
+  std::vector<uint8_t> configImage;
+  std::vector<uint8_t> counterDataPrefix;
+  std::vector<uint8_t> counterDataImage;
+  std::vector<uint8_t> counterDataScratchBuffer;
+  std::deque<Launch> launches;
+};
+
+/// Samples the program counters of kernels with CUPTI's PC sampling, and
+/// attributes the samples of each kernel to the source lines of its
+/// instructions, with the stall reasons of the sampled warps.
+///
+/// Kernels are serialized, and each launch is sampled in a range of its own,
+/// whose samples are decoded when the launch returns.  The source lines are
+/// found through the line info of the cubins (emitted by Triton unless
+/// TRITON_DISABLE_LINE_INFO is set); modules loaded before profiling starts
+/// are not known, and their samples are attributed to the offsets of their
+/// instructions instead.  Only the context current at the first launch is
+/// sampled.
+class PCSampler {
+public:
+  PCSampler() = default;
+  ~PCSampler() = default;
+
+  /// Called when a module is loaded, to map the samples of its kernels to
+  /// source lines.
+  void addModule(const void *cubin, size_t cubinSize) {
+    CUpti_GetCubinCrcParams crcParams = {CUpti_GetCubinCrcParamsSize};
+    crcParams.cubinSize = cubinSize;
+    crcParams.cubin = cubin;
+    cupti::getCubinCrc<true>(&crcParams);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto *bytes = static_cast<const char *>(cubin);
+    cubins[crcParams.cubinCrc].assign(bytes, bytes + cubinSize);
+  }
+
+  /// Called on the launching thread before a kernel is launched.
+  /// See CounterProfiler::enterLaunch for the arguments.
+  void enterLaunch(size_t scopeId, bool isAPI, bool isGraph) {
+    std::lock_guard<std::mutex> lock(mutex);
+    CUcontext currentContext = nullptr;
+    cuda::ctxGetCurrent<false>(&currentContext);
+    if (currentContext == nullptr)
+      return;
+    if (context == nullptr) {
+      context = currentContext;
+      init();
+    }
+    // Kernels of graphs cannot be attributed to launches
+    if (currentContext != context || isGraph)
+      return;
+    CUpti_PCSamplingStartParams startParams = {CUpti_PCSamplingStartParamsSize};
+    startParams.ctx = context;
+    cupti::pcSamplingStart<true>(&startParams);
+    launch = {scopeId, isAPI};
+    sampling = true;
+  }
+
+  /// Called on the launching thread after a kernel is launched.
+  void exitLaunch(const std::set<Data *> &dataSet) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!sampling)
+      return;
+    CUpti_PCSamplingStopParams stopParams = {CUpti_PCSamplingStopParamsSize};
+    stopParams.ctx = context;
+    cupti::pcSamplingStop<true>(&stopParams);
+    sampling = false;
+    decode(dataSet);
+  }
+
+  void stop() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (context == nullptr)
+      return;
+    CUpti_PCSamplingDisableParams disableParams = {
+        CUpti_PCSamplingDisableParamsSize};
+    disableParams.ctx = context;
+    cupti::pcSamplingDisable<true>(&disableParams);
+    context = nullptr;
+  }
+
+private:
+  struct Launch {
+    size_t scopeId;
+    bool isAPI;
+  };
+
+  // 2^(5 + SamplingPeriod) cycles between samples
+  static constexpr uint32_t SamplingPeriod = 5;
+  // Number of PCs decoded per call to pcSamplingGetData
+  static constexpr size_t MaxPCs = 4096;
+  static constexpr size_t ScratchBufferSize = 128 * 1024 * 1024;
+  static constexpr const char *StallReasonPrefix = "smsp__pcsamp_warps_issue_";
+
+  void init() {
+    CUpti_PCSamplingEnableParams enableParams = {
+        CUpti_PCSamplingEnableParamsSize};
+    enableParams.ctx = context;
+    cupti::pcSamplingEnable<true>(&enableParams);
+
+    size_t numStallReasons = 0;
+    CUpti_PCSamplingGetNumStallReasonsParams numParams = {
+        CUpti_PCSamplingGetNumStallReasonsParamsSize};
+    numParams.ctx = context;
+    numParams.numStallReasons = &numStallReasons;
+    cupti::pcSamplingGetNumStallReasons<true>(&numParams);
+    std::vector<uint32_t> stallReasonIndices(numStallReasons);
+    std::vector<std::vector<char>> names(
+        numStallReasons, std::vector<char>(CUPTI_STALL_REASON_STRING_SIZE));
+    std::vector<char *> namePointers;
+    for (auto &name : names)
+      namePointers.push_back(name.data());
+    CUpti_PCSamplingGetStallReasonsParams reasonParams = {
+        CUpti_PCSamplingGetStallReasonsParamsSize};
+    reasonParams.ctx = context;
+    reasonParams.numStallReasons = numStallReasons;
+    reasonParams.stallReasonIndex = stallReasonIndices.data();
+    reasonParams.stallReasons = namePointers.data();
+    cupti::pcSamplingGetStallReasons<true>(&reasonParams);
+    for (size_t i = 0; i < numStallReasons; ++i) {
+      std::string name = names[i].data();
+      if (name.rfind(StallReasonPrefix, 0) == 0)
+        name = name.substr(std::char_traits<char>::length(StallReasonPrefix));
+      stallReasonNames[stallReasonIndices[i]] = name;
+    }
+
+    stallReasons.resize(MaxPCs * numStallReasons);
+    pcData.resize(MaxPCs);
+    for (size_t i = 0; i < MaxPCs; ++i) {
+      pcData[i].size = sizeof(CUpti_PCSamplingPCData);
+      pcData[i].stallReasonCount = numStallReasons;
+      pcData[i].stallReason = &stallReasons[i * numStallReasons];
+    }
+    samplingData.size = sizeof(CUpti_PCSamplingData);
+    samplingData.collectNumPcs = MaxPCs;
+    samplingData.pPcData = pcData.data();
+
+    std::vector<CUpti_PCSamplingConfigurationInfo> configs(6);
+    configs[0].attributeType =
+        CUPTI_PC_SAMPLING_CONFIGURATION_ATTR_TYPE_SAMPLING_PERIOD;
+    configs[0].attributeData.samplingPeriodData.samplingPeriod =
+        SamplingPeriod;
+    configs[1].attributeType =
+        CUPTI_PC_SAMPLING_CONFIGURATION_ATTR_TYPE_STALL_REASON;
+    configs[1].attributeData.stallReasonData.stallReasonCount =
+        numStallReasons;
+    configs[1].attributeData.stallReasonData.pStallReasonIndex =
+        stallReasonIndices.data();
+    configs[2].attributeType =
+        CUPTI_PC_SAMPLING_CONFIGURATION_ATTR_TYPE_SCRATCH_BUFFER_SIZE;
+    configs[2].attributeData.scratchBufferSizeData.scratchBufferSize =
+        ScratchBufferSize;
+    configs[3].attributeType =
+        CUPTI_PC_SAMPLING_CONFIGURATION_ATTR_TYPE_COLLECTION_MODE;
+    configs[3].attributeData.collectionModeData.collectionMode =
+        CUPTI_PC_SAMPLING_COLLECTION_MODE_KERNEL_SERIALIZED;
+    configs[4].attributeType =
+        CUPTI_PC_SAMPLING_CONFIGURATION_ATTR_TYPE_ENABLE_START_STOP_CONTROL;
+    configs[4].attributeData.enableStartStopControlData.enableStartStopControl =
+        1;
+    configs[5].attributeType =
+        CUPTI_PC_SAMPLING_CONFIGURATION_ATTR_TYPE_SAMPLING_DATA_BUFFER;
+    configs[5].attributeData.samplingDataBufferData.samplingDataBuffer =
+        &samplingData;
+    CUpti_PCSamplingConfigurationInfoParams configParams = {
+        CUpti_PCSamplingConfigurationInfoParamsSize};
+    configParams.ctx = context;
+    configParams.numAttributes = configs.size();
+    configParams.pPCSamplingConfigurationInfo = configs.data();
+    cupti::pcSamplingSetConfigurationAttribute<true>(&configParams);
+  }
+
+  /// Returns the source line of an instruction, as "path:function@line".
+  std::string getSourceLine(const CUpti_PCSamplingPCData &pc) {
+    auto key = std::make_pair(pc.cubinCrc, pc.pcOffset);
+    auto lineIt = sourceLines.find(key);
+    if (lineIt != sourceLines.end())
+      return lineIt->second;
+    std::string functionName = pc.functionName ? pc.functionName : "";
+    std::stringstream line;
+    auto cubinIt = cubins.find(pc.cubinCrc);
+    CUpti_GetSassToSourceCorrelationParams sourceParams = {
+        CUpti_GetSassToSourceCorrelationParamsSize};
+    if (cubinIt != cubins.end()) {
+      sourceParams.cubin = cubinIt->second.data();
+      sourceParams.cubinSize = cubinIt->second.size();
+      sourceParams.functionName = functionName.c_str();
+      sourceParams.pcOffset = pc.pcOffset;
+    }
+    if (cubinIt != cubins.end() &&
+        cupti::getSassToSourceCorrelation<false>(&sourceParams) ==
+            CUPTI_SUCCESS) {
+      if (sourceParams.dirName && *sourceParams.dirName)
+        line << sourceParams.dirName << "/";
+      line << (sourceParams.fileName ? sourceParams.fileName : "") << ":"
+           << functionName << "@" << sourceParams.lineNumber;
+      // The names are allocated by CUPTI
+      std::free(sourceParams.fileName);
+      std::free(sourceParams.dirName);
+    } else {
+      line << functionName << "@0x" << std::hex << pc.pcOffset;
+    }
+    return sourceLines[key] = line.str();
+  }
+
+  void decode(const std::set<Data *> &dataSet) {
+    // source line -> metric name -> samples
+    std::map<std::string, std::map<std::string, uint64_t>> lineSamples;
+    std::string kernelName;
+    do {
+      CUpti_PCSamplingGetDataParams dataParams = {
+          CUpti_PCSamplingGetDataParamsSize};
+      dataParams.ctx = context;
+      dataParams.pcSamplingData = &samplingData;
+      cupti::pcSamplingGetData<true>(&dataParams);
+      for (size_t i = 0; i < samplingData.totalNumPcs; ++i) {
+        auto &pc = pcData[i];
+        if (pc.functionName && kernelName.empty())
+          kernelName = pc.functionName;
+        std::map<std::string, uint64_t> *samples = nullptr;
+        for (size_t j = 0; j < pc.stallReasonCount; ++j) {
+          auto &stallReason = pc.stallReason[j];
+          if (stallReason.samples == 0)
+            continue;
+          if (samples == nullptr)
+            samples = &lineSamples[getSourceLine(pc)];
+          auto index = stallReason.pcSamplingStallReasonIndex;
+          (*samples)[stallReasonNames[index]] += stallReason.samples;
+          (*samples)[SamplesMetricName] += stallReason.samples;
+        }
+      }
+    } while (samplingData.remainingNumPcs > 0);
+    if (samplingData.droppedSamples > 0)
+      std::cerr << "[PROTON] " << samplingData.droppedSamples
+                << " PC samples were dropped, increase the scratch buffer size"
+                << std::endl;
+    if (lineSamples.empty())
+      return;
+    for (auto *data : dataSet) {
+      auto scopeId = launch.scopeId;
+      if (launch.isAPI)
+        scopeId = data->addScope(launch.scopeId, kernelName);
+      for (auto &[line, samples] : lineSamples) {
+        std::map<std::string, MetricValueType> metrics(samples.begin(),
+                                                       samples.end());
+        data->addMetrics(data->addScope(scopeId, line), metrics,
+                         /*aggregable=*/true);
+      }
+    }
+  }
+
+  inline static const std::string SamplesMetricName = "pc_samples";
+
+  std::mutex mutex;
+  CUcontext context{};
+  bool sampling{false};
+  Launch launch{};
+  // stall reason index -> name
+  std::map<uint32_t, std::string> stallReasonNames;
+  std::vector<CUpti_PCSamplingStallReason> stallReasons;
+  std::vector<CUpti_PCSamplingPCData> pcData;
+  CUpti_PCSamplingData samplingData{};
+  // cubin crc -> cubin
+  std::unordered_map<uint64_t, std::vector<char>> cubins;
+  // (cubin crc, pc offset) -> source line
+  std::map<std::pair<uint64_t, uint64_t>, std::string> sourceLines;
+};
+
+/// Tracks the device memory allocated and freed through the driver API,
+/// including the allocations of the runtime API and of caching allocators
+/// growing their pools.  Each allocation and free is attributed to the
+/// calling context of the thread making it, with the peak of the memory
+/// allocated on its device while profiling.  Memory allocated before
+/// profiling is not counted, nor freed.
+class MemoryTracker {
+public:
+  MemoryTracker() = default;
+  ~MemoryTracker() = default;
+
+  /// Called on the thread exiting an allocation or free API.
+  void exitApi(CUpti_CallbackId cbId, const CUpti_CallbackData *callbackData,
+               const std::set<Data *> &dataSet) {
+    if (*static_cast<CUresult *>(callbackData->functionReturnValue) !=
+        CUDA_SUCCESS)
+      return;
+    auto *params = callbackData->functionParams;
+    switch (cbId) {
+    case CUPTI_DRIVER_TRACE_CBID_cuMemAlloc_v2: {
+      auto *allocParams = static_cast<const cuMemAlloc_v2_params *>(params);
+      allocate(*allocParams->dptr, allocParams->bytesize, dataSet);
+      break;
+    }
+    case CUPTI_DRIVER_TRACE_CBID_cuMemAllocManaged: {
+      auto *allocParams =
+          static_cast<const cuMemAllocManaged_params *>(params);
+      allocate(*allocParams->dptr, allocParams->bytesize, dataSet);
+      break;
+    }
+    case CUPTI_DRIVER_TRACE_CBID_cuMemAllocAsync:
+    case CUPTI_DRIVER_TRACE_CBID_cuMemAllocAsync_ptsz: {
+      auto *allocParams = static_cast<const cuMemAllocAsync_params *>(params);
+      allocate(*allocParams->dptr, allocParams->bytesize, dataSet);
+      break;
+    }
+    case CUPTI_DRIVER_TRACE_CBID_cuMemAllocFromPoolAsync:
+    case CUPTI_DRIVER_TRACE_CBID_cuMemAllocFromPoolAsync_ptsz: {
+      auto *allocParams =
+          static_cast<const cuMemAllocFromPoolAsync_params *>(params);
+      allocate(*allocParams->dptr, allocParams->bytesize, dataSet);
+      break;
+    }
+    case CUPTI_DRIVER_TRACE_CBID_cuMemFree_v2:
+      release(static_cast<const cuMemFree_v2_params *>(params)->dptr, dataSet);
+      break;
+    case CUPTI_DRIVER_TRACE_CBID_cuMemFreeAsync:
+    case CUPTI_DRIVER_TRACE_CBID_cuMemFreeAsync_ptsz:
+      release(static_cast<const cuMemFreeAsync_params *>(params)->dptr,
+              dataSet);
+      break;
+    default:
+      break;
+    }
+  }
+
+private:
+  void allocate(CUdeviceptr ptr, size_t bytes,
+                const std::set<Data *> &dataSet) {
+    CUdevice device = 0;
+    cuda::ctxGetDevice<false>(&device);
+    uint64_t peakBytes = 0;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      allocations[ptr] = {device, bytes};
+      auto &deviceBytes = allocatedBytes[device];
+      deviceBytes += bytes;
+      peakBytes = deviceBytes;
+    }
+    addMetric(std::make_shared<MemoryMetric>(bytes, 0, 1, peakBytes), dataSet);
+  }
+
+  void release(CUdeviceptr ptr, const std::set<Data *> &dataSet) {
+    size_t bytes = 0;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto it = allocations.find(ptr);
+      if (it == allocations.end())
+        return;
+      auto [device, allocationBytes] = it->second;
+      bytes = allocationBytes;
+      allocatedBytes[device] -= bytes;
+      allocations.erase(it);
+    }
+    addMetric(std::make_shared<MemoryMetric>(0, bytes, 0, 0), dataSet);
+  }
+
+  void addMetric(std::shared_ptr<Metric> metric,
+                 const std::set<Data *> &dataSet) {
+    // Attributed to the current context of each data
+    auto scopeId = Scope::getNewScopeId();
+    for (auto *data : dataSet) {
+      data->addScope(scopeId);
+      data->addMetric(scopeId, metric);
+    }
+  }
+
+  std::mutex mutex;
+  // address -> (device, bytes) of the allocations made while profiling
+  std::unordered_map<CUdeviceptr, std::pair<CUdevice, size_t>> allocations;
+  // device -> bytes allocated while profiling
+  std::map<CUdevice, uint64_t> allocatedBytes;
+};
+
+// Recycles the activity buffers of CUPTI and processes the completed ones on
+// a consumer thread, so that CUPTI's threads and the flushing thread don't
+// wait on the locks of the data.  The completed buffers are handed off
+// through a lock-free stack, which the consumer takes all at once.
+class ActivityBufferQueue {
+public:
+  using ProcessFn = std::function<void(uint8_t *buffer, size_t validSize)>;
+
+  void start(size_t size, ProcessFn fn) {
+    bufferSize = (size + AlignSize - 1) / AlignSize * AlignSize;
+    processFn = std::move(fn);
+    stopped = false;
+    consumer = std::thread([this]() { consume(); });
+  }
+
+  /// Processes the buffers pushed so far, then stops the consumer and frees
+  /// the recycled buffers.
+  void stop() {
+    if (!consumer.joinable())
+      return;
+    drain();
+    stopped = true;
+    pushedCondition.notify_one();
+    consumer.join();
+    std::lock_guard<std::mutex> lock(poolMutex);
+    for (auto *buffer : freeBuffers)
+      std::free(buffer);
+    freeBuffers.clear();
+  }
+
+  /// Returns a recycled buffer, or a new one.
+  uint8_t *allocBuffer() {
+    {
+      std::lock_guard<std::mutex> lock(poolMutex);
+      if (!freeBuffers.empty()) {
+        auto *buffer = freeBuffers.back();
+        freeBuffers.pop_back();
+        return buffer;
+      }
+    }
+    auto *buffer = static_cast<uint8_t *>(aligned_alloc(AlignSize, bufferSize));
+    if (buffer == nullptr)
+      throw std::runtime_error("aligned_alloc failed");
+    return buffer;
+  }
+
+  size_t getBufferSize() const { return bufferSize; }
+
+  /// Hands off a completed buffer to the consumer.
+  void push(uint8_t *buffer, size_t validSize) {
+    auto *node = new Node{buffer, validSize, nullptr};
+    numPending.fetch_add(1);
+    node->next = completed.load(std::memory_order_relaxed);
+    while (!completed.compare_exchange_weak(node->next, node,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed))
+      ;
+    pushedCondition.notify_one();
+  }
+
+  /// Waits until the buffers pushed so far are processed.
+  void drain() {
+    std::unique_lock<std::mutex> lock(waitMutex);
+    drainedCondition.wait(lock, [this]() { return numPending.load() == 0; });
+  }
+
+private:
+  struct Node {
+    uint8_t *buffer;
+    size_t validSize;
+    Node *next;
+  };
+
+  void consume() {
+    while (true) {
+      Node *nodes = completed.exchange(nullptr, std::memory_order_acquire);
+      if (nodes == nullptr) {
+        if (stopped)
+          return;
+        // The producers notify without taking the lock, which bounds the
+        // delay of a missed wakeup by the timeout rather than blocking them.
+        std::unique_lock<std::mutex> lock(waitMutex);
+        pushedCondition.wait_for(lock, std::chrono::milliseconds(10), [this]() {
+          return stopped || completed.load(std::memory_order_relaxed);
+        });
+        continue;
+      }
+      // The stack holds the last pushed buffer first
+      Node *ordered = nullptr;
+      while (nodes != nullptr) {
+        auto *next = nodes->next;
+        nodes->next = ordered;
+        ordered = nodes;
+        nodes = next;
+      }
+      while (ordered != nullptr) {
+        try {
+          processFn(ordered->buffer, ordered->validSize);
+        } catch (const std::exception &e) {
+          std::cerr << "[PROTON] Failed to process activities: " << e.what()
+                    << std::endl;
+        }
+        release(ordered->buffer);
+        auto *next = ordered->next;
+        delete ordered;
+        ordered = next;
+        if (numPending.fetch_sub(1) == 1) {
+          std::lock_guard<std::mutex> lock(waitMutex);
+          drainedCondition.notify_all();
+        }
+      }
+    }
+  }
+
+  void release(uint8_t *buffer) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    if (freeBuffers.size() < MaxFreeBuffers)
+      freeBuffers.push_back(buffer);
+    else
+      std::free(buffer);
+  }
+
+  static constexpr size_t AlignSize = 8;
+  static constexpr size_t MaxFreeBuffers = 4;
+
+  size_t bufferSize{};
+  ProcessFn processFn;
+  std::atomic<Node *> completed{nullptr};
+  std::atomic<size_t> numPending{0};
+  std::atomic<bool> stopped{true};
+  std::thread consumer;
+  std::mutex waitMutex;
+  std::condition_variable pushedCondition;
+  std::condition_variable drainedCondition;
+  std::mutex poolMutex;
+  std::vector<uint8_t *> freeBuffers;
+};
+
 } // namespace
 
 struct CuptiProfiler::CuptiProfilerPimpl
@@ -178,14 +1217,17 @@ struct CuptiProfiler::CuptiProfilerPimpl
                           size_t *maxNumRecords);
   static void completeBuffer(CUcontext context, uint32_t streamId,
                              uint8_t *buffer, size_t size, size_t validSize);
+  static void processBuffer(uint8_t *buffer, size_t validSize);
   static void callbackFn(void *userData, CUpti_CallbackDomain domain,
                          CUpti_CallbackId cbId, const void *cbData);
 
-  static constexpr size_t AlignSize = 8;
-  static constexpr size_t BufferSize = 64 * 1024 * 1024;
   static constexpr size_t AttributeSize = sizeof(size_t);
 
   CUpti_SubscriberHandle subscriber{};
+  ActivityBufferQueue activityBuffers;
+  std::unique_ptr<CounterProfiler> counterProfiler;
+  std::unique_ptr<PCSampler> pcSampler;
+  std::unique_ptr<MemoryTracker> memoryTracker;
 
   ThreadSafeMap<uint32_t, size_t, std::unordered_map<uint32_t, size_t>>
       graphIdToNumInstances;
@@ -196,11 +1238,10 @@ struct CuptiProfiler::CuptiProfilerPimpl
 void CuptiProfiler::CuptiProfilerPimpl::allocBuffer(uint8_t **buffer,
                                                     size_t *bufferSize,
                                                     size_t *maxNumRecords) {
-  *buffer = static_cast<uint8_t *>(aligned_alloc(AlignSize, BufferSize));
-  if (*buffer == nullptr) {
-    throw std::runtime_error("aligned_alloc failed");
-  }
-  *bufferSize = BufferSize;
+  CuptiProfiler &profiler = threadState.profiler;
+  auto *pImpl = dynamic_cast<CuptiProfilerPimpl *>(profiler.pImpl.get());
+  *buffer = pImpl->activityBuffers.allocBuffer();
+  *bufferSize = pImpl->activityBuffers.getBufferSize();
   *maxNumRecords = 0;
 }
 
@@ -210,16 +1251,25 @@ void CuptiProfiler::CuptiProfilerPimpl::completeBuffer(CUcontext ctx,
                                                        size_t size,
                                                        size_t validSize) {
   CuptiProfiler &profiler = threadState.profiler;
+  auto *pImpl = dynamic_cast<CuptiProfilerPimpl *>(profiler.pImpl.get());
+  pImpl->activityBuffers.push(buffer, validSize);
+}
+
+void CuptiProfiler::CuptiProfilerPimpl::processBuffer(uint8_t *buffer,
+                                                      size_t validSize) {
+  CuptiProfiler &profiler = threadState.profiler;
   auto &dataSet = profiler.dataSet;
+  auto samplingInterval = profiler.getSamplingInterval();
   uint32_t maxCorrelationId = 0;
   CUptiResult status;
   CUpti_Activity *activity = nullptr;
   do {
     status = cupti::activityGetNextRecord<false>(buffer, validSize, &activity);
     if (status == CUPTI_SUCCESS) {
-      auto correlationId =
-          processActivity(profiler.correlation.corrIdToExternId,
-                          profiler.correlation.apiExternIds, dataSet, activity);
+      auto correlationId = processActivity(
+          profiler.correlation.corrIdToExternId,
+          profiler.correlation.apiExternIds, dataSet, activity,
+          samplingInterval);
       maxCorrelationId = std::max(maxCorrelationId, correlationId);
     } else if (status == CUPTI_ERROR_MAX_LIMIT_REACHED) {
       break;
@@ -228,8 +1278,6 @@ void CuptiProfiler::CuptiProfilerPimpl::completeBuffer(CUcontext ctx,
     }
   } while (true);
 
-  std::free(buffer);
-
   profiler.correlation.complete(maxCorrelationId);
 }
 
@@ -238,7 +1286,16 @@ void CuptiProfiler::CuptiProfilerPimpl::callbackFn(void *userData,
                                                    CUpti_CallbackId cbId,
                                                    const void *cbData) {
   CuptiProfiler &profiler = threadState.profiler;
-  if (domain == CUPTI_CB_DOMAIN_RESOURCE) {
+  if (domain == CUPTI_CB_DOMAIN_RESOURCE &&
+      cbId == CUPTI_CBID_RESOURCE_MODULE_LOADED) {
+    auto *resourceData =
+        static_cast<CUpti_ResourceData *>(const_cast<void *>(cbData));
+    auto *moduleData = static_cast<CUpti_ModuleResourceData *>(
+        resourceData->resourceDescriptor);
+    auto *pImpl = dynamic_cast<CuptiProfilerPimpl *>(profiler.pImpl.get());
+    if (pImpl->pcSampler && moduleData->pCubin)
+      pImpl->pcSampler->addModule(moduleData->pCubin, moduleData->cubinSize);
+  } else if (domain == CUPTI_CB_DOMAIN_RESOURCE) {
     auto *resourceData =
         static_cast<CUpti_ResourceData *>(const_cast<void *>(cbData));
     auto *graphData =
@@ -265,17 +1322,28 @@ void CuptiProfiler::CuptiProfilerPimpl::callbackFn(void *userData,
     } else if (cbId == CUPTI_CBID_RESOURCE_GRAPH_DESTROY_STARTING) {
       pImpl->graphIdToNumInstances.erase(graphId);
     }
+  } else if (isMemoryApi(domain, cbId)) {
+    const CUpti_CallbackData *callbackData =
+        static_cast<const CUpti_CallbackData *>(cbData);
+    auto *pImpl = dynamic_cast<CuptiProfilerPimpl *>(profiler.pImpl.get());
+    if (pImpl->memoryTracker && callbackData->callbackSite == CUPTI_API_EXIT)
+      pImpl->memoryTracker->exitApi(cbId, callbackData, profiler.getDataSet());
   } else {
     const CUpti_CallbackData *callbackData =
         static_cast<const CUpti_CallbackData *>(cbData);
     if (callbackData->callbackSite == CUPTI_API_ENTER) {
+      // Launches not sampled are not correlated, so that their activities
+      // are dropped
+      if (!threadState.enterLaunch())
+        return;
+      auto *pImpl = dynamic_cast<CuptiProfilerPimpl *>(profiler.pImpl.get());
+      auto isAPI = !profiler.isOpInProgress();
       auto scopeId = Scope::getNewScopeId();
       threadState.record(scopeId);
       threadState.enterOp(scopeId);
       size_t numInstances = 1;
       if (cbId == CUPTI_DRIVER_TRACE_CBID_cuGraphLaunch ||
           cbId == CUPTI_DRIVER_TRACE_CBID_cuGraphLaunch_ptsz) {
-        auto *pImpl = dynamic_cast<CuptiProfilerPimpl *>(profiler.pImpl.get());
         auto graphExec = static_cast<const cuGraphLaunch_params *>(
                              callbackData->functionParams)
                              ->hGraph;
@@ -298,14 +1366,36 @@ void CuptiProfiler::CuptiProfilerPimpl::callbackFn(void *userData,
                     << std::endl;
       }
       profiler.correlation.correlate(callbackData->correlationId, numInstances);
+      auto &externIds = profiler.correlation.externIdQueue;
+      if (pImpl->counterProfiler && threadState.getLaunchDepth() == 1 &&
+          !externIds.empty())
+        pImpl->counterProfiler->enterLaunch(externIds.back(), isAPI,
+                                            isGraphLaunch(cbId));
+      if (pImpl->pcSampler && threadState.getLaunchDepth() == 1 &&
+          !externIds.empty())
+        pImpl->pcSampler->enterLaunch(externIds.back(), isAPI,
+                                      isGraphLaunch(cbId));
     } else if (callbackData->callbackSite == CUPTI_API_EXIT) {
+      if (!threadState.exitLaunch())
+        return;
       threadState.exitOp();
       profiler.correlation.submit(callbackData->correlationId);
+      auto *pImpl = dynamic_cast<CuptiProfilerPimpl *>(profiler.pImpl.get());
+      if (pImpl->counterProfiler && threadState.getLaunchDepth() == 0)
+        pImpl->counterProfiler->exitLaunch(isGraphLaunch(cbId),
+                                           profiler.getDataSet());
+      if (pImpl->pcSampler && threadState.getLaunchDepth() == 0)
+        pImpl->pcSampler->exitLaunch(profiler.getDataSet());
     }
   }
 }
 
 void CuptiProfiler::CuptiProfilerPimpl::doStart() {
+  if (profiler.hasHardwareCounters())
+    counterProfiler = std::make_unique<CounterProfiler>();
+  if (profiler.hasPCSampling())
+    pcSampler = std::make_unique<PCSampler>();
+  activityBuffers.start(profiler.getBufferSize(), processBuffer);
   cupti::activityRegisterCallbacks<true>(allocBuffer, completeBuffer);
   cupti::activityEnable<true>(CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL);
   // TODO: switch to directly subscribe the APIs and measure overhead
@@ -313,6 +1403,12 @@ void CuptiProfiler::CuptiProfilerPimpl::doStart() {
   setGraphCallbacks(subscriber, /*enable=*/true);
   setRuntimeCallbacks(subscriber, /*enable=*/true);
   setDriverCallbacks(subscriber, /*enable=*/true);
+  if (pcSampler)
+    setModuleCallbacks(subscriber, /*enable=*/true);
+  if (profiler.hasMemoryTracking()) {
+    memoryTracker = std::make_unique<MemoryTracker>();
+    setMemoryCallbacks(subscriber, /*enable=*/true);
+  }
 }
 
 void CuptiProfiler::CuptiProfilerPimpl::doFlush() {
@@ -328,25 +1424,43 @@ void CuptiProfiler::CuptiProfilerPimpl::doFlush() {
   cuda::ctxGetCurrent<false>(&cuContext);
   if (cuContext)
     cuda::ctxSynchronize<true>();
+  if (counterProfiler)
+    counterProfiler->flush(profiler.dataSet, /*stop=*/false);
   profiler.correlation.flush(
       /*maxRetries=*/100, /*sleepMs=*/10,
-      /*flush=*/[]() {
+      /*flush=*/[this]() {
         cupti::activityFlushAll<true>(
             /*flag=*/0);
+        activityBuffers.drain();
       });
   // CUPTI_ACTIVITY_FLAG_FLUSH_FORCED is used to ensure that even incomplete
   // activities are flushed so that the next profiling session can start with
   // new activities.
   cupti::activityFlushAll<true>(/*flag=*/CUPTI_ACTIVITY_FLAG_FLUSH_FORCED);
+  activityBuffers.drain();
 }
 
 void CuptiProfiler::CuptiProfilerPimpl::doStop() {
+  if (counterProfiler) {
+    counterProfiler->flush(profiler.dataSet, /*stop=*/true);
+    counterProfiler.reset();
+  }
+  if (pcSampler) {
+    pcSampler->stop();
+    pcSampler.reset();
+    setModuleCallbacks(subscriber, /*enable=*/false);
+  }
+  if (memoryTracker) {
+    memoryTracker.reset();
+    setMemoryCallbacks(subscriber, /*enable=*/false);
+  }
   cupti::activityDisable<true>(CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL);
   setGraphCallbacks(subscriber, /*enable=*/false);
   setRuntimeCallbacks(subscriber, /*enable=*/false);
   setDriverCallbacks(subscriber, /*enable=*/false);
   cupti::unsubscribe<true>(subscriber);
   cupti::finalize<true>();
+  activityBuffers.stop();
 }
 
 CuptiProfiler::CuptiProfiler() {
@@ -13,6 +13,7 @@
 #include <deque>
 #include <memory>
 #include <mutex>
+#include <stdexcept>
 #include <tuple>
 
 #include <cxxabi.h>
@@ -70,7 +71,8 @@ private:
 };
 
 std::shared_ptr<Metric>
-convertActivityToMetric(const roctracer_record_t *activity) {
+convertActivityToMetric(const roctracer_record_t *activity,
+                        uint64_t samplingInterval) {
   std::shared_ptr<Metric> metric;
   switch (activity->kind) {
   case kHipVdiCommandKernel: {
@@ -79,7 +81,9 @@ convertActivityToMetric(const roctracer_record_t *activity) {
         static_cast<uint64_t>(activity->end_ns), 1,
         static_cast<uint64_t>(
             DeviceInfo::instance().mapDeviceId(activity->device_id)),
-        static_cast<uint64_t>(DeviceType::HIP));
+        static_cast<uint64_t>(DeviceType::HIP),
+        static_cast<uint64_t>(activity->queue_id));
+    std::static_pointer_cast<KernelMetric>(metric)->scale(samplingInterval);
     break;
   }
   default:
@@ -93,11 +97,13 @@ void processActivityKernel(size_t externId, std::set<Data *> &dataSet,
   if (externId == Scope::DummyScopeId)
     return;
   auto correlationId = activity->correlation_id;
+  auto samplingInterval = RoctracerProfiler::instance().getSamplingInterval();
   for (auto *data : dataSet) {
     auto scopeId = externId;
     if (isAPI)
       scopeId = data->addScope(/*parentId=*/externId, activity->kernel_name);
-    data->addMetric(scopeId, convertActivityToMetric(activity));
+    data->addMetric(scopeId,
+                    convertActivityToMetric(activity, samplingInterval));
   }
 }
 
@@ -118,29 +124,31 @@ void processActivity(size_t externId, std::set<Data *> &dataSet,
 
 namespace {
 
-std::pair<bool, bool> matchKernelCbId(uint32_t cbId) {
-  bool isRuntimeApi = false;
-  bool isDriverApi = false;
-  switch (cbId) {
-  // TODO: switch to directly subscribe the APIs
-  case HIP_API_ID_hipExtLaunchKernel:
-  case HIP_API_ID_hipExtLaunchMultiKernelMultiDevice:
-  case HIP_API_ID_hipExtModuleLaunchKernel:
-  case HIP_API_ID_hipHccModuleLaunchKernel:
-  case HIP_API_ID_hipLaunchCooperativeKernel:
-  case HIP_API_ID_hipLaunchCooperativeKernelMultiDevice:
-  case HIP_API_ID_hipLaunchKernel:
-  case HIP_API_ID_hipModuleLaunchKernel:
-  case HIP_API_ID_hipGraphLaunch:
-  case HIP_API_ID_hipModuleLaunchCooperativeKernel:
-  case HIP_API_ID_hipModuleLaunchCooperativeKernelMultiDevice: {
-    isRuntimeApi = true;
-    break;
-  }
-  default:
-    break;
+// The HIP APIs launching kernels, the only ones whose callbacks are enabled,
+// so that the other APIs don't pay for the callbacks.
+constexpr uint32_t KernelLaunchApiIds[] = {
+    HIP_API_ID_hipExtLaunchKernel,
+    HIP_API_ID_hipExtLaunchMultiKernelMultiDevice,
+    HIP_API_ID_hipExtModuleLaunchKernel,
+    HIP_API_ID_hipHccModuleLaunchKernel,
+    HIP_API_ID_hipLaunchCooperativeKernel,
+    HIP_API_ID_hipLaunchCooperativeKernelMultiDevice,
+    HIP_API_ID_hipLaunchKernel,
+    HIP_API_ID_hipModuleLaunchKernel,
+    HIP_API_ID_hipGraphLaunch,
+    HIP_API_ID_hipModuleLaunchCooperativeKernel,
+    HIP_API_ID_hipModuleLaunchCooperativeKernelMultiDevice,
+};
+
+void setKernelLaunchCallbacks(activity_rtapi_callback_t callback,
+                              bool enable) {
+  for (auto cbId : KernelLaunchApiIds) {
+    if (enable)
+      roctracer::enableOpCallback<true>(ACTIVITY_DOMAIN_HIP_API, cbId,
+                                        callback, nullptr);
+    else
+      roctracer::disableOpCallback<true>(ACTIVITY_DOMAIN_HIP_API, cbId);
   }
-  return std::make_pair(isRuntimeApi, isDriverApi);
 }
 
 } // namespace
@@ -158,16 +166,10 @@ struct RoctracerProfiler::RoctracerProfilerPimpl
   static void apiCallback(uint32_t domain, uint32_t cid,
                           const void *callbackData, void *arg);
   static void activityCallback(const char *begin, const char *end, void *arg);
-
-  static constexpr size_t BufferSize = 64 * 1024 * 1024;
 };
 
 void RoctracerProfiler::RoctracerProfilerPimpl::apiCallback(
     uint32_t domain, uint32_t cid, const void *callbackData, void *arg) {
-  auto [isRuntimeAPI, isDriverAPI] = matchKernelCbId(cid);
-  if (!(isRuntimeAPI || isDriverAPI)) {
-    return;
-  }
   auto &profiler =
       dynamic_cast<RoctracerProfiler &>(RoctracerProfiler::instance());
   auto &pImpl = dynamic_cast<RoctracerProfiler::RoctracerProfilerPimpl &>(
@@ -175,12 +177,18 @@ void RoctracerProfiler::RoctracerProfilerPimpl::apiCallback(
   if (domain == ACTIVITY_DOMAIN_HIP_API) {
     const hip_api_data_t *data = (const hip_api_data_t *)(callbackData);
     if (data->phase == ACTIVITY_API_PHASE_ENTER) {
+      // Launches not sampled are not correlated, so that their activities
+      // are dropped
+      if (!threadState.enterLaunch())
+        return;
       // Valid context and outermost level of the kernel launch
       auto scopeId = Scope::getNewScopeId();
       threadState.record(scopeId);
       threadState.enterOp(scopeId);
       profiler.correlation.correlate(data->correlation_id);
     } else if (data->phase == ACTIVITY_API_PHASE_EXIT) {
+      if (!threadState.exitLaunch())
+        return;
       threadState.exitOp();
       // Track outstanding op for flush
       profiler.correlation.submit(data->correlation_id);
@@ -207,30 +215,39 @@ void RoctracerProfiler::RoctracerProfilerPimpl::activityCallback(
     maxCorrelationId =
         std::max<uint64_t>(maxCorrelationId, record->correlation_id);
     // TODO(Keren): Roctracer doesn't support cuda graph yet.
-    auto externId =
-        correlation.corrIdToExternId.contain(record->correlation_id)
-            ? correlation.corrIdToExternId.at(record->correlation_id).first
-            : Scope::DummyScopeId;
-    auto isAPI = correlation.apiExternIds.contain(externId);
+    // The correlation of a record is looked up and erased under a single
+    // lock of each map, as the launching threads contend on them.
+    std::pair<size_t, size_t> externIdAndCount{Scope::DummyScopeId, 0};
+    correlation.corrIdToExternId.pop(record->correlation_id,
+                                     externIdAndCount);
+    auto externId = externIdAndCount.first;
+    auto isAPI = externId != Scope::DummyScopeId &&
+                 correlation.apiExternIds.erase(externId);
     processActivity(externId, dataSet, record, isAPI);
-    // Track correlation ids from the same stream and erase those <
-    // correlationId
-    correlation.corrIdToExternId.erase(record->correlation_id);
-    correlation.apiExternIds.erase(externId);
     roctracer::getNextRecord<true>(record, &record);
   }
   correlation.complete(maxCorrelationId);
 }
 
 void RoctracerProfiler::RoctracerProfilerPimpl::doStart() {
-  roctracer::enableDomainCallback<true>(ACTIVITY_DOMAIN_HIP_API, apiCallback,
-                                        nullptr);
+  if (profiler.hasHardwareCounters())
+    throw std::runtime_error(
+        "Hardware counters are not supported by the roctracer backend");
+  if (profiler.hasPCSampling())
+    throw std::runtime_error(
+        "PC sampling is not supported by the roctracer backend");
+  if (profiler.hasMemoryTracking())
+    throw std::runtime_error(
+        "Memory tracking is not supported by the roctracer backend");
+  setKernelLaunchCallbacks(apiCallback, /*enable=*/true);
   // Activity Records
   roctracer_properties_t properties{0};
-  properties.buffer_size = BufferSize;
+  properties.buffer_size = profiler.getBufferSize();
   properties.buffer_callback_fun = activityCallback;
   roctracer::openPool<true>(&properties);
-  roctracer::enableDomainActivity<true>(ACTIVITY_DOMAIN_HIP_OPS);
+  // Only the kernel dispatches are recorded, not the copies and barriers
+  roctracer::enableOpActivity<true>(ACTIVITY_DOMAIN_HIP_OPS,
+                                    HIP_OP_ID_DISPATCH);
   roctracer::start();
 }
 
@@ -248,8 +265,9 @@ void RoctracerProfiler::RoctracerProfilerPimpl::doFlush() {
 
 void RoctracerProfiler::RoctracerProfilerPimpl::doStop() {
   roctracer::stop();
-  roctracer::disableDomainCallback<true>(ACTIVITY_DOMAIN_HIP_API);
-  roctracer::disableDomainActivity<true>(ACTIVITY_DOMAIN_HIP_OPS);
+  setKernelLaunchCallbacks(apiCallback, /*enable=*/false);
+  roctracer::disableOpActivity<true>(ACTIVITY_DOMAIN_HIP_OPS,
+                                     HIP_OP_ID_DISPATCH);
   roctracer::closePool<true>();
 }
 
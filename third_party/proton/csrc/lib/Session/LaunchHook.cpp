@@ -0,0 +1,63 @@
+#include "Session/LaunchHook.h"
+#include "Data/Data.h"
+#include "Session/Session.h"
+
+#include <mutex>
+#include <vector>
+
+namespace proton {
+
+namespace {
+
+// The ops entered by the launches of this thread, and the metadata of the next
+// launch
+thread_local std::vector<Scope> launchScopes;
+thread_local std::string launchName;
+thread_local std::map<std::string, MetricValueType> launchMetrics;
+
+} // namespace
+
+void LaunchHook::registerKernel(uint64_t function, const std::string &name) {
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  kernelNames[function] = name;
+}
+
+void LaunchHook::setLaunchMetadata(
+    const std::string &name,
+    const std::map<std::string, MetricValueType> &metrics) {
+  launchName = name;
+  launchMetrics = metrics;
+}
+
+void LaunchHook::enter(uint64_t function) {
+  std::string name = "unknown";
+  if (!launchName.empty()) {
+    name = std::move(launchName);
+    launchName.clear();
+  } else {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto it = kernelNames.find(function);
+    if (it != kernelNames.end())
+      name = it->second;
+  }
+  auto &scope = launchScopes.emplace_back(name);
+  SessionManager::instance().enterOp(scope);
+  if (!launchMetrics.empty()) {
+    SessionManager::instance().addMetrics(scope.scopeId, launchMetrics,
+                                          /*aggregable=*/true);
+    launchMetrics.clear();
+  }
+}
+
+void LaunchHook::exit(uint64_t function) {
+  if (launchScopes.empty())
+    return;
+  SessionManager::instance().exitOp(launchScopes.back());
+  launchScopes.pop_back();
+}
+
+void LaunchHook::enterHook(uint64_t function) { instance().enter(function); }
+
+void LaunchHook::exitHook(uint64_t function) { instance().exit(function); }
+
+} // namespace proton
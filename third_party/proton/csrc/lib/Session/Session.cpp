@@ -1,6 +1,7 @@
 #include "Session/Session.h"
 #include "Context/Python.h"
 #include "Context/Shadow.h"
+#include "Data/TraceData.h"
 #include "Data/TreeData.h"
 #include "Profiler/CuptiProfiler.h"
 #include "Profiler/RoctracerProfiler.h"
@@ -25,21 +26,29 @@ std::unique_ptr<Data> makeData(const std::string &dataName,
   if (toLower(dataName) == "tree") {
     return std::make_unique<TreeData>(path, contextSource);
   }
+  if (toLower(dataName) == "trace") {
+    return std::make_unique<TraceData>(path, contextSource);
+  }
   throw std::runtime_error("Unknown data: " + dataName);
 }
 
 std::unique_ptr<ContextSource>
-makeContextSource(const std::string &contextSourceName) {
+makeContextSource(const std::string &contextSourceName, size_t contextDepth) {
   if (toLower(contextSourceName) == "shadow") {
     return std::make_unique<ShadowContextSource>();
   } else if (toLower(contextSourceName) == "python") {
-    return std::make_unique<PythonContextSource>();
+    return std::make_unique<PythonContextSource>(contextDepth);
   }
   throw std::runtime_error("Unknown context source: " + contextSourceName);
 }
 } // namespace
 
 void Session::activate() {
+  profiler->setSamplingInterval(samplingInterval);
+  profiler->setHardwareCounters(hardwareCounters);
+  profiler->setPCSampling(pcSampling);
+  profiler->setMemoryTracking(memoryTracking);
+  profiler->setBufferSize(bufferSize);
   profiler->start();
   profiler->registerData(data.get());
 }
@@ -50,18 +59,57 @@ void Session::deactivate() {
 }
 
 void Session::finalize(OutputFormat outputFormat) {
+  stopPeriodicFlush();
   profiler->stop();
   data->dump(outputFormat);
 }
 
+Session::~Session() { stopPeriodicFlush(); }
+
+void Session::startPeriodicFlush(std::chrono::milliseconds interval) {
+  if (interval.count() <= 0)
+    throw std::invalid_argument("The flush interval must be positive");
+  if (flushThread.joinable())
+    throw std::runtime_error("The session is already flushed periodically");
+  flushStopped = false;
+  flushThread = std::thread([this, interval]() {
+    std::unique_lock<std::mutex> lock(flushMutex);
+    while (!flushCondition.wait_for(lock, interval,
+                                    [this]() { return flushStopped; })) {
+      profiler->flush();
+      data->dump(OutputFormat::Binary);
+    }
+  });
+}
+
+void Session::stopPeriodicFlush() {
+  if (!flushThread.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(flushMutex);
+    flushStopped = true;
+  }
+  flushCondition.notify_one();
+  flushThread.join();
+}
+
 std::unique_ptr<Session> SessionManager::makeSession(
     size_t id, const std::string &path, const std::string &profilerName,
-    const std::string &contextSourceName, const std::string &dataName) {
+    const std::string &contextSourceName, const std::string &dataName,
+    uint64_t samplingInterval, bool hardwareCounters, bool pcSampling,
+    bool memoryTracking, size_t contextDepth, size_t bufferSize) {
+  if (samplingInterval == 0)
+    throw std::invalid_argument("The sampling interval must be positive");
+  if (hardwareCounters && pcSampling)
+    throw std::invalid_argument(
+        "Hardware counters and PC sampling cannot be collected together");
   auto profiler = getProfiler(profilerName);
-  auto contextSource = makeContextSource(contextSourceName);
+  auto contextSource = makeContextSource(contextSourceName, contextDepth);
   auto data = makeData(dataName, path, contextSource.get());
   auto *session = new Session(id, path, profiler, std::move(contextSource),
-                              std::move(data));
+                              std::move(data), samplingInterval,
+                              hardwareCounters, pcSampling, memoryTracking,
+                              bufferSize);
   return std::unique_ptr<Session>(session);
 }
 
@@ -106,7 +154,11 @@ void SessionManager::removeSession(size_t sessionId) {
 size_t SessionManager::addSession(const std::string &path,
                                   const std::string &profilerName,
                                   const std::string &contextSourceName,
-                                  const std::string &dataName) {
+                                  const std::string &dataName,
+                                  uint64_t samplingInterval,
+                                  bool hardwareCounters, bool pcSampling,
+                                  bool memoryTracking, size_t contextDepth,
+                                  size_t bufferSize) {
   std::unique_lock<std::shared_mutex> lock(mutex);
   if (hasSession(path)) {
     auto sessionId = getSessionId(path);
@@ -116,7 +168,9 @@ size_t SessionManager::addSession(const std::string &path,
   auto sessionId = nextSessionId++;
   sessionPaths[path] = sessionId;
   sessions[sessionId] =
-      makeSession(sessionId, path, profilerName, contextSourceName, dataName);
+      makeSession(sessionId, path, profilerName, contextSourceName, dataName,
+                  samplingInterval, hardwareCounters, pcSampling,
+                  memoryTracking, contextDepth, bufferSize);
   return sessionId;
 }
 
@@ -144,6 +198,22 @@ void SessionManager::finalizeAllSessions(OutputFormat outputFormat) {
   }
 }
 
+void SessionManager::startPeriodicFlush(size_t sessionId,
+                                        std::chrono::milliseconds interval) {
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  if (!hasSession(sessionId))
+    throw std::runtime_error("Unknown session: " + std::to_string(sessionId));
+  sessions[sessionId]->startPeriodicFlush(interval);
+}
+
+void SessionManager::setTag(size_t sessionId, const std::string &key,
+                            const std::string &value) {
+  std::shared_lock<std::shared_mutex> lock(mutex);
+  if (!hasSession(sessionId))
+    throw std::runtime_error("Unknown session: " + std::to_string(sessionId));
+  sessions[sessionId]->data->setTag(key, value);
+}
+
 void SessionManager::enterScope(const Scope &scope) {
   std::shared_lock<std::shared_mutex> lock(mutex);
   for (auto iter : scopeInterfaceCounts) {
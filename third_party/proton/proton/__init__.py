@@ -1,5 +1,6 @@
 # flake8: noqa
 from .scope import scope, enter_scope, exit_scope
+from .regions import RegionBuffer
 from .profile import (
     start,
     activate,
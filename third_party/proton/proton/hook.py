@@ -1,28 +1,37 @@
 from .scope import enter_scope, exit_scope
+from triton._C.libproton import proton as libproton
 from triton.compiler import CompiledKernel, LazyDict
 
 COMPUTE_METADATA_SCOPE_NAME = "__proton_launch_metadata"
 
 
 class TritonHook:
+    """
+    Launch hooks of Triton kernels.  The launchers call Proton's native hooks with the handle of each kernel, which
+    look up the name of the kernel registered before its first launch, so that launches do not call Python.  Only the
+    kernels defining `launch_metadata` call `metadata` to compute their name and metrics before each launch.
+    """
     flops_width = [8, 16, 32, 64]
     metrics = [f"flops{width}" for width in flops_width] + ["bytes"] + ["flops"]
+    enter, exit = libproton.get_launch_hooks()
 
     @staticmethod
-    def enter(lazy_dict: LazyDict) -> None:
+    def register(kernel: CompiledKernel) -> None:
+        libproton.register_kernel(kernel.function, kernel.name)
+
+    @staticmethod
+    def metadata(lazy_dict: LazyDict) -> None:
         enter_scope(COMPUTE_METADATA_SCOPE_NAME)
         metadata = lazy_dict.get()
         exit_scope()
         fn_metrics = {k: metadata[k] for k in TritonHook.metrics if k in metadata}
-        enter_scope(metadata["name"], triton_op=True, metrics=fn_metrics)
-
-    @staticmethod
-    def exit(lazy_dict: LazyDict) -> None:
-        exit_scope(triton_op=True)
+        libproton.set_launch_metadata(metadata["name"], fn_metrics)
 
 
 def register_triton_hook() -> None:
     if CompiledKernel.launch_enter_hook is None:
+        CompiledKernel.launch_register_hook = TritonHook.register
+        CompiledKernel.launch_metadata_hook = TritonHook.metadata
         CompiledKernel.launch_enter_hook = TritonHook.enter
         CompiledKernel.launch_exit_hook = TritonHook.exit
 
@@ -31,3 +40,5 @@ def unregister_triton_hook() -> None:
     if CompiledKernel.launch_enter_hook == TritonHook.enter:
         CompiledKernel.launch_enter_hook = None
         CompiledKernel.launch_exit_hook = None
+        CompiledKernel.launch_register_hook = None
+        CompiledKernel.launch_metadata_hook = None
@@ -0,0 +1,187 @@
+import argparse
+import json
+from typing import List, Optional
+
+from .viewer import BINARY_MAGIC, read_binary
+
+desc = """
+Merges the profiles written by the ranks of a distributed job.
+
+Tree profiles ("<name>.rank<rank>.hatchet" or ".binary") are merged into a
+single hatchet file, whose nodes are the scopes and kernels found on any rank.
+The metrics of each node are the mean over the ranks that ran it, next to
+their min and max (e.g., "Time (ns)", "Time min (ns)", "Time max (ns)"),
+the number of those ranks ("num_ranks"), the rank with the longest time
+("straggler_rank") and the ratio of the longest to the mean time
+("imbalance").  The kernels with the largest gap between their longest and
+mean time are printed, slowest first, e.g.
+
+`proton-merge -o merged.hatchet proton.rank*.hatchet`
+
+Traces ("<name>.rank<rank>.chrome_trace") are merged into a single trace with
+a process per device and host of each rank.  Host clocks of different nodes
+are not synchronized, so the events of each rank are shifted to align them:
+by default on the first event of each rank, which lines up ranks starting
+the profiler after a barrier, or, with `--align <name>`, on the end of the
+first event with the given name (e.g., a scope around a barrier).
+"""
+
+TIME_METRIC = "Time (ns)"
+
+
+def stat_metric_name(name: str, stat: str) -> str:
+    # Keeps the unit last, so that the viewer matches the metric by its name without the unit
+    if "(" in name:
+        base, unit = name.split("(", 1)
+        return f"{base.strip()} {stat} ({unit}"
+    return f"{name} {stat}"
+
+
+def read_profile(file_name: str):
+    with open(file_name, "rb") as f:
+        data = f.read()
+    return read_binary(data) if data.startswith(BINARY_MAGIC) else json.loads(data)
+
+
+def get_rank(tags: dict, default: int) -> int:
+    return int(tags["rank"]) if "rank" in tags else default
+
+
+def merge_nodes(nodes: List[dict], ranks: List[int]) -> dict:
+    """Merges the nodes with the same calling context of the given ranks, and their children."""
+    merged = {"frame": nodes[0]["frame"], "metrics": {}, "children": []}
+    metric_names = []
+    for node in nodes:
+        for name in node["metrics"]:
+            if name not in metric_names:
+                metric_names.append(name)
+    for name in metric_names:
+        values = [node["metrics"][name] for node in nodes if name in node["metrics"]]
+        if not all(isinstance(value, (int, float)) for value in values):
+            # Non-numeric metrics (e.g., the device type) are taken from the first rank
+            merged["metrics"][name] = values[0]
+            continue
+        merged["metrics"][name] = sum(values) / len(values)
+        merged["metrics"][stat_metric_name(name, "min")] = min(values)
+        merged["metrics"][stat_metric_name(name, "max")] = max(values)
+    merged["metrics"]["num_ranks"] = len(nodes)
+    times = [node["metrics"].get(TIME_METRIC, 0) for node in nodes]
+    if any(times):
+        slowest = max(range(len(nodes)), key=lambda i: times[i])
+        merged["metrics"]["straggler_rank"] = ranks[slowest]
+        merged["metrics"]["imbalance"] = max(times) * len(times) / sum(times)
+    # Children of the same name on different ranks are the same calling context
+    children = {}
+    for node, rank in zip(nodes, ranks):
+        for child in node["children"]:
+            child_nodes, child_ranks = children.setdefault(child["frame"]["name"], ([], []))
+            child_nodes.append(child)
+            child_ranks.append(rank)
+    for child_nodes, child_ranks in children.values():
+        merged["children"].append(merge_nodes(child_nodes, child_ranks))
+    return merged
+
+
+def merge_trees(databases: List[list]) -> list:
+    """Merges the hatchet databases ([tree, devices, tags]) of the ranks of a job."""
+    ranks = [get_rank(database[2] if len(database) > 2 else {}, index) for index, database in enumerate(databases)]
+    root = merge_nodes([database[0] for database in databases], ranks)
+    device_info = {}
+    for database in databases:
+        for device_type, devices in database[1].items():
+            device_info.setdefault(device_type, {}).update(devices)
+    return [root, device_info, {"world_size": str(len(databases))}]
+
+
+def find_stragglers(root: dict, limit: int) -> List[tuple]:
+    """Returns (path, min, mean, max time, straggler rank) of the `limit` kernels with the largest gaps."""
+    rows = []
+
+    def visit(node, path):
+        path = path + [node["frame"]["name"]]
+        metrics = node["metrics"]
+        if not node["children"] and "straggler_rank" in metrics:
+            rows.append(("/".join(path[1:]), metrics[stat_metric_name(TIME_METRIC, "min")], metrics[TIME_METRIC],
+                         metrics[stat_metric_name(TIME_METRIC, "max")], metrics["straggler_rank"]))
+        for child in node["children"]:
+            visit(child, path)
+
+    visit(root, [])
+    rows.sort(key=lambda row: row[3] - row[2], reverse=True)
+    return rows[:limit]
+
+
+def get_event_end(events: List[dict], index: int) -> float:
+    event = events[index]
+    if event["ph"] == "X":
+        return event["ts"] + event.get("dur", 0)
+    if event["ph"] != "B":
+        return event["ts"]
+    # The matching end of a begin event is the first unmatched end on its thread
+    depth = 0
+    for other in events[index + 1:]:
+        if other.get("pid") != event["pid"] or other.get("tid") != event["tid"]:
+            continue
+        if other["ph"] == "B":
+            depth += 1
+        elif other["ph"] == "E":
+            if depth == 0:
+                return other["ts"]
+            depth -= 1
+    return event["ts"]
+
+
+def get_alignment_time(events: List[dict], align: Optional[str]) -> float:
+    timed = [event for event in events if "ts" in event and event["ph"] != "M"]
+    if align is None:
+        return min((event["ts"] for event in timed), default=0)
+    for index, event in enumerate(events):
+        if event.get("name") == align and event["ph"] in ("B", "X", "i"):
+            return get_event_end(events, index)
+    raise ValueError(f"No event named {align} to align the trace on")
+
+
+def merge_traces(traces: List[dict], align: Optional[str] = None) -> dict:
+    """Merges the Chrome traces of the ranks of a job, shifting the events of each rank to align them."""
+    merged = []
+    pids = {}
+    for index, trace in enumerate(traces):
+        rank = get_rank(trace.get("otherData", {}), index)
+        events = trace["traceEvents"]
+        offset = get_alignment_time(events, align)
+        for event in events:
+            event = dict(event)
+            # Processes of different ranks may have the same pid
+            event["pid"] = pids.setdefault((rank, event["pid"]), len(pids))
+            if "ts" in event and event["ph"] != "M":
+                event["ts"] -= offset
+            if event["ph"] == "M" and event.get("name") == "process_name":
+                event["args"] = {"name": f"rank {rank} {event['args']['name']}"}
+            merged.append(event)
+    return {"traceEvents": merged, "displayTimeUnit": "ns"}
+
+
+def main():
+    argparser = argparse.ArgumentParser(description=desc, formatter_class=argparse.RawTextHelpFormatter)
+    argparser.add_argument("profiles", nargs="+", help="The profiles of the ranks")
+    argparser.add_argument("-o", "--output", type=str, required=True, help="Path of the merged profile")
+    argparser.add_argument("--align", type=str, default=None,
+                           help="Align traces on the end of the first event with the given name")
+    argparser.add_argument("-n", "--num-stragglers", type=int, default=10,
+                           help="The number of straggler kernels to print")
+    args = argparser.parse_args()
+
+    profiles = [read_profile(file_name) for file_name in args.profiles]
+    if all(isinstance(profile, dict) and "traceEvents" in profile for profile in profiles):
+        merged = merge_traces(profiles, args.align)
+    else:
+        merged = merge_trees(profiles)
+        print(f"{'kernel':<60} {'min (ns)':>14} {'mean (ns)':>14} {'max (ns)':>14} {'rank':>6}")
+        for path, min_time, mean_time, max_time, rank in find_stragglers(merged[0], args.num_stragglers):
+            print(f"{path[-60:]:<60} {min_time:>14.0f} {mean_time:>14.0f} {max_time:>14.0f} {rank:>6}")
+    with open(args.output, "w") as f:
+        json.dump(merged, f)
+
+
+if __name__ == "__main__":
+    main()
@@ -1,4 +1,6 @@
 import functools
+import os
+import socket
 import triton
 
 from triton._C.libproton import proton as libproton
@@ -8,6 +10,11 @@ from typing import Optional
 
 DEFAULT_PROFILE_NAME = "proton"
 
+# The output format of each data structure
+_DATA_OUTPUT_FORMATS = {"tree": "hatchet", "trace": "chrome_trace"}
+# session id -> output format, for the sessions whose data is not dumped as hatchet by default
+_session_output_formats = {}
+
 
 def _select_backend() -> str:
     backend = triton.runtime.driver.active.get_current_target().backend
@@ -19,6 +26,35 @@ def _select_backend() -> str:
         raise ValueError("No backend is available for the current target.")
 
 
+# Environment variables of the launchers (torchrun, Open MPI, MPICH, Slurm) giving the rank of the process
+_RANK_ENV_VARS = ["RANK", "OMPI_COMM_WORLD_RANK", "PMI_RANK", "SLURM_PROCID"]
+_LOCAL_RANK_ENV_VARS = ["LOCAL_RANK", "OMPI_COMM_WORLD_LOCAL_RANK", "MPI_LOCALRANKID", "SLURM_LOCALID"]
+_WORLD_SIZE_ENV_VARS = ["WORLD_SIZE", "OMPI_COMM_WORLD_SIZE", "PMI_SIZE", "SLURM_NTASKS"]
+
+
+def _get_env(names):
+    for name in names:
+        if name in os.environ:
+            return int(os.environ[name])
+    return None
+
+
+def _get_rank_tags() -> dict:
+    """
+    Returns the rank, local rank, world size and host of the process when it is one of the processes of a
+    distributed job, or an empty dict otherwise.
+    """
+    rank = _get_env(_RANK_ENV_VARS)
+    world_size = _get_env(_WORLD_SIZE_ENV_VARS)
+    if rank is None or world_size is None or world_size <= 1:
+        return {}
+    tags = {"rank": rank, "world_size": world_size, "hostname": socket.gethostname()}
+    local_rank = _get_env(_LOCAL_RANK_ENV_VARS)
+    if local_rank is not None:
+        tags["local_rank"] = local_rank
+    return tags
+
+
 def start(
     name: Optional[str] = None,
     *,
@@ -26,6 +62,13 @@ def start(
     data: Optional[str] = "tree",
     backend: Optional[str] = None,
     hook: Optional[str] = None,
+    sampling_interval: int = 1,
+    hardware_counters: bool = False,
+    pc_sampling: bool = False,
+    memory: bool = False,
+    flush_interval: Optional[float] = None,
+    context_depth: Optional[int] = None,
+    buffer_size: Optional[int] = None,
 ):
     """
     Start profiling with the given name and backend.
@@ -41,6 +84,10 @@ def start(
     Args:
         name (str, optional): The name (with path) of the profiling session.
                               If not provided, the default name is "~/proton.hatchet".
+                              In distributed jobs (e.g., launched by torchrun, mpirun or srun), the rank of the
+                              process is appended to the name ("<name>.rank<rank>"), and the profile is tagged with
+                              the rank, local rank, world size and host of the process, so that `proton-merge` can
+                              merge the profiles of all ranks.
         backend (str, optional): The backend to use for profiling.
                                  Available options are ["cupti"].
                                  Defaults to None, which automatically selects the backend matching the current active runtime.
@@ -48,11 +95,53 @@ def start(
                                  Available options are ["shadow", "python"].
                                  Defaults to "shadow".
         data (str, optional): The data structure to use for profiling.
-                              Available options are ["tree"].
+                              Available options are ["tree", "trace"].
+                              "tree" aggregates metrics by calling context and is dumped as a hatchet file,
+                              "trace" records the timeline of scopes and kernels and is dumped as a Chrome trace,
+                              which Perfetto can open.
                               Defaults to "tree".
         hook (str, optional): The hook to use for profiling.
                               Available options are [None, "triton"].
                               Defaults to None.
+        sampling_interval (int, optional): Profile one in every `sampling_interval` kernel launches of each thread,
+                                           to lower the overhead of always-on profiling.
+                                           The metrics of the sampled launches are extrapolated to all launches, e.g.,
+                                           their time and count are multiplied by the interval; traces only show the
+                                           sampled kernels.
+                                           Defaults to 1, which profiles every launch.
+        hardware_counters (bool, optional): Collect the hardware counters of each kernel: DRAM bytes, L2 hit and miss
+                                            sectors, active cycles, achieved occupancy, tensor pipe active cycles and
+                                            shared memory bank conflicts.
+                                            Kernels are replayed to collect the counters, which serializes them and
+                                            inflates their measured time.  Only supported by the "cupti" backend.
+                                            Defaults to False.
+        pc_sampling (bool, optional): Sample the program counters of each kernel, and attribute the samples to the
+                                      source lines of the kernel, as children of its node, with the stall reasons of
+                                      the sampled warps (e.g., "pc_samples", "stalled_long_scoreboard").
+                                      Kernels are serialized while sampled.  Only supported by the "cupti" backend,
+                                      and not together with `hardware_counters`.
+                                      Defaults to False.
+        memory (bool, optional): Track the device memory allocated and freed by each scope: "alloc_bytes",
+                                 "free_bytes", "allocs", and "peak_bytes", the peak of the device memory allocated
+                                 while profiling, right after the allocations of the scope.  Allocations by caching
+                                 allocators (e.g., PyTorch's) are only seen when their pools grow.  Only supported by
+                                 the "cupti" backend.
+                                 Defaults to False.
+        flush_interval (float, optional): Flush the profile every `flush_interval` seconds to a binary file
+                                          ("<name>.binary"), which only grows by what changed since the previous
+                                          flush, so that long-running jobs keep a recent profile on disk.
+                                          `proton-viewer` reads it and converts it to hatchet.
+                                          Only supported by the "tree" data.
+                                          Defaults to None, which writes the profile once when finalized.
+        context_depth (int, optional): Only keep the `context_depth` innermost Python frames of the launches, which
+                                       bounds the cost of unwinding deep stacks.  Only supported by the "python"
+                                       context.
+                                       Defaults to None, which keeps all the frames.
+        buffer_size (int, optional): The size in bytes of the buffers the backend records the kernels into.  The
+                                     buffers are recycled, and the full ones are processed on a background thread.
+                                     Smaller buffers are processed sooner and use less memory, larger ones are
+                                     handed off less often.
+                                     Defaults to None, which uses 64 MB buffers.
     Returns:
         session (int): The session ID of the profiling session.
     """
@@ -62,6 +151,9 @@ def start(
 
     if name is None:
         name = DEFAULT_PROFILE_NAME
+    rank_tags = _get_rank_tags()
+    if rank_tags:
+        name = f"{name}.rank{rank_tags['rank']}"
 
     if backend is None:
         backend = _select_backend()
@@ -69,7 +161,24 @@ def start(
     set_profiling_on()
     if hook and hook == "triton":
         register_triton_hook()
-    return libproton.start(name, context, data, backend)
+    if sampling_interval < 1:
+        raise ValueError("sampling_interval must be a positive integer")
+    if flush_interval is not None and (flush_interval <= 0 or data != "tree"):
+        raise ValueError("flush_interval must be positive and requires the tree data")
+    if context_depth is not None and (context_depth < 1 or context != "python"):
+        raise ValueError("context_depth must be a positive integer and requires the python context")
+    if buffer_size is not None and buffer_size < 1:
+        raise ValueError("buffer_size must be a positive integer")
+    session = libproton.start(name, context, data, backend, sampling_interval, hardware_counters, pc_sampling,
+                              memory, context_depth or 0, buffer_size or 0)
+    for key, value in rank_tags.items():
+        libproton.set_tag(session, key, str(value))
+    if flush_interval is not None:
+        libproton.start_periodic_flush(session, flush_interval)
+        _session_output_formats[session] = "binary"
+    elif _DATA_OUTPUT_FORMATS.get(data, "hatchet") != "hatchet":
+        _session_output_formats[session] = _DATA_OUTPUT_FORMATS[data]
+    return session
 
 
 def activate(session: Optional[int] = 0) -> None:
@@ -104,7 +213,7 @@ def deactivate(session: Optional[int] = 0) -> None:
     libproton.deactivate(session)
 
 
-def finalize(session: Optional[int] = None, output_format: str = "hatchet") -> None:
+def finalize(session: Optional[int] = None, output_format: Optional[str] = None) -> None:
     """
     Finalizes a profiling session.
     Flush and write the profiling data to the file specified by the session name.
@@ -112,19 +221,27 @@ def finalize(session: Optional[int] = None, output_format: str = "hatchet") -> N
     Args:
         session (int, optional): The session ID to finalize. If None, all sessions are finalized. Defaults to None.
         output_format (str, optional): The output format for the profiling results.
-                                       Aavailable options are ["hatchet"].
+                                       Aavailable options are ["hatchet", "chrome_trace", "binary"].
+                                       Defaults to None, which selects the format of the data of each session:
+                                       "hatchet" for "tree", "chrome_trace" for "trace", and "binary" for the
+                                       sessions flushed periodically.
 
     Returns:
         None
     """
     if session is None:
         set_profiling_off()
-        libproton.finalize_all(output_format)
+        if output_format is None:
+            for trace_session, trace_format in list(_session_output_formats.items()):
+                libproton.finalize(trace_session, trace_format)
+        _session_output_formats.clear()
+        libproton.finalize_all(output_format or "hatchet")
         unregister_triton_hook()
     else:
         if is_command_line() and session != 0:
             raise ValueError("Only one session can be finalized when running from the command line.")
-        libproton.finalize(session, output_format)
+        default_format = _session_output_formats.pop(session, "hatchet")
+        libproton.finalize(session, output_format or default_format)
 
 
 def _profiling(
@@ -16,8 +16,20 @@ def parse_arguments():
     parser.add_argument("-b", "--backend", type=str, help="Profiling backend", default=None, choices=["cupti"])
     parser.add_argument("-c", "--context", type=str, help="Profiling context", default="shadow",
                         choices=["shadow", "python"])
-    parser.add_argument("-d", "--data", type=str, help="Profiling data", default="tree", choices=["tree"])
+    parser.add_argument("-d", "--data", type=str, help="Profiling data", default="tree", choices=["tree", "trace"])
     parser.add_argument("-k", "--hook", type=str, help="Profiling hook", default=None, choices=[None, "triton"])
+    parser.add_argument("-s", "--sampling-interval", type=int, help="Profile one in every N kernel launches",
+                        default=1)
+    parser.add_argument("--hardware-counters", action="store_true", help="Collect the hardware counters of kernels")
+    parser.add_argument("--pc-sampling", action="store_true",
+                        help="Sample the program counters of kernels, to attribute time to source lines")
+    parser.add_argument("--memory", action="store_true", help="Track the device memory allocated and freed by scopes")
+    parser.add_argument("--flush-interval", type=float, default=None,
+                        help="Flush the profile to a binary file every N seconds")
+    parser.add_argument("--context-depth", type=int, default=None,
+                        help="Only keep the N innermost Python frames of the python context")
+    parser.add_argument("--buffer-size", type=int, default=None,
+                        help="Record the kernels into buffers of N bytes")
     args, target_args = parser.parse_known_args()
     return args, target_args
 
@@ -55,7 +67,10 @@ def execute_as_main(script, args):
 def run_profiling(args, target_args):
     backend = args.backend if args.backend else _select_backend()
 
-    start(args.name, context=args.context, data=args.data, backend=backend, hook=args.hook)
+    start(args.name, context=args.context, data=args.data, backend=backend, hook=args.hook,
+          sampling_interval=args.sampling_interval, hardware_counters=args.hardware_counters,
+          pc_sampling=args.pc_sampling, memory=args.memory, flush_interval=args.flush_interval,
+          context_depth=args.context_depth, buffer_size=args.buffer_size)
 
     # Set the command line mode to avoid any `start` calls in the script.
     set_command_line()
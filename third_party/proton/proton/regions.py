@@ -0,0 +1,96 @@
+import json
+from typing import Dict, List, Optional
+
+DEFAULT_CAPACITY = 1024
+
+
+class RegionBuffer:
+    """
+    Ring buffers of the timestamps recorded by `tl.profile_region`, one per warp of each program.
+
+    Usage:
+
+        ```python
+        regions = proton.RegionBuffer(num_programs=grid[0], num_warps=4)
+        kernel[grid](..., regions.data, num_warps=4)
+        regions.dump_chrome_trace("regions.chrome_trace")
+        ```
+
+    Args:
+        num_programs (int): The number of programs of the launch.
+        num_warps (int): The number of warps of each program.
+        capacity (int): The number of records of each warp, which must match the `capacity` passed to
+                        `tl.profile_region`.  Defaults to 1024, the default of `tl.profile_region`.
+        device (str): The device of the kernel.
+    """
+
+    def __init__(self, num_programs: int, num_warps: int, capacity: int = DEFAULT_CAPACITY, device: str = "cuda"):
+        import torch
+        self.num_programs = num_programs
+        self.num_warps = num_warps
+        self.capacity = capacity
+        self.data = torch.zeros(num_programs * num_warps * (1 + 2 * capacity), dtype=torch.int64, device=device)
+
+    def reset(self) -> None:
+        """Drops the records, to reuse the buffer for another launch."""
+        self.data.zero_()
+
+    def records(self) -> List[dict]:
+        """
+        Returns the records kept, as dicts of "program", "warp", "region", "end" and "time", oldest first for each
+        warp.
+        """
+        words = self.data.view(self.num_programs * self.num_warps, 1 + 2 * self.capacity).tolist()
+        records = []
+        for index, warp_words in enumerate(words):
+            program, warp = divmod(index, self.num_warps)
+            count = warp_words[0]
+            for i in range(max(0, count - self.capacity), count):
+                slot = i % self.capacity
+                time, tag = warp_words[1 + 2 * slot], warp_words[2 + 2 * slot]
+                records.append({
+                    "program": program, "warp": warp, "region": tag >> 1, "end": bool(tag & 1), "time": time
+                })
+        return records
+
+    def to_chrome_trace(self, region_names: Optional[Dict[int, str]] = None) -> dict:
+        """
+        Converts the records to a Chrome trace, with a process per program and a thread per warp.
+        Regions whose start or end was overwritten are dropped.
+
+        Args:
+            region_names (dict, optional): region id -> name of the region in the trace.
+        """
+        region_names = region_names or {}
+        events = []
+        starts = {}
+        for record in self.records():
+            key = (record["program"], record["warp"], record["region"])
+            if not record["end"]:
+                starts.setdefault(key, []).append(record["time"])
+                continue
+            if not starts.get(key):
+                continue
+            start = starts[key].pop()
+            events.append({
+                "name": region_names.get(record["region"], f"region {record['region']}"),
+                "cat": "region",
+                "ph": "X",
+                # Raw timer ticks: nanoseconds on NVIDIA GPUs, and cycles on AMD GPUs
+                "ts": start / 1000,
+                "dur": (record["time"] - start) / 1000,
+                "pid": record["program"],
+                "tid": record["warp"],
+            })
+        for program in sorted({event["pid"] for event in events}):
+            events.append({"name": "process_name", "ph": "M", "pid": program, "args": {"name": f"program {program}"}})
+        for program, warp in sorted({(event["pid"], event["tid"]) for event in events if event["ph"] == "X"}):
+            events.append({
+                "name": "thread_name", "ph": "M", "pid": program, "tid": warp, "args": {"name": f"warp {warp}"}
+            })
+        return {"traceEvents": events, "displayTimeUnit": "ns"}
+
+    def dump_chrome_trace(self, path: str, region_names: Optional[Dict[int, str]] = None) -> None:
+        """Writes the Chrome trace of the records to `path`, which Perfetto and chrome://tracing can open."""
+        with open(path, "w") as f:
+            json.dump(self.to_chrome_trace(region_names), f)
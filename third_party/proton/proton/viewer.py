@@ -1,6 +1,7 @@
 import argparse
 from collections import namedtuple
 import json
+import struct
 import pandas as pd
 
 import hatchet as ht
@@ -22,10 +23,127 @@ def match_available_metrics(metrics, raw_metrics):
     return ret
 
 
+BINARY_MAGIC = b"PROTONB1"
+# Record tags and value types of the binary format, see TreeData.h
+BINARY_NODE, BINARY_NAME, BINARY_METRICS, BINARY_DEVICE, BINARY_END = range(1, 6)
+BINARY_UINT64, BINARY_INT64, BINARY_DOUBLE, BINARY_STRING = range(4)
+
+
+class BinaryReader:
+
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def read_varint(self):
+        value = shift = 0
+        while True:
+            byte = self.data[self.pos]
+            self.pos += 1
+            value |= (byte & 0x7f) << shift
+            shift += 7
+            if byte < 0x80:
+                return value
+
+    def read_string(self):
+        size = self.read_varint()
+        value = self.data[self.pos:self.pos + size].decode()
+        self.pos += size
+        return value
+
+    def read_value(self):
+        value_type = self.data[self.pos]
+        self.pos += 1
+        if value_type == BINARY_UINT64:
+            return self.read_varint()
+        if value_type == BINARY_INT64:
+            value = self.read_varint()
+            return (value >> 1) ^ -(value & 1)
+        if value_type == BINARY_DOUBLE:
+            value = struct.unpack_from("<d", self.data, self.pos)[0]
+            self.pos += 8
+            return value
+        if value_type == BINARY_STRING:
+            return self.read_string()
+        raise ValueError(f"Unknown value type: {value_type}")
+
+
+def read_binary(data):
+    """
+    Converts the contents of a binary profile to the hatchet database of a json profile.
+    Only the records up to the last complete flush are read: the file may be written concurrently.
+    """
+    assert data.startswith(BINARY_MAGIC), "Not a binary proton profile"
+    reader = BinaryReader(data)
+    reader.pos = len(BINARY_MAGIC)
+    nodes = {0: {"frame": {"name": "ROOT", "type": "function"}, "metrics": {}, "children": []}}
+    names = {}
+    device_info = {}
+    value_names = set()
+    # Records are applied once the End record of their flush is read
+    pending = []
+    try:
+        while reader.pos < len(data):
+            tag = data[reader.pos]
+            reader.pos += 1
+            if tag == BINARY_NODE:
+                node_id, parent_id, name = reader.read_varint(), reader.read_varint(), reader.read_string()
+                pending.append((tag, (node_id, parent_id, name)))
+            elif tag == BINARY_NAME:
+                pending.append((tag, (reader.read_varint(), reader.read_string())))
+            elif tag == BINARY_METRICS:
+                node_id = reader.read_varint()
+                values = [(reader.read_varint(), reader.read_value()) for _ in range(reader.read_varint())]
+                pending.append((tag, (node_id, values)))
+            elif tag == BINARY_DEVICE:
+                device_type, device_id = reader.read_string(), reader.read_varint()
+                clock_rate, memory_clock_rate, bus_width, num_sms = (reader.read_varint() for _ in range(4))
+                arch = reader.read_string()
+                device = {
+                    "clock_rate": clock_rate,
+                    "memory_clock_rate": memory_clock_rate,
+                    "bus_width": bus_width,
+                    "arch": arch,
+                    "num_sms": num_sms,
+                }
+                pending.append((tag, (device_type, str(device_id), device)))
+            elif tag == BINARY_END:
+                for tag, record in pending:
+                    if tag == BINARY_NODE:
+                        node_id, parent_id, name = record
+                        nodes[node_id] = {"frame": {"name": name, "type": "function"}, "metrics": {}, "children": []}
+                        nodes[parent_id]["children"].append(nodes[node_id])
+                    elif tag == BINARY_NAME:
+                        names[record[0]] = record[1]
+                    elif tag == BINARY_METRICS:
+                        node_id, values = record
+                        for name_id, value in values:
+                            nodes[node_id]["metrics"][names[name_id]] = value
+                            if not isinstance(value, str):
+                                value_names.add(names[name_id])
+                    elif tag == BINARY_DEVICE:
+                        device_type, device_id, device = record
+                        device_info.setdefault(device_type, {})[device_id] = device
+                pending = []
+            else:
+                raise ValueError(f"Unknown record: {tag}")
+    except IndexError:
+        # Truncated by a flush in progress
+        pass
+    # Hints for all available metrics
+    for value_name in value_names:
+        nodes[0]["metrics"].setdefault(value_name, 0)
+    return [nodes[0], device_info]
+
+
 def get_raw_metrics(file):
-    database = json.load(file)
-    device_info = database.pop(1)
-    gf = ht.GraphFrame.from_literal(database)
+    data = file.read()
+    if isinstance(data, str):
+        data = data.encode()
+    database = read_binary(data) if data.startswith(BINARY_MAGIC) else json.loads(data)
+    # [tree, devices] followed by the tags of the process, if any
+    device_info = database[1]
+    gf = ht.GraphFrame.from_literal(database[:1])
     return gf, gf.show_metric_columns(), device_info
 
 
@@ -62,8 +180,14 @@ def get_min_time_flops(df, device_info):
     return min_time_flops
 
 
+def get_bytes_metric_name(columns):
+    # Prefer the bytes measured by hardware counters over the estimates recorded by kernels
+    return "dram_bytes" if "dram_bytes" in columns else "bytes"
+
+
 def get_min_time_bytes(df, device_info):
     min_time_bytes = pd.DataFrame(0.0, index=df.index, columns=["min_time"])
+    bytes_metric_name = get_bytes_metric_name(df.columns)
     for device_type in device_info:
         for device_index in device_info[device_type]:
             idx = df["DeviceId"] == device_index
@@ -71,7 +195,7 @@ def get_min_time_bytes(df, device_info):
             memory_clock_rate = device_info[device_type][device_index]["memory_clock_rate"]  # in khz
             bus_width = device_info[device_type][device_index]["bus_width"]  # in bits
             peak_bandwidth = 2 * bus_width * memory_clock_rate * 1e3 / 8
-            min_time_bytes.loc[idx, "min_time"] += device_frames["bytes"] / peak_bandwidth
+            min_time_bytes.loc[idx, "min_time"] += device_frames[bytes_metric_name] / peak_bandwidth
     return min_time_bytes
 
 
@@ -80,6 +204,16 @@ time_factor_dict = FactorDict("time", {"time/s": 1, "time/ms": 1e-3, "time/us":
 flops_factor_dict = FactorDict("flops", {"flop/s": 1, "gflop/s": 1e9, "tflop/s": 1e12})
 bytes_factor_dict = FactorDict("bytes", {"byte/s": 1, "gbyte/s": 1e9, "tbyte/s": 1e12})
 
+# Peak device memory of the scopes, which aggregates by maximum
+PEAK_METRIC = "peak_bytes"
+
+# Ratios of hardware counters: derived metric -> (numerator, denominators)
+counter_ratio_metrics = {
+    "l2_hit_rate": ("l2_hit_sectors", ["l2_hit_sectors", "l2_miss_sectors"]),
+    "occupancy": ("sm_occupancy_cycles", ["sm_active_cycles"]),
+    "tensor_util": ("tensor_pipe_active_cycles", ["sm_active_cycles"]),
+}
+
 derivable_metrics = {
     **{key: flops_factor_dict
        for key in flops_factor_dict.factor.keys()},
@@ -101,9 +235,17 @@ def derive_metrics(gf, metrics, raw_metrics, device_info):
                                                          time_factor_dict.factor["time/s"])
             gf.dataframe["util (inc)"] = min_time_flops["min_time"].combine(min_time_bytes["min_time"], max) / time_sec
             derived_metrics.append("util (inc)")
+        elif metric in counter_ratio_metrics:
+            numerator, denominators = counter_ratio_metrics[metric]
+            numerator = match_available_metrics([numerator], raw_metrics)[0]
+            denominators = match_available_metrics(denominators, raw_metrics)
+            gf.dataframe[f"{metric} (inc)"] = gf.dataframe[numerator] / sum(gf.dataframe[d] for d in denominators)
+            derived_metrics.append(f"{metric} (inc)")
         elif metric in derivable_metrics:
             deriveable_metric = derivable_metrics[metric]
             metric_name = deriveable_metric.name
+            if metric_name == "bytes":
+                metric_name = get_bytes_metric_name(raw_metrics)
             metric_factor_dict = deriveable_metric.factor
             matched_metric_name = match_available_metrics([metric_name], raw_metrics)[0]
             gf.dataframe[f"{metric} (inc)"] = (gf.dataframe[matched_metric_name] /
@@ -133,12 +275,25 @@ def format_frames(gf, format):
     return gf
 
 
+def update_peak_columns(gf):
+    # Peaks do not add up: the inclusive peak of a node is the largest peak of its subtree
+    if PEAK_METRIC not in gf.dataframe.columns:
+        return
+    df = gf.dataframe
+    for node in gf.graph.traverse(order="post"):
+        peak = df.loc[node, PEAK_METRIC]
+        for child in node.children:
+            peak = max(peak, df.loc[child, f"{PEAK_METRIC} (inc)"])
+        df.loc[node, f"{PEAK_METRIC} (inc)"] = peak
+
+
 def parse(metrics, filename, include, exclude, threshold, depth, format):
-    with open(filename, "r") as f:
+    with open(filename, "rb") as f:
         gf, raw_metrics, device_info = get_raw_metrics(f)
         gf = format_frames(gf, format)
         assert len(raw_metrics) > 0, "No metrics found in the input file"
         gf.update_inclusive_columns()
+        update_peak_columns(gf)
         metrics = derive_metrics(gf, metrics, raw_metrics, device_info)
         if include or exclude:
             # make regex do negative match
@@ -156,7 +311,7 @@ def parse(metrics, filename, include, exclude, threshold, depth, format):
 
 
 def show_metrics(file_name):
-    with open(file_name, "r") as f:
+    with open(file_name, "rb") as f:
         _, raw_metrics, _ = get_raw_metrics(f)
         print("Available metrics:")
         if raw_metrics:
@@ -166,6 +321,13 @@ def show_metrics(file_name):
         return
 
 
+def convert_to_hatchet(file_name, output_name):
+    with open(file_name, "rb") as f:
+        database = read_binary(f.read())
+    with open(output_name, "w") as f:
+        json.dump(database, f, indent=4)
+
+
 def main():
     argparser = argparse.ArgumentParser(
         description="Performance data viewer for proton profiles.",
@@ -181,6 +343,14 @@ Derived metrics can be created when source metrics are available.
 - flop/s, gflop/s, tflop/s: flops / time
 - byte/s, gbyte/s, tbyte/s: bytes / time
 - util: max(sum(flops<width>) / peak_flops<width>_time, sum(bytes) / peak_bandwidth_time)
+- l2_hit_rate: l2_hit_sectors / (l2_hit_sectors + l2_miss_sectors)
+- occupancy: sm_occupancy_cycles / sm_active_cycles
+- tensor_util: tensor_pipe_active_cycles / sm_active_cycles
+Hardware counters (dram_bytes, when collected) are preferred over the bytes recorded by kernels.
+With memory tracking, alloc_bytes, free_bytes, allocs and peak_bytes are the device memory allocated and freed by
+scopes, and the peak of the allocated memory (the largest of their subtree when inclusive).
+With PC sampling, the source lines of kernels are children of their kernels, with pc_samples and the samples of each
+stall reason (e.g., stalled_long_scoreboard) as metrics.
 """,
     )
     argparser.add_argument(
@@ -231,6 +401,12 @@ There are two modes:
 - function_line: include the function name and line number.
 - file_function: include the file name and function name.
 """)
+    argparser.add_argument(
+        "--to-hatchet",
+        type=str,
+        default=None,
+        help="Convert a binary profile to a hatchet file at the given path",
+    )
 
     args, target_args = argparser.parse_known_args()
     assert len(target_args) == 1, "Must specify a file to read"
@@ -244,7 +420,9 @@ There are two modes:
     format = args.format
     if include and exclude:
         raise ValueError("Cannot specify both include and exclude")
-    if args.list:
+    if args.to_hatchet:
+        convert_to_hatchet(file_name, args.to_hatchet)
+    elif args.list:
         show_metrics(file_name)
     elif metrics:
         parse(metrics, file_name, include, exclude, threshold, depth, format)
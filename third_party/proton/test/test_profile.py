@@ -2,6 +2,7 @@ import torch
 import triton
 import triton.profiler as proton
 import tempfile
+import time
 import json
 import pytest
 from typing import NamedTuple
@@ -37,6 +38,30 @@ def test_torch(context):
             assert "elementwise_kernel" in prev_frame[0]["frame"]["name"]
 
 
+def test_python_context_depth():
+
+    def launch():
+        torch.ones((2, 2), device="cuda")
+
+    with tempfile.NamedTemporaryFile(delete=True, suffix=".hatchet") as f:
+        proton.start(f.name.split(".")[0], context="python", context_depth=2)
+        for _ in range(2):
+            launch()
+        proton.finalize()
+        data = json.load(f)
+        # The two innermost frames and the kernel, shared by both launches
+        names = []
+        curr_frame = data[0]["children"]
+        while len(curr_frame) > 0:
+            assert len(curr_frame) == 1
+            names.append(curr_frame[0]["frame"]["name"])
+            curr_frame = curr_frame[0]["children"]
+        assert len(names) == 3
+        assert "test_python_context_depth" in names[0]
+        assert "launch" in names[1]
+        assert "elementwise_kernel" in names[2]
+
+
 def test_triton():
 
     @triton.jit
@@ -197,3 +222,186 @@ def test_hook():
         assert data[0]["children"][0]["children"][0]["frame"]["name"] == "foo_test_1ctas_1elems"
         assert data[0]["children"][0]["children"][0]["metrics"]["flops32"] == 1.0
         assert data[0]["children"][0]["children"][0]["metrics"]["Time (ns)"] > 0
+
+
+def test_threads():
+    import threading
+
+    def launch():
+        for _ in range(10):
+            torch.ones((2, 2), device="cuda")
+        torch.cuda.synchronize()
+
+    with tempfile.NamedTemporaryFile(delete=True, suffix=".hatchet") as f:
+        proton.start(f.name.split(".")[0])
+        threads = [threading.Thread(target=launch) for _ in range(4)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        proton.finalize()
+        data = json.load(f)
+        # The trees of all threads are merged
+        kernels = data[0]["children"]
+        assert len(kernels) == 1
+        assert kernels[0]["metrics"]["Count"] == 40
+
+
+def test_sampling():
+    x = torch.ones((2, 2), device="cuda")
+    with tempfile.NamedTemporaryFile(delete=True, suffix=".hatchet") as f:
+        proton.start(f.name.split(".")[0], sampling_interval=5)
+        for _ in range(10):
+            x = x + 1
+        proton.finalize()
+        data = json.load(f)
+        kernels = data[0]["children"]
+        assert len(kernels) == 1
+        # Two launches are sampled and extrapolated to ten
+        assert kernels[0]["metrics"]["Count"] == 10
+        assert kernels[0]["metrics"]["Time (ns)"] > 0
+
+
+def test_buffer_size():
+    x = torch.ones((2, 2), device="cuda")
+    with tempfile.NamedTemporaryFile(delete=True, suffix=".hatchet") as f:
+        # Small buffers fill up, and are recycled, while launching
+        proton.start(f.name.split(".")[0], buffer_size=64 * 1024)
+        for _ in range(2000):
+            x = x + 1
+        proton.finalize()
+        data = json.load(f)
+        kernels = data[0]["children"]
+        assert len(kernels) == 1
+        assert kernels[0]["metrics"]["Count"] == 2000
+
+
+def test_flush_interval():
+    from triton.profiler.viewer import read_binary
+    x = torch.ones((2, 2), device="cuda")
+    with tempfile.NamedTemporaryFile(delete=True, suffix=".binary") as f:
+        proton.start(f.name.split(".")[0], flush_interval=0.01)
+        for _ in range(10):
+            x = x + 1
+        time.sleep(0.1)
+        flushed_size = len(f.read())
+        for _ in range(10):
+            x = x + 1
+        proton.finalize()
+        f.seek(0)
+        data = f.read()
+        # The first flushes are kept, and the next ones only append
+        assert 0 < flushed_size < len(data)
+        database = read_binary(data)
+        kernels = database[0]["children"]
+        assert len(kernels) == 1
+        assert kernels[0]["metrics"]["Count"] == 20
+        assert kernels[0]["metrics"]["Time (ns)"] > 0
+        assert len(database[1]) > 0
+
+
+def test_pc_sampling():
+    if is_hip():
+        pytest.skip("PC sampling requires CUDA")
+
+    @triton.jit
+    def foo(x, y, size: tl.constexpr):
+        offs = tl.arange(0, size)
+        tl.store(y + offs, tl.load(x + offs) * 2)
+
+    x = torch.ones((1024, ), device="cuda")
+    y = torch.zeros_like(x)
+    with tempfile.NamedTemporaryFile(delete=True, suffix=".hatchet") as f:
+        proton.start(f.name.split(".")[0], hook="triton", pc_sampling=True)
+        for _ in range(100):
+            foo[(1, )](x, y, 1024)
+        proton.finalize()
+        data = json.load(f)
+        kernels = data[0]["children"]
+        assert len(kernels) == 1 and kernels[0]["frame"]["name"] == "foo"
+        lines = kernels[0]["children"]
+        assert len(lines) > 0
+        assert all(":foo@" in line["frame"]["name"] for line in lines)
+        assert sum(line["metrics"]["pc_samples"] for line in lines) > 0
+
+
+def test_memory():
+    if is_hip():
+        pytest.skip("Memory tracking requires CUDA")
+
+    size = 64 << 20
+    # Allocations are only seen when the caching allocator grows its pool
+    torch.cuda.empty_cache()
+    with tempfile.NamedTemporaryFile(delete=True, suffix=".hatchet") as f:
+        proton.start(f.name.split(".")[0], memory=True)
+        with proton.scope("alloc"):
+            x = torch.empty((size, ), dtype=torch.uint8, device="cuda")
+        del x
+        with proton.scope("free"):
+            torch.cuda.empty_cache()
+        proton.finalize()
+        data = json.load(f)
+        scopes = {child["frame"]["name"]: child["metrics"] for child in data[0]["children"]}
+        assert scopes["alloc"]["alloc_bytes"] >= size and scopes["alloc"]["allocs"] >= 1
+        assert scopes["alloc"]["peak_bytes"] >= size
+        assert scopes["free"]["free_bytes"] >= size
+
+
+def test_trace():
+    with tempfile.NamedTemporaryFile(delete=True, suffix=".chrome_trace") as f:
+        proton.start(f.name.split(".")[0], data="trace")
+        with proton.scope("test"):
+            torch.ones((2, 2), device="cuda")
+        proton.finalize()
+        events = json.load(f)["traceEvents"]
+        scopes = [e for e in events if e.get("cat") == "scope"]
+        kernels = [e for e in events if e.get("cat") == "kernel"]
+        assert len(scopes) == 1 and scopes[0]["name"] == "test" and scopes[0]["ph"] == "B"
+        assert len(kernels) == 1 and kernels[0]["ph"] == "X"
+        assert kernels[0]["dur"] > 0
+        assert kernels[0]["ts"] >= scopes[0]["ts"]
+
+
+def test_rank_tags(monkeypatch):
+    monkeypatch.setenv("RANK", "3")
+    monkeypatch.setenv("LOCAL_RANK", "1")
+    monkeypatch.setenv("WORLD_SIZE", "4")
+    with tempfile.TemporaryDirectory() as tmpdir:
+        proton.start(f"{tmpdir}/test")
+        torch.ones((2, 2), device="cuda")
+        proton.finalize()
+        with open(f"{tmpdir}/test.rank3.hatchet") as f:
+            data = json.load(f)
+        assert data[2]["rank"] == "3" and data[2]["local_rank"] == "1" and data[2]["world_size"] == "4"
+
+
+def test_profile_region():
+
+    @triton.jit
+    def foo(x, y, regions):
+        tl.profile_region(regions, 0)
+        offs = tl.arange(0, 128)
+        tl.store(y + offs, tl.load(x + offs) + 1)
+        tl.profile_region(regions, 0, end=True)
+
+    x = torch.ones((128, ), device="cuda")
+    y = torch.zeros_like(x)
+    regions = proton.RegionBuffer(num_programs=2, num_warps=4)
+    foo[(2, )](x, y, regions.data, num_warps=4)
+    records = regions.records()
+    assert len(records) == 2 * 4 * 2
+    assert {(r["program"], r["warp"]) for r in records} == {(p, w) for p in range(2) for w in range(4)}
+    with tempfile.NamedTemporaryFile(delete=True, suffix=".chrome_trace") as f:
+        regions.dump_chrome_trace(f.name, region_names={0: "body"})
+        events = [e for e in json.load(f)["traceEvents"] if e["ph"] == "X"]
+        assert len(events) == 2 * 4
+        assert all(e["name"] == "body" and e["dur"] >= 0 for e in events)
+
+
+@pytest.mark.parametrize("l2_cache", ["cold", "warm"])
+def test_do_bench_cupti(l2_cache):
+    if is_hip():
+        pytest.skip("timer='cupti' requires CUDA")
+    x = torch.randn((1024, 1024), device="cuda")
+    ms = triton.testing.do_bench(lambda: x + 1, warmup=1, rep=10, timer="cupti", l2_cache=l2_cache)
+    assert 0 < ms < 10
@@ -1,6 +1,9 @@
 import pytest
 import subprocess
-from triton.profiler.viewer import get_min_time_flops, get_min_time_bytes, get_raw_metrics, format_frames
+from triton.profiler.viewer import get_min_time_flops, get_min_time_bytes, get_raw_metrics, format_frames, derive_metrics
+from triton.profiler.viewer import update_peak_columns
+import io
+import json
 import numpy as np
 
 file_path = __file__
@@ -71,3 +74,78 @@ def test_min_time_bytes():
         np.testing.assert_allclose(ret[device0_idx].to_numpy(), [[6.10351e-06]], atol=1e-6)
         # MI300
         np.testing.assert_allclose(ret[device1_idx].to_numpy(), [[1.93378e-05]], atol=1e-6)
+
+
+def test_counter_metrics():
+    with open(cuda_example_file, "r") as f:
+        database = json.load(f)
+    counters = {
+        "dram_bytes": 20000000.0, "l2_hit_sectors": 300.0, "l2_miss_sectors": 100.0, "sm_active_cycles": 1000.0,
+        "sm_occupancy_cycles": 500.0, "tensor_pipe_active_cycles": 250.0
+    }
+    database[0]["metrics"].update({name: 0 for name in counters})
+    foo1 = database[0]["children"][1]
+    foo1["metrics"].update(counters)
+    gf, raw_metrics, device_info = get_raw_metrics(io.StringIO(json.dumps(database)))
+    gf.update_inclusive_columns()
+    metrics = derive_metrics(gf, ["l2_hit_rate", "occupancy", "tensor_util"], raw_metrics, device_info)
+    idx = gf.dataframe["name"] == "foo1"
+    np.testing.assert_allclose(gf.dataframe[idx][metrics].to_numpy(), [[0.75, 0.5, 0.25]])
+    # Measured bytes are used instead of the bytes recorded by the kernel
+    ret = get_min_time_bytes(gf.dataframe, device_info)
+    np.testing.assert_allclose(ret[idx].to_numpy(), [[1.98394e-05]], atol=1e-6)
+
+
+def test_merge_trees():
+    from triton.profiler.merge import merge_trees, find_stragglers
+    databases = []
+    for rank, time in enumerate([100, 300, 200]):
+        with open(cuda_example_file, "r") as f:
+            database = json.load(f)
+        database[0]["children"][0]["metrics"]["Time (ns)"] = time
+        databases.append(database + [{"rank": str(rank)}])
+    merged = merge_trees(databases)
+    foo0 = merged[0]["children"][0]["metrics"]
+    assert foo0["Time (ns)"] == 200
+    assert foo0["Time min (ns)"] == 100 and foo0["Time max (ns)"] == 300
+    assert foo0["num_ranks"] == 3 and foo0["straggler_rank"] == 1
+    assert foo0["imbalance"] == 1.5
+    assert find_stragglers(merged[0], 1)[0][0] == "foo0"
+    # The merged profile is read like the profile of a single rank
+    gf, raw_metrics, _ = get_raw_metrics(io.StringIO(json.dumps(merged)))
+    assert "Time max (ns)" in raw_metrics
+
+
+def test_merge_traces():
+    from triton.profiler.merge import merge_traces
+    traces = []
+    for rank, start in enumerate([1000, 5000]):
+        traces.append({
+            "traceEvents": [
+                {"name": "process_name", "ph": "M", "pid": 7, "args": {"name": "host"}},
+                {"name": "barrier", "cat": "scope", "ph": "B", "ts": start, "pid": 7, "tid": 0},
+                {"ph": "E", "ts": start + 10 * (rank + 1), "pid": 7, "tid": 0},
+                {"name": "kernel", "cat": "kernel", "ph": "X", "ts": start + 50, "dur": 5, "pid": 7, "tid": 0},
+            ], "otherData": {"rank": str(rank)}
+        })
+    merged = merge_traces(traces, align="barrier")["traceEvents"]
+    kernels = [e for e in merged if e.get("name") == "kernel"]
+    # Both kernels run 40 (rank 0) and 30 (rank 1) after the end of the barrier
+    assert [e["ts"] for e in kernels] == [40, 30]
+    assert len({e["pid"] for e in merged}) == 2
+    names = [e["args"]["name"] for e in merged if e.get("name") == "process_name"]
+    assert names == ["rank 0 host", "rank 1 host"]
+
+
+def test_peak_metrics():
+    with open(cuda_example_file, "r") as f:
+        database = json.load(f)
+    database[0]["metrics"]["peak_bytes"] = 0
+    for child, peak in zip(database[0]["children"], [100, 300]):
+        child["metrics"]["peak_bytes"] = peak
+    gf, _, _ = get_raw_metrics(io.StringIO(json.dumps(database)))
+    gf.update_inclusive_columns()
+    update_peak_columns(gf)
+    root = gf.dataframe[gf.dataframe["name"] == "ROOT"]
+    # The largest peak of the children rather than their sum
+    assert root["peak_bytes (inc)"].iloc[0] == 300
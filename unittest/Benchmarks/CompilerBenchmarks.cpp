@@ -0,0 +1,194 @@
+// Compile-time benchmarks of the TritonGPU passes and analyses, and of the
+// linear layout operations they are built on.
+//
+// The passes and analyses run on each module of the corpus, the .ttgir and
+// .mlir files of the directory named by TRITON_BENCHMARK_CORPUS, which
+// defaults to Corpus/ next to this file.  Modules dumped by Triton, e.g. the
+// .ttgir files of the cache with TRITON_KERNEL_DUMP=1, can be benchmarked by
+// pointing it to them.  Results are emitted as JSON with
+//
+//   CompilerBenchmarks --benchmark_out=results.json --benchmark_out_format=json
+//
+// and can be compared between two builds with benchmark's tools/compare.py.
+
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <functional>
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/ControlFlow/IR/ControlFlow.h"
+#include "mlir/Dialect/GPU/IR/GPUDialect.h"
+#include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Pass/PassManager.h"
+#include "triton/Analysis/Allocation.h"
+#include "triton/Analysis/AxisInfo.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/LinearLayoutConversions.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+#include "triton/Dialect/TritonNvidiaGPU/IR/Dialect.h"
+#include "triton/Tools/LinearLayout.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace mlir::triton::gpu {
+namespace {
+
+MLIRContext &getContext() {
+  static MLIRContext *ctx = [] {
+    DialectRegistry registry;
+    registry.insert<TritonDialect, TritonGPUDialect,
+                    nvidia_gpu::TritonNvidiaGPUDialect, arith::ArithDialect,
+                    math::MathDialect, scf::SCFDialect,
+                    cf::ControlFlowDialect, mlir::gpu::GPUDialect>();
+    auto *ctx = new MLIRContext(registry);
+    ctx->loadAllAvailableDialects();
+    // Time the passes on a single thread, so that runs can be compared.
+    ctx->disableMultithreading();
+    return ctx;
+  }();
+  return *ctx;
+}
+
+// Runs the passes added by `addPasses` on a clone of `module` in each
+// iteration, without timing the cloning.
+void runPasses(benchmark::State &state, ModuleOp module,
+               std::function<void(PassManager &)> addPasses) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    OwningOpRef<ModuleOp> clone = module.clone();
+    PassManager pm(module.getContext());
+    pm.enableVerifier(false);
+    addPasses(pm);
+    state.ResumeTiming();
+    if (failed(pm.run(*clone))) {
+      state.SkipWithError("the passes failed");
+      break;
+    }
+    state.PauseTiming();
+    clone = nullptr;
+    state.ResumeTiming();
+  }
+}
+
+void registerModuleBenchmarks(StringRef name, ModuleOp module) {
+  auto registerBenchmark = [&](StringRef prefix, auto fn) {
+    std::string fullName = (prefix + "/" + name).str();
+    benchmark::RegisterBenchmark(fullName.c_str(), fn)
+        ->Unit(benchmark::kMillisecond);
+  };
+  registerBenchmark("RemoveLayoutConversions", [=](benchmark::State &state) {
+    runPasses(state, module, [](PassManager &pm) {
+      pm.addPass(createTritonGPURemoveLayoutConversions());
+    });
+  });
+  registerBenchmark("Pipeline", [=](benchmark::State &state) {
+    runPasses(state, module, [](PassManager &pm) {
+      pm.addPass(createTritonGPUPipeline());
+    });
+  });
+  registerBenchmark("AxisInfoAnalysis", [=](benchmark::State &state) {
+    for (auto _ : state) {
+      ModuleAxisInfoAnalysis axisInfo(module);
+      benchmark::DoNotOptimize(&axisInfo);
+    }
+  });
+  registerBenchmark("Allocation", [=](benchmark::State &state) {
+    for (auto _ : state) {
+      ModuleAllocation allocation(module);
+      benchmark::DoNotOptimize(allocation.getSharedMemorySize());
+    }
+  });
+}
+
+// Parses the modules of the corpus and registers their benchmarks.  The
+// modules live until the end of the program.
+void registerCorpusBenchmarks() {
+  static SmallVector<OwningOpRef<ModuleOp>> modules;
+  std::string corpus = TRITON_BENCHMARK_CORPUS_DIR;
+  if (const char *dir = std::getenv("TRITON_BENCHMARK_CORPUS"))
+    corpus = dir;
+
+  SmallVector<std::string> paths;
+  std::error_code ec;
+  for (llvm::sys::fs::directory_iterator it(corpus, ec), end;
+       it != end && !ec; it.increment(ec)) {
+    StringRef ext = llvm::sys::path::extension(it->path());
+    if (ext == ".ttgir" || ext == ".mlir")
+      paths.push_back(it->path());
+  }
+  if (ec)
+    llvm::errs() << "cannot read the corpus " << corpus << ": "
+                 << ec.message() << "\n";
+  llvm::sort(paths);
+
+  for (const std::string &path : paths) {
+    OwningOpRef<ModuleOp> module =
+        parseSourceFile<ModuleOp>(path, &getContext());
+    if (!module) {
+      llvm::errs() << "cannot parse " << path << "\n";
+      continue;
+    }
+    registerModuleBenchmarks(llvm::sys::path::stem(path), *module);
+    modules.push_back(std::move(module));
+  }
+}
+
+// The layouts of a size x size tensor in a blocked and in an MMAv2 layout,
+// between which the accumulators of dots are converted.
+std::pair<LinearLayout, LinearLayout> getBlockedAndMmaLayouts(int64_t size) {
+  MLIRContext &ctx = getContext();
+  auto ctaLayout = CTALayoutAttr::get(&ctx, {1, 1}, {1, 1}, {1, 0});
+  auto blocked = BlockedEncodingAttr::get(&ctx, {1, 4}, {4, 8}, {4, 1},
+                                          {1, 0}, ctaLayout);
+  auto mma = NvidiaMmaEncodingAttr::get(&ctx, 2, 0, {4, 1}, ctaLayout,
+                                        {16, 8});
+  return {*toLinearLayout({size, size}, blocked),
+          *toLinearLayout({size, size}, mma)};
+}
+
+void BM_LinearLayoutInvertAndCompose(benchmark::State &state) {
+  auto [blocked, mma] = getBlockedAndMmaLayouts(state.range(0));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(blocked.invertAndCompose(mma));
+}
+BENCHMARK(BM_LinearLayoutInvertAndCompose)->RangeMultiplier(2)->Range(32, 256);
+
+void BM_LinearLayoutCompose(benchmark::State &state) {
+  auto [blocked, mma] = getBlockedAndMmaLayouts(state.range(0));
+  LinearLayout conversion = blocked.invertAndCompose(mma);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(conversion.compose(mma));
+}
+BENCHMARK(BM_LinearLayoutCompose)->RangeMultiplier(2)->Range(32, 256);
+
+// The elements per thread of a tensor, which the lowering queries for nearly
+// every op.
+void BM_GetTotalElemsPerThread(benchmark::State &state) {
+  MLIRContext &ctx = getContext();
+  auto ctaLayout = CTALayoutAttr::get(&ctx, {1, 1}, {1, 1}, {1, 0});
+  auto blocked = BlockedEncodingAttr::get(&ctx, {1, 4}, {4, 8}, {4, 1},
+                                          {1, 0}, ctaLayout);
+  auto type = RankedTensorType::get({128, 128}, FloatType::getF16(&ctx),
+                                    SliceEncodingAttr::get(&ctx, 0, blocked));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(getTotalElemsPerThread(type));
+}
+BENCHMARK(BM_GetTotalElemsPerThread);
+
+} // namespace
+} // namespace mlir::triton::gpu
+
+int main(int argc, char **argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+  mlir::triton::gpu::registerCorpusBenchmarks();
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
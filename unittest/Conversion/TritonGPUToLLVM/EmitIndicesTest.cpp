@@ -143,8 +143,8 @@ protected:
 
   void runWmmaSingleCTA(int row, int col, llvm::ArrayRef<unsigned> warpsPerCTA,
                         const std::string &refStr) {
-    auto layout =
-        AMDWmmaEncodingAttr::get(&context, warpsPerCTA, getSingleCTALayout2d());
+    auto layout = AMDWmmaEncodingAttr::get(&context, /*version=*/1,
+                                           warpsPerCTA, getSingleCTALayout2d());
     runDistributed2d(row, col, layout, /*multiCTA=*/false, refStr);
   }
 
@@ -724,7 +724,7 @@ TEST_F(EmitIndicesTest, LayoutVisualizer_Wmma) {
                          /*CTASplitNum=*/{1, 1}, /*CTAOrder=*/{1, 0});
 
   Attribute wmmaLayout = AMDWmmaEncodingAttr::get(
-      /*context=*/&context,
+      /*context=*/&context, /*version=*/1,
       /*warpsPerCTA=*/{1, 1}, /*CTALayout=*/CTALayout);
 
   llvm::SmallVector<int64_t> shape = {/*row=*/16, /*col=*/16};
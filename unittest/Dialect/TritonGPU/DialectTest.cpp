@@ -588,6 +588,27 @@ TEST_F(AMDMfmaLayoutTest, mfma16) {
   ASSERT_THAT(tmfma3d.getWarpOrder(), testing::ElementsAre(1u, 2u, 0u));
 }
 
+TEST_F(AMDMfmaLayoutTest, cachedElemsPerThread) {
+  // The cached properties of an encoding are kept per shape and element type.
+  auto mfma = createMFMA(32, 32, {2, 4});
+  Type f32Ty = FloatType::getF32(&ctx);
+  SmallVector<SmallVector<int64_t>> shapes = {{64, 128}, {128, 128}};
+  for (int i = 0; i < 2; i++) {
+    for (ArrayRef<int64_t> shape : shapes) {
+      for (Type eltTy : {f16Ty, f32Ty}) {
+        auto type = RankedTensorType::get(shape, eltTy, mfma);
+        ASSERT_EQ(getTotalElemsPerThread(type),
+                  mfma.getTotalElemsPerThread(shape, eltTy));
+        ASSERT_EQ(getElemsPerThread(type),
+                  mfma.getElemsPerThread(shape, eltTy));
+      }
+      ASSERT_EQ(getShapePerCTATile(mfma, shape),
+                mfma.getShapePerCTATile(shape));
+    }
+    ASSERT_EQ(getCTALayout(mfma), ctaLayout);
+  }
+}
+
 } // anonymous namespace
 } // namespace mlir::triton::gpu
 
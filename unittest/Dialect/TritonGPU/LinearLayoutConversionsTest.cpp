@@ -50,13 +50,13 @@ public:
         isTransposed, CTALayoutAttr::get(&ctx, cpg, cSplit, cOrd));
   }
 
-  AMDWmmaEncodingAttr wmma(ArrayRef<unsigned> warps) {
+  AMDWmmaEncodingAttr wmma(ArrayRef<unsigned> warps, unsigned version = 1) {
     SmallVector<unsigned> cpg(warps.size(), 1u);
     SmallVector<unsigned> cSplit(warps.size(), 1u);
     SmallVector<unsigned> cOrd(warps.size());
     std::iota(cOrd.begin(), cOrd.end(), 0);
     return AMDWmmaEncodingAttr::get(
-        &ctx, warps, CTALayoutAttr::get(&ctx, cpg, cSplit, cOrd));
+        &ctx, version, warps, CTALayoutAttr::get(&ctx, cpg, cSplit, cOrd));
   }
 
   SliceEncodingAttr slice(Attribute parent, int dim) {
@@ -717,6 +717,24 @@ TEST_F(LinearLayoutConversionsTest, WMMA_2x4x1Warps) {
           {S("dim0"), S("dim1"), S("dim2")}));
 }
 
+TEST_F(LinearLayoutConversionsTest, WMMAv2_2x4Warps) {
+  auto legacy = wmma(/*warps=*/{2, 4}, /*version=*/2);
+
+  // Each half of a wave holds 8 contiguous rows.
+  EXPECT_EQ(toLinearLayout({16, 16}, legacy),
+            LinearLayout({{S("register"), {{1, 0}, {2, 0}, {4, 0}}},
+                          {S("lane"), {{0, 1}, {0, 2}, {0, 4}, {0, 8}, {8, 0}}},
+                          {S("warp"), {{0, 0}, {0, 0}, {0, 0}}},
+                          {S("block"), {}}},
+                         {S("dim0"), S("dim1")}));
+  EXPECT_EQ(toLinearLayout({32, 32}, legacy),
+            LinearLayout({{S("register"), {{1, 0}, {2, 0}, {4, 0}}},
+                          {S("lane"), {{0, 1}, {0, 2}, {0, 4}, {0, 8}, {8, 0}}},
+                          {S("warp"), {{0, 16}, {0, 0}, {16, 0}}},
+                          {S("block"), {}}},
+                         {S("dim0"), S("dim1")}));
+}
+
 TEST_F(LinearLayoutConversionsTest, SliceOfBlocked) {
   auto parent = blocked({2, 4}, {4, 2}, {2, 2}, {2, 2}, {2, 2}, {1, 0}, {1, 0});
   EXPECT_EQ(toLinearLayout({128}, slice(parent, 0)),
@@ -993,6 +1011,24 @@ TEST_F(LinearLayoutConversionsTest, Shared1DSwizzle) {
                 LinearLayout::identity1D(1, S("block"), S("dim0")));
 }
 
+TEST_F(LinearLayoutConversionsTest, CachedLayoutConversion) {
+  auto srcEnc = blocked({1, 4}, {4, 8}, {4, 1}, {1, 1}, {1, 1}, {1, 0}, {1, 0});
+  auto dstEnc = blocked({4, 1}, {8, 4}, {1, 4}, {1, 1}, {1, 1}, {0, 1}, {1, 0});
+  auto f16 = FloatType::getF16(&ctx);
+  auto srcTy = RankedTensorType::get({64, 64}, f16, srcEnc);
+  auto dstTy = RankedTensorType::get({64, 64}, f16, dstEnc);
+
+  auto expected = toLinearLayout({64, 64}, srcEnc)->invertAndCompose(
+      *toLinearLayout({64, 64}, dstEnc));
+  EXPECT_EQ(getLayoutConversion(srcTy, dstTy), expected);
+  // The second query is served from the cache and must agree.
+  EXPECT_EQ(getLayoutConversion(srcTy, dstTy), expected);
+  EXPECT_EQ(toLinearLayout({64, 64}, srcEnc), toLinearLayout({64, 64}, srcEnc));
+  // elemBitWidth doesn't affect layouts other than MMAv3 shared ones.
+  EXPECT_EQ(toLinearLayout({64, 64}, srcEnc, /*elemBitWidth=*/16),
+            toLinearLayout({64, 64}, srcEnc));
+}
+
 } // anonymous namespace
 } // namespace mlir::triton::gpu
 
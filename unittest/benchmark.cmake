@@ -0,0 +1,23 @@
+include(FetchContent)
+
+set(BENCHMARK_DIR "" CACHE STRING "Location of local Google Benchmark repo to build against")
+
+if(BENCHMARK_DIR)
+  set(FETCHCONTENT_SOURCE_DIR_BENCHMARK ${BENCHMARK_DIR} CACHE STRING "Google Benchmark source directory override")
+endif()
+
+FetchContent_Declare(
+  benchmark
+  GIT_REPOSITORY https://github.com/google/benchmark.git
+  GIT_TAG v1.8.3
+  )
+
+FetchContent_GetProperties(benchmark)
+
+if(NOT benchmark_POPULATED)
+  FetchContent_Populate(benchmark)
+  set(BENCHMARK_ENABLE_TESTING OFF CACHE BOOL "" FORCE)
+  set(BENCHMARK_ENABLE_GTEST_TESTS OFF CACHE BOOL "" FORCE)
+  set(BENCHMARK_ENABLE_INSTALL OFF CACHE BOOL "" FORCE)
+  add_subdirectory(${benchmark_SOURCE_DIR} ${benchmark_BINARY_DIR} EXCLUDE_FROM_ALL)
+endif()